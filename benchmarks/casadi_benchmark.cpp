@@ -0,0 +1,502 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+/** \brief Benchmark suite of standard CasADi workloads
+
+  Usage: casadi_benchmark [--list] [--filter substring] [--min-time seconds]
+                          [--output file.json]
+
+  Each benchmark consists of a setup, which is timed once, and a workload, which is
+  repeated until at least --min-time seconds (and at least three samples) have been
+  spent. Cheap workloads are repeated several times per sample so that each sample
+  takes about a millisecond. All data is generated deterministically.
+
+  The results are printed as a table and, with --output, written as JSON:
+  {"casadi_version": ..., "min_time": ..., "benchmarks": [{"name": ..., "t_setup": ...,
+  "n_rep": ..., "t_min": ..., "t_median": ..., "t_mean": ...}, ...]}
+  with all times in seconds per execution of the workload. Benchmarks whose
+  dependencies are missing have a "skipped" entry instead of timings.
+  Two result files can be compared with compare.py in this directory.
+*/
+
+#include <casadi/casadi.hpp>
+#include <casadi/core/casadi_meta.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+
+using namespace casadi;
+
+namespace {
+
+  /// Wall time in seconds
+  double now() {
+    return std::chrono::duration<double>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  /// Deterministic pseudo-random numbers in [0, 1), independent of the platform
+  class Random {
+  public:
+    explicit Random(unsigned long long seed=1) : state_(seed) {}
+    double operator()() {
+      state_ = state_*6364136223846793005ULL + 1442695040888963407ULL;
+      return static_cast<double>(state_ >> 11) / 9007199254740992.;
+    }
+    /// Random matrix with a given sparsity pattern
+    DM matrix(const Sparsity& sp) {
+      std::vector<double> nz(sp.nnz());
+      for (double& e : nz) e = (*this)();
+      return DM(sp, nz);
+    }
+  private:
+    unsigned long long state_;
+  };
+
+  /// Workload of a benchmark, the return value must depend on the result
+  typedef std::function<double()> Workload;
+
+  /// A benchmark: name and setup, returning the workload
+  struct Benchmark {
+    std::string name;
+    std::function<Workload()> setup;
+  };
+
+  /// Result of a benchmark
+  struct Result {
+    std::string name, skipped;
+    double t_setup, t_min, t_median, t_mean;
+    casadi_int n_rep;
+  };
+
+  /// Numerical evaluation with preallocated buffers
+  Workload evaluation(const Function& f, const std::vector<DM>& arg) {
+    auto a = std::make_shared<std::vector<std::vector<double>>>();
+    auto r = std::make_shared<std::vector<std::vector<double>>>();
+    for (auto&& e : arg) a->push_back(e.nonzeros());
+    for (casadi_int i=0; i<f.n_out(); ++i) r->push_back(std::vector<double>(f.nnz_out(i)));
+    return [f, a, r]() {
+      std::vector<const double*> a1;
+      std::vector<double*> r1;
+      for (auto&& e : *a) a1.push_back(get_ptr(e));
+      for (auto&& e : *r) r1.push_back(get_ptr(e));
+      f(a1, r1);
+      return r->at(0).empty() ? 0. : r->at(0).front();
+    };
+  }
+
+  /// Two-dimensional Laplacian on an n-by-n grid, symmetric positive definite
+  DM laplacian(casadi_int n) {
+    std::vector<casadi_int> row, col;
+    std::vector<double> nz;
+    for (casadi_int i=0; i<n; ++i) {
+      for (casadi_int j=0; j<n; ++j) {
+        casadi_int k = i*n+j;
+        row.push_back(k); col.push_back(k); nz.push_back(4.);
+        if (j>0) {row.push_back(k); col.push_back(k-1); nz.push_back(-1.);}
+        if (j<n-1) {row.push_back(k); col.push_back(k+1); nz.push_back(-1.);}
+        if (i>0) {row.push_back(k); col.push_back(k-n); nz.push_back(-1.);}
+        if (i<n-1) {row.push_back(k); col.push_back(k+n); nz.push_back(-1.);}
+      }
+    }
+    return DM::triplet(row, col, nz, n*n, n*n);
+  }
+
+  /// Long scalar recursion, many small instructions
+  SX sx_chain(const SX& x, const SX& p, casadi_int n) {
+    SX y = x;
+    for (casadi_int k=0; k<n; ++k) {
+      casadi_int i = k % x.nnz(), j = (7*k+3) % x.nnz();
+      y(i) = y(i) + 0.01*sin(y(j))*p(i) - 0.001*y(i)*y(j);
+    }
+    return y;
+  }
+
+  /// Chained Rosenbrock function, sparse Hessian
+  template<typename M>
+  M rosenbrock(const M& x) {
+    casadi_int n = x.nnz();
+    M a = x(Slice(0, n-1)), b = x(Slice(1, n));
+    return sum1(100*sq(b-sq(a)) + sq(1-a));
+  }
+
+  /// Van der Pol oscillator, states x and control u
+  SX vdp(const SX& x, const SX& u) {
+    return vertcat((1-sq(x(1)))*x(0) - x(1) + u, x(0));
+  }
+
+  /// Optimal control of the Van der Pol oscillator by multiple shooting
+  MXDict vdp_ocp(casadi_int N, MX& lbw, MX& ubw) {
+    SX x = SX::sym("x", 2), u = SX::sym("u");
+    double T = 10, h = T/N/4;
+    // RK4 integrator, four steps per interval
+    SX xf = x, q = 0;
+    for (casadi_int k=0; k<4; ++k) {
+      SX k1 = vdp(xf, u), k2 = vdp(xf + h/2*k1, u);
+      SX k3 = vdp(xf + h/2*k2, u), k4 = vdp(xf + h*k3, u);
+      q += h*(sumsqr(xf) + sq(u));
+      xf += h/6*(k1 + 2*k2 + 2*k3 + k4);
+    }
+    Function F("F", {x, u}, {xf, q});
+    MX w = MX::sym("w", 3*N+2);
+    std::vector<MX> g;
+    MX J = 0;
+    for (casadi_int k=0; k<N; ++k) {
+      std::vector<MX> r = F(std::vector<MX>{w(Slice(3*k, 3*k+2)), w(3*k+2)});
+      g.push_back(r.at(0) - w(Slice(3*k+3, 3*k+5)));
+      J += r.at(1);
+    }
+    g.push_back(w(Slice(0, 2)) - MX(std::vector<double>{0, 1}));
+    std::vector<double> lb(3*N+2, -inf), ub(3*N+2, inf);
+    for (casadi_int k=0; k<N; ++k) {
+      lb[3*k+2] = -1;
+      ub[3*k+2] = 1;
+    }
+    lbw = MX(lb);
+    ubw = MX(ub);
+    return {{"x", w}, {"f", J}, {"g", vertcat(g)}};
+  }
+
+  /// Test function for code generation: the Jacobian of a chain
+  Function codegen_function() {
+    SX x = SX::sym("x", 20), p = SX::sym("p", 20);
+    SX y = sx_chain(x, p, 500);
+    return Function("bench_cg", {x, p}, {y, jacobian(y, x)});
+  }
+
+  /// All benchmarks, in order
+  std::vector<Benchmark> benchmarks() {
+    std::vector<Benchmark> b;
+
+    // Numerical evaluation of expression graphs
+    b.push_back({"sx_eval/chain", []() {
+      SX x = SX::sym("x", 100), p = SX::sym("p", 100);
+      Function f("f", {x, p}, {sx_chain(x, p, 20000)});
+      Random r;
+      return evaluation(f, {r.matrix(x.sparsity()), r.matrix(p.sparsity())});
+    }});
+    b.push_back({"sx_eval/chain_jacobian", []() {
+      SX x = SX::sym("x", 50), p = SX::sym("p", 50);
+      SX y = sx_chain(x, p, 2000);
+      Function f("f", {x, p}, {jacobian(y, x)});
+      Random r;
+      return evaluation(f, {r.matrix(x.sparsity()), r.matrix(p.sparsity())});
+    }});
+    b.push_back({"mx_eval/mtimes", []() {
+      MX A = MX::sym("A", 100, 100), v = MX::sym("v", 100);
+      MX y = v;
+      for (casadi_int k=0; k<10; ++k) y = tanh(mtimes(A, y));
+      Function f("f", {A, v}, {y});
+      Random r;
+      return evaluation(f, {r.matrix(A.sparsity()) / 100, r.matrix(v.sparsity())});
+    }});
+    b.push_back({"mx_eval/map", []() {
+      SX x = SX::sym("x", 10), p = SX::sym("p", 10);
+      Function g("g", {x, p}, {sx_chain(x, p, 200)});
+      MX X = MX::sym("X", 10, 1000), P = MX::sym("P", 10);
+      Function f("f", {X, P}, g.map(1000)(std::vector<MX>{X, repmat(P, 1, 1000)}));
+      Random r;
+      return evaluation(f, {r.matrix(X.sparsity()), r.matrix(P.sparsity())});
+    }});
+
+    // Construction of derivatives
+    b.push_back({"ad/sx_jacobian", []() {
+      SX x = SX::sym("x", 100), p = SX::sym("p", 100);
+      SX y = sx_chain(x, p, 5000);
+      return Workload([x, y]() {
+        Function f("f", {x}, {jacobian(y, x)});
+        return static_cast<double>(f.nnz_out(0));
+      });
+    }});
+    b.push_back({"ad/sx_hessian", []() {
+      SX x = SX::sym("x", 2000);
+      SX obj = rosenbrock(x);
+      return Workload([x, obj]() {
+        SX g;
+        Function f("f", {x}, {hessian(obj, x, g)});
+        return static_cast<double>(f.nnz_out(0));
+      });
+    }});
+    b.push_back({"ad/mx_jacobian", []() {
+      MX A = MX::sym("A", 30, 30), v = MX::sym("v", 30);
+      MX y = v;
+      for (casadi_int k=0; k<10; ++k) y = sin(mtimes(A, y));
+      return Workload([v, y]() {
+        Function f("f", {v}, {jacobian(y, v)});
+        return static_cast<double>(f.nnz_out(0));
+      });
+    }});
+
+    // Sparsity pattern operations
+    b.push_back({"sparsity/star_coloring", []() {
+      Sparsity H = laplacian(60).sparsity();
+      H = Sparsity::mtimes(H, H);
+      return Workload([H]() { return static_cast<double>(H.star_coloring().size2());});
+    }});
+    b.push_back({"sparsity/uni_coloring", []() {
+      Random r;
+      Sparsity J = Sparsity::band(2000, 5) + Sparsity::band(2000, -7);
+      for (casadi_int k=0; k<200; ++k) {
+        J = J + Sparsity::triplet(2000, 2000, {static_cast<casadi_int>(r()*2000)},
+                                 {static_cast<casadi_int>(r()*2000)});
+      }
+      return Workload([J]() { return static_cast<double>(J.uni_coloring().size2());});
+    }});
+    b.push_back({"sparsity/mtimes", []() {
+      Sparsity A = laplacian(100).sparsity();
+      return Workload([A]() { return static_cast<double>(Sparsity::mtimes(A, A).nnz());});
+    }});
+    b.push_back({"sparsity/jacobian_pattern", []() {
+      SX x = SX::sym("x", 500), p = SX::sym("p", 500);
+      SX y = sx_chain(x, p, 20000);
+      return Workload([x, p, y]() {
+        Function f("f", {x, p}, {y});
+        return static_cast<double>(f.sparsity_jac(0, 0).nnz());
+      });
+    }});
+
+    // Sparse linear solvers: numeric factorization and solve
+    for (std::string plugin : {"ldl", "qr"}) {
+      b.push_back({"linsol/" + plugin, [plugin]() {
+        DM A = laplacian(40);
+        Linsol ls("ls", plugin, A.sparsity());
+        ls.sfact(A);
+        auto x = std::make_shared<std::vector<double>>();
+        return Workload([ls, A, x]() {
+          *x = std::vector<double>(A.size1(), 1.);
+          ls.nfact(A.ptr());
+          ls.solve(A.ptr(), get_ptr(*x));
+          return x->front();
+        });
+      }});
+    }
+
+    // Quadratic programming
+    b.push_back({"conic/qrqp", []() {
+      casadi_int n = 100, m = 50;
+      Random r;
+      DM H = laplacian(10) + DM::eye(n);
+      DM A = r.matrix(Sparsity::band(n, 0) + Sparsity::band(n, 3))(Slice(0, m), Slice());
+      Function solver = conic("qp", "qrqp", SpDict{{"h", H.sparsity()}, {"a", A.sparsity()}},
+                              Dict{{"print_header", false}, {"print_iter", false}});
+      DMDict arg = {{"h", H}, {"a", A}, {"g", r.matrix(Sparsity::dense(n)) - 0.5},
+                    {"lba", -DM::ones(m)}, {"uba", DM::ones(m)},
+                    {"lbx", -0.1*DM::ones(n)}, {"ubx", 0.1*DM::ones(n)}};
+      return Workload([solver, arg]() {
+        return static_cast<double>(solver(arg).at("cost"));
+      });
+    }});
+
+    // Nonlinear programming: optimal control by multiple shooting
+    b.push_back({"nlpsol/sqpmethod_vdp_ocp", []() {
+      MX lbw, ubw;
+      MXDict nlp = vdp_ocp(40, lbw, ubw);
+      Function solver = nlpsol("solver", "sqpmethod", nlp,
+        Dict{{"qpsol", "qrqp"}, {"print_header", false}, {"print_iteration", false},
+             {"print_status", false}, {"print_time", false},
+             {"qpsol_options", Dict{{"print_header", false}, {"print_iter", false}}}});
+      DMDict arg = {{"lbx", evalf(lbw)}, {"ubx", evalf(ubw)}, {"lbg", 0}, {"ubg", 0}};
+      return Workload([solver, arg]() {
+        return static_cast<double>(solver(arg).at("f"));
+      });
+    }});
+
+    // Integrators
+    for (std::string plugin : {"cvodes", "rk"}) {
+      b.push_back({"integrator/" + plugin + "_vdp", [plugin]() {
+        SX x = SX::sym("x", 2), u = SX::sym("u");
+        SXDict dae = {{"x", x}, {"p", u}, {"ode", vdp(x, u)}};
+        Dict opts = {{"tf", 10}};
+        if (plugin=="rk") opts["number_of_finite_elements"] = 200;
+        Function F = integrator("F", plugin, dae, opts);
+        DMDict arg = {{"x0", DM(std::vector<double>{0, 1})}, {"p", 0.1}};
+        return Workload([F, arg]() {
+          return static_cast<double>(F(arg).at("xf")(0));
+        });
+      }});
+    }
+
+    // Code generation
+    b.push_back({"codegen/generate", []() {
+      Function f = codegen_function();
+      return Workload([f]() {
+        std::string fname = f.generate("bench_cg.c");
+        std::ifstream s(fname);
+        double sz = static_cast<double>(s.seekg(0, std::ios::end).tellg());
+        std::remove(fname.c_str());
+        return sz;
+      });
+    }});
+    b.push_back({"codegen/compile", []() {
+      Function f = codegen_function();
+      std::string fname = f.generate("bench_cg.c");
+      return Workload([fname]() {
+        Importer c(fname, "shell", Dict{{"cleanup", true}});
+        return static_cast<double>(c.has_function("bench_cg"));
+      });
+    }});
+
+    return b;
+  }
+
+  /// Run a benchmark
+  Result run(const Benchmark& b, double min_time) {
+    Result r;
+    r.name = b.name;
+    r.t_setup = r.t_min = r.t_median = r.t_mean = 0;
+    r.n_rep = 0;
+    try {
+      double t0 = now();
+      Workload w = b.setup();
+      r.t_setup = now() - t0;
+
+      // Warm-up, also determining the number of executions per sample
+      t0 = now();
+      volatile double sink = w();
+      double t1 = now() - t0;
+      casadi_int n_inner = t1>=1e-3 ? 1 : static_cast<casadi_int>(1e-3/std::max(t1, 1e-9));
+
+      // Collect samples
+      std::vector<double> t;
+      double t_total = 0;
+      while (t.size()<3 || t_total<min_time) {
+        t0 = now();
+        for (casadi_int k=0; k<n_inner; ++k) sink = w();
+        double dt = now() - t0;
+        t_total += dt;
+        t.push_back(dt/n_inner);
+      }
+      (void)sink;
+      r.n_rep = t.size()*n_inner;
+      std::sort(t.begin(), t.end());
+      r.t_min = t.front();
+      r.t_median = t.size() % 2 ? t[t.size()/2] : (t[t.size()/2-1] + t[t.size()/2])/2;
+      r.t_mean = 0;
+      for (double e : t) r.t_mean += e;
+      r.t_mean /= t.size();
+    } catch (std::exception& e) {
+      r.skipped = e.what();
+      // Only keep the first line of the error message
+      r.skipped = r.skipped.substr(0, r.skipped.find('\n'));
+    }
+    return r;
+  }
+
+  /// Escape a string for JSON
+  std::string json(const std::string& s) {
+    std::stringstream ss;
+    ss << '"';
+    for (char c : s) {
+      if (c=='"' || c=='\\') {
+        ss << '\\' << c;
+      } else if (static_cast<unsigned char>(c)<0x20) {
+        ss << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c)
+           << std::dec << std::setfill(' ');
+      } else {
+        ss << c;
+      }
+    }
+    ss << '"';
+    return ss.str();
+  }
+
+  /// Write the results as JSON
+  void write_json(std::ostream& s, const std::vector<Result>& res, double min_time) {
+    s << std::setprecision(9);
+    s << "{\"casadi_version\": " << json(CasadiMeta::version())
+      << ", \"min_time\": " << min_time << ", \"benchmarks\": [";
+    for (casadi_int i=0; i<res.size(); ++i) {
+      const Result& r = res[i];
+      s << (i==0 ? "\n" : ",\n") << "  {\"name\": " << json(r.name);
+      if (r.skipped.empty()) {
+        s << ", \"t_setup\": " << r.t_setup << ", \"n_rep\": " << r.n_rep
+          << ", \"t_min\": " << r.t_min << ", \"t_median\": " << r.t_median
+          << ", \"t_mean\": " << r.t_mean << "}";
+      } else {
+        s << ", \"skipped\": " << json(r.skipped) << "}";
+      }
+    }
+    s << "\n]}" << std::endl;
+  }
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  std::string filter, output;
+  double min_time = 0.5;
+  bool list = false;
+  for (int i=1; i<argc; ++i) {
+    std::string a = argv[i];
+    if (a=="--list") {
+      list = true;
+    } else if (a=="--filter" && i+1<argc) {
+      filter = argv[++i];
+    } else if (a=="--min-time" && i+1<argc) {
+      min_time = atof(argv[++i]);
+    } else if (a=="--output" && i+1<argc) {
+      output = argv[++i];
+    } else {
+      std::cerr << "Usage: " << argv[0] << " [--list] [--filter substring] "
+                << "[--min-time seconds] [--output file.json]" << std::endl;
+      return 1;
+    }
+  }
+
+  std::vector<Result> res;
+  for (auto&& b : benchmarks()) {
+    if (b.name.find(filter)==std::string::npos) continue;
+    if (list) {
+      std::cout << b.name << std::endl;
+      continue;
+    }
+    res.push_back(run(b, min_time));
+    const Result& r = res.back();
+    std::cout << std::left << std::setw(32) << r.name << std::right;
+    if (r.skipped.empty()) {
+      std::cout << " median " << std::setw(12) << r.t_median << " s, min "
+                << std::setw(12) << r.t_min << " s, " << std::setw(8) << r.n_rep << " reps, setup "
+                << r.t_setup << " s";
+    } else {
+      std::cout << " skipped: " << r.skipped;
+    }
+    std::cout << std::endl;
+  }
+
+  if (!output.empty()) {
+    std::ofstream s(output);
+    if (!s.good()) {
+      std::cerr << "Cannot open " << output << std::endl;
+      return 1;
+    }
+    write_json(s, res, min_time);
+  }
+  return 0;
+}
@@ -0,0 +1,371 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+/** \brief Concurrent evaluation stress test and benchmark of the plugins
+
+  Usage: casadi_stress [--list] [--filter substring] [--threads n] [--calls n]
+
+  Each case creates one Function, typically a plugin instance, and evaluates it once
+  for reference. The same Function is then called --calls times from each of --threads
+  threads at once, each call with its own buffers, and every result is compared with
+  the reference. This exercises the per-call memory objects and the serialization of
+  non-reentrant plugins, cf. Function::is_thread_safe. The throughput is compared with
+  the same number of calls made from a single thread.
+
+  Cases whose plugins are not available are skipped. The exit code is nonzero if any
+  call failed or returned a result different from the reference.
+*/
+
+#include <casadi/casadi.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+using namespace casadi;
+
+namespace {
+
+  /// Wall time in seconds
+  double now() {
+    return std::chrono::duration<double>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  /// A Function and the inputs it is called with
+  struct Instance {
+    Function f;
+    std::vector<DM> arg;
+  };
+
+  /// A case: name and setup, returning the instance
+  struct Case {
+    std::string name;
+    std::function<Instance()> setup;
+  };
+
+  /// Result of a case
+  struct Result {
+    std::string skipped;
+    bool thread_safe;
+    double t_serial, t_concurrent;
+    casadi_int n_fail, n_mismatch;
+    std::string error;
+  };
+
+  /// Skip a case if its plugin is not available
+  void require(bool available, const std::string& plugin) {
+    if (!available) throw CasadiException("Plugin '" + plugin + "' is not available");
+  }
+
+  /// Van der Pol oscillator, states x and parameter p
+  SX vdp(const SX& x, const SX& p) {
+    return vertcat((1-sq(x(1)))*x(0) - x(1) + p, x(0));
+  }
+
+  /// Two-dimensional Laplacian on an n-by-n grid, symmetric positive definite
+  DM laplacian(casadi_int n) {
+    std::vector<casadi_int> row, col;
+    std::vector<double> nz;
+    for (casadi_int i=0; i<n; ++i) {
+      for (casadi_int j=0; j<n; ++j) {
+        casadi_int k = i*n+j;
+        row.push_back(k); col.push_back(k); nz.push_back(4.);
+        if (j>0) {row.push_back(k); col.push_back(k-1); nz.push_back(-1.);}
+        if (j<n-1) {row.push_back(k); col.push_back(k+1); nz.push_back(-1.);}
+        if (i>0) {row.push_back(k); col.push_back(k-n); nz.push_back(-1.);}
+        if (i<n-1) {row.push_back(k); col.push_back(k+n); nz.push_back(-1.);}
+      }
+    }
+    return DM::triplet(row, col, nz, n*n, n*n);
+  }
+
+  /// Quadratic program as a Function of the linear cost
+  Instance qp(const std::string& plugin) {
+    require(has_conic(plugin), plugin);
+    casadi_int n = 25, m = 10;
+    DM H = laplacian(5) + DM::eye(n);
+    DM A = DM::zeros(m, n);
+    for (casadi_int i=0; i<m; ++i) {
+      A(i, i) = 1;
+      A(i, i+5) = -1;
+    }
+    Dict opts;
+    if (plugin=="qrqp") opts = {{"print_header", false}, {"print_iter", false}};
+    if (plugin=="qpoases") opts = {{"printLevel", "none"}};
+    Function solver = conic("solver", plugin, SpDict{{"h", H.sparsity()}, {"a", A.sparsity()}},
+                            opts);
+    MX g = MX::sym("g", n);
+    MXDict r = solver(MXDict{{"h", H}, {"a", A}, {"g", g}, {"lba", -DM::ones(m)},
+                             {"uba", DM::ones(m)}, {"lbx", -DM::ones(n)}, {"ubx", DM::ones(n)}});
+    std::vector<double> g0(n);
+    for (casadi_int i=0; i<n; ++i) g0[i] = std::sin(static_cast<double>(i));
+    return {Function("f", {g}, {r.at("x"), r.at("cost")}), {DM(g0)}};
+  }
+
+  /// Rosenbrock problem as a Function of the parameter
+  Instance nlp(const std::string& plugin) {
+    require(has_nlpsol(plugin), plugin);
+    SX x = SX::sym("x", 2), p = SX::sym("p");
+    SX x0 = x(0), x1 = x(1);
+    Dict opts;
+    if (plugin=="sqpmethod") {
+      opts = {{"qpsol", "qrqp"}, {"print_header", false}, {"print_iteration", false},
+              {"print_status", false}, {"print_time", false},
+              {"qpsol_options", Dict{{"print_header", false}, {"print_iter", false}}}};
+    } else if (plugin=="ipopt") {
+      opts = {{"print_time", false}, {"ipopt.print_level", 0}, {"ipopt.sb", "yes"}};
+    }
+    Function solver = nlpsol("solver", plugin,
+      SXDict{{"x", x}, {"p", p}, {"f", sq(1-x0) + 100*sq(x1-sq(x0))},
+             {"g", sq(x0) + sq(x1) - p}}, opts);
+    MX P = MX::sym("p");
+    MXDict r = solver(MXDict{{"x0", DM(std::vector<double>{-1, 1})}, {"p", P},
+                             {"lbg", -inf}, {"ubg", 0}});
+    return {Function("f", {P}, {r.at("x"), r.at("f")}), {DM(1.5)}};
+  }
+
+  /// Van der Pol oscillator, final state as a Function of the initial state
+  Instance integration(const std::string& plugin) {
+    require(has_integrator(plugin), plugin);
+    SX x = SX::sym("x", 2), p = SX::sym("p");
+    Dict opts = {{"tf", 5}};
+    if (plugin=="rk" || plugin=="collocation") opts["number_of_finite_elements"] = 100;
+    Function F = integrator("F", plugin, SXDict{{"x", x}, {"p", p}, {"ode", vdp(x, p)}},
+                            opts);
+    MX x0 = MX::sym("x0", 2);
+    MXDict r = F(MXDict{{"x0", x0}, {"p", 0.1}});
+    return {Function("f", {x0}, {r.at("xf")}), {DM(std::vector<double>{0, 1})}};
+  }
+
+  /// Nonlinear system x + exp(x) = p, componentwise
+  Instance root(const std::string& plugin) {
+    require(has_rootfinder(plugin), plugin);
+    SX x = SX::sym("x", 10), p = SX::sym("p", 10);
+    Function g("g", {x, p}, {x + exp(x) - p});
+    Function R = rootfinder("R", plugin, g);
+    MX P = MX::sym("p", 10);
+    std::vector<MX> r = R(std::vector<MX>{MX::zeros(10), P});
+    std::vector<double> p0(10);
+    for (casadi_int i=0; i<10; ++i) p0[i] = 1 + 0.1*i;
+    return {Function("f", {P}, {r.at(0)}), {DM(p0)}};
+  }
+
+  /// Sparse linear system as a Function of the right-hand side
+  Instance linear(const std::string& plugin) {
+    require(has_linsol(plugin), plugin);
+    DM A = laplacian(10);
+    MX b = MX::sym("b", A.size1());
+    return {Function("f", {b}, {solve(MX(A), b, plugin)}), {DM::ones(A.size1())}};
+  }
+
+  /// All cases, in order
+  std::vector<Case> cases() {
+    std::vector<Case> c;
+
+    // Expression graphs
+    c.push_back({"function/sx", []() {
+      SX x = SX::sym("x", 20);
+      SX y = x;
+      for (casadi_int k=0; k<200; ++k) {
+        SX yk = y(k % 20);
+        y = sin(y) + 0.1*yk*y;
+      }
+      Function f("f", {x}, {y, jacobian(sum1(y), x)});
+      return Instance{f, {DM::ones(20)}};
+    }});
+    c.push_back({"function/mx_map", []() {
+      SX x = SX::sym("x", 5);
+      Function g("g", {x}, {sin(x)*cos(x) + sumsqr(x)});
+      MX X = MX::sym("X", 5, 100);
+      return Instance{Function("f", {X}, g.map(100)(std::vector<MX>{X})), {DM::ones(5, 100)}};
+    }});
+
+    for (std::string plugin : {"ldl", "qr", "csparse", "lapacklu", "ma27"}) {
+      c.push_back({"linsol/" + plugin, [plugin]() { return linear(plugin);}});
+    }
+    for (std::string plugin : {"qrqp", "qpoases", "osqp", "hpmpc", "ooqp"}) {
+      c.push_back({"conic/" + plugin, [plugin]() { return qp(plugin);}});
+    }
+    for (std::string plugin : {"sqpmethod", "ipopt"}) {
+      c.push_back({"nlpsol/" + plugin, [plugin]() { return nlp(plugin);}});
+    }
+    for (std::string plugin : {"rk", "collocation", "cvodes", "idas"}) {
+      c.push_back({"integrator/" + plugin, [plugin]() { return integration(plugin);}});
+    }
+    for (std::string plugin : {"newton", "fast_newton", "kinsol"}) {
+      c.push_back({"rootfinder/" + plugin, [plugin]() { return root(plugin);}});
+    }
+    c.push_back({"interpolant/linear", []() {
+      std::vector<double> grid(50), values(50);
+      for (casadi_int i=0; i<50; ++i) {
+        grid[i] = i;
+        values[i] = std::sin(0.1*i);
+      }
+      Function F = interpolant("F", "linear", {grid}, values);
+      MX x = MX::sym("x", 1, 100);
+      std::vector<double> x0(100);
+      for (casadi_int i=0; i<100; ++i) x0[i] = 0.45*i;
+      return Instance{Function("f", {x}, F.map(100)(std::vector<MX>{x})), {DM(x0).T()}};
+    }});
+
+    return c;
+  }
+
+  /// Make n calls, comparing with the reference
+  void calls(const Instance& inst, const std::vector<std::vector<double>>& ref,
+             casadi_int n, std::atomic<casadi_int>& n_fail, std::atomic<casadi_int>& n_mismatch,
+             std::string& error) {
+    const Function& f = inst.f;
+    std::vector<std::vector<double>> a, r(f.n_out());
+    for (auto&& e : inst.arg) a.push_back(e.nonzeros());
+    std::vector<const double*> a1;
+    std::vector<double*> r1;
+    for (auto&& e : a) a1.push_back(get_ptr(e));
+    for (casadi_int i=0; i<f.n_out(); ++i) {
+      r[i].resize(f.nnz_out(i));
+      r1.push_back(get_ptr(r[i]));
+    }
+    for (casadi_int k=0; k<n; ++k) {
+      try {
+        f(a1, r1);
+      } catch (std::exception& e) {
+        if (n_fail++==0) error = e.what();
+        continue;
+      }
+      for (casadi_int i=0; i<r.size(); ++i) {
+        for (casadi_int j=0; j<r[i].size(); ++j) {
+          if (std::fabs(r[i][j]-ref[i][j])>1e-8*(1+std::fabs(ref[i][j]))) {
+            n_mismatch++;
+            i = r.size();
+            break;
+          }
+        }
+      }
+    }
+  }
+
+  /// Run a case
+  Result run(const Case& c, casadi_int n_threads, casadi_int n_calls) {
+    Result res;
+    res.thread_safe = false;
+    res.t_serial = res.t_concurrent = 0;
+    res.n_fail = res.n_mismatch = 0;
+    Instance inst;
+    std::vector<std::vector<double>> ref;
+    try {
+      inst = c.setup();
+      for (auto&& e : inst.f(inst.arg)) ref.push_back(e.nonzeros());
+    } catch (std::exception& e) {
+      res.skipped = e.what();
+      res.skipped = res.skipped.substr(0, res.skipped.find('\n'));
+      return res;
+    }
+    res.thread_safe = inst.f.is_thread_safe();
+    std::atomic<casadi_int> n_fail(0), n_mismatch(0);
+
+    // Same number of calls, from one thread
+    std::string error;
+    double t0 = now();
+    calls(inst, ref, n_threads*n_calls, n_fail, n_mismatch, error);
+    res.t_serial = now() - t0;
+
+    // From all threads at once
+    std::vector<std::string> errors(n_threads);
+    std::vector<std::thread> threads;
+    t0 = now();
+    for (casadi_int t=0; t<n_threads; ++t) {
+      threads.emplace_back([&, t]() {
+        calls(inst, ref, n_calls, n_fail, n_mismatch, errors[t]);
+      });
+    }
+    for (auto&& t : threads) t.join();
+    res.t_concurrent = now() - t0;
+
+    res.n_fail = n_fail;
+    res.n_mismatch = n_mismatch;
+    res.error = error;
+    for (auto&& e : errors) if (res.error.empty()) res.error = e;
+    return res;
+  }
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  std::string filter;
+  casadi_int n_threads = std::max<casadi_int>(2, std::thread::hardware_concurrency());
+  casadi_int n_calls = 50;
+  bool list = false;
+  for (int i=1; i<argc; ++i) {
+    std::string a = argv[i];
+    if (a=="--list") {
+      list = true;
+    } else if (a=="--filter" && i+1<argc) {
+      filter = argv[++i];
+    } else if (a=="--threads" && i+1<argc) {
+      n_threads = atoi(argv[++i]);
+    } else if (a=="--calls" && i+1<argc) {
+      n_calls = atoi(argv[++i]);
+    } else {
+      std::cerr << "Usage: " << argv[0] << " [--list] [--filter substring] "
+                << "[--threads n] [--calls n]" << std::endl;
+      return 1;
+    }
+  }
+
+  bool ok = true;
+  if (!list) {
+    std::cout << n_threads << " threads, " << n_calls << " calls each" << std::endl;
+  }
+  for (auto&& c : cases()) {
+    if (c.name.find(filter)==std::string::npos) continue;
+    if (list) {
+      std::cout << c.name << std::endl;
+      continue;
+    }
+    Result r = run(c, n_threads, n_calls);
+    std::cout << std::left << std::setw(24) << c.name << std::right;
+    if (!r.skipped.empty()) {
+      std::cout << " skipped: " << r.skipped << std::endl;
+      continue;
+    }
+    double n_total = static_cast<double>(n_threads*n_calls);
+    std::cout << (r.thread_safe ? " parallel  " : " serialized")
+              << std::setprecision(4) << " serial " << std::setw(10) << n_total/r.t_serial
+              << " calls/s, concurrent " << std::setw(10) << n_total/r.t_concurrent
+              << " calls/s, speedup " << std::setw(6) << r.t_serial/r.t_concurrent;
+    if (r.n_fail || r.n_mismatch) {
+      ok = false;
+      std::cout << ", " << r.n_fail << " failed, " << r.n_mismatch << " wrong";
+      if (!r.error.empty()) std::cout << ": " << r.error.substr(0, r.error.find('\n'));
+    }
+    std::cout << std::endl;
+  }
+  return ok ? 0 : 1;
+}
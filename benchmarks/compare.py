@@ -0,0 +1,72 @@
+#
+#     This file is part of CasADi.
+#
+#     CasADi -- A symbolic framework for dynamic optimization.
+#     Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+#                             K.U. Leuven. All rights reserved.
+#     Copyright (C) 2011-2014 Greg Horn
+#
+#     CasADi is free software; you can redistribute it and/or
+#     modify it under the terms of the GNU Lesser General Public
+#     License as published by the Free Software Foundation; either
+#     version 3 of the License, or (at your option) any later version.
+#
+#     CasADi is distributed in the hope that it will be useful,
+#     but WITHOUT ANY WARRANTY; without even the implied warranty of
+#     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+#     Lesser General Public License for more details.
+#
+#     You should have received a copy of the GNU Lesser General Public
+#     License along with CasADi; if not, write to the Free Software
+#     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+#
+#
+"""Compare two result files of casadi_benchmark
+
+Usage: python compare.py baseline.json current.json [--tolerance 0.1] [--key t_median]
+
+Prints the ratio current/baseline of each benchmark present in both files and exits
+with status 1 if any ratio exceeds 1+tolerance, so that it can be used to gate upgrades.
+"""
+from __future__ import print_function
+import argparse
+import json
+import sys
+
+parser = argparse.ArgumentParser(description="Compare two result files of casadi_benchmark")
+parser.add_argument("baseline")
+parser.add_argument("current")
+parser.add_argument("--tolerance", type=float, default=0.1,
+                    help="Allowed relative slowdown [default: 0.1]")
+parser.add_argument("--key", default="t_median", choices=["t_min", "t_median", "t_mean"],
+                    help="Timing that is compared [default: t_median]")
+args = parser.parse_args()
+
+def load(fname):
+  with open(fname) as f:
+    d = json.load(f)
+  return d["casadi_version"], dict((b["name"], b) for b in d["benchmarks"])
+
+v0, base = load(args.baseline)
+v1, cur = load(args.current)
+print("Baseline %s, current %s, comparing %s" % (v0, v1, args.key))
+
+failed = []
+for name in sorted(set(base) & set(cur)):
+  b, c = base[name], cur[name]
+  if args.key not in b or args.key not in c:
+    print("%-32s skipped" % name)
+    continue
+  ratio = c[args.key] / b[args.key]
+  flag = ""
+  if ratio > 1 + args.tolerance:
+    flag = "  SLOWER"
+    failed.append(name)
+  print("%-32s %12.4g s %12.4g s %8.3f%s" % (name, b[args.key], c[args.key], ratio, flag))
+
+for name in sorted(set(base) ^ set(cur)):
+  print("%-32s only in %s" % (name, args.baseline if name in base else args.current))
+
+if failed:
+  print("%d benchmark(s) slower than the tolerance of %g" % (len(failed), args.tolerance))
+  sys.exit(1)
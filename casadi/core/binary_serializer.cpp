@@ -0,0 +1,392 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#include "binary_serializer.hpp"
+#include "sx_function.hpp"
+#include "mx_function.hpp"
+#include "lazy_function.hpp"
+
+#include <cstring>
+#include <fstream>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // _WIN32
+
+using namespace std;
+
+namespace casadi {
+
+  // Start of a file
+  static const char binary_magic[] = "CSDBIN01";
+  // Byte order mark
+  static const int64_t binary_bom = 0x0102030405060708;
+  // Tag of a reference to a Function already written
+  static const casadi_int binary_ref = 'R';
+  // Tag of a Function that can be loaded on demand
+  static const casadi_int binary_lazy = 'L';
+
+  // 64-bit FNV-1a
+  static const uint64_t fnv_basis = 14695981039346656037ULL;
+  static uint64_t fnv(uint64_t h, const void* data, size_t n) {
+    const unsigned char* c = static_cast<const unsigned char*>(data);
+    for (size_t i=0; i<n; ++i) {
+      h ^= c[i];
+      h *= 1099511628211ULL;
+    }
+    return h;
+  }
+
+  namespace {
+    // Called Functions loaded in this process by content hash, weakly referenced
+    std::map<std::string, WeakRef> binary_cache;
+#ifdef CASADI_WITH_THREAD
+    std::mutex binary_cache_mtx;
+#endif // CASADI_WITH_THREAD
+  } // namespace
+
+  BinaryBuffer::BinaryBuffer(const std::string& fname) : data_(nullptr), size_(0), mapped_(false) {
+#ifndef _WIN32
+    // Map the file into memory
+    int fd = open(fname.c_str(), O_RDONLY);
+    casadi_assert(fd>=0, "Cannot open " + fname);
+    struct stat st;
+    if (fstat(fd, &st)==0 && st.st_size>0) {
+      void* m = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (m!=MAP_FAILED) {
+        data_ = static_cast<const char*>(m);
+        size_ = st.st_size;
+        mapped_ = true;
+      }
+    }
+    close(fd);
+    if (mapped_) return;
+#endif // _WIN32
+    // Read the whole file
+    std::ifstream in(fname, std::ios::binary);
+    casadi_assert(in.good(), "Cannot open " + fname);
+    copy_.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    data_ = copy_.data();
+    size_ = copy_.size();
+  }
+
+  BinaryBuffer::~BinaryBuffer() {
+#ifndef _WIN32
+    if (mapped_) munmap(const_cast<char*>(data_), size_);
+#endif // _WIN32
+  }
+
+  const casadi_int BinarySerializer::version;
+
+  BinarySerializer::BinarySerializer() {
+    write(binary_magic, 8, false);
+    pack(version);
+    pack(static_cast<casadi_int>(binary_bom));
+  }
+
+  void BinarySerializer::write(const void* data, size_t n, bool hash) {
+    data_.append(static_cast<const char*>(data), n);
+    if (hash && !hash_.empty()) hash_.back() = fnv(hash_.back(), data, n);
+  }
+
+  void BinarySerializer::patch(size_t pos, int64_t e) {
+    std::memcpy(&data_[pos], &e, sizeof(e));
+  }
+
+  void BinarySerializer::mix(uint64_t h) {
+    if (!hash_.empty()) hash_.back() = fnv(hash_.back(), &h, sizeof(h));
+  }
+
+  void BinarySerializer::pack(casadi_int e) {
+    int64_t v = e;
+    write(&v, sizeof(v));
+  }
+
+  void BinarySerializer::pack(double e) {
+    write(&e, sizeof(e));
+  }
+
+  void BinarySerializer::pack_raw(const void* data, size_t n) {
+    write(data, n);
+    static const char zeros[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    if (n % 8) write(zeros, 8 - n % 8);
+  }
+
+  void BinarySerializer::pack(const std::string& e) {
+    pack(static_cast<casadi_int>(e.size()));
+    pack_raw(e.data(), e.size());
+  }
+
+  void BinarySerializer::pack(const std::vector<casadi_int>& e) {
+    pack(static_cast<casadi_int>(e.size()));
+    if (sizeof(casadi_int)==sizeof(int64_t)) {
+      pack_raw(e.data(), e.size()*sizeof(int64_t));
+    } else {
+      for (casadi_int i : e) pack(i);
+    }
+  }
+
+  void BinarySerializer::pack(const std::vector<double>& e) {
+    pack(static_cast<casadi_int>(e.size()));
+    pack_raw(e.data(), e.size()*sizeof(double));
+  }
+
+  void BinarySerializer::pack(const Sparsity& e) {
+    pack(e.size1());
+    pack(e.size2());
+    pack(e.get_colind());
+    pack(e.get_row());
+  }
+
+  void BinarySerializer::pack(const Function& e) {
+    casadi_assert(!e.is_null(), "Cannot serialize null Function");
+    int64_t v[7];
+    // Reference to a Function already written, hashed by its content
+    auto it = functions_.find(e.get());
+    if (it!=functions_.end()) {
+      v[0] = binary_ref;
+      v[1] = it->second.first;
+      write(v, 2*sizeof(int64_t), false);
+      mix(it->second.second);
+      return;
+    }
+    // The Function written
+    if (hash_.empty()) {
+      hash_.push_back(fnv_basis);
+      e->serialize_binary(*this);
+      hash_.pop_back();
+      return;
+    }
+    // A called Function, patch hash and length when written
+    size_t pos = data_.size();
+    v[0] = binary_lazy;
+    v[1] = v[2] = 0;
+    v[3] = e.sz_arg();
+    v[4] = e.sz_res();
+    v[5] = e.sz_iw();
+    v[6] = e.sz_w();
+    write(v, sizeof(v), false);
+    size_t start = data_.size();
+    hash_.push_back(fnv_basis);
+    e->serialize_binary(*this);
+    uint64_t h = hash_.back();
+    hash_.pop_back();
+    patch(pos + sizeof(int64_t), static_cast<int64_t>(h));
+    patch(pos + 2*sizeof(int64_t), data_.size() - start);
+    functions_[e.get()] = std::make_pair(pos, h);
+    mix(h);
+  }
+
+  void BinarySerializer::pack_header(const FunctionInternal& f) {
+    pack(f.name());
+    pack(static_cast<casadi_int>(f.n_in_));
+    for (casadi_int i=0; i<f.n_in_; ++i) {
+      pack(f.name_in_[i]);
+      pack(f.sparsity_in_[i]);
+      pack(f.get_default_in(i));
+    }
+    pack(static_cast<casadi_int>(f.n_out_));
+    for (casadi_int i=0; i<f.n_out_; ++i) {
+      pack(f.name_out_[i]);
+      pack(f.sparsity_out_[i]);
+    }
+  }
+
+  BinaryDeserializer::BinaryDeserializer(const std::shared_ptr<const BinaryBuffer>& buf, bool lazy)
+    : buf_(buf), data_(buf->data()), size_(buf->size()), pos_(0), lazy_(lazy) {
+    casadi_assert(size_>=8 && std::memcmp(data_, binary_magic, 8)==0,
+      "Not a CasADi binary file");
+    pos_ = 8;
+    casadi_int v = unpack_int();
+    casadi_assert(v==BinarySerializer::version,
+      "Binary format version " + str(v) + " not supported, expected "
+      + str(BinarySerializer::version));
+    casadi_assert(static_cast<int64_t>(unpack_int())==binary_bom,
+      "Binary file was written on a platform with a different byte order");
+  }
+
+  BinaryDeserializer::BinaryDeserializer(const std::shared_ptr<const BinaryBuffer>& buf,
+                                         size_t pos, bool lazy)
+    : buf_(buf), data_(buf->data()), size_(buf->size()), pos_(pos), lazy_(lazy) {
+    casadi_assert(pos_<=size_ && pos_%8==0, "Corrupt binary file");
+  }
+
+  const char* BinaryDeserializer::unpack_raw(size_t n) {
+    size_t n_padded = 8*((n+7)/8);
+    casadi_assert(n_padded>=n && n_padded<=size_-pos_, "Binary file is truncated");
+    const char* ret = data_ + pos_;
+    pos_ += n_padded;
+    return ret;
+  }
+
+  casadi_int BinaryDeserializer::unpack_int() {
+    int64_t v;
+    std::memcpy(&v, unpack_raw(sizeof(v)), sizeof(v));
+    return v;
+  }
+
+  double BinaryDeserializer::unpack_double() {
+    double v;
+    std::memcpy(&v, unpack_raw(sizeof(v)), sizeof(v));
+    return v;
+  }
+
+  std::string BinaryDeserializer::unpack_string() {
+    casadi_int n = unpack_int();
+    casadi_assert(n>=0, "Corrupt binary file");
+    return std::string(unpack_raw(n), n);
+  }
+
+  std::vector<casadi_int> BinaryDeserializer::unpack_int_vector() {
+    casadi_int n = unpack_int();
+    casadi_assert(n>=0, "Corrupt binary file");
+    const int64_t* v = unpack_array<int64_t>(n);
+    return std::vector<casadi_int>(v, v+n);
+  }
+
+  std::vector<double> BinaryDeserializer::unpack_double_vector() {
+    casadi_int n = unpack_int();
+    casadi_assert(n>=0, "Corrupt binary file");
+    const double* v = unpack_array<double>(n);
+    return std::vector<double>(v, v+n);
+  }
+
+  Sparsity BinaryDeserializer::unpack_sparsity() {
+    casadi_int nrow = unpack_int();
+    casadi_int ncol = unpack_int();
+    std::vector<casadi_int> colind = unpack_int_vector();
+    std::vector<casadi_int> row = unpack_int_vector();
+    return Sparsity(nrow, ncol, colind, row);
+  }
+
+  Function BinaryDeserializer::unpack_function() {
+    size_t pos = pos_;
+    casadi_int tag = unpack_int();
+    Function ret;
+    switch (tag) {
+      case binary_ref:
+        {
+          casadi_int ref = unpack_int();
+          auto it = functions_.find(ref);
+          if (it!=functions_.end()) return it->second;
+          // Not read by this reader, e.g. when loading lazily
+          casadi_assert(ref>=8 && ref<pos, "Corrupt binary file");
+          size_t pos_ret = pos_;
+          pos_ = ref;
+          ret = unpack_function();
+          pos_ = pos_ret;
+          return ret;
+        }
+      case binary_lazy:
+        {
+          uint64_t h = static_cast<uint64_t>(unpack_int());
+          casadi_int n = unpack_int();
+          std::vector<casadi_int> sz(4);
+          for (casadi_int& e : sz) e = unpack_int();
+          size_t start = pos_;
+          casadi_assert(n>=0 && n%8==0 && n<=size_-start, "Corrupt binary file");
+          std::string key = str(h) + "_" + str(n);
+          {
+#ifdef CASADI_WITH_THREAD
+            std::lock_guard<std::mutex> lock(binary_cache_mtx);
+#endif // CASADI_WITH_THREAD
+            auto it = binary_cache.find(key);
+            if (it!=binary_cache.end() && it->second.alive()) {
+              ret = shared_cast<Function>(it->second.shared());
+            }
+          }
+          if (ret.is_null()) {
+            if (lazy_) {
+              unpack_int();
+              ret = LazyFunction::create(unpack_header(), sz, buf_, start);
+            } else {
+              ret = unpack_function();
+            }
+            casadi_assert(pos_<=start+n, "Corrupt binary file");
+#ifdef CASADI_WITH_THREAD
+            std::lock_guard<std::mutex> lock(binary_cache_mtx);
+#endif // CASADI_WITH_THREAD
+            binary_cache[key] = ret;
+          }
+          pos_ = start + n;
+        }
+        break;
+      case 'S':
+        ret = SXFunction::deserialize_binary(*this);
+        break;
+      case 'M':
+        ret = MXFunction::deserialize_binary(*this);
+        break;
+      default:
+        casadi_error("Corrupt binary file: Unknown Function type " + str(tag));
+    }
+    functions_[pos] = ret;
+    return ret;
+  }
+
+  BinaryDeserializer::Header BinaryDeserializer::unpack_header() {
+    Header h;
+    h.name = unpack_string();
+    casadi_int n_in = unpack_int();
+    casadi_assert(n_in>=0, "Corrupt binary file");
+    for (casadi_int i=0; i<n_in; ++i) {
+      h.name_in.push_back(unpack_string());
+      h.sp_in.push_back(unpack_sparsity());
+      h.default_in.push_back(unpack_double());
+    }
+    casadi_int n_out = unpack_int();
+    casadi_assert(n_out>=0, "Corrupt binary file");
+    for (casadi_int i=0; i<n_out; ++i) {
+      h.name_out.push_back(unpack_string());
+      h.sp_out.push_back(unpack_sparsity());
+    }
+    return h;
+  }
+
+  Dict BinaryDeserializer::Header::options() const {
+    for (double d : default_in) {
+      if (d!=0) return {{"default_in", default_in}};
+    }
+    return Dict();
+  }
+
+  void save_binary(const Function& f, const std::string& fname) {
+    BinarySerializer s;
+    s.pack(f);
+    std::ofstream out(fname, std::ios::binary);
+    casadi_assert(out.good(), "Cannot open " + fname);
+    out.write(s.data().data(), s.data().size());
+    casadi_assert(out.good(), "Failed to write " + fname);
+  }
+
+  Function load_binary(const std::string& fname, bool lazy) {
+    BinaryDeserializer s(std::make_shared<const BinaryBuffer>(fname), lazy);
+    return s.unpack_function();
+  }
+
+} // namespace casadi
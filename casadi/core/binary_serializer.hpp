@@ -0,0 +1,188 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#ifndef CASADI_BINARY_SERIALIZER_HPP
+#define CASADI_BINARY_SERIALIZER_HPP
+
+#include "function.hpp"
+
+#include <map>
+#include <memory>
+
+/// \cond INTERNAL
+
+namespace casadi {
+
+  /** \brief Contents of a file in memory, memory-mapped where supported */
+  class CASADI_EXPORT BinaryBuffer {
+  public:
+    /// Map or read a file
+    explicit BinaryBuffer(const std::string& fname);
+
+    /// Destructor, unmaps the file
+    ~BinaryBuffer();
+
+    /// Not copyable
+    BinaryBuffer(const BinaryBuffer&) = delete;
+    BinaryBuffer& operator=(const BinaryBuffer&) = delete;
+
+    /// Access the data
+    const char* data() const { return data_;}
+    size_t size() const { return size_;}
+
+  private:
+    const char* data_;
+    size_t size_;
+    bool mapped_;
+    std::vector<char> copy_;
+  };
+
+  /** \brief Writer of the binary Function format, cf. Function::save
+
+  All entries are 8-byte aligned and in host byte order: integers as int64, doubles
+  as IEEE 754, strings and arrays as an int64 length followed by the data, padded with
+  zeros. A file starts with the magic "CSDBIN01", the format version and a byte order
+  mark, followed by the record of the Function.
+
+  A Function called by another one is written where it is first used, as a record
+  tagged 'L' with its content hash, its length and its work vector sizes, such that a
+  reader can skip it and load it later. Further uses are written as a reference to
+  the position of that record. The content hash does not depend on the position in
+  the file, so that identical Functions in different files have the same hash.
+  */
+  class CASADI_EXPORT BinarySerializer {
+  public:
+    /// Constructor, writes the file header
+    BinarySerializer();
+
+    ///@{
+    /// Write an entry
+    void pack(casadi_int e);
+    void pack(double e);
+    void pack(const std::string& e);
+    void pack(const std::vector<casadi_int>& e);
+    void pack(const std::vector<double>& e);
+    void pack(const Sparsity& e);
+    void pack(const Function& e);
+    ///@}
+
+    /// Write raw data, padded to a multiple of 8 bytes
+    void pack_raw(const void* data, size_t n);
+
+    /// Write the header common to all Functions
+    void pack_header(const FunctionInternal& f);
+
+    /// Everything written
+    const std::string& data() const { return data_;}
+
+    /// Format version
+    static const casadi_int version = 1;
+  private:
+    // Append data, updating the content hash of the innermost Function if requested
+    void write(const void* data, size_t n, bool hash=true);
+    // Overwrite an integer written before
+    void patch(size_t pos, int64_t e);
+    // Mix a value into the innermost content hash
+    void mix(uint64_t h);
+    // File contents
+    std::string data_;
+    // Content hashes of the Functions being written, innermost last
+    std::vector<uint64_t> hash_;
+    // Functions already written: position of the record and content hash
+    std::map<const FunctionInternal*, std::pair<size_t, uint64_t> > functions_;
+  };
+
+  /** \brief Reader of the binary Function format, cf. Function::load
+
+  Reads without copying from a buffer in memory, typically a memory-mapped file.
+  Arrays are accessed in place. All reads are bounds checked.
+
+  Called Functions with the same content hash as a Function loaded before, and still
+  in use, are shared. With lazy loading, called Functions are returned as proxies
+  that keep a reference to the buffer and are only read on first use.
+  */
+  class CASADI_EXPORT BinaryDeserializer {
+  public:
+    /// Constructor, checks the file header
+    BinaryDeserializer(const std::shared_ptr<const BinaryBuffer>& buf, bool lazy=false);
+
+    /// Constructor, continue reading at a position of a checked buffer
+    BinaryDeserializer(const std::shared_ptr<const BinaryBuffer>& buf, size_t pos, bool lazy);
+
+    ///@{
+    /// Read an entry
+    casadi_int unpack_int();
+    double unpack_double();
+    std::string unpack_string();
+    std::vector<casadi_int> unpack_int_vector();
+    std::vector<double> unpack_double_vector();
+    Sparsity unpack_sparsity();
+    Function unpack_function();
+    ///@}
+
+    /// Access n raw elements of type T in place
+    template<typename T>
+    const T* unpack_array(size_t n) {
+      return reinterpret_cast<const T*>(unpack_raw(n*sizeof(T)));
+    }
+
+    /// Header common to all Functions
+    struct Header {
+      std::string name;
+      std::vector<std::string> name_in, name_out;
+      std::vector<Sparsity> sp_in, sp_out;
+      std::vector<double> default_in;
+      // Options for the default input values, if any is nonzero
+      Dict options() const;
+    };
+
+    /// Read the header common to all Functions
+    Header unpack_header();
+
+  private:
+    // Access n raw bytes, padded to a multiple of 8 bytes
+    const char* unpack_raw(size_t n);
+    // Buffer
+    std::shared_ptr<const BinaryBuffer> buf_;
+    const char* data_;
+    size_t size_, pos_;
+    // Return proxies for called Functions
+    bool lazy_;
+    // Functions already read, by position of the record
+    std::map<size_t, Function> functions_;
+  };
+
+  /// Write a Function to a file in the binary format
+  CASADI_EXPORT void save_binary(const Function& f, const std::string& fname);
+
+  /// Read a Function from a file in the binary format
+  CASADI_EXPORT Function load_binary(const std::string& fname, bool lazy);
+
+} // namespace casadi
+
+/// \endcond
+
+#endif // CASADI_BINARY_SERIALIZER_HPP
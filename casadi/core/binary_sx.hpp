@@ -41,7 +41,12 @@ class BinarySX : public SXNode {
 
     /** \brief  Constructor is private, use "create" below */
     BinarySX(unsigned char op, const SXElem& dep0, const SXElem& dep1) :
-        op_(op), dep0_(dep0), dep1_(dep1) {}
+        op_(op), dep0_(dep0), dep1_(dep1) {
+      unsigned int h0 = dep0.get()->hash(), h1 = dep1.get()->hash();
+      // Independent of the order of the arguments for commutative operations
+      if (operation_checker<CommChecker>(op_) && h1<h0) std::swap(h0, h1);
+      hash_ = hash_combine(hash_combine(op_, h0), h1);
+    }
 
   public:
 
@@ -78,6 +83,7 @@ class BinarySX : public SXNode {
 
     /** \brief Check if two nodes are equivalent up to a given depth */
     bool is_equal(const SXNode* node, casadi_int depth) const override {
+      if (node->hash()!=hash_) return false;
       const BinarySX* n = dynamic_cast<const BinarySX*>(node);
       if (n==nullptr) return false;
       if (n->op_ != op_) return false;
@@ -99,6 +105,9 @@ class BinarySX : public SXNode {
     /** \brief  Get the operation */
     casadi_int op() const override { return op_;}
 
+    /** \brief  Structural hash */
+    unsigned int hash() const override { return hash_;}
+
     /** \brief  Print expression */
     std::string print(const std::string& arg1, const std::string& arg2) const override {
       return casadi_math<double>::print(op_, arg1, arg2);
@@ -107,6 +116,9 @@ class BinarySX : public SXNode {
     /** \brief  The binary operation as an 1 byte integer (allows 256 values) */
     unsigned char op_;
 
+    /** \brief  Structural hash, stored in the padding after op_ */
+    unsigned int hash_;
+
     /** \brief  The dependencies of the node */
     SXElem dep0_, dep1_;
 };
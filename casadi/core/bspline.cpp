@@ -40,7 +40,9 @@ namespace casadi {
          "Specifies, for each grid dimenion, the lookup algorithm used to find the correct index. "
          "'linear' uses a for-loop + break; (default when #knots<=100), "
          "'exact' uses floored division (only for uniform grids), "
-         "'binary' uses a binary search. (default when #knots>100)."}}
+         "'binary' uses a binary search. (default when #knots>100), "
+         "'hunt' searches outward from the interval found in the previous call, "
+         "'table' uses a precomputed index table (for non-uniform grids)."}}
       }
   };
 
@@ -61,6 +63,7 @@ namespace casadi {
       offset_, degree_, degree_);
 
     casadi_int n_dims = degree_.size();
+    batch_lookup_mode_ = Interpolant::batch_lookup_mode(lookup_mode_, n_dims);
 
     casadi_int k;
     for (k=0;k<n_dims-1;++k) {
@@ -87,6 +90,31 @@ namespace casadi {
   }
 
 
+  void* BSplineCommon::alloc_mem() const {
+    return new LookupMemory();
+  }
+
+  int BSplineCommon::init_mem(void* mem) const {
+    static_cast<LookupMemory*>(mem)->hint.assign(degree_.size(), 0);
+    return 0;
+  }
+
+  void BSplineCommon::free_mem(void *mem) const {
+    delete static_cast<LookupMemory*>(mem);
+  }
+
+  void BSplineCommon::get_hint(void* mem, casadi_int* iw) const {
+    // casadi_nd_boor_eval keeps the start intervals after boor_offset
+    auto m = static_cast<LookupMemory*>(mem);
+    copy(m->hint.begin(), m->hint.end(), iw+degree_.size()+1);
+  }
+
+  void BSplineCommon::set_hint(void* mem, const casadi_int* iw) const {
+    auto m = static_cast<LookupMemory*>(mem);
+    iw += degree_.size()+1;
+    copy(iw, iw+degree_.size(), m->hint.begin());
+  }
+
   void BSplineCommon::from_knots(const std::vector< std::vector<double> >& knots,
     std::vector<casadi_int>& offset, std::vector<double>& stacked) {
 
@@ -141,9 +169,11 @@ namespace casadi {
       if (!res[0]) return 0;
 
       casadi_fill(res[0], m_, 0.0);
+      get_hint(mem, iw);
       casadi_nd_boor_eval(res[0], degree_.size(), get_ptr(knots_), get_ptr(offset_),
         get_ptr(degree_), get_ptr(strides_), get_ptr(coeffs_), m_, arg[0], get_ptr(lookup_mode_),
         false, iw, w);
+      set_hint(mem, iw);
       return 0;
     }
 
@@ -161,6 +191,41 @@ namespace casadi {
         <<  g.constant(lookup_mode_) << ", 0, iw, w);\n";
     }
 
+    int BSpline::eval_batch(const double** arg, double** res, casadi_int* iw, double* w,
+                            void* mem, casadi_int n) const {
+      if (!res[0]) return 0;
+      casadi_int n_dims = degree_.size();
+
+      casadi_fill(res[0], n*m_, 0.0);
+      get_hint(mem, iw);
+      for (casadi_int k=0; k<n; ++k) {
+        casadi_nd_boor_eval(res[0]+k*m_, n_dims, get_ptr(knots_), get_ptr(offset_),
+          get_ptr(degree_), get_ptr(strides_), get_ptr(coeffs_), m_,
+          arg[0]+k*n_dims, get_ptr(batch_lookup_mode_), false, iw, w);
+      }
+      set_hint(mem, iw);
+      return 0;
+    }
+
+    void BSpline::codegen_body_batch(CodeGenerator& g, casadi_int n, const std::string& nb,
+                                     const std::string& arg, const std::string& res,
+                                     const std::string& w) const {
+      casadi_int n_dims = offset_.size()-1;
+
+      g.add_auxiliary(CodeGenerator::AUX_ND_BOOR_EVAL);
+      g.add_auxiliary(CodeGenerator::AUX_FILL);
+      g << "if (" << res << "[0]) {\n"
+        << "for (k=0; k<" << nb << "; ++k) {\n"
+        << g.fill(res + "[0]+k*" + str(m_), m_, "0.0") << "\n"
+        << "CASADI_PREFIX(nd_boor_eval)(" << res << "[0]+k*" << m_ << "," << n_dims << ","
+        << g.constant(knots_) << "," << g.constant(offset_) << "," <<  g.constant(degree_)
+        << "," << g.constant(strides_) << "," <<  g.constant(coeffs_) << "," << m_ << ","
+        << arg << "[0]+k*" << n_dims << "," << g.constant(batch_lookup_mode_) << ", 0, iw, "
+        << w << ");\n"
+        << "}\n"
+        << "}\n";
+    }
+
     Function BSpline::get_forward(casadi_int nfwd, const std::string& name,
                   const std::vector<std::string>& inames,
                   const std::vector<std::string>& onames,
@@ -218,7 +283,8 @@ namespace casadi {
           }
         }
         Dict opts;
-        opts["lookup_mode"] = Interpolant::lookup_mode_from_enum(lookup_mode_);
+        opts["lookup_mode"] = Interpolant::lookup_mode_from_enum(
+          std::vector<casadi_int>(lookup_mode_.begin(), lookup_mode_.begin()+n_dims));
         Function d = Function::bspline("jac_helper", knots, derivative_coeff(k), degree, m_, opts);
         parts.push_back(d(std::vector<MX>{x})[0]);
       }
@@ -317,11 +383,13 @@ namespace casadi {
 
       casadi_int n_dims = degree_.size();
 
+      get_hint(mem, iw);
       for (casadi_int i=0;i<N_;++i) {
         casadi_nd_boor_eval(res[0]+(reverse_? 0 : i*m_), n_dims, get_ptr(knots_), get_ptr(offset_),
         get_ptr(degree_), get_ptr(strides_), arg[0]+(reverse_? i*m_ : 0), m_, get_ptr(x_)+i*n_dims,
-        get_ptr(lookup_mode_), reverse_, iw, w);
+        get_ptr(batch_lookup_mode_), reverse_, iw, w);
       }
+      set_hint(mem, iw);
       return 0;
     }
 
@@ -339,8 +407,8 @@ namespace casadi {
         << (reverse_? "" : "+i*" + str(m_)) << "," << n_dims << "," << g.constant(knots_)
         << "," << g.constant(offset_) << "," <<  g.constant(degree_)
         << "," << g.constant(strides_) << ",arg[0]" << (reverse_? "i*" + str(m_) : "")
-        << "," << m_  << "," << g.constant(x_) <<"+i*" << n_dims << "," <<  g.constant(lookup_mode_)
-        << ", 0, iw, w);\n";
+        << "," << m_  << "," << g.constant(x_) <<"+i*" << n_dims << ","
+        <<  g.constant(batch_lookup_mode_) << ", 0, iw, w);\n";
     }
 
     Function BSplineDual::get_forward(casadi_int nfwd, const std::string& name,
@@ -400,7 +468,9 @@ namespace casadi {
         casadi_int n_b = n_knots-degree-1;
 
         double x = all_x[k];
-        casadi_int L = casadi_low(x, knots+degree, n_knots-2*degree, lookup_mode[k]);
+        const casadi_int* table = lookup_mode[k]==4 ? lookup_mode + lookup_mode[n_dims+k] : 0;
+        casadi_int L = casadi_low(x, knots+degree, n_knots-2*degree, lookup_mode[k], table,
+                                  starts[k]);
 
         casadi_int start = L;
         if (start>n_b-degree-1) start = n_b-degree-1;
@@ -464,7 +534,7 @@ namespace casadi {
       for (casadi_int i=0;i<N_;++i) {
         nd_boor_eval_sp(res[0]+(reverse_? 0 : i*m_), n_dims, get_ptr(knots_), get_ptr(offset_),
           get_ptr(degree_), get_ptr(strides_), arg[0]+(reverse_? i*m_ : 0), m_,
-          get_ptr(x_)+i*n_dims, get_ptr(lookup_mode_), reverse_, iw, w);
+          get_ptr(x_)+i*n_dims, get_ptr(batch_lookup_mode_), reverse_, iw, w);
       }
       return 0;
     }
@@ -476,7 +546,7 @@ namespace casadi {
       for (casadi_int i=0;i<N_;++i) {
         nd_boor_eval_sp(arg[0]+(!reverse_? 0 : i*m_), n_dims, get_ptr(knots_), get_ptr(offset_),
           get_ptr(degree_), get_ptr(strides_), res[0]+(!reverse_? i*m_ : 0), m_,
-          get_ptr(x_)+i*n_dims, get_ptr(lookup_mode_), !reverse_, iw, w);
+          get_ptr(x_)+i*n_dims, get_ptr(batch_lookup_mode_), !reverse_, iw, w);
       }
       return 0;
     }
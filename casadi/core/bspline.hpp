@@ -55,10 +55,23 @@ namespace casadi {
     const Options& get_options() const override { return options_;}
     ///@}
 
+    /** \brief Create memory block */
+    void* alloc_mem() const override;
+
+    /** \brief Initalize memory block */
+    int init_mem(void* mem) const override;
+
+    /** \brief Free memory block */
+    void free_mem(void *mem) const override;
+
+    /// Restore and save the intervals from the previous call, used by lookup mode 'hunt'
+    void get_hint(void* mem, casadi_int* iw) const;
+    void set_hint(void* mem, const casadi_int* iw) const;
+
     static void from_knots(const std::vector< std::vector<double> >& knots,
       std::vector<casadi_int>& offset, std::vector<double>& stacked);
 
-    std::vector<casadi_int> lookup_mode_;
+    std::vector<casadi_int> lookup_mode_, batch_lookup_mode_;
     std::vector<double> knots_;
     std::vector<casadi_int> offset_;
     std::vector<casadi_int> degree_;
@@ -81,7 +94,7 @@ namespace casadi {
       const std::vector<casadi_int>& degree, casadi_int m);
 
     /** \brief  Destructor */
-    ~BSpline() override {}
+    ~BSpline() override { clear_mem();}
 
     /// @{
     /** \brief Sparsities of function inputs and outputs */
@@ -129,6 +142,16 @@ namespace casadi {
     void codegen_body(CodeGenerator& g) const override;
     void codegen_declarations(CodeGenerator& g) const override {};
 
+    ///@{
+    /** \brief Batched evaluation, each lookup starts from the interval of the previous point */
+    bool has_eval_batch() const override { return true;}
+    int eval_batch(const double** arg, double** res, casadi_int* iw, double* w,
+                   void* mem, casadi_int n) const override;
+    void codegen_body_batch(CodeGenerator& g, casadi_int n, const std::string& nb,
+                            const std::string& arg, const std::string& res,
+                            const std::string& w) const override;
+    ///@}
+
     std::string class_name() const override { return "BSpline"; }
 
     std::vector<double> coeffs_;
@@ -152,7 +175,7 @@ namespace casadi {
       const std::vector<casadi_int>& degree, casadi_int m, bool reverse);
 
     /** \brief  Destructor */
-    ~BSplineDual() override {}
+    ~BSplineDual() override { clear_mem();}
 
     ///@{
     /** \brief Number of function inputs and outputs */
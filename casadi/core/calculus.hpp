@@ -184,9 +184,15 @@ namespace casadi {
     OP_PRINTME,
     OP_LIFT,
 
-    OP_EINSTEIN
+    OP_EINSTEIN,
+
+    // Fused elementwise operations
+    OP_ELEMENTWISE,
+
+    // Discrete convolution
+    OP_CONVOLUTION
   };
-  #define NUM_BUILT_IN_OPS (OP_EINSTEIN+1)
+  #define NUM_BUILT_IN_OPS (OP_CONVOLUTION+1)
 
   #define OP_
 
@@ -1056,6 +1062,8 @@ namespace casadi {
     case OP_PRINTME:       return F<OP_PRINTME>::check;
     case OP_LIFT:          return F<OP_LIFT>::check;
     case OP_EINSTEIN:      return F<OP_EINSTEIN>::check;
+    case OP_ELEMENTWISE:   return F<OP_ELEMENTWISE>::check;
+    case OP_CONVOLUTION:   return F<OP_CONVOLUTION>::check;
     }
     return T();
   }
@@ -1576,6 +1584,8 @@ namespace casadi {
     case OP_PRINTME:        return "printme";
     case OP_LIFT:           return "lift";
     case OP_EINSTEIN:       return "einstein";
+    case OP_ELEMENTWISE:    return "elementwise";
+    case OP_CONVOLUTION:    return "convolution";
     }
     return nullptr;
   }
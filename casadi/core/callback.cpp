@@ -49,6 +49,7 @@ namespace casadi {
   }
 
   std::vector<DM> Callback::eval(const std::vector<DM>& arg) const {
+    if (has_eval_async()) return eval_await(eval_async(arg));
     return (*this)->FunctionInternal::eval_dm(arg);
   }
 
@@ -61,6 +62,84 @@ namespace casadi {
     return (*this)->FunctionInternal::eval_sx(arg, res, iw, w, mem);
   }
 
+  bool Callback::has_eval_batch() const {
+    return false;
+  }
+
+  std::vector<DM> Callback::eval_batch(const std::vector<DM>& arg, casadi_int n) const {
+    // Split up into points
+    std::vector<std::vector<DM> > argk(n, std::vector<DM>(arg.size()));
+    for (casadi_int i=0; i<arg.size(); ++i) {
+      std::vector<DM> arg_split = horzsplit(arg[i], size2_in(i));
+      for (casadi_int k=0; k<n; ++k) argk[k][i] = arg_split.at(k);
+    }
+    // Evaluate the points one by one, or start all before waiting for any
+    std::vector<std::vector<DM> > resk(n);
+    if (has_eval_async()) {
+      std::vector<casadi_int> handle;
+      std::string err;
+      try {
+        for (casadi_int k=0; k<n; ++k) handle.push_back(eval_async(argk[k]));
+      } catch (std::exception& ex) {
+        err = ex.what();
+      }
+      // Wait for all started evaluations, also after a failure
+      for (casadi_int k=0; k<handle.size(); ++k) {
+        try {
+          resk[k] = eval_await(handle[k]);
+        } catch (std::exception& ex) {
+          if (err.empty()) err = ex.what();
+        }
+      }
+      casadi_assert(err.empty(), err);
+    } else {
+      for (casadi_int k=0; k<n; ++k) resk[k] = eval(argk[k]);
+    }
+    // Concatenate the outputs
+    std::vector<DM> ret(n==0 ? 0 : resk[0].size());
+    for (casadi_int i=0; i<ret.size(); ++i) {
+      std::vector<DM> res_split(n);
+      for (casadi_int k=0; k<n; ++k) res_split[k] = resk[k].at(i);
+      ret[i] = horzcat(res_split);
+    }
+    return ret;
+  }
+
+  bool Callback::has_eval_async() const {
+    return false;
+  }
+
+  casadi_int Callback::eval_async(const std::vector<DM>& arg) const {
+    casadi_error("'eval_async' not defined for " + name());
+  }
+
+  std::vector<DM> Callback::eval_await(casadi_int handle) const {
+    casadi_error("'eval_await' not defined for " + name());
+  }
+
+  int Callback::eval_batch(const double** arg, double** res, casadi_int* iw, double* w,
+                           void* mem, casadi_int n) const {
+    // Stack the points side by side and redirect to the DM variant
+    std::vector<DM> argv(n_in());
+    for (casadi_int i=0; i<argv.size(); ++i) {
+      argv[i] = DM(repmat(sparsity_in(i), 1, n));
+      casadi_copy(arg[i], argv[i].nnz(), argv[i].ptr());
+    }
+    std::vector<DM> resv = eval_batch(argv, n);
+    casadi_assert(resv.size()==n_out(),
+      "Expected " + str(n_out()) + " outputs, got " + str(resv.size()) + ".");
+    for (casadi_int i=0; i<resv.size(); ++i) {
+      Sparsity sp = repmat(sparsity_out(i), 1, n);
+      if (resv[i].sparsity()!=sp) {
+        casadi_assert(resv[i].size()==sp.size(), "Shape mismatch for output " + str(i)
+                      + ": got " + resv[i].dim() + ", expected " + sp.dim() + ".");
+        resv[i] = project(resv[i], sp);
+      }
+      if (res[i]) casadi_copy(resv[i].ptr(), resv[i].nnz(), res[i]);
+    }
+    return 0;
+  }
+
   casadi_int Callback::get_n_in() {
     return (*this)->FunctionInternal::get_n_in();
   }
@@ -89,6 +168,22 @@ namespace casadi {
     return (*this)->FunctionInternal::uses_output();
   }
 
+  bool Callback::has_jacobian_sparsity() const {
+    return false;
+  }
+
+  Sparsity Callback::get_jacobian_sparsity() const {
+    return Sparsity();
+  }
+
+  bool Callback::has_jac_sparsity(casadi_int oind, casadi_int iind) const {
+    return (*this)->FunctionInternal::has_jac_sparsity(oind, iind);
+  }
+
+  Sparsity Callback::get_jac_sparsity(casadi_int oind, casadi_int iind, bool symmetric) const {
+    return (*this)->FunctionInternal::get_jac_sparsity(oind, iind, symmetric);
+  }
+
   bool Callback::has_jacobian() const {
     return (*this)->FunctionInternal::has_jacobian();
   }
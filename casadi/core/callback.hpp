@@ -92,6 +92,35 @@ namespace casadi {
                         casadi_int* iw, SXElem* w, void* mem) const;
 #endif // SWIG
 
+    ///@{
+    /** \brief Evaluate n points at once
+     * Input i holds the n points side by side, i.e. horzcat of n matrices with
+     * the sparsity of input i, and the outputs are returned likewise.
+     * Used by serial maps and finite differences if has_eval_batch returns true,
+     * so that a single call evaluates all points. The default implementation
+     * calls eval for each point, or eval_async for all points before eval_await.
+     */
+    virtual bool has_eval_batch() const;
+    virtual std::vector<DM> eval_batch(const std::vector<DM>& arg, casadi_int n) const;
+#ifndef SWIG
+    virtual int eval_batch(const double** arg, double** res, casadi_int* iw, double* w,
+                           void* mem, casadi_int n) const;
+#endif // SWIG
+    ///@}
+
+    ///@{
+    /** \brief Asynchronous evaluation, e.g. of remote models
+     * eval_async starts the evaluation of a point and returns a handle, eval_await
+     * blocks until the evaluation with that handle has finished and returns its
+     * outputs. If has_eval_async returns true, batched evaluation (serial maps,
+     * finite differences) starts all points before waiting for any of them, so
+     * that the latencies overlap, and eval defaults to starting and waiting.
+     */
+    virtual bool has_eval_async() const;
+    virtual casadi_int eval_async(const std::vector<DM>& arg) const;
+    virtual std::vector<DM> eval_await(casadi_int handle) const;
+    ///@}
+
    /** \brief Get the number of inputs
      * This function is called during construction.
      */
@@ -125,6 +154,28 @@ namespace casadi {
     /** \brief Do the derivative functions need nondifferentiated outputs? */
     virtual bool uses_output() const;
 
+    ///@{
+    /** \brief Return sparsity of the Jacobian of all outputs with respect to all inputs
+     * Dimensions numel_out-by-numel_in. Used to color the Jacobian, so that
+     * finite differences perturb structurally orthogonal inputs together.
+     * This function is called during construction.
+     */
+    virtual bool has_jacobian_sparsity() const;
+    virtual Sparsity get_jacobian_sparsity() const;
+    ///@}
+
+    ///@{
+    /** \brief Return sparsity of the Jacobian of output oind with respect to input iind
+     * Dimensions numel_out(oind)-by-numel_in(iind), an all-zero pattern declares
+     * that the output does not depend on the input. Blocks without a pattern
+     * are assumed dense, unless given by get_jacobian_sparsity.
+     * The pattern is requested when first needed and also used to
+     * propagate sparsity through calls to the Callback.
+     */
+    virtual bool has_jac_sparsity(casadi_int oind, casadi_int iind) const;
+    virtual Sparsity get_jac_sparsity(casadi_int oind, casadi_int iind, bool symmetric) const;
+    ///@}
+
     ///@{
     /** \brief Return Jacobian of all input elements with respect to all output elements */
     virtual bool has_jacobian() const;
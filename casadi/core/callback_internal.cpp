@@ -76,6 +76,20 @@ namespace casadi {
     // Initialize this
     casadi_assert(self_!=nullptr, "Callback object has been deleted");
     self_->init();
+
+    // User-provided Jacobian sparsity
+    try {
+      if (self_->has_jacobian_sparsity()) {
+        Sparsity sp = self_->get_jacobian_sparsity();
+        casadi_assert(sp.size1()==numel_out() && sp.size2()==numel_in(),
+                      "Jacobian sparsity has dimensions " + sp.dim() + ", expected "
+                      + str(numel_out()) + "-by-" + str(numel_in()));
+        set_jac_sparsity(sp);
+      }
+    } catch (std::exception& ex) {
+      casadi_error("Error calling \"get_jacobian_sparsity\" for object "
+                   + name_ + ":\n" + std::string(ex.what()));
+    }
   }
 
   void CallbackInternal::finalize(const Dict& opts) {
@@ -101,10 +115,35 @@ namespace casadi {
     TRY_CALL(eval, self_, arg);
   }
 
+  bool CallbackInternal::has_eval_batch() const {
+    // Asynchronous evaluation is overlapped in the default eval_batch
+    try {
+      casadi_assert(self_!=nullptr, "Callback object has been deleted");
+      return self_->has_eval_batch() || self_->has_eval_async();
+    } catch (std::exception& ex) {
+      casadi_error("Error calling \"has_eval_batch\" for object "
+                   + name_ + ":\n" + std::string(ex.what()));
+    }
+  }
+
+  int CallbackInternal::eval_batch(const double** arg, double** res, casadi_int* iw, double* w,
+                                   void* mem, casadi_int n) const {
+    TRY_CALL(eval_batch, self_, arg, res, iw, w, nullptr, n);
+  }
+
   bool CallbackInternal::uses_output() const {
     TRY_CALL(uses_output, self_);
   }
 
+  bool CallbackInternal::has_jac_sparsity(casadi_int oind, casadi_int iind) const {
+    TRY_CALL(has_jac_sparsity, self_, oind, iind);
+  }
+
+  Sparsity CallbackInternal::
+  get_jac_sparsity(casadi_int oind, casadi_int iind, bool symmetric) const {
+    TRY_CALL(get_jac_sparsity, self_, oind, iind, symmetric);
+  }
+
   bool CallbackInternal::has_jacobian() const {
     TRY_CALL(has_jacobian, self_);
   }
@@ -77,9 +77,23 @@ namespace casadi {
     /** \brief Evaluate with DM matrices */
     std::vector<DM> eval_dm(const std::vector<DM>& arg) const override;
 
+    ///@{
+    /** \brief Batched evaluation, if supplied */
+    bool has_eval_batch() const override;
+    bool prefer_eval_batch() const override { return has_eval_batch();}
+    int eval_batch(const double** arg, double** res, casadi_int* iw, double* w,
+                   void* mem, casadi_int n) const override;
+    ///@}
+
     /** \brief Do the derivative functions need nondifferentiated outputs? */
     bool uses_output() const override;
 
+    ///@{
+    /** \brief Sparsity of a Jacobian block, if supplied */
+    bool has_jac_sparsity(casadi_int oind, casadi_int iind) const override;
+    Sparsity get_jac_sparsity(casadi_int oind, casadi_int iind, bool symmetric) const override;
+    ///@}
+
     ///@{
     /** \brief Return Jacobian of all input elements with respect to all output elements */
     bool has_jacobian() const override;
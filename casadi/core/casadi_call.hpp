@@ -106,6 +106,11 @@ namespace casadi {
     /** \brief Get the operation */
     casadi_int op() const override { return OP_CALL;}
 
+    /** \brief Check if two nodes are equivalent up to a given depth */
+    bool is_equal(const MXNode* node, casadi_int depth) const override {
+      return sameOpAndDeps(node, depth) && node->which_function().get()==fcn_.get();
+    }
+
     /** \brief Get required length of arg field */
     size_t sz_arg() const override;
 
@@ -28,9 +28,13 @@
 
 #include <casadi/core/casadi_export.h>
 #include "exception.hpp"
+#include "casadi_types.hpp"
 
 #include <iostream>
 #include <fstream>
+#include <atomic>
+#include <chrono>
+#include <cmath>
 
 namespace casadi {
 
@@ -64,6 +68,46 @@ namespace casadi {
     }
   };
 
+  /**
+   * \brief Wall-clock deadline and cooperative cancellation of a call
+   *
+   * Started when a solver is called, cf. option "max_wall_time" and Function::cancel,
+   * and polled in the iteration loops of the solver. Polling is an atomic load and,
+   * only if a time limit was set, a read of the steady clock.
+   */
+  class CASADI_EXPORT Deadline {
+  public:
+    Deadline() : limited_(false), epoch_(nullptr), epoch0_(0) {}
+
+    /// Start a call, with a time limit in seconds (inf for none) and a cancellation counter
+    void start(double max_wall_time, const std::atomic<casadi_int>* epoch) {
+      limited_ = !std::isinf(max_wall_time);
+      if (limited_) {
+        t_end_ = std::chrono::steady_clock::now()
+          + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+              std::chrono::duration<double>(max_wall_time));
+      }
+      epoch_ = epoch;
+      epoch0_ = epoch ? epoch->load(std::memory_order_relaxed) : 0;
+    }
+
+    /// Has the call been cancelled since it started?
+    bool cancelled() const {
+      return epoch_ && epoch_->load(std::memory_order_relaxed)!=epoch0_;
+    }
+
+    /// Has the time limit passed or the call been cancelled?
+    bool expired() const {
+      return cancelled() || (limited_ && std::chrono::steady_clock::now()>=t_end_);
+    }
+
+  private:
+    bool limited_;
+    std::chrono::steady_clock::time_point t_end_;
+    const std::atomic<casadi_int>* epoch_;
+    casadi_int epoch0_;
+  };
+
    /// \endcond INTERNAL
 
 } // namespace casadi
@@ -24,23 +24,111 @@
 
 #include "casadi_common.hpp"
 #include "casadi_logger.hpp"
+#include "exception.hpp"
 
 #ifdef CASADI_WITH_THREAD
 #ifdef CASADI_WITH_THREAD_MINGW
+#include <mingw.thread.h>
 #include <mingw.mutex.h>
+#include <mingw.condition_variable.h>
 #else // CASADI_WITH_THREAD_MINGW
+#include <thread>
 #include <mutex>
+#include <condition_variable>
 #endif // CASADI_WITH_THREAD_MINGW
 #endif //CASADI_WITH_THREAD
 
+#include <ctime>
+
 namespace casadi {
 
 #ifdef CASADI_WITH_THREAD
   std::mutex mutex_logger;
+
+  namespace {
+    // Pending output of the asynchronous mode: text or a log record
+    struct LogNode {
+      LogNode* next;
+      bool is_record;
+      bool error;
+      std::string text;
+      Logger::Record record;
+    };
+
+    // Lock-free stack of pending output, newest first
+    std::atomic<LogNode*> log_head(nullptr);
+
+    // Asynchronous mode enabled
+    std::atomic<bool> log_async(false);
+
+    // Is the thread writing pending output, holding mutex_logger?
+    thread_local bool log_draining = false;
+
+    // Push pending output, lock-free
+    void log_push(LogNode* n) {
+      n->next = log_head.load(std::memory_order_relaxed);
+      while (!log_head.compare_exchange_weak(n->next, n, std::memory_order_release,
+                                             std::memory_order_relaxed)) {}
+    }
+
+    // Push text, unless empty
+    void log_push_text(std::string& text, bool error) {
+      if (text.empty()) return;
+      LogNode* n = new LogNode();
+      n->is_record = false;
+      n->error = error;
+      n->text.swap(text);
+      log_push(n);
+    }
+
+    // Output of a thread since its last complete line, handed over at thread exit
+    struct LogBuffer {
+      std::string text[2];
+      ~LogBuffer() {
+        log_push_text(text[0], false);
+        log_push_text(text[1], true);
+      }
+    };
+    thread_local LogBuffer log_buffer;
+
+    // Background thread writing the pending output
+    struct LogWriter {
+      std::thread thread;
+      std::mutex mtx;
+      std::condition_variable cv;
+      bool stop;
+      // Stop the thread and write everything
+      void finish() {
+        log_async.store(false);
+        {
+          std::lock_guard<std::mutex> lock(mtx);
+          stop = true;
+        }
+        cv.notify_one();
+        thread.join();
+        Logger::drain();
+      }
+      ~LogWriter() {
+        if (thread.joinable()) finish();
+      }
+    };
+    LogWriter& log_writer() {
+      static LogWriter instance;
+      return instance;
+    }
+  } // namespace
 #endif //CASADI_WITH_THREAD
 
   void Logger::WriteFunThreadSafe(const char* s, std::streamsize num, bool error) {
 #ifdef CASADI_WITH_THREAD
+    if (log_draining) return writeFun(s, num, error);
+    if (log_async.load(std::memory_order_relaxed)) {
+      // Collect until the end of the line, without locking
+      std::string& text = log_buffer.text[error];
+      text.append(s, num);
+      if (num>0 && s[num-1]=='\n') log_push_text(text, error);
+      return;
+    }
     std::lock_guard<std::mutex> lock(mutex_logger);
 #endif //CASADI_WITH_THREAD
     writeFun(s, num, error);
@@ -48,11 +136,121 @@ namespace casadi {
 
   void Logger::FlushThreadSafe(bool error) {
 #ifdef CASADI_WITH_THREAD
+    if (log_draining) return flush(error);
+    if (log_async.load(std::memory_order_relaxed)) {
+      // Hand over to the background thread
+      log_push_text(log_buffer.text[error], error);
+      return;
+    }
     std::lock_guard<std::mutex> lock(mutex_logger);
 #endif //CASADI_WITH_THREAD
     flush(error);
   }
 
+  void Logger::drain() {
+#ifdef CASADI_WITH_THREAD
+    if (log_draining) return;
+    std::lock_guard<std::mutex> lock(mutex_logger);
+    log_draining = true;
+    // Take all pending output, oldest first
+    LogNode* n = log_head.exchange(nullptr, std::memory_order_acquire);
+    LogNode* first = nullptr;
+    while (n) {
+      LogNode* next = n->next;
+      n->next = first;
+      first = n;
+      n = next;
+    }
+    // Write
+    bool written[2] = {false, false};
+    while (first) {
+      n = first;
+      first = n->next;
+      if (n->is_record) {
+        recordFun(n->record);
+      } else {
+        writeFun(n->text.data(), n->text.size(), n->error);
+        written[n->error] = true;
+      }
+      delete n;
+    }
+    if (written[0]) flush(false);
+    if (written[1]) flush(true);
+    log_draining = false;
+#endif //CASADI_WITH_THREAD
+  }
+
+  void Logger::set_async(bool async) {
+#ifdef CASADI_WITH_THREAD
+    LogWriter& w = log_writer();
+    if (async==w.thread.joinable()) return;
+    if (async) {
+      w.stop = false;
+      log_async.store(true);
+      w.thread = std::thread([&w]() {
+        std::unique_lock<std::mutex> lock(w.mtx);
+        while (!w.stop) {
+          lock.unlock();
+          drain();
+          lock.lock();
+          w.cv.wait_for(lock, std::chrono::milliseconds(10));
+        }
+      });
+    } else {
+      // Including the incomplete lines of the calling thread
+      log_push_text(log_buffer.text[0], false);
+      log_push_text(log_buffer.text[1], true);
+      w.finish();
+    }
+#else // CASADI_WITH_THREAD
+    if (async) casadi_error("Asynchronous output requires thread support");
+#endif //CASADI_WITH_THREAD
+  }
+
+  bool Logger::is_async() {
+#ifdef CASADI_WITH_THREAD
+    return log_async.load(std::memory_order_relaxed);
+#else // CASADI_WITH_THREAD
+    return false;
+#endif //CASADI_WITH_THREAD
+  }
+
+  void Logger::log(Level level, const std::string& where, const std::string& msg) {
+    Record r;
+    r.level = level;
+    r.time = std::chrono::system_clock::now();
+    r.where = where;
+    r.msg = msg;
+#ifdef CASADI_WITH_THREAD
+    if (log_async.load(std::memory_order_relaxed)) {
+      // Formatted by the background thread
+      LogNode* n = new LogNode();
+      n->is_record = true;
+      n->record = std::move(r);
+      log_push(n);
+      return;
+    }
+#endif //CASADI_WITH_THREAD
+    recordFun(r);
+  }
+
+  void Logger::recordDefault(const Record& r) {
+    static const char* tag[] = {"DEBUG", "MESSAGE", "WARNING", "ERROR"};
+    std::time_t time = std::chrono::system_clock::to_time_t(r.time);
+    char stamp[30];
+    strftime(stamp, 30, "%F %T", std::localtime(&time)); // NOLINT(runtime/threadsafe_fn)
+    std::string s = "CasADi - " + std::string(stamp) + " " + tag[r.level] + "(\"" + r.msg
+      + "\") [" + r.where + "]\n";
+    // Written and flushed at once, so that records do not interleave
+    bool error = r.level>=LOG_WARNING;
+    WriteFunThreadSafe(s.data(), s.size(), error);
+    FlushThreadSafe(error);
+  }
+
+  std::atomic<int> Logger::min_level(Logger::LOG_DEBUG);
+
+  void (*Logger::recordFun)(const Record& r) = Logger::recordDefault;
+
   void (*Logger::writeFun)(const char* s, std::streamsize num, bool error) =
     Logger::writeDefault;
 
@@ -31,6 +31,9 @@
 #include <iostream>
 #include <fstream>
 #include <cstdarg>
+#include <string>
+#include <atomic>
+#include <chrono>
 
 namespace casadi {
   /**
@@ -46,6 +49,46 @@ namespace casadi {
     Logger();
 
   public:
+    /// Severity of a log record
+    enum Level {LOG_DEBUG, LOG_INFO, LOG_WARNING, LOG_ERROR};
+
+    /// Structured log record, cf. casadi_message and casadi_warning
+    struct Record {
+      Level level;
+      std::chrono::system_clock::time_point time;
+      std::string where, msg;
+    };
+
+    /// Records below this level are dropped before the message is formatted [LOG_DEBUG]
+    static std::atomic<int> min_level;
+
+    /// Is a record of a given level logged?
+    static bool enabled(Level level) {
+      return level>=min_level.load(std::memory_order_relaxed);
+    }
+
+    /** \brief Log a record
+     * Passed to recordFun, from the background thread in asynchronous mode */
+    static void log(Level level, const std::string& where, const std::string& msg);
+
+    /// Handle a record, can be redefined
+    static void (*recordFun)(const Record& r);
+
+    /// By default, format the record to uout (info, debug) or uerr (warning, error)
+    static void recordDefault(const Record& r);
+
+    /** \brief Asynchronous output
+     * Output is collected per thread, without locking, until a newline or flush
+     * and written by a background thread, together with the log records.
+     * Requires thread support, disabling it writes all pending output */
+    static void set_async(bool async);
+
+    /// Is the output asynchronous?
+    static bool is_async();
+
+    /// Write all pending output of the asynchronous mode, from the calling thread
+    static void drain();
+
     /// Print warnings, can be redefined
     static void (*writeFun)(const char* s, std::streamsize num, bool error);
 
@@ -27,25 +27,104 @@
 #include "code_generator.hpp"
 #include "function_internal.hpp"
 #include <iomanip>
+#include <cctype>
+#include <algorithm>
+#include <functional>
 #include <casadi_runtime_str.h>
 
 using namespace std;
 namespace casadi {
 
+  namespace {
+    // Functions in math.h with a single precision variant, having an f-suffix
+    bool has_single(const string& fname) {
+      static const set<string> fnames = {"sin", "cos", "tan", "asin", "acos", "atan",
+        "sinh", "cosh", "tanh", "asinh", "acosh", "atanh", "exp", "log", "log10",
+        "log1p", "expm1", "sqrt", "floor", "ceil", "fmod", "fabs", "pow", "atan2",
+        "erf", "erfc", "hypot", "copysign", "fmin", "fmax", "round", "trunc"};
+      return fnames.count(fname)>0;
+    }
+
+    // Single precision version of a line of C code: f-suffixes for floating point
+    // literals and single precision math functions, string literals are left as is
+    string to_single(const string& line) {
+      auto is_ident = [](char c) { return isalnum(static_cast<unsigned char>(c)) || c=='_';};
+      string ret;
+      bool in_string = false;
+      for (size_t i=0; i<line.size(); ) {
+        char c = line[i];
+        if (in_string) {
+          ret += c;
+          if (c=='\\' && i+1<line.size()) ret += line[++i];
+          if (c=='"') in_string = false;
+          i++;
+        } else if (c=='"') {
+          in_string = true;
+          ret += c;
+          i++;
+        } else if (isalpha(static_cast<unsigned char>(c)) || c=='_') {
+          // Identifier
+          size_t j = i;
+          while (j<line.size() && is_ident(line[j])) j++;
+          string id = line.substr(i, j-i);
+          size_t k = j;
+          while (k<line.size() && line[k]==' ') k++;
+          ret += id;
+          if (k<line.size() && line[k]=='(' && has_single(id)) ret += 'f';
+          i = j;
+        } else if (isdigit(static_cast<unsigned char>(c))
+                   || (c=='.' && i+1<line.size() && isdigit(static_cast<unsigned char>(line[i+1])))) {
+          // Numeric literal
+          size_t j = i;
+          bool floating = false;
+          while (j<line.size() && isdigit(static_cast<unsigned char>(line[j]))) j++;
+          if (j<line.size() && line[j]=='.') {
+            floating = true;
+            j++;
+            while (j<line.size() && isdigit(static_cast<unsigned char>(line[j]))) j++;
+          }
+          if (j<line.size() && (line[j]=='e' || line[j]=='E')) {
+            size_t k = j+1;
+            if (k<line.size() && (line[k]=='+' || line[k]=='-')) k++;
+            if (k<line.size() && isdigit(static_cast<unsigned char>(line[k]))) {
+              floating = true;
+              j = k;
+              while (j<line.size() && isdigit(static_cast<unsigned char>(line[j]))) j++;
+            }
+          }
+          ret += line.substr(i, j-i);
+          // Literals with a suffix (or hexadecimal literals) are left as is
+          if (floating && !(j<line.size() && is_ident(line[j]))) ret += 'f';
+          while (j<line.size() && is_ident(line[j])) ret += line[j++];
+          i = j;
+        } else {
+          ret += c;
+          i++;
+        }
+      }
+      return ret;
+    }
+  } // namespace
+
   CodeGenerator::CodeGenerator(const string& name, const Dict& opts) {
     // Default options
     this->verbose = true;
     this->mex = false;
     this->cpp = false;
+    this->header_only = false;
+    this->split = 1;
     this->main = false;
     this->casadi_real = "double";
     this->casadi_int_type = CASADI_INT_TYPE_STR;
     this->codegen_scalars = false;
     this->with_header = false;
+    this->with_report = false;
     this->with_mem = false;
     this->with_export = true;
     this->with_import = false;
     this->include_math = true;
+    this->blas = false;
+    this->fixed_point = -1;
     avoid_stack_ = false;
     indent_ = 2;
 
@@ -57,6 +136,11 @@ namespace casadi {
         this->mex = e.second;
       } else if (e.first=="cpp") {
         this->cpp = e.second;
+      } else if (e.first=="header_only") {
+        this->header_only = e.second;
+      } else if (e.first=="split") {
+        this->split = e.second;
+        casadi_assert(this->split>=1, "Option 'split' must be positive");
       } else if (e.first=="main") {
         this->main = e.second;
       } else if (e.first=="casadi_real") {
@@ -67,6 +151,8 @@ namespace casadi {
         this->codegen_scalars = e.second;
       } else if (e.first=="with_header") {
         this->with_header = e.second;
+      } else if (e.first=="with_report") {
+        this->with_report = e.second;
       } else if (e.first=="with_mem") {
         this->with_mem = e.second;
       } else if (e.first=="with_export") {
@@ -80,11 +166,36 @@ namespace casadi {
         casadi_assert_dev(indent_>=0);
       } else if (e.first=="avoid_stack") {
         avoid_stack_ = e.second;
+      } else if (e.first=="blas") {
+        this->blas = e.second;
+      } else if (e.first=="fixed_point") {
+        this->fixed_point = e.second;
       } else {
         casadi_error("Unrecongnized option: " + str(e.first));
       }
     }
 
+    casadi_assert(!this->blas || this->casadi_real=="double" || this->casadi_real=="float",
+                  "Option 'blas' requires 'casadi_real' to be 'double' or 'float'");
+    if (this->fixed_point>=0) {
+      casadi_assert(this->casadi_real=="int16_t" || this->casadi_real=="int32_t",
+                    "Option 'fixed_point' requires 'casadi_real' to be 'int16_t' or 'int32_t'");
+      casadi_assert(this->fixed_point<(this->casadi_real=="int16_t" ? 15 : 31),
+                    "Option 'fixed_point': too many fractional bits for " + this->casadi_real);
+      casadi_assert(!this->blas && !this->main && !this->mex,
+                    "Option 'fixed_point' cannot be combined with 'blas', 'main' or 'mex'");
+    }
+
+    if (this->header_only) {
+      casadi_assert(!this->mex && !this->main && this->split==1 && !this->with_header,
+                    "Option 'header_only' cannot be combined with 'mex', 'main', 'split' "
+                    "or 'with_header'");
+      // Everything is defined in the header, with internal linkage
+      this->cpp = true;
+      this->with_export = false;
+      this->with_import = false;
+    }
+
     // Start at new line with no indentation
     newline_ = true;
     current_indent_ = 0;
@@ -93,7 +204,7 @@ namespace casadi {
     string::size_type dotpos = name.rfind('.');
     if (dotpos==string::npos) {
       this->name = name;
-      this->suffix = this->cpp ? ".cpp" : ".c";
+      this->suffix = this->header_only ? ".hpp" : this->cpp ? ".cpp" : ".c";
     } else {
       this->name = name.substr(0, dotpos);
       this->suffix = name.substr(dotpos);
@@ -108,6 +219,7 @@ namespace casadi {
 
     // Includes needed
     if (this->include_math) add_include("math.h");
+    if (this->fixed_point>=0) add_include("stdint.h");
     if (this->main) add_include("stdio.h");
 
     // Mex and main need string.h
@@ -159,6 +271,9 @@ namespace casadi {
     // Flush to body
     flush(this->body);
 
+    // A translation unit may end here
+    body_splits_.push_back(this->body.tellp());
+
     return fname;
   }
 
@@ -171,6 +286,9 @@ namespace casadi {
           << "return " << codegen_name <<  "(arg, res, iw, w, mem);\n"
           << "}\n\n";
 
+    // Dimensions known at compile time and an entry point with fixed-size arguments
+    if (this->header_only) generate_typed(f);
+
     // Generate meta information
     f->codegen_meta(*this);
 
@@ -187,6 +305,63 @@ namespace casadi {
 
     // Add to list of exposed symbols
     this->exposed_fname.push_back(f.name());
+
+    // A translation unit may end here
+    body_splits_.push_back(this->body.tellp());
+  }
+
+  void CodeGenerator::generate_typed(const Function& f) {
+    string fname = f.name();
+    size_t sz_arg, sz_res, sz_iw, sz_w;
+    f.sz_work(sz_arg, sz_res, sz_iw, sz_w);
+
+    // Dimensions
+    *this << "struct " << fname << "_dims {\n"
+          << "static constexpr casadi_int n_in = " << f.n_in() << ";\n"
+          << "static constexpr casadi_int n_out = " << f.n_out() << ";\n";
+    for (casadi_int i=0; i<f.n_in(); ++i) {
+      *this << "static constexpr casadi_int size1_in" << i << " = " << f.size1_in(i) << ", "
+            << "size2_in" << i << " = " << f.size2_in(i) << ", "
+            << "nnz_in" << i << " = " << f.nnz_in(i) << ";\n";
+    }
+    for (casadi_int i=0; i<f.n_out(); ++i) {
+      *this << "static constexpr casadi_int size1_out" << i << " = " << f.size1_out(i) << ", "
+            << "size2_out" << i << " = " << f.size2_out(i) << ", "
+            << "nnz_out" << i << " = " << f.nnz_out(i) << ";\n";
+    }
+    *this << "static constexpr casadi_int sz_arg = " << sz_arg << ", sz_res = " << sz_res
+          << ", sz_iw = " << sz_iw << ", sz_w = " << sz_w << ";\n"
+          << "};\n\n";
+
+    // Arguments of fixed size, work vectors on the stack
+    *this << "inline int " << fname << "(";
+    for (casadi_int i=0; i<f.n_in(); ++i) {
+      *this << (i==0 ? "" : ", ") << "const casadi_real ";
+      if (f.nnz_in(i)==0) {
+        *this << "*arg" << i;
+      } else {
+        *this << "(&arg" << i << ")[" << f.nnz_in(i) << "]";
+      }
+    }
+    for (casadi_int i=0; i<f.n_out(); ++i) {
+      *this << (i+f.n_in()==0 ? "" : ", ") << "casadi_real ";
+      if (f.nnz_out(i)==0) {
+        *this << "*res" << i;
+      } else {
+        *this << "(&res" << i << ")[" << f.nnz_out(i) << "]";
+      }
+    }
+    *this << ") {\n"
+          << "const casadi_real* arg[" << max(sz_arg, size_t(1)) << "] = {";
+    for (casadi_int i=0; i<f.n_in(); ++i) *this << (i==0 ? "" : ", ") << "arg" << i;
+    *this << "};\n"
+          << "casadi_real* res[" << max(sz_res, size_t(1)) << "] = {";
+    for (casadi_int i=0; i<f.n_out(); ++i) *this << (i==0 ? "" : ", ") << "res" << i;
+    *this << "};\n"
+          << "casadi_int iw[" << max(sz_iw, size_t(1)) << "];\n"
+          << "casadi_real w[" << max(sz_w, size_t(1)) << "];\n"
+          << "return " << fname << "(arg, res, iw, w, 0);\n"
+          << "}\n\n";
   }
 
   string CodeGenerator::dump() const {
@@ -278,11 +453,49 @@ namespace casadi {
 
     // Create c file
     ofstream s;
-    string fullname = prefix + this->name + this->suffix;
+    vector<string> files = source_files(prefix);
+    string fullname = files.front();
     file_open(s, fullname);
 
-    // Dump code to file
-    dump(s);
+    if (this->split>1) {
+      // Declarations shared by all translation units
+      string internal_name = this->name + "_internal.h";
+      ofstream h;
+      file_open(h, prefix + internal_name);
+      dump_prelude(h);
+      h << "/* Functions defined in other translation units */\n";
+      for (auto&& e : added_functions_) {
+        h << e.f->signature(e.codegen_name) << ";\n";
+        if (e.f->has_refcount_) {
+          h << "void " << e.codegen_name << "_incref(void);\n"
+            << "void " << e.codegen_name << "_decref(void);\n";
+        }
+      }
+      for (auto&& e : exposed_fname) {
+        if (this->mex) {
+          h << "#ifdef MATLAB_MEX_FILE\n"
+            << "void mex_" << e
+            << "(int resc, mxArray *resv[], int argc, const mxArray *argv[]);\n"
+            << "#endif\n";
+        }
+        if (this->main) h << "casadi_int main_" << e << "(casadi_int argc, char* argv[]);\n";
+      }
+      h << endl;
+      file_close(h);
+
+      // Distribute the function bodies
+      vector<string> units = split_body();
+      s << "#include \"" << internal_name << "\"\n\n" << units.front() << endl;
+      for (casadi_int i=1; i<files.size(); ++i) {
+        ofstream u;
+        file_open(u, files[i]);
+        u << "#include \"" << internal_name << "\"\n\n" << units[i] << endl;
+        file_close(u);
+      }
+    } else {
+      // Dump code to file
+      dump(s);
+    }
 
     // Mex entry point
     if (this->mex) generate_mex(s);
@@ -313,9 +526,122 @@ namespace casadi {
       // Finalize file
       file_close(s);
     }
+
+    // Generate footprint report
+    if (this->with_report) {
+      s.open(prefix + this->name + "_report.json");
+      generate_report(s);
+      s.close();
+    }
     return fullname;
   }
 
+  // Write a generic type as JSON
+  static void report_json(std::ostream &s, const GenericType& v, casadi_int indent) {
+    if (v.is_dict()) {
+      const Dict& d = v.as_dict();
+      s << "{";
+      bool first = true;
+      for (auto&& e : d) {
+        s << (first ? "" : ",") << "\n" << std::string(indent+2, ' ') << "\"" << e.first
+          << "\": ";
+        report_json(s, e.second, indent+2);
+        first = false;
+      }
+      s << "\n" << std::string(indent, ' ') << "}";
+    } else if (v.is_string_vector()) {
+      s << "[";
+      const std::vector<std::string>& l = v.as_string_vector();
+      for (casadi_int i=0; i<l.size(); ++i) s << (i ? ", " : "") << "\"" << l[i] << "\"";
+      s << "]";
+    } else if (v.is_string()) {
+      s << "\"" << v.as_string() << "\"";
+    } else if (v.is_bool()) {
+      s << (v.as_bool() ? "true" : "false");
+    } else if (v.is_int()) {
+      s << v.as_int();
+    } else {
+      s << v.to_double();
+    }
+  }
+
+  void CodeGenerator::generate_report(std::ostream &s) const {
+    // Assumed type sizes
+    casadi_int sizeof_real = this->casadi_real=="float" || this->casadi_real=="int32_t" ? 4
+      : this->casadi_real=="int16_t" ? 2 : 8;
+    casadi_int sizeof_int = this->casadi_int_type=="int" ? 4 : 8;
+    casadi_int sizeof_ptr = sizeof(void*);
+
+    // Footprint of all generated functions
+    Dict functions;
+    std::map<std::string, Dict> fp;
+    for (auto&& e : added_functions_) {
+      Dict r = e.f->codegen_footprint(*this);
+      r["codegen_name"] = e.codegen_name;
+      fp[e.f.name()] = r;
+    }
+
+    // Worst-case stack of local variables, including the called functions
+    std::map<std::string, casadi_int> stack;
+    std::function<casadi_int(const std::string&, casadi_int)> worst_stack
+      = [&](const std::string& fname, casadi_int depth) -> casadi_int {
+      auto it = stack.find(fname);
+      if (it!=stack.end()) return it->second;
+      casadi_assert(depth<=fp.size(), "Recursive calls in generated code");
+      const Dict& r = fp.at(fname);
+      casadi_int ret = 0;
+      if (r.count("calls")) {
+        for (auto&& c : r.at("calls").as_string_vector()) {
+          if (fp.count(c)) ret = std::max(ret, worst_stack(c, depth+1));
+        }
+      }
+      ret += r.at("stack_real").as_int()*sizeof_real;
+      return stack[fname] = ret;
+    };
+
+    for (auto&& e : fp) {
+      Dict r = e.second;
+      r["stack_bytes"] = worst_stack(e.first, 0);
+      r["work_bytes"] = (r.at("sz_arg").as_int() + r.at("sz_res").as_int())*sizeof_ptr
+        + r.at("sz_iw").as_int()*sizeof_int + r.at("sz_w").as_int()*sizeof_real;
+      functions[e.first] = r;
+    }
+
+    Dict report = {{"casadi_real", this->casadi_real}, {"casadi_int", this->casadi_int_type},
+                   {"sizeof_real", sizeof_real}, {"sizeof_int", sizeof_int},
+                   {"sizeof_pointer", sizeof_ptr}, {"avoid_stack", avoid_stack_},
+                   {"exposed", exposed_fname}, {"functions", functions}};
+    report_json(s, report, 0);
+    s << endl;
+  }
+
+  std::vector<std::string> CodeGenerator::source_files(const std::string& prefix) const {
+    vector<string> ret(1, prefix + this->name + this->suffix);
+    for (casadi_int i=1; i<this->split; ++i) {
+      ret.push_back(prefix + this->name + "_" + str(i) + this->suffix);
+    }
+    return ret;
+  }
+
+  std::vector<std::string> CodeGenerator::split_body() const {
+    string b = this->body.str();
+    vector<string> ret(this->split);
+    // Fill the translation units one after the other, in whole functions
+    size_t target = b.size()/this->split + 1, start = 0;
+    casadi_int unit = 0;
+    for (auto&& e : body_splits_) {
+      size_t end = static_cast<size_t>(e);
+      if (end-start>=target || end==b.size()) {
+        ret[unit] += b.substr(start, end-start);
+        start = end;
+        if (unit+1<this->split) unit++;
+      }
+    }
+    // Anything not followed by a split point
+    ret[unit] += b.substr(start);
+    return ret;
+  }
+
   void CodeGenerator::generate_mex(std::ostream &s) const {
     // Begin conditional compilation
     s << "#ifdef MATLAB_MEX_FILE\n";
@@ -382,6 +708,37 @@ namespace casadi {
   }
 
   void CodeGenerator::dump(std::ostream& s) const {
+    // Include guard around the code, the internal macros do not leak out
+    string guard = this->name + "_HPP";
+    transform(guard.begin(), guard.end(), guard.begin(), ::toupper);
+    if (this->header_only) {
+      s << "#ifndef " << guard << "\n"
+        << "#define " << guard << "\n\n";
+    }
+
+    // Everything preceding the function bodies
+    dump_prelude(s);
+
+    // Codegen body
+    s << this->body.str();
+
+    // End with new line
+    s << endl;
+
+    if (this->header_only) {
+      s << "} // namespace\n\n"
+        << "#ifdef __GNUC__\n"
+        << "#pragma GCC diagnostic pop\n"
+        << "#endif\n\n";
+      for (auto&& i : added_shorthands_) s << "#undef casadi_" << i << "\n";
+      s << "#undef CASADI_PREFIX\n"
+        << "#undef NAMESPACE_CONCAT\n"
+        << "#undef _NAMESPACE_CONCAT\n\n"
+        << "#endif // " << guard << "\n";
+    }
+  }
+
+  void CodeGenerator::dump_prelude(std::ostream& s) const {
     // Consistency check
     casadi_assert_dev(current_indent_ == 0);
 
@@ -398,6 +755,15 @@ namespace casadi {
     s << this->includes.str();
     s << endl;
 
+    // Internal linkage for all definitions in a header
+    if (this->header_only) {
+      s << "#ifdef __GNUC__\n"
+        << "#pragma GCC diagnostic push\n"
+        << "#pragma GCC diagnostic ignored \"-Wunused-function\"\n"
+        << "#endif\n\n"
+        << "namespace {\n\n";
+    }
+
     // Real type (usually double)
     generate_casadi_real(s);
 
@@ -442,12 +808,6 @@ namespace casadi {
 
     // Codegen auxiliary functions
     s << this->auxiliaries.str();
-
-    // Codegen body
-    s << this->body.str();
-
-    // End with new line
-    s << endl;
   }
 
   string CodeGenerator::work(casadi_int n, casadi_int sz) const {
@@ -488,11 +848,29 @@ namespace casadi {
   }
 
   void CodeGenerator::print_vector(std::ostream &s, const string& name,
-                                  const vector<double>& v) {
+                                  const vector<double>& v) const {
     s << array("static const casadi_real", name, v.size(), initializer(v));
   }
 
   std::string CodeGenerator::print_op(casadi_int op, const std::string& a0) {
+    if (this->fixed_point>=0) {
+      // Fixed point: 1 is represented by 2^fixed_point
+      std::string one = str(casadi_int(1) << this->fixed_point);
+      switch (op) {
+        case OP_ASSIGN: return a0;
+        case OP_NEG: return "(-" + a0 + ")";
+        case OP_TWICE: return "(2*" + a0 + ")";
+        case OP_SQ:
+          add_auxiliary(AUX_QMUL);
+          return "casadi_qmul(" + a0 + "," + a0 + ")";
+        case OP_FABS: return "(" + a0 + "<0 ? -" + a0 + " : " + a0 + ")";
+        case OP_SIGN: return "(" + a0 + "<0 ? -" + one + " : " + a0 + ">0 ? " + one + " : 0)";
+        case OP_NOT: return "(" + a0 + "==0 ? " + one + " : 0)";
+        default:
+          casadi_error("Operation '" + casadi_math<double>::name(op)
+                       + "' is not supported with option 'fixed_point'");
+      }
+    }
     switch (op) {
       case OP_SQ:
         add_auxiliary(AUX_SQ);
@@ -501,10 +879,36 @@ namespace casadi {
         add_auxiliary(AUX_SIGN);
         return "casadi_sign("+a0+")";
       default:
+        if (this->casadi_real=="float") {
+          if (op==OP_TWICE) return "(2.f*"+a0+")";
+          if (op==OP_INV) return "(1.f/"+a0+")";
+          return to_single(casadi_math<double>::print(op, a0));
+        }
         return casadi_math<double>::print(op, a0);
     }
   }
   std::string CodeGenerator::print_op(casadi_int op, const std::string& a0, const std::string& a1) {
+    if (this->fixed_point>=0) {
+      std::string one = str(casadi_int(1) << this->fixed_point);
+      switch (op) {
+        case OP_ADD: return "(" + a0 + "+" + a1 + ")";
+        case OP_SUB: return "(" + a0 + "-" + a1 + ")";
+        case OP_MUL:
+          add_auxiliary(AUX_QMUL);
+          return "casadi_qmul(" + a0 + "," + a1 + ")";
+        case OP_DIV:
+          add_auxiliary(AUX_QDIV);
+          return "casadi_qdiv(" + a0 + "," + a1 + ")";
+        case OP_FMIN: return "(" + a0 + "<" + a1 + " ? " + a0 + " : " + a1 + ")";
+        case OP_FMAX: return "(" + a0 + ">" + a1 + " ? " + a0 + " : " + a1 + ")";
+        case OP_LT: case OP_LE: case OP_EQ: case OP_NE: case OP_AND: case OP_OR:
+          return "(" + a0 + casadi_math<double>::sep(op) + a1 + " ? " + one + " : 0)";
+        case OP_IF_ELSE_ZERO: return "(" + a0 + " ? " + a1 + " : 0)";
+        default:
+          casadi_error("Operation '" + casadi_math<double>::name(op)
+                       + "' is not supported with option 'fixed_point'");
+      }
+    }
     switch (op) {
       case OP_FMIN:
         add_auxiliary(AUX_FMIN);
@@ -513,6 +917,7 @@ namespace casadi {
         add_auxiliary(AUX_FMAX);
         return "casadi_fmax("+a0+","+a1+")";
       default:
+        if (this->casadi_real=="float") return to_single(casadi_math<double>::print(op, a0, a1));
         return casadi_math<double>::print(op, a0, a1);
     }
   }
@@ -658,6 +1063,19 @@ namespace casadi {
     }
     added_auxiliaries_.insert(make_pair(f, inst));
 
+    // With fixed point, only auxiliaries that do not calculate are available
+    if (this->fixed_point>=0) {
+      switch (f) {
+      case AUX_COPY: case AUX_SWAP: case AUX_FILL: case AUX_PROJECT: case AUX_DENSIFY:
+      case AUX_TRANS: case AUX_FLIP: case AUX_TO_INT: case AUX_CAST: case AUX_IF_ELSE:
+      case AUX_PRINTF: case AUX_QMUL: case AUX_QDIV:
+        break;
+      default:
+        casadi_error("Code generation with option 'fixed_point' is limited to "
+                     "scalar expressions (SXFunction), an auxiliary function was needed");
+      }
+    }
+
     // Add the appropriate function
     switch (f) {
     case AUX_COPY:
@@ -706,6 +1124,9 @@ namespace casadi {
       add_auxiliary(AUX_LOW);
       this->auxiliaries << sanitize_source(casadi_nd_boor_eval_str, inst);
       break;
+    case AUX_POLYVAL_ND:
+      this->auxiliaries << sanitize_source(casadi_polyval_nd_str, inst);
+      break;
     case AUX_FLIP:
       this->auxiliaries << sanitize_source(casadi_flip_str, inst);
       break;
@@ -736,11 +1157,18 @@ namespace casadi {
       this->auxiliaries << sanitize_source(casadi_mv_str, inst);
       break;
     case AUX_MV_DENSE:
+      add_auxiliary(AUX_DOT);
       this->auxiliaries << sanitize_source(casadi_mv_dense_str, inst);
       break;
     case AUX_MTIMES:
       this->auxiliaries << sanitize_source(casadi_mtimes_str, inst);
       break;
+    case AUX_MTIMES_DENSE:
+      this->auxiliaries << sanitize_source(casadi_mtimes_dense_str, inst);
+      break;
+    case AUX_CONV:
+      this->auxiliaries << sanitize_source(casadi_conv_str, inst);
+      break;
     case AUX_PROJECT:
       this->auxiliaries << sanitize_source(casadi_project_str, inst);
       break;
@@ -768,20 +1196,27 @@ namespace casadi {
                         << sanitize_source(casadi_from_mex_str, inst)
                         << "#endif\n\n";
       break;
+    case AUX_MEX:
+      add_auxiliary(AUX_FROM_MEX);
+      add_auxiliary(AUX_TO_DOUBLE);
+      this->auxiliaries << "#ifdef MATLAB_MEX_FILE\n"
+                        << sanitize_source(casadi_mex_str, inst)
+                        << "#endif\n\n";
+      break;
     case AUX_FINITE_DIFF:
       add_auxiliary(AUX_FMAX);
       this->auxiliaries << sanitize_source(casadi_finite_diff_str, inst);
       break;
     case AUX_QR:
       add_auxiliary(AUX_IF_ELSE);
-      add_auxiliary(AUX_SCAL);
-      add_auxiliary(AUX_DOT);
-      add_auxiliary(AUX_FILL);
       this->auxiliaries << sanitize_source(casadi_qr_str, inst);
       break;
     case AUX_LDL:
       this->auxiliaries << sanitize_source(casadi_ldl_str, inst);
       break;
+    case AUX_LDL_SUPER:
+      this->auxiliaries << sanitize_source(casadi_ldl_super_str, inst);
+      break;
     case AUX_NEWTON:
       add_auxiliary(AUX_COPY);
       add_auxiliary(AUX_AXPY);
@@ -789,6 +1224,72 @@ namespace casadi {
       add_auxiliary(AUX_QR);
       this->auxiliaries << sanitize_source(casadi_newton_str, inst);
       break;
+    case AUX_DOPRI:
+      add_auxiliary(AUX_COPY);
+      add_auxiliary(AUX_AXPY);
+      add_auxiliary(AUX_FMIN);
+      add_auxiliary(AUX_FMAX);
+      this->auxiliaries << sanitize_source(casadi_dopri_str, inst);
+      break;
+    case AUX_RICCATI:
+      add_auxiliary(AUX_COPY);
+      add_auxiliary(AUX_FILL);
+      add_auxiliary(AUX_AXPY);
+      add_auxiliary(AUX_DOT);
+      add_auxiliary(AUX_MV_DENSE);
+      add_auxiliary(AUX_FMIN);
+      add_auxiliary(AUX_FMAX);
+      this->auxiliaries << sanitize_source(casadi_riccati_str, inst);
+      break;
+    case AUX_IPQP:
+      add_auxiliary(AUX_COPY);
+      add_auxiliary(AUX_FILL);
+      add_auxiliary(AUX_AXPY);
+      add_auxiliary(AUX_DOT);
+      add_auxiliary(AUX_BILIN);
+      add_auxiliary(AUX_NORM_INF);
+      add_auxiliary(AUX_MV);
+      add_auxiliary(AUX_LDL);
+      add_auxiliary(AUX_FMIN);
+      add_auxiliary(AUX_FMAX);
+      this->auxiliaries << sanitize_source(casadi_ipqp_str, inst);
+      break;
+    case AUX_ADMM:
+      add_auxiliary(AUX_COPY);
+      add_auxiliary(AUX_FILL);
+      add_auxiliary(AUX_AXPY);
+      add_auxiliary(AUX_DOT);
+      add_auxiliary(AUX_BILIN);
+      add_auxiliary(AUX_NORM_INF);
+      add_auxiliary(AUX_MV);
+      add_auxiliary(AUX_LDL);
+      add_auxiliary(AUX_FMIN);
+      add_auxiliary(AUX_FMAX);
+      this->auxiliaries << sanitize_source(casadi_admm_str, inst);
+      break;
+    case AUX_GMRES:
+      add_auxiliary(AUX_FILL);
+      add_auxiliary(AUX_AXPY);
+      add_auxiliary(AUX_DOT);
+      add_auxiliary(AUX_SCAL);
+      add_auxiliary(AUX_NORM_2);
+      this->auxiliaries << sanitize_source(casadi_gmres_str, inst);
+      break;
+    case AUX_DPLE:
+      add_auxiliary(AUX_COPY);
+      add_auxiliary(AUX_FILL);
+      add_auxiliary(AUX_AXPY);
+      add_auxiliary(AUX_DOT);
+      add_auxiliary(AUX_MTIMES_DENSE);
+      this->auxiliaries << sanitize_source(casadi_dple_str, inst);
+      break;
+    case AUX_EXPM:
+      add_auxiliary(AUX_COPY);
+      add_auxiliary(AUX_FILL);
+      add_auxiliary(AUX_AXPY);
+      add_auxiliary(AUX_MTIMES_DENSE);
+      this->auxiliaries << sanitize_source(casadi_expm_str, inst);
+      break;
     case AUX_TO_DOUBLE:
       this->auxiliaries << "#define casadi_to_double(x) "
                         << "(" << (this->cpp ? "static_cast<double>(x)" : "(double) x") << ")\n\n";
@@ -835,7 +1336,8 @@ namespace casadi {
                         << "#if __STDC_VERSION__ < 199901L\n"
                         << "  return x<y ? x : y;\n"
                         << "#else\n"
-                        << "  return fmin(x, y);\n"
+                        << "  return " << (this->casadi_real=="float" ? "fminf" : "fmin")
+                        << "(x, y);\n"
                         << "#endif\n"
                         << "}\n\n";
       break;
@@ -846,10 +1348,23 @@ namespace casadi {
                         << "#if __STDC_VERSION__ < 199901L\n"
                         << "  return x>y ? x : y;\n"
                         << "#else\n"
-                        << "  return fmax(x, y);\n"
+                        << "  return " << (this->casadi_real=="float" ? "fmaxf" : "fmax")
+                        << "(x, y);\n"
                         << "#endif\n"
                         << "}\n\n";
       break;
+    case AUX_QMUL:
+      shorthand("qmul");
+      this->auxiliaries << "casadi_real casadi_qmul(casadi_real x, casadi_real y) "
+                        << "{ return (casadi_real) (((" << fixed_wide() << ") x*y) >> "
+                        << this->fixed_point << ");}\n\n";
+      break;
+    case AUX_QDIV:
+      shorthand("qdiv");
+      this->auxiliaries << "casadi_real casadi_qdiv(casadi_real x, casadi_real y) "
+                        << "{ return (casadi_real) (((" << fixed_wide() << ") x*"
+                        << (casadi_int(1) << this->fixed_point) << ")/y);}\n\n";
+      break;
     }
   }
 
@@ -873,11 +1388,21 @@ namespace casadi {
     return s.str();
   }
 
-  string CodeGenerator::constant(casadi_int v) {
+  string CodeGenerator::constant(casadi_int v) const {
     return constant(static_cast<double>(v));
   }
-  string CodeGenerator::constant(double v) {
+  string CodeGenerator::constant(double v) const {
     stringstream s;
+    if (this->fixed_point>=0) {
+      // Scaled integer
+      casadi_int v_max = this->casadi_real=="int16_t" ? 32767 : 2147483647;
+      double v_fix = std::round(std::ldexp(v, this->fixed_point));
+      casadi_assert(!isnan(v) && std::fabs(v_fix)<=v_max,
+                    "Constant " + str(v) + " cannot be represented in fixed point");
+      s << static_cast<casadi_int>(v_fix);
+      return s.str();
+    }
+    bool single = this->casadi_real=="float";
     if (isnan(v)) {
       s << "NAN";
     } else if (isinf(v)) {
@@ -888,17 +1413,24 @@ namespace casadi {
       if (static_cast<double>(v_int)==v) {
         // Print integer
         s << v_int << ".";
+      } else if (single) {
+        // Print real, rounded to single precision
+        std::ios_base::fmtflags fmtfl = s.flags(); // get current format flags
+        s << std::scientific << std::setprecision(std::numeric_limits<float>::max_digits10 - 1)
+          << static_cast<float>(v);
+        s.flags(fmtfl); // reset current format flags
       } else {
         // Print real
         std::ios_base::fmtflags fmtfl = s.flags(); // get current format flags
         s << std::scientific << std::setprecision(std::numeric_limits<double>::digits10 + 1) << v;
         s.flags(fmtfl); // reset current format flags
       }
+      if (single) s << "f";
     }
     return s.str();
   }
 
-  string CodeGenerator::initializer(const vector<double>& v) {
+  string CodeGenerator::initializer(const vector<double>& v) const {
     stringstream s;
     s << "{";
     for (casadi_int i=0; i<v.size(); ++i) {
@@ -940,6 +1472,10 @@ namespace casadi {
 
   string CodeGenerator::dot(casadi_int n, const string& x,
                                  const string& y) {
+    if (this->blas) {
+      add_include("cblas.h");
+      return cblas("dot") + "(" + str(n) + ", " + x + ", 1, " + y + ", 1)";
+    }
     add_auxiliary(AUX_DOT);
     stringstream s;
     s << "casadi_dot(" << n << ", " << x << ", " << y << ")";
@@ -998,7 +1534,7 @@ namespace casadi {
 
   string CodeGenerator::declare(string s) {
     // Add c linkage
-    string cpp_prefix = this->cpp ? "extern \"C\" " : "";
+    string cpp_prefix = this->cpp && !this->header_only ? "extern \"C\" " : "";
 
     // To header file
     if (this->with_header) {
@@ -1059,11 +1595,19 @@ namespace casadi {
 
   string CodeGenerator::axpy(casadi_int n, const string& a,
                                   const string& x, const string& y) {
+    if (this->blas) {
+      add_include("cblas.h");
+      return cblas("axpy") + "(" + str(n) + ", " + a + ", " + x + ", 1, " + y + ", 1);";
+    }
     add_auxiliary(AUX_AXPY);
     return "casadi_axpy(" + str(n) + ", " + a + ", " + x + ", " + y + ");";
   }
 
   string CodeGenerator::scal(casadi_int n, const string& alpha, const string& x) {
+    if (this->blas) {
+      add_include("cblas.h");
+      return cblas("scal") + "(" + str(n) + ", " + alpha + ", " + x + ", 1);";
+    }
     add_auxiliary(AUX_SCAL);
     return "casadi_scal(" + str(n) + ", " + alpha + ", " + x + ");";
   }
@@ -1077,6 +1621,12 @@ namespace casadi {
 
   string CodeGenerator::mv(const string& x, casadi_int nrow_x, casadi_int ncol_x,
                                 const string& y, const string& z, bool tr) {
+    if (this->blas) {
+      add_include("cblas.h");
+      return cblas("gemv") + "(CblasColMajor, " + (tr ? "CblasTrans" : "CblasNoTrans") + ", "
+        + str(nrow_x) + ", " + str(ncol_x) + ", 1, " + x + ", "
+        + str(std::max(nrow_x, casadi_int(1))) + ", " + y + ", 1, 1, " + z + ", 1);";
+    }
     add_auxiliary(AUX_MV_DENSE);
     return "casadi_mv_dense(" + x + ", " + str(nrow_x) + ", " + str(ncol_x) + ", "
            + y + ", " + z + ", " +  (tr ? "1" : "0") + ");";
@@ -1091,6 +1641,36 @@ namespace casadi {
       + z + ", " + sparsity(sp_z) + ", " + w + ", " +  (tr ? "1" : "0") + ");";
   }
 
+  string CodeGenerator::mtimes(const string& x, casadi_int nrow_x, casadi_int ncol_x,
+                               const string& y, casadi_int ncol_y, const string& z) {
+    return mtimes(x, nrow_x, ncol_x, y, str(ncol_y), z);
+  }
+
+  string CodeGenerator::mtimes(const string& x, casadi_int nrow_x, casadi_int ncol_x,
+                               const string& y, const string& ncol_y, const string& z) {
+    if (this->blas) {
+      add_include("cblas.h");
+      // Leading dimensions must be positive
+      string m = str(nrow_x), n = ncol_y, k = str(ncol_x);
+      string ldx = str(std::max(nrow_x, casadi_int(1))), ldy = str(std::max(ncol_x, casadi_int(1)));
+      return cblas("gemm") + "(CblasColMajor, CblasNoTrans, CblasNoTrans, " + m + ", " + n + ", " + k
+        + ", 1, " + x + ", " + ldx + ", " + y + ", " + ldy + ", 1, " + z + ", " + ldx + ");";
+    }
+    add_auxiliary(AUX_MTIMES_DENSE);
+    return "casadi_mtimes_dense(" + x + ", " + str(nrow_x) + ", " + str(ncol_x) + ", "
+      + y + ", " + ncol_y + ", " + z + ");";
+  }
+
+  string CodeGenerator::cblas(const string& routine) const {
+    return string(this->casadi_real=="float" ? "cblas_s" : "cblas_d") + routine;
+  }
+
+  string CodeGenerator::conv(const string& h, casadi_int nh,
+                             const string& x, casadi_int nx, const string& y) {
+    add_auxiliary(AUX_CONV);
+    return "casadi_conv(" + h + ", " + str(nh) + ", " + x + ", " + str(nx) + ", " + y + ");";
+  }
+
   void CodeGenerator::print_formatted(const string& s) {
     // Quick return if empty
     if (s.empty()) return;
@@ -1218,7 +1798,7 @@ namespace casadi {
         string sym = line.substr(n1+1, n2-n1-1);
         if (add_shorthand) shorthand(sym + suffix);
         if (!suffix.empty()) {
-          rep.push_back(make_pair(sym, sym + suffix));
+          rep.push_back(make_pair("casadi_" + sym, "casadi_" + sym + suffix));
         }
         continue;
       }
@@ -1248,15 +1828,26 @@ namespace casadi {
         continue;
       }
 
-      // Perform string replacements
+      // Perform string replacements, whole identifiers only
+      auto is_ident = [](char c) { return isalnum(static_cast<unsigned char>(c)) || c=='_';};
       for (auto&& it = rep.rbegin(); it!=rep.rend(); ++it) {
+        const string& key = it->first;
         string::size_type n = 0;
-        while ((n = line.find(it->first, n)) != string::npos) {
-          line.replace(n, it->first.size(), it->second);
+        while ((n = line.find(key, n)) != string::npos) {
+          string::size_type n_end = n + key.size();
+          if ((n>0 && is_ident(line[n-1]) && is_ident(key.front()))
+              || (n_end<line.size() && is_ident(line[n_end]) && is_ident(key.back()))) {
+            n = n_end;
+            continue;
+          }
+          line.replace(n, key.size(), it->second);
           n += it->second.size();
         }
       }
 
+      // Single precision arithmetic and math functions
+      if (this->casadi_real=="float") line = to_single(line);
+
       // Append to return
       ret << line << "\n";
     }
@@ -1301,9 +1892,11 @@ namespace casadi {
   string CodeGenerator::
   qr(const string& sp, const string& A, const string& w,
      const string& sp_v, const string& v, const string& sp_r,
-     const string& r, const string& beta, const string& prinv, const string& pc) {
-    add_auxiliary(CodeGenerator::AUX_QR);
-    return "casadi_qr(" + sp + ", " + A + ", " + w + ", "
+     const string& r, const string& beta, const string& prinv, const string& pc,
+     const string& type) {
+    add_auxiliary(CodeGenerator::AUX_QR, {type});
+    string fname = type=="casadi_real" ? "casadi_qr" : "casadi_qr_" + type;
+    return fname + "(" + sp + ", " + A + ", " + w + ", "
            + sp_v + ", " + v + ", " + sp_r + ", " + r + ", "
            + beta + ", " + prinv + ", " + pc + ");";
   }
@@ -1313,9 +1906,10 @@ namespace casadi {
            const string& sp_v, const string& v,
            const string& sp_r, const string& r,
            const string& beta, const string& prinv,
-           const string& pc, const string& w) {
-    add_auxiliary(CodeGenerator::AUX_QR);
-    return "casadi_qr_solve(" + x + ", " + str(nrhs) + ", " + (tr ? "1" : "0") + ", "
+           const string& pc, const string& w, const string& type) {
+    add_auxiliary(CodeGenerator::AUX_QR, {type});
+    string fname = type=="casadi_real" ? "casadi_qr_solve" : "casadi_qr_solve_" + type;
+    return fname + "(" + x + ", " + str(nrhs) + ", " + (tr ? "1" : "0") + ", "
            + sp_v + ", " + v + ", " + sp_r + ", " + r + ", "
            + beta + ", " + prinv + ", " + pc + ", " + w + ");";
   }
@@ -1323,19 +1917,153 @@ namespace casadi {
   std::string CodeGenerator::
   ldl(const std::string& sp_a, const std::string& a,
       const std::string& sp_lt, const std::string& lt, const std::string& d,
-      const std::string& p, const std::string& w) {
-    add_auxiliary(CodeGenerator::AUX_LDL);
-    return "casadi_ldl(" + sp_a + ", " + a + ", " + sp_lt + ", " + lt + ", "
+      const std::string& p, const std::string& w, const std::string& type) {
+    add_auxiliary(CodeGenerator::AUX_LDL, {type});
+    string fname = type=="casadi_real" ? "casadi_ldl" : "casadi_ldl_" + type;
+    return fname + "(" + sp_a + ", " + a + ", " + sp_lt + ", " + lt + ", "
            + d + ", " + p + ", " + w + ");";
   }
 
+  std::string CodeGenerator::
+  ldl_super(const std::string& sp_a, const std::string& a,
+            const std::string& sp_lt, const std::string& lt, const std::string& d,
+            const std::string& p, const std::string& sn, const std::string& blk,
+            const std::string& w, const std::string& iw) {
+    add_auxiliary(CodeGenerator::AUX_LDL_SUPER);
+    return "casadi_ldl_super(" + sp_a + ", " + a + ", " + sp_lt + ", " + lt + ", "
+           + d + ", " + p + ", " + sn + ", " + blk + ", " + w + ", " + iw + ");";
+  }
+
   std::string CodeGenerator::
   ldl_solve(const std::string& x, casadi_int nrhs,
     const std::string& sp_lt, const std::string& lt, const std::string& d,
-    const std::string& p, const std::string& w) {
-    add_auxiliary(CodeGenerator::AUX_LDL);
-    return "casadi_ldl_solve(" + x + ", " + str(nrhs) + ", " + sp_lt + ", "
+    const std::string& p, const std::string& w, const std::string& type) {
+    add_auxiliary(CodeGenerator::AUX_LDL, {type});
+    string fname = type=="casadi_real" ? "casadi_ldl_solve" : "casadi_ldl_solve_" + type;
+    return fname + "(" + x + ", " + str(nrhs) + ", " + sp_lt + ", "
            + lt + ", " + d + ", " + p + ", " + w + ");";
   }
 
+  Dict CodeGenerator::check_accuracy(const Function& f,
+                                     const std::vector<std::vector<DM> >& samples) const {
+    Function fsx = f.is_a("SXFunction") ? f : f.expand();
+    casadi_int n_in = fsx.n_in(), n_out = fsx.n_out();
+    casadi_int q = this->fixed_point;
+    casadi_int v_max = this->casadi_real=="int16_t" ? 32767 : 2147483647;
+    bool single = this->casadi_real=="float";
+
+    // Round to the precision of the generated code
+    auto prec = [&](double v) -> double {
+      if (q>=0) {
+        // Fixed point values are stored scaled
+        double v_fix = std::round(std::ldexp(v, q));
+        casadi_assert(!isnan(v) && std::fabs(v_fix)<=v_max,
+                      "Value " + str(v) + " cannot be represented in fixed point");
+        return v_fix;
+      }
+      return single ? static_cast<double>(static_cast<float>(v)) : v;
+    };
+    // Integer overflow wraps around
+    auto wrap = [&](int64_t v) -> double {
+      if (this->casadi_real=="int16_t") return static_cast<int16_t>(v);
+      return static_cast<int32_t>(v);
+    };
+    double one = q>=0 ? std::ldexp(1., q) : 1;
+
+    // Work vector
+    casadi_int sz_w = 0;
+    for (casadi_int k=0; k<fsx.n_instructions(); ++k) {
+      if (fsx.instruction_id(k)!=OP_OUTPUT) {
+        sz_w = std::max(sz_w, fsx.instruction_output(k).at(0)+1);
+      }
+    }
+    std::vector<double> w(sz_w);
+
+    std::vector<double> abs_err(n_out, 0), ref_max(n_out, 0);
+    for (auto&& arg : samples) {
+      casadi_assert(arg.size()==n_in, "Expected " + str(n_in) + " inputs, got "
+                    + str(arg.size()));
+      // Inputs with the sparsity of the function
+      std::vector<DM> x(n_in);
+      for (casadi_int i=0; i<n_in; ++i) {
+        const Sparsity& sp = fsx.sparsity_in(i);
+        if (arg[i].is_scalar() && !sp.is_scalar()) {
+          x[i] = DM(sp, arg[i].scalar());
+        } else {
+          x[i] = DM::project(arg[i], sp);
+        }
+      }
+      // Reference in double precision
+      std::vector<DM> ref = fsx(x);
+      std::vector<std::vector<double> > res(n_out);
+      for (casadi_int i=0; i<n_out; ++i) res[i].resize(fsx.nnz_out(i), 0);
+      // Emulate the generated code
+      for (casadi_int k=0; k<fsx.n_instructions(); ++k) {
+        casadi_int op = fsx.instruction_id(k);
+        std::vector<casadi_int> o = fsx.instruction_output(k), i = fsx.instruction_input(k);
+        if (op==OP_OUTPUT) {
+          res[o[0]][o[1]] = q>=0 ? std::ldexp(w[i[0]], -q) : w[i[0]];
+          continue;
+        } else if (op==OP_INPUT) {
+          w[o[0]] = prec(x[i[0]].nonzeros()[i[1]]);
+          continue;
+        } else if (op==OP_CONST) {
+          w[o[0]] = prec(fsx.instruction_constant(k));
+          continue;
+        }
+        double a = w[i.at(0)], b = i.size()>1 ? w[i[1]] : 0, r;
+        if (q<0) {
+          casadi_math<double>::fun(op, a, b, r);
+          w[o[0]] = prec(r);
+          continue;
+        }
+        // Fixed point arithmetic, cf. print_op
+        int64_t ia = static_cast<int64_t>(a), ib = static_cast<int64_t>(b);
+        switch (op) {
+          case OP_ASSIGN: r = a; break;
+          case OP_ADD: r = wrap(ia+ib); break;
+          case OP_SUB: r = wrap(ia-ib); break;
+          case OP_NEG: r = wrap(-ia); break;
+          case OP_TWICE: r = wrap(2*ia); break;
+          case OP_MUL: r = wrap((ia*ib) >> q); break;
+          case OP_SQ: r = wrap((ia*ia) >> q); break;
+          case OP_DIV:
+            casadi_assert(ib!=0, "Division by zero in fixed point");
+            r = wrap((ia*static_cast<int64_t>(one))/ib);
+            break;
+          case OP_FABS: r = a<0 ? wrap(-ia) : a; break;
+          case OP_SIGN: r = a<0 ? -one : a>0 ? one : 0; break;
+          case OP_NOT: r = a==0 ? one : 0; break;
+          case OP_FMIN: r = a<b ? a : b; break;
+          case OP_FMAX: r = a>b ? a : b; break;
+          case OP_LT: r = a<b ? one : 0; break;
+          case OP_LE: r = a<=b ? one : 0; break;
+          case OP_EQ: r = a==b ? one : 0; break;
+          case OP_NE: r = a!=b ? one : 0; break;
+          case OP_AND: r = a!=0 && b!=0 ? one : 0; break;
+          case OP_OR: r = a!=0 || b!=0 ? one : 0; break;
+          case OP_IF_ELSE_ZERO: r = a!=0 ? b : 0; break;
+          default:
+            casadi_error("Operation '" + casadi_math<double>::name(op)
+                         + "' is not supported with option 'fixed_point'");
+        }
+        w[o[0]] = r;
+      }
+      // Compare
+      for (casadi_int i=0; i<n_out; ++i) {
+        const std::vector<double>& r = ref[i].nonzeros();
+        for (casadi_int k=0; k<r.size(); ++k) {
+          abs_err[i] = std::max(abs_err[i], std::fabs(res[i][k]-r[k]));
+          ref_max[i] = std::max(ref_max[i], std::fabs(r[k]));
+        }
+      }
+    }
+    std::vector<double> rel_err(n_out);
+    for (casadi_int i=0; i<n_out; ++i) {
+      rel_err[i] = ref_max[i]>0 ? abs_err[i]/ref_max[i] : abs_err[i];
+    }
+    return {{"abs_err", abs_err}, {"rel_err", rel_err},
+            {"n_samples", static_cast<casadi_int>(samples.size())}};
+  }
+
 } // namespace casadi
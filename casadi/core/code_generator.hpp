@@ -60,6 +60,22 @@ namespace casadi {
     */
     std::string generate(const std::string& prefix="") const;
 
+    /** \brief Names of the source files written by generate
+      More than one file is written when the option "split" is set.
+      The first entry is the file returned by generate.
+    */
+    std::vector<std::string> source_files(const std::string& prefix="") const;
+
+    /** \brief Compare the arithmetic of the generated code with double precision
+      The scalar operations of f, which is expanded if it is not an SXFunction, are
+      emulated in the precision selected with the options "casadi_real" and
+      "fixed_point" for each sample of the inputs. Returns the largest absolute
+      error of each output ("abs_err") and the same relative to the largest
+      magnitude of the output over the samples ("rel_err").
+    */
+    Dict check_accuracy(const Function& f,
+                        const std::vector<std::vector<DM> >& samples) const;
+
     /// Add an include file optionally using a relative path "..." instead of an absolute path <...>
     void add_include(const std::string& new_include, bool relative_path=false,
                     const std::string& use_ifdef=std::string());
@@ -136,14 +152,17 @@ namespace casadi {
     void unindent() {current_indent_--;}
 
     /** \brief Avoid stack? */
-    bool avoid_stack() { return avoid_stack_;}
+    bool avoid_stack() const { return avoid_stack_;}
 
-    /** \brief Print a constant in a lossless but compact manner */
-    static std::string constant(double v);
-    static std::string constant(casadi_int v);
+    /** \brief Print a constant in a lossless but compact manner
+      With single precision, the constant is rounded and has an f-suffix.
+      With fixed point, the scaled integer is printed.
+    */
+    std::string constant(double v) const;
+    std::string constant(casadi_int v) const;
 
     /** \brief Print an intializer */
-    static std::string initializer(const std::vector<double>& v);
+    std::string initializer(const std::vector<double>& v) const;
     static std::string initializer(const std::vector<casadi_int>& v);
 
     /** \brief Sanitize source files for codegen */
@@ -175,6 +194,18 @@ namespace casadi {
                        const std::string& z, const Sparsity& sp_z,
                        const std::string& w, bool tr);
 
+    /** \brief Codegen dense matrix-matrix multiplication, z += x*y */
+    std::string mtimes(const std::string& x, casadi_int nrow_x, casadi_int ncol_x,
+                       const std::string& y, casadi_int ncol_y, const std::string& z);
+
+    /** \brief Codegen dense matrix-matrix multiplication, number of columns of y in a variable */
+    std::string mtimes(const std::string& x, casadi_int nrow_x, casadi_int ncol_x,
+                       const std::string& y, const std::string& ncol_y, const std::string& z);
+
+    /** \brief Codegen full discrete convolution, y += conv(h, x) */
+    std::string conv(const std::string& h, casadi_int nh,
+                     const std::string& x, casadi_int nx, const std::string& y);
+
     /** \brief Codegen bilinear form */
     std::string bilin(const std::string& A, const Sparsity& sp_A,
                       const std::string& x, const std::string& y);
@@ -207,26 +238,35 @@ namespace casadi {
                    const std::string& w, const std::string& sp_v,
                    const std::string& v, const std::string& sp_r,
                    const std::string& r, const std::string& beta,
-                   const std::string& prinv, const std::string& pc);
+                   const std::string& prinv, const std::string& pc,
+                   const std::string& type="casadi_real");
 
     /** \brief QR solve */
     std::string qr_solve(const std::string& x, casadi_int nrhs, bool tr,
                          const std::string& sp_v, const std::string& v,
                          const std::string& sp_r, const std::string& r,
                          const std::string& beta, const std::string& prinv,
-                         const std::string& pc, const std::string& w);
+                         const std::string& pc, const std::string& w,
+                         const std::string& type="casadi_real");
 
     /** \brief LDL factorization */
     std::string ldl(const std::string& sp_a, const std::string& a,
                    const std::string& sp_lt, const std::string& lt,
                    const std::string& d, const std::string& p,
-                   const std::string& w);
+                   const std::string& w, const std::string& type="casadi_real");
+
+    /** \brief Supernodal LDL factorization */
+    std::string ldl_super(const std::string& sp_a, const std::string& a,
+                          const std::string& sp_lt, const std::string& lt,
+                          const std::string& d, const std::string& p,
+                          const std::string& sn, const std::string& blk,
+                          const std::string& w, const std::string& iw);
 
     /** \brief LDL solve */
     std::string ldl_solve(const std::string& x, casadi_int nrhs,
                          const std::string& sp_lt, const std::string& lt,
                          const std::string& d, const std::string& p,
-                         const std::string& w);
+                         const std::string& w, const std::string& type="casadi_real");
 
     /** \brief Declare a function */
     std::string declare(std::string s);
@@ -251,11 +291,14 @@ namespace casadi {
       AUX_MV,
       AUX_MV_DENSE,
       AUX_MTIMES,
+      AUX_MTIMES_DENSE,
+      AUX_CONV,
       AUX_PROJECT,
       AUX_DENSIFY,
       AUX_TRANS,
       AUX_TO_MEX,
       AUX_FROM_MEX,
+      AUX_MEX,
       AUX_INTERPN,
       AUX_INTERPN_GRAD,
       AUX_FLIP,
@@ -264,10 +307,19 @@ namespace casadi {
       AUX_INTERPN_INTERPOLATE,
       AUX_DE_BOOR,
       AUX_ND_BOOR_EVAL,
+      AUX_POLYVAL_ND,
       AUX_FINITE_DIFF,
       AUX_QR,
       AUX_LDL,
+      AUX_LDL_SUPER,
       AUX_NEWTON,
+      AUX_DOPRI,
+      AUX_RICCATI,
+      AUX_IPQP,
+      AUX_ADMM,
+      AUX_GMRES,
+      AUX_DPLE,
+      AUX_EXPM,
       AUX_TO_DOUBLE,
       AUX_TO_INT,
       AUX_CAST,
@@ -276,9 +328,14 @@ namespace casadi {
       AUX_IF_ELSE,
       AUX_PRINTF,
       AUX_FMIN,
-      AUX_FMAX
+      AUX_FMAX,
+      AUX_QMUL,
+      AUX_QDIV
     };
 
+    /** \brief Integer type for the intermediate results of fixed-point products */
+    std::string fixed_wide() const { return casadi_real=="int16_t" ? "int32_t" : "int64_t";}
+
     /** \brief Add a built-in auxiliary function */
     void add_auxiliary(Auxiliary f, const std::vector<std::string>& inst = {"casadi_real"});
 
@@ -302,8 +359,8 @@ namespace casadi {
                              const std::vector<casadi_int>& v);
 
     /** \brief  Print real vector to a c file */
-    static void print_vector(std::ostream &s, const std::string& name,
-                             const std::vector<double>& v);
+    void print_vector(std::ostream &s, const std::string& name,
+                      const std::vector<double>& v) const;
 
     /** \brief Create a copy operation */
     std::string copy(const std::string& arg, std::size_t n, const std::string& res);
@@ -361,6 +418,21 @@ namespace casadi {
     // Generate import symbol macros
     void generate_import_symbol(std::ostream &s) const;
 
+    // Dimensions and an entry point with fixed-size arguments, cf. option "header_only"
+    void generate_typed(const Function& f);
+
+    // Generate the footprint report, cf. option "with_report"
+    void generate_report(std::ostream &s) const;
+
+    // Generate everything that precedes the function bodies
+    void dump_prelude(std::ostream &s) const;
+
+    // Distribute the function bodies over the translation units
+    std::vector<std::string> split_body() const;
+
+    // CBLAS routine name for the precision of casadi_real, cf. option "blas"
+    std::string cblas(const std::string& routine) const;
+
     //  private:
   public:
     /// \cond INTERNAL
@@ -380,6 +452,9 @@ namespace casadi {
     // Generate header file?
     bool with_header;
 
+    // Generate a report of the worst-case memory and operation counts?
+    bool with_report;
+
     // Are we creating a MEX file?
     bool mex;
 
@@ -389,6 +464,12 @@ namespace casadi {
     // Are we generating C++?
     bool cpp;
 
+    // Generate a self-contained C++ header with internal linkage and typed entry points?
+    bool header_only;
+
+    // Number of translation units to split the function bodies over
+    casadi_int split;
+
     // Should we generate a main (allowing evaluation from command line)
     bool main;
 
@@ -398,6 +479,12 @@ namespace casadi {
     // Do we want to be lean on stack usage?
     bool avoid_stack_;
 
+    // Call a CBLAS library for dense vector and matrix kernels?
+    bool blas;
+
+    // Number of fractional bits with a fixed-point casadi_real, -1 for floating point
+    casadi_int fixed_point;
+
     /** \brief Codegen scalar
      * Use the work vector for storing work vector elements of length 1
      * (typically scalar) instead of using local variables
@@ -449,6 +536,9 @@ namespace casadi {
     };
     std::vector<FunctionMeta> added_functions_;
 
+    // Positions in the body where a translation unit may end
+    std::vector<std::streamoff> body_splits_;
+
     // Constants
     std::vector<std::vector<double> > double_constants_;
     std::vector<std::vector<casadi_int> > integer_constants_;
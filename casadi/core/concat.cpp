@@ -50,7 +50,8 @@ namespace casadi {
     T* r = res[0];
     for (casadi_int i=0; i<n_dep(); ++i) {
       casadi_int n = dep(i).nnz();
-      copy(arg[i], arg[i]+n, r);
+      // Nothing to do if already written in place, cf. MXFunction option "zero_copy_concat"
+      if (arg[i]!=r) copy(arg[i], arg[i]+n, r);
       r += n;
     }
     return 0;
@@ -61,7 +62,7 @@ namespace casadi {
     for (casadi_int i=0; i<n_dep(); ++i) {
       casadi_int n_i = dep(i).nnz();
       const bvec_t *arg_i_ptr = arg[i];
-      copy(arg_i_ptr, arg_i_ptr+n_i, res_ptr);
+      if (arg_i_ptr!=res_ptr) copy(arg_i_ptr, arg_i_ptr+n_i, res_ptr);
       res_ptr += n_i;
     }
     return 0;
@@ -72,6 +73,11 @@ namespace casadi {
     for (casadi_int i=0; i<n_dep(); ++i) {
       casadi_int n_i = dep(i).nnz();
       bvec_t *arg_i_ptr = arg[i];
+      if (arg_i_ptr==res_ptr) {
+        // Written in place, the seeds are already in the argument
+        res_ptr += n_i;
+        continue;
+      }
       for (casadi_int k=0; k<n_i; ++k) {
         *arg_i_ptr++ |= *res_ptr;
         *res_ptr++ = 0;
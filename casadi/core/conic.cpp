@@ -364,7 +364,12 @@ namespace casadi {
   = {{&FunctionInternal::options_},
      {{"discrete",
        {OT_BOOLVECTOR,
-        "Indicates which of the variables are discrete, i.e. integer-valued"}}
+        "Indicates which of the variables are discrete, i.e. integer-valued"}},
+      {"max_wall_time",
+       {OT_DOUBLE,
+        "Wall-clock time limit of a call in seconds. Solvers that support it (qrqp) "
+        "poll it, together with Function::cancel, in their iteration loops and return "
+        "their current iterate when it has passed [inf]"}}
      }
   };
 
@@ -372,10 +377,16 @@ namespace casadi {
     // Call the init method of the base class
     FunctionInternal::init(opts);
 
+    // Default options
+    max_wall_time_ = inf;
+
     // Read options
     for (auto&& op : opts) {
       if (op.first=="discrete") {
         discrete_ = op.second;
+      } else if (op.first=="max_wall_time") {
+        max_wall_time_ = op.second;
+        casadi_assert(max_wall_time_>0, "Option 'max_wall_time' must be positive");
       }
     }
 
@@ -414,6 +425,146 @@ namespace casadi {
     }
   }
 
+  int Conic::eval_batch(const double** arg, double** res, casadi_int* iw, double* w,
+                        void* mem, casadi_int n) const {
+    const double* arg1[CONIC_NUM_IN];
+    double* res1[CONIC_NUM_OUT];
+    for (casadi_int k=0; k<n; ++k) {
+      batch_point(arg, res, k, arg1, res1);
+      if (eval(arg1, res1, iw, w, mem)) return 1;
+    }
+    return 0;
+  }
+
+  void Conic::codegen_body_batch(CodeGenerator& g, casadi_int n, const std::string& nb,
+                                 const std::string& arg, const std::string& res,
+                                 const std::string& w) const {
+    casadi_assert(arg!="arg" && res!="res", "Batch arguments must not be called arg, res");
+    // The non-batched code in a block of its own, with arg and res pointing to point k
+    g << "for (k=0; k<" << nb << "; ++k) {\n"
+      << "const casadi_real* arg[" << CONIC_NUM_IN << "];\n"
+      << "casadi_real* res[" << CONIC_NUM_OUT << "];\n";
+    for (casadi_int i=0; i<CONIC_NUM_IN; ++i) {
+      g << "arg[" << i << "] = " << arg << "[" << i << "] ? " << arg << "[" << i << "]+k*"
+        << nnz_in(i) << " : 0;\n";
+    }
+    for (casadi_int i=0; i<CONIC_NUM_OUT; ++i) {
+      g << "res[" << i << "] = " << res << "[" << i << "] ? " << res << "[" << i << "]+k*"
+        << nnz_out(i) << " : 0;\n";
+    }
+    g << "{\n";
+    codegen_body(g);
+    g << "}\n"
+      << "}\n";
+  }
+
+  void Conic::detect_structure(casadi_int& N, std::vector<casadi_int>& nx,
+      std::vector<casadi_int>& nu, std::vector<casadi_int>& ng) const {
+    nx.clear();
+    nu.clear();
+    ng.clear();
+    if (na_==0) {
+      // Single stage without constraints
+      N = 0;
+      nx.push_back(nx_);
+      ng.push_back(0);
+      return;
+    }
+
+    /* General strategy: look for the xk+1 diagonal part in A
+    */
+
+    // Find the right-most column for each row in A -> A_skyline
+    // Find the second-to-right-most column -> A_skyline2
+    // Find the left-most column -> A_bottomline
+    Sparsity AT = A_.T();
+    std::vector<casadi_int> A_skyline;
+    std::vector<casadi_int> A_skyline2;
+    std::vector<casadi_int> A_bottomline;
+    for (casadi_int i=0;i<AT.size2();++i) {
+      casadi_int pivot = AT.colind()[i+1];
+      A_bottomline.push_back(AT.row()[AT.colind()[i]]);
+      if (pivot>AT.colind()[i]) {
+        A_skyline.push_back(AT.row()[pivot-1]);
+        if (pivot>AT.colind()[i]+1) {
+          A_skyline2.push_back(AT.row()[pivot-2]);
+        } else {
+          A_skyline2.push_back(-1);
+        }
+      } else {
+        A_skyline.push_back(-1);
+        A_skyline2.push_back(-1);
+      }
+    }
+
+    /*
+    Loop over the right-most columns of A:
+    they form the diagonal part due to xk+1 in gap constraints.
+    detect when the diagonal pattern is broken -> new stage
+    */
+    casadi_int pivot = 0; // Current right-most element
+    casadi_int start_pivot = pivot; // First right-most element that started the stage
+    casadi_int cg = 0; // Counter for non-gap-closing constraints
+    for (casadi_int i=0;i<na_;++i) { // Loop over all rows
+      bool commit = false; // Set true to jump to the stage
+      if (A_skyline[i]>pivot+1) { // Jump to a diagonal in the future
+        nu.push_back(A_skyline[i]-pivot-1); // Size of jump equals number of states
+        commit = true;
+      } else if (A_skyline[i]==pivot+1) { // Walking the diagonal
+        if (A_skyline2[i]<start_pivot) { // Free of below-diagonal entries?
+          pivot++;
+        } else {
+          nu.push_back(0); // We cannot but conclude that we arrived at a new stage
+          commit = true;
+        }
+      } else { // non-gap-closing constraint detected
+        cg++;
+      }
+
+      if (commit) {
+        nx.push_back(pivot-start_pivot+1);
+        ng.push_back(cg); cg=0;
+        start_pivot = A_skyline[i];
+        pivot = A_skyline[i];
+      }
+    }
+    nx.push_back(pivot-start_pivot+1);
+
+    // Correction for k==0
+    nx[0] = A_skyline[0];
+    nu[0] = 0;
+    ng.erase(ng.begin());
+    casadi_int cN=0;
+    for (casadi_int i=na_-1;i>=0;--i) {
+      if (A_bottomline[i]<start_pivot) break;
+      cN++;
+    }
+    ng.push_back(cg-cN);
+    ng.push_back(cN);
+
+    N = nu.size();
+  }
+
+  void Conic::batch_point(const double** arg, double** res, casadi_int k,
+                          const double** arg1, double** res1) const {
+    for (casadi_int i=0; i<CONIC_NUM_IN; ++i) {
+      arg1[i] = arg[i] ? arg[i] + k*nnz_in(i) : nullptr;
+    }
+    for (casadi_int i=0; i<CONIC_NUM_OUT; ++i) {
+      res1[i] = res[i] ? res[i] + k*nnz_out(i) : nullptr;
+    }
+  }
+
+  bool Conic::batch_same_matrices(const double** arg, casadi_int k) const {
+    if (k==0) return false;
+    for (casadi_int i : {CONIC_H, CONIC_A}) {
+      if (arg[i]==nullptr) continue;
+      casadi_int nz = nnz_in(i);
+      if (!std::equal(arg[i]+(k-1)*nz, arg[i]+k*nz, arg[i]+k*nz)) return false;
+    }
+    return true;
+  }
+
   void Conic::generateNativeCode(std::ostream& file) const {
     casadi_error("generateNativeCode not defined for class " + class_name());
   }
@@ -30,6 +30,7 @@
 #include "function_internal.hpp"
 #include "plugin_interface.hpp"
 #include "timing.hpp"
+#include "casadi_interrupt.hpp"
 
 /// \cond INTERNAL
 namespace casadi {
@@ -37,6 +38,9 @@ namespace casadi {
   struct CASADI_EXPORT ConicMemory {
     // Function specific statistics
     std::map<std::string, FStats> fstats;
+
+    // Time limit and cancellation of the current call, cf. Conic::max_wall_time_
+    Deadline deadline;
   };
 
   /// Internal class
@@ -114,10 +118,40 @@ namespace casadi {
     /// Print statistics
     void print_fstats(const ConicMemory* m) const;
 
+    ///@{
+    /** \brief Batched evaluation: solve n QPs one after the other
+        The QPs share the memory block, which lets plugins reuse
+        matrix-dependent work between QPs with identical H and A.
+        Statistics refer to the last QP, unless the plugin says otherwise.
+    */
+    bool has_eval_batch() const override { return true;}
+    int eval_batch(const double** arg, double** res, casadi_int* iw, double* w,
+                   void* mem, casadi_int n) const override;
+    void codegen_body_batch(CodeGenerator& g, casadi_int n, const std::string& nb,
+                            const std::string& arg, const std::string& res,
+                            const std::string& w) const override;
+    ///@}
+
   protected:
+    /** \brief Detect the multistage structure of A
+        Variables are assumed ordered x0, u0, x1, u1, ..., xN and constraints stage by stage,
+        the dynamic constraints, whose diagonal in x_{k+1} marks a stage, before the others */
+    void detect_structure(casadi_int& N, std::vector<casadi_int>& nx,
+                          std::vector<casadi_int>& nu, std::vector<casadi_int>& ng) const;
+
+    /// Input and output pointers of point k of a batch
+    void batch_point(const double** arg, double** res, casadi_int k,
+                     const double** arg1, double** res1) const;
+
+    /// Are H and A of point k of a batch equal to those of point k-1?
+    bool batch_same_matrices(const double** arg, casadi_int k) const;
+
     /// Options
     std::vector<bool> discrete_;
 
+    /// Wall-clock time limit of a call, polled in the iteration loops of the solvers
+    double max_wall_time_;
+
     /// Problem structure
     Sparsity H_, A_, Q_, P_;
 
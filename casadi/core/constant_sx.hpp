@@ -28,6 +28,13 @@
 
 #include "sx_node.hpp"
 #include <cassert>
+#ifdef CASADI_WITH_THREAD
+#ifdef CASADI_WITH_THREAD_MINGW
+#include <mingw.mutex.h>
+#else // CASADI_WITH_THREAD_MINGW
+#include <mutex>
+#endif // CASADI_WITH_THREAD_MINGW
+#endif //CASADI_WITH_THREAD
 
 /// \cond INTERNAL
 
@@ -56,6 +63,20 @@ double to_double() const override = 0;
 /** \brief  Properties */
 bool is_constant() const override { return true; }
 
+/** \brief Add a reference, unless the count has already reached zero, i.e. the node
+ * is being deleted by another thread. Used for the cached constants */
+bool claim() {
+#ifdef CASADI_WITH_THREAD
+  unsigned int c = count;
+  while (c>0 && !count.compare_exchange_weak(c, c+1)) {}
+  return c>0;
+#else // CASADI_WITH_THREAD
+  if (count==0) return false;
+  count++;
+  return true;
+#endif // CASADI_WITH_THREAD
+}
+
 /** \brief  Get the operation */
 casadi_int op() const override { return OP_CONST;}
 
@@ -65,6 +86,13 @@ bool is_equal(const SXNode* node, casadi_int depth) const override {
   return n && n->to_double()==to_double();
 }
 
+/** \brief Structural hash, from the value, with -0 and 0 equal */
+unsigned int hash() const override {
+  double v = to_double();
+  size_t h = std::hash<double>()(v==0 ? 0. : v);
+  return static_cast<unsigned int>(h ^ (h>>32));
+}
+
 protected:
 
 /** \brief  Print expression */
@@ -91,29 +119,37 @@ class RealtypeSX : public ConstantSX {
 
     /// Destructor
     ~RealtypeSX() override {
-      size_t num_erased = cached_constants_.erase(value);
-      assert(num_erased==1);
-      (void)num_erased;
+#ifdef CASADI_WITH_THREAD
+      std::lock_guard<std::mutex> lock(mtx_);
+#endif // CASADI_WITH_THREAD
+      // The entry has been replaced if "create" was called during the deletion
+      CACHING_MAP<double, RealtypeSX*>::iterator it = cached_constants_.find(value);
+      assert(it!=cached_constants_.end());
+      if (it->second==this) cached_constants_.erase(it);
     }
 
-    /// Static creator function (use instead of constructor)
+    /// Static creator function (use instead of constructor), the reference is counted
     inline static RealtypeSX* create(double value) {
+#ifdef CASADI_WITH_THREAD
+      std::lock_guard<std::mutex> lock(mtx_);
+#endif // CASADI_WITH_THREAD
       // Try to find the constant
       CACHING_MAP<double, RealtypeSX*>::iterator it = cached_constants_.find(value);
 
-      // If not found, add it,
-      if (it==cached_constants_.end()) {
-        // Allocate a new object
-        RealtypeSX* n = new RealtypeSX(value);
+      // Return it to caller, unless being deleted
+      if (it!=cached_constants_.end() && it->second->claim()) return it->second;
 
-        // Add to hash_table
-        cached_constants_.insert(it, std::make_pair(value, n));
+      // Allocate a new object
+      RealtypeSX* n = new RealtypeSX(value);
+      n->count++;
 
-        // Return it to caller
-        return n;
-      } else { // Else, returned the object
-        return it->second;
+      // Add to hash_table
+      if (it==cached_constants_.end()) {
+        cached_constants_.insert(it, std::make_pair(value, n));
+      } else {
+        it->second = n;
       }
+      return n;
     }
 
     ///@{
@@ -129,6 +165,11 @@ class RealtypeSX : public ConstantSX {
      * (storage is allocated for it in sx_element.cpp) */
     static CACHING_MAP<double, RealtypeSX*> cached_constants_;
 
+#ifdef CASADI_WITH_THREAD
+    /// Mutex protecting cached_constants_
+    static std::mutex mtx_;
+#endif // CASADI_WITH_THREAD
+
     /** \brief  Data members */
     double value;
 };
@@ -150,29 +191,37 @@ class IntegerSX : public ConstantSX {
 
     /// Destructor
     ~IntegerSX() override {
-      size_t num_erased = cached_constants_.erase(value);
-      assert(num_erased==1);
-      (void)num_erased;
+#ifdef CASADI_WITH_THREAD
+      std::lock_guard<std::mutex> lock(mtx_);
+#endif // CASADI_WITH_THREAD
+      // The entry has been replaced if "create" was called during the deletion
+      CACHING_MAP<casadi_int, IntegerSX*>::iterator it = cached_constants_.find(value);
+      assert(it!=cached_constants_.end());
+      if (it->second==this) cached_constants_.erase(it);
     }
 
-    /// Static creator function (use instead of constructor)
+    /// Static creator function (use instead of constructor), the reference is counted
     inline static IntegerSX* create(casadi_int value) {
+#ifdef CASADI_WITH_THREAD
+      std::lock_guard<std::mutex> lock(mtx_);
+#endif // CASADI_WITH_THREAD
       // Try to find the constant
       CACHING_MAP<casadi_int, IntegerSX*>::iterator it = cached_constants_.find(value);
 
-      // If not found, add it,
-      if (it==cached_constants_.end()) {
-        // Allocate a new object
-        IntegerSX* n = new IntegerSX(value);
+      // Return it to caller, unless being deleted
+      if (it!=cached_constants_.end() && it->second->claim()) return it->second;
 
-        // Add to hash_table
-        cached_constants_.insert(it, std::make_pair(value, n));
+      // Allocate a new object
+      IntegerSX* n = new IntegerSX(value);
+      n->count++;
 
-        // Return it to caller
-        return n;
-      } else { // Else, returned the object
-        return it->second;
+      // Add to hash_table
+      if (it==cached_constants_.end()) {
+        cached_constants_.insert(it, std::make_pair(value, n));
+      } else {
+        it->second = n;
       }
+      return n;
     }
 
     ///@{
@@ -190,6 +239,11 @@ class IntegerSX : public ConstantSX {
      * (storage is allocated for it in sx_element.cpp) */
     static CACHING_MAP<casadi_int, IntegerSX*> cached_constants_;
 
+#ifdef CASADI_WITH_THREAD
+    /// Mutex protecting cached_constants_
+    static std::mutex mtx_;
+#endif // CASADI_WITH_THREAD
+
     /** \brief  Data members */
     int value;
 };
@@ -0,0 +1,115 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#include "convolution.hpp"
+#include "casadi_misc.hpp"
+#include "function_internal.hpp"
+
+using namespace std;
+
+namespace casadi {
+
+  Convolution::Convolution(const MX& h, const MX& x) {
+    casadi_assert_dev(h.is_column() && h.is_dense() && x.is_column() && x.is_dense());
+    casadi_assert_dev(!h.is_empty() && !x.is_empty());
+    set_dep(h, x);
+    set_sparsity(Sparsity::dense(h.nnz()+x.nnz()-1, 1));
+  }
+
+  std::string Convolution::disp(const std::vector<std::string>& arg) const {
+    return "conv(" + arg.at(0) + ", " + arg.at(1) + ")";
+  }
+
+  int Convolution::eval(const double** arg, double** res, casadi_int* iw, double* w) const {
+    return eval_gen<double>(arg, res, iw, w);
+  }
+
+  int Convolution::eval_sx(const SXElem** arg, SXElem** res, casadi_int* iw, SXElem* w) const {
+    return eval_gen<SXElem>(arg, res, iw, w);
+  }
+
+  template<typename T>
+  int Convolution::eval_gen(const T** arg, T** res, casadi_int* iw, T* w) const {
+    casadi_fill(res[0], nnz(), T(0));
+    casadi_conv(arg[0], dep(0).nnz(), arg[1], dep(1).nnz(), res[0]);
+    return 0;
+  }
+
+  void Convolution::eval_mx(const std::vector<MX>& arg, std::vector<MX>& res) const {
+    res[0] = conv(arg[0], arg[1]);
+  }
+
+  void Convolution::ad_forward(const std::vector<std::vector<MX> >& fseed,
+                               std::vector<std::vector<MX> >& fsens) const {
+    // Bilinear in h and x
+    for (casadi_int d=0; d<fsens.size(); ++d) {
+      fsens[d][0] = conv(fseed[d][0], dep(1)) + conv(dep(0), fseed[d][1]);
+    }
+  }
+
+  void Convolution::ad_reverse(const std::vector<std::vector<MX> >& aseed,
+                               std::vector<std::vector<MX> >& asens) const {
+    // Adjoint of a convolution is a correlation, i.e. a convolution with the reversed factor
+    casadi_int nh = dep(0).nnz(), nx = dep(1).nnz();
+    MX h_rev = dep(0).nz(Matrix<casadi_int>(range(nh-1, -1, -1)));
+    MX x_rev = dep(1).nz(Matrix<casadi_int>(range(nx-1, -1, -1)));
+    for (casadi_int d=0; d<aseed.size(); ++d) {
+      MX s = densify(aseed[d][0]);
+      asens[d][0] += conv(s, x_rev).nz(Slice(nx-1, nx-1+nh));
+      asens[d][1] += conv(s, h_rev).nz(Slice(nh-1, nh-1+nx));
+    }
+  }
+
+  int Convolution::sp_forward(const bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w) const {
+    casadi_int nh = dep(0).nnz(), nx = dep(1).nnz();
+    fill_n(res[0], nnz(), 0);
+    for (casadi_int j=0; j<nx; ++j) {
+      for (casadi_int i=0; i<nh; ++i) res[0][i+j] |= arg[0][i] | arg[1][j];
+    }
+    return 0;
+  }
+
+  int Convolution::sp_reverse(bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w) const {
+    casadi_int nh = dep(0).nnz(), nx = dep(1).nnz();
+    for (casadi_int j=0; j<nx; ++j) {
+      for (casadi_int i=0; i<nh; ++i) {
+        arg[0][i] |= res[0][i+j];
+        arg[1][j] |= res[0][i+j];
+      }
+    }
+    fill_n(res[0], nnz(), 0);
+    return 0;
+  }
+
+  void Convolution::generate(CodeGenerator& g,
+                             const std::vector<casadi_int>& arg,
+                             const std::vector<casadi_int>& res) const {
+    g << g.fill(g.work(res[0], nnz()), nnz(), "0.") << "\n";
+    g << g.conv(g.work(arg[0], dep(0).nnz()), dep(0).nnz(),
+                g.work(arg[1], dep(1).nnz()), dep(1).nnz(), g.work(res[0], nnz())) << "\n";
+  }
+
+} // namespace casadi
@@ -33,10 +33,13 @@
 #include "polynomial.hpp"
 #include "casadi_misc.hpp"
 #include "global_options.hpp"
+#include "evaluation_hook.hpp"
+#include "evaluation_context.hpp"
 #include "casadi_meta.hpp"
 
 // Matrices
 #include "matrix.hpp"
+#include "sparse_product.hpp"
 
 // Matrix expressions
 #include "mx.hpp"
@@ -54,6 +57,7 @@
 #include "expm.hpp"
 #include "interpolant.hpp"
 #include "external.hpp"
+#include "plugin_preload.hpp"
 
 // Misc
 #include "integration_tools.hpp"
@@ -31,12 +31,20 @@
 #include <sstream>
 #include <ctime>
 #include <cctype>
+#ifdef CASADI_WITH_THREAD
+#ifdef CASADI_WITH_THREAD_MINGW
+#include <mingw.mutex.h>
+#else // CASADI_WITH_THREAD_MINGW
+#include <mutex>
+#endif // CASADI_WITH_THREAD_MINGW
+#endif // CASADI_WITH_THREAD
 
 #include "casadi_misc.hpp"
 #include "exception.hpp"
 #include "code_generator.hpp"
 #include "calculus.hpp"
 #include "xml_file.hpp"
+#include "xml_reader.hpp"
 #include "external.hpp"
 
 using namespace std;
@@ -46,273 +54,159 @@ namespace casadi {
     this->t = MX::sym("t");
   }
 
-  void DaeBuilder::parse_fmi(const std::string& filename) {
-
-    // Load
-    XmlFile xml_file("tinyxml");
-    XmlNode document = xml_file.parse(filename);
-
-    // **** Add model variables ****
-    {
-      // Get a reference to the ModelVariables node
-      const XmlNode& modvars = document[0]["ModelVariables"];
-
-      // Add variables
-      for (casadi_int i=0; i<modvars.size(); ++i) {
-
-        // Get a reference to the variable
-        const XmlNode& vnode = modvars[i];
-
-        // Get the attributes
-        string name        = vnode.getAttribute("name");
-        casadi_int valueReference;
-        vnode.readAttribute("valueReference", valueReference);
-        string variability = vnode.getAttribute("variability");
-        string causality   = vnode.getAttribute("causality");
-        string alias       = vnode.getAttribute("alias");
-
-        // Skip to the next variable if its an alias
-        if (alias.compare("alias") == 0 || alias.compare("negatedAlias") == 0)
-          continue;
-
-        // Get the name
-        const XmlNode& nn = vnode["QualifiedName"];
-        string qn = qualified_name(nn);
-
-        // Add variable, if not already added
-        if (varmap_.find(qn)==varmap_.end()) {
-
-          // Create variable
-          Variable var(name);
-
-          // Value reference
-          var.valueReference = valueReference;
-
-          // Variability
-          if (variability.compare("constant")==0)
-            var.variability = CONSTANT;
-          else if (variability.compare("parameter")==0)
-            var.variability = PARAMETER;
-          else if (variability.compare("discrete")==0)
-            var.variability = DISCRETE;
-          else if (variability.compare("continuous")==0)
-            var.variability = CONTINUOUS;
-          else
-            throw CasadiException("Unknown variability");
-
-          // Causality
-          if (causality.compare("input")==0)
-            var.causality = INPUT;
-          else if (causality.compare("output")==0)
-            var.causality = OUTPUT;
-          else if (causality.compare("internal")==0)
-            var.causality = INTERNAL;
-          else
-            throw CasadiException("Unknown causality");
-
-          // Alias
-          if (alias.compare("noAlias")==0)
-            var.alias = NO_ALIAS;
-          else if (alias.compare("alias")==0)
-            var.alias = ALIAS;
-          else if (alias.compare("negatedAlias")==0)
-            var.alias = NEGATED_ALIAS;
-          else
-            throw CasadiException("Unknown alias");
-
-          // Other properties
-          if (vnode.hasChild("Real")) {
-            const XmlNode& props = vnode["Real"];
-            props.readAttribute("unit", var.unit, false);
-            props.readAttribute("displayUnit", var.display_unit, false);
-            props.readAttribute("min", var.min, false);
-            props.readAttribute("max", var.max, false);
-            props.readAttribute("initialGuess", var.guess, false);
-            props.readAttribute("start", var.start, false);
-            props.readAttribute("nominal", var.nominal, false);
-            props.readAttribute("free", var.free, false);
-          }
-
-          // Variable category
-          if (vnode.hasChild("VariableCategory")) {
-            string cat = vnode["VariableCategory"].getText();
-            if (cat.compare("derivative")==0)
-              var.category = CAT_DERIVATIVE;
-            else if (cat.compare("state")==0)
-              var.category = CAT_STATE;
-            else if (cat.compare("dependentConstant")==0)
-              var.category = CAT_DEPENDENT_CONSTANT;
-            else if (cat.compare("independentConstant")==0)
-              var.category = CAT_INDEPENDENT_CONSTANT;
-            else if (cat.compare("dependentParameter")==0)
-              var.category = CAT_DEPENDENT_PARAMETER;
-            else if (cat.compare("independentParameter")==0)
-              var.category = CAT_INDEPENDENT_PARAMETER;
-            else if (cat.compare("algebraic")==0)
-              var.category = CAT_ALGEBRAIC;
-            else
-              throw CasadiException("Unknown variable category: " + cat);
-          }
-
-          // Add to list of variables
-          add_variable(qn, var);
-
-          // Sort expression
-          switch (var.category) {
-          case CAT_DERIVATIVE:
-            // Skip - meta information about time derivatives is
-            //        kept together with its parent variable
-            break;
-          case CAT_STATE:
-            this->s.push_back(var.v);
-            this->sdot.push_back(var.d);
-            break;
-          case CAT_DEPENDENT_CONSTANT:
-            // Skip
-            break;
-          case CAT_INDEPENDENT_CONSTANT:
-            // Skip
-            break;
-          case CAT_DEPENDENT_PARAMETER:
-            // Skip
-            break;
-          case CAT_INDEPENDENT_PARAMETER:
-            if (var.free) {
-              this->p.push_back(var.v);
-            } else {
-              // Skip
-            }
-            break;
-          case CAT_ALGEBRAIC:
-            if (var.causality == INTERNAL) {
-              this->s.push_back(var.v);
-              this->sdot.push_back(var.d);
-            } else if (var.causality == INPUT) {
-              this->u.push_back(var.v);
-            }
-            break;
-          default:
-            casadi_error("Unknown category");
-          }
-        }
-      }
-    }
-
-    // **** Add binding equations ****
-    {
-      // Get a reference to the BindingEquations node
-      const XmlNode& bindeqs = document[0]["equ:BindingEquations"];
-
-      for (casadi_int i=0; i<bindeqs.size(); ++i) {
-        const XmlNode& beq = bindeqs[i];
-
-        // Get the variable and binding expression
-        Variable& var = read_variable(beq[0]);
-        MX bexpr = read_expr(beq[1][0]);
-        this->d.push_back(var.v);
-        this->ddef.push_back(bexpr);
+  namespace {
+    // Models read with the option "cache", by checksum of the file and sections skipped.
+    // Never destroyed, since the expressions may outlive the static objects they use
+    std::map<std::string, DaeBuilder>& parse_cache() {
+      static auto* cache = new std::map<std::string, DaeBuilder>();
+      return *cache;
+    }
+#ifdef CASADI_WITH_THREAD
+    std::mutex parse_cache_mtx;
+#endif // CASADI_WITH_THREAD
+  } // namespace
+
+  void DaeBuilder::parse_fmi(const std::string& filename, const Dict& opts) {
+    // Read options
+    bool cache = false;
+    std::set<std::string> skip;
+    for (auto&& op : opts) {
+      if (op.first=="cache") {
+        cache = op.second;
+      } else if (op.first=="skip") {
+        std::vector<std::string> s = op.second;
+        skip.insert(s.begin(), s.end());
+      } else {
+        casadi_error("No such option: " + op.first);
       }
     }
 
-    // **** Add dynamic equations ****
-    {
-      // Get a reference to the DynamicEquations node
-      const XmlNode& dyneqs = document[0]["equ:DynamicEquations"];
-
-      // Add equations
-      for (casadi_int i=0; i<dyneqs.size(); ++i) {
-
-        // Get a reference to the variable
-        const XmlNode& dnode = dyneqs[i];
-
-        // Add the differential equation
-        MX de_new = read_expr(dnode[0]);
-        this->dae.push_back(de_new);
+    // Map the file
+    XmlReader xml(filename);
+
+    // Look up the model if read before, only into an empty DaeBuilder
+    std::string key;
+    if (cache && varmap_.empty()) {
+      key = str(xml.checksum());
+      for (const std::string& sec : skip) key += " " + sec;
+#ifdef CASADI_WITH_THREAD
+      std::lock_guard<std::mutex> lock(parse_cache_mtx);
+#endif // CASADI_WITH_THREAD
+      auto it = parse_cache().find(key);
+      if (it!=parse_cache().end()) {
+        *this = it->second;
+        return;
       }
     }
 
-    // **** Add initial equations ****
-    {
-      // Get a reference to the DynamicEquations node
-      const XmlNode& initeqs = document[0]["equ:InitialEquations"];
-
-      // Add equations
-      for (casadi_int i=0; i<initeqs.size(); ++i) {
-
-        // Get a reference to the node
-        const XmlNode& inode = initeqs[i];
-
-        // Add the differential equations
-        for (casadi_int i=0; i<inode.size(); ++i) {
-          this->init.push_back(read_expr(inode[i]));
+    // Visit the sections of the model description, in the order of the schema
+    casadi_assert(xml.next(), "No model description in " + filename);
+    xml.enter();
+    while (xml.next()) {
+      const std::string& sec = xml.name();
+      if (skip.count(sec)) {
+        xml.skip();
+      } else if (sec=="ModelVariables") {
+        // **** Add model variables ****
+        xml.enter();
+        while (xml.next()) read_model_variable(xml.read());
+      } else if (sec=="equ:BindingEquations") {
+        // **** Add binding equations ****
+        xml.enter();
+        while (xml.next()) {
+          XmlNode beq = xml.read();
+
+          // Get the variable and binding expression
+          Variable& var = read_variable(beq[0]);
+          MX bexpr = read_expr(beq[1][0]);
+          this->d.push_back(var.v);
+          this->ddef.push_back(bexpr);
         }
-      }
-    }
-
-    // **** Add optimization ****
-    if (document[0].hasChild("opt:Optimization")) {
-
-      // Get a reference to the DynamicEquations node
-      const XmlNode& opts = document[0]["opt:Optimization"];
-      for (casadi_int i=0; i<opts.size(); ++i) {
-
-        // Get a reference to the node
-        const XmlNode& onode = opts[i];
-
-        // Get the type
-        if (onode.checkName("opt:ObjectiveFunction")) { // mayer term
-          try {
-            // Add components
-            for (casadi_int i=0; i<onode.size(); ++i) {
-              const XmlNode& var = onode[i];
-
-              // If string literal, ignore
-              if (var.checkName("exp:StringLiteral"))
-                continue;
-
-              // Read expression
-              MX v = read_expr(var);
-
-              // Treat as an output
-              add_y("mterm", v);
-            }
-          } catch(exception& ex) {
-            throw CasadiException(std::string("addObjectiveFunction failed: ") + ex.what());
+      } else if (sec=="equ:DynamicEquations") {
+        // **** Add dynamic equations ****
+        xml.enter();
+        while (xml.next()) {
+          XmlNode dnode = xml.read();
+
+          // Add the differential equation
+          MX de_new = read_expr(dnode[0]);
+          this->dae.push_back(de_new);
+        }
+      } else if (sec=="equ:InitialEquations") {
+        // **** Add initial equations ****
+        xml.enter();
+        while (xml.next()) {
+          XmlNode inode = xml.read();
+
+          // Add the differential equations
+          for (casadi_int i=0; i<inode.size(); ++i) {
+            this->init.push_back(read_expr(inode[i]));
           }
-        } else if (onode.checkName("opt:IntegrandObjectiveFunction")) {
-          try {
-            for (casadi_int i=0; i<onode.size(); ++i) {
-              const XmlNode& var = onode[i];
+        }
+      } else if (sec=="opt:Optimization") {
+        // **** Add optimization ****
+        xml.enter();
+        while (xml.next()) {
+          const std::string& oname = xml.name();
+          if (oname=="opt:ObjectiveFunction") { // mayer term
+            XmlNode onode = xml.read();
+            try {
+              // Add components
+              for (casadi_int i=0; i<onode.size(); ++i) {
+                const XmlNode& var = onode[i];
+
+                // If string literal, ignore
+                if (var.checkName("exp:StringLiteral"))
+                  continue;
+
+                // Read expression
+                MX v = read_expr(var);
+
+                // Treat as an output
+                add_y("mterm", v);
+              }
+            } catch(exception& ex) {
+              throw CasadiException(std::string("addObjectiveFunction failed: ") + ex.what());
+            }
+          } else if (oname=="opt:IntegrandObjectiveFunction") {
+            XmlNode onode = xml.read();
+            try {
+              for (casadi_int i=0; i<onode.size(); ++i) {
+                const XmlNode& var = onode[i];
 
-              // If string literal, ignore
-              if (var.checkName("exp:StringLiteral")) continue;
+                // If string literal, ignore
+                if (var.checkName("exp:StringLiteral")) continue;
 
-              // Read expression
-              MX v = read_expr(var);
+                // Read expression
+                MX v = read_expr(var);
 
-              // Treat as a quadrature state
-              add_q("lterm");
-              add_quad("lterm_rhs", v);
+                // Treat as a quadrature state
+                add_q("lterm");
+                add_quad("lterm_rhs", v);
+              }
+            } catch(exception& ex) {
+              throw CasadiException(std::string("addIntegrandObjectiveFunction failed: ")
+                                    + ex.what());
             }
-          } catch(exception& ex) {
-            throw CasadiException(std::string("addIntegrandObjectiveFunction failed: ")
-                                  + ex.what());
+          } else if (oname=="opt:IntervalStartTime") {
+            // Ignore, treated above
+          } else if (oname=="opt:IntervalFinalTime") {
+            // Ignore, treated above
+          } else if (oname=="opt:TimePoints") {
+            // Ignore, treated above
+          } else if (oname=="opt:PointConstraints") {
+            casadi_warning("opt:PointConstraints not supported, ignored");
+          } else if (oname=="opt:Constraints") {
+            casadi_warning("opt:Constraints not supported, ignored");
+          } else if (oname=="opt:PathConstraints") {
+            casadi_warning("opt:PointConstraints not supported, ignored");
+          } else {
+            casadi_warning("DaeBuilder::addOptimization: Unknown node " + str(oname));
           }
-        } else if (onode.checkName("opt:IntervalStartTime")) {
-          // Ignore, treated above
-        } else if (onode.checkName("opt:IntervalFinalTime")) {
-          // Ignore, treated above
-        } else if (onode.checkName("opt:TimePoints")) {
-          // Ignore, treated above
-        } else if (onode.checkName("opt:PointConstraints")) {
-          casadi_warning("opt:PointConstraints not supported, ignored");
-        } else if (onode.checkName("opt:Constraints")) {
-          casadi_warning("opt:Constraints not supported, ignored");
-        } else if (onode.checkName("opt:PathConstraints")) {
-          casadi_warning("opt:PointConstraints not supported, ignored");
-        } else {
-          casadi_warning("DaeBuilder::addOptimization: Unknown node " + str(onode.name()));
         }
+      } else {
+        // Not used, e.g. UnitDefinitions or VendorAnnotations
+        xml.skip();
       }
     }
 
@@ -326,6 +220,149 @@ namespace casadi {
                     "differentiated variables) does not match the number of "
                     "algebraic variables.");
     }
+
+    // Save for later reads of the same file
+    if (!key.empty()) {
+#ifdef CASADI_WITH_THREAD
+      std::lock_guard<std::mutex> lock(parse_cache_mtx);
+#endif // CASADI_WITH_THREAD
+      parse_cache()[key] = *this;
+    }
+  }
+
+  void DaeBuilder::read_model_variable(const XmlNode& vnode) {
+    // Get the attributes
+    string name        = vnode.getAttribute("name");
+    casadi_int valueReference;
+    vnode.readAttribute("valueReference", valueReference);
+    string variability = vnode.getAttribute("variability");
+    string causality   = vnode.getAttribute("causality");
+    string alias       = vnode.getAttribute("alias");
+
+    // Skip the variable if its an alias
+    if (alias.compare("alias") == 0 || alias.compare("negatedAlias") == 0)
+      return;
+
+    // Get the name
+    const XmlNode& nn = vnode["QualifiedName"];
+    string qn = qualified_name(nn);
+
+    // Add variable, if not already added
+    if (varmap_.find(qn)==varmap_.end()) {
+
+      // Create variable
+      Variable var(name);
+
+      // Value reference
+      var.valueReference = valueReference;
+
+      // Variability
+      if (variability.compare("constant")==0)
+        var.variability = CONSTANT;
+      else if (variability.compare("parameter")==0)
+        var.variability = PARAMETER;
+      else if (variability.compare("discrete")==0)
+        var.variability = DISCRETE;
+      else if (variability.compare("continuous")==0)
+        var.variability = CONTINUOUS;
+      else
+        throw CasadiException("Unknown variability");
+
+      // Causality
+      if (causality.compare("input")==0)
+        var.causality = INPUT;
+      else if (causality.compare("output")==0)
+        var.causality = OUTPUT;
+      else if (causality.compare("internal")==0)
+        var.causality = INTERNAL;
+      else
+        throw CasadiException("Unknown causality");
+
+      // Alias
+      if (alias.compare("noAlias")==0)
+        var.alias = NO_ALIAS;
+      else if (alias.compare("alias")==0)
+        var.alias = ALIAS;
+      else if (alias.compare("negatedAlias")==0)
+        var.alias = NEGATED_ALIAS;
+      else
+        throw CasadiException("Unknown alias");
+
+      // Other properties
+      if (vnode.hasChild("Real")) {
+        const XmlNode& props = vnode["Real"];
+        props.readAttribute("unit", var.unit, false);
+        props.readAttribute("displayUnit", var.display_unit, false);
+        props.readAttribute("min", var.min, false);
+        props.readAttribute("max", var.max, false);
+        props.readAttribute("initialGuess", var.guess, false);
+        props.readAttribute("start", var.start, false);
+        props.readAttribute("nominal", var.nominal, false);
+        props.readAttribute("free", var.free, false);
+      }
+
+      // Variable category
+      if (vnode.hasChild("VariableCategory")) {
+        string cat = vnode["VariableCategory"].getText();
+        if (cat.compare("derivative")==0)
+          var.category = CAT_DERIVATIVE;
+        else if (cat.compare("state")==0)
+          var.category = CAT_STATE;
+        else if (cat.compare("dependentConstant")==0)
+          var.category = CAT_DEPENDENT_CONSTANT;
+        else if (cat.compare("independentConstant")==0)
+          var.category = CAT_INDEPENDENT_CONSTANT;
+        else if (cat.compare("dependentParameter")==0)
+          var.category = CAT_DEPENDENT_PARAMETER;
+        else if (cat.compare("independentParameter")==0)
+          var.category = CAT_INDEPENDENT_PARAMETER;
+        else if (cat.compare("algebraic")==0)
+          var.category = CAT_ALGEBRAIC;
+        else
+          throw CasadiException("Unknown variable category: " + cat);
+      }
+
+      // Add to list of variables
+      add_variable(qn, var);
+
+      // Sort expression
+      switch (var.category) {
+      case CAT_DERIVATIVE:
+        // Skip - meta information about time derivatives is
+        //        kept together with its parent variable
+        break;
+      case CAT_STATE:
+        this->s.push_back(var.v);
+        this->sdot.push_back(var.d);
+        break;
+      case CAT_DEPENDENT_CONSTANT:
+        // Skip
+        break;
+      case CAT_INDEPENDENT_CONSTANT:
+        // Skip
+        break;
+      case CAT_DEPENDENT_PARAMETER:
+        // Skip
+        break;
+      case CAT_INDEPENDENT_PARAMETER:
+        if (var.free) {
+          this->p.push_back(var.v);
+        } else {
+          // Skip
+        }
+        break;
+      case CAT_ALGEBRAIC:
+        if (var.causality == INTERNAL) {
+          this->s.push_back(var.v);
+          this->sdot.push_back(var.d);
+        } else if (var.causality == INPUT) {
+          this->u.push_back(var.v);
+        }
+        break;
+      default:
+        casadi_error("Unknown category");
+      }
+    }
   }
 
   Variable& DaeBuilder::read_variable(const XmlNode& node) {
@@ -713,14 +750,19 @@ namespace casadi {
   }
 
   void DaeBuilder::make_semi_explicit() {
-    // Only works if there are no i
-    eliminate_d();
-
     // Separate the algebraic variables and equations
     split_dae();
 
     // Quick return if there are no implicitly defined states
-    if (this->s.empty()) return;
+    if (this->s.empty()) {
+      eliminate_d();
+      return;
+    }
+
+    // Dependent parameters are eliminated at the end, keeping the equations of
+    // each block small, unless they depend on the state derivatives
+    split_d();
+    if (!this->d.empty() && depends_on(vertcat(this->ddef), vertcat(this->sdot))) eliminate_d();
 
     // Write the ODE as a function of the state derivatives
     Function f("tmp", {vertcat(this->sdot)}, {vertcat(this->dae)});
@@ -794,14 +836,22 @@ namespace casadi {
     this->dae.clear();
     this->s.clear();
     this->sdot.clear();
-  }
 
-  void DaeBuilder::eliminate_alg() {
-    // Only works if there are no i
+    // Eliminate the dependent parameters
     eliminate_d();
+  }
 
+  void DaeBuilder::eliminate_alg() {
     // Quick return if there are no algebraic states
-    if (this->z.empty()) return;
+    if (this->z.empty()) {
+      eliminate_d();
+      return;
+    }
+
+    // Dependent parameters are eliminated at the end, keeping the equations of
+    // each block small, unless they depend on the algebraic states
+    split_d();
+    if (!this->d.empty() && depends_on(vertcat(this->ddef), vertcat(this->z))) eliminate_d();
 
     // Write the algebraic equations as a function of the algebraic states
     Function f("f", {vertcat(this->z)}, {vertcat(this->alg)});
@@ -873,12 +923,8 @@ namespace casadi {
       }
     }
 
-    // Eliminate inter-dependencies in fb_exp
-    vector<MX> ex;
-    substitute_inplace(z_exp, f_exp, ex, false);
-
-    // Add to the beginning of the dependent variables
-    // (since the other dependent variable might depend on them)
+    // Add to the beginning of the dependent variables, inter-dependencies in fb_exp
+    // are eliminated with the other dependent variables below
     this->d.insert(this->d.begin(), z_exp.begin(), z_exp.end());
     this->ddef.insert(this->ddef.begin(), f_exp.begin(), f_exp.end());
 
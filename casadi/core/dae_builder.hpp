@@ -263,8 +263,15 @@ namespace casadi {
     /** @name Import and export
      */
     ///@{
-    /// Import existing problem from FMI/XML
-    void parse_fmi(const std::string& filename);
+    /** \brief Import existing problem from FMI/XML
+     *
+     * The file is read in a single pass, one variable or equation at a time.
+     * Options:
+     *   cache: Reuse the model if a file with the same contents was read before
+     *          into an empty DaeBuilder. The models then share their symbols. [false]
+     *   skip:  Sections not to read, e.g. "opt:Optimization" []
+     */
+    void parse_fmi(const std::string& filename, const Dict& opts=Dict());
 
 #ifndef SWIG
     // Input convension in codegen
@@ -487,6 +494,9 @@ namespace casadi {
     /// Read an equation
     MX read_expr(const XmlNode& odenode);
 
+    /// Read a ScalarVariable node
+    void read_model_variable(const XmlNode& vnode);
+
     /// Read a variable
     Variable& read_variable(const XmlNode& node);
 
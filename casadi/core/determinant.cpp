@@ -44,6 +44,14 @@ namespace casadi {
     res[0] = det(arg[0]);
   }
 
+  int Determinant::eval_sx(const SXElem** arg, SXElem** res,
+                           casadi_int* iw, SXElem* w) const {
+    SX x = SX::zeros(dep().sparsity());
+    if (arg[0]) std::copy_n(arg[0], x.nnz(), x.ptr());
+    if (res[0]) res[0][0] = det(x).scalar();
+    return 0;
+  }
+
   void Determinant::ad_forward(const std::vector<std::vector<MX> >& fseed,
                             std::vector<std::vector<MX> >& fsens) const {
     const MX& X = dep();
@@ -0,0 +1,73 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#ifndef CASADI_DM_VIEW_HPP
+#define CASADI_DM_VIEW_HPP
+
+#include "matrix.hpp"
+
+namespace casadi {
+
+#ifndef SWIG
+  /** \brief Non-owning view of a numerical matrix in caller-owned storage
+   *
+   * Pairs a sparsity pattern with a pointer to the nonzeros, e.g. the data of an Eigen
+   * matrix, a NumPy array or a shared memory segment. Dense storage is in column-major
+   * order. The storage is not copied and must outlive the view.
+   */
+  class DMView {
+  public:
+    /// Null view, a zero input or an output that is not requested
+    DMView() : nz_(nullptr) {}
+
+    /// View nonzeros with a given sparsity pattern
+    DMView(const Sparsity& sp, double* nz) : sp_(sp), nz_(nz) {}
+
+    /// View dense, column-major storage
+    DMView(casadi_int nrow, casadi_int ncol, double* nz)
+      : sp_(Sparsity::dense(nrow, ncol)), nz_(nz) {}
+
+    /// View the nonzeros of a matrix, valid until its sparsity pattern changes
+    DMView(DM& x) : sp_(x.sparsity()), nz_(x.ptr()) {}
+
+    /// Sparsity pattern
+    const Sparsity& sparsity() const { return sp_;}
+
+    /// Pointer to the nonzeros
+    double* ptr() const { return nz_;}
+
+    /// Is the view null
+    bool is_null() const { return nz_==nullptr;}
+
+  private:
+    Sparsity sp_;
+    double* nz_;
+  };
+#endif // SWIG
+
+} // namespace casadi
+
+#endif // CASADI_DM_VIEW_HPP
@@ -48,6 +48,72 @@ namespace casadi {
     n_iter_ = einstein_process(A, B, C, dim_a, dim_b, dim_c, a, b, c,
       iter_dims_, strides_a_, strides_b_, strides_c_);
 
+    plan();
+  }
+
+  void Einstein::plan() {
+    casadi_int n = iter_dims_.size();
+
+    // Loops with the largest strides outermost, keeping the order of ties
+    vector<casadi_int> order = range(n);
+    auto footprint = [&](casadi_int j) {
+      return std::abs(strides_a_[1+j]) + std::abs(strides_b_[1+j]) + std::abs(strides_c_[1+j]);
+    };
+    std::stable_sort(order.begin(), order.end(),
+      [&](casadi_int i, casadi_int j) { return footprint(i) > footprint(j);});
+    iter_dims_ = vector_slice(iter_dims_, order);
+    for (vector<casadi_int>* s : {&strides_a_, &strides_b_, &strides_c_}) {
+      vector<casadi_int> s_new(1, s->front());
+      for (casadi_int j : order) s_new.push_back(s->at(1+j));
+      *s = s_new;
+    }
+
+    // Look for the rows (i), columns (j) and summation (k) of a matrix multiplication
+    gemm_ = false;
+    gemm_swap_ = false;
+    for (bool swap : {false, true}) {
+      const vector<casadi_int>& sx = swap ? strides_b_ : strides_a_;
+      const vector<casadi_int>& sy = swap ? strides_a_ : strides_b_;
+      const vector<casadi_int>& sc = strides_c_;
+      casadi_int ii=-1, jj=-1, kk=-1, m=1, nn=1, k=1;
+      for (casadi_int j=0; j<n; ++j) {
+        if (iter_dims_[j]>1 && sc[1+j]==1 && sx[1+j]==1 && sy[1+j]==0) {
+          ii = j;
+          m = iter_dims_[j];
+        }
+      }
+      for (casadi_int j=0; j<n; ++j) {
+        if (iter_dims_[j]>1 && sc[1+j]==0 && sx[1+j]==m && sy[1+j]==1) {
+          kk = j;
+          k = iter_dims_[j];
+        }
+      }
+      for (casadi_int j=0; j<n; ++j) {
+        if (iter_dims_[j]>1 && j!=ii && sc[1+j]==m && sx[1+j]==0 && sy[1+j]==k) {
+          jj = j;
+          nn = iter_dims_[j];
+        }
+      }
+      // Only worth it for an actual matrix (or matrix-vector) product
+      if (kk<0 || m*nn==1) continue;
+      gemm_ = true;
+      gemm_swap_ = swap;
+      gemm_m_ = m;
+      gemm_n_ = nn;
+      gemm_k_ = k;
+      batch_dims_.clear();
+      batch_a_.clear();
+      batch_b_.clear();
+      batch_c_.clear();
+      for (casadi_int j=0; j<n; ++j) {
+        if (j==ii || j==jj || j==kk || iter_dims_[j]==1) continue;
+        batch_dims_.push_back(iter_dims_[j]);
+        batch_a_.push_back(strides_a_[1+j]);
+        batch_b_.push_back(strides_b_[1+j]);
+        batch_c_.push_back(strides_c_[1+j]);
+      }
+      break;
+    }
   }
 
   std::string Einstein::disp(const std::vector<std::string>& arg) const {
@@ -55,7 +121,28 @@ namespace casadi {
   }
 
   int Einstein::eval(const double** arg, double** res, casadi_int* iw, double* w) const {
-    return eval_gen<double>(arg, res, iw, w);
+    if (!gemm_) return eval_gen<double>(arg, res, iw, w);
+    if (arg[0]!=res[0]) copy(arg[0], arg[0]+dep(0).nnz(), res[0]);
+    if (!n_iter_) return 0;
+
+    // Repeated matrix multiplication
+    casadi_int n_batch = product(batch_dims_);
+    for (casadi_int i=0; i<n_batch; ++i) {
+      const double* a = arg[1]+strides_a_[0];
+      const double* b = arg[2]+strides_b_[0];
+      double* c = res[0]+strides_c_[0];
+      casadi_int sub = i;
+      for (casadi_int j=0; j<batch_dims_.size(); ++j) {
+        casadi_int ind = sub % batch_dims_[j];
+        sub /= batch_dims_[j];
+        a += batch_a_[j]*ind;
+        b += batch_b_[j]*ind;
+        c += batch_c_[j]*ind;
+      }
+      if (gemm_swap_) std::swap(a, b);
+      casadi_mtimes_dense(a, gemm_m_, gemm_k_, b, gemm_n_, c);
+    }
+    return 0;
   }
 
   int Einstein::eval_sx(const SXElem** arg, SXElem** res, casadi_int* iw, SXElem* w) const {
@@ -136,10 +223,23 @@ namespace casadi {
     if (arg[0]!=res[0]) {
       g << g.copy(g.work(arg[0], nnz()), nnz(), g.work(res[0], nnz()));
     }
+    if (!n_iter_) return;
+
+    // Outer loops, flattened, and the innermost loop
+    const vector<casadi_int>& dims = gemm_ ? batch_dims_ : iter_dims_;
+    casadi_int n_outer = gemm_ || dims.empty() ? dims.size() : dims.size()-1;
+    casadi_int n_inner = gemm_ || dims.empty() ? 1 : dims.back();
+    vector<casadi_int> sa(dims.size()), sb(dims.size()), sc(dims.size());
+    for (casadi_int j=0; j<dims.size(); ++j) {
+      sa[j] = gemm_ ? batch_a_[j] : strides_a_[1+j];
+      sb[j] = gemm_ ? batch_b_[j] : strides_b_[1+j];
+      sc[j] = gemm_ ? batch_c_[j] : strides_c_[1+j];
+    }
 
     // main loop
     g.local("i", "casadi_int");
-    g << "for (i=0; i<" << n_iter_ << "; ++i) {\n";
+    g << "for (i=0; i<" << n_iter_/(n_inner*(gemm_ ? gemm_m_*gemm_n_*gemm_k_ : 1))
+      << "; ++i) {\n";
 
     // Data pointers
     g.local("cr", "const casadi_real", "*");
@@ -150,21 +250,39 @@ namespace casadi {
     g << "rr = " << g.work(res[0], dep(0).nnz()) << "+" << strides_c_[0] << ";\n";
 
     // Construct indices
-    for (casadi_int j=0; j<iter_dims_.size(); ++j) {
+    for (casadi_int j=0; j<n_outer; ++j) {
       if (j==0) {
         g.local("k", "casadi_int");
         g << "k = i;\n";
         g.local("j", "casadi_int");
       }
-      g << "j = k % " << iter_dims_[j] << ";\n";
-      if (j+1<iter_dims_.size()) g << "k /= " << iter_dims_[j] << ";\n";
-      if (strides_a_[1+j]) g << "cr += j*" << strides_a_[1+j] << ";\n";
-      if (strides_b_[1+j]) g << "cs += j*" << strides_b_[1+j] << ";\n";
-      if (strides_c_[1+j]) g << "rr += j*" << strides_c_[1+j] << ";\n";
+      g << "j = k % " << dims[j] << ";\n";
+      if (j+1<n_outer) g << "k /= " << dims[j] << ";\n";
+      if (sa[j]) g << "cr += j*" << sa[j] << ";\n";
+      if (sb[j]) g << "cs += j*" << sb[j] << ";\n";
+      if (sc[j]) g << "rr += j*" << sc[j] << ";\n";
     }
 
-    // Perform the actual multiplication
-    g << "*rr += *cr**cs;\n";
+    if (gemm_) {
+      // Dense matrix multiplication
+      g << g.mtimes(gemm_swap_ ? "cs" : "cr", gemm_m_, gemm_k_,
+                    gemm_swap_ ? "cr" : "cs", gemm_n_, "rr") << "\n";
+    } else {
+      // Innermost loop with pointer increments, summing in a register if invariant
+      casadi_int a = n_outer<dims.size() ? sa.back() : 0;
+      casadi_int b = n_outer<dims.size() ? sb.back() : 0;
+      casadi_int c = n_outer<dims.size() ? sc.back() : 0;
+      g.local("j", "casadi_int");
+      string inc = (a ? ", cr+=" + str(a) : "") + (b ? ", cs+=" + str(b) : "");
+      if (c==0) {
+        g.local("acc", "casadi_real");
+        g << "for (j=0, acc=0; j<" << n_inner << "; ++j" << inc << ") acc += *cr**cs;\n";
+        g << "*rr += acc;\n";
+      } else {
+        g << "for (j=0; j<" << n_inner << "; ++j" << inc << ", rr+=" << c << ") "
+          << "*rr += *cr**cs;\n";
+      }
+    }
 
     g << "}\n";
   }
@@ -103,9 +103,17 @@ namespace casadi {
               {"a", a_}, {"b", b_}, {"c", c_},
               {"iter_dims", iter_dims_},
               {"strides_a", strides_a_}, {"strides_b", strides_b_}, {"strides_c", strides_c_},
-              {"n_iter", n_iter_}};
+              {"n_iter", n_iter_}, {"gemm", gemm_}};
     }
 
+    /** \brief Reorder the loops and detect matrix multiplications
+
+        The loops are sorted by decreasing strides so that the innermost loop has
+        stride-1 (or loop-invariant) access. A contraction C[i,j] += X[i,k]*Y[k,j]
+        of column-major blocks, with X either A or B and possibly repeated over
+        the remaining (batch) loops, is evaluated with a dense matrix multiplication */
+    void plan();
+
     /// Dimensions of tensors A B C
     std::vector<casadi_int> dim_c_, dim_a_, dim_b_;
     /// Einstein indices
@@ -119,6 +127,18 @@ namespace casadi {
 
     casadi_int n_iter_;
 
+    /// Matrix multiplication, cf. plan
+    bool gemm_;
+
+    /// B is the left factor of the matrix multiplication
+    bool gemm_swap_;
+
+    /// Dimensions of the matrix multiplication
+    casadi_int gemm_m_, gemm_n_, gemm_k_;
+
+    /// Loops around the matrix multiplication
+    std::vector<casadi_int> batch_dims_, batch_a_, batch_b_, batch_c_;
+
   };
 
 
@@ -0,0 +1,359 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#include "elementwise_mx.hpp"
+#include <algorithm>
+#include <map>
+#include <sstream>
+#include <stack>
+#include "casadi_misc.hpp"
+
+using namespace std;
+
+namespace casadi {
+
+  ElementwiseMX::ElementwiseMX(const std::vector<MX>& dep, const Sparsity& sp,
+                               const std::vector<double>& c,
+                               const std::vector<casadi_int>& code) : c_(c), code_(code) {
+    casadi_assert_dev(!code_.empty() && code_.size() % 3 == 0);
+    set_dep(dep);
+    set_sparsity(sp);
+  }
+
+  bool ElementwiseMX::is_fusable(const MXNode* n) {
+    if (!n->is_unary() && !n->is_binary()) return false;
+    if (n->op()==OP_PRINTME || n->nnz()==0) return false;
+    for (casadi_int k=0; k<n->n_dep(); ++k) {
+      const MX& d = n->dep(k);
+      if (d.sparsity()!=n->sparsity() && !d.is_scalar(true)) return false;
+    }
+    return true;
+  }
+
+  MX ElementwiseMX::fuse(const MX& root, const std::vector<bool>& absorbed,
+                         const std::vector<MX>& leaf) {
+    // Collect the nodes of the tree
+    vector<MXNode*> tree;
+    stack<MXNode*> s;
+    s.push(root.get());
+    while (!s.empty()) {
+      MXNode* n = s.top();
+      s.pop();
+      tree.push_back(n);
+      for (casadi_int k=0; k<n->n_dep(); ++k) {
+        if (absorbed.at(n->dep(k)->temp)) s.push(n->dep(k).get());
+      }
+    }
+
+    // Topological order, cf. the temp field
+    sort(tree.begin(), tree.end(),
+         [](const MXNode* a, const MXNode* b) { return a->temp < b->temp;});
+    map<casadi_int, casadi_int> instr;
+    for (casadi_int i=0; i<tree.size(); ++i) instr[tree[i]->temp] = i;
+
+    // Operands, tagged as dependency (0), constant (1) or instruction (2)
+    vector<MX> dep;
+    map<const MXNode*, casadi_int> dep_ind;
+    vector<double> c;
+    vector<pair<casadi_int, casadi_int> > operand;
+    vector<casadi_int> op;
+    for (MXNode* n : tree) {
+      op.push_back(n->op());
+      for (casadi_int k=0; k<2; ++k) {
+        // Second operand of a unary operation is a copy of the first
+        const MX& d = n->dep(k<n->n_dep() ? k : 0);
+        if (absorbed.at(d->temp)) {
+          operand.push_back(make_pair(2, instr.at(d->temp)));
+        } else if (d.is_constant() && d.is_scalar(true)) {
+          operand.push_back(make_pair(1, c.size()));
+          c.push_back(static_cast<double>(d));
+        } else {
+          auto it = dep_ind.find(d.get());
+          if (it==dep_ind.end()) {
+            it = dep_ind.insert(make_pair(d.get(), dep.size())).first;
+            dep.push_back(leaf.at(d->temp));
+          }
+          operand.push_back(make_pair(0, it->second));
+        }
+      }
+    }
+
+    // Assemble the instructions
+    casadi_int offset[3] = {0, static_cast<casadi_int>(dep.size()),
+                            static_cast<casadi_int>(dep.size()+c.size())};
+    vector<casadi_int> code;
+    code.reserve(3*op.size());
+    for (casadi_int i=0; i<op.size(); ++i) {
+      code.push_back(op[i]);
+      for (casadi_int k=0; k<2; ++k) {
+        const pair<casadi_int, casadi_int>& a = operand[2*i+k];
+        code.push_back(offset[a.first] + a.second);
+      }
+    }
+    return MX::create(new ElementwiseMX(dep, root.sparsity(), c, code));
+  }
+
+  casadi_int ElementwiseMX::block_size() const {
+    return min(nnz(), casadi_int(256));
+  }
+
+  bool ElementwiseMX::is_scalar_operand(casadi_int k) const {
+    if (k<n_dep()) return dep(k).nnz()!=nnz();
+    return k<n_dep()+c_.size();
+  }
+
+  size_t ElementwiseMX::sz_w() const {
+    return (code_.size()/3-1)*block_size();
+  }
+
+  std::string ElementwiseMX::disp(const std::vector<std::string>& arg) const {
+    casadi_int nd = n_dep(), nc = c_.size(), ni = code_.size()/3;
+    vector<string> s(arg.begin(), arg.end());
+    for (double c : c_) s.push_back(str(c));
+    for (casadi_int i=0; i<ni; ++i) {
+      casadi_int op = code_[3*i];
+      string x = s.at(code_[3*i+1]), y = s.at(code_[3*i+2]);
+      s.push_back(casadi_math<double>::is_binary(op) ? casadi_math<double>::print(op, x, y)
+                  : casadi_math<double>::print(op, x));
+    }
+    casadi_assert_dev(s.size()==nd+nc+ni);
+    return s.back();
+  }
+
+  int ElementwiseMX::eval(const double** arg, double** res, casadi_int* iw, double* w) const {
+    return eval_gen<double>(arg, res, iw, w);
+  }
+
+  int ElementwiseMX::eval_sx(const SXElem** arg, SXElem** res, casadi_int* iw, SXElem* w) const {
+    return eval_gen<SXElem>(arg, res, iw, w);
+  }
+
+  template<typename T>
+  int ElementwiseMX::eval_gen(const T** arg, T** res, casadi_int* iw, T* w) const {
+    casadi_int n = nnz(), nd = n_dep(), nc = c_.size(), ni = code_.size()/3;
+    casadi_int bs = block_size();
+    // Evaluate a block at a time, keeping the intermediate results in cache
+    for (casadi_int k0=0; k0<n; k0+=bs) {
+      casadi_int m = min(bs, n-k0);
+      for (casadi_int i=0; i<ni; ++i) {
+        casadi_int op = code_[3*i];
+        // Operands, vector (p) or scalar (v)
+        const T* p[2];
+        T v[2];
+        for (casadi_int j=0; j<2; ++j) {
+          casadi_int k = code_[3*i+1+j];
+          if (k<nd) {
+            if (is_scalar_operand(k)) {
+              p[j] = nullptr;
+              v[j] = arg[k][0];
+            } else {
+              p[j] = arg[k]+k0;
+            }
+          } else if (k<nd+nc) {
+            p[j] = nullptr;
+            v[j] = c_[k-nd];
+          } else {
+            p[j] = w+(k-nd-nc)*bs;
+          }
+        }
+        // Last instruction writes to the result
+        T* f = i==ni-1 ? res[0]+k0 : w+i*bs;
+        if (p[0] && p[1]) {
+          casadi_math<T>::fun(op, p[0], p[1], f, m);
+        } else if (p[0]) {
+          casadi_math<T>::fun(op, p[0], v[1], f, m);
+        } else if (p[1]) {
+          casadi_math<T>::fun(op, v[0], p[1], f, m);
+        } else {
+          casadi_math<T>::fun(op, v[0], v[1], f[0]);
+          std::fill(f+1, f+m, f[0]);
+        }
+      }
+    }
+    return 0;
+  }
+
+  std::vector<MX> ElementwiseMX::replay(const std::vector<MX>& arg) const {
+    casadi_int ni = code_.size()/3;
+    vector<MX> v(arg.begin(), arg.end());
+    for (double c : c_) v.push_back(c);
+    for (casadi_int i=0; i<ni; ++i) {
+      MX f;
+      casadi_math<MX>::fun(code_[3*i], v.at(code_[3*i+1]), v.at(code_[3*i+2]), f);
+      v.push_back(f);
+    }
+    return v;
+  }
+
+  void ElementwiseMX::eval_mx(const std::vector<MX>& arg, std::vector<MX>& res) const {
+    res[0] = replay(arg).back();
+  }
+
+  void ElementwiseMX::ad_forward(const std::vector<std::vector<MX> >& fseed,
+                                 std::vector<std::vector<MX> >& fsens) const {
+    casadi_int nd = n_dep(), ni = code_.size()/3, nv = nd + c_.size() + ni;
+
+    // Intermediate results and partial derivatives
+    vector<MX> v = replay(dep_);
+    v.back() = shared_from_this<MX>();
+    vector<MX> pd(2*ni);
+    for (casadi_int i=0; i<ni; ++i) {
+      casadi_math<MX>::der(code_[3*i], v[code_[3*i+1]], v[code_[3*i+2]], v[nv-ni+i], &pd[2*i]);
+    }
+
+    // Propagate forward seeds, constants have no sensitivities
+    for (casadi_int d=0; d<fsens.size(); ++d) {
+      vector<MX> t(nv);
+      vector<bool> nz(nv, false);
+      copy(fseed[d].begin(), fseed[d].end(), t.begin());
+      fill(nz.begin(), nz.begin()+nd, true);
+      for (casadi_int i=0; i<ni; ++i) {
+        bool binary = casadi_math<double>::is_binary(code_[3*i]);
+        casadi_int r = nv-ni+i;
+        for (casadi_int j=0; j<(binary ? 2 : 1); ++j) {
+          casadi_int k = code_[3*i+1+j];
+          if (!nz[k]) continue;
+          t[r] = nz[r] ? t[r] + pd[2*i+j]*t[k] : pd[2*i+j]*t[k];
+          nz[r] = true;
+        }
+      }
+      MX& r = t.back();
+      if (!nz.back()) r = MX(size());
+      if (r.sparsity()!=sparsity() && r.is_scalar()) r = MX(sparsity(), r);
+      fsens[d][0] = r;
+    }
+  }
+
+  void ElementwiseMX::ad_reverse(const std::vector<std::vector<MX> >& aseed,
+                                 std::vector<std::vector<MX> >& asens) const {
+    casadi_int nd = n_dep(), nc = c_.size(), ni = code_.size()/3, nv = nd + nc + ni;
+
+    // Intermediate results and partial derivatives
+    vector<MX> v = replay(dep_);
+    v.back() = shared_from_this<MX>();
+    vector<MX> pd(2*ni);
+    for (casadi_int i=0; i<ni; ++i) {
+      casadi_math<MX>::der(code_[3*i], v[code_[3*i+1]], v[code_[3*i+2]], v[nv-ni+i], &pd[2*i]);
+    }
+
+    // Propagate adjoint seeds
+    for (casadi_int d=0; d<aseed.size(); ++d) {
+      vector<MX> t(nv);
+      vector<bool> nz(nv, false);
+      t.back() = aseed[d][0];
+      nz.back() = true;
+      for (casadi_int i=ni-1; i>=0; --i) {
+        if (!nz[nv-ni+i]) continue;
+        const MX& s = t[nv-ni+i];
+        bool binary = casadi_math<double>::is_binary(code_[3*i]);
+        for (casadi_int j=0; j<(binary ? 2 : 1); ++j) {
+          casadi_int k = code_[3*i+1+j];
+          if (k>=nd && k<nd+nc) continue;
+          MX a = pd[2*i+j]*s;
+          // Sum the entries of a broadcast scalar
+          if (k<nd && is_scalar_operand(k) && !a.is_scalar()) a = sum2(sum1(a));
+          t[k] = nz[k] ? t[k] + a : a;
+          nz[k] = true;
+        }
+      }
+      for (casadi_int k=0; k<nd; ++k) {
+        if (nz[k]) asens[d][k] += t[k];
+      }
+    }
+  }
+
+  int ElementwiseMX::sp_forward(const bvec_t** arg, bvec_t** res,
+                                casadi_int* iw, bvec_t* w) const {
+    casadi_int n = nnz(), nd = n_dep();
+    for (casadi_int k=0; k<n; ++k) {
+      bvec_t r = 0;
+      for (casadi_int j=0; j<nd; ++j) {
+        if (arg[j]) r |= arg[j][is_scalar_operand(j) ? 0 : k];
+      }
+      res[0][k] = r;
+    }
+    return 0;
+  }
+
+  int ElementwiseMX::sp_reverse(bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w) const {
+    casadi_int n = nnz(), nd = n_dep();
+    for (casadi_int k=0; k<n; ++k) {
+      bvec_t s = res[0][k];
+      res[0][k] = 0;
+      for (casadi_int j=0; j<nd; ++j) {
+        if (arg[j]) arg[j][is_scalar_operand(j) ? 0 : k] |= s;
+      }
+    }
+    return 0;
+  }
+
+  std::string ElementwiseMX::codegen_operand(CodeGenerator& g,
+                                             const std::vector<casadi_int>& arg,
+                                             casadi_int k) const {
+    if (k>=n_dep()) return " " + g.constant(c_.at(k-n_dep())) + " ";
+    if (nnz()==1 || is_scalar_operand(k)) return g.workel(arg[k]);
+    return g.work(arg[k], nnz()) + "[i]";
+  }
+
+  void ElementwiseMX::generate(CodeGenerator& g,
+                               const std::vector<casadi_int>& arg,
+                               const std::vector<casadi_int>& res) const {
+    casadi_int nd = n_dep(), nc = c_.size(), ni = code_.size()/3;
+
+    // Expression for each instruction, the operations form a tree
+    vector<string> s(ni);
+    for (casadi_int i=0; i<ni; ++i) {
+      casadi_int op = code_[3*i];
+      string x[2];
+      for (casadi_int j=0; j<2; ++j) {
+        casadi_int k = code_[3*i+1+j];
+        x[j] = k<nd+nc ? codegen_operand(g, arg, k) : s[k-nd-nc];
+      }
+      s[i] = casadi_math<double>::is_binary(op) ? g.print_op(op, x[0], x[1])
+             : g.print_op(op, x[0]);
+    }
+
+    // Single loop over the nonzeros
+    string r;
+    if (nnz()==1) {
+      r = g.workel(res[0]);
+    } else {
+      g.local("rr", "casadi_real", "*");
+      g.local("i", "casadi_int");
+      g << "for (i=0, rr=" << g.work(res[0], nnz()) << "; i<" << nnz() << "; ++i) ";
+      r = "rr[i]";
+    }
+    g << r << " = " << s.back() << ";\n";
+  }
+
+  bool ElementwiseMX::is_equal(const MXNode* node, casadi_int depth) const {
+    if (!sameOpAndDeps(node, depth)) return false;
+    const ElementwiseMX* n = dynamic_cast<const ElementwiseMX*>(node);
+    if (n==nullptr) return false;
+    return sparsity()==n->sparsity() && c_==n->c_ && code_==n->code_;
+  }
+
+} // namespace casadi
@@ -0,0 +1,136 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#ifndef CASADI_ELEMENTWISE_MX_HPP
+#define CASADI_ELEMENTWISE_MX_HPP
+
+#include "mx_node.hpp"
+/// \cond INTERNAL
+
+namespace casadi {
+  /** \brief A chain of elementwise operations evaluated in a single loop
+
+      The operations form a tree with the dependencies and scalar constants as leaves.
+      The instructions are stored as (op, x, y) triplets, where operand k refers to
+      dependency k if k<n_dep(), to constant k-n_dep() if k<n_dep()+c_.size() and to
+      the result of an earlier instruction otherwise. The last instruction is the result.
+      Dependencies have the sparsity pattern of the node or are scalars.
+  */
+  class CASADI_EXPORT ElementwiseMX : public MXNode {
+  public:
+
+    /** \brief  Constructor */
+    ElementwiseMX(const std::vector<MX>& dep, const Sparsity& sp,
+                  const std::vector<double>& c, const std::vector<casadi_int>& code);
+
+    /** \brief  Destructor */
+    ~ElementwiseMX() override {}
+
+    /** \brief Can the node be part of a fused kernel */
+    static bool is_fusable(const MXNode* n);
+
+    /** \brief Fuse an elementwise node with the dependencies marked by \a absorbed
+
+        The arguments are indexed by the temp field of the nodes, the remaining
+        dependencies are replaced by \a leaf */
+    static MX fuse(const MX& root, const std::vector<bool>& absorbed,
+                   const std::vector<MX>& leaf);
+
+    /** \brief  Print expression */
+    std::string disp(const std::vector<std::string>& arg) const override;
+
+    /// Evaluate the function (template)
+    template<typename T>
+    int eval_gen(const T** arg, T** res, casadi_int* iw, T* w) const;
+
+    /// Evaluate the function numerically
+    int eval(const double** arg, double** res, casadi_int* iw, double* w) const override;
+
+    /// Evaluate the function symbolically (SX)
+    int eval_sx(const SXElem** arg, SXElem** res, casadi_int* iw, SXElem* w) const override;
+
+    /** \brief  Evaluate symbolically (MX) */
+    void eval_mx(const std::vector<MX>& arg, std::vector<MX>& res) const override;
+
+    /** \brief Calculate forward mode directional derivatives */
+    void ad_forward(const std::vector<std::vector<MX> >& fseed,
+                         std::vector<std::vector<MX> >& fsens) const override;
+
+    /** \brief Calculate reverse mode directional derivatives */
+    void ad_reverse(const std::vector<std::vector<MX> >& aseed,
+                         std::vector<std::vector<MX> >& asens) const override;
+
+    /** \brief  Propagate sparsity forward */
+    int sp_forward(const bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w) const override;
+
+    /** \brief  Propagate sparsity backwards */
+    int sp_reverse(bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w) const override;
+
+    /** \brief Generate code for the operation */
+    void generate(CodeGenerator& g,
+                  const std::vector<casadi_int>& arg,
+                  const std::vector<casadi_int>& res) const override;
+
+    /** \brief Get the operation */
+    casadi_int op() const override { return OP_ELEMENTWISE;}
+
+    /// Can the operation be performed inplace (i.e. overwrite the result)
+    casadi_int n_inplace() const override { return n_dep();}
+
+    /** \brief Get required length of w field */
+    size_t sz_w() const override;
+
+    /** \brief Check if two nodes are equivalent up to a given depth */
+    bool is_equal(const MXNode* node, casadi_int depth) const override;
+
+    /** Obtain information about node */
+    Dict info() const override { return {{"constants", c_}, {"code", code_}}; }
+
+    /// Constants
+    std::vector<double> c_;
+
+    /// Instructions, (op, x, y) triplets
+    std::vector<casadi_int> code_;
+
+  private:
+    /// Number of elements evaluated per block
+    casadi_int block_size() const;
+
+    /// Is an operand a scalar
+    bool is_scalar_operand(casadi_int k) const;
+
+    /// Replay the instructions on MX, returns the values of all operands
+    std::vector<MX> replay(const std::vector<MX>& arg) const;
+
+    /// Expression for an operand in generated code
+    std::string codegen_operand(CodeGenerator& g, const std::vector<casadi_int>& arg,
+                                casadi_int k) const;
+  };
+
+} // namespace casadi
+/// \endcond
+
+#endif // CASADI_ELEMENTWISE_MX_HPP
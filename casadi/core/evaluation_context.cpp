@@ -0,0 +1,129 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#include "evaluation_context.hpp"
+#include "function_internal.hpp"
+
+using namespace std;
+
+namespace casadi {
+
+  EvaluationContext::EvaluationContext(const Function& f) : f_(f) {
+    mem_ = f_.checkout();
+    arg_.resize(f_.sz_arg());
+    res_.resize(f_.sz_res());
+    iw_.resize(f_.sz_iw());
+    w_.resize(f_.sz_w());
+    arg_dm_.resize(f_.n_in());
+    casadi_int max_nrow = 0;
+    for (casadi_int i=0; i<f_.n_in(); ++i) {
+      arg_dm_[i] = DM::zeros(f_.sparsity_in(i));
+      max_nrow = std::max(max_nrow, f_.size1_in(i));
+    }
+    w_proj_.resize(max_nrow);
+    res_dm_.resize(f_.n_out());
+    for (casadi_int i=0; i<f_.n_out(); ++i) {
+      res_dm_[i] = DM::zeros(f_.sparsity_out(i));
+      res_dict_[f_.name_out(i)] = DM::zeros(f_.sparsity_out(i));
+    }
+  }
+
+  EvaluationContext::~EvaluationContext() {
+    f_.release(mem_);
+  }
+
+  void EvaluationContext::set_arg(casadi_int i, const DM& a) {
+    const Sparsity& sp = f_.sparsity_in(i);
+    DM& a_dm = arg_dm_[i];
+    if (a.sparsity()==sp) {
+      // Use directly
+      arg_[i] = a.ptr();
+      return;
+    } else if (a.size()==sp.size()) {
+      // Project into the buffer
+      casadi_project(a.ptr(), a.sparsity(), a_dm.ptr(), sp, get_ptr(w_proj_));
+    } else if (a.is_empty()) {
+      // Empty matrix means set zero
+      std::fill(a_dm.nonzeros().begin(), a_dm.nonzeros().end(), 0);
+    } else if (a.is_scalar()) {
+      // Scalar assign means set all
+      std::fill(a_dm.nonzeros().begin(), a_dm.nonzeros().end(), a.scalar());
+    } else {
+      // Other conversions, e.g. transposed vectors
+      DM r = replace_mat(a, sp, 1);
+      casadi_assert(r.size()==sp.size(), "Input " + str(i) + " (" + f_.name_in(i)
+        + ") has mismatching shape. Got " + a.dim() + ", expected " + sp.dim() + ".");
+      a_dm = project(r, sp);
+    }
+    arg_[i] = a_dm.ptr();
+  }
+
+  void EvaluationContext::set_res(casadi_int i, DM& r) {
+    if (r.sparsity()!=f_.sparsity_out(i)) r = DM::zeros(f_.sparsity_out(i));
+    res_[i] = r.ptr();
+  }
+
+  void EvaluationContext::eval() {
+    if (f_(get_ptr(arg_), get_ptr(res_), get_ptr(iw_), get_ptr(w_), mem_)) {
+      casadi_error("Evaluation of " + f_.name() + " failed");
+    }
+  }
+
+  void EvaluationContext::call(const std::vector<DM>& arg, std::vector<DM>& res) {
+    casadi_assert(arg.size()==f_.n_in(), "Incorrect number of inputs: Expected "
+                  + str(f_.n_in()) + ", got " + str(arg.size()));
+    for (casadi_int i=0; i<arg.size(); ++i) set_arg(i, arg[i]);
+    res.resize(f_.n_out());
+    for (casadi_int i=0; i<res.size(); ++i) set_res(i, res[i]);
+    eval();
+  }
+
+  void EvaluationContext::call(const DMDict& arg, DMDict& res) {
+    // Default inputs, unless provided
+    for (casadi_int i=0; i<f_.n_in(); ++i) arg_[i] = nullptr;
+    for (auto&& e : arg) set_arg(f_.index_in(e.first), e.second);
+    for (casadi_int i=0; i<f_.n_in(); ++i) {
+      if (arg_[i]) continue;
+      DM& a_dm = arg_dm_[i];
+      std::fill(a_dm.nonzeros().begin(), a_dm.nonzeros().end(), f_.default_in(i));
+      arg_[i] = a_dm.ptr();
+    }
+    // Outputs, reused if present
+    for (casadi_int i=0; i<f_.n_out(); ++i) set_res(i, res[f_.name_out(i)]);
+    eval();
+  }
+
+  const std::vector<DM>& EvaluationContext::operator()(const std::vector<DM>& arg) {
+    call(arg, res_dm_);
+    return res_dm_;
+  }
+
+  const DMDict& EvaluationContext::operator()(const DMDict& arg) {
+    call(arg, res_dict_);
+    return res_dict_;
+  }
+
+} // namespace casadi
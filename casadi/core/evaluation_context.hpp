@@ -0,0 +1,113 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#ifndef CASADI_EVALUATION_CONTEXT_HPP
+#define CASADI_EVALUATION_CONTEXT_HPP
+
+#include "function.hpp"
+
+namespace casadi {
+
+#ifndef SWIG
+  /** \brief Buffers for repeated numerical evaluation of a Function
+   *
+   * Owns a memory object of the function, the work vectors and the outputs. After the
+   * first call, repeated calls perform no heap allocation provided that the inputs have
+   * the sparsity patterns of the function inputs, or are scalars or empty, and that
+   * the outputs passed to call are reused. Other inputs are converted as in
+   * Function::call, at the cost of an allocation. Mapped evaluation is not supported.
+   *
+   * An evaluation context must not be used by several threads at the same time, but
+   * several contexts of the same function can.
+   */
+  class CASADI_EXPORT EvaluationContext {
+  public:
+    /// Constructor, checks out a memory object of f
+    explicit EvaluationContext(const Function& f);
+
+    /// Destructor, releases the memory object
+    ~EvaluationContext();
+
+    /// Not copyable
+    EvaluationContext(const EvaluationContext&) = delete;
+    EvaluationContext& operator=(const EvaluationContext&) = delete;
+
+    ///@{
+    /// Evaluate, the outputs are owned by the context and valid until the next call
+    const std::vector<DM>& operator()(const std::vector<DM>& arg);
+    const DMDict& operator()(const DMDict& arg);
+    ///@}
+
+    ///@{
+    /** \brief Evaluate into outputs, which are reused if they have the right sparsity
+     * Missing entries of a dictionary input take the default values */
+    void call(const std::vector<DM>& arg, std::vector<DM>& res);
+    void call(const DMDict& arg, DMDict& res);
+    ///@}
+
+    /// The function
+    const Function& function() const { return f_;}
+
+    /// Index of the memory object, e.g. for Function::stats
+    casadi_int mem() const { return mem_;}
+
+  private:
+    /// Point to an input, converted if needed
+    void set_arg(casadi_int i, const DM& a);
+
+    /// Point to an output, reallocated if needed
+    void set_res(casadi_int i, DM& r);
+
+    /// Evaluate with the current pointers
+    void eval();
+
+    // Function
+    Function f_;
+
+    // Memory object
+    casadi_int mem_;
+
+    // Work vectors
+    std::vector<const double*> arg_;
+    std::vector<double*> res_;
+    std::vector<casadi_int> iw_;
+    std::vector<double> w_;
+
+    // Inputs that needed to be converted, with the sparsity of the function inputs
+    std::vector<DM> arg_dm_;
+
+    // Work vector for projecting inputs
+    std::vector<double> w_proj_;
+
+    // Owned outputs
+    std::vector<DM> res_dm_;
+    DMDict res_dict_;
+  };
+#endif // SWIG
+
+} // namespace casadi
+
+#endif // CASADI_EVALUATION_CONTEXT_HPP
@@ -0,0 +1,272 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#include "evaluation_hook.hpp"
+#include "exception.hpp"
+#include "casadi_misc.hpp"
+#include <cstring>
+#include <iomanip>
+#include <map>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif // __linux__
+
+#ifdef CASADI_WITH_THREAD
+#ifdef CASADI_WITH_THREAD_MINGW
+#include <mingw.mutex.h>
+#else // CASADI_WITH_THREAD_MINGW
+#include <mutex>
+#endif // CASADI_WITH_THREAD_MINGW
+#include <atomic>
+#endif //CASADI_WITH_THREAD
+
+namespace casadi {
+
+  EvaluationHook* EvaluationHook::active = nullptr;
+
+  // Counters of a single thread
+  struct PerfEventThread {
+    // File descriptors of the counters, the first is the group leader
+    std::vector<int> fd;
+    // Counter values at the beginning of the active evaluations
+    std::vector<std::vector<casadi_int> > stack;
+    // Could the counters be opened
+    bool ok;
+  };
+
+  struct PerfEventHook::Internal {
+    // Unique identifier, distinguishes hooks allocated at the same address
+    casadi_int id;
+    // Counter names, perf_event types and configurations
+    std::vector<std::string> counters;
+    std::vector<std::pair<casadi_int, casadi_int> > config;
+    // Counters of every thread
+    std::map<casadi_int, std::unique_ptr<PerfEventThread> > threads;
+    // Accumulated number of calls, followed by the counts, per function
+    std::map<std::string, std::vector<casadi_int> > counts;
+#ifdef CASADI_WITH_THREAD
+    std::mutex mtx;
+#endif //CASADI_WITH_THREAD
+  };
+
+  namespace {
+
+    // Lookup counter type and configuration
+    bool perf_config(const std::string& name, std::pair<casadi_int, casadi_int>& c) {
+#ifdef __linux__
+      static const std::map<std::string, std::pair<casadi_int, casadi_int> > known = {
+        {"cycles", {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES}},
+        {"instructions", {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS}},
+        {"cache_references", {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES}},
+        {"cache_misses", {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES}},
+        {"branches", {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_INSTRUCTIONS}},
+        {"branch_misses", {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES}},
+        {"task_clock", {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK}},
+        {"page_faults", {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS}},
+        {"context_switches", {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES}}};
+      auto it = known.find(name);
+      if (it==known.end()) return false;
+      c = it->second;
+      return true;
+#else // __linux__
+      return false;
+#endif // __linux__
+    }
+
+    // Open a group of counters for the calling thread, returns false on failure
+    bool perf_open(const std::vector<std::pair<casadi_int, casadi_int> >& config,
+                   std::vector<int>& fd) {
+#ifdef __linux__
+      for (auto&& c : config) {
+        struct perf_event_attr pe;
+        memset(&pe, 0, sizeof(pe));
+        pe.size = sizeof(pe);
+        pe.type = c.first;
+        pe.config = c.second;
+        pe.exclude_kernel = 1;
+        pe.exclude_hv = 1;
+        pe.read_format = PERF_FORMAT_GROUP;
+        int f = syscall(__NR_perf_event_open, &pe, 0, -1, fd.empty() ? -1 : fd.front(), 0);
+        if (f<0) {
+          for (int e : fd) close(e);
+          fd.clear();
+          return false;
+        }
+        fd.push_back(f);
+      }
+      return true;
+#else // __linux__
+      return false;
+#endif // __linux__
+    }
+
+    // Read a group of counters
+    bool perf_read(const std::vector<int>& fd, std::vector<casadi_int>& v) {
+#ifdef __linux__
+      // Number of counters, followed by the values
+      uint64_t buf[16];
+      casadi_int n = fd.size();
+      ssize_t sz = (n+1)*sizeof(uint64_t);
+      if (read(fd.front(), buf, sz)!=sz || buf[0]!=n) return false;
+      v.resize(n);
+      for (casadi_int i=0; i<n; ++i) v[i] = static_cast<casadi_int>(buf[i+1]);
+      return true;
+#else // __linux__
+      return false;
+#endif // __linux__
+    }
+
+    void perf_close(const std::vector<int>& fd) {
+#ifdef __linux__
+      for (int e : fd) close(e);
+#endif // __linux__
+    }
+
+    // Counters of the calling thread, cached for the hook with a given identifier
+    thread_local casadi_int perf_cache_hook = -1;
+    thread_local PerfEventThread* perf_cache_thread = nullptr;
+
+    // Next hook identifier
+#ifdef CASADI_WITH_THREAD
+    std::atomic<casadi_int> perf_next_id(0);
+#else // CASADI_WITH_THREAD
+    casadi_int perf_next_id = 0;
+#endif //CASADI_WITH_THREAD
+
+  } // namespace
+
+  PerfEventHook::PerfEventHook(const std::vector<std::string>& counters)
+    : p_(new Internal()) {
+    p_->id = perf_next_id++;
+    casadi_assert(!counters.empty() && counters.size()<16,
+                  "PerfEventHook: Between 1 and 15 counters are supported");
+    p_->counters = counters;
+    for (auto&& c : counters) {
+      std::pair<casadi_int, casadi_int> cf;
+      casadi_assert(perf_config(c, cf), "PerfEventHook: Unknown counter '" + c + "'");
+      p_->config.push_back(cf);
+    }
+    casadi_assert(is_available(counters),
+                  "PerfEventHook: Cannot open the counters " + str(counters) + ", "
+                  "check /proc/sys/kernel/perf_event_paranoid");
+  }
+
+  PerfEventHook::~PerfEventHook() {
+    if (active==this) active = nullptr;
+    for (auto&& t : p_->threads) perf_close(t.second->fd);
+  }
+
+  bool PerfEventHook::is_available(const std::vector<std::string>& counters) {
+    std::vector<std::pair<casadi_int, casadi_int> > config;
+    for (auto&& c : counters) {
+      std::pair<casadi_int, casadi_int> cf;
+      if (!perf_config(c, cf)) return false;
+      config.push_back(cf);
+    }
+    std::vector<int> fd;
+    if (!perf_open(config, fd)) return false;
+    std::vector<casadi_int> v;
+    bool ok = perf_read(fd, v);
+    perf_close(fd);
+    return ok;
+  }
+
+  void PerfEventHook::begin(const std::string& name, casadi_int mem, casadi_int thread) {
+    if (perf_cache_hook!=p_->id) {
+      // Find or open the counters of the thread
+#ifdef CASADI_WITH_THREAD
+      std::lock_guard<std::mutex> lock(p_->mtx);
+#endif //CASADI_WITH_THREAD
+      std::unique_ptr<PerfEventThread>& t = p_->threads[thread];
+      if (!t) {
+        t.reset(new PerfEventThread());
+        t->ok = perf_open(p_->config, t->fd);
+      }
+      perf_cache_hook = p_->id;
+      perf_cache_thread = t.get();
+    }
+    PerfEventThread& t = *perf_cache_thread;
+    t.stack.emplace_back();
+    if (t.ok && !perf_read(t.fd, t.stack.back())) t.stack.back().clear();
+  }
+
+  void PerfEventHook::end(const std::string& name, casadi_int mem, casadi_int thread) {
+    if (perf_cache_hook!=p_->id || perf_cache_thread->stack.empty()) {
+      // Evaluation started before the hook was installed
+      return;
+    }
+    PerfEventThread& t = *perf_cache_thread;
+    std::vector<casadi_int> v0 = std::move(t.stack.back()), v;
+    t.stack.pop_back();
+    if (v0.empty() || !perf_read(t.fd, v)) return;
+#ifdef CASADI_WITH_THREAD
+    std::lock_guard<std::mutex> lock(p_->mtx);
+#endif //CASADI_WITH_THREAD
+    std::vector<casadi_int>& c = p_->counts[name];
+    if (c.empty()) c.resize(v.size()+1, 0);
+    c[0]++;
+    for (casadi_int i=0; i<v.size(); ++i) c[i+1] += v[i]-v0[i];
+  }
+
+  Dict PerfEventHook::stats() const {
+#ifdef CASADI_WITH_THREAD
+    std::lock_guard<std::mutex> lock(p_->mtx);
+#endif //CASADI_WITH_THREAD
+    Dict ret;
+    for (auto&& e : p_->counts) {
+      Dict d = {{"n_call", e.second[0]}};
+      for (casadi_int i=0; i<p_->counters.size(); ++i) d[p_->counters[i]] = e.second[i+1];
+      ret[e.first] = d;
+    }
+    return ret;
+  }
+
+  void PerfEventHook::reset() {
+#ifdef CASADI_WITH_THREAD
+    std::lock_guard<std::mutex> lock(p_->mtx);
+#endif //CASADI_WITH_THREAD
+    p_->counts.clear();
+  }
+
+  void PerfEventHook::print(std::ostream& stream) const {
+#ifdef CASADI_WITH_THREAD
+    std::lock_guard<std::mutex> lock(p_->mtx);
+#endif //CASADI_WITH_THREAD
+    stream << std::setw(24) << std::left << "function" << std::right << std::setw(10)
+           << "n_call";
+    for (auto&& c : p_->counters) stream << std::setw(18) << c;
+    stream << std::endl;
+    for (auto&& e : p_->counts) {
+      stream << std::setw(24) << std::left << e.first << std::right
+             << std::setw(10) << e.second[0];
+      for (casadi_int i=1; i<e.second.size(); ++i) stream << std::setw(18) << e.second[i];
+      stream << std::endl;
+    }
+  }
+
+} // namespace casadi
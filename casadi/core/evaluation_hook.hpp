@@ -0,0 +1,106 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#ifndef CASADI_EVALUATION_HOOK_HPP
+#define CASADI_EVALUATION_HOOK_HPP
+
+#include "generic_type.hpp"
+#include <memory>
+
+namespace casadi {
+
+#ifndef SWIG
+  /** \brief Callbacks around every numerical Function evaluation
+   *
+   * Install with GlobalOptions::setEvaluationHook. The callbacks are made by the
+   * evaluating thread, also for nested evaluations, and must hence be thread-safe.
+   * When no hook is installed, the cost per evaluation is a single test.
+   *
+   * \param name Name of the evaluated function
+   * \param mem Index of the memory object of the evaluation
+   * \param thread Index of the evaluating thread, in order of the first evaluation
+   */
+  class CASADI_EXPORT EvaluationHook {
+  public:
+    virtual ~EvaluationHook() {}
+
+    /// Called before an evaluation
+    virtual void begin(const std::string& name, casadi_int mem, casadi_int thread) = 0;
+
+    /// Called after an evaluation, also if it failed
+    virtual void end(const std::string& name, casadi_int mem, casadi_int thread) = 0;
+
+    /// The installed hook, nullptr if none
+    static EvaluationHook* active;
+  };
+
+  /** \brief Hardware and software counters of every function, using Linux perf_event
+   *
+   * The counters of the evaluating thread are read at the beginning and end of every
+   * evaluation and accumulated per function, inclusive of the nested evaluations.
+   * Available counters: "cycles", "instructions", "cache_references", "cache_misses",
+   * "branches", "branch_misses" (hardware) and "task_clock" [ns], "page_faults",
+   * "context_switches" (software). Whether they can be opened depends on the platform
+   * and on /proc/sys/kernel/perf_event_paranoid.
+   */
+  class CASADI_EXPORT PerfEventHook : public EvaluationHook {
+  public:
+    /// Constructor, fails if the counters cannot be opened
+    explicit PerfEventHook(const std::vector<std::string>& counters
+      = {"cycles", "instructions", "cache_misses", "branch_misses"});
+
+    /// Destructor
+    ~PerfEventHook() override;
+
+    /// Can the counters be opened on this platform?
+    static bool is_available(const std::vector<std::string>& counters
+      = {"cycles", "instructions", "cache_misses", "branch_misses"});
+
+    ///@{
+    /// Read the counters of the evaluating thread
+    void begin(const std::string& name, casadi_int mem, casadi_int thread) override;
+    void end(const std::string& name, casadi_int mem, casadi_int thread) override;
+    ///@}
+
+    /// Accumulated counts per function: {name: {"n_call": ..., counter: ...}}
+    Dict stats() const;
+
+    /// Discard the accumulated counts
+    void reset();
+
+    /// Print the accumulated counts
+    void print(std::ostream& stream=casadi::uout()) const;
+
+    /// Internal data, opaque
+    struct Internal;
+
+  private:
+    std::unique_ptr<Internal> p_;
+  };
+#endif // SWIG
+
+} // namespace casadi
+
+#endif // CASADI_EVALUATION_HOOK_HPP
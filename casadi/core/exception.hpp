@@ -126,15 +126,19 @@ if (!(x)) casadi_error("Assertion \"" CASADI_STR(x) "\" failed:\n"\
 // This assertion if for internal errors caused by bugs in CasADi
 #define casadi_report() casadi_error("Notify the CasADi developers.")
 
+// Log a record, the message is only formatted if the level is enabled
+#define casadi_log(level, msg) \
+  if (!casadi::Logger::enabled(level)) {} else { \
+    std::stringstream casadi_log_ss; \
+    casadi_log_ss << msg; \
+    casadi::Logger::log(level, CASADI_WHERE, casadi_log_ss.str()); \
+  }
+
 // Issue a warning, including location in the source code
-#define casadi_warning(msg) \
-  casadi::message_prefix(casadi::uerr()) \
-    << " WARNING(\"" << msg << "\") [" << CASADI_WHERE << "]\n" << std::flush;
+#define casadi_warning(msg) casadi_log(casadi::Logger::LOG_WARNING, msg)
 
 // Issue a message, including location in the source code
-#define casadi_message(msg) \
-  casadi::message_prefix(casadi::uout()) \
-    << " MESSAGE(\"" << msg << "\") [" << CASADI_WHERE << "]\n" << std::flush;
+#define casadi_message(msg) casadi_log(casadi::Logger::LOG_INFO, msg)
 
 } // namespace casadi
 
@@ -123,7 +123,9 @@ namespace casadi {
       DM N = DM::zeros(A_.size());
 
       MX extended = MX::blockcat({{A, Adot}, {N, A}});
-      MX R = expm(extended*t);
+      // Frechet derivative as the upper right block, computed with the same plugin
+      Function ext = expmsol(name + "_ext", plugin_name(), extended.sparsity());
+      MX R = ext(std::vector<MX>{extended, t}).at(0);
 
       Ydot += R(Slice(0, A_.size1()), Slice(A_.size1(), 2*A_.size1()));
     }
@@ -153,7 +155,9 @@ namespace casadi {
 
       MX At = A.T();
       MX extended = MX::blockcat({{At, Ybar}, {N, At}});
-      MX R = expm(extended*t);
+      // Frechet derivative as the upper right block, computed with the same plugin
+      Function ext = expmsol(name + "_ext", plugin_name(), extended.sparsity());
+      MX R = ext(std::vector<MX>{extended, t}).at(0);
 
       Abar = R(Slice(0, A_.size1()), Slice(A_.size1(), 2*A_.size1()));
     }
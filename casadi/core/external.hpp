@@ -37,7 +37,8 @@ namespace casadi {
   CASADI_EXPORT Function external(const std::string& name, const Dict& opts=Dict());
 
   /** \brief  Load an external function
-   * File name given
+   * File name given. Functions loaded from the same file share the library,
+   * which is unloaded when the last of them is destroyed.
    */
   CASADI_EXPORT Function external(const std::string& name, const std::string& bin_name,
                                   const Dict& opts=Dict());
@@ -84,7 +84,8 @@ namespace casadi {
     std::vector<HBlock> hess_;
 
     // Constructor
-    Factory(const Function::AuxOut& aux, bool verbose=false) : aux_(aux), verbose_(verbose) {}
+    Factory(const Function::AuxOut& aux, bool verbose=false, casadi_int ad_num_threads=1)
+      : aux_(aux), verbose_(verbose), ad_num_threads_(ad_num_threads) {}
 
     // Add an input expression
     void add_input(const std::string& s, const MatType& e);
@@ -132,6 +133,9 @@ namespace casadi {
 
     // Verbose?
     bool verbose_;
+
+    // Number of threads for the construction of Jacobians and Hessians
+    casadi_int ad_num_threads_;
   };
 
   template<typename MatType>
@@ -248,7 +252,7 @@ namespace casadi {
   void Factory<MatType>::calculate() {
     using namespace std;
 
-    Dict all_opts = {{"verbose", verbose_}};
+    Dict all_opts = {{"verbose", verbose_}, {"ad_num_threads", ad_num_threads_}};
 
     // Dual variables
     for (auto&& e : out_) {
@@ -354,7 +358,10 @@ namespace casadi {
       const MatType& arg1 = in_.at(b.arg1);
       //const MatType& arg2 = in_.at(b.arg2);
       try {
-        out_["hess:" + b.ex + ":" + b.arg1 + ":" + b.arg2] = triu(hessian(ex, arg1));
+        Dict hess_opts = all_opts;
+        hess_opts["symmetric"] = true;
+        out_["hess:" + b.ex + ":" + b.arg1 + ":" + b.arg2]
+          = triu(MatType::jacobian(gradient(ex, arg1), arg1, hess_opts));
       } catch (exception& e) {
         casadi_error("Hessian generation failed:\n" + str(e.what()));
       }
@@ -24,6 +24,7 @@
 
 
 #include "finite_differences.hpp"
+#include "thread_pool.hpp"
 
 using namespace std;
 
@@ -63,6 +64,11 @@ namespace casadi {
         {OT_INT,
         "Number of iterations to improve on the step-size "
         "[default: 1 if error estimate available, otherwise 0]"}},
+      {"max_num_threads",
+        {OT_INT,
+        "Evaluate the perturbed points of different directions concurrently, "
+        "using at most this many threads. The differentiated function must be "
+        "safe to call from several threads [default: 1]"}},
      }
   };
 
@@ -79,6 +85,7 @@ namespace casadi {
     h_ = calc_stepsize(m_.abstol);
     u_aim_ = 100;
     h_iter_ = has_err() ? 1 : 0;
+    casadi_int max_num_threads = 1;
 
     // Read options
     for (auto&& op : opts) {
@@ -98,6 +105,9 @@ namespace casadi {
         u_aim_ = op.second;
       } else if (op.first=="h_iter") {
         h_iter_ = op.second;
+      } else if (op.first=="max_num_threads") {
+        max_num_threads = op.second;
+        casadi_assert(max_num_threads>=1, "Option 'max_num_threads' must be positive");
       }
     }
 
@@ -124,6 +134,30 @@ namespace casadi {
 
     // Allocate sufficient temporary memory for function evaluation
     alloc(derivative_of_);
+
+    // Each additional thread gets its own copy of the per-direction work vectors
+    n_threads_ = std::min(max_num_threads, n_);
+    thr_sz_arg_ = derivative_of_.sz_arg();
+    thr_sz_res_ = n_pert() + derivative_of_.sz_res();
+    thr_sz_iw_ = derivative_of_.sz_iw();
+    thr_sz_w_ = (n_pert() + 2) * n_y_ + n_z_ + derivative_of_.sz_w();
+    if (n_threads_>1) {
+      alloc_arg((n_threads_-1) * thr_sz_arg_, true);
+      alloc_res((n_threads_-1) * thr_sz_res_, true);
+      alloc_iw((n_threads_-1) * thr_sz_iw_, true);
+      alloc_w((n_threads_-1) * thr_sz_w_, true);
+    }
+
+    // Batched evaluation of all perturbed points, unless threaded
+    batch_ = n_threads_==1 && n_>0 && derivative_of_->has_eval_batch();
+    if (batch_) {
+      casadi_int n_points = n_ * n_pert();
+      alloc_w(n_ + (n_points-1) * (n_z_ + n_y_), true); // h[:], remaining points
+      alloc_w(n_points * derivative_of_.sz_w());
+      if (verbose_) {
+        casadi_message("Batched evaluation of " + str(n_points) + " perturbed points");
+      }
+    }
   }
 
   Sparsity FiniteDiff::get_sparsity_in(casadi_int i) {
@@ -198,7 +232,6 @@ namespace casadi {
       casadi_int* iw, double* w, void* mem) const {
     // Shorthands
     casadi_int n_in = derivative_of_.n_in(), n_out = derivative_of_.n_out();
-    casadi_int n_pert = this->n_pert();
 
     // Non-differentiated input
     const double** x0 = arg;
@@ -220,6 +253,34 @@ namespace casadi {
     double** sens = res;
     res += n_out;
 
+    // All perturbed points at once
+    if (batch_) return eval_batched(x0, y0, seed, sens, arg, res, iw, w);
+
+    // Sequential evaluation
+    if (n_threads_==1) {
+      for (casadi_int i=0; i<n_; ++i) {
+        if (eval_dir(i, x0, y0, seed, sens, arg, res, iw, w)) return 1;
+      }
+      return 0;
+    }
+
+    // Evaluate the directions concurrently, thread t uses work vector block t
+    std::vector<int> flag(n_, 0);
+    ThreadPool::run(n_, n_threads_, [&](casadi_int i, casadi_int t) {
+      flag[i] = eval_dir(i, x0, y0, seed, sens, arg + t*thr_sz_arg_, res + t*thr_sz_res_,
+                         iw + t*thr_sz_iw_, w + t*thr_sz_w_);
+    });
+    for (int f : flag) if (f) return 1;
+    return 0;
+  }
+
+  int FiniteDiff::eval_dir(casadi_int i, const double** x0, double* y0,
+                           const double** seed, double** sens,
+                           const double** arg, double** res, casadi_int* iw, double* w) const {
+    // Shorthands
+    casadi_int n_in = derivative_of_.n_in(), n_out = derivative_of_.n_out();
+    casadi_int n_pert = this->n_pert();
+
     // Finite difference approximation
     double* J = w;
     w += n_y_;
@@ -245,50 +306,136 @@ namespace casadi {
       w += derivative_of_.nnz_out(j);
     }
 
-    // For all sensitivity directions
-    for (casadi_int i=0; i<n_; ++i) {
-      // Initial stepsize
-      double h = h_;
-      // Perform finite difference algorithm with different step sizes
-      for (casadi_int iter=0; iter<1+h_iter_; ++iter) {
-        // Calculate perturbed function values
+    // Initial stepsize
+    double h = h_;
+    // Perform finite difference algorithm with different step sizes
+    for (casadi_int iter=0; iter<1+h_iter_; ++iter) {
+      // Calculate perturbed function values
+      for (casadi_int k=0; k<n_pert; ++k) {
+        // Perturb inputs
+        casadi_int off = 0;
+        for (casadi_int j=0; j<n_in; ++j) {
+          casadi_int nnz = derivative_of_.nnz_in(j);
+          casadi_copy(x0[j], nnz, z + off);
+          if (seed[j]) casadi_axpy(nnz, pert(k, h), seed[j] + i*nnz, z + off);
+          off += nnz;
+        }
+        // Evaluate
+        if (derivative_of_(arg, res, iw, w)) return 1;
+        // Save outputs
+        casadi_copy(y, n_y_, yk[k]);
+      }
+      // Finite difference calculation with error estimate
+      double u = calc_fd(yk, y0, J, h);
+      if (iter==h_iter_) break;
+
+      // Update step size
+      if (u < 0) {
+        // Perturbation failed, try a smaller step size
+        h /= u_aim_;
+      } else {
+        // Update h to get u near the target ratio
+        h *= sqrt(u_aim_ / fmax(1., u));
+      }
+      // Make sure h stays in the range [h_min_,h_max_]
+      h = fmin(fmax(h, h_min_), h_max_);
+    }
+
+    // Gather sensitivities
+    casadi_int off = 0;
+    for (casadi_int j=0; j<n_out; ++j) {
+      casadi_int nnz = derivative_of_.nnz_out(j);
+      if (sens[j]) casadi_copy(J + off, nnz, sens[j] + i*nnz);
+      off += nnz;
+    }
+    return 0;
+  }
+
+  int FiniteDiff::eval_batched(const double** x0, double* y0, const double** seed,
+                               double** sens, const double** arg, double** res,
+                               casadi_int* iw, double* w) const {
+    // Shorthands
+    casadi_int n_in = derivative_of_.n_in(), n_out = derivative_of_.n_out();
+    casadi_int n_pert = this->n_pert(), n_points = n_ * n_pert;
+
+    // Finite difference approximation
+    double* J = w;
+    w += n_y_;
+
+    // Perturbed function values of a direction
+    double** yk = res;
+    res += n_pert;
+    for (casadi_int k=0; k<n_pert; ++k) {
+      yk[k] = w, w += n_y_;
+    }
+
+    // Step size for each direction
+    double* h = w;
+    w += n_;
+    casadi_fill(h, n_, h_);
+
+    // Inputs and outputs of point p are at offset p*nnz of each input and output
+    double* z = w;
+    for (casadi_int j=0; j<n_in; ++j) {
+      arg[j] = w;
+      w += n_points * derivative_of_.nnz_in(j);
+    }
+    for (casadi_int j=0; j<n_out; ++j) {
+      res[j] = w;
+      w += n_points * derivative_of_.nnz_out(j);
+    }
+
+    // Memory object of the differentiated function
+    scoped_checkout<Function> mem(derivative_of_);
+
+    // All directions use the same number of iterations
+    for (casadi_int iter=0; iter<1+h_iter_; ++iter) {
+      // Perturb inputs, point i*n_pert+k is perturbation k in direction i
+      double* zj = z;
+      for (casadi_int j=0; j<n_in; ++j) {
+        casadi_int nnz = derivative_of_.nnz_in(j);
+        for (casadi_int i=0; i<n_; ++i) {
+          for (casadi_int k=0; k<n_pert; ++k) {
+            casadi_copy(x0[j], nnz, zj);
+            if (seed[j]) casadi_axpy(nnz, pert(k, h[i]), seed[j] + i*nnz, zj);
+            zj += nnz;
+          }
+        }
+      }
+      // Evaluate
+      if (derivative_of_->eval_batch(arg, res, iw, w, derivative_of_->memory(mem), n_points)) {
+        return 1;
+      }
+      // For all sensitivity directions
+      for (casadi_int i=0; i<n_; ++i) {
+        // Collect the perturbed function values
         for (casadi_int k=0; k<n_pert; ++k) {
-          // Perturb inputs
           casadi_int off = 0;
-          for (casadi_int j=0; j<n_in; ++j) {
-            casadi_int nnz = derivative_of_.nnz_in(j);
-            casadi_copy(x0[j], nnz, z + off);
-            //cout << "k = " << k << ": pert(k, h) = " << pert(k, h) << endl;
-            if (seed[j]) casadi_axpy(nnz, pert(k, h), seed[j] + i*nnz, z + off);
+          for (casadi_int j=0; j<n_out; ++j) {
+            casadi_int nnz = derivative_of_.nnz_out(j);
+            casadi_copy(res[j] + (i*n_pert+k)*nnz, nnz, yk[k] + off);
             off += nnz;
           }
-          // Evaluate
-          if (derivative_of_(arg, res, iw, w)) return 1;
-          // Save outputs
-          casadi_copy(y, n_y_, yk[k]);
         }
         // Finite difference calculation with error estimate
-        double u = calc_fd(yk, y0, J, h);
-        if (iter==h_iter_) break;
-
-        // Update step size
-        if (u < 0) {
-          // Perturbation failed, try a smaller step size
-          h /= u_aim_;
+        double u = calc_fd(yk, y0, J, h[i]);
+        if (iter==h_iter_) {
+          // Gather sensitivities
+          casadi_int off = 0;
+          for (casadi_int j=0; j<n_out; ++j) {
+            casadi_int nnz = derivative_of_.nnz_out(j);
+            if (sens[j]) casadi_copy(J + off, nnz, sens[j] + i*nnz);
+            off += nnz;
+          }
         } else {
-          // Update h to get u near the target ratio
-          h *= sqrt(u_aim_ / fmax(1., u));
+          // Update step size, cf. eval_dir
+          if (u < 0) {
+            h[i] /= u_aim_;
+          } else {
+            h[i] *= sqrt(u_aim_ / fmax(1., u));
+          }
+          h[i] = fmin(fmax(h[i], h_min_), h_max_);
         }
-        // Make sure h stays in the range [h_min_,h_max_]
-        h = fmin(fmax(h, h_min_), h_max_);
-      }
-
-      // Gather sensitivities
-      casadi_int off = 0;
-      for (casadi_int j=0; j<n_out; ++j) {
-        casadi_int nnz = derivative_of_.nnz_out(j);
-        if (sens[j]) casadi_copy(J + off, nnz, sens[j] + i*nnz);
-        off += nnz;
       }
     }
     return 0;
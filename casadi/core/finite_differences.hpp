@@ -76,6 +76,17 @@ namespace casadi {
     // Evaluate numerically
     int eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const override;
 
+    /** \brief Calculate the directional derivative in direction i
+        arg, res, iw and w are the work vectors of a single thread */
+    int eval_dir(casadi_int i, const double** x0, double* y0,
+                 const double** seed, double** sens,
+                 const double** arg, double** res, casadi_int* iw, double* w) const;
+
+    /** \brief Calculate all directional derivatives, all perturbed points of an
+        iteration are passed to the differentiated function in a single eval_batch call */
+    int eval_batched(const double** x0, double* y0, const double** seed, double** sens,
+                     const double** arg, double** res, casadi_int* iw, double* w) const;
+
     /** \brief Is the scheme using the (nondifferentiated) output? */
     bool uses_output() const override {return true;}
 
@@ -128,6 +139,15 @@ namespace casadi {
     // Allowed step size range
     double h_min_, h_max_;
 
+    // Number of threads evaluating the directions concurrently
+    casadi_int n_threads_;
+
+    // Evaluate the perturbed points with eval_batch
+    bool batch_;
+
+    // Work vector sizes per thread
+    size_t thr_sz_arg_, thr_sz_res_, thr_sz_iw_, thr_sz_w_;
+
     // Memory object
     casadi_finite_diff_mem<double> m_;
   };
@@ -29,9 +29,14 @@
 #include "mx_function.hpp"
 #include "switch.hpp"
 #include "bspline.hpp"
+#include "polynomial_function.hpp"
+#include "mlp.hpp"
 #include "nlpsol.hpp"
 #include "conic.hpp"
 #include "jit_function.hpp"
+#include "binary_serializer.hpp"
+#include "memoize.hpp"
+#include "mapaccum.hpp"
 
 #include <typeinfo>
 #include <fstream>
@@ -306,6 +311,91 @@ namespace casadi {
     (*this)->call(arg, res, always_inline, never_inline);
   }
 
+  // Sparsity of a view, with vectors reshaped to the expected orientation
+  static Sparsity view_sparsity(const DMView& v, const Sparsity& sp) {
+    const Sparsity& v_sp = v.sparsity();
+    if (v_sp.size()!=sp.size() && v_sp.is_vector() && sp.is_vector()
+        && v_sp.numel()==sp.numel()) {
+      return Sparsity::reshape(v_sp, sp.size1(), sp.size2());
+    }
+    return v_sp;
+  }
+
+  void Function::call(const vector<DMView>& arg, const vector<DMView>& res) const {
+    casadi_assert(arg.size()==n_in(), "Incorrect number of inputs: Expected "
+                  + str(n_in()) + ", got " + str(arg.size()));
+    casadi_assert(res.size()==n_out(), "Incorrect number of outputs: Expected "
+                  + str(n_out()) + ", got " + str(res.size()));
+    // Pointers to inputs and outputs
+    vector<const double*> buf_arg(sz_arg(), nullptr);
+    vector<double*> buf_res(sz_res(), nullptr);
+    // Storage for converted inputs and outputs, only allocated when needed
+    vector<DM> arg_dm(n_in()), res_dm(n_out());
+    vector<bool> project_res(n_out(), false);
+    vector<double> w_proj;
+    // Inputs
+    for (casadi_int i=0; i<n_in(); ++i) {
+      const DMView& a = arg[i];
+      if (a.is_null()) continue;
+      const Sparsity& sp = sparsity_in(i);
+      Sparsity a_sp = view_sparsity(a, sp);
+      if (a_sp==sp) {
+        // Use directly
+        buf_arg[i] = a.ptr();
+        continue;
+      }
+      DM& a_dm = arg_dm[i];
+      if (a_sp.size()==sp.size()) {
+        // Project into temporary storage
+        a_dm = DM::zeros(sp);
+        w_proj.resize(std::max(w_proj.size(), static_cast<size_t>(sp.size1())));
+        casadi_project(a.ptr(), a_sp, a_dm.ptr(), sp, get_ptr(w_proj));
+      } else if (a_sp.is_scalar()) {
+        // Scalar assign means set all
+        a_dm = DM(sp, DM(a_sp.nnz()==1 ? *a.ptr() : 0.));
+      } else if (a_sp.is_empty()) {
+        // Empty matrix means zero
+        continue;
+      } else {
+        casadi_error("Input " + str(i) + " (" + name_in(i) + ") has mismatching shape. "
+                     "Got " + a_sp.dim() + ", expected " + sp.dim() + ".");
+      }
+      buf_arg[i] = a_dm.ptr();
+    }
+    // Outputs
+    for (casadi_int i=0; i<n_out(); ++i) {
+      const DMView& r = res[i];
+      if (r.is_null()) continue;
+      const Sparsity& sp = sparsity_out(i);
+      Sparsity r_sp = view_sparsity(r, sp);
+      if (r_sp==sp) {
+        // Write directly
+        buf_res[i] = r.ptr();
+      } else {
+        casadi_assert(r_sp.size()==sp.size(), "Output " + str(i) + " (" + name_out(i)
+                      + ") has mismatching shape. Got " + r_sp.dim() + ", expected "
+                      + sp.dim() + ".");
+        res_dm[i] = DM::zeros(sp);
+        buf_res[i] = res_dm[i].ptr();
+        project_res[i] = true;
+        w_proj.resize(std::max(w_proj.size(), static_cast<size_t>(sp.size1())));
+      }
+    }
+    // Evaluate memoryless
+    vector<casadi_int> iw(sz_iw());
+    vector<double> w(sz_w());
+    if ((*this)(get_ptr(buf_arg), get_ptr(buf_res), get_ptr(iw), get_ptr(w), 0)) {
+      casadi_error("Evaluation of " + name() + " failed");
+    }
+    // Copy converted outputs to the caller storage
+    for (casadi_int i=0; i<n_out(); ++i) {
+      if (!project_res[i]) continue;
+      const Sparsity& sp = sparsity_out(i);
+      casadi_project(res_dm[i].ptr(), sp, res[i].ptr(), view_sparsity(res[i], sp),
+                     get_ptr(w_proj));
+    }
+  }
+
   vector<const double*> Function::buf_in(Function::VecArg arg) const {
     casadi_assert_dev(arg.size()==n_in());
     auto arg_it=arg.begin();
@@ -432,11 +522,55 @@ namespace casadi {
   }
 
   Function Function::fold(casadi_int N, const Dict& opts) const {
-    Function base = mapaccum(N, opts);
+    Dict options = opts;
+
+    // Checkpointing of a native fold
+    casadi_int checkpoint_interval = N;
+    auto it = options.find("checkpoint_interval");
+    if (it!=options.end()) {
+      checkpoint_interval = it->second;
+      options.erase(it);
+      auto u = opts.find("unroll");
+      casadi_assert(u!=opts.end() && !u->second.to_bool(),
+                    "fold: 'checkpoint_interval' requires 'unroll' false");
+      casadi_assert(checkpoint_interval>=1, "fold: 'checkpoint_interval' must be positive");
+    }
+    Dict fold_options = options;
+    fold_options.erase("unroll");
+    fold_options.erase("base");
+
+    if (checkpoint_interval<N) {
+      // Only every checkpoint_interval-th state is stored: segments of that many iterations
+      // are folded separately, which the reverse mode recomputes segment by segment
+      casadi_int q = N / checkpoint_interval, r = N % checkpoint_interval;
+      Function seg = fold(checkpoint_interval, Dict{{"unroll", false}});
+      Function outer = seg.mapaccum(name() + "_checkpoints", q, options);
+      std::vector<MX> arg = mx_in(), res;
+      for (casadi_int i=1; i<arg.size(); ++i) {
+        arg[i] = MX::sym(name_in(i), repmat(sparsity_in(i), 1, N));
+      }
+      std::vector<MX> outer_arg = arg, rem_arg = arg;
+      for (casadi_int i=1; i<arg.size(); ++i) {
+        casadi_int sz = size2_in(i)*checkpoint_interval*q;
+        outer_arg[i] = arg[i](Slice(), Slice(0, sz));
+        rem_arg[i] = arg[i](Slice(), Slice(sz, arg[i].size2()));
+      }
+      res = outer(outer_arg);
+      res[0] = res[0](Slice(), range((q-1)*size2_out(0), q*size2_out(0)));
+      if (r>0) {
+        rem_arg[0] = res[0];
+        std::vector<MX> rem_res = fold(r, Dict{{"unroll", false}})(rem_arg);
+        res[0] = rem_res[0];
+        for (casadi_int i=1; i<res.size(); ++i) res[i] = horzcat(res[i], rem_res[i]);
+      }
+      return Function("fold_"+name(), arg, res, name_in(), name_out(), fold_options);
+    }
+
+    Function base = mapaccum(N, options);
     std::vector<MX> base_in = base.mx_in();
     std::vector<MX> out = base(base_in);
     out[0] = out[0](Slice(), range((N-1)*size2_out(0), N*size2_out(0)));
-    return Function("fold_"+name(), base_in, out, name_in(), name_out(), opts);
+    return Function("fold_"+name(), base_in, out, name_in(), name_out(), fold_options);
   }
   Function Function::mapaccum(casadi_int N, const Dict& opts) const {
     return mapaccum("mapaccum_"+name(), N, opts);
@@ -448,6 +582,17 @@ namespace casadi {
                               const Dict& opts) const {
     Dict options = opts;
 
+    // Native loop instead of unrolled calls
+    auto u = options.find("unroll");
+    if (u!=options.end()) {
+      bool unroll = u->second;
+      options.erase(u);
+      if (!unroll) {
+        options.erase("base");
+        return Mapaccum::create(name, *this, N, n_accum, options);
+      }
+    }
+
     // Default base
     casadi_int base = 10;
     auto it = options.find("base");
@@ -595,6 +740,10 @@ namespace casadi {
   Function::map(casadi_int n, const std::string& parallelization,
       casadi_int max_num_threads) const {
     casadi_assert(max_num_threads>=1, "max_num_threads invalid.");
+    // Thread maps distribute the iterations over a thread pool themselves
+    if (parallelization=="thread" && n>1) {
+      return (*this)->map(n, parallelization, {{"max_num_threads", max_num_threads}});
+    }
     // No need for logic when we are not saturating the limit
     if (n<=max_num_threads) return map(n, parallelization);
 
@@ -622,6 +771,19 @@ namespace casadi {
     }
   }
 
+  Function
+  Function::map(casadi_int n, const std::string& parallelization, const Dict& opts) const {
+    // Make sure not degenerate
+    casadi_assert(n>0, "Degenerate map operation");
+    // No options: use the potentially cached map
+    if (opts.empty()) return map(n, parallelization);
+    casadi_assert(parallelization=="serial" || parallelization=="openmp"
+                  || parallelization=="thread" || parallelization=="opencl"
+                  || parallelization=="mpi",
+                  "Options not supported for parallelization '" + parallelization + "'");
+    return (*this)->map(n, parallelization, opts);
+  }
+
   Function
   Function::map(casadi_int n, const std::string& parallelization) const {
     // Make sure not degenerate
@@ -709,6 +871,26 @@ namespace casadi {
     }
   }
 
+  Function Function::polynomial(const std::string& name,
+      const std::vector< std::vector<casadi_int> >& exponents, const DM& coeff,
+      const Dict& opts) {
+    try {
+      return PolynomialFunction::create(name, exponents, coeff, opts);
+    } catch (exception& e) {
+      THROW_ERROR_NOOBJ("polynomial", e.what(), "PolynomialFunction");
+    }
+  }
+
+  Function Function::mlp(const std::string& name, const std::vector<DM>& weights,
+      const std::vector<DM>& biases, const std::vector<std::string>& activations,
+      const Dict& opts) {
+    try {
+      return Mlp::create(name, weights, biases, activations, opts);
+    } catch (exception& e) {
+      THROW_ERROR_NOOBJ("mlp", e.what(), "Mlp");
+    }
+  }
+
   Function Function::if_else(const string& name, const Function& f_true,
                              const Function& f_false, const Dict& opts) {
     try {
@@ -828,6 +1010,15 @@ namespace casadi {
     return (*this)->get_stats(memory(mem));
   }
 
+  Dict Function::memory_usage() const {
+    std::set<const void*> visited;
+    return (*this)->memory_tree(visited);
+  }
+
+  void Function::print_memory_usage(ostream &stream) const {
+    FunctionInternal::print_memory_tree(stream, memory_usage(), name(), 0);
+  }
+
   const Sparsity Function::
   sparsity_jac(casadi_int iind, casadi_int oind, bool compact, bool symmetric) const {
     try {
@@ -981,6 +1172,14 @@ namespace casadi {
     }
   }
 
+  Function Function::hessvec() const {
+    try {
+      return (*this)->hessvec();
+    } catch (exception& e) {
+      THROW_ERROR("hessvec", e.what());
+    }
+  }
+
   void Function::print_dimensions(ostream &stream) const {
     (*this)->print_dimensions(stream);
   }
@@ -989,6 +1188,10 @@ namespace casadi {
     (*this)->print_options(stream);
   }
 
+  void Function::print_instruction_profile(ostream &stream, casadi_int mem) const {
+    (*this)->print_instruction_profile(stream, memory(mem));
+  }
+
   void Function::print_option(const std::string &name, std::ostream &stream) const {
     (*this)->print_option(name, stream);
   }
@@ -1032,6 +1235,10 @@ namespace casadi {
     return (*this)->serialize(stream);
   }
 
+  void Function::save(const std::string& fname) const {
+    save_binary(*this, fname);
+  }
+
   std::string Function::export_code(const std::string& lang, const Dict& options) const {
     std::stringstream ss;
     (*this)->export_code(lang, ss, options);
@@ -1092,6 +1299,18 @@ namespace casadi {
     return deserialize(ss);
   }
 
+  Function Function::load(const std::string& fname, const Dict& opts) {
+    bool lazy = false;
+    for (auto&& op : opts) {
+      if (op.first=="lazy") {
+        lazy = op.second;
+      } else {
+        casadi_error("No such option: " + op.first);
+      }
+    }
+    return load_binary(fname, lazy);
+  }
+
   string Function::fix_name(const string& name) {
     // Quick return if already valid name
     if (check_name(name)) return name;
@@ -1417,6 +1636,18 @@ namespace casadi {
     (*this)->release(mem);
   }
 
+  void Function::cancel() const {
+    (*this)->cancel();
+  }
+
+  bool Function::is_thread_safe() const {
+#ifdef CASADI_WITH_THREAD
+    return (*this)->is_thread_safe();
+#else // CASADI_WITH_THREAD
+    return false;
+#endif // CASADI_WITH_THREAD
+  }
+
   void* Function::memory(casadi_int ind) const {
     return (*this)->memory(ind);
   }
@@ -1491,6 +1722,15 @@ namespace casadi {
     return (*this)->wrap();
   }
 
+  Function Function::memoize(const string& name, casadi_int cache_size,
+                             const Dict& opts) const {
+    try {
+      return create(new Memoize(name, *this, cache_size), opts);
+    } catch (exception& e) {
+      THROW_ERROR("memoize", e.what());
+    }
+  }
+
   bool Function::operator==(const Function& f) const {
     try {
       casadi_assert(!is_null(), "lhs is null");
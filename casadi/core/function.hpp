@@ -27,6 +27,7 @@
 
 #include "sx_elem.hpp"
 #include "mx.hpp"
+#include "dm_view.hpp"
 #include "printable.hpp"
 #include <exception>
 
@@ -330,6 +331,18 @@ namespace casadi {
     /** \brief Wrap in an Function instance consisting of only one MX call */
     Function wrap() const;
 
+    /** \brief Reuse the results of recent numerical evaluations
+
+        The returned Function keeps the outputs of the last \a cache_size numerical
+        evaluations with distinct input values and returns them when called again with
+        exactly the same input values. Useful when an expensive Function, e.g. an
+        integrator, is called with the same arguments from several derivative Functions.
+        The Function must not have side effects. Derivatives and generated code do not
+        use the cache. Hit statistics are available with stats().
+    */
+    Function memoize(const std::string& name, casadi_int cache_size=16,
+                     const Dict& opts=Dict()) const;
+
     /** \brief Which variables enter with some order
     *
     * \param[in] order Only 1 (linear) and 2 (nonlinear) allowed
@@ -348,6 +361,12 @@ namespace casadi {
     /** \brief Print all information there is to know about a certain option */
     void print_option(const std::string &name, std::ostream &stream = casadi::uout()) const;
 
+    /** \brief Print the instruction profile of a memory object, most expensive first
+     *
+     * Requires option "profile_instructions" of SXFunction or MXFunction.
+     */
+    void print_instruction_profile(std::ostream &stream=casadi::uout(), casadi_int mem=0) const;
+
     /** \brief Do the derivative functions need nondifferentiated outputs? */
     bool uses_output() const;
 
@@ -389,7 +408,8 @@ namespace casadi {
     Function jac() const;
 
     ///@{
-    /** \brief Evaluate the function symbolically or numerically  */
+    /** \brief Evaluate the function symbolically or numerically
+     * For repeated numerical evaluation without heap allocation, cf. EvaluationContext */
     void call(const std::vector<DM> &arg, std::vector<DM>& SWIG_OUTPUT(res),
               bool always_inline=false, bool never_inline=false) const;
     void call(const std::vector<SX> &arg, std::vector<SX>& SWIG_OUTPUT(res),
@@ -404,6 +424,17 @@ namespace casadi {
               bool always_inline=false, bool never_inline=false) const;
     ///@}
 
+#ifndef SWIG
+    /** \brief Evaluate numerically with inputs and outputs in caller-owned storage
+     *
+     * Views with the sparsity patterns of the function inputs and outputs, or vectors
+     * with the transposed dense pattern, are passed to the function without copying.
+     * Null inputs are zero and null outputs are not calculated. Other inputs of matching
+     * shape, as well as scalars, are converted and other outputs of matching shape are
+     * projected, which requires temporary storage. */
+    void call(const std::vector<DMView>& arg, const std::vector<DMView>& res) const;
+#endif // SWIG
+
 #ifndef SWIG
     /// Check if same as another function
     bool operator==(const Function& f) const;
@@ -541,6 +572,13 @@ namespace casadi {
 
         Set base to -1 to unroll all the way; no gains in memory efficiency here.
 
+        Set unroll to false to evaluate the loop in a single node instead, so that
+        construction time and graph size do not depend on N. Its derivatives are again
+        such nodes: the adjoints run backwards in time from the states stored in X.
+        For fold, which only returns x_N, the option checkpoint_interval then limits
+        the stored states to every checkpoint_interval-th one; the reverse mode
+        recomputes the states in between, one interval at a time.
+
     */
     Function mapaccum(const std::string& name, casadi_int n, const Dict& opts = Dict()) const;
     Function mapaccum(const std::string& name, casadi_int n, casadi_int n_accum,
@@ -579,12 +617,31 @@ namespace casadi {
                 s_(N-1) <- f(a_(N-1), p_(N-1))
         \endverbatim
 
-        \param parallelization Type of parallelization used: unroll|serial|openmp
+        \param parallelization Type of parallelization used:
+               unroll|serial|openmp|thread|opencl|mpi
+        \param max_num_threads Maximum number of threads; for "thread", the iterations
+               are distributed over a persistent thread pool
+
+        "opencl" evaluates all iterations of an SX Function at once on an OpenCL device
+        and requires CasADi to be compiled WITH_OPENCL.
+
+        "mpi" distributes the iterations over the ranks of MPI_COMM_WORLD and requires
+        CasADi to be compiled WITH_MPI. All ranks run the same program and evaluate the
+        map collectively; the outputs are available on all ranks.
     */
     Function map(casadi_int n, const std::string& parallelization="serial") const;
     Function map(casadi_int n, const std::string& parallelization,
       casadi_int max_num_threads) const;
 
+    /** \brief Create a mapped version of this function, passing options to the map
+
+        For serial|openmp|thread, the options "schedule" (static|dynamic) and "chunk_size"
+        control how the iterations are distributed over the threads; "thread" also
+        accepts "max_num_threads". For mpi, "local_parallelization" (serial|openmp|thread)
+        sets how each rank evaluates its block of iterations.
+    */
+    Function map(casadi_int n, const std::string& parallelization, const Dict& opts) const;
+
     ///@{
     /** \brief Map with reduction
       A subset of the inputs are non-repeated and a subset of the outputs summed
@@ -626,6 +683,29 @@ namespace casadi {
       const std::vector<casadi_int>& degree, casadi_int m=1,
       bool reverse=false, const Dict& opts=Dict());
 
+    /** \brief Multivariate polynomial evaluator function
+     *
+     *  Term t is the product over the inputs j of the basis function of degree
+     *  exponents[t][j] in x_j. Column t of \a coeff holds the coefficients of term t,
+     *  one row per output. Options 'basis' ('monomial' or 'chebyshev') and, for the
+     *  Chebyshev basis, the domain 'lbx'/'ubx'. Exponents and coefficients are stored
+     *  sparsely; derivatives are again polynomial functions.
+     */
+    static Function polynomial(const std::string& name,
+      const std::vector< std::vector<casadi_int> >& exponents, const DM& coeff,
+      const Dict& opts=Dict());
+
+    /** \brief Evaluator for stacked dense layers, h_{l+1} = act_l(W_l*h_l + b_l)
+     *
+     *  One activation per layer ('identity', 'tanh', 'sigmoid', 'relu' or 'softplus'),
+     *  or a single one for all hidden layers followed by a linear output layer.
+     *  \a biases may be empty. Layers are evaluated as dense matrix products, for all
+     *  points at once when the function is mapped with a batch size.
+     */
+    static Function mlp(const std::string& name, const std::vector<DM>& weights,
+      const std::vector<DM>& biases, const std::vector<std::string>& activations,
+      const Dict& opts=Dict());
+
     /** \brief Constructor (if-else) */
     static Function if_else(const std::string& name, const Function& f_true,
                             const Function& f_false, const Dict& opts=Dict());
@@ -666,6 +746,23 @@ namespace casadi {
      */
     Function reverse(casadi_int nadj) const;
 
+    /** \brief Get a function that calculates Hessian-vector products
+     *
+     *         Returns a function with <tt>n_in + n_in + n_out</tt> inputs
+     *         and <tt>n_in</tt> outputs.
+     *         The first <tt>n_in</tt> inputs correspond to nondifferentiated inputs.
+     *         The next <tt>n_in</tt> inputs correspond to forward seeds \a v
+     *         and the last <tt>n_out</tt> inputs correspond to adjoint seeds \a w.
+     *         The <tt>n_in</tt> outputs correspond to the forward derivative of the
+     *         adjoint sensitivities, i.e. sum_k w_k * hessian(f_k) * v for a single input.
+     *         <tt>(n_in = n_in(), n_out = n_out())</tt>
+     *
+     *        SXFunction calculates these numerically in one forward and one reverse
+     *        sweep, without constructing the Hessian or the derivative expressions.
+     *        The function returned is cached.
+     */
+    Function hessvec() const;
+
     ///@{
     /// Get, if necessary generate, the sparsity of a Jacobian block
     const Sparsity sparsity_jac(casadi_int iind, casadi_int oind,
@@ -709,6 +806,15 @@ namespace casadi {
     /** \brief Serialize */
     std::string serialize() const;
 
+    /** \brief Save to a file in a compact binary format
+     *
+     * Unlike serialize, MX Functions and the Functions they call are supported.
+     * Doubles are stored exactly and the algorithm of SX Functions is stored as
+     * fixed-width instructions, so that load does not need to parse any text.
+     * The format is versioned and in host byte order.
+     */
+    void save(const std::string& fname) const;
+
     std::string export_code(const std::string& lang, const Dict& options=Dict()) const;
 #ifndef SWIG
     void export_code(const std::string& lang,
@@ -739,6 +845,20 @@ namespace casadi {
     /// Get all statistics obtained at the end of the last evaluate call
     Dict stats(casadi_int mem=0) const;
 
+    /** \brief Estimated heap memory in bytes used by the function and nested functions
+     *
+     * Returns {"self": {category: bytes}, "total": bytes, "children": {name: ...}}, where
+     * the categories include the sparsity patterns ("sparsity", "jac_sparsity"), the
+     * memory objects ("memory", with their number in "n_memory"), the work vectors
+     * needed per evaluation ("work") and class specific storage such as "algorithm".
+     * Objects shared between functions, e.g. sparsity patterns and nested functions,
+     * are counted once, for the first function in depth-first order.
+     */
+    Dict memory_usage() const;
+
+    /// Print the estimated heap memory as a tree, cf. memory_usage
+    void print_memory_usage(std::ostream &stream=casadi::uout()) const;
+
     ///@{
     /** \brief Get symbolic primitives equivalent to the input expressions
      * There is no guarantee that subsequent calls return unique answers
@@ -882,18 +1002,49 @@ namespace casadi {
     /** \brief Build function from serialization */
     static Function deserialize(const std::string& s);
 
+    /** \brief Load a Function saved with save
+     *
+     * The file is memory-mapped where supported. Functions called from the loaded
+     * Function are shared with Functions with identical content loaded before.
+     * Options:
+     *   lazy: Read called Functions on first use rather than during the
+     *         call. The file contents are kept until then. [false]
+     */
+    static Function load(const std::string& fname, const Dict& opts=Dict());
+
     /// Assert that an input dimension is equal so some given value
     void assert_size_in(casadi_int i, casadi_int nrow, casadi_int ncol) const;
 
     /// Assert that an output dimension is equal so some given value
     void assert_size_out(casadi_int i, casadi_int nrow, casadi_int ncol) const;
 
-    /// Checkout a memory object
+    /** \brief Checkout a memory object
+     *
+     * Calls without a memory object check out and release one for each evaluation.
+     * Loops that evaluate the function repeatedly, e.g. one per thread, can instead
+     * check out a memory object once and pass it to each call. Check out and release
+     * are lock-free, except when a new memory object is allocated.
+     */
     casadi_int checkout() const;
 
     /// Release a memory object
     void release(casadi_int mem) const;
 
+    /** \brief Cancel the calls in progress
+     *
+     * Thread-safe. Solvers that support it (cf. option "max_wall_time") return
+     * their current iterate at the next iteration, calls started later are not affected.
+     */
+    void cancel() const;
+
+    /** \brief Can calls from several threads run in parallel?
+     *
+     * Each call uses its own memory object. Plugins wrapping non-reentrant libraries
+     * (e.g. ipopt, qpoases) serialize their evaluation with a process-wide lock and
+     * report false, as do functions calling them. False without thread support.
+     */
+    bool is_thread_safe() const;
+
 #ifndef SWIG
     /// Get memory object
     void* memory(casadi_int ind) const;
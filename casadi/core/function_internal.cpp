@@ -30,6 +30,11 @@
 #include "external.hpp"
 #include "finite_differences.hpp"
 #include "map.hpp"
+#include "timing.hpp"
+#include "profiler.hpp"
+#include "sparsity_internal.hpp"
+#include "binary_serializer.hpp"
+#include "thread_pool.hpp"
 
 #include <typeinfo>
 #include <cctype>
@@ -54,9 +59,11 @@ namespace casadi {
     return ret;
   }
 
-  ProtoFunction::ProtoFunction(const std::string& name) : name_(name) {
+  ProtoFunction::ProtoFunction(const std::string& name)
+      : name_(name), cancel_epoch_(0), n_mem_(0), unused_(0) {
     // Default options (can be overridden in derived classes)
     verbose_ = false;
+    for (auto&& b : mem_blocks_) b.store(nullptr, std::memory_order_relaxed);
   }
 
   FunctionInternal::FunctionInternal(const std::string& name) : ProtoFunction(name) {
@@ -74,10 +81,22 @@ namespace casadi {
     ad_weight_sp_ = 0.49; // Forward when tie
     jac_penalty_ = 2;
     max_num_dir_ = GlobalOptions::getMaxNumDir();
+    coloring_num_threads_ = 1;
+    ad_num_threads_ = 1;
+    ad_weight_timing_ = false;
+    sparsity_cache_loaded_ = false;
+    share_derivatives_ = false;
+    structure_key_set_ = false;
     user_data_ = nullptr;
     regularity_check_ = false;
     inputs_check_ = true;
     jit_ = false;
+    jit_cache_ = true;
+    jit_async_ = false;
+#ifdef CASADI_WITH_THREAD
+    jit_state_ = JIT_PENDING;
+    eval_async_ = nullptr;
+#endif // CASADI_WITH_THREAD
     compilerplugin_ = "clang";
     print_time_ = true;
     eval_ = nullptr;
@@ -97,13 +116,17 @@ namespace casadi {
   }
 
   ProtoFunction::~ProtoFunction() {
-    for (void* m : mem_) {
-      if (m!=nullptr) casadi_warning("Memory object has not been properly freed");
+    for (casadi_int i=0; i<n_mem(); ++i) {
+      if (mem_slot(i).mem!=nullptr) casadi_warning("Memory object has not been properly freed");
     }
-    mem_.clear();
+    for (auto&& b : mem_blocks_) delete[] b.load();
   }
 
   FunctionInternal::~FunctionInternal() {
+#ifdef CASADI_WITH_THREAD
+    // Wait for background compilation
+    if (jit_thread_.joinable()) jit_thread_.join();
+#endif // CASADI_WITH_THREAD
   }
 
   void ProtoFunction::construct(const Dict& opts) {
@@ -196,6 +219,14 @@ namespace casadi {
       {"jit_options",
        {OT_DICT,
         "Options to be passed to the jit compiler."}},
+      {"jit_async",
+       {OT_BOOL,
+        "Compile in a background thread and evaluate in interpreted mode until the "
+        "compiled code is available. Requires thread support (WITH_THREAD)."}},
+      {"jit_cache",
+       {OT_BOOL,
+        "Reuse the library of a previously jit-compiled function if the generated code, "
+        "the compiler and the compiler options are identical [default: true]"}},
       {"derivative_of",
        {OT_FUNCTION,
         "The function is a derivative of another function. "
@@ -205,6 +236,32 @@ namespace casadi {
        {OT_INT,
         "Specify the maximum number of directions for derivative functions."
         " Overrules the builtin optimized_num_dir."}},
+      {"coloring_num_threads",
+       {OT_INT,
+        "Number of threads for the graph coloring of Jacobian and Hessian sparsity patterns."
+        " The coloring is deterministic, but differs from the serial one if >1 [default: 1]"}},
+      {"ad_num_threads",
+       {OT_INT,
+        "Number of threads for the symbolic construction of Jacobian and Hessian "
+        "expressions of SX functions, each thread evaluating derivative sweeps [default: 1]"}},
+      {"ad_weight_timing",
+       {OT_BOOL,
+        "Choose between forward and reverse mode for each Jacobian block by timing "
+        "the derivative evaluations needed by the colorings of both modes, instead "
+        "of by the weighting factor \"ad_weight\". The choice is stored with the colorings, "
+        "cf. option \"sparsity_cache\" [default: false]"}},
+      {"sparsity_cache",
+       {OT_STRING,
+        "Directory of a persistent cache for Jacobian sparsity patterns and colorings,"
+        " keyed by a structural hash of the function (serialized or generated code)."
+        " Entries are reloaded by functions with the same structure, e.g. after a restart."
+        " Disabled if empty [default]"}},
+      {"share_derivatives",
+       {OT_BOOL,
+        "Share derivative functions, Jacobian sparsity patterns and colorings with"
+        " structurally identical functions in this process that also set this option."
+        " Functions are compared by a hash of their binary serialization, computed upon"
+        " first use, together with the options affecting derivatives [default: false]"}},
       {"print_time",
        {OT_BOOL,
         "print information about execution time"}},
@@ -273,6 +330,10 @@ namespace casadi {
         compilerplugin_ = op.second.to_string();
       } else if (op.first=="jit_options") {
         jit_options_ = op.second;
+      } else if (op.first=="jit_cache") {
+        jit_cache_ = op.second;
+      } else if (op.first=="jit_async") {
+        jit_async_ = op.second;
       } else if (op.first=="derivative_of") {
         derivative_of_ = op.second;
       } else if (op.first=="ad_weight") {
@@ -281,6 +342,16 @@ namespace casadi {
         ad_weight_sp_ = op.second;
       } else if (op.first=="max_num_dir") {
         max_num_dir_ = op.second;
+      } else if (op.first=="coloring_num_threads") {
+        coloring_num_threads_ = op.second;
+      } else if (op.first=="ad_num_threads") {
+        ad_num_threads_ = op.second;
+      } else if (op.first=="ad_weight_timing") {
+        ad_weight_timing_ = op.second;
+      } else if (op.first=="sparsity_cache") {
+        sparsity_cache_ = op.second.to_string();
+      } else if (op.first=="share_derivatives") {
+        share_derivatives_ = op.second;
       } else if (op.first=="print_time") {
         print_time_ = op.second;
       } else if (op.first=="enable_forward") {
@@ -297,6 +368,10 @@ namespace casadi {
         fd_method_ = op.second.to_string();
       }
     }
+    casadi_assert(coloring_num_threads_>=1,
+                  "Option 'coloring_num_threads' must be positive");
+    casadi_assert(ad_num_threads_>=1,
+                  "Option 'ad_num_threads' must be positive");
 
     // Verbose?
     if (verbose_) casadi_message(name_ + "::init");
@@ -372,6 +447,52 @@ namespace casadi {
     return "o" + str(i);
   }
 
+  namespace {
+    // Libraries jit-compiled in this process, weakly referenced
+    std::map<std::string, WeakRef> jit_cache;
+#ifdef CASADI_WITH_THREAD
+    std::mutex jit_cache_mtx;
+#endif // CASADI_WITH_THREAD
+  } // namespace
+
+  Importer FunctionInternal::jit_import(const std::string& fname, const std::string& compiler,
+                                        const Dict& opts, bool compile) {
+    // Read the generated code
+    std::ifstream file(fname);
+    casadi_assert(file.good(), "Cannot open '" + fname + "'");
+    std::stringstream ss;
+    ss << file.rdbuf();
+    std::string code = ss.str();
+
+    // Hash the code together with the compiler and its options
+    std::string key = compiler + ":" + str(std::hash<std::string>()(code))
+      + ":" + str(code.size()) + ":" + str(opts);
+
+#ifdef CASADI_WITH_THREAD
+    std::lock_guard<std::mutex> lock(jit_cache_mtx);
+#endif // CASADI_WITH_THREAD
+    // Cache hit?
+    auto it = jit_cache.find(key);
+    if (it!=jit_cache.end() && it->second.alive()) {
+      return shared_cast<Importer>(it->second.shared());
+    }
+
+    // Compile
+    if (!compile) return Importer();
+    Importer ret(fname, compiler, opts);
+
+    // Remove dead references, to prevent uncontrolled growth
+    for (auto it=jit_cache.begin(); it!=jit_cache.end();) {
+      if (it->second.alive()) {
+        ++it;
+      } else {
+        jit_cache.erase(it++);
+      }
+    }
+    jit_cache[key] = ret;
+    return ret;
+  }
+
   void FunctionInternal::finalize(const Dict& opts) {
     if (jit_) {
       string jit_name = "jit_tmp";
@@ -380,8 +501,20 @@ namespace casadi {
         // JIT everything
         CodeGenerator gen(jit_name);
         gen.add(self());
+        string fname = gen.generate();
+        if (jit_async_ && !(jit_cache_
+              && !jit_import(fname, compilerplugin_, jit_options_, false).is_null())) {
+          // Compile in the background, evaluate in interpreted mode meanwhile
+          jit_async(fname);
+          ProtoFunction::finalize(opts);
+          return;
+        }
         if (verbose_) casadi_message("Compiling function '" + name_ + "'..");
-        compiler_ = Importer(gen.generate(), compilerplugin_, jit_options_);
+        if (jit_cache_) {
+          compiler_ = jit_import(fname, compilerplugin_, jit_options_);
+        } else {
+          compiler_ = Importer(fname, compilerplugin_, jit_options_);
+        }
         if (verbose_) casadi_message("Compiling function '" + name_ + "' done.");
         // Try to load
         eval_ = (eval_t)compiler_.get_function(name_);
@@ -395,6 +528,33 @@ namespace casadi {
     ProtoFunction::finalize(opts);
   }
 
+  void FunctionInternal::jit_async(const std::string& fname) {
+#ifdef CASADI_WITH_THREAD
+    // Move the code to a file of its own, since jit_tmp.c may be overwritten meanwhile
+    string async_name = fname.substr(0, fname.rfind('.')) + "_"
+      + str(reinterpret_cast<size_t>(this)) + fname.substr(fname.rfind('.'));
+    std::remove(async_name.c_str());
+    casadi_assert(std::rename(fname.c_str(), async_name.c_str())==0,
+                  "Cannot rename '" + fname + "'");
+    if (verbose_) casadi_message("Compiling function '" + name_ + "' in the background.");
+    // Arguments copied in the calling thread
+    jit_state_ = JIT_PENDING;
+    jit_thread_ = std::thread([this](std::string async_name, std::string compiler, Dict opts) {
+      try {
+        compiler_ = Importer(async_name, compiler, opts);
+        eval_async_ = (eval_t)compiler_.get_function(name_);
+        jit_state_ = eval_async_ ? JIT_READY : JIT_FAILED;
+      } catch (std::exception& e) {
+        jit_error_ = e.what();
+        jit_state_ = JIT_FAILED;
+      }
+      std::remove(async_name.c_str());
+    }, async_name, compilerplugin_, jit_options_);
+#else // CASADI_WITH_THREAD
+    casadi_error("Option 'jit_async' requires CasADi to be compiled with WITH_THREAD");
+#endif // CASADI_WITH_THREAD
+  }
+
   void ProtoFunction::finalize(const Dict& opts) {
     // Create memory object
     casadi_int mem = checkout();
@@ -403,11 +563,31 @@ namespace casadi {
 
   int FunctionInternal::
   eval_gen(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const {
+    ProfilerScope profile(this, mem);
+    SerialLock serial(!is_reentrant());
     if (eval_) {
       return eval_(arg, res, iw, w, mem);
-    } else {
-      return eval(arg, res, iw, w, mem);
     }
+#ifdef CASADI_WITH_THREAD
+    if (jit_async_) {
+      // Switch to the compiled code as soon as the background compilation is done
+      int state = jit_state_;
+      if (state==JIT_READY) return eval_async_(arg, res, iw, w, mem);
+      if (state==JIT_FAILED && jit_state_.exchange(JIT_REPORTED)==JIT_FAILED) {
+        casadi_warning("Background jit compilation of '" + name_ + "' failed, "
+                       "using interpreted evaluation. " + jit_error_);
+      }
+    }
+#endif // CASADI_WITH_THREAD
+    return eval(arg, res, iw, w, mem);
+  }
+
+  bool FunctionInternal::is_thread_safe() const {
+    if (!is_reentrant()) return false;
+    for (auto&& f : get_function()) {
+      if (!get_function(f)->is_thread_safe()) return false;
+    }
+    return true;
   }
 
   void FunctionInternal::print_dimensions(ostream &stream) const {
@@ -431,6 +611,56 @@ namespace casadi {
     get_options().print_one(name, stream);
   }
 
+  void FunctionInternal::print_instruction_profile(std::ostream &stream, void* mem) const {
+    Dict stats = get_stats(mem);
+    auto it = stats.find("instructions");
+    casadi_assert(it!=stats.end(), "Function '" + name_ + "' has no instruction profile, "
+                  "see option 'profile_instructions'");
+    Dict p = it->second;
+    std::vector<casadi_int> n_call = p.at("n_call");
+    bool timed = p.find("t_wall")!=p.end();
+    std::vector<double> t_wall = timed ? p.at("t_wall").to_double_vector()
+                                       : std::vector<double>(n_call.size(), 0);
+    double t_total = 0;
+    casadi_int n_total = 0;
+    for (casadi_int k=0; k<n_call.size(); ++k) {
+      t_total += t_wall[k];
+      n_total += n_call[k];
+    }
+
+    // Descriptions of the entries, the operations (SX) or instructions (MX)
+    std::vector<std::string> desc(n_call.size());
+    if (p.find("op")!=p.end()) {
+      desc = p.at("op").to_string_vector();
+    } else {
+      desc = p.at("instruction").to_string_vector();
+      std::vector<std::string> sp = p.at("sparsity");
+      for (casadi_int k=0; k<desc.size(); ++k) {
+        if (!sp[k].empty()) desc[k] += " [" + sp[k] + "]";
+      }
+    }
+
+    // Most expensive first
+    std::vector<casadi_int> order(n_call.size());
+    for (casadi_int k=0; k<order.size(); ++k) order[k] = k;
+    std::stable_sort(order.begin(), order.end(), [&](casadi_int a, casadi_int b) {
+      return timed ? t_wall[a]>t_wall[b] : n_call[a]>n_call[b];});
+
+    stream << "Instruction profile of '" << name_ << "': " << n_total << " executed";
+    if (timed) stream << ", " << t_total << " s";
+    stream << endl;
+    for (casadi_int k : order) {
+      if (n_call[k]==0) continue;
+      stream << std::setw(12) << n_call[k];
+      if (timed) {
+        stream << std::setw(14) << t_wall[k] << " s" << std::setw(7) << std::fixed
+               << std::setprecision(1) << (t_total>0 ? 100*t_wall[k]/t_total : 0.)
+               << "%" << std::defaultfloat << std::setprecision(6);
+      }
+      stream << "  " << desc[k] << endl;
+    }
+  }
+
   std::vector<std::string> FunctionInternal::get_free() const {
     casadi_assert_dev(!has_free());
     return std::vector<std::string>();
@@ -468,6 +698,10 @@ namespace casadi {
     if (it!=cache_.end() && it->second.alive()) {
       f = shared_cast<Function>(it->second.shared());
       return true;
+    } else if (incache_shared(fname, f)) {
+      // Created by a structurally identical function
+      cache_[fname] = f;
+      return true;
     } else {
       return false;
     }
@@ -483,11 +717,68 @@ namespace casadi {
         break; // just one dead reference is enough
       }
     }
+    // Make available to structurally identical functions
+    tocache_shared(f);
+  }
+
+  namespace {
+    // Functions and sparsity patterns shared by structurally identical functions,
+    // cf. option "share_derivatives"
+    std::map<std::string, WeakRef> shared_functions;
+    std::map<std::string, std::vector<Sparsity> > shared_sparsity;
+#ifdef CASADI_WITH_THREAD
+    std::mutex shared_mtx;
+#endif // CASADI_WITH_THREAD
+  } // namespace
+
+  const std::string& FunctionInternal::structure_key() const {
+    if (!structure_key_set_) {
+      structure_key_set_ = true;
+      try {
+        BinarySerializer s;
+        s.pack(self());
+        const std::string& d = s.data();
+        structure_key_ = str(std::hash<std::string>()(d)) + "_" + str(d.size())
+          + ":" + str(max_num_dir_) + ":" + str(ad_weight_) + ":" + str(ad_weight_sp_);
+      } catch (std::exception& e) {
+        if (verbose_) {
+          casadi_message("Sharing of derivatives not supported for " + name_ + ": " + e.what());
+        }
+      }
+    }
+    return structure_key_;
+  }
+
+  bool FunctionInternal::incache_shared(const std::string& fname, Function& f) const {
+    if (!share_derivatives_ || structure_key().empty()) return false;
+#ifdef CASADI_WITH_THREAD
+    std::lock_guard<std::mutex> lock(shared_mtx);
+#endif // CASADI_WITH_THREAD
+    auto it = shared_functions.find(structure_key() + ":" + fname);
+    if (it==shared_functions.end() || !it->second.alive()) return false;
+    f = shared_cast<Function>(it->second.shared());
+    return true;
+  }
+
+  void FunctionInternal::tocache_shared(const Function& f) const {
+    if (!share_derivatives_ || structure_key().empty()) return;
+#ifdef CASADI_WITH_THREAD
+    std::lock_guard<std::mutex> lock(shared_mtx);
+#endif // CASADI_WITH_THREAD
+    shared_functions[structure_key() + ":" + f.name()] = f;
+    // Remove a lost reference, if any, to prevent uncontrolled growth
+    for (auto it = shared_functions.begin(); it!=shared_functions.end(); ++it) {
+      if (!it->second.alive()) {
+        shared_functions.erase(it);
+        break;
+      }
+    }
   }
 
-  Function FunctionInternal::map(casadi_int n, const std::string& parallelization) const {
+  Function FunctionInternal::map(casadi_int n, const std::string& parallelization,
+                                 const Dict& opts) const {
     Function f;
-    if (parallelization=="serial") {
+    if (parallelization=="serial" && opts.empty()) {
       // Serial maps are cached
       string fname = "map" + str(n) + "_" + name_;
       if (!incache(fname, f)) {
@@ -499,7 +790,7 @@ namespace casadi {
       }
     } else {
       // Non-serial maps are not cached
-      f = Map::create(parallelization, self(), n);
+      f = Map::create(parallelization, self(), n, opts);
     }
     return f;
   }
@@ -514,6 +805,11 @@ namespace casadi {
       opts["ad_weight"] = ad_weight();
       opts["ad_weight_sp"] = sp_weight();
       opts["max_num_dir"] = max_num_dir_;
+      opts["coloring_num_threads"] = coloring_num_threads_;
+      opts["ad_num_threads"] = ad_num_threads_;
+      opts["ad_weight_timing"] = ad_weight_timing_;
+      opts["sparsity_cache"] = sparsity_cache_;
+      opts["share_derivatives"] = share_derivatives_;
       // Wrap the function
       vector<MX> arg = mx_in();
       vector<MX> res = self()(arg);
@@ -558,6 +854,11 @@ namespace casadi {
                           casadi_int* iw, bvec_t* w, void* mem) {
       f->sp_forward(arg, res, iw, w, mem);
     }
+    static inline void sp_wide(const FunctionInternal *f,
+                          const bvec_t** arg, bvec_t** res,
+                          casadi_int* iw, bvec_t* w, void* mem, casadi_int nw) {
+      f->sp_forward_wide(arg, res, iw, w, mem, nw);
+    }
   };
   template<> struct JacSparsityTraits<false> {
     typedef bvec_t* arg_t;
@@ -566,6 +867,11 @@ namespace casadi {
                           casadi_int* iw, bvec_t* w, void* mem) {
       f->sp_reverse(arg, res, iw, w, mem);
     }
+    static inline void sp_wide(const FunctionInternal *f,
+                          bvec_t** arg, bvec_t** res,
+                          casadi_int* iw, bvec_t* w, void* mem, casadi_int nw) {
+      f->sp_reverse_wide(arg, res, iw, w, mem, nw);
+    }
   };
 
   template<bool fwd>
@@ -576,27 +882,35 @@ namespace casadi {
     casadi_int nz_in = nnz_in(iind);
     casadi_int nz_out = nnz_out(oind);
 
+    // Number of bvec_t words per nonzero and number of directions per sweep
+    casadi_int nw = sp_width();
+    casadi_int ndir = nw*bvec_size;
+
     // Evaluation buffers
     vector<typename JacSparsityTraits<fwd>::arg_t> arg(sz_arg(), nullptr);
     vector<bvec_t*> res(sz_res(), nullptr);
     vector<casadi_int> iw(sz_iw());
-    vector<bvec_t> w(sz_w(), 0);
+    vector<bvec_t> w(sz_w()*nw, 0);
 
     // Seeds and sensitivities
-    vector<bvec_t> seed(nz_in, 0);
+    vector<bvec_t> seed(nz_in*nw, 0);
     arg[iind] = get_ptr(seed);
-    vector<bvec_t> sens(nz_out, 0);
+    vector<bvec_t> sens(nz_out*nw, 0);
     res[oind] = get_ptr(sens);
     if (!fwd) std::swap(seed, sens);
 
+    // Number of seed and sensitivity nonzeros
+    casadi_int nz_seed = fwd ? nz_in : nz_out;
+    casadi_int nz_sens = fwd ? nz_out : nz_in;
+
     // Number of forward sweeps we must make
-    casadi_int nsweep = seed.size() / bvec_size;
-    if (seed.size() % bvec_size) nsweep++;
+    casadi_int nsweep = nz_seed / ndir;
+    if (nz_seed % ndir) nsweep++;
 
     // Print
     if (verbose_) {
       casadi_message(str(nsweep) + string(fwd ? " forward" : " reverse") + " sweeps "
-                     "needed for " + str(seed.size()) + " directions");
+                     "needed for " + str(nz_seed) + " directions");
     }
 
     // Progress
@@ -605,7 +919,7 @@ namespace casadi {
     // Temporary vectors
     std::vector<casadi_int> jcol, jrow;
 
-    // Loop over the variables, bvec_size variables at a time
+    // Loop over the variables, ndir variables at a time
     for (casadi_int s=0; s<nsweep; ++s) {
 
       // Print progress
@@ -619,42 +933,50 @@ namespace casadi {
       }
 
       // Nonzero offset
-      casadi_int offset = s*bvec_size;
+      casadi_int offset = s*ndir;
 
       // Number of local seed directions
-      casadi_int ndir_local = seed.size()-offset;
-      ndir_local = std::min(static_cast<casadi_int>(bvec_size), ndir_local);
+      casadi_int ndir_local = std::min(ndir, nz_seed-offset);
 
       for (casadi_int i=0; i<ndir_local; ++i) {
-        seed[offset+i] |= bvec_t(1)<<i;
+        seed[(offset+i)*nw + i/bvec_size] |= bvec_t(1)<<(i%bvec_size);
       }
 
       // Propagate the dependencies
-      JacSparsityTraits<fwd>::sp(this, get_ptr(arg), get_ptr(res),
-                                  get_ptr(iw), get_ptr(w), memory(0));
+      if (nw==1) {
+        JacSparsityTraits<fwd>::sp(this, get_ptr(arg), get_ptr(res),
+                                    get_ptr(iw), get_ptr(w), memory(0));
+      } else {
+        JacSparsityTraits<fwd>::sp_wide(this, get_ptr(arg), get_ptr(res),
+                                         get_ptr(iw), get_ptr(w), memory(0), nw);
+      }
 
       // Loop over the nonzeros of the output
-      for (casadi_int el=0; el<sens.size(); ++el) {
+      for (casadi_int el=0; el<nz_sens; ++el) {
+        for (casadi_int k=0; k<nw; ++k) {
 
-        // Get the sparsity sensitivity
-        bvec_t spsens = sens[el];
+          // Get the sparsity sensitivity
+          bvec_t spsens = sens[el*nw+k];
 
-        if (!fwd) {
-          // Clear the sensitivities for the next sweep
-          sens[el] = 0;
-        }
+          if (!fwd) {
+            // Clear the sensitivities for the next sweep
+            sens[el*nw+k] = 0;
+          }
 
-        // If there is a dependency in any of the directions
-        if (spsens!=0) {
+          // If there is a dependency in any of the directions
+          if (spsens!=0) {
 
-          // Loop over seed directions
-          for (casadi_int i=0; i<ndir_local; ++i) {
+            // Loop over seed directions
+            casadi_int i_end = std::min(static_cast<casadi_int>(bvec_size),
+                                        ndir_local - k*bvec_size);
+            for (casadi_int i=0; i<i_end; ++i) {
 
-            // If dependents on the variable
-            if ((bvec_t(1) << i) & spsens) {
-              // Add to pattern
-              jcol.push_back(el);
-              jrow.push_back(i+offset);
+              // If dependents on the variable
+              if ((bvec_t(1) << i) & spsens) {
+                // Add to pattern
+                jcol.push_back(el);
+                jrow.push_back(i+k*bvec_size+offset);
+              }
             }
           }
         }
@@ -662,7 +984,7 @@ namespace casadi {
 
       // Remove the seeds
       for (casadi_int i=0; i<ndir_local; ++i) {
-        seed[offset+i] = 0;
+        seed[(offset+i)*nw + i/bvec_size] = 0;
       }
     }
 
@@ -729,7 +1051,8 @@ namespace casadi {
       // Clear the fine block structure
       fine.clear();
 
-      Sparsity D = r.star_coloring();
+      Sparsity D = r.star_coloring(1, std::numeric_limits<casadi_int>::max(),
+                                   coloring_num_threads_);
 
       if (verbose_) {
         casadi_message("Star coloring on " + str(r.dim()) + ": "
@@ -989,9 +1312,11 @@ namespace casadi {
       /**       Decide which ad_mode to take           */
 
       // Forward mode
-      Sparsity D1 = rT.uni_coloring(r);
+      Sparsity D1 = rT.uni_coloring(r, std::numeric_limits<casadi_int>::max(),
+                                    coloring_num_threads_);
       // Adjoint mode
-      Sparsity D2 = r.uni_coloring(rT);
+      Sparsity D2 = r.uni_coloring(rT, std::numeric_limits<casadi_int>::max(),
+                                   coloring_num_threads_);
       if (verbose_) {
         casadi_message("Coloring on " + str(r.dim()) + " (fwd seeps: " + str(D1.size2()) +
                  " , adj sweeps: " + str(D2.size1()) + ")");
@@ -1211,13 +1536,34 @@ namespace casadi {
     return r.T();
   }
 
+  Sparsity FunctionInternal::
+  get_jac_sparsity(casadi_int oind, casadi_int iind, bool symmetric) const {
+    casadi_error("'get_jac_sparsity' not defined for " + class_name());
+  }
+
   Sparsity FunctionInternal::getJacSparsity(casadi_int iind, casadi_int oind,
       bool symmetric) const {
+    // Pattern supplied by the class
+    if (has_jac_sparsity(oind, iind)) {
+      Sparsity sp = get_jac_sparsity(oind, iind, symmetric);
+      casadi_assert(sp.size1()==numel_out(oind) && sp.size2()==numel_in(iind),
+                    "Jacobian sparsity block (" + str(oind) + ", " + str(iind) + ") has "
+                    "dimensions " + sp.dim() + ", expected " + str(numel_out(oind)) + "-by-"
+                    + str(numel_in(iind)));
+      // Drop the rows and columns of structurally zero outputs and inputs
+      if (!sparsity_out(oind).is_dense() || !sparsity_in(iind).is_dense()) {
+        vector<casadi_int> mapping;
+        sp = sp.sub(sparsity_out(oind).find(), sparsity_in(iind).find(), mapping);
+      }
+      if (symmetric) sp = sp + sp.T();
+      return sp;
+    }
+
     // Check if we are able to propagate dependencies through the function
     if (has_spfwd() || has_sprev()) {
       Sparsity sp;
       if (nnz_in(iind)>3*bvec_size && nnz_out(oind)>3*bvec_size &&
-            GlobalOptions::hierarchical_sparsity) {
+            GlobalOptions::hierarchical_sparsity && sp_width()==1) {
         if (symmetric) {
           sp = getJacSparsityHierarchicalSymm(iind, oind);
         } else {
@@ -1228,13 +1574,16 @@ namespace casadi {
         casadi_int nz_in = nnz_in(iind);
         casadi_int nz_out = nnz_out(oind);
 
+        // Number of directions per sweep
+        casadi_int ndir = sp_width()*bvec_size;
+
         // Number of forward sweeps we must make
-        casadi_int nsweep_fwd = nz_in/bvec_size;
-        if (nz_in%bvec_size) nsweep_fwd++;
+        casadi_int nsweep_fwd = nz_in/ndir;
+        if (nz_in%ndir) nsweep_fwd++;
 
         // Number of adjoint sweeps we must make
-        casadi_int nsweep_adj = nz_out/bvec_size;
-        if (nz_out%bvec_size) nsweep_adj++;
+        casadi_int nsweep_adj = nz_out/ndir;
+        if (nz_out%ndir) nsweep_adj++;
 
         // Get weighting factor
         double w = sp_weight();
@@ -1268,8 +1617,15 @@ namespace casadi {
     if (jsp.is_null()) {
       if (compact) {
 
-        // Use internal routine to determine sparsity
-        jsp = getJacSparsity(iind, oind, symmetric);
+        // Use internal routine to determine sparsity, unless in the persistent cache
+        string key = "jac:" + str(iind) + ":" + str(oind) + ":" + str(symmetric);
+        vector<Sparsity> cached;
+        if (sparsity_cache_get(key, cached) && cached.size()==1) {
+          jsp = cached[0];
+        } else {
+          jsp = getJacSparsity(iind, oind, symmetric);
+          sparsity_cache_put(key, {jsp});
+        }
 
       } else {
 
@@ -1321,6 +1677,17 @@ namespace casadi {
     if (verbose_) casadi_message(name_ + "::get_partition");
     casadi_assert(allow_forward || allow_reverse, "Inconsistent options");
 
+    // Look up in the persistent cache
+    string key = "partition:" + str(iind) + ":" + str(oind) + ":" + str(compact)
+      + str(symmetric) + str(allow_forward) + str(allow_reverse) + ":" + str(ad_weight())
+      + ":" + str(coloring_num_threads_) + (ad_weight_timing_ ? ":timing" : "");
+    vector<Sparsity> cached;
+    if (sparsity_cache_get(key, cached) && cached.size()==2) {
+      D1 = cached[0];
+      D2 = cached[1];
+      return;
+    }
+
     // Sparsity pattern with transpose
     Sparsity &AT = sparsity_jac(iind, oind, compact, symmetric);
     Sparsity A = symmetric ? AT : AT.T();
@@ -1332,7 +1699,7 @@ namespace casadi {
 
       // Star coloring if symmetric
       if (verbose_) casadi_message("FunctionInternal::getPartition star_coloring");
-      D1 = A.star_coloring();
+      D1 = A.star_coloring(1, std::numeric_limits<casadi_int>::max(), coloring_num_threads_);
       if (verbose_) {
         casadi_message("Star coloring completed: " + str(D1.size2())
           + " directional derivatives needed ("
@@ -1349,6 +1716,28 @@ namespace casadi {
       if (w==0) allow_reverse = false;
       casadi_assert(allow_forward || allow_reverse, "Conflicting ad weights");
 
+      // Complete colorings for both modes, keep the one with the fastest evaluation
+      if (ad_weight_timing_ && allow_forward && allow_reverse) {
+        Sparsity D1_fwd = AT.uni_coloring(A, A.size1(), coloring_num_threads_);
+        Sparsity D2_adj = A.uni_coloring(AT, A.size2(), coloring_num_threads_);
+        double t_fwd = time_derivative(true, D1_fwd.size2());
+        double t_adj = time_derivative(false, D2_adj.size2());
+        if (verbose_) {
+          casadi_message("Timed colorings: " + str(D1_fwd.size2()) + " forward directions in "
+                         + str(t_fwd) + " s, " + str(D2_adj.size2()) + " adjoint directions in "
+                         + str(t_adj) + " s.");
+        }
+        if (t_fwd<=t_adj) {
+          D1 = D1_fwd;
+          D2 = Sparsity();
+        } else {
+          D1 = Sparsity();
+          D2 = D2_adj;
+        }
+        sparsity_cache_put(key, {D1, D2});
+        return;
+      }
+
       // Best coloring encountered so far (relatively tight upper bound)
       double best_coloring = numeric_limits<double>::infinity();
 
@@ -1372,7 +1761,7 @@ namespace casadi {
           bool d = best_coloring>=w*static_cast<double>(A.size1());
           casadi_int max_colorings_to_test =
             d ? A.size1() : static_cast<casadi_int>(floor(best_coloring/w));
-          D1 = AT.uni_coloring(A, max_colorings_to_test);
+          D1 = AT.uni_coloring(A, max_colorings_to_test, coloring_num_threads_);
           if (D1.is_null()) {
             if (verbose_) {
               casadi_message("Forward mode coloring interrupted (more than "
@@ -1393,7 +1782,7 @@ namespace casadi {
           casadi_int max_colorings_to_test =
             d ? A.size2() : static_cast<casadi_int>(floor(best_coloring/(1-w)));
 
-          D2 = A.uni_coloring(AT, max_colorings_to_test);
+          D2 = A.uni_coloring(AT, max_colorings_to_test, coloring_num_threads_);
           if (D2.is_null()) {
             if (verbose_) {
               casadi_message("Adjoint mode coloring interrupted (more than "
@@ -1412,6 +1801,139 @@ namespace casadi {
       }
 
     }
+
+    // Save in the persistent cache
+    sparsity_cache_put(key, {D1, D2});
+  }
+
+  double FunctionInternal::time_derivative(bool fwd, casadi_int ndir) const {
+    if (ndir==0) return 0;
+    try {
+      // Number of directions per call
+      casadi_int nb = std::min(ndir, max_num_dir_);
+      Function df = fwd ? self().forward(nb) : self().reverse(nb);
+      // Default input values, unit seeds
+      std::vector<DM> arg(df.n_in()), res;
+      for (casadi_int i=0; i<arg.size(); ++i) {
+        arg[i] = DM(df.sparsity_in(i), i<n_in_ ? get_default_in(i) : 1.);
+      }
+      // Best of a few evaluations
+      double t_best = inf;
+      FStats t;
+      for (casadi_int k=0; k<3; ++k) {
+        t.reset();
+        t.tic();
+        df.call(arg, res);
+        t.toc();
+        t_best = std::min(t_best, t.t_wall);
+      }
+      return t_best * static_cast<double>((ndir + nb - 1) / nb);
+    } catch (std::exception& e) {
+      if (verbose_) casadi_message("Timing of derivatives failed: " + string(e.what()));
+      return inf;
+    }
+  }
+
+  bool FunctionInternal::sparsity_cache_get(const std::string& key,
+                                            std::vector<Sparsity>& sp) const {
+    // Patterns of a structurally identical function
+    if (share_derivatives_ && !structure_key().empty()) {
+#ifdef CASADI_WITH_THREAD
+      std::lock_guard<std::mutex> lock(shared_mtx);
+#endif // CASADI_WITH_THREAD
+      auto it = shared_sparsity.find(structure_key() + ":" + key);
+      if (it!=shared_sparsity.end()) {
+        sp = it->second;
+        return true;
+      }
+    }
+    if (sparsity_cache_.empty()) return false;
+    // Locate and read the cache file upon first use
+    if (!sparsity_cache_loaded_) {
+      sparsity_cache_loaded_ = true;
+      // Structural description of the function: serialized, or else the generated code
+      std::stringstream ss;
+      try {
+        serialize(ss);
+      } catch (std::exception&) {
+        ss.str("");
+        if (has_codegen()) {
+          try {
+            CodeGenerator gen(name_);
+            gen.add(self());
+            gen.dump(ss);
+          } catch (std::exception&) {
+            ss.str("");
+          }
+        }
+      }
+      std::string s = ss.str();
+      if (s.empty()) {
+        if (verbose_) casadi_message("Persistent sparsity cache not supported for " + name_);
+        return false;
+      }
+      std::stringstream fname;
+      fname << sparsity_cache_ << "/sparsity_" << std::hex << std::hash<std::string>()(s)
+            << "_" << std::dec << s.size() << ".txt";
+      sparsity_cache_file_ = fname.str();
+      // Each line holds a key followed by the patterns, 'null' for a null pattern
+      std::ifstream file(sparsity_cache_file_);
+      std::string line;
+      while (std::getline(file, line)) {
+        std::istringstream ls(line);
+        std::string k, t;
+        size_t n;
+        if (!(ls >> k >> n)) continue;
+        std::vector<Sparsity> e;
+        try {
+          while (e.size()<n && ls >> t) {
+            e.push_back(t=="null" ? Sparsity() : Sparsity::deserialize(t));
+          }
+        } catch (std::exception&) {
+          continue;
+        }
+        if (e.size()==n) sparsity_cache_entries_[k] = e;
+      }
+      if (verbose_) {
+        casadi_message("Read " + str(sparsity_cache_entries_.size())
+                       + " entries from " + sparsity_cache_file_);
+      }
+    }
+    if (sparsity_cache_file_.empty()) return false;
+    // Look up the entry
+    auto it = sparsity_cache_entries_.find(key);
+    if (it==sparsity_cache_entries_.end()) return false;
+    sp = it->second;
+    return true;
+  }
+
+  void FunctionInternal::sparsity_cache_put(const std::string& key,
+                                            const std::vector<Sparsity>& sp) const {
+    // Make available to structurally identical functions
+    if (share_derivatives_ && !structure_key().empty()) {
+#ifdef CASADI_WITH_THREAD
+      std::lock_guard<std::mutex> lock(shared_mtx);
+#endif // CASADI_WITH_THREAD
+      shared_sparsity[structure_key() + ":" + key] = sp;
+    }
+    if (sparsity_cache_file_.empty()) return;
+    sparsity_cache_entries_[key] = sp;
+    // Append as a single line
+    std::stringstream line;
+    line << key << " " << sp.size();
+    for (const Sparsity& e : sp) {
+      line << " ";
+      if (e.is_null()) {
+        line << "null";
+      } else {
+        e.serialize(line);
+      }
+    }
+    line << "\n";
+    std::ofstream file(sparsity_cache_file_, std::ios::app);
+    if (!(file << line.str() << std::flush)) {
+      casadi_warning("Cannot write to sparsity cache '" + sparsity_cache_file_ + "'");
+    }
   }
 
   std::vector<DM> FunctionInternal::eval_dm(const std::vector<DM>& arg) const {
@@ -1541,6 +2063,63 @@ namespace casadi {
     casadi_error("'get_reverse' not defined for " + class_name());
   }
 
+  Function FunctionInternal::hessvec() const {
+    // Derivative information must be available
+    casadi_assert(has_derivative(), "Derivatives cannot be calculated for " + name_);
+    // Retrieve/generate cached
+    Function f;
+    string fname = "hessvec_" + name_;
+    if (!incache(fname, f)) {
+      casadi_int i;
+      // Names of inputs
+      std::vector<std::string> inames;
+      for (i=0; i<n_in_; ++i) inames.push_back(name_in_[i]);
+      for (i=0; i<n_in_; ++i) inames.push_back("fwd_" + name_in_[i]);
+      for (i=0; i<n_out_; ++i) inames.push_back("adj_" + name_out_[i]);
+      // Names of outputs
+      std::vector<std::string> onames;
+      for (i=0; i<n_in_; ++i) onames.push_back("fwd_adj_" + name_in_[i]);
+      // Options
+      Dict opts;
+      opts["max_num_dir"] = max_num_dir_;
+      opts["derivative_of"] = self();
+      // Generate derivative function
+      f = get_hessvec(fname, inames, onames, opts);
+      // Consistency check for inputs
+      casadi_assert_dev(f.n_in()==n_in_ + n_in_ + n_out_);
+      casadi_int ind=0;
+      for (i=0; i<n_in_; ++i) f.assert_size_in(ind++, size1_in(i), size2_in(i));
+      for (i=0; i<n_in_; ++i) f.assert_size_in(ind++, size1_in(i), size2_in(i));
+      for (i=0; i<n_out_; ++i) f.assert_size_in(ind++, size1_out(i), size2_out(i));
+      // Consistency check for outputs
+      casadi_assert_dev(f.n_out()==n_in_);
+      for (i=0; i<n_in_; ++i) f.assert_size_out(i, size1_in(i), size2_in(i));
+      // Save to cache
+      tocache(f);
+    }
+    return f;
+  }
+
+  Function FunctionInternal::
+  get_hessvec(const std::string& name,
+              const std::vector<std::string>& inames,
+              const std::vector<std::string>& onames,
+              const Dict& opts) const {
+    // Symbolic inputs and seeds
+    std::vector<MX> arg = mx_in(), fseed(n_in_), aseed(n_out_);
+    for (casadi_int i=0; i<n_in_; ++i) fseed[i] = MX::sym(inames[n_in_+i], sparsity_in(i));
+    for (casadi_int i=0; i<n_out_; ++i) aseed[i] = MX::sym(inames[2*n_in_+i], sparsity_out(i));
+    // Forward-over-reverse using the derivative functions
+    std::vector<MX> res = self()(arg);
+    std::vector<MX> asens = MX::reverse(res, arg, {aseed}).at(0);
+    std::vector<MX> ret = MX::forward(asens, arg, {fseed}).at(0);
+    // All inputs of the return function
+    std::vector<MX> ret_in = arg;
+    ret_in.insert(ret_in.end(), fseed.begin(), fseed.end());
+    ret_in.insert(ret_in.end(), aseed.begin(), aseed.end());
+    return Function(name, ret_in, ret, inames, onames, opts);
+  }
+
   void FunctionInternal::export_code(const std::string& lang, std::ostream &stream,
       const Dict& options) const {
     casadi_error("'export_code' not defined for " + class_name());
@@ -1550,6 +2129,10 @@ namespace casadi {
     casadi_error("'serialize' not defined for " + class_name());
   }
 
+  void FunctionInternal::serialize_binary(BinarySerializer& s) const {
+    casadi_error("'serialize_binary' not defined for " + class_name());
+  }
+
   void assert_read(std::istream &stream, const std::string& s) {
     casadi_int n = s.size();
     char c;
@@ -1714,6 +2297,13 @@ namespace casadi {
     // Give it a suitable name
     string name = "jac_" + name_;
 
+    // Created by a structurally identical function?
+    Function ret;
+    if (incache_shared(name, ret)) {
+      jacobian_ = ret;
+      return ret;
+    }
+
     // Names of inputs
     std::vector<std::string> inames;
     for (casadi_int i=0; i<n_in_; ++i) inames.push_back(name_in_[i]);
@@ -1728,7 +2318,7 @@ namespace casadi {
 
     // Generate derivative function
     casadi_assert_dev(enable_jacobian_);
-    Function ret = get_jacobian(name, inames, onames, opts);
+    ret = get_jacobian(name, inames, onames, opts);
 
     // Consistency check
     casadi_assert_dev(ret.n_in()==n_in_ + n_out_);
@@ -1736,6 +2326,7 @@ namespace casadi {
 
     // Cache it for reuse and return
     jacobian_ = ret;
+    tocache_shared(ret);
     return ret;
   }
 
@@ -1762,7 +2353,8 @@ namespace casadi {
   void FunctionInternal::codegen(CodeGenerator& g, const std::string& fname) const {
     // Define function
     g << "/* " << definition() << " */\n";
-    g << "static " << signature(fname) << " {\n";
+    // Visible to the other translation units when splitting
+    g << (g.split>1 ? "" : "static ") << signature(fname) << " {\n";
 
     // Reset local variables, flush buffer
     g.flush(g.body);
@@ -1867,9 +2459,9 @@ namespace casadi {
       // Declare wrapper
       g << "void mex_" << name_
         << "(int resc, mxArray *resv[], int argc, const mxArray *argv[]) {\n"
-        << "casadi_int i, j;\n";
+        << "casadi_int i, j, npt;\n";
 
-      // Work vectors, including input and output buffers
+      // Work vectors, including input and output buffers, persist between calls
       casadi_int i_nnz = nnz_in(), o_nnz = nnz_out();
       size_t sz_w = this->sz_w();
       for (casadi_int i=0; i<n_in_; ++i) {
@@ -1878,15 +2470,14 @@ namespace casadi {
         sz_w = max(sz_w, static_cast<size_t>(s.size2())); // To be able to copy a row
       }
       sz_w += i_nnz + o_nnz;
-      g << g.array("casadi_real", "w", sz_w);
-      g << g.array("casadi_int", "iw", sz_iw());
+      g << g.array("static casadi_real", "w", sz_w);
+      g << g.array("static casadi_int", "iw", sz_iw());
       string fw = "w+" + str(i_nnz + o_nnz);
+      g.add_auxiliary(CodeGenerator::AUX_MEX);
 
-      // Copy inputs to buffers
-      casadi_int offset=0;
+      // Number of points per input, zero if not passed
+      g << g.array("casadi_int", "npt_in", n_in_, "{0}");
       g << g.array("const casadi_real*", "arg", n_in_, "{0}");
-
-      // Allocate output buffers
       g << "casadi_real* res[" << n_out_ << "] = {0};\n";
 
       // Check arguments
@@ -1898,23 +2489,43 @@ namespace casadi {
         << "\"Evaluation of \\\"" << name_ << "\\\" failed. "
         << "Too many output arguments (%d, max " << n_out_ << ")\", resc);\n";
 
+      // Inputs with columns a multiple of the expected number are evaluated point by point
+      g << "npt = 1;\n";
       for (casadi_int i=0; i<n_in_; ++i) {
-        std::string p = "argv[" + str(i) + "]";
-        g << "if (--argc>=0) arg[" << i << "] = "
-          << g.from_mex(p, "w", offset, sparsity_in_[i], fw) << "\n";
-        offset += nnz_in(i);
+        g << "if (argc>" << i << ") {\n"
+          << "npt_in[" << i << "] = casadi_mex_npt(argv[" << i << "], "
+          << g.sparsity(sparsity_in_[i]) << ");\n"
+          << "if (npt_in[" << i << "]>1) {\n"
+          << "if (npt>1 && npt!=npt_in[" << i << "]) mexErrMsgIdAndTxt(\"Casadi:RuntimeError\","
+          << "\"Evaluation of \\\"" << name_ << "\\\" failed. "
+          << "Inconsistent number of points for input " << i << "\");\n"
+          << "npt = npt_in[" << i << "];\n"
+          << "}\n"
+          << "}\n";
       }
 
+      // Allocate outputs, always the first (possibly ans output)
       for (casadi_int i=0; i<n_out_; ++i) {
-        if (i==0) {
-          // if i==0, always store output (possibly ans output)
-          g << "--resc;\n";
-        } else {
-          // Store output, if it exists
-          g << "if (--resc>=0) ";
-        }
-        // Create and get pointer
-        g << "res[" << i << "] = w+" << str(offset) << ";\n";
+        if (i>0) g << "if (resc>" << i << ") ";
+        g << "resv[" << i << "] = casadi_mex_create(" << g.sparsity(sparsity_out_[i])
+          << ", npt);\n";
+      }
+
+      // Evaluate for each point
+      g << "for (j=0; j<npt; ++j) {\n";
+      casadi_int offset=0;
+      for (casadi_int i=0; i<n_in_; ++i) {
+        // Inputs not batched are only read once
+        g << "if (npt_in[" << i << "]>1 || (j==0 && npt_in[" << i << "])) "
+          << "arg[" << i << "] = casadi_mex_arg(argv[" << i << "], npt_in[" << i << "]>1 ? j : 0, "
+          << "w+" << offset << ", " << g.sparsity(sparsity_in_[i]) << ", " << fw << ");\n";
+        offset += nnz_in(i);
+      }
+      for (casadi_int i=0; i<n_out_; ++i) {
+        // Write directly to the MATLAB storage if possible
+        if (i>0) g << "if (resc>" << i << ") ";
+        g << "if (!(res[" << i << "] = casadi_mex_nz(resv[" << i << "], "
+          << g.sparsity(sparsity_out_[i]) << ", j))) res[" << i << "] = w+" << offset << ";\n";
         offset += nnz_out(i);
       }
 
@@ -1923,12 +2534,14 @@ namespace casadi {
         << "if (i) mexErrMsgIdAndTxt(\"Casadi:RuntimeError\",\"Evaluation of \\\"" << name_
         << "\\\" failed.\");\n";
 
-      // Save results
+      // Copy results that could not be written in place
+      offset = i_nnz;
       for (casadi_int i=0; i<n_out_; ++i) {
-        string res_i = "res[" + str(i) + "]";
-        g << "if (" << res_i << ") resv[" << i << "] = "
-          << g.to_mex(sparsity_out_[i], res_i) << "\n";
+        g << "if (res[" << i << "]==w+" << offset << ") casadi_mex_set(resv[" << i << "], "
+          << g.sparsity(sparsity_out_[i]) << ", j, res[" << i << "]);\n";
+        offset += nnz_out(i);
       }
+      g << "}\n";
 
       // End conditional compilation and function
       g << "}\n"
@@ -1987,6 +2600,46 @@ namespace casadi {
     }
 
     if (g.with_mem) {
+      // Memory objects with work vectors, one per concurrent call
+      string mem_t = name_ + "_mem_t";
+      g << "typedef struct {\n"
+        << "const casadi_real* arg[" << max(sz_arg(), size_t(1)) << "];\n"
+        << "casadi_real* res[" << max(sz_res(), size_t(1)) << "];\n"
+        << "casadi_int iw[" << max(sz_iw(), size_t(1)) << "];\n"
+        << "casadi_real w[" << max(sz_w_codegen, casadi_int(1)) << "];\n"
+        << "} " << mem_t << ";\n\n"
+        << "static " << mem_t << " " << name_ << "_mem[CASADI_MAX_NUM_THREADS];\n"
+        << "static volatile long " << name_ << "_mem_used[CASADI_MAX_NUM_THREADS];\n\n";
+
+      // Lock-free checkout: claim the first free slot, null if all are taken
+      g << g.declare("void* " + name_ + "_checkout(void)") << " {\n"
+        << "int i;\n"
+        << "for (i=0; i<CASADI_MAX_NUM_THREADS; ++i) {\n"
+        << "if (casadi_flag_acquire(" << name_ << "_mem_used+i)) return "
+        << name_ << "_mem+i;\n"
+        << "}\n"
+        << "return 0;\n"
+        << "}\n\n";
+
+      // Give a memory object back to the pool
+      g << g.declare("void " + name_ + "_release(void* mem)") << " {\n"
+        << "casadi_flag_release(" << name_ << "_mem_used+((" << mem_t << "*)mem-"
+        << name_ << "_mem));\n"
+        << "}\n\n";
+
+      // Thread-safe evaluation using work vectors from the pool
+      g << g.declare("int " + name_ + "_call(const casadi_real** arg, casadi_real** res)")
+        << " {\n"
+        << "int i, flag;\n"
+        << mem_t << "* m = (" << mem_t << "*)" << name_ << "_checkout();\n"
+        << "if (!m) return 1;\n"
+        << "for (i=0; i<" << n_in_ << "; ++i) m->arg[i] = arg[i];\n"
+        << "for (i=0; i<" << n_out_ << "; ++i) m->res[i] = res[i];\n"
+        << "flag = " << name_ << "(m->arg, m->res, m->iw, m->w, m);\n"
+        << name_ << "_release(m);\n"
+        << "return flag;\n"
+        << "}\n\n";
+
       // Allocate memory
       g << g.declare("casadi_functions* " + name_ + "_functions(void)") << " {\n"
         << "static casadi_functions fun = {\n"
@@ -1999,7 +2652,9 @@ namespace casadi {
         << name_ << "_sparsity_in,\n"
         << name_ << "_sparsity_out,\n"
         << name_ << "_work,\n"
-        << name_ << "\n"
+        << name_ << ",\n"
+        << name_ << "_checkout,\n"
+        << name_ << "_release\n"
         << "};\n"
         << "return &fun;\n"
         << "}\n";
@@ -2027,6 +2682,18 @@ namespace casadi {
     g << "#error Code generation not supported for " << class_name() << "\n";
   }
 
+  Dict FunctionInternal::codegen_footprint(const CodeGenerator& g) const {
+    casadi_int sz_w_codegen = sz_w();
+    if (is_a("SXFunction", true) && !g.avoid_stack()) sz_w_codegen = 0;
+    // Functions called by the generated code
+    std::vector<std::string> calls;
+    for (auto&& n : get_function()) calls.push_back(get_function(n).name());
+    return {{"class", class_name()}, {"sz_arg", static_cast<casadi_int>(sz_arg())},
+            {"sz_res", static_cast<casadi_int>(sz_res())},
+            {"sz_iw", static_cast<casadi_int>(sz_iw())}, {"sz_w", sz_w_codegen},
+            {"stack_real", 0}, {"calls", calls}, {"control", "static"}, {"bounded", true}};
+  }
+
   std::string FunctionInternal::
   generate_dependencies(const std::string& fname, const Dict& opts) const {
     casadi_error("'generate_dependencies' not defined for " + class_name());
@@ -2096,6 +2763,31 @@ namespace casadi {
     return 0;
   }
 
+  int FunctionInternal::
+  eval_batch(const double** arg, double** res, casadi_int* iw, double* w, void* mem,
+             casadi_int n) const {
+    casadi_error("'eval_batch' not defined for " + class_name());
+  }
+
+  void FunctionInternal::
+  codegen_body_batch(CodeGenerator& g, casadi_int n, const std::string& nb,
+                     const std::string& arg, const std::string& res,
+                     const std::string& w) const {
+    casadi_error("'codegen_body_batch' not defined for " + class_name());
+  }
+
+  int FunctionInternal::
+  sp_forward_wide(const bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w, void* mem,
+                  casadi_int nw) const {
+    casadi_error("'sp_forward_wide' not defined for " + class_name());
+  }
+
+  int FunctionInternal::
+  sp_reverse_wide(bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w, void* mem,
+                  casadi_int nw) const {
+    casadi_error("'sp_reverse_wide' not defined for " + class_name());
+  }
+
   void FunctionInternal::sz_work(size_t& sz_arg, size_t& sz_res,
                                  size_t& sz_iw, size_t& sz_w) const {
     sz_arg = this->sz_arg();
@@ -2136,6 +2828,15 @@ namespace casadi {
     }
   }
 
+  Dict FunctionInternal::get_stats(void* mem) const {
+    Dict stats;
+    if (!compiler_.is_null()) {
+      Dict c = compiler_.stats();
+      if (!c.empty()) stats["compiler"] = c;
+    }
+    return stats;
+  }
+
   void FunctionInternal::alloc(const Function& f, bool persistent) {
     if (f.is_null()) return;
     size_t sz_arg, sz_res, sz_iw, sz_w;
@@ -2542,6 +3243,10 @@ namespace casadi {
     casadi_error("'n_nodes' not defined for " + class_name());
   }
 
+  double FunctionInternal::n_instructions_sx() const {
+    return inf;
+  }
+
   std::vector<MX>
   FunctionInternal::mapsum_mx(const std::vector<MX > &x,
                               const std::string& parallelization) {
@@ -2613,10 +3318,14 @@ namespace casadi {
   }
 
   void ProtoFunction::clear_mem() {
-    for (auto&& i : mem_) {
-      if (i!=nullptr) free_mem(i);
+    for (casadi_int i=0; i<n_mem(); ++i) {
+      void*& m = mem_slot(i).mem;
+      if (m!=nullptr) free_mem(m);
+      m = nullptr;
     }
-    mem_.clear();
+    for (auto&& b : mem_blocks_) delete[] b.exchange(nullptr);
+    n_mem_ = 0;
+    unused_ = 0;
   }
 
   size_t FunctionInternal::get_n_in() {
@@ -2670,38 +3379,68 @@ namespace casadi {
     return Sparsity::scalar();
   }
 
+  ProtoFunction::MemSlot& ProtoFunction::mem_slot(casadi_int ind) const {
+    // Slot ind is number ind+1-2^k in block k, with 2^k <= ind+1 < 2^(k+1)
+    casadi_int k = 0;
+    while ((ind+1) >> (k+1)) k++;
+    return mem_blocks_[k].load(std::memory_order_acquire)[ind+1-(casadi_int(1) << k)];
+  }
+
   void* ProtoFunction::memory(casadi_int ind) const {
-#ifdef CASADI_WITH_THREAD
-    std::lock_guard<std::mutex> lock(mtx_);
-#endif //CASADI_WITH_THREAD
-    return mem_.at(ind);
+    casadi_assert(ind>=0 && ind<n_mem(), "Memory object " + str(ind) + " does not exist");
+    return mem_slot(ind).mem;
+  }
+
+  casadi_int ProtoFunction::memory_index(void* mem) const {
+    for (casadi_int i=0; i<n_mem(); ++i) {
+      if (mem_slot(i).mem==mem) return i;
+    }
+    return -1;
   }
 
   casadi_int ProtoFunction::checkout() const {
+    // Pop an unused memory object
+    uint64_t top = unused_.load(std::memory_order_acquire);
+    while (top & 0xffffffff) {
+      casadi_int ind = static_cast<casadi_int>(top & 0xffffffff) - 1;
+      uint64_t next = ((top >> 32) + 1) << 32
+        | static_cast<uint64_t>(mem_slot(ind).next.load(std::memory_order_relaxed));
+      if (unused_.compare_exchange_weak(top, next, std::memory_order_acquire,
+                                        std::memory_order_acquire)) return ind;
+    }
+    // Allocate a new memory object
 #ifdef CASADI_WITH_THREAD
     std::lock_guard<std::mutex> lock(mtx_);
 #endif //CASADI_WITH_THREAD
-    if (unused_.empty()) {
-      // Allocate a new memory object
-      void* m = alloc_mem();
-      mem_.push_back(m);
-      if (init_mem(m)) {
-        casadi_error("Failed to create or initialize memory object");
-      }
-      return mem_.size()-1;
-    } else {
-      // Use an unused memory object
-      casadi_int m = unused_.top();
-      unused_.pop();
-      return m;
+    casadi_int ind = n_mem_.load(std::memory_order_relaxed);
+    casadi_assert(ind < 0xffffffff, "Too many memory objects");
+    casadi_int k = 0;
+    while ((ind+1) >> (k+1)) k++;
+    if (ind+1==(casadi_int(1) << k)) {
+      // First slot of a new block
+      MemSlot* b = new MemSlot[casadi_int(1) << k];
+      mem_blocks_[k].store(b, std::memory_order_release);
+    }
+    MemSlot& slot = mem_slot(ind);
+    slot.mem = alloc_mem();
+    slot.next.store(0, std::memory_order_relaxed);
+    n_mem_.store(ind+1, std::memory_order_release);
+    if (init_mem(slot.mem)) {
+      casadi_error("Failed to create or initialize memory object");
     }
+    return ind;
   }
 
   void ProtoFunction::release(casadi_int mem) const {
-#ifdef CASADI_WITH_THREAD
-    std::lock_guard<std::mutex> lock(mtx_);
-#endif //CASADI_WITH_THREAD
-    unused_.push(mem);
+    // Push to the unused memory objects
+    MemSlot& slot = mem_slot(mem);
+    uint64_t top = unused_.load(std::memory_order_relaxed);
+    uint64_t next;
+    do {
+      slot.next.store(static_cast<casadi_int>(top & 0xffffffff), std::memory_order_relaxed);
+      next = ((top >> 32) + 1) << 32 | static_cast<uint64_t>(mem+1);
+    } while (!unused_.compare_exchange_weak(top, next, std::memory_order_release,
+                                            std::memory_order_relaxed));
   }
 
   Function FunctionInternal::
@@ -2713,6 +3452,85 @@ namespace casadi {
     return wrap().factory(name, s_in, s_out, aux, opts);
   }
 
+  casadi_int FunctionInternal::memory_bytes(const Sparsity& sp,
+                                            std::set<const void*>& visited) {
+    if (sp.is_null() || !visited.insert(sp.get()).second) return 0;
+    return sizeof(SparsityInternal) + sp->sp().capacity()*sizeof(casadi_int);
+  }
+
+  void FunctionInternal::memory_usage(std::map<std::string, casadi_int>& usage,
+                                      std::set<const void*>& visited) const {
+    // Sparsity patterns of the inputs and outputs
+    casadi_int& sp = usage["sparsity"];
+    for (auto&& e : sparsity_in_) sp += memory_bytes(e, visited);
+    for (auto&& e : sparsity_out_) sp += memory_bytes(e, visited);
+    // Cached Jacobian sparsity patterns
+    casadi_int& jac_sp = usage["jac_sparsity"];
+    for (auto* c : {&jac_sparsity_, &jac_sparsity_compact_}) {
+      jac_sp += memory_bytes(c->sparsity(), visited);
+      for (auto&& e : c->nonzeros()) jac_sp += memory_bytes(e, visited);
+    }
+    for (auto&& e : sparsity_cache_entries_) {
+      for (auto&& s : e.second) jac_sp += memory_bytes(s, visited);
+    }
+    // Memory objects and their checkout slots, the contents are class specific
+    usage["n_memory"] = n_mem();
+    usage["memory"] += n_mem()*(sizeof(void*) + sizeof(casadi_int));
+    // Work vectors needed per evaluation
+    usage["work"] = (sz_arg() + sz_res())*sizeof(void*) + sz_iw()*sizeof(casadi_int)
+      + sz_w()*sizeof(double);
+  }
+
+  std::vector<std::pair<std::string, Function> > FunctionInternal::memory_children() const {
+    std::vector<std::pair<std::string, Function> > ret;
+    for (auto&& n : get_function()) ret.push_back(std::make_pair(n, get_function(n)));
+    // Cached derivative functions that are still alive
+    for (auto&& c : cache_) {
+      Function f;
+      if (incache(c.first, f)) ret.push_back(std::make_pair(c.first, f));
+    }
+    return ret;
+  }
+
+  Dict FunctionInternal::memory_tree(std::set<const void*>& visited) const {
+    visited.insert(this);
+    std::map<std::string, casadi_int> usage;
+    memory_usage(usage, visited);
+    casadi_int total = 0;
+    Dict self;
+    for (auto&& e : usage) {
+      self[e.first] = e.second;
+      if (e.first!="n_memory") total += e.second;
+    }
+    Dict children;
+    for (auto&& c : memory_children()) {
+      if (c.second.is_null() || visited.count(c.second.get())) continue;
+      Dict d = c.second->memory_tree(visited);
+      total += d.at("total").as_int();
+      // Unique key
+      std::string key = c.first;
+      for (casadi_int k=1; children.count(key); ++k) key = c.first + "_" + str(k);
+      children[key] = d;
+    }
+    return {{"class", class_name()}, {"self", self}, {"total", total}, {"children", children}};
+  }
+
+  void FunctionInternal::print_memory_tree(std::ostream &stream, const Dict& tree,
+                                           const std::string& name, casadi_int indent) {
+    stream << std::string(2*indent, ' ') << name << " [" << tree.at("class").to_string()
+           << "]: " << tree.at("total").as_int() << " bytes (";
+    Dict self = tree.at("self");
+    bool first = true;
+    for (auto&& e : self) {
+      if (e.first=="n_memory" || e.second.as_int()==0) continue;
+      stream << (first ? "" : ", ") << e.first << " " << e.second.as_int();
+      first = false;
+    }
+    stream << ")" << endl;
+    Dict children = tree.at("children");
+    for (auto&& c : children) print_memory_tree(stream, c.second, c.first, indent+1);
+  }
+
   std::vector<std::string> FunctionInternal::get_function() const {
     // No functions
     return std::vector<std::string>();
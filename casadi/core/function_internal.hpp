@@ -27,6 +27,8 @@
 #define CASADI_FUNCTION_INTERNAL_HPP
 
 #include "function.hpp"
+#include <atomic>
+#include <cstdint>
 #include <set>
 #include <stack>
 #include "code_generator.hpp"
@@ -37,8 +39,10 @@
 #ifdef CASADI_WITH_THREAD
 #ifdef CASADI_WITH_THREAD_MINGW
 #include <mingw.mutex.h>
+#include <mingw.thread.h>
 #else // CASADI_WITH_THREAD_MINGW
 #include <mutex>
+#include <thread>
 #endif // CASADI_WITH_THREAD_MINGW
 #endif //CASADI_WITH_THREAD
 
@@ -51,6 +55,10 @@
 /// \cond INTERNAL
 
 namespace casadi {
+  // Forward declarations
+  class BinarySerializer;
+  class BinaryDeserializer;
+
   template<typename T>
   std::vector<std::pair<std::string, T>> zip(const std::vector<std::string>& id,
                                              const std::vector<T>& mat) {
@@ -99,15 +107,28 @@ namespace casadi {
     */
     virtual void finalize(const Dict& opts);
 
-    /// Checkout a memory object
+    /** \brief Checkout a memory object
+     * Lock-free unless a new memory object needs to be allocated */
     casadi_int checkout() const;
 
-    /// Release a memory object
+    /// Release a memory object, lock-free
     void release(casadi_int mem) const;
 
-    /// Memory objects
+    /// Memory objects, lock-free
     void* memory(casadi_int ind) const;
 
+    /// Index of a memory object, -1 if not found
+    casadi_int memory_index(void* mem) const;
+
+    /// Number of memory objects
+    casadi_int n_mem() const { return n_mem_.load(std::memory_order_acquire);}
+
+    /// Cancel the calls in progress, cf. Function::cancel
+    void cancel() const { cancel_epoch_.fetch_add(1, std::memory_order_relaxed);}
+
+    /// Name of the function
+    const std::string& name() const { return name_;}
+
     /** \brief Create memory block */
     virtual void* alloc_mem() const {return nullptr;}
 
@@ -126,15 +147,36 @@ namespace casadi {
 
     /// Verbose printout
     bool verbose_;
+
+    /// Number of cancellations, the calls in progress poll for changes, cf. Deadline
+    mutable std::atomic<casadi_int> cancel_epoch_;
   private:
-    /// Memory objects
-    mutable std::vector<void*> mem_;
+    /// Memory object with its link in the stack of unused memory objects
+    struct MemSlot {
+      void* mem;
+      std::atomic<casadi_int> next;
+    };
+
+    /// Slot of a memory object
+    MemSlot& mem_slot(casadi_int ind) const;
+
+    /// Maximum number of blocks of memory objects
+    static const casadi_int MEM_BLOCKS = 32;
+
+    /** \brief Blocks of memory objects, block k holds 2^k slots
+     * Blocks are never moved, so that slots can be accessed without locking */
+    mutable std::atomic<MemSlot*> mem_blocks_[MEM_BLOCKS];
 
-    /// Unused memory objects
-    mutable std::stack<casadi_int> unused_;
+    /// Number of memory objects
+    mutable std::atomic<casadi_int> n_mem_;
+
+    /** \brief Lock-free stack of unused memory objects
+     * The low 32 bits hold 1+index of the top (0 if empty), the high 32 bits a version
+     * counter that is incremented by each change to avoid the ABA problem */
+    mutable std::atomic<uint64_t> unused_;
 
 #ifdef CASADI_WITH_THREAD
-    /// Mutex for thread safety
+    /// Mutex for the allocation of memory objects
     mutable std::mutex mtx_;
 #endif // CASADI_WITH_THREAD
   };
@@ -202,12 +244,27 @@ namespace casadi {
     virtual bool has_sprev() const { return false;}
     ///@}
 
+    ///@{
+    /** \brief Sparsity of a Jacobian block known without propagation
+        Dimensions numel_out(oind)-by-numel_in(iind) */
+    virtual bool has_jac_sparsity(casadi_int oind, casadi_int iind) const { return false;}
+    virtual Sparsity get_jac_sparsity(casadi_int oind, casadi_int iind, bool symmetric) const;
+    ///@}
+
     ///@{
     /** \brief  Evaluate numerically */
     int eval_gen(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const;
     virtual int eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const;
     ///@}
 
+    /** \brief Can the numerical evaluation run in parallel with other evaluations?
+        False for plugins wrapping libraries with global state, evaluated under SerialLock */
+    virtual bool is_reentrant() const { return true;}
+
+    /** \brief Can calls from several threads run in parallel? cf. Function::is_thread_safe
+        By default, if reentrant and all functions in get_function are thread-safe */
+    virtual bool is_thread_safe() const;
+
     /** \brief  Evaluate with symbolic scalars */
     virtual int eval_sx(const SXElem** arg, SXElem** res,
       casadi_int* iw, SXElem* w, void* mem) const;
@@ -360,6 +417,20 @@ namespace casadi {
                                  const Dict& opts) const;
     ///@}
 
+    ///@{
+    /** \brief Return function that calculates Hessian-vector products
+     *    hessvec() returns a cached instance if available,
+     *    and calls <tt>Function get_hessvec()</tt>
+     *    if no cached version is available. By default forward-over-reverse
+     *    with the functions returned by reverse(1) and forward(1)
+     */
+    Function hessvec() const;
+    virtual Function get_hessvec(const std::string& name,
+                                 const std::vector<std::string>& inames,
+                                 const std::vector<std::string>& onames,
+                                 const Dict& opts) const;
+    ///@}
+
     /** \brief returns a new function with a selection of inputs/outputs of the original */
     virtual Function slice(const std::string& name, const std::vector<casadi_int>& order_in,
                            const std::vector<casadi_int>& order_out, const Dict& opts) const;
@@ -422,6 +493,10 @@ namespace casadi {
     /** \brief Number of nodes in the algorithm */
     virtual casadi_int n_nodes() const;
 
+    /** \brief Estimated number of atomic operations after expansion to SX,
+        inf if the function cannot be expanded */
+    virtual double n_instructions_sx() const;
+
     /** *\brief get MX expression associated with instruction */
     virtual MX instruction_MX(casadi_int k) const;
 
@@ -434,6 +509,16 @@ namespace casadi {
     /** \brief Save function to cache */
     void tocache(const Function& f) const;
 
+    /** \brief Get function in the cache shared by structurally identical functions */
+    bool incache_shared(const std::string& fname, Function& f) const;
+
+    /** \brief Save function to the cache shared by structurally identical functions */
+    void tocache_shared(const Function& f) const;
+
+    /** \brief Key identifying structurally identical functions, cf. "share_derivatives"
+        Empty if the function cannot be serialized */
+    const std::string& structure_key() const;
+
     /** \brief Generate code the function */
     void codegen(CodeGenerator& g, const std::string& fname) const;
 
@@ -467,6 +552,11 @@ namespace casadi {
     /** \brief Is codegen supported? */
     virtual bool has_codegen() const { return false;}
 
+    /** \brief Worst-case footprint of the generated code, cf. option "with_report"
+     * Work vector lengths, local real variables on the stack ("stack_real"), operation
+     * counts, called functions and whether the control flow is data dependent */
+    virtual Dict codegen_footprint(const CodeGenerator& g) const;
+
     /** \brief Jit dependencies */
     virtual void jit_dependencies(const std::string& fname) {}
 
@@ -480,6 +570,9 @@ namespace casadi {
     /** \brief Serialize function header */
     void serialize_header(std::ostream &stream) const;
 
+    /** \brief Serialize in the binary format, cf. Function::save */
+    virtual void serialize_binary(BinarySerializer& s) const;
+
     /** \brief Build function from serialization */
     static void deserialize_header(std::istream& stream,
         std::string& name,
@@ -511,6 +604,9 @@ namespace casadi {
     /** \brief Print all information there is to know about a certain option */
     void print_option(const std::string &name, std::ostream &stream) const;
 
+    /** \brief Print the instruction profile in the statistics, most expensive first */
+    void print_instruction_profile(std::ostream &stream, void* mem) const;
+
     /** \brief Print free variables */
     virtual std::vector<std::string> get_free() const;
 
@@ -519,6 +615,10 @@ namespace casadi {
                       bool compact, bool symmetric,
                       bool allow_forward, bool allow_reverse) const;
 
+    /** \brief Wall time [s] of evaluating ndir forward or adjoint directional derivatives
+        Used by option "ad_weight_timing", infinite if evaluation fails */
+    double time_derivative(bool fwd, casadi_int ndir) const;
+
     ///@{
     /** \brief Number of input/output nonzeros */
     casadi_int nnz_in() const;
@@ -578,6 +678,12 @@ namespace casadi {
     /// Get, if necessary generate, the sparsity of a Jacobian block
     Sparsity& sparsity_jac(casadi_int iind, casadi_int oind, bool compact, bool symmetric) const;
 
+    /// Look up sparsity patterns in the persistent sparsity cache
+    bool sparsity_cache_get(const std::string& key, std::vector<Sparsity>& sp) const;
+
+    /// Store sparsity patterns in the persistent sparsity cache
+    void sparsity_cache_put(const std::string& key, const std::vector<Sparsity>& sp) const;
+
     /// Get a vector of symbolic variables corresponding to the outputs
     virtual std::vector<MX> symbolic_output(const std::vector<MX>& arg) const;
 
@@ -652,6 +758,45 @@ namespace casadi {
     /** \brief  Propagate sparsity backwards */
     virtual int sp_reverse(bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w, void* mem) const;
 
+    /** \brief Is batched evaluation supported, numerically and in generated code? */
+    virtual bool has_eval_batch() const { return false;}
+
+    /** \brief Should callers pass as many points as possible to eval_batch by default?
+        True when a call is expensive compared to a point, e.g. a Callback crossing
+        into an interpreter */
+    virtual bool prefer_eval_batch() const { return false;}
+
+    /** \brief Generate code for batched evaluation of n points, cf. eval_batch
+        The generated code evaluates the points 0..nb-1, with nb a variable of the
+        surrounding code, nb<=n. Work vector element i of point k is located at w[i*n+k].
+        The loop index k must be declared by the surrounding code.
+    */
+    virtual void codegen_body_batch(CodeGenerator& g, casadi_int n, const std::string& nb,
+                                    const std::string& arg, const std::string& res,
+                                    const std::string& w) const;
+
+    /** \brief Evaluate numerically for n points at once
+        The inputs and outputs of point k are stored contiguously after those of point k-1,
+        i.e. at offset k*nnz_in(i) and k*nnz_out(i). The work vector w must hold n*sz_w()
+        elements.
+    */
+    virtual int eval_batch(const double** arg, double** res, casadi_int* iw, double* w,
+                           void* mem, casadi_int n) const;
+
+    /** \brief Number of bvec_t words per nonzero in wide sparsity propagation
+        If larger than one, getJacSparsityGen propagates sp_width()*bvec_size directions
+        per sweep using sp_forward_wide and sp_reverse_wide.
+    */
+    virtual casadi_int sp_width() const { return 1;}
+
+    /** \brief  Propagate sparsity forward, nw consecutive bvec_t words per nonzero */
+    virtual int sp_forward_wide(const bvec_t** arg, bvec_t** res,
+                                casadi_int* iw, bvec_t* w, void* mem, casadi_int nw) const;
+
+    /** \brief  Propagate sparsity backwards, nw consecutive bvec_t words per nonzero */
+    virtual int sp_reverse_wide(bvec_t** arg, bvec_t** res,
+                                casadi_int* iw, bvec_t* w, void* mem, casadi_int nw) const;
+
     /** \brief Get number of temporary variables needed */
     void sz_work(size_t& sz_arg, size_t& sz_res, size_t& sz_iw, size_t& sz_w) const;
 
@@ -682,8 +827,30 @@ namespace casadi {
     /** \brief Ensure work vectors long enough to evaluate function */
     void alloc(const Function& f, bool persistent=false);
 
-    /// Get all statistics
-    virtual Dict get_stats(void* mem) const { return Dict();}
+    /// Get all statistics, including those of the JIT compiler
+    virtual Dict get_stats(void* mem) const;
+
+    /** \brief Add the estimated heap memory of the function itself in bytes, per category
+     * Objects in visited have already been counted */
+    virtual void memory_usage(std::map<std::string, casadi_int>& usage,
+                              std::set<const void*>& visited) const;
+
+    /** \brief Nested functions with their names, for the memory footprint */
+    virtual std::vector<std::pair<std::string, Function> > memory_children() const;
+
+    /** \brief Memory footprint of the function and its nested functions, cf. Function::memory_usage */
+    Dict memory_tree(std::set<const void*>& visited) const;
+
+    /** \brief Print a memory footprint */
+    static void print_memory_tree(std::ostream &stream, const Dict& tree,
+                                  const std::string& name, casadi_int indent);
+
+    /** \brief Heap memory of a sparsity pattern in bytes, 0 if already visited */
+    static casadi_int memory_bytes(const Sparsity& sp, std::set<const void*>& visited);
+
+    /** \brief Heap memory of the elements of a vector in bytes */
+    template<typename T>
+    static casadi_int memory_bytes(const std::vector<T>& v) { return v.capacity()*sizeof(T);}
 
     /** \brief Set the (persistent) work vectors */
     virtual void set_work(void* mem, const double**& arg, double**& res,
@@ -705,8 +872,16 @@ namespace casadi {
     /** Obtain information about function */
     virtual Dict info() const;
 
+    /** \brief Compile generated code, reusing a library compiled from identical code */
+    static Importer jit_import(const std::string& fname, const std::string& compiler,
+                               const Dict& opts, bool compile=true);
+
+    /** \brief Compile generated code in a background thread */
+    void jit_async(const std::string& fname);
+
     /** \brief Generate/retrieve cached serial map */
-    Function map(casadi_int n, const std::string& parallelization) const;
+    Function map(casadi_int n, const std::string& parallelization,
+                 const Dict& opts=Dict()) const;
 
     /// Number of inputs and outputs
     size_t n_in_, n_out_;
@@ -720,6 +895,27 @@ namespace casadi {
     /** \brief  Use just-in-time compiler */
     bool jit_;
 
+    /** \brief  Reuse libraries jit-compiled from identical code */
+    bool jit_cache_;
+
+    /** \brief  Compile in the background */
+    bool jit_async_;
+
+#ifdef CASADI_WITH_THREAD
+    /** \brief  State of the background compilation */
+    enum JitState {JIT_PENDING, JIT_READY, JIT_FAILED, JIT_REPORTED};
+    mutable std::atomic<int> jit_state_;
+
+    /** \brief  Compiled function, valid when jit_state_==JIT_READY */
+    eval_t eval_async_;
+
+    /** \brief  Error message of a failed background compilation */
+    std::string jit_error_;
+
+    /** \brief  Thread for the background compilation */
+    std::thread jit_thread_;
+#endif // CASADI_WITH_THREAD
+
     /** \brief Numerical evaluation redirected to a C function */
     eval_t eval_;
 
@@ -738,6 +934,23 @@ namespace casadi {
     /// Cache for sparsities of the Jacobian blocks
     mutable SparseStorage<Sparsity> jac_sparsity_, jac_sparsity_compact_;
 
+    /// Directory of the persistent sparsity cache, empty if disabled
+    std::string sparsity_cache_;
+
+    /// File of the persistent sparsity cache, empty if not (yet) available
+    mutable std::string sparsity_cache_file_;
+    mutable bool sparsity_cache_loaded_;
+
+    /// Entries read from or written to the persistent sparsity cache
+    mutable std::map<std::string, std::vector<Sparsity> > sparsity_cache_entries_;
+
+    /// Share derivatives with structurally identical functions
+    bool share_derivatives_;
+
+    /// Structural key, cf. structure_key()
+    mutable std::string structure_key_;
+    mutable bool structure_key_set_;
+
     /// If the function is the derivative of another function
     Function derivative_of_;
 
@@ -761,6 +974,15 @@ namespace casadi {
     /// Maximum number of sensitivity directions
     casadi_int max_num_dir_;
 
+    /// Number of threads for graph coloring
+    casadi_int coloring_num_threads_;
+
+    /// Number of threads for the symbolic construction of Jacobians
+    casadi_int ad_num_threads_;
+
+    /// Choose the AD mode of the Jacobian blocks by timing
+    bool ad_weight_timing_;
+
     /// Errors are thrown when NaN is produced
     bool regularity_check_;
 
@@ -333,6 +333,49 @@ namespace casadi {
     static MatType bilin(const MatType& A, const MatType& x, const MatType& y);
     ///@}
 
+    ///@{
+    /** \brief Full discrete convolution of two vectors, cf. Matlab's \c conv
+     *
+     * Returns a column vector of length h.numel()+x.numel()-1
+     */
+    inline friend MatType conv(const MatType &h, const MatType &x) {
+      return MatType::conv(h, x);
+    }
+    static MatType conv(const MatType& h, const MatType& x);
+    ///@}
+
+    ///@{
+    /** \brief Calculate kron(a, b)*x without forming the Kronecker product
+     *
+     * Evaluated column by column as vec(b*X*a^T), with X the column reshaped
+     */
+    inline friend MatType kron_mtimes(const MatType &a, const MatType &b, const MatType &x) {
+      return MatType::kron_mtimes(a, b, x);
+    }
+    static MatType kron_mtimes(const MatType& a, const MatType& b, const MatType& x);
+    ///@}
+
+    ///@{
+    /** \brief Calculate diagcat(a)*x without forming the block diagonal matrix
+     */
+    inline friend MatType diagcat_mtimes(const std::vector<MatType> &a, const MatType &x) {
+      return MatType::diagcat_mtimes(a, x);
+    }
+    static MatType diagcat_mtimes(const std::vector<MatType>& a, const MatType& x);
+    ///@}
+
+    ///@{
+    /** \brief Multiply with a Toeplitz matrix without forming it
+     *
+     * The matrix has first column c and first row r, with r(0) ignored as in
+     * Matlab's \c toeplitz. The product is evaluated as a convolution.
+     */
+    inline friend MatType toeplitz_mtimes(const MatType &c, const MatType &r, const MatType &x) {
+      return MatType::toeplitz_mtimes(c, r, x);
+    }
+    static MatType toeplitz_mtimes(const MatType& c, const MatType& r, const MatType& x);
+    ///@}
+
     ///@{
     /** \brief Make a rank-1 update to a matrix A
      * Calculates A + 1/2 * alpha * x*y'
@@ -1117,6 +1160,65 @@ namespace casadi {
     return MatType::_bilin(A, x, y);
   }
 
+  template<typename MatType>
+  MatType GenericMatrix<MatType>::conv(const MatType& h, const MatType& x) {
+    casadi_assert(h.is_vector() && x.is_vector(),
+      "conv(h, x): Arguments must be vectors, got " + h.dim() + " and " + x.dim() + ".");
+    if (h.is_empty() || x.is_empty()) return MatType(0, 1);
+
+    // Call the class specific method
+    return MatType::_conv(densify(vec(h)), densify(vec(x)));
+  }
+
+  template<typename MatType>
+  MatType GenericMatrix<MatType>::kron_mtimes(const MatType& a, const MatType& b,
+                                              const MatType& x) {
+    casadi_assert(x.size1()==a.size2()*b.size2(),
+      "kron_mtimes(a, b, x): Dimension mismatch. Got x.size1() = " + str(x.size1())
+      + " but kron(a, b) has " + str(a.size2()*b.size2()) + " columns.");
+    if (x.size2()==0) return MatType(a.size1()*b.size1(), 0);
+    std::vector<MatType> ret;
+    for (auto&& xj : horzsplit(x)) {
+      ret.push_back(vec(mtimes(b, mtimes(reshape(xj, b.size2(), a.size2()), a.T()))));
+    }
+    return horzcat(ret);
+  }
+
+  template<typename MatType>
+  MatType GenericMatrix<MatType>::diagcat_mtimes(const std::vector<MatType>& a,
+                                                 const MatType& x) {
+    std::vector<casadi_int> offset(1, 0);
+    for (auto&& e : a) offset.push_back(offset.back()+e.size2());
+    casadi_assert(x.size1()==offset.back(),
+      "diagcat_mtimes(a, x): Dimension mismatch. Got x.size1() = " + str(x.size1())
+      + " but the blocks have " + str(offset.back()) + " columns.");
+    std::vector<MatType> xs = vertsplit(x, offset);
+    std::vector<MatType> ret(a.size());
+    for (casadi_int i=0; i<a.size(); ++i) ret[i] = mtimes(a[i], xs[i]);
+    return vertcat(ret);
+  }
+
+  template<typename MatType>
+  MatType GenericMatrix<MatType>::toeplitz_mtimes(const MatType& c, const MatType& r,
+                                                  const MatType& x) {
+    casadi_assert(c.is_vector() && r.is_vector() && !c.is_empty() && !r.is_empty(),
+      "toeplitz_mtimes(c, r, x): c and r must be nonempty vectors, got "
+      + c.dim() + " and " + r.dim() + ".");
+    casadi_int m = c.numel(), n = r.numel();
+    casadi_assert(x.size1()==n,
+      "toeplitz_mtimes(c, r, x): Dimension mismatch. Got x.size1() = " + str(x.size1())
+      + " but the matrix has " + str(n) + " columns.");
+    if (x.size2()==0) return MatType(m, 0);
+
+    // Diagonals from the top right to the bottom left corner
+    MatType t = vertcat(vec(r).nz(Matrix<casadi_int>(range(n-1, 0, -1))), vec(c));
+    std::vector<MatType> ret;
+    for (auto&& xj : horzsplit(x)) {
+      ret.push_back(conv(t, xj).nz(Slice(n-1, n-1+m)));
+    }
+    return horzcat(ret);
+  }
+
   template<typename MatType>
   MatType GenericMatrix<MatType>::rank1(const MatType& A, const MatType& alpha,
                                         const MatType& x, const MatType& y) {
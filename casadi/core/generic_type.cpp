@@ -217,7 +217,7 @@ namespace casadi {
   GenericType::GenericType(const vector<int>& iv) {
     std::vector<casadi_int> temp(iv.size());
     std::copy(iv.begin(), iv.end(), temp.begin());
-    own(new IntVectorType(temp));
+    own(new IntVectorType(std::move(temp)));
   }
 
   GenericType::GenericType(const vector<vector<casadi_int> >& ivv) {
@@ -227,7 +227,7 @@ namespace casadi {
   GenericType::GenericType(const vector<bool>& b_vec) {
     vector<casadi_int> i_vec(b_vec.size());
     copy(b_vec.begin(), b_vec.end(), i_vec.begin());
-    own(new IntVectorType(i_vec));
+    own(new IntVectorType(std::move(i_vec)));
   }
 
   GenericType::GenericType(const vector<double>& dv) {
@@ -250,6 +250,34 @@ namespace casadi {
     own(new StringType(s));
   }
 
+  GenericType::GenericType(string&& s) {
+    own(new StringType(std::move(s)));
+  }
+
+  GenericType::GenericType(vector<casadi_int>&& iv) {
+    own(new IntVectorType(std::move(iv)));
+  }
+
+  GenericType::GenericType(vector<vector<casadi_int> >&& ivv) {
+    own(new IntVectorVectorType(std::move(ivv)));
+  }
+
+  GenericType::GenericType(vector<double>&& dv) {
+    own(new DoubleVectorType(std::move(dv)));
+  }
+
+  GenericType::GenericType(vector< vector<double> >&& dv) {
+    own(new DoubleVectorVectorType(std::move(dv)));
+  }
+
+  GenericType::GenericType(vector<string>&& sv) {
+    own(new StringVectorType(std::move(sv)));
+  }
+
+  GenericType::GenericType(std::vector<Function>&& f) {
+    own(new FunctionVectorType(std::move(f)));
+  }
+
   GenericType::GenericType(const Function& f) {
     own(new FunctionType(f));
   }
@@ -513,6 +541,10 @@ namespace casadi {
     own(new DictType(dict));
   }
 
+  GenericType::GenericType(Dict&& dict) {
+    own(new DictType(std::move(dict)));
+  }
+
   void* GenericType::to_void_pointer() const {
     casadi_assert(getType()==OT_VOIDPTR, "type mismatch");
     return as_void_pointer();
@@ -57,6 +57,11 @@ namespace casadi {
 #endif // SWIG
 
   /** \brief Generic data type, can hold different types such as bool, casadi_int, string etc.
+
+      Copies are shallow: the payload is reference counted and never modified in place,
+      so copying a Dict does not copy the vectors or nested dictionaries it holds.
+      Temporaries are moved into the payload.
+
       \author Joel Andersson
       \date 2010
   */
@@ -94,6 +99,20 @@ namespace casadi {
     GenericType(const Dict& dict);
     GenericType(void* ptr);
 
+#ifndef SWIG
+    ///@{
+    /// Constructors taking over the data of a temporary
+    GenericType(std::string&& s);
+    GenericType(std::vector<casadi_int>&& iv);
+    GenericType(std::vector< std::vector<casadi_int> >&& ivv);
+    GenericType(std::vector<double>&& dv);
+    GenericType(std::vector< std::vector<double> >&& dv);
+    GenericType(std::vector<std::string>&& sv);
+    GenericType(std::vector<Function>&& f);
+    GenericType(Dict&& dict);
+    ///@}
+#endif // SWIG
+
     /// Public class name
     static std::string type_name() {return "GenericType";}
 
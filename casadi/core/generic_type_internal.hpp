@@ -44,6 +44,7 @@ namespace casadi {
   class CASADI_EXPORT GenericTypeInternal : public GenericTypeBase {
   public:
     explicit GenericTypeInternal(const T& d) : d_(d) {}
+    explicit GenericTypeInternal(T&& d) : d_(std::move(d)) {}
     ~GenericTypeInternal() override {}
     std::string class_name() const override {return "GenericTypeInternal";}
     void disp(std::ostream& stream, bool more) const override { stream << d_; }
@@ -40,6 +40,9 @@ namespace casadi {
       pair<Slice, Slice> sl = to_slice2(nz);
       return create(sp, x, sl.first, sl.second);
     }
+    // Simplify to piecewise strided
+    vector<casadi_int> runs = to_runs(nz);
+    if (!runs.empty()) return MX::create(new GetNonzerosRuns(sp, x, runs));
     return MX::create(new GetNonzerosVector(sp, x, nz));
   }
 
@@ -128,6 +131,33 @@ namespace casadi {
     return 0;
   }
 
+  int GetNonzerosRuns::
+  eval(const double** arg, double** res, casadi_int* iw, double* w) const {
+    return eval_gen<double>(arg, res, iw, w);
+  }
+
+  int GetNonzerosRuns::
+  eval_sx(const SXElem** arg, SXElem** res, casadi_int* iw, SXElem* w) const {
+    return eval_gen<SXElem>(arg, res, iw, w);
+  }
+
+  template<typename T>
+  int GetNonzerosRuns::
+  eval_gen(const T* const* arg, T* const* res, casadi_int* iw, T* w) const {
+    const T* idata = arg[0];
+    T* odata = res[0];
+    for (auto r=runs_.begin(); r!=runs_.end(); r+=3) {
+      casadi_int start = r[0], step = r[1], len = r[2];
+      if (start<0) {
+        std::fill(odata, odata+len, T(0));
+        odata += len;
+      } else {
+        for (casadi_int i=0; i<len; ++i) *odata++ = idata[start+i*step];
+      }
+    }
+    return 0;
+  }
+
   int GetNonzerosVector::
   sp_forward(const bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w) const {
     const bvec_t *a = arg[0];
@@ -193,6 +223,29 @@ namespace casadi {
     return 0;
   }
 
+  int GetNonzerosRuns::
+  sp_forward(const bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w) const {
+    const bvec_t *a = arg[0];
+    bvec_t *r = res[0];
+    for (auto p=runs_.begin(); p!=runs_.end(); p+=3) {
+      for (casadi_int i=0; i<p[2]; ++i) *r++ = p[0]>=0 ? a[p[0]+i*p[1]] : 0;
+    }
+    return 0;
+  }
+
+  int GetNonzerosRuns::
+  sp_reverse(bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w) const {
+    bvec_t *a = arg[0];
+    bvec_t *r = res[0];
+    for (auto p=runs_.begin(); p!=runs_.end(); p+=3) {
+      for (casadi_int i=0; i<p[2]; ++i) {
+        if (p[0]>=0) a[p[0]+i*p[1]] |= *r;
+        *r++ = 0;
+      }
+    }
+    return 0;
+  }
+
   std::string GetNonzerosVector::disp(const std::vector<std::string>& arg) const {
     stringstream ss;
     ss << arg.at(0) << nz_;
@@ -211,6 +264,21 @@ namespace casadi {
     return ss.str();
   }
 
+  std::string GetNonzerosRuns::disp(const std::vector<std::string>& arg) const {
+    stringstream ss;
+    ss << arg.at(0) << "[";
+    for (casadi_int r=0; r<runs_.size(); r+=3) {
+      if (r>0) ss << ", ";
+      if (runs_[r]<0) {
+        ss << "0*" << runs_[r+2];
+      } else {
+        ss << runs_[r] << ":" << runs_[r]+runs_[r+1]*runs_[r+2] << ":" << runs_[r+1];
+      }
+    }
+    ss << "]";
+    return ss.str();
+  }
+
   void GetNonzeros::eval_mx(const std::vector<MX>& arg, std::vector<MX>& res) const {
     // Get all the nonzeros
     vector<casadi_int> nz = all();
@@ -522,6 +590,23 @@ namespace casadi {
       << "; tt+=" << inner_.step << ") *rr++ = *tt;\n";
   }
 
+  void GetNonzerosRuns::generate(CodeGenerator& g,
+                                 const std::vector<casadi_int>& arg,
+                                 const std::vector<casadi_int>& res) const {
+    // Codegen the runs
+    string ind = g.constant(runs_);
+
+    // Codegen the assignments
+    g.local("cii", "const casadi_int", "*");
+    g.local("rr", "casadi_real", "*");
+    g.local("ss", "casadi_real", "*");
+    g.local("i", "casadi_int");
+    g << "for (cii=" << ind << ", rr=" << g.work(res[0], nnz())
+      << ", ss=" << g.work(arg[0], dep(0).nnz())
+      << "; cii!=" << ind << "+" << runs_.size()
+      << "; cii+=3) for (i=0; i<cii[2]; ++i) *rr++ = cii[0]>=0 ? ss[cii[0]+i*cii[1]] : 0;\n";
+  }
+
   bool GetNonzerosVector::is_equal(const MXNode* node, casadi_int depth) const {
     // Check dependencies
     if (!sameOpAndDeps(node, depth)) return false;
@@ -540,6 +625,21 @@ namespace casadi {
     return true;
   }
 
+  bool GetNonzerosRuns::is_equal(const MXNode* node, casadi_int depth) const {
+    // Check dependencies
+    if (!sameOpAndDeps(node, depth)) return false;
+
+    // Check if same node
+    const GetNonzerosRuns* n = dynamic_cast<const GetNonzerosRuns*>(node);
+    if (n==nullptr) return false;
+
+    // Check sparsity
+    if (this->sparsity()!=node->sparsity()) return false;
+
+    // Check runs
+    return this->runs_==n->runs_;
+  }
+
   bool GetNonzerosSlice::is_equal(const MXNode* node, casadi_int depth) const {
     // Check dependencies
     if (!sameOpAndDeps(node, depth)) return false;
@@ -25,6 +25,9 @@
 
 #include "global_options.hpp"
 #include "exception.hpp"
+#include "node_pool.hpp"
+#include "profiler.hpp"
+#include "thread_pool.hpp"
 
 namespace casadi {
 
@@ -38,4 +41,52 @@ namespace casadi {
   // By default, use zero-based indexing
   casadi_int GlobalOptions::start_index = 0;
 
+  bool GlobalOptions::node_pool = false;
+
+  casadi_int GlobalOptions::getNodeMemory() {
+    return static_cast<casadi_int>(NodePool::memory());
+  }
+
+  casadi_int GlobalOptions::getNodeMemoryPeak() {
+    return static_cast<casadi_int>(NodePool::peak_memory());
+  }
+
+  void GlobalOptions::resetNodeMemoryPeak() {
+    NodePool::reset_peak_memory();
+  }
+
+  void GlobalOptions::setProfiling(bool flag) {
+    Profiler::enabled = flag;
+  }
+
+  bool GlobalOptions::getProfiling() {
+    return Profiler::enabled;
+  }
+
+  void GlobalOptions::resetProfile() {
+    Profiler::reset();
+  }
+
+  void GlobalOptions::setThreadPinning(bool flag) {
+    ThreadPool::set_pinning(flag);
+  }
+
+  bool GlobalOptions::getThreadPinning() {
+    return ThreadPool::pinning();
+  }
+
+  void GlobalOptions::setEvaluationHook(EvaluationHook* hook) {
+    EvaluationHook::active = hook;
+  }
+
+  EvaluationHook* GlobalOptions::getEvaluationHook() {
+    return EvaluationHook::active;
+  }
+
+  void GlobalOptions::writeProfile(const std::string& filename, const std::string& format) {
+    std::ofstream file(filename);
+    casadi_assert(file.good(), "Cannot open '" + filename + "' for writing");
+    Profiler::write(file, format);
+  }
+
 } // namespace casadi
@@ -34,6 +34,9 @@
 
 namespace casadi {
 
+  // Forward declaration
+  class EvaluationHook;
+
   /**
   * \brief Collects global CasADi options
   *
@@ -66,6 +69,8 @@ namespace casadi {
 
       static casadi_int start_index;
 
+      static bool node_pool;
+
 #endif //SWIG
       // Setter and getter for simplification_on_the_fly
       static void setSimplificationOnTheFly(bool flag) { simplification_on_the_fly = flag; }
@@ -81,6 +86,53 @@ namespace casadi {
       static void setMaxNumDir(casadi_int ndir) { max_num_dir=ndir; }
       static casadi_int getMaxNumDir() { return max_num_dir; }
 
+      /** \brief Allocate SX and MX expression nodes from a memory pool
+      * with per-thread free lists instead of the system allocator.
+      * Affects nodes created after the call. Default: false
+      */
+      static void setNodePool(bool flag) { node_pool = flag; }
+      static bool getNodePool() { return node_pool; }
+
+      /// Memory [bytes] of the SX and MX expression nodes currently alive
+      static casadi_int getNodeMemory();
+
+      /// Peak memory [bytes] of the SX and MX expression nodes
+      static casadi_int getNodeMemoryPeak();
+
+      /// Reset the peak memory of the SX and MX expression nodes to the current value
+      static void resetNodeMemoryPeak();
+
+      /** \brief Record a call tree of all numerical Function evaluations, with the
+      * number of calls and the wall and processor times of every function and memory
+      * object, inclusive and exclusive of the nested evaluations. Default: false
+      */
+      static void setProfiling(bool flag);
+      static bool getProfiling();
+
+      /// Discard the recorded call trees
+      static void resetProfile();
+
+      /** \brief Pin the worker threads of parallel maps (parallelization 'thread') to one
+      * core each, keeping their buffers local on multi-socket machines. Linux only.
+      * Default: false
+      */
+      static void setThreadPinning(bool flag);
+      static bool getThreadPinning();
+
+      /** \brief Write the recorded call trees to a file, call when no evaluation is running
+      * Formats: 'chrome' (Chrome trace JSON), 'collapsed' (collapsed stacks for flame graphs,
+      * weighted by exclusive wall time in microseconds), 'text' (indented table)
+      */
+      static void writeProfile(const std::string& filename, const std::string& format="chrome");
+
+#ifndef SWIG
+      /** \brief Install a hook called around every numerical Function evaluation,
+      * nullptr to remove it. The hook is not owned, cf. EvaluationHook, PerfEventHook
+      */
+      static void setEvaluationHook(EvaluationHook* hook);
+      static EvaluationHook* getEvaluationHook();
+#endif // SWIG
+
   };
 
 } // namespace casadi
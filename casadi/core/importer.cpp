@@ -26,9 +26,39 @@
 #include "importer.hpp"
 #include "importer_internal.hpp"
 
+#ifndef _WIN32
+#include <sys/stat.h>
+#endif // _WIN32
+
 using namespace std;
 namespace casadi {
 
+  namespace {
+    // Dynamically linked libraries, weakly referenced
+    std::map<std::string, WeakRef> dll_cache;
+#ifdef CASADI_WITH_THREAD
+    std::mutex dll_cache_mtx;
+#endif // CASADI_WITH_THREAD
+
+    // Identify a library: a path is made canonical and, on POSIX, extended by the inode
+    // and the modification time of the file, so that a rebuilt library is loaded anew.
+    // A bare name, which the loader looks up in the search paths, is used as is.
+    std::string dll_key(const std::string& name) {
+#ifndef _WIN32
+      if (name.find('/')==std::string::npos) return name;
+      char* p = realpath(name.c_str(), nullptr);
+      if (p==nullptr) return std::string();
+      std::string key(p);
+      free(p);
+      struct stat st;
+      if (stat(key.c_str(), &st)!=0) return std::string();
+      return key + ":" + str(st.st_ino) + ":" + str(st.st_mtime) + ":" + str(st.st_size);
+#else // _WIN32
+      return name;
+#endif // _WIN32
+    }
+  } // namespace
+
   Importer::Importer() {
   }
 
@@ -38,6 +68,31 @@ namespace casadi {
     if (compiler=="none") {
       own(new ImporterInternal(name));
     } else if (compiler=="dll") {
+      // Share a library with the Importers of the same file, unloaded with the last one
+      std::string key = opts.empty() ? dll_key(name) : std::string();
+      if (!key.empty()) {
+#ifdef CASADI_WITH_THREAD
+        std::lock_guard<std::mutex> lock(dll_cache_mtx);
+#endif // CASADI_WITH_THREAD
+        auto it = dll_cache.find(key);
+        if (it!=dll_cache.end() && it->second.alive()) {
+          *this = shared_cast<Importer>(it->second.shared());
+          return;
+        }
+        own(new DllLibrary(name));
+        (*this)->construct(opts);
+
+        // Remove dead references, to prevent uncontrolled growth
+        for (auto it=dll_cache.begin(); it!=dll_cache.end();) {
+          if (it->second.alive()) {
+            ++it;
+          } else {
+            dll_cache.erase(it++);
+          }
+        }
+        dll_cache[key] = *this;
+        return;
+      }
       own(new DllLibrary(name));
     } else {
       own(ImporterInternal::getPlugin(compiler).creator(name));
@@ -77,6 +132,10 @@ namespace casadi {
     return (*this)->has_function(symname);
   }
 
+  Dict Importer::stats() const {
+    return (*this)->get_stats();
+  }
+
   signal_t Importer::get_function(const std::string& symname) {
     return (*this)->get_function(symname);
   }
@@ -111,6 +111,9 @@ namespace casadi {
     // Check if symbol exists
     bool has_function(const std::string& symname) const;
 
+    /// Get statistics of the compilation, e.g. timings
+    Dict stats() const;
+
 #ifndef SWIG
     /// Get a function pointer for numerical evaluation
     signal_t get_function(const std::string& symname);
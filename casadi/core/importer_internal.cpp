@@ -246,16 +246,23 @@ namespace casadi {
 
   signal_t DllLibrary::get_function(const std::string& sym) {
 #ifdef WITH_DL
+#ifdef CASADI_WITH_THREAD
+    std::lock_guard<std::mutex> lock(symbols_mtx_);
+#endif // CASADI_WITH_THREAD
+    // Looked up before?
+    auto it = symbols_.find(sym);
+    if (it!=symbols_.end()) return it->second;
 #ifdef _WIN32
-    return (signal_t)GetProcAddress(handle_, TEXT(sym.c_str()));
+    signal_t fcnPtr = (signal_t)GetProcAddress(handle_, TEXT(sym.c_str()));
 #else // _WIN32
     signal_t fcnPtr = (signal_t)dlsym(handle_, sym.c_str());
     if (dlerror()) {
       fcnPtr=nullptr;
       dlerror(); // Reset error flags
     }
-    return fcnPtr;
 #endif // _WIN32
+    symbols_[sym] = fcnPtr;
+    return fcnPtr;
 #endif // WITH_DL
   }
 
@@ -92,6 +92,9 @@ namespace casadi {
     /// Get a function pointer for numerical evaluation
     virtual signal_t get_function(const std::string& symname) { return nullptr;}
 
+    /// Get statistics of the compilation
+    virtual Dict get_stats() const { return Dict();}
+
     /// Get a function pointer for numerical evaluation
     bool has_function(const std::string& symname) const;
 
@@ -153,6 +156,12 @@ namespace casadi {
     typedef void* handle_t;
 #endif
     handle_t handle_;
+
+    // Symbols looked up, including those not found
+    std::map<std::string, signal_t> symbols_;
+#ifdef CASADI_WITH_THREAD
+    std::mutex symbols_mtx_;
+#endif // CASADI_WITH_THREAD
   public:
 
     // Constructor
@@ -289,7 +289,7 @@ namespace casadi {
       x = vertsplit(ifcn_out[0], x0.size1());
 
       // State at end of step
-      xf = D[0]*x0;
+      xf = D[0]*xf;
       for (casadi_int i=1; i<=order; ++i) {
         xf += D[i]*x[i-1];
       }
@@ -299,6 +299,158 @@ namespace casadi {
     return Function("F", {x0, p, h}, {xf}, {"x0", "p", "h"}, {"xf"});
   }
 
+  Function butcherRK(Function f, const std::vector< std::vector<double> >& A,
+                     const std::vector<double>& b, const std::vector<double>& e,
+                     casadi_int N) {
+    // Consistency check
+    casadi_assert(N>=1,
+      "Parameter N (number of steps) must be at least 1, but got " + str(N) + ".");
+    casadi_assert(f.n_in()==2, "Function must have two inputs: x and p");
+    casadi_assert(f.n_out()==1, "Function must have one outputs: dot(x)");
+    casadi_int s = b.size();
+    casadi_assert(s>=1, "Butcher tableau must have at least one stage");
+    casadi_assert(A.size()==s, "Dimension mismatch for A");
+    for (casadi_int j=0; j<s; ++j) {
+      casadi_assert(A[j].size()==s, "Dimension mismatch for A");
+      for (casadi_int jj=j; jj<s; ++jj) {
+        casadi_assert(A[j][jj]==0, "Butcher tableau must be explicit");
+      }
+    }
+    casadi_assert(e.empty() || e.size()==s, "Dimension mismatch for e");
+
+    SX x0 = SX::sym("x0", f.sparsity_in(0));
+    SX p = SX::sym("p", f.sparsity_in(1));
+    SX h = SX::sym("h");
+
+    // Time step
+    SX dt = h/N;
+
+    // Integrate, stages inlined
+    std::vector<SX> k(s);
+    SX xf = x0, err = SX::zeros(x0.sparsity());
+    for (casadi_int i=0; i<N; ++i) {
+      for (casadi_int j=0; j<s; ++j) {
+        SX xL = xf;
+        for (casadi_int jj=0; jj<j; ++jj) {
+          if (A[j][jj]!=0) xL += (A[j][jj]*dt)*k[jj];
+        }
+        k[j] = f(std::vector<SX>{xL, p}).at(0);
+      }
+      SX dx = 0, dxe = 0;
+      for (casadi_int j=0; j<s; ++j) {
+        if (b[j]!=0) dx += b[j]*k[j];
+        if (!e.empty() && e[j]!=0) dxe += e[j]*k[j];
+      }
+      xf += dt*dx;
+      if (!e.empty()) err += dt*dxe;
+    }
+
+    // Form discrete-time dynamics
+    if (e.empty()) return Function("F", {x0, p, h}, {xf}, {"x0", "p", "h"}, {"xf"});
+    return Function("F", {x0, p, h}, {xf, err}, {"x0", "p", "h"}, {"xf", "err"});
+  }
+
+  Function fusedRK(Function f, casadi_int N, const std::string& method) {
+    std::vector< std::vector<double> > A;
+    std::vector<double> b, e;
+    if (method=="euler") {
+      A = {{0}};
+      b = {1};
+    } else if (method=="midpoint") {
+      A = {{0, 0}, {1./2, 0}};
+      b = {0, 1};
+    } else if (method=="heun") {
+      // Embedded Euler
+      A = {{0, 0}, {1, 0}};
+      b = {1./2, 1./2};
+      e = {-1./2, 1./2};
+    } else if (method=="rk4") {
+      A = {{0, 0, 0, 0}, {1./2, 0, 0, 0}, {0, 1./2, 0, 0}, {0, 0, 1, 0}};
+      b = {1./6, 1./3, 1./3, 1./6};
+    } else if (method=="rk23") {
+      // Bogacki-Shampine, first same as last
+      A = {{0, 0, 0, 0}, {1./2, 0, 0, 0}, {0, 3./4, 0, 0}, {2./9, 1./3, 4./9, 0}};
+      b = {2./9, 1./3, 4./9, 0};
+      std::vector<double> b_hat = {7./24, 1./4, 1./3, 1./8};
+      for (casadi_int j=0; j<b.size(); ++j) e.push_back(b[j]-b_hat[j]);
+    } else if (method=="rk45") {
+      // Dormand-Prince, first same as last
+      A = {{0, 0, 0, 0, 0, 0, 0},
+           {1./5, 0, 0, 0, 0, 0, 0},
+           {3./40, 9./40, 0, 0, 0, 0, 0},
+           {44./45, -56./15, 32./9, 0, 0, 0, 0},
+           {19372./6561, -25360./2187, 64448./6561, -212./729, 0, 0, 0},
+           {9017./3168, -355./33, 46732./5247, 49./176, -5103./18656, 0, 0},
+           {35./384, 0, 500./1113, 125./192, -2187./6784, 11./84, 0}};
+      b = {35./384, 0, 500./1113, 125./192, -2187./6784, 11./84, 0};
+      std::vector<double> b_hat = {5179./57600, 0, 7571./16695, 393./640,
+                                   -92097./339200, 187./2100, 1./40};
+      for (casadi_int j=0; j<b.size(); ++j) e.push_back(b[j]-b_hat[j]);
+    } else {
+      casadi_error("Unknown Runge-Kutta method '" + method + "'. Supported: "
+                   "'euler', 'midpoint', 'heun', 'rk4', 'rk23', 'rk45'");
+    }
+    return butcherRK(f, A, b, e, N);
+  }
+
+  Function fusedIRK(Function f, casadi_int N, casadi_int order, const std::string& scheme,
+                    casadi_int newton_iter) {
+    // Consistency check
+    casadi_assert(N>=1,
+      "Parameter N (number of steps) must be at least 1, but got " + str(N) + ".");
+    casadi_assert(newton_iter>=1, "Parameter newton_iter must be at least 1, but got "
+                  + str(newton_iter) + ".");
+    casadi_assert(f.n_in()==2, "Function must have two inputs: x and p");
+    casadi_assert(f.n_out()==1, "Function must have one outputs: dot(x)");
+
+    // Obtain collocation points
+    std::vector<double> tau_root = collocation_points(order, scheme);
+
+    // Retrieve collocation interpolating matrices
+    std::vector < std::vector <double> > C;
+    std::vector < double > D;
+    collocation_interpolators(tau_root, C, D);
+
+    // Inputs of constructed function
+    SX x0 = SX::sym("x0", f.sparsity_in(0));
+    SX p = SX::sym("p", f.sparsity_in(1));
+    SX h = SX::sym("h");
+
+    // Collocation equations of a step and their Jacobian
+    SX v = SX::sym("v", repmat(x0.sparsity(), order));
+    SX xk = SX::sym("xk", x0.sparsity());
+    SX dt = SX::sym("dt");
+    std::vector<SX> x = vertsplit(v, x0.size1());
+    x.insert(x.begin(), xk);
+    std::vector<SX> V_eq;
+    for (casadi_int j=1; j<order+1; ++j) {
+      SX xp_j = 0;
+      for (casadi_int r=0; r<=order; ++r) xp_j += C[j][r]*x[r];
+      V_eq.push_back(dt*f(std::vector<SX>{x[j], p}).at(0) - xp_j);
+    }
+    SX eq = vertcat(V_eq);
+    Function G("G", {v, xk, p, dt}, {eq, SX::jacobian(eq, v)});
+
+    // Integrate, Newton iterations inlined
+    SX xf = x0;
+    for (casadi_int k=0; k<N; ++k) {
+      SX vk = repmat(xf, order);
+      for (casadi_int it=0; it<newton_iter; ++it) {
+        std::vector<SX> G_out = G(std::vector<SX>{vk, xf, p, h/N});
+        vk -= SX::solve(G_out.at(1), G_out.at(0));
+      }
+      x = vertsplit(vk, x0.size1());
+
+      // State at end of step
+      SX xn = D[0]*xf;
+      for (casadi_int i=1; i<=order; ++i) xn += D[i]*x[i-1];
+      xf = xn;
+    }
+
+    // Form discrete-time dynamics
+    return Function("F", {x0, p, h}, {xf}, {"x0", "p", "h"}, {"xf"});
+  }
+
   Function simpleIntegrator(Function f, const std::string& plugin,
                             const Dict& plugin_options) {
     // Consistency check
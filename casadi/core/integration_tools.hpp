@@ -106,6 +106,53 @@ namespace casadi {
                       const std::string& solver="newton",
                       const Dict& solver_options = Dict());
 
+  /** \brief Construct a fused explicit Runge-Kutta integrator from a Butcher tableau
+   * The constructed function is an SX function in which all stages of all steps
+   * are inlined, so that subexpressions are shared across the stages.
+   * It has three inputs, corresponding to initial state (x0), parameter (p) and
+   * integration time (h), and one output, corresponding to final state (xf).
+   * If error weights are given, a second output (err) holds the sum of the local
+   * error estimates of the steps. The signature is compatible with Function::mapaccum.
+   *
+   * \param f ODE function with two inputs (x and p) and one output (xdot),
+   *          which must be possible to evaluate symbolically with SX
+   * \param A Runge-Kutta matrix, strictly lower triangular
+   * \param b Weights
+   * \param e Error weights b-b_hat of an embedded method, or empty
+   * \param N Number of integrator steps
+   */
+  CASADI_EXPORT
+  Function butcherRK(Function f, const std::vector< std::vector<double> >& A,
+                     const std::vector<double>& b,
+                     const std::vector<double>& e=std::vector<double>(), casadi_int N=1);
+
+  /** \brief Construct a fused explicit Runge-Kutta integrator
+   * Same as butcherRK, for a named method: 'euler', 'midpoint', 'heun', 'rk4',
+   * 'rk23' (Bogacki-Shampine) or 'rk45' (Dormand-Prince). 'heun', 'rk23' and 'rk45'
+   * have an embedded error estimate, returned as a second output (err).
+   *
+   * \param f      ODE function with two inputs (x and p) and one output (xdot)
+   * \param N      Number of integrator steps
+   * \param method Runge-Kutta method
+   */
+  CASADI_EXPORT
+  Function fusedRK(Function f, casadi_int N=1, const std::string& method="rk4");
+
+  /** \brief Construct a fused implicit Runge-Kutta integrator using a collocation scheme
+   * Same as simpleIRK, but the collocation equations are solved with a fixed number of
+   * full Newton iterations, inlined in an SX function together with the symbolic
+   * linear solves. Suitable for small state dimensions.
+   *
+   * \param f           ODE function with two inputs (x and p) and one output (xdot)
+   * \param N           Number of integrator steps
+   * \param order       Order of interpolating polynomials
+   * \param scheme      Collocation scheme, as excepted by collocationPoints function.
+   * \param newton_iter Number of Newton iterations per step
+   */
+  CASADI_EXPORT
+  Function fusedIRK(Function f, casadi_int N=1, casadi_int order=4,
+                    const std::string& scheme="radau", casadi_int newton_iter=3);
+
   /** \brief Simplified wrapper for the Integrator class
    * Constructs an integrator using the same syntax as simpleRK and simpleIRK.
    * The constructed function has three inputs,
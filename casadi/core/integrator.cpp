@@ -60,6 +60,83 @@ namespace casadi {
     return Function::create(Integrator::getPlugin(solver).creator(name, dae), opts);
   }
 
+  /// Stack the DAE of n independent trajectories, the time is shared
+  template<typename XType>
+  Function batch_dae(const Function& dae, casadi_int n) {
+    Function dae_n = dae.map(n, "serial");
+    vector<XType> arg(DE_NUM_IN), arg_n(DE_NUM_IN);
+    for (casadi_int i=0; i<DE_NUM_IN; ++i) {
+      const Sparsity& sp = dae.sparsity_in(i);
+      if (i==DE_T) {
+        arg[i] = XType::sym(dae.name_in(i), sp);
+        arg_n[i] = repmat(arg[i], 1, n);
+      } else {
+        arg[i] = XType::sym(dae.name_in(i), sp.numel()*n);
+        arg_n[i] = reshape(arg[i], sp.size1(), sp.size2()*n);
+      }
+    }
+    vector<XType> res = dae_n(arg_n);
+    std::map<string, XType> d;
+    for (casadi_int i=0; i<DE_NUM_IN; ++i) d[dae.name_in(i)] = arg[i];
+    for (casadi_int i=0; i<DE_NUM_OUT; ++i) d[dae.name_out(i)] = vec(res[i]);
+    return Integrator::map2oracle(dae.name() + "_batch", d);
+  }
+
+  Function integrator_batch(const string& name, const string& solver,
+                            const SXDict& dae, casadi_int n, const Dict& opts) {
+    return integrator_batch(name, solver, Integrator::map2oracle("dae", dae), n, opts);
+  }
+
+  Function integrator_batch(const string& name, const string& solver,
+                            const MXDict& dae, casadi_int n, const Dict& opts) {
+    return integrator_batch(name, solver, Integrator::map2oracle("dae", dae), n, opts);
+  }
+
+  Function integrator_batch(const string& name, const string& solver,
+                            const Function& dae, casadi_int n, const Dict& opts) {
+    casadi_assert(n>=1, "integrator_batch: n must be positive");
+
+    // Integrator for the stacked trajectories
+    Function dae_n = dae.is_a("SXFunction") ? batch_dae<SX>(dae, n) : batch_dae<MX>(dae, n);
+    Function F = integrator(name + "_batch", solver, dae_n, opts);
+
+    // Per trajectory sparsity of the inputs and outputs
+    vector<Sparsity> sp_in(INTEGRATOR_NUM_IN), sp_out(INTEGRATOR_NUM_OUT);
+    sp_in[INTEGRATOR_X0] = dae.sparsity_in(DE_X);
+    sp_in[INTEGRATOR_P] = dae.sparsity_in(DE_P);
+    sp_in[INTEGRATOR_Z0] = dae.sparsity_in(DE_Z);
+    sp_in[INTEGRATOR_RX0] = dae.sparsity_in(DE_RX);
+    sp_in[INTEGRATOR_RP] = dae.sparsity_in(DE_RP);
+    sp_in[INTEGRATOR_RZ0] = dae.sparsity_in(DE_RZ);
+    sp_out[INTEGRATOR_XF] = dae.sparsity_in(DE_X);
+    sp_out[INTEGRATOR_QF] = dae.sparsity_out(DE_QUAD);
+    sp_out[INTEGRATOR_ZF] = dae.sparsity_in(DE_Z);
+    sp_out[INTEGRATOR_RXF] = dae.sparsity_in(DE_RX);
+    sp_out[INTEGRATOR_RQF] = dae.sparsity_out(DE_RQUAD);
+    sp_out[INTEGRATOR_RZF] = dae.sparsity_in(DE_RZ);
+
+    // Trajectory k in the columns k*size2..(k+1)*size2-1 of the inputs
+    vector<MX> arg(INTEGRATOR_NUM_IN), F_arg(INTEGRATOR_NUM_IN);
+    for (casadi_int i=0; i<INTEGRATOR_NUM_IN; ++i) {
+      arg[i] = MX::sym(integrator_in(i), sp_in[i].size1(), sp_in[i].size2()*n);
+      F_arg[i] = reshape(arg[i], F.size1_in(i), F.size2_in(i));
+    }
+
+    // Same layout for the outputs, all output times of a trajectory next to each other
+    vector<MX> res = F(F_arg);
+    for (casadi_int i=0; i<INTEGRATOR_NUM_OUT; ++i) {
+      casadi_int m = res[i].size1()/n, nc = res[i].size2()*sp_out[i].size2();
+      if (m==0) {
+        res[i] = MX(sp_out[i].size1(), nc*n);
+        continue;
+      }
+      vector<MX> r = vertsplit(res[i], m);
+      for (auto&& e : r) e = reshape(e, sp_out[i].size1(), nc);
+      res[i] = horzcat(r);
+    }
+    return Function(name, arg, res, integrator_in(), integrator_out());
+  }
+
   vector<string> integrator_in() {
     vector<string> ret(integrator_n_in());
     for (size_t i=0; i<ret.size(); ++i) ret[i]=integrator_in(i);
@@ -154,6 +231,7 @@ namespace casadi {
     // Reset statistics
     for (auto&& s : m->fstats) s.second.reset();
     m->fstats.at(name_).tic();
+    m->nevents = 0;
 
     // Read inputs
     const double* x0 = arg[INTEGRATOR_X0];
@@ -175,29 +253,40 @@ namespace casadi {
 
     // Setup memory object
     setup(m, arg, res, iw, w);
+    m->trace.start();
+    m->deadline.start(max_wall_time_, &cancel_epoch_);
+
+    try {
+      // Reset solver, take time to t0
+      reset(m, grid_.front(), x0, z0, p);
+
+      // Integrate forward, unless an earlier forward pass can be reused
+      if (!restore(m, x0, z0, p, x, z, q)) {
+        double *xk = x, *zk = z, *qk = q;
+        for (casadi_int k=0; k<grid_.size(); ++k) {
+          // Skip t0?
+          if (k==0 && !output_t0_) continue;
+
+          // Integrate forward
+          advance(m, grid_[k], xk, zk, qk);
+          if (xk) xk += nx_;
+          if (zk) zk += nz_;
+          if (qk) qk += nq_;
+        }
+        store(m, x0, z0, p, x, z, q);
+      }
 
-    // Reset solver, take time to t0
-    reset(m, grid_.front(), x0, z0, p);
-
-    // Integrate forward
-    for (casadi_int k=0; k<grid_.size(); ++k) {
-      // Skip t0?
-      if (k==0 && !output_t0_) continue;
-
-      // Integrate forward
-      advance(m, grid_[k], x, z, q);
-      if (x) x += nx_;
-      if (z) z += nz_;
-      if (q) q += nq_;
-    }
-
-    // If backwards integration is needed
-    if (nrx_>0) {
-      // Integrate backward
-      resetB(m, grid_.back(), rx0, rz0, rp);
+      // If backwards integration is needed
+      if (nrx_>0) {
+        // Integrate backward
+        resetB(m, grid_.back(), rx0, rz0, rp);
 
-      // Proceed to t0
-      retreat(m, grid_.front(), rx, rz, rq);
+        // Proceed to t0
+        retreat(m, grid_.front(), rx, rz, rq);
+      }
+    } catch (...) {
+      m->trace.dump_on_fail();
+      throw;
     }
 
     // Finalize/print statistics
@@ -212,6 +301,14 @@ namespace casadi {
      {{"expand",
        {OT_BOOL,
         "Replace MX with SX expressions in problem formulation [false]"}},
+      {"expand_auto",
+       {OT_BOOL,
+        "Replace MX with SX expressions in problem formulation if the number of SX "
+        "instructions, estimated without expanding, does not exceed expand_max_instructions. "
+        "The estimates and the decision are reported in the statistics [false]"}},
+      {"expand_max_instructions",
+       {OT_INT,
+        "Largest estimated number of SX instructions for expand_auto [1e6]"}},
       {"print_stats",
        {OT_BOOL,
         "Print out statistics after integration"}},
@@ -229,19 +326,44 @@ namespace casadi {
         "Options to be passed down to the augmented integrator, if one is constructed."}},
       {"output_t0",
        {OT_BOOL,
-        "Output the state at the initial time"}}
+        "Output the state at the initial time"}},
+      {"sens_parallelization",
+       {OT_STRING,
+        "Evaluate the forward sensitivity equations of all directions with a single "
+        "mapped directional derivative: serial|openmp|thread [default: inlined]"}},
+      {"event",
+       {OT_FUNCTION,
+        "Event functions (t, x, z, p) -> e. An event occurs when an entry of e "
+        "changes sign"}},
+      {"event_transition",
+       {OT_FUNCTION,
+        "State reset at an event (t, x, z, p, i) -> x, with i the index of the event "
+        "function [default: no reset]"}},
+      {"event_direction",
+       {OT_INTVECTOR,
+        "Direction of the zero crossings that trigger each event: 1 for increasing, "
+        "-1 for decreasing, 0 for both [default: 0]"}},
+      {"max_events",
+       {OT_INT,
+        "Maximum number of events per integration [1000]"}}
      }
   };
 
   void Integrator::init(const Dict& opts) {
     // Default (temporary) options
     double t0=0, tf=1;
-    bool expand = false;
+    bool expand = false, expand_auto = false;
+    casadi_int expand_max_instructions = 1000000;
+    max_events_ = 1000;
 
     // Read options
     for (auto&& op : opts) {
       if (op.first=="expand") {
         expand = op.second;
+      } else if (op.first=="expand_auto") {
+        expand_auto = op.second;
+      } else if (op.first=="expand_max_instructions") {
+        expand_max_instructions = op.second;
       } else if (op.first=="output_t0") {
         output_t0_ = op.second;
       } else if (op.first=="print_stats") {
@@ -250,6 +372,16 @@ namespace casadi {
         grid_ = op.second;
       } else if (op.first=="augmented_options") {
         augmented_options_ = op.second;
+      } else if (op.first=="sens_parallelization") {
+        sens_parallelization_ = op.second.to_string();
+      } else if (op.first=="event") {
+        event_ = op.second;
+      } else if (op.first=="event_transition") {
+        event_transition_ = op.second;
+      } else if (op.first=="event_direction") {
+        event_direction_ = op.second;
+      } else if (op.first=="max_events") {
+        max_events_ = op.second;
       } else if (op.first=="t0") {
         t0 = op.second;
       } else if (op.first=="tf") {
@@ -258,7 +390,11 @@ namespace casadi {
     }
 
     // Replace MX oracle with SX oracle?
-    if (expand) this->expand();
+    if (expand) {
+      this->expand();
+    } else if (expand_auto) {
+      this->expand_auto(expand_max_instructions);
+    }
 
     // Store a copy of the options, for creating augmented integrators
     opts_ = opts;
@@ -322,6 +458,31 @@ namespace casadi {
                             + str(nrx_+nrz_));
     }
 
+    // Event functions
+    ne_ = 0;
+    if (!event_.is_null()) {
+      casadi_assert(nrx_==0, "Events are not supported for backward problems");
+      casadi_assert(event_.n_in()==4 && event_.n_out()==1,
+        "Event function must have the signature (t, x, z, p) -> e");
+      casadi_assert(event_.nnz_in(0)==1 && event_.nnz_in(1)==nx_ && event_.nnz_in(2)==nz_
+                    && event_.nnz_in(3)==np_, "Dimension mismatch for the event function");
+      casadi_assert(event_.sparsity_out(0).is_dense(), "Event functions must be dense");
+      ne_ = event_.nnz_out(0);
+      if (event_direction_.empty()) event_direction_.resize(ne_, 0);
+      casadi_assert(event_direction_.size()==ne_,
+        "Option 'event_direction' has wrong length, expected " + str(ne_));
+      set_function(event_, "event");
+      if (!event_transition_.is_null()) {
+        casadi_assert(event_transition_.n_in()==5 && event_transition_.n_out()==1,
+          "Event transition must have the signature (t, x, z, p, i) -> x");
+        casadi_assert(event_transition_.nnz_in(1)==nx_ && event_transition_.nnz_out(0)==nx_,
+          "Dimension mismatch for the event transition");
+        set_function(event_transition_, "event_transition");
+      }
+    } else {
+      casadi_assert(event_transition_.is_null(), "Event transition requires event functions");
+    }
+
     // Consistency check
 
     // Allocate sufficiently large work vectors
@@ -335,9 +496,48 @@ namespace casadi {
 
     auto m = static_cast<IntegratorMemory*>(mem);
     m->add_stat(name_);
+    m->nevents = 0;
+    m->e.resize(ne_);
+    if (!event_transition_.is_null()) m->xe.resize(nx_);
     return 0;
   }
 
+  Dict Integrator::get_stats(void* mem) const {
+    Dict stats = OracleFunction::get_stats(mem);
+    auto m = static_cast<IntegratorMemory*>(mem);
+    if (ne_>0) stats["nevents"] = m->nevents;
+    return stats;
+  }
+
+  void Integrator::calc_event(IntegratorMemory* m, double t, const double* x, const double* z,
+                              const double* p, double* e) const {
+    m->arg[0] = &t;
+    m->arg[1] = x;
+    m->arg[2] = z;
+    m->arg[3] = p;
+    m->res[0] = e;
+    if (calc_function(m, "event")) casadi_error("Integrator::calc_event: 'event' failed");
+  }
+
+  void Integrator::apply_event(IntegratorMemory* m, double t, casadi_int i, double* x,
+                               const double* z, const double* p) const {
+    casadi_assert(m->nevents<max_events_,
+      "Maximum number of events (" + str(max_events_) + ") reached at t=" + str(t));
+    m->nevents++;
+    if (event_transition_.is_null()) return;
+    casadi_copy(x, nx_, get_ptr(m->xe));
+    double ind = static_cast<double>(i);
+    m->arg[0] = &t;
+    m->arg[1] = get_ptr(m->xe);
+    m->arg[2] = z;
+    m->arg[3] = p;
+    m->arg[4] = &ind;
+    m->res[0] = x;
+    if (calc_function(m, "event_transition")) {
+      casadi_error("Integrator::apply_event: 'event_transition' failed");
+    }
+  }
+
   template<typename MatType>
   std::map<string, MatType> Integrator::aug_fwd(casadi_int nfwd) const {
     if (verbose_) casadi_message(name_ + "::aug_fwd");
@@ -381,7 +581,32 @@ namespace casadi {
 
     // Calculate directional derivatives
     vector<vector<MatType>> sens;
-    oracle_->call_forward(arg, res, seed, sens, true, false);
+    if (sens_parallelization_.empty()) {
+      oracle_->call_forward(arg, res, seed, sens, true, false);
+    } else {
+      // All directions with one call to the mapped directional derivative
+      Function fwd = oracle_.forward(1).map(nfwd, sens_parallelization_);
+      vector<MatType> fwd_arg;
+      for (auto&& e : arg) fwd_arg.push_back(repmat(e, 1, nfwd));
+      for (auto&& e : res) fwd_arg.push_back(repmat(e, 1, nfwd));
+      for (casadi_int i=0; i<DE_NUM_IN; ++i) {
+        vector<MatType> v(nfwd);
+        for (casadi_int d=0; d<nfwd; ++d) v[d] = seed[d][i];
+        fwd_arg.push_back(horzcat(v));
+      }
+      vector<MatType> fwd_res = fwd(fwd_arg);
+      sens.resize(nfwd, vector<MatType>(DE_NUM_OUT));
+      for (casadi_int i=0; i<DE_NUM_OUT; ++i) {
+        const Sparsity& sp = oracle_.sparsity_out(i);
+        vector<MatType> v;
+        if (sp.numel()==0) {
+          v.resize(nfwd, MatType(sp.size()));
+        } else {
+          v = horzsplit(fwd_res[i], sp.size2());
+        }
+        for (casadi_int d=0; d<nfwd; ++d) sens[d][i] = v[d];
+      }
+    }
 
     // Collect sensitivity equations
     casadi_assert_dev(sens.size()==nfwd);
@@ -507,6 +732,18 @@ namespace casadi {
   sp_forward(const bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w, void* mem) const {
     if (verbose_) casadi_message(name_ + "::sp_forward");
 
+    // With events, conservatively assume that all outputs depend on all inputs
+    if (ne_>0) {
+      bvec_t all = 0;
+      for (casadi_int i=0; i<n_in_; ++i) {
+        if (arg[i]) for (casadi_int k=0; k<nnz_in(i); ++k) all |= arg[i][k];
+      }
+      for (casadi_int i=0; i<n_out_; ++i) {
+        if (res[i]) fill_n(res[i], nnz_out(i), all);
+      }
+      return 0;
+    }
+
     // Work vectors
     bvec_t *tmp_x = w; w += nx_;
     bvec_t *tmp_z = w; w += nz_;
@@ -546,6 +783,13 @@ namespace casadi {
       if (oracle_(arg1, res1, iw, w, 0)) return 1;
     }
 
+    // Same dependencies at all output times
+    for (casadi_int k=1; k<ntout_; ++k) {
+      if (res[INTEGRATOR_XF]) copy_n(res[INTEGRATOR_XF], nx_, res[INTEGRATOR_XF] + k*nx_);
+      if (res[INTEGRATOR_ZF]) copy_n(res[INTEGRATOR_ZF], nz_, res[INTEGRATOR_ZF] + k*nz_);
+      if (res[INTEGRATOR_QF]) copy_n(res[INTEGRATOR_QF], nq_, res[INTEGRATOR_QF] + k*nq_);
+    }
+
     if (nrx_>0) {
       // Propagate through g
       fill_n(arg1, static_cast<size_t>(DE_NUM_IN), nullptr);
@@ -589,6 +833,21 @@ namespace casadi {
       casadi_int* iw, bvec_t* w, void* mem) const {
     if (verbose_) casadi_message(name_ + "::sp_reverse");
 
+    // With events, conservatively assume that all outputs depend on all inputs
+    if (ne_>0) {
+      bvec_t all = 0;
+      for (casadi_int i=0; i<n_out_; ++i) {
+        if (res[i]) {
+          for (casadi_int k=0; k<nnz_out(i); ++k) all |= res[i][k];
+          fill_n(res[i], nnz_out(i), 0);
+        }
+      }
+      for (casadi_int i=0; i<n_in_; ++i) {
+        if (arg[i]) for (casadi_int k=0; k<nnz_in(i); ++k) arg[i][k] |= all;
+      }
+      return 0;
+    }
+
     // Work vectors
     bvec_t** arg1 = arg+n_in_;
     bvec_t** res1 = res+n_out_;
@@ -602,6 +861,22 @@ namespace casadi {
     bvec_t* zf = res[INTEGRATOR_ZF];
     bvec_t* qf = res[INTEGRATOR_QF];
 
+    // Collect the dependencies of all output times in the first one
+    for (casadi_int k=1; k<ntout_; ++k) {
+      if (xf) {
+        for (casadi_int i=0; i<nx_; ++i) xf[i] |= xf[i + k*nx_];
+        fill_n(xf + k*nx_, nx_, 0);
+      }
+      if (zf) {
+        for (casadi_int i=0; i<nz_; ++i) zf[i] |= zf[i + k*nz_];
+        fill_n(zf + k*nz_, nz_, 0);
+      }
+      if (qf) {
+        for (casadi_int i=0; i<nq_; ++i) qf[i] |= qf[i + k*nq_];
+        fill_n(qf + k*nq_, nq_, 0);
+      }
+    }
+
     // Propagate from outputs to state vectors
     if (xf) {
       copy_n(xf, nx_, tmp_x);
@@ -706,19 +981,21 @@ namespace casadi {
               const std::vector<std::string>& onames,
               const Dict& opts) const {
     if (verbose_) casadi_message(name_ + "::get_forward");
+    casadi_assert(ne_==0, "Sensitivities of integrators with events are not supported");
 
     // Integrator options
     Dict aug_opts = getDerivativeOptions(true);
     for (auto&& i : augmented_options_) {
       aug_opts[i.first] = i.second;
     }
+    aug_opts.erase("trajectory_cache");
 
     // Create integrator for augmented DAE
     Function aug_dae;
     string aug_prefix = "fsens" + str(nfwd) + "_";
     string dae_name = aug_prefix + oracle_.name();
     Dict dae_opts = {{"derivative_of", oracle_}};
-    if (oracle_.is_a("SXFunction")) {
+    if (oracle_.is_a("SXFunction") && sens_parallelization_.empty()) {
       aug_dae = map2oracle(dae_name, aug_fwd<SX>(nfwd));
     } else {
       aug_dae = map2oracle(dae_name, aug_fwd<MX>(nfwd));
@@ -745,17 +1022,20 @@ namespace casadi {
       x0_aug.push_back(vec(din[INTEGRATOR_X0] = MX::sym("x0" + suff, x())));
       p_aug.push_back(vec(din[INTEGRATOR_P] = MX::sym("p" + suff, p())));
       z0_aug.push_back(vec(din[INTEGRATOR_Z0] = MX::sym("z0" + suff, z())));
-      rx0_aug.push_back(vec(din[INTEGRATOR_RX0] = MX::sym("rx0" + suff, rx())));
-      rp_aug.push_back(vec(din[INTEGRATOR_RP] = MX::sym("rp" + suff, rp())));
-      rz0_aug.push_back(vec(din[INTEGRATOR_RZ0] = MX::sym("rz0" + suff, rz())));
+      din[INTEGRATOR_RX0] = MX::sym("rx0" + suff, sparsity_in(INTEGRATOR_RX0));
+      din[INTEGRATOR_RP] = MX::sym("rp" + suff, sparsity_in(INTEGRATOR_RP));
+      din[INTEGRATOR_RZ0] = MX::sym("rz0" + suff, sparsity_in(INTEGRATOR_RZ0));
+      rx0_aug.push_back(reshape(din[INTEGRATOR_RX0], rx().numel(), ntout_));
+      rp_aug.push_back(reshape(din[INTEGRATOR_RP], rp().numel(), ntout_));
+      rz0_aug.push_back(reshape(din[INTEGRATOR_RZ0], rz().numel(), ntout_));
       ret_in.insert(ret_in.end(), din.begin(), din.end());
 
       // Dummy outputs
       if (dir==-1) {
         vector<MX> dout(INTEGRATOR_NUM_OUT);
         dout[INTEGRATOR_XF]  = MX::sym("xf_dummy", Sparsity(size_out(INTEGRATOR_XF)));
-        dout[INTEGRATOR_QF]  = MX::sym("qf_dummy", Sparsity(q().size()));
-        dout[INTEGRATOR_ZF]  = MX::sym("zf_dummy", Sparsity(z().size()));
+        dout[INTEGRATOR_QF]  = MX::sym("qf_dummy", Sparsity(size_out(INTEGRATOR_QF)));
+        dout[INTEGRATOR_ZF]  = MX::sym("zf_dummy", Sparsity(size_out(INTEGRATOR_ZF)));
         dout[INTEGRATOR_RXF]  = MX::sym("rxf_dummy", Sparsity(rx().size()));
         dout[INTEGRATOR_RQF]  = MX::sym("rqf_dummy", Sparsity(rq().size()));
         dout[INTEGRATOR_RZF]  = MX::sym("rzf_dummy", Sparsity(rz().size()));
@@ -768,23 +1048,32 @@ namespace casadi {
     integrator_in[INTEGRATOR_X0] = horzcat(x0_aug);
     integrator_in[INTEGRATOR_P] = horzcat(p_aug);
     integrator_in[INTEGRATOR_Z0] = horzcat(z0_aug);
-    integrator_in[INTEGRATOR_RX0] = horzcat(rx0_aug);
-    integrator_in[INTEGRATOR_RP] = horzcat(rp_aug);
-    integrator_in[INTEGRATOR_RZ0] = horzcat(rz0_aug);
-    vector<MX> integrator_out = aug_int(integrator_in);
-    for (auto&& e : integrator_out) {
-      // Workaround
-      if (e.size2()!=1+nfwd) e = reshape(e, -1, 1+nfwd);
+    // Backward inputs have one block of 1+nfwd columns per output time
+    vector<casadi_int> perm;
+    for (casadi_int k=0; k<ntout_; ++k) {
+      for (casadi_int d=0; d<1+nfwd; ++d) perm.push_back(k + d*ntout_);
     }
+    integrator_in[INTEGRATOR_RX0] = horzcat(rx0_aug)(Slice(), perm);
+    integrator_in[INTEGRATOR_RP] = horzcat(rp_aug)(Slice(), perm);
+    integrator_in[INTEGRATOR_RZ0] = horzcat(rz0_aug)(Slice(), perm);
+    vector<MX> integrator_out = aug_int(integrator_in);
 
-    // Augmented results
-    vector<casadi_int> offset = range(1+nfwd+1);
-    vector<MX> xf_aug = horzsplit(integrator_out[INTEGRATOR_XF], offset);
-    vector<MX> qf_aug = horzsplit(integrator_out[INTEGRATOR_QF], offset);
-    vector<MX> zf_aug = horzsplit(integrator_out[INTEGRATOR_ZF], offset);
-    vector<MX> rxf_aug = horzsplit(integrator_out[INTEGRATOR_RXF], offset);
-    vector<MX> rqf_aug = horzsplit(integrator_out[INTEGRATOR_RQF], offset);
-    vector<MX> rzf_aug = horzsplit(integrator_out[INTEGRATOR_RZF], offset);
+    // Augmented results, the forward outputs have one block of 1+nfwd columns per output time
+    vector<vector<MX>> out_aug(INTEGRATOR_NUM_OUT, vector<MX>(1+nfwd));
+    for (casadi_int i=0; i<INTEGRATOR_NUM_OUT; ++i) {
+      bool fwd_out = i==INTEGRATOR_XF || i==INTEGRATOR_QF || i==INTEGRATOR_ZF;
+      casadi_int nt = fwd_out ? ntout_ : 1;
+      MX e = reshape(integrator_out[i], -1, (1+nfwd)*nt);
+      for (casadi_int d=0; d<1+nfwd; ++d) {
+        out_aug[i][d] = e(Slice(), Slice(d, (1+nfwd)*nt, 1+nfwd));
+      }
+    }
+    const vector<MX>& xf_aug = out_aug[INTEGRATOR_XF];
+    const vector<MX>& qf_aug = out_aug[INTEGRATOR_QF];
+    const vector<MX>& zf_aug = out_aug[INTEGRATOR_ZF];
+    const vector<MX>& rxf_aug = out_aug[INTEGRATOR_RXF];
+    const vector<MX>& rqf_aug = out_aug[INTEGRATOR_RQF];
+    const vector<MX>& rzf_aug = out_aug[INTEGRATOR_RZF];
 
     // All outputs of the return function
     vector<MX> ret_out;
@@ -793,9 +1082,9 @@ namespace casadi {
     // Collect the forward sensitivities
     vector<MX> dd(INTEGRATOR_NUM_IN);
     for (casadi_int dir=0; dir<nfwd; ++dir) {
-      dd[INTEGRATOR_XF]  = reshape(xf_aug.at(dir+1), x().size());
-      dd[INTEGRATOR_QF]  = reshape(qf_aug.at(dir+1), q().size());
-      dd[INTEGRATOR_ZF]  = reshape(zf_aug.at(dir+1), z().size());
+      dd[INTEGRATOR_XF]  = reshape(xf_aug.at(dir+1), size_out(INTEGRATOR_XF));
+      dd[INTEGRATOR_QF]  = reshape(qf_aug.at(dir+1), size_out(INTEGRATOR_QF));
+      dd[INTEGRATOR_ZF]  = reshape(zf_aug.at(dir+1), size_out(INTEGRATOR_ZF));
       dd[INTEGRATOR_RXF] = reshape(rxf_aug.at(dir+1), rx().size());
       dd[INTEGRATOR_RQF] = reshape(rqf_aug.at(dir+1), rq().size());
       dd[INTEGRATOR_RZF] = reshape(rzf_aug.at(dir+1), rz().size());
@@ -829,12 +1118,14 @@ namespace casadi {
               const std::vector<std::string>& onames,
               const Dict& opts) const {
     if (verbose_) casadi_message(name_ + "::get_reverse");
+    casadi_assert(ne_==0, "Sensitivities of integrators with events are not supported");
 
     // Integrator options
     Dict aug_opts = getDerivativeOptions(false);
     for (auto&& i : augmented_options_) {
       aug_opts[i.first] = i.second;
     }
+    aug_opts.erase("trajectory_cache");
 
     // Create integrator for augmented DAE
     Function aug_dae;
@@ -1025,6 +1316,7 @@ namespace casadi {
 
     // Default options
     nk_ = 20;
+    trajectory_cache_ = 0;
   }
 
   FixedStepIntegrator::~FixedStepIntegrator() {
@@ -1035,7 +1327,13 @@ namespace casadi {
   = {{&Integrator::options_},
      {{"number_of_finite_elements",
        {OT_INT,
-        "Number of finite elements"}}
+        "Number of finite elements"}},
+      {"trajectory_cache",
+       {OT_INT,
+        "Number of forward passes kept for reuse by the reverse derivative, e.g. the "
+        "number of shooting intervals. The reverse derivative skips its forward "
+        "integration when called with inputs of a kept forward pass. Only for problems "
+        "without backward states or events [default: 0]"}}
      }
   };
 
@@ -1047,6 +1345,8 @@ namespace casadi {
     for (auto&& op : opts) {
       if (op.first=="number_of_finite_elements") {
         nk_ = op.second;
+      } else if (op.first=="trajectory_cache") {
+        trajectory_cache_ = op.second;
       }
     }
 
@@ -1060,6 +1360,11 @@ namespace casadi {
     // Get discrete time dimensions
     nZ_ = F_.nnz_in(DAE_Z);
     nRZ_ =  G_.is_null() ? 0 : G_.nnz_in(RDAE_RZ);
+
+    // Keeping forward passes requires the tape
+    casadi_assert(trajectory_cache_>=0, "Option \"trajectory_cache\" must be nonnegative");
+    if (nrx_>0 || ne_>0) trajectory_cache_ = 0;
+    tape_ = nrx_>0 || trajectory_cache_>0;
   }
 
   int FixedStepIntegrator::init_mem(void* mem) const {
@@ -1070,8 +1375,8 @@ namespace casadi {
     m->Z.resize(F_.nnz_in(DAE_Z));
     if (!G_.is_null()) m->RZ.resize(G_.nnz_in(RDAE_RZ));
 
-    // Allocate tape if backward states are present
-    if (nrx_>0) {
+    // Allocate tape if backward states are present or forward passes are kept
+    if (tape_) {
       m->x_tape.resize(nk_+1, vector<double>(nx_));
       m->Z_tape.resize(nk_, vector<double>(nZ_));
     }
@@ -1091,6 +1396,23 @@ namespace casadi {
     m->rx_prev.resize(nrx_);
     m->RZ_prev.resize(nRZ_);
     m->rq_prev.resize(nrq_);
+
+    // Event handling
+    if (ne_>0) {
+      m->e_prev.resize(ne_);
+      m->e_lo.resize(ne_);
+      m->e_hi.resize(ne_);
+      m->x_event.resize(nx_);
+      m->z_event.resize(nz_);
+      m->q_event.resize(nq_);
+    }
+
+    // No forward pass reused yet
+    m->reused = false;
+
+    // No rootfinder memory
+    m->mem_F = m->mem_G = -1;
+    m->niter = m->nfact = m->niterB = m->nfactB = 0;
     return 0;
   }
 
@@ -1098,55 +1420,175 @@ namespace casadi {
                                     double* x, double* z, double* q) const {
     auto m = static_cast<FixedStepMemory*>(mem);
 
-    // Get discrete time sought
-    casadi_int k_out = static_cast<casadi_int>(std::ceil((t - grid_.front())/h_));
-    k_out = std::min(k_out, nk_); //  make sure that rounding errors does not result in k_out>nk_
-    casadi_assert_dev(k_out>=0);
-
     // Explicit discrete time dynamics
     const Function& F = getExplicit();
 
-    // Discrete dynamics function inputs ...
-    fill_n(m->arg, F.n_in(), nullptr);
-    m->arg[DAE_T] = &m->t;
-    m->arg[DAE_X] = get_ptr(m->x_prev);
-    m->arg[DAE_Z] = get_ptr(m->Z_prev);
-    m->arg[DAE_P] = get_ptr(m->p);
+    // Take time steps until end time has been reached
+    while (true) {
+      // Event located in the last step, unless it is after t
+      if (m->event_pending) {
+        if (m->t_event>t) break;
+        apply_located_event(m);
+      }
 
-    // ... and outputs
-    fill_n(m->res, F.n_out(), nullptr);
-    m->res[DAE_ODE] = get_ptr(m->x);
-    m->res[DAE_ALG] = get_ptr(m->Z);
-    m->res[DAE_QUAD] = get_ptr(m->q);
+      // Get discrete time sought
+      casadi_int k_out;
+      if (m->nevents==0) {
+        k_out = static_cast<casadi_int>(std::ceil((t - grid_.front())/h_));
+        k_out = std::min(k_out, nk_); //  make sure that rounding errors does not result in k_out>nk_
+      } else {
+        // Steps are shifted with respect to the grid after an event
+        k_out = static_cast<casadi_int>(std::ceil((t - m->t_start)/h_ - 1e-9));
+      }
+      casadi_assert_dev(k_out>=0);
+      if (m->k>=k_out) break;
+      check_deadline(m);
+
+      // Discrete dynamics function inputs ...
+      fill_n(m->arg, F.n_in(), nullptr);
+      m->arg[DAE_T] = &m->t;
+      m->arg[DAE_X] = get_ptr(m->x_prev);
+      m->arg[DAE_Z] = get_ptr(m->Z_prev);
+      m->arg[DAE_P] = get_ptr(m->p);
+
+      // ... and outputs
+      fill_n(m->res, F.n_out(), nullptr);
+      m->res[DAE_ODE] = get_ptr(m->x);
+      m->res[DAE_ALG] = get_ptr(m->Z);
+      m->res[DAE_QUAD] = get_ptr(m->q);
 
-    // Take time steps until end time has been reached
-    while (m->k<k_out) {
       // Update the previous step
       casadi_copy(get_ptr(m->x), nx_, get_ptr(m->x_prev));
       casadi_copy(get_ptr(m->Z), nZ_, get_ptr(m->Z_prev));
       casadi_copy(get_ptr(m->q), nq_, get_ptr(m->q_prev));
 
       // Take step
-      F(m->arg, m->res, m->iw, m->w);
+      stepF(m);
       casadi_axpy(nq_, 1., get_ptr(m->q_prev), get_ptr(m->q));
 
       // Tape
-      if (nrx_>0) {
+      if (tape_) {
         casadi_copy(get_ptr(m->x), nx_, get_ptr(m->x_tape.at(m->k+1)));
         casadi_copy(get_ptr(m->Z), m->Z.size(), get_ptr(m->Z_tape.at(m->k)));
       }
 
       // Advance time
       m->k++;
-      m->t = static_cast<double>(grid_.front()) + static_cast<double>(m->k)*h_;
+      m->t = static_cast<double>(m->t_start) + static_cast<double>(m->k)*h_;
+
+      // Look for events
+      if (ne_>0) locate_event(m);
     }
 
-    // Return to user TODO(@jaeandersson): interpolate
+    // Return to user, interpolating if t is inside the last step
+    double theta = m->k==0 ? 1 : (t - m->t)/h_ + 1;
+    if (theta < 1-1e-9) {
+      interpolate(m, std::max(theta, 0.), x, z, q);
+    } else {
+      casadi_copy(get_ptr(m->x), nx_, x);
+      casadi_copy(get_ptr(m->Z)+m->Z.size()-nz_, nz_, z);
+      casadi_copy(get_ptr(m->q), nq_, q);
+    }
+  }
+
+  // Does an event function change sign between the values a and b?
+  inline bool event_crossing(casadi_int dir, double a, double b) {
+    return (dir<=0 && a>0 && b<=0) || (dir>=0 && a<0 && b>=0);
+  }
+
+  void FixedStepIntegrator::locate_event(FixedStepMemory* m) const {
+    // Event functions at the end of the step
+    const double* zf = get_ptr(m->Z) + m->Z.size() - nz_;
+    calc_event(m, m->t, get_ptr(m->x), zf, get_ptr(m->p), get_ptr(m->e_hi));
+    bool found = false;
+    for (casadi_int i=0; i<ne_; ++i) {
+      found = found || event_crossing(event_direction_[i], m->e_prev[i], m->e_hi[i]);
+    }
+    if (!found) {
+      casadi_copy(get_ptr(m->e_hi), ne_, get_ptr(m->e_prev));
+      return;
+    }
+
+    // Bisection, keeping the first sign change in [lo, hi]
+    double t0 = m->t - h_, lo = 0, hi = 1;
+    casadi_copy(get_ptr(m->e_prev), ne_, get_ptr(m->e_lo));
+    while (hi-lo>1e-12) {
+      double mid = (lo+hi)/2;
+      interpolate(m, mid, get_ptr(m->x_event), get_ptr(m->z_event), nullptr);
+      calc_event(m, t0 + mid*h_, get_ptr(m->x_event), get_ptr(m->z_event), get_ptr(m->p),
+                 get_ptr(m->e));
+      bool left = false;
+      for (casadi_int i=0; i<ne_; ++i) {
+        left = left || event_crossing(event_direction_[i], m->e_lo[i], m->e[i]);
+      }
+      if (left) {
+        hi = mid;
+        casadi_copy(get_ptr(m->e), ne_, get_ptr(m->e_hi));
+      } else {
+        lo = mid;
+        casadi_copy(get_ptr(m->e), ne_, get_ptr(m->e_lo));
+      }
+    }
+
+    // Event functions changing sign in the bracket
+    m->event_index.clear();
+    for (casadi_int i=0; i<ne_; ++i) {
+      if (event_crossing(event_direction_[i], m->e_lo[i], m->e_hi[i])) {
+        m->event_index.push_back(i);
+      }
+    }
+    m->event_pending = true;
+    m->theta_event = hi;
+    m->t_event = t0 + hi*h_;
+  }
+
+  void FixedStepIntegrator::apply_located_event(FixedStepMemory* m) const {
+    // State at the event
+    double* x = get_ptr(m->x_event);
+    double* z = get_ptr(m->z_event);
+    double* q = get_ptr(m->q_event);
+    if (m->theta_event < 1-1e-9) {
+      interpolate(m, m->theta_event, x, z, q);
+    } else {
+      casadi_copy(get_ptr(m->x), nx_, x);
+      casadi_copy(get_ptr(m->Z)+m->Z.size()-nz_, nz_, z);
+      casadi_copy(get_ptr(m->q), nq_, q);
+    }
+
+    // State transitions
+    for (casadi_int i : m->event_index) apply_event(m, m->t_event, i, x, z, get_ptr(m->p));
+
+    // Restart at the event time
+    casadi_copy(x, nx_, get_ptr(m->x));
+    casadi_copy(z, nz_, get_ptr(m->Z)+m->Z.size()-nz_);
+    casadi_copy(q, nq_, get_ptr(m->q));
+    m->t = m->t_event;
+    m->t_start = m->t_event - static_cast<double>(m->k)*h_;
+    m->event_pending = false;
+    calc_event(m, m->t, x, z, get_ptr(m->p), get_ptr(m->e_prev));
+  }
+
+  void FixedStepIntegrator::interpolate(FixedStepMemory* m, double theta,
+                                        double* x, double* z, double* q) const {
     casadi_copy(get_ptr(m->x), nx_, x);
     casadi_copy(get_ptr(m->Z)+m->Z.size()-nz_, nz_, z);
     casadi_copy(get_ptr(m->q), nq_, q);
   }
 
+  void FixedStepIntegrator::check_deadline(FixedStepMemory* m) const {
+    if (!m->deadline.expired()) return;
+    casadi_error(name_ + (m->deadline.cancelled() ? ": Cancelled" : ": Maximum wall time exceeded")
+                 + " at t = " + str(m->t));
+  }
+
+  void FixedStepIntegrator::stepF(FixedStepMemory* m) const {
+    getExplicit()(m->arg, m->res, m->iw, m->w);
+  }
+
+  void FixedStepIntegrator::stepG(FixedStepMemory* m) const {
+    getExplicitB()(m->arg, m->res, m->iw, m->w);
+  }
+
   void FixedStepIntegrator::retreat(IntegratorMemory* mem, double t,
                                     double* rx, double* rz, double* rq) const {
     auto m = static_cast<FixedStepMemory*>(mem);
@@ -1176,6 +1618,8 @@ namespace casadi {
 
     // Take time steps until end time has been reached
     while (m->k>k_out) {
+      check_deadline(m);
+
       // Advance time
       m->k--;
       m->t = static_cast<double>(grid_.front()) + static_cast<double>(m->k)*h_;
@@ -1188,7 +1632,7 @@ namespace casadi {
       // Take step
       m->arg[RDAE_X] = get_ptr(m->x_tape.at(m->k));
       m->arg[RDAE_Z] = get_ptr(m->Z_tape.at(m->k));
-      G(m->arg, m->res, m->iw, m->w);
+      stepG(m);
       casadi_axpy(nrq_, 1., get_ptr(m->rq_prev), get_ptr(m->rq));
     }
 
@@ -1218,14 +1662,91 @@ namespace casadi {
 
     // Bring discrete time to the beginning
     m->k = 0;
+    m->k_dense = -1;
+    m->t_start = t;
+
+    // Event functions at the initial time
+    m->event_pending = false;
+    if (ne_>0) calc_event(m, t, x, z, p, get_ptr(m->e_prev));
 
     // Get consistent initial conditions
     casadi_fill(get_ptr(m->Z), m->Z.size(), numeric_limits<double>::quiet_NaN());
 
     // Add the first element in the tape
-    if (nrx_>0) {
+    if (tape_) {
       casadi_copy(x, nx_, get_ptr(m->x_tape.at(0)));
     }
+    m->reused = false;
+  }
+
+  bool FixedStepIntegrator::restore(IntegratorMemory* mem, const double* x0, const double* z0,
+                                    const double* p, double* x, double* z, double* q) const {
+    auto m = static_cast<FixedStepMemory*>(mem);
+    // Only the reverse derivative of an integrator keeping its forward passes
+    if (nrx_==0 || ne_>0 || derivative_of_.is_null()) return false;
+    auto d = dynamic_cast<const FixedStepIntegrator*>(derivative_of_.get());
+    if (d==nullptr || d->trajectory_cache_==0) return false;
+    // The forward problem must be the one of the nondifferentiated integrator
+    if (d->nx_!=nx_ || d->nz_!=nz_ || d->np_!=np_ || d->nq_!=nq_ || d->nZ_!=nZ_
+        || d->nk_!=nk_ || d->grid_!=grid_ || d->output_t0_!=output_t0_) return false;
+#ifdef CASADI_WITH_THREAD
+    std::lock_guard<std::mutex> lock(d->trajectories_mtx_);
+#endif // CASADI_WITH_THREAD
+    for (auto it=d->trajectories_.begin(); it!=d->trajectories_.end(); ++it) {
+      // Compare initial states and parameters, missing inputs are zero
+      const double* v = get_ptr(it->in);
+      bool match = true;
+      for (casadi_int i=0; i<nx_ && match; ++i) match = *v++ == (x0 ? x0[i] : 0);
+      for (casadi_int i=0; i<nz_ && match; ++i) match = *v++ == (z0 ? z0[i] : 0);
+      for (casadi_int i=0; i<np_ && match; ++i) match = *v++ == (p ? p[i] : 0);
+      if (!match) continue;
+      // Restore the tape and take the discrete time to the end
+      for (casadi_int k=0; k<=nk_; ++k) m->x_tape[k] = it->x_tape[k];
+      for (casadi_int k=0; k<nk_; ++k) m->Z_tape[k] = it->Z_tape[k];
+      m->k = nk_;
+      // Outputs, not available if not requested from the nondifferentiated integrator
+      const double nan = numeric_limits<double>::quiet_NaN();
+      if (x) casadi_fill(x, nnz_out(INTEGRATOR_XF), nan);
+      if (z) casadi_fill(z, nnz_out(INTEGRATOR_ZF), nan);
+      if (q) casadi_fill(q, nnz_out(INTEGRATOR_QF), nan);
+      if (!it->xf.empty()) casadi_copy(get_ptr(it->xf), it->xf.size(), x);
+      if (!it->zf.empty()) casadi_copy(get_ptr(it->zf), it->zf.size(), z);
+      if (!it->qf.empty()) casadi_copy(get_ptr(it->qf), it->qf.size(), q);
+      d->trajectories_.splice(d->trajectories_.begin(), d->trajectories_, it);
+      if (verbose_) casadi_message(name_ + ": Reusing the forward pass of " + d->name_);
+      m->reused = true;
+      return true;
+    }
+    return false;
+  }
+
+  void FixedStepIntegrator::store(IntegratorMemory* mem, const double* x0, const double* z0,
+                                  const double* p, const double* x, const double* z,
+                                  const double* q) const {
+    if (trajectory_cache_==0) return;
+    auto m = static_cast<FixedStepMemory*>(mem);
+    Trajectory t;
+    t.in.resize(nx_ + nz_ + np_);
+    casadi_copy(x0, nx_, get_ptr(t.in));
+    casadi_copy(z0, nz_, get_ptr(t.in) + nx_);
+    casadi_copy(p, np_, get_ptr(t.in) + nx_ + nz_);
+    if (x) t.xf.assign(x, x + nnz_out(INTEGRATOR_XF));
+    if (z) t.zf.assign(z, z + nnz_out(INTEGRATOR_ZF));
+    if (q) t.qf.assign(q, q + nnz_out(INTEGRATOR_QF));
+    t.x_tape = m->x_tape;
+    t.Z_tape = m->Z_tape;
+#ifdef CASADI_WITH_THREAD
+    std::lock_guard<std::mutex> lock(trajectories_mtx_);
+#endif // CASADI_WITH_THREAD
+    trajectories_.push_front(std::move(t));
+    if (static_cast<casadi_int>(trajectories_.size())>trajectory_cache_) trajectories_.pop_back();
+  }
+
+  Dict FixedStepIntegrator::get_stats(void* mem) const {
+    Dict stats = Integrator::get_stats(mem);
+    auto m = static_cast<FixedStepMemory*>(mem);
+    stats["forward_reused"] = m->reused;
+    return stats;
   }
 
   void FixedStepIntegrator::resetB(IntegratorMemory* mem, double t, const double* rx,
@@ -1258,6 +1779,7 @@ namespace casadi {
   }
 
   ImplicitFixedStepIntegrator::~ImplicitFixedStepIntegrator() {
+    clear_mem();
   }
 
   Options ImplicitFixedStepIntegrator::options_
@@ -1314,6 +1836,74 @@ namespace casadi {
     }
   }
 
+  int ImplicitFixedStepIntegrator::init_mem(void* mem) const {
+    if (FixedStepIntegrator::init_mem(mem)) return 1;
+    auto m = static_cast<FixedStepMemory*>(mem);
+
+    // Keep the rootfinder memory, e.g. a factorized Jacobian, between the steps
+    m->mem_F = rootfinder_.checkout();
+    if (!backward_rootfinder_.is_null()) m->mem_G = backward_rootfinder_.checkout();
+    return 0;
+  }
+
+  void ImplicitFixedStepIntegrator::free_mem(void *mem) const {
+    auto m = static_cast<FixedStepMemory*>(mem);
+    if (m->mem_F>=0) rootfinder_.release(m->mem_F);
+    if (m->mem_G>=0) backward_rootfinder_.release(m->mem_G);
+    delete m;
+  }
+
+  void ImplicitFixedStepIntegrator::
+  reset(IntegratorMemory* mem, double t,
+        const double* x, const double* z, const double* p) const {
+    auto m = static_cast<FixedStepMemory*>(mem);
+    FixedStepIntegrator::reset(mem, t, x, z, p);
+    m->niter = m->nfact = 0;
+  }
+
+  void ImplicitFixedStepIntegrator::resetB(IntegratorMemory* mem, double t, const double* rx,
+                                           const double* rz, const double* rp) const {
+    auto m = static_cast<FixedStepMemory*>(mem);
+    FixedStepIntegrator::resetB(mem, t, rx, rz, rp);
+    m->niterB = m->nfactB = 0;
+  }
+
+  void ImplicitFixedStepIntegrator::stepF(FixedStepMemory* m) const {
+    rootfinder_(m->arg, m->res, m->iw, m->w, m->mem_F);
+    Dict stats = rootfinder_.stats(m->mem_F);
+    if (stats.count("iter_count")) m->niter += stats.at("iter_count").to_int();
+    if (stats.count("n_fact")) m->nfact += stats.at("n_fact").to_int();
+  }
+
+  void ImplicitFixedStepIntegrator::stepG(FixedStepMemory* m) const {
+    backward_rootfinder_(m->arg, m->res, m->iw, m->w, m->mem_G);
+    Dict stats = backward_rootfinder_.stats(m->mem_G);
+    if (stats.count("iter_count")) m->niterB += stats.at("iter_count").to_int();
+    if (stats.count("n_fact")) m->nfactB += stats.at("n_fact").to_int();
+  }
+
+  void ImplicitFixedStepIntegrator::print_stats(IntegratorMemory* mem) const {
+    auto m = static_cast<FixedStepMemory*>(mem);
+    print("FORWARD INTEGRATION:\n");
+    print("Number of rootfinder iterations: %lld\n", m->niter);
+    print("Number of Jacobian factorizations: %lld\n", m->nfact);
+    if (nrx_>0) {
+      print("BACKWARD INTEGRATION:\n");
+      print("Number of rootfinder iterations: %lld\n", m->niterB);
+      print("Number of Jacobian factorizations: %lld\n", m->nfactB);
+    }
+  }
+
+  Dict ImplicitFixedStepIntegrator::get_stats(void* mem) const {
+    Dict stats = FixedStepIntegrator::get_stats(mem);
+    auto m = static_cast<FixedStepMemory*>(mem);
+    stats["rootfinder_iter"] = m->niter;
+    stats["rootfinder_nfact"] = m->nfact;
+    stats["rootfinder_iterB"] = m->niterB;
+    stats["rootfinder_nfactB"] = m->nfactB;
+    return stats;
+  }
+
   template<typename XType>
   Function Integrator::map2oracle(const std::string& name,
     const std::map<std::string, XType>& d, const Dict& opts) {
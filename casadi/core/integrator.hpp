@@ -89,6 +89,29 @@ namespace casadi {
 #endif // SWIG
   ///@}
 
+  /** \brief Integrator for n independent trajectories of the same DAE
+
+      The trajectories are integrated at once, as one block-diagonal system with
+      a single solver memory and one DAE evaluation per right-hand side evaluation.
+      The inputs and outputs have the columns of trajectory k at k*ncol, ..., (k+1)*ncol-1,
+      as for Function::map. The step size is shared by all trajectories, i.e. it is
+      determined by the most demanding one. For step size control per trajectory,
+      map an integrator instead, e.g. with F.map(n, "thread", max_num_threads).
+  */
+  ///@{
+  CASADI_EXPORT Function integrator_batch(const std::string& name, const std::string& solver,
+                                          const SXDict& dae, casadi_int n,
+                                          const Dict& opts=Dict());
+  CASADI_EXPORT Function integrator_batch(const std::string& name, const std::string& solver,
+                                          const MXDict& dae, casadi_int n,
+                                          const Dict& opts=Dict());
+#ifndef SWIG
+  CASADI_EXPORT Function integrator_batch(const std::string& name, const std::string& solver,
+                                          const Function& dae, casadi_int n,
+                                          const Dict& opts=Dict());
+#endif // SWIG
+  ///@}
+
   /// Check if a particular plugin is available
   CASADI_EXPORT bool has_integrator(const std::string& name);
 
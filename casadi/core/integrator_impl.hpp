@@ -29,6 +29,7 @@
 #include "integrator.hpp"
 #include "oracle_function.hpp"
 #include "plugin_interface.hpp"
+#include <list>
 
 /// \cond INTERNAL
 
@@ -36,6 +37,11 @@ namespace casadi {
 
   /** \brief Integrator memory */
   struct CASADI_EXPORT IntegratorMemory : public OracleMemory {
+    // Number of events during the last integration
+    casadi_int nevents;
+
+    // Event function values and a copy of the state for the event transition
+    std::vector<double> e, xe;
   };
 
   /** \brief Internal storage for integrator related data
@@ -99,12 +105,35 @@ namespace casadi {
     virtual void retreat(IntegratorMemory* mem, double t,
                          double* rx, double* rz, double* rq) const = 0;
 
+    /** \brief Take the forward problem to the end time by reusing an earlier forward pass
+        Returns false if no forward pass with the same inputs is available */
+    virtual bool restore(IntegratorMemory* mem, const double* x0, const double* z0,
+                         const double* p, double* x, double* z, double* q) const {
+      return false;
+    }
+
+    /** \brief Keep the forward pass after integrating for reuse by derivatives */
+    virtual void store(IntegratorMemory* mem, const double* x0, const double* z0,
+                       const double* p, const double* x, const double* z,
+                       const double* q) const {}
+
     /** \brief  evaluate */
     int eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const override;
 
     /** \brief  Print solver statistics */
     virtual void print_stats(IntegratorMemory* mem) const {}
 
+    /** \brief Get all statistics */
+    Dict get_stats(void* mem) const override;
+
+    /** \brief Evaluate the event functions at (t, x, z, p) */
+    void calc_event(IntegratorMemory* m, double t, const double* x, const double* z,
+                    const double* p, double* e) const;
+
+    /** \brief Apply the state transition of event i at time t, updating x */
+    void apply_event(IntegratorMemory* m, double t, casadi_int i, double* x,
+                     const double* z, const double* p) const;
+
     /** \brief  Propagate sparsity forward */
     int sp_forward(const bvec_t** arg, bvec_t** res,
       casadi_int* iw, bvec_t* w, void* mem) const override;
@@ -189,6 +218,18 @@ namespace casadi {
     // Augmented user option
     Dict augmented_options_;
 
+    // Evaluation of the forward sensitivity equations, empty for inlined
+    std::string sens_parallelization_;
+
+    // Event functions (t, x, z, p) -> e and state transition (t, x, z, p, i) -> x
+    Function event_, event_transition_;
+
+    // Number of event functions, maximum number of events per integration
+    casadi_int ne_, max_events_;
+
+    // Direction of the zero crossings triggering each event: 1, -1 or 0 for both
+    std::vector<casadi_int> event_direction_;
+
     // Copy of the options
     Dict opts_;
 
@@ -238,6 +279,31 @@ namespace casadi {
 
     // Tape
     std::vector<std::vector<double> > x_tape, Z_tape;
+
+    /// Was the forward pass of the nondifferentiated integrator reused?
+    bool reused;
+
+    /// Dense output data of step k_dense, e.g. quadrature derivatives at the stages
+    std::vector<double> dense;
+    casadi_int k_dense;
+
+    /// Time with k=0, differs from t0 after an event
+    double t_start;
+
+    /// Event located in the last step: time, fraction of the step and event functions
+    bool event_pending;
+    double t_event, theta_event;
+    std::vector<casadi_int> event_index;
+
+    /// Event function values at the start of the step and bracketing a root
+    std::vector<double> e_prev, e_lo, e_hi;
+
+    /// State at an event
+    std::vector<double> x_event, z_event, q_event;
+
+    /// Rootfinder memory, persistent over the steps, and statistics (implicit schemes)
+    casadi_int mem_F, mem_G;
+    casadi_int niter, nfact, niterB, nfactB;
   };
 
   class CASADI_EXPORT FixedStepIntegrator : public Integrator {
@@ -261,6 +327,9 @@ namespace casadi {
     /** \brief Create memory block */
     void* alloc_mem() const override { return new FixedStepMemory();}
 
+    /** \brief Get all statistics */
+    Dict get_stats(void* mem) const override;
+
     /** \brief Initalize memory block */
     int init_mem(void* mem) const override;
 
@@ -286,6 +355,37 @@ namespace casadi {
     void retreat(IntegratorMemory* mem, double t,
                          double* rx, double* rz, double* rq) const override;
 
+    /** \brief Reuse the tape of the nondifferentiated integrator (reverse derivatives) */
+    bool restore(IntegratorMemory* mem, const double* x0, const double* z0,
+                 const double* p, double* x, double* z, double* q) const override;
+
+    /** \brief Keep the outputs and the tape, if trajectory_cache is set */
+    void store(IntegratorMemory* mem, const double* x0, const double* z0,
+               const double* p, const double* x, const double* z,
+               const double* q) const override;
+
+    /** \brief Dense output at t_k + theta*h, 0 <= theta < 1, inside the last step k
+
+        Defaults to the values at the end of the step.
+    */
+    virtual void interpolate(FixedStepMemory* m, double theta,
+                             double* x, double* z, double* q) const;
+
+    /// Raise an error if the call has been cancelled or its time limit has passed
+    void check_deadline(FixedStepMemory* m) const;
+
+    /// Take a step with the explicit dynamics, arguments in m->arg and m->res
+    virtual void stepF(FixedStepMemory* m) const;
+
+    /// Locate the first event in the last step by bisection on the dense output
+    void locate_event(FixedStepMemory* m) const;
+
+    /// Apply the located event and restart the integration at the event time
+    void apply_located_event(FixedStepMemory* m) const;
+
+    /// Take a step with the explicit dynamics (backward problem)
+    virtual void stepG(FixedStepMemory* m) const;
+
     /// Get explicit dynamics
     virtual const Function& getExplicit() const { return F_;}
 
@@ -303,6 +403,30 @@ namespace casadi {
 
     /// Number of algebraic variables for the discrete time integration
     casadi_int nZ_, nRZ_;
+
+    /// Number of forward passes kept for reuse by the reverse derivative
+    casadi_int trajectory_cache_;
+
+    /// Record the tape during forward integration?
+    bool tape_;
+
+    /// Forward pass kept for reuse
+    struct Trajectory {
+      // Initial states and parameters
+      std::vector<double> in;
+      // Outputs of the forward problem, empty if not requested
+      std::vector<double> xf, zf, qf;
+      // Tape
+      std::vector<std::vector<double> > x_tape, Z_tape;
+    };
+
+    /// Forward passes kept, most recently used first
+    mutable std::list<Trajectory> trajectories_;
+
+#ifdef CASADI_WITH_THREAD
+    /// The forward passes are shared between threads
+    mutable std::mutex trajectories_mtx_;
+#endif // CASADI_WITH_THREAD
   };
 
   class CASADI_EXPORT ImplicitFixedStepIntegrator : public FixedStepIntegrator {
@@ -323,6 +447,32 @@ namespace casadi {
     /// Initialize stage
     void init(const Dict& opts) override;
 
+    /** \brief Initalize memory block */
+    int init_mem(void* mem) const override;
+
+    /** \brief Free memory block */
+    void free_mem(void *mem) const override;
+
+    /** \brief Reset the forward problem */
+    void reset(IntegratorMemory* mem, double t,
+               const double* x, const double* z, const double* p) const override;
+
+    /// Reset the backward problem and take time to tf
+    void resetB(IntegratorMemory* mem, double t,
+                const double* rx, const double* rz, const double* rp) const override;
+
+    /// Take a step, reusing the memory of the rootfinder
+    void stepF(FixedStepMemory* m) const override;
+
+    /// Take a step, reusing the memory of the rootfinder (backward problem)
+    void stepG(FixedStepMemory* m) const override;
+
+    /** \brief  Print solver statistics */
+    void print_stats(IntegratorMemory* mem) const override;
+
+    /** \brief Get all statistics */
+    Dict get_stats(void* mem) const override;
+
     /// Get explicit dynamics
     const Function& getExplicit() const override { return rootfinder_;}
 
@@ -131,7 +131,9 @@ namespace casadi {
         "Specifies, for each grid dimenion, the lookup algorithm used to find the correct index. "
         "'linear' uses a for-loop + break; (default when #knots<=100), "
         "'exact' uses floored division (only for uniform grids), "
-        "'binary' uses a binary search. (default when #knots>100)."}}
+        "'binary' uses a binary search. (default when #knots>100), "
+        "'hunt' searches outward from the interval found in the previous call, "
+        "'table' uses a precomputed index table (for non-uniform grids)."}}
      }
   };
 
@@ -165,6 +167,12 @@ namespace casadi {
         case 2:
           ret[i] = "binary";
           break;
+        case 3:
+          ret[i] = "hunt";
+          break;
+        case 4:
+          ret[i] = "table";
+          break;
         default:
           casadi_error("lookup_mode error.");
       }
@@ -188,6 +196,8 @@ namespace casadi {
     if (modes.empty()) return ret;
 
     casadi_assert_dev(modes.size()==offset.size()-1);
+    // Index tables, stored after the lookup modes
+    std::vector<casadi_int> tables;
     for (casadi_int i=0;i<offset.size()-1;++i) {
       if (modes[i]=="linear") {
         ret[i] = 0;
@@ -202,11 +212,67 @@ namespace casadi {
         casadi_assert_dev(is_increasing(grid) && is_equally_spaced(grid));
       } else if (modes[i]=="binary") {
         ret[i] = 2;
+      } else if (modes[i]=="hunt") {
+        ret[i] = 3;
+      } else if (modes[i]=="table") {
+        ret[i] = 4;
+        casadi_int m_left  = margin_left.empty() ? 0 : margin_left[i];
+        casadi_int m_right = margin_right.empty() ? 0 : margin_right[i];
+
+        std::vector<double> grid(
+            knots.begin()+offset[i]+m_left,
+            knots.begin()+offset[i+1]-m_right);
+        casadi_assert(is_nondecreasing(grid), "lookup_mode 'table' requires a sorted grid");
+        if (tables.empty()) tables.resize(offset.size()-1, 0);
+        tables[i] = tables.size();
+        lookup_table(grid, tables);
       } else {
         casadi_error("Unknown lookup_mode option '" + modes[i] + ". "
-                     "Allowed values: linear, binary, exact.");
+                     "Allowed values: linear, binary, exact, hunt, table.");
+      }
+    }
+    // Offsets of the tables are relative to the start of the lookup modes
+    if (!tables.empty()) {
+      for (casadi_int i=0;i<ret.size();++i) {
+        if (ret[i]==4) tables[i] += ret.size();
       }
+      ret.insert(ret.end(), tables.begin(), tables.end());
     }
     return ret;
   }
+
+  std::vector<casadi_int> Interpolant::batch_lookup_mode(
+      const std::vector<casadi_int>& lookup_mode, casadi_int ndim) {
+    // Linear and binary search give the same intervals as hunting
+    std::vector<casadi_int> ret = lookup_mode;
+    for (casadi_int i=0;i<ndim;++i) {
+      if (ret[i]==0 || ret[i]==2) ret[i] = 3;
+    }
+    return ret;
+  }
+
+  void Interpolant::lookup_table(const std::vector<double>& grid,
+      std::vector<casadi_int>& table) {
+    casadi_int ng = grid.size();
+    // Number of buckets, fine enough that most buckets overlap at most two intervals
+    double dg = ng<2 ? 0 : grid.back()-grid.front();
+    double dmin = dg;
+    for (casadi_int j=0;j+1<ng;++j) {
+      double d = grid[j+1]-grid[j];
+      if (d>0 && d<dmin) dmin = d;
+    }
+    casadi_int nb = 1;
+    if (ng>2 && dg>0) {
+      nb = std::min(static_cast<casadi_int>(ceil(dg/dmin)), 4*(ng-1));
+      nb = std::max(nb, casadi_int(1));
+    }
+    // First interval of each bucket
+    table.push_back(nb);
+    casadi_int j = 0;
+    for (casadi_int b=0;b<nb;++b) {
+      double x = grid.front() + b*dg/nb;
+      while (j<ng-2 && x>=grid[j+1]) j++;
+      table.push_back(j);
+    }
+  }
 } // namespace casadi
@@ -34,6 +34,14 @@
 
 namespace casadi {
 
+  /** \brief Memory for interval lookups
+
+      Keeps the intervals found in the previous call, used by lookup mode 'hunt'
+  */
+  struct CASADI_EXPORT LookupMemory {
+    std::vector<casadi_int> hint;
+  };
+
   /** Internal class
       @copydoc Interpolant_doc
   */
@@ -77,6 +85,13 @@ namespace casadi {
     /// Initialize
     void init(const Dict& opts) override;
 
+    /// Add the estimated heap memory, including the grid and the values
+    void memory_usage(std::map<std::string, casadi_int>& usage,
+                      std::set<const void*>& visited) const override {
+      FunctionInternal::memory_usage(usage, visited);
+      usage["data"] += memory_bytes(grid_) + memory_bytes(offset_) + memory_bytes(values_);
+    }
+
     /// Convert from (optional) lookup modes labels to enum
     static std::vector<casadi_int> interpret_lookup_mode(const std::vector<std::string>& modes,
         const std::vector<double>& grid, const std::vector<casadi_int>& offset,
@@ -85,6 +100,13 @@ namespace casadi {
 
     static std::vector<std::string> lookup_mode_from_enum(const std::vector<casadi_int>& modes);
 
+    /// Lookup modes for batched evaluation, searching from the interval of the previous point
+    static std::vector<casadi_int> batch_lookup_mode(const std::vector<casadi_int>& lookup_mode,
+                                                     casadi_int ndim);
+
+    /// Append the index table of a grid, used by lookup mode 'table'
+    static void lookup_table(const std::vector<double>& grid, std::vector<casadi_int>& table);
+
     // Creator function for internal class
     typedef Interpolant* (*Creator)(const std::string& name,
                                     const std::vector<double>& grid,
@@ -44,6 +44,16 @@ namespace casadi {
     res[0] = inv(arg[0]);
   }
 
+  int Inverse::eval_sx(const SXElem** arg, SXElem** res, casadi_int* iw, SXElem* w) const {
+    SX x = SX::zeros(dep().sparsity());
+    if (arg[0]) std::copy_n(arg[0], x.nnz(), x.ptr());
+    if (res[0]) {
+      SX r = SX::project(inv(x), sparsity());
+      std::copy_n(r.ptr(), r.nnz(), res[0]);
+    }
+    return 0;
+  }
+
   void Inverse::ad_forward(const std::vector<std::vector<MX> >& fseed,
                         std::vector<std::vector<MX> >& fsens) const {
     MX inv_X = shared_from_this<MX>();
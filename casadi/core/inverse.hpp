@@ -49,6 +49,9 @@ namespace casadi {
     /** \brief  Evaluate symbolically (MX) */
     void eval_mx(const std::vector<MX>& arg, std::vector<MX>& res) const override;
 
+    /** \brief  Evaluate symbolically (SX), by sparse elimination */
+    int eval_sx(const SXElem** arg, SXElem** res, casadi_int* iw, SXElem* w) const override;
+
     /** \brief Calculate forward mode directional derivatives */
     void ad_forward(const std::vector<std::vector<MX> >& fseed,
                          std::vector<std::vector<MX> >& fsens) const override;
@@ -62,6 +65,10 @@ namespace casadi {
 
     /** \brief Get the operation */
     casadi_int op() const override { return OP_INVERSE;}
+
+    /** \brief Largest number of nonzeros in the LU factors for which the inverse
+        is formed by symbolic elimination, cf. Sparsity::lu_sparse */
+    static const casadi_int max_lu_nnz = 5000;
   };
 
 
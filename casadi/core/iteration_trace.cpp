@@ -0,0 +1,118 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#include "iteration_trace.hpp"
+#include "exception.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <limits>
+
+namespace casadi {
+
+  using namespace std::chrono;
+
+  IterationTrace::IterationTrace() : n_(0), next_(0), n_recorded_(0), solve_(0) {
+  }
+
+  void IterationTrace::init(casadi_int n, const std::vector<std::string>& columns,
+                            const std::string& file) {
+    columns_ = {"solve", "iter", "t_wall"};
+    columns_.insert(columns_.end(), columns.begin(), columns.end());
+    n_ = n;
+    data_.assign(n*columns_.size(), 0);
+    next_ = n_recorded_ = solve_ = 0;
+    file_ = file;
+  }
+
+  void IterationTrace::start() {
+    solve_++;
+    start_ = steady_clock::now();
+  }
+
+  void IterationTrace::record(casadi_int iter, std::initializer_list<double> values) {
+    if (data_.empty()) return;
+    double* r = &data_[next_*columns_.size()];
+    r[0] = static_cast<double>(solve_);
+    r[1] = static_cast<double>(iter);
+    r[2] = duration<double>(steady_clock::now() - start_).count();
+    // Missing values are nan, extra values ignored
+    casadi_int i = 3;
+    for (double v : values) {
+      if (i==columns_.size()) break;
+      r[i++] = v;
+    }
+    std::fill(r+i, r+columns_.size(), std::numeric_limits<double>::quiet_NaN());
+    if (++next_==n_) next_ = 0;
+    n_recorded_++;
+  }
+
+  std::vector<const double*> IterationTrace::records() const {
+    std::vector<const double*> ret;
+    casadi_int n = std::min(n_recorded_, n_);
+    casadi_int first = n_recorded_ > n_ ? next_ : 0;
+    for (casadi_int k=0; k<n; ++k) {
+      ret.push_back(&data_[((first+k) % n_)*columns_.size()]);
+    }
+    return ret;
+  }
+
+  Dict IterationTrace::get() const {
+    std::vector<const double*> r = records();
+    Dict ret;
+    for (casadi_int i=0; i<columns_.size(); ++i) {
+      std::vector<double> c(r.size());
+      for (casadi_int k=0; k<r.size(); ++k) c[k] = r[k][i];
+      ret[columns_[i]] = c;
+    }
+    ret["n_dropped"] = std::max(n_recorded_ - n_, casadi_int(0));
+    return ret;
+  }
+
+  void IterationTrace::dump(const std::string& file) const {
+    std::ofstream f(file, std::ios::binary);
+    casadi_assert(f.good(), "Cannot open " + file);
+    auto put = [&](int64_t v) { f.write(reinterpret_cast<const char*>(&v), sizeof(v));};
+    f.write("CSDTRC01", 8);
+    put(columns_.size());
+    for (auto&& c : columns_) {
+      put(c.size());
+      f.write(c.data(), c.size());
+    }
+    std::vector<const double*> r = records();
+    put(r.size());
+    put(std::max(n_recorded_ - n_, casadi_int(0)));
+    for (const double* e : r) {
+      f.write(reinterpret_cast<const char*>(e), columns_.size()*sizeof(double));
+    }
+  }
+
+  void IterationTrace::dump_on_fail() const {
+    if (enabled() && !file_.empty()) dump(file_);
+  }
+
+} // namespace casadi
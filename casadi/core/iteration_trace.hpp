@@ -0,0 +1,104 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#ifndef CASADI_ITERATION_TRACE_HPP
+#define CASADI_ITERATION_TRACE_HPP
+
+#include "generic_type.hpp"
+
+#include <chrono>
+#include <initializer_list>
+
+namespace casadi {
+  /// \cond INTERNAL
+
+  /** \brief Preallocated ring buffer of solver iterations
+
+  Each record holds the solve number, the iteration number, the wall time [s] since the
+  start of the solve and solver specific values. Recording performs no allocation and
+  no formatting. When the buffer is full, the oldest records are overwritten.
+
+  Binary format written by dump, in host byte order:
+  "CSDTRC01", int64 number of columns, per column an int64 length and the characters of
+  the name, int64 number of records, int64 number of overwritten records, then the
+  records as doubles, oldest first.
+  */
+  class CASADI_EXPORT IterationTrace {
+    public:
+      /// Constructor, disabled
+      IterationTrace();
+
+      /// Allocate n records with the given solver specific columns
+      void init(casadi_int n, const std::vector<std::string>& columns,
+                const std::string& file=std::string());
+
+      /// Is the trace enabled?
+      bool enabled() const { return !data_.empty();}
+
+      /// Start a new solve
+      void start();
+
+      /// Record an iteration
+      void record(casadi_int iter, std::initializer_list<double> values);
+
+      /// All columns, including solve, iter and t_wall
+      const std::vector<std::string>& columns() const { return columns_;}
+
+      /// Records, oldest first, as {column: values}, with "n_dropped"
+      Dict get() const;
+
+      /// Write binary dump
+      void dump(const std::string& file) const;
+
+      /// Write a binary dump to the file given to init, if any, e.g. when a solve failed
+      void dump_on_fail() const;
+
+    private:
+      // Column names
+      std::vector<std::string> columns_;
+
+      // Records
+      std::vector<double> data_;
+
+      // Number of records, the next record and the number of records ever recorded
+      casadi_int n_, next_, n_recorded_;
+
+      // Solve counter
+      casadi_int solve_;
+
+      // File for dump_on_fail
+      std::string file_;
+
+      // Start of the current solve
+      std::chrono::time_point<std::chrono::steady_clock> start_;
+
+      // Records in chronological order
+      std::vector<const double*> records() const;
+  };
+/// \endcond
+} // namespace casadi
+
+#endif // CASADI_ITERATION_TRACE_HPP
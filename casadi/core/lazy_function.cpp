@@ -0,0 +1,131 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#include "lazy_function.hpp"
+
+using namespace std;
+
+namespace casadi {
+
+  Function LazyFunction::create(const BinaryDeserializer::Header& h,
+                                const std::vector<casadi_int>& sz,
+                                const std::shared_ptr<const BinaryBuffer>& buf, size_t pos) {
+    return Function::create(new LazyFunction(h, sz, buf, pos), Dict());
+  }
+
+  LazyFunction::LazyFunction(const BinaryDeserializer::Header& h,
+                             const std::vector<casadi_int>& sz,
+                             const std::shared_ptr<const BinaryBuffer>& buf, size_t pos)
+    : FunctionInternal(h.name), h_(h), sz_(sz), buf_(buf), pos_(pos),
+      loaded_(false), fits_(false) {
+    casadi_assert_dev(sz_.size()==4);
+  }
+
+  LazyFunction::~LazyFunction() {
+  }
+
+  void LazyFunction::init(const Dict& opts) {
+    // Call the initialization method of the base class
+    FunctionInternal::init(opts);
+
+    // Work vectors of the Function, as written
+    alloc_arg(sz_[0]);
+    alloc_res(sz_[1]);
+    alloc_iw(sz_[2]);
+    alloc_w(sz_[3]);
+  }
+
+  bool LazyFunction::is_loaded() const {
+    return loaded_;
+  }
+
+  const Function& LazyFunction::get() const {
+    if (loaded_) return f_;
+#ifdef CASADI_WITH_THREAD
+    std::lock_guard<std::mutex> lock(mtx_);
+#endif // CASADI_WITH_THREAD
+    if (!loaded_) {
+      if (verbose_) casadi_message("Reading " + name_);
+      BinaryDeserializer s(buf_, pos_, true);
+      Function f = s.unpack_function();
+      casadi_assert(f.n_in()==n_in_ && f.n_out()==n_out_, "Corrupt binary file");
+      for (casadi_int i=0; i<n_in_; ++i) {
+        casadi_assert(f.sparsity_in(i)==sparsity_in_[i], "Corrupt binary file");
+      }
+      for (casadi_int i=0; i<n_out_; ++i) {
+        casadi_assert(f.sparsity_out(i)==sparsity_out_[i], "Corrupt binary file");
+      }
+      fits_ = f.sz_arg()<=sz_[0] && f.sz_res()<=sz_[1] && f.sz_iw()<=sz_[2]
+        && f.sz_w()<=sz_[3];
+      f_ = f;
+      buf_.reset();
+      loaded_ = true;
+    }
+    return f_;
+  }
+
+  int LazyFunction::eval(const double** arg, double** res,
+                         casadi_int* iw, double* w, void* mem) const {
+    const Function& f = get();
+    if (fits_) return f(arg, res, iw, w);
+    // The Function read needs more work memory than it did when written
+    f(vector<const double*>(arg, arg+n_in_), vector<double*>(res, res+n_out_));
+    return 0;
+  }
+
+  int LazyFunction::eval_sx(const SXElem** arg, SXElem** res,
+                            casadi_int* iw, SXElem* w, void* mem) const {
+    const Function& f = get();
+    if (fits_) return f(arg, res, iw, w);
+    f(vector<const SXElem*>(arg, arg+n_in_), vector<SXElem*>(res, res+n_out_));
+    return 0;
+  }
+
+  int LazyFunction::sp_forward(const bvec_t** arg, bvec_t** res,
+                               casadi_int* iw, bvec_t* w, void* mem) const {
+    const Function& f = get();
+    if (fits_) return f(arg, res, iw, w);
+    f(vector<const bvec_t*>(arg, arg+n_in_), vector<bvec_t*>(res, res+n_out_));
+    return 0;
+  }
+
+  int LazyFunction::sp_reverse(bvec_t** arg, bvec_t** res,
+                               casadi_int* iw, bvec_t* w, void* mem) const {
+    const Function& f = get();
+    if (fits_) return f.rev(arg, res, iw, w);
+    return f.rev(vector<bvec_t*>(arg, arg+n_in_), vector<bvec_t*>(res, res+n_out_));
+  }
+
+  void LazyFunction::codegen_declarations(CodeGenerator& g) const {
+    g.add_dependency(get());
+  }
+
+  void LazyFunction::codegen_body(CodeGenerator& g) const {
+    casadi_assert(fits_, "Cannot generate code for " + name_ + ": Work vectors changed");
+    g << "return " << g(get(), "arg", "res", "iw", "w") << ";\n";
+  }
+
+} // namespace casadi
@@ -0,0 +1,183 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#ifndef CASADI_LAZY_FUNCTION_HPP
+#define CASADI_LAZY_FUNCTION_HPP
+
+#include "function_internal.hpp"
+#include "binary_serializer.hpp"
+
+/// \cond INTERNAL
+
+namespace casadi {
+
+  /** \brief Function in a binary file that is only read on first use
+
+  Created when loading with Function::load and option "lazy". The signature and the
+  work vector sizes are known without reading the Function. Evaluation, derivatives
+  and code generation read the Function, which then replaces the proxy for all uses.
+  */
+  class CASADI_EXPORT LazyFunction : public FunctionInternal {
+  public:
+    /// Create a proxy for the record at position pos of a buffer
+    static Function create(const BinaryDeserializer::Header& h,
+                           const std::vector<casadi_int>& sz,
+                           const std::shared_ptr<const BinaryBuffer>& buf, size_t pos);
+
+    /** \brief Destructor */
+    ~LazyFunction() override;
+
+    /** \brief Get type name */
+    std::string class_name() const override {return "LazyFunction";}
+
+    /// @{
+    /** \brief Sparsities of function inputs and outputs */
+    Sparsity get_sparsity_in(casadi_int i) override { return h_.sp_in.at(i);}
+    Sparsity get_sparsity_out(casadi_int i) override { return h_.sp_out.at(i);}
+    /// @}
+
+    /** \brief Get default input value */
+    double get_default_in(casadi_int ind) const override { return h_.default_in.at(ind);}
+
+    ///@{
+    /** \brief Number of function inputs and outputs */
+    size_t get_n_in() override { return h_.sp_in.size();}
+    size_t get_n_out() override { return h_.sp_out.size();}
+    ///@}
+
+    ///@{
+    /** \brief Names of function input and outputs */
+    std::string get_name_in(casadi_int i) override { return h_.name_in.at(i);}
+    std::string get_name_out(casadi_int i) override { return h_.name_out.at(i);}
+    /// @}
+
+    /** \brief  Initialize */
+    void init(const Dict& opts) override;
+
+    /// The Function, read on the first call
+    const Function& get() const;
+
+    /// Has the Function been read?
+    bool is_loaded() const;
+
+    /// Evaluate the function numerically
+    int eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const override;
+
+    /** \brief  Evaluate symbolically, SX type */
+    int eval_sx(const SXElem** arg, SXElem** res,
+                casadi_int* iw, SXElem* w, void* mem) const override;
+
+    /** \brief  Propagate sparsity forward */
+    int sp_forward(const bvec_t** arg, bvec_t** res,
+                   casadi_int* iw, bvec_t* w, void* mem) const override;
+
+    /** \brief  Propagate sparsity backwards */
+    int sp_reverse(bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w, void* mem) const override;
+
+    ///@{
+    /// Is the class able to propagate seeds through the algorithm?
+    bool has_spfwd() const override { return true;}
+    bool has_sprev() const override { return true;}
+    ///@}
+
+    ///@{
+    /** \brief Derivatives of the Function, which is an SXFunction or MXFunction */
+    bool has_forward(casadi_int nfwd) const override { return true;}
+    Function get_forward(casadi_int nfwd, const std::string& name,
+                         const std::vector<std::string>& inames,
+                         const std::vector<std::string>& onames,
+                         const Dict& opts) const override {
+      return get()->get_forward(nfwd, name, inames, onames, opts);
+    }
+    bool has_reverse(casadi_int nadj) const override { return true;}
+    Function get_reverse(casadi_int nadj, const std::string& name,
+                         const std::vector<std::string>& inames,
+                         const std::vector<std::string>& onames,
+                         const Dict& opts) const override {
+      return get()->get_reverse(nadj, name, inames, onames, opts);
+    }
+    bool has_jacobian() const override { return true;}
+    Function get_jacobian(const std::string& name,
+                          const std::vector<std::string>& inames,
+                          const std::vector<std::string>& onames,
+                          const Dict& opts) const override {
+      return get()->get_jacobian(name, inames, onames, opts);
+    }
+    ///@}
+
+    /** \brief Thread-safe if the Function is, reading it if needed */
+    bool is_thread_safe() const override { return get()->is_thread_safe();}
+
+    /** \brief Is codegen supported? */
+    bool has_codegen() const override { return true;}
+
+    /** \brief Generate code for the declarations of the C function */
+    void codegen_declarations(CodeGenerator& g) const override;
+
+    /** \brief Generate code for the body of the C function */
+    void codegen_body(CodeGenerator& g) const override;
+
+    /** \brief Serialize in the binary format */
+    void serialize_binary(BinarySerializer& s) const override { get()->serialize_binary(s);}
+
+    /** Obtain information about node */
+    Dict info() const override { return {{"loaded", is_loaded()}};}
+
+  protected:
+    // Constructor (protected, use create function)
+    LazyFunction(const BinaryDeserializer::Header& h, const std::vector<casadi_int>& sz,
+                 const std::shared_ptr<const BinaryBuffer>& buf, size_t pos);
+
+    // Signature
+    BinaryDeserializer::Header h_;
+
+    // Work vector sizes of the Function: sz_arg, sz_res, sz_iw, sz_w
+    std::vector<casadi_int> sz_;
+
+    // Buffer and position of the record, released when read
+    mutable std::shared_ptr<const BinaryBuffer> buf_;
+    size_t pos_;
+
+    // The Function, once read
+    mutable Function f_;
+
+    // Has the Function been read?
+    mutable std::atomic<bool> loaded_;
+
+    // Do the work vectors fit the Function read?
+    mutable bool fits_;
+
+#ifdef CASADI_WITH_THREAD
+    // Reading is thread-safe
+    mutable std::mutex mtx_;
+#endif // CASADI_WITH_THREAD
+  };
+
+} // namespace casadi
+
+/// \endcond
+
+#endif // CASADI_LAZY_FUNCTION_HPP
@@ -25,6 +25,7 @@
 
 #include "linsol_internal.hpp"
 #include "mx_node.hpp"
+#include "thread_pool.hpp"
 
 using namespace std;
 namespace casadi {
@@ -83,7 +84,7 @@ namespace casadi {
 
     // Solve
     DM x = densify(B);
-    if (solve(A.ptr(), x.ptr(), x.size2())) casadi_error("Linsol::solve: 'solve' failed");
+    if (solve(A.ptr(), x.ptr(), x.size2(), tr)) casadi_error("Linsol::solve: 'solve' failed");
     return x;
   }
 
@@ -101,7 +102,7 @@ namespace casadi {
     auto m = static_cast<LinsolMemory*>((*this)->memory(mem));
 
     // Factorization will be needed after this step
-    m->is_sfact = m->is_nfact = false;
+    m->is_sfact = m->is_nfact = m->is_cached = false;
 
     // Perform pivoting
     if ((*this)->sfact(m, A)) return 1;
@@ -125,12 +126,27 @@ namespace casadi {
       if (sfact(A, mem)) return 1;
     }
 
-    m->is_nfact = false;
+    m->is_nfact = m->is_cached = false;
     if ((*this)->nfact(m, A)) return 1;
     m->is_nfact = true;
     return 0;
   }
 
+  int Linsol::nfact_cached(const double* A, casadi_int mem) const {
+    if (A==nullptr) return 1;
+    auto m = static_cast<LinsolMemory*>((*this)->memory(mem));
+
+    // Quick return if the current factorization is for the same numerical values
+    casadi_int nnz = sparsity().nnz();
+    if (m->is_cached && std::equal(A, A+nnz, m->A_cached.begin())) return 0;
+
+    // Factorize and record the nonzeros
+    if (nfact(A, mem)) return 1;
+    m->A_cached.assign(A, A+nnz);
+    m->is_cached = true;
+    return 0;
+  }
+
   casadi_int Linsol::neig(const DM& A) const {
     if (A.sparsity()!=sparsity()) return neig(project(A, sparsity()));
     casadi_int n = neig(A.ptr());
@@ -153,12 +169,78 @@ namespace casadi {
     return (*this)->rank((*this)->memory(mem), A);
   }
 
+  void Linsol::update(const DM& W, double sigma) const {
+    casadi_assert(W.size1()==sparsity().size1(), "Dimension mismatch");
+    if (!W.is_dense()) return update(densify(W), sigma);
+    if (update(W.ptr(), W.size2(), sigma)) casadi_error("'update' failed");
+  }
+
+  int Linsol::update(const double* W, casadi_int k, double sigma, casadi_int mem) const {
+    auto m = static_cast<LinsolMemory*>((*this)->memory(mem));
+    casadi_assert(m->is_nfact, "Linear system has not been factorized");
+    m->is_cached = false;
+    return (*this)->update(m, W, k, sigma);
+  }
+
   int Linsol::solve(const double* A, double* x, casadi_int nrhs, bool tr, casadi_int mem) const {
     auto m = static_cast<LinsolMemory*>((*this)->memory(mem));
     casadi_assert(m->is_nfact, "Linear system has not been factorized");
     return (*this)->solve(m, A, x, nrhs, tr);
   }
 
+  int Linsol::nfact_batch(const std::vector<const double*>& A,
+                          const std::vector<casadi_int>& mem, casadi_int n_threads) const {
+    casadi_assert(A.size()==mem.size(), "Dimension mismatch");
+    // Failures, one entry per matrix to avoid sharing between threads
+    std::vector<int> flag(A.size(), 0);
+    bool serial = !(*this)->is_reentrant();
+    ThreadPool::run(A.size(), serial ? 1 : n_threads, [&](casadi_int i, casadi_int t) {
+      flag[i] = nfact(A[i], mem[i]);
+    });
+    for (int f : flag) if (f) return 1;
+    return 0;
+  }
+
+  int Linsol::solve_batch(const std::vector<const double*>& A, const std::vector<double*>& x,
+                          casadi_int nrhs, bool tr, const std::vector<casadi_int>& mem,
+                          casadi_int n_threads) const {
+    casadi_assert(A.size()==mem.size() && x.size()==mem.size(), "Dimension mismatch");
+    std::vector<int> flag(A.size(), 0);
+    bool serial = !(*this)->is_reentrant();
+    ThreadPool::run(A.size(), serial ? 1 : n_threads, [&](casadi_int i, casadi_int t) {
+      flag[i] = solve(A[i], x[i], nrhs, tr, mem[i]);
+    });
+    for (int f : flag) if (f) return 1;
+    return 0;
+  }
+
+  std::vector<DM> Linsol::solve_batch(const std::vector<DM>& A, const std::vector<DM>& B,
+                                      bool tr, casadi_int n_threads) const {
+    casadi_assert(A.size()==B.size(), "Dimension mismatch");
+    casadi_int n = A.size();
+    // Nonzeros of the matrices and dense right-hand sides
+    std::vector<DM> Ap(n), X(n);
+    std::vector<const double*> a(n);
+    std::vector<double*> x(n);
+    for (casadi_int i=0; i<n; ++i) {
+      Ap[i] = A[i].sparsity()==sparsity() ? A[i] : project(A[i], sparsity());
+      casadi_assert(B[i].size1()==sparsity().size2(), "Dimension mismatch");
+      casadi_assert(i==0 || B[i].size2()==B[0].size2(),
+                    "All right-hand sides must have the same number of columns");
+      X[i] = densify(B[i]);
+      a[i] = Ap[i].ptr();
+      x[i] = X[i].ptr();
+    }
+    // One memory object per matrix
+    std::vector<casadi_int> mem(n);
+    for (casadi_int i=0; i<n; ++i) mem[i] = checkout();
+    int flag = nfact_batch(a, mem, n_threads);
+    if (flag==0 && n>0) flag = solve_batch(a, x, X[0].size2(), tr, mem, n_threads);
+    for (casadi_int i=0; i<n; ++i) release(mem[i]);
+    casadi_assert(flag==0, "'solve_batch' failed");
+    return X;
+  }
+
   casadi_int Linsol::checkout() const {
     return (*this)->checkout();
   }
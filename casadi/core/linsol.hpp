@@ -106,16 +106,48 @@ namespace casadi {
       */
     casadi_int rank(const DM& A) const;
 
+    /** \brief Low-rank modification of the numeric factorization
+      * Replaces the factorization of A with that of A + sigma*W*W', without
+      * refactorizing. The pattern of W*W' must be contained in sparsity().
+      * Not available for all solvers
+      */
+    void update(const DM& W, double sigma=1) const;
+
+    /** \brief Solve several linear systems with the same sparsity pattern
+      * Solves A[i]*X[i] = B[i], or A[i]'*X[i] = B[i] if tr, for all i. Each matrix is
+      * factorized in its own memory object, optionally in parallel on n_threads threads.
+      */
+    std::vector<DM> solve_batch(const std::vector<DM>& A, const std::vector<DM>& B,
+                                bool tr=false, casadi_int n_threads=1) const;
+
     #ifndef SWIG
     ///@{
     /// Low-level API
     int sfact(const double* A, casadi_int mem=0) const;
     int nfact(const double* A, casadi_int mem=0) const;
+    int nfact_cached(const double* A, casadi_int mem=0) const;
     int solve(const double* A, double* x, casadi_int nrhs=1, bool tr=false, casadi_int mem=0) const;
     casadi_int neig(const double* A, casadi_int mem=0) const;
     casadi_int rank(const double* A, casadi_int mem=0) const;
+    int update(const double* W, casadi_int k, double sigma=1, casadi_int mem=0) const;
     ///@}
 
+    /** \brief Numeric factorization of A[i] into memory object mem[i], for all i
+      * With n_threads>1, the factorizations run in parallel.
+      * Returns nonzero if any of them failed
+      */
+    int nfact_batch(const std::vector<const double*>& A, const std::vector<casadi_int>& mem,
+                    casadi_int n_threads=1) const;
+
+    /** \brief Solve with A[i] factorized in memory object mem[i], for all i
+      * x[i] holds nrhs right-hand sides on entry and the solution on exit.
+      * With n_threads>1, the solves run in parallel.
+      * Returns nonzero if any of them failed
+      */
+    int solve_batch(const std::vector<const double*>& A, const std::vector<double*>& x,
+                    casadi_int nrhs, bool tr, const std::vector<casadi_int>& mem,
+                    casadi_int n_threads=1) const;
+
     /// Checkout a memory object
     casadi_int checkout() const;
 
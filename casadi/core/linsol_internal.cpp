@@ -102,13 +102,124 @@ namespace casadi {
     casadi_error("'rank' not defined for " + class_name());
   }
 
+  int LinsolInternal::update(void* mem, const double* W, casadi_int k, double sigma) const {
+    casadi_error("'update' not defined for " + class_name());
+  }
+
   void LinsolInternal::generate(CodeGenerator& g, const std::string& A, const std::string& x,
                                 casadi_int nrhs, bool tr) const {
     g << "#error " <<  class_name() << " does not support code generation\n";
   }
 
+  void LinsolInternal::etree_subtrees(const Sparsity& sp_deps, casadi_int n_threads,
+                                      std::vector<casadi_int>& ptr,
+                                      std::vector<casadi_int>& ind) {
+    casadi_int n = sp_deps.size2();
+    const casadi_int *colind = sp_deps.colind(), *row = sp_deps.row();
+    // Elimination tree: the parent of r is the first column depending on r
+    std::vector<casadi_int> parent(n, -1);
+    for (casadi_int c=0; c<n; ++c) {
+      for (casadi_int k=colind[c]; k<colind[c+1]; ++k) {
+        casadi_int r = row[k];
+        if (r<c && parent[r]<0) parent[r] = c;
+      }
+    }
+    // Estimated work for each subtree, children have lower indices than parents
+    std::vector<casadi_int> cost(n);
+    casadi_int total = 0;
+    for (casadi_int c=0; c<n; ++c) {
+      cost[c] += 1 + colind[c+1] - colind[c];
+      if (parent[c]>=0) {
+        cost[parent[c]] += cost[c];
+      } else {
+        total += cost[c];
+      }
+    }
+    // Subtrees small enough for load balancing become tasks, top-down
+    casadi_int target = n_threads>1 ? total/(4*n_threads) : -1;
+    std::vector<casadi_int> task(n, -1), task_cost;
+    for (casadi_int c=n-1; c>=0; --c) {
+      if (parent[c]>=0 && task[parent[c]]>=0) {
+        task[c] = task[parent[c]];
+      } else if (cost[c]<=target) {
+        task[c] = task_cost.size();
+        task_cost.push_back(cost[c]);
+      }
+    }
+    // Most expensive tasks first
+    casadi_int ntask = task_cost.size();
+    std::vector<casadi_int> order = range(ntask), pos(ntask);
+    std::stable_sort(order.begin(), order.end(),
+                     [&](casadi_int i, casadi_int j) { return task_cost[i]>task_cost[j];});
+    for (casadi_int i=0; i<ntask; ++i) pos[order[i]] = i;
+    // Group the columns, remaining columns last
+    ptr.assign(ntask+2, 0);
+    for (casadi_int c=0; c<n; ++c) ptr[1 + (task[c]<0 ? ntask : pos[task[c]])]++;
+    for (casadi_int i=0; i<=ntask; ++i) ptr[i+1] += ptr[i];
+    ind.resize(n);
+    std::vector<casadi_int> next(ptr.begin(), ptr.end()-1);
+    for (casadi_int c=0; c<n; ++c) ind[next[task[c]<0 ? ntask : pos[task[c]]]++] = c;
+  }
+
+  casadi_int LinsolInternal::refine(const Sparsity& sp, const double* A, double* x,
+                                    casadi_int nrhs, bool tr,
+                                    const std::function<void(double*)>& solve_low,
+                                    double* b, double* r, casadi_int max_iter, double tol) {
+    casadi_int n = sp.size1(), ret = 0;
+    for (casadi_int j=0; j<nrhs; ++j) {
+      casadi_copy(x, n, b);
+      solve_low(x);
+      double b_norm = casadi_norm_inf(n, b);
+      casadi_int k;
+      for (k=0; k<max_iter; ++k) {
+        // Residual in double precision
+        for (casadi_int i=0; i<n; ++i) r[i] = -b[i];
+        casadi_mv(A, sp, x, r, tr);
+        if (casadi_norm_inf(n, r)<=tol*b_norm) break;
+        // Correction in low precision
+        solve_low(r);
+        for (casadi_int i=0; i<n; ++i) x[i] -= r[i];
+      }
+      ret = std::max(ret, k);
+      x += n;
+    }
+    return ret;
+  }
+
+  void LinsolInternal::generate_refine(CodeGenerator& g, const Sparsity& sp,
+                                       const std::string& A, const std::string& x,
+                                       casadi_int nrhs, bool tr, const std::string& type,
+                                       const std::string& solve_low,
+                                       casadi_int max_iter, double tol) {
+    casadi_int n = sp.size1();
+    g.add_auxiliary(CodeGenerator::AUX_NORM_INF);
+    g << "{\n"
+      << "casadi_int i, j, k;\n"
+      << "casadi_real *xj, rhs[" << n << "], res[" << n << "], rhs_norm;\n"
+      << type << " xl[" << n << "];\n"
+      << "for (j=0; j<" << nrhs << "; ++j) {\n"
+      << "xj = " << x << "+j*" << n << ";\n"
+      << g.copy("xj", n, "rhs") << "\n"
+      << "for (i=0; i<" << n << "; ++i) xl[i] = xj[i];\n"
+      << solve_low << "\n"
+      << "for (i=0; i<" << n << "; ++i) xj[i] = xl[i];\n"
+      << "rhs_norm = casadi_norm_inf(" << n << ", rhs);\n"
+      << "for (k=0; k<" << max_iter << "; ++k) {\n"
+      << "for (i=0; i<" << n << "; ++i) res[i] = -rhs[i];\n"
+      << g.mv(A, sp, "xj", "res", tr) << "\n"
+      << "if (casadi_norm_inf(" << n << ", res)<=" << g.constant(tol) << "*rhs_norm) break;\n"
+      << "for (i=0; i<" << n << "; ++i) xl[i] = res[i];\n"
+      << solve_low << "\n"
+      << "for (i=0; i<" << n << "; ++i) xj[i] -= xl[i];\n"
+      << "}\n"
+      << "}\n"
+      << "}\n";
+  }
+
   std::map<std::string, LinsolInternal::Plugin> LinsolInternal::solvers_;
 
   const std::string LinsolInternal::infix_ = "linsol";
 
+  const casadi_int LinsolInternal::nrhs_blk = 8;
+
 } // namespace casadi
@@ -29,6 +29,9 @@
 #include "linsol.hpp"
 #include "function_internal.hpp"
 #include "plugin_interface.hpp"
+#include <functional>
+#include <memory>
+#include <unordered_map>
 
 /// \cond INTERNAL
 
@@ -38,8 +41,12 @@ namespace casadi {
     // Current state of factorization
     bool is_sfact, is_nfact;
 
+    // Nonzeros of the matrix of the current factorization, if recorded by nfact_cached
+    bool is_cached;
+    std::vector<double> A_cached;
+
     // Constructor
-    LinsolMemory() : is_sfact(false), is_nfact(false) {}
+    LinsolMemory() : is_sfact(false), is_nfact(false), is_cached(false) {}
   };
 
   /** Internal class
@@ -103,10 +110,56 @@ namespace casadi {
     /// Matrix rank
     virtual casadi_int rank(void* mem, const double* A) const;
 
+    /// Can factorizations and solves in different memory objects run in parallel?
+    virtual bool is_reentrant() const { return true;}
+
+    /// Number of right-hand sides per pass over the factors in blocked solves
+    static const casadi_int nrhs_blk;
+
+    /// Low-rank modification A + sigma*W*W' of the factorization, W dense n-by-k
+    virtual int update(void* mem, const double* W, casadi_int k, double sigma) const;
+
     /// Generate C code
     virtual void generate(CodeGenerator& g, const std::string& A, const std::string& x,
                           casadi_int nrhs, bool tr) const;
 
+    /** \brief Schedule a factorization over independent subtrees of the elimination tree
+        Column c of sp_deps lists the columns r<c needed to calculate column c, e.g.
+        the pattern of L^T for LDL^T and of R for QR. The columns are distributed over
+        groups ptr[i]..ptr[i+1]-1 of ind, each in increasing order. The first
+        ptr.size()-2 groups are independent of each other, the last group depends on
+        the others and is to be processed last.
+    */
+    static void etree_subtrees(const Sparsity& sp_deps, casadi_int n_threads,
+                               std::vector<casadi_int>& ptr, std::vector<casadi_int>& ind);
+
+    /** \brief Iterative refinement of a solution calculated in lower precision
+        solve_low overwrites a single right-hand side with the low-precision solution.
+        Each column of x is refined until the residual, calculated with A in double
+        precision, satisfies |A*x-b|_inf <= tol*|b|_inf or max_iter iterations have been
+        performed. len[b] >= nrow, len[r] >= nrow. Returns the largest number of iterations.
+    */
+    static casadi_int refine(const Sparsity& sp, const double* A, double* x, casadi_int nrhs,
+                             bool tr, const std::function<void(double*)>& solve_low,
+                             double* b, double* r, casadi_int max_iter, double tol);
+
+    /** \brief Generate C code for refine
+        solve_low is a statement solving in-place for the right-hand side in the local
+        array "xl" of type type */
+    static void generate_refine(CodeGenerator& g, const Sparsity& sp, const std::string& A,
+                                const std::string& x, casadi_int nrhs, bool tr,
+                                const std::string& type, const std::string& solve_low,
+                                casadi_int max_iter, double tol);
+
+    /** \brief Symbolic factorization shared between instances
+        Instances with equal sparsity pattern and equal key, encoding the options that
+        affect the symbolic analysis, share the same object. It is constructed on the
+        first request and released together with the last instance referencing it.
+    */
+    template<typename T>
+    static std::shared_ptr<const T> shared_symbolic(const Sparsity& sp, const std::string& key,
+                                                    const std::function<T()>& construct);
+
     // Creator function for internal class
     typedef LinsolInternal* (*Creator)(const std::string& name, const Sparsity& sp);
 
@@ -133,6 +186,43 @@ namespace casadi {
     Sparsity sp_;
   };
 
+  template<typename T>
+  std::shared_ptr<const T> LinsolInternal::shared_symbolic(const Sparsity& sp,
+      const std::string& key, const std::function<T()>& construct) {
+    // Weak references, indexed by the hash of the sparsity pattern
+    struct Entry {
+      Sparsity sp;
+      std::string key;
+      std::weak_ptr<const T> ref;
+    };
+    static std::unordered_multimap<std::size_t, Entry> cache;
+#ifdef CASADI_WITH_THREAD
+    static std::mutex mtx;
+    std::lock_guard<std::mutex> lock(mtx);
+#endif // CASADI_WITH_THREAD
+    // Cache hit?
+    std::size_t h = sp.hash();
+    auto eq = cache.equal_range(h);
+    for (auto it=eq.first; it!=eq.second; ++it) {
+      if (it->second.key==key && it->second.sp==sp) {
+        std::shared_ptr<const T> ret = it->second.ref.lock();
+        if (ret) return ret;
+      }
+    }
+    // Remove dead references, to prevent uncontrolled growth
+    for (auto it=cache.begin(); it!=cache.end();) {
+      if (it->second.ref.expired()) {
+        it = cache.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    // Symbolic factorization
+    std::shared_ptr<const T> ret = std::make_shared<T>(construct());
+    cache.insert(std::make_pair(h, Entry{sp, key, ret}));
+    return ret;
+  }
+
 } // namespace casadi
 /// \endcond
 
@@ -25,27 +25,40 @@
 
 #include "map.hpp"
 
-#ifdef CASADI_WITH_THREAD
-#ifdef CASADI_WITH_THREAD_MINGW
-#include <mingw.thread.h>
-#else // CASADI_WITH_THREAD_MINGW
-#include <thread>
-#endif // CASADI_WITH_THREAD_MINGW
-#endif // CASADI_WITH_THREAD
+#include <cstdlib>
+#include <limits>
+#include <memory>
+
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif // WITH_OPENMP
 
 using namespace std;
 
 namespace casadi {
 
-  Function Map::create(const std::string& parallelization, const Function& f, casadi_int n) {
+  Function Map::create(const std::string& parallelization, const Function& f, casadi_int n,
+                       const Dict& opts) {
     // Create instance of the right class
     string suffix = str(n) + "_" + f.name();
     if (parallelization == "serial") {
-      return Function::create(new Map("map" + suffix, f, n), Dict());
+      return Function::create(new Map("map" + suffix, f, n), opts);
     } else if (parallelization== "openmp") {
-      return Function::create(new OmpMap("ompmap" + suffix, f, n), Dict());
+      return Function::create(new OmpMap("ompmap" + suffix, f, n), opts);
     } else if (parallelization== "thread") {
-      return Function::create(new ThreadMap("threadmap" + suffix, f, n), Dict());
+      return Function::create(new ThreadMap("threadmap" + suffix, f, n), opts);
+    } else if (parallelization== "opencl") {
+#ifdef WITH_OPENCL
+      return Function::create(new OpenCLMap("openclmap" + suffix, f, n), opts);
+#else
+      casadi_error("Parallelization 'opencl' requires CasADi to be compiled WITH_OPENCL");
+#endif
+    } else if (parallelization== "mpi") {
+#ifdef WITH_MPI
+      return Function::create(new MpiMap("mpimap" + suffix, f, n), opts);
+#else
+      casadi_error("Parallelization 'mpi' requires CasADi to be compiled WITH_MPI");
+#endif
     } else {
       casadi_error("Unknown parallelization: " + parallelization);
     }
@@ -58,14 +71,91 @@ namespace casadi {
   Map::~Map() {
   }
 
+  ParallelMapSlot* Map::local_slot(ParallelMapMemory* m, casadi_int id) const {
+    if (id>=m->slots.size()) return nullptr;
+    ParallelMapSlot*& s = m->slots[id];
+    if (!s) {
+      // Allocated and zero-initialized here, i.e. first touched by this thread
+      size_t sz_arg, sz_res, sz_iw, sz_w;
+      f_.sz_work(sz_arg, sz_res, sz_iw, sz_w);
+      s = new ParallelMapSlot();
+      s->mem = f_.checkout();
+      s->arg.resize(sz_arg);
+      s->res.resize(sz_res);
+      s->iw.resize(sz_iw);
+      s->w.resize(sz_w);
+    }
+    return s;
+  }
+
+  void Map::free_slots(ParallelMapMemory* m) const {
+    for (ParallelMapSlot* s : m->slots) {
+      if (s) {
+        f_.release(s->mem);
+        delete s;
+      }
+    }
+    delete m;
+  }
+
+  Options Map::options_
+  = {{&FunctionInternal::options_},
+     {{"schedule",
+       {OT_STRING,
+        "Scheduling of the iterations for parallel evaluation: "
+        "'static' (default) assigns an equal share of the iterations to each thread, "
+        "'dynamic' lets idle threads claim chunks of 'chunk_size' iterations, "
+        "which balances the load when the cost per iteration varies. "
+        "Ignored for serial evaluation."}},
+      {"chunk_size",
+       {OT_INT,
+        "Number of iterations per chunk for dynamic scheduling [default: 1]"}},
+      {"batch_size",
+       {OT_INT,
+        "Serial evaluation only: number of iterations evaluated at once, instruction by "
+        "instruction, if the mapped function supports it (SXFunction). "
+        "Requires batch_size times the work vector of the function. "
+        "[default: 1, all iterations for Callbacks with eval_batch]"}}
+     }
+  };
+
   void Map::init(const Dict& opts) {
     // Call the initialization method of the base class
     FunctionInternal::init(opts);
 
+    // Default options
+    dynamic_ = false;
+    chunk_size_ = 1;
+    batch_size_ = f_->prefer_eval_batch() ? n_ : 1;
+
+    // Read options
+    for (auto&& op : opts) {
+      if (op.first=="schedule") {
+        string schedule = op.second;
+        if (schedule=="static") {
+          dynamic_ = false;
+        } else if (schedule=="dynamic") {
+          dynamic_ = true;
+        } else {
+          casadi_error("Unknown schedule: '" + schedule + "'. Use 'static' or 'dynamic'");
+        }
+      } else if (op.first=="chunk_size") {
+        chunk_size_ = op.second;
+      } else if (op.first=="batch_size") {
+        batch_size_ = op.second;
+      }
+    }
+    casadi_assert(chunk_size_>=1, "Option 'chunk_size' must be positive");
+    casadi_assert(batch_size_>=1, "Option 'batch_size' must be positive");
+
+    // Batched evaluation only for serial maps of functions that support it
+    if (parallelization()!="serial" || !f_->has_eval_batch()) batch_size_ = 1;
+    batch_size_ = std::min(batch_size_, n_);
+
     // Allocate sufficient memory for serial evaluation
     alloc_arg(f_.sz_arg());
     alloc_res(f_.sz_res());
-    alloc_w(f_.sz_w());
+    alloc_w(f_.sz_w() * batch_size_);
     alloc_iw(f_.sz_iw());
   }
 
@@ -113,11 +203,49 @@ namespace casadi {
     return 0;
   }
 
+  Dict Map::map_options() const {
+    Dict ret;
+    if (dynamic_) {
+      ret["schedule"] = "dynamic";
+      ret["chunk_size"] = chunk_size_;
+    }
+    if (batch_size_>1) ret["batch_size"] = batch_size_;
+    return ret;
+  }
+
   void Map::codegen_declarations(CodeGenerator& g) const {
-    g.add_dependency(f_);
+    // Batched evaluation is generated inline
+    if (batch_size_==1) g.add_dependency(f_);
+  }
+
+  Dict Map::codegen_footprint(const CodeGenerator& g) const {
+    Dict r = FunctionInternal::codegen_footprint(g);
+    r["calls"] = std::vector<std::string>{f_.name()};
+    r["n_call"] = n_;
+    return r;
   }
 
   void Map::codegen_body(CodeGenerator& g) const {
+    if (batch_size_>1) {
+      // Batched evaluation, batch_size_ iterations at a time
+      g << "casadi_int i, k, nb;\n"
+        << "const casadi_real** arg1 = arg+" << n_in_ << ";\n"
+        << "casadi_real** res1 = res+" << n_out_ << ";\n"
+        << "for (i=0; i<" << n_ << "; i+=" << batch_size_ << ") {\n"
+        << "nb = " << n_ << "-i;\n"
+        << "if (nb>" << batch_size_ << ") nb=" << batch_size_ << ";\n";
+      for (casadi_int j=0; j<n_in_; ++j) {
+        g << "arg1[" << j << "] = arg[" << j << "] ? arg[" << j << "]+i*"
+          << f_.nnz_in(j) << " : 0;\n";
+      }
+      for (casadi_int j=0; j<n_out_; ++j) {
+        g << "res1[" << j << "] = res[" << j << "] ? res[" << j << "]+i*"
+          << f_.nnz_out(j) << " : 0;\n";
+      }
+      f_->codegen_body_batch(g, batch_size_, "nb", "arg1", "res1", "w");
+      g << "}\n";
+      return;
+    }
     g << "casadi_int i;\n";
     g << "const casadi_real** arg1;\n";
     g << "casadi_real** res1;\n";
@@ -148,7 +276,7 @@ namespace casadi {
                 const Dict& opts) const {
     // Generate map of derivative
     Function df = f_.forward(nfwd);
-    Function dm = df.map(n_, parallelization());
+    Function dm = df->map(n_, parallelization(), map_options());
 
     // Input expressions
     vector<MX> arg = dm.mx_in();
@@ -199,7 +327,7 @@ namespace casadi {
                 const Dict& opts) const {
     // Generate map of derivative
     Function df = f_.reverse(nadj);
-    Function dm = df.map(n_, parallelization());
+    Function dm = df->map(n_, parallelization(), map_options());
 
     // Input expressions
     vector<MX> arg = dm.mx_in();
@@ -248,48 +376,141 @@ namespace casadi {
     // Could also use the thread-safe variant f_(arg1, res1, iw, w)
     // in Map::eval_gen
     scoped_checkout<Function> m(f_);
-    return eval_gen(arg, res, iw, w, m);
+    if (batch_size_==1) return eval_gen(arg, res, iw, w, m);
+
+    // Batched evaluation, batch_size_ iterations at a time
+    const double** arg1 = arg+n_in_;
+    double** res1 = res+n_out_;
+    for (casadi_int i=0; i<n_; i+=batch_size_) {
+      for (casadi_int j=0; j<n_in_; ++j) {
+        arg1[j] = arg[j] ? arg[j] + i*f_.nnz_in(j) : nullptr;
+      }
+      for (casadi_int j=0; j<n_out_; ++j) {
+        res1[j] = res[j] ? res[j] + i*f_.nnz_out(j) : nullptr;
+      }
+      casadi_int nb = std::min(batch_size_, n_-i);
+      if (f_->eval_batch(arg1, res1, iw, w, f_->memory(m), nb)) return 1;
+    }
+    return 0;
   }
 
   OmpMap::~OmpMap() {
+    clear_mem();
+  }
+
+  int OmpMap::init_mem(void* mem) const {
+#ifdef WITH_OPENMP
+    auto m = static_cast<ParallelMapMemory*>(mem);
+    m->slots.resize(omp_get_max_threads(), nullptr);
+#endif // WITH_OPENMP
+    return 0;
   }
 
   int OmpMap::eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const {
 #ifndef WITH_OPENMP
     return Map::eval(arg, res, iw, w, mem);
 #else // WITH_OPENMP
+    auto m = static_cast<ParallelMapMemory*>(mem);
     size_t sz_arg, sz_res, sz_iw, sz_w;
     f_.sz_work(sz_arg, sz_res, sz_iw, sz_w);
 
     // Error flag
     casadi_int flag = 0;
 
-    // Checkout memory objects
-    std::vector< scoped_checkout<Function> > ind; ind.reserve(n_);
-    for (casadi_int i=0; i<n_; ++i) ind.emplace_back(f_);
+    // Evaluate iteration i
+    auto work = [&](casadi_int i) -> casadi_int {
+      // Buffers of this OpenMP thread, kept between calls
+      ParallelMapSlot* s = local_slot(m, omp_get_thread_num());
+      if (!s) {
+        // Otherwise, the work vectors of iteration i and a memory object
+        scoped_checkout<Function> ind(f_);
+        const double** arg1 = arg + n_in_ + i*sz_arg;
+        for (casadi_int j=0; j<n_in_; ++j) {
+          arg1[j] = arg[j] ? arg[j] + i*f_.nnz_in(j) : 0;
+        }
+        double** res1 = res + n_out_ + i*sz_res;
+        for (casadi_int j=0; j<n_out_; ++j) {
+          res1[j] = res[j] ? res[j] + i*f_.nnz_out(j) : 0;
+        }
+        return f_(arg1, res1, iw + i*sz_iw, w + i*sz_w, ind);
+      }
+      for (casadi_int j=0; j<n_in_; ++j) {
+        s->arg[j] = arg[j] ? arg[j] + i*f_.nnz_in(j) : 0;
+      }
+      for (casadi_int j=0; j<n_out_; ++j) {
+        s->res[j] = res[j] ? res[j] + i*f_.nnz_out(j) : 0;
+      }
+      return f_(get_ptr(s->arg), get_ptr(s->res), get_ptr(s->iw), get_ptr(s->w), s->mem);
+    };
 
     // Evaluate in parallel
+    if (dynamic_) {
+      casadi_int chunk_size = chunk_size_;
+#pragma omp parallel for schedule(dynamic, chunk_size) reduction(||:flag)
+      for (casadi_int i=0; i<n_; ++i) flag = work(i) || flag;
+    } else {
 #pragma omp parallel for reduction(||:flag)
-    for (casadi_int i=0; i<n_; ++i) {
-      // Input buffers
-      const double** arg1 = arg + n_in_ + i*sz_arg;
+      for (casadi_int i=0; i<n_; ++i) flag = work(i) || flag;
+    }
+
+    // Return error flag
+    return flag;
+#endif  // WITH_OPENMP
+  }
+
+  template<typename T1, typename T2>
+  int OmpMap::sp_gen(T1** arg, T2** res, casadi_int* iw, bvec_t* w) const {
+    size_t sz_arg, sz_res, sz_iw, sz_w;
+    f_.sz_work(sz_arg, sz_res, sz_iw, sz_w);
+
+    // Propagate iteration i
+    auto work = [&](casadi_int i) -> casadi_int {
+      T1** arg1 = arg + n_in_ + i*sz_arg;
       for (casadi_int j=0; j<n_in_; ++j) {
         arg1[j] = arg[j] ? arg[j] + i*f_.nnz_in(j) : 0;
       }
-
-      // Output buffers
-      double** res1 = res + n_out_ + i*sz_res;
+      T2** res1 = res + n_out_ + i*sz_res;
       for (casadi_int j=0; j<n_out_; ++j) {
         res1[j] = res[j] ? res[j] + i*f_.nnz_out(j) : 0;
       }
+      return sp_call(arg1, res1, iw + i*sz_iw, w + i*sz_w);
+    };
 
-      // Evaluation
-      flag = f_(arg1, res1, iw + i*sz_iw, w + i*sz_w, ind[i]) || flag;
+    // The first iteration is propagated serially, so that sparsity patterns
+    // that f computes lazily are available before the parallel sweep
+    casadi_int flag = work(0);
+    if (flag) return 1;
+#ifdef WITH_OPENMP
+    if (dynamic_) {
+      casadi_int chunk_size = chunk_size_;
+#pragma omp parallel for schedule(dynamic, chunk_size) reduction(||:flag)
+      for (casadi_int i=1; i<n_; ++i) flag = work(i) || flag;
+    } else {
+#pragma omp parallel for reduction(||:flag)
+      for (casadi_int i=1; i<n_; ++i) flag = work(i) || flag;
     }
-
-    // Return error flag
+#else // WITH_OPENMP
+    for (casadi_int i=1; i<n_; ++i) flag = work(i) || flag;
+#endif // WITH_OPENMP
     return flag;
-#endif  // WITH_OPENMP
+  }
+
+  int OmpMap::sp_call(const bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w) const {
+    return f_(arg, res, iw, w);
+  }
+
+  int OmpMap::sp_call(bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w) const {
+    return f_.rev(arg, res, iw, w);
+  }
+
+  int OmpMap::sp_forward(const bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w, void* mem) const {
+    return sp_gen(arg, res, iw, w);
+  }
+
+  int OmpMap::sp_reverse(bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w, void* mem) const {
+    return sp_gen(arg, res, iw, w);
   }
 
   void OmpMap::codegen_body(CodeGenerator& g) const {
@@ -299,7 +520,9 @@ namespace casadi {
       << "const double** arg1;\n"
       << "double** res1;\n"
       << "casadi_int flag = 0;\n"
-      << "#pragma omp parallel for private(i,arg1,res1) reduction(||:flag)\n"
+      << "#pragma omp parallel for private(i,arg1,res1) reduction(||:flag)";
+    if (dynamic_) g << " schedule(dynamic, " << chunk_size_ << ")";
+    g << "\n"
       << "for (i=0; i<" << n_ << "; ++i) {\n"
       << "arg1 = arg + " << n_in_ << "+i*" << sz_arg << ";\n";
     for (casadi_int j=0; j<n_in_; ++j) {
@@ -332,93 +555,514 @@ namespace casadi {
   }
 
 
+  Options ThreadMap::options_
+  = {{&Map::options_},
+     {{"max_num_threads",
+       {OT_INT,
+        "Maximum number of threads used for the evaluation, including the calling thread. "
+        "The iterations are distributed evenly over the threads. "
+        "Default: the number of hardware threads."}}
+     }
+  };
+
   ThreadMap::~ThreadMap() {
+    clear_mem();
+  }
+
+  int ThreadMap::init_mem(void* mem) const {
+    auto m = static_cast<ParallelMapMemory*>(mem);
+    // Pool threads, including the ones this map may start, and the calling thread
+    casadi_int n = std::max(n_threads_, ThreadPool::hardware_concurrency());
+    m->slots.resize(n+1, nullptr);
+    return 0;
+  }
+
+  Dict ThreadMap::info() const {
+    Dict ret = {{"f", f_}, {"n", n_}, {"max_num_threads", max_num_threads_}};
+    ret["schedule"] = dynamic_ ? "dynamic" : "static";
+    ret["chunk_size"] = chunk_size_;
+    return ret;
+  }
+
+  Dict ThreadMap::map_options() const {
+    Dict ret = Map::map_options();
+    ret["max_num_threads"] = max_num_threads_;
+    return ret;
+  }
+
+  int ThreadMap::parallel(casadi_int i_begin,
+      const std::function<int(casadi_int, casadi_int, casadi_int)>& work) const {
+    // Checkout one memory object per thread
+    std::vector< scoped_checkout<Function> > ind; ind.reserve(n_threads_);
+    for (casadi_int k=0; k<n_threads_; ++k) ind.emplace_back(f_);
+
+    // Return values per thread
+    std::vector<int> ret_values(n_threads_, 0);
+
+    // Evaluate iterations [i0, i1) using the work vectors of thread t
+    dispatch(i_begin, [&](casadi_int i0, casadi_int i1, casadi_int t) {
+      for (casadi_int i=i0; i<i1; ++i) {
+        if (work(i, t, ind[t])) ret_values[t] = 1;
+      }
+    });
+
+    // Compute aggregate return value
+    int ret = 0;
+    for (int e : ret_values) ret = ret || e;
+    return ret;
+  }
+
+  void ThreadMap::dispatch(casadi_int i_begin,
+      const std::function<void(casadi_int, casadi_int, casadi_int)>& range) const {
+    casadi_int n = n_ - i_begin;
+    if (dynamic_) {
+      // Idle threads claim the next chunk of chunk_size_ iterations
+      casadi_int n_chunks = (n + chunk_size_ - 1) / chunk_size_;
+      ThreadPool::run(n_chunks, n_threads_, [&](casadi_int k, casadi_int t) {
+        range(i_begin + k*chunk_size_, i_begin + std::min((k+1)*chunk_size_, n), t);
+      });
+    } else {
+      // One contiguous chunk per thread
+      ThreadPool::run(n_threads_, n_threads_, [&](casadi_int k, casadi_int t) {
+        range(i_begin + (k*n)/n_threads_, i_begin + ((k+1)*n)/n_threads_, t);
+      });
+    }
+  }
+
+  int ThreadMap::eval(const double** arg, double** res, casadi_int* iw, double* w,
+      void* mem) const {
+    auto m = static_cast<ParallelMapMemory*>(mem);
+
+    // Function work sizes
+    size_t sz_arg, sz_res, sz_iw, sz_w;
+    f_.sz_work(sz_arg, sz_res, sz_iw, sz_w);
+
+    // Return values per thread
+    std::vector<int> ret_values(n_threads_, 0);
+
+    // Evaluate iterations [i0, i1) in thread t
+    dispatch(0, [&](casadi_int i0, casadi_int i1, casadi_int t) {
+      // Buffers of this thread, kept between calls
+      ParallelMapSlot* s = local_slot(m, ThreadPool::worker_id());
+      const double** arg1 = s ? get_ptr(s->arg) : arg + n_in_ + t*sz_arg;
+      double** res1 = s ? get_ptr(s->res) : res + n_out_ + t*sz_res;
+      casadi_int* iw1 = s ? get_ptr(s->iw) : iw + t*sz_iw;
+      double* w1 = s ? get_ptr(s->w) : w + t*sz_w;
+      // Otherwise, the work vectors of the call and a memory object for this chunk
+      std::unique_ptr<scoped_checkout<Function>> ind;
+      if (!s) ind.reset(new scoped_checkout<Function>(f_));
+      casadi_int mem1 = s ? s->mem : static_cast<casadi_int>(*ind);
+      for (casadi_int i=i0; i<i1; ++i) {
+        for (casadi_int j=0; j<n_in_; ++j) {
+          arg1[j] = arg[j] ? arg[j] + i*f_.nnz_in(j) : nullptr;
+        }
+        for (casadi_int j=0; j<n_out_; ++j) {
+          res1[j] = res[j] ? res[j] + i*f_.nnz_out(j) : nullptr;
+        }
+        if (f_(arg1, res1, iw1, w1, mem1)) ret_values[t] = 1;
+      }
+    });
+
+    // Compute aggregate return value
+    int ret = 0;
+    for (int e : ret_values) ret = ret || e;
+    return ret;
   }
 
-  void ThreadsWork(const Function& f, casadi_int i,
-      const double** arg, double** res,
-      casadi_int* iw, double* w,
-      casadi_int ind, int& ret) {
+  int ThreadMap::sp_forward(const bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w, void* mem) const {
+    // Function work sizes
+    size_t sz_arg, sz_res, sz_iw, sz_w;
+    f_.sz_work(sz_arg, sz_res, sz_iw, sz_w);
 
-    // Function dimensions
-    casadi_int n_in = f.n_in();
-    casadi_int n_out = f.n_out();
+    // Propagate iteration i using the work vectors of thread t
+    auto work = [&](casadi_int i, casadi_int t, casadi_int m) {
+      const bvec_t** arg1 = arg + n_in_ + t*sz_arg;
+      for (casadi_int j=0; j<n_in_; ++j) {
+        arg1[j] = arg[j] ? arg[j] + i*f_.nnz_in(j) : nullptr;
+      }
+      bvec_t** res1 = res + n_out_ + t*sz_res;
+      for (casadi_int j=0; j<n_out_; ++j) {
+        res1[j] = res[j] ? res[j] + i*f_.nnz_out(j) : nullptr;
+      }
+      return f_(arg1, res1, iw + t*sz_iw, w + t*sz_w, m);
+    };
 
+    // The first iteration is propagated serially, so that sparsity patterns
+    // that f computes lazily are available before the parallel sweep
+    if (work(0, 0, 0)) return 1;
+    return parallel(1, work);
+  }
+
+  int ThreadMap::sp_reverse(bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w, void* mem) const {
     // Function work sizes
     size_t sz_arg, sz_res, sz_iw, sz_w;
-    f.sz_work(sz_arg, sz_res, sz_iw, sz_w);
+    f_.sz_work(sz_arg, sz_res, sz_iw, sz_w);
+
+    // Propagate iteration i using the work vectors of thread t
+    auto work = [&](casadi_int i, casadi_int t, casadi_int m) {
+      bvec_t** arg1 = arg + n_in_ + t*sz_arg;
+      for (casadi_int j=0; j<n_in_; ++j) {
+        arg1[j] = arg[j] ? arg[j] + i*f_.nnz_in(j) : nullptr;
+      }
+      bvec_t** res1 = res + n_out_ + t*sz_res;
+      for (casadi_int j=0; j<n_out_; ++j) {
+        res1[j] = res[j] ? res[j] + i*f_.nnz_out(j) : nullptr;
+      }
+      return f_.rev(arg1, res1, iw + t*sz_iw, w + t*sz_w, m);
+    };
+
+    // Cf. ThreadMap::sp_forward
+    if (work(0, 0, 0)) return 1;
+    return parallel(1, work);
+  }
+
+  void ThreadMap::codegen_body(CodeGenerator& g) const {
+    if (n_threads_==1) return Map::codegen_body(g);
+    size_t sz_arg, sz_res, sz_iw, sz_w;
+    f_.sz_work(sz_arg, sz_res, sz_iw, sz_w);
+    // One contiguous chunk of iterations per thread, cf. ThreadMap::parallel
+    g << "casadi_int t, i, flag = 0;\n"
+      << "const casadi_real** arg1;\n"
+      << "casadi_real** res1;\n"
+      << "#pragma omp parallel for private(i,arg1,res1) reduction(||:flag)\n"
+      << "for (t=0; t<" << n_threads_ << "; ++t) {\n"
+      << "arg1 = arg + " << n_in_ << "+t*" << sz_arg << ";\n"
+      << "res1 = res + " << n_out_ << "+t*" << sz_res << ";\n"
+      << "for (i=(t*" << n_ << ")/" << n_threads_ << "; i<((t+1)*" << n_ << ")/"
+      << n_threads_ << "; ++i) {\n";
+    for (casadi_int j=0; j<n_in_; ++j) {
+      g << "arg1[" << j << "] = arg[" << j << "] ? "
+        << "arg[" << j << "]+i*" << f_.nnz_in(j) << " : 0;\n";
+    }
+    for (casadi_int j=0; j<n_out_; ++j) {
+      g << "res1[" << j << "] = res[" << j << "] ? "
+        << "res[" << j << "]+i*" << f_.nnz_out(j) << " : 0;\n";
+    }
+    g << "flag = "
+      << g(f_, "arg1", "res1", "iw+t*" + str(sz_iw), "w+t*" + str(sz_w)) << " || flag;\n"
+      << "}\n"
+      << "}\n"
+      << "if (flag) return 1;\n";
+  }
 
-    // Input buffers
-    const double** arg1 = arg + n_in + i*sz_arg;
-    for (casadi_int j=0; j<n_in; ++j) {
-      arg1[j] = arg[j] ? arg[j] + i*f.nnz_in(j) : nullptr;
+  void ThreadMap::init(const Dict& opts) {
+    // Call the initialization method of the base class
+    Map::init(opts);
+
+    // Default options
+    max_num_threads_ = ThreadPool::hardware_concurrency();
+
+    // Read options
+    for (auto&& op : opts) {
+      if (op.first=="max_num_threads") {
+        max_num_threads_ = op.second;
+      }
     }
+    casadi_assert(max_num_threads_>=1, "Option 'max_num_threads' must be positive");
+
+    // No more threads than iterations
+    n_threads_ = std::min(max_num_threads_, n_);
+
+    // Allocate sufficient memory for parallel evaluation
+    alloc_arg(f_.sz_arg() * n_threads_);
+    alloc_res(f_.sz_res() * n_threads_);
+    alloc_w(f_.sz_w() * n_threads_);
+    alloc_iw(f_.sz_iw() * n_threads_);
+  }
 
-    // Output buffers
-    double** res1 = res + n_out + i*sz_res;
-    for (casadi_int j=0; j<n_out; ++j) {
-      res1[j] = res[j] ? res[j] + i*f.nnz_out(j) : nullptr;
+#ifdef WITH_OPENCL
+  namespace {
+    // Raise an error with the OpenCL error code
+    void cl_check(cl_int err, const std::string& what) {
+      casadi_assert(err==CL_SUCCESS, what + " failed with OpenCL error " + str(err));
     }
+  } // namespace
 
-    ret = f(arg1, res1, iw + i*sz_iw, w + i*sz_w, ind);
+  Options OpenCLMap::options_
+  = {{&Map::options_},
+     {{"platform",
+       {OT_INT,
+        "Index of the OpenCL platform [default: 0]"}},
+      {"device",
+       {OT_INT,
+        "Index of the device on the platform [default: 0]"}}
+     }
+  };
+
+  Dict OpenCLMap::info() const {
+    return {{"f", f_}, {"n", n_}, {"platform", platform_}, {"device", device_},
+            {"source", source_}};
   }
 
-  int ThreadMap::eval(const double** arg, double** res, casadi_int* iw, double* w,
-      void* mem) const {
+  OpenCLMap::~OpenCLMap() {
+    clear_mem();
+    if (program_) clReleaseProgram(program_);
+    if (context_) clReleaseContext(context_);
+  }
 
-#ifndef CASADI_WITH_THREAD
-    return Map::eval(arg, res, iw, w, mem);
-#else // CASADI_WITH_THREAD
-    // Checkout memory objects
-    std::vector< scoped_checkout<Function> > ind; ind.reserve(n_);
-    for (casadi_int i=0; i<n_; ++i) ind.emplace_back(f_);
+  void OpenCLMap::init(const Dict& opts) {
+    // Call the initialization method of the base class
+    Map::init(opts);
 
-    // Allocate space for return values
-    std::vector<int> ret_values(n_);
+    // Default options
+    platform_ = 0;
+    device_ = 0;
 
-    // Spawn threads
-    std::vector<std::thread> threads;
-    for (casadi_int i=0; i<n_; ++i) {
-      // Why the lambda function?
-      // Because it was the first iteration to pass tests on MingGW
-      // using mingw-std-threads.
-      threads.emplace_back(
-        [i](const Function& f, const double** arg, double** res,
-            casadi_int* iw, double* w, casadi_int ind, int& ret) {
-              ThreadsWork(f, i, arg, res, iw, w, ind, ret);
-            },
-        std::ref(f_), arg, res, iw, w, casadi_int(ind[i]), std::ref(ret_values[i]));
+    // Read options
+    for (auto&& op : opts) {
+      if (op.first=="platform") {
+        platform_ = op.second;
+      } else if (op.first=="device") {
+        device_ = op.second;
+      }
     }
+    casadi_assert(f_.is_a("SXFunction"),
+                  "Parallelization 'opencl' requires an SXFunction, got " + f_.class_name());
 
-    // Join threads
-    for (auto && th : threads) th.join();
+    // Generate the kernel
+    std::stringstream ss;
+    f_->export_code("opencl", ss, {{"kernel_name", "casadi_kernel"}});
+    source_ = ss.str();
 
-    // Anticipate success
-    int ret = 0;
+    // Select the device
+    cl_uint n_platforms, n_devices;
+    cl_check(clGetPlatformIDs(0, nullptr, &n_platforms), "clGetPlatformIDs");
+    casadi_assert(platform_>=0 && platform_<n_platforms,
+                  "OpenCL platform " + str(platform_) + " not available, "
+                  + str(n_platforms) + " platforms found");
+    std::vector<cl_platform_id> platforms(n_platforms);
+    cl_check(clGetPlatformIDs(n_platforms, get_ptr(platforms), nullptr), "clGetPlatformIDs");
+    cl_check(clGetDeviceIDs(platforms[platform_], CL_DEVICE_TYPE_ALL, 0, nullptr, &n_devices),
+             "clGetDeviceIDs");
+    casadi_assert(device_>=0 && device_<n_devices,
+                  "OpenCL device " + str(device_) + " not available, "
+                  + str(n_devices) + " devices found");
+    std::vector<cl_device_id> devices(n_devices);
+    cl_check(clGetDeviceIDs(platforms[platform_], CL_DEVICE_TYPE_ALL, n_devices,
+                            get_ptr(devices), nullptr), "clGetDeviceIDs");
+    device_id_ = devices[device_];
 
-    // Compute aggregate return value
-    for (int e : ret_values) ret = ret || e;
+    // Create the context and build the program
+    cl_int err;
+    context_ = clCreateContext(nullptr, 1, &device_id_, nullptr, nullptr, &err);
+    cl_check(err, "clCreateContext");
+    const char* src = source_.c_str();
+    program_ = clCreateProgramWithSource(context_, 1, &src, nullptr, &err);
+    cl_check(err, "clCreateProgramWithSource");
+    if (clBuildProgram(program_, 1, &device_id_, nullptr, nullptr, nullptr)!=CL_SUCCESS) {
+      size_t sz;
+      clGetProgramBuildInfo(program_, device_id_, CL_PROGRAM_BUILD_LOG, 0, nullptr, &sz);
+      std::vector<char> log(sz+1, 0);
+      clGetProgramBuildInfo(program_, device_id_, CL_PROGRAM_BUILD_LOG, sz, get_ptr(log), nullptr);
+      casadi_error("Building the OpenCL kernel failed:\n" + std::string(get_ptr(log)));
+    }
+  }
 
+  int OpenCLMap::init_mem(void* mem) const {
+    auto m = static_cast<OpenCLMapMemory*>(mem);
+    cl_int err;
+    m->queue = clCreateCommandQueue(context_, device_id_, 0, &err);
+    if (err!=CL_SUCCESS) return 1;
+    m->kernel = clCreateKernel(program_, "casadi_kernel", &err);
+    if (err!=CL_SUCCESS) return 1;
+
+    // Device buffers holding all iterations
+    m->in.resize(n_in_);
+    for (casadi_int j=0; j<n_in_; ++j) {
+      m->in[j] = clCreateBuffer(context_, CL_MEM_READ_ONLY,
+                                sizeof(double)*std::max(f_.nnz_in(j)*n_, casadi_int(1)),
+                                nullptr, &err);
+      if (err!=CL_SUCCESS) return 1;
+    }
+    m->out.resize(n_out_);
+    for (casadi_int j=0; j<n_out_; ++j) {
+      m->out[j] = clCreateBuffer(context_, CL_MEM_WRITE_ONLY,
+                                 sizeof(double)*std::max(f_.nnz_out(j)*n_, casadi_int(1)),
+                                 nullptr, &err);
+      if (err!=CL_SUCCESS) return 1;
+    }
+    return 0;
+  }
+
+  void OpenCLMap::free_mem(void *mem) const {
+    auto m = static_cast<OpenCLMapMemory*>(mem);
+    for (cl_mem b : m->in) if (b) clReleaseMemObject(b);
+    for (cl_mem b : m->out) if (b) clReleaseMemObject(b);
+    if (m->kernel) clReleaseKernel(m->kernel);
+    if (m->queue) clReleaseCommandQueue(m->queue);
+    delete m;
+  }
+
+  int OpenCLMap::eval(const double** arg, double** res, casadi_int* iw, double* w,
+      void* mem) const {
+    auto m = static_cast<OpenCLMapMemory*>(mem);
+    // Arguments: number of iterations, then a buffer (or null) per input and output
+    cl_long n = n_;
+    cl_mem null_buffer = nullptr;
+    if (clSetKernelArg(m->kernel, 0, sizeof(cl_long), &n)!=CL_SUCCESS) return 1;
+    for (casadi_int j=0; j<n_in_; ++j) {
+      bool has_arg = arg[j] && f_.nnz_in(j)>0;
+      if (has_arg && clEnqueueWriteBuffer(m->queue, m->in[j], CL_FALSE, 0,
+                                          sizeof(double)*f_.nnz_in(j)*n_, arg[j],
+                                          0, nullptr, nullptr)!=CL_SUCCESS) return 1;
+      if (clSetKernelArg(m->kernel, 1+j, sizeof(cl_mem),
+                         has_arg ? &m->in[j] : &null_buffer)!=CL_SUCCESS) return 1;
+    }
+    for (casadi_int j=0; j<n_out_; ++j) {
+      bool has_res = res[j] && f_.nnz_out(j)>0;
+      if (clSetKernelArg(m->kernel, 1+n_in_+j, sizeof(cl_mem),
+                         has_res ? &m->out[j] : &null_buffer)!=CL_SUCCESS) return 1;
+    }
+
+    // One work item per iteration
+    size_t global_size = n_;
+    if (clEnqueueNDRangeKernel(m->queue, m->kernel, 1, nullptr, &global_size, nullptr,
+                               0, nullptr, nullptr)!=CL_SUCCESS) return 1;
+
+    // Read back the outputs, in order after the kernel
+    for (casadi_int j=0; j<n_out_; ++j) {
+      if (res[j] && f_.nnz_out(j)>0) {
+        if (clEnqueueReadBuffer(m->queue, m->out[j], CL_FALSE, 0,
+                                sizeof(double)*f_.nnz_out(j)*n_, res[j],
+                                0, nullptr, nullptr)!=CL_SUCCESS) return 1;
+      }
+    }
+    return clFinish(m->queue)==CL_SUCCESS ? 0 : 1;
+  }
+#endif // WITH_OPENCL
+
+#ifdef WITH_MPI
+  Options MpiMap::options_
+  = {{&Map::options_},
+     {{"local_parallelization",
+       {OT_STRING,
+        "Parallelization of the iterations evaluated by each rank: "
+        "serial|openmp|thread [default: serial]"}}
+     }
+  };
+
+  Dict MpiMap::info() const {
+    return {{"f", f_}, {"n", n_}, {"local_parallelization", local_parallelization_},
+            {"rank", rank_}, {"size", size_}, {"count", count_}};
+  }
+
+  Dict MpiMap::map_options() const {
+    Dict ret = Map::map_options();
+    ret["local_parallelization"] = local_parallelization_;
     return ret;
-#endif // CASADI_WITH_THREAD
   }
 
-  void ThreadMap::codegen_body(CodeGenerator& g) const {
-    Map::codegen_body(g);
+  MpiMap::~MpiMap() {
   }
 
-  void ThreadMap::init(const Dict& opts) {
+  void MpiMap::init(const Dict& opts) {
     // Call the initialization method of the base class
     Map::init(opts);
 
-    // Allocate memory for holding memory object references
-    alloc_iw(n_, true);
+    // Default options
+    local_parallelization_ = "serial";
 
-    // Allocate sufficient memory for parallel evaluation
-    alloc_arg(f_.sz_arg() * n_);
-    alloc_res(f_.sz_res() * n_);
-    alloc_w(f_.sz_w() * n_);
-    alloc_iw(f_.sz_iw() * n_);
+    // Read options
+    for (auto&& op : opts) {
+      if (op.first=="local_parallelization") {
+        local_parallelization_ = op.second.to_string();
+      }
+    }
+    casadi_assert(local_parallelization_=="serial" || local_parallelization_=="openmp"
+                  || local_parallelization_=="thread",
+                  "Unsupported local parallelization: '" + local_parallelization_ + "'");
+
+    // Initialize MPI, if not already done by the caller
+    int initialized;
+    MPI_Initialized(&initialized);
+    if (!initialized) {
+      MPI_Init(nullptr, nullptr);
+      std::atexit([]() {
+        int finalized;
+        MPI_Finalized(&finalized);
+        if (!finalized) MPI_Finalize();
+      });
+    }
+    MPI_Comm_size(MPI_COMM_WORLD, &size_);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank_);
+
+    // Contiguous blocks of iterations, as equal as possible
+    count_.resize(size_);
+    for (int r=0; r<size_; ++r) count_[r] = n_/size_ + (r < n_%size_ ? 1 : 0);
+    auto layout = [&](casadi_int nnz, std::vector<int>& count, std::vector<int>& offset) {
+      count.resize(size_);
+      offset.resize(size_);
+      casadi_int k = 0;
+      for (int r=0; r<size_; ++r) {
+        casadi_assert(k + count_[r]*nnz <= std::numeric_limits<int>::max(),
+                      "Map too large for MPI, counts must fit into int");
+        count[r] = count_[r]*nnz;
+        offset[r] = k;
+        k += count[r];
+      }
+    };
+    in_count_.resize(n_in_);
+    in_offset_.resize(n_in_);
+    for (casadi_int j=0; j<n_in_; ++j) layout(f_.nnz_in(j), in_count_[j], in_offset_[j]);
+    out_count_.resize(n_out_);
+    out_offset_.resize(n_out_);
+    for (casadi_int j=0; j<n_out_; ++j) layout(f_.nnz_out(j), out_count_[j], out_offset_[j]);
+
+    // Local map
+    casadi_int n_local = count_[rank_], sz_w = 0;
+    if (n_local>0) {
+      local_ = f_.map(n_local, local_parallelization_);
+      alloc_arg(local_.sz_arg());
+      alloc_res(local_.sz_res());
+      alloc_iw(local_.sz_iw());
+      sz_w = local_.sz_w();
+    }
+
+    // Local blocks of the inputs and outputs, followed by the work vector of the local map
+    alloc_w(n_local*(f_.nnz_in() + f_.nnz_out()) + sz_w);
+  }
+
+  int MpiMap::eval(const double** arg, double** res, casadi_int* iw, double* w,
+      void* mem) const {
+    const double** arg1 = arg+n_in_;
+    double** res1 = res+n_out_;
+
+    // Scatter the inputs of rank 0
+    for (casadi_int j=0; j<n_in_; ++j) {
+      arg1[j] = nullptr;
+      if (arg[j]==nullptr || f_.nnz_in(j)==0) continue;
+      MPI_Scatterv(arg[j], get_ptr(in_count_[j]), get_ptr(in_offset_[j]), MPI_DOUBLE,
+                   w, in_count_[j][rank_], MPI_DOUBLE, 0, MPI_COMM_WORLD);
+      arg1[j] = w;
+      w += in_count_[j][rank_];
+    }
+
+    // Evaluate the iterations of this rank
+    for (casadi_int j=0; j<n_out_; ++j) {
+      res1[j] = nullptr;
+      if (res[j]==nullptr || f_.nnz_out(j)==0) continue;
+      res1[j] = w;
+      w += out_count_[j][rank_];
+    }
+    int flag = 0;
+    if (!local_.is_null()) flag = local_(arg1, res1, iw, w);
+
+    // Fail on all ranks if any failed
+    int flag_any;
+    MPI_Allreduce(&flag, &flag_any, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+    if (flag_any) return 1;
+
+    // Gather the outputs on all ranks
+    for (casadi_int j=0; j<n_out_; ++j) {
+      if (res1[j]==nullptr) continue;
+      MPI_Allgatherv(res1[j], out_count_[j][rank_], MPI_DOUBLE, res[j],
+                     get_ptr(out_count_[j]), get_ptr(out_offset_[j]), MPI_DOUBLE,
+                     MPI_COMM_WORLD);
+    }
+    return 0;
   }
+#endif // WITH_MPI
 
 } // namespace casadi
@@ -27,6 +27,19 @@
 #define CASADI_MAP_HPP
 
 #include "function_internal.hpp"
+#include "thread_pool.hpp"
+
+#ifdef WITH_OPENCL
+#ifdef __APPLE__
+#include <OpenCL/cl.h>
+#else
+#include <CL/cl.h>
+#endif
+#endif // WITH_OPENCL
+
+#ifdef WITH_MPI
+#include <mpi.h>
+#endif // WITH_MPI
 
 /// \cond INTERNAL
 
@@ -36,11 +49,29 @@ namespace casadi {
       \author Joel Andersson
       \date 2015
   */
+  /** \brief Buffers of one thread evaluating a parallel map
+      Allocated and first written by the thread itself, so that with first-touch page
+      placement they are local to its NUMA node, and kept for the following calls */
+  struct ParallelMapSlot {
+    // Memory object of the mapped function, checked out by the thread
+    casadi_int mem;
+    // Work vectors
+    std::vector<const double*> arg;
+    std::vector<double*> res;
+    std::vector<casadi_int> iw;
+    std::vector<double> w;
+  };
+
+  /** \brief Memory of a parallel map: buffers per thread, indexed by thread number */
+  struct ParallelMapMemory {
+    std::vector<ParallelMapSlot*> slots;
+  };
+
   class CASADI_EXPORT Map : public FunctionInternal {
   public:
     // Create function (use instead of constructor)
     static Function create(const std::string& parallelization,
-                           const Function& f, casadi_int n);
+                           const Function& f, casadi_int n, const Dict& opts=Dict());
 
     /** \brief Destructor */
     ~Map() override;
@@ -83,6 +114,9 @@ namespace casadi {
     /// Type of parallellization
     virtual std::string parallelization() const { return "serial"; }
 
+    /// Options to be passed on to maps of derivatives
+    virtual Dict map_options() const;
+
     /** \brief  evaluate symbolically while also propagating directional derivatives */
     int eval_sx(const SXElem** arg, SXElem** res,
                 casadi_int* iw, SXElem* w, void* mem) const override;
@@ -100,6 +134,9 @@ namespace casadi {
     bool has_sprev() const override { return true;}
     ///@}
 
+    /** \brief Thread-safe if the function evaluated is */
+    bool is_thread_safe() const override { return f_->is_thread_safe();}
+
     /** \brief Is codegen supported? */
     bool has_codegen() const override { return true;}
 
@@ -109,6 +146,15 @@ namespace casadi {
     /** \brief Generate code for the body of the C function */
     void codegen_body(CodeGenerator& g) const override;
 
+    /** \brief Worst-case footprint of the generated code */
+    Dict codegen_footprint(const CodeGenerator& g) const override;
+
+    ///@{
+    /** \brief Options */
+    static Options options_;
+    const Options& get_options() const override { return options_;}
+    ///@}
+
     /** \brief  Initialize */
     void init(const Dict& opts) override;
 
@@ -133,15 +179,34 @@ namespace casadi {
     /** Obtain information about node */
     Dict info() const override { return {{"f", f_}, {"n", n_}}; }
 
+    /** \brief Estimated number of atomic operations after expansion to SX */
+    double n_instructions_sx() const override { return n_ * f_->n_instructions_sx();}
+
   protected:
     // Constructor (protected, use create function)
     Map(const std::string& name, const Function& f, casadi_int n);
 
+    /** \brief Buffers of the calling thread number id, allocated on first use
+        Null if id exceeds the capacity of the memory object */
+    ParallelMapSlot* local_slot(ParallelMapMemory* m, casadi_int id) const;
+
+    /** \brief Release the buffers of all threads and free the memory object */
+    void free_slots(ParallelMapMemory* m) const;
+
     // The function which is to be evaluated in parallel
     Function f_;
 
     // Number of times to evaluate this function
     casadi_int n_;
+
+    // Dynamic scheduling of the iterations for parallel evaluation
+    bool dynamic_;
+
+    // Number of iterations per chunk for dynamic scheduling
+    casadi_int chunk_size_;
+
+    // Number of iterations evaluated at once with batched evaluation, 1 if disabled
+    casadi_int batch_size_;
   };
 
   /** A map Evaluate in parallel using OpenMP
@@ -166,6 +231,32 @@ namespace casadi {
     /// Evaluate the function numerically
     int eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const override;
 
+    /** \brief Create memory block */
+    void* alloc_mem() const override { return new ParallelMapMemory();}
+
+    /** \brief Initalize memory block, buffers per OpenMP thread */
+    int init_mem(void* mem) const override;
+
+    /** \brief Free memory block */
+    void free_mem(void *mem) const override { free_slots(static_cast<ParallelMapMemory*>(mem));}
+
+    /** \brief  Propagate sparsity forward */
+    int sp_forward(const bvec_t** arg, bvec_t** res,
+                    casadi_int* iw, bvec_t* w, void* mem) const override;
+
+    /** \brief  Propagate sparsity backwards */
+    int sp_reverse(bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w, void* mem) const override;
+
+    /** \brief  Propagate sparsity in parallel, forward or backwards */
+    template<typename T1, typename T2>
+    int sp_gen(T1** arg, T2** res, casadi_int* iw, bvec_t* w) const;
+
+    ///@{
+    /** \brief  Propagate sparsity through one iteration */
+    int sp_call(const bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w) const;
+    int sp_call(bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w) const;
+    ///@}
+
     /** \brief  Initialize */
     void init(const Dict& opts) override;
 
@@ -177,8 +268,13 @@ namespace casadi {
   };
 
   /** A map Evaluate in parallel using std::thread
-      Note: Do not use this class with much more than the intended number of
-      threads for the parallel evaluation as it will cause excessive memory use.
+      The iterations are split into chunks which are dispatched to a process-wide
+      pool of persistent worker threads: one contiguous chunk per thread with static
+      scheduling, or chunks of chunk_size iterations claimed by idle threads with
+      dynamic scheduling.
+      Memory and work vectors are allocated per thread, not per iteration. For the
+      numerical evaluation, each pool thread allocates its own (cf. ParallelMapSlot), which
+      keeps them on its NUMA node; cf. GlobalOptions::setThreadPinning.
 
       \author Joris Gillis
       \date 2018
@@ -189,6 +285,24 @@ namespace casadi {
     // Constructor (protected, use create function in Map)
     ThreadMap(const std::string& name, const Function& f, casadi_int n) : Map(name, f, n) {}
 
+    ///@{
+    /** \brief Options */
+    static Options options_;
+    const Options& get_options() const override { return options_;}
+    ///@}
+
+    /** Obtain information about node */
+    Dict info() const override;
+
+    /// Options to be passed on to maps of derivatives
+    Dict map_options() const override;
+
+    // Maximum number of threads
+    casadi_int max_num_threads_;
+
+    // Number of threads actually used
+    casadi_int n_threads_;
+
     /** \brief  Destructor */
     ~ThreadMap() override;
 
@@ -198,6 +312,35 @@ namespace casadi {
     /// Evaluate the function numerically
     int eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const override;
 
+    /** \brief  Propagate sparsity forward */
+    int sp_forward(const bvec_t** arg, bvec_t** res,
+                    casadi_int* iw, bvec_t* w, void* mem) const override;
+
+    /** \brief  Propagate sparsity backwards */
+    int sp_reverse(bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w, void* mem) const override;
+
+    /** \brief Evaluate iterations i_begin..n_-1 in parallel
+        work(i, t, m) evaluates iteration i using the work vectors of thread t
+        and the memory object m. Symbolic evaluation (eval_sx) stays serial since
+        the construction of SX expressions is not thread-safe.
+    */
+    int parallel(casadi_int i_begin,
+                 const std::function<int(casadi_int, casadi_int, casadi_int)>& work) const;
+
+    /** \brief Split iterations i_begin..n_-1 into chunks, processed by the thread pool
+        range(i0, i1, t) processes iterations i0..i1-1 in thread t=0..n_threads_-1 */
+    void dispatch(casadi_int i_begin,
+                  const std::function<void(casadi_int, casadi_int, casadi_int)>& range) const;
+
+    /** \brief Create memory block */
+    void* alloc_mem() const override { return new ParallelMapMemory();}
+
+    /** \brief Initalize memory block */
+    int init_mem(void* mem) const override;
+
+    /** \brief Free memory block */
+    void free_mem(void *mem) const override { free_slots(static_cast<ParallelMapMemory*>(mem));}
+
     /** \brief  Initialize */
     void init(const Dict& opts) override;
 
@@ -208,6 +351,134 @@ namespace casadi {
     void codegen_body(CodeGenerator& g) const override;
   };
 
+#ifdef WITH_OPENCL
+  /** \brief Memory of an OpenCLMap: a command queue, a kernel and the device buffers */
+  struct OpenCLMapMemory {
+    cl_command_queue queue;
+    cl_kernel kernel;
+    std::vector<cl_mem> in, out;
+  };
+
+  /** A map evaluated on an OpenCL device
+      The mapped function must be an SXFunction, which is exported to an OpenCL kernel
+      with one work item per iteration (cf. SXFunction::export_kernel). The inputs are
+      copied to the device, the kernel is launched once for all iterations and the
+      outputs are copied back, with one transfer per argument.
+  */
+  class CASADI_EXPORT OpenCLMap : public Map {
+    friend class Map;
+  protected:
+    // Constructor (protected, use create function in Map)
+    OpenCLMap(const std::string& name, const Function& f, casadi_int n)
+      : Map(name, f, n), context_(nullptr), program_(nullptr) {}
+
+    ///@{
+    /** \brief Options */
+    static Options options_;
+    const Options& get_options() const override { return options_;}
+    ///@}
+
+    /** Obtain information about node */
+    Dict info() const override;
+
+    // OpenCL platform and device used
+    casadi_int platform_, device_;
+
+    // Kernel source
+    std::string source_;
+
+    // OpenCL objects shared by all memory objects
+    cl_device_id device_id_;
+    cl_context context_;
+    cl_program program_;
+
+    /** \brief  Destructor */
+    ~OpenCLMap() override;
+
+    /** \brief Get type name */
+    std::string class_name() const override {return "OpenCLMap";}
+
+    /// Evaluate the function numerically
+    int eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const override;
+
+    /** \brief  Initialize */
+    void init(const Dict& opts) override;
+
+    ///@{
+    /** \brief Memory objects, holding the command queue and the device buffers */
+    void* alloc_mem() const override { return new OpenCLMapMemory();}
+    int init_mem(void* mem) const override;
+    void free_mem(void *mem) const override;
+    ///@}
+
+    /// Type of parallellization
+    std::string parallelization() const override { return "opencl"; }
+  };
+#endif // WITH_OPENCL
+
+#ifdef WITH_MPI
+  /** A map evaluated across the ranks of MPI_COMM_WORLD
+      All ranks run the same program and evaluate the map collectively: the inputs of
+      rank 0 are scattered, each rank evaluates a contiguous block of iterations with a
+      local map of the given parallelization, and the outputs are gathered on all ranks.
+      Each rank hence constructs the mapped function itself, and all ranks must evaluate
+      the map in the same order, with the same inputs and outputs present.
+      MPI is initialized on first use, unless already done by the caller.
+      Sparsity propagation, symbolic evaluation and code generation are serial.
+  */
+  class CASADI_EXPORT MpiMap : public Map {
+    friend class Map;
+  protected:
+    // Constructor (protected, use create function in Map)
+    MpiMap(const std::string& name, const Function& f, casadi_int n) : Map(name, f, n) {}
+
+    ///@{
+    /** \brief Options */
+    static Options options_;
+    const Options& get_options() const override { return options_;}
+    ///@}
+
+    /** Obtain information about node */
+    Dict info() const override;
+
+    /// Options to be passed on to maps of derivatives
+    Dict map_options() const override;
+
+    // Parallelization of the iterations evaluated by one rank
+    std::string local_parallelization_;
+
+    // Number of ranks and the rank of this process
+    int size_, rank_;
+
+    // Number of iterations per rank
+    std::vector<casadi_int> count_;
+
+    // Nonzero counts and offsets per rank, for each input and output
+    std::vector<std::vector<int>> in_count_, in_offset_, out_count_, out_offset_;
+
+    // Map evaluating the iterations of this rank, null if none
+    Function local_;
+
+    /** \brief  Destructor */
+    ~MpiMap() override;
+
+    /** \brief Get type name */
+    std::string class_name() const override {return "MpiMap";}
+
+    /// Evaluate the function numerically
+    int eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const override;
+
+    /// Collective operations: calls must be made from one thread, in the same order on all ranks
+    bool is_thread_safe() const override { return false;}
+
+    /** \brief  Initialize */
+    void init(const Dict& opts) override;
+
+    /// Type of parallellization
+    std::string parallelization() const override { return "mpi"; }
+  };
+#endif // WITH_MPI
+
 } // namespace casadi
 /// \endcond
 
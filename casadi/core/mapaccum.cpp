@@ -0,0 +1,398 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#include "mapaccum.hpp"
+
+using namespace std;
+
+namespace casadi {
+
+  Function Mapaccum::create(const std::string& name, const Function& f, casadi_int n,
+                            casadi_int n_accum, const Dict& opts) {
+    return Function::create(new Mapaccum(name, f, n, n_accum), opts);
+  }
+
+  Mapaccum::Mapaccum(const std::string& name, const Function& f, casadi_int n,
+                     casadi_int n_accum)
+    : FunctionInternal(name), f_(f), n_(n), n_accum_(n_accum) {
+  }
+
+  Mapaccum::~Mapaccum() {
+  }
+
+  void Mapaccum::init(const Dict& opts) {
+    // Call the initialization method of the base class
+    FunctionInternal::init(opts);
+
+    // Consistency checks
+    casadi_assert(n_>0, "mapaccum: N must be positive");
+    casadi_assert(n_accum_>=0 && n_accum_<=min(n_in_, n_out_),
+                  "mapaccum: too many accumulators");
+    for (casadi_int i=0; i<n_accum_; ++i) {
+      casadi_assert(f_.size_in(i)==f_.size_out(i),
+                    "mapaccum: dimension mismatch for accumulator " + str(i) + ": input "
+                    + str(f_.size_in(i)) + ", output " + str(f_.size_out(i)));
+    }
+
+    // Work vector: the accumulators, the projections between them and f
+    casadi_int sz_w = 0, sz_proj = 0;
+    w_in_.resize(n_accum_);
+    w_out_.resize(n_accum_);
+    for (casadi_int i=0; i<n_accum_; ++i) {
+      w_in_[i] = sz_w;
+      sz_w += f_.nnz_in(i);
+      w_out_[i] = sz_w;
+      sz_w += f_.nnz_out(i);
+      sz_proj = max(sz_proj, f_.size1_in(i));
+    }
+    w_proj_ = sz_w;
+    w_f_ = sz_w + sz_proj;
+    alloc_arg(f_.sz_arg());
+    alloc_res(f_.sz_res());
+    alloc_w(w_f_ + f_.sz_w());
+    alloc_iw(f_.sz_iw());
+  }
+
+  template<typename T>
+  int Mapaccum::eval_gen(const T** arg, T** res, casadi_int* iw, T* w) const {
+    const T** arg1 = arg+n_in_;
+    T** res1 = res+n_out_;
+    // Initial value of the accumulators
+    for (casadi_int i=0; i<n_accum_; ++i) casadi_copy(arg[i], f_.nnz_in(i), w+w_in_[i]);
+    for (casadi_int k=0; k<n_; ++k) {
+      for (casadi_int i=0; i<n_in_; ++i) {
+        if (i<n_accum_) {
+          arg1[i] = w+w_in_[i];
+        } else {
+          arg1[i] = arg[i] ? arg[i] + k*f_.nnz_in(i) : nullptr;
+        }
+      }
+      for (casadi_int i=0; i<n_out_; ++i) {
+        if (i<n_accum_) {
+          res1[i] = w+w_out_[i];
+        } else {
+          res1[i] = res[i] ? res[i] + k*f_.nnz_out(i) : nullptr;
+        }
+      }
+      if (f_(arg1, res1, iw, w+w_f_)) return 1;
+      // Save the accumulators and feed them back
+      for (casadi_int i=0; i<n_accum_; ++i) {
+        if (res[i]) casadi_copy(w+w_out_[i], f_.nnz_out(i), res[i] + k*f_.nnz_out(i));
+        if (f_.sparsity_out(i)==f_.sparsity_in(i)) {
+          casadi_copy(w+w_out_[i], f_.nnz_out(i), w+w_in_[i]);
+        } else {
+          casadi_project(w+w_out_[i], f_.sparsity_out(i), w+w_in_[i], f_.sparsity_in(i),
+                         w+w_proj_);
+        }
+      }
+    }
+    return 0;
+  }
+
+  int Mapaccum::eval(const double** arg, double** res, casadi_int* iw, double* w,
+                     void* mem) const {
+    return eval_gen(arg, res, iw, w);
+  }
+
+  int Mapaccum::eval_sx(const SXElem** arg, SXElem** res, casadi_int* iw, SXElem* w,
+                        void* mem) const {
+    return eval_gen(arg, res, iw, w);
+  }
+
+  int Mapaccum::sp_forward(const bvec_t** arg, bvec_t** res,
+                           casadi_int* iw, bvec_t* w, void* mem) const {
+    return eval_gen(arg, res, iw, w);
+  }
+
+  int Mapaccum::sp_reverse(bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w,
+                           void* mem) const {
+    bvec_t** arg1 = arg+n_in_;
+    bvec_t** res1 = res+n_out_;
+    // Seeds of the accumulator inputs of the next iteration
+    for (casadi_int i=0; i<n_accum_; ++i) fill_n(w+w_in_[i], f_.nnz_in(i), 0);
+    for (casadi_int k=n_-1; k>=0; --k) {
+      for (casadi_int i=0; i<n_accum_; ++i) {
+        // Seed of the accumulator output: its own seed and that of the next input
+        bvec_t* s = w+w_out_[i];
+        if (f_.sparsity_out(i)==f_.sparsity_in(i)) {
+          casadi_copy(w+w_in_[i], f_.nnz_in(i), s);
+        } else {
+          casadi_project(w+w_in_[i], f_.sparsity_in(i), s, f_.sparsity_out(i), w+w_proj_);
+        }
+        if (res[i]) {
+          bvec_t* r = res[i] + k*f_.nnz_out(i);
+          for (casadi_int el=0; el<f_.nnz_out(i); ++el) {
+            s[el] |= r[el];
+            r[el] = 0;
+          }
+        }
+        fill_n(w+w_in_[i], f_.nnz_in(i), 0);
+      }
+      for (casadi_int i=0; i<n_in_; ++i) {
+        if (i<n_accum_) {
+          arg1[i] = w+w_in_[i];
+        } else {
+          arg1[i] = arg[i] ? arg[i] + k*f_.nnz_in(i) : nullptr;
+        }
+      }
+      for (casadi_int i=0; i<n_out_; ++i) {
+        if (i<n_accum_) {
+          res1[i] = w+w_out_[i];
+        } else {
+          res1[i] = res[i] ? res[i] + k*f_.nnz_out(i) : nullptr;
+        }
+      }
+      if (f_.rev(arg1, res1, iw, w+w_f_)) return 1;
+    }
+    // Seeds of the initial values
+    for (casadi_int i=0; i<n_accum_; ++i) {
+      if (arg[i]) {
+        for (casadi_int el=0; el<f_.nnz_in(i); ++el) arg[i][el] |= w[w_in_[i]+el];
+      }
+    }
+    return 0;
+  }
+
+  void Mapaccum::codegen_declarations(CodeGenerator& g) const {
+    g.add_dependency(f_);
+  }
+
+  void Mapaccum::codegen_body(CodeGenerator& g) const {
+    g << "casadi_int k;\n"
+      << "const casadi_real** arg1 = arg+" << n_in_ << ";\n"
+      << "casadi_real** res1 = res+" << n_out_ << ";\n";
+    // Initial value of the accumulators
+    for (casadi_int i=0; i<n_accum_; ++i) {
+      g << g.copy("arg[" + str(i) + "]", f_.nnz_in(i), "w+" + str(w_in_[i])) << "\n";
+    }
+    g << "for (k=0; k<" << n_ << "; ++k) {\n";
+    for (casadi_int i=0; i<n_in_; ++i) {
+      if (i<n_accum_) {
+        g << "arg1[" << i << "] = w+" << w_in_[i] << ";\n";
+      } else {
+        g << "arg1[" << i << "] = arg[" << i << "] ? arg[" << i << "]+k*"
+          << f_.nnz_in(i) << " : 0;\n";
+      }
+    }
+    for (casadi_int i=0; i<n_out_; ++i) {
+      if (i<n_accum_) {
+        g << "res1[" << i << "] = w+" << w_out_[i] << ";\n";
+      } else {
+        g << "res1[" << i << "] = res[" << i << "] ? res[" << i << "]+k*"
+          << f_.nnz_out(i) << " : 0;\n";
+      }
+    }
+    g << "if (" << g(f_, "arg1", "res1", "iw", "w+" + str(w_f_)) << ") return 1;\n";
+    // Save the accumulators and feed them back
+    for (casadi_int i=0; i<n_accum_; ++i) {
+      g << "if (res[" << i << "]) "
+        << g.copy("w+" + str(w_out_[i]), f_.nnz_out(i),
+                  "res[" + str(i) + "]+k*" + str(f_.nnz_out(i))) << "\n";
+      g << g.project("w+" + str(w_out_[i]), f_.sparsity_out(i),
+                     "w+" + str(w_in_[i]), f_.sparsity_in(i), "w+" + str(w_proj_)) << "\n";
+    }
+    g << "}\n";
+  }
+
+  Function Mapaccum
+  ::get_forward(casadi_int nfwd, const std::string& name,
+                const std::vector<std::string>& inames,
+                const std::vector<std::string>& onames,
+                const Dict& opts) const {
+    // One step with the forward sensitivities of the accumulators as additional accumulators
+    Function df = f_.forward(nfwd);
+    vector<MX> x = f_.mx_in(), y = f_(x), fseed(n_in_);
+    for (casadi_int i=0; i<n_in_; ++i) {
+      fseed[i] = MX::sym("fwd_" + f_.name_in(i), repmat(f_.sparsity_in(i), 1, nfwd));
+    }
+    vector<MX> df_arg = x;
+    df_arg.insert(df_arg.end(), y.begin(), y.end());
+    df_arg.insert(df_arg.end(), fseed.begin(), fseed.end());
+    vector<MX> fsens = df(df_arg);
+    vector<MX> step_in, step_out;
+    for (casadi_int i=0; i<n_accum_; ++i) step_in.push_back(x[i]);
+    for (casadi_int i=0; i<n_accum_; ++i) step_in.push_back(fseed[i]);
+    for (casadi_int i=n_accum_; i<n_in_; ++i) step_in.push_back(x[i]);
+    for (casadi_int i=n_accum_; i<n_in_; ++i) step_in.push_back(fseed[i]);
+    for (casadi_int i=0; i<n_accum_; ++i) step_out.push_back(y[i]);
+    for (casadi_int i=0; i<n_accum_; ++i) step_out.push_back(fsens[i]);
+    for (casadi_int i=n_accum_; i<n_out_; ++i) step_out.push_back(y[i]);
+    for (casadi_int i=n_accum_; i<n_out_; ++i) step_out.push_back(fsens[i]);
+    Function step("fwd" + str(nfwd) + "_" + f_.name(), step_in, step_out);
+    Function dm = create("mapaccum_" + step.name(), step, n_, 2*n_accum_);
+
+    // Inputs of the derivative: nondifferentiated inputs and outputs, forward seeds
+    vector<MX> arg;
+    for (casadi_int i=0; i<n_in_; ++i) arg.push_back(MX::sym(inames.at(i), sparsity_in(i)));
+    for (casadi_int i=0; i<n_out_; ++i) {
+      arg.push_back(MX::sym(inames.at(n_in_+i), sparsity_out(i)));
+    }
+    for (casadi_int i=0; i<n_in_; ++i) {
+      arg.push_back(MX::sym(inames.at(n_in_+n_out_+i), repmat(sparsity_in(i), 1, nfwd)));
+    }
+
+    // Reorder the seeds of the mapped inputs from direction-major to iteration-major
+    vector<MX> dm_arg;
+    vector<casadi_int> ind;
+    for (casadi_int i=0; i<n_accum_; ++i) dm_arg.push_back(arg[i]);
+    for (casadi_int i=0; i<n_accum_; ++i) dm_arg.push_back(arg[n_in_+n_out_+i]);
+    for (casadi_int i=n_accum_; i<n_in_; ++i) dm_arg.push_back(arg[i]);
+    for (casadi_int i=n_accum_; i<n_in_; ++i) {
+      casadi_int sz = f_.size2_in(i);
+      ind.clear();
+      for (casadi_int k=0; k<n_; ++k) {
+        for (casadi_int d=0; d<nfwd; ++d) {
+          for (casadi_int j=0; j<sz; ++j) {
+            ind.push_back((d*n_ + k)*sz + j);
+          }
+        }
+      }
+      dm_arg.push_back(arg[n_in_+n_out_+i](Slice(), ind));
+    }
+    vector<MX> dm_res = dm(dm_arg);
+
+    // Reorder the sensitivities from iteration-major to direction-major
+    vector<MX> res(n_out_);
+    for (casadi_int i=0; i<n_out_; ++i) {
+      const MX& r = i<n_accum_ ? dm_res[n_accum_+i] : dm_res[n_out_+i];
+      casadi_int sz = f_.size2_out(i);
+      ind.clear();
+      for (casadi_int d=0; d<nfwd; ++d) {
+        for (casadi_int k=0; k<n_; ++k) {
+          for (casadi_int j=0; j<sz; ++j) {
+            ind.push_back((k*nfwd + d)*sz + j);
+          }
+        }
+      }
+      res[i] = r(Slice(), ind);
+    }
+
+    // Construct return function
+    return Function(name, arg, res, inames, onames, opts);
+  }
+
+  Function Mapaccum
+  ::get_reverse(casadi_int nadj, const std::string& name,
+                const std::vector<std::string>& inames,
+                const std::vector<std::string>& onames,
+                const Dict& opts) const {
+    // One step backwards in time, with the adjoints of the accumulators as accumulators
+    Function df = f_.reverse(nadj);
+    vector<MX> lam(n_accum_), x = f_.mx_in(), y(n_out_), aseed(n_out_);
+    for (casadi_int i=0; i<n_accum_; ++i) {
+      lam[i] = MX::sym("adj_next_" + f_.name_in(i), repmat(f_.sparsity_in(i), 1, nadj));
+    }
+    for (casadi_int i=0; i<n_out_; ++i) {
+      y[i] = MX::sym(f_.name_out(i), f_.sparsity_out(i));
+      aseed[i] = MX::sym("adj_" + f_.name_out(i), repmat(f_.sparsity_out(i), 1, nadj));
+    }
+    vector<MX> df_arg = x;
+    df_arg.insert(df_arg.end(), y.begin(), y.end());
+    for (casadi_int i=0; i<n_out_; ++i) {
+      // The adjoint of an accumulator output includes that of the next input
+      df_arg.push_back(i<n_accum_ ? aseed[i] + lam[i] : aseed[i]);
+    }
+    vector<MX> asens = df(df_arg);
+    vector<MX> step_in = lam;
+    step_in.insert(step_in.end(), x.begin(), x.end());
+    step_in.insert(step_in.end(), y.begin(), y.end());
+    step_in.insert(step_in.end(), aseed.begin(), aseed.end());
+    Function step("adj" + str(nadj) + "_" + f_.name(), step_in, asens);
+    Function dm = create("mapaccum_" + step.name(), step, n_, n_accum_);
+
+    // Inputs of the derivative: nondifferentiated inputs and outputs, adjoint seeds
+    vector<MX> arg;
+    for (casadi_int i=0; i<n_in_; ++i) arg.push_back(MX::sym(inames.at(i), sparsity_in(i)));
+    for (casadi_int i=0; i<n_out_; ++i) {
+      arg.push_back(MX::sym(inames.at(n_in_+i), sparsity_out(i)));
+    }
+    for (casadi_int i=0; i<n_out_; ++i) {
+      arg.push_back(MX::sym(inames.at(n_in_+n_out_+i), repmat(sparsity_out(i), 1, nadj)));
+    }
+
+    // Inputs of the backward iterations, in reverse order
+    vector<MX> dm_arg;
+    vector<casadi_int> ind;
+    for (casadi_int i=0; i<n_accum_; ++i) {
+      dm_arg.push_back(MX(f_.size1_in(i), f_.size2_in(i)*nadj));
+    }
+    for (casadi_int i=0; i<n_in_; ++i) {
+      // The accumulator inputs are the initial value and all but the last output
+      MX v = i<n_accum_ ? horzcat(arg[i], arg[n_in_+i]) : arg[i];
+      casadi_int sz = f_.size2_in(i);
+      ind.clear();
+      for (casadi_int k=n_-1; k>=0; --k) {
+        for (casadi_int j=0; j<sz; ++j) ind.push_back(k*sz + j);
+      }
+      dm_arg.push_back(v(Slice(), ind));
+    }
+    for (casadi_int i=0; i<n_out_; ++i) {
+      casadi_int sz = f_.size2_out(i);
+      ind.clear();
+      for (casadi_int k=n_-1; k>=0; --k) {
+        for (casadi_int j=0; j<sz; ++j) ind.push_back(k*sz + j);
+      }
+      dm_arg.push_back(arg[n_in_+i](Slice(), ind));
+    }
+    for (casadi_int i=0; i<n_out_; ++i) {
+      casadi_int sz = f_.size2_out(i);
+      ind.clear();
+      for (casadi_int k=n_-1; k>=0; --k) {
+        for (casadi_int d=0; d<nadj; ++d) {
+          for (casadi_int j=0; j<sz; ++j) {
+            ind.push_back((d*n_ + k)*sz + j);
+          }
+        }
+      }
+      dm_arg.push_back(arg[n_in_+n_out_+i](Slice(), ind));
+    }
+    vector<MX> dm_res = dm(dm_arg);
+
+    // Adjoint sensitivities, back in forward order and direction-major
+    vector<MX> res(n_in_);
+    for (casadi_int i=0; i<n_in_; ++i) {
+      casadi_int sz = f_.size2_in(i);
+      ind.clear();
+      if (i<n_accum_) {
+        // Adjoint of the initial value: the last backward iteration
+        for (casadi_int j=0; j<nadj*sz; ++j) ind.push_back((n_-1)*nadj*sz + j);
+      } else {
+        for (casadi_int d=0; d<nadj; ++d) {
+          for (casadi_int k=0; k<n_; ++k) {
+            for (casadi_int j=0; j<sz; ++j) {
+              ind.push_back(((n_-1-k)*nadj + d)*sz + j);
+            }
+          }
+        }
+      }
+      res[i] = dm_res[i](Slice(), ind);
+    }
+
+    // Construct return function
+    return Function(name, arg, res, inames, onames, opts);
+  }
+
+} // namespace casadi
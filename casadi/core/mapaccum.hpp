@@ -0,0 +1,164 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#ifndef CASADI_MAPACCUM_HPP
+#define CASADI_MAPACCUM_HPP
+
+#include "function_internal.hpp"
+
+/// \cond INTERNAL
+
+namespace casadi {
+
+  /** Evaluate a function N times, feeding the first n_accum outputs back as inputs
+      The loop is evaluated internally, so that the size of the expression graph does not
+      grow with N. Derivatives are native mapaccums of the derivatives of the function:
+      the forward sensitivities of the accumulators are accumulated alongside, and
+      the adjoints run backwards in time from the states stored in the outputs.
+  */
+  class CASADI_EXPORT Mapaccum : public FunctionInternal {
+  public:
+    // Create function (use instead of constructor)
+    static Function create(const std::string& name, const Function& f, casadi_int n,
+                           casadi_int n_accum, const Dict& opts=Dict());
+
+    /** \brief Destructor */
+    ~Mapaccum() override;
+
+    /** \brief Get type name */
+    std::string class_name() const override {return "Mapaccum";}
+
+    /// @{
+    /** \brief Sparsities of function inputs and outputs */
+    Sparsity get_sparsity_in(casadi_int i) override {
+      return i<n_accum_ ? f_.sparsity_in(i) : repmat(f_.sparsity_in(i), 1, n_);
+    }
+    Sparsity get_sparsity_out(casadi_int i) override {
+      return repmat(f_.sparsity_out(i), 1, n_);
+    }
+    /// @}
+
+    /** \brief Get default input value */
+    double get_default_in(casadi_int ind) const override { return f_.default_in(ind);}
+
+    ///@{
+    /** \brief Number of function inputs and outputs */
+    size_t get_n_in() override { return f_.n_in();}
+    size_t get_n_out() override { return f_.n_out();}
+    ///@}
+
+    ///@{
+    /** \brief Names of function input and outputs */
+    std::string get_name_in(casadi_int i) override { return f_.name_in(i);}
+    std::string get_name_out(casadi_int i) override { return f_.name_out(i);}
+    /// @}
+
+    /** \brief  Evaluate or propagate sparsities forward */
+    template<typename T>
+    int eval_gen(const T** arg, T** res, casadi_int* iw, T* w) const;
+
+    /// Evaluate the function numerically
+    int eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const override;
+
+    /** \brief  evaluate symbolically while also propagating directional derivatives */
+    int eval_sx(const SXElem** arg, SXElem** res,
+                casadi_int* iw, SXElem* w, void* mem) const override;
+
+    /** \brief  Propagate sparsity forward */
+    int sp_forward(const bvec_t** arg, bvec_t** res,
+                    casadi_int* iw, bvec_t* w, void* mem) const override;
+
+    /** \brief  Propagate sparsity backwards */
+    int sp_reverse(bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w, void* mem) const override;
+
+    ///@{
+    /// Is the class able to propagate seeds through the algorithm?
+    bool has_spfwd() const override { return true;}
+    bool has_sprev() const override { return true;}
+    ///@}
+
+    /** \brief Thread-safe if the function evaluated is */
+    bool is_thread_safe() const override { return f_->is_thread_safe();}
+
+    /** \brief Is codegen supported? */
+    bool has_codegen() const override { return true;}
+
+    /** \brief Generate code for the declarations of the C function */
+    void codegen_declarations(CodeGenerator& g) const override;
+
+    /** \brief Generate code for the body of the C function */
+    void codegen_body(CodeGenerator& g) const override;
+
+    /** \brief  Initialize */
+    void init(const Dict& opts) override;
+
+    ///@{
+    /** \brief Generate a function that calculates \a nfwd forward derivatives */
+    bool has_forward(casadi_int nfwd) const override { return true;}
+    Function get_forward(casadi_int nfwd, const std::string& name,
+                         const std::vector<std::string>& inames,
+                         const std::vector<std::string>& onames,
+                         const Dict& opts) const override;
+    ///@}
+
+    ///@{
+    /** \brief Generate a function that calculates \a nadj adjoint derivatives */
+    bool has_reverse(casadi_int nadj) const override { return true;}
+    Function get_reverse(casadi_int nadj, const std::string& name,
+                         const std::vector<std::string>& inames,
+                         const std::vector<std::string>& onames,
+                         const Dict& opts) const override;
+    ///@}
+
+    /** Obtain information about node */
+    Dict info() const override { return {{"f", f_}, {"n", n_}, {"n_accum", n_accum_}}; }
+
+    /** \brief Estimated number of atomic operations after expansion to SX */
+    double n_instructions_sx() const override { return n_ * f_->n_instructions_sx();}
+
+  protected:
+    // Constructor (protected, use create function)
+    Mapaccum(const std::string& name, const Function& f, casadi_int n, casadi_int n_accum);
+
+    // The function which is to be evaluated repeatedly
+    Function f_;
+
+    // Number of times to evaluate this function
+    casadi_int n_;
+
+    // Number of accumulated inputs and outputs
+    casadi_int n_accum_;
+
+    // Offsets of the accumulator inputs and outputs in the work vector, followed by
+    // the work vector of the projections and the work vector of f
+    std::vector<casadi_int> w_in_, w_out_;
+    casadi_int w_proj_, w_f_;
+  };
+
+} // namespace casadi
+/// \endcond
+
+#endif // CASADI_MAPACCUM_HPP
@@ -27,6 +27,7 @@
 #include "sx_node.hpp"
 #include "linsol.hpp"
 #include "expm.hpp"
+#include "sparse_file.hpp"
 #include <chrono>
 
 using namespace std;
@@ -1063,6 +1064,25 @@ namespace casadi {
     }
   }
 
+  // Matrix product kernel, z <- z + x*y
+  template<typename Scalar>
+  static void mac_kernel(const Matrix<Scalar> &x, const Matrix<Scalar> &y, Matrix<Scalar> &z) {
+    std::vector<Scalar> work(x.size1());
+    casadi_mtimes(x.ptr(), x.sparsity(), y.ptr(), y.sparsity(),
+                  z.ptr(), z.sparsity(), get_ptr(work), false);
+  }
+
+  // Numerical matrix product kernel, blocked dense if all factors are dense
+  static void mac_kernel(const Matrix<double> &x, const Matrix<double> &y, Matrix<double> &z) {
+    if (x.is_dense() && y.is_dense() && z.is_dense()) {
+      casadi_mtimes_dense(x.ptr(), x.size1(), x.size2(), y.ptr(), y.size2(), z.ptr());
+    } else {
+      std::vector<double> work(x.size1());
+      casadi_mtimes(x.ptr(), x.sparsity(), y.ptr(), y.sparsity(),
+                    z.ptr(), z.sparsity(), get_ptr(work), false);
+    }
+  }
+
   template<typename Scalar>
   Matrix<Scalar> Matrix<Scalar>::mac(const Matrix<Scalar> &x,
                                          const Matrix<Scalar> &y,
@@ -1095,9 +1115,7 @@ namespace casadi {
     } else {
       // Carry out the matrix product
       Matrix<Scalar> ret = z;
-      std::vector<Scalar> work(x.size1());
-      casadi_mtimes(x.ptr(), x.sparsity(), y.ptr(), y.sparsity(),
-                    ret.ptr(), ret.sparsity(), get_ptr(work), false);
+      mac_kernel(x, y, ret);
       return ret;
     }
   }
@@ -1109,6 +1127,14 @@ namespace casadi {
     return casadi_bilin(A.ptr(), A.sparsity(), x.ptr(), y.ptr());
   }
 
+  template<typename Scalar>
+  Matrix<Scalar> Matrix<Scalar>::
+  _conv(const Matrix<Scalar>& h, const Matrix<Scalar>& x) {
+    Matrix<Scalar> ret = zeros(h.nnz()+x.nnz()-1, 1);
+    casadi_conv(h.ptr(), h.nnz(), x.ptr(), x.nnz(), ret.ptr());
+    return ret;
+  }
+
   template<typename Scalar>
   Matrix<Scalar> Matrix<Scalar>::
   _rank1(const Matrix<Scalar>& A, const Matrix<Scalar>& alpha,
@@ -1320,6 +1346,36 @@ namespace casadi {
     return Matrix<Scalar>(sp, d.nz(mapping));
   }
 
+  template<typename Scalar>
+  Matrix<Scalar> Matrix<Scalar>::assemble(const std::vector<casadi_int>& row,
+                                          const std::vector<casadi_int>& col,
+                                          const Matrix<Scalar>& d,
+                                          casadi_int nrow, casadi_int ncol,
+                                          casadi_int n_threads) {
+    std::vector<casadi_int> nz;
+    Sparsity sp = Sparsity::assemble(nrow, ncol, row, col, nz, n_threads);
+    return assemble(sp, nz, d);
+  }
+
+  template<typename Scalar>
+  Matrix<Scalar> Matrix<Scalar>::assemble(const Sparsity& sp, const std::vector<casadi_int>& nz,
+                                          const Matrix<Scalar>& d) {
+    casadi_assert(nz.size()==d.nnz(),
+                  "Argument error in Matrix<Scalar>::assemble(sp, nz, d): "
+                  "nz has length " + str(nz.size()) + ", but d has " + str(d.nnz())
+                  + " nonzeros");
+    Matrix<Scalar> ret = zeros(sp);
+    Scalar* r = get_ptr(ret.nonzeros());
+    const Scalar* v = get_ptr(d.nonzeros());
+    casadi_int nnz = sp.nnz();
+    for (casadi_int k=0; k<nz.size(); ++k) {
+      casadi_assert(nz[k]>=0 && nz[k]<nnz,
+                    "Entry " + str(k) + " is not in the sparsity pattern");
+      r[nz[k]] += v[k];
+    }
+    return ret;
+  }
+
   template<typename Scalar>
   Matrix<Scalar> Matrix<Scalar>::eye(casadi_int n) {
     return Matrix<Scalar>::ones(Sparsity::diag(n));
@@ -1574,6 +1630,59 @@ namespace casadi {
     casadi_error("'get_max_depth' not defined for " + type_name());
   }
 
+  namespace {
+    // Sign of a permutation, from the parity of its number of cycles
+    casadi_int permutation_sign(const std::vector<casadi_int>& p) {
+      std::vector<bool> visited(p.size(), false);
+      casadi_int sign = 1;
+      for (casadi_int i=0; i<p.size(); ++i) {
+        if (visited[i]) continue;
+        casadi_int len = 0;
+        for (casadi_int j=i; !visited[j]; j=p[j]) {
+          visited[j] = true;
+          len++;
+        }
+        if (len % 2 == 0) sign = -sign;
+      }
+      return sign;
+    }
+
+    // Numeric phase of Sparsity::lu_sparse for the permuted matrix A
+    // Returns false if a pivot is exactly zero
+    template<typename Scalar>
+    bool lu_numeric(const Matrix<Scalar>& A, const Sparsity& L, const Sparsity& U,
+                    std::vector<Scalar>& L_nz, std::vector<Scalar>& U_nz) {
+      casadi_int n = A.size2();
+      const casadi_int *a_colind = A.colind(), *a_row = A.row();
+      const casadi_int *l_colind = L.colind(), *l_row = L.row();
+      const casadi_int *u_colind = U.colind(), *u_row = U.row();
+      const std::vector<Scalar>& a = A.nonzeros();
+      L_nz.resize(L.nnz());
+      U_nz.resize(U.nnz());
+      std::vector<Scalar> w(n, 0);
+      for (casadi_int j=0; j<n; ++j) {
+        for (casadi_int el=a_colind[j]; el<a_colind[j+1]; ++el) w[a_row[el]] = a[el];
+        // Rows in increasing order is a topological order of L, the pivot comes last
+        for (casadi_int el=u_colind[j]; el<u_colind[j+1]-1; ++el) {
+          casadi_int k = u_row[el];
+          Scalar x_k = U_nz[el] = w[k];
+          w[k] = 0;
+          for (casadi_int el2=l_colind[k]; el2<l_colind[k+1]; ++el2) {
+            w[l_row[el2]] -= L_nz[el2]*x_k;
+          }
+        }
+        Scalar pivot = U_nz[u_colind[j+1]-1] = w[j];
+        w[j] = 0;
+        if (casadi_limits<Scalar>::is_zero(pivot)) return false;
+        for (casadi_int el=l_colind[j]; el<l_colind[j+1]; ++el) {
+          L_nz[el] = w[l_row[el]]/pivot;
+          w[l_row[el]] = 0;
+        }
+      }
+      return true;
+    }
+  } // namespace
+
   template<typename Scalar>
   Matrix<Scalar> Matrix<Scalar>::det(const Matrix<Scalar>& x) {
     casadi_int n = x.size2();
@@ -1585,6 +1694,27 @@ namespace casadi {
     // Trivial case 2 x 2
     if (n==2) return x(0, 0) * x(1, 1) - x(0, 1) * x(1, 0);
 
+    // Sparse elimination: the cofactor expansion grows exponentially beyond 3 x 3
+    if (n>3 && !std::numeric_limits<Scalar>::is_integer) {
+      // Structural zeros would become zero pivots
+      if (x.has_zeros()) return det(sparsify(x));
+      // Structurally singular
+      if (Sparsity::sprank(x.sparsity())<n) return 0;
+      Sparsity L, U;
+      std::vector<casadi_int> rowperm, colperm;
+      x.sparsity().lu_sparse(L, U, rowperm, colperm);
+      std::vector<Scalar> L_nz, U_nz;
+      if (lu_numeric(x(rowperm, colperm), L, U, L_nz, U_nz)) {
+        // Product of the pivots
+        const casadi_int* u_colind = U.colind();
+        Scalar ret = U_nz[u_colind[1]-1];
+        for (casadi_int j=1; j<n; ++j) ret *= U_nz[u_colind[j+1]-1];
+        if (permutation_sign(rowperm)*permutation_sign(colperm)<0) ret = -ret;
+        return ret;
+      }
+      // A pivot is exactly zero, no pivoting on values: use the cofactor expansion
+    }
+
     // Return expression
     Matrix<Scalar> ret = 0;
 
@@ -1802,9 +1932,21 @@ namespace casadi {
 
   template<typename Scalar>
   Matrix<Scalar> Matrix<Scalar>::vertcat(const std::vector<Matrix<Scalar> > &v) {
-    std::vector<Matrix<Scalar> > vT(v.size());
-    for (casadi_int i=0; i<v.size(); ++i) vT[i] = v[i].T();
-    return horzcat(vT).T();
+    // Concatenate sparsity patterns
+    std::vector<Sparsity> sp(v.size());
+    for (casadi_int i=0; i<v.size(); ++i) sp[i] = v[i].sparsity();
+    Matrix<Scalar> ret = zeros(Sparsity::vertcat(sp));
+
+    // Copy nonzeros, column by column
+    auto i=ret->begin();
+    for (casadi_int cc=0; cc<ret.size2(); ++cc) {
+      for (auto&& j : v) {
+        if (j.size2()!=ret.size2()) continue;
+        const casadi_int* colind = j.colind();
+        i = std::copy(j->begin()+colind[cc], j->begin()+colind[cc+1], i);
+      }
+    }
+    return ret;
   }
 
   template<typename Scalar>
@@ -2182,6 +2324,56 @@ namespace casadi {
   template<typename Scalar>
   Matrix<Scalar> Matrix<Scalar>::
   inv(const Matrix<Scalar>& a) {
+    casadi_int n = a.size2();
+    // Sparse elimination, the inverse of A(rowperm, colperm) = (I+L)*U is U\((I+L)\I)
+    if (n>3 && a.is_square() && !std::numeric_limits<Scalar>::is_integer) {
+      // Structural zeros would become zero pivots
+      if (a.has_zeros()) return inv(sparsify(a));
+      if (Sparsity::sprank(a.sparsity())==n) {
+        Sparsity L, U;
+        std::vector<casadi_int> rowperm, colperm;
+        a.sparsity().lu_sparse(L, U, rowperm, colperm);
+        std::vector<Scalar> L_nz, U_nz;
+        if (lu_numeric(a(rowperm, colperm), L, U, L_nz, U_nz)) {
+          const casadi_int *l_colind = L.colind(), *l_row = L.row();
+          const casadi_int *u_colind = U.colind(), *u_row = U.row();
+          std::vector<casadi_int> ret_row, ret_col;
+          std::vector<Scalar> ret_nz, w(n, 0);
+          std::vector<bool> mark(n, false);
+          for (casadi_int j=0; j<n; ++j) {
+            w[j] = 1;
+            mark[j] = true;
+            // Forward substitution, only rows j and below can be nonzero
+            for (casadi_int k=j; k<n; ++k) {
+              if (!mark[k]) continue;
+              for (casadi_int el=l_colind[k]; el<l_colind[k+1]; ++el) {
+                w[l_row[el]] -= L_nz[el]*w[k];
+                mark[l_row[el]] = true;
+              }
+            }
+            // Backward substitution
+            for (casadi_int k=n-1; k>=0; --k) {
+              if (!mark[k]) continue;
+              w[k] /= U_nz[u_colind[k+1]-1];
+              for (casadi_int el=u_colind[k]; el<u_colind[k+1]-1; ++el) {
+                w[u_row[el]] -= U_nz[el]*w[k];
+                mark[u_row[el]] = true;
+              }
+            }
+            // Undo the permutations
+            for (casadi_int k=0; k<n; ++k) {
+              if (!mark[k]) continue;
+              ret_row.push_back(colperm[k]);
+              ret_col.push_back(rowperm[j]);
+              ret_nz.push_back(w[k]);
+              w[k] = 0;
+              mark[k] = false;
+            }
+          }
+          return triplet(ret_row, ret_col, ret_nz, n, n);
+        }
+      }
+    }
     return solve(a, Matrix<Scalar>::eye(a.size1()));
   }
 
@@ -3282,9 +3474,12 @@ namespace casadi {
 
   template<>
   SX SX::jacobian(const SX &f, const SX &x, const Dict& opts) {
-    // Propagate verbose option to helper function
+    // Propagate verbose, coloring, AD mode timing and sparsity cache options to helper function
     Dict h_opts;
-    if (opts.count("verbose")) h_opts["verbose"] = opts.at("verbose");
+    for (const char* op : {"verbose", "coloring_num_threads", "ad_num_threads",
+                           "ad_weight_timing", "sparsity_cache"}) {
+      if (opts.count(op)) h_opts[op] = opts.at(op);
+    }
     Function h("jac_helper", {x}, {f}, h_opts);
     return h.get<SXFunction>()->jac(0, 0, opts);
   }
@@ -3861,29 +4056,16 @@ namespace casadi {
 
   template<>
   void DM::to_file(const std::string& filename, const std::string& format_hint) const {
-    std::string format = format_hint;
-    if (format_hint=="") {
-      std::string extension = filename.substr(filename.rfind(".")+1);
-      if (extension=="mtx") {
-        format = "mtx";
-      } else {
-        casadi_error("Could not detect format from extension '" + extension + "'");
-      }
-    }
-    std::ofstream out(filename);
-    if (format=="mtx") {
-      out << std::scientific << std::setprecision(15);
-      out << "%%MatrixMarket matrix coordinate real general" << std::endl;
-      out << size1() << " " << size2() << " " << nnz() << std::endl;
-      std::vector<casadi_int> row = sparsity().get_row();
-      std::vector<casadi_int> col = sparsity().get_col();
+    write_sparse(filename, Sparsity::file_format(filename, format_hint), sparsity(), ptr());
+  }
 
-      for (casadi_int k=0;k<row.size();++k) {
-        out << row[k]+1 << " " << col[k]+1 << " " << nonzeros_[k] << std::endl;
-      }
-    } else {
-      casadi_error("Unknown format '" + format + "'");
-    }
+  template<>
+  DM DM::from_file(const std::string& filename, const std::string& format_hint) {
+    std::vector<double> nz;
+    Sparsity sp = read_sparse(filename, Sparsity::file_format(filename, format_hint), &nz);
+    DM ret = DM::zeros(sp);
+    ret.nonzeros().swap(nz);
+    return ret;
   }
 
   template<>
@@ -3896,6 +4078,18 @@ namespace casadi {
     casadi_error("Not implemented");
   }
 
+  template<>
+  SX SX::from_file(const std::string& filename, const std::string& format_hint) {
+    casadi_error("Not implemented");
+    return SX();
+  }
+
+  template<>
+  IM IM::from_file(const std::string& filename, const std::string& format_hint) {
+    casadi_error("Not implemented");
+    return IM();
+  }
+
   // Instantiate templates
   template class casadi_limits<double>;
   template class casadi_limits<casadi_int>;
@@ -315,6 +315,7 @@ namespace casadi {
     static Matrix<Scalar> _bilin(const Matrix<Scalar>& A,
                                    const Matrix<Scalar>& x,
                                    const Matrix<Scalar>& y);
+    static Matrix<Scalar> _conv(const Matrix<Scalar>& h, const Matrix<Scalar>& x);
     static Matrix<Scalar> _rank1(const Matrix<Scalar>& A,
                                    const Matrix<Scalar>& alpha,
                                    const Matrix<Scalar>& x,
@@ -890,6 +891,22 @@ namespace casadi {
                                   const std::pair<casadi_int, casadi_int>& rc);
     ///@}
 
+    /** \brief Assemble a sparse matrix from triplets, summing duplicate entries
+        cf. Sparsity::assemble. When assembling repeatedly with the same structure,
+        compute the pattern and nz once and use assemble(sp, nz, d) instead.
+    */
+    static Matrix<Scalar> assemble(const std::vector<casadi_int>& row,
+                                   const std::vector<casadi_int>& col,
+                                   const Matrix<Scalar>& d, casadi_int nrow, casadi_int ncol,
+                                   casadi_int n_threads=1);
+
+    /** \brief Assemble into a precomputed sparsity pattern
+        Scatter-adds the nonzeros of d into the nonzeros nz of sp, without any sorting.
+        nz can come from Sparsity::assemble or from sp.get_nz on the linear indices.
+    */
+    static Matrix<Scalar> assemble(const Sparsity& sp, const std::vector<casadi_int>& nz,
+                                   const Matrix<Scalar>& d);
+
     ///@{
     /** \brief  create a matrix with all inf */
     static Matrix<Scalar> inf(const Sparsity& sp);
@@ -1070,9 +1087,20 @@ namespace casadi {
     *
     * Supported formats:
     *   - .mtx   Matrix Market
+    *   - .csc   Raw compressed column storage, binary
+    *
+    * For exchange in memory, ptr() points to the nonzeros in compressed column storage.
     */
     void to_file(const std::string& filename, const std::string& format="") const;
 
+    /** Import numerical matrix from file, memory-mapped where supported
+    *
+    * Supported formats as for to_file. Matrix Market files may also be symmetric,
+    * patterns (all ones) or dense arrays.
+    */
+    static Matrix<Scalar> from_file(const std::string& filename,
+                                    const std::string& format_hint="");
+
 #ifndef SWIG
     /// Sparse matrix with a given sparsity with all values same
     Matrix(const Sparsity& sp, const Scalar& val, bool dummy);
@@ -0,0 +1,149 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#include "memoize.hpp"
+#include <cstring>
+
+using namespace std;
+
+namespace casadi {
+
+  Memoize::Memoize(const std::string& name, const Function& f, casadi_int cache_size)
+    : FunctionInternal(name), f_(f), cache_size_(cache_size), n_hit_(0), n_miss_(0) {
+    casadi_assert(cache_size_>0, "Cache size must be positive");
+  }
+
+  Memoize::~Memoize() {
+  }
+
+  void Memoize::init(const Dict& opts) {
+    // Call the initialization method of the base class
+    FunctionInternal::init(opts);
+
+    // Evaluation of the wrapped Function
+    alloc(f_);
+
+    // Input and output values of an evaluation
+    alloc_res(n_out_, true);
+    alloc_w(nnz_in() + nnz_out(), true);
+  }
+
+  int Memoize::eval(const double** arg, double** res,
+                    casadi_int* iw, double* w, void* mem) const {
+    // Input values, missing inputs are zero
+    double* val = w; w += nnz_in() + nnz_out();
+    double* v = val;
+    for (casadi_int i=0; i<n_in_; ++i) {
+      casadi_copy(arg[i], nnz_in(i), v);
+      v += nnz_in(i);
+    }
+
+    // Hash the bit patterns of the input values
+    size_t h = 0;
+    for (casadi_int k=0; k<nnz_in(); ++k) {
+      uint64_t b;
+      memcpy(&b, val + k, sizeof(b));
+      hash_combine(h, b);
+    }
+
+    // Look up in the cache
+    {
+#ifdef CASADI_WITH_THREAD
+      std::lock_guard<std::mutex> lock(mtx_);
+#endif // CASADI_WITH_THREAD
+      for (auto it=cache_.begin(); it!=cache_.end(); ++it) {
+        if (it->hash==h && memcmp(get_ptr(it->val), val, nnz_in()*sizeof(double))==0) {
+          // Hit: copy the cached outputs and mark as most recently used
+          const double* r = get_ptr(it->val) + nnz_in();
+          for (casadi_int i=0; i<n_out_; ++i) {
+            casadi_copy(r, nnz_out(i), res[i]);
+            r += nnz_out(i);
+          }
+          cache_.splice(cache_.begin(), cache_, it);
+          n_hit_++;
+          return 0;
+        }
+      }
+    }
+
+    // Miss: evaluate all outputs, without holding the lock
+    double** res1 = res + n_out_;
+    for (casadi_int i=0; i<n_out_; ++i) {
+      res1[i] = v;
+      v += nnz_out(i);
+    }
+    if (f_(arg, res1, iw, w)) return 1;
+    v = val + nnz_in();
+    for (casadi_int i=0; i<n_out_; ++i) {
+      casadi_copy(v, nnz_out(i), res[i]);
+      v += nnz_out(i);
+    }
+
+    // Add to the cache, dropping the least recently used evaluation if full
+#ifdef CASADI_WITH_THREAD
+    std::lock_guard<std::mutex> lock(mtx_);
+#endif // CASADI_WITH_THREAD
+    n_miss_++;
+    cache_.push_front(Entry{h, vector<double>(val, val + nnz_in() + nnz_out())});
+    if (static_cast<casadi_int>(cache_.size())>cache_size_) cache_.pop_back();
+    return 0;
+  }
+
+  int Memoize::eval_sx(const SXElem** arg, SXElem** res,
+                       casadi_int* iw, SXElem* w, void* mem) const {
+    return f_(arg, res, iw, w);
+  }
+
+  int Memoize::sp_forward(const bvec_t** arg, bvec_t** res,
+                          casadi_int* iw, bvec_t* w, void* mem) const {
+    return f_(arg, res, iw, w);
+  }
+
+  int Memoize::sp_reverse(bvec_t** arg, bvec_t** res,
+                          casadi_int* iw, bvec_t* w, void* mem) const {
+    return f_.rev(arg, res, iw, w);
+  }
+
+  void Memoize::codegen_declarations(CodeGenerator& g) const {
+    g.add_dependency(f_);
+  }
+
+  void Memoize::codegen_body(CodeGenerator& g) const {
+    // Generated code evaluates the wrapped Function directly
+    g << "return " << g(f_, "arg", "res", "iw", "w") << ";\n";
+  }
+
+  Dict Memoize::get_stats(void* mem) const {
+#ifdef CASADI_WITH_THREAD
+    std::lock_guard<std::mutex> lock(mtx_);
+#endif // CASADI_WITH_THREAD
+    casadi_int n_call = n_hit_ + n_miss_;
+    return {{"n_hit", n_hit_}, {"n_miss", n_miss_},
+            {"hit_rate", n_call==0 ? 0. : static_cast<double>(n_hit_)/n_call},
+            {"n_cached", static_cast<casadi_int>(cache_.size())}};
+  }
+
+} // namespace casadi
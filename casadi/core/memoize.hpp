@@ -0,0 +1,173 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#ifndef CASADI_MEMOIZE_HPP
+#define CASADI_MEMOIZE_HPP
+
+#include "function_internal.hpp"
+#include <list>
+
+/// \cond INTERNAL
+
+namespace casadi {
+
+  /** \brief Function that reuses the results of recent numerical evaluations
+
+  Created with Function::memoize. A bounded least-recently-used cache, shared by all
+  memory objects, maps input values to output values. Lookups hash the input values
+  and compare them exactly. Symbolic evaluation, derivatives and code generation use
+  the wrapped Function, which must not have side effects.
+  */
+  class CASADI_EXPORT Memoize : public FunctionInternal {
+  public:
+    /** \brief Constructor */
+    Memoize(const std::string& name, const Function& f, casadi_int cache_size);
+
+    /** \brief Destructor */
+    ~Memoize() override;
+
+    /** \brief Get type name */
+    std::string class_name() const override {return "Memoize";}
+
+    /// @{
+    /** \brief Sparsities of function inputs and outputs */
+    Sparsity get_sparsity_in(casadi_int i) override { return f_.sparsity_in(i);}
+    Sparsity get_sparsity_out(casadi_int i) override { return f_.sparsity_out(i);}
+    /// @}
+
+    /** \brief Get default input value */
+    double get_default_in(casadi_int ind) const override { return f_.default_in(ind);}
+
+    ///@{
+    /** \brief Number of function inputs and outputs */
+    size_t get_n_in() override { return f_.n_in();}
+    size_t get_n_out() override { return f_.n_out();}
+    ///@}
+
+    ///@{
+    /** \brief Names of function input and outputs */
+    std::string get_name_in(casadi_int i) override { return f_.name_in(i);}
+    std::string get_name_out(casadi_int i) override { return f_.name_out(i);}
+    /// @}
+
+    /** \brief  Initialize */
+    void init(const Dict& opts) override;
+
+    /// Evaluate numerically, reusing a cached result if the inputs match
+    int eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const override;
+
+    /** \brief  Evaluate symbolically, SX type */
+    int eval_sx(const SXElem** arg, SXElem** res,
+                casadi_int* iw, SXElem* w, void* mem) const override;
+
+    /** \brief  Propagate sparsity forward */
+    int sp_forward(const bvec_t** arg, bvec_t** res,
+                   casadi_int* iw, bvec_t* w, void* mem) const override;
+
+    /** \brief  Propagate sparsity backwards */
+    int sp_reverse(bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w, void* mem) const override;
+
+    ///@{
+    /// Is the class able to propagate seeds through the algorithm?
+    bool has_spfwd() const override { return true;}
+    bool has_sprev() const override { return true;}
+    ///@}
+
+    /** \brief Thread-safe if the function evaluated is */
+    bool is_thread_safe() const override { return f_->is_thread_safe();}
+
+    ///@{
+    /** \brief Derivatives of the wrapped Function, not cached */
+    bool has_forward(casadi_int nfwd) const override { return f_->has_forward(nfwd);}
+    Function get_forward(casadi_int nfwd, const std::string& name,
+                         const std::vector<std::string>& inames,
+                         const std::vector<std::string>& onames,
+                         const Dict& opts) const override {
+      return f_->get_forward(nfwd, name, inames, onames, opts);
+    }
+    bool has_reverse(casadi_int nadj) const override { return f_->has_reverse(nadj);}
+    Function get_reverse(casadi_int nadj, const std::string& name,
+                         const std::vector<std::string>& inames,
+                         const std::vector<std::string>& onames,
+                         const Dict& opts) const override {
+      return f_->get_reverse(nadj, name, inames, onames, opts);
+    }
+    bool has_jacobian() const override { return f_->has_jacobian();}
+    Function get_jacobian(const std::string& name,
+                          const std::vector<std::string>& inames,
+                          const std::vector<std::string>& onames,
+                          const Dict& opts) const override {
+      return f_->get_jacobian(name, inames, onames, opts);
+    }
+    ///@}
+
+    /** \brief Is codegen supported? */
+    bool has_codegen() const override { return f_->has_codegen();}
+
+    /** \brief Generate code for the declarations of the C function */
+    void codegen_declarations(CodeGenerator& g) const override;
+
+    /** \brief Generate code for the body of the C function */
+    void codegen_body(CodeGenerator& g) const override;
+
+    /** \brief Cache statistics, shared by all memory objects */
+    Dict get_stats(void* mem) const override;
+
+    /** Obtain information about node */
+    Dict info() const override { return {{"f", f_}, {"cache_size", cache_size_}};}
+
+  protected:
+    // Cached evaluation
+    struct Entry {
+      // Hash of the input values
+      std::size_t hash;
+      // Nonzeros of all inputs, followed by the nonzeros of all outputs
+      std::vector<double> val;
+    };
+
+    // Wrapped Function
+    Function f_;
+
+    // Maximum number of cached evaluations
+    casadi_int cache_size_;
+
+    // Cached evaluations, most recently used first
+    mutable std::list<Entry> cache_;
+
+    // Statistics
+    mutable casadi_int n_hit_, n_miss_;
+
+#ifdef CASADI_WITH_THREAD
+    // The cache is shared between threads
+    mutable std::mutex mtx_;
+#endif // CASADI_WITH_THREAD
+  };
+
+} // namespace casadi
+
+/// \endcond
+
+#endif // CASADI_MEMOIZE_HPP
@@ -0,0 +1,390 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#include "mlp.hpp"
+
+using namespace std;
+namespace casadi {
+
+  Function Mlp::create(const std::string& name, const std::vector<DM>& weights,
+                       const std::vector<DM>& biases,
+                       const std::vector<std::string>& activations, const Dict& opts) {
+    casadi_int n_layers = weights.size();
+    casadi_assert(n_layers>0, "At least one layer required");
+    casadi_assert(biases.empty() || biases.size()==n_layers,
+      "Expected " + str(n_layers) + " bias vectors, got " + str(biases.size()));
+    casadi_assert(activations.size()==n_layers || activations.size()==1,
+      "Expected one activation per layer, or a single one for the hidden layers");
+    // Activation of each layer, a single one applies to the hidden layers only
+    vector<casadi_int> act(n_layers);
+    for (casadi_int l=0; l<n_layers; ++l) {
+      string a;
+      if (activations.size()==n_layers) {
+        a = activations[l];
+      } else {
+        a = l<n_layers-1 || n_layers==1 ? activations.front() : "identity";
+      }
+      if (a=="identity" || a=="linear") {
+        act[l] = ACT_IDENTITY;
+      } else if (a=="tanh") {
+        act[l] = ACT_TANH;
+      } else if (a=="sigmoid") {
+        act[l] = ACT_SIGMOID;
+      } else if (a=="relu") {
+        act[l] = ACT_RELU;
+      } else if (a=="softplus") {
+        act[l] = ACT_SOFTPLUS;
+      } else {
+        casadi_error("Unknown activation '" + a + "', expected 'identity', 'tanh', "
+                     "'sigmoid', 'relu' or 'softplus'");
+      }
+    }
+    return Function::create(new Mlp(name, weights, biases, act, false), opts);
+  }
+
+  Mlp::Mlp(const std::string& name, const std::vector<DM>& weights,
+           const std::vector<DM>& biases, const std::vector<casadi_int>& act, bool all_layers)
+    : FunctionInternal(name), W_(weights), b_(biases), act_(act), all_layers_(all_layers) {
+    // Layer widths
+    width_.push_back(W_.front().size2());
+    for (casadi_int l=0; l<n_layers(); ++l) {
+      casadi_assert(W_[l].size2()==width_.back(),
+        "Weight matrix " + str(l) + " has " + str(W_[l].size2()) + " columns, "
+        "expected " + str(width_.back()));
+      casadi_assert(W_[l].size1()>0, "Weight matrix " + str(l) + " has no rows");
+      width_.push_back(W_[l].size1());
+    }
+    if (b_.empty()) {
+      for (casadi_int l=0; l<n_layers(); ++l) b_.push_back(DM::zeros(width_[l+1]));
+    }
+    for (casadi_int l=0; l<n_layers(); ++l) {
+      casadi_assert(b_[l].is_empty() || (b_[l].is_column() && b_[l].size1()==width_[l+1]),
+        "Bias vector " + str(l) + " must have length " + str(width_[l+1]));
+      if (b_[l].is_empty()) b_[l] = DM::zeros(width_[l+1]);
+    }
+  }
+
+  void Mlp::init(const Dict& opts) {
+    // Call the initialization method of the base class
+    FunctionInternal::init(opts);
+
+    // Dense weights and biases
+    W_nz_.resize(n_layers());
+    b_nz_.resize(n_layers());
+    for (casadi_int l=0; l<n_layers(); ++l) {
+      W_nz_[l] = densify(W_[l]).nonzeros();
+      b_nz_[l] = densify(b_[l]).nonzeros();
+    }
+
+    // Two buffers for the layer activations
+    max_width_ = *max_element(width_.begin(), width_.end());
+    alloc_w(2*max_width_, true);
+  }
+
+  namespace {
+    // Apply an activation function in place
+    template<typename T>
+    void mlp_activate(T* z, casadi_int n, casadi_int act) {
+      using std::tanh; using std::exp; using std::log; using std::fabs; using std::fmax;
+      switch (act) {
+        case Mlp::ACT_TANH:
+          for (casadi_int i=0; i<n; ++i) z[i] = tanh(z[i]);
+          break;
+        case Mlp::ACT_SIGMOID:
+          for (casadi_int i=0; i<n; ++i) z[i] = T(1)/(T(1) + exp(-z[i]));
+          break;
+        case Mlp::ACT_RELU:
+          for (casadi_int i=0; i<n; ++i) z[i] = fmax(z[i], T(0));
+          break;
+        case Mlp::ACT_SOFTPLUS:
+          // Overflow-free log(1+exp(z))
+          for (casadi_int i=0; i<n; ++i) {
+            z[i] = fmax(z[i], T(0)) + log(T(1) + exp(-fabs(z[i])));
+          }
+          break;
+        default: break;
+      }
+    }
+  } // namespace
+
+  template<typename T>
+  void Mlp::eval_gen(const T* x, T** res, T* w, casadi_int n,
+                     const std::vector<const T*>& W, const std::vector<const T*>& b) const {
+    const T* h = x;
+    for (casadi_int l=0; l<n_layers(); ++l) {
+      casadi_int n0 = width_[l], n1 = width_[l+1];
+      T* z = w + (l % 2)*n*max_width_;
+      // z <- act(W*h + b), all points at once
+      for (casadi_int k=0; k<n; ++k) casadi_copy(b[l], n1, z + k*n1);
+      if (h) casadi_mtimes_dense(W[l], n1, n0, h, n, z);
+      mlp_activate(z, n1*n, act_[l]);
+      if (all_layers_ && res[l]) casadi_copy(z, n1*n, res[l]);
+      h = z;
+    }
+    if (!all_layers_ && res[0]) casadi_copy(h, width_.back()*n, res[0]);
+  }
+
+  int Mlp::eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const {
+    return eval_batch(arg, res, iw, w, mem, 1);
+  }
+
+  int Mlp::eval_batch(const double** arg, double** res, casadi_int* iw, double* w,
+                      void* mem, casadi_int n) const {
+    vector<const double*> W(n_layers()), b(n_layers());
+    for (casadi_int l=0; l<n_layers(); ++l) {
+      W[l] = get_ptr(W_nz_[l]);
+      b[l] = get_ptr(b_nz_[l]);
+    }
+    eval_gen(arg[0], res, w, n, W, b);
+    return 0;
+  }
+
+  int Mlp::eval_sx(const SXElem** arg, SXElem** res,
+                   casadi_int* iw, SXElem* w, void* mem) const {
+    vector<vector<SXElem> > W_sx(n_layers()), b_sx(n_layers());
+    vector<const SXElem*> W(n_layers()), b(n_layers());
+    for (casadi_int l=0; l<n_layers(); ++l) {
+      W_sx[l].assign(W_nz_[l].begin(), W_nz_[l].end());
+      b_sx[l].assign(b_nz_[l].begin(), b_nz_[l].end());
+      W[l] = get_ptr(W_sx[l]);
+      b[l] = get_ptr(b_sx[l]);
+    }
+    eval_gen(arg[0], res, w, 1, W, b);
+    return 0;
+  }
+
+  void Mlp::codegen_layers(CodeGenerator& g, casadi_int n, const std::string& nb,
+                           const std::string& arg, const std::string& res,
+                           const std::string& w) const {
+    g.add_auxiliary(CodeGenerator::AUX_COPY);
+    g << "{\n"
+      << "casadi_int i, j;\n"
+      << "casadi_real *h[2];\n"
+      << "h[0] = " << w << ";\n"
+      << "h[1] = " << w << "+" << n*max_width_ << ";\n";
+    for (casadi_int l=0; l<n_layers(); ++l) {
+      casadi_int n0 = width_[l], n1 = width_[l+1];
+      string z = "h[" + str(l % 2) + "]";
+      string x = l==0 ? arg + "[0]" : "h[" + str((l-1) % 2) + "]";
+      g << "/* Layer " << l << " */\n";
+      g << "for (j=0; j<" << nb << "; ++j) casadi_copy(" << g.constant(b_nz_[l]) << ", "
+        << n1 << ", " << z << "+j*" << n1 << ");\n";
+      if (l==0) g << "if (" << x << ") ";
+      g << g.mtimes(g.constant(W_nz_[l]), n1, n0, x, nb, z) << "\n";
+      string zi = z + "[i]";
+      switch (act_[l]) {
+        case ACT_TANH:
+          g << "for (i=0; i<" << n1 << "*" << nb << "; ++i) " << zi << " = tanh(" << zi << ");\n";
+          break;
+        case ACT_SIGMOID:
+          g << "for (i=0; i<" << n1 << "*" << nb << "; ++i) "
+            << zi << " = 1/(1+exp(-" << zi << "));\n";
+          break;
+        case ACT_RELU:
+          g << "for (i=0; i<" << n1 << "*" << nb << "; ++i) if (" << zi << "<0) " << zi << " = 0;\n";
+          break;
+        case ACT_SOFTPLUS:
+          g << "for (i=0; i<" << n1 << "*" << nb << "; ++i) "
+            << zi << " = (" << zi << ">0 ? " << zi << " : 0) + log(1+exp(-fabs(" << zi << ")));\n";
+          break;
+        default: break;
+      }
+      if (all_layers_) {
+        g << "if (" << res << "[" << l << "]) casadi_copy(" << z << ", " << n1 << "*" << nb
+          << ", " << res << "[" << l << "]);\n";
+      }
+    }
+    if (!all_layers_) {
+      g << "if (" << res << "[0]) casadi_copy(h[" << ((n_layers()-1) % 2) << "], "
+        << width_.back() << "*" << nb << ", " << res << "[0]);\n";
+    }
+    g << "}\n";
+  }
+
+  void Mlp::codegen_body(CodeGenerator& g) const {
+    codegen_layers(g, 1, "1", "arg", "res", "w");
+  }
+
+  void Mlp::codegen_body_batch(CodeGenerator& g, casadi_int n, const std::string& nb,
+                               const std::string& arg, const std::string& res,
+                               const std::string& w) const {
+    codegen_layers(g, n, nb, arg, res, w);
+  }
+
+  int Mlp::sp_forward(const bvec_t** arg, bvec_t** res,
+                      casadi_int* iw, bvec_t* w, void* mem) const {
+    const bvec_t* h = arg[0];
+    for (casadi_int l=0; l<n_layers(); ++l) {
+      casadi_int n0 = width_[l], n1 = width_[l+1];
+      bvec_t* z = w + (l % 2)*max_width_;
+      fill_n(z, n1, 0);
+      if (h) {
+        const casadi_int *colind = W_[l].colind(), *row = W_[l].row();
+        for (casadi_int j=0; j<n0; ++j) {
+          for (casadi_int k=colind[j]; k<colind[j+1]; ++k) z[row[k]] |= h[j];
+        }
+      }
+      if (all_layers_ && res[l]) copy_n(z, n1, res[l]);
+      h = z;
+    }
+    if (!all_layers_ && res[0]) copy_n(h, width_.back(), res[0]);
+    return 0;
+  }
+
+  int Mlp::sp_reverse(bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w, void* mem) const {
+    casadi_int L = n_layers();
+    // Seeds of the last layer
+    bvec_t* a = w;
+    bvec_t* seed = all_layers_ ? res[L-1] : res[0];
+    if (seed) {
+      copy_n(seed, width_.back(), a);
+      fill_n(seed, width_.back(), 0);
+    } else {
+      fill_n(a, width_.back(), 0);
+    }
+    for (casadi_int l=L-1; l>=0; --l) {
+      casadi_int n0 = width_[l];
+      bvec_t* z = w + ((L-l) % 2)*max_width_;
+      fill_n(z, n0, 0);
+      const casadi_int *colind = W_[l].colind(), *row = W_[l].row();
+      for (casadi_int j=0; j<n0; ++j) {
+        for (casadi_int k=colind[j]; k<colind[j+1]; ++k) z[j] |= a[row[k]];
+      }
+      // Seeds of the hidden layer
+      if (l>0 && all_layers_ && res[l-1]) {
+        for (casadi_int j=0; j<n0; ++j) z[j] |= res[l-1][j];
+        fill_n(res[l-1], n0, 0);
+      }
+      a = z;
+    }
+    if (arg[0]) {
+      for (casadi_int j=0; j<width_.front(); ++j) arg[0][j] |= a[j];
+    }
+    return 0;
+  }
+
+  std::vector<MX> Mlp::layers(const MX& x) const {
+    Function f = Function::create(new Mlp(name_ + "_layers", W_, b_, act_, true), Dict());
+    return f(vector<MX>{x});
+  }
+
+  MX Mlp::dact(casadi_int l, const MX& h) const {
+    switch (act_[l]) {
+      case ACT_TANH: return 1 - sq(h);
+      case ACT_SIGMOID: return h*(1 - h);
+      case ACT_RELU: return h>0;
+      case ACT_SOFTPLUS: return 1 - exp(-h);
+      default: return MX();
+    }
+  }
+
+  std::vector<MX> Mlp::fwd(const std::vector<MX>& h, const MX& seed) const {
+    vector<MX> ret;
+    MX t = seed;
+    for (casadi_int l=0; l<n_layers(); ++l) {
+      t = mtimes(MX(W_[l]), t);
+      if (act_[l]!=ACT_IDENTITY) t = repmat(dact(l, h[l]), 1, t.size2()) * t;
+      ret.push_back(t);
+    }
+    return ret;
+  }
+
+  MX Mlp::rev(const std::vector<MX>& h, const std::vector<MX>& seed) const {
+    MX a = seed.back();
+    for (casadi_int l=n_layers()-1; l>=0; --l) {
+      if (act_[l]!=ACT_IDENTITY) a = repmat(dact(l, h[l]), 1, a.size2()) * a;
+      a = mtimes(MX(W_[l]).T(), a);
+      if (l>0 && !seed[l-1].is_empty()) a += seed[l-1];
+    }
+    return a;
+  }
+
+  Function Mlp::get_forward(casadi_int nfwd, const std::string& name,
+                            const std::vector<std::string>& inames,
+                            const std::vector<std::string>& onames,
+                            const Dict& opts) const {
+    // Nondifferentiated inputs and outputs
+    vector<MX> arg = {MX::sym(inames.at(0), sparsity_in_.at(0))};
+    for (casadi_int i=0; i<n_out_; ++i) {
+      arg.push_back(MX::sym(inames.at(1+i), Sparsity(size_out(i))));
+    }
+    // Forward seeds, stacked horizontally
+    MX seed = MX::sym(inames.at(1+n_out_), width_.front(), nfwd);
+    arg.push_back(seed);
+    // Forward sensitivities
+    vector<MX> t = fwd(layers(arg[0]), seed);
+    vector<MX> res = all_layers_ ? t : vector<MX>{t.back()};
+    return Function(name, arg, res, inames, onames, opts);
+  }
+
+  Function Mlp::get_reverse(casadi_int nadj, const std::string& name,
+                            const std::vector<std::string>& inames,
+                            const std::vector<std::string>& onames,
+                            const Dict& opts) const {
+    // Nondifferentiated inputs and outputs
+    vector<MX> arg = {MX::sym(inames.at(0), sparsity_in_.at(0))};
+    for (casadi_int i=0; i<n_out_; ++i) {
+      arg.push_back(MX::sym(inames.at(1+i), Sparsity(size_out(i))));
+    }
+    // Adjoint seeds, stacked horizontally, on the output of each layer
+    vector<MX> seed(n_layers());
+    for (casadi_int i=0; i<n_out_; ++i) {
+      MX s = MX::sym(inames.at(1+n_out_+i), size1_out(i), nadj);
+      arg.push_back(s);
+      seed[all_layers_ ? i : n_layers()-1] = s;
+    }
+    // Adjoint sensitivities
+    return Function(name, arg, {rev(layers(arg[0]), seed)}, inames, onames, opts);
+  }
+
+  Function Mlp::get_jacobian(const std::string& name,
+                             const std::vector<std::string>& inames,
+                             const std::vector<std::string>& onames,
+                             const Dict& opts) const {
+    casadi_int nx = width_.front(), ny = width_.back();
+    vector<MX> arg = {MX::sym(inames.at(0), sparsity_in_.at(0))};
+    for (casadi_int i=0; i<n_out_; ++i) {
+      arg.push_back(MX::sym(inames.at(1+i), Sparsity(size_out(i))));
+    }
+    vector<MX> h = layers(arg[0]);
+    MX J;
+    if (!all_layers_ && ny<nx) {
+      // Fewer outputs than inputs: propagate unit seeds backwards
+      vector<MX> seed(n_layers());
+      seed.back() = MX(densify(DM::eye(ny)));
+      J = rev(h, seed).T();
+    } else {
+      vector<MX> t = fwd(h, MX(densify(DM::eye(nx))));
+      J = all_layers_ ? vertcat(t) : t.back();
+    }
+    return Function(name, arg, {J}, inames, onames, opts);
+  }
+
+  Dict Mlp::info() const {
+    return {{"width", width_}, {"activation", act_}};
+  }
+
+} // namespace casadi
@@ -0,0 +1,197 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#ifndef CASADI_MLP_HPP
+#define CASADI_MLP_HPP
+
+#include "function_internal.hpp"
+
+/// \cond INTERNAL
+namespace casadi {
+
+  /** \brief Stacked dense layers, h_{l+1} = act_l(W_l*h_l + b_l)
+
+      Created with Function::mlp. Each layer is evaluated as a bias fill, a dense
+      matrix-matrix product (cblas gemm in generated code with the "blas" option) and an
+      activation, in place. Batched evaluation multiplies all points of a layer at once.
+      Derivatives are MX expressions in the constant weights, with the activations of
+      all layers obtained from a variant of the function that returns them.
+  */
+  class CASADI_EXPORT Mlp : public FunctionInternal {
+  public:
+    /// Activation functions
+    enum Activation {ACT_IDENTITY, ACT_TANH, ACT_SIGMOID, ACT_RELU, ACT_SOFTPLUS};
+
+    /** \brief Create from weight matrices, bias vectors and activation names */
+    static Function create(const std::string& name, const std::vector<DM>& weights,
+                           const std::vector<DM>& biases,
+                           const std::vector<std::string>& activations,
+                           const Dict& opts=Dict());
+
+    /** \brief Constructor */
+    Mlp(const std::string& name, const std::vector<DM>& weights,
+        const std::vector<DM>& biases, const std::vector<casadi_int>& act, bool all_layers);
+
+    /** \brief Destructor */
+    ~Mlp() override { clear_mem();}
+
+    /** \brief Get type name */
+    std::string class_name() const override {return "Mlp";}
+
+    ///@{
+    /** \brief Number of function inputs and outputs */
+    size_t get_n_in() override { return 1;}
+    size_t get_n_out() override { return all_layers_ ? n_layers() : 1;}
+    ///@}
+
+    /// @{
+    /** \brief Sparsities of function inputs and outputs */
+    Sparsity get_sparsity_in(casadi_int i) override { return Sparsity::dense(width_.front());}
+    Sparsity get_sparsity_out(casadi_int i) override {
+      return Sparsity::dense(all_layers_ ? width_.at(i+1) : width_.back());
+    }
+    /// @}
+
+    /** \brief  Initialize */
+    void init(const Dict& opts) override;
+
+    /** \brief  Evaluate numerically */
+    int eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const override;
+
+    /** \brief  Evaluate symbolically, SX type */
+    int eval_sx(const SXElem** arg, SXElem** res,
+                casadi_int* iw, SXElem* w, void* mem) const override;
+
+    ///@{
+    /** \brief Batched evaluation, one matrix-matrix product per layer */
+    bool has_eval_batch() const override { return true;}
+    int eval_batch(const double** arg, double** res, casadi_int* iw, double* w,
+                   void* mem, casadi_int n) const override;
+    void codegen_body_batch(CodeGenerator& g, casadi_int n, const std::string& nb,
+                            const std::string& arg, const std::string& res,
+                            const std::string& w) const override;
+    ///@}
+
+    /** \brief  Propagate sparsity forward */
+    int sp_forward(const bvec_t** arg, bvec_t** res,
+                   casadi_int* iw, bvec_t* w, void* mem) const override;
+
+    /** \brief  Propagate sparsity backwards */
+    int sp_reverse(bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w, void* mem) const override;
+
+    ///@{
+    /// Is the class able to propagate seeds through the algorithm?
+    bool has_spfwd() const override { return true;}
+    bool has_sprev() const override { return true;}
+    ///@}
+
+    ///@{
+    /** \brief Generate a function that calculates \a nfwd forward derivatives */
+    bool has_forward(casadi_int nfwd) const override { return true;}
+    Function get_forward(casadi_int nfwd, const std::string& name,
+                         const std::vector<std::string>& inames,
+                         const std::vector<std::string>& onames,
+                         const Dict& opts) const override;
+    ///@}
+
+    ///@{
+    /** \brief Generate a function that calculates \a nadj adjoint derivatives */
+    bool has_reverse(casadi_int nadj) const override { return true;}
+    Function get_reverse(casadi_int nadj, const std::string& name,
+                         const std::vector<std::string>& inames,
+                         const std::vector<std::string>& onames,
+                         const Dict& opts) const override;
+    ///@}
+
+    ///@{
+    /** \brief Return Jacobian of all input elements with respect to all output elements */
+    bool has_jacobian() const override { return true;}
+    Function get_jacobian(const std::string& name,
+                          const std::vector<std::string>& inames,
+                          const std::vector<std::string>& onames,
+                          const Dict& opts) const override;
+    ///@}
+
+    /** \brief Is codegen supported? */
+    bool has_codegen() const override { return true;}
+
+    /** \brief Generate code for the declarations of the C function */
+    void codegen_declarations(CodeGenerator& g) const override {}
+
+    /** \brief Generate code for the body of the C function */
+    void codegen_body(CodeGenerator& g) const override;
+
+    /** Obtain information about node */
+    Dict info() const override;
+
+  protected:
+    /// Number of layers
+    casadi_int n_layers() const { return act_.size();}
+
+    /// Evaluate n points, any scalar type
+    template<typename T>
+    void eval_gen(const T* x, T** res, T* w, casadi_int n,
+                  const std::vector<const T*>& W, const std::vector<const T*>& b) const;
+
+    /// Generate code for nb points, at most n
+    void codegen_layers(CodeGenerator& g, casadi_int n, const std::string& nb,
+                        const std::string& arg, const std::string& res,
+                        const std::string& w) const;
+
+    /// Activations of all layers
+    std::vector<MX> layers(const MX& x) const;
+
+    /// Derivative of the activation of layer l, in terms of its output
+    MX dact(casadi_int l, const MX& h) const;
+
+    /// Forward propagation of seeds (columns), tangents of all layers
+    std::vector<MX> fwd(const std::vector<MX>& h, const MX& seed) const;
+
+    /// Reverse propagation of seeds on the layer outputs (empty if zero)
+    MX rev(const std::vector<MX>& h, const std::vector<MX>& seed) const;
+
+    // Weights and biases, as given
+    std::vector<DM> W_, b_;
+
+    // Dense nonzeros of the weights and biases
+    std::vector<std::vector<double> > W_nz_, b_nz_;
+
+    // Activation of each layer
+    std::vector<casadi_int> act_;
+
+    // Return the activations of all layers rather than just the last
+    bool all_layers_;
+
+    // Layer widths, input first
+    std::vector<casadi_int> width_;
+
+    // Largest width
+    casadi_int max_width_;
+  };
+
+} // namespace casadi
+/// \endcond
+
+#endif // CASADI_MLP_HPP
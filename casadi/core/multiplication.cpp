@@ -29,11 +29,78 @@
 #include "multiplication.hpp"
 #include "casadi_misc.hpp"
 #include "function_internal.hpp"
+#include "thread_pool.hpp"
 
 using namespace std;
 
 namespace casadi {
 
+  namespace {
+    // z += x*y for the columns c0, ..., c1-1 of y and z, cf. casadi_mtimes
+    void mtimes_cols(const double* x, const Sparsity& sp_x,
+                     const double* y, const Sparsity& sp_y,
+                     double* z, const Sparsity& sp_z, double* w,
+                     casadi_int c0, casadi_int c1) {
+      const casadi_int *x_colind = sp_x.colind(), *x_row = sp_x.row();
+      const casadi_int *y_colind = sp_y.colind(), *y_row = sp_y.row();
+      const casadi_int *z_colind = sp_z.colind(), *z_row = sp_z.row();
+      for (casadi_int cc=c0; cc<c1; ++cc) {
+        for (casadi_int kk=z_colind[cc]; kk<z_colind[cc+1]; ++kk) w[z_row[kk]] = z[kk];
+        for (casadi_int kk=y_colind[cc]; kk<y_colind[cc+1]; ++kk) {
+          casadi_int rr = y_row[kk];
+          double yy = y[kk];
+          for (casadi_int kk1=x_colind[rr]; kk1<x_colind[rr+1]; ++kk1) {
+            w[x_row[kk1]] += x[kk1]*yy;
+          }
+        }
+        for (casadi_int kk=z_colind[cc]; kk<z_colind[cc+1]; ++kk) z[kk] = w[z_row[kk]];
+      }
+    }
+
+    // Forward sparsity propagation for the columns c0, ..., c1-1, cf. mul_sparsityF
+    void mul_sparsity_cols_fwd(const bvec_t* x, const Sparsity& sp_x,
+                               const bvec_t* y, const Sparsity& sp_y,
+                               bvec_t* z, const Sparsity& sp_z, bvec_t* w,
+                               casadi_int c0, casadi_int c1) {
+      const casadi_int *x_colind = sp_x.colind(), *x_row = sp_x.row();
+      const casadi_int *y_colind = sp_y.colind(), *y_row = sp_y.row();
+      const casadi_int *z_colind = sp_z.colind(), *z_row = sp_z.row();
+      for (casadi_int cc=c0; cc<c1; ++cc) {
+        for (casadi_int kk=z_colind[cc]; kk<z_colind[cc+1]; ++kk) w[z_row[kk]] = z[kk];
+        for (casadi_int kk=y_colind[cc]; kk<y_colind[cc+1]; ++kk) {
+          casadi_int rr = y_row[kk];
+          bvec_t yy = y[kk];
+          for (casadi_int kk1=x_colind[rr]; kk1<x_colind[rr+1]; ++kk1) {
+            w[x_row[kk1]] |= x[kk1] | yy;
+          }
+        }
+        for (casadi_int kk=z_colind[cc]; kk<z_colind[cc+1]; ++kk) z[kk] = w[z_row[kk]];
+      }
+    }
+
+    // Reverse sparsity propagation for the columns c0, ..., c1-1, cf. mul_sparsityR
+    void mul_sparsity_cols_rev(bvec_t* x, const Sparsity& sp_x,
+                               bvec_t* y, const Sparsity& sp_y,
+                               const bvec_t* z, const Sparsity& sp_z, bvec_t* w,
+                               casadi_int c0, casadi_int c1) {
+      const casadi_int *x_colind = sp_x.colind(), *x_row = sp_x.row();
+      const casadi_int *y_colind = sp_y.colind(), *y_row = sp_y.row();
+      const casadi_int *z_colind = sp_z.colind(), *z_row = sp_z.row();
+      for (casadi_int cc=c0; cc<c1; ++cc) {
+        for (casadi_int kk=z_colind[cc]; kk<z_colind[cc+1]; ++kk) w[z_row[kk]] = z[kk];
+        for (casadi_int kk=y_colind[cc]; kk<y_colind[cc+1]; ++kk) {
+          casadi_int rr = y_row[kk];
+          bvec_t yy = 0;
+          for (casadi_int kk1=x_colind[rr]; kk1<x_colind[rr+1]; ++kk1) {
+            yy |= w[x_row[kk1]];
+            x[kk1] |= w[x_row[kk1]];
+          }
+          y[kk] |= yy;
+        }
+      }
+    }
+  } // namespace
+
   Multiplication::Multiplication(const MX& z, const MX& x, const MX& y) {
     casadi_assert(x.size2() == y.size1() && x.size1() == z.size1()
       && y.size2() == z.size2(),
@@ -43,6 +110,32 @@ namespace casadi {
 
     set_dep(z, x, y);
     set_sparsity(z.sparsity());
+
+    // Partition the columns for a threaded evaluation of large products
+    n_threads_ = 1;
+    casadi_int max_num_threads = ThreadPool::hardware_concurrency();
+    casadi_int ncol = z.size2();
+    if (max_num_threads==1 || ncol<2) return;
+    const casadi_int *x_colind = x.colind(), *y_colind = y.colind(), *y_row = y.row();
+    const casadi_int *z_colind = z.colind();
+    // Cumulative number of multiply-adds (and nonzeros of z) per column
+    vector<casadi_int> work(ncol+1, 0);
+    for (casadi_int cc=0; cc<ncol; ++cc) {
+      work[cc+1] = work[cc] + z_colind[cc+1] - z_colind[cc];
+      for (casadi_int kk=y_colind[cc]; kk<y_colind[cc+1]; ++kk) {
+        work[cc+1] += x_colind[y_row[kk]+1] - x_colind[y_row[kk]];
+      }
+    }
+    if (work.back()<parallel_threshold) return;
+    n_threads_ = min(max_num_threads, ncol);
+    // A few chunks per thread, for load balancing
+    casadi_int n_chunks = min(ncol, 4*n_threads_);
+    chunks_ = {0};
+    for (casadi_int k=1; k<=n_chunks; ++k) {
+      casadi_int c = lower_bound(work.begin(), work.end(), work.back()*k/n_chunks) - work.begin();
+      if (c>chunks_.back()) chunks_.push_back(c);
+    }
+    chunks_.back() = ncol;
   }
 
   std::string Multiplication::disp(const std::vector<std::string>& arg) const {
@@ -50,7 +143,14 @@ namespace casadi {
   }
 
   int Multiplication::eval(const double** arg, double** res, casadi_int* iw, double* w) const {
-    return eval_gen<double>(arg, res, iw, w);
+    if (n_threads_==1) return eval_gen<double>(arg, res, iw, w);
+    if (arg[0]!=res[0]) copy(arg[0], arg[0]+dep(0).nnz(), res[0]);
+    // Columns of the result are independent, each thread uses its own work vector
+    ThreadPool::run(chunks_.size()-1, n_threads_, [&](casadi_int k, casadi_int t) {
+      mtimes_cols(arg[1], dep(1).sparsity(), arg[2], dep(2).sparsity(),
+                  res[0], sparsity(), w + t*size1(), chunks_[k], chunks_[k+1]);
+    });
+    return 0;
   }
 
   int Multiplication::
@@ -92,17 +192,45 @@ namespace casadi {
   int Multiplication::
   sp_forward(const bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w) const {
     copy_fwd(arg[0], res[0], nnz());
-    Sparsity::mul_sparsityF(arg[1], dep(1).sparsity(),
-                            arg[2], dep(2).sparsity(),
-                            res[0], sparsity(), w);
+    if (n_threads_==1) {
+      Sparsity::mul_sparsityF(arg[1], dep(1).sparsity(),
+                              arg[2], dep(2).sparsity(),
+                              res[0], sparsity(), w);
+      return 0;
+    }
+    ThreadPool::run(chunks_.size()-1, n_threads_, [&](casadi_int k, casadi_int t) {
+      mul_sparsity_cols_fwd(arg[1], dep(1).sparsity(), arg[2], dep(2).sparsity(),
+                            res[0], sparsity(), w + t*size1(), chunks_[k], chunks_[k+1]);
+    });
     return 0;
   }
 
   int Multiplication::
   sp_reverse(bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w) const {
-    Sparsity::mul_sparsityR(arg[1], dep(1).sparsity(),
-                            arg[2], dep(2).sparsity(),
-                            res[0], sparsity(), w);
+    if (n_threads_==1) {
+      Sparsity::mul_sparsityR(arg[1], dep(1).sparsity(),
+                              arg[2], dep(2).sparsity(),
+                              res[0], sparsity(), w);
+      copy_rev(arg[0], res[0], nnz());
+      return 0;
+    }
+    // Every column contributes to the seeds of x: threads other than the calling
+    // thread accumulate into private buffers, which are merged afterwards
+    casadi_int n_x = dep(1).nnz();
+    vector<bvec_t> x_t((n_threads_-1)*n_x, 0);
+    ThreadPool::run(chunks_.size()-1, n_threads_, [&](casadi_int k, casadi_int t) {
+      bvec_t* x = t==0 ? arg[1] : get_ptr(x_t) + (t-1)*n_x;
+      mul_sparsity_cols_rev(x, dep(1).sparsity(), arg[2], dep(2).sparsity(),
+                            res[0], sparsity(), w + t*size1(), chunks_[k], chunks_[k+1]);
+    });
+    casadi_int block = (n_x+n_threads_-1)/n_threads_;
+    ThreadPool::run(n_threads_, n_threads_, [&](casadi_int k, casadi_int t) {
+      casadi_int end = min(n_x, (k+1)*block);
+      for (casadi_int t1=0; t1<n_threads_-1; ++t1) {
+        const bvec_t* x = get_ptr(x_t) + t1*n_x;
+        for (casadi_int i=k*block; i<end; ++i) arg[1][i] |= x[i];
+      }
+    });
     copy_rev(arg[0], res[0], nnz());
     return 0;
   }
@@ -121,6 +249,21 @@ namespace casadi {
                           g.work(res[0], nnz()), sparsity(), "w", false) << '\n';
   }
 
+  int DenseMultiplication::
+  eval(const double** arg, double** res, casadi_int* iw, double* w) const {
+    if (arg[0]!=res[0]) copy(arg[0], arg[0]+dep(0).nnz(), res[0]);
+    casadi_int nrow_x = dep(1).size1(), ncol_x = dep(1).size2();
+    if (n_threads_==1) {
+      casadi_mtimes_dense(arg[1], nrow_x, ncol_x, arg[2], dep(2).size2(), res[0]);
+      return 0;
+    }
+    ThreadPool::run(chunks_.size()-1, n_threads_, [&](casadi_int k, casadi_int t) {
+      casadi_mtimes_dense(arg[1], nrow_x, ncol_x, arg[2] + chunks_[k]*ncol_x,
+                          chunks_[k+1]-chunks_[k], res[0] + chunks_[k]*nrow_x);
+    });
+    return 0;
+  }
+
   void DenseMultiplication::
   generate(CodeGenerator& g,
            const std::vector<casadi_int>& arg, const std::vector<casadi_int>& res) const {
@@ -130,18 +273,10 @@ namespace casadi {
                           g.work(res[0], nnz())) << '\n';
     }
 
-    casadi_int nrow_x = dep(1).size1(), nrow_y = dep(2).size1(), ncol_y = dep(2).size2();
-    g.local("rr", "casadi_real", "*");
-    g.local("ss", "casadi_real", "*");
-    g.local("tt", "casadi_real", "*");
-    g.local("i", "casadi_int");
-    g.local("j", "casadi_int");
-    g.local("k", "casadi_int");
-    g << "for (i=0, rr=" << g.work(res[0], nnz()) <<"; i<" << ncol_y << "; ++i)"
-      << " for (j=0; j<" << nrow_x << "; ++j, ++rr)"
-      << " for (k=0, ss=" << g.work(arg[1], dep(1).nnz()) << "+j, tt="
-      << g.work(arg[2], dep(2).nnz()) << "+i*" << nrow_y << "; k<" << nrow_y << "; ++k)"
-      << " *rr += ss[k*" << nrow_x << "]**tt++;\n";
+    // Perform dense matrix multiplication
+    g << g.mtimes(g.work(arg[1], dep(1).nnz()), dep(1).size1(), dep(1).size2(),
+                  g.work(arg[2], dep(2).nnz()), dep(2).size2(),
+                  g.work(res[0], nnz())) << '\n';
   }
 
 } // namespace casadi
@@ -92,7 +92,24 @@ namespace casadi {
     }
 
     /** \brief Get required length of w field */
-    size_t sz_w() const override { return sparsity().size1();}
+    size_t sz_w() const override { return sparsity().size1()*n_threads_;}
+
+    /** \brief Obtain information about node */
+    Dict info() const override { return {{"n_threads", n_threads_}};}
+
+    /** \brief Minimum number of multiply-adds for a threaded evaluation */
+    static const casadi_int parallel_threshold = 1<<20;
+
+  protected:
+    /** \brief Number of threads used for numerical evaluation and sparsity propagation
+        Determined at construction from the number of multiply-adds of the product
+    */
+    casadi_int n_threads_;
+
+    /** \brief Column offsets of the chunks for a threaded evaluation
+        Balanced with respect to the number of multiply-adds per column
+    */
+    std::vector<casadi_int> chunks_;
   };
 
 
@@ -111,6 +128,9 @@ namespace casadi {
     /** \brief  Destructor */
     ~DenseMultiplication() override {}
 
+    /// Evaluate the function numerically, using a blocked dense kernel
+    int eval(const double** arg, double** res, casadi_int* iw, double* w) const override;
+
     /** \brief Generate code for the operation */
     void generate(CodeGenerator& g,
                   const std::vector<casadi_int>& arg,
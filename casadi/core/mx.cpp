@@ -33,6 +33,7 @@
 #include "mx_function.hpp"
 #include "linsol.hpp"
 #include "expm.hpp"
+#include "convolution.hpp"
 
 // Throw informative error message
 #define CASADI_THROW_ERROR(FNAME, WHAT) \
@@ -1595,9 +1596,12 @@ namespace casadi {
 
   MX MX::jacobian(const MX &f, const MX &x, const Dict& opts) {
     try {
-      // Propagate verbose option to helper function
+      // Propagate verbose, coloring, AD mode timing and sparsity cache options
       Dict h_opts;
-      if (opts.count("verbose")) h_opts["verbose"] = opts.at("verbose");
+      for (const char* op : {"verbose", "coloring_num_threads", "ad_num_threads",
+                             "ad_weight_timing", "sparsity_cache"}) {
+        if (opts.count(op)) h_opts[op] = opts.at(op);
+      }
       Function h("helper_jacobian_MX", {x}, {f}, h_opts);
       return h.get<MXFunction>()->jac(0, 0, opts);
     } catch (std::exception& e) {
@@ -1835,6 +1839,10 @@ namespace casadi {
    return A->get_rank1(alpha, x, y);
  }
 
+  MX MX::_conv(const MX& h, const MX& x) {
+    return MX::create(new Convolution(h, x));
+  }
+
  void MX::eval_mx(const std::vector<MX>& arg, std::vector<MX>& res) const {
    try {
      (*this)->eval_mx(arg, res);
@@ -28,9 +28,18 @@
 #include "global_options.hpp"
 #include "casadi_interrupt.hpp"
 #include "io_instruction.hpp"
+#include "thread_pool.hpp"
+#include "binary_serializer.hpp"
+#include "casadi_call.hpp"
+#include "getnonzeros.hpp"
+#include "setnonzeros.hpp"
+#include "split.hpp"
+#include "elementwise_mx.hpp"
 
 #include <stack>
 #include <typeinfo>
+#include <unordered_map>
+#include <functional>
 
 // Throw informative error message
 #define CASADI_THROW_ERROR(FNAME, WHAT) \
@@ -59,7 +68,55 @@ namespace casadi {
         "Default input values"}},
       {"live_variables",
        {OT_BOOL,
-        "Reuse variables in the work vector"}}
+        "Reuse variables in the work vector"}},
+      {"parallel",
+       {OT_BOOL,
+        "Evaluate independent instructions concurrently on a thread pool. "
+        "Generated code dispatches independent function calls with OpenMP. "
+        "Disables live variables [default: false]"}},
+      {"max_num_threads",
+       {OT_INT,
+        "Maximum number of threads used by the parallel evaluation "
+        "[default: number of hardware threads]"}},
+      {"cse",
+       {OT_BOOL,
+        "Merge structurally equal subexpressions before allocating the work vector. "
+        "The number of removed instructions is reported in the statistics "
+        "[default: false]"}},
+      {"fuse_elementwise",
+       {OT_BOOL,
+        "Evaluate chains of elementwise operations with the same sparsity pattern "
+        "in a single loop instead of one loop per operation. The number of absorbed "
+        "instructions is reported in the statistics [default: false]"}},
+      {"inline_max_instructions",
+       {OT_INT,
+        "Inline calls to MX Functions with at most this many instructions into the "
+        "expression graph, calls to larger Functions are kept. Applies to both numerical "
+        "evaluation and generated code. The number of inlined calls is reported in the "
+        "statistics [default: -1, no inlining]"}},
+      {"zero_copy_concat",
+       {OT_BOOL,
+        "Write the results of instructions only used by a concatenation directly into "
+        "the result of the concatenation, instead of copying them. The number of such "
+        "instructions is reported in the statistics [default: false]"}},
+      {"detect_map",
+       {OT_STRING,
+        "Replace mutually independent calls to the same Function by a single call to a "
+        "Map with this parallelization, e.g. \"serial\", \"openmp\" or \"thread\". "
+        "The number of calls folded into maps is reported in the statistics. "
+        "Disabled if empty [default]"}},
+      {"profile_instructions",
+       {OT_BOOL,
+        "Time each instruction during numerical evaluation, disabling the parallel "
+        "evaluation. The timings are reported in the statistics and by "
+        "print_instruction_profile [default: false]"}},
+      {"incremental",
+       {OT_BOOL,
+        "Keep the variables of the previous call in the memory object and only reevaluate "
+        "the instructions depending on inputs whose nonzeros changed. Disables live "
+        "variables, cannot be combined with parallel evaluation and is ignored when "
+        "profiling instructions. The number of evaluated instructions is reported in "
+        "the statistics [default: false]"}}
      }
   };
 
@@ -92,8 +149,18 @@ namespace casadi {
     XFunction<MXFunction, MX, MXNode>::init(opts);
     if (verbose_) casadi_message(name_ + "::init");
 
+    // Default options
+    parallel_ = false;
+    incremental_ = false;
+
     // Default (temporary) options
     bool live_variables = true;
+    bool cse = false;
+    bool fuse = false;
+    casadi_int inline_max_instructions = -1;
+    std::string detect_map;
+    bool zero_copy_concat = false;
+    casadi_int max_num_threads = ThreadPool::hardware_concurrency();
 
     // Read options
     for (auto&& op : opts) {
@@ -101,8 +168,34 @@ namespace casadi {
         default_in_ = op.second;
       } else if (op.first=="live_variables") {
         live_variables = op.second;
+      } else if (op.first=="parallel") {
+        parallel_ = op.second;
+      } else if (op.first=="max_num_threads") {
+        max_num_threads = op.second;
+      } else if (op.first=="cse") {
+        cse = op.second;
+      } else if (op.first=="fuse_elementwise") {
+        fuse = op.second;
+      } else if (op.first=="inline_max_instructions") {
+        inline_max_instructions = op.second;
+      } else if (op.first=="zero_copy_concat") {
+        zero_copy_concat = op.second;
+      } else if (op.first=="detect_map") {
+        detect_map = op.second.to_string();
+      } else if (op.first=="profile_instructions") {
+        profile_instructions_ = op.second;
+      } else if (op.first=="incremental") {
+        incremental_ = op.second;
       }
     }
+    casadi_assert(max_num_threads>=1, "Option 'max_num_threads' must be positive");
+    casadi_assert(!(parallel_ && incremental_),
+                  "Options 'parallel' and 'incremental' cannot be combined");
+    if (profile_instructions_) incremental_ = false;
+
+    // Concurrent instructions must not share variables in the work vector,
+    // the variables of the previous call must not be overwritten
+    if (parallel_ || incremental_) live_variables = false;
 
     // Check/set default inputs
     if (default_in_.empty()) {
@@ -112,6 +205,44 @@ namespace casadi {
                             "Option 'default_in' has incorrect length");
     }
 
+    // Inline calls to small functions, repeated for calls exposed by inlining
+    n_inlined_ = -1;
+    if (inline_max_instructions>=0) {
+      n_inlined_ = 0;
+      while (casadi_int n = inline_calls(out_, inline_max_instructions)) n_inlined_ += n;
+      if (verbose_) {
+        casadi_message("Inlined " + str(n_inlined_) + " function calls");
+      }
+    }
+
+    // Merge structurally equal subexpressions
+    n_cse_removed_ = -1;
+    if (cse) {
+      n_cse_removed_ = cse_merge(out_);
+      if (verbose_) {
+        casadi_message("Common subexpression elimination removed "
+                       + str(n_cse_removed_) + " instructions");
+      }
+    }
+
+    // Fold independent calls to the same function into maps
+    n_mapped_ = -1;
+    if (!detect_map.empty()) {
+      n_mapped_ = fold_map(out_, detect_map);
+      if (verbose_) {
+        casadi_message("Folded " + str(n_mapped_) + " function calls into maps");
+      }
+    }
+
+    // Fuse chains of elementwise operations
+    n_fused_ = -1;
+    if (fuse) {
+      n_fused_ = fuse_elementwise(out_);
+      if (verbose_) {
+        casadi_message("Fused " + str(n_fused_) + " elementwise instructions");
+      }
+    }
+
     // Stack used to sort the computational graph
     stack<MXNode*> s;
 
@@ -219,6 +350,62 @@ namespace casadi {
     // Work vector size
     casadi_int worksize = 0;
 
+    // Nodes only used by a concatenation are written directly into its result:
+    // the concatenation node and the nonzero offset, cf. option "zero_copy_concat"
+    vector<casadi_int> concat_node(nodes.size(), -1), concat_offset(nodes.size(), 0);
+    n_zero_copy_ = -1;
+    if (zero_copy_concat) {
+      n_zero_copy_ = 0;
+      for (auto&& e : algorithm_) {
+        if (e.op!=OP_HORZCAT && e.op!=OP_VERTCAT && e.op!=OP_DIAGCAT) continue;
+        casadi_int offset = 0;
+        for (casadi_int j : e.arg) {
+          MXNode* n = nodes[j];
+          if (refcount[j]==1 && n->op()>=0 && !n->has_output() && n->nnz()>0) {
+            concat_node[j] = e.res[0];
+            concat_offset[j] = offset;
+            n_zero_copy_++;
+          }
+          offset += n->nnz();
+        }
+      }
+    }
+
+    // For each element of the work vector, the element holding it and the offset,
+    // or -1 if it is not part of another element
+    vector<pair<casadi_int, casadi_int> > alias;
+
+    // Get a new or unused element of the work vector
+    auto new_place = [&](casadi_int nnz) {
+      if (live_variables) {
+        // Try to reuse a variable from the stack if possible (last in, first out)
+        stack<casadi_int>& unused = unused_all[nnz];
+        if (!unused.empty()) {
+          casadi_int r = unused.top();
+          unused.pop();
+          return r;
+        }
+      }
+      alias.emplace_back(-1, 0);
+      return worksize++;
+    };
+
+    // Concatenations get their element before the first node written into it
+    vector<bool> allocated(nodes.size(), false);
+    std::function<casadi_int(casadi_int)> place_ahead = [&](casadi_int j) {
+      if (!allocated[j]) {
+        allocated[j] = true;
+        if (concat_node[j]>=0) {
+          casadi_int base = place_ahead(concat_node[j]);
+          alias.emplace_back(base, concat_offset[j]);
+          place[j] = worksize++;
+        } else {
+          place[j] = new_place(nodes[j]->nnz());
+        }
+      }
+      return place[j];
+    };
+
     // Find a place in the work vector for the operation
     for (auto&& e : algorithm_) {
 
@@ -241,8 +428,8 @@ namespace casadi {
             // unused variables if the count hits zero
             casadi_int remaining = --refcount[ch_ind];
 
-            // Free variable for reuse
-            if (live_variables && remaining==0) {
+            // Free variable for reuse, unless part of another element
+            if (live_variables && remaining==0 && alias[place[ch_ind]].first<0) {
 
               // Get a pointer to the sparsity pattern of the argument that can be freed
               casadi_int nnz = nodes[ch_ind]->sparsity().nnz();
@@ -266,25 +453,12 @@ namespace casadi {
         // Allocate/reuse memory for the results of the operation
         for (casadi_int c=0; c<e.res.size(); ++c) {
           if (e.res[c]>=0) {
-
-            // Are reuse of variables (live variables) enabled?
-            if (live_variables) {
-              // Get a pointer to the sparsity pattern node
-              casadi_int nnz = e.data->sparsity(c).nnz();
-
-              // Get a reference to the stack for the current sparsity
-              stack<casadi_int>& unused = unused_all[nnz];
-
-              // Try to reuse a variable from the stack if possible (last in, first out)
-              if (!unused.empty()) {
-                e.res[c] = place[e.res[c]] = unused.top();
-                unused.pop();
-                continue; // Success, no new element needed in the work vector
-              }
+            if (allocated[e.res[c]] || concat_node[e.res[c]]>=0) {
+              // Concatenation or part of a concatenation
+              e.res[c] = place_ahead(e.res[c]);
+            } else {
+              e.res[c] = place[e.res[c]] = new_place(e.data->sparsity(c).nnz());
             }
-
-            // Allocate a new element in the work vector
-            e.res[c] = place[e.res[c]] = worksize++;
           }
         }
       }
@@ -299,19 +473,73 @@ namespace casadi {
       }
     }
 
+    // Parallel schedule
+    par_order_.clear();
+    par_level_.clear();
+    par_threaded_.clear();
+    n_threads_ = 1;
+    if (parallel_) {
+      // Level of each instruction: longest path from an instruction without dependencies
+      vector<casadi_int> slot_level(worksize, 0), level(algorithm_.size());
+      casadi_int n_level = 0;
+      for (casadi_int k=0; k<algorithm_.size(); ++k) {
+        const AlgEl& e = algorithm_[k];
+        casadi_int l = 0;
+        for (casadi_int a : e.arg) if (a>=0) l = max(l, slot_level[a]+1);
+        if (e.op!=OP_OUTPUT) {
+          for (casadi_int r : e.res) if (r>=0) slot_level[r] = l;
+        }
+        level[k] = l;
+        n_level = max(n_level, l+1);
+      }
+
+      // Sort the instructions by level, keeping the order within each level
+      par_level_.resize(n_level+1, 0);
+      for (casadi_int l : level) par_level_[l+1]++;
+      for (casadi_int l=0; l<n_level; ++l) par_level_[l+1] += par_level_[l];
+      vector<casadi_int> pos(par_level_.begin(), par_level_.end()-1);
+      par_order_.resize(algorithm_.size());
+      for (casadi_int k=0; k<algorithm_.size(); ++k) par_order_[pos[level[k]]++] = k;
+
+      // Only levels with several function calls or linear solves are worth dispatching
+      par_threaded_.resize(n_level, false);
+      casadi_int max_width = 1, n_threaded = 0;
+      for (casadi_int l=0; l<n_level; ++l) {
+        casadi_int width = 0;
+        for (casadi_int i=par_level_[l]; i<par_level_[l+1]; ++i) {
+          casadi_int op = algorithm_[par_order_[i]].op;
+          if (op==OP_CALL || op==OP_SOLVE) width++;
+        }
+        if (width>1) {
+          par_threaded_[l] = true;
+          n_threaded++;
+        }
+        max_width = max(max_width, width);
+      }
+      n_threads_ = min(max_num_threads, max_width);
+      if (verbose_) {
+        casadi_message("Parallel evaluation: " + str(n_level) + " levels, "
+                       + str(n_threaded) + " dispatched to " + str(n_threads_) + " threads");
+      }
+    }
+
     // Allocate work vectors (numeric)
     workloc_.resize(worksize+1);
     fill(workloc_.begin(), workloc_.end(), -1);
+    worknnz_.resize(worksize);
+    fill(worknnz_.begin(), worknnz_.end(), 0);
     size_t wind=0, sz_w=0;
+    par_sz_arg_ = par_sz_res_ = par_sz_iw_ = 0;
     for (auto&& e : algorithm_) {
       if (e.op!=OP_OUTPUT) {
         for (casadi_int c=0; c<e.res.size(); ++c) {
           if (e.res[c]>=0) {
-            alloc_arg(e.data->sz_arg());
-            alloc_res(e.data->sz_res());
-            alloc_iw(e.data->sz_iw());
+            par_sz_arg_ = max(par_sz_arg_, e.data->sz_arg());
+            par_sz_res_ = max(par_sz_res_, e.data->sz_res());
+            par_sz_iw_ = max(par_sz_iw_, e.data->sz_iw());
             sz_w = max(sz_w, e.data->sz_w());
-            if (workloc_[e.res[c]] < 0) {
+            worknnz_[e.res[c]] = e.data->sparsity(c).nnz();
+            if (workloc_[e.res[c]] < 0 && alias[e.res[c]].first<0) {
               workloc_[e.res[c]] = wind;
               wind += e.data->sparsity(c).nnz();
             }
@@ -320,6 +548,18 @@ namespace casadi {
       }
     }
     workloc_.back()=wind;
+
+    // Elements that are part of another element, which has a lower index
+    for (casadi_int i=0; i<worksize; ++i) {
+      if (alias[i].first>=0) workloc_[i] = workloc_[alias[i].first] + alias[i].second;
+    }
+
+    // Each thread gets its own slice of the scratch space
+    par_sz_w_ = sz_w;
+    alloc_arg(n_threads_*par_sz_arg_);
+    alloc_res(n_threads_*par_sz_res_);
+    alloc_iw(n_threads_*par_sz_iw_);
+    sz_w *= n_threads_;
     for (casadi_int i=0; i<workloc_.size(); ++i) {
       if (workloc_[i]<0) workloc_[i] = i==0 ? 0 : workloc_[i-1];
       workloc_[i] += sz_w;
@@ -380,6 +620,405 @@ namespace casadi {
     }
   }
 
+  casadi_int MXFunction::cse_merge(std::vector<MX>& ex) {
+    // Sort the expression graph
+    stack<MXNode*> s;
+    vector<MXNode*> nodes;
+    for (auto&& e : ex) {
+      s.push(e.get());
+      sort_depth_first(s, nodes);
+    }
+    for (casadi_int i=0; i<nodes.size(); ++i) nodes[i]->temp = i;
+
+    // Replacement of each node and of the outputs of multiple-output nodes
+    vector<MX> node_new(nodes.size());
+    vector<vector<MX> > out_new(nodes.size());
+    vector<vector<bool> > out_def(nodes.size());
+
+    // Multiple-output node holding the outputs in out_new
+    vector<casadi_int> canon(nodes.size(), -1);
+
+    // Nodes in the new graph, with the index of the node they replace, for each hash value
+    std::unordered_map<size_t, vector<pair<MX, casadi_int> > > seen;
+
+    // Visit the nodes in topological order, the arguments have been merged already
+    vector<MX> arg, res;
+    for (casadi_int i=0; i<nodes.size(); ++i) {
+      MXNode* n = nodes[i];
+
+      // Output of a multiple-output node, created on first use
+      if (n->is_output()) {
+        casadi_int j = canon[n->dep(0)->temp];
+        casadi_int oind = n->which_output();
+        if (!out_def[j].at(oind)) {
+          out_new[j][oind] = node_new[j].get()==n->dep(0).get() ? MX::create(n)
+            : node_new[j]->get_output(oind);
+          out_def[j][oind] = true;
+        }
+        node_new[i] = out_new[j][oind];
+        continue;
+      }
+
+      // Arguments in the new graph
+      arg.resize(n->n_dep());
+      bool changed = false;
+      for (casadi_int k=0; k<arg.size(); ++k) {
+        arg[k] = node_new[n->dep(k)->temp];
+        if (arg[k].get()!=n->dep(k).get()) changed = true;
+      }
+
+      // Recreate the node if any argument was merged
+      MX c = MX::create(n);
+      if (changed) {
+        res.resize(n->nout());
+        n->eval_mx(arg, res);
+        if (!n->has_output()) {
+          // Keep the original node if the sparsity pattern changes
+          if (res.at(0).sparsity()==n->sparsity()) c = res[0];
+        } else {
+          // Locate the new multiple-output node
+          MXNode* p = nullptr;
+          for (auto&& r : res) {
+            if (!r.is_output() || (p && r.dep(0).get()!=p)) {
+              p = nullptr;
+              break;
+            }
+            p = r.dep(0).get();
+          }
+          if (p==nullptr) {
+            // Simplified to something else, no merging
+            out_new[i] = res;
+            out_def[i].resize(res.size(), true);
+            canon[i] = i;
+            continue;
+          }
+          c = MX::create(p);
+        }
+      }
+
+      // Look for a structurally equal node
+      size_t h = 0;
+      hash_combine(h, c->op());
+      hash_combine(h, c->n_dep());
+      for (casadi_int k=0; k<c->n_dep(); ++k) {
+        hash_combine(h, reinterpret_cast<size_t>(c->dep(k).get()));
+      }
+      if (!c->has_output()) hash_combine(h, c->sparsity().hash());
+      vector<pair<MX, casadi_int> >& bucket = seen[h];
+      casadi_int rep = -1;
+      for (auto&& b : bucket) {
+        if (MXNode::is_equal(b.first.get(), c.get(), 1)) {
+          c = b.first;
+          rep = b.second;
+          break;
+        }
+      }
+      if (rep<0) bucket.push_back(make_pair(c, i));
+      node_new[i] = c;
+
+      // Outputs of a multiple-output node
+      if (n->has_output()) {
+        if (rep>=0) {
+          canon[i] = canon[rep];
+        } else {
+          canon[i] = i;
+          if (changed) {
+            out_new[i] = res;
+          } else {
+            out_new[i].resize(n->nout());
+          }
+          out_def[i].resize(n->nout(), changed);
+        }
+      }
+    }
+
+    // Replace the expressions
+    for (auto&& e : ex) e = node_new.at(e.get()->temp);
+    for (MXNode* n : nodes) n->temp = 0;
+
+    // Count the nodes in the new graph
+    vector<MXNode*> nodes_new;
+    for (auto&& e : ex) {
+      s.push(e.get());
+      sort_depth_first(s, nodes_new);
+    }
+    for (MXNode* n : nodes_new) n->temp = 0;
+    return nodes.size() - nodes_new.size();
+  }
+
+  casadi_int MXFunction::fuse_elementwise(std::vector<MX>& ex) {
+    // Sort the expression graph
+    stack<MXNode*> s;
+    vector<MXNode*> nodes;
+    for (auto&& e : ex) {
+      s.push(e.get());
+      sort_depth_first(s, nodes);
+    }
+    for (casadi_int i=0; i<nodes.size(); ++i) nodes[i]->temp = i;
+
+    // Number of uses of each node, with the expressions counting as uses
+    vector<casadi_int> n_use(nodes.size(), 0);
+    for (MXNode* n : nodes) {
+      for (casadi_int k=0; k<n->n_dep(); ++k) n_use[n->dep(k)->temp]++;
+    }
+    for (auto&& e : ex) n_use[e->temp]++;
+
+    // Elementwise nodes only used by an elementwise node with the same sparsity are absorbed
+    vector<bool> fusable(nodes.size()), absorbed(nodes.size(), false);
+    for (casadi_int i=0; i<nodes.size(); ++i) {
+      fusable[i] = ElementwiseMX::is_fusable(nodes[i]);
+    }
+    casadi_int n_absorbed = 0;
+    for (casadi_int i=0; i<nodes.size(); ++i) {
+      if (!fusable[i]) continue;
+      for (casadi_int k=0; k<nodes[i]->n_dep(); ++k) {
+        casadi_int j = nodes[i]->dep(k)->temp;
+        if (fusable[j] && n_use[j]==1 && nodes[j]->sparsity()==nodes[i]->sparsity()) {
+          absorbed[j] = true;
+          n_absorbed++;
+        }
+      }
+    }
+
+    // Rebuild the graph in topological order, absorbed nodes are not needed
+    vector<MX> node_new(nodes.size());
+    vector<vector<MX> > out_new(nodes.size());
+    vector<MX> arg;
+    for (casadi_int i=0; i<nodes.size(); ++i) {
+      MXNode* n = nodes[i];
+      if (absorbed[i]) continue;
+
+      // Output of a multiple-output node that has been recreated
+      if (n->is_output()) {
+        const vector<MX>& r = out_new[n->dep(0)->temp];
+        node_new[i] = r.empty() ? MX::create(n) : r.at(n->which_output());
+        continue;
+      }
+
+      // Root of a kernel
+      bool root = false;
+      if (fusable[i]) {
+        for (casadi_int k=0; k<n->n_dep(); ++k) {
+          if (absorbed[n->dep(k)->temp]) root = true;
+        }
+      }
+      if (root) {
+        node_new[i] = ElementwiseMX::fuse(MX::create(n), absorbed, node_new);
+        continue;
+      }
+
+      // Recreate the node if any argument has changed
+      arg.resize(n->n_dep());
+      bool changed = false;
+      for (casadi_int k=0; k<arg.size(); ++k) {
+        arg[k] = node_new[n->dep(k)->temp];
+        if (arg[k].get()!=n->dep(k).get()) changed = true;
+      }
+      if (changed) {
+        vector<MX> res(n->nout());
+        n->eval_mx(arg, res);
+        if (n->has_output()) {
+          out_new[i] = res;
+          node_new[i] = MX::create(n);
+        } else {
+          node_new[i] = res.at(0);
+        }
+      } else {
+        node_new[i] = MX::create(n);
+      }
+    }
+
+    // Replace the expressions
+    for (auto&& e : ex) e = node_new.at(e.get()->temp);
+    for (MXNode* n : nodes) n->temp = 0;
+    return n_absorbed;
+  }
+
+  casadi_int MXFunction::inline_calls(std::vector<MX>& ex, casadi_int max_instructions) {
+    // Sort the expression graph
+    stack<MXNode*> s;
+    vector<MXNode*> nodes;
+    for (auto&& e : ex) {
+      s.push(e.get());
+      sort_depth_first(s, nodes);
+    }
+    for (casadi_int i=0; i<nodes.size(); ++i) nodes[i]->temp = i;
+
+    // Rebuild the graph in topological order
+    vector<MX> node_new(nodes.size());
+    vector<vector<MX> > out_new(nodes.size());
+    vector<MX> arg;
+    casadi_int n_inlined = 0;
+    for (casadi_int i=0; i<nodes.size(); ++i) {
+      MXNode* n = nodes[i];
+
+      // Output of a multiple-output node that has been recreated or inlined
+      if (n->is_output()) {
+        const vector<MX>& r = out_new[n->dep(0)->temp];
+        node_new[i] = r.empty() ? MX::create(n) : r.at(n->which_output());
+        continue;
+      }
+
+      // Arguments in the new graph
+      arg.resize(n->n_dep());
+      bool changed = false;
+      for (casadi_int k=0; k<arg.size(); ++k) {
+        arg[k] = node_new[n->dep(k)->temp];
+        if (arg[k].get()!=n->dep(k).get()) changed = true;
+      }
+
+      // Calls to small MX functions are replaced by the expressions of the function
+      if (n->op()==OP_CALL) {
+        const Function& f = n->which_function();
+        if (f.is_a("MXFunction") && f.n_instructions()<=max_instructions) {
+          vector<MX> res(n->nout());
+          f->eval_mx(arg, res, true, false);
+          out_new[i] = res;
+          node_new[i] = MX::create(n);
+          n_inlined++;
+          continue;
+        }
+      }
+
+      // Recreate the node if any argument has changed
+      if (changed) {
+        vector<MX> res(n->nout());
+        n->eval_mx(arg, res);
+        if (n->has_output()) {
+          out_new[i] = res;
+          node_new[i] = MX::create(n);
+        } else {
+          node_new[i] = res.at(0);
+        }
+      } else {
+        node_new[i] = MX::create(n);
+      }
+    }
+
+    // Replace the expressions
+    for (auto&& e : ex) e = node_new.at(e.get()->temp);
+    for (MXNode* n : nodes) n->temp = 0;
+    return n_inlined;
+  }
+
+  casadi_int MXFunction::fold_map(std::vector<MX>& ex, const std::string& parallelization) {
+    // Sort the expression graph
+    stack<MXNode*> s;
+    vector<MXNode*> nodes;
+    for (auto&& e : ex) {
+      s.push(e.get());
+      sort_depth_first(s, nodes);
+    }
+    for (casadi_int i=0; i<nodes.size(); ++i) nodes[i]->temp = i;
+
+    // Length of the longest path from the symbolic primitives, outputs of a
+    // multiple-output node have the depth of the node
+    vector<casadi_int> depth(nodes.size(), 0);
+    for (casadi_int i=0; i<nodes.size(); ++i) {
+      MXNode* n = nodes[i];
+      if (n->is_output()) {
+        depth[i] = depth[n->dep(0)->temp];
+      } else {
+        for (casadi_int k=0; k<n->n_dep(); ++k) {
+          depth[i] = std::max(depth[i], depth[n->dep(k)->temp] + 1);
+        }
+      }
+    }
+
+    // Calls to the same function at the same depth cannot depend on each other
+    std::map<pair<const FunctionInternal*, casadi_int>, vector<casadi_int> > calls;
+    for (casadi_int i=0; i<nodes.size(); ++i) {
+      if (nodes[i]->op()==OP_CALL) {
+        calls[make_pair(nodes[i]->which_function().get(), depth[i])].push_back(i);
+      }
+    }
+    vector<casadi_int> group(nodes.size(), -1);
+    vector<vector<casadi_int> > groups;
+    for (auto&& c : calls) {
+      if (c.second.size()<2) continue;
+      for (casadi_int i : c.second) group[i] = groups.size();
+      groups.push_back(c.second);
+    }
+    if (groups.empty()) {
+      for (MXNode* n : nodes) n->temp = 0;
+      return 0;
+    }
+
+    // Rebuild the graph in order of increasing depth, such that the arguments
+    // of all calls in a group are available when the first one is visited
+    vector<casadi_int> order(nodes.size());
+    for (casadi_int i=0; i<order.size(); ++i) order[i] = i;
+    std::stable_sort(order.begin(), order.end(),
+      [&](casadi_int i, casadi_int j) { return depth[i]<depth[j];});
+    vector<MX> node_new(nodes.size());
+    vector<vector<MX> > out_new(nodes.size());
+    vector<bool> done(nodes.size(), false);
+    vector<MX> arg;
+    casadi_int n_mapped = 0;
+    for (casadi_int i : order) {
+      MXNode* n = nodes[i];
+      if (done[i]) continue;
+
+      // Output of a multiple-output node that has been recreated or mapped
+      if (n->is_output()) {
+        const vector<MX>& r = out_new[n->dep(0)->temp];
+        node_new[i] = r.empty() ? MX::create(n) : r.at(n->which_output());
+        continue;
+      }
+
+      // Replace a group of calls by a single call to a map
+      if (group[i]>=0) {
+        const vector<casadi_int>& g = groups[group[i]];
+        const Function& f = n->which_function();
+        vector<MX> marg(f.n_in());
+        for (casadi_int k=0; k<marg.size(); ++k) {
+          arg.resize(g.size());
+          for (casadi_int m=0; m<g.size(); ++m) {
+            arg[m] = node_new[nodes[g[m]]->dep(k)->temp];
+          }
+          marg[k] = horzcat(arg);
+        }
+        vector<MX> mres = f.map(g.size(), parallelization)(marg);
+        for (casadi_int m=0; m<g.size(); ++m) {
+          out_new[g[m]].resize(f.n_out());
+          node_new[g[m]] = MX::create(nodes[g[m]]);
+          done[g[m]] = true;
+        }
+        for (casadi_int k=0; k<mres.size(); ++k) {
+          vector<MX> r = horzsplit(mres[k], f.size2_out(k));
+          for (casadi_int m=0; m<g.size(); ++m) out_new[g[m]][k] = r.at(m);
+        }
+        n_mapped += g.size();
+        continue;
+      }
+
+      // Recreate the node if any argument has changed
+      arg.resize(n->n_dep());
+      bool changed = false;
+      for (casadi_int k=0; k<arg.size(); ++k) {
+        arg[k] = node_new[n->dep(k)->temp];
+        if (arg[k].get()!=n->dep(k).get()) changed = true;
+      }
+      if (changed) {
+        vector<MX> res(n->nout());
+        n->eval_mx(arg, res);
+        if (n->has_output()) {
+          out_new[i] = res;
+          node_new[i] = MX::create(n);
+        } else {
+          node_new[i] = res.at(0);
+        }
+      } else {
+        node_new[i] = MX::create(n);
+      }
+    }
+
+    // Replace the expressions
+    for (auto&& e : ex) e = node_new.at(e.get()->temp);
+    for (MXNode* n : nodes) n->temp = 0;
+    return n_mapped;
+  }
+
   int MXFunction::eval(const double** arg, double** res,
       casadi_int* iw, double* w, void* mem) const {
     if (verbose_) casadi_message(name_ + "::eval");
@@ -395,41 +1034,165 @@ namespace casadi {
                    + str(free_vars_) + " are free.");
     }
 
+    // Only reevaluate what changed, cf. option "incremental"
+    if (incremental_ && mem) {
+      return eval_incremental(arg, res, iw, w, *static_cast<MXIncrementalMemory*>(mem));
+    }
+
+    // Time each instruction, cf. option "profile_instructions"
+    if (profile_instructions_ && mem) {
+      InstructionProfile& m = *static_cast<InstructionProfile*>(mem);
+      for (casadi_int k=0; k<algorithm_.size(); ++k) {
+        auto t0 = std::chrono::steady_clock::now();
+        if (eval_el(algorithm_[k], arg, res, arg1, res1, iw, w, w)) return 1;
+        m.toc(k, t0);
+        m.n_call[k]++;
+      }
+      return 0;
+    }
+
+    // Evaluate independent instructions concurrently
+    if (n_threads_>1) return eval_parallel(arg, res, iw, w);
+
     // Evaluate all of the nodes of the algorithm:
     // should only evaluate nodes that have not yet been calculated!
     for (auto&& e : algorithm_) {
-      if (e.op==OP_INPUT) {
-        // Pass an input
-        double *w1 = w+workloc_[e.res.front()];
-        casadi_int nnz=e.data.nnz();
-        casadi_int i=e.data->ind();
-        casadi_int nz_offset=e.data->offset();
-        if (arg[i]==nullptr) {
-          fill(w1, w1+nnz, 0);
-        } else {
-          copy(arg[i]+nz_offset, arg[i]+nz_offset+nnz, w1);
-        }
-      } else if (e.op==OP_OUTPUT) {
-        // Get an output
-        double *w1 = w+workloc_[e.arg.front()];
-        casadi_int nnz=e.data->dep().nnz();
-        casadi_int i=e.data->ind();
-        casadi_int nz_offset=e.data->offset();
-        if (res[i]) copy(w1, w1+nnz, res[i]+nz_offset);
+      if (eval_el(e, arg, res, arg1, res1, iw, w, w)) return 1;
+    }
+    return 0;
+  }
+
+  int MXFunction::eval_el(const AlgEl& e, const double** arg, double** res,
+                          const double** arg1, double** res1,
+                          casadi_int* iw, double* w, double* wk) const {
+    if (e.op==OP_INPUT) {
+      // Pass an input
+      double *w1 = w+workloc_[e.res.front()];
+      casadi_int nnz=e.data.nnz();
+      casadi_int i=e.data->ind();
+      casadi_int nz_offset=e.data->offset();
+      if (arg[i]==nullptr) {
+        fill(w1, w1+nnz, 0);
       } else {
-        // Point pointers to the data corresponding to the element
-        for (casadi_int i=0; i<e.arg.size(); ++i)
-          arg1[i] = e.arg[i]>=0 ? w+workloc_[e.arg[i]] : nullptr;
-        for (casadi_int i=0; i<e.res.size(); ++i)
-          res1[i] = e.res[i]>=0 ? w+workloc_[e.res[i]] : nullptr;
+        copy(arg[i]+nz_offset, arg[i]+nz_offset+nnz, w1);
+      }
+    } else if (e.op==OP_OUTPUT) {
+      // Get an output
+      double *w1 = w+workloc_[e.arg.front()];
+      casadi_int nnz=e.data->dep().nnz();
+      casadi_int i=e.data->ind();
+      casadi_int nz_offset=e.data->offset();
+      if (res[i]) copy(w1, w1+nnz, res[i]+nz_offset);
+    } else {
+      // Point pointers to the data corresponding to the element
+      for (casadi_int i=0; i<e.arg.size(); ++i)
+        arg1[i] = e.arg[i]>=0 ? w+workloc_[e.arg[i]] : nullptr;
+      for (casadi_int i=0; i<e.res.size(); ++i)
+        res1[i] = e.res[i]>=0 ? w+workloc_[e.res[i]] : nullptr;
+
+      // Evaluate
+      if (e.data->eval(arg1, res1, iw, wk)) return 1;
+    }
+    return 0;
+  }
 
-        // Evaluate
-        if (e.data->eval(arg1, res1, iw, w)) return 1;
+  int MXFunction::eval_parallel(const double** arg, double** res,
+                                casadi_int* iw, double* w) const {
+    // Return flag for each thread
+    std::vector<int> ret_values(n_threads_, 0);
+
+    // Evaluate one instruction of the schedule using the work vector slice of thread t
+    auto eval_k = [&](casadi_int k, casadi_int t) {
+      const AlgEl& e = algorithm_[par_order_[k]];
+      const double** arg1 = arg + n_in_ + t*par_sz_arg_;
+      double** res1 = res + n_out_ + t*par_sz_res_;
+      if (eval_el(e, arg, res, arg1, res1, iw + t*par_sz_iw_, w, w + t*par_sz_w_)) {
+        ret_values[t] = 1;
+      }
+    };
+
+    // Loop over levels, instructions in a level are independent
+    for (casadi_int l=0; l+1<par_level_.size(); ++l) {
+      casadi_int k0 = par_level_[l], n = par_level_[l+1]-k0;
+      if (par_threaded_[l]) {
+        ThreadPool::run(n, n_threads_, [&](casadi_int k, casadi_int t) { eval_k(k0+k, t); });
+      } else {
+        for (casadi_int k=0; k<n; ++k) eval_k(k0+k, 0);
       }
+      for (int r : ret_values) if (r) return 1;
     }
     return 0;
   }
 
+  int MXFunction::eval_incremental(const double** arg, double** res,
+                                   casadi_int* iw, double* w, MXIncrementalMemory& m) const {
+    const double** arg1 = arg+n_in_;
+    double** res1 = res+n_out_;
+    double* wv = get_ptr(m.w);
+
+    // Evaluate everything if the variables are not those of a successful call
+    bool all = !m.valid;
+    m.valid = false;
+    m.n_eval = 0;
+    fill(m.changed.begin(), m.changed.end(), false);
+
+    for (auto&& e : algorithm_) {
+      if (e.op==OP_INPUT) {
+        // Compare with the nonzeros of the previous call
+        const double* w1 = wv+workloc_[e.res.front()];
+        const double* a = arg[e.data->ind()];
+        if (a) a += e.data->offset();
+        bool changed = all;
+        for (casadi_int k=0; !changed && k<e.data.nnz(); ++k) {
+          changed = (a ? a[k] : 0) != w1[k];
+        }
+        if (!changed) continue;
+        m.changed[e.res.front()] = true;
+      } else if (e.op!=OP_OUTPUT && !all) {
+        // Skip unless an argument changed
+        bool changed = false;
+        for (casadi_int i : e.arg) {
+          if (i>=0 && m.changed[i]) {
+            changed = true;
+            break;
+          }
+        }
+        if (!changed) continue;
+        for (casadi_int i : e.res) if (i>=0) m.changed[i] = true;
+      }
+      // Outputs are always written
+      if (eval_el(e, arg, res, arg1, res1, iw, wv, w)) return 1;
+      m.n_eval++;
+    }
+    m.valid = true;
+    return 0;
+  }
+
+  void* MXFunction::alloc_mem() const {
+    if (incremental_) return new MXIncrementalMemory();
+    return XFunction::alloc_mem();
+  }
+
+  int MXFunction::init_mem(void* mem) const {
+    if (incremental_) {
+      MXIncrementalMemory* m = static_cast<MXIncrementalMemory*>(mem);
+      m->w.resize(workloc_.back());
+      m->changed.resize(workloc_.size()-1);
+      m->valid = false;
+      m->n_eval = 0;
+      return 0;
+    }
+    return XFunction::init_mem(mem);
+  }
+
+  void MXFunction::free_mem(void *mem) const {
+    if (incremental_) {
+      delete static_cast<MXIncrementalMemory*>(mem);
+    } else {
+      XFunction::free_mem(mem);
+    }
+  }
+
   string MXFunction::print(const AlgEl& el) const {
     stringstream s;
     if (el.op==OP_OUTPUT) {
@@ -1073,6 +1836,34 @@ namespace casadi {
     }
   }
 
+  Dict MXFunction::codegen_footprint(const CodeGenerator& g) const {
+    Dict r = XFunction::codegen_footprint(g);
+    // Instructions by class, elementwise operations by the number of nonzeros
+    Dict ops, flops;
+    casadi_int n_flop = 0;
+    std::vector<std::string> calls;
+    for (auto&& e : algorithm_) {
+      if (e.op==OP_INPUT || e.op==OP_OUTPUT || e.op==OP_PARAMETER) continue;
+      std::string cl = e.data->class_name();
+      ops[cl] = (ops.count(cl) ? ops[cl].as_int() : 0) + 1;
+      if (e.data->is_unary() || e.data->is_binary()) {
+        std::string name = casadi_math<double>::name(e.op);
+        casadi_int nnz = e.data->sparsity(0).nnz();
+        flops[name] = (flops.count(name) ? flops[name].as_int() : 0) + nnz;
+        n_flop += nnz;
+      } else if (e.op==OP_CALL) {
+        const std::string& fname = e.data.which_function().name();
+        if (std::find(calls.begin(), calls.end(), fname)==calls.end()) calls.push_back(fname);
+      }
+    }
+    r["n_instructions"] = static_cast<casadi_int>(algorithm_.size());
+    r["instructions"] = ops;
+    r["flops"] = flops;
+    r["n_flop"] = n_flop;
+    r["calls"] = calls;
+    return r;
+  }
+
   void MXFunction::codegen_body(CodeGenerator& g) const {
     // Temporary variables and vectors
     g.init_local("arg1", "arg+" + str(n_in_));
@@ -1081,7 +1872,7 @@ namespace casadi {
     // Declare scalar work vector elements as local variables
     bool first = true;
     for (casadi_int i=0; i<workloc_.size()-1; ++i) {
-      casadi_int n=workloc_[i+1]-workloc_[i];
+      casadi_int n=worknnz_[i];
       if (n==0) continue;
       if (first) {
         g << "casadi_real ";
@@ -1104,24 +1895,23 @@ namespace casadi {
     }
     if (!first) g << ";\n";
 
-    // Operation number (for printing)
-    casadi_int k=0;
-
     // Names of operation argument and results
     vector<casadi_int> arg, res;
 
-    // Codegen the algorithm
-    for (auto&& e : algorithm_) {
+    // Codegen an instruction
+    auto generate_el = [&](casadi_int k) {
+      const AlgEl& e = algorithm_[k];
+
       // Generate comment
       if (g.verbose) {
-        g << "/* #" << k++ << ": " << print(e) << " */\n";
+        g << "/* #" << k << ": " << print(e) << " */\n";
       }
 
       // Get the names of the operation arguments
       arg.resize(e.arg.size());
       for (casadi_int i=0; i<e.arg.size(); ++i) {
         casadi_int j=e.arg.at(i);
-        if (j>=0 && workloc_.at(j)!=workloc_.at(j+1)) {
+        if (j>=0 && worknnz_.at(j)!=0) {
           arg.at(i) = j;
         } else {
           arg.at(i) = -1;
@@ -1132,7 +1922,7 @@ namespace casadi {
       res.resize(e.res.size());
       for (casadi_int i=0; i<e.res.size(); ++i) {
         casadi_int j=e.res.at(i);
-        if (j>=0 && workloc_.at(j)!=workloc_.at(j+1)) {
+        if (j>=0 && worknnz_.at(j)!=0) {
           res.at(i) = j;
         } else {
           res.at(i) = -1;
@@ -1141,6 +1931,62 @@ namespace casadi {
 
       // Generate operation
       e.data->generate(g, arg, res);
+    };
+
+    // Codegen the algorithm
+    if (n_threads_==1) {
+      for (casadi_int k=0; k<algorithm_.size(); ++k) generate_el(k);
+      return;
+    }
+
+    // Codegen the parallel schedule, level by level
+    for (casadi_int l=0; l+1<par_level_.size(); ++l) {
+      // Function calls of threaded levels are dispatched with OpenMP, cf. eval_parallel
+      vector<casadi_int> calls;
+      for (casadi_int i=par_level_[l]; i<par_level_[l+1]; ++i) {
+        casadi_int k = par_order_[i];
+        if (par_threaded_[l] && algorithm_[k].op==OP_CALL) {
+          calls.push_back(k);
+        } else {
+          generate_el(k);
+        }
+      }
+      if (calls.empty()) continue;
+
+      // Thread t evaluates the calls t, t+nt, ... with its own work vector slice
+      casadi_int nt = min(n_threads_, static_cast<casadi_int>(calls.size()));
+      g << "{\n"
+        << "casadi_int t, k, flag=0;\n"
+        << "#pragma omp parallel for private(k) reduction(||:flag)\n"
+        << "for (t=0; t<" << nt << "; ++t) {\n"
+        << "const casadi_real** targ = arg+" << n_in_ << "+t*" << par_sz_arg_ << ";\n"
+        << "casadi_real** tres = res+" << n_out_ << "+t*" << par_sz_res_ << ";\n"
+        << "for (k=t; k<" << calls.size() << "; k+=" << nt << ") {\n"
+        << "switch (k) {\n";
+      for (casadi_int c=0; c<calls.size(); ++c) {
+        const AlgEl& e = algorithm_[calls[c]];
+        const Function& f = e.data->which_function();
+        g << "case " << c << ":\n";
+        if (g.verbose) g << "/* #" << calls[c] << ": " << print(e) << " */\n";
+        for (casadi_int i=0; i<e.arg.size(); ++i) {
+          casadi_int j = e.arg[i];
+          if (j>=0 && worknnz_.at(j)==0) j = -1;
+          g << "targ[" << i << "]=" << g.work(j, f.nnz_in(i)) << ";\n";
+        }
+        for (casadi_int i=0; i<e.res.size(); ++i) {
+          casadi_int j = e.res[i];
+          if (j>=0 && worknnz_.at(j)==0) j = -1;
+          g << "tres[" << i << "]=" << g.work(j, f.nnz_out(i)) << ";\n";
+        }
+        g << "flag = " << g(f, "targ", "tres", "iw+t*" + str(par_sz_iw_),
+                            "w+t*" + str(par_sz_w_)) << " || flag;\n"
+          << "break;\n";
+      }
+      g << "}\n"
+        << "}\n"
+        << "}\n"
+        << "if (flag) return 1;\n"
+        << "}\n";
     }
   }
 
@@ -1244,6 +2090,13 @@ namespace casadi {
     return in_;
   }
 
+  bool MXFunction::is_thread_safe() const {
+    for (auto&& e : algorithm_) {
+      if (e.op==OP_CALL && !e.data.which_function()->is_thread_safe()) return false;
+    }
+    return true;
+  }
+
   bool MXFunction::is_a(const std::string& type, bool recursive) const {
     return type=="MXFunction"
       || (recursive && XFunction<MXFunction,
@@ -1622,21 +2475,361 @@ namespace casadi {
     }
   }
 
+  void MXFunction::memory_usage(std::map<std::string, casadi_int>& usage,
+                                std::set<const void*>& visited) const {
+    XFunction::memory_usage(usage, visited);
+    casadi_int& a = usage["algorithm"];
+    a += memory_bytes(algorithm_) + memory_bytes(workloc_) + memory_bytes(worknnz_)
+      + memory_bytes(free_vars_)
+      + memory_bytes(default_in_) + memory_bytes(par_order_) + memory_bytes(par_level_)
+      + par_threaded_.capacity()/8;
+    for (auto&& e : algorithm_) a += memory_bytes(e.arg) + memory_bytes(e.res);
+    if (incremental_) {
+      for (casadi_int i=0; i<n_mem(); ++i) {
+        auto m = static_cast<const MXIncrementalMemory*>(memory(i));
+        usage["memory"] += sizeof(*m) + memory_bytes(m->w) + m->changed.capacity()/8;
+      }
+    }
+  }
+
+  double MXFunction::n_instructions_sx() const {
+    // Free variables cannot be expanded
+    if (!free_vars_.empty()) return inf;
+    double ret = 0;
+    for (auto&& e : algorithm_) {
+      switch (e.op) {
+      case OP_INPUT:
+      case OP_OUTPUT:
+      case OP_PARAMETER:
+      case OP_RESHAPE:
+      case OP_TRANSPOSE:
+      case OP_GETNONZEROS:
+      case OP_HORZCAT:
+      case OP_VERTCAT:
+      case OP_DIAGCAT:
+      case OP_HORZSPLIT:
+      case OP_VERTSPLIT:
+      case OP_DIAGSPLIT:
+      case OP_PROJECT:
+        // No operations, only a reordering of nonzeros
+        break;
+      case OP_CALL:
+        ret += e.data.which_function()->n_instructions_sx();
+        break;
+      case OP_MTIMES:
+        {
+          // One multiplication and one addition for each product of nonzeros
+          const Sparsity& x = e.data->dep(1).sparsity();
+          const Sparsity& y = e.data->dep(2).sparsity();
+          const casadi_int *x_colind = x.colind(), *y_row = y.row();
+          for (casadi_int k=0; k<y.nnz(); ++k) {
+            ret += 2*(x_colind[y_row[k]+1] - x_colind[y_row[k]]);
+          }
+        }
+        break;
+      case OP_SOLVE:
+        {
+          // Dense factorization and substitutions, with dependencies r and A
+          double n = e.data->dep(1).size1();
+          ret += n*n*n + 2*n*n*e.data.size2();
+        }
+        break;
+      default:
+        ret += e.data.nnz();
+      }
+    }
+    return ret;
+  }
+
+  std::vector<std::pair<std::string, Function> > MXFunction::memory_children() const {
+    std::vector<std::pair<std::string, Function> > ret = XFunction::memory_children();
+    for (auto&& e : algorithm_) {
+      if (e.op==OP_CALL) {
+        const Function& f = e.data.which_function();
+        ret.push_back(std::make_pair(f.name(), f));
+      }
+    }
+    return ret;
+  }
+
+  void MXFunction::serialize_binary(BinarySerializer& s) const {
+    casadi_assert(free_vars_.empty(), "Cannot serialize MXFunction with free parameters.");
+    s.pack(casadi_int('M'));
+    s.pack_header(*this);
+    s.pack(static_cast<casadi_int>(workloc_.size()-1));
+    s.pack(static_cast<casadi_int>(algorithm_.size()));
+    for (auto&& e : algorithm_) {
+      // Operation and work vector indices, dimensions of unused arguments
+      s.pack(e.op);
+      s.pack(e.arg);
+      for (casadi_int i=0; i<e.arg.size(); ++i) {
+        if (e.arg[i]<0) {
+          s.pack(e.data->dep(i).size1());
+          s.pack(e.data->dep(i).size2());
+        }
+      }
+      s.pack(e.res);
+      // Data of the operation
+      if (e.data->is_unary() || e.data->is_binary()) continue;
+      switch (e.op) {
+        case OP_INPUT:
+          s.pack(e.data->ind());
+          s.pack(e.data->info().at("offset").to_int());
+          s.pack(e.data.sparsity());
+          break;
+        case OP_OUTPUT:
+          s.pack(e.data->ind());
+          s.pack(e.data->info().at("offset").to_int());
+          break;
+        case OP_CONST:
+          {
+            DM v = e.data->get_DM();
+            s.pack(v.sparsity());
+            s.pack(v.nonzeros());
+          }
+          break;
+        case OP_CALL:
+          s.pack(e.data.which_function());
+          break;
+        case OP_RESHAPE:
+        case OP_PROJECT:
+          s.pack(e.data.sparsity());
+          break;
+        case OP_GETNONZEROS:
+          s.pack(e.data.sparsity());
+          s.pack(static_cast<const GetNonzeros*>(e.data.get())->all());
+          break;
+        case OP_SETNONZEROS:
+          s.pack(static_cast<const SetNonzeros<false>*>(e.data.get())->all());
+          break;
+        case OP_ADDNONZEROS:
+          s.pack(static_cast<const SetNonzeros<true>*>(e.data.get())->all());
+          break;
+        case OP_HORZSPLIT:
+        case OP_VERTSPLIT:
+        case OP_DIAGSPLIT:
+          {
+            // Row and column offsets, from the sparsity of the outputs
+            const Split* n = static_cast<const Split*>(e.data.get());
+            std::vector<casadi_int> offset1(1, 0), offset2(1, 0);
+            for (auto&& sp : n->output_sparsity_) {
+              offset1.push_back(offset1.back() + sp.size1());
+              offset2.push_back(offset2.back() + sp.size2());
+            }
+            if (e.op!=OP_HORZSPLIT) s.pack(offset1);
+            if (e.op!=OP_VERTSPLIT) s.pack(offset2);
+          }
+          break;
+        case OP_MTIMES:
+        case OP_TRANSPOSE:
+        case OP_DETERMINANT:
+        case OP_INVERSE:
+        case OP_DOT:
+        case OP_BILIN:
+        case OP_RANK1:
+        case OP_HORZCAT:
+        case OP_VERTCAT:
+        case OP_DIAGCAT:
+        case OP_NORM2:
+        case OP_NORM1:
+        case OP_NORMINF:
+        case OP_NORMF:
+        case OP_MMIN:
+        case OP_MMAX:
+          break;
+        default:
+          casadi_error("Binary serialization not supported for " + e.data->class_name());
+      }
+    }
+  }
+
+  Function MXFunction::deserialize_binary(BinaryDeserializer& s) {
+    BinaryDeserializer::Header h = s.unpack_header();
+    casadi_int sz_w = s.unpack_int();
+    casadi_int n = s.unpack_int();
+    casadi_assert(sz_w>=0 && n>=0, "Corrupt binary file");
+
+    // Symbolic inputs
+    std::vector<MX> arg;
+    for (casadi_int i=0; i<h.sp_in.size(); ++i) arg.push_back(MX::sym(h.name_in[i], h.sp_in[i]));
+
+    // Output segments with their nonzero offsets
+    std::vector<std::vector<std::pair<casadi_int, MX> > > res_split(h.sp_out.size());
+
+    // Replay the algorithm, with all indices checked
+    std::vector<MX> w(sz_w), x, y;
+    auto chk = [](casadi_int i, casadi_int n) {
+      casadi_assert(i>=0 && i<n, "Corrupt binary file");
+      return i;
+    };
+    auto nz_range = [&](casadi_int offset, casadi_int nnz, casadi_int n) {
+      casadi_assert(offset>=0 && nnz>=0 && offset+nnz<=n, "Corrupt binary file");
+      return range(offset, offset+nnz);
+    };
+    for (casadi_int k=0; k<n; ++k) {
+      casadi_int op = s.unpack_int();
+      std::vector<casadi_int> a = s.unpack_int_vector();
+      x.resize(a.size());
+      for (casadi_int i=0; i<a.size(); ++i) {
+        if (a[i]<0) {
+          casadi_int nrow = s.unpack_int();
+          casadi_int ncol = s.unpack_int();
+          x[i] = MX(nrow, ncol);
+        } else {
+          x[i] = w[chk(a[i], sz_w)];
+        }
+      }
+      std::vector<casadi_int> r = s.unpack_int_vector();
+      switch (op) {
+        case OP_INPUT:
+          {
+            const MX& v = arg.at(chk(s.unpack_int(), arg.size()));
+            casadi_int offset = s.unpack_int();
+            Sparsity sp = s.unpack_sparsity();
+            if (offset==0 && sp==v.sparsity()) {
+              y = {v};
+            } else {
+              y = {v->get_nzref(sp, nz_range(offset, sp.nnz(), v.nnz()))};
+            }
+          }
+          break;
+        case OP_OUTPUT:
+          {
+            casadi_int ind = chk(s.unpack_int(), res_split.size());
+            res_split[ind].push_back(std::make_pair(s.unpack_int(), x.at(0)));
+            y.clear();
+          }
+          break;
+        case OP_CONST:
+          {
+            Sparsity sp = s.unpack_sparsity();
+            std::vector<double> nz = s.unpack_double_vector();
+            casadi_assert(nz.size()==sp.nnz(), "Corrupt binary file");
+            y = {DM(sp, nz)};
+          }
+          break;
+        case OP_CALL: y = Call::create(s.unpack_function(), x); break;
+        case OP_RESHAPE: y = {x.at(0)->get_reshape(s.unpack_sparsity())}; break;
+        case OP_PROJECT: y = {x.at(0)->get_project(s.unpack_sparsity())}; break;
+        case OP_GETNONZEROS:
+          {
+            Sparsity sp = s.unpack_sparsity();
+            std::vector<casadi_int> nz = s.unpack_int_vector();
+            casadi_assert(nz.size()==sp.nnz(), "Corrupt binary file");
+            for (casadi_int i : nz) casadi_assert(i<x.at(0).nnz(), "Corrupt binary file");
+            y = {x.at(0)->get_nzref(sp, nz)};
+          }
+          break;
+        case OP_SETNONZEROS:
+        case OP_ADDNONZEROS:
+          {
+            std::vector<casadi_int> nz = s.unpack_int_vector();
+            casadi_assert(nz.size()==x.at(1).nnz(), "Corrupt binary file");
+            for (casadi_int i : nz) casadi_assert(i<x.at(0).nnz(), "Corrupt binary file");
+            y = {op==OP_SETNONZEROS ? x.at(1)->get_nzassign(x.at(0), nz)
+                                    : x.at(1)->get_nzadd(x.at(0), nz)};
+          }
+          break;
+        case OP_HORZSPLIT: y = x.at(0)->get_horzsplit(s.unpack_int_vector()); break;
+        case OP_VERTSPLIT: y = x.at(0)->get_vertsplit(s.unpack_int_vector()); break;
+        case OP_DIAGSPLIT:
+          {
+            std::vector<casadi_int> offset1 = s.unpack_int_vector();
+            y = x.at(0)->get_diagsplit(offset1, s.unpack_int_vector());
+          }
+          break;
+        case OP_MTIMES: y = {x.at(1)->get_mac(x.at(2), x.at(0))}; break;
+        case OP_TRANSPOSE: y = {x.at(0)->get_transpose()}; break;
+        case OP_DETERMINANT: y = {x.at(0)->get_det()}; break;
+        case OP_INVERSE: y = {x.at(0)->get_inv()}; break;
+        case OP_DOT: y = {x.at(0)->get_dot(x.at(1))}; break;
+        case OP_BILIN: y = {x.at(0)->get_bilin(x.at(1), x.at(2))}; break;
+        case OP_RANK1: y = {x.at(0)->get_rank1(x.at(1), x.at(2), x.at(3))}; break;
+        case OP_HORZCAT: y = {MX::horzcat(x)}; break;
+        case OP_VERTCAT: y = {MX::vertcat(x)}; break;
+        case OP_DIAGCAT: y = {MX::diagcat(x)}; break;
+        case OP_NORM2: y = {x.at(0)->get_norm_2()}; break;
+        case OP_NORM1: y = {x.at(0)->get_norm_1()}; break;
+        case OP_NORMINF: y = {x.at(0)->get_norm_inf()}; break;
+        case OP_NORMF: y = {x.at(0)->get_norm_fro()}; break;
+        case OP_MMIN: y = {x.at(0)->get_mmin()}; break;
+        case OP_MMAX: y = {x.at(0)->get_mmax()}; break;
+        default:
+          casadi_assert(op>=0 && op<NUM_BUILT_IN_OPS, "Corrupt binary file");
+          switch (casadi_math<double>::ndeps(op)) {
+            case 1: y = {MX::unary(op, x.at(0))}; break;
+            case 2: y = {MX::binary(op, x.at(0), x.at(1))}; break;
+            default: casadi_error("Not implemented: " + str(op));
+          }
+      }
+      casadi_assert(y.size()>=r.size() || op==OP_OUTPUT, "Corrupt binary file");
+      for (casadi_int i=0; i<r.size(); ++i) {
+        if (r[i]>=0) w[chk(r[i], sz_w)] = y[i];
+      }
+    }
+
+    // Assemble the outputs from their segments
+    std::vector<MX> res(h.sp_out.size());
+    for (casadi_int i=0; i<res.size(); ++i) {
+      const Sparsity& sp = h.sp_out[i];
+      if (res_split[i].size()==1 && res_split[i][0].first==0
+          && res_split[i][0].second.sparsity()==sp) {
+        res[i] = res_split[i][0].second;
+      } else {
+        res[i] = MX::zeros(sp);
+        for (auto&& e : res_split[i]) {
+          res[i] = e.second->get_nzassign(res[i], nz_range(e.first, e.second.nnz(), sp.nnz()));
+        }
+      }
+    }
+
+    return Function(h.name, arg, res, h.name_in, h.name_out, h.options());
+  }
+
   Dict MXFunction::get_stats(void* mem) const {
     Dict stats = XFunction::get_stats(mem);
+    stats["worksize"] = workloc_.back()-workloc_.front();
+    if (n_cse_removed_>=0) stats["n_cse_removed"] = n_cse_removed_;
+    if (n_fused_>=0) stats["n_fused"] = n_fused_;
+    if (n_inlined_>=0) stats["n_inlined"] = n_inlined_;
+    if (n_mapped_>=0) stats["n_mapped"] = n_mapped_;
+    if (n_zero_copy_>=0) stats["n_zero_copy"] = n_zero_copy_;
+    if (incremental_ && mem) {
+      stats["n_evaluated"] = static_cast<MXIncrementalMemory*>(mem)->n_eval;
+    }
+    if (profile_instructions_ && mem) {
+      // Instruction timings, cf. option "profile_instructions"
+      const InstructionProfile& m = *static_cast<InstructionProfile*>(mem);
+      std::vector<std::string> instr, cl, name, sp;
+      for (auto&& e : algorithm_) {
+        instr.push_back(print(e));
+        cl.push_back(e.data->class_name());
+        name.push_back(e.op==OP_CALL ? e.data.which_function().name() : "");
+        if (e.op==OP_OUTPUT) {
+          sp.push_back(e.data->dep().sparsity().dim(true));
+        } else {
+          sp.push_back(e.data->nout()>0 ? e.data->sparsity(0).dim(true) : "");
+        }
+      }
+      stats["instructions"] = Dict{{"instruction", instr}, {"class", cl}, {"name", name}, {"sparsity", sp},
+                                   {"n_call", m.n_call}, {"t_wall", m.t_wall}};
+    }
 
+    // Forward the statistics of a single embedded conic solver
     Function dep;
     for (auto&& e : algorithm_) {
       if (e.op==OP_CALL) {
         Function d = e.data.which_function();
         if (d.is_a("conic", true)) {
-          if (!dep.is_null()) return {};
+          if (!dep.is_null()) return stats;
           dep = d;
         }
       }
     }
-    if (dep.is_null()) return {};
-    return dep.stats(1);
+    if (dep.is_null()) return stats;
+    Dict ret = dep.stats(1);
+    ret.insert(stats.begin(), stats.end());
+    return ret;
   }
 
 } // namespace casadi
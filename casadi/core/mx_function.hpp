@@ -53,6 +53,18 @@ namespace casadi {
     /// Work vector indices of the results
     std::vector<casadi_int> res;
   };
+
+  /** \brief Memory of an incremental evaluation, cf. option "incremental" of MXFunction */
+  struct CASADI_EXPORT MXIncrementalMemory {
+    /// Variables of the previous call
+    std::vector<double> w;
+    /// Variables changed in the current call
+    std::vector<bool> changed;
+    /// Does w hold the result of a successful call?
+    bool valid;
+    /// Number of instructions evaluated in the last call
+    casadi_int n_eval;
+  };
 #endif // SWIG
 
   /** \brief  Internal node class for MXFunction
@@ -71,12 +83,50 @@ namespace casadi {
     /** \brief Offsets for elements in the w_ vector */
     std::vector<casadi_int> workloc_;
 
+    /** \brief Number of nonzeros of the elements in the w_ vector
+        Elements written into a concatenation are part of its element */
+    std::vector<casadi_int> worknnz_;
+
     /// Free variables
     std::vector<MX> free_vars_;
 
     /// Default input values
     std::vector<double> default_in_;
 
+    /// Number of instructions removed by common subexpression elimination, -1 if disabled
+    casadi_int n_cse_removed_;
+
+    /// Number of instructions absorbed into fused elementwise kernels, -1 if disabled
+    casadi_int n_fused_;
+
+    /// Number of function calls inlined into the graph, -1 if disabled
+    casadi_int n_inlined_;
+
+    /// Number of function calls folded into maps, -1 if disabled
+    casadi_int n_mapped_;
+
+    /// Number of results written directly into a concatenation, -1 if disabled
+    casadi_int n_zero_copy_;
+
+    /// Evaluate independent instructions concurrently
+    bool parallel_;
+
+    /// Number of threads used for parallel evaluation
+    casadi_int n_threads_;
+
+    /// Only reevaluate instructions depending on changed inputs
+    bool incremental_;
+
+    /** \brief Parallel schedule: instructions sorted by level in the dependency graph
+        Instructions in the same level do not depend on each other */
+    std::vector<casadi_int> par_order_, par_level_;
+
+    /// Levels that are dispatched to the thread pool
+    std::vector<bool> par_threaded_;
+
+    /// Work vector sizes of the instructions, per thread
+    size_t par_sz_arg_, par_sz_res_, par_sz_iw_, par_sz_w_;
+
     /** \brief Constructor */
     MXFunction(const std::string& name,
       const std::vector<MX>& input, const std::vector<MX>& output,
@@ -89,6 +139,30 @@ namespace casadi {
     /** \brief  Evaluate numerically, work vectors given */
     int eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const override;
 
+    /** \brief  Evaluate numerically, using the parallel schedule */
+    int eval_parallel(const double** arg, double** res, casadi_int* iw, double* w) const;
+
+    /** \brief  Evaluate numerically, reusing the variables of the previous call */
+    int eval_incremental(const double** arg, double** res, casadi_int* iw, double* w,
+                         MXIncrementalMemory& m) const;
+
+    /** \brief Create memory block */
+    void* alloc_mem() const override;
+
+    /** \brief Initalize memory block */
+    int init_mem(void* mem) const override;
+
+    /** \brief Free memory block */
+    void free_mem(void *mem) const override;
+
+    /** \brief  Evaluate a single instruction
+        w holds the variables at the offsets workloc_, wk is scratch space for the instruction */
+    int eval_el(const AlgEl& e, const double** arg, double** res,
+                const double** arg1, double** res1, casadi_int* iw, double* w, double* wk) const;
+
+    /** \brief Number of entries in the instruction profile: one per instruction */
+    casadi_int n_profile() const { return algorithm_.size();}
+
     /** \brief  Print description */
     void disp_more(std::ostream& stream) const override;
 
@@ -98,6 +172,9 @@ namespace casadi {
     /** \brief Check if the function is of a particular type */
     bool is_a(const std::string& type, bool recursive) const override;
 
+    /** \brief Thread-safe if all functions called are */
+    bool is_thread_safe() const override;
+
     ///@{
     /** \brief Options */
     static Options options_;
@@ -107,9 +184,32 @@ namespace casadi {
     /// Get all statistics
     Dict get_stats(void* mem) const override;
 
+    /** \brief Add the estimated heap memory, including the algorithm */
+    void memory_usage(std::map<std::string, casadi_int>& usage,
+                      std::set<const void*>& visited) const override;
+
+    /** \brief Nested functions, including the called ones */
+    std::vector<std::pair<std::string, Function> > memory_children() const override;
+
     /** \brief  Initialize */
     void init(const Dict& opts) override;
 
+    /** \brief Merge structurally equal subexpressions
+        Nodes with merged arguments are recreated, returns the number of nodes removed */
+    static casadi_int cse_merge(std::vector<MX>& ex);
+
+    /** \brief Fuse chains of elementwise operations into single loop kernels
+        Returns the number of instructions absorbed into the kernels */
+    static casadi_int fuse_elementwise(std::vector<MX>& ex);
+
+    /** \brief Inline calls to MX functions with at most max_instructions instructions
+        Calls exposed by inlining are kept, returns the number of calls inlined */
+    static casadi_int inline_calls(std::vector<MX>& ex, casadi_int max_instructions);
+
+    /** \brief Replace calls to the same function that do not depend on each other by maps
+        Returns the number of calls folded into maps */
+    static casadi_int fold_map(std::vector<MX>& ex, const std::string& parallelization);
+
     /** \brief Generate code for the declarations of the C function */
     void codegen_declarations(CodeGenerator& g) const override;
 
@@ -122,6 +222,9 @@ namespace casadi {
     /** \brief Generate code for the body of the C function */
     void codegen_body(CodeGenerator& g) const override;
 
+    /** \brief Worst-case footprint of the generated code */
+    Dict codegen_footprint(const CodeGenerator& g) const override;
+
     /** \brief Extract the residual function G and the modified function Z out of an expression
      * (see Albersmeyer2010 paper) */
     void generate_lifted(Function& vdef_fcn, Function& vinit_fcn) const override;
@@ -182,6 +285,9 @@ namespace casadi {
 
     casadi_int n_instructions() const override { return algorithm_.size();}
 
+    /** \brief Estimated number of atomic operations after expansion to SX */
+    double n_instructions_sx() const override;
+
     /** *\brief get MX expression associated with instruction */
     MX instruction_MX(casadi_int k) const override;
 
@@ -191,6 +297,12 @@ namespace casadi {
     /** \brief Get default input value */
     double get_default_in(casadi_int ind) const override { return default_in_.at(ind);}
 
+    /** \brief Serialize in the binary format, including nested Functions */
+    void serialize_binary(BinarySerializer& s) const override;
+
+    /** \brief Build function from the binary format */
+    static Function deserialize_binary(BinaryDeserializer& s);
+
     /** \brief Get the (integer) input arguments of an atomic operation */
     std::vector<casadi_int> instruction_input(casadi_int k) const override;
 
@@ -57,6 +57,7 @@
 #include "binary_mx_impl.hpp"
 
 #include <typeinfo>
+#include <stack>
 
 using namespace std;
 
@@ -234,49 +235,77 @@ namespace casadi {
   }
 
   void MXNode::can_inline(std::map<const MXNode*, casadi_int>& nodeind) const {
-    // Add or mark node in map
-    std::map<const MXNode*, casadi_int>::iterator it=nodeind.find(this);
-    if (it==nodeind.end()) {
-      // First time encountered, mark inlined
-      nodeind.insert(it, make_pair(this, 0));
-
-      // Handle dependencies with recursion
-      for (casadi_int i=0; i<n_dep(); ++i) {
-        dep(i)->can_inline(nodeind);
+    // Depth-first traversal with an explicit stack, deep graphs would overflow the call stack
+    std::stack<const MXNode*> s;
+    s.push(this);
+    while (!s.empty()) {
+      const MXNode* t = s.top();
+      s.pop();
+      // Add or mark node in map
+      std::map<const MXNode*, casadi_int>::iterator it=nodeind.find(t);
+      if (it==nodeind.end()) {
+        // First time encountered, mark inlined
+        nodeind.insert(it, make_pair(t, 0));
+
+        // Handle dependencies, the first one on top
+        for (casadi_int i=t->n_dep(); i-->0; ) {
+          s.push(static_cast<const MXNode*>(t->dep(i).get()));
+        }
+      } else if (it->second==0 && t->op()!=OP_PARAMETER) {
+        // Node encountered before, do not inline (except if symbolic primitive)
+        it->second = -1;
       }
-    } else if (it->second==0 && op()!=OP_PARAMETER) {
-      // Node encountered before, do not inline (except if symbolic primitive)
-      it->second = -1;
     }
   }
 
   std::string MXNode::print_compact(std::map<const MXNode*, casadi_int>& nodeind,
                                    vector<std::string>& intermed) const {
-    // Get reference to node index
-    casadi_int& ind = nodeind[this];
-
-    // If positive, already in intermediate expressions
-    if (ind>0) return "@" + str(ind);
+    // Post-order traversal with an explicit stack of nodes and index of the next dependency
+    std::vector<std::pair<const MXNode*, casadi_int> > s;
+    // Expressions of the visited nodes, not yet used by their parent
+    std::vector<std::string> done;
+    s.push_back(make_pair(this, 0));
+    while (!s.empty()) {
+      const MXNode* t = s.back().first;
+      casadi_int next_dep = s.back().second++;
+
+      // Get reference to node index
+      casadi_int& ind = nodeind[t];
+
+      // If positive, already in intermediate expressions
+      if (next_dep==0 && ind>0) {
+        done.push_back("@" + str(ind));
+        s.pop_back();
+        continue;
+      }
 
-    // Get expressions for dependencies
-    vector<string> arg(n_dep());
-    for (casadi_int i=0; i<arg.size(); ++i) {
-      arg[i] = dep(i)->print_compact(nodeind, intermed);
-    }
+      // Get expressions for dependencies first
+      if (next_dep<t->n_dep()) {
+        s.push_back(make_pair(static_cast<const MXNode*>(t->dep(next_dep).get()), 0));
+        continue;
+      }
+      s.pop_back();
+      vector<string> arg(t->n_dep());
+      for (casadi_int i=t->n_dep(); i-->0; ) {
+        arg[i] = std::move(done.back());
+        done.pop_back();
+      }
 
-    // Get expression for this
-    string s = disp(arg);
+      // Get expression for this
+      string e = t->disp(arg);
 
-    // Decide what to do with the expression
-    if (ind==0) {
-      // Inline expression
-      return s;
-    } else {
-      // Add to list of intermediate expressions and return reference
-      intermed.push_back(s);
-      ind = intermed.size(); // For subsequent references
-      return "@" + str(ind);
+      // Decide what to do with the expression
+      if (ind==0) {
+        // Inline expression
+        done.push_back(std::move(e));
+      } else {
+        // Add to list of intermediate expressions and return reference
+        intermed.push_back(e);
+        ind = intermed.size(); // For subsequent references
+        done.push_back("@" + str(ind));
+      }
     }
+    return done.back();
   }
 
   const Function& MXNode::which_function() const {
@@ -717,6 +746,16 @@ namespace casadi {
   }
 
   MX MXNode::get_inv() const {
+    // Symbolic elimination is only viable if the LU factors stay small,
+    // otherwise let a linear solver factorize numerically
+    if (sparsity().is_square() && Sparsity::sprank(sparsity())==size1()) {
+      Sparsity L, U;
+      std::vector<casadi_int> rowperm, colperm;
+      sparsity().lu_sparse(L, U, rowperm, colperm);
+      if (L.nnz() + U.nnz() > Inverse::max_lu_nnz) {
+        return MX::solve(shared_from_this<MX>(), MX::eye(size1()));
+      }
+    }
     return MX::create(new Inverse(shared_from_this<MX>()));
   }
 
@@ -32,6 +32,7 @@
 #include "calculus.hpp"
 #include "code_generator.hpp"
 #include "linsol.hpp"
+#include "node_pool.hpp"
 #include <vector>
 #include <stack>
 
@@ -51,6 +52,12 @@ namespace casadi {
     /** \brief  Destructor */
     ~MXNode() override=0;
 
+    ///@{
+    /** \brief Allocation of nodes, cf. GlobalOptions::setNodePool */
+    static void* operator new(std::size_t sz) { return NodePool::allocate(sz);}
+    static void operator delete(void* p) { NodePool::deallocate(p);}
+    ///@}
+
     /** \brief Check the truth value of this node
      */
     virtual bool __nonzero__() const;
@@ -25,7 +25,11 @@
 
 #include "nlp_builder.hpp"
 #include "core.hpp"
-#include <fstream>
+#include "binary_serializer.hpp"
+#include "thread_pool.hpp"
+#include <cctype>
+#include <chrono>
+#include <cstring>
 
 using namespace std;
 namespace casadi {
@@ -46,29 +50,40 @@ namespace casadi {
   }
 
   NlImporter::NlImporter(NlpBuilder& nlp, const std::string& filename, const Dict& opts)
-  : nlp_(nlp) {
+  : nlp_(nlp), r_(nullptr, nullptr, false) {
     // Set default options
     verbose_=false;
+    max_num_threads_ = ThreadPool::hardware_concurrency();
 
     // Read user options
     for (auto&& op : opts) {
       if (op.first == "verbose") {
         verbose_ = op.second;
+      } else if (op.first == "max_num_threads") {
+        max_num_threads_ = op.second;
       } else {
         stringstream ss;
         ss << "Unknown option \"" << op.first << "\"" << endl;
         throw CasadiException(ss.str());
       }
     }
-    // Open file for reading
-    s_.open(filename.c_str());
+    casadi_assert(max_num_threads_>=1, "Option 'max_num_threads' must be positive");
+    auto t_start = std::chrono::steady_clock::now();
+
+    // Map the file into memory
     if (verbose_) casadi_message("Reading file \"" + filename + "\"");
+    buf_.reset(new BinaryBuffer(filename));
+    const char* end = buf_->data() + buf_->size();
 
     // Read the header of the NL-file (first 10 lines)
     const casadi_int header_sz = 10;
     vector<string> header(header_sz);
+    const char* pos = buf_->data();
     for (casadi_int k=0; k<header_sz; ++k) {
-      getline(s_, header[k]);
+      const char* eol = pos==end ? end : static_cast<const char*>(memchr(pos, '\n', end-pos));
+      casadi_assert(eol!=nullptr && eol!=end, "File could not be read");
+      header[k].assign(pos, eol);
+      pos = eol + 1;
     }
 
     // Assert that the file is not in binary form
@@ -79,6 +94,7 @@ namespace casadi {
     } else {
       casadi_error("File could not be read");
     }
+    r_ = NlReader(pos, end, binary_);
 
     // Get the number of objectives and constraints
     stringstream ss(header[1]);
@@ -160,23 +176,32 @@ namespace casadi {
     // All variables, including dependent
     v_ = nlp_.x;
 
-    if (binary_) {
-      streampos offset = s_.tellg();
-      s_.close();
-      s_.open(filename.c_str(), std::ifstream::binary);
-      s_.seekg(offset);
-    }
+    // Constraint bodies and linear terms, built after reading all segments
+    c_body_.resize(n_con_, nullptr);
+    c_lin_.resize(n_con_);
 
     // Read segments
     parse();
+    auto t_parse = std::chrono::steady_clock::now();
+
+    // Build the constraints
+    build_constraints();
+    auto t_end = std::chrono::steady_clock::now();
 
     // multiple the objective sign
     nlp_.f = sign_*nlp_.f;
+
+    if (verbose_) {
+      double t1 = std::chrono::duration<double>(t_parse - t_start).count();
+      double t2 = std::chrono::duration<double>(t_end - t_parse).count();
+      double mb = static_cast<double>(buf_->size())/1e6;
+      casadi_message("Read " + str(mb) + " MB in " + str(t1+t2) + " s "
+                     "(" + str(mb/(t1+t2)) + " MB/s): " + str(t1) + " s for the segments, "
+                     + str(t2) + " s for the constraints");
+    }
   }
 
   NlImporter::~NlImporter() {
-    // Close the NL file
-    s_.close();
   }
 
   void NlImporter::parse() {
@@ -184,10 +209,9 @@ namespace casadi {
     char key;
 
     // Process segments
-    while (true) {
+    while (!r_.at_end()) {
       // Read segment key
       key = read_char();
-      if (s_.eof()) break; // end of file encountered
       switch (key) {
         case 'F': F_segment(); break;
         case 'S': S_segment(); break;
@@ -207,9 +231,78 @@ namespace casadi {
     }
   }
 
-  MX NlImporter::expr() {
+  void NlImporter::build_constraints() {
+    // Split into chunks, claimed dynamically since expression sizes vary
+    casadi_int n_threads = std::max(casadi_int(1), std::min(max_num_threads_, n_con_));
+    casadi_int n_chunks = std::min(n_con_, 16*n_threads);
+    if (verbose_) {
+      casadi_message("Building " + str(n_con_) + " constraints with "
+                     + str(n_threads) + " threads");
+    }
+    ThreadPool::run(n_chunks, n_threads, [&](casadi_int k, casadi_int t) {
+      for (casadi_int i=(k*n_con_)/n_chunks; i<((k+1)*n_con_)/n_chunks; ++i) {
+        // Nonlinear part
+        if (c_body_[i]) {
+          NlReader r(c_body_[i], r_.end, binary_);
+          nlp_.g[i] = expr(r);
+        }
+        // Linear terms
+        for (auto&& e : c_lin_[i]) nlp_.g[i] += e.second*v_.at(e.first);
+      }
+    });
+  }
+
+  void NlImporter::skip_expr(NlReader& r) const {
+    // Start of the instruction
+    const char* start = r.pos;
+
+    // Read the instruction
+    char inst = r.read_char();
+    switch (inst) {
+      case 'v': r.skip_number(sizeof(int)); return;
+      case 'n': r.skip_number(sizeof(double)); return;
+      case 's': r.skip_number(2); return;
+      case 'l': r.skip_number(4); return;
+      case 'o': break;
+      default: casadi_error("Unknown instruction: " + str(inst));
+    }
+
+    // Skip the dependencies of the operation, cf. expr
+    int i = r.read_int();
+    switch (i) {
+      // Unary operations
+      case 13:  case 14:  case 15:  case 16:  case 34:  case 37:  case 38:  case 39:  case 40:
+      case 41:  case 43:  case 42:  case 44:  case 45:  case 46:  case 47:  case 49:  case 50:
+      case 51:  case 52:  case 53:
+      skip_expr(r);
+      return;
+
+      // Binary operations
+      case 0:   case 1:   case 2:   case 3:   case 4:   case 5:   case 6:   case 20:  case 21:
+      case 22:  case 23:  case 24:  case 28:  case 29:  case 30:  case 48:  case 55:  case 56:
+      case 57:  case 58:  case 73:
+      skip_expr(r);
+      skip_expr(r);
+      return;
+
+      // N-ary operators
+      case 11: case 12: case 54: case 59: case 60: case 61: case 70: case 71: case 74:
+      {
+        int n = r.read_int();
+        for (int k=0; k<n; ++k) skip_expr(r);
+        return;
+      }
+
+      default:
+      // Unsupported, let expr raise the error
+      r.pos = start;
+      expr(r);
+    }
+  }
+
+  MX NlImporter::expr(NlReader& r) const {
     // Read the instruction
-    char inst = read_char();
+    char inst = r.read_char();
 
     // Temporaries
     int i;
@@ -224,7 +317,7 @@ namespace casadi {
       // Symbolic variable
       case 'v':
       // Read the variable number
-      i = read_int();
+      i = r.read_int();
 
       // Return the corresponding expression
       return v_.at(i);
@@ -233,7 +326,7 @@ namespace casadi {
       case 'n':
 
       // Read the floating point number
-      d = read_double();
+      d = r.read_double();
 
       // Return an expression containing the number
       return d;
@@ -242,7 +335,7 @@ namespace casadi {
       case 's':
 
       // Read the short number
-      d = read_short();
+      d = r.read_short();
 
       // Return an expression containing the number
       return d;
@@ -251,7 +344,7 @@ namespace casadi {
       case 'l':
 
       // Read the short number
-      d = static_cast<double>(read_long());
+      d = static_cast<double>(r.read_long());
 
       // Return an expression containing the number
       return d;
@@ -260,7 +353,7 @@ namespace casadi {
       case 'o':
 
       // Read the operation
-      i = read_int();
+      i = r.read_int();
 
       // Process
       switch (i) {
@@ -271,7 +364,7 @@ namespace casadi {
         case 51:  case 52:  case 53:
         {
           // Read dependency
-          MX x = expr();
+          MX x = expr(r);
 
           // Perform operation
           switch (i) {
@@ -309,8 +402,8 @@ namespace casadi {
         case 57:  case 58:  case 73:
         {
           // Read dependencies
-          MX x = expr();
-          MX y = expr();
+          MX x = expr(r);
+          MX y = expr(r);
 
           // Perform operation
           switch (i) {
@@ -347,12 +440,12 @@ namespace casadi {
         case 11: case 12: case 54: case 59: case 60: case 61: case 70: case 71: case 74:
         {
           // Number of elements in the sum
-          int n = read_int();
+          int n = r.read_int();
 
           // Collect the arguments
           vector<MX> args(n);
           for (int k=0; k<n; ++k) {
-            args[k] = expr();
+            args[k] = expr(r);
           }
 
           // Perform the operation
@@ -396,7 +489,6 @@ namespace casadi {
       break;
 
       default:
-       uout() << s_.tellg() << std::endl;
       casadi_error("Unknown instruction: " + str(inst));
     }
 
@@ -441,62 +533,107 @@ namespace casadi {
     v_.at(i) += expr();
   }
 
-  int NlImporter::read_int() {
-    int i;
-    if (binary_) {
-      s_.read(reinterpret_cast<char *>(&i), sizeof(int));
-    } else {
-      s_ >> i;
+  void NlReader::error(const std::string& msg) const {
+    casadi_error(msg + ", " + str(end - pos) + " bytes before the end of the file");
+  }
+
+  void NlReader::skip_space() {
+    while (pos!=end) {
+      if (*pos=='#') {
+        // Comment, skip to the end of the line
+        const char* eol = static_cast<const char*>(memchr(pos, '\n', end-pos));
+        pos = eol ? eol : end;
+      } else if (isspace(static_cast<unsigned char>(*pos))) {
+        pos++;
+      } else {
+        break;
+      }
     }
-    return i;
   }
 
-  char NlImporter::read_char() {
-    char c;
-    if (binary_) {
-      s_.read(&c, 1);
+  bool NlReader::at_end() {
+    if (!binary) skip_space();
+    return pos==end;
+  }
+
+  template<typename T>
+  T NlReader::read_binary() {
+    if (static_cast<size_t>(end-pos) < sizeof(T)) error("Unexpected end of file");
+    T v;
+    memcpy(&v, pos, sizeof(T));
+    pos += sizeof(T);
+    return v;
+  }
+
+  void NlReader::skip_number(size_t sz) {
+    if (binary) {
+      if (static_cast<size_t>(end-pos) < sz) error("Unexpected end of file");
+      pos += sz;
     } else {
-      s_ >> c;
+      skip_space();
+      while (pos!=end && !isspace(static_cast<unsigned char>(*pos)) && *pos!='#') pos++;
     }
-    return c;
   }
 
-  double NlImporter::read_double() {
+  int NlReader::read_int() {
+    if (binary) return read_binary<int32_t>();
+    return static_cast<int>(read_long());
+  }
+
+  char NlReader::read_char() {
+    if (binary) return read_binary<char>();
+    skip_space();
+    if (pos==end) error("Unexpected end of file");
+    return *pos++;
+  }
+
+  double NlReader::read_double() {
+    if (binary) return read_binary<double>();
+    skip_space();
+    // Find the end of the token
+    const char* tok_end = pos;
+    while (tok_end!=end && !isspace(static_cast<unsigned char>(*tok_end))
+           && *tok_end!='#') tok_end++;
+    if (tok_end==pos) error("Number expected");
+    // strtod stops at the whitespace, except for a token at the very end of the file
+    char* e;
     double d;
-    if (binary_) {
-      s_.read(reinterpret_cast<char *>(&d), sizeof(double));
+    if (tok_end!=end) {
+      d = strtod(pos, &e);
+      if (e!=tok_end) error("Number expected");
     } else {
-      s_ >> d;
+      string tok(pos, tok_end);
+      d = strtod(tok.c_str(), &e);
+      if (e!=tok.c_str()+tok.size()) error("Number expected");
     }
+    pos = tok_end;
     return d;
   }
 
-  short NlImporter::read_short() {
-    short d;
-    if (binary_) {
-      s_.read(reinterpret_cast<char *>(&d), 2);
-    } else {
-      s_ >> d;
-    }
-    return d;
+  short NlReader::read_short() {
+    if (binary) return read_binary<int16_t>();
+    return static_cast<short>(read_long());
   }
 
-  long NlImporter::read_long() {
-    long d;
-    if (binary_) {
-      s_.read(reinterpret_cast<char *>(&d), 4);
-    } else {
-      s_ >> d;
-    }
-    return d;
+  long NlReader::read_long() {
+    if (binary) return read_binary<int32_t>();
+    skip_space();
+    bool neg = pos!=end && *pos=='-';
+    if (neg || (pos!=end && *pos=='+')) pos++;
+    if (pos==end || !isdigit(static_cast<unsigned char>(*pos))) error("Integer expected");
+    long v = 0;
+    while (pos!=end && isdigit(static_cast<unsigned char>(*pos))) v = 10*v + (*pos++ - '0');
+    return neg ? -v : v;
   }
 
   void NlImporter::C_segment() {
     // Get the number
     int i = read_int();
 
-    // Parse and save expression
-    nlp_.g.at(i) = expr();
+    // Save the position of the expression, built in build_constraints
+    casadi_assert(i>=0 && i<n_con_, "Constraint index out of bounds");
+    c_body_[i] = r_.pos;
+    skip_expr(r_);
   }
 
   void NlImporter::L_segment() {
@@ -676,7 +813,7 @@ namespace casadi {
       double c = read_double();
 
       // Add to constraints
-      nlp_.g.at(i) += c*v_.at(j);
+      c_lin_.at(i).push_back(make_pair(j, c));
     }
   }
 
@@ -27,6 +27,7 @@
 #define CASADI_NLP_BUILDER_HPP
 
 #include "mx.hpp"
+#include <memory>
 
 namespace casadi {
 
@@ -68,7 +69,13 @@ namespace casadi {
     std::vector<bool> discrete;
     ///@}
 
-    /// Import an .nl file
+    /** \brief Import an .nl file, in text or binary format
+     *
+     * Options:
+     *   verbose: Print progress and the parse throughput [false]
+     *   max_num_threads: Maximum number of threads building the constraint
+     *                    expressions [number of hardware threads]
+     */
     void import_nl(const std::string& filename, const Dict& opts = Dict());
 
     /// Readable name of the class
@@ -86,8 +93,46 @@ namespace casadi {
   };
 
 #ifndef SWIG
+  class BinaryBuffer;
+
+  /** \brief Cursor into an .nl file in memory
+  In the text format, numbers are separated by whitespace and '#' starts a comment
+  that extends to the end of the line. In the binary format, they are in host byte
+  order with 4-byte integers and longs, 2-byte shorts and 8-byte doubles.
+  */
+  class CASADI_EXPORT NlReader {
+  public:
+    // Constructor
+    NlReader(const char* pos, const char* end, bool binary)
+      : pos(pos), end(end), binary(binary) {}
+    int read_int();
+    char read_char();
+    double read_double();
+    short read_short();
+    long read_long();
+    // Skip a number of a given size in the binary format, without converting it
+    void skip_number(size_t sz);
+    // Has the end of the file been reached?
+    bool at_end();
+    // Current position and end of the file
+    const char* pos;
+    const char* end;
+    // Binary mode
+    bool binary;
+  private:
+    // Skip whitespace and comments, text format only
+    void skip_space();
+    // Read a value in the binary format
+    template<typename T> T read_binary();
+    // Throw an error at the current position
+    void error(const std::string& msg) const;
+  };
+
   /** \Helper class for .nl import
   The .nl format is described in "Writing .nl Files" paper by David M. Gay (2005)
+  The file is memory-mapped and read in two passes. The first pass reads all segments
+  except the bodies of the algebraic constraints, which it only skips. The second pass
+  builds the constraint expressions in parallel chunks.
   \date 2016
   \author Joel Andersson
   */
@@ -98,21 +143,26 @@ namespace casadi {
     // Destructor
     ~NlImporter();
   private:
-    int read_int();
-    char read_char();
-    double read_double();
-    short read_short();
-    long read_long();
+    int read_int() { return r_.read_int();}
+    char read_char() { return r_.read_char();}
+    double read_double() { return r_.read_double();}
     // Reference to the class
     NlpBuilder& nlp_;
     // Options
     bool verbose_;
+    casadi_int max_num_threads_;
     // Binary mode
     bool binary_;
-    // File stream
-    std::ifstream s_;
+    // File contents
+    std::unique_ptr<BinaryBuffer> buf_;
+    // Position in the file during the first pass
+    NlReader r_;
     // All variables, including dependent
     std::vector<MX> v_;
+    // Start of the body of each algebraic constraint, null if none
+    std::vector<const char*> c_body_;
+    // Linear terms of each algebraic constraint
+    std::vector<std::vector<std::pair<int, double> > > c_lin_;
     // Number of objectives and constraints
     casadi_int n_var_, n_con_, n_obj_, n_eq_, n_lcon_;
     // nonlinear vars in constraints, objectives, both
@@ -124,6 +174,8 @@ namespace casadi {
     MX sign_;
     // Parse the file
     void parse();
+    // Build the algebraic constraints
+    void build_constraints();
     // Imported function description
     void F_segment();
     // Suffix values
@@ -151,7 +203,10 @@ namespace casadi {
     // Linear terms in the objective function
     void G_segment();
     /// Read an expression from an NL-file (Polish infix format)
-    MX expr();
+    MX expr() { return expr(r_);}
+    MX expr(NlReader& r) const;
+    /// Skip an expression without building it
+    void skip_expr(NlReader& r) const;
   };
 #endif // SWIG
 
@@ -204,6 +204,8 @@ namespace casadi {
     calc_lam_p_ = true;
     no_nlp_grad_ = false;
     error_on_fail_ = false;
+    warm_start_ = false;
+    sens_linsol_plugin_ = "qr";
   }
 
   Nlpsol::~Nlpsol() {
@@ -250,6 +252,14 @@ namespace casadi {
      {{"expand",
        {OT_BOOL,
         "Replace MX with SX expressions in problem formulation [false]"}},
+      {"expand_auto",
+       {OT_BOOL,
+        "Replace MX with SX expressions in problem formulation if the number of SX "
+        "instructions, estimated without expanding, does not exceed expand_max_instructions. "
+        "The estimates and the decision are reported in the statistics [false]"}},
+      {"expand_max_instructions",
+       {OT_INT,
+        "Largest estimated number of SX instructions for expand_auto [1e6]"}},
       {"iteration_callback",
        {OT_FUNCTION,
         "A function that will be called at each iteration with the solver as input. "
@@ -303,7 +313,20 @@ namespace casadi {
         "Options to be passed to the oracle function"}},
       {"error_on_fail",
        {OT_BOOL,
-        "When the numerical process returns unsuccessfully, raise an error (default false)."}}
+        "When the numerical process returns unsuccessfully, raise an error (default false)."}},
+      {"sens_linsol",
+       {OT_STRING,
+        "Linear solver for the (unsymmetric) KKT system of the parametric sensitivities. "
+        "The factorization is shared by all forward and reverse derivatives of the solver "
+        "and reused as long as the solution is unchanged (default qr)."}},
+      {"sens_linsol_options",
+       {OT_DICT,
+        "Options to be passed to the linear solver of the parametric sensitivities"}},
+      {"warm_start",
+       {OT_BOOL,
+        "Preserve solver-internal state (Hessian approximations, penalty parameters, active "
+        "sets, application state) between calls with the same memory object. The primal-dual "
+        "initial guess is still taken from x0, lam_x0 and lam_g0 (default false)."}}
      }
   };
 
@@ -312,12 +335,17 @@ namespace casadi {
     OracleFunction::init(opts);
 
     // Default options
-    bool expand = false;
+    bool expand = false, expand_auto = false;
+    casadi_int expand_max_instructions = 1000000;
 
     // Read options
     for (auto&& op : opts) {
       if (op.first=="expand") {
         expand = op.second;
+      } else if (op.first=="expand_auto") {
+        expand_auto = op.second;
+      } else if (op.first=="expand_max_instructions") {
+        expand_max_instructions = op.second;
       } else if (op.first=="iteration_callback") {
         fcallback_ = op.second;
       } else if (op.first=="iteration_callback_step") {
@@ -346,6 +374,12 @@ namespace casadi {
         bound_consistency_ = op.second;
       } else if (op.first=="error_on_fail") {
         error_on_fail_ = op.second;
+      } else if (op.first=="warm_start") {
+        warm_start_ = op.second;
+      } else if (op.first=="sens_linsol") {
+        sens_linsol_plugin_ = op.second.to_string();
+      } else if (op.first=="sens_linsol_options") {
+        sens_linsol_options_ = op.second;
       }
     }
 
@@ -356,7 +390,11 @@ namespace casadi {
     }
 
     // Replace MX oracle with SX oracle?
-    if (expand) oracle_ = oracle_.expand();
+    if (expand) {
+      oracle_ = oracle_.expand();
+    } else if (expand_auto) {
+      this->expand_auto(expand_max_instructions);
+    }
 
     // Get dimensions
     nx_ = nnz_out(NLPSOL_X);
@@ -443,6 +481,7 @@ namespace casadi {
     m->add_stat(name_);
     m->add_stat("callback_fun");
     m->success = false;
+    m->warm = false;
     return 0;
   }
 
@@ -540,6 +579,8 @@ namespace casadi {
     // Reset statistics
     for (auto&& s : m->fstats) s.second.reset();
     m->fstats.at(name_).tic();
+    m->trace.start();
+    m->deadline.start(max_wall_time_, &cancel_epoch_);
 
     // Bounds, given parameter values
     m->p = arg[NLPSOL_P];
@@ -619,6 +660,7 @@ namespace casadi {
     // Finalize/print statistics
     m->fstats.at(name_).toc();
     if (print_time_)  print_fstats(m);
+    if (!m->success) m->trace.dump_on_fail();
 
     if (error_on_fail_ && !m->success)
       casadi_error("nlpsol process failed. "
@@ -673,6 +715,15 @@ namespace casadi {
     return ret;
   }
 
+  Linsol Nlpsol::sens_linsol(const Sparsity& sp) const {
+    if (sens_linsol_.is_null()) {
+      sens_linsol_ = Linsol(name_ + "_sens_linsol", sens_linsol_plugin_, sp,
+                            sens_linsol_options_);
+    }
+    casadi_assert_dev(sens_linsol_.sparsity()==sp);
+    return sens_linsol_;
+  }
+
 
   Function Nlpsol::
   get_forward(casadi_int nfwd, const std::string& name,
@@ -766,7 +817,7 @@ namespace casadi {
     MX v = MX::vertcat({fwd_alpha_x, fwd_alpha_g});
 
     // Solve
-    v = MX::solve(H, v, "qr");
+    v = sens_linsol(H.sparsity()).solve(H, v);
 
     // Extract sensitivities in x, lam_x and lam_g
     vector<MX> v_split = vertsplit(v, {0, nx_, nx_+ng_});
@@ -882,7 +933,7 @@ namespace casadi {
 
     // Solve to get beta_x_bar, beta_g_bar
     MX v = MX::vertcat({adj_x + adj_x0, adj_lam_g + adj_lam_g0});
-    v = MX::solve(H.T(), v, "qr");
+    v = sens_linsol(H.sparsity()).solve(H, v, true);
     vector<MX> v_split = vertsplit(v, {0, nx_, nx_+ng_});
     MX beta_x_bar = v_split.at(0);
     MX beta_g_bar = v_split.at(1);
@@ -931,7 +982,7 @@ namespace casadi {
     // Callback outputs
     fill_n(m->res, fcallback_.n_out(), nullptr);
     double ret = 0;
-    m->arg[0] = &ret;
+    m->res[0] = &ret;
 
     // Start timer
     m->fstats.at("callback_fun").tic();
@@ -29,6 +29,7 @@
 #include "nlpsol.hpp"
 #include "oracle_function.hpp"
 #include "plugin_interface.hpp"
+#include "linsol.hpp"
 
 
 /// \cond INTERNAL
@@ -53,6 +54,9 @@ namespace casadi {
 
     // Success?
     bool success;
+
+    // Solver-internal state of a previous call available for warm starting?
+    bool warm;
   };
 
   /** \brief NLP solver storage class
@@ -82,6 +86,9 @@ namespace casadi {
     /// Throw an exception on failure?
     bool error_on_fail_;
 
+    /// Preserve solver-internal state between calls?
+    bool warm_start_;
+
     ///@{
     /** \brief Options */
     bool eval_errors_fatal_;
@@ -100,6 +107,13 @@ namespace casadi {
     /// Cache for KKT function
     mutable WeakRef kkt_;
 
+    /// Linear solver for the KKT system of the parametric sensitivities
+    std::string sens_linsol_plugin_;
+    Dict sens_linsol_options_;
+
+    /// Shared by all derivative functions, created on demand
+    mutable Linsol sens_linsol_;
+
     /// Constructor
     Nlpsol(const std::string& name, const Function& oracle);
 
@@ -195,6 +209,9 @@ namespace casadi {
     // Get KKT function
     Function kkt() const;
 
+    // Linear solver for the KKT system of the parametric sensitivities
+    Linsol sens_linsol(const Sparsity& sp) const;
+
     // Make sure primal-dual solution is consistent with bounds
     static void bound_consistency(casadi_int n, double* x, double* lam,
                                   const double* lbx, const double* ubx);
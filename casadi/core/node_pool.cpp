@@ -0,0 +1,241 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#include "node_pool.hpp"
+#include "global_options.hpp"
+#include <new>
+
+#ifdef CASADI_WITH_THREAD
+#include <atomic>
+#ifdef CASADI_WITH_THREAD_MINGW
+#include <mingw.mutex.h>
+#else // CASADI_WITH_THREAD_MINGW
+#include <mutex>
+#endif // CASADI_WITH_THREAD_MINGW
+#endif //CASADI_WITH_THREAD
+
+namespace casadi {
+
+  // Header in front of each node, keeps the 16 byte alignment
+  struct NodeHeader {
+    // Size class, 0 if from the system allocator
+    std::size_t cls;
+    // Requested size
+    std::size_t sz;
+  };
+  static const std::size_t node_header = 16;
+
+  // Size classes are multiples of 16 bytes, larger nodes use the system allocator
+  static const std::size_t node_granularity = 16;
+  static const std::size_t node_classes = 17;
+  static const std::size_t node_chunk = 1 << 16;
+
+  // Singly linked free lists, one per size class
+  struct NodeFreeLists {
+    void* head[node_classes];
+  };
+
+  // Free lists shared by all threads: blocks of exited threads
+  struct NodeSharedLists {
+    NodeFreeLists lists;
+#ifdef CASADI_WITH_THREAD
+    std::mutex mtx;
+#endif //CASADI_WITH_THREAD
+    NodeSharedLists() {
+      for (std::size_t c=0; c<node_classes; ++c) lists.head[c] = nullptr;
+    }
+  };
+
+  // Never destroyed, nodes may be freed during static destruction
+  static NodeSharedLists& node_shared() {
+    static NodeSharedLists* s = new NodeSharedLists();
+    return *s;
+  }
+
+#ifdef CASADI_WITH_THREAD
+  static std::atomic<std::size_t> node_memory(0), node_peak(0);
+#else // CASADI_WITH_THREAD
+  static std::size_t node_memory = 0, node_peak = 0;
+#endif //CASADI_WITH_THREAD
+
+#ifdef CASADI_WITH_THREAD
+  // Free lists of the thread, null after they have been returned to the shared lists
+  static thread_local NodeFreeLists* node_local_lists = nullptr;
+  static thread_local bool node_local_done = false;
+
+  // Returns the blocks of the thread to the shared lists when the thread exits
+  struct NodeLocalLists {
+    NodeFreeLists lists;
+    NodeLocalLists() {
+      for (std::size_t c=0; c<node_classes; ++c) lists.head[c] = nullptr;
+    }
+    ~NodeLocalLists() {
+      NodeSharedLists& s = node_shared();
+      std::lock_guard<std::mutex> lock(s.mtx);
+      for (std::size_t c=0; c<node_classes; ++c) {
+        while (lists.head[c]) {
+          void* b = lists.head[c];
+          lists.head[c] = *static_cast<void**>(b);
+          *static_cast<void**>(b) = s.lists.head[c];
+          s.lists.head[c] = b;
+        }
+      }
+      node_local_lists = nullptr;
+      node_local_done = true;
+    }
+  };
+
+  static NodeFreeLists* node_local() {
+    if (node_local_lists==nullptr && !node_local_done) {
+      static thread_local NodeLocalLists l;
+      node_local_lists = &l.lists;
+    }
+    return node_local_lists;
+  }
+#endif //CASADI_WITH_THREAD
+
+  // Carve a new chunk into blocks of size class c
+  static void* node_refill(std::size_t c) {
+    std::size_t bsz = c*node_granularity, n = node_chunk/bsz;
+    char* chunk = static_cast<char*>(::operator new(n*bsz));
+    // Link all blocks but the first one
+    void* head = nullptr;
+    for (std::size_t k=n; k-->1; ) {
+      void* b = chunk + k*bsz;
+      *static_cast<void**>(b) = head;
+      head = b;
+    }
+#ifdef CASADI_WITH_THREAD
+    NodeFreeLists* l = node_local();
+    if (l) {
+      l->head[c] = head;
+      return chunk;
+    }
+#endif //CASADI_WITH_THREAD
+    NodeSharedLists& s = node_shared();
+#ifdef CASADI_WITH_THREAD
+    std::lock_guard<std::mutex> lock(s.mtx);
+#endif //CASADI_WITH_THREAD
+    for (void* b=head; b; ) {
+      void* next = *static_cast<void**>(b);
+      *static_cast<void**>(b) = s.lists.head[c];
+      s.lists.head[c] = b;
+      b = next;
+    }
+    return chunk;
+  }
+
+  // Take a block of size class c from the free lists
+  static void* node_pop(std::size_t c) {
+#ifdef CASADI_WITH_THREAD
+    NodeFreeLists* l = node_local();
+    if (l && l->head[c]) {
+      void* b = l->head[c];
+      l->head[c] = *static_cast<void**>(b);
+      return b;
+    }
+#endif //CASADI_WITH_THREAD
+    {
+      NodeSharedLists& s = node_shared();
+#ifdef CASADI_WITH_THREAD
+      std::lock_guard<std::mutex> lock(s.mtx);
+#endif //CASADI_WITH_THREAD
+      void* b = s.lists.head[c];
+      if (b) {
+        s.lists.head[c] = *static_cast<void**>(b);
+        return b;
+      }
+    }
+    return node_refill(c);
+  }
+
+  // Return a block of size class c to the free lists
+  static void node_push(void* b, std::size_t c) {
+#ifdef CASADI_WITH_THREAD
+    NodeFreeLists* l = node_local();
+    if (l) {
+      *static_cast<void**>(b) = l->head[c];
+      l->head[c] = b;
+      return;
+    }
+#endif //CASADI_WITH_THREAD
+    NodeSharedLists& s = node_shared();
+#ifdef CASADI_WITH_THREAD
+    std::lock_guard<std::mutex> lock(s.mtx);
+#endif //CASADI_WITH_THREAD
+    *static_cast<void**>(b) = s.lists.head[c];
+    s.lists.head[c] = b;
+  }
+
+  void* NodePool::allocate(std::size_t sz) {
+    // Memory statistics
+    std::size_t m = node_memory += sz;
+#ifdef CASADI_WITH_THREAD
+    std::size_t p = node_peak.load(std::memory_order_relaxed);
+    while (m>p && !node_peak.compare_exchange_weak(p, m, std::memory_order_relaxed)) {}
+#else // CASADI_WITH_THREAD
+    if (m>node_peak) node_peak = m;
+#endif //CASADI_WITH_THREAD
+    // Allocate block with header
+    std::size_t c = (sz + node_header + node_granularity - 1) / node_granularity;
+    void* b;
+    if (GlobalOptions::node_pool && c<node_classes) {
+      b = node_pop(c);
+    } else {
+      b = ::operator new(sz + node_header);
+      c = 0;
+    }
+    NodeHeader* h = static_cast<NodeHeader*>(b);
+    h->cls = c;
+    h->sz = sz;
+    return static_cast<char*>(b) + node_header;
+  }
+
+  void NodePool::deallocate(void* p) {
+    if (p==nullptr) return;
+    void* b = static_cast<char*>(p) - node_header;
+    NodeHeader* h = static_cast<NodeHeader*>(b);
+    node_memory -= h->sz;
+    if (h->cls==0) {
+      ::operator delete(b);
+    } else {
+      node_push(b, h->cls);
+    }
+  }
+
+  std::size_t NodePool::memory() {
+    return node_memory;
+  }
+
+  std::size_t NodePool::peak_memory() {
+    return node_peak;
+  }
+
+  void NodePool::reset_peak_memory() {
+    node_peak = static_cast<std::size_t>(node_memory);
+  }
+
+} // namespace casadi
@@ -0,0 +1,65 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#ifndef CASADI_NODE_POOL_HPP
+#define CASADI_NODE_POOL_HPP
+
+#include <cstddef>
+#include <casadi/core/casadi_export.h>
+
+/// \cond INTERNAL
+
+namespace casadi {
+
+  /** \brief Allocation of expression graph nodes, cf. GlobalOptions::setNodePool
+   *
+   * When enabled, SXNode and MXNode instances are taken from per-thread free lists
+   * of a few size classes, refilled from large chunks, instead of from the system
+   * allocator. Freed nodes are kept in the pool for reuse. The memory of all live
+   * nodes is counted also when the pool is disabled.
+   */
+  class CASADI_EXPORT NodePool {
+  public:
+    /// Allocate memory for a node of sz bytes
+    static void* allocate(std::size_t sz);
+
+    /// Free memory allocated with allocate
+    static void deallocate(void* p);
+
+    /// Memory [bytes] used by the nodes currently alive
+    static std::size_t memory();
+
+    /// Peak of memory(), since the start or the last reset
+    static std::size_t peak_memory();
+
+    /// Reset the peak to the current memory use
+    static void reset_peak_memory();
+  };
+
+} // namespace casadi
+/// \endcond
+
+#endif // CASADI_NODE_POOL_HPP
@@ -160,6 +160,18 @@ OptiSol Opti::solve() {
   }
 }
 
+Function Opti::to_function(const std::string& name,
+    const std::vector<MX>& args, const std::vector<MX>& res,
+    const std::vector<std::string>& name_in,
+    const std::vector<std::string>& name_out,
+    const Dict& opts) {
+  try {
+    return (*this)->to_function(name, args, res, name_in, name_out, opts);
+  } catch (exception& e) {
+    THROW_ERROR("to_function", e.what());
+  }
+}
+
 DM Opti::value(const MX& x, const std::vector<MX>& values) const {
   try {
     return (*this)->value(x, values);
@@ -164,6 +164,10 @@ public:
   *            In practice, not all nlpsol plugins may be supported yet
   * \param[in] options passed on to nlpsol plugin
   *            No stability can be guaranteed about this part of the API
+  *            Opti itself interprets 'structure_detection': with 'auto',
+  *            the solver sees variables and constraints in stage-wise ordering,
+  *            such that structure-exploiting solvers (blocksqp, or sqpmethod with
+  *            qpsol hpmpc, condensing or riccati) can detect a multistage structure
   * \param[in] options to be passed to nlpsol solver
   *            No stability can be guaranteed about this part of the API
   */
@@ -194,6 +198,30 @@ public:
   /// Crunch the numbers; solve the problem
   OptiSol solve();
 
+  /** \brief Create a CasADi Function from the Opti solver
+  *
+  * The solver is constructed once and embedded in the returned Function,
+  * such that repeated evaluation involves no symbolic work.
+  *
+  * \param[in] args Inputs: variables, parameters or dual variables of this Opti instance.
+  *            A variable input acts as initial guess, a dual input as initial guess
+  *            for the multipliers. Symbols that are not inputs are frozen at the
+  *            initial guess and parameter values at the time of calling to_function.
+  * \param[in] res Outputs: expressions in terms of variables, parameters and duals,
+  *            evaluated at the solution
+  *
+  * \verbatim
+  * f = opti.to_function('f', [p, x], [x, opti.f])
+  * [x_opt, f_opt] = f(p_val, x_prev)
+  * \endverbatim
+  * Feeding the solution of one call as initial guess to the next warm-starts the solver.
+  */
+  Function to_function(const std::string& name,
+      const std::vector<MX>& args, const std::vector<MX>& res,
+      const std::vector<std::string>& name_in=std::vector<std::string>(),
+      const std::vector<std::string>& name_out=std::vector<std::string>(),
+      const Dict& opts=Dict());
+
   /// @{
   /** Obtain value of expression at the current value
   *
@@ -132,7 +132,7 @@ std::string OptiNode::format_stacktrace(const Dict& stacktrace, casadi_int inden
 }
 
 std::string OptiNode::describe(const MX& expr, casadi_int indent) const {
-  if (problem_dirty()) return baked_copy().describe(expr, indent);
+  bake_if_dirty();
   std::string s_indent;
   for (casadi_int i=0;i<indent;++i) {
     s_indent+= "  ";
@@ -189,7 +189,7 @@ std::string OptiNode::describe(const MX& expr, casadi_int indent) const {
 }
 
 std::string OptiNode::g_describe(casadi_int i) const {
-  if (problem_dirty()) return baked_copy().g_describe(i);
+  bake_if_dirty();
   MX expr = g_lookup(i);
   casadi_int local_i = i-meta_con(expr).start + GlobalOptions::start_index;
   std::string description = describe(expr);
@@ -199,7 +199,7 @@ std::string OptiNode::g_describe(casadi_int i) const {
 }
 
 std::string OptiNode::x_describe(casadi_int i) const {
-  if (problem_dirty()) return baked_copy().x_describe(i);
+  bake_if_dirty();
   MX symbol = x_lookup(i);
   casadi_int local_i = i-meta(symbol).start + GlobalOptions::start_index;
   std::string description = describe(symbol);
@@ -209,7 +209,7 @@ std::string OptiNode::x_describe(casadi_int i) const {
 }
 
 MX OptiNode::x_lookup(casadi_int i) const {
-  if (problem_dirty()) return baked_copy().x_lookup(i);
+  bake_if_dirty();
   casadi_assert_dev(i>=0);
   casadi_assert_dev(i<nx());
   std::vector<MX> x = active_symvar(OPTI_VAR);
@@ -222,7 +222,7 @@ MX OptiNode::x_lookup(casadi_int i) const {
 }
 
 MX OptiNode::g_lookup(casadi_int i) const {
-  if (problem_dirty()) return baked_copy().g_lookup(i);
+  bake_if_dirty();
   casadi_assert_dev(i>=0);
   casadi_assert_dev(i<ng());
   for (const auto& e : g_) {
@@ -233,7 +233,8 @@ MX OptiNode::g_lookup(casadi_int i) const {
   return MX();
 }
 
-OptiNode::OptiNode() : count_(0), count_var_(0), count_par_(0), count_dual_(0) {
+OptiNode::OptiNode() : count_(0), count_var_(0), count_par_(0), count_dual_(0),
+    n_baked_(-1), nx_(0), np_(0), ng_(0), concat_dirty_(true) {
   f_ = 0;
   instance_number_ = instance_count_++;
   user_callback_ = nullptr;
@@ -562,33 +563,33 @@ void OptiNode::bake() {
     "You need to specify at least an objective (y calling 'minimize'), "
     "or a constraint (by calling 'subject_to').");
 
-  symbol_active_.clear();
-  symbol_active_.resize(symbols_.size());
-
-  // Gather all expressions
-  MX total_expr = vertcat(f_, veccat(g_));
-
-  // Categorize the symbols appearing in those expressions
-  for (const auto& d : symvar(total_expr))
-    symbol_active_[meta(d).count] = true;
-
-  std::vector<MX> x = active_symvar(OPTI_VAR);
-  casadi_int offset = 0;
-  for (const auto& v : x) {
-    meta(v).start = offset;
-    offset+= v.nnz();
-    meta(v).stop = offset;
+  // Symbols that become active require new offsets into x and p
+  bool new_symbols = false;
+  auto activate = [&](const MX& d) {
+    casadi_int c = meta(d).count;
+    if (symbol_active_[c]) return;
+    symbol_active_[c] = true;
+    new_symbols = true;
+  };
+
+  // Start over unless constraints were only appended since the last bake
+  if (n_baked_<0) {
+    symbol_active_.clear();
+    symbol_active_.resize(symbols_.size());
+    n_baked_ = 0;
+    g_all_.clear();
+    lbg_all_.clear();
+    ubg_all_.clear();
+    lam_all_.clear();
+    new_symbols = true;
+    for (const auto& d : symvar(f_)) activate(d);
   }
-  std::vector<MX> p = active_symvar(OPTI_PAR);
-
-  // Fill the nlp definition
-  nlp_["x"] = veccat(x);
-  nlp_["p"] = veccat(p);
+  symbol_active_.resize(symbols_.size(), false);
 
-  nlp_["f"] = f_;
-
-  offset = 0;
-  for (casadi_int i=0;i<g_.size();++i) {
+  // Categorize the symbols appearing in the new constraints
+  casadi_int offset = lbg_all_.empty() ? 0 : meta_con(g_[n_baked_-1]).stop;
+  for (casadi_int i=n_baked_;i<g_.size();++i) {
+    for (const auto& d : symvar(g_[i])) activate(d);
     MetaCon& r = meta_con(g_[i]);
     MetaVar& r2 = meta(r.dual_canon);
     symbol_active_[r2.count] = true;
@@ -602,33 +603,50 @@ void OptiNode::bake() {
     r2.start = r.start;
     r2.stop  = r.stop;
 
+    // Collect bounds and canonical form of constraints
+    g_all_.push_back(r.canon);
+    lbg_all_.push_back(r.lb);
+    ubg_all_.push_back(r.ub);
+    lam_all_.push_back(r.dual_canon);
   }
-
-  lam_ = veccat(active_symvar(OPTI_DUAL_G));
-
-  // Collect bounds and canonical form of constraints
-  std::vector<MX> g_all;
-  std::vector<MX> lbg_all;
-  std::vector<MX> ubg_all;
-  for (const auto& g : g_) {
-    g_all.push_back(meta_con(g).canon);
-    lbg_all.push_back(meta_con(g).lb);
-    ubg_all.push_back(meta_con(g).ub);
+  n_baked_ = g_.size();
+
+  ng_ = offset;
+  if (new_symbols) {
+    offset = 0;
+    for (const auto& v : active_symvar(OPTI_VAR)) {
+      meta(v).start = offset;
+      offset+= v.nnz();
+      meta(v).stop = offset;
+    }
+    nx_ = offset;
+    np_ = 0;
+    for (const auto& v : active_symvar(OPTI_PAR)) np_+= v.nnz();
   }
 
-  nlp_["g"] = veccat(g_all);
+  // Concatenation into the nlp definition is deferred until needed
+  concat_dirty_ = true;
 
-  // Create bounds helper function
-  MXDict bounds;
-  bounds["p"] = nlp_["p"];
-  bounds_lbg_ = veccat(lbg_all);
-  bounds_ubg_ = veccat(ubg_all);
+  // The bounds helper function is created when solving
+  bounds_ = Function();
+  mark_problem_dirty(false);
+}
 
-  bounds["lbg"] = bounds_lbg_;
-  bounds["ubg"] = bounds_ubg_;
+void OptiNode::concat() {
+  nlp_["x"] = veccat(active_symvar(OPTI_VAR));
+  nlp_["p"] = veccat(active_symvar(OPTI_PAR));
+  nlp_["f"] = f_;
+  nlp_["g"] = veccat(g_all_);
+  lam_ = veccat(lam_all_);
+  bounds_lbg_ = veccat(lbg_all_);
+  bounds_ubg_ = veccat(ubg_all_);
+  concat_dirty_ = false;
+}
 
-  bounds_ = Function("bounds", bounds, {"p"}, {"lbg", "ubg"});
-  mark_problem_dirty(false);
+const MXDict& OptiNode::nlp() const {
+  bake_if_dirty();
+  if (concat_dirty_) const_cast<OptiNode*>(this)->concat();
+  return nlp_;
 }
 
 void OptiNode::solver(const std::string& solver_name, const Dict& plugin_options,
@@ -842,7 +860,7 @@ void OptiNode::minimize(const MX& f) {
 
 void OptiNode::subject_to(const MX& g) {
   assert_only_opti_nondual(g);
-  mark_problem_dirty();
+  mark_problem_extended();
   g_.push_back(g);
 
   casadi_assert(!g.is_empty(),    "You passed an empty expression to `subject_to`. "
@@ -876,7 +894,22 @@ std::vector<MX> OptiNode::symvar(const MX& expr, VariableType type) const {
   return ret;
 }
 
-void OptiNode::res(const DMDict& res) {
+// Map the nonzeros of v from the ordering perm back to the natural ordering
+DM unpermute(const DM& v, const std::vector<casadi_int>& perm) {
+  if (perm.empty() || v.nnz()!=perm.size()) return v;
+  DM ret = v;
+  for (casadi_int i=0;i<perm.size();++i) ret.nonzeros()[perm[i]] = v.nonzeros()[i];
+  return ret;
+}
+
+void OptiNode::res(const DMDict& solver_res) {
+  // Results in natural ordering
+  DMDict res = solver_res;
+  for (auto&& e : res) {
+    if (e.first=="x" || e.first=="lam_x") e.second = unpermute(e.second, x_perm_);
+    if (e.first=="g" || e.first=="lam_g") e.second = unpermute(e.second, g_perm_);
+  }
+
   const std::vector<double> & x_v = res.at("x").nonzeros();
   for (const auto &v : active_symvar(OPTI_VAR)) {
     casadi_int i = meta(v).i;
@@ -906,30 +939,12 @@ OptiSol OptiNode::solve() {
   if (problem_dirty()) {
     bake();
   }
-  // Verify the constraint types
-  for (const auto& g : g_) {
-    if (meta_con(g).type==OPTI_PSD)
-      casadi_error("Psd constraints not implemented yet. "
-      "Perhaps you intended an element-wise inequality? "
-      "In that case, make sure that the matrix is flattened (e.g. mat(:)).");
-  }
+  assert_constraint_types();
 
   bool solver_update =  solver_dirty() || old_callback() || (user_callback_ && callback_.is_null());
 
   if (solver_update) {
-    Dict opts = solver_options_;
-
-    // Handle callbacks
-    if (user_callback_) {
-      callback_ = Function::create(new InternalOptiCallback(*this), Dict());
-      opts["iteration_callback"] = callback_;
-    }
-
-    casadi_assert(solver_name_!="",
-      "You must call 'solver' on the Opti stack to select a solver. "
-      "Suggestion: opti.solver('ipopt')");
-
-    solver_ = nlpsol("solver", solver_name_, nlp_, opts);
+    solver_ = solver_construct(true);
     mark_solver_dirty(false);
   }
 
@@ -945,15 +960,101 @@ OptiSol OptiNode::solve() {
   return Opti(this);
 }
 
-// Solve the problem
-void OptiNode::solve_prepare() {
+Function OptiNode::solver_construct(bool callback) {
+  Dict opts = solver_options_;
+
+  // Opti-level options
+  std::string structure_detection = "none";
+  auto it = opts.find("structure_detection");
+  if (it!=opts.end()) {
+    structure_detection = it->second.to_string();
+    opts.erase(it);
+  }
+  casadi_assert(structure_detection=="none" || structure_detection=="auto",
+    "'structure_detection' must be 'none' or 'auto', got '" + structure_detection + "'.");
+
+  // Pose the problem in stage-wise ordering
+  MXDict nlp = this->nlp();
+  x_perm_.clear();
+  g_perm_.clear();
+  if (structure_detection=="auto") {
+    stage_ordering(x_perm_, g_perm_);
+    MX z = MX::sym("x", nx_);
+    Function fg("fg", {nlp["x"], nlp["p"]}, {nlp["f"], nlp["g"]});
+    std::vector<MX> r = fg(std::vector<MX>{z(lookupvector(x_perm_, nx_)), nlp["p"]});
+    nlp["x"] = z;
+    nlp["f"] = r[0];
+    nlp["g"] = g_perm_.empty() ? r[1] : r[1](g_perm_);
+  }
+
+  // Handle callbacks
+  if (callback && user_callback_) {
+    callback_ = Function::create(new InternalOptiCallback(*this), Dict());
+    opts["iteration_callback"] = callback_;
+  }
 
+  casadi_assert(solver_name_!="",
+    "You must call 'solver' on the Opti stack to select a solver. "
+    "Suggestion: opti.solver('ipopt')");
 
-  // Verify the constraint types
+  return nlpsol("solver", solver_name_, nlp, opts);
+}
+
+void OptiNode::stage_ordering(std::vector<casadi_int>& x_perm,
+    std::vector<casadi_int>& g_perm) const {
+  // Stage of each scalarised decision variable
+  std::vector<casadi_int> x_stage(nx_, 0);
+  for (const auto& v : active_symvar(OPTI_VAR)) {
+    const casadi_int* colind = v.sparsity().colind();
+    for (casadi_int c=0;c<v.size2();++c) {
+      for (casadi_int k=colind[c];k<colind[c+1];++k) x_stage[meta(v).start+k] = c;
+    }
+  }
+  x_perm = range(nx_);
+  std::stable_sort(x_perm.begin(), x_perm.end(),
+    [&](casadi_int a, casadi_int b) { return x_stage[a]<x_stage[b]; });
+
+  // Stage of each scalarised constraint, from the Jacobian sparsity
+  Sparsity J = Function("g", {nlp_.at("x"), nlp_.at("p")}, {nlp_.at("g")}).sparsity_jac(0, 0);
+  J = J.T();
+  std::vector<casadi_int> g_key(ng_, 0);
+  for (casadi_int i=0;i<ng_;++i) {
+    casadi_int smin = -1, smax = -1;
+    for (casadi_int k=J.colind()[i];k<J.colind()[i+1];++k) {
+      casadi_int s = x_stage[J.row()[k]];
+      if (smin<0 || s<smin) smin = s;
+      if (s>smax) smax = s;
+    }
+    if (smax<0) smax = 0;
+    g_key[i] = smin>=0 && smin<smax ? 2*(smax-1) : 2*smax+1;
+  }
+  g_perm = range(ng_);
+  std::stable_sort(g_perm.begin(), g_perm.end(),
+    [&](casadi_int a, casadi_int b) { return g_key[a]<g_key[b]; });
+}
+
+void OptiNode::assert_constraint_types() const {
   for (const auto& g : g_) {
+    if (meta_con(g).type==OPTI_PSD)
+      casadi_error("Psd constraints not implemented yet. "
+      "Perhaps you intended an element-wise inequality? "
+      "In that case, make sure that the matrix is flattened (e.g. mat(:)).");
     if (meta_con(g).type==OPTI_UNKNOWN)
      casadi_error("Constraint type unknown. Use ==, >= or <= .");
   }
+}
+
+void OptiNode::bounds_construct() {
+  if (!bounds_.is_null()) return;
+  MXDict bounds;
+  bounds["p"] = nlp().at("p");
+  bounds["lbg"] = bounds_lbg_;
+  bounds["ubg"] = bounds_ubg_;
+  bounds_ = Function("bounds", bounds, {"p"}, {"lbg", "ubg"});
+}
+
+// Solve the problem
+void OptiNode::solve_prepare() {
 
   if (user_callback_) {
     InternalOptiCallback* cb = static_cast<InternalOptiCallback*>(callback_.get());
@@ -975,12 +1076,96 @@ void OptiNode::solve_prepare() {
   }
 
   // Evaluate bounds for given parameter values
+  bounds_construct();
   DMDict arg;
   arg["p"] = arg_["p"];
   DMDict res = bounds_(arg);
   arg_["lbg"] = res["lbg"];
   arg_["ubg"] = res["ubg"];
 
+  // Solver ordering
+  if (!x_perm_.empty()) {
+    arg_["x0"] = arg_["x0"](x_perm_);
+  }
+  if (!g_perm_.empty()) {
+    for (const char* n : {"lbg", "ubg", "lam_g0"}) arg_[n] = arg_[n](g_perm_);
+  }
+}
+
+Function OptiNode::to_function(const std::string& name,
+    const std::vector<MX>& args, const std::vector<MX>& res,
+    const std::vector<std::string>& name_in,
+    const std::vector<std::string>& name_out,
+    const Dict& opts) {
+  if (problem_dirty()) bake();
+  assert_constraint_types();
+
+  // Inputs must be symbols of this Opti instance
+  std::set<MXNode*> inputs;
+  for (const auto& a : args) {
+    casadi_assert(a.is_symbolic(),
+      "to_function: inputs must be variables, parameters or dual variables "
+      "of this Opti instance, got '" + str(a) + "'.");
+    assert_active_symbol(a);
+    inputs.insert(a.get());
+  }
+
+  // Symbols that are not inputs are frozen at their current values
+  std::vector<MX> nlp_in[3];
+  VariableType types[] = {OPTI_VAR, OPTI_PAR, OPTI_DUAL_G};
+  for (casadi_int k=0;k<3;++k) {
+    std::vector<MX> s = active_symvar(types[k]);
+    std::vector<DM> v = active_values(types[k]);
+    for (casadi_int i=0;i<s.size();++i) {
+      if (inputs.count(s[i].get())) {
+        nlp_in[k].push_back(s[i]);
+      } else {
+        casadi_assert(types[k]!=OPTI_PAR || v[i].is_regular(),
+          "You have forgotten to assign a value to a parameter ('set_value'), "
+          "or have set it to NaN/Inf:\n" + describe(s[i], 1));
+        nlp_in[k].push_back(v[i]);
+      }
+    }
+  }
+
+  // Reuse the solver of 'solve' unless it reports to a user callback
+  Function solver;
+  if (user_callback_) {
+    solver = solver_construct(false);
+  } else {
+    if (solver_dirty() || !callback_.is_null()) {
+      callback_ = Function();
+      solver_ = solver_construct(false);
+      mark_solver_dirty(false);
+    }
+    solver = solver_;
+  }
+
+  // Embed the solver call in a symbolic expression graph
+  MXDict arg;
+  arg["x0"] = veccat(nlp_in[0]);
+  arg["p"] = veccat(nlp_in[1]);
+  arg["lam_g0"] = veccat(nlp_in[2]);
+  bounds_construct();
+  std::vector<MX> lbg_ubg = bounds_(std::vector<MX>{arg["p"]});
+  arg["lbg"] = lbg_ubg[0];
+  arg["ubg"] = lbg_ubg[1];
+  if (!x_perm_.empty()) {
+    arg["x0"] = arg["x0"](x_perm_);
+  }
+  if (!g_perm_.empty()) {
+    for (const char* n : {"lbg", "ubg", "lam_g0"}) arg[n] = arg[n](g_perm_);
+  }
+  MXDict sol = solver(arg);
+  if (!x_perm_.empty()) sol["x"] = sol["x"](lookupvector(x_perm_, nx_));
+  if (!g_perm_.empty()) sol["lam_g"] = sol["lam_g"](lookupvector(g_perm_, ng_));
+
+  // Express the requested outputs in terms of the solution
+  Function helper("helper", {nlp().at("x"), nlp().at("p"), lam_}, res);
+  std::vector<MX> ret = helper(std::vector<MX>{sol["x"], arg["p"], sol["lam_g"]});
+
+  if (name_in.empty() && name_out.empty()) return Function(name, args, ret, opts);
+  return Function(name, args, ret, name_in, name_out, opts);
 }
 
 DMDict OptiNode::solve_actual(const DMDict& arg) {
@@ -99,6 +99,13 @@ public:
   /// Crunch the numbers; solve the problem
   OptiSol solve();
 
+  /// Create a CasADi Function from the Opti solver
+  Function to_function(const std::string& name,
+      const std::vector<MX>& args, const std::vector<MX>& res,
+      const std::vector<std::string>& name_in,
+      const std::vector<std::string>& name_out,
+      const Dict& opts);
+
   /// @{
   /// Obtain value of expression at the current value
   DM value(const MX& x, const std::vector<MX>& values=std::vector<MX>()) const;
@@ -180,6 +187,21 @@ public:
   void solve_prepare();
   DMDict solve_actual(const DMDict& args);
 
+  /// Construct an nlpsol instance for the baked problem
+  Function solver_construct(bool callback);
+
+  /// Verify that all constraints have a supported type
+  void assert_constraint_types() const;
+
+  /// Create the bounds helper function if needed
+  void bounds_construct();
+
+  /** \brief Stage-wise ordering of the scalarised variables and constraints
+      Matrix-valued variables contribute their k-th column to stage k, other variables
+      keep their declaration order. Constraints follow the stages of the variables they
+      depend on, constraints coupling stage k and k+1 preceding the other stage k ones. */
+  void stage_ordering(std::vector<casadi_int>& x_perm, std::vector<casadi_int>& g_perm) const;
+
   DMDict arg() const { return arg_; }
   void res(const DMDict& res);
   DMDict res() const { return res_; }
@@ -192,63 +214,68 @@ public:
     return s;
   }
 
+  /** \brief Bake in place if needed
+      Baking only updates cached data derived from the problem, so const accessors may bake */
+  void bake_if_dirty() const {
+    if (problem_dirty()) const_cast<OptiNode*>(this)->bake();
+  }
+
+  /// Baked nlp definition, concatenated on demand
+  const MXDict& nlp() const;
+
   std::string class_name() const override { return "OptiNode"; }
 
   /// Number of (scalarised) decision variables
   casadi_int nx() const {
-    if (problem_dirty()) return baked_copy().nx();
-    return nlp_.at("x").size1();
+    bake_if_dirty();
+    return nx_;
   }
 
   /// Number of (scalarised) parameters
   casadi_int np() const {
-    if (problem_dirty()) return baked_copy().np();
-    return nlp_.at("p").size1();
+    bake_if_dirty();
+    return np_;
   }
 
   /// Number of (scalarised) constraints
   casadi_int ng() const {
-    if (problem_dirty()) return baked_copy().ng();
-    return nlp_.at("g").size1();
+    bake_if_dirty();
+    return ng_;
   }
 
   /// Get all (scalarised) decision variables as a symbolic column vector
   MX x() const {
-    if (problem_dirty()) return baked_copy().x();
-    return nlp_.at("x");
+    return nlp().at("x");
   }
 
   /// Get all (scalarised) parameters as a symbolic column vector
   MX p() const {
-    if (problem_dirty()) return baked_copy().p();
-    return nlp_.at("p");
+    return nlp().at("p");
   }
 
   /// Get all (scalarised) constraint expressions as a column vector
   MX g() const {
-    if (problem_dirty()) return baked_copy().g();
-    return nlp_.at("g");
+    return nlp().at("g");
   }
 
   /// Get objective expression
   MX f() const {
-    if (problem_dirty()) return baked_copy().f();
-    return nlp_.at("f");
+    return nlp().at("f");
   }
 
   MX lbg() const {
-    if (problem_dirty()) return baked_copy().lbg();
+    nlp();
     return bounds_lbg_;
   }
 
   MX ubg() const {
-    if (problem_dirty()) return baked_copy().ubg();
+    nlp();
     return bounds_ubg_;
   }
 
   /// Get dual variables as a symbolic column vector
   MX lam_g() const {
-    if (problem_dirty()) return baked_copy().lam_g();
+    nlp();
     return lam_;
   }
   void assert_empty() const;
@@ -259,12 +286,21 @@ public:
   /// Fix the structure of the optimization problem
   void bake();
 
+  /// Concatenate the baked symbols and constraints into nlp_
+  void concat();
+
   casadi_int instance_number() const;
 
   static OptiNode* create();
 
   bool problem_dirty_;
-  void mark_problem_dirty(bool flag=true) { problem_dirty_=flag; mark_solver_dirty(); }
+  void mark_problem_dirty(bool flag=true) {
+    problem_dirty_=flag;
+    if (flag) n_baked_ = -1;
+    mark_solver_dirty();
+  }
+  /// Constraints were appended: the next bake only processes the new constraints
+  void mark_problem_extended() { problem_dirty_=true; mark_solver_dirty(); }
   bool problem_dirty() const { return problem_dirty_; }
 
   bool solver_dirty_;
@@ -353,11 +389,25 @@ private:
   MXDict nlp_;
   MX lam_;
 
-  /// Bounds helper function: p -> lbg, ubg
+  /// Bounds helper function: p -> lbg, ubg, created when solving
   Function bounds_;
   MX bounds_lbg_;
   MX bounds_ubg_;
 
+  /** \brief Incremental baking: number of entries of g_ that are baked, -1 for none
+      The canonical constraints, bounds and duals of the baked entries are kept */
+  casadi_int n_baked_;
+  std::vector<MX> g_all_, lbg_all_, ubg_all_, lam_all_;
+
+  /// Ordering of x and g as seen by the solver, empty for the natural ordering
+  std::vector<casadi_int> x_perm_, g_perm_;
+
+  /// Sizes of the baked problem, known before concatenation
+  casadi_int nx_, np_, ng_;
+
+  /// Do nlp_, lam_ and the bounds need to be concatenated anew?
+  bool concat_dirty_;
+
   /// Constraints verbatim as passed in with 'subject_to'
   std::vector<MX> g_;
 
@@ -25,9 +25,15 @@
 
 #include "oracle_function.hpp"
 #include "external.hpp"
+#include "thread_pool.hpp"
+#include "binary_serializer.hpp"
+#include "sx_function.hpp"
+#include "binary_sx.hpp"
 
 #include <iostream>
 #include <iomanip>
+#include <fstream>
+#include <cstdio>
 
 using namespace std;
 
@@ -35,6 +41,13 @@ namespace casadi {
 
   OracleFunction::OracleFunction(const std::string& name, const Function& oracle)
   : FunctionInternal(name), oracle_(oracle) {
+    max_num_threads_ = 1;
+    oracle_cache_ = false;
+    latency_stats_ = false;
+    trace_size_ = 0;
+    max_wall_time_ = inf;
+    snapshot_read_ = false;
+    snapshot_stale_ = false;
   }
 
   OracleFunction::~OracleFunction() {
@@ -51,7 +64,41 @@ namespace casadi {
       {"specific_options",
        {OT_DICT,
         "Options for specific auto-generated functions,"
-        " overwriting the defaults from common_options. Nested dictionary."}}
+        " overwriting the defaults from common_options. Nested dictionary."}},
+      {"max_num_threads",
+       {OT_INT,
+        "Evaluate independent functions requested at the same time, "
+        "e.g. the constraint Jacobian and the Hessian of the Lagrangian, "
+        "concurrently using at most this many threads [1]"}},
+      {"oracle_cache",
+       {OT_BOOL,
+        "Serve calls at repeated inputs, e.g. the objective gradient and the "
+        "constraint Jacobian at the same x and p, from a single fused evaluation. "
+        "Only effective for solvers that register fused functions, such as Ipopt"}},
+      {"latency_stats",
+       {OT_BOOL,
+        "Keep histograms of the wall time of each call of the user problem functions "
+        "and, for solvers, of each solve. The statistics report the percentiles and "
+        "the maximum as latency_<name>, accumulated over all calls with the same "
+        "memory object [false]"}},
+      {"trace_size",
+       {OT_INT,
+        "Keep the data of this many of the last iterations, across solves, in a "
+        "preallocated buffer, available as 'trace' in the statistics [0]"}},
+      {"trace_file",
+       {OT_STRING,
+        "Write the iteration trace to this file, in a binary format, when a solve fails"}},
+      {"max_wall_time",
+       {OT_DOUBLE,
+        "Wall-clock time limit of a call in seconds. Solvers that support it poll it, "
+        "together with Function::cancel, in their iteration loops and return their "
+        "current iterate when it has passed: sqpmethod, scpgen, ipopt, newton and the "
+        "fixed step integrators, which raise an error instead [inf]"}},
+      {"snapshot",
+       {OT_STRING,
+        "Binary file with the auto-generated functions. If it was written for the same "
+        "oracle and options, the functions are read from it instead of being generated; "
+        "otherwise it is (re)written at the end of the initialization"}}
     }
   };
 
@@ -71,6 +118,23 @@ namespace casadi {
             " Type mismatch for entry '" + i.first+ "': "
             " got type " + i.second.get_description() + ".");
         }
+      } else if (op.first=="max_num_threads") {
+        max_num_threads_ = op.second;
+        casadi_assert(max_num_threads_>=1, "Option 'max_num_threads' must be positive");
+      } else if (op.first=="oracle_cache") {
+        oracle_cache_ = op.second;
+      } else if (op.first=="latency_stats") {
+        latency_stats_ = op.second;
+      } else if (op.first=="trace_size") {
+        trace_size_ = op.second;
+        casadi_assert(trace_size_>=0, "Option 'trace_size' must be nonnegative");
+      } else if (op.first=="trace_file") {
+        trace_file_ = op.second.to_string();
+      } else if (op.first=="max_wall_time") {
+        max_wall_time_ = op.second;
+        casadi_assert(max_wall_time_>0, "Option 'max_wall_time' must be positive");
+      } else if (op.first=="snapshot") {
+        snapshot_ = op.second.to_string();
       }
     }
   }
@@ -98,6 +162,39 @@ namespace casadi {
       }
     }
 
+    if (trace_size_>0 && trace_columns().empty()) {
+      casadi_warning("Option 'trace_size' ignored: No iteration trace for " + class_name());
+    }
+
+    // Fused functions serving the outputs of each function
+    fused_out_.clear();
+    if (oracle_cache_) {
+      for (auto&& e : all_functions_) {
+        const Function& f = e.second.f;
+        for (casadi_int i=0; i<fused_.size(); ++i) {
+          const Function& F = get_function(fused_[i]);
+          // Same inputs
+          bool ok = F.name_in()==f.name_in();
+          for (casadi_int j=0; ok && j<f.n_in(); ++j) {
+            ok = F.sparsity_in(j)==f.sparsity_in(j);
+          }
+          // All outputs, with the same sparsity
+          FusedOut fo;
+          fo.ind = i;
+          std::vector<std::string> F_out = F.name_out();
+          for (casadi_int j=0; ok && j<f.n_out(); ++j) {
+            auto k = find(F_out.begin(), F_out.end(), f.name_out(j));
+            ok = k!=F_out.end();
+            if (ok) {
+              fo.out.push_back(k-F_out.begin());
+              ok = F.sparsity_out(fo.out.back())==f.sparsity_out(j);
+            }
+          }
+          if (ok) fused_out_[e.first].push_back(fo);
+        }
+      }
+    }
+
     // Check specific options
     for (auto&& i : specific_options_) {
       if (all_functions_.find(i.first)==all_functions_.end())
@@ -105,6 +202,9 @@ namespace casadi {
                        " Available functions: " + join(get_function()) + ".");
     }
 
+    // Save the generated functions for the next initialization
+    if (!snapshot_.empty() && snapshot_stale_) write_snapshot();
+
     // Recursive call
     FunctionInternal::finalize(opts);
   }
@@ -118,20 +218,36 @@ namespace casadi {
       casadi_message(name_ + "::create_function " + fname + ":" + str(s_in) + "->" + str(s_out));
     }
 
-    // Retrieve specific set of options if available
-    Dict specific_options;
-    auto it = specific_options_.find(fname);
-    if (it!=specific_options_.end()) specific_options = it->second;
+    // Signature, for matching against the snapshot
+    string sig = str(s_in) + "->" + str(s_out) + str(aux);
+    created_[fname] = sig;
+
+    // Read from the snapshot, if available
+    Function ret;
+    if (!snapshot_.empty()) {
+      if (!snapshot_read_) read_snapshot();
+      auto it = snapshot_functions_.find(fname);
+      if (it!=snapshot_functions_.end() && it->second.first==sig) {
+        ret = it->second.second;
+      } else {
+        snapshot_stale_ = true;
+      }
+    }
 
-    // Combine specific and common options
-    Dict opt = combine(specific_options, common_options_);
+    if (ret.is_null()) {
+      // Combine specific set of options, if available, and common options
+      auto it = specific_options_.find(fname);
+      Dict opt = it==specific_options_.end() ? common_options_
+        : combine(it->second, common_options_);
 
-    // Generate the function
-    Function ret = oracle_.factory(fname, s_in, s_out, aux, opt);
+      // Generate the function
+      ret = oracle_.factory(fname, s_in, s_out, aux, opt);
 
-    // Make sure that it's sound
-    if (ret.has_free()) {
-      casadi_error("Cannot create '" + fname + "' since " + str(ret.get_free()) + " are free.");
+      // Make sure that it's sound
+      if (ret.has_free()) {
+        casadi_error("Cannot create '" + fname + "' since " + str(ret.get_free())
+                     + " are free.");
+      }
     }
 
     // Save and return
@@ -139,6 +255,69 @@ namespace casadi {
     return ret;
   }
 
+  casadi_int OracleFunction::snapshot_key() const {
+    BinarySerializer s;
+    s.pack(oracle_);
+    s.pack(class_name());
+    s.pack(str(common_options_));
+    s.pack(str(specific_options_));
+    return static_cast<casadi_int>(std::hash<std::string>()(s.data()));
+  }
+
+  void OracleFunction::read_snapshot() {
+    snapshot_read_ = true;
+    // Nothing to read yet
+    if (!std::ifstream(snapshot_).good()) return;
+    try {
+      casadi_int key = snapshot_key();
+      BinaryDeserializer s(std::make_shared<const BinaryBuffer>(snapshot_));
+      if (s.unpack_int()!=key) {
+        if (verbose_) casadi_message("Snapshot " + snapshot_ + " is outdated");
+        return;
+      }
+      casadi_int n = s.unpack_int();
+      for (casadi_int i=0; i<n; ++i) {
+        string fname = s.unpack_string();
+        string sig = s.unpack_string();
+        snapshot_functions_[fname] = make_pair(sig, s.unpack_function());
+      }
+      if (verbose_) {
+        casadi_message("Read " + str(n) + " functions from snapshot " + snapshot_);
+      }
+    } catch (exception& e) {
+      snapshot_functions_.clear();
+      casadi_warning("Ignoring snapshot " + snapshot_ + ": " + string(e.what()));
+    }
+  }
+
+  void OracleFunction::write_snapshot() const {
+    try {
+      BinarySerializer s;
+      s.pack(snapshot_key());
+      s.pack(static_cast<casadi_int>(created_.size()));
+      for (auto&& e : created_) {
+        s.pack(e.first);
+        s.pack(e.second);
+        s.pack(get_function(e.first));
+      }
+      // Write to a temporary file and rename, so that readers never see a partial file
+      string tmp = snapshot_ + ".tmp";
+      {
+        std::ofstream out(tmp, std::ios::binary);
+        casadi_assert(out.good(), "Cannot open " + tmp);
+        out.write(s.data().data(), s.data().size());
+        casadi_assert(out.good(), "Failed to write " + tmp);
+      }
+      casadi_assert(std::rename(tmp.c_str(), snapshot_.c_str())==0,
+                    "Cannot rename " + tmp + " to " + snapshot_);
+      if (verbose_) {
+        casadi_message("Wrote " + str(created_.size()) + " functions to snapshot " + snapshot_);
+      }
+    } catch (exception& e) {
+      casadi_warning("Cannot write snapshot " + snapshot_ + ": " + string(e.what()));
+    }
+  }
+
   void OracleFunction::
   set_function(const Function& fcn, const std::string& fname, bool jit) {
     casadi_assert(!has_function(fname), "Duplicate function " + fname);
@@ -151,15 +330,148 @@ namespace casadi {
   casadi_int OracleFunction::
   calc_function(OracleMemory* m, const std::string& fcn,
                 const double* const* arg) const {
+    // Input buffers
+    if (arg) {
+      casadi_int n_in = get_function(fcn).n_in();
+      fill_n(m->arg, n_in, nullptr);
+      for (casadi_int i=0; i<n_in; ++i) m->arg[i] = *arg++;
+    }
+
+    // Respond to a possible Crl+C signals
+    InterruptHandler::check();
+
+    return calc_function(m, fcn, m->arg, m->res, m->iw, m->w);
+  }
+
+  casadi_int OracleFunction::
+  calc_functions(OracleMemory* m, const std::vector<OracleCall>& calls) const {
+    // Respond to a possible Crl+C signals
+    InterruptHandler::check();
+
+    // Evaluate concurrently, unless monitored
+    casadi_int n_threads = std::min(max_num_threads_, static_cast<casadi_int>(calls.size()));
+    for (casadi_int k=0; k<calls.size() && n_threads>1; ++k) {
+      // Monitored and cached calls are evaluated sequentially
+      if (monitored(calls[k].fcn) || fused_out_.count(calls[k].fcn)) n_threads = 1;
+      // Statistics are per function
+      for (casadi_int k2=0; k2<k; ++k2) {
+        casadi_assert(calls[k].fcn!=calls[k2].fcn, "Duplicate call to " + calls[k].fcn);
+      }
+    }
+
+    // Return flags
+    std::vector<casadi_int> flag(calls.size(), 0);
+    auto task = [&](casadi_int k, casadi_int t) {
+      const OracleCall& c = calls[k];
+      const Function& f = get_function(c.fcn);
+      // Work vectors of the thread
+      const double** arg = t==0 ? m->arg : get_ptr(m->thread_arg[t-1]);
+      double** res = t==0 ? m->res : get_ptr(m->thread_res[t-1]);
+      casadi_int* iw = t==0 ? m->iw : get_ptr(m->thread_iw[t-1]);
+      double* w = t==0 ? m->w : get_ptr(m->thread_w[t-1]);
+      // Input and output buffers
+      fill_n(arg, f.n_in(), nullptr);
+      copy(c.arg.begin(), c.arg.end(), arg);
+      fill_n(res, f.n_out(), nullptr);
+      copy(c.res.begin(), c.res.end(), res);
+      flag[k] = calc_function(m, c.fcn, arg, res, iw, w);
+    };
+    if (n_threads>1) {
+      ThreadPool::run(calls.size(), n_threads, task);
+    } else {
+      for (casadi_int k=0; k<calls.size(); ++k) {
+        task(k, 0);
+        if (flag[k]) break;
+      }
+    }
+
+    for (casadi_int fk : flag) if (fk) return fk;
+    return 0;
+  }
+
+  void OracleFunction::add_fused(const std::string& fname) {
+    casadi_assert(has_function(fname), "No function \"" + fname + "\"");
+    fused_.push_back(fname);
+  }
+
+  casadi_int OracleFunction::
+  calc_function(OracleMemory* m, const std::string& fcn,
+                const double** arg, double** res,
+                casadi_int* iw, double* w) const {
+    auto it = fused_out_.find(fcn);
+    if (it!=fused_out_.end()) return calc_cached(m, fcn, it->second, arg, res, iw, w);
+    return eval_function(m, fcn, arg, res, iw, w);
+  }
+
+  casadi_int OracleFunction::
+  calc_cached(OracleMemory* m, const std::string& fcn, const std::vector<FusedOut>& fo,
+              const double** arg, double** res, casadi_int* iw, double* w) const {
+    const Function& f = get_function(fcn);
+    casadi_int n_in = f.n_in(), n_out = f.n_out();
+
+    // Look for a cached evaluation at the same inputs
+    const FusedOut* hit = nullptr;
+    for (const FusedOut& e : fo) {
+      const OracleMemory::Cache& c = m->cache[e.ind];
+      if (!c.valid) continue;
+      bool same = true;
+      for (casadi_int i=0; same && i<n_in; ++i) {
+        for (casadi_int k=0; same && k<c.arg[i].size(); ++k) {
+          same = c.arg[i][k]==(arg[i] ? arg[i][k] : 0);
+        }
+      }
+      if (same) {
+        hit = &e;
+        break;
+      }
+    }
+
+    if (hit) {
+      if (monitored(fcn)) {
+        casadi_message("Serving \"" + fcn + "\" from \"" + fused_[hit->ind] + "\"");
+      }
+    } else {
+      // Evaluate the cheapest fused function, saving the buffers of the call
+      hit = &fo.front();
+      const Function& F = get_function(fused_[hit->ind]);
+      OracleMemory::Cache& c = m->cache[hit->ind];
+      std::vector<const double*> arg0(arg, arg+n_in);
+      std::vector<double*> res0(res, res+n_out);
+      for (casadi_int i=0; i<n_in; ++i) {
+        if (arg[i]) {
+          copy_n(arg[i], c.arg[i].size(), c.arg[i].begin());
+        } else {
+          fill(c.arg[i].begin(), c.arg[i].end(), 0);
+        }
+        arg[i] = get_ptr(c.arg[i]);
+      }
+      for (casadi_int i=0; i<F.n_out(); ++i) res[i] = get_ptr(c.res[i]);
+      c.valid = false;
+      casadi_int flag = eval_function(m, fused_[hit->ind], arg, res, iw, w);
+      copy(arg0.begin(), arg0.end(), arg);
+      copy(res0.begin(), res0.end(), res);
+      if (flag) return flag;
+      c.valid = true;
+    }
+
+    // Copy the requested outputs
+    const OracleMemory::Cache& c = m->cache[hit->ind];
+    for (casadi_int i=0; i<n_out; ++i) {
+      if (res[i]) copy(c.res[hit->out[i]].begin(), c.res[hit->out[i]].end(), res[i]);
+    }
+    return 0;
+  }
+
+  casadi_int OracleFunction::
+  eval_function(OracleMemory* m, const std::string& fcn,
+                const double** arg, double** res,
+                casadi_int* iw, double* w) const {
     // Is the function monitored?
     bool monitored = this->monitored(fcn);
 
     // Print progress
     if (monitored) casadi_message("Calling \"" + fcn + "\"");
 
-    // Respond to a possible Crl+C signals
-    InterruptHandler::check();
-
     // Get function
     const Function& f = get_function(fcn);
 
@@ -172,24 +484,18 @@ namespace casadi {
     // Prepare stats, start timer
     fstats.tic();
 
-    // Input buffers
-    if (arg) {
-      fill_n(m->arg, n_in, nullptr);
-      for (casadi_int i=0; i<n_in; ++i) m->arg[i] = *arg++;
-    }
-
     // Print inputs nonzeros
     if (monitored) {
       std::stringstream s;
       s << fcn << " input nonzeros:\n";
       for (casadi_int i=0; i<n_in; ++i) {
         s << " " << i << " (" << f.name_in(i) << "): ";
-        if (m->arg[i]) {
+        if (arg[i]) {
           // Print nonzeros
           s << "[";
           for (casadi_int k=0; k<f.nnz_in(i); ++k) {
             if (k!=0) s << ", ";
-            DM::print_scalar(s, m->arg[i][k]);
+            DM::print_scalar(s, arg[i][k]);
           }
           s << "]\n";
         } else {
@@ -202,7 +508,7 @@ namespace casadi {
 
     // Evaluate memory-less
     try {
-      f(m->arg, m->res, m->iw, m->w);
+      f(arg, res, iw, w);
     } catch(exception& ex) {
       // Fatal error
       casadi_warning(name_ + ":" + fcn + " failed:" + std::string(ex.what()));
@@ -215,12 +521,12 @@ namespace casadi {
       s << fcn << " output nonzeros:\n";
       for (casadi_int i=0; i<n_out; ++i) {
         s << " " << i << " (" << f.name_out(i) << "): ";
-        if (m->res[i]) {
+        if (res[i]) {
           // Print nonzeros
           s << "[";
           for (casadi_int k=0; k<f.nnz_out(i); ++k) {
             if (k!=0) s << ", ";
-            DM::print_scalar(s, m->res[i][k]);
+            DM::print_scalar(s, res[i][k]);
           }
           s << "]\n";
         } else {
@@ -233,13 +539,13 @@ namespace casadi {
 
     // Make sure not NaN or Inf
     for (casadi_int i=0; i<n_out; ++i) {
-      if (!m->res[i]) continue;
-      if (!all_of(m->res[i], m->res[i]+f.nnz_out(i), [](double v) { return isfinite(v);})) {
+      if (!res[i]) continue;
+      if (!all_of(res[i], res[i]+f.nnz_out(i), [](double v) { return isfinite(v);})) {
         std::stringstream ss;
 
-        auto it = find_if(m->res[i], m->res[i]+f.nnz_out(i), [](double v) { return !isfinite(v);});
-        casadi_int k = distance(m->res[i], it);
-        bool is_nan = isnan(m->res[i][k]);
+        auto it = find_if(res[i], res[i]+f.nnz_out(i), [](double v) { return !isfinite(v);});
+        casadi_int k = distance(res[i], it);
+        bool is_nan = isnan(res[i][k]);
         ss << name_ << ":" << fcn << " failed: " << (is_nan? "NaN" : "Inf") <<
         " detected for output " << f.name_out(i) << ", at " << f.sparsity_out(i).repr_el(k) << ".";
 
@@ -288,6 +594,20 @@ namespace casadi {
     oracle_ = oracle_.expand();
   }
 
+  void OracleFunction::expand_auto(casadi_int max_instructions) {
+    // Estimated number of instructions and memory of the expanded oracle
+    double n_instructions = oracle_->n_instructions_sx();
+    double memory = n_instructions * (sizeof(BinarySX) + sizeof(ScalarAtomic));
+    bool expanded = n_instructions <= max_instructions;
+    if (verbose_) {
+      casadi_message("Estimated " + str(n_instructions) + " SX instructions for the oracle, "
+                     + std::string(expanded ? "" : "not ") + "expanding");
+    }
+    if (expanded) expand();
+    expand_stats_ = {{"n_instructions", n_instructions}, {"memory", memory},
+                     {"max_instructions", max_instructions}, {"expanded", expanded}};
+  }
+
   void OracleFunction::print_fstats(const OracleMemory* m) const {
     // Length of the name being printed
     size_t name_len=0;
@@ -301,14 +621,24 @@ namespace casadi {
 
     // Print header
     print(namefmt, "");
-    print("%12s %12s %9s\n", "t_proc [s]", "t_wall [s]", "n_eval");
+    if (latency_stats_) {
+      print("%12s %12s %9s %12s %12s\n", "t_proc [s]", "t_wall [s]", "n_eval",
+            "p99 [s]", "max [s]");
+    } else {
+      print("%12s %12s %9s\n", "t_proc [s]", "t_wall [s]", "n_eval");
+    }
 
     // Print keys
     for (auto &&s : m->fstats) {
       const FStats& fs = m->fstats.at(s.first);
       if (fs.n_call!=0) {
         print(namefmt, s.first.c_str());
-        print("%12.3g %12.3g %9d\n", fs.t_proc, fs.t_wall, fs.n_call);
+        if (fs.has_histogram()) {
+          print("%12.3g %12.3g %9d %12.3g %12.3g\n", fs.t_proc, fs.t_wall, fs.n_call,
+                fs.percentile(0.99), fs.t_max);
+        } else {
+          print("%12.3g %12.3g %9d\n", fs.t_proc, fs.t_wall, fs.n_call);
+        }
       }
     }
   }
@@ -322,7 +652,10 @@ namespace casadi {
       stats["n_call_" +s.first] = s.second.n_call;
       stats["t_wall_" +s.first] = s.second.t_wall;
       stats["t_proc_" +s.first] = s.second.t_proc;
+      if (s.second.has_histogram()) stats["latency_" +s.first] = s.second.latency();
     }
+    if (m->trace.enabled()) stats["trace"] = m->trace.get();
+    if (!expand_stats_.empty()) stats["expand"] = expand_stats_;
     return stats;
   }
 
@@ -330,9 +663,48 @@ namespace casadi {
     if (!mem) return 1;
     auto m = static_cast<OracleMemory*>(mem);
 
+    // Iteration trace
+    if (trace_size_>0) m->trace.init(trace_size_, trace_columns(), trace_file_);
+
     // Create statistics
+    m->latency_stats = latency_stats_;
     for (auto&& e : all_functions_) {
       m->fstats[e.first] = FStats();
+      if (latency_stats_) m->fstats[e.first].enable_histogram();
+    }
+
+    // Cached evaluations
+    m->cache.resize(fused_.size());
+    for (casadi_int i=0; i<fused_.size(); ++i) {
+      const Function& F = get_function(fused_[i]);
+      OracleMemory::Cache& c = m->cache[i];
+      c.valid = false;
+      c.arg.resize(F.n_in());
+      for (casadi_int j=0; j<F.n_in(); ++j) c.arg[j].resize(F.nnz_in(j));
+      c.res.resize(F.n_out());
+      for (casadi_int j=0; j<F.n_out(); ++j) c.res[j].resize(F.nnz_out(j));
+    }
+
+    // Work vectors for concurrent evaluation
+    if (max_num_threads_>1) {
+      size_t sz_arg=0, sz_res=0, sz_iw=0, sz_w=0;
+      for (auto&& e : all_functions_) {
+        const Function& f = e.second.f;
+        sz_arg = max(sz_arg, f.sz_arg());
+        sz_res = max(sz_res, f.sz_res());
+        sz_iw = max(sz_iw, f.sz_iw());
+        sz_w = max(sz_w, f.sz_w());
+      }
+      m->thread_arg.resize(max_num_threads_-1);
+      m->thread_res.resize(max_num_threads_-1);
+      m->thread_iw.resize(max_num_threads_-1);
+      m->thread_w.resize(max_num_threads_-1);
+      for (casadi_int t=0; t<max_num_threads_-1; ++t) {
+        m->thread_arg[t].resize(sz_arg);
+        m->thread_res[t].resize(sz_res);
+        m->thread_iw[t].resize(sz_iw);
+        m->thread_w[t].resize(sz_w);
+      }
     }
     return 0;
   }
@@ -28,6 +28,8 @@
 
 #include "function_internal.hpp"
 #include "timing.hpp"
+#include "iteration_trace.hpp"
+#include "casadi_interrupt.hpp"
 
 /// \cond INTERNAL
 namespace casadi {
@@ -40,16 +42,49 @@ namespace casadi {
     casadi_int* iw;
     double* w;
 
+    // Work vectors for concurrent evaluation, one set per additional thread
+    std::vector<std::vector<const double*> > thread_arg;
+    std::vector<std::vector<double*> > thread_res;
+    std::vector<std::vector<casadi_int> > thread_iw;
+    std::vector<std::vector<double> > thread_w;
+
+    // Cached evaluations of the fused functions, cf. OracleFunction::add_fused
+    struct Cache {
+      bool valid;
+      std::vector<std::vector<double> > arg, res;
+    };
+    std::vector<Cache> cache;
+
     // Function specific statistics
     std::map<std::string, FStats> fstats;
 
+    // Keep latency histograms in the statistics, cf. OracleFunction::latency_stats_
+    bool latency_stats;
+
+    // Iterations of the last solves, cf. OracleFunction::trace_columns
+    IterationTrace trace;
+
+    // Time limit and cancellation of the current call, cf. OracleFunction::max_wall_time_
+    Deadline deadline;
+
     // Add a statistic
     void add_stat(const std::string& s) {
-      bool added = fstats.insert(std::make_pair(s, FStats())).second;
+      FStats fs;
+      if (latency_stats) fs.enable_histogram();
+      bool added = fstats.insert(std::make_pair(s, fs)).second;
       casadi_assert(added, "Duplicate stat: '" + s + "'");
     }
   };
 
+  /** \brief One call of an oracle function, cf. OracleFunction::calc_functions */
+  struct CASADI_EXPORT OracleCall {
+    // Name of the function
+    std::string fcn;
+    // Input and output buffers, missing entries are treated as null
+    std::vector<const double*> arg;
+    std::vector<double*> res;
+  };
+
   /** \brief Base class for functions that perform calculation with an oracle
       \author Joel Andersson
       \date 2016
@@ -72,6 +107,49 @@ namespace casadi {
 
     // All NLP functions
     std::map<std::string, RegFun> all_functions_;
+
+    // Maximum number of threads in calc_functions
+    casadi_int max_num_threads_;
+
+    // Serve calls at repeated inputs from cached evaluations of the fused functions
+    bool oracle_cache_;
+
+    // Keep histograms of the wall time per call in the statistics
+    bool latency_stats_;
+
+    // Number of iterations kept in the iteration trace, 0 if disabled
+    casadi_int trace_size_;
+
+    // File to dump the iteration trace to when a solve fails
+    std::string trace_file_;
+
+    // Wall-clock time limit of a call, polled in the iteration loops of the solvers
+    double max_wall_time_;
+
+    // Fused functions, cheapest first
+    std::vector<std::string> fused_;
+
+    // Fused functions with the same inputs as a function and all of its outputs
+    struct FusedOut {
+      casadi_int ind;
+      std::vector<casadi_int> out;
+    };
+    std::map<std::string, std::vector<FusedOut> > fused_out_;
+
+    // File with the functions generated by create_function, cf. option 'snapshot'
+    std::string snapshot_;
+
+    // Snapshot read, and whether functions had to be generated
+    bool snapshot_read_, snapshot_stale_;
+
+    // Functions read from the snapshot, with the signature they were created for
+    std::map<std::string, std::pair<std::string, Function> > snapshot_functions_;
+
+    // Signatures of the functions generated by create_function
+    std::map<std::string, std::string> created_;
+
+    // Size estimates and decision of expand_auto, for the statistics
+    Dict expand_stats_;
   public:
     /** \brief  Constructor */
     OracleFunction(const std::string& name, const Function& oracle);
@@ -97,6 +175,9 @@ namespace casadi {
     // Replace MX oracle with SX oracle?
     void expand();
 
+    // Replace MX oracle with SX oracle if the estimated size of the latter is small enough
+    void expand_auto(casadi_int max_instructions);
+
     /** Create an oracle function */
     Function
     create_function(const std::string& fname,
@@ -107,13 +188,48 @@ namespace casadi {
     /** Register the function for evaluation and statistics gathering */
     void set_function(const Function& fcn, const std::string& fname, bool jit=false);
 
+    /** \brief Key of a snapshot: the oracle, the class and the options for creating functions */
+    casadi_int snapshot_key() const;
+
+    /// Read the functions in the snapshot file, if it exists and the key matches
+    void read_snapshot();
+
+    /// Write the functions generated by create_function to the snapshot file
+    void write_snapshot() const;
+
     /** Register the function for evaluation and statistics gathering */
     void set_function(const Function& fcn) { set_function(fcn, fcn.name()); }
 
+    /** \brief Register a fused function for the evaluation cache
+        With the option 'oracle_cache', calls to functions with the same inputs and
+        a subset of the outputs are served from its last evaluation if the inputs
+        are unchanged. Register the cheapest fused functions first. */
+    void add_fused(const std::string& fname);
+
     // Calculate an oracle function
     casadi_int calc_function(OracleMemory* m, const std::string& fcn,
                       const double* const* arg=nullptr) const;
 
+    // Calculate an oracle function with given work vectors
+    casadi_int calc_function(OracleMemory* m, const std::string& fcn,
+                             const double** arg, double** res,
+                             casadi_int* iw, double* w) const;
+
+    // Evaluate an oracle function, bypassing the cache
+    casadi_int eval_function(OracleMemory* m, const std::string& fcn,
+                             const double** arg, double** res,
+                             casadi_int* iw, double* w) const;
+
+    // Serve a call from the cached evaluations of the fused functions
+    casadi_int calc_cached(OracleMemory* m, const std::string& fcn,
+                           const std::vector<FusedOut>& fo,
+                           const double** arg, double** res,
+                           casadi_int* iw, double* w) const;
+
+    /** \brief Calculate independent oracle functions, concurrently if max_num_threads>1
+        Returns the first nonzero return flag of calc_function, if any */
+    casadi_int calc_functions(OracleMemory* m, const std::vector<OracleCall>& calls) const;
+
     // Get list of dependency functions
     std::vector<std::string> get_function() const override;
 
@@ -150,6 +266,9 @@ namespace casadi {
 
     /// Get all statistics
     Dict get_stats(void* mem) const override;
+
+    /** \brief Solver specific columns of the iteration trace, none if not supported */
+    virtual std::vector<std::string> trace_columns() const { return {};}
   };
 
 } // namespace casadi
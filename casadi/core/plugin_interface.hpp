@@ -107,12 +107,14 @@ namespace casadi {
     /// Instantiate a Plugin struct from a factory function
     static Plugin pluginFromRegFcn(RegFcn regfcn);
 
-    /// Load a plugin dynamically
-    static Plugin load_plugin(const std::string& pname, bool register_plugin=true);
+    /** \brief Load a plugin dynamically
+        A pinned plugin has all symbols resolved when loaded and is never unloaded */
+    static Plugin load_plugin(const std::string& pname, bool register_plugin=true,
+      bool pin=false);
 
     /// Load a library dynamically
     static DL_HANDLE_TYPE load_library(const std::string& libname, std::string& resultpath,
-      bool global);
+      bool global, bool pin=false);
 
     /// Register an integrator in the factory
     static void registerPlugin(const Plugin& plugin);
@@ -174,7 +176,7 @@ namespace casadi {
 
   template<class Derived>
   DL_HANDLE_TYPE PluginInterface<Derived>::load_library(const std::string& libname,
-    std::string& resultpath, bool global) {
+    std::string& resultpath, bool global, bool pin) {
 
 #ifndef WITH_DL
     casadi_error("WITH_DL option needed for dynamic loading");
@@ -255,6 +257,13 @@ namespace casadi {
     } else {
       flag = RTLD_LAZY | RTLD_LOCAL;
     }
+    if (pin) {
+      // Bind all symbols now rather than at their first call
+      flag = (flag & ~RTLD_LAZY) | RTLD_NOW;
+#ifdef RTLD_NODELETE
+      flag |= RTLD_NODELETE;
+#endif // RTLD_NODELETE
+    }
 #ifdef WITH_DEEPBIND
 #ifndef __APPLE__
     flag |= RTLD_DEEPBIND;
@@ -298,7 +307,8 @@ namespace casadi {
 
   template<class Derived>
   typename PluginInterface<Derived>::Plugin
-      PluginInterface<Derived>::load_plugin(const std::string& pname, bool register_plugin) {
+      PluginInterface<Derived>::load_plugin(const std::string& pname, bool register_plugin,
+                                            bool pin) {
     // Issue warning and quick return if already loaded
     if (Derived::solvers_.find(pname) != Derived::solvers_.end()) {
       casadi_warning("PluginInterface: Solver " + pname + " is already in use. Ignored.");
@@ -317,7 +327,7 @@ namespace casadi {
 
     std::string searchpath;
     DL_HANDLE_TYPE handle = load_library("casadi_" + Derived::infix_ + "_" + pname, searchpath,
-      false);
+      false, pin);
 
 #ifdef _WIN32
     reg = (RegFcn)GetProcAddress(handle, TEXT(regName.c_str()));
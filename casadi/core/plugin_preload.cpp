@@ -0,0 +1,130 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#include "plugin_preload.hpp"
+#include "conic_impl.hpp"
+#include "dple_impl.hpp"
+#include "expm_impl.hpp"
+#include "importer_internal.hpp"
+#include "integrator_impl.hpp"
+#include "interpolant_impl.hpp"
+#include "linsol_internal.hpp"
+#include "nlpsol_impl.hpp"
+#include "rootfinder_impl.hpp"
+#include "xml_file_internal.hpp"
+#include "thread_pool.hpp"
+#include <chrono>
+
+using namespace std;
+namespace casadi {
+
+  namespace {
+    // Load the library of a plugin, returns the registration, which is not thread-safe
+    template<class Derived>
+    std::function<void()> load_library(const std::string& pname, bool pin) {
+      if (Derived::solvers_.find(pname)!=Derived::solvers_.end()) return nullptr;
+      typename Derived::Plugin plugin = Derived::load_plugin(pname, false, pin);
+      return [plugin]() {
+        if (Derived::solvers_.find(plugin.name)==Derived::solvers_.end()) {
+          Derived::registerPlugin(plugin);
+        }
+      };
+    }
+
+    std::function<void()> load_library(const std::string& type, const std::string& pname,
+                                       bool pin) {
+      if (type==Conic::infix_) return load_library<Conic>(pname, pin);
+      if (type==Dple::infix_) return load_library<Dple>(pname, pin);
+      if (type==Expm::infix_) return load_library<Expm>(pname, pin);
+      if (type==ImporterInternal::infix_) return load_library<ImporterInternal>(pname, pin);
+      if (type==Integrator::infix_) return load_library<Integrator>(pname, pin);
+      if (type==Interpolant::infix_) return load_library<Interpolant>(pname, pin);
+      if (type==LinsolInternal::infix_) return load_library<LinsolInternal>(pname, pin);
+      if (type==Nlpsol::infix_) return load_library<Nlpsol>(pname, pin);
+      if (type==Rootfinder::infix_) return load_library<Rootfinder>(pname, pin);
+      if (type==XmlFileInternal::infix_) return load_library<XmlFileInternal>(pname, pin);
+      casadi_error("Unknown plugin type '" + type + "'");
+    }
+  } // namespace
+
+  Dict preload_plugins(const std::vector<std::string>& plugins, const Dict& opts) {
+    // Read options
+    bool pin = true;
+    casadi_int max_num_threads = ThreadPool::hardware_concurrency();
+    for (auto&& op : opts) {
+      if (op.first=="pin") {
+        pin = op.second;
+      } else if (op.first=="max_num_threads") {
+        max_num_threads = op.second;
+      } else {
+        casadi_error("No such option: " + op.first);
+      }
+    }
+    casadi_assert(max_num_threads>=1, "Option 'max_num_threads' must be positive");
+
+    // Split into type and name
+    casadi_int n = plugins.size();
+    std::vector<std::string> type(n), pname(n);
+    for (casadi_int k=0; k<n; ++k) {
+      size_t sep = plugins[k].find("::");
+      casadi_assert(sep!=std::string::npos,
+        "Plugin '" + plugins[k] + "' must be given as '<type>::<name>', e.g. 'nlpsol::ipopt'");
+      type[k] = plugins[k].substr(0, sep);
+      pname[k] = plugins[k].substr(sep+2);
+    }
+
+    // Load the libraries in parallel
+    std::vector<std::function<void()> > reg(n);
+    std::vector<double> t(n, 0);
+    std::vector<std::string> err(n);
+    if (n>0) {
+      ThreadPool::run(n, std::min(max_num_threads, n), [&](casadi_int k, casadi_int) {
+        auto t0 = std::chrono::steady_clock::now();
+        try {
+          reg[k] = load_library(type[k], pname[k], pin);
+        } catch (std::exception& e) {
+          err[k] = e.what();
+        }
+        t[k] = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+      });
+    }
+
+    // Register in order
+    Dict ret;
+    std::string failed;
+    for (casadi_int k=0; k<n; ++k) {
+      if (err[k].empty()) {
+        if (reg[k]) reg[k]();
+        ret[plugins[k]] = t[k];
+      } else {
+        failed += "\n" + plugins[k] + ": " + err[k];
+      }
+    }
+    casadi_assert(failed.empty(), "Cannot preload plugins:" + failed);
+    return ret;
+  }
+
+} // namespace casadi
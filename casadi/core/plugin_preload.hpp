@@ -0,0 +1,55 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#ifndef CASADI_PLUGIN_PRELOAD_HPP
+#define CASADI_PLUGIN_PRELOAD_HPP
+
+#include "generic_type.hpp"
+
+namespace casadi {
+
+  /** \brief Load plugins ahead of their first use
+
+      Plugins are given as "<type>::<name>", e.g. "nlpsol::ipopt", "integrator::cvodes"
+      or "linsol::ma27". The libraries are loaded in parallel and then registered, so that
+      creating a solver later does not load any library. Plugins already loaded are
+      skipped. Returns the wall time [s] spent loading each plugin.
+
+      Options:
+        pin: Resolve all symbols of the libraries when loading them, rather than at
+             their first call, and never unload them [true]
+        max_num_threads: Maximum number of threads loading libraries
+                         [number of hardware threads]
+
+      If some plugins cannot be loaded, the others are registered and an error
+      listing the failures is thrown.
+  */
+  CASADI_EXPORT Dict preload_plugins(const std::vector<std::string>& plugins,
+                                     const Dict& opts=Dict());
+
+} // namespace casadi
+
+#endif // CASADI_PLUGIN_PRELOAD_HPP
@@ -0,0 +1,357 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#include "polynomial_function.hpp"
+#include "mx_node.hpp"
+#include <map>
+
+using namespace std;
+namespace casadi {
+
+  Options PolynomialFunction::options_
+  = {{&FunctionInternal::options_},
+     {{"basis",
+       {OT_STRING,
+        "Polynomial basis: 'monomial' (default) or 'chebyshev'"}},
+      {"lbx",
+       {OT_DOUBLEVECTOR,
+        "Lower bounds of the Chebyshev domain, mapped to -1 [default -1]"}},
+      {"ubx",
+       {OT_DOUBLEVECTOR,
+        "Upper bounds of the Chebyshev domain, mapped to 1 [default 1]"}}
+     }
+  };
+
+  Function PolynomialFunction::create(const std::string& name,
+                                      const std::vector<std::vector<casadi_int> >& exponents,
+                                      const DM& coeff, const Dict& opts) {
+    casadi_int nterm = exponents.size();
+    casadi_assert(nterm>0, "Polynomial must have at least one term");
+    casadi_int nx = exponents.front().size();
+    casadi_assert(coeff.size2()==nterm,
+      "Coefficient matrix must have one column per term, got " + str(coeff.size2())
+      + " columns for " + str(nterm) + " terms");
+    // Sparse exponent matrix, one column per term
+    vector<casadi_int> colind(1, 0), row, e;
+    for (auto&& t : exponents) {
+      casadi_assert(t.size()==nx, "All exponent vectors must have length " + str(nx));
+      for (casadi_int j=0; j<nx; ++j) {
+        casadi_assert(t[j]>=0, "Exponents must be nonnegative");
+        if (t[j]>0) {
+          row.push_back(j);
+          e.push_back(t[j]);
+        }
+      }
+      colind.push_back(row.size());
+    }
+    return Function::create(new PolynomialFunction(name, Sparsity(nx, nterm, colind, row), e,
+      coeff.sparsity(), coeff.nonzeros(), Sparsity::dense(coeff.size1())), opts);
+  }
+
+  PolynomialFunction::PolynomialFunction(const std::string& name, const Sparsity& sp_e,
+      const std::vector<casadi_int>& e, const Sparsity& sp_c, const std::vector<double>& c,
+      const Sparsity& sp_out)
+    : FunctionInternal(name), sp_e_(sp_e), e_(e), sp_c_(sp_c), c_(c), sp_out_(sp_out) {
+    casadi_assert_dev(sp_e_.nnz()==e_.size());
+    casadi_assert_dev(sp_c_.nnz()==c_.size());
+    casadi_assert_dev(sp_c_.size2()==sp_e_.size2());
+    casadi_assert_dev(sp_c_.size1()==sp_out_.nnz());
+  }
+
+  void PolynomialFunction::init(const Dict& opts) {
+    // Call the initialization method of the base class
+    FunctionInternal::init(opts);
+
+    // Default options
+    string basis = "monomial";
+    casadi_int nx = sp_e_.size1();
+    lbx_.assign(nx, -1);
+    ubx_.assign(nx, 1);
+
+    // Read options
+    for (auto&& op : opts) {
+      if (op.first=="basis") {
+        basis = op.second.to_string();
+      } else if (op.first=="lbx") {
+        lbx_ = op.second;
+      } else if (op.first=="ubx") {
+        ubx_ = op.second;
+      }
+    }
+
+    // Basis
+    if (basis=="monomial") {
+      chebyshev_ = false;
+    } else if (basis=="chebyshev") {
+      chebyshev_ = true;
+    } else {
+      casadi_error("Unknown basis '" + basis + "', expected 'monomial' or 'chebyshev'");
+    }
+    casadi_assert(lbx_.size()==nx && ubx_.size()==nx,
+      "Options 'lbx' and 'ubx' must have length " + str(nx));
+    for (casadi_int j=0; j<nx; ++j) {
+      casadi_assert(lbx_[j]<ubx_[j], "Empty Chebyshev domain for input " + str(j));
+    }
+
+    // Tables for the basis functions, only for inputs that appear
+    vector<casadi_int> deg_max(nx, -1);
+    const casadi_int* row_e = sp_e_.row();
+    for (casadi_int k=0; k<e_.size(); ++k) {
+      deg_max[row_e[k]] = max(deg_max[row_e[k]], e_[k]);
+    }
+    deg_off_.resize(nx+1);
+    deg_off_[0] = 0;
+    for (casadi_int j=0; j<nx; ++j) deg_off_[j+1] = deg_off_[j] + deg_max[j] + 1;
+    alloc_w(deg_off_.back(), true);
+
+    // Inputs on which each output nonzero depends
+    const casadi_int *colind_e = sp_e_.colind(), *colind_c = sp_c_.colind(),
+      *row_c = sp_c_.row();
+    vector<casadi_int> dep_row, dep_col;
+    for (casadi_int t=0; t<sp_e_.size2(); ++t) {
+      for (casadi_int k=colind_c[t]; k<colind_c[t+1]; ++k) {
+        for (casadi_int k1=colind_e[t]; k1<colind_e[t+1]; ++k1) {
+          dep_row.push_back(row_e[k1]);
+          dep_col.push_back(row_c[k]);
+        }
+      }
+    }
+    sp_dep_ = Sparsity::triplet(nx, sp_out_.nnz(), dep_row, dep_col);
+  }
+
+  int PolynomialFunction::eval(const double** arg, double** res,
+                               casadi_int* iw, double* w, void* mem) const {
+    if (!res[0]) return 0;
+    casadi_polyval_nd(arg[0], res[0], sp_e_, get_ptr(e_), sp_c_, get_ptr(c_),
+      casadi_int(chebyshev_), get_ptr(lbx_), get_ptr(ubx_), get_ptr(deg_off_), w);
+    return 0;
+  }
+
+  int PolynomialFunction::eval_sx(const SXElem** arg, SXElem** res,
+                                  casadi_int* iw, SXElem* w, void* mem) const {
+    if (!res[0]) return 0;
+    vector<SXElem> c(c_.begin(), c_.end()), lbx(lbx_.begin(), lbx_.end()),
+      ubx(ubx_.begin(), ubx_.end());
+    casadi_polyval_nd(arg[0], res[0], sp_e_, get_ptr(e_), sp_c_, get_ptr(c),
+      casadi_int(chebyshev_), get_ptr(lbx), get_ptr(ubx), get_ptr(deg_off_), w);
+    return 0;
+  }
+
+  int PolynomialFunction::eval_batch(const double** arg, double** res, casadi_int* iw,
+                                     double* w, void* mem, casadi_int n) const {
+    if (!res[0]) return 0;
+    casadi_int nx = sp_e_.size1(), ny = sp_out_.nnz();
+    for (casadi_int k=0; k<n; ++k) {
+      casadi_polyval_nd(arg[0] ? arg[0]+k*nx : nullptr, res[0]+k*ny, sp_e_, get_ptr(e_),
+        sp_c_, get_ptr(c_), casadi_int(chebyshev_), get_ptr(lbx_), get_ptr(ubx_),
+        get_ptr(deg_off_), w);
+    }
+    return 0;
+  }
+
+  void PolynomialFunction::codegen_body(CodeGenerator& g) const {
+    g.add_auxiliary(CodeGenerator::AUX_POLYVAL_ND);
+    g << "if (res[0]) casadi_polyval_nd(arg[0], res[0], " << g.sparsity(sp_e_) << ", "
+      << g.constant(e_) << ", " << g.sparsity(sp_c_) << ", " << g.constant(c_) << ", "
+      << casadi_int(chebyshev_) << ", " << g.constant(lbx_) << ", " << g.constant(ubx_) << ", "
+      << g.constant(deg_off_) << ", w);\n";
+  }
+
+  void PolynomialFunction::codegen_body_batch(CodeGenerator& g, casadi_int n,
+                                              const std::string& nb, const std::string& arg,
+                                              const std::string& res,
+                                              const std::string& w) const {
+    casadi_int nx = sp_e_.size1(), ny = sp_out_.nnz();
+    g.add_auxiliary(CodeGenerator::AUX_POLYVAL_ND);
+    g << "if (" << res << "[0]) {\n"
+      << "for (k=0; k<" << nb << "; ++k) {\n"
+      << "casadi_polyval_nd(" << arg << "[0] ? " << arg << "[0]+k*" << nx << " : 0, "
+      << res << "[0]+k*" << ny << ", " << g.sparsity(sp_e_) << ", "
+      << g.constant(e_) << ", " << g.sparsity(sp_c_) << ", " << g.constant(c_) << ", "
+      << casadi_int(chebyshev_) << ", " << g.constant(lbx_) << ", " << g.constant(ubx_) << ", "
+      << g.constant(deg_off_) << ", " << w << ");\n"
+      << "}\n"
+      << "}\n";
+  }
+
+  int PolynomialFunction::sp_forward(const bvec_t** arg, bvec_t** res,
+                                     casadi_int* iw, bvec_t* w, void* mem) const {
+    if (!res[0]) return 0;
+    const casadi_int *colind = sp_dep_.colind(), *row = sp_dep_.row();
+    for (casadi_int i=0; i<sp_dep_.size2(); ++i) {
+      res[0][i] = 0;
+      if (arg[0]) {
+        for (casadi_int k=colind[i]; k<colind[i+1]; ++k) res[0][i] |= arg[0][row[k]];
+      }
+    }
+    return 0;
+  }
+
+  int PolynomialFunction::sp_reverse(bvec_t** arg, bvec_t** res,
+                                     casadi_int* iw, bvec_t* w, void* mem) const {
+    if (!res[0]) return 0;
+    const casadi_int *colind = sp_dep_.colind(), *row = sp_dep_.row();
+    for (casadi_int i=0; i<sp_dep_.size2(); ++i) {
+      if (arg[0]) {
+        for (casadi_int k=colind[i]; k<colind[i+1]; ++k) arg[0][row[k]] |= res[0][i];
+      }
+      res[0][i] = 0;
+    }
+    return 0;
+  }
+
+  Function PolynomialFunction::derivative() const {
+    // Jacobian pattern, one output of the derivative per nonzero
+    Sparsity sp_jac = sp_dep_.T();
+    const casadi_int *colind_e = sp_e_.colind(), *row_e = sp_e_.row(),
+      *colind_c = sp_c_.colind(), *row_c = sp_c_.row();
+    // Terms of the derivative, identified by their (input, exponent) pairs
+    std::map<vector<pair<casadi_int, casadi_int> >, casadi_int> terms;
+    // Coefficients of the derivative, keyed by (term, output nonzero)
+    std::map<pair<casadi_int, casadi_int>, double> coeff;
+    for (casadi_int t=0; t<sp_e_.size2(); ++t) {
+      if (colind_c[t]==colind_c[t+1]) continue;
+      // Exponents of the term
+      vector<pair<casadi_int, casadi_int> > ex;
+      for (casadi_int k=colind_e[t]; k<colind_e[t+1]; ++k) ex.push_back({row_e[k], e_[k]});
+      for (casadi_int i=0; i<ex.size(); ++i) {
+        casadi_int j = ex[i].first, d = ex[i].second;
+        // Derivative of the univariate basis function, in the same basis
+        vector<pair<casadi_int, double> > dbasis;
+        if (chebyshev_) {
+          // T_d' = 2d (T_{d-1} + T_{d-3} + ...), T_0 with half weight
+          double scale = 2/(ubx_[j]-lbx_[j]);
+          for (casadi_int k=d-1; k>=0; k-=2) {
+            dbasis.push_back({k, (k==0 ? d : 2*d)*scale});
+          }
+        } else {
+          dbasis.push_back({d-1, static_cast<double>(d)});
+        }
+        for (auto&& db : dbasis) {
+          vector<pair<casadi_int, casadi_int> > ex_new;
+          for (casadi_int i1=0; i1<ex.size(); ++i1) {
+            if (i1!=i) {
+              ex_new.push_back(ex[i1]);
+            } else if (db.first>0) {
+              ex_new.push_back({j, db.first});
+            }
+          }
+          auto it = terms.insert({ex_new, terms.size()}).first;
+          for (casadi_int k=colind_c[t]; k<colind_c[t+1]; ++k) {
+            casadi_int nz = sp_jac.get_nz(row_c[k], j);
+            coeff[{it->second, nz}] += c_[k]*db.second;
+          }
+        }
+      }
+    }
+    // Assemble exponent matrix
+    casadi_int nterm = terms.size();
+    vector<vector<pair<casadi_int, casadi_int> > > ex_all(nterm);
+    for (auto&& t : terms) ex_all[t.second] = t.first;
+    vector<casadi_int> colind_e_new(1, 0), row_e_new, e_new;
+    for (auto&& ex : ex_all) {
+      for (auto&& p : ex) {
+        row_e_new.push_back(p.first);
+        e_new.push_back(p.second);
+      }
+      colind_e_new.push_back(row_e_new.size());
+    }
+    // Assemble coefficient matrix, map is ordered by term and then output nonzero
+    vector<casadi_int> colind_c_new(nterm+1, 0), row_c_new;
+    vector<double> c_new;
+    for (auto&& c : coeff) {
+      colind_c_new[c.first.first+1]++;
+      row_c_new.push_back(c.first.second);
+      c_new.push_back(c.second);
+    }
+    for (casadi_int t=0; t<nterm; ++t) colind_c_new[t+1] += colind_c_new[t];
+    // Create derivative with the same basis
+    Dict opts = {{"basis", chebyshev_ ? "chebyshev" : "monomial"}};
+    if (chebyshev_) {
+      opts["lbx"] = lbx_;
+      opts["ubx"] = ubx_;
+    }
+    return Function::create(new PolynomialFunction("d_" + name_,
+      Sparsity(sp_e_.size1(), nterm, colind_e_new, row_e_new), e_new,
+      Sparsity(sp_jac.nnz(), nterm, colind_c_new, row_c_new), c_new, sp_jac), opts);
+  }
+
+  MX PolynomialFunction::jac(const MX& x) const {
+    return derivative()(vector<MX>{x}).at(0);
+  }
+
+  Function PolynomialFunction::get_forward(casadi_int nfwd, const std::string& name,
+                                           const std::vector<std::string>& inames,
+                                           const std::vector<std::string>& onames,
+                                           const Dict& opts) const {
+    casadi_int ny = sp_out_.nnz();
+    bool vec_out = sp_out_.is_dense() && sp_out_.is_column();
+    MX x = MX::sym(inames.at(0), sparsity_in_.at(0));
+    MX dummy = MX::sym(inames.at(1), Sparsity(sp_out_.size()));
+    MX J = jac(x);
+    vector<MX> seed = MX::sym(inames.at(2), sparsity_in_.at(0), nfwd);
+    vector<MX> sens;
+    for (casadi_int d=0; d<nfwd; ++d) {
+      MX s = densify(mtimes(J, seed[d]));
+      sens.push_back(vec_out ? s : s->get_nzref(sp_out_, range(ny)));
+    }
+    return Function(name, {x, dummy, horzcat(seed)}, {horzcat(sens)}, inames, onames, opts);
+  }
+
+  Function PolynomialFunction::get_reverse(casadi_int nadj, const std::string& name,
+                                           const std::vector<std::string>& inames,
+                                           const std::vector<std::string>& onames,
+                                           const Dict& opts) const {
+    casadi_int ny = sp_out_.nnz();
+    bool vec_out = sp_out_.is_dense() && sp_out_.is_column();
+    MX x = MX::sym(inames.at(0), sparsity_in_.at(0));
+    MX dummy = MX::sym(inames.at(1), Sparsity(sp_out_.size()));
+    MX JT = jac(x).T();
+    vector<MX> seed = MX::sym(inames.at(2), sp_out_, nadj);
+    vector<MX> sens;
+    for (casadi_int d=0; d<nadj; ++d) {
+      MX s = vec_out ? seed[d] : seed[d]->get_nzref(Sparsity::dense(ny), range(ny));
+      sens.push_back(densify(mtimes(JT, s)));
+    }
+    return Function(name, {x, dummy, horzcat(seed)}, {horzcat(sens)}, inames, onames, opts);
+  }
+
+  Function PolynomialFunction::get_jacobian(const std::string& name,
+                                            const std::vector<std::string>& inames,
+                                            const std::vector<std::string>& onames,
+                                            const Dict& opts) const {
+    MX x = MX::sym(inames.at(0), sparsity_in_.at(0));
+    MX dummy = MX::sym(inames.at(1), Sparsity(sp_out_.size()));
+    return Function(name, {x, dummy}, {jac(x)}, inames, onames, opts);
+  }
+
+  Dict PolynomialFunction::info() const {
+    return {{"basis", chebyshev_ ? "chebyshev" : "monomial"},
+            {"n_terms", sp_e_.size2()}, {"nnz_exponents", sp_e_.nnz()},
+            {"nnz_coeff", sp_c_.nnz()}};
+  }
+
+} // namespace casadi
@@ -0,0 +1,184 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#ifndef CASADI_POLYNOMIAL_FUNCTION_HPP
+#define CASADI_POLYNOMIAL_FUNCTION_HPP
+
+#include "function_internal.hpp"
+
+/// \cond INTERNAL
+namespace casadi {
+
+  /** \brief Multivariate polynomial in monomial or Chebyshev basis
+
+      Created with Function::polynomial. The terms are stored as a sparse exponent
+      matrix (nx-by-nterm) and the coefficients as a sparse matrix with one row per
+      output nonzero (nnz_out-by-nterm). Evaluation tabulates the univariate basis
+      functions of each input once, after which every term costs one multiplication
+      per variable it contains. Derivatives are again PolynomialFunction instances.
+  */
+  class CASADI_EXPORT PolynomialFunction : public FunctionInternal {
+  public:
+    /** \brief Create from dense exponent vectors and a coefficient matrix */
+    static Function create(const std::string& name,
+                           const std::vector<std::vector<casadi_int> >& exponents,
+                           const DM& coeff, const Dict& opts=Dict());
+
+    /** \brief Constructor */
+    PolynomialFunction(const std::string& name, const Sparsity& sp_e,
+                       const std::vector<casadi_int>& e, const Sparsity& sp_c,
+                       const std::vector<double>& c, const Sparsity& sp_out);
+
+    /** \brief Destructor */
+    ~PolynomialFunction() override { clear_mem();}
+
+    /** \brief Get type name */
+    std::string class_name() const override {return "PolynomialFunction";}
+
+    ///@{
+    /** \brief Number of function inputs and outputs */
+    size_t get_n_in() override { return 1;}
+    size_t get_n_out() override { return 1;}
+    ///@}
+
+    /// @{
+    /** \brief Sparsities of function inputs and outputs */
+    Sparsity get_sparsity_in(casadi_int i) override { return Sparsity::dense(sp_e_.size1());}
+    Sparsity get_sparsity_out(casadi_int i) override { return sp_out_;}
+    /// @}
+
+    ///@{
+    /** \brief Options */
+    static Options options_;
+    const Options& get_options() const override { return options_;}
+    ///@}
+
+    /** \brief  Initialize */
+    void init(const Dict& opts) override;
+
+    /** \brief  Evaluate numerically */
+    int eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const override;
+
+    /** \brief  Evaluate symbolically, SX type */
+    int eval_sx(const SXElem** arg, SXElem** res,
+                casadi_int* iw, SXElem* w, void* mem) const override;
+
+    ///@{
+    /** \brief Batched evaluation, points evaluated one after the other */
+    bool has_eval_batch() const override { return true;}
+    int eval_batch(const double** arg, double** res, casadi_int* iw, double* w,
+                   void* mem, casadi_int n) const override;
+    void codegen_body_batch(CodeGenerator& g, casadi_int n, const std::string& nb,
+                            const std::string& arg, const std::string& res,
+                            const std::string& w) const override;
+    ///@}
+
+    /** \brief  Propagate sparsity forward */
+    int sp_forward(const bvec_t** arg, bvec_t** res,
+                   casadi_int* iw, bvec_t* w, void* mem) const override;
+
+    /** \brief  Propagate sparsity backwards */
+    int sp_reverse(bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w, void* mem) const override;
+
+    ///@{
+    /// Is the class able to propagate seeds through the algorithm?
+    bool has_spfwd() const override { return true;}
+    bool has_sprev() const override { return true;}
+    ///@}
+
+    ///@{
+    /** \brief Generate a function that calculates \a nfwd forward derivatives */
+    bool has_forward(casadi_int nfwd) const override { return true;}
+    Function get_forward(casadi_int nfwd, const std::string& name,
+                         const std::vector<std::string>& inames,
+                         const std::vector<std::string>& onames,
+                         const Dict& opts) const override;
+    ///@}
+
+    ///@{
+    /** \brief Generate a function that calculates \a nadj adjoint derivatives */
+    bool has_reverse(casadi_int nadj) const override { return true;}
+    Function get_reverse(casadi_int nadj, const std::string& name,
+                         const std::vector<std::string>& inames,
+                         const std::vector<std::string>& onames,
+                         const Dict& opts) const override;
+    ///@}
+
+    ///@{
+    /** \brief Return Jacobian of all input elements with respect to all output elements */
+    bool has_jacobian() const override { return true;}
+    Function get_jacobian(const std::string& name,
+                          const std::vector<std::string>& inames,
+                          const std::vector<std::string>& onames,
+                          const Dict& opts) const override;
+    ///@}
+
+    /** \brief Is codegen supported? */
+    bool has_codegen() const override { return true;}
+
+    /** \brief Generate code for the declarations of the C function */
+    void codegen_declarations(CodeGenerator& g) const override {}
+
+    /** \brief Generate code for the body of the C function */
+    void codegen_body(CodeGenerator& g) const override;
+
+    /** Obtain information about node */
+    Dict info() const override;
+
+  protected:
+    /// Jacobian, nnz_out-by-nx, as a call to the derivative polynomial
+    MX jac(const MX& x) const;
+
+    /// Derivative polynomial: one output nonzero per structurally nonzero Jacobian entry
+    Function derivative() const;
+
+    // Exponent matrix, nx-by-nterm
+    Sparsity sp_e_;
+    std::vector<casadi_int> e_;
+
+    // Coefficient matrix, nnz_out-by-nterm
+    Sparsity sp_c_;
+    std::vector<double> c_;
+
+    // Output sparsity pattern
+    Sparsity sp_out_;
+
+    // Chebyshev basis?
+    bool chebyshev_;
+
+    // Domain of the Chebyshev basis
+    std::vector<double> lbx_, ubx_;
+
+    // Offsets of the basis function tables in the work vector
+    std::vector<casadi_int> deg_off_;
+
+    // Inputs on which each output nonzero depends, nx-by-nnz_out
+    Sparsity sp_dep_;
+  };
+
+} // namespace casadi
+/// \endcond
+
+#endif // CASADI_POLYNOMIAL_FUNCTION_HPP
@@ -0,0 +1,262 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#include "profiler.hpp"
+#include "function_internal.hpp"
+#include <iomanip>
+#include <sstream>
+
+#ifdef CASADI_WITH_THREAD
+#include <atomic>
+#ifdef CASADI_WITH_THREAD_MINGW
+#include <mingw.mutex.h>
+#else // CASADI_WITH_THREAD_MINGW
+#include <mutex>
+#endif // CASADI_WITH_THREAD_MINGW
+#endif //CASADI_WITH_THREAD
+
+namespace casadi {
+
+  bool Profiler::enabled = false;
+
+  // Trees of all threads
+  struct ProfilerTrees {
+    std::vector<std::unique_ptr<Profiler::Node> > roots;
+#ifdef CASADI_WITH_THREAD
+    std::mutex mtx;
+    std::atomic<casadi_int> generation;
+#else // CASADI_WITH_THREAD
+    casadi_int generation;
+#endif //CASADI_WITH_THREAD
+    ProfilerTrees() : generation(0) {}
+  };
+
+  // Never destroyed, evaluations may happen during static destruction
+  static ProfilerTrees& profiler_trees() {
+    static ProfilerTrees* t = new ProfilerTrees();
+    return *t;
+  }
+
+  // Innermost evaluation of the thread, and the generation of the trees it belongs to
+  static thread_local Profiler::Node* profiler_current = nullptr;
+  static thread_local casadi_int profiler_generation = -1;
+
+  double Profiler::Node::t_wall_self() const {
+    double t = t_wall;
+    for (auto&& c : children) t -= c->t_wall;
+    // Rounding errors of the subtraction
+    return t>1e-12*t_wall ? t : 0;
+  }
+
+  double Profiler::Node::t_proc_self() const {
+    double t = t_proc;
+    for (auto&& c : children) t -= c->t_proc;
+    // Rounding errors of the subtraction
+    return t>1e-12*t_proc ? t : 0;
+  }
+
+  static Profiler::Node* profiler_node(const ProtoFunction* f, const std::string& name,
+                                       casadi_int mem, Profiler::Node* parent) {
+    Profiler::Node* n = new Profiler::Node();
+    n->f = f;
+    n->name = name;
+    n->mem = mem;
+    n->parent = parent;
+    n->n_call = 0;
+    n->t_wall = n->t_proc = 0;
+    return n;
+  }
+
+  Profiler::Node* Profiler::enter(const ProtoFunction* f, void* mem, casadi_int& generation) {
+    ProfilerTrees& t = profiler_trees();
+    generation = t.generation;
+    // New root if the thread has none or the trees were reset
+    if (profiler_generation!=generation || profiler_current==nullptr) {
+      Node* root = profiler_node(nullptr, "", -1, nullptr);
+#ifdef CASADI_WITH_THREAD
+      std::lock_guard<std::mutex> lock(t.mtx);
+#endif //CASADI_WITH_THREAD
+      // Thread number, as it appears in the output
+      root->mem = t.roots.size();
+      t.roots.emplace_back(root);
+      profiler_current = root;
+      profiler_generation = generation;
+    }
+    // Find or add child of the current evaluation
+    casadi_int m = f->memory_index(mem);
+    Node* parent = profiler_current;
+    Node* node = nullptr;
+    for (auto&& c : parent->children) {
+      if (c->f==f && c->mem==m) {
+        node = c.get();
+        break;
+      }
+    }
+    if (node==nullptr) {
+      node = profiler_node(f, f->name(), m, parent);
+      parent->children.emplace_back(node);
+    }
+    profiler_current = node;
+    return node;
+  }
+
+  void Profiler::leave(Node* node, casadi_int generation, double t_wall, double t_proc) {
+    if (generation!=profiler_trees().generation || profiler_generation!=generation) {
+      // Trees were reset during the evaluation
+      profiler_current = nullptr;
+      return;
+    }
+    node->n_call++;
+    node->t_wall += t_wall;
+    node->t_proc += t_proc;
+    profiler_current = node->parent;
+    // Time of the thread
+    if (profiler_current->parent==nullptr) {
+      profiler_current->n_call++;
+      profiler_current->t_wall += t_wall;
+      profiler_current->t_proc += t_proc;
+    }
+  }
+
+  casadi_int Profiler::thread_index() {
+#ifdef CASADI_WITH_THREAD
+    static std::atomic<casadi_int> n_thread(0);
+#else // CASADI_WITH_THREAD
+    static casadi_int n_thread = 0;
+#endif //CASADI_WITH_THREAD
+    static thread_local casadi_int index = n_thread++;
+    return index;
+  }
+
+  void ProfilerScope::hook_begin(const ProtoFunction* f, void* mem) {
+    hook_ = EvaluationHook::active;
+    f_ = f;
+    mem_ = f->memory_index(mem);
+    thread_ = Profiler::thread_index();
+    hook_->begin(f->name(), mem_, thread_);
+  }
+
+  void ProfilerScope::hook_end() {
+    // Called from a destructor, must not throw
+    try {
+      hook_->end(f_->name(), mem_, thread_);
+    } catch (std::exception& e) {
+      casadi_warning("EvaluationHook::end failed: " + std::string(e.what()));
+    }
+  }
+
+  void Profiler::reset() {
+    ProfilerTrees& t = profiler_trees();
+#ifdef CASADI_WITH_THREAD
+    std::lock_guard<std::mutex> lock(t.mtx);
+#endif //CASADI_WITH_THREAD
+    t.roots.clear();
+    t.generation++;
+  }
+
+  // Name of a node in the output
+  static std::string profiler_name(const Profiler::Node& n) {
+    if (n.f==nullptr) return "thread " + str(n.mem);
+    return n.mem>0 ? n.name + "[" + str(n.mem) + "]" : n.name;
+  }
+
+  // Escape a string for JSON
+  static std::string profiler_json(const std::string& s) {
+    std::stringstream ss;
+    for (char c : s) {
+      if (c=='"' || c=='\\') {
+        ss << '\\' << c;
+      } else if (static_cast<unsigned char>(c)<0x20) {
+        ss << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c)
+           << std::dec << std::setfill(' ');
+      } else {
+        ss << c;
+      }
+    }
+    return ss.str();
+  }
+
+  // Chrome trace events: children are laid out one after the other inside their parent
+  static void profiler_chrome(std::ostream& stream, const Profiler::Node& n, casadi_int tid,
+                              double ts, bool& first) {
+    stream << (first ? "\n" : ",\n");
+    first = false;
+    stream << "{\"name\":\"" << profiler_json(profiler_name(n)) << "\",\"ph\":\"X\","
+           << "\"pid\":0,\"tid\":" << tid << ",\"ts\":" << ts*1e6 << ",\"dur\":" << n.t_wall*1e6
+           << ",\"args\":{\"n_call\":" << n.n_call << ",\"mem\":" << n.mem
+           << ",\"t_wall_self\":" << n.t_wall_self() << ",\"t_proc\":" << n.t_proc
+           << ",\"t_proc_self\":" << n.t_proc_self() << "}}";
+    for (auto&& c : n.children) {
+      profiler_chrome(stream, *c, tid, ts, first);
+      ts += c->t_wall;
+    }
+  }
+
+  // Collapsed stacks, weighted by the exclusive wall time in microseconds
+  static void profiler_collapsed(std::ostream& stream, const Profiler::Node& n,
+                                 const std::string& stack) {
+    std::string s = stack.empty() ? profiler_name(n) : stack + ";" + profiler_name(n);
+    casadi_int us = static_cast<casadi_int>(n.t_wall_self()*1e6 + 0.5);
+    if (us>0) stream << s << " " << us << "\n";
+    for (auto&& c : n.children) profiler_collapsed(stream, *c, s);
+  }
+
+  // Indented table
+  static void profiler_text(std::ostream& stream, const Profiler::Node& n, casadi_int depth) {
+    std::string name = std::string(2*depth, ' ') + profiler_name(n);
+    stream << std::left << std::setw(40) << name << std::right
+           << std::setw(10) << n.n_call
+           << std::setw(12) << n.t_wall << std::setw(12) << n.t_wall_self()
+           << std::setw(12) << n.t_proc << std::setw(12) << n.t_proc_self() << "\n";
+    for (auto&& c : n.children) profiler_text(stream, *c, depth+1);
+  }
+
+  void Profiler::write(std::ostream& stream, const std::string& format) {
+    ProfilerTrees& t = profiler_trees();
+#ifdef CASADI_WITH_THREAD
+    std::lock_guard<std::mutex> lock(t.mtx);
+#endif //CASADI_WITH_THREAD
+    if (format=="chrome") {
+      // Chrome trace event format, cf. chrome://tracing or https://ui.perfetto.dev
+      stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+      bool first = true;
+      for (auto&& r : t.roots) profiler_chrome(stream, *r, r->mem, 0, first);
+      stream << "\n]}\n";
+    } else if (format=="collapsed") {
+      // Input for flamegraph.pl, speedscope and similar tools
+      for (auto&& r : t.roots) profiler_collapsed(stream, *r, "");
+    } else if (format=="text") {
+      stream << std::left << std::setw(40) << "function" << std::right << std::setw(10)
+             << "n_call" << std::setw(12) << "t_wall" << std::setw(12) << "t_wall_self"
+             << std::setw(12) << "t_proc" << std::setw(12) << "t_proc_self" << "\n";
+      for (auto&& r : t.roots) profiler_text(stream, *r, 0);
+    } else {
+      casadi_error("Unknown profile format '" + format + "'. "
+                   "Allowed values: chrome, collapsed, text.");
+    }
+  }
+
+} // namespace casadi
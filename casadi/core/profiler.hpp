@@ -0,0 +1,126 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#ifndef CASADI_PROFILER_HPP
+#define CASADI_PROFILER_HPP
+
+#include "casadi_common.hpp"
+#include "evaluation_hook.hpp"
+#include <chrono>
+#include <ctime>
+#include <memory>
+
+/// \cond INTERNAL
+
+namespace casadi {
+
+  // Forward declaration
+  class ProtoFunction;
+
+  /** \brief Call tree of numerical Function evaluations, cf. GlobalOptions::setProfiling
+   *
+   * Every thread records its own tree. A node is a function evaluated with a given memory
+   * object below a given parent, with the number of calls and the accumulated wall and
+   * processor times, including the time spent in the children.
+   */
+  class CASADI_EXPORT Profiler {
+  public:
+    struct Node {
+      // Evaluated function, nullptr for the root of a thread
+      const ProtoFunction* f;
+      // Name of the function
+      std::string name;
+      // Memory object
+      casadi_int mem;
+      // Parent node
+      Node* parent;
+      // Children in order of the first call
+      std::vector<std::unique_ptr<Node> > children;
+      // Number of calls
+      casadi_int n_call;
+      // Inclusive wall and processor times [s]
+      double t_wall, t_proc;
+      // Exclusive wall and processor times [s]
+      double t_wall_self() const;
+      double t_proc_self() const;
+    };
+
+    /// Is recording enabled
+    static bool enabled;
+
+    /// Enter an evaluation, returns nullptr if the tree was reset meanwhile
+    static Node* enter(const ProtoFunction* f, void* mem, casadi_int& generation);
+
+    /// Leave an evaluation
+    static void leave(Node* node, casadi_int generation, double t_wall, double t_proc);
+
+    /// Discard all recorded trees
+    static void reset();
+
+    /// Write the trees, format 'chrome', 'collapsed' or 'text'
+    static void write(std::ostream& stream, const std::string& format);
+
+    /// Index of the calling thread, in order of the first call
+    static casadi_int thread_index();
+  };
+
+  /** \brief Records an evaluation for the lifetime of the object,
+   * and calls the EvaluationHook if one is installed */
+  class CASADI_EXPORT ProfilerScope {
+  public:
+    ProfilerScope(const ProtoFunction* f, void* mem) : node_(nullptr), hook_(nullptr) {
+      if (EvaluationHook::active) hook_begin(f, mem);
+      if (Profiler::enabled) {
+        node_ = Profiler::enter(f, mem, generation_);
+        start_wall_ = std::chrono::steady_clock::now();
+        start_proc_ = std::clock();
+      }
+    }
+    ~ProfilerScope() {
+      if (node_) {
+        std::chrono::duration<double> t_wall = std::chrono::steady_clock::now() - start_wall_;
+        double t_proc = static_cast<double>(std::clock() - start_proc_) / CLOCKS_PER_SEC;
+        Profiler::leave(node_, generation_, t_wall.count(), t_proc);
+      }
+      if (hook_) hook_end();
+    }
+  private:
+    Profiler::Node* node_;
+    casadi_int generation_;
+    std::chrono::steady_clock::time_point start_wall_;
+    std::clock_t start_proc_;
+    // Out-of-line calls of the evaluation hook
+    void hook_begin(const ProtoFunction* f, void* mem);
+    void hook_end();
+    EvaluationHook* hook_;
+    const ProtoFunction* f_;
+    casadi_int mem_, thread_;
+  };
+
+} // namespace casadi
+/// \endcond
+
+#endif // CASADI_PROFILER_HPP
@@ -264,12 +264,14 @@ namespace casadi {
 
   int Rootfinder::eval(const double** arg, double** res,
       casadi_int* iw, double* w, void* mem) const {
+    auto m = static_cast<RootfinderMemory*>(mem);
+    m->deadline.start(max_wall_time_, &cancel_epoch_);
+
     // Reset the solver, prepare for solution
     setup(mem, arg, res, iw, w);
 
     // Solve the NLP
     int ret = solve(mem);
-    auto m = static_cast<RootfinderMemory*>(mem);
     if (error_on_fail_ && !m->success)
       casadi_error("rootfinder process failed. "
                    "Set 'error_on_fail' option to false to ignore this error.");
@@ -0,0 +1,281 @@
+// NOLINT(legal/copyright)
+
+// C-REPLACE "fmin" "casadi_fmin"
+// C-REPLACE "fmax" "casadi_fmax"
+
+// SYMBOL "admm_prob"
+template<typename T1>
+struct casadi_admm_prob {
+  // Number of variables, constraints and their sum
+  casadi_int nx, na, n;
+  // Sparsity patterns of H and A
+  const casadi_int *sp_h, *sp_a;
+  // KKT matrix [H, A'; A, 0] with the diagonal, its transposed L factor and ordering
+  const casadi_int *sp_kkt, *sp_lt, *perm;
+  // Locations in the KKT matrix of the nonzeros of H, A, A' and of the diagonal
+  const casadi_int *kkt_h, *kkt_a, *kkt_at, *kkt_d;
+  // Maximum number of iterations, iterations between updates of the penalty
+  casadi_int max_iter, rho_interval;
+  // Absolute and relative tolerance
+  T1 eps_abs, eps_rel;
+  // Penalty: initial value and range, proximal term, relaxation parameter
+  T1 rho0, rho_min, rho_max, sigma, alpha;
+  // Infinity
+  T1 inf;
+};
+// C-REPLACE "casadi_admm_prob<T1>" "struct casadi_admm_prob"
+
+// SYMBOL "admm_data"
+template<typename T1>
+struct casadi_admm_data {
+  // Problem structure
+  const casadi_admm_prob<T1>* prob;
+  // Type of each variable and constraint: 0 free, 1 inequality, 2 equality
+  casadi_int *type;
+  // Problem data
+  const T1 *h, *g, *a;
+  // Bounds of the variables followed by the constraints
+  T1 *lb, *ub;
+  // Iterate: variables, values of [x; A*x] projected on the bounds, multipliers
+  T1 *x, *z, *y;
+  // Solution of the KKT system, followed by the values of [x; A*x] it implies
+  T1 *xt, *zt;
+  // Penalty of each variable and constraint, values of [x; A*x], dual residual
+  T1 *rho_v, *v, *rz;
+  // KKT matrix, its factorization and work
+  T1 *kkt, *lt, *d, *w;
+  // Current penalty
+  T1 rho;
+  // Factorization up to date, number of factorizations
+  casadi_int factorized, nfact;
+  // Iteration counter
+  casadi_int iter;
+  // Primal and dual residual
+  T1 r_prim, r_dual;
+};
+// C-REPLACE "casadi_admm_data<T1>" "struct casadi_admm_data"
+
+// SYMBOL "admm_work"
+template<typename T1>
+void casadi_admm_work(const casadi_admm_prob<T1>* p, casadi_int* sz_iw, casadi_int* sz_w) {
+  *sz_iw = p->n; // type
+  *sz_w = 2*p->n; // lb, ub
+  *sz_w += 2*p->nx + 2*p->n; // x, rz, z, y
+  *sz_w += 2*p->n; // xt, zt
+  *sz_w += 2*p->n; // rho_v, v
+  *sz_w += p->sp_kkt[2+p->n] + p->sp_lt[2+p->n] + 2*p->n; // kkt, lt, d, w
+}
+
+// SYMBOL "admm_init"
+template<typename T1>
+void casadi_admm_init(casadi_admm_data<T1>* d, casadi_int* iw, T1* w) {
+  const casadi_admm_prob<T1>* p = d->prob;
+  d->type = iw;
+  d->lb = w; w += p->n;
+  d->ub = w; w += p->n;
+  d->x = w; w += p->nx;
+  d->rz = w; w += p->nx;
+  d->z = w; w += p->n;
+  d->y = w; w += p->n;
+  d->xt = w; w += p->n;
+  d->zt = w; w += p->n;
+  d->rho_v = w; w += p->n;
+  d->v = w; w += p->n;
+  d->kkt = w; w += p->sp_kkt[2+p->n];
+  d->lt = w; w += p->sp_lt[2+p->n];
+  d->d = w; w += p->n;
+  d->w = w;
+  d->rho = p->rho0;
+  d->factorized = 0;
+  d->nfact = 0;
+}
+
+// SYMBOL "admm_setup"
+// Pass the QP data, the initial guess and classify the bounds, returns 1 if some
+// lower bound exceeds the corresponding upper bound
+template<typename T1>
+int casadi_admm_setup(casadi_admm_data<T1>* d, const T1* h, const T1* g, const T1* a,
+                      const T1* lba, const T1* uba, const T1* lbx, const T1* ubx,
+                      const T1* x0, const T1* lam_x0, const T1* lam_a0) {
+  // Local variables
+  casadi_int i;
+  const casadi_admm_prob<T1>* p = d->prob;
+  d->h = h;
+  d->g = g;
+  d->a = a;
+  for (i=0; i<p->nx; ++i) {
+    d->lb[i] = lbx ? lbx[i] : 0;
+    d->ub[i] = ubx ? ubx[i] : 0;
+  }
+  for (i=0; i<p->na; ++i) {
+    d->lb[p->nx+i] = lba ? lba[i] : 0;
+    d->ub[p->nx+i] = uba ? uba[i] : 0;
+  }
+  for (i=0; i<p->n; ++i) {
+    if (d->lb[i] > d->ub[i]) return 1;
+    if (d->lb[i]==d->ub[i]) {
+      d->type[i] = 2;
+    } else if (d->lb[i] > -p->inf || d->ub[i] < p->inf) {
+      d->type[i] = 1;
+    } else {
+      d->type[i] = 0;
+    }
+  }
+  // Initial guess
+  casadi_fill(d->x, p->nx, 0.);
+  if (x0) casadi_copy(x0, p->nx, d->x);
+  casadi_fill(d->y, p->n, 0.);
+  if (lam_x0) casadi_copy(lam_x0, p->nx, d->y);
+  if (lam_a0) casadi_copy(lam_a0, p->na, d->y + p->nx);
+  return 0;
+}
+
+// SYMBOL "admm_rho"
+// Penalty of each variable and constraint: larger for equalities, small for free rows
+template<typename T1>
+void casadi_admm_rho(casadi_admm_data<T1>* d) {
+  // Local variables
+  casadi_int i;
+  const casadi_admm_prob<T1>* p = d->prob;
+  for (i=0; i<p->n; ++i) {
+    if (d->type[i]==2) {
+      d->rho_v[i] = 1e3*d->rho;
+    } else if (d->type[i]==1) {
+      d->rho_v[i] = d->rho;
+    } else {
+      d->rho_v[i] = p->rho_min;
+    }
+  }
+}
+
+// SYMBOL "admm_factor"
+// Assemble and factorize the quasi-definite KKT matrix
+// [H + sigma*I + diag(rho_x), A'; A, -diag(1/rho_a)]
+template<typename T1>
+void casadi_admm_factor(casadi_admm_data<T1>* d) {
+  // Local variables
+  casadi_int i, c, k;
+  const casadi_int *colind;
+  const casadi_admm_prob<T1>* p = d->prob;
+  casadi_fill(d->kkt, p->sp_kkt[2+p->n], 0.);
+  if (d->h) {
+    colind = p->sp_h+2;
+    for (c=0; c<p->nx; ++c) {
+      for (k=colind[c]; k<colind[c+1]; ++k) d->kkt[p->kkt_h[k]] = d->h[k];
+    }
+  }
+  if (d->a) {
+    colind = p->sp_a+2;
+    for (c=0; c<p->nx; ++c) {
+      for (k=colind[c]; k<colind[c+1]; ++k) d->kkt[p->kkt_a[k]] = d->kkt[p->kkt_at[k]] = d->a[k];
+    }
+  }
+  for (i=0; i<p->nx; ++i) d->kkt[p->kkt_d[i]] += p->sigma + d->rho_v[i];
+  for (i=p->nx; i<p->n; ++i) d->kkt[p->kkt_d[i]] = -1/d->rho_v[i];
+  casadi_ldl(p->sp_kkt, d->kkt, p->sp_lt, d->lt, d->d, p->perm, d->w);
+  d->factorized = 1;
+  d->nfact++;
+}
+
+// SYMBOL "admm_residual"
+// Calculate the primal and dual residuals, returns 1 if both are within the tolerance
+// and updates the penalty every rho_interval iterations
+template<typename T1>
+int casadi_admm_residual(casadi_admm_data<T1>* d) {
+  // Local variables
+  casadi_int i;
+  T1 n_v, n_z, n_hx, n_aty, n_g, s_prim, s_dual, rho;
+  const casadi_admm_prob<T1>* p = d->prob;
+  // Primal residual [x; A*x] - z
+  casadi_copy(d->x, p->nx, d->v);
+  casadi_fill(d->v + p->nx, p->na, 0.);
+  if (d->a) casadi_mv(d->a, p->sp_a, d->x, d->v + p->nx, 0);
+  d->r_prim = 0;
+  for (i=0; i<p->n; ++i) d->r_prim = fmax(d->r_prim, fabs(d->v[i] - d->z[i]));
+  n_v = casadi_norm_inf(p->n, d->v);
+  n_z = casadi_norm_inf(p->n, d->z);
+  // Dual residual H*x + g + y_x + A'*y_a
+  casadi_fill(d->rz, p->nx, 0.);
+  if (d->h) casadi_mv(d->h, p->sp_h, d->x, d->rz, 0);
+  n_hx = casadi_norm_inf(p->nx, d->rz);
+  casadi_copy(d->y, p->nx, d->xt);
+  if (d->a) casadi_mv(d->a, p->sp_a, d->y + p->nx, d->xt, 1);
+  n_aty = casadi_norm_inf(p->nx, d->xt);
+  casadi_axpy(p->nx, 1., d->xt, d->rz);
+  n_g = 0;
+  if (d->g) {
+    casadi_axpy(p->nx, 1., d->g, d->rz);
+    n_g = casadi_norm_inf(p->nx, d->g);
+  }
+  d->r_dual = casadi_norm_inf(p->nx, d->rz);
+  // Scales of the residuals
+  s_prim = fmax(n_v, n_z);
+  s_dual = fmax(n_hx, fmax(n_aty, n_g));
+  if (d->r_prim <= p->eps_abs + p->eps_rel*s_prim
+      && d->r_dual <= p->eps_abs + p->eps_rel*s_dual) return 1;
+  // Balance the scaled residuals, refactorize only for significant changes
+  if (p->rho_interval>0 && d->iter>0 && d->iter%p->rho_interval==0
+      && d->r_prim>0 && d->r_dual>0 && s_prim>0 && s_dual>0) {
+    rho = d->rho*sqrt((d->r_prim/s_prim)/(d->r_dual/s_dual));
+    rho = fmin(fmax(rho, p->rho_min), p->rho_max);
+    if (rho>5*d->rho || rho<0.2*d->rho) {
+      d->rho = rho;
+      casadi_admm_rho(d);
+      casadi_admm_factor(d);
+    }
+  }
+  return 0;
+}
+
+// SYMBOL "admm_solve"
+// Alternating direction method of multipliers, cf. OSQP, returns 0 if converged and
+// 1 if the maximum number of iterations was reached
+template<typename T1>
+int casadi_admm_solve(casadi_admm_data<T1>* d) {
+  // Local variables
+  casadi_int i;
+  T1 t, zn;
+  const casadi_admm_prob<T1>* p = d->prob;
+  // Start from the projection of the initial guess
+  casadi_copy(d->x, p->nx, d->z);
+  casadi_fill(d->z + p->nx, p->na, 0.);
+  if (d->a) casadi_mv(d->a, p->sp_a, d->x, d->z + p->nx, 0);
+  for (i=0; i<p->n; ++i) d->z[i] = fmin(fmax(d->z[i], d->lb[i]), d->ub[i]);
+  casadi_admm_rho(d);
+  if (!d->factorized) casadi_admm_factor(d);
+  for (d->iter=0; ; ++d->iter) {
+    if (casadi_admm_residual(d)) return 0;
+    if (d->iter>=p->max_iter) return 1;
+    // Solve the KKT system: a single pair of triangular solves
+    for (i=0; i<p->nx; ++i) {
+      d->xt[i] = p->sigma*d->x[i] + d->rho_v[i]*d->z[i] - d->y[i] - (d->g ? d->g[i] : 0);
+    }
+    for (i=p->nx; i<p->n; ++i) d->xt[i] = d->z[i] - d->y[i]/d->rho_v[i];
+    casadi_ldl_solve(d->xt, 1, p->sp_lt, d->lt, d->d, p->perm, d->w);
+    // Values of [x; A*x] implied by the solution
+    casadi_copy(d->xt, p->nx, d->zt);
+    for (i=p->nx; i<p->n; ++i) d->zt[i] = d->z[i] + (d->xt[i] - d->y[i])/d->rho_v[i];
+    // Relaxed updates of the variables, the projection and the multipliers
+    for (i=0; i<p->nx; ++i) d->x[i] = p->alpha*d->xt[i] + (1-p->alpha)*d->x[i];
+    for (i=0; i<p->n; ++i) {
+      t = p->alpha*d->zt[i] + (1-p->alpha)*d->z[i];
+      zn = fmin(fmax(t + d->y[i]/d->rho_v[i], d->lb[i]), d->ub[i]);
+      d->y[i] += d->rho_v[i]*(t - zn);
+      d->z[i] = zn;
+    }
+  }
+}
+
+// SYMBOL "admm_scatter"
+// Get the solution, the objective value and the multipliers
+template<typename T1>
+void casadi_admm_scatter(casadi_admm_data<T1>* d, T1* x, T1* f, T1* lam_a, T1* lam_x) {
+  const casadi_admm_prob<T1>* p = d->prob;
+  if (x) casadi_copy(d->x, p->nx, x);
+  if (f) {
+    *f = d->g ? casadi_dot(p->nx, d->g, d->x) : 0;
+    if (d->h) *f += 0.5*casadi_bilin(d->h, p->sp_h, d->x, d->x);
+  }
+  if (lam_x) casadi_copy(d->y, p->nx, lam_x);
+  if (lam_a) casadi_copy(d->y + p->nx, p->na, lam_a);
+}
@@ -0,0 +1,13 @@
+// NOLINT(legal/copyright)
+// SYMBOL "conv"
+// Full discrete convolution: y <- y + conv(h, x), y of length nh+nx-1
+template<typename T1>
+void casadi_conv(const T1* h, casadi_int nh, const T1* x, casadi_int nx, T1* y) {
+  casadi_int i, j;
+  T1 xj, *yj;
+  for (j=0; j<nx; ++j) {
+    xj = x[j];
+    yj = y + j;
+    for (i=0; i<nh; ++i) yj[i] += h[i]*xj;
+  }
+}
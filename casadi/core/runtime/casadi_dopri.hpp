@@ -0,0 +1,135 @@
+// NOLINT(legal/copyright)
+// SYMBOL "dopri_mem"
+template<typename T1>
+struct casadi_dopri_mem {
+  // Number of states, the first ne of which enter the error estimate
+  casadi_int n, ne;
+  // Error tolerances
+  T1 abstol, reltol;
+  // Step size control
+  T1 h_max, fac_min, fac_max, safety;
+  // Current time and step size
+  T1 t, h;
+  // Current state and stage state, length n
+  T1 *y, *ys;
+  // Stage derivatives, length 7*n
+  T1 *k;
+  // Dense output coefficients of the last accepted step, length 5*n
+  T1 *rc;
+};
+
+// C-REPLACE "casadi_dopri_mem<T1>" "struct casadi_dopri_mem"
+// C-REPLACE "fmax" "casadi_fmax"
+// C-REPLACE "fmin" "casadi_fmin"
+
+// SYMBOL "dopri_h0"
+// Initial step size guess from the state and its derivative k[0], cf. Hairer et al.
+template<typename T1>
+T1 casadi_dopri_h0(const casadi_dopri_mem<T1>* m) {
+  casadi_int i;
+  T1 sc, d0, d1, h;
+  d0 = d1 = 0;
+  for (i=0; i<m->ne; ++i) {
+    sc = m->abstol + m->reltol*fabs(m->y[i]);
+    d0 += (m->y[i]/sc)*(m->y[i]/sc);
+    d1 += (m->k[i]/sc)*(m->k[i]/sc);
+  }
+  if (d0<1e-10*m->ne || d1<1e-10*m->ne) {
+    h = 1e-6;
+  } else {
+    h = 0.01*sqrt(d0/d1);
+  }
+  return fmin(h, m->h_max);
+}
+
+// SYMBOL "dopri_stage"
+// Calculate the state ys of stage s=1,...,6 and return its time, stage 6 is the new state
+template<typename T1>
+T1 casadi_dopri_stage(casadi_dopri_mem<T1>* m, casadi_int s) {
+  static const T1 a[] = {1./5,
+    3./40, 9./40,
+    44./45, -56./15, 32./9,
+    19372./6561, -25360./2187, 64448./6561, -212./729,
+    9017./3168, -355./33, 46732./5247, 49./176, -5103./18656,
+    35./384, 0., 500./1113, 125./192, -2187./6784, 11./84};
+  static const T1 c[] = {0., 1./5, 3./10, 4./5, 8./9, 1., 1.};
+  casadi_int j;
+  const T1* a_s;
+  a_s = a + (s*(s-1))/2;
+  casadi_copy(m->y, m->n, m->ys);
+  for (j=0; j<s; ++j) {
+    if (a_s[j]!=0) casadi_axpy(m->n, m->h*a_s[j], m->k+j*m->n, m->ys);
+  }
+  return m->t + c[s]*m->h;
+}
+
+// SYMBOL "dopri_err"
+// Norm of the embedded error estimate, the step is accepted if it is less than one
+template<typename T1>
+T1 casadi_dopri_err(const casadi_dopri_mem<T1>* m) {
+  static const T1 e[] = {71./57600, 0., -71./16695, 71./1920, -17253./339200,
+    22./525, -1./40};
+  casadi_int i, j;
+  T1 r, sc, err;
+  if (m->ne==0) return 0;
+  err = 0;
+  for (i=0; i<m->ne; ++i) {
+    r = 0;
+    for (j=0; j<7; ++j) r += e[j]*m->k[i+j*m->n];
+    sc = m->abstol + m->reltol*fmax(fabs(m->y[i]), fabs(m->ys[i]));
+    r *= m->h/sc;
+    err += r*r;
+  }
+  return sqrt(err/m->ne);
+}
+
+// SYMBOL "dopri_fac"
+// Factor by which to change the step size after a step with error norm err
+template<typename T1>
+T1 casadi_dopri_fac(const casadi_dopri_mem<T1>* m, T1 err) {
+  T1 fac;
+  fac = err>0 ? m->safety*pow(err, -0.2) : m->fac_max;
+  fac = fmax(m->fac_min, fmin(fac, m->fac_max));
+  // Never increase the step size after a rejected step
+  if (err>1) fac = fmin(fac, 1.);
+  return fac;
+}
+
+// SYMBOL "dopri_accept"
+// Accept the step: form the dense output, advance time and state, reuse the last stage
+template<typename T1>
+void casadi_dopri_accept(casadi_dopri_mem<T1>* m) {
+  static const T1 d[] = {-12715105075./11282082432, 0., 87487479700./32700410799,
+    -10690763975./1880347072, 701980252875./199316789632, -1453857185./822651844,
+    69997945./29380423};
+  casadi_int i, j, n;
+  T1 ydiff, bspl, r;
+  n = m->n;
+  for (i=0; i<n; ++i) {
+    ydiff = m->ys[i] - m->y[i];
+    bspl = m->h*m->k[i] - ydiff;
+    r = 0;
+    for (j=0; j<7; ++j) r += d[j]*m->k[i+j*n];
+    m->rc[i] = m->y[i];
+    m->rc[i+n] = ydiff;
+    m->rc[i+2*n] = bspl;
+    m->rc[i+3*n] = ydiff - m->h*m->k[i+6*n] - bspl;
+    m->rc[i+4*n] = m->h*r;
+  }
+  casadi_copy(m->ys, n, m->y);
+  casadi_copy(m->k+6*n, n, m->k);
+  m->t += m->h;
+}
+
+// SYMBOL "dopri_interp"
+// Evaluate the dense output at the fraction theta of a step, rc as in casadi_dopri_mem
+template<typename T1>
+void casadi_dopri_interp(casadi_int n, const T1* rc, T1 theta, T1* y) {
+  casadi_int i;
+  T1 theta1;
+  theta1 = 1-theta;
+  for (i=0; i<n; ++i) {
+    y[i] = rc[i] + theta*(rc[i+n] + theta1*(rc[i+2*n] + theta*(rc[i+3*n]
+      + theta1*rc[i+4*n])));
+  }
+}
@@ -3,7 +3,15 @@
 template<typename T1>
 T1 casadi_dot(casadi_int n, const T1* x, const T1* y) {
   casadi_int i;
-  T1 r = 0;
-  for (i=0; i<n; ++i) r += *x++ * *y++;
-  return r;
+  T1 r0, r1, r2, r3;
+  r0 = r1 = r2 = r3 = 0;
+  // Independent partial sums break the dependency chain and let the compiler vectorize
+  for (i=0; i+4<=n; i+=4) {
+    r0 += x[i]*y[i];
+    r1 += x[i+1]*y[i+1];
+    r2 += x[i+2]*y[i+2];
+    r3 += x[i+3]*y[i+3];
+  }
+  for (; i<n; ++i) r0 += x[i]*y[i];
+  return (r0+r1) + (r2+r3);
 }
@@ -0,0 +1,104 @@
+// NOLINT(legal/copyright)
+
+// SYMBOL "dple_mul"
+// y <- y + a*x*a', all n-by-n column-major with x symmetric, w of length n*n
+template<typename T1>
+void casadi_dple_mul(casadi_int n, const T1* a, const T1* x, T1* y, T1* w) {
+  casadi_int i, j, k;
+  T1 c;
+  // w <- a*x, which equals (x*a')' for symmetric x
+  casadi_fill(w, n*n, 0.);
+  casadi_mtimes_dense(a, n, n, x, n, w);
+  // y <- y + w*a'
+  for (j=0; j<n; ++j) {
+    for (k=0; k<n; ++k) {
+      c = a[j+k*n];
+      for (i=0; i<n; ++i) y[i+j*n] += w[i+k*n]*c;
+    }
+  }
+}
+
+// SYMBOL "dple_sym"
+// y <- y + (x+x')/2, n-by-n column-major
+template<typename T1>
+void casadi_dple_sym(casadi_int n, const T1* x, T1* y) {
+  casadi_int i, j;
+  for (j=0; j<n; ++j) {
+    for (i=0; i<n; ++i) y[i+j*n] += 0.5*(x[i+j*n] + x[j+i*n]);
+  }
+}
+
+// SYMBOL "dple"
+// Solve the discrete periodic Lyapunov equations
+//   P_(k+1) = A_k*P_k*A_k' + V_k, k=0..K-1, with P_K = P_0,
+// for nrhs right-hand sides. a holds the K dense n-by-n blocks A_k, v and p hold nrhs times
+// K blocks, V_k is symmetrized. The periodic solution P_0 is found from the lifted equation
+// P_0 = F*P_0*F' + S, with F = A_(K-1)*...*A_0 the monodromy matrix, which is solved by
+// doubling: S <- S + F*S*F', F <- F*F. The squarings of F are shared among the right-hand
+// sides. w has length 3*n*n. Returns 1 if the iteration diverges or has not converged after
+// max_iter squarings, i.e. if the system is unstable.
+template<typename T1>
+int casadi_dple(casadi_int n, casadi_int K, casadi_int nrhs, const T1* a, const T1* v, T1* p,
+                casadi_int max_iter, T1 tol, casadi_int* iter, T1* w) {
+  // Local variables
+  casadi_int nn, k, r, i, converged;
+  T1 *f, *t, *w1, *p0, nrm_t, nrm_s;
+  nn = n*n;
+  // Work vectors
+  f = w; w += nn;
+  t = w; w += nn;
+  w1 = w;
+  // Monodromy matrix
+  casadi_fill(f, nn, 0.);
+  for (i=0; i<n; ++i) f[i+i*n] = 1.;
+  for (k=0; k<K; ++k) {
+    casadi_fill(t, nn, 0.);
+    casadi_mtimes_dense(a+k*nn, n, n, f, n, t);
+    casadi_copy(t, nn, f);
+  }
+  // S: P_0 obtained by propagating P_0 = 0 over one period, stored in place of P_0
+  for (r=0; r<nrhs; ++r) {
+    p0 = p + r*K*nn;
+    casadi_fill(p0, nn, 0.);
+    for (k=0; k<K; ++k) {
+      casadi_fill(t, nn, 0.);
+      casadi_dple_mul(n, a+k*nn, p0, t, w1);
+      casadi_dple_sym(n, v+(r*K+k)*nn, t);
+      casadi_copy(t, nn, p0);
+    }
+  }
+  // Doubling iterations
+  for (*iter=0; ; ++*iter) {
+    converged = 1;
+    for (r=0; r<nrhs; ++r) {
+      p0 = p + r*K*nn;
+      casadi_fill(t, nn, 0.);
+      casadi_dple_mul(n, f, p0, t, w1);
+      casadi_axpy(nn, 1., t, p0);
+      // Squared Frobenius norms, which propagate inf and nan
+      nrm_t = casadi_dot(nn, t, t);
+      nrm_s = casadi_dot(nn, p0, p0);
+      if (nrm_s-nrm_s != 0) return 1;
+      if (nrm_t > tol*tol*(1+nrm_s)) converged = 0;
+    }
+    if (converged) break;
+    if (*iter==max_iter) return 1;
+    // F <- F*F
+    casadi_fill(t, nn, 0.);
+    casadi_mtimes_dense(f, n, n, f, n, t);
+    casadi_copy(t, nn, f);
+  }
+  // Propagate the periodic solution over the period
+  for (r=0; r<nrhs; ++r) {
+    p0 = p + r*K*nn;
+    casadi_copy(p0, nn, t);
+    casadi_fill(p0, nn, 0.);
+    casadi_dple_sym(n, t, p0);
+    for (k=0; k+1<K; ++k) {
+      casadi_fill(p0+(k+1)*nn, nn, 0.);
+      casadi_dple_mul(n, a+k*nn, p0+k*nn, p0+(k+1)*nn, w1);
+      casadi_dple_sym(n, v+(r*K+k)*nn, p0+(k+1)*nn);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,122 @@
+// NOLINT(legal/copyright)
+
+// SYMBOL "expm_lincomb"
+// y <- c0*x0 + c1*x1 + c2*x2 + c3*I, all n-by-n column-major
+template<typename T1>
+void casadi_expm_lincomb(casadi_int n, T1 c0, const T1* x0, T1 c1, const T1* x1,
+                         T1 c2, const T1* x2, T1 c3, T1* y) {
+  casadi_int i;
+  for (i=0; i<n*n; ++i) y[i] = c0*x0[i] + c1*x1[i] + c2*x2[i];
+  for (i=0; i<n; ++i) y[i+i*n] += c3;
+}
+
+// SYMBOL "expm_solve"
+// x <- q\x by Gaussian elimination with partial pivoting, overwriting q, both n-by-n
+// column-major. Returns 1 if q is singular.
+template<typename T1>
+int casadi_expm_solve(casadi_int n, T1* q, T1* x) {
+  casadi_int i, j, k, p;
+  T1 l, s;
+  for (k=0; k<n; ++k) {
+    // Pivot
+    p = k;
+    for (i=k+1; i<n; ++i) if (fabs(q[i+k*n]) > fabs(q[p+k*n])) p = i;
+    if (q[p+k*n]==0) return 1;
+    if (p!=k) {
+      for (j=0; j<n; ++j) {
+        s = q[k+j*n]; q[k+j*n] = q[p+j*n]; q[p+j*n] = s;
+        s = x[k+j*n]; x[k+j*n] = x[p+j*n]; x[p+j*n] = s;
+      }
+    }
+    // Eliminate
+    for (i=k+1; i<n; ++i) {
+      l = q[i+k*n] /= q[k+k*n];
+      for (j=k+1; j<n; ++j) q[i+j*n] -= l*q[k+j*n];
+      for (j=0; j<n; ++j) x[i+j*n] -= l*x[k+j*n];
+    }
+  }
+  // Back substitution
+  for (j=0; j<n; ++j) {
+    for (i=n-1; i>=0; --i) {
+      s = x[i+j*n];
+      for (k=i+1; k<n; ++k) s -= q[i+k*n]*x[k+j*n];
+      x[i+j*n] = s/q[i+i*n];
+    }
+  }
+  return 0;
+}
+
+// SYMBOL "expm"
+// r <- expm(a*t) for a dense n-by-n column-major matrix a, using the degree 13 Pade
+// approximant with scaling and squaring (Higham, 2005). w has length 7*n*n.
+// Returns 1 if the denominator of the Pade approximant is singular.
+template<typename T1>
+int casadi_expm(casadi_int n, const T1* a, T1 t, T1* r, T1* w) {
+  // Local variables
+  casadi_int nn, i, j, s;
+  T1 *as, *a2, *a4, *a6, *u, *v, *tmp, nrm, c;
+  // Pade coefficients
+  const T1 b[] = {64764752532480000., 32382376266240000., 7771770303897600.,
+    1187353796428800., 129060195264000., 10559470521600., 670442572800., 33522128640.,
+    1323241920., 40840800., 960960., 16380., 182., 1.};
+  nn = n*n;
+  // Work vectors
+  as = w; w += nn;
+  a2 = w; w += nn;
+  a4 = w; w += nn;
+  a6 = w; w += nn;
+  u = w; w += nn;
+  v = w; w += nn;
+  tmp = w;
+  // 1-norm of a*t
+  nrm = 0;
+  for (j=0; j<n; ++j) {
+    c = 0;
+    for (i=0; i<n; ++i) c += fabs(a[i+j*n]);
+    if (c > nrm) nrm = c;
+  }
+  nrm *= fabs(t);
+  // Scaling such that the 1-norm is below theta_13
+  s = 0;
+  c = t;
+  while (nrm > 5.371920351148152) {
+    nrm /= 2;
+    c /= 2;
+    s++;
+  }
+  for (i=0; i<nn; ++i) as[i] = c*a[i];
+  // Powers of the scaled matrix
+  casadi_fill(a2, nn, 0.);
+  casadi_mtimes_dense(as, n, n, as, n, a2);
+  casadi_fill(a4, nn, 0.);
+  casadi_mtimes_dense(a2, n, n, a2, n, a4);
+  casadi_fill(a6, nn, 0.);
+  casadi_mtimes_dense(a4, n, n, a2, n, a6);
+  // Odd part U
+  casadi_expm_lincomb(n, b[13], a6, b[11], a4, b[9], a2, 0., tmp);
+  casadi_fill(u, nn, 0.);
+  casadi_mtimes_dense(a6, n, n, tmp, n, u);
+  casadi_expm_lincomb(n, b[7], a6, b[5], a4, b[3], a2, b[1], tmp);
+  casadi_axpy(nn, 1., tmp, u);
+  casadi_fill(tmp, nn, 0.);
+  casadi_mtimes_dense(as, n, n, u, n, tmp);
+  // Even part V
+  casadi_expm_lincomb(n, b[12], a6, b[10], a4, b[8], a2, 0., as);
+  casadi_fill(v, nn, 0.);
+  casadi_mtimes_dense(a6, n, n, as, n, v);
+  casadi_expm_lincomb(n, b[6], a6, b[4], a4, b[2], a2, b[0], as);
+  casadi_axpy(nn, 1., as, v);
+  // Solve (V-U)*R = V+U
+  for (i=0; i<nn; ++i) {
+    r[i] = v[i] + tmp[i];
+    v[i] -= tmp[i];
+  }
+  if (casadi_expm_solve(n, v, r)) return 1;
+  // Undo the scaling by repeated squaring
+  for (; s>0; --s) {
+    casadi_fill(tmp, nn, 0.);
+    casadi_mtimes_dense(r, n, n, r, n, tmp);
+    casadi_copy(tmp, nn, r);
+  }
+  return 0;
+}
@@ -0,0 +1,83 @@
+// NOLINT(legal/copyright)
+// SYMBOL "gmres_mem"
+template<typename T1>
+struct casadi_gmres_mem {
+  // Dimension and maximum number of Krylov vectors per cycle
+  casadi_int n, m;
+  // Krylov basis, n-by-(m+1), column-major
+  T1* v;
+  // Hessenberg matrix, triangularized by Givens rotations, (m+1)-by-m
+  T1* h;
+  // Givens rotations, length m
+  T1 *c, *s;
+  // Rotated right-hand side, length m+1, |g[j]| is the residual norm after j steps
+  T1* g;
+};
+// C-REPLACE "casadi_gmres_mem<T1>" "struct casadi_gmres_mem"
+
+// SYMBOL "gmres_start"
+// Start a cycle with the residual stored in the first Krylov vector, returns its norm
+template<typename T1>
+T1 casadi_gmres_start(casadi_gmres_mem<T1>* m) {
+  T1 beta;
+  beta = casadi_norm_2(m->n, m->v);
+  if (beta>0) casadi_scal(m->n, 1./beta, m->v);
+  m->g[0] = beta;
+  return beta;
+}
+
+// SYMBOL "gmres_arnoldi"
+// Step j of a cycle: orthogonalize A times Krylov vector j, stored in Krylov vector j+1,
+// returns the norm of the residual after j+1 steps
+template<typename T1>
+T1 casadi_gmres_arnoldi(casadi_gmres_mem<T1>* m, casadi_int j) {
+  casadi_int i, n;
+  T1 *w, *hj, t, r;
+  n = m->n;
+  w = m->v + (j+1)*n;
+  hj = m->h + j*(m->m+1);
+  // Modified Gram-Schmidt
+  for (i=0; i<=j; ++i) {
+    hj[i] = casadi_dot(n, w, m->v + i*n);
+    casadi_axpy(n, -hj[i], m->v + i*n, w);
+  }
+  hj[j+1] = casadi_norm_2(n, w);
+  if (hj[j+1]>0) casadi_scal(n, 1./hj[j+1], w);
+  // Apply the previous rotations to the new column
+  for (i=0; i<j; ++i) {
+    t = m->c[i]*hj[i] + m->s[i]*hj[i+1];
+    hj[i+1] = m->c[i]*hj[i+1] - m->s[i]*hj[i];
+    hj[i] = t;
+  }
+  // New rotation, eliminating the subdiagonal entry
+  r = sqrt(hj[j]*hj[j] + hj[j+1]*hj[j+1]);
+  if (r==0) {
+    m->c[j] = 1;
+    m->s[j] = 0;
+  } else {
+    m->c[j] = hj[j]/r;
+    m->s[j] = hj[j+1]/r;
+  }
+  hj[j] = r;
+  hj[j+1] = 0;
+  m->g[j+1] = -m->s[j]*m->g[j];
+  m->g[j] *= m->c[j];
+  return fabs(m->g[j+1]);
+}
+
+// SYMBOL "gmres_update"
+// Minimize the residual over the first k Krylov vectors, the correction is stored in z
+template<typename T1>
+void casadi_gmres_update(casadi_gmres_mem<T1>* m, casadi_int k, T1* z) {
+  casadi_int i, j, ldh;
+  T1 d;
+  ldh = m->m+1;
+  // Back substitution, overwriting g with the coefficients
+  for (i=k-1; i>=0; --i) {
+    for (j=i+1; j<k; ++j) m->g[i] -= m->h[i+j*ldh]*m->g[j];
+    d = m->h[i+i*ldh];
+    m->g[i] = d==0 ? 0 : m->g[i]/d;
+  }
+  casadi_fill(z, m->n, 0.);
+  for (i=0; i<k; ++i) casadi_axpy(m->n, m->g[i], m->v + i*m->n, z);
+}
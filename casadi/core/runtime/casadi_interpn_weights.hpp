@@ -2,19 +2,22 @@
 // SYMBOL "interpn_weights"
 template<typename T1>
 void casadi_interpn_weights(casadi_int ndim, const T1* grid, const casadi_int* offset, const T1* x, T1* alpha, casadi_int* index, const casadi_int* lookup_mode) { // NOLINT(whitespace/line_length)
-  // Left index and fraction of interval
+  // Left index and fraction of interval, the previous index is used as a hint, tables for
+  // lookup mode 4 are stored after the lookup modes at lookup_mode[ndim+i]
   casadi_int i;
   for (i=0; i<ndim; ++i) {
     casadi_int ng, j;
     T1 xi;
     const T1* g;
+    const casadi_int* table;
     // Grid point
     xi = x ? x[i] : 0;
     // Grid
     g = grid + offset[i];
     ng = offset[i+1]-offset[i];
     // Find left index
-    j = index[i] = casadi_low(xi, g, ng, lookup_mode[i]);
+    table = lookup_mode[i]==4 ? lookup_mode + lookup_mode[ndim+i] : 0;
+    j = index[i] = casadi_low(xi, g, ng, lookup_mode[i], table, index[i]);
     // Get interpolation/extrapolation alpha
     alpha[i] = (xi-g[j])/(g[j+1]-g[j]);
   }
@@ -0,0 +1,450 @@
+// NOLINT(legal/copyright)
+
+// C-REPLACE "fmin" "casadi_fmin"
+// C-REPLACE "fmax" "casadi_fmax"
+
+// SYMBOL "ipqp_prob"
+template<typename T1>
+struct casadi_ipqp_prob {
+  // Number of variables, constraints and their sum
+  casadi_int nx, na, n;
+  // Sparsity patterns of H and A
+  const casadi_int *sp_h, *sp_a;
+  // KKT matrix [H, A'; A, 0] with the diagonal, its transposed L factor and ordering
+  const casadi_int *sp_kkt, *sp_lt, *perm;
+  // Locations in the KKT matrix of the nonzeros of H, A, A' and of the diagonal
+  const casadi_int *kkt_h, *kkt_a, *kkt_at, *kkt_d;
+  // Maximum number of iterations
+  casadi_int max_iter;
+  // Tolerance, static regularization, infinity
+  T1 tol, reg, inf;
+};
+// C-REPLACE "casadi_ipqp_prob<T1>" "struct casadi_ipqp_prob"
+
+// SYMBOL "ipqp_data"
+template<typename T1>
+struct casadi_ipqp_data {
+  // Problem structure
+  const casadi_ipqp_prob<T1>* prob;
+  // Type of each variable and constraint: 0 free, 1 inequality, 2 equality
+  casadi_int *type;
+  // Problem data
+  const T1 *h, *g, *a;
+  // Bounds of the variables followed by the constraints
+  T1 *lb, *ub;
+  // Primal-dual iterate: variables, multipliers, slacks, bound multipliers
+  T1 *z, *lam, *sl, *su, *ll, *lu;
+  // Newton step, the first nx entries for the variables, the rest for the multipliers
+  // of the constraints
+  T1 *dz, *dsl, *dsu, *dll, *dlu;
+  // Residuals: stationarity, lower and upper bounds (or equality constraint violation)
+  T1 *rz, *rl, *ru;
+  // Complementarity right-hand sides, barrier terms, values [z; A*z] and [dz; A*dz]
+  T1 *cl, *cu, *sig, *q, *v, *dv;
+  // KKT matrix, its factorization, right-hand side, residual and work
+  T1 *kkt, *lt, *d, *rhs, *r, *w;
+  // Iteration counter
+  casadi_int iter;
+  // Duality measure, largest residual
+  T1 mu, err;
+};
+// C-REPLACE "casadi_ipqp_data<T1>" "struct casadi_ipqp_data"
+
+// SYMBOL "ipqp_work"
+template<typename T1>
+void casadi_ipqp_work(const casadi_ipqp_prob<T1>* p, casadi_int* sz_iw, casadi_int* sz_w) {
+  *sz_iw = p->n; // type
+  *sz_w = 2*p->n; // lb, ub
+  *sz_w += 2*p->nx + 5*p->n; // z, rz, lam, sl, su, ll, lu
+  *sz_w += 5*p->n; // dz, dsl, dsu, dll, dlu
+  *sz_w += 2*p->n; // rl, ru
+  *sz_w += 6*p->n; // cl, cu, sig, q, v, dv
+  *sz_w += p->sp_kkt[2+p->n] + p->sp_lt[2+p->n] + 4*p->n; // kkt, lt, d, rhs, r, w
+}
+
+// SYMBOL "ipqp_init"
+template<typename T1>
+void casadi_ipqp_init(casadi_ipqp_data<T1>* d, casadi_int* iw, T1* w) {
+  const casadi_ipqp_prob<T1>* p = d->prob;
+  d->type = iw;
+  d->lb = w; w += p->n;
+  d->ub = w; w += p->n;
+  d->z = w; w += p->nx;
+  d->rz = w; w += p->nx;
+  d->lam = w; w += p->n;
+  d->sl = w; w += p->n;
+  d->su = w; w += p->n;
+  d->ll = w; w += p->n;
+  d->lu = w; w += p->n;
+  d->dz = w; w += p->n;
+  d->dsl = w; w += p->n;
+  d->dsu = w; w += p->n;
+  d->dll = w; w += p->n;
+  d->dlu = w; w += p->n;
+  d->rl = w; w += p->n;
+  d->ru = w; w += p->n;
+  d->cl = w; w += p->n;
+  d->cu = w; w += p->n;
+  d->sig = w; w += p->n;
+  d->q = w; w += p->n;
+  d->v = w; w += p->n;
+  d->dv = w; w += p->n;
+  d->kkt = w; w += p->sp_kkt[2+p->n];
+  d->lt = w; w += p->sp_lt[2+p->n];
+  d->d = w; w += p->n;
+  d->rhs = w; w += p->n;
+  d->r = w; w += p->n;
+  d->w = w;
+}
+
+// SYMBOL "ipqp_setup"
+// Pass the QP data and classify the bounds, returns 1 if some lower bound exceeds
+// the corresponding upper bound
+template<typename T1>
+int casadi_ipqp_setup(casadi_ipqp_data<T1>* d, const T1* h, const T1* g, const T1* a,
+                      const T1* lba, const T1* uba, const T1* lbx, const T1* ubx) {
+  // Local variables
+  casadi_int i;
+  const casadi_ipqp_prob<T1>* p = d->prob;
+  d->h = h;
+  d->g = g;
+  d->a = a;
+  for (i=0; i<p->nx; ++i) {
+    d->lb[i] = lbx ? lbx[i] : 0;
+    d->ub[i] = ubx ? ubx[i] : 0;
+  }
+  for (i=0; i<p->na; ++i) {
+    d->lb[p->nx+i] = lba ? lba[i] : 0;
+    d->ub[p->nx+i] = uba ? uba[i] : 0;
+  }
+  for (i=0; i<p->n; ++i) {
+    if (d->lb[i] > d->ub[i]) return 1;
+    if (d->lb[i]==d->ub[i]) {
+      d->type[i] = 2;
+    } else if (d->lb[i] > -p->inf || d->ub[i] < p->inf) {
+      d->type[i] = 1;
+    } else {
+      d->type[i] = 0;
+    }
+  }
+  return 0;
+}
+
+// SYMBOL "ipqp_residual"
+// Calculate the multipliers and the residuals of the perturbed KKT conditions
+template<typename T1>
+void casadi_ipqp_residual(casadi_ipqp_data<T1>* d) {
+  // Local variables
+  casadi_int i, nfin;
+  T1 r;
+  const casadi_ipqp_prob<T1>* p = d->prob;
+  // Values [z; A*z]
+  casadi_copy(d->z, p->nx, d->v);
+  casadi_fill(d->v + p->nx, p->na, 0.);
+  if (d->a) casadi_mv(d->a, p->sp_a, d->z, d->v + p->nx, 0);
+  // Multipliers of the inequalities and the free constraints
+  for (i=0; i<p->n; ++i) {
+    if (d->type[i]==1) {
+      d->lam[i] = d->lu[i] - d->ll[i];
+    } else if (d->type[i]==0) {
+      d->lam[i] = 0;
+    }
+  }
+  // Stationarity: H*z + g + lam_x + A'*lam_a, the multipliers of the fixed
+  // variables are chosen to satisfy it exactly
+  casadi_fill(d->rz, p->nx, 0.);
+  if (d->g) casadi_copy(d->g, p->nx, d->rz);
+  if (d->h) casadi_mv(d->h, p->sp_h, d->z, d->rz, 0);
+  if (d->a) casadi_mv(d->a, p->sp_a, d->lam + p->nx, d->rz, 1);
+  for (i=0; i<p->nx; ++i) {
+    if (d->type[i]==2) {
+      d->lam[i] = -d->rz[i];
+      d->rz[i] = 0;
+    } else {
+      d->rz[i] += d->lam[i];
+    }
+  }
+  // Bounds, equality constraints, duality measure
+  d->mu = 0;
+  nfin = 0;
+  for (i=0; i<p->n; ++i) {
+    d->rl[i] = d->ru[i] = 0;
+    if (d->type[i]==1) {
+      if (d->lb[i] > -p->inf) {
+        d->rl[i] = d->v[i] - d->lb[i] - d->sl[i];
+        d->mu += d->sl[i]*d->ll[i];
+        nfin++;
+      }
+      if (d->ub[i] < p->inf) {
+        d->ru[i] = d->ub[i] - d->v[i] - d->su[i];
+        d->mu += d->su[i]*d->lu[i];
+        nfin++;
+      }
+    } else if (d->type[i]==2 && i>=p->nx) {
+      d->rl[i] = d->v[i] - d->lb[i];
+    }
+  }
+  if (nfin>0) d->mu /= nfin;
+  // Largest residual
+  d->err = 0;
+  for (i=0; i<p->nx; ++i) d->err = fmax(d->err, fabs(d->rz[i]));
+  for (i=0; i<p->n; ++i) {
+    r = fmax(fabs(d->rl[i]), fabs(d->ru[i]));
+    d->err = fmax(d->err, r);
+  }
+}
+
+// SYMBOL "ipqp_factor"
+// Assemble and factorize the regularized KKT matrix
+// [H + diag(sig_x), A'; A, -diag(1/sig_a)], with the rows and columns of the
+// fixed variables and the free constraints decoupled,
+// returns 1 if the factorization broke down
+template<typename T1>
+int casadi_ipqp_factor(casadi_ipqp_data<T1>* d) {
+  // Local variables
+  casadi_int i, c, r, k;
+  const casadi_int *colind, *row;
+  const casadi_ipqp_prob<T1>* p = d->prob;
+  casadi_fill(d->kkt, p->sp_kkt[2+p->n], 0.);
+  // Hessian
+  if (d->h) {
+    colind = p->sp_h+2; row = p->sp_h+2+p->nx+1;
+    for (c=0; c<p->nx; ++c) {
+      if (d->type[c]==2) continue;
+      for (k=colind[c]; k<colind[c+1]; ++k) {
+        r = row[k];
+        if (d->type[r]!=2) d->kkt[p->kkt_h[k]] = d->h[k];
+      }
+    }
+  }
+  // Constraint Jacobian and its transpose
+  if (d->a) {
+    colind = p->sp_a+2; row = p->sp_a+2+p->nx+1;
+    for (c=0; c<p->nx; ++c) {
+      if (d->type[c]==2) continue;
+      for (k=colind[c]; k<colind[c+1]; ++k) {
+        r = row[k];
+        if (d->type[p->nx+r]!=0) d->kkt[p->kkt_a[k]] = d->kkt[p->kkt_at[k]] = d->a[k];
+      }
+    }
+  }
+  // Diagonal
+  for (i=0; i<p->nx; ++i) {
+    if (d->type[i]==2) {
+      d->kkt[p->kkt_d[i]] = 1;
+    } else {
+      d->kkt[p->kkt_d[i]] += d->sig[i] + p->reg;
+    }
+  }
+  for (i=p->nx; i<p->n; ++i) {
+    if (d->type[i]==1) {
+      d->kkt[p->kkt_d[i]] = -1/d->sig[i] - p->reg;
+    } else if (d->type[i]==2) {
+      d->kkt[p->kkt_d[i]] = -p->reg;
+    } else {
+      d->kkt[p->kkt_d[i]] = -1;
+    }
+  }
+  // Sparse LDL^T factorization with the fixed symbolic factorization
+  casadi_ldl(p->sp_kkt, d->kkt, p->sp_lt, d->lt, d->d, p->perm, d->w);
+  for (i=0; i<p->n; ++i) {
+    if (d->d[i]==0 || d->d[i]!=d->d[i]) return 1;
+  }
+  return 0;
+}
+
+// SYMBOL "ipqp_kkt"
+// Solve the KKT system with the right-hand side rhs for dz, refining the solution of
+// the regularized system iteratively to remove the effect of the regularization
+template<typename T1>
+void casadi_ipqp_kkt(casadi_ipqp_data<T1>* d) {
+  // Local variables
+  casadi_int i, k;
+  T1 e, e0;
+  const casadi_ipqp_prob<T1>* p = d->prob;
+  casadi_copy(d->rhs, p->n, d->dz);
+  casadi_ldl_solve(d->dz, 1, p->sp_lt, d->lt, d->d, p->perm, d->w);
+  e0 = p->inf;
+  for (k=0; k<10; ++k) {
+    // Residual r = rhs - K*dz, with K the KKT matrix without regularization
+    casadi_copy(d->rhs, p->n, d->r);
+    for (i=0; i<p->n; ++i) d->r[i] = -d->r[i];
+    casadi_mv(d->kkt, p->sp_kkt, d->dz, d->r, 0);
+    for (i=0; i<p->n; ++i) {
+      if (i<p->nx ? d->type[i]!=2 : d->type[i]!=0) {
+        d->r[i] -= (i<p->nx ? p->reg : -p->reg)*d->dz[i];
+      }
+      d->r[i] = -d->r[i];
+    }
+    // Stop when the residual no longer decreases
+    e = casadi_norm_inf(p->n, d->r);
+    if (e==0 || e>=0.5*e0) break;
+    e0 = e;
+    casadi_ldl_solve(d->r, 1, p->sp_lt, d->lt, d->d, p->perm, d->w);
+    casadi_axpy(p->n, 1., d->r, d->dz);
+  }
+}
+
+// SYMBOL "ipqp_newton"
+// Newton step for the complementarity target smu, with Mehrotra's correction if corr
+template<typename T1>
+void casadi_ipqp_newton(casadi_ipqp_data<T1>* d, T1 smu, int corr) {
+  // Local variables
+  casadi_int i;
+  const casadi_ipqp_prob<T1>* p = d->prob;
+  for (i=0; i<p->n; ++i) {
+    d->cl[i] = d->cu[i] = d->q[i] = 0;
+    if (d->type[i]!=1) continue;
+    if (d->lb[i] > -p->inf) {
+      d->cl[i] = smu - d->sl[i]*d->ll[i] - (corr ? d->dsl[i]*d->dll[i] : 0);
+      d->q[i] -= (d->cl[i] - d->ll[i]*d->rl[i])/d->sl[i];
+    }
+    if (d->ub[i] < p->inf) {
+      d->cu[i] = smu - d->su[i]*d->lu[i] - (corr ? d->dsu[i]*d->dlu[i] : 0);
+      d->q[i] += (d->cu[i] - d->lu[i]*d->ru[i])/d->su[i];
+    }
+  }
+  // Right-hand side of the KKT system
+  for (i=0; i<p->nx; ++i) d->rhs[i] = d->type[i]==2 ? 0 : -d->rz[i] - d->q[i];
+  for (i=p->nx; i<p->n; ++i) {
+    if (d->type[i]==1) {
+      d->rhs[i] = -d->q[i]/d->sig[i];
+    } else if (d->type[i]==2) {
+      d->rhs[i] = -d->rl[i];
+    } else {
+      d->rhs[i] = 0;
+    }
+  }
+  casadi_ipqp_kkt(d);
+  // Recover the slacks and bound multipliers
+  casadi_copy(d->dz, p->nx, d->dv);
+  casadi_fill(d->dv + p->nx, p->na, 0.);
+  if (d->a) casadi_mv(d->a, p->sp_a, d->dz, d->dv + p->nx, 0);
+  for (i=0; i<p->n; ++i) {
+    d->dsl[i] = d->dll[i] = d->dsu[i] = d->dlu[i] = 0;
+    if (d->type[i]!=1) continue;
+    if (d->lb[i] > -p->inf) {
+      d->dsl[i] = d->dv[i] + d->rl[i];
+      d->dll[i] = (d->cl[i] - d->ll[i]*d->dsl[i])/d->sl[i];
+    }
+    if (d->ub[i] < p->inf) {
+      d->dsu[i] = d->ru[i] - d->dv[i];
+      d->dlu[i] = (d->cu[i] - d->lu[i]*d->dsu[i])/d->su[i];
+    }
+  }
+}
+
+// SYMBOL "ipqp_maxstep"
+// Largest step, at most one, keeping the slacks and multipliers positive, scaled by tau
+template<typename T1>
+T1 casadi_ipqp_maxstep(casadi_ipqp_data<T1>* d, T1 tau) {
+  // Local variables
+  casadi_int i;
+  T1 alpha;
+  const casadi_ipqp_prob<T1>* p = d->prob;
+  alpha = 1;
+  for (i=0; i<p->n; ++i) {
+    if (d->dsl[i]<0) alpha = fmin(alpha, -tau*d->sl[i]/d->dsl[i]);
+    if (d->dll[i]<0) alpha = fmin(alpha, -tau*d->ll[i]/d->dll[i]);
+    if (d->dsu[i]<0) alpha = fmin(alpha, -tau*d->su[i]/d->dsu[i]);
+    if (d->dlu[i]<0) alpha = fmin(alpha, -tau*d->lu[i]/d->dlu[i]);
+  }
+  return alpha;
+}
+
+// SYMBOL "ipqp_solve"
+// Mehrotra predictor-corrector interior point method, returns 0 if converged,
+// 1 if the maximum number of iterations was reached and 2 if the factorization failed
+template<typename T1>
+int casadi_ipqp_solve(casadi_ipqp_data<T1>* d) {
+  // Local variables
+  casadi_int i, nfin;
+  T1 alpha, mu_aff, sigma, thr;
+  const casadi_ipqp_prob<T1>* p = d->prob;
+  // Starting point: zero projected on the bounds shrunk by thr, or the midpoint of
+  // narrower boxes, with all slacks at least thr
+  thr = 0.1;
+  for (i=0; i<p->nx; ++i) {
+    if (d->ub[i]-d->lb[i] < 2*thr) {
+      d->z[i] = 0.5*(d->lb[i]+d->ub[i]);
+    } else {
+      d->z[i] = fmin(fmax(0., d->lb[i]+thr), d->ub[i]-thr);
+    }
+  }
+  casadi_fill(d->lam, p->n, 0.);
+  casadi_copy(d->z, p->nx, d->v);
+  casadi_fill(d->v + p->nx, p->na, 0.);
+  if (d->a) casadi_mv(d->a, p->sp_a, d->z, d->v + p->nx, 0);
+  for (i=0; i<p->n; ++i) {
+    d->sl[i] = d->ll[i] = d->su[i] = d->lu[i] = 0;
+    d->dsl[i] = d->dll[i] = d->dsu[i] = d->dlu[i] = 0;
+    if (d->type[i]!=1) continue;
+    if (d->lb[i] > -p->inf) {
+      d->sl[i] = fmax(thr, d->v[i] - d->lb[i]);
+      d->ll[i] = 1;
+    }
+    if (d->ub[i] < p->inf) {
+      d->su[i] = fmax(thr, d->ub[i] - d->v[i]);
+      d->lu[i] = 1;
+    }
+  }
+  for (d->iter=0; ; ++d->iter) {
+    casadi_ipqp_residual(d);
+    if (d->err<=p->tol && d->mu<=p->tol) return 0;
+    if (d->iter>=p->max_iter) return 1;
+    // Barrier terms
+    for (i=0; i<p->n; ++i) {
+      d->sig[i] = 0;
+      if (d->type[i]!=1) continue;
+      if (d->lb[i] > -p->inf) d->sig[i] += d->ll[i]/d->sl[i];
+      if (d->ub[i] < p->inf) d->sig[i] += d->lu[i]/d->su[i];
+    }
+    if (casadi_ipqp_factor(d)) return 2;
+    // Predictor step
+    casadi_ipqp_newton(d, 0., 0);
+    alpha = casadi_ipqp_maxstep(d, 1.);
+    mu_aff = 0;
+    nfin = 0;
+    for (i=0; i<p->n; ++i) {
+      if (d->type[i]!=1) continue;
+      if (d->lb[i] > -p->inf) {
+        mu_aff += (d->sl[i] + alpha*d->dsl[i])*(d->ll[i] + alpha*d->dll[i]);
+        nfin++;
+      }
+      if (d->ub[i] < p->inf) {
+        mu_aff += (d->su[i] + alpha*d->dsu[i])*(d->lu[i] + alpha*d->dlu[i]);
+        nfin++;
+      }
+    }
+    sigma = 0;
+    if (nfin>0 && d->mu>0) {
+      sigma = mu_aff/nfin/d->mu;
+      sigma = sigma*sigma*sigma;
+    }
+    // Corrector step
+    casadi_ipqp_newton(d, sigma*d->mu, 1);
+    alpha = casadi_ipqp_maxstep(d, 0.995);
+    casadi_axpy(p->nx, alpha, d->dz, d->z);
+    for (i=p->nx; i<p->n; ++i) {
+      if (d->type[i]==2) d->lam[i] += alpha*d->dz[i];
+    }
+    casadi_axpy(p->n, alpha, d->dsl, d->sl);
+    casadi_axpy(p->n, alpha, d->dsu, d->su);
+    casadi_axpy(p->n, alpha, d->dll, d->ll);
+    casadi_axpy(p->n, alpha, d->dlu, d->lu);
+  }
+}
+
+// SYMBOL "ipqp_scatter"
+// Get the solution, the objective value and the multipliers
+template<typename T1>
+void casadi_ipqp_scatter(casadi_ipqp_data<T1>* d, T1* x, T1* f, T1* lam_a, T1* lam_x) {
+  const casadi_ipqp_prob<T1>* p = d->prob;
+  if (x) casadi_copy(d->z, p->nx, x);
+  if (f) {
+    *f = d->g ? casadi_dot(p->nx, d->g, d->z) : 0;
+    if (d->h) *f += 0.5*casadi_bilin(d->h, p->sp_h, d->z, d->z);
+  }
+  if (lam_x) casadi_copy(d->lam, p->nx, lam_x);
+  if (lam_a) casadi_copy(d->lam + p->nx, p->na, lam_a);
+}
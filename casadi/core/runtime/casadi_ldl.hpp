@@ -1,4 +1,41 @@
 // NOLINT(legal/copyright)
+// SYMBOL "ldl_row"
+// Calculate row c of L (i.e. column c of L^T) and d(c) for an LDL^T factorization,
+// given the rows of L that c depends on, cf. casadi_ldl
+// Rows in different subtrees of the elimination tree can be calculated independently
+// len[w] >= n, w must be zero on entry and is zero on exit
+template<typename T1>
+void casadi_ldl_row(const casadi_int* sp_a, const T1* a,
+                    const casadi_int* sp_lt, T1* lt, T1* d, const casadi_int* p,
+                    casadi_int c, T1* w) {
+  const casadi_int *lt_colind, *lt_row, *a_colind, *a_row;
+  casadi_int n, r, c1, k, k2;
+  // Extract sparsities
+  n=sp_lt[1];
+  lt_colind=sp_lt+2; lt_row=sp_lt+2+n+1;
+  a_colind=sp_a+2; a_row=sp_a+2+n+1;
+  // Sparse copy of A to L and D
+  c1 = p[c];
+  for (k=a_colind[c1]; k<a_colind[c1+1]; ++k) w[a_row[k]] = a[k];
+  for (k=lt_colind[c]; k<lt_colind[c+1]; ++k) lt[k] = w[p[lt_row[k]]];
+  d[c] = w[p[c]];
+  for (k=a_colind[c1]; k<a_colind[c1+1]; ++k) w[a_row[k]] = 0;
+  // Loop over the nonzeros of row c of L
+  for (k=lt_colind[c]; k<lt_colind[c+1]; ++k) {
+    r = lt_row[k];
+    // Calculate l(r,c) with r<c
+    for (k2=lt_colind[r]; k2<lt_colind[r+1]; ++k2) {
+      lt[k] -= lt[k2] * w[lt_row[k2]];
+    }
+    w[r] = lt[k];
+    lt[k] /= d[r];
+    // Update d(c)
+    d[c] -= w[r]*lt[k];
+  }
+  // Clear w
+  for (k=lt_colind[c]; k<lt_colind[c+1]; ++k) w[lt_row[k]] = 0;
+}
+
 // SYMBOL "ldl"
 // Calculate the nonzeros of the transposed L factor (strictly lower entries only)
 // as well as D for an LDL^T factorization
@@ -6,38 +43,12 @@
 template<typename T1>
 void casadi_ldl(const casadi_int* sp_a, const T1* a,
                 const casadi_int* sp_lt, T1* lt, T1* d, const casadi_int* p, T1* w) {
-  const casadi_int *lt_colind, *lt_row, *a_colind, *a_row;
-  casadi_int n, r, c, c1, k, k2;
-  // Extract sparsities
+  casadi_int n, r, c;
   n=sp_lt[1];
-  lt_colind=sp_lt+2; lt_row=sp_lt+2+n+1;
-  a_colind=sp_a+2; a_row=sp_a+2+n+1;
   // Clear w
   for (r=0; r<n; ++r) w[r] = 0;
-  // Sparse copy of A to L and D
-  for (c=0; c<n; ++c) {
-    c1 = p[c];
-    for (k=a_colind[c1]; k<a_colind[c1+1]; ++k) w[a_row[k]] = a[k];
-    for (k=lt_colind[c]; k<lt_colind[c+1]; ++k) lt[k] = w[p[lt_row[k]]];
-    d[c] = w[p[c]];
-    for (k=a_colind[c1]; k<a_colind[c1+1]; ++k) w[a_row[k]] = 0;
-  }
-  // Loop over columns of L
-  for (c=0; c<n; ++c) {
-    for (k=lt_colind[c]; k<lt_colind[c+1]; ++k) {
-      r = lt_row[k];
-      // Calculate l(r,c) with r<c
-      for (k2=lt_colind[r]; k2<lt_colind[r+1]; ++k2) {
-        lt[k] -= lt[k2] * w[lt_row[k2]];
-      }
-      w[r] = lt[k];
-      lt[k] /= d[r];
-      // Update d(c)
-      d[c] -= w[r]*lt[k];
-    }
-    // Clear w
-    for (k=lt_colind[c]; k<lt_colind[c+1]; ++k) w[lt_row[k]] = 0;
-  }
+  // Loop over rows of L
+  for (c=0; c<n; ++c) casadi_ldl_row(sp_a, a, sp_lt, lt, d, p, c, w);
 }
 
 // SYMBOL "ldl_trs"
@@ -89,3 +100,115 @@ void casadi_ldl_solve(T1* x, casadi_int nrhs, const casadi_int* sp_lt, const T1*
     x += n;
   }
 }
+
+// SYMBOL "ldl_trs_blk"
+// Solve for (I+R) as in casadi_ldl_trs for nb right-hand sides at once, stored
+// interleaved: entry i of right-hand side j is x[i*nb+j]
+template<typename T1>
+void casadi_ldl_trs_blk(const casadi_int* sp_r, const T1* nz_r, T1* x, casadi_int nb,
+                        casadi_int tr) {
+  casadi_int ncol, c, k, j;
+  const casadi_int *colind, *row;
+  T1 *xc, *xr;
+  // Extract sparsity
+  ncol=sp_r[1];
+  colind=sp_r+2; row=sp_r+2+ncol+1;
+  if (tr) {
+    // Forward substitution
+    for (c=0; c<ncol; ++c) {
+      xc = x + c*nb;
+      for (k=colind[c]; k<colind[c+1]; ++k) {
+        xr = x + row[k]*nb;
+        for (j=0; j<nb; ++j) xc[j] -= nz_r[k]*xr[j];
+      }
+    }
+  } else {
+    // Backward substitution
+    for (c=ncol-1; c>=0; --c) {
+      xc = x + c*nb;
+      for (k=colind[c+1]-1; k>=colind[c]; --k) {
+        xr = x + row[k]*nb;
+        for (j=0; j<nb; ++j) xr[j] -= nz_r[k]*xc[j];
+      }
+    }
+  }
+}
+
+// SYMBOL "ldl_solve_blk"
+// Linear solve using an LDL^T factorized linear system, cf. casadi_ldl_solve,
+// with one pass over the factors for every nb right-hand sides
+// len[w] >= n*nb
+template<typename T1>
+void casadi_ldl_solve_blk(T1* x, casadi_int nrhs, const casadi_int* sp_lt, const T1* lt,
+                          const T1* d, const casadi_int* p, T1* w, casadi_int nb) {
+  casadi_int i, j, k, m;
+  casadi_int n = sp_lt[1];
+  for (k=0; k<nrhs; k+=m) {
+    // Size of the block
+    m = nrhs-k<nb ? nrhs-k : nb;
+    // Multiply by P, interleaving the right-hand sides
+    for (j=0; j<m; ++j) {
+      for (i=0; i<n; ++i) w[i*m+j] = x[j*n+p[i]];
+    }
+    //  Solve for L
+    casadi_ldl_trs_blk(sp_lt, lt, w, m, 1);
+    // Divide by D
+    for (i=0; i<n; ++i) {
+      for (j=0; j<m; ++j) w[i*m+j] /= d[i];
+    }
+    // Solve for L'
+    casadi_ldl_trs_blk(sp_lt, lt, w, m, 0);
+    // Multiply by P'
+    for (j=0; j<m; ++j) {
+      for (i=0; i<n; ++i) x[j*n+p[i]] = w[i*m+j];
+    }
+    // Next block
+    x += m*n;
+  }
+}
+
+// SYMBOL "ldl_update"
+// Rank-1 modification L*D*L' + sigma*x*x' of an LDL^T factorization, in-place
+// Only the nonzeros on the elimination tree path from the first nonzero of P*x are
+// visited. The pattern of x*x' must be contained in the pattern of the factorized
+// matrix, so that no fill-in occurs. sp_l is the pattern of L, i.e. the transpose
+// of sp_lt, and l_map holds the locations in lt of its nonzeros.
+// Returns 1 if the modified matrix is singular, 0 otherwise
+// len[w] >= n
+template<typename T1>
+int casadi_ldl_update(const casadi_int* sp_l, const casadi_int* l_map, T1* lt, T1* d,
+                      const casadi_int* p, T1 sigma, const T1* x, T1* w) {
+  const casadi_int *l_colind, *l_row;
+  casadi_int n, i, j, k;
+  T1 alpha, alpha_bar, gamma, wj;
+  // Extract sparsity
+  n=sp_l[1];
+  l_colind=sp_l+2; l_row=sp_l+2+n+1;
+  // Multiply by P, locate the start of the path
+  j = n;
+  for (i=n-1; i>=0; --i) {
+    w[i] = x[p[i]];
+    if (w[i]!=0) j = i;
+  }
+  // Walk up the elimination tree, cf. Davis & Hager (1999)
+  alpha = 1;
+  while (j<n) {
+    wj = w[j];
+    w[j] = 0;
+    if (wj!=0) {
+      alpha_bar = alpha + sigma*wj*wj/d[j];
+      if (alpha_bar==0) return 1;
+      gamma = wj/(d[j]*alpha_bar);
+      d[j] *= alpha_bar/alpha;
+      alpha = alpha_bar;
+      for (k=l_colind[j]; k<l_colind[j+1]; ++k) {
+        i = l_row[k];
+        w[i] -= wj*lt[l_map[k]];
+        lt[l_map[k]] += sigma*gamma*w[i];
+      }
+    }
+    // Parent in the elimination tree
+    j = l_colind[j]<l_colind[j+1] ? l_row[l_colind[j]] : n;
+  }
+  return 0;
+}
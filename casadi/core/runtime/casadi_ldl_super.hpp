@@ -0,0 +1,114 @@
+// NOLINT(legal/copyright)
+// SYMBOL "ldl_super"
+// Supernodal variant of casadi_ldl, calculating the same nonzeros of L^T and D
+// The supernode partitioning sn is laid out as [ns, super[ns+1], rowptr[ns+1], row[rowptr[ns]],
+// updptr[ns+1], upd[updptr[ns]], blkptr[ns+1]], where row holds the rows of L below each
+// supernode and upd the (descendant) supernodes updating each supernode.
+// Each supernode is factorized as a dense column-major block in blk.
+// len[blk] >= blkptr[ns], len[w] >= n, len[iw] >= 2*n
+template<typename T1>
+void casadi_ldl_super(const casadi_int* sp_a, const T1* a,
+                      const casadi_int* sp_lt, T1* lt, T1* d, const casadi_int* p,
+                      const casadi_int* sn, T1* blk, T1* w, casadi_int* iw) {
+  const casadi_int *lt_colind, *lt_row, *a_colind, *a_row;
+  const casadi_int *super, *rowptr, *sn_row, *updptr, *upd, *blkptr;
+  casadi_int n, ns, s, s2, r, c, c1, i, i2, j, j2, k, f, nc, m, f2, nc2, m2, p1, p2, q;
+  casadi_int *map, *rel;
+  T1 t, *b, *b2, *bc;
+  // Extract sparsities
+  n=sp_lt[1];
+  lt_colind=sp_lt+2; lt_row=sp_lt+2+n+1;
+  a_colind=sp_a+2; a_row=sp_a+2+n+1;
+  // Extract supernodes
+  ns=sn[0];
+  super=sn+1; rowptr=super+ns+1; sn_row=rowptr+ns+1;
+  updptr=sn_row+rowptr[ns]; upd=updptr+ns+1; blkptr=upd+updptr[ns];
+  map=iw; rel=iw+n;
+  // Clear w
+  for (r=0; r<n; ++r) w[r] = 0;
+  // Sparse copy of A to L and D
+  for (c=0; c<n; ++c) {
+    c1 = p[c];
+    for (k=a_colind[c1]; k<a_colind[c1+1]; ++k) w[a_row[k]] = a[k];
+    for (k=lt_colind[c]; k<lt_colind[c+1]; ++k) lt[k] = w[p[lt_row[k]]];
+    d[c] = w[p[c]];
+    for (k=a_colind[c1]; k<a_colind[c1+1]; ++k) w[a_row[k]] = 0;
+  }
+  // Scatter to the dense supernode blocks
+  for (k=0; k<blkptr[ns]; ++k) blk[k] = 0;
+  for (s=0; s<ns; ++s) {
+    for (c=super[s]; c<super[s+1]; ++c) map[c] = s;
+    rel[s] = super[s+1]-super[s];
+  }
+  for (c=0; c<n; ++c) {
+    for (k=lt_colind[c]; k<lt_colind[c+1]; ++k) {
+      r = lt_row[k];
+      s = map[r];
+      f = super[s]; nc = super[s+1]-f; m = nc+rowptr[s+1]-rowptr[s];
+      if (c<f+nc) {
+        blk[blkptr[s] + c-f + (r-f)*m] = lt[k];
+      } else {
+        // Row c holds all columns of the supernode, count it after the last one
+        blk[blkptr[s] + rel[s] + (r-f)*m] = lt[k];
+        if (r==f+nc-1) rel[s]++;
+      }
+    }
+    s = map[c];
+    f = super[s]; m = super[s+1]-f+rowptr[s+1]-rowptr[s];
+    blk[blkptr[s] + (c-f)*(m+1)] = d[c];
+  }
+  // Loop over supernodes
+  for (s=0; s<ns; ++s) {
+    f = super[s]; nc = super[s+1]-f; m = nc+rowptr[s+1]-rowptr[s];
+    b = blk + blkptr[s];
+    // Local row indices
+    for (c=f; c<f+nc; ++c) map[c] = c-f;
+    for (k=rowptr[s]; k<rowptr[s+1]; ++k) map[sn_row[k]] = nc+k-rowptr[s];
+    // Updates from descendant supernodes
+    for (k=updptr[s]; k<updptr[s+1]; ++k) {
+      s2 = upd[k];
+      f2 = super[s2]; nc2 = super[s2+1]-f2; m2 = nc2+rowptr[s2+1]-rowptr[s2];
+      b2 = blk + blkptr[s2];
+      q = nc2 - rowptr[s2];
+      // Rows of s2 intersecting the columns of s, and all rows below
+      for (p1=rowptr[s2]; sn_row[p1]<f; ++p1) {}
+      for (p2=p1; p2<rowptr[s2+1] && sn_row[p2]<f+nc; ++p2) {}
+      for (i=p1; i<rowptr[s2+1]; ++i) rel[i-p1] = map[sn_row[i]];
+      // Dense update, one column of s2 at a time
+      for (j=0; j<nc2; ++j) {
+        for (i=p1; i<p2; ++i) {
+          t = b2[q+i+j*m2] * d[f2+j];
+          bc = b + rel[i-p1]*m;
+          for (i2=i; i2<rowptr[s2+1]; ++i2) bc[rel[i2-p1]] -= b2[q+i2+j*m2] * t;
+        }
+      }
+    }
+    // Dense factorization of the supernode
+    for (j=0; j<nc; ++j) {
+      d[f+j] = b[j+j*m];
+      for (i=j+1; i<m; ++i) b[i+j*m] /= d[f+j];
+      for (j2=j+1; j2<nc; ++j2) {
+        t = b[j2+j*m] * d[f+j];
+        for (i=j2; i<m; ++i) b[i+j2*m] -= b[i+j*m] * t;
+      }
+    }
+  }
+  // Gather from the dense supernode blocks
+  for (s=0; s<ns; ++s) {
+    for (c=super[s]; c<super[s+1]; ++c) map[c] = s;
+    rel[s] = super[s+1]-super[s];
+  }
+  for (c=0; c<n; ++c) {
+    for (k=lt_colind[c]; k<lt_colind[c+1]; ++k) {
+      r = lt_row[k];
+      s = map[r];
+      f = super[s]; nc = super[s+1]-f; m = nc+rowptr[s+1]-rowptr[s];
+      if (c<f+nc) {
+        lt[k] = blk[blkptr[s] + c-f + (r-f)*m];
+      } else {
+        lt[k] = blk[blkptr[s] + rel[s] + (r-f)*m];
+        if (r==f+nc-1) rel[s]++;
+      }
+    }
+  }
+}
@@ -1,7 +1,11 @@
 // NOLINT(legal/copyright)
 // SYMBOL "low"
+// Find the interval of a grid containing x
+// Lookup modes: 0 linear, 1 exact, 2 binary, 3 hunt (starting from the interval hint),
+// 4 table (table[0] uniform buckets, table[1+b] first interval of bucket b)
 template<typename T1>
-casadi_int casadi_low(T1 x, const double* grid, casadi_int ng, casadi_int lookup_mode) {
+casadi_int casadi_low(T1 x, const double* grid, casadi_int ng, casadi_int lookup_mode,
+    const casadi_int* table, casadi_int hint) {
   switch (lookup_mode) {
     case 1: // exact
       {
@@ -34,6 +38,63 @@ casadi_int casadi_low(T1 x, const double* grid, casadi_int ng, casadi_int lookup
           }
         }
       }
+    case 3: // hunt
+      {
+        casadi_int lo, hi, step, mid;
+        // Quick return
+        if (ng<3) return 0;
+        lo = hint;
+        if (lo<0) lo = 0;
+        if (lo>ng-2) lo = ng-2;
+        // Bracket the interval with increasing steps
+        step = 1;
+        if (lo==0 || grid[lo]<=x) {
+          hi = lo+1;
+          while (hi<=ng-2 && grid[hi]<=x) {
+            lo = hi;
+            step *= 2;
+            hi = lo+step;
+          }
+          if (hi>ng-1) hi = ng-1;
+        } else {
+          hi = lo;
+          lo = hi-1;
+          while (lo>0 && x<grid[lo]) {
+            hi = lo;
+            step *= 2;
+            lo = hi-step;
+          }
+          if (lo<0) lo = 0;
+        }
+        // Bisection
+        while (hi-lo>1) {
+          mid = (lo+hi)/2;
+          if (grid[mid]<=x) {
+            lo = mid;
+          } else {
+            hi = mid;
+          }
+        }
+        return lo;
+      }
+    case 4: // table
+      {
+        casadi_int nb, b, i;
+        double g0, dg;
+        // Quick return
+        if (ng<3) return 0;
+        nb = table[0];
+        g0 = grid[0];
+        dg = grid[ng-1]-g0;
+        b = (casadi_int) ((x-g0)*nb/dg); // NOLINT(readability/casting)
+        if (b<0) b=0;
+        if (b>nb-1) b=nb-1;
+        // Short scan from the first interval of the bucket
+        i = table[1+b];
+        while (i>0 && x<grid[i]) i--;
+        while (i<ng-2 && x>=grid[i+1]) i++;
+        return i;
+      }
     default: // linear
       {
         casadi_int i;
@@ -0,0 +1,142 @@
+// NOLINT(legal/copyright)
+// SYMBOL "mex_npt"
+// Number of points stacked horizontally in a MATLAB array, 1 if not batched
+template<typename T1>
+casadi_int casadi_mex_npt(const mxArray* p, const casadi_int* sp) {
+  casadi_int nrow, ncol, p_ncol;
+  nrow = sp[0];
+  ncol = sp[1];
+  if (!mxIsDouble(p) || mxGetNumberOfDimensions(p)!=2 || ncol==0) return 1;
+  p_ncol = (casadi_int)mxGetN(p);
+  if ((casadi_int)mxGetM(p)!=nrow || p_ncol<=ncol || p_ncol % ncol) return 1;
+  return p_ncol/ncol;
+}
+
+// SYMBOL "mex_nz"
+// Nonzeros of point j in a MATLAB array, null if the storage does not match the pattern
+template<typename T1>
+T1* casadi_mex_nz(const mxArray* p, const casadi_int* sp, casadi_int j) {
+  casadi_int nrow, ncol, nnz, c, k;
+  const casadi_int *colind, *row;
+#ifndef CASADI_MEX_NO_SPARSE
+  mwIndex *Jc, *Ir, off;
+#endif /* CASADI_MEX_NO_SPARSE */
+  if (sizeof(T1)!=sizeof(double)) return 0;
+  if (!mxIsDouble(p) || mxIsComplex(p) || mxGetNumberOfDimensions(p)!=2) return 0;
+  nrow = *sp++;
+  ncol = *sp++;
+  nnz = sp[ncol];
+  colind = sp;
+  row = sp+ncol+1;
+  if ((casadi_int)mxGetM(p)!=nrow || (casadi_int)mxGetN(p)<(j+1)*ncol) return 0;
+  if (mxIsSparse(p)) {
+#ifndef CASADI_MEX_NO_SPARSE
+    Jc = mxGetJc(p) + j*ncol;
+    Ir = mxGetIr(p);
+    off = Jc[0];
+    for (c=0; c<=ncol; ++c) if ((casadi_int)(Jc[c]-off)!=colind[c]) return 0;
+    for (k=0; k<nnz; ++k) if ((casadi_int)Ir[off+k]!=row[k]) return 0;
+    return (T1*)mxGetData(p) + off;
+#else /* CASADI_MEX_NO_SPARSE */
+    return 0;
+#endif /* CASADI_MEX_NO_SPARSE */
+  }
+  if (nnz!=nrow*ncol) return 0;
+  return (T1*)mxGetData(p) + j*nnz;
+}
+
+// SYMBOL "mex_arg"
+// Input for point j: MATLAB storage if possible, else copied to y
+template<typename T1>
+const T1* casadi_mex_arg(const mxArray* p, casadi_int j, T1* y, const casadi_int* sp, T1* w) {
+  casadi_int nrow, ncol, c, k;
+  const casadi_int *colind, *row;
+#ifndef CASADI_MEX_NO_SPARSE
+  mwIndex *Jc, *Ir;
+#endif /* CASADI_MEX_NO_SPARSE */
+  const double* p_data;
+  T1* r;
+  if ((r = casadi_mex_nz(p, sp, j))) return r;
+  if (casadi_mex_npt(p, sp)==1) return casadi_from_mex(p, y, sp, w);
+  nrow = *sp++;
+  ncol = *sp++;
+  colind = sp;
+  row = sp+ncol+1;
+  p_data = (const double*)mxGetData(p);
+  if (mxIsSparse(p)) {
+#ifndef CASADI_MEX_NO_SPARSE
+    Jc = mxGetJc(p) + j*ncol;
+    Ir = mxGetIr(p);
+    for (c=0; c<ncol; ++c) {
+      for (k=colind[c]; k<colind[c+1]; ++k) w[row[k]]=0;
+      for (k=Jc[c]; k<Jc[c+1]; ++k) w[Ir[k]]=p_data[k];
+      for (k=colind[c]; k<colind[c+1]; ++k) y[k]=w[row[k]];
+    }
+#else /* CASADI_MEX_NO_SPARSE */
+    mexErrMsgIdAndTxt("Casadi:RuntimeError",
+      "\"mex_arg\" failed: Sparse inputs disabled.");
+#endif /* CASADI_MEX_NO_SPARSE */
+  } else {
+    p_data += j*nrow*ncol;
+    for (c=0; c<ncol; ++c) {
+      for (k=colind[c]; k<colind[c+1]; ++k) y[k] = p_data[row[k]+c*nrow];
+    }
+  }
+  return y;
+}
+
+// SYMBOL "mex_create"
+// Create a MATLAB array holding npt points side by side, zero-initialized
+template<typename T1>
+mxArray* casadi_mex_create(const casadi_int* sp, casadi_int npt) {
+  casadi_int nrow, ncol;
+#ifndef CASADI_MEX_NO_SPARSE
+  casadi_int nnz, i, c, k;
+  const casadi_int *colind, *row;
+  mxArray *p;
+  mwIndex *Jc, *Ir;
+#endif /* CASADI_MEX_NO_SPARSE */
+  nrow = sp[0];
+  ncol = sp[1];
+#ifndef CASADI_MEX_NO_SPARSE
+  nnz = sp[2+ncol];
+  colind = sp+2;
+  row = sp+3+ncol;
+  if (nnz!=nrow*ncol) {
+    p = mxCreateSparse(nrow, npt*ncol, npt*nnz, mxREAL);
+    Jc = mxGetJc(p);
+    Ir = mxGetIr(p);
+    for (i=0; i<npt; ++i) {
+      for (c=0; c<ncol; ++c) *Jc++ = i*nnz + colind[c];
+      for (k=0; k<nnz; ++k) *Ir++ = row[k];
+    }
+    *Jc = npt*nnz;
+    return p;
+  }
+#endif /* CASADI_MEX_NO_SPARSE */
+  return mxCreateDoubleMatrix(nrow, npt*ncol, mxREAL);
+}
+
+// SYMBOL "mex_set"
+// Write the nonzeros of point j to an array created by casadi_mex_create
+template<typename T1>
+void casadi_mex_set(mxArray* p, const casadi_int* sp, casadi_int j, const T1* x) {
+  casadi_int nrow, ncol, nnz, c, k;
+  const casadi_int *colind, *row;
+  double* d;
+  nrow = *sp++;
+  ncol = *sp++;
+  nnz = sp[ncol];
+  colind = sp;
+  row = sp+ncol+1;
+  d = (double*)mxGetData(p);
+  if (mxIsSparse(p)) {
+    d += j*nnz;
+    for (k=0; k<nnz; ++k) d[k] = casadi_to_double(x[k]);
+  } else {
+    d += j*nrow*ncol;
+    for (c=0; c<ncol; ++c) {
+      for (k=colind[c]; k<colind[c+1]; ++k) d[row[k]+c*nrow] = casadi_to_double(*x++);
+    }
+  }
+}
@@ -17,6 +17,14 @@ void casadi_mtimes(const T1* x, const casadi_int* sp_x, const T1* y, const casad
     // Loop over the columns of y and z
     for (cc=0; cc<ncol_z; ++cc) {
       casadi_int kk;
+      // Clear the entries of w that will be read
+      for (kk=colind_z[cc]; kk<colind_z[cc+1]; ++kk) {
+        casadi_int kk1;
+        casadi_int rr = row_z[kk];
+        for (kk1=colind_x[rr]; kk1<colind_x[rr+1]; ++kk1) {
+          w[row_x[kk1]] = 0;
+        }
+      }
       // Get the dense column of y
       for (kk=colind_y[cc]; kk<colind_y[cc+1]; ++kk) {
         w[row_y[kk]] = y[kk];
@@ -0,0 +1,30 @@
+// NOLINT(legal/copyright)
+// SYMBOL "mtimes_dense"
+// Dense matrix-matrix multiplication: z <- z + x*y, all column-major, x nrow_x-by-ncol_x,
+// y ncol_x-by-ncol_y. Blocked over the rows and columns of x, four columns at a time.
+template<typename T1>
+void casadi_mtimes_dense(const T1* x, casadi_int nrow_x, casadi_int ncol_x,
+                         const T1* y, casadi_int ncol_y, T1* z) {
+  casadi_int i, j, k, i0, i1, k0, k1;
+  const T1 *x0, *x1, *x2, *x3, *yj;
+  T1 *zj, y0, y1, y2, y3;
+  for (i0=0; i0<nrow_x; i0=i1) {
+    i1 = i0+256<nrow_x ? i0+256 : nrow_x;
+    for (k0=0; k0<ncol_x; k0=k1) {
+      k1 = k0+64<ncol_x ? k0+64 : ncol_x;
+      for (j=0; j<ncol_y; ++j) {
+        zj = z + j*nrow_x;
+        yj = y + j*ncol_x;
+        for (k=k0; k+4<=k1; k+=4) {
+          x0 = x + k*nrow_x; x1 = x0 + nrow_x; x2 = x1 + nrow_x; x3 = x2 + nrow_x;
+          y0 = yj[k]; y1 = yj[k+1]; y2 = yj[k+2]; y3 = yj[k+3];
+          for (i=i0; i<i1; ++i) zj[i] += x0[i]*y0 + x1[i]*y1 + x2[i]*y2 + x3[i]*y3;
+        }
+        for (; k<k1; ++k) {
+          x0 = x + k*nrow_x; y0 = yj[k];
+          for (i=i0; i<i1; ++i) zj[i] += x0[i]*y0;
+        }
+      }
+    }
+  }
+}
@@ -7,9 +7,8 @@ void casadi_mv_dense(const T1* x, casadi_int nrow_x, casadi_int ncol_x,
   if (!x || !y || !z) return;
   if (tr) {
     for (i=0; i<ncol_x; ++i) {
-      for (j=0; j<nrow_x; ++j) {
-        z[i] += *x++ * y[j];
-      }
+      z[i] += casadi_dot(nrow_x, x, y);
+      x += nrow_x;
     }
   } else {
     for (i=0; i<ncol_x; ++i) {
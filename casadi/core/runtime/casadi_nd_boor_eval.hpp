@@ -22,6 +22,7 @@ void casadi_nd_boor_eval(T1* ret, casadi_int n_dims, const T1* all_knots, const
   for (k=0;k<n_dims;++k) {
     T1 *boor;
     const T1* knots;
+    const casadi_int* table;
     T1 x;
     casadi_int degree, n_knots, n_b, L, start;
     boor = all_boor+boor_offset[k];
@@ -32,7 +33,9 @@ void casadi_nd_boor_eval(T1* ret, casadi_int n_dims, const T1* all_knots, const
     n_b = n_knots-degree-1;
 
     x = all_x[k];
-    L = casadi_low(x, knots+degree, n_knots-2*degree, lookup_mode[k]);
+    // Previous start is used as a hint, tables for lookup mode 4 follow the lookup modes
+    table = lookup_mode[k]==4 ? lookup_mode + lookup_mode[n_dims+k] : 0;
+    L = casadi_low(x, knots+degree, n_knots-2*degree, lookup_mode[k], table, starts[k]);
 
     start = L;
     if (start>n_b-degree-1) start = n_b-degree-1;
@@ -3,8 +3,16 @@
 template<typename T1>
 T1 casadi_norm_inf(casadi_int n, const T1* x) {
   casadi_int i;
-  T1 ret = 0;
+  T1 r0, r1, r2, r3;
+  r0 = r1 = r2 = r3 = 0;
+  // Independent partial maxima, cf. casadi_dot
 // C-REPLACE "fmax" "casadi_fmax"
-  for (i=0; i<n; ++i) ret = fmax(ret, fabs(*x++));
-  return ret;
+  for (i=0; i+4<=n; i+=4) {
+    r0 = fmax(r0, fabs(x[i]));
+    r1 = fmax(r1, fabs(x[i+1]));
+    r2 = fmax(r2, fabs(x[i+2]));
+    r3 = fmax(r3, fabs(x[i+3]));
+  }
+  for (; i<n; ++i) r0 = fmax(r0, fabs(x[i]));
+  return fmax(fmax(r0, r1), fmax(r2, r3));
 }
@@ -0,0 +1,39 @@
+// NOLINT(legal/copyright)
+// SYMBOL "polyval_nd"
+// Multivariate polynomial in monomial (cheb=0) or Chebyshev (cheb=1) basis:
+// y = c*phi with phi_t = prod_j b_j(x_j)[e_jt], e the exponent matrix (nx-by-nterm),
+// c the coefficient matrix (ny-by-nterm). Basis values of x_j are tabulated in
+// w[deg_off[j]], ..., w[deg_off[j+1]-1]. Chebyshev inputs are scaled from [lb, ub] to [-1, 1]
+template<typename T1>
+void casadi_polyval_nd(const T1* x, T1* y, const casadi_int* sp_e, const casadi_int* e,
+    const casadi_int* sp_c, const T1* c, casadi_int cheb, const T1* lb, const T1* ub,
+    const casadi_int* deg_off, T1* w) {
+  casadi_int nx, nterm, ny, j, d, nd, t, k;
+  const casadi_int *colind_e, *row_e, *colind_c, *row_c;
+  T1 xj, phi, *b;
+  nx = sp_e[0];
+  nterm = sp_e[1];
+  colind_e = sp_e+2;
+  row_e = sp_e+2+nterm+1;
+  ny = sp_c[0];
+  colind_c = sp_c+2;
+  row_c = sp_c+2+nterm+1;
+  // Tabulate the basis functions
+  for (j=0; j<nx; ++j) {
+    b = w + deg_off[j];
+    nd = deg_off[j+1] - deg_off[j];
+    xj = x ? x[j] : 0;
+    if (cheb) xj = (2*xj - (lb[j] + ub[j]))/(ub[j] - lb[j]);
+    if (nd>0) b[0] = 1;
+    if (nd>1) b[1] = xj;
+    for (d=2; d<nd; ++d) b[d] = cheb ? 2*xj*b[d-1] - b[d-2] : xj*b[d-1];
+  }
+  // Accumulate the terms
+  for (k=0; k<ny; ++k) y[k] = 0;
+  for (t=0; t<nterm; ++t) {
+    if (colind_c[t]==colind_c[t+1]) continue;
+    phi = 1;
+    for (k=colind_e[t]; k<colind_e[t+1]; ++k) phi *= w[deg_off[row_e[k]] + e[k]];
+    for (k=colind_c[t]; k<colind_c[t+1]; ++k) y[row_c[k]] += c[k]*phi;
+  }
+}
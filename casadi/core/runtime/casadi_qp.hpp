@@ -56,6 +56,7 @@ void casadi_qp_work(casadi_qp_prob<T1>* p, casadi_int* sz_iw, casadi_int* sz_w)
   *sz_iw += p->nz; // neverupper
   *sz_iw += p->nz; // neverlower
   *sz_iw += p->nz; // lincomb
+  *sz_iw += p->nz; // qr_inactive
   *sz_w += std::max(nnz_v+nnz_r, nnz_kkt); // [v,r] or trans(kkt)
   *sz_w += p->nz; // beta
 }
@@ -74,6 +75,10 @@ struct casadi_qp_data {
   casadi_int *iw, *neverzero, *neverlower, *neverupper, *lincomb;
   // Numeric QR factorization
   T1 *nz_at, *nz_kkt, *beta, *nz_v, *nz_r;
+  // Inactive constraints (lam==0) in the current QR factorization, if any
+  casadi_int has_qr, *qr_inactive;
+  // Number of QR columns calculated
+  casadi_int n_qr_col;
   // Message buffer
   char msg[40];
   // Stepsize
@@ -118,8 +123,11 @@ void casadi_qp_init(casadi_qp_data<T1>* d, casadi_int* iw, T1* w) {
   d->neverupper = iw; iw += p->nz;
   d->neverlower = iw; iw += p->nz;
   d->lincomb = iw; iw += p->nz;
+  d->qr_inactive = iw; iw += p->nz;
   d->w = w;
   d->iw = iw;
+  d->has_qr = 0;
+  d->n_qr_col = 0;
 }
 
 // SYMBOL "qp_reset"
@@ -664,11 +672,30 @@ int casadi_qp_flip_check(casadi_qp_data<T1>* d, casadi_int index, casadi_int sig
 template<typename T1>
 void casadi_qp_factorize(casadi_qp_data<T1>* d) {
   const casadi_qp_prob<T1>* p = d->prob;
+  // Local variables
+  casadi_int c, i, k, nrow, flip;
+  const casadi_int *r_colind, *r_row;
   // Construct the KKT matrix
   casadi_qp_kkt(d);
-  // QR factorization
-  casadi_qr(p->sp_kkt, d->nz_kkt, d->w, p->sp_v, d->nz_v, p->sp_r,
-            d->nz_r, d->beta, p->prinv, p->pc);
+  // Columns of the (transposed) KKT matrix only change with the active set.
+  // Recalculate the QR columns of the changed KKT columns and the QR columns
+  // depending on them, i.e. their ancestors in the column elimination tree
+  r_row = (r_colind = p->sp_r+2) + p->nz + 1;
+  nrow = p->sp_v[0];
+  casadi_fill(d->w, nrow, 0.);
+  for (c=0; c<p->nz; ++c) {
+    i = p->pc[c];
+    flip = !d->has_qr || d->qr_inactive[i]!=(d->lam[i]==0);
+    for (k=r_colind[c]; !flip && k<r_colind[c+1] && r_row[k]<c; ++k) flip = d->iw[r_row[k]];
+    d->iw[c] = flip;
+    if (flip) {
+      casadi_qr_col(p->sp_kkt, d->nz_kkt, d->w, p->sp_v, d->nz_v, p->sp_r,
+                    d->nz_r, d->beta, p->prinv, p->pc, c);
+      d->n_qr_col++;
+    }
+  }
+  for (i=0; i<p->nz; ++i) d->qr_inactive[i] = d->lam[i]==0;
+  d->has_qr = 1;
   // Check singularity
   d->sing = casadi_qr_singular(&d->mina, &d->imina, d->nz_r, p->sp_r, p->pc, 1e-12);
 }
@@ -721,6 +748,8 @@ int casadi_qp_singular_step(casadi_qp_data<T1>* d, casadi_int* r_index, casadi_i
   casadi_copy(d->nz_v, nnz_kkt, d->nz_kkt);
   casadi_qr(p->sp_kkt, d->nz_kkt, d->w, p->sp_v, d->nz_v, p->sp_r, d->nz_r,
             d->beta, p->prinv, p->pc);
+  // The next factorization cannot be updated from this one
+  d->has_qr = 0;
   // Best flip
   tau = p->inf;
   // For all nullspace vectors
@@ -22,6 +22,52 @@ T1 casadi_house(T1* v, T1* beta, casadi_int nv) {
   return s;
 }
 
+// SYMBOL "qr_col"
+// Calculate column c of V and R for a QR factorization, given the columns that c
+// depends on, cf. casadi_qr
+// Columns in different subtrees of the elimination tree can be calculated independently
+// len[x] = nrow, x must be zero on entry and is zero on exit
+template<typename T1>
+void casadi_qr_col(const casadi_int* sp_a, const T1* nz_a, T1* x,
+                   const casadi_int* sp_v, T1* nz_v, const casadi_int* sp_r, T1* nz_r, T1* beta,
+                   const casadi_int* prinv, const casadi_int* pc, casadi_int c) {
+  // Local variables
+  casadi_int ncol, r, k, k1;
+  T1 alpha;
+  const casadi_int *a_colind, *a_row, *v_colind, *v_row, *r_colind, *r_row;
+  // Extract sparsities
+  ncol = sp_a[1];
+  a_colind=sp_a+2; a_row=sp_a+2+ncol+1;
+  v_colind=sp_v+2; v_row=sp_v+2+ncol+1;
+  r_colind=sp_r+2; r_row=sp_r+2+ncol+1;
+  // Nonzeros of column c of R
+  nz_r += r_colind[c];
+  // Copy (permuted) column of A to x
+  for (k=a_colind[pc[c]]; k<a_colind[pc[c]+1]; ++k) x[prinv[a_row[k]]] = nz_a[k];
+  // Use the equality R = (I-betan*vn*vn')*...*(I-beta1*v1*v1')*A to get
+  // strictly upper triangular entries of R
+  for (k=r_colind[c]; k<r_colind[c+1] && (r=r_row[k])<c; ++k) {
+    // Calculate scalar factor alpha = beta(r)*dot(v(:,r), x)
+    alpha = 0;
+    for (k1=v_colind[r]; k1<v_colind[r+1]; ++k1) alpha += nz_v[k1]*x[v_row[k1]];
+    alpha *= beta[r];
+    // x -= alpha*v(:,r)
+    for (k1=v_colind[r]; k1<v_colind[r+1]; ++k1) x[v_row[k1]] -= alpha*nz_v[k1];
+    // Get r entry
+    *nz_r++ = x[r];
+    // Strictly upper triangular entries in x no longer needed
+    x[r] = 0;
+  }
+  // Get V column
+  for (k=v_colind[c]; k<v_colind[c+1]; ++k) {
+    nz_v[k] = x[v_row[k]];
+    // Lower triangular entries of x no longer needed
+    x[v_row[k]] = 0;
+  }
+  // Get diagonal entry of R, normalize V column
+  *nz_r = casadi_house(nz_v + v_colind[c], beta + c, v_colind[c+1] - v_colind[c]);
+}
+
 // SYMBOL "qr"
 // Numeric QR factorization
 // Ref: Chapter 5, Direct Methods for Sparse Linear Systems by Tim Davis
@@ -36,43 +82,15 @@ void casadi_qr(const casadi_int* sp_a, const T1* nz_a, T1* x,
                const casadi_int* sp_v, T1* nz_v, const casadi_int* sp_r, T1* nz_r, T1* beta,
                const casadi_int* prinv, const casadi_int* pc) {
    // Local variables
-   casadi_int ncol, nrow, r, c, k, k1;
-   T1 alpha;
-   const casadi_int *a_colind, *a_row, *v_colind, *v_row, *r_colind, *r_row;
+   casadi_int ncol, nrow, r, c;
    // Extract sparsities
    ncol = sp_a[1];
-   a_colind=sp_a+2; a_row=sp_a+2+ncol+1;
    nrow = sp_v[0];
-   v_colind=sp_v+2; v_row=sp_v+2+ncol+1;
-   r_colind=sp_r+2; r_row=sp_r+2+ncol+1;
    // Clear work vector
    for (r=0; r<nrow; ++r) x[r] = 0;
    // Loop over columns of R, A and V
    for (c=0; c<ncol; ++c) {
-     // Copy (permuted) column of A to x
-     for (k=a_colind[pc[c]]; k<a_colind[pc[c]+1]; ++k) x[prinv[a_row[k]]] = nz_a[k];
-     // Use the equality R = (I-betan*vn*vn')*...*(I-beta1*v1*v1')*A to get
-     // strictly upper triangular entries of R
-     for (k=r_colind[c]; k<r_colind[c+1] && (r=r_row[k])<c; ++k) {
-       // Calculate scalar factor alpha = beta(r)*dot(v(:,r), x)
-       alpha = 0;
-       for (k1=v_colind[r]; k1<v_colind[r+1]; ++k1) alpha += nz_v[k1]*x[v_row[k1]];
-       alpha *= beta[r];
-       // x -= alpha*v(:,r)
-       for (k1=v_colind[r]; k1<v_colind[r+1]; ++k1) x[v_row[k1]] -= alpha*nz_v[k1];
-       // Get r entry
-       *nz_r++ = x[r];
-       // Strictly upper triangular entries in x no longer needed
-       x[r] = 0;
-     }
-     // Get V column
-     for (k=v_colind[c]; k<v_colind[c+1]; ++k) {
-       nz_v[k] = x[v_row[k]];
-       // Lower triangular entries of x no longer needed
-       x[v_row[k]] = 0;
-     }
-     // Get diagonal entry of R, normalize V column
-     *nz_r++ = casadi_house(nz_v + v_colind[c], beta + c, v_colind[c+1] - v_colind[c]);
+     casadi_qr_col(sp_a, nz_a, x, sp_v, nz_v, sp_r, nz_r, beta, prinv, pc, c);
    }
  }
 
@@ -178,6 +196,133 @@ void casadi_qr_solve(T1* x, casadi_int nrhs, casadi_int tr,
   }
 }
 
+// SYMBOL "qr_mv_blk"
+// Multiply QR Q matrix from the right with nb vectors at once, cf. casadi_qr_mv,
+// stored interleaved: entry i of vector j is x[i*nb+j]
+// len[alpha] >= nb
+template<typename T1>
+void casadi_qr_mv_blk(const casadi_int* sp_v, const T1* v, const T1* beta, T1* x,
+                      casadi_int nb, casadi_int tr, T1* alpha) {
+  // Local variables
+  casadi_int ncol, c, c1, k, j;
+  T1* xr;
+  const casadi_int *colind, *row;
+  // Extract sparsity
+  ncol=sp_v[1];
+  colind=sp_v+2; row=sp_v+2+ncol+1;
+  // Loop over vectors
+  for (c1=0; c1<ncol; ++c1) {
+    // Forward order for transpose, otherwise backwards
+    c = tr ? c1 : ncol-1-c1;
+    // Calculate scalar factors alpha = beta(c)*dot(v(:,c), x)
+    for (j=0; j<nb; ++j) alpha[j] = 0;
+    for (k=colind[c]; k<colind[c+1]; ++k) {
+      xr = x + row[k]*nb;
+      for (j=0; j<nb; ++j) alpha[j] += v[k]*xr[j];
+    }
+    for (j=0; j<nb; ++j) alpha[j] *= beta[c];
+    // x -= alpha*v(:,c)
+    for (k=colind[c]; k<colind[c+1]; ++k) {
+      xr = x + row[k]*nb;
+      for (j=0; j<nb; ++j) xr[j] -= alpha[j]*v[k];
+    }
+  }
+}
+
+// SYMBOL "qr_trs_blk"
+// Solve for an (optionally transposed) upper triangular matrix R, cf. casadi_qr_trs,
+// for nb right-hand sides stored interleaved
+template<typename T1>
+void casadi_qr_trs_blk(const casadi_int* sp_r, const T1* nz_r, T1* x, casadi_int nb,
+                       casadi_int tr) {
+  // Local variables
+  casadi_int ncol, r, c, k, j;
+  T1 *xc, *xr;
+  const casadi_int *colind, *row;
+  // Extract sparsity
+  ncol=sp_r[1];
+  colind=sp_r+2; row=sp_r+2+ncol+1;
+  if (tr) {
+    // Forward substitution
+    for (c=0; c<ncol; ++c) {
+      xc = x + c*nb;
+      for (k=colind[c]; k<colind[c+1]; ++k) {
+        r = row[k];
+        if (r==c) {
+          for (j=0; j<nb; ++j) xc[j] /= nz_r[k];
+        } else {
+          xr = x + r*nb;
+          for (j=0; j<nb; ++j) xc[j] -= nz_r[k]*xr[j];
+        }
+      }
+    }
+  } else {
+    // Backward substitution
+    for (c=ncol-1; c>=0; --c) {
+      xc = x + c*nb;
+      for (k=colind[c+1]-1; k>=colind[c]; --k) {
+        r=row[k];
+        xr = x + r*nb;
+        if (r==c) {
+          for (j=0; j<nb; ++j) xr[j] /= nz_r[k];
+        } else {
+          for (j=0; j<nb; ++j) xr[j] -= nz_r[k]*xc[j];
+        }
+      }
+    }
+  }
+}
+
+// SYMBOL "qr_solve_blk"
+// Solve a factorized linear system, cf. casadi_qr_solve, with one pass over
+// the factors for every nb right-hand sides
+// len[w] >= (nrow_ext+1)*nb
+template<typename T1>
+void casadi_qr_solve_blk(T1* x, casadi_int nrhs, casadi_int tr,
+                         const casadi_int* sp_v, const T1* v, const casadi_int* sp_r, const T1* r,
+                         const T1* beta, const casadi_int* prinv, const casadi_int* pc, T1* w,
+                         casadi_int nb) {
+  casadi_int k, c, j, m, nrow_ext, ncol;
+  T1* alpha;
+  nrow_ext = sp_v[0]; ncol = sp_v[1];
+  alpha = w + nrow_ext*nb;
+  for (k=0; k<nrhs; k+=m) {
+    // Size of the block
+    m = nrhs-k<nb ? nrhs-k : nb;
+    if (tr) {
+      // Multiply by PC
+      for (c=ncol*m; c<nrow_ext*m; ++c) w[c] = 0;
+      for (j=0; j<m; ++j) {
+        for (c=0; c<ncol; ++c) w[c*m+j] = x[j*ncol+pc[c]];
+      }
+      //  Solve for R'
+      casadi_qr_trs_blk(sp_r, r, w, m, 1);
+      // Multiply by Q
+      casadi_qr_mv_blk(sp_v, v, beta, w, m, 0, alpha);
+      // Multiply by PR'
+      for (j=0; j<m; ++j) {
+        for (c=0; c<ncol; ++c) x[j*ncol+c] = w[prinv[c]*m+j];
+      }
+    } else {
+      // Multiply with PR
+      for (c=0; c<nrow_ext*m; ++c) w[c] = 0;
+      for (j=0; j<m; ++j) {
+        for (c=0; c<ncol; ++c) w[prinv[c]*m+j] = x[j*ncol+c];
+      }
+      // Multiply with Q'
+      casadi_qr_mv_blk(sp_v, v, beta, w, m, 1, alpha);
+      //  Solve for R
+      casadi_qr_trs_blk(sp_r, r, w, m, 0);
+      // Multiply with PC'
+      for (j=0; j<m; ++j) {
+        for (c=0; c<ncol; ++c) x[j*ncol+pc[c]] = w[c*m+j];
+      }
+    }
+    // Next block
+    x += m*ncol;
+  }
+}
+
 // SYMBOL "qr_singular"
 // Check if QR factorization corresponds to a singular matrix
 template<typename T1>
@@ -216,6 +361,7 @@ void casadi_qr_colcomb(T1* v, const T1* nz_r, const casadi_int* sp_r,
   // Local variables
   casadi_int ncol, r, c, k;
   const casadi_int *r_colind, *r_row;
+  T1 s;
   // Extract sparsity
   ncol = sp_r[1];
   r_colind = sp_r + 2;
@@ -228,7 +374,7 @@ void casadi_qr_colcomb(T1* v, const T1* nz_r, const casadi_int* sp_r,
     }
   }
   // Reset w
-  casadi_fill(v, ncol, 0.);
+  for (c=0; c<ncol; ++c) v[c] = 0;
   v[pc[ind]] = 1.;
   // Copy ind-th column to v
   for (k=r_colind[ind]; k<r_colind[ind+1]-1; ++k) {
@@ -250,5 +396,8 @@ void casadi_qr_colcomb(T1* v, const T1* nz_r, const casadi_int* sp_r,
     }
   }
   // Normalize v
-  casadi_scal(ncol, 1./sqrt(casadi_dot(ncol, v, v)), v);
+  s = 0;
+  for (c=0; c<ncol; ++c) s += v[c]*v[c];
+  s = 1./sqrt(s);
+  for (c=0; c<ncol; ++c) v[c] *= s;
 }
@@ -0,0 +1,648 @@
+// NOLINT(legal/copyright)
+
+// C-REPLACE "fmin" "casadi_fmin"
+// C-REPLACE "fmax" "casadi_fmax"
+
+// SYMBOL "riccati_prob"
+template<typename T1>
+struct casadi_riccati_prob {
+  // Horizon and dimensions of each stage, length N+1 with nu[N]=0
+  casadi_int N;
+  const casadi_int *nx, *nu, *ng;
+  // Number of variables, constraints, dynamic constraints and other constraints
+  casadi_int nz, na, nd, nc;
+  // Sparsity patterns of H and A
+  const casadi_int *sp_h, *sp_a;
+  // Maximum number of iterations
+  casadi_int max_iter;
+  // Tolerance, infinity
+  T1 tol, inf;
+};
+// C-REPLACE "casadi_riccati_prob<T1>" "struct casadi_riccati_prob"
+
+// SYMBOL "riccati_data"
+template<typename T1>
+struct casadi_riccati_data {
+  // Problem structure
+  const casadi_riccati_prob<T1>* prob;
+  // Offsets of each stage: variables, dynamic and other constraints, dense blocks
+  casadi_int *oz, *od, *oc, *oh, *oab, *ocg, *op;
+  // Stage of each variable, type (dynamic constraint j or other constraint -1-j)
+  // and stage of each constraint
+  casadi_int *zstage, *rtype, *rstage;
+  // Stage blocks: Hessian, dynamics x_(k+1) = [A B]*z_k + b, other constraints C*z_k,
+  // coefficient e of x_(k+1) in the dynamic constraint
+  T1 *h, *ab, *cg, *e, *b;
+  // Objective gradient, bounds of the variables followed by the other constraints
+  T1 *g, *lb, *ub;
+  // Primal-dual iterate: variables, multipliers of the dynamics, slacks, multipliers
+  T1 *z, *pi, *sl, *su, *ll, *lu;
+  // Newton step
+  T1 *dz, *dpi, *dsl, *dsu, *dll, *dlu;
+  // Residuals: stationarity, dynamics, lower and upper bounds
+  T1 *rz, *rc, *rl, *ru;
+  // Complementarity right-hand sides, barrier terms, inequality values D*z and D*dz
+  T1 *cl, *cu, *sig, *q, *v, *dv;
+  // Riccati recursion: stage matrices, cost-to-go Hessians and gradients, work
+  T1 *m, *p, *pv, *mv, *tmp;
+  // Iteration counter
+  casadi_int iter;
+  // Duality measure, largest residual
+  T1 mu, err;
+};
+// C-REPLACE "casadi_riccati_data<T1>" "struct casadi_riccati_data"
+
+// SYMBOL "riccati_work"
+template<typename T1>
+void casadi_riccati_work(const casadi_riccati_prob<T1>* p, casadi_int* sz_iw, casadi_int* sz_w) {
+  // Local variables
+  casadi_int k, nzk, ni, sz_h, sz_ab, sz_cg, sz_p, sz_tmp;
+  sz_h = sz_ab = sz_cg = sz_p = sz_tmp = 0;
+  for (k=0; k<=p->N; ++k) {
+    nzk = p->nx[k] + p->nu[k];
+    sz_h += nzk*nzk;
+    sz_cg += p->ng[k]*nzk;
+    sz_p += p->nx[k]*p->nx[k];
+    if (k<p->N) {
+      sz_ab += p->nx[k+1]*nzk;
+      if (p->nx[k+1]*nzk + p->nx[k+1] > sz_tmp) sz_tmp = p->nx[k+1]*nzk + p->nx[k+1];
+    }
+  }
+  ni = p->nz + p->nc;
+  *sz_iw = 7*(p->N+2) + p->nz + 2*p->na;
+  *sz_w = 2*sz_h + sz_ab + sz_cg + 2*p->nd; // h, m, ab, cg, e, b
+  *sz_w += p->nz + 2*ni; // g, lb, ub
+  *sz_w += 2*(p->nz + p->nd + 4*ni); // iterate and step
+  *sz_w += p->nz + p->nd + 2*ni; // residuals
+  *sz_w += 6*ni; // cl, cu, sig, q, v, dv
+  *sz_w += sz_p + 2*p->nz + sz_tmp; // p, pv, mv, tmp
+}
+
+// SYMBOL "riccati_init"
+template<typename T1>
+void casadi_riccati_init(casadi_riccati_data<T1>* d, casadi_int* iw, T1* w) {
+  // Local variables
+  casadi_int k, i, nzk, ni;
+  const casadi_riccati_prob<T1>* p = d->prob;
+  ni = p->nz + p->nc;
+  // Stage offsets
+  d->oz = iw; iw += p->N+2;
+  d->od = iw; iw += p->N+2;
+  d->oc = iw; iw += p->N+2;
+  d->oh = iw; iw += p->N+2;
+  d->oab = iw; iw += p->N+2;
+  d->ocg = iw; iw += p->N+2;
+  d->op = iw; iw += p->N+2;
+  d->oz[0] = d->od[0] = d->oc[0] = d->oh[0] = d->oab[0] = d->ocg[0] = d->op[0] = 0;
+  for (k=0; k<=p->N; ++k) {
+    nzk = p->nx[k] + p->nu[k];
+    d->oz[k+1] = d->oz[k] + nzk;
+    d->od[k+1] = d->od[k] + (k<p->N ? p->nx[k+1] : 0);
+    d->oc[k+1] = d->oc[k] + p->ng[k];
+    d->oh[k+1] = d->oh[k] + nzk*nzk;
+    d->oab[k+1] = d->oab[k] + (k<p->N ? p->nx[k+1]*nzk : 0);
+    d->ocg[k+1] = d->ocg[k] + p->ng[k]*nzk;
+    d->op[k+1] = d->op[k] + p->nx[k]*p->nx[k];
+  }
+  // Stage of each variable, type and stage of each constraint
+  d->zstage = iw; iw += p->nz;
+  d->rtype = iw; iw += p->na;
+  d->rstage = iw; iw += p->na;
+  for (k=0; k<=p->N; ++k) {
+    for (i=d->oz[k]; i<d->oz[k+1]; ++i) d->zstage[i] = k;
+    for (i=0; i<(k<p->N ? p->nx[k+1] : 0); ++i) {
+      d->rtype[d->od[k]+d->oc[k]+i] = d->od[k]+i;
+      d->rstage[d->od[k]+d->oc[k]+i] = k;
+    }
+    for (i=0; i<p->ng[k]; ++i) {
+      d->rtype[d->od[k+1]+d->oc[k]+i] = -1-(d->oc[k]+i);
+      d->rstage[d->od[k+1]+d->oc[k]+i] = k;
+    }
+  }
+  // Real work vectors
+  d->h = w; w += d->oh[p->N+1];
+  d->m = w; w += d->oh[p->N+1];
+  d->ab = w; w += d->oab[p->N+1];
+  d->cg = w; w += d->ocg[p->N+1];
+  d->e = w; w += p->nd;
+  d->b = w; w += p->nd;
+  d->g = w; w += p->nz;
+  d->lb = w; w += ni;
+  d->ub = w; w += ni;
+  d->z = w; w += p->nz;
+  d->pi = w; w += p->nd;
+  d->sl = w; w += ni;
+  d->su = w; w += ni;
+  d->ll = w; w += ni;
+  d->lu = w; w += ni;
+  d->dz = w; w += p->nz;
+  d->dpi = w; w += p->nd;
+  d->dsl = w; w += ni;
+  d->dsu = w; w += ni;
+  d->dll = w; w += ni;
+  d->dlu = w; w += ni;
+  d->rz = w; w += p->nz;
+  d->rc = w; w += p->nd;
+  d->rl = w; w += ni;
+  d->ru = w; w += ni;
+  d->cl = w; w += ni;
+  d->cu = w; w += ni;
+  d->sig = w; w += ni;
+  d->q = w; w += ni;
+  d->v = w; w += ni;
+  d->dv = w; w += ni;
+  d->p = w; w += d->op[p->N+1];
+  d->pv = w; w += p->nz;
+  d->mv = w; w += p->nz;
+  d->tmp = w;
+}
+
+// SYMBOL "riccati_gather"
+// Distribute the QP data over the stage blocks, returns 1 if a dynamic constraint is
+// not an equality or does not depend on its state
+template<typename T1>
+int casadi_riccati_gather(casadi_riccati_data<T1>* d, const T1* h, const T1* g, const T1* a,
+                          const T1* lba, const T1* uba, const T1* lbx, const T1* ubx) {
+  // Local variables
+  casadi_int c, k, r, s, t, nzk, nx1, lc, i, j;
+  const casadi_int *colind, *row;
+  const casadi_riccati_prob<T1>* p = d->prob;
+  // Hessian blocks
+  casadi_fill(d->h, d->oh[p->N+1], 0.);
+  colind = p->sp_h+2; row = p->sp_h+2+p->nz+1;
+  if (h) {
+    for (c=0; c<p->nz; ++c) {
+      s = d->zstage[c];
+      nzk = d->oz[s+1]-d->oz[s];
+      for (k=colind[c]; k<colind[c+1]; ++k) {
+        d->h[d->oh[s] + row[k]-d->oz[s] + (c-d->oz[s])*nzk] = h[k];
+      }
+    }
+  }
+  // Constraint blocks
+  casadi_fill(d->ab, d->oab[p->N+1], 0.);
+  casadi_fill(d->cg, d->ocg[p->N+1], 0.);
+  casadi_fill(d->e, p->nd, 0.);
+  colind = p->sp_a+2; row = p->sp_a+2+p->nz+1;
+  if (a) {
+    for (c=0; c<p->nz; ++c) {
+      s = d->zstage[c];
+      lc = c-d->oz[s];
+      for (k=colind[c]; k<colind[c+1]; ++k) {
+        r = row[k];
+        t = d->rtype[r];
+        if (t<0) {
+          t = -1-t;
+          d->cg[d->ocg[s] + t-d->oc[s] + lc*p->ng[s]] = a[k];
+        } else if (d->rstage[r]==s) {
+          d->ab[d->oab[s] + t-d->od[s] + lc*p->nx[s+1]] = a[k];
+        } else {
+          d->e[t] = a[k];
+        }
+      }
+    }
+  }
+  // Bounds
+  casadi_fill(d->g, p->nz, 0.);
+  if (g) casadi_copy(g, p->nz, d->g);
+  for (i=0; i<p->nz; ++i) {
+    d->lb[i] = lbx ? lbx[i] : 0;
+    d->ub[i] = ubx ? ubx[i] : 0;
+  }
+  for (r=0; r<p->na; ++r) {
+    t = d->rtype[r];
+    if (t<0) {
+      d->lb[p->nz-1-t] = lba ? lba[r] : 0;
+      d->ub[p->nz-1-t] = uba ? uba[r] : 0;
+    } else {
+      if ((lba ? lba[r] : 0) != (uba ? uba[r] : 0) || d->e[t]==0) return 1;
+      d->b[t] = lba ? lba[r] : 0;
+    }
+  }
+  // Scale the dynamics to x_(k+1) = [A B]*z_k + b
+  for (k=0; k<p->N; ++k) {
+    nzk = d->oz[k+1]-d->oz[k];
+    nx1 = p->nx[k+1];
+    for (i=0; i<nx1; ++i) {
+      j = d->od[k]+i;
+      for (lc=0; lc<nzk; ++lc) d->ab[d->oab[k] + i + lc*nx1] /= -d->e[j];
+      d->b[j] /= d->e[j];
+    }
+  }
+  return 0;
+}
+
+// SYMBOL "riccati_dmul"
+// Values of the inequality constraints D*z = [z; C*z]
+template<typename T1>
+void casadi_riccati_dmul(casadi_riccati_data<T1>* d, const T1* z, T1* v) {
+  // Local variables
+  casadi_int k, nzk;
+  const casadi_riccati_prob<T1>* p = d->prob;
+  casadi_copy(z, p->nz, v);
+  v += p->nz;
+  for (k=0; k<=p->N; ++k) {
+    nzk = d->oz[k+1]-d->oz[k];
+    casadi_fill(v+d->oc[k], p->ng[k], 0.);
+    casadi_mv_dense(d->cg + d->ocg[k], p->ng[k], nzk, z + d->oz[k], v + d->oc[k], 0);
+  }
+}
+
+// SYMBOL "riccati_dtmul"
+// Add D'*v to z
+template<typename T1>
+void casadi_riccati_dtmul(casadi_riccati_data<T1>* d, const T1* v, T1* z) {
+  // Local variables
+  casadi_int k, nzk;
+  const casadi_riccati_prob<T1>* p = d->prob;
+  casadi_axpy(p->nz, 1., v, z);
+  v += p->nz;
+  for (k=0; k<=p->N; ++k) {
+    nzk = d->oz[k+1]-d->oz[k];
+    casadi_mv_dense(d->cg + d->ocg[k], p->ng[k], nzk, v + d->oc[k], z + d->oz[k], 1);
+  }
+}
+
+// SYMBOL "riccati_residual"
+// Calculate the residuals of the perturbed KKT conditions
+template<typename T1>
+void casadi_riccati_residual(casadi_riccati_data<T1>* d) {
+  // Local variables
+  casadi_int k, i, nzk, nx1, ni, nfin;
+  T1 r;
+  const casadi_riccati_prob<T1>* p = d->prob;
+  ni = p->nz + p->nc;
+  // Inequality values
+  casadi_riccati_dmul(d, d->z, d->v);
+  // Stationarity: H*z + g + D'*(lu-ll) + J'*pi
+  casadi_copy(d->g, p->nz, d->rz);
+  for (i=0; i<ni; ++i) d->q[i] = d->lu[i] - d->ll[i];
+  casadi_riccati_dtmul(d, d->q, d->rz);
+  for (k=0; k<=p->N; ++k) {
+    nzk = d->oz[k+1]-d->oz[k];
+    casadi_mv_dense(d->h + d->oh[k], nzk, nzk, d->z + d->oz[k], d->rz + d->oz[k], 0);
+    if (k<p->N) {
+      nx1 = p->nx[k+1];
+      casadi_mv_dense(d->ab + d->oab[k], nx1, nzk, d->pi + d->od[k], d->rz + d->oz[k], 1);
+      casadi_axpy(nx1, -1., d->pi + d->od[k], d->rz + d->oz[k+1]);
+      // Dynamics: [A B]*z_k + b - x_(k+1)
+      casadi_copy(d->b + d->od[k], nx1, d->rc + d->od[k]);
+      casadi_axpy(nx1, -1., d->z + d->oz[k+1], d->rc + d->od[k]);
+      casadi_mv_dense(d->ab + d->oab[k], nx1, nzk, d->z + d->oz[k], d->rc + d->od[k], 0);
+    }
+  }
+  // Bounds, duality measure
+  d->mu = 0;
+  nfin = 0;
+  for (i=0; i<ni; ++i) {
+    d->rl[i] = d->ru[i] = 0;
+    if (d->lb[i] > -p->inf) {
+      d->rl[i] = d->v[i] - d->lb[i] - d->sl[i];
+      d->mu += d->sl[i]*d->ll[i];
+      nfin++;
+    }
+    if (d->ub[i] < p->inf) {
+      d->ru[i] = d->ub[i] - d->v[i] - d->su[i];
+      d->mu += d->su[i]*d->lu[i];
+      nfin++;
+    }
+  }
+  if (nfin>0) d->mu /= nfin;
+  // Largest residual
+  d->err = 0;
+  for (i=0; i<p->nz; ++i) d->err = fmax(d->err, fabs(d->rz[i]));
+  for (i=0; i<p->nd; ++i) d->err = fmax(d->err, fabs(d->rc[i]));
+  for (i=0; i<ni; ++i) {
+    r = fmax(fabs(d->rl[i]), fabs(d->ru[i]));
+    d->err = fmax(d->err, r);
+  }
+}
+
+// SYMBOL "riccati_chol"
+// In-place Cholesky factorization of a dense n-by-n block with leading dimension ld,
+// the lower triangle is overwritten, returns 1 if not positive definite
+template<typename T1>
+int casadi_riccati_chol(T1* a, casadi_int n, casadi_int ld) {
+  // Local variables
+  casadi_int i, j, k;
+  for (j=0; j<n; ++j) {
+    for (k=0; k<j; ++k) {
+      for (i=j; i<n; ++i) a[i+j*ld] -= a[i+k*ld]*a[j+k*ld];
+    }
+    if (a[j+j*ld] <= 0) return 1;
+    a[j+j*ld] = sqrt(a[j+j*ld]);
+    for (i=j+1; i<n; ++i) a[i+j*ld] /= a[j+j*ld];
+  }
+  return 0;
+}
+
+// SYMBOL "riccati_trsv"
+// Solve L*x=b (tr=0) or L'*x=b (tr=1) in place, L lower triangular with leading dimension ld
+template<typename T1>
+void casadi_riccati_trsv(const T1* l, casadi_int n, casadi_int ld, T1* x, int tr) {
+  // Local variables
+  casadi_int i, j;
+  if (tr) {
+    for (i=n-1; i>=0; --i) {
+      for (j=i+1; j<n; ++j) x[i] -= l[j+i*ld]*x[j];
+      x[i] /= l[i+i*ld];
+    }
+  } else {
+    for (i=0; i<n; ++i) {
+      for (j=0; j<i; ++j) x[i] -= l[i+j*ld]*x[j];
+      x[i] /= l[i+i*ld];
+    }
+  }
+}
+
+// SYMBOL "riccati_factor"
+// Backward Riccati recursion for the Hessian H + D'*diag(sig)*D, returns 1 if the
+// reduced Hessian of some stage is not positive definite
+template<typename T1>
+int casadi_riccati_factor(casadi_riccati_data<T1>* d) {
+  // Local variables
+  casadi_int k, i, j, l, nx, nu, nzk, nx1, ng;
+  T1 *m, *P, *P1, *ab, *cg, *sig, *Y;
+  const casadi_riccati_prob<T1>* p = d->prob;
+  for (k=p->N; k>=0; --k) {
+    nx = p->nx[k];
+    nu = p->nu[k];
+    nzk = nx + nu;
+    ng = p->ng[k];
+    m = d->m + d->oh[k];
+    cg = d->cg + d->ocg[k];
+    // Barrier Hessian of the stage
+    casadi_copy(d->h + d->oh[k], nzk*nzk, m);
+    sig = d->sig + d->oz[k];
+    for (i=0; i<nzk; ++i) m[i+i*nzk] += sig[i];
+    sig = d->sig + p->nz + d->oc[k];
+    for (j=0; j<nzk; ++j) {
+      for (i=0; i<nzk; ++i) {
+        for (l=0; l<ng; ++l) m[i+j*nzk] += cg[l+i*ng]*sig[l]*cg[l+j*ng];
+      }
+    }
+    P = d->p + d->op[k];
+    if (k<p->N) {
+      // Add [A B]'*P_(k+1)*[A B]
+      nx1 = p->nx[k+1];
+      ab = d->ab + d->oab[k];
+      P1 = d->p + d->op[k+1];
+      for (j=0; j<nzk; ++j) {
+        for (i=0; i<nx1; ++i) {
+          d->tmp[i+j*nx1] = 0;
+          for (l=0; l<nx1; ++l) d->tmp[i+j*nx1] += P1[i+l*nx1]*ab[l+j*nx1];
+        }
+      }
+      for (j=0; j<nzk; ++j) {
+        for (i=0; i<nzk; ++i) {
+          for (l=0; l<nx1; ++l) m[i+j*nzk] += ab[l+i*nx1]*d->tmp[l+j*nx1];
+        }
+      }
+      // Factorize the control block, Y = L\S with S the control-state block
+      if (casadi_riccati_chol(m+nx+nx*nzk, nu, nzk)) return 1;
+      for (j=0; j<nx; ++j) casadi_riccati_trsv(m+nx+nx*nzk, nu, nzk, m+nx+j*nzk, 0);
+      // Cost-to-go Hessian P_k = Q - Y'*Y
+      Y = m+nx;
+      for (j=0; j<nx; ++j) {
+        for (i=0; i<nx; ++i) {
+          P[i+j*nx] = m[i+j*nzk];
+          for (l=0; l<nu; ++l) P[i+j*nx] -= Y[l+i*nzk]*Y[l+j*nzk];
+        }
+      }
+    } else {
+      casadi_copy(m, nx*nx, P);
+    }
+  }
+  // Factorize the cost-to-go Hessian of the initial state
+  return casadi_riccati_chol(d->p, p->nx[0], p->nx[0]);
+}
+
+// SYMBOL "riccati_kkt"
+// Solve the Newton system with the linear term rz + D'*q using the factorization
+template<typename T1>
+void casadi_riccati_kkt(casadi_riccati_data<T1>* d) {
+  // Local variables
+  casadi_int k, i, j, nx, nu, nzk, nx1;
+  T1 *m, *mk, *pk, *ab, *P1, *dz;
+  const casadi_riccati_prob<T1>* p = d->prob;
+  // Linear term
+  casadi_copy(d->rz, p->nz, d->mv);
+  casadi_riccati_dtmul(d, d->q, d->mv);
+  // Backward recursion for the cost-to-go gradients
+  casadi_copy(d->mv + d->oz[p->N], p->nx[p->N], d->pv + d->oz[p->N]);
+  for (k=p->N-1; k>=0; --k) {
+    nx = p->nx[k];
+    nu = p->nu[k];
+    nzk = nx + nu;
+    nx1 = p->nx[k+1];
+    m = d->m + d->oh[k];
+    mk = d->mv + d->oz[k];
+    pk = d->pv + d->oz[k];
+    ab = d->ab + d->oab[k];
+    P1 = d->p + d->op[k+1];
+    // t = P_(k+1)*rc_k + p_(k+1), m_k += [A B]'*t
+    casadi_copy(d->pv + d->oz[k+1], nx1, d->tmp);
+    casadi_mv_dense(P1, nx1, nx1, d->rc + d->od[k], d->tmp, 0);
+    casadi_mv_dense(ab, nx1, nzk, d->tmp, mk, 1);
+    // Control part, p_k = q - Y'*(L\r)
+    casadi_riccati_trsv(m+nx+nx*nzk, nu, nzk, mk+nx, 0);
+    casadi_copy(mk, nx, pk);
+    for (j=0; j<nx; ++j) {
+      for (i=0; i<nu; ++i) pk[j] -= m[nx+i+j*nzk]*mk[nx+i];
+    }
+  }
+  // Initial state
+  dz = d->dz;
+  for (i=0; i<p->nx[0]; ++i) dz[i] = -d->pv[i];
+  casadi_riccati_trsv(d->p, p->nx[0], p->nx[0], dz, 0);
+  casadi_riccati_trsv(d->p, p->nx[0], p->nx[0], dz, 1);
+  // Forward recursion
+  for (k=0; k<p->N; ++k) {
+    nx = p->nx[k];
+    nu = p->nu[k];
+    nzk = nx + nu;
+    nx1 = p->nx[k+1];
+    m = d->m + d->oh[k];
+    mk = d->mv + d->oz[k];
+    dz = d->dz + d->oz[k];
+    ab = d->ab + d->oab[k];
+    P1 = d->p + d->op[k+1];
+    // du = -L'\(Y*dx + L\r)
+    for (i=0; i<nu; ++i) {
+      dz[nx+i] = mk[nx+i];
+      for (j=0; j<nx; ++j) dz[nx+i] += m[nx+i+j*nzk]*dz[j];
+      dz[nx+i] = -dz[nx+i];
+    }
+    casadi_riccati_trsv(m+nx+nx*nzk, nu, nzk, dz+nx, 1);
+    // dx_(k+1) = [A B]*dz_k + rc_k
+    casadi_copy(d->rc + d->od[k], nx1, dz+nzk);
+    casadi_mv_dense(ab, nx1, nzk, dz, dz+nzk, 0);
+    // dpi_k = P_(k+1)*dx_(k+1) + p_(k+1)
+    casadi_copy(d->pv + d->oz[k+1], nx1, d->dpi + d->od[k]);
+    casadi_mv_dense(P1, nx1, nx1, dz+nzk, d->dpi + d->od[k], 0);
+  }
+}
+
+// SYMBOL "riccati_newton"
+// Newton step for the complementarity target smu, with Mehrotra's correction if corr
+template<typename T1>
+void casadi_riccati_newton(casadi_riccati_data<T1>* d, T1 smu, int corr) {
+  // Local variables
+  casadi_int i, ni;
+  const casadi_riccati_prob<T1>* p = d->prob;
+  ni = p->nz + p->nc;
+  for (i=0; i<ni; ++i) {
+    d->cl[i] = d->cu[i] = d->q[i] = 0;
+    if (d->lb[i] > -p->inf) {
+      d->cl[i] = smu - d->sl[i]*d->ll[i] - (corr ? d->dsl[i]*d->dll[i] : 0);
+      d->q[i] -= (d->cl[i] - d->ll[i]*d->rl[i])/d->sl[i];
+    }
+    if (d->ub[i] < p->inf) {
+      d->cu[i] = smu - d->su[i]*d->lu[i] - (corr ? d->dsu[i]*d->dlu[i] : 0);
+      d->q[i] += (d->cu[i] - d->lu[i]*d->ru[i])/d->su[i];
+    }
+  }
+  casadi_riccati_kkt(d);
+  // Recover the slacks and bound multipliers
+  casadi_riccati_dmul(d, d->dz, d->dv);
+  for (i=0; i<ni; ++i) {
+    d->dsl[i] = d->dll[i] = d->dsu[i] = d->dlu[i] = 0;
+    if (d->lb[i] > -p->inf) {
+      d->dsl[i] = d->dv[i] + d->rl[i];
+      d->dll[i] = (d->cl[i] - d->ll[i]*d->dsl[i])/d->sl[i];
+    }
+    if (d->ub[i] < p->inf) {
+      d->dsu[i] = d->ru[i] - d->dv[i];
+      d->dlu[i] = (d->cu[i] - d->lu[i]*d->dsu[i])/d->su[i];
+    }
+  }
+}
+
+// SYMBOL "riccati_maxstep"
+// Largest step, at most one, keeping the slacks and multipliers positive, scaled by tau
+template<typename T1>
+T1 casadi_riccati_maxstep(casadi_riccati_data<T1>* d, T1 tau) {
+  // Local variables
+  casadi_int i, ni;
+  T1 alpha;
+  const casadi_riccati_prob<T1>* p = d->prob;
+  ni = p->nz + p->nc;
+  alpha = 1;
+  for (i=0; i<ni; ++i) {
+    if (d->dsl[i]<0) alpha = fmin(alpha, -tau*d->sl[i]/d->dsl[i]);
+    if (d->dll[i]<0) alpha = fmin(alpha, -tau*d->ll[i]/d->dll[i]);
+    if (d->dsu[i]<0) alpha = fmin(alpha, -tau*d->su[i]/d->dsu[i]);
+    if (d->dlu[i]<0) alpha = fmin(alpha, -tau*d->lu[i]/d->dlu[i]);
+  }
+  return alpha;
+}
+
+// SYMBOL "riccati_solve"
+// Mehrotra predictor-corrector interior point method, returns 0 if converged,
+// 1 if the maximum number of iterations was reached and 2 if the factorization failed
+template<typename T1>
+int casadi_riccati_solve(casadi_riccati_data<T1>* d) {
+  // Local variables
+  casadi_int i, ni, nfin;
+  T1 alpha, mu_aff, sigma, thr;
+  const casadi_riccati_prob<T1>* p = d->prob;
+  ni = p->nz + p->nc;
+  // Starting point: zero projected on the bounds shrunk by thr, or the midpoint of
+  // narrower boxes, with all slacks at least thr
+  thr = 0.1;
+  for (i=0; i<p->nz; ++i) {
+    if (d->ub[i]-d->lb[i] < 2*thr) {
+      d->z[i] = 0.5*(d->lb[i]+d->ub[i]);
+    } else {
+      d->z[i] = fmin(fmax(0., d->lb[i]+thr), d->ub[i]-thr);
+    }
+  }
+  casadi_fill(d->pi, p->nd, 0.);
+  casadi_riccati_dmul(d, d->z, d->v);
+  for (i=0; i<ni; ++i) {
+    d->sl[i] = d->ll[i] = d->su[i] = d->lu[i] = 0;
+    d->dsl[i] = d->dll[i] = d->dsu[i] = d->dlu[i] = 0;
+    if (d->lb[i] > -p->inf) {
+      d->sl[i] = fmax(thr, d->v[i] - d->lb[i]);
+      d->ll[i] = 1;
+    }
+    if (d->ub[i] < p->inf) {
+      d->su[i] = fmax(thr, d->ub[i] - d->v[i]);
+      d->lu[i] = 1;
+    }
+  }
+  for (d->iter=0; ; ++d->iter) {
+    casadi_riccati_residual(d);
+    if (d->err<=p->tol && d->mu<=p->tol) return 0;
+    if (d->iter>=p->max_iter) return 1;
+    // Barrier terms
+    for (i=0; i<ni; ++i) {
+      d->sig[i] = 0;
+      if (d->lb[i] > -p->inf) d->sig[i] += d->ll[i]/d->sl[i];
+      if (d->ub[i] < p->inf) d->sig[i] += d->lu[i]/d->su[i];
+    }
+    if (casadi_riccati_factor(d)) return 2;
+    // Predictor step
+    casadi_riccati_newton(d, 0., 0);
+    alpha = casadi_riccati_maxstep(d, 1.);
+    mu_aff = 0;
+    nfin = 0;
+    for (i=0; i<ni; ++i) {
+      if (d->lb[i] > -p->inf) {
+        mu_aff += (d->sl[i] + alpha*d->dsl[i])*(d->ll[i] + alpha*d->dll[i]);
+        nfin++;
+      }
+      if (d->ub[i] < p->inf) {
+        mu_aff += (d->su[i] + alpha*d->dsu[i])*(d->lu[i] + alpha*d->dlu[i]);
+        nfin++;
+      }
+    }
+    sigma = 0;
+    if (nfin>0 && d->mu>0) {
+      sigma = mu_aff/nfin/d->mu;
+      sigma = sigma*sigma*sigma;
+    }
+    // Corrector step
+    casadi_riccati_newton(d, sigma*d->mu, 1);
+    alpha = casadi_riccati_maxstep(d, 0.995);
+    casadi_axpy(p->nz, alpha, d->dz, d->z);
+    casadi_axpy(p->nd, alpha, d->dpi, d->pi);
+    casadi_axpy(ni, alpha, d->dsl, d->sl);
+    casadi_axpy(ni, alpha, d->dsu, d->su);
+    casadi_axpy(ni, alpha, d->dll, d->ll);
+    casadi_axpy(ni, alpha, d->dlu, d->lu);
+  }
+}
+
+// SYMBOL "riccati_scatter"
+// Get the solution, the objective value and the multipliers
+template<typename T1>
+void casadi_riccati_scatter(casadi_riccati_data<T1>* d, T1* x, T1* f, T1* lam_a, T1* lam_x) {
+  // Local variables
+  casadi_int k, i, r, t, nzk;
+  const casadi_riccati_prob<T1>* p = d->prob;
+  if (x) casadi_copy(d->z, p->nz, x);
+  if (f) {
+    *f = casadi_dot(p->nz, d->g, d->z);
+    for (k=0; k<=p->N; ++k) {
+      nzk = d->oz[k+1]-d->oz[k];
+      casadi_fill(d->tmp, nzk, 0.);
+      casadi_mv_dense(d->h + d->oh[k], nzk, nzk, d->z + d->oz[k], d->tmp, 0);
+      *f += 0.5*casadi_dot(nzk, d->tmp, d->z + d->oz[k]);
+    }
+  }
+  if (lam_x) {
+    for (i=0; i<p->nz; ++i) lam_x[i] = d->lu[i] - d->ll[i];
+  }
+  if (lam_a) {
+    for (r=0; r<p->na; ++r) {
+      t = d->rtype[r];
+      if (t<0) {
+        lam_a[r] = d->lu[p->nz-1-t] - d->ll[p->nz-1-t];
+      } else {
+        // The dynamic constraints were scaled by -1/e
+        lam_a[r] = -d->pi[t]/d->e[t];
+      }
+    }
+  }
+}
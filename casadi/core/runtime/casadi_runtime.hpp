@@ -86,6 +86,15 @@ namespace casadi {
   void casadi_mtimes(const T1* x, const casadi_int* sp_x, const T1* y, const casadi_int* sp_y,
                              T1* z, const casadi_int* sp_z, T1* w, casadi_int tr);
 
+  /// Dense matrix-matrix multiplication: z <- z + x*y
+  template<typename T1>
+  void casadi_mtimes_dense(const T1* x, casadi_int nrow_x, casadi_int ncol_x,
+                           const T1* y, casadi_int ncol_y, T1* z);
+
+  /// Full discrete convolution: y <- y + conv(h, x)
+  template<typename T1>
+  void casadi_conv(const T1* h, casadi_int nh, const T1* x, casadi_int nx, T1* y);
+
   /// Sparse matrix-vector multiplication: z <- z + x*y
   template<typename T1>
   void casadi_mv(const T1* x, const casadi_int* sp_x, const T1* y, T1* z, casadi_int tr);
@@ -135,12 +144,19 @@ namespace casadi {
   template<typename T1>
   T1 casadi_polyval(const T1* p, casadi_int n, T1 x);
 
+  /// Evaluate a multivariate polynomial, monomial or Chebyshev basis
+  template<typename T1>
+  void casadi_polyval_nd(const T1* x, T1* y, const casadi_int* sp_e, const casadi_int* e,
+      const casadi_int* sp_c, const T1* c, casadi_int cheb, const T1* lb, const T1* ub,
+      const casadi_int* deg_off, T1* w);
+
   // Loop over corners of a hypercube
   casadi_int casadi_flip(casadi_int* corner, casadi_int ndim);
 
   // Find the interval to which a value belongs
   template<typename T1>
-  casadi_int casadi_low(T1 x, const double* grid, casadi_int ng, casadi_int lookup_mode);
+  casadi_int casadi_low(T1 x, const double* grid, casadi_int ng, casadi_int lookup_mode,
+                        const casadi_int* table, casadi_int hint);
 
   // Get weights for the multilinear interpolant
   template<typename T1>
@@ -216,6 +232,8 @@ namespace casadi {
   #include "casadi_minmax.hpp"
   #include "casadi_sum_viol.hpp"
   #include "casadi_mtimes.hpp"
+  #include "casadi_mtimes_dense.hpp"
+  #include "casadi_conv.hpp"
   #include "casadi_mv.hpp"
   #include "casadi_trans.hpp"
   #include "casadi_norm_1.hpp"
@@ -227,6 +245,7 @@ namespace casadi {
   #include "casadi_low.hpp"
   #include "casadi_flip.hpp"
   #include "casadi_polyval.hpp"
+  #include "casadi_polyval_nd.hpp"
   #include "casadi_de_boor.hpp"
   #include "casadi_nd_boor_eval.hpp"
   #include "casadi_interpn_weights.hpp"
@@ -236,10 +255,18 @@ namespace casadi {
   #include "casadi_mv_dense.hpp"
   #include "casadi_finite_diff.hpp"
   #include "casadi_ldl.hpp"
+  #include "casadi_ldl_super.hpp"
   #include "casadi_qr.hpp"
   #include "casadi_bfgs.hpp"
   #include "casadi_regularize.hpp"
   #include "casadi_newton.hpp"
+  #include "casadi_dopri.hpp"
+  #include "casadi_riccati.hpp"
+  #include "casadi_ipqp.hpp"
+  #include "casadi_admm.hpp"
+  #include "casadi_gmres.hpp"
+  #include "casadi_dple.hpp"
+  #include "casadi_expm.hpp"
 } // namespace casadi
 
 /// \endcond
@@ -79,6 +79,8 @@ namespace casadi {
     /// Can the operation be performed inplace (i.e. overwrite the result)
     casadi_int n_inplace() const override { return 1;}
 
+    /// Ignore duplicate assignments, keeping the last one, unless adding
+    static void ignore_duplicates(std::vector<casadi_int>& nz, casadi_int n);
   };
 
 
@@ -231,6 +233,55 @@ namespace casadi {
     Slice inner_, outer_;
   };
 
+  // Specialization of the above when nz_ is piecewise strided, cf. to_runs
+  template<bool Add>
+  class CASADI_EXPORT SetNonzerosRuns : public SetNonzeros<Add>{
+  public:
+
+    /// Constructor
+    SetNonzerosRuns(const MX& y, const MX& x, const std::vector<casadi_int>& runs) :
+        SetNonzeros<Add>(y, x), runs_(runs) {}
+
+    /// Destructor
+    ~SetNonzerosRuns() override {}
+
+    /// Get all the nonzeros
+    std::vector<casadi_int> all() const override { return from_runs(runs_);}
+
+    /** \brief  Propagate sparsity forward */
+    int sp_forward(const bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w) const override;
+
+    /** \brief  Propagate sparsity backwards */
+    int sp_reverse(bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w) const override;
+
+    /// Evaluate the function (template)
+    template<typename T>
+    int eval_gen(const T** arg, T** res, casadi_int* iw, T* w) const;
+
+    /// Evaluate the function numerically
+    int eval(const double** arg, double** res, casadi_int* iw, double* w) const override;
+
+    /// Evaluate the function symbolically (SX)
+    int eval_sx(const SXElem** arg, SXElem** res, casadi_int* iw, SXElem* w) const override;
+
+    /** \brief  Print expression */
+    std::string disp(const std::vector<std::string>& arg) const override;
+
+    /** \brief Generate code for the operation */
+    void generate(CodeGenerator& g,
+                  const std::vector<casadi_int>& arg,
+                  const std::vector<casadi_int>& res) const override;
+
+    /** \brief Check if two nodes are equivalent up to a given depth */
+    bool is_equal(const MXNode* node, casadi_int depth) const override;
+
+    /** Obtain information about node */
+    Dict info() const override { return {{"nz", all()}, {"runs", runs_}, {"add", Add}}; }
+
+    /// Triplets (start, step, length), start -1 for entries not set
+    std::vector<casadi_int> runs_;
+  };
+
 } // namespace casadi
 /// \endcond
 
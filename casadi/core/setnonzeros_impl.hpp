@@ -42,7 +42,27 @@ namespace casadi {
       pair<Slice, Slice> sl = to_slice2(nz);
       return create(y, x, sl.first, sl.second);
     }
-    return MX::create(new SetNonzerosVector<Add>(y, x, nz));
+    // Piecewise strided, after removing duplicate assignments
+    vector<casadi_int> nz1 = nz;
+    ignore_duplicates(nz1, y.nnz());
+    vector<casadi_int> runs = to_runs(nz1);
+    if (!runs.empty()) return MX::create(new SetNonzerosRuns<Add>(y, x, runs));
+    return MX::create(new SetNonzerosVector<Add>(y, x, nz1));
+  }
+
+  template<bool Add>
+  void SetNonzeros<Add>::ignore_duplicates(std::vector<casadi_int>& nz, casadi_int n) {
+    if (Add) return;
+    vector<bool> already_set(n, false);
+    for (vector<casadi_int>::reverse_iterator i=nz.rbegin(); i!=nz.rend(); ++i) {
+      if (*i>=0) {
+        if (already_set[*i]) {
+          *i = -1;
+        } else {
+          already_set[*i] = true;
+        }
+      }
+    }
   }
 
   template<bool Add>
@@ -73,18 +93,7 @@ namespace casadi {
   SetNonzerosVector<Add>::SetNonzerosVector(const MX& y, const MX& x,
       const std::vector<casadi_int>& nz) : SetNonzeros<Add>(y, x), nz_(nz) {
     // Ignore duplicate assignments
-    if (!Add) {
-      vector<bool> already_set(this->nnz(), false);
-      for (vector<casadi_int>::reverse_iterator i=nz_.rbegin(); i!=nz_.rend(); ++i) {
-        if (*i>=0) {
-          if (already_set[*i]) {
-            *i = -1;
-          } else {
-            already_set[*i] = true;
-          }
-        }
-      }
-    }
+    this->ignore_duplicates(nz_, this->nnz());
   }
 
   template<bool Add>
@@ -635,6 +644,44 @@ namespace casadi {
     return 0;
   }
 
+  template<bool Add>
+  int SetNonzerosRuns<Add>::
+  eval(const double** arg, double** res, casadi_int* iw, double* w) const {
+    return eval_gen<double>(arg, res, iw, w);
+  }
+
+  template<bool Add>
+  int SetNonzerosRuns<Add>::
+  eval_sx(const SXElem** arg, SXElem** res, casadi_int* iw, SXElem* w) const {
+    return eval_gen<SXElem>(arg, res, iw, w);
+  }
+
+  template<bool Add>
+  template<typename T>
+  int SetNonzerosRuns<Add>::
+  eval_gen(const T** arg, T** res, casadi_int* iw, T* w) const {
+    const T* idata0 = arg[0];
+    const T* idata = arg[1];
+    T* odata = res[0];
+    if (idata0 != odata) {
+      copy(idata0, idata0+this->dep(0).nnz(), odata);
+    }
+    for (auto r=runs_.begin(); r!=runs_.end(); r+=3) {
+      casadi_int start = r[0], step = r[1], len = r[2];
+      if (start>=0) {
+        for (casadi_int i=0; i<len; ++i) {
+          if (Add) {
+            odata[start+i*step] += idata[i];
+          } else {
+            odata[start+i*step] = idata[i];
+          }
+        }
+      }
+      idata += len;
+    }
+    return 0;
+  }
+
   template<bool Add>
   int SetNonzerosVector<Add>::
   sp_forward(const bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w) const {
@@ -746,6 +793,48 @@ namespace casadi {
     return 0;
   }
 
+  template<bool Add>
+  int SetNonzerosRuns<Add>::
+  sp_forward(const bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w) const {
+    const bvec_t *a0 = arg[0];
+    const bvec_t *a = arg[1];
+    bvec_t *r = res[0];
+    casadi_int n = this->nnz();
+
+    // Propagate sparsity
+    if (r != a0) copy(a0, a0+n, r);
+    for (auto p=runs_.begin(); p!=runs_.end(); p+=3) {
+      for (casadi_int i=0; i<p[2]; ++i, ++a) {
+        if (p[0]<0) continue;
+        if (Add) {
+          r[p[0]+i*p[1]] |= *a;
+        } else {
+          r[p[0]+i*p[1]] = *a;
+        }
+      }
+    }
+    return 0;
+  }
+
+  template<bool Add>
+  int SetNonzerosRuns<Add>::
+  sp_reverse(bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w) const {
+    bvec_t *a = arg[1];
+    bvec_t *r = res[0];
+    for (auto p=runs_.begin(); p!=runs_.end(); p+=3) {
+      for (casadi_int i=0; i<p[2]; ++i, ++a) {
+        if (p[0]<0) continue;
+        casadi_int k = p[0]+i*p[1];
+        *a |= r[k];
+        if (!Add) {
+          r[k] = 0;
+        }
+      }
+    }
+    MXNode::copy_rev(arg[0], r, this->nnz());
+    return 0;
+  }
+
   template<bool Add>
   std::string SetNonzerosVector<Add>::disp(const std::vector<std::string>& arg) const {
     stringstream ss;
@@ -768,6 +857,22 @@ namespace casadi {
     return ss.str();
   }
 
+  template<bool Add>
+  std::string SetNonzerosRuns<Add>::disp(const std::vector<std::string>& arg) const {
+    stringstream ss;
+    ss << "(" << arg.at(0) << "[";
+    for (casadi_int r=0; r<runs_.size(); r+=3) {
+      if (r>0) ss << ", ";
+      if (runs_[r]<0) {
+        ss << "0*" << runs_[r+2];
+      } else {
+        ss << runs_[r] << ":" << runs_[r]+runs_[r+1]*runs_[r+2] << ":" << runs_[r+1];
+      }
+    }
+    ss << "]" << (Add ? " += " : " = ") << arg.at(1) << ")";
+    return ss.str();
+  }
+
   template<bool Add>
   Matrix<casadi_int> SetNonzeros<Add>::mapping() const {
     vector<casadi_int> nz = all();
@@ -793,6 +898,22 @@ namespace casadi {
     return true;
   }
 
+  template<bool Add>
+  bool SetNonzerosRuns<Add>::is_equal(const MXNode* node, casadi_int depth) const {
+    // Check dependencies
+    if (!this->sameOpAndDeps(node, depth)) return false;
+
+    // Check if same node
+    const SetNonzerosRuns<Add>* n = dynamic_cast<const SetNonzerosRuns<Add>*>(node);
+    if (n==nullptr) return false;
+
+    // Check sparsity
+    if (this->sparsity()!=node->sparsity()) return false;
+
+    // Check runs
+    return this->runs_==n->runs_;
+  }
+
   template<bool Add>
   bool SetNonzerosSlice<Add>::is_equal(const MXNode* node, casadi_int depth) const {
     // Check dependencies
@@ -852,6 +973,31 @@ namespace casadi {
       << " if (*cii>=0) rr[*cii] " << (Add?"+=":"=") << " *ss;\n";
   }
 
+  template<bool Add>
+  void SetNonzerosRuns<Add>::
+  generate(CodeGenerator& g,
+           const std::vector<casadi_int>& arg, const std::vector<casadi_int>& res) const {
+    // Copy first argument if not inplace
+    if (arg[0]!=res[0]) {
+      g << g.copy(g.work(arg[0], this->dep(0).nnz()), this->nnz(),
+                          g.work(res[0], this->nnz())) << '\n';
+    }
+
+    // Codegen the runs
+    std::string ind = g.constant(runs_);
+
+    // Perform the operation inplace
+    g.local("cii", "const casadi_int", "*");
+    g.local("rr", "casadi_real", "*");
+    g.local("ss", "casadi_real", "*");
+    g.local("i", "casadi_int");
+    g << "for (cii=" << ind << ", rr=" << g.work(res[0], this->nnz()) << ", "
+      << "ss=" << g.work(arg[1], this->dep(1).nnz()) << "; cii!=" << ind
+      << "+" << runs_.size() << "; cii+=3)"
+      << " for (i=0; i<cii[2]; ++i, ++ss)"
+      << " if (cii[0]>=0) rr[cii[0]+i*cii[1]] " << (Add?"+=":"=") << " *ss;\n";
+  }
+
   template<bool Add>
   void SetNonzerosSlice<Add>::
   generate(CodeGenerator& g,
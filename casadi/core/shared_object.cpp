@@ -44,6 +44,11 @@ namespace casadi {
     count_up();
   }
 
+  SharedObject::SharedObject(SharedObject&& ref) noexcept {
+    node = ref.node;
+    ref.node = nullptr;
+  }
+
   SharedObject::~SharedObject() {
     count_down();
   }
@@ -71,6 +76,18 @@ namespace casadi {
     return *this;
   }
 
+  SharedObject& SharedObject::operator=(SharedObject&& ref) noexcept {
+    if (this == &ref) return *this;
+
+    // decrease the counter and delete if this was the last pointer
+    count_down();
+
+    // take over the reference
+    node = ref.node;
+    ref.node = nullptr;
+    return *this;
+  }
+
   SharedObjectInternal* SharedObject::get() const {
     return node;
   }
@@ -90,7 +107,20 @@ namespace casadi {
 #ifdef WITH_EXTRA_CHECKS
     casadi_assert_dev(Function::call_depth_==0);
 #endif // WITH_EXTRA_CHECKS
-    if (node && --node->count == 0) {
+    if (!node) return;
+#ifdef CASADI_WITH_THREAD
+    if (node->weak_ref_) {
+      // Weakly referenced objects must not be resurrected while being deleted
+      std::shared_ptr<std::mutex> mtx = (*node->weak_ref_)->mutex_;
+      std::lock_guard<std::mutex> lock(*mtx);
+      if (--node->count == 0) {
+        delete node;
+        node = nullptr;
+      }
+      return;
+    }
+#endif // CASADI_WITH_THREAD
+    if (--node->count == 0) {
       delete node;
       node = nullptr;
     }
@@ -145,6 +175,10 @@ namespace casadi {
 
   SharedObject WeakRef::shared() {
     SharedObject ret;
+    if (is_null()) return ret;
+#ifdef CASADI_WITH_THREAD
+    std::lock_guard<std::mutex> lock(*(*this)->mutex_);
+#endif // CASADI_WITH_THREAD
     if (alive()) {
       ret.own((*this)->raw_);
     }
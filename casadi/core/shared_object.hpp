@@ -93,12 +93,18 @@ namespace casadi {
     /// Copy constructor (shallow copy)
     SharedObject(const SharedObject& ref);
 
+    /// Move constructor, takes over the reference without reference counting
+    SharedObject(SharedObject&& ref) noexcept;
+
     /// Destructor
     ~SharedObject();
 
     /// Assignment operator
     SharedObject& operator=(const SharedObject& ref);
 
+    /// Move assignment operator, takes over the reference
+    SharedObject& operator=(SharedObject&& ref) noexcept;
+
     /// \cond INTERNAL
     /// Assign the node to a node class pointer (or null)
     void own(SharedObjectInternal* node);
@@ -68,6 +68,9 @@ namespace casadi {
   }
 
   WeakRefInternal::WeakRefInternal(SharedObjectInternal* raw) : raw_(raw) {
+#ifdef CASADI_WITH_THREAD
+    mutex_ = std::make_shared<std::mutex>();
+#endif // CASADI_WITH_THREAD
   }
 
   WeakRefInternal::~WeakRefInternal() {
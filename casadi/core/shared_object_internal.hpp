@@ -27,6 +27,15 @@
 #define CASADI_SHARED_OBJECT_INTERNAL_HPP
 
 #include "shared_object.hpp"
+#ifdef CASADI_WITH_THREAD
+#ifdef CASADI_WITH_THREAD_MINGW
+#include <mingw.mutex.h>
+#else // CASADI_WITH_THREAD_MINGW
+#include <mutex>
+#endif // CASADI_WITH_THREAD_MINGW
+#include <atomic>
+#include <memory>
+#endif //CASADI_WITH_THREAD
 
 namespace casadi {
 
@@ -83,7 +92,11 @@ namespace casadi {
 
   private:
     /// Number of references pointing to the object
+#ifdef CASADI_WITH_THREAD
+    std::atomic<casadi_int> count;
+#else // CASADI_WITH_THREAD
     casadi_int count;
+#endif // CASADI_WITH_THREAD
 
     /// Weak pointer (non-owning) object for the object
     WeakRef* weak_ref_;
@@ -105,6 +118,11 @@ namespace casadi {
 
     // Raw pointer to the cached object
     SharedObjectInternal* raw_;
+
+#ifdef CASADI_WITH_THREAD
+    // Serializes resurrection (WeakRef::shared) and deletion of the object
+    std::shared_ptr<std::mutex> mutex_;
+#endif // CASADI_WITH_THREAD
   };
 
 
@@ -252,4 +252,40 @@ namespace casadi {
     return make_pair(inner, outer);
   }
 
+  std::vector<casadi_int> CASADI_EXPORT to_runs(const std::vector<casadi_int>& v,
+                                                casadi_int min_len) {
+    std::vector<casadi_int> runs;
+    casadi_int n = v.size();
+    for (casadi_int k=0; k<n;) {
+      casadi_int start, step, len=1;
+      if (v[k]<0) {
+        // Entries not set
+        start = -1;
+        step = 0;
+        while (k+len<n && v[k+len]<0) len++;
+      } else {
+        start = v[k];
+        step = k+1<n && v[k+1]>=0 ? v[k+1]-start : 0;
+        while (k+len<n && v[k+len]>=0 && v[k+len]-v[k+len-1]==step) len++;
+      }
+      // Quick return if not worth it
+      runs.push_back(start);
+      runs.push_back(step);
+      runs.push_back(len);
+      if (runs.size()/3*min_len > n) return {};
+      k += len;
+    }
+    return runs;
+  }
+
+  std::vector<casadi_int> CASADI_EXPORT from_runs(const std::vector<casadi_int>& runs) {
+    std::vector<casadi_int> v;
+    for (casadi_int r=0; r<runs.size(); r+=3) {
+      for (casadi_int i=0; i<runs[r+2]; ++i) {
+        v.push_back(runs[r]<0 ? -1 : runs[r]+i*runs[r+1]);
+      }
+    }
+    return v;
+  }
+
 } // namespace casadi
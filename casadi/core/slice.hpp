@@ -112,6 +112,17 @@ namespace casadi {
   /// Check if an index vector can be represented more efficiently as two nested slices
   bool CASADI_EXPORT is_slice2(const std::vector<casadi_int>& v);
 
+  /** \brief Compress an index vector into runs with a constant stride
+   *
+   * Returns consecutive triplets (start, step, length), where negative entries of v
+   * form runs with start -1. Empty unless the runs are on average at least min_len
+   * entries long. */
+  std::vector<casadi_int> CASADI_EXPORT to_runs(const std::vector<casadi_int>& v,
+                                                casadi_int min_len=8);
+
+  /// Expand runs, as returned by to_runs, to an index vector
+  std::vector<casadi_int> CASADI_EXPORT from_runs(const std::vector<casadi_int>& runs);
+
 } // namespace casadi
 
 #endif // CASADI_SLICE_HPP
@@ -55,8 +55,8 @@ namespace casadi {
   int Solve<Tr>::eval(const double** arg, double** res, casadi_int* iw, double* w) const {
     if (arg[0]!=res[0]) copy(arg[0], arg[0]+dep(0).nnz(), res[0]);
     scoped_checkout<Linsol> mem(linsol_);
-    if (linsol_.sfact(arg[1], mem)) return 1;
-    if (linsol_.nfact(arg[1], mem)) return 1;
+    // Reuses the factorization if the matrix is unchanged since the last evaluation
+    if (linsol_.nfact_cached(arg[1], mem)) return 1;
     if (linsol_.solve(arg[1], res[0], dep(0).size2(), Tr, mem)) return 1;
     return 0;
   }
@@ -0,0 +1,405 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#include "sparse_file.hpp"
+#include "binary_serializer.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+using namespace std;
+
+namespace casadi {
+
+  namespace {
+    // Magic number and byte order mark of the raw CSC format
+    const char csc_magic[] = "CSDCSC01";
+    const int64_t csc_bom = 0x0102030405060708;
+
+    // Output file with a large buffer
+    class BufferedFile {
+    public:
+      explicit BufferedFile(const string& fname) : out_(fname, ios::binary), fname_(fname) {
+        casadi_assert(out_.good(), "Cannot open " + fname);
+        buf_.reserve(buf_size);
+      }
+
+      void put(char c) {
+        buf_.push_back(c);
+        if (buf_.size()>=buf_size) flush();
+      }
+
+      void put(const char* s, size_t n) {
+        buf_.append(s, n);
+        if (buf_.size()>=buf_size) flush();
+      }
+
+      void put(const string& s) { put(s.data(), s.size());}
+
+      void put_int(casadi_int v) {
+        char tmp[24];
+        char* p = tmp + sizeof(tmp);
+        bool neg = v<0;
+        casadi_uint u = neg ? -static_cast<casadi_uint>(v) : v;
+        do {
+          *--p = static_cast<char>('0' + u%10);
+          u /= 10;
+        } while (u);
+        if (neg) *--p = '-';
+        put(p, tmp + sizeof(tmp) - p);
+      }
+
+      void put_double(double v) {
+        // Same format as before, Matrix Market readers expect a decimal representation
+        char tmp[32];
+        int n = snprintf(tmp, sizeof(tmp), "%.15e", v);
+        put(tmp, n);
+      }
+
+      // Binary entries, written directly when large
+      void put_raw(const void* data, size_t n) {
+        if (n<buf_size) {
+          put(static_cast<const char*>(data), n);
+        } else {
+          flush();
+          out_.write(static_cast<const char*>(data), n);
+        }
+      }
+
+      void put_int64(int64_t v) { put_raw(&v, sizeof(v));}
+
+      // Array of integers as int64
+      void put_int64(const casadi_int* v, size_t n) {
+        if (sizeof(casadi_int)==sizeof(int64_t)) {
+          put_raw(v, n*sizeof(int64_t));
+        } else {
+          for (size_t i=0; i<n; ++i) put_int64(static_cast<int64_t>(v[i]));
+        }
+      }
+
+      void close() {
+        flush();
+        out_.close();
+        casadi_assert(!out_.fail(), "Failed to write " + fname_);
+      }
+
+    private:
+      void flush() {
+        out_.write(buf_.data(), buf_.size());
+        buf_.clear();
+      }
+      static const size_t buf_size = 1 << 20;
+      ofstream out_;
+      string fname_;
+      string buf_;
+    };
+
+    // Cursor over a text file in memory
+    class TextCursor {
+    public:
+      TextCursor(const char* begin, const char* end, const string& fname)
+        : pos_(begin), end_(end), fname_(fname) {}
+
+      void error(const string& msg) const {
+        casadi_error(fname_ + ": " + msg);
+      }
+
+      bool at_end() const { return pos_==end_;}
+
+      // Rest of the current line, advancing to the next
+      string line() {
+        const char* eol = static_cast<const char*>(memchr(pos_, '\n', end_-pos_));
+        if (!eol) eol = end_;
+        string r(pos_, eol);
+        pos_ = eol==end_ ? end_ : eol+1;
+        if (!r.empty() && r.back()=='\r') r.pop_back();
+        return r;
+      }
+
+      // Skip lines starting with '%' as well as blank lines
+      void skip_comments() {
+        while (pos_!=end_) {
+          const char* p = pos_;
+          while (p!=end_ && (*p==' ' || *p=='\t')) p++;
+          if (p!=end_ && *p!='%' && *p!='\n' && *p!='\r') break;
+          line();
+        }
+      }
+
+      void skip_space() {
+        while (pos_!=end_ && isspace(static_cast<unsigned char>(*pos_))) pos_++;
+      }
+
+      casadi_int read_int() {
+        skip_space();
+        bool neg = pos_!=end_ && *pos_=='-';
+        if (neg || (pos_!=end_ && *pos_=='+')) pos_++;
+        if (pos_==end_ || !isdigit(static_cast<unsigned char>(*pos_))) error("Integer expected");
+        casadi_int v = 0;
+        while (pos_!=end_ && isdigit(static_cast<unsigned char>(*pos_))) v = 10*v + (*pos_++ - '0');
+        return neg ? -v : v;
+      }
+
+      double read_double() {
+        skip_space();
+        const char* tok_end = pos_;
+        while (tok_end!=end_ && !isspace(static_cast<unsigned char>(*tok_end))) tok_end++;
+        if (tok_end==pos_) error("Number expected");
+        // strtod stops at the whitespace, except for a token at the very end of the file
+        char* e;
+        double d;
+        if (tok_end!=end_) {
+          d = strtod(pos_, &e);
+          if (e!=tok_end) error("Number expected");
+        } else {
+          string tok(pos_, tok_end);
+          d = strtod(tok.c_str(), &e);
+          if (e!=tok.c_str()+tok.size()) error("Number expected");
+        }
+        pos_ = tok_end;
+        return d;
+      }
+
+    private:
+      const char *pos_, *end_;
+      string fname_;
+    };
+
+    // Split a line into lower case words
+    vector<string> words(const string& s) {
+      vector<string> r;
+      string w;
+      for (char c : s) {
+        if (isspace(static_cast<unsigned char>(c))) {
+          if (!w.empty()) r.push_back(w);
+          w.clear();
+        } else {
+          w.push_back(static_cast<char>(tolower(static_cast<unsigned char>(c))));
+        }
+      }
+      if (!w.empty()) r.push_back(w);
+      return r;
+    }
+
+    void write_mtx(const string& filename, const Sparsity& sp, const double* nz) {
+      BufferedFile out(filename);
+      out.put(nz ? "%%MatrixMarket matrix coordinate real general\n"
+                 : "%%MatrixMarket matrix coordinate pattern general\n");
+      out.put_int(sp.size1());
+      out.put(' ');
+      out.put_int(sp.size2());
+      out.put(' ');
+      out.put_int(sp.nnz());
+      out.put('\n');
+      const casadi_int* colind = sp.colind();
+      const casadi_int* row = sp.row();
+      for (casadi_int c=0; c<sp.size2(); ++c) {
+        for (casadi_int k=colind[c]; k<colind[c+1]; ++k) {
+          out.put_int(row[k]+1);
+          out.put(' ');
+          out.put_int(c+1);
+          if (nz) {
+            out.put(' ');
+            out.put_double(nz[k]);
+          }
+          out.put('\n');
+        }
+      }
+      out.close();
+    }
+
+    void write_csc(const string& filename, const Sparsity& sp, const double* nz) {
+      BufferedFile out(filename);
+      out.put_raw(csc_magic, 8);
+      out.put_int64(csc_bom);
+      out.put_int64(sp.size1());
+      out.put_int64(sp.size2());
+      out.put_int64(sp.nnz());
+      out.put_int64(nz ? 1 : 0);
+      out.put_int64(sp.colind(), sp.size2()+1);
+      out.put_int64(sp.row(), sp.nnz());
+      if (nz) out.put_raw(nz, sp.nnz()*sizeof(double));
+      out.close();
+    }
+
+    Sparsity read_mtx(const string& filename, const BinaryBuffer& buf, vector<double>* nz) {
+      TextCursor in(buf.data(), buf.data()+buf.size(), filename);
+      // Header
+      vector<string> h = words(in.line());
+      if (h.size()!=5 || h[0]!="%%matrixmarket" || h[1]!="matrix") {
+        in.error("Not a Matrix Market matrix file");
+      }
+      const string& fmt = h[2], &field = h[3], &symm = h[4];
+      if (field!="real" && field!="integer" && field!="pattern") {
+        in.error("Unsupported field '" + field + "'");
+      }
+      if (symm!="general" && symm!="symmetric" && symm!="skew-symmetric") {
+        in.error("Unsupported symmetry '" + symm + "'");
+      }
+      bool pattern = field=="pattern";
+      in.skip_comments();
+      casadi_int nrow = in.read_int(), ncol = in.read_int();
+      if (nrow<0 || ncol<0) in.error("Negative dimensions");
+
+      if (fmt=="array") {
+        // Dense, column-major
+        if (pattern || symm!="general") in.error("Only real, general arrays are supported");
+        if (nz) {
+          nz->resize(nrow*ncol);
+          for (double& v : *nz) v = in.read_double();
+        }
+        return Sparsity::dense(nrow, ncol);
+      } else if (fmt!="coordinate") {
+        in.error("Unsupported format '" + fmt + "'");
+      }
+
+      // Triplets
+      casadi_int n = in.read_int();
+      if (n<0) in.error("Negative number of entries");
+      bool mirror = symm!="general";
+      double sign = symm=="skew-symmetric" ? -1 : 1;
+      vector<casadi_int> row, col;
+      vector<double> val;
+      row.reserve(mirror ? 2*n : n);
+      col.reserve(mirror ? 2*n : n);
+      if (nz && !pattern) val.reserve(mirror ? 2*n : n);
+      // Entries in column-major order without duplicates, as written by to_file
+      bool sorted = !mirror;
+      for (casadi_int k=0; k<n; ++k) {
+        casadi_int r = in.read_int()-1, c = in.read_int()-1;
+        if (r<0 || r>=nrow || c<0 || c>=ncol) {
+          in.error("Entry " + str(k) + " (" + str(r+1) + ", " + str(c+1) + ") out of range");
+        }
+        if (sorted && k>0) sorted = c>col.back() || (c==col.back() && r>row.back());
+        row.push_back(r);
+        col.push_back(c);
+        double v = pattern ? 1 : in.read_double();
+        if (nz && !pattern) val.push_back(v);
+        if (mirror && r!=c) {
+          row.push_back(c);
+          col.push_back(r);
+          if (nz && !pattern) val.push_back(sign*v);
+        }
+      }
+
+      Sparsity sp;
+      if (sorted) {
+        // Compressed column storage directly
+        vector<casadi_int> colind(ncol+1, 0);
+        for (casadi_int c : col) colind[c+1]++;
+        for (casadi_int c=0; c<ncol; ++c) colind[c+1] += colind[c];
+        sp = Sparsity(nrow, ncol, colind, row);
+      } else {
+        vector<casadi_int> mapping;
+        sp = Sparsity::triplet(nrow, ncol, row, col, mapping, false);
+        if (nz && !pattern) {
+          vector<double> v(mapping.size());
+          for (casadi_int k=0; k<mapping.size(); ++k) v[k] = val[mapping[k]];
+          val.swap(v);
+        }
+      }
+      if (nz) {
+        if (pattern) {
+          nz->assign(sp.nnz(), 1);
+        } else {
+          nz->swap(val);
+        }
+      }
+      return sp;
+    }
+
+    Sparsity read_csc(const string& filename, const BinaryBuffer& buf, vector<double>* nz) {
+      const char* data = buf.data();
+      size_t size = buf.size();
+      casadi_assert(size>=48 && memcmp(data, csc_magic, 8)==0,
+                    filename + ": Not a raw CSC file");
+      const int64_t* h = reinterpret_cast<const int64_t*>(data) + 1;
+      casadi_assert(h[0]==csc_bom, filename + ": Wrong byte order");
+      int64_t nrow = h[1], ncol = h[2], nnz = h[3], has_val = h[4];
+      casadi_assert(nrow>=0 && ncol>=0 && nnz>=0 && nnz<=nrow*ncol,
+                    filename + ": Inconsistent dimensions");
+      size_t n_int = ncol+1+nnz;
+      casadi_assert(size==48+8*(n_int + (has_val ? nnz : 0)),
+                    filename + ": Unexpected file size");
+      const int64_t* colind = h + 5;
+      const int64_t* row = colind + ncol + 1;
+      // Check the pattern, the file may be corrupt
+      bool ok = colind[0]==0 && colind[ncol]==nnz;
+      for (int64_t c=0; ok && c<ncol; ++c) {
+        ok = colind[c]<=colind[c+1];
+        for (int64_t k=colind[c]; ok && k<colind[c+1]; ++k) {
+          ok = row[k]>=0 && row[k]<nrow && (k==colind[c] || row[k]>row[k-1]);
+        }
+      }
+      casadi_assert(ok, filename + ": Invalid sparsity pattern");
+      Sparsity sp;
+      if (sizeof(casadi_int)==sizeof(int64_t)) {
+        sp = Sparsity(nrow, ncol, reinterpret_cast<const casadi_int*>(colind),
+                      reinterpret_cast<const casadi_int*>(row));
+      } else {
+        sp = Sparsity(nrow, ncol, vector<casadi_int>(colind, colind+ncol+1),
+                      vector<casadi_int>(row, row+nnz));
+      }
+      if (nz) {
+        if (has_val) {
+          const double* v = reinterpret_cast<const double*>(row + nnz);
+          nz->assign(v, v+nnz);
+        } else {
+          nz->assign(nnz, 1);
+        }
+      }
+      return sp;
+    }
+  } // namespace
+
+  void write_sparse(const string& filename, const string& format,
+                    const Sparsity& sp, const double* nz) {
+    if (format=="mtx") {
+      write_mtx(filename, sp, nz);
+    } else if (format=="csc") {
+      write_csc(filename, sp, nz);
+    } else {
+      casadi_error("Unknown format '" + format + "'");
+    }
+  }
+
+  Sparsity read_sparse(const string& filename, const string& format, vector<double>* nz) {
+    BinaryBuffer buf(filename);
+    if (format=="mtx") {
+      return read_mtx(filename, buf, nz);
+    } else if (format=="csc") {
+      return read_csc(filename, buf, nz);
+    } else {
+      casadi_error("Unknown format '" + format + "'");
+      return Sparsity();
+    }
+  }
+
+} // namespace casadi
@@ -0,0 +1,66 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#ifndef CASADI_SPARSE_FILE_HPP
+#define CASADI_SPARSE_FILE_HPP
+
+#include "sparsity.hpp"
+
+#include <string>
+#include <vector>
+
+/// \cond INTERNAL
+
+namespace casadi {
+
+  /** \brief Write a sparse matrix to a file, cf. Sparsity::to_file and DM::to_file
+
+  Formats:
+    - "mtx": Matrix Market coordinate format, "pattern" if nz is null, else "real"
+    - "csc": Raw compressed column storage, 8-byte entries in host byte order. The
+      magic "CSDCSC01", a byte order mark, nrow, ncol, nnz and 1 if there are values,
+      followed by colind (ncol+1 entries), row (nnz entries) and the values, if any
+
+  Output is buffered, such that writing is limited by the disk rather than by formatting.
+  */
+  CASADI_EXPORT void write_sparse(const std::string& filename, const std::string& format,
+                                  const Sparsity& sp, const double* nz);
+
+  /** \brief Read a sparse matrix from a file, cf. Sparsity::from_file and DM::from_file
+
+  The file is memory-mapped where supported. Matrix Market files may be in the
+  coordinate format, "real", "integer" or "pattern", and "general" or "symmetric", or
+  in the general array format. If nz is not null, the values are returned in it,
+  ones for a pattern.
+  */
+  CASADI_EXPORT Sparsity read_sparse(const std::string& filename, const std::string& format,
+                                     std::vector<double>* nz);
+
+} // namespace casadi
+
+/// \endcond
+
+#endif // CASADI_SPARSE_FILE_HPP
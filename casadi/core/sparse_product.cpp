@@ -0,0 +1,158 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#include "sparse_product.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace casadi {
+
+  // Minimum number of multiply-adds per parallel block
+  static const casadi_int min_block_flops = 1<<14;
+
+  SparseProduct::SparseProduct(const Sparsity& x, const Sparsity& y, casadi_int n_threads)
+      : x_(x), y_(y) {
+    casadi_assert(x.size2()==y.size1(),
+                  "Matrix product with incompatible dimensions. Lhs is "
+                  + x.dim() + " and rhs is " + y.dim() + ".");
+    z_ = Sparsity::mtimes(x, y);
+    dense_ = x.is_dense() && y.is_dense();
+    casadi_int ncol = y.size2();
+    const casadi_int *x_colind = x.colind(), *x_row = x.row();
+    const casadi_int *y_colind = y.colind(), *y_row = y.row();
+    const casadi_int *z_colind = z_.colind(), *z_row = z_.row();
+
+    // Count the multiply-adds per column
+    flop_offset_.resize(ncol+1);
+    flop_offset_[0] = 0;
+    for (casadi_int j=0; j<ncol; ++j) {
+      casadi_int n = 0;
+      for (casadi_int ky=y_colind[j]; ky<y_colind[j+1]; ++ky) {
+        casadi_int k = y_row[ky];
+        n += x_colind[k+1] - x_colind[k];
+      }
+      flop_offset_[j+1] = flop_offset_[j] + n;
+    }
+    n_flops_ = flop_offset_.back();
+
+    // Nonzero of z updated by each multiply-add
+    if (!dense_) {
+      zloc_.resize(n_flops_);
+      vector<casadi_int> iw(z_.size1());
+      casadi_int* p = get_ptr(zloc_);
+      for (casadi_int j=0; j<ncol; ++j) {
+        for (casadi_int kz=z_colind[j]; kz<z_colind[j+1]; ++kz) iw[z_row[kz]] = kz;
+        for (casadi_int ky=y_colind[j]; ky<y_colind[j+1]; ++ky) {
+          casadi_int k = y_row[ky];
+          for (casadi_int kx=x_colind[k]; kx<x_colind[k+1]; ++kx) *p++ = iw[x_row[kx]];
+        }
+      }
+    }
+
+    // Split the columns into blocks with a similar number of multiply-adds
+    casadi_int n_blocks = max(casadi_int(1), min(n_threads, n_flops_/min_block_flops));
+    block_.push_back(0);
+    for (casadi_int b=1; b<n_blocks; ++b) {
+      casadi_int target = b*n_flops_/n_blocks;
+      casadi_int j = upper_bound(flop_offset_.begin() + block_.back(), flop_offset_.end()-1,
+                                 target) - flop_offset_.begin() - 1;
+      if (j>block_.back()) block_.push_back(j);
+    }
+    block_.push_back(ncol);
+  }
+
+  void SparseProduct::check(const Sparsity& x, const Sparsity& y, const Sparsity& z) const {
+    casadi_assert(x==x_ && y==y_,
+                  "SparseProduct: factors have patterns " + x.dim() + " and " + y.dim()
+                  + ", but the plan is for " + x_.dim() + " and " + y_.dim());
+    casadi_assert(z==z_, "SparseProduct: output pattern " + z.dim()
+                  + " does not match sparsity_out() " + z_.dim());
+  }
+
+  DM SparseProduct::mtimes(const DM& x, const DM& y) const {
+    DM z = DM::zeros(z_);
+    mac(DMView(const_cast<DM&>(x)), DMView(const_cast<DM&>(y)), DMView(z));
+    return z;
+  }
+
+  DM SparseProduct::mac(const DM& x, const DM& y, const DM& z) const {
+    DM ret = z;
+    mac(DMView(const_cast<DM&>(x)), DMView(const_cast<DM&>(y)), DMView(ret));
+    return ret;
+  }
+
+  void SparseProduct::mtimes(const DMView& x, const DMView& y, const DMView& z) const {
+    check(x.sparsity(), y.sparsity(), z.sparsity());
+    casadi_fill(z.ptr(), z_.nnz(), 0.);
+    mac(x.ptr(), y.ptr(), z.ptr());
+  }
+
+  void SparseProduct::mac(const DMView& x, const DMView& y, const DMView& z) const {
+    check(x.sparsity(), y.sparsity(), z.sparsity());
+    mac(x.ptr(), y.ptr(), z.ptr());
+  }
+
+  void SparseProduct::mac(const double* x, const double* y, double* z) const {
+    casadi_int n_blocks = block_.size()-1;
+    if (n_blocks==1) {
+      mac_cols(x, y, z, 0, y_.size2());
+    } else {
+      ThreadPool::run(n_blocks, n_blocks, [&](casadi_int b, casadi_int t) {
+        mac_cols(x, y, z, block_[b], block_[b+1]);
+      });
+    }
+  }
+
+  void SparseProduct::mac_cols(const double* x, const double* y, double* z,
+                               casadi_int j0, casadi_int j1) const {
+    if (dense_) {
+      casadi_int nrow = x_.size1(), n = x_.size2();
+      casadi_mtimes_dense(x, nrow, n, y + j0*n, j1-j0, z + j0*nrow);
+      return;
+    }
+    const casadi_int *x_colind = x_.colind();
+    const casadi_int *y_colind = y_.colind(), *y_row = y_.row();
+    const casadi_int* p = get_ptr(zloc_) + flop_offset_[j0];
+    for (casadi_int j=j0; j<j1; ++j) {
+      for (casadi_int ky=y_colind[j]; ky<y_colind[j+1]; ++ky) {
+        double yv = y[ky];
+        casadi_int k = y_row[ky];
+        for (casadi_int kx=x_colind[k]; kx<x_colind[k+1]; ++kx) z[*p++] += x[kx]*yv;
+      }
+    }
+  }
+
+  void SparseProduct::disp(std::ostream& stream, bool more) const {
+    stream << "SparseProduct(" << x_.dim() << "*" << y_.dim() << " -> " << z_.dim()
+           << ", " << n_flops_ << " flops";
+    if (block_.size()>2) stream << ", " << (block_.size()-1) << " blocks";
+    stream << ")";
+  }
+
+} // namespace casadi
@@ -0,0 +1,122 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#ifndef CASADI_SPARSE_PRODUCT_HPP
+#define CASADI_SPARSE_PRODUCT_HPP
+
+#include "sx_elem.hpp"
+#include "dm_view.hpp"
+#include "printable.hpp"
+#include <sstream>
+
+namespace casadi {
+
+  /** \brief Sparse matrix product z = x*y with a precomputed symbolic phase
+
+      The sparsity pattern of the product and, for every multiply-add, the nonzero of z
+      that it updates are computed once for fixed patterns of x and y. Each numerical
+      product is then a single pass over the multiply-adds, without any pattern
+      computations, work vectors or allocations for the in-place variants.
+
+      With n_threads>1, the columns of z are split into blocks with a similar number of
+      multiply-adds that are evaluated in parallel. If both factors are dense, the
+      blocked dense kernel is used instead of the precomputed positions.
+
+      \date 2026
+  */
+  class CASADI_EXPORT SparseProduct
+    : public SWIG_IF_ELSE(PrintableCommon, Printable<SparseProduct>) {
+  public:
+    /// Default constructor
+    SparseProduct() : n_flops_(0) {}
+
+    /// Symbolic phase for the product of matrices with patterns x and y
+    SparseProduct(const Sparsity& x, const Sparsity& y, casadi_int n_threads=1);
+
+    ///@{
+    /// Sparsity patterns of the factors and the product
+    Sparsity sparsity_x() const { return x_;}
+    Sparsity sparsity_y() const { return y_;}
+    Sparsity sparsity_out() const { return z_;}
+    ///@}
+
+    /// Number of multiply-adds per product
+    casadi_int n_flops() const { return n_flops_;}
+
+    /// Matrix product x*y
+    DM mtimes(const DM& x, const DM& y) const;
+
+    /// Matrix product z + x*y, z with the pattern sparsity_out()
+    DM mac(const DM& x, const DM& y, const DM& z) const;
+
+#ifndef SWIG
+    /// In place z <- x*y, z with the pattern sparsity_out()
+    void mtimes(const DMView& x, const DMView& y, const DMView& z) const;
+
+    /// In place z <- z + x*y, z with the pattern sparsity_out()
+    void mac(const DMView& x, const DMView& y, const DMView& z) const;
+
+    /// In place z <- z + x*y on the nonzeros, no pattern checks
+    void mac(const double* x, const double* y, double* z) const;
+
+    /// Print a description of the object
+    void disp(std::ostream& stream, bool more=false) const;
+
+    /// Get string representation
+    std::string get_str(bool more=false) const {
+      std::stringstream ss;
+      disp(ss, more);
+      return ss.str();
+    }
+#endif // SWIG
+
+  private:
+    // Check the patterns of the operands
+    void check(const Sparsity& x, const Sparsity& y, const Sparsity& z) const;
+
+    // Evaluate columns [j0, j1) of z
+    void mac_cols(const double* x, const double* y, double* z,
+                  casadi_int j0, casadi_int j1) const;
+
+    // Sparsity patterns
+    Sparsity x_, y_, z_;
+
+    // Use the dense kernel
+    bool dense_;
+
+    // Number of multiply-adds
+    casadi_int n_flops_;
+
+    // Multiply-adds of column j are zloc_[flop_offset_[j]], ..., zloc_[flop_offset_[j+1]-1]
+    std::vector<casadi_int> flop_offset_, zloc_;
+
+    // Columns of the parallel blocks
+    std::vector<casadi_int> block_;
+  };
+
+} // namespace casadi
+
+#endif // CASADI_SPARSE_PRODUCT_HPP
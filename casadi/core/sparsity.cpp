@@ -28,6 +28,8 @@
 #include "matrix.hpp"
 #include "casadi_misc.hpp"
 #include "sparse_storage_impl.hpp"
+#include "sparse_file.hpp"
+#include "thread_pool.hpp"
 #include <climits>
 
 #define CASADI_THROW_ERROR(FNAME, WHAT) \
@@ -40,6 +42,64 @@ namespace casadi {
   // Instantiate templates
   template class SparseStorage<Sparsity>;
 
+  namespace {
+    // Number of independently locked parts of the cache of sparsity patterns
+    const std::size_t n_cache_shards = 64;
+
+    // Part of the cache of sparsity patterns, selected by the hash of the pattern
+    struct CacheShard {
+      Sparsity::CachingMap map;
+#ifdef CASADI_WITH_THREAD
+      std::mutex mtx;
+#endif // CASADI_WITH_THREAD
+    };
+
+    CacheShard& cache_shard(std::size_t h) {
+      static CacheShard shards[n_cache_shards];
+      return shards[h % n_cache_shards];
+    }
+
+    // Cache statistics
+#ifdef CASADI_WITH_THREAD
+    std::atomic<casadi_int> cache_hits(0), cache_misses(0);
+#else // CASADI_WITH_THREAD
+    casadi_int cache_hits = 0, cache_misses = 0;
+#endif // CASADI_WITH_THREAD
+
+    // Stable counting sort of perm by key[perm[k]], 0<=key<nkey
+    // Entries are split into consecutive blocks that are counted and scattered in parallel
+    void radix_pass(const std::vector<casadi_int>& key, casadi_int nkey,
+                    const std::vector<casadi_int>& perm, std::vector<casadi_int>& perm_out,
+                    casadi_int n_threads) {
+      casadi_int n = perm.size();
+      // Per-block counters only pay off if there are enough entries per key
+      casadi_int n_blocks = std::max(casadi_int(1), std::min(n_threads, n/(nkey+1024)));
+      std::vector<casadi_int> count(n_blocks*nkey, 0);
+      // Count the entries of each block
+      ThreadPool::run(n_blocks, n_blocks, [&](casadi_int b, casadi_int t) {
+        casadi_int* c = get_ptr(count) + b*nkey;
+        for (casadi_int k=b*n/n_blocks; k<(b+1)*n/n_blocks; ++k) c[key[perm[k]]]++;
+      });
+      // Offsets, blocks ordered within each key to keep the sort stable
+      casadi_int offset = 0;
+      for (casadi_int i=0; i<nkey; ++i) {
+        for (casadi_int b=0; b<n_blocks; ++b) {
+          casadi_int c = count[b*nkey+i];
+          count[b*nkey+i] = offset;
+          offset += c;
+        }
+      }
+      // Scatter
+      perm_out.resize(n);
+      ThreadPool::run(n_blocks, n_blocks, [&](casadi_int b, casadi_int t) {
+        casadi_int* c = get_ptr(count) + b*nkey;
+        for (casadi_int k=b*n/n_blocks; k<(b+1)*n/n_blocks; ++k) {
+          perm_out[c[key[perm[k]]]++] = perm[k];
+        }
+      });
+    }
+  } // namespace
+
   /// \cond INTERNAL
   // Singletons
   class EmptySparsity : public Sparsity {
@@ -496,11 +556,6 @@ namespace casadi {
     }
   }
 
-  Sparsity::CachingMap& Sparsity::getCache() {
-    static CachingMap ret;
-    return ret;
-  }
-
   const Sparsity& Sparsity::getScalar() {
     static ScalarSparsity ret;
     return ret;
@@ -668,6 +723,83 @@ namespace casadi {
     R = compressed(sp_r, true);
   }
 
+  void Sparsity::lu_sparse(Sparsity& L, Sparsity& U, std::vector<casadi_int>& rowperm,
+                           std::vector<casadi_int>& colperm) const {
+    casadi_assert(is_square(), "LU factorization requires a square matrix");
+    casadi_int n = size2();
+
+    // Block triangular form, zero-free diagonal if structurally nonsingular
+    std::vector<casadi_int> rowblock, colblock, coarse_rowblock, coarse_colblock;
+    casadi_int nb = btf(rowperm, colperm, rowblock, colblock,
+                        coarse_rowblock, coarse_colblock);
+    casadi_assert(coarse_colblock.at(3)==n, "LU factorization requires a structurally "
+                  "nonsingular matrix, but the structural rank is "
+                  + str(coarse_colblock.at(3)) + " < " + str(n));
+
+    // Symmetric fill-reducing ordering within each diagonal block
+    std::vector<casadi_int> rr, cc, tmp;
+    for (casadi_int b=0; b<nb; ++b) {
+      casadi_int r0 = rowblock[b], c0 = colblock[b], nn = rowblock[b+1] - r0;
+      if (nn<=2) continue;
+      rr.assign(rowperm.begin()+r0, rowperm.begin()+r0+nn);
+      cc.assign(colperm.begin()+c0, colperm.begin()+c0+nn);
+      Sparsity B = sub(rr, cc, tmp);
+      std::vector<casadi_int> q = (B + B.T()).amd();
+      for (casadi_int k=0; k<nn; ++k) {
+        rowperm[r0+k] = rr[q[k]];
+        colperm[c0+k] = cc[q[k]];
+      }
+    }
+    Sparsity A = sub(rowperm, colperm, tmp);
+    const casadi_int *colind = A.colind(), *row = A.row();
+
+    // Left-looking elimination: the nonzeros of column j of L+U are the rows reachable
+    // from A(:, j) in the graph of L(:, 0:j-1)
+    std::vector<std::vector<casadi_int> > Lc(n);
+    std::vector<casadi_int> U_colind(n+1, 0), U_row, L_colind(n+1, 0), L_row;
+    std::vector<casadi_int> mark(n, -1), stack, pos, reach;
+    for (casadi_int j=0; j<n; ++j) {
+      reach.clear();
+      for (casadi_int el=colind[j]; el<colind[j+1]; ++el) {
+        casadi_int r = row[el];
+        if (mark[r]==j) continue;
+        // Iterative depth-first search, nodes are added in post-order
+        mark[r] = j;
+        stack.assign(1, r);
+        pos.assign(1, 0);
+        while (!stack.empty()) {
+          casadi_int k = stack.back(), &p = pos.back();
+          if (k<j && p<Lc[k].size()) {
+            casadi_int i = Lc[k][p++];
+            if (mark[i]!=j) {
+              mark[i] = j;
+              stack.push_back(i);
+              pos.push_back(0);
+            }
+          } else {
+            reach.push_back(k);
+            stack.pop_back();
+            pos.pop_back();
+          }
+        }
+      }
+      std::sort(reach.begin(), reach.end());
+      casadi_assert_dev(mark[j]==j);
+      for (casadi_int i : reach) {
+        if (i<=j) {
+          U_row.push_back(i);
+        } else {
+          L_row.push_back(i);
+          Lc[j].push_back(i);
+        }
+      }
+      U_colind[j+1] = U_row.size();
+      L_colind[j+1] = L_row.size();
+    }
+    L = Sparsity(n, n, L_colind, L_row, true);
+    U = Sparsity(n, n, U_colind, U_row, true);
+  }
+
   casadi_int Sparsity::dfs(casadi_int j, casadi_int top, std::vector<casadi_int>& xi,
                             std::vector<casadi_int>& pstack,
                             const std::vector<casadi_int>& pinv,
@@ -683,6 +815,30 @@ namespace casadi {
     return (*this)->amd();
   }
 
+  std::vector<casadi_int> Sparsity::nd() const {
+    return (*this)->nd();
+  }
+
+  std::vector<casadi_int> Sparsity::ordering(const std::string& method) const {
+    if (method=="natural") {
+      casadi_assert(is_symmetric(), "Ordering requires a symmetric matrix");
+      return range(size2());
+    } else if (method=="amd") {
+      return amd();
+    } else if (method=="nd") {
+      return nd();
+    } else if (method=="auto") {
+      // Predicted number of nonzeros in the factor
+      std::vector<casadi_int> p_amd = amd(), p_nd = nd(), tmp;
+      casadi_int nnz_amd = sub(p_amd, p_amd, tmp).ldl(tmp, false).nnz();
+      casadi_int nnz_nd = sub(p_nd, p_nd, tmp).ldl(tmp, false).nnz();
+      return nnz_nd<nnz_amd ? p_nd : p_amd;
+    } else {
+      casadi_error("Unknown ordering '" + method + "'. "
+                   "Choose from 'natural', 'amd', 'nd' or 'auto'.");
+    }
+  }
+
   casadi_int Sparsity::btf(std::vector<casadi_int>& rowperm, std::vector<casadi_int>& colperm,
                             std::vector<casadi_int>& rowblock, std::vector<casadi_int>& colblock,
                             std::vector<casadi_int>& coarse_rowblock,
@@ -721,16 +877,24 @@ namespace casadi {
     (*this)->get_nz(indices);
   }
 
-  Sparsity Sparsity::uni_coloring(const Sparsity& AT, casadi_int cutoff) const {
+  std::vector<casadi_int> Sparsity::get_nz_elements(const std::vector<casadi_int>& rr,
+                                                    const std::vector<casadi_int>& cc,
+                                                    casadi_int n_threads) const {
+    return (*this)->get_nz_elements(rr, cc, n_threads);
+  }
+
+  Sparsity Sparsity::uni_coloring(const Sparsity& AT, casadi_int cutoff,
+                                  casadi_int n_threads) const {
     if (AT.is_null()) {
-      return (*this)->uni_coloring(T(), cutoff);
+      return (*this)->uni_coloring(T(), cutoff, n_threads);
     } else {
-      return (*this)->uni_coloring(AT, cutoff);
+      return (*this)->uni_coloring(AT, cutoff, n_threads);
     }
   }
 
-  Sparsity Sparsity::star_coloring(casadi_int ordering, casadi_int cutoff) const {
-    return (*this)->star_coloring(ordering, cutoff);
+  Sparsity Sparsity::star_coloring(casadi_int ordering, casadi_int cutoff,
+                                   casadi_int n_threads) const {
+    return (*this)->star_coloring(ordering, cutoff, n_threads);
   }
 
   Sparsity Sparsity::star_coloring2(casadi_int ordering, casadi_int cutoff) const {
@@ -848,8 +1012,12 @@ namespace casadi {
     // Hash the pattern
     std::size_t h = hash_sparsity(nrow, ncol, colind, row);
 
-    // Get a reference to the cache
-    CachingMap& cache = getCache();
+    // Get a reference to the part of the cache holding the pattern
+    CacheShard& shard = cache_shard(h);
+    CachingMap& cache = shard.map;
+#ifdef CASADI_WITH_THREAD
+    std::lock_guard<std::mutex> lock(shard.mtx);
+#endif // CASADI_WITH_THREAD
 
     // Record the current number of buckets (for garbage collection below)
     casadi_int bucket_count_before = cache.bucket_count();
@@ -863,20 +1031,17 @@ namespace casadi {
       // Loop over maching patterns
       for (CachingMap::iterator i=eq.first; i!=eq.second; ++i) {
 
-        // Get a weak reference to the cached sparsity pattern
-        WeakRef& wref = i->second;
-
-        // Check if the pattern still exists
-        if (wref.alive()) {
-
-          // Get an owning reference to the cached pattern
-          Sparsity ref = shared_cast<Sparsity>(wref.shared());
+        // Get an owning reference to the cached sparsity pattern, if it still exists
+        SharedObject ref_i = i->second.shared();
+        if (!ref_i.is_null()) {
 
           // Check if the pattern matches
+          Sparsity ref = shared_cast<Sparsity>(ref_i);
           if (ref.is_equal(nrow, ncol, colind, row)) {
 
             // Found match!
             own(ref.get());
+            cache_hits++;
             return;
 
           } else { // There is a hash rowision (unlikely, but possible)
@@ -889,14 +1054,16 @@ namespace casadi {
           CachingMap::iterator j=i;
           j++; // Start at the next matching key
           for (; j!=eq.second; ++j) {
-            if (j->second.alive()) {
+            SharedObject ref_j = j->second.shared();
+            if (!ref_j.is_null()) {
 
               // Recover cached sparsity
-              Sparsity ref = shared_cast<Sparsity>(j->second.shared());
+              Sparsity ref = shared_cast<Sparsity>(ref_j);
 
               // Match found if sparsity matches
               if (ref.is_equal(nrow, ncol, colind, row)) {
                 own(ref.get());
+                cache_hits++;
                 return;
               }
             }
@@ -904,9 +1071,10 @@ namespace casadi {
 
           // The cached entry has been deleted, create a new one
           own(new SparsityInternal(nrow, ncol, colind, row));
+          cache_misses++;
 
           // Cache this pattern
-          wref = *this;
+          i->second = *this;
 
           // Return
           return;
@@ -916,6 +1084,7 @@ namespace casadi {
 
     // No matching sparsity pattern could be found, create a new one
     own(new SparsityInternal(nrow, ncol, colind, row));
+    cache_misses++;
 
     // Cache this pattern
     cache.insert(std::pair<std::size_t, WeakRef>(h, *this));
@@ -936,6 +1105,32 @@ namespace casadi {
     }
   }
 
+  Dict Sparsity::cache_stats() {
+    casadi_int n_pattern = 0, n_bytes = 0;
+    for (std::size_t k=0; k<n_cache_shards; ++k) {
+      CacheShard& shard = cache_shard(k);
+#ifdef CASADI_WITH_THREAD
+      std::lock_guard<std::mutex> lock(shard.mtx);
+#endif // CASADI_WITH_THREAD
+      // Buckets and nodes of the hash map
+      n_bytes += shard.map.bucket_count()*sizeof(void*)
+        + shard.map.size()*(sizeof(CachingMap::value_type) + sizeof(void*));
+      // Cached patterns still alive
+      for (auto&& e : shard.map) {
+        SharedObject ref = e.second.shared();
+        if (ref.is_null()) continue;
+        const Sparsity& sp = shared_cast<Sparsity>(ref);
+        n_pattern++;
+        n_bytes += sizeof(SparsityInternal) + sizeof(WeakRefInternal)
+          + (3 + sp.size2() + sp.nnz())*sizeof(casadi_int);
+      }
+    }
+    return {{"n_hit", static_cast<casadi_int>(cache_hits)},
+            {"n_miss", static_cast<casadi_int>(cache_misses)},
+            {"n_pattern", n_pattern},
+            {"n_bytes", n_bytes}};
+  }
+
   Sparsity Sparsity::tril(const Sparsity& x, bool includeDiagonal) {
     return x->_tril(includeDiagonal);
   }
@@ -1053,12 +1248,21 @@ namespace casadi {
   }
 
   Sparsity Sparsity::banded(casadi_int n, casadi_int p) {
-    // This is not an efficient implementation
-    Sparsity ret = Sparsity(n, n);
-    for (casadi_int i=-p;i<=p;++i) {
-      ret = ret + Sparsity::band(n, i);
+    return banded(n, p, p);
+  }
+
+  Sparsity Sparsity::banded(casadi_int n, casadi_int lower, casadi_int upper) {
+    casadi_assert(n>=0, "Sparsity::banded expects a positive integer as argument");
+    casadi_assert(lower>=0 && upper>=0, "Sparsity::banded: half-bandwidths must be nonnegative");
+    std::vector<casadi_int> colind(n+1), row;
+    colind[0] = 0;
+    for (casadi_int c=0; c<n; ++c) {
+      for (casadi_int r=std::max(casadi_int(0), c-upper); r<=std::min(n-1, c+lower); ++r) {
+        row.push_back(r);
+      }
+      colind[c+1] = row.size();
     }
-    return ret;
+    return Sparsity(n, n, colind, row);
   }
 
   Sparsity Sparsity::unit(casadi_int n, casadi_int el) {
@@ -1240,6 +1444,43 @@ namespace casadi {
     return Sparsity::triplet(nrow, ncol, row, col, mapping, false);
   }
 
+  Sparsity Sparsity::assemble(casadi_int nrow, casadi_int ncol,
+                              const std::vector<casadi_int>& row,
+                              const std::vector<casadi_int>& col,
+                              std::vector<casadi_int>& nz, casadi_int n_threads) {
+    casadi_assert_dev(nrow>=0);
+    casadi_assert_dev(ncol>=0);
+    casadi_assert(col.size()==row.size(), "inconsistent lengths");
+    casadi_int n = row.size();
+    for (casadi_int k=0; k<n; ++k) {
+      casadi_assert(col[k]>=0 && col[k]<ncol, "Column index out of bounds");
+      casadi_assert(row[k]>=0 && row[k]<nrow, "Row index out of bounds");
+    }
+
+    // Least significant digit first: sort by row, then stably by column
+    std::vector<casadi_int> perm(n), perm1;
+    for (casadi_int k=0; k<n; ++k) perm[k] = k;
+    radix_pass(row, nrow, perm, perm1, n_threads);
+    radix_pass(col, ncol, perm1, perm, n_threads);
+
+    // Merge duplicates, writing the compressed column format directly
+    std::vector<casadi_int> r_colind(ncol+1, 0), r_row;
+    r_row.reserve(n);
+    nz.resize(n);
+    casadi_int last_row=-1, last_col=-1;
+    for (casadi_int k : perm) {
+      if (row[k]!=last_row || col[k]!=last_col) {
+        last_row = row[k];
+        last_col = col[k];
+        r_row.push_back(last_row);
+        r_colind[last_col+1]++;
+      }
+      nz[k] = r_row.size()-1;
+    }
+    for (casadi_int c=0; c<ncol; ++c) r_colind[c+1] += r_colind[c];
+    return Sparsity(nrow, ncol, r_colind, r_row);
+  }
+
   Sparsity Sparsity::nonzeros(casadi_int nrow, casadi_int ncol,
       const std::vector<casadi_int>& nz, bool ind1) {
     casadi_assert(nrow>0, "nrow must be >0.");
@@ -1327,41 +1568,29 @@ namespace casadi {
     if (sp.empty()) return Sparsity(0, 0);
     if (sp.size()==1) return sp.front();
 
-    // Count total nnz
-    casadi_int nnz_total = 0;
-    for (casadi_int i=0; i<sp.size(); ++i) nnz_total += sp[i].nnz();
-
-    // Construct from vectors (triplet format)
-    vector<casadi_int> ret_row, ret_col;
-    ret_row.reserve(nnz_total);
-    ret_col.reserve(nnz_total);
-    casadi_int ret_ncol = 0;
-    casadi_int ret_nrow = 0;
-    for (casadi_int i=0; i<sp.size() && ret_nrow==0; ++i)
-      ret_nrow = sp[i].size1();
-
-    // Append all patterns
-    for (vector<Sparsity>::const_iterator i=sp.begin(); i!=sp.end(); ++i) {
-      // Get sparsity pattern
-      casadi_int sp_nrow = i->size1();
-      casadi_int sp_ncol = i->size2();
-      const casadi_int* sp_colind = i->colind();
-      const casadi_int* sp_row = i->row();
-      casadi_assert(sp_nrow==ret_nrow || sp_nrow==0,
-                            "Sparsity::horzcat: Mismatching number of rows");
-
-      // Add entries to pattern
-      for (casadi_int cc=0; cc<sp_ncol; ++cc) {
-        for (casadi_int k=sp_colind[cc]; k<sp_colind[cc+1]; ++k) {
-          ret_row.push_back(sp_row[k]);
-          ret_col.push_back(cc + ret_ncol);
-        }
-      }
+    // Dimensions and number of nonzeros of the result
+    casadi_int ret_nrow = 0, ret_ncol = 0, nnz_total = 0;
+    for (auto&& e : sp) {
+      if (ret_nrow==0) ret_nrow = e.size1();
+      ret_ncol += e.size2();
+      nnz_total += e.nnz();
+    }
 
-      // Update offset
-      ret_ncol += sp_ncol;
+    // Append the column offsets and rows of all patterns
+    vector<casadi_int> ret_colind(ret_ncol+1), ret_row(nnz_total);
+    casadi_int* colind_ptr = get_ptr(ret_colind);
+    casadi_int* row_ptr = get_ptr(ret_row);
+    *colind_ptr++ = 0;
+    casadi_int nz = 0;
+    for (auto&& e : sp) {
+      casadi_assert(e.size1()==ret_nrow || e.size1()==0,
+                            "Sparsity::horzcat: Mismatching number of rows");
+      const casadi_int* sp_colind = e.colind();
+      for (casadi_int cc=0; cc<e.size2(); ++cc) *colind_ptr++ = sp_colind[cc+1] + nz;
+      row_ptr = std::copy(e.row(), e.row()+e.nnz(), row_ptr);
+      nz += e.nnz();
     }
-    return Sparsity::triplet(ret_nrow, ret_ncol, ret_row, ret_col);
+    return Sparsity(ret_nrow, ret_ncol, ret_colind, ret_row);
   }
 
   Sparsity Sparsity::kron(const Sparsity& a, const Sparsity& b) {
@@ -1413,41 +1642,36 @@ namespace casadi {
     if (sp.empty()) return Sparsity(0, 0);
     if (sp.size()==1) return sp.front();
 
-    // Count total nnz
-    casadi_int nnz_total = 0;
-    for (casadi_int i=0; i<sp.size(); ++i) nnz_total += sp[i].nnz();
-
-    // Construct from vectors (triplet format)
-    vector<casadi_int> ret_row, ret_col;
-    ret_row.reserve(nnz_total);
-    ret_col.reserve(nnz_total);
-    casadi_int ret_nrow = 0;
-    casadi_int ret_ncol = 0;
-    for (casadi_int i=0; i<sp.size() && ret_ncol==0; ++i)
-      ret_ncol = sp[i].size2();
-
-    // Append all patterns
-    for (vector<Sparsity>::const_iterator i=sp.begin(); i!=sp.end(); ++i) {
-      // Get sparsity pattern
-      casadi_int sp_nrow = i->size1();
-      casadi_int sp_ncol = i->size2();
-      const casadi_int* sp_colind = i->colind();
-      const casadi_int* sp_row = i->row();
-      casadi_assert(sp_ncol==ret_ncol || sp_ncol==0,
+    // Dimensions and number of nonzeros of the result, row offset of each pattern
+    casadi_int ret_nrow = 0, ret_ncol = 0, nnz_total = 0;
+    vector<casadi_int> row_offset(sp.size());
+    for (casadi_int i=0; i<sp.size(); ++i) {
+      if (ret_ncol==0) ret_ncol = sp[i].size2();
+      row_offset[i] = ret_nrow;
+      ret_nrow += sp[i].size1();
+      nnz_total += sp[i].nnz();
+    }
+    for (auto&& e : sp) {
+      casadi_assert(e.size2()==ret_ncol || e.size2()==0,
                             "Sparsity::vertcat: Mismatching number of columns");
+    }
 
-      // Add entries to pattern
-      for (casadi_int cc=0; cc<sp_ncol; ++cc) {
+    // Assemble column by column, patterns without columns have no nonzeros
+    vector<casadi_int> ret_colind(ret_ncol+1), ret_row(nnz_total);
+    casadi_int* row_ptr = get_ptr(ret_row);
+    ret_colind[0] = 0;
+    for (casadi_int cc=0; cc<ret_ncol; ++cc) {
+      for (casadi_int i=0; i<sp.size(); ++i) {
+        if (sp[i].size2()!=ret_ncol) continue;
+        const casadi_int* sp_colind = sp[i].colind();
+        const casadi_int* sp_row = sp[i].row();
         for (casadi_int k=sp_colind[cc]; k<sp_colind[cc+1]; ++k) {
-          ret_row.push_back(sp_row[k] + ret_nrow);
-          ret_col.push_back(cc);
+          *row_ptr++ = sp_row[k] + row_offset[i];
         }
       }
-
-      // Update offset
-      ret_nrow += sp_nrow;
+      ret_colind[cc+1] = row_ptr - get_ptr(ret_row);
     }
-    return Sparsity::triplet(ret_nrow, ret_ncol, ret_row, ret_col);
+    return Sparsity(ret_nrow, ret_ncol, ret_colind, ret_row);
   }
 
   Sparsity Sparsity::diagcat(const std::vector< Sparsity > &v) {
@@ -1791,7 +2015,7 @@ namespace casadi {
     return Sparsity(nrow, ncol, colind, row);
   }
 
-  std::set<std::string> Sparsity::file_formats = {"mtx"};
+  std::set<std::string> Sparsity::file_formats = {"mtx", "csc"};
 
   std::string Sparsity::file_format(const std::string& filename, const std::string& format_hint) {
     if (format_hint=="") {
@@ -1811,56 +2035,11 @@ namespace casadi {
 
   }
   void Sparsity::to_file(const std::string& filename, const std::string& format_hint) const {
-    std::string format = file_format(filename, format_hint);
-    std::ofstream out(filename);
-    if (format=="mtx") {
-      out << std::scientific << std::setprecision(15);
-      out << "%%MatrixMarket matrix coordinate pattern general" << std::endl;
-      out << size1() << " " << size2() << " " << nnz() << std::endl;
-      std::vector<casadi_int> row = get_row();
-      std::vector<casadi_int> col = get_col();
-
-      for (casadi_int k=0;k<row.size();++k) {
-        out << row[k]+1 << " " << col[k]+1 << std::endl;
-      }
-    } else {
-      casadi_error("Unknown format '" + format + "'");
-    }
+    write_sparse(filename, file_format(filename, format_hint), *this, nullptr);
   }
 
   Sparsity Sparsity::from_file(const std::string& filename, const std::string& format_hint) {
-    std::string format = file_format(filename, format_hint);
-    std::ifstream in(filename);
-    if (format=="mtx") {
-      std::string line;
-      std::vector<casadi_int> row, col;
-      casadi_int size1, size2, nnz;
-      int line_num = 0;
-      while (std::getline(in, line)) {
-        if (line_num==0) {
-          casadi_assert(line=="%%MatrixMarket matrix coordinate pattern general", "Wrong header");
-          line_num = 1;
-        } else if (line_num==1) {
-          std::stringstream stream(line);
-          stream >> size1;
-          stream >> size2;
-          stream >> nnz;
-          row.reserve(nnz);
-          col.reserve(nnz);
-          line_num = 2;
-        } else {
-          std::stringstream stream(line);
-          casadi_int r, c;
-          stream >> r;
-          stream >> c;
-          row.push_back(r-1);
-          col.push_back(c-1);
-        }
-      }
-      return triplet(size1, size2, row, col);
-    } else {
-      casadi_error("Unknown format '" + format + "'");
-    }
+    return read_sparse(filename, file_format(filename, format_hint), nullptr);
   }
 
   Sparsity Sparsity::kkt(const Sparsity& H, const Sparsity& J,
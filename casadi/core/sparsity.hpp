@@ -176,6 +176,12 @@ namespace casadi {
      **/
     static Sparsity banded(casadi_int n, casadi_int p);
 
+    /** \brief Create a square banded sparsity pattern
+     *
+     * All elements (i, j) with j-upper <= i <= j+lower are nonzeros
+     **/
+    static Sparsity banded(casadi_int n, casadi_int lower, casadi_int upper);
+
     /** \brief Construct a block sparsity pattern from (row, col) vectors */
     static Sparsity rowcol(const std::vector<casadi_int>& row,
                            const std::vector<casadi_int>& col,
@@ -195,6 +201,15 @@ namespace casadi {
     static Sparsity triplet(casadi_int nrow, casadi_int ncol, const std::vector<casadi_int>& row,
                             const std::vector<casadi_int>& col);
 
+    /** \brief Create a sparsity pattern from triplets, merging duplicate entries
+        On return, nz[k] is the nonzero that entry (row[k], col[k]) is assembled into,
+        cf. Matrix::assemble. The (col, row) keys are radix sorted, in parallel blocks
+        if n_threads>1, and the pattern is written directly in compressed column form.
+    */
+    static Sparsity assemble(casadi_int nrow, casadi_int ncol,
+                             const std::vector<casadi_int>& row, const std::vector<casadi_int>& col,
+                             std::vector<casadi_int>& SWIG_OUTPUT(nz), casadi_int n_threads=1);
+
     /** \brrief Create a sparsity from nonzeros
     *
     * Inverse of `find()`
@@ -340,13 +355,29 @@ namespace casadi {
     /** Construct instance from info */
     static Sparsity from_info(const Dict& info);
 
+    /** \brief Statistics of the cache of sparsity patterns
+    *
+    * Number of lookups that found an existing pattern ("n_hit") or created a new
+    * one ("n_miss"), number of patterns currently cached ("n_pattern") and an
+    * estimate of the memory they occupy, including the cache itself ("n_bytes").
+    */
+    static Dict cache_stats();
+
     /** Export sparsity pattern to file
     *
     * Supported formats:
     *   - .mtx   Matrix Market
+    *   - .csc   Raw compressed column storage, binary
+    *
+    * For exchange in memory, colind() and row() point to the compressed column storage.
     */
     void to_file(const std::string& filename, const std::string& format_hint="") const;
 
+    /** Import sparsity pattern from file, memory-mapped where supported
+    *
+    * Supported formats as for to_file. Matrix Market files may also be symmetric and
+    * contain values, which are ignored.
+    */
     static Sparsity from_file(const std::string& filename, const std::string& format_hint="");
 
 #ifndef SWIG
@@ -420,6 +451,15 @@ namespace casadi {
     */
     void get_nz(std::vector<casadi_int>& SWIG_INOUT(indices)) const;
 
+    /** \brief Get the nonzero index of each element (rr[k], cc[k])
+        Elements not in the sparsity pattern give -1. The indices need not be sorted.
+        Lookups go through a hash index of the pattern, built on first use, and are
+        split over n_threads threads for large batches.
+    */
+    std::vector<casadi_int> get_nz_elements(const std::vector<casadi_int>& rr,
+                                            const std::vector<casadi_int>& cc,
+                                            casadi_int n_threads=1) const;
+
     /// Get nonzeros in lower triangular part
     std::vector<casadi_int> get_lower() const;
 
@@ -648,9 +688,6 @@ namespace casadi {
 #ifndef SWIG
     typedef std::unordered_multimap<std::size_t, WeakRef> CachingMap;
 
-    /// Cached sparsity patterns
-    static CachingMap& getCache();
-
     /// (Dense) scalar
     static const Sparsity& getScalar();
 
@@ -694,6 +731,17 @@ namespace casadi {
                    std::vector<casadi_int>& SWIG_OUTPUT(prinv),
                    std::vector<casadi_int>& SWIG_OUTPUT(pc), bool amd=true) const;
 
+    /** \brief Symbolic LU factorization without pivoting
+        Orders the rows and columns such that A(rowperm, colperm) = (I+L)*U can be
+        formed by elimination on a structurally nonzero diagonal: block triangular
+        form, with an approximate minimum degree ordering of each diagonal block to
+        limit fill-in. Returns the sparsity patterns of L (strictly lower) and U.
+        The matrix must be square and structurally nonsingular.
+    */
+    void lu_sparse(Sparsity& SWIG_OUTPUT(L), Sparsity& SWIG_OUTPUT(U),
+                   std::vector<casadi_int>& SWIG_OUTPUT(rowperm),
+                   std::vector<casadi_int>& SWIG_OUTPUT(colperm)) const;
+
     /** \brief Depth-first search on the adjacency graph of the sparsity
         See Direct Methods for Sparse Linear Systems by Davis (2006).
     */
@@ -763,6 +811,21 @@ namespace casadi {
     */
     std::vector<casadi_int> amd() const;
 
+    /** \brief Nested dissection preordering
+      Fill-reducing ordering for a symmetric sparsity pattern, obtained by recursive
+      graph bisection with vertex separators. Usually gives less fill-in than AMD for
+      large 2D or 3D grid-like problems and exposes more parallelism, since the two
+      parts of each bisection are factorized independently.
+    */
+    std::vector<casadi_int> nd() const;
+
+    /** \brief Fill-reducing preordering by name
+      "natural", "amd", "nd" (nested dissection) or "auto", which picks the one of
+      "amd" and "nd" that gives the fewest nonzeros in the LDL factor.
+      The pattern must be symmetric, cf. amd.
+    */
+    std::vector<casadi_int> ordering(const std::string& method) const;
+
 #ifndef SWIG
     /** \brief Propagate sparsity through a linear solve
      */
@@ -786,9 +849,15 @@ namespace casadi {
 #endif // SWIG
 
     /** \brief Perform a unidirectional coloring: A greedy distance-2 coloring algorithm
-        (Algorithm 3.1 in A. H. GEBREMEDHIN, F. MANNE, A. POTHEN) */
+        (Algorithm 3.1 in A. H. GEBREMEDHIN, F. MANNE, A. POTHEN)
+
+        With n_threads>1, the columns are colored speculatively in parallel blocks with
+        conflicts resolved in subsequent rounds. The result is then independent of the
+        number of threads, but may differ from the sequential coloring.
+    */
     Sparsity uni_coloring(const Sparsity& AT=Sparsity(),
-                          casadi_int cutoff = std::numeric_limits<casadi_int>::max()) const;
+                          casadi_int cutoff = std::numeric_limits<casadi_int>::max(),
+                          casadi_int n_threads=1) const;
 
     /** \brief Perform a star coloring of a symmetric matrix:
         A greedy distance-2 coloring algorithm
@@ -798,9 +867,12 @@ namespace casadi {
           SIAM Rev., 47(4), 629–705 (2006)
 
         Ordering options: None (0), largest first (1)
+
+        With n_threads>1, a parallel speculative variant is used, cf. uni_coloring.
     */
     Sparsity star_coloring(casadi_int ordering = 1,
-                            casadi_int cutoff = std::numeric_limits<casadi_int>::max()) const;
+                           casadi_int cutoff = std::numeric_limits<casadi_int>::max(),
+                           casadi_int n_threads=1) const;
 
     /** \brief Perform a star coloring of a symmetric matrix:
         A new greedy distance-2 coloring algorithm
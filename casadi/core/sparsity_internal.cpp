@@ -30,11 +30,86 @@
 #include <climits>
 #include <cstdlib>
 #include <cmath>
+#include <list>
 #include "matrix.hpp"
+#include "thread_pool.hpp"
 
 using namespace std;
 
 namespace casadi {
+  namespace {
+    // Operations with memoized results, cf. SparsityMemo
+    enum MemoOp {MEMO_TRANSPOSE, MEMO_MTIMES, MEMO_COMBINE};
+
+    /* Memoized results of transpose, combine and _mtimes, keyed by the addresses of the
+       operands. Since patterns are cached, equal operands usually have the same address.
+       The entries own the operands, such that the addresses remain valid. Entries are evicted
+       in least recently used order when the stored integers exceed a limit. */
+    class SparsityMemo {
+    public:
+      // Patterns with fewer nonzeros are cheaper to recalculate than to look up
+      static const casadi_int min_nnz = 64;
+      // Largest number of stored integers (row indices and mappings)
+      static const casadi_int max_size = 1 << 21;
+
+      struct Entry {
+        Sparsity x, y, r;
+        std::vector<casadi_int> mapping;
+        std::vector<unsigned char> cmapping;
+        casadi_int size() const {
+          // y is null for unary operations
+          return x.nnz() + (y.is_null() ? 0 : y.nnz()) + r.nnz()
+            + mapping.size() + cmapping.size()/8;
+        }
+      };
+      typedef std::tuple<int, const void*, const void*> Key;
+
+      // Look up, move to the front if found
+      bool get(const Key& key, Entry& e) {
+#ifdef CASADI_WITH_THREAD
+        std::lock_guard<std::mutex> lock(mtx_);
+#endif // CASADI_WITH_THREAD
+        auto it = index_.find(key);
+        if (it==index_.end()) return false;
+        lru_.splice(lru_.begin(), lru_, it->second.first);
+        e = it->second.first->second;
+        return true;
+      }
+
+      // Add an entry, evicting the least recently used ones if needed
+      void put(const Key& key, const Entry& e) {
+        casadi_int sz = e.size();
+        if (sz>max_size) return;
+#ifdef CASADI_WITH_THREAD
+        std::lock_guard<std::mutex> lock(mtx_);
+#endif // CASADI_WITH_THREAD
+        if (index_.count(key)) return;
+        while (size_+sz>max_size) {
+          size_ -= lru_.back().second.size();
+          index_.erase(lru_.back().first);
+          lru_.pop_back();
+        }
+        lru_.emplace_front(key, e);
+        index_[key] = make_pair(lru_.begin(), sz);
+        size_ += sz;
+      }
+
+      // Instance, never destroyed, since entries reference the pattern cache
+      static SparsityMemo& instance() {
+        static SparsityMemo* memo = new SparsityMemo();
+        return *memo;
+      }
+    private:
+      SparsityMemo() : size_(0) {}
+      std::list<std::pair<Key, Entry> > lru_;
+      std::map<Key, std::pair<std::list<std::pair<Key, Entry> >::iterator, casadi_int> > index_;
+      casadi_int size_;
+#ifdef CASADI_WITH_THREAD
+      std::mutex mtx_;
+#endif // CASADI_WITH_THREAD
+    };
+  } // namespace
+
   void SparsityInternal::etree(const casadi_int* sp, casadi_int* parent,
       casadi_int *w, casadi_int ata) {
     /*
@@ -452,15 +527,65 @@ namespace casadi {
   SparsityInternal::
   SparsityInternal(casadi_int nrow, casadi_int ncol,
       const casadi_int* colind, const casadi_int* row) :
-    sp_(2 + ncol+1 + colind[ncol]), btf_(nullptr) {
+    sp_(2 + ncol+1 + colind[ncol]), btf_(nullptr), nz_index_(nullptr) {
     sp_[0] = nrow;
     sp_[1] = ncol;
     std::copy(colind, colind+ncol+1, sp_.begin()+2);
     std::copy(row, row+colind[ncol], sp_.begin()+2+ncol+1);
+
+    // Half-bandwidths
+    bw_lower_ = bw_upper_ = 0;
+    for (casadi_int cc=0; cc<ncol; ++cc) {
+      if (colind[cc] != colind[cc+1]) { // if there are any elements of the column
+        bw_upper_ = std::max(bw_upper_, cc-row[colind[cc]]);
+        bw_lower_ = std::max(bw_lower_, row[colind[cc+1]-1]-cc);
+      }
+    }
+
+    // Banded if the number of nonzeros matches the number of elements in the band
+    casadi_int n_band = 0;
+    for (casadi_int cc=0; cc<ncol; ++cc) {
+      casadi_int r0 = std::max(casadi_int(0), cc-bw_upper_);
+      casadi_int r1 = std::min(nrow-1, cc+bw_lower_);
+      if (r1>=r0) n_band += r1-r0+1;
+    }
+    banded_ = n_band==colind[ncol];
+    diag_ = banded_ && nrow==ncol && bw_lower_==0 && bw_upper_==0;
   }
 
   SparsityInternal::~SparsityInternal() {
     if (btf_) delete btf_;
+    delete nz_index_.load();
+  }
+
+  const SparsityInternal::NzIndex& SparsityInternal::nz_index() const {
+    NzIndex* ind = nz_index_.load(std::memory_order_acquire);
+    if (ind) return *ind;
+    // Power of two capacity, at most half full
+    ind = new NzIndex();
+    int log_cap = 4;
+    while ((casadi_int(1) << log_cap) < 2*nnz()) log_cap++;
+    ind->shift = 64 - log_cap;
+    ind->table.resize(casadi_int(2) << log_cap, -1);
+    size_t mask = (size_t(1) << log_cap) - 1;
+    const casadi_int *colind = this->colind(), *row = this->row();
+    casadi_int nrow = size1();
+    for (casadi_int cc=0; cc<size2(); ++cc) {
+      for (casadi_int el=colind[cc]; el<colind[cc+1]; ++el) {
+        casadi_int k = row[el] + cc*nrow;
+        size_t i = (static_cast<uint64_t>(k)*0x9E3779B97F4A7C15ull) >> ind->shift;
+        while (ind->table[2*i]>=0) i = (i+1) & mask;
+        ind->table[2*i] = k;
+        ind->table[2*i+1] = el;
+      }
+    }
+    // Publish, unless another thread was faster
+    NzIndex* expected = nullptr;
+    if (!nz_index_.compare_exchange_strong(expected, ind, std::memory_order_acq_rel)) {
+      delete ind;
+      return *expected;
+    }
+    return *ind;
   }
 
   const SparsityInternal::Btf& SparsityInternal::btf() const {
@@ -505,12 +630,62 @@ namespace casadi {
   }
 
   Sparsity SparsityInternal::transpose(vector<casadi_int>& mapping, bool invert_mapping) const {
+    // Diagonal: same pattern
+    if (is_diag()) {
+      mapping = range(nnz());
+      return shared_from_this<Sparsity>();
+    }
+
+    // Dense: the mapping is known without sorting
+    if (is_dense()) {
+      casadi_int n1 = size1(), n2 = size2();
+      mapping.resize(nnz());
+      for (casadi_int c=0; c<n2; ++c) {
+        for (casadi_int r=0; r<n1; ++r) {
+          if (invert_mapping) {
+            mapping[r+c*n1] = c+r*n2;
+          } else {
+            mapping[c+r*n2] = r+c*n1;
+          }
+        }
+      }
+      return Sparsity::dense(n2, n1);
+    }
+
+    // Memoized result?
+    bool memo = nnz()>=SparsityMemo::min_nnz;
+    SparsityMemo::Key key(MEMO_TRANSPOSE, this, nullptr);
+    SparsityMemo::Entry e;
+    if (memo && SparsityMemo::instance().get(key, e)) {
+      if (invert_mapping) {
+        // The mapping is a permutation
+        mapping.resize(e.mapping.size());
+        for (casadi_int k=0; k<e.mapping.size(); ++k) mapping[e.mapping[k]] = k;
+      } else {
+        mapping = e.mapping;
+      }
+      return e.r;
+    }
+
     // Get the sparsity of the transpose in sparse triplet form
     vector<casadi_int> trans_col = get_row();
     vector<casadi_int> trans_row = get_col();
 
     // Create the sparsity pattern
-    return Sparsity::triplet(size2(), size1(), trans_row, trans_col, mapping, invert_mapping);
+    Sparsity ret = Sparsity::triplet(size2(), size1(), trans_row, trans_col, mapping,
+                                     invert_mapping);
+    if (memo) {
+      e.x = shared_from_this<Sparsity>();
+      e.r = ret;
+      if (invert_mapping) {
+        e.mapping.resize(mapping.size());
+        for (casadi_int k=0; k<mapping.size(); ++k) e.mapping[mapping[k]] = k;
+      } else {
+        e.mapping = mapping;
+      }
+      SparsityMemo::instance().put(key, e);
+    }
+    return ret;
   }
 
   casadi_int SparsityInternal::dfs(casadi_int j, casadi_int top, std::vector<casadi_int>& xi,
@@ -962,6 +1137,115 @@ namespace casadi {
     #undef FLIP
   }
 
+  std::vector<casadi_int> SparsityInternal::nd(casadi_int leaf_size) const {
+    casadi_assert(is_symmetric(), "Nested dissection requires a symmetric matrix");
+    casadi_int n=size2();
+    // All nodes, part 0
+    std::vector<casadi_int> mark(n, 0), level(n, -1), p;
+    p.reserve(n);
+    casadi_int next_id = 1;
+    nd_dissect(range(n), leaf_size, mark, next_id, level, p);
+    return p;
+  }
+
+  std::vector<casadi_int> SparsityInternal::nd_bfs(casadi_int root, casadi_int id,
+                                                   const std::vector<casadi_int>& mark,
+                                                   std::vector<casadi_int>& level) const {
+    const casadi_int *colind = this->colind(), *row = this->row();
+    std::vector<casadi_int> q(1, root);
+    level[root] = 0;
+    for (casadi_int h=0; h<q.size(); ++h) {
+      casadi_int i = q[h];
+      for (casadi_int k=colind[i]; k<colind[i+1]; ++k) {
+        casadi_int j = row[k];
+        if (mark[j]==id && level[j]<0) {
+          level[j] = level[i]+1;
+          q.push_back(j);
+        }
+      }
+    }
+    return q;
+  }
+
+  void SparsityInternal::nd_dissect(const std::vector<casadi_int>& v, casadi_int leaf_size,
+                                    std::vector<casadi_int>& mark, casadi_int& next_id,
+                                    std::vector<casadi_int>& level,
+                                    std::vector<casadi_int>& p) const {
+    if (v.empty()) return;
+    casadi_int id = mark[v.front()];
+    const casadi_int *colind = this->colind(), *row = this->row();
+    if (v.size()>leaf_size) {
+      // Level structure of the component containing v[0]
+      for (casadi_int i : v) level[i] = -1;
+      std::vector<casadi_int> q = nd_bfs(v.front(), id, mark, level);
+      if (q.size()<v.size()) {
+        // Disconnected: the component and the rest are independent
+        std::vector<casadi_int> rest;
+        for (casadi_int i : v) if (level[i]<0) rest.push_back(i);
+        casadi_int id_q = next_id++, id_rest = next_id++;
+        for (casadi_int i : q) mark[i] = id_q;
+        for (casadi_int i : rest) mark[i] = id_rest;
+        nd_dissect(q, leaf_size, mark, next_id, level, p);
+        nd_dissect(rest, leaf_size, mark, next_id, level, p);
+        return;
+      }
+      // Pseudo-peripheral root: restart from a minimum degree node of the last level
+      casadi_int nlev = level[q.back()]+1;
+      for (casadi_int iter=0; iter<5; ++iter) {
+        casadi_int root = q.back(), deg = colind[root+1]-colind[root];
+        for (auto it=q.rbegin(); it!=q.rend() && level[*it]==nlev-1; ++it) {
+          if (colind[*it+1]-colind[*it]<deg) {
+            root = *it;
+            deg = colind[root+1]-colind[root];
+          }
+        }
+        for (casadi_int i : v) level[i] = -1;
+        std::vector<casadi_int> q2 = nd_bfs(root, id, mark, level);
+        casadi_int nlev2 = level[q2.back()]+1;
+        q.swap(q2);
+        if (nlev2<=nlev) break;
+        nlev = nlev2;
+      }
+      nlev = level[q.back()]+1;
+      // Middle level, splitting the nodes in halves
+      casadi_int m = level[q[q.size()/2]];
+      if (m>0 && m<nlev-1) {
+        // Separator: nodes in the middle level connected to the next level
+        std::vector<casadi_int> a, b, s;
+        for (casadi_int i : q) {
+          if (level[i]<m) {
+            a.push_back(i);
+          } else if (level[i]>m) {
+            b.push_back(i);
+          } else {
+            bool sep = false;
+            for (casadi_int k=colind[i]; k<colind[i+1] && !sep; ++k) {
+              casadi_int j = row[k];
+              sep = mark[j]==id && level[j]==m+1;
+            }
+            if (sep) {
+              s.push_back(i);
+            } else {
+              a.push_back(i);
+            }
+          }
+        }
+        // Order the parts, then the separator
+        casadi_int id_a = next_id++, id_b = next_id++;
+        for (casadi_int i : a) mark[i] = id_a;
+        for (casadi_int i : b) mark[i] = id_b;
+        nd_dissect(a, leaf_size, mark, next_id, level, p);
+        nd_dissect(b, leaf_size, mark, next_id, level, p);
+        p.insert(p.end(), s.begin(), s.end());
+        return;
+      }
+    }
+    // Small or not separable: AMD on the induced subgraph
+    std::vector<casadi_int> mapping;
+    std::vector<casadi_int> pv = sub(v, v, mapping, false).amd();
+    for (casadi_int i : pv) p.push_back(v[i]);
+  }
+
   void SparsityInternal::bfs(casadi_int n, std::vector<casadi_int>& wi, std::vector<casadi_int>& wj,
                               std::vector<casadi_int>& queue, const std::vector<casadi_int>& imatch,
                               const std::vector<casadi_int>& jmatch, casadi_int mark) const {
@@ -1741,6 +2025,18 @@ namespace casadi {
     // Quick return if second factor is diagonal
     if (y.is_diag()) return shared_from_this<Sparsity>();
 
+    // Banded square factors: the product is banded with the half-bandwidths added
+    if (is_banded() && y->is_banded() && is_square() && y.size1()==d1 && y.size2()==d1) {
+      return Sparsity::banded(d1, std::min(bw_lower()+y.bw_lower(), d1-1),
+                              std::min(bw_upper()+y.bw_upper(), d1-1));
+    }
+
+    // Memoized result?
+    bool memo = nnz()+y.nnz()>=SparsityMemo::min_nnz;
+    SparsityMemo::Key key(MEMO_MTIMES, this, y.get());
+    SparsityMemo::Entry e;
+    if (memo && SparsityMemo::instance().get(key, e)) return e.r;
+
     // Direct access to the vectors
     const casadi_int* x_row = row();
     const casadi_int* x_colind = colind();
@@ -1772,8 +2068,15 @@ namespace casadi {
       }
     }
 
-    // Assemble sparsity pattern and return
-    return Sparsity::triplet(d1, d2, row, col);
+    // Assemble sparsity pattern
+    Sparsity ret = Sparsity::triplet(d1, d2, row, col);
+    if (memo) {
+      e.x = shared_from_this<Sparsity>();
+      e.y = y;
+      e.r = ret;
+      SparsityMemo::instance().put(key, e);
+    }
+    return ret;
   }
 
   bool SparsityInternal::is_scalar(bool scalar_and_dense) const {
@@ -1800,32 +2103,6 @@ namespace casadi {
     return both ? size2()==0 && size1()==0 : size2()==0 || size1()==0;
   }
 
-  bool SparsityInternal::is_diag() const {
-    const casadi_int* colind = this->colind();
-    const casadi_int* row = this->row();
-
-    // Check if matrix is square
-    if (size2() != size1()) return false;
-
-    // Check if correct number of non-zeros (one per column)
-    if (nnz() != size2()) return false;
-
-    // Check that the row indices are correct
-    for (casadi_int i=0; i<nnz(); ++i) {
-      if (row[i]!=i)
-        return false;
-    }
-
-    // Make sure that the col indices are correct
-    for (casadi_int i=0; i<size2(); ++i) {
-      if (colind[i]!=i)
-        return false;
-    }
-
-    // Diagonal if reached this point
-    return true;
-  }
-
   bool SparsityInternal::is_square() const {
     return size2() == size1();
   }
@@ -1966,27 +2243,18 @@ namespace casadi {
     casadi_assert_in_range(rr, -size1()+ind1, size1()+ind1);
     casadi_assert_in_range(cc, -size2()+ind1, size2()+ind1);
 
-    // Handle index-1, negative indices, non-monotone rr and cc
-    if (ind1 || has_negative(rr) || has_negative(cc)
-        || !is_nondecreasing(rr) || !is_nondecreasing(cc)) {
-      // Create substitute rr
-      std::vector<casadi_int> rr_mod = rr;
-      for (vector<casadi_int>::iterator i=rr_mod.begin(); i!=rr_mod.end(); ++i) {
-        if (ind1) (*i)--;
-        if (*i<0) *i += size1();
+    // Handle index-1, negative indices
+    if (ind1 || has_negative(rr) || has_negative(cc)) {
+      std::vector<casadi_int> rr_mod = rr, cc_mod = cc;
+      for (casadi_int& i : rr_mod) {
+        if (ind1) i--;
+        if (i<0) i += size1();
       }
-      std::sort(rr_mod.begin(), rr_mod.end());
-
-      // Create substitute cc
-      std::vector<casadi_int> cc_mod = cc;
-      for (vector<casadi_int>::iterator i=cc_mod.begin(); i!=cc_mod.end(); ++i) {
-        if (ind1) (*i)--;
-        if (*i<0) *i += size2();
+      for (casadi_int& i : cc_mod) {
+        if (ind1) i--;
+        if (i<0) i += size2();
       }
-      std::sort(cc_mod.begin(), cc_mod.end());
-
-      // Call recursively
-      return _erase(rr_mod, cc_mod, false, mapping);
+      return _erase(rr_mod, cc_mod, false, mapping); // Call recursively
     }
 
     // Mapping
@@ -1995,6 +2263,25 @@ namespace casadi {
     // Quick return if no elements
     if (numel()==0) return shared_from_this<Sparsity>();
 
+    // Columns to be erased
+    std::vector<bool> erase_col(size2(), false);
+    for (casadi_int c : cc) erase_col[c] = true;
+
+    // Rows to be erased: merge each column with the sorted rows, O(cc.size()*rr.size()),
+    // or mark the rows, O(size1()), whichever is cheaper
+    bool with_lookup = static_cast<double>(cc.size())*static_cast<double>(rr.size())
+      > static_cast<double>(size1());
+    std::vector<bool> erase_row;
+    std::vector<casadi_int> rr_sorted;
+    if (with_lookup) {
+      erase_row.resize(size1(), false);
+      for (casadi_int r : rr) erase_row[r] = true;
+    } else if (!is_nondecreasing(rr)) {
+      rr_sorted = rr;
+      std::sort(rr_sorted.begin(), rr_sorted.end());
+    }
+    const std::vector<casadi_int>& rs = rr_sorted.empty() ? rr : rr_sorted;
+
     // Reserve memory
     mapping.reserve(nnz());
 
@@ -2004,9 +2291,6 @@ namespace casadi {
     // Number of non-zeros
     casadi_int nz=0;
 
-    // Columns to be erased
-    vector<casadi_int>::const_iterator ie = cc.begin();
-
     // First and last index for the col
     casadi_int el_first=0, el_last=0;
 
@@ -2016,46 +2300,30 @@ namespace casadi {
       el_first = el_last;
       el_last = ret_colind[i+1];
 
-      // Is it a col that can be deleted
-      bool deletable_col = ie!=cc.end() && *ie==i;
-      if (deletable_col) {
-        ie++;
-
-        // Rows to be erased
-        vector<casadi_int>::const_iterator je = rr.begin();
-
-        // Loop over nonzero elements of the col
-        for (casadi_int el=el_first; el<el_last; ++el) {
-          // Row
-          casadi_int j=ret_row[el];
+      // Rows to be erased, if merging
+      vector<casadi_int>::const_iterator je = rs.begin();
 
-          // Continue to the next row to skip
-          for (; je!=rr.end() && *je<j; ++je) {}
+      // Loop over nonzero elements of the col
+      for (casadi_int el=el_first; el<el_last; ++el) {
+        // Row
+        casadi_int j=ret_row[el];
 
-          // Remove row if necessary
-          if (je!=rr.end() && *je==j) {
-            je++;
-            continue;
+        // Remove element if necessary
+        if (erase_col[i]) {
+          if (with_lookup) {
+            if (erase_row[j]) continue;
+          } else {
+            // Continue to the next row to skip
+            for (; je!=rs.end() && *je<j; ++je) {}
+            if (je!=rs.end() && *je==j) continue;
           }
-
-          // Save old nonzero for each new nonzero
-          mapping.push_back(el);
-
-          // Update row and increase nonzero counter
-          ret_row[nz++] = j;
         }
-      } else {
-        // Loop over nonzero elements of the col
-        for (casadi_int el=el_first; el<el_last; ++el) {
-          // Row
-          casadi_int j=ret_row[el];
 
-          // Save old nonzero for each new nonzero
-          mapping.push_back(el);
+        // Save old nonzero for each new nonzero
+        mapping.push_back(el);
 
-          // Update row and increase nonzero counter
-          ret_row[nz++] = j;
-        }
+        // Update row and increase nonzero counter
+        ret_row[nz++] = j;
       }
 
       // Register last nonzero of the col
@@ -2073,17 +2341,27 @@ namespace casadi {
     casadi_assert_bounded(rr, size1());
     casadi_assert_bounded(cc, size2());
 
-    std::vector<casadi_int> rr_sorted;
-    std::vector<casadi_int> rr_sorted_index;
-
-    sort(rr, rr_sorted, rr_sorted_index);
-
     vector<casadi_int> ret(cc.size()*rr.size());
-
     casadi_int stride = rr.size();
     const casadi_int* colind = this->colind();
     const casadi_int* row = this->row();
 
+    // Few rows compared to the column lengths: hash lookups rather than merging
+    if (rr.size()*size2() < nnz()) {
+      const NzIndex& ind = nz_index();
+      for (casadi_int i=0; i<cc.size(); ++i) {
+        for (casadi_int j=0; j<rr.size(); ++j) {
+          ret[i*stride+j] = ind.find(rr[j] + cc[i]*size1());
+        }
+      }
+      return ret;
+    }
+
+    std::vector<casadi_int> rr_sorted;
+    std::vector<casadi_int> rr_sorted_index;
+
+    sort(rr, rr_sorted, rr_sorted_index);
+
     for (casadi_int i=0;i<cc.size();++i) {
       casadi_int it = cc[i];
       casadi_int el=colind[it];
@@ -2151,122 +2429,91 @@ namespace casadi {
     casadi_assert_in_range(rr, -size1()+ind1, size1()+ind1);
     casadi_assert_in_range(cc, -size2()+ind1, size2()+ind1);
 
-    // Handle index-1, negative indices in rr
-    std::vector<casadi_int> tmp = rr;
-    for (vector<casadi_int>::iterator i=tmp.begin(); i!=tmp.end(); ++i) {
-      if (ind1) (*i)--;
-      if (*i<0) *i += size1();
+    // Handle index-1, negative indices
+    if (ind1 || has_negative(rr) || has_negative(cc)) {
+      std::vector<casadi_int> rr_mod = rr, cc_mod = cc;
+      for (casadi_int& i : rr_mod) {
+        if (ind1) i--;
+        if (i<0) i += size1();
+      }
+      for (casadi_int& i : cc_mod) {
+        if (ind1) i--;
+        if (i<0) i += size2();
+      }
+      return sub(rr_mod, cc_mod, mapping, false); // Call recursively
     }
-    std::vector<casadi_int> rr_sorted, rr_sorted_index;
-    sort(tmp, rr_sorted, rr_sorted_index, false);
 
-    // Handle index-1, negative indices in cc
-    tmp = cc;
-    for (vector<casadi_int>::iterator i=tmp.begin(); i!=tmp.end(); ++i) {
-      if (ind1) (*i)--;
-      if (*i<0) *i += size2();
-    }
-    std::vector<casadi_int> cc_sorted, cc_sorted_index;
-    sort(tmp, cc_sorted, cc_sorted_index, false);
-    vector<casadi_int> columns, rows;
+    // Either merge each column with the sorted rows, O(cc.size()*rr.size()), or
+    // look up the rows of the nonzeros, O(size1() + rr.size()), in addition to
+    // a pass over the nonzeros of the selected columns
+    // Typical use cases:
+    // a = DM.ones(1000, 1000); a[[0, 1],[0, 1]] (merge)
+    // a = SX.sym("a", Sparsity.diag(50000)); a[:, :] (lookup)
+    casadi_int n_rr = rr.size();
+    bool with_lookup = static_cast<double>(cc.size())*static_cast<double>(n_rr)
+      > static_cast<double>(size1() + n_rr);
+    bool rr_increasing = is_nondecreasing(rr);
 
-    // With lookup vector
-    bool with_lookup = static_cast<double>(cc.size())*static_cast<double>(rr.size()) > nnz();
-    std::vector<casadi_int> rrlookup;
+    // Rows in increasing order with their position in rr, for merging
+    std::vector<casadi_int> rr_sorted, rr_sorted_index;
+    // For each row, the first position in rr, chained to the next ones, for lookup
+    std::vector<casadi_int> rr_first, rr_next;
     if (with_lookup) {
-      // Time complexity: O(ii.size()*(nnz per column))
-      // Typical use case:
-      // a = SX::sym("a", sp_diag(50000))
-      // a[:, :]
-      rrlookup = lookupvector(rr_sorted, size1());
-      // Else: Time complexity: O(ii.size()*jj.size())
-      // Typical use case:
-      // a = DM.ones(1000, 1000)
-      // a[[0, 1],[0, 1]]
-    }
-
-    // count the number of non-zeros
-    casadi_int nnz = 0;
+      rr_first.resize(size1(), -1);
+      rr_next.resize(n_rr);
+      for (casadi_int p=n_rr-1; p>=0; --p) {
+        rr_next[p] = rr_first[rr[p]];
+        rr_first[rr[p]] = p;
+      }
+    } else if (!rr_increasing) {
+      sort(rr, rr_sorted, rr_sorted_index, false);
+    }
+    const std::vector<casadi_int>& rs = rr_increasing ? rr : rr_sorted;
 
-    // loop over the columns of the slice
+    // Construct the compressed column format directly, column by column
     const casadi_int* colind = this->colind();
     const casadi_int* row = this->row();
+    std::vector<casadi_int> ret_colind(cc.size()+1), ret_row;
+    ret_colind[0] = 0;
+    mapping.clear();
+    std::vector<std::pair<casadi_int, casadi_int> > col_el;
     for (casadi_int i=0; i<cc.size(); ++i) {
-      casadi_int it = cc_sorted[i];
+      casadi_int c = cc[i], k0 = ret_row.size();
       if (with_lookup) {
-        // loop over the non-zeros of the matrix
-        for (casadi_int el=colind[it]; el<colind[it+1]; ++el) {
-          casadi_int j = row[el];
-          casadi_int ji = rrlookup[j];
-          if (ji!=-1) {
-            casadi_int jv = rr_sorted[ji];
-            while (ji>=0 && jv == rr_sorted[ji--]) nnz++;
+        // Loop over the nonzeros of the column, all positions in rr of the row
+        for (casadi_int el=colind[c]; el<colind[c+1]; ++el) {
+          for (casadi_int p=rr_first[row[el]]; p>=0; p=rr_next[p]) {
+            ret_row.push_back(p);
+            mapping.push_back(el);
           }
         }
       } else {
         // Loop over rr
-        casadi_int el = colind[it];
-        for (casadi_int j=0; j<rr_sorted.size(); ++j) {
-          casadi_int jt=rr_sorted[j];
+        casadi_int el = colind[c];
+        for (casadi_int j=0; j<n_rr; ++j) {
           // Continue to the non-zero element
-          while (el<colind[it+1] && row[el]<jt) el++;
+          while (el<colind[c+1] && row[el]<rs[j]) el++;
           // Add the non-zero element, if there was an element in the location exists
-          if (el<colind[it+1] && row[el]== jt) nnz++;
-        }
-      }
-    }
-
-    mapping.resize(nnz);
-    columns.resize(nnz);
-    rows.resize(nnz);
-
-    casadi_int k = 0;
-    // loop over the columns of the slice
-    for (casadi_int i=0; i<cc.size(); ++i) {
-      casadi_int it = cc_sorted[i];
-      if (with_lookup) {
-        // loop over the non-zeros of the matrix
-        for (casadi_int el=colind[it]; el<colind[it+1]; ++el) {
-          casadi_int jt = row[el];
-          casadi_int ji = rrlookup[jt];
-          if (ji!=-1) {
-            casadi_int jv = rr_sorted[ji];
-            while (ji>=0 && jv == rr_sorted[ji]) {
-              rows[k] = rr_sorted_index[ji];
-              columns[k] = cc_sorted_index[i];
-              mapping[k] = el;
-              k++;
-              ji--;
-            }
+          if (el<colind[c+1] && row[el]==rs[j]) {
+            ret_row.push_back(rr_increasing ? j : rr_sorted_index[j]);
+            mapping.push_back(el);
           }
         }
-      } else {
-        // Loop over rr
-        casadi_int el = colind[it];
-        for (casadi_int j=0; j<rr_sorted.size(); ++j) {
-          casadi_int jt=rr_sorted[j];
-          // Continue to the non-zero element
-          while (el<colind[it+1] && row[el]<jt) el++;
-          // Add the non-zero element, if there was an element in the location exists
-          if (el<colind[it+1] && row[el]== jt) {
-            rows[k] = rr_sorted_index[j];
-            columns[k] = cc_sorted_index[i];
-            mapping[k] = el;
-            k++;
-          }
+      }
+      // Rows are only out of order if rr is
+      if (!rr_increasing) {
+        casadi_int k1 = ret_row.size();
+        col_el.resize(k1-k0);
+        for (casadi_int k=k0; k<k1; ++k) col_el[k-k0] = std::make_pair(ret_row[k], mapping[k]);
+        std::sort(col_el.begin(), col_el.end());
+        for (casadi_int k=k0; k<k1; ++k) {
+          ret_row[k] = col_el[k-k0].first;
+          mapping[k] = col_el[k-k0].second;
         }
       }
+      ret_colind[i+1] = ret_row.size();
     }
-
-    std::vector<casadi_int> sp_mapping;
-    std::vector<casadi_int> mapping_ = mapping;
-    Sparsity ret = Sparsity::triplet(rr.size(), cc.size(), rows, columns, sp_mapping, false);
-
-    for (casadi_int i=0; i<mapping.size(); ++i)
-      mapping[i] = mapping_[sp_mapping[i]];
-
-    // Create sparsity pattern
-    return ret;
+    return Sparsity(n_rr, cc.size(), ret_colind, ret_row);
   }
 
   Sparsity SparsityInternal::combine(const Sparsity& y, bool f0x_is_zero,
@@ -2295,17 +2542,36 @@ namespace casadi {
       return y;
     }
 
+    // Memoized result?
+    bool memo = nnz()+y.nnz()>=SparsityMemo::min_nnz;
+    SparsityMemo::Key key(MEMO_COMBINE + 2*f0x_is_zero + 4*function0_is_zero + 8*with_mapping,
+                          this, y.get());
+    SparsityMemo::Entry e;
+    if (memo && SparsityMemo::instance().get(key, e)) {
+      if (with_mapping) mapping = e.cmapping;
+      return e.r;
+    }
+
+    Sparsity ret;
     if (f0x_is_zero) {
       if (function0_is_zero) {
-        return combineGen<with_mapping, true, true>(y, mapping);
+        ret = combineGen<with_mapping, true, true>(y, mapping);
       } else {
-        return combineGen<with_mapping, true, false>(y, mapping);
+        ret = combineGen<with_mapping, true, false>(y, mapping);
       }
     } else if (function0_is_zero) {
-      return combineGen<with_mapping, false, true>(y, mapping);
+      ret = combineGen<with_mapping, false, true>(y, mapping);
     } else {
-      return combineGen<with_mapping, false, false>(y, mapping);
+      ret = combineGen<with_mapping, false, false>(y, mapping);
+    }
+    if (memo) {
+      e.x = shared_from_this<Sparsity>();
+      e.y = y;
+      e.r = ret;
+      if (with_mapping) e.cmapping = mapping;
+      SparsityMemo::instance().put(key, e);
     }
+    return ret;
   }
 
   template<bool with_mapping, bool f0x_is_zero, bool function0_is_zero>
@@ -2633,6 +2899,9 @@ namespace casadi {
     // Quick return if past the end
     if (colind[cc]==nnz() || (colind[cc+1]==nnz() && row[nnz()-1]<rr)) return -1;
 
+    // Hash lookup if a scan of the column would be long
+    if (colind[cc+1]-colind[cc] > nz_index_scan) return nz_index().find(rr+cc*size1());
+
     // Find sparse element
     for (casadi_int ind=colind[cc]; ind<colind[cc+1]; ++ind) {
       if (row[ind] == rr) {
@@ -2703,6 +2972,29 @@ namespace casadi {
     return Sparsity(nrow, ncol, colind_new, row_new);
   }
 
+  vector<casadi_int> SparsityInternal::get_nz_elements(const vector<casadi_int>& rr,
+      const vector<casadi_int>& cc, casadi_int n_threads) const {
+    casadi_assert(rr.size()==cc.size(), "Dimension mismatch: " + str(rr.size())
+                  + " rows but " + str(cc.size()) + " columns");
+    casadi_assert_bounded(rr, size1());
+    casadi_assert_bounded(cc, size2());
+    casadi_int n = rr.size(), nrow = size1();
+    vector<casadi_int> ret(n);
+    if (is_dense()) {
+      for (casadi_int k=0; k<n; ++k) ret[k] = rr[k] + cc[k]*nrow;
+      return ret;
+    }
+    const NzIndex& ind = nz_index();
+    // Lookups are independent, split in contiguous blocks
+    n_threads = std::max(casadi_int(1), std::min(n_threads, n/nz_index_block));
+    ThreadPool::run(n_threads, n_threads, [&](casadi_int t, casadi_int) {
+      for (casadi_int k=t*n/n_threads; k<(t+1)*n/n_threads; ++k) {
+        ret[k] = ind.find(rr[k] + cc[k]*nrow);
+      }
+    });
+    return ret;
+  }
+
   bool SparsityInternal::rowsSequential(bool strictly) const {
     const casadi_int* colind = this->colind();
     const casadi_int* row = this->row();
@@ -2819,12 +3111,10 @@ namespace casadi {
       if (*it>=0) {
         casadi_int el = *it;
         if (el<last) {
-          // Sort rr in nondecreasing order, if needed
-          std::vector<casadi_int> indices_sorted, mapping;
-          sort(indices, indices_sorted, mapping, false);
-          get_nz(indices_sorted);
-          for (size_t i=0; i<indices.size(); ++i) {
-            indices[mapping[i]] = indices_sorted[i];
+          // Not sorted: look up each element instead of sorting
+          const NzIndex& ind = nz_index();
+          for (casadi_int& k : indices) {
+            if (k>=0) k = ind.find(k);
           }
           return;
         }
@@ -2889,12 +3179,90 @@ namespace casadi {
     fill(it, indices.end(), -1);
   }
 
-  Sparsity SparsityInternal::uni_coloring(const Sparsity& AT, casadi_int cutoff) const {
+  /// Number of vertices per block in the speculative coloring
+  static const casadi_int coloring_block_size = 256;
 
-    // Allocate temporary vectors
-    vector<casadi_int> forbiddenColors;
-    forbiddenColors.reserve(size2());
-    vector<casadi_int> color(size2(), 0);
+  /// Has vertex u (work list position pos[u], -1 if colored) been colored when coloring v?
+  static inline bool coloring_visible(casadi_int u, casadi_int v, const casadi_int* pos) {
+    return pos[u]<0 || (pos[u]<pos[v] && pos[u]/coloring_block_size==pos[v]/coloring_block_size);
+  }
+
+  /// Was vertex u colored concurrently with, and before, vertex v?
+  static inline bool coloring_crosses(casadi_int u, casadi_int v, const casadi_int* pos) {
+    return pos[u]>=0 && pos[u]<pos[v]
+      && pos[u]/coloring_block_size!=pos[v]/coloring_block_size;
+  }
+
+  /** \brief Deterministic speculative coloring of the vertices 0..n-1
+   *
+   * The vertices still to be colored are split into blocks of fixed size, which are
+   * colored greedily and concurrently. A vertex sees the colors of the vertices
+   * finalized in earlier rounds and of the preceding vertices of its own block only.
+   * Vertices in conflict with a preceding vertex of another block are recolored in the
+   * next round. Since the blocks do not depend on the number of threads, neither does
+   * the coloring. Cf. Bozdag, Gebremedhin, Manne, Boman, Catalyurek (2008).
+   * color_vertex(v, stamp, pos, color, forbidden) returns the color of v, using a
+   * forbidden color marker unique to the call, and conflict(v, pos, color) checks whether
+   * v must be recolored. Returns false if more than cutoff colors are needed.
+   */
+  template<typename ColorRule, typename ConflictRule>
+  static bool speculative_coloring(casadi_int n, casadi_int n_threads, casadi_int cutoff,
+                                   const ColorRule& color_vertex, const ConflictRule& conflict,
+                                   vector<casadi_int>& color) {
+    // Position of each vertex in the work list, -1 if colored
+    vector<casadi_int> pos = range(n);
+    vector<casadi_int> work = pos, next;
+    color.assign(n, -1);
+    // Forbidden colors, one vector per thread
+    vector<vector<casadi_int> > forbidden(n_threads, vector<casadi_int>(n+1, -1));
+    vector<char> flag(n);
+    // Colors in use by the finalized vertices
+    vector<casadi_int> used(n, 0);
+    casadi_int ncolors = 0;
+    for (casadi_int round=0; !work.empty(); ++round) {
+      casadi_int nw = work.size();
+      casadi_int n_blocks = (nw+coloring_block_size-1)/coloring_block_size;
+      // Speculative coloring of each block
+      ThreadPool::run(n_blocks, n_threads, [&](casadi_int b, casadi_int t) {
+        casadi_int end = min(nw, (b+1)*coloring_block_size);
+        for (casadi_int k=b*coloring_block_size; k<end; ++k) {
+          color[work[k]] = color_vertex(work[k], round*n+work[k], get_ptr(pos),
+                                        get_ptr(color), get_ptr(forbidden[t]));
+        }
+      });
+      // Detect conflicts between blocks
+      ThreadPool::run(n_blocks, n_threads, [&](casadi_int b, casadi_int t) {
+        casadi_int end = min(nw, (b+1)*coloring_block_size);
+        for (casadi_int k=b*coloring_block_size; k<end; ++k) {
+          flag[k] = conflict(work[k], get_ptr(pos), get_ptr(color));
+        }
+      });
+      // Collect the vertices to be recolored
+      next.clear();
+      for (casadi_int k=0; k<nw; ++k) {
+        if (flag[k]) {
+          next.push_back(work[k]);
+        } else {
+          pos[work[k]] = -1;
+          if (!used[color[work[k]]]) {
+            used[color[work[k]]] = 1;
+            // Cutoff if too many colors
+            if (++ncolors>cutoff) return false;
+          }
+        }
+      }
+      for (casadi_int k=0; k<next.size(); ++k) pos[next[k]] = k;
+      work.swap(next);
+    }
+    // Number the colors in use consecutively
+    ncolors = 0;
+    for (casadi_int c=0; c<n; ++c) if (used[c]) used[c] = ncolors++;
+    for (casadi_int v=0; v<n; ++v) color[v] = used[color[v]];
+    return true;
+  }
+
+  Sparsity SparsityInternal::uni_coloring(const Sparsity& AT, casadi_int cutoff,
+                                          casadi_int n_threads) const {
 
     // Access the sparsity of the transpose
     const casadi_int* AT_colind = AT.colind();
@@ -2902,6 +3270,47 @@ namespace casadi {
     const casadi_int* colind = this->colind();
     const casadi_int* row = this->row();
 
+    // Parallel coloring
+    if (n_threads>1) {
+      vector<casadi_int> color;
+      bool success = speculative_coloring(size2(), n_threads, cutoff,
+        [&](casadi_int i, casadi_int stamp, const casadi_int* pos, const casadi_int* color,
+            casadi_int* forbidden) {
+          // Mark the colors of the visible columns sharing a row as forbidden
+          for (casadi_int el=colind[i]; el<colind[i+1]; ++el) {
+            casadi_int c = row[el];
+            for (casadi_int el2=AT_colind[c]; el2<AT_colind[c+1]; ++el2) {
+              casadi_int i2 = AT_row[el2];
+              if (coloring_visible(i2, i, pos)) forbidden[color[i2]] = stamp;
+            }
+          }
+          // Get the first nonforbidden color
+          casadi_int color_i = 0;
+          while (forbidden[color_i]==stamp) color_i++;
+          return color_i;
+        },
+        [&](casadi_int i, const casadi_int* pos, const casadi_int* color) {
+          // Check the columns sharing a row that were colored concurrently
+          for (casadi_int el=colind[i]; el<colind[i+1]; ++el) {
+            casadi_int c = row[el];
+            for (casadi_int el2=AT_colind[c]; el2<AT_colind[c+1]; ++el2) {
+              casadi_int i2 = AT_row[el2];
+              if (color[i2]==color[i] && coloring_crosses(i2, i, pos)) return true;
+            }
+          }
+          return false;
+        }, color);
+      if (!success) return Sparsity();
+      casadi_int num_colors = 0;
+      for (casadi_int i=0; i<color.size(); ++i) num_colors = max(num_colors, color[i]+1);
+      return Sparsity::triplet(size2(), num_colors, range(size2()), color);
+    }
+
+    // Allocate temporary vectors
+    vector<casadi_int> forbiddenColors;
+    forbiddenColors.reserve(size2());
+    vector<casadi_int> color(size2(), 0);
+
     // Loop over columns
     for (casadi_int i=0; i<size2(); ++i) {
 
@@ -3231,7 +3640,8 @@ namespace casadi {
     return Sparsity(size2(), forbiddenColors.size(), ret_colind, ret_row);
   }
 
-  Sparsity SparsityInternal::star_coloring(casadi_int ordering, casadi_int cutoff) const {
+  Sparsity SparsityInternal::star_coloring(casadi_int ordering, casadi_int cutoff,
+                                           casadi_int n_threads) const {
     if (!is_square()) {
       // NOTE(@jaeandersson) Why warning and not error?
       casadi_message("StarColoring requires a square matrix, got " + dim() + ".");
@@ -3248,7 +3658,8 @@ namespace casadi {
       Sparsity sp_permuted = pmult(ord, true, true, true);
 
       // Star coloring for the permuted matrix
-      Sparsity ret_permuted = sp_permuted.star_coloring(0);
+      Sparsity ret_permuted = sp_permuted.star_coloring(0,
+        std::numeric_limits<casadi_int>::max(), n_threads);
 
       // Permute result back
       return ret_permuted.pmult(ord, true, false, false);
@@ -3257,6 +3668,94 @@ namespace casadi {
     // Allocate temporary vectors
     const casadi_int* colind = this->colind();
     const casadi_int* row = this->row();
+
+    // Parallel coloring, rule as below with the vertices not visible considered uncolored
+    if (n_threads>1) {
+      vector<casadi_int> color;
+      bool success = speculative_coloring(size2(), n_threads, cutoff,
+        [&](casadi_int i, casadi_int stamp, const casadi_int* pos, const casadi_int* color,
+            casadi_int* forbidden) {
+          for (casadi_int w_el=colind[i]; w_el<colind[i+1]; ++w_el) {
+            casadi_int w = row[w_el];
+            bool w_colored = coloring_visible(w, i, pos);
+            if (w_colored) forbidden[color[w]] = stamp;
+            // Since the vertices are not colored in order, i can also be an interior
+            // vertex of a two-colored path x-w-i-w2
+            if (w_colored) {
+              bool has_w2 = false;
+              for (casadi_int w2_el=colind[i]; w2_el<colind[i+1] && !has_w2; ++w2_el) {
+                casadi_int w2 = row[w2_el];
+                has_w2 = w2!=w && coloring_visible(w2, i, pos) && color[w2]==color[w];
+              }
+              if (has_w2) {
+                for (casadi_int x_el=colind[w]; x_el<colind[w+1]; ++x_el) {
+                  casadi_int x = row[x_el];
+                  if (coloring_visible(x, i, pos)) forbidden[color[x]] = stamp;
+                }
+              }
+            }
+            for (casadi_int x_el=colind[w]; x_el<colind[w+1]; ++x_el) {
+              casadi_int x = row[x_el];
+              if (!coloring_visible(x, i, pos)) continue;
+              if (!w_colored) {
+                forbidden[color[x]] = stamp;
+              } else {
+                for (casadi_int y_el=colind[x]; y_el<colind[x+1]; ++y_el) {
+                  casadi_int y = row[y_el];
+                  if (y==w || !coloring_visible(y, i, pos)) continue;
+                  if (color[y]==color[w]) {
+                    forbidden[color[x]] = stamp;
+                    break;
+                  }
+                }
+              }
+            }
+          }
+          casadi_int color_i = 0;
+          while (forbidden[color_i]==stamp) color_i++;
+          return color_i;
+        },
+        [&](casadi_int i, const casadi_int* pos, const casadi_int* color) {
+          // Look for an edge or a two-colored path on four vertices through i
+          // involving a vertex colored concurrently
+          for (casadi_int w_el=colind[i]; w_el<colind[i+1]; ++w_el) {
+            casadi_int w = row[w_el];
+            if (w==i) continue;
+            bool cross_w = coloring_crosses(w, i, pos);
+            if (color[w]==color[i] && cross_w) return true;
+            for (casadi_int x_el=colind[w]; x_el<colind[w+1]; ++x_el) {
+              casadi_int x = row[x_el];
+              if (x==i || x==w) continue;
+              bool cross_x = cross_w || coloring_crosses(x, i, pos);
+              // Path i-w-x-y
+              if (color[x]==color[i]) {
+                for (casadi_int y_el=colind[x]; y_el<colind[x+1]; ++y_el) {
+                  casadi_int y = row[y_el];
+                  if (y==i || y==w || y==x || color[y]!=color[w]) continue;
+                  if (cross_x || coloring_crosses(y, i, pos)) return true;
+                }
+              }
+            }
+            for (casadi_int x_el=colind[i]; x_el<colind[i+1]; ++x_el) {
+              casadi_int x = row[x_el];
+              if (x==i || x==w || color[x]!=color[w]) continue;
+              bool cross_x = cross_w || coloring_crosses(x, i, pos);
+              // Path w-i-x-y
+              for (casadi_int y_el=colind[x]; y_el<colind[x+1]; ++y_el) {
+                casadi_int y = row[y_el];
+                if (y==i || y==w || y==x || color[y]!=color[i]) continue;
+                if (cross_x || coloring_crosses(y, i, pos)) return true;
+              }
+            }
+          }
+          return false;
+        }, color);
+      if (!success) return Sparsity();
+      casadi_int num_colors = 0;
+      for (casadi_int i=0; i<color.size(); ++i) num_colors = max(num_colors, color[i]+1);
+      return Sparsity::triplet(size2(), num_colors, range(color.size()), color);
+    }
+
     vector<casadi_int> forbiddenColors;
     forbiddenColors.reserve(size2());
     vector<casadi_int> color(size2(), -1);
@@ -3737,32 +4236,6 @@ namespace casadi {
     return ret;
   }
 
-  casadi_int SparsityInternal::bw_upper() const {
-    casadi_int bw = 0;
-    const casadi_int* colind = this->colind();
-    const casadi_int* row = this->row();
-    for (casadi_int cc=0; cc<size2(); ++cc) {
-      if (colind[cc] != colind[cc+1]) { // if there are any elements of the column
-        casadi_int rr = row[colind[cc]];
-        bw = std::max(bw, cc-rr);
-      }
-    }
-    return bw;
-  }
-
-  casadi_int SparsityInternal::bw_lower() const {
-    casadi_int bw = 0;
-    const casadi_int* colind = this->colind();
-    const casadi_int* row = this->row();
-    for (casadi_int cc=0; cc<size2(); ++cc) {
-      if (colind[cc] != colind[cc+1]) { // if there are any elements of the column
-        casadi_int rr = row[colind[cc+1]-1];
-        bw = std::max(bw, rr-cc);
-      }
-    }
-    return bw;
-  }
-
   vector<casadi_int> SparsityInternal::get_colind() const {
     const casadi_int* colind = this->colind();
     return vector<casadi_int>(colind, colind+size2()+1);
@@ -29,6 +29,7 @@
 
 #include "sparsity.hpp"
 #include "shared_object_internal.hpp"
+#include <atomic>
 /// \cond INTERNAL
 
 namespace casadi {
@@ -56,6 +57,41 @@ namespace casadi {
     */
     mutable Btf* btf_;
 
+    /* \brief Structure, detected on construction
+      Lower and upper half-bandwidths, and whether all elements within the band and,
+      for square patterns, on the diagonal only, are nonzeros
+    */
+    casadi_int bw_lower_, bw_upper_;
+    bool banded_, diag_;
+
+    /* \brief Hash index from element (row + col*nrow) to nonzero
+      Open addressing with linear probing, in a table of (element, nonzero) pairs
+      where unused slots have element -1
+    */
+    struct NzIndex {
+      int shift;
+      std::vector<casadi_int> table;
+      inline casadi_int find(casadi_int k) const {
+        size_t mask = table.size()/2 - 1;
+        for (size_t i=(static_cast<uint64_t>(k)*0x9E3779B97F4A7C15ull) >> shift; ;
+             i = (i+1) & mask) {
+          if (table[2*i]==k) return table[2*i+1];
+          if (table[2*i]<0) return -1;
+        }
+      }
+    };
+
+    /// Columns longer than this are searched with the hash index
+    static const casadi_int nz_index_scan = 16;
+
+    /// Smallest number of lookups per thread in get_nz_elements
+    static const casadi_int nz_index_block = 1 << 14;
+
+    /* \brief The hash index, built on first use of nz_index()
+      Threads racing to build it keep the first one published
+    */
+    mutable std::atomic<NzIndex*> nz_index_;
+
   public:
     /// Construct a sparsity pattern from arrays
     SparsityInternal(casadi_int nrow, casadi_int ncol,
@@ -117,6 +153,23 @@ namespace casadi {
       */
     std::vector<casadi_int> amd() const;
 
+    /** \brief Nested dissection ordering
+      * Recursive bisection with separators from the middle level of a breadth-first
+      * level structure rooted at a pseudo-peripheral node, parts below leaf_size
+      * are ordered with AMD
+      */
+    std::vector<casadi_int> nd(casadi_int leaf_size=64) const;
+
+    /** \brief Order the nodes in v (all marked with mark[i]==v_id), for nd */
+    void nd_dissect(const std::vector<casadi_int>& v, casadi_int leaf_size,
+                    std::vector<casadi_int>& mark, casadi_int& next_id,
+                    std::vector<casadi_int>& level, std::vector<casadi_int>& p) const;
+
+    /** \brief Breadth-first search among the nodes marked id, for nd */
+    std::vector<casadi_int> nd_bfs(casadi_int root, casadi_int id,
+                                   const std::vector<casadi_int>& mark,
+                                   std::vector<casadi_int>& level) const;
+
     /** \brief Calculate the elimination tree for a matrix
       * len[w] >= ata ? ncol + nrow : ncol
       * len[parent] == ncol
@@ -413,10 +466,10 @@ namespace casadi {
     casadi_int nnz_diag() const;
 
     /** \brief Upper half-bandwidth */
-    casadi_int bw_upper() const;
+    casadi_int bw_upper() const { return bw_upper_;}
 
     /** \brief Lower half-bandwidth */
-    casadi_int bw_lower() const;
+    casadi_int bw_lower() const { return bw_lower_;}
 
     /// Shape
     std::pair<casadi_int, casadi_int> size() const;
@@ -444,7 +497,10 @@ namespace casadi {
     bool is_vector() const;
 
     /// Is diagonal?
-    bool is_diag() const;
+    bool is_diag() const { return diag_;}
+
+    /// Are all elements within the half-bandwidths nonzeros, e.g. dense or diagonal?
+    bool is_banded() const { return banded_;}
 
     /// Is square?
     bool is_square() const;
@@ -557,6 +613,14 @@ namespace casadi {
     /// Get the nonzero index for a set of elements (see description in public class)
     void get_nz(std::vector<casadi_int>& indices) const;
 
+    /// Get the nonzero index of each element (rr[k], cc[k]) (see public class)
+    std::vector<casadi_int> get_nz_elements(const std::vector<casadi_int>& rr,
+                                            const std::vector<casadi_int>& cc,
+                                            casadi_int n_threads) const;
+
+    /// Hash index from element to nonzero, built on first call
+    const NzIndex& nz_index() const;
+
     /// Does the rows appear sequentially on each col
     bool rowsSequential(bool strictly) const;
 
@@ -582,14 +646,15 @@ namespace casadi {
     /** \brief Perform a unidirectional coloring
      *
      * A greedy distance-2 coloring algorithm
-     * (Algorithm 3.1 in A. H. GEBREMEDHIN, F. MANNE, A. POTHEN)
+     * (Algorithm 3.1 in A. H. GEBREMEDHIN, F. MANNE, A. POTHEN),
+     * speculative and in parallel if n_threads>1
      */
-    Sparsity uni_coloring(const Sparsity& AT, casadi_int cutoff) const;
+    Sparsity uni_coloring(const Sparsity& AT, casadi_int cutoff, casadi_int n_threads=1) const;
 
     /** \brief A greedy distance-2 coloring algorithm
      * See description in public class.
      */
-    Sparsity star_coloring(casadi_int ordering, casadi_int cutoff) const;
+    Sparsity star_coloring(casadi_int ordering, casadi_int cutoff, casadi_int n_threads=1) const;
 
     /** \brief An improved distance-2 coloring algorithm
      * See description in public class.
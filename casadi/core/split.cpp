@@ -122,6 +122,18 @@ namespace casadi {
     }
   }
 
+  bool Split::is_equal(const MXNode* node, casadi_int depth) const {
+    // Check dependencies
+    if (!sameOpAndDeps(node, depth)) return false;
+
+    // Check if same node
+    const Split* n = dynamic_cast<const Split*>(node);
+    if (n==nullptr) return false;
+
+    // Check offsets and sparsity patterns of the outputs
+    return offset_==n->offset_ && output_sparsity_==n->output_sparsity_;
+  }
+
   Dict Split::info() const {
     std::vector<MX> arg;
     for (auto& sp : output_sparsity_)
@@ -76,6 +76,9 @@ namespace casadi {
     /** Obtain information about node */
     Dict info() const override;
 
+    /** \brief Check if two nodes are equivalent up to a given depth */
+    bool is_equal(const MXNode* node, casadi_int depth) const override;
+
     // Sparsity pattern of the outputs
     std::vector<casadi_int> offset_;
     std::vector<Sparsity> output_sparsity_;
@@ -31,25 +31,72 @@ namespace casadi {
 
   Switch::Switch(const std::string& name,
                  const std::vector<Function>& f, const Function& f_def)
-    : FunctionInternal(name), f_(f), f_def_(f_def) {
+    : FunctionInternal(name), f_(f), f_def_(f_def), lazy_nfwd_(0), lazy_nadj_(0) {
 
     // Consitency check
     casadi_assert_dev(!f_.empty());
   }
 
+  Switch::Switch(const std::string& name, const std::vector<Function>& f,
+                 const Function& f_def, casadi_int nfwd, casadi_int nadj)
+    : FunctionInternal(name), f_(f), f_def_(f_def), lazy_nfwd_(nfwd), lazy_nadj_(nadj),
+      lazy_f_(f.size()) {
+
+    // Consitency check
+    casadi_assert_dev(!f_.empty());
+    casadi_assert_dev((nfwd>0) != (nadj>0));
+  }
+
+  Options Switch::options_
+  = {{&FunctionInternal::options_},
+     {{"lazy_derivatives",
+       {OT_BOOL,
+        "Generate the derivative of a case only when the derivative function first "
+        "selects it during numerical evaluation. Derivative functions with lazily "
+        "generated cases do not support code generation and propagate dense "
+        "sparsity patterns [default: false]"}}
+     }
+  };
+
   Switch::~Switch() {
   }
 
+  casadi_int Switch::case_n_in(const Function& fk) const {
+    if (!lazy()) return fk.n_in();
+    return fk.n_in() + fk.n_out() + (lazy_nfwd_>0 ? fk.n_in() : fk.n_out());
+  }
+
+  casadi_int Switch::case_n_out(const Function& fk) const {
+    if (!lazy()) return fk.n_out();
+    return lazy_nfwd_>0 ? fk.n_out() : fk.n_in();
+  }
+
+  Sparsity Switch::case_sparsity_in(const Function& fk, casadi_int i) const {
+    if (!lazy()) return fk.sparsity_in(i);
+    // Nondifferentiated inputs and outputs, followed by the seeds
+    casadi_int n_in = fk.n_in(), n_out = fk.n_out();
+    if (i<n_in) return fk.sparsity_in(i);
+    if (i<n_in+n_out) return fk.sparsity_out(i-n_in);
+    if (lazy_nfwd_>0) return repmat(fk.sparsity_in(i-n_in-n_out), 1, lazy_nfwd_);
+    return repmat(fk.sparsity_out(i-n_in-n_out), 1, lazy_nadj_);
+  }
+
+  Sparsity Switch::case_sparsity_out(const Function& fk, casadi_int i) const {
+    if (!lazy()) return fk.sparsity_out(i);
+    if (lazy_nfwd_>0) return repmat(fk.sparsity_out(i), 1, lazy_nfwd_);
+    return repmat(fk.sparsity_in(i), 1, lazy_nadj_);
+  }
+
   size_t Switch::get_n_in() {
-    for (auto&& i : f_) if (!i.is_null()) return 1+i.n_in();
+    for (auto&& i : f_) if (!i.is_null()) return 1+case_n_in(i);
     casadi_assert_dev(!f_def_.is_null());
-    return 1+f_def_.n_in();
+    return 1+case_n_in(f_def_);
   }
 
   size_t Switch::get_n_out() {
-    for (auto&& i : f_) if (!i.is_null()) return i.n_out();
+    for (auto&& i : f_) if (!i.is_null()) return case_n_out(i);
     casadi_assert_dev(!f_def_.is_null());
-    return f_def_.n_out();
+    return case_n_out(f_def_);
   }
 
   Sparsity Switch::get_sparsity_in(casadi_int i) {
@@ -59,12 +106,12 @@ namespace casadi {
       Sparsity ret;
       for (auto&& fk : f_) {
         if (!fk.is_null()) {
-          const Sparsity& s = fk.sparsity_in(i-1);
+          Sparsity s = case_sparsity_in(fk, i-1);
           ret = ret.is_null() ? s : ret.unite(s);
         }
       }
       casadi_assert_dev(!f_def_.is_null());
-      const Sparsity& s = f_def_.sparsity_in(i-1);
+      Sparsity s = case_sparsity_in(f_def_, i-1);
       ret = ret.is_null() ? s : ret.unite(s);
       return ret;
     }
@@ -74,12 +121,12 @@ namespace casadi {
     Sparsity ret;
     for (auto&& fk : f_) {
       if (!fk.is_null()) {
-        const Sparsity& s = fk.sparsity_out(i);
+        Sparsity s = case_sparsity_out(fk, i);
         ret = ret.is_null() ? s : ret.unite(s);
       }
     }
     casadi_assert_dev(!f_def_.is_null());
-    const Sparsity& s = f_def_.sparsity_out(i);
+    Sparsity s = case_sparsity_out(f_def_, i);
     ret = ret.is_null() ? s : ret.unite(s);
     return ret;
   }
@@ -88,11 +135,25 @@ namespace casadi {
     // Call the initialization method of the base class
     FunctionInternal::init(opts);
 
-    // Buffer for mismatching sparsities
-    size_t sz_buf=0;
+    // Default options
+    lazy_derivatives_ = false;
+
+    // Read options
+    for (auto&& op : opts) {
+      if (op.first=="lazy_derivatives") {
+        lazy_derivatives_ = op.second;
+      }
+    }
 
     // Keep track of sparsity projections
     project_in_ = project_out_ = false;
+    sz_sp_res_ = sz_sp_proj_ = 0;
+
+    // The cases of a lazy switch allocate their work vectors upon evaluation
+    if (lazy()) return;
+
+    // Buffer for mismatching sparsities
+    size_t sz_buf=0;
 
     // Get required work
     for (casadi_int k=0; k<=f_.size(); ++k) {
@@ -127,15 +188,221 @@ namespace casadi {
 
       // Only need the largest of these work vectors
       sz_buf = max(sz_buf, sz_buf_k);
+      sz_sp_res_ = max(sz_sp_res_, fk.nnz_out());
+    }
+
+    // Work vectors for sparsity propagation: accumulated result or seeds,
+    // outputs of a case, projected inputs or outputs and projection work
+    for (casadi_int i=1; i<n_in_; ++i) {
+      sz_sp_proj_ = max(sz_sp_proj_, nnz_in(i) + size1_in(i));
+    }
+    for (casadi_int i=0; i<n_out_; ++i) {
+      sz_sp_proj_ = max(sz_sp_proj_, nnz_out(i) + size1_out(i));
     }
 
     // Memory for the work vectors
     alloc_w(sz_buf, true);
+    alloc_w(nnz_out() + sz_sp_res_ + sz_sp_proj_, true);
+  }
+
+  bool Switch::is_thread_safe() const {
+    for (auto&& fk : f_) {
+      if (!fk.is_null() && !fk->is_thread_safe()) return false;
+    }
+    return f_def_.is_null() || f_def_->is_thread_safe();
+  }
+
+  const Function& Switch::get_case(casadi_int k) const {
+    bool def = k<0 || k>=f_.size();
+    if (!lazy()) return def ? f_def_ : f_[k];
+#ifdef CASADI_WITH_THREAD
+    std::lock_guard<std::mutex> lock(lazy_mtx_);
+#endif // CASADI_WITH_THREAD
+    Function& dk = def ? lazy_f_def_ : lazy_f_[k];
+    const Function& fk = def ? f_def_ : f_[k];
+    if (dk.is_null() && !fk.is_null()) {
+      if (verbose_) casadi_message(name_ + ": generating derivative of " + fk.name());
+      dk = lazy_nfwd_>0 ? fk.forward(lazy_nfwd_) : fk.reverse(lazy_nadj_);
+    }
+    return dk;
+  }
+
+  Function Switch::get_full() const {
+    if (!lazy()) return self();
+    if (lazy_full_.is_null()) {
+      vector<Function> f(f_.size());
+      for (casadi_int k=0; k<f_.size(); ++k) f[k] = get_case(k);
+      Function f_def = get_case(-1);
+#ifdef CASADI_WITH_THREAD
+      std::lock_guard<std::mutex> lock(lazy_mtx_);
+#endif // CASADI_WITH_THREAD
+      if (lazy_full_.is_null()) lazy_full_ = Function::conditional(name_ + "_full", f, f_def);
+    }
+    return lazy_full_;
+  }
+
+  template<typename T>
+  int Switch::eval_projected(const Function& fk, const T** arg, T** res, casadi_int off) const {
+    if (fk.is_null()) return 1;
+    // Work vectors, the function may have been generated after initialization
+    std::vector<const T*> arg1(fk.sz_arg());
+    std::vector<T*> res1(fk.sz_res());
+    std::vector<casadi_int> iw(fk.sz_iw());
+    std::vector<T> w(fk.sz_w()), buf(fk.nnz_in() + fk.nnz_out());
+    casadi_int sz_pw = 0;
+    for (casadi_int i=0; i<fk.n_in(); ++i) sz_pw = max(sz_pw, fk.size1_in(i));
+    for (casadi_int i=0; i<fk.n_out(); ++i) sz_pw = max(sz_pw, fk.size1_out(i));
+    std::vector<T> pw(sz_pw);
+    T* b = get_ptr(buf);
+    // Project arguments with different sparsity
+    for (casadi_int i=0; i<fk.n_in(); ++i) {
+      const Sparsity& f_sp = fk.sparsity_in(i);
+      const Sparsity& sp = sparsity_in_[i+off];
+      arg1[i] = arg[i];
+      if (arg1[i] && f_sp!=sp) {
+        casadi_project(arg1[i], sp, b, f_sp, get_ptr(pw));
+        arg1[i] = b; b += f_sp.nnz();
+      }
+    }
+    // Temporary memory for results with different sparsity
+    for (casadi_int i=0; i<fk.n_out(); ++i) {
+      res1[i] = res[i];
+      if (res1[i] && fk.sparsity_out(i)!=sparsity_out_[i]) {
+        res1[i] = b; b += fk.nnz_out(i);
+      }
+    }
+    // Evaluate
+    if (fk(get_ptr(arg1), get_ptr(res1), get_ptr(iw), get_ptr(w), 0)) return 1;
+    // Project results with different sparsity
+    for (casadi_int i=0; i<fk.n_out(); ++i) {
+      const Sparsity& f_sp = fk.sparsity_out(i);
+      if (res[i] && f_sp!=sparsity_out_[i]) {
+        casadi_project(res1[i], f_sp, res[i], sparsity_out_[i], get_ptr(pw));
+      }
+    }
+    return 0;
+  }
+
+  int Switch::sp_forward(const bvec_t** arg, bvec_t** res,
+                         casadi_int* iw, bvec_t* w, void* mem) const {
+    // Union of the dependencies of all cases
+    bvec_t* acc = w; w += nnz_out();
+    casadi_fill(acc, nnz_out(), bvec_t(0));
+    bvec_t* res_buf = w; w += sz_sp_res_;
+    bvec_t* proj = w; w += sz_sp_proj_;
+    const bvec_t** arg1 = arg + n_in_;
+    bvec_t** res1 = res + n_out_;
+    for (casadi_int k=0; k<=f_.size(); ++k) {
+      const Function& fk = k<f_.size() ? f_[k] : f_def_;
+      if (fk.is_null()) continue;
+      bvec_t* wk = w;
+      // Project arguments with different sparsity
+      for (casadi_int i=0; i<n_in_-1; ++i) {
+        const Sparsity& f_sp = fk.sparsity_in(i);
+        const Sparsity& sp = sparsity_in_[i+1];
+        arg1[i] = arg[i+1];
+        if (arg1[i] && f_sp!=sp) {
+          casadi_project(arg1[i], sp, wk, f_sp, proj);
+          arg1[i] = wk; wk += f_sp.nnz();
+        }
+      }
+      // Results of the case
+      bvec_t* r = res_buf;
+      for (casadi_int i=0; i<n_out_; ++i) {
+        res1[i] = res[i] ? r : nullptr;
+        r += fk.nnz_out(i);
+      }
+      if (fk(arg1, res1, iw, wk, 0)) return 1;
+      // Add to the union, projecting results with different sparsity
+      bvec_t* a = acc;
+      for (casadi_int i=0; i<n_out_; ++i) {
+        const Sparsity& f_sp = fk.sparsity_out(i);
+        const Sparsity& sp = sparsity_out_[i];
+        if (res[i]) {
+          const bvec_t* ri = res1[i];
+          if (f_sp!=sp) {
+            casadi_project(ri, f_sp, proj, sp, proj + nnz_out(i));
+            ri = proj;
+          }
+          for (casadi_int j=0; j<nnz_out(i); ++j) a[j] |= ri[j];
+        }
+        a += nnz_out(i);
+      }
+    }
+    // Copy to the results
+    for (casadi_int i=0; i<n_out_; ++i) {
+      if (res[i]) casadi_copy(acc, nnz_out(i), res[i]);
+      acc += nnz_out(i);
+    }
+    return 0;
+  }
+
+  int Switch::sp_reverse(bvec_t** arg, bvec_t** res,
+                         casadi_int* iw, bvec_t* w, void* mem) const {
+    // Seeds, propagated through all cases
+    bvec_t* seed = w; w += nnz_out();
+    bvec_t* s = seed;
+    for (casadi_int i=0; i<n_out_; ++i) {
+      if (res[i]) {
+        casadi_copy(res[i], nnz_out(i), s);
+        casadi_fill(res[i], nnz_out(i), bvec_t(0));
+      }
+      s += nnz_out(i);
+    }
+    bvec_t* res_buf = w; w += sz_sp_res_;
+    bvec_t* proj = w; w += sz_sp_proj_;
+    bvec_t** arg1 = arg + n_in_;
+    bvec_t** res1 = res + n_out_;
+    for (casadi_int k=0; k<=f_.size(); ++k) {
+      const Function& fk = k<f_.size() ? f_[k] : f_def_;
+      if (fk.is_null()) continue;
+      bvec_t* wk = w;
+      // Seeds of the case, projected if the sparsity differs
+      bvec_t* r = res_buf;
+      s = seed;
+      for (casadi_int i=0; i<n_out_; ++i) {
+        const Sparsity& f_sp = fk.sparsity_out(i);
+        const Sparsity& sp = sparsity_out_[i];
+        res1[i] = res[i] ? r : nullptr;
+        if (res[i]) {
+          if (f_sp!=sp) {
+            casadi_project(s, sp, r, f_sp, proj);
+          } else {
+            casadi_copy(s, nnz_out(i), r);
+          }
+        }
+        r += f_sp.nnz();
+        s += nnz_out(i);
+      }
+      // Sensitivities, buffered if the sparsity differs
+      for (casadi_int i=0; i<n_in_-1; ++i) {
+        const Sparsity& f_sp = fk.sparsity_in(i);
+        arg1[i] = arg[i+1];
+        if (arg1[i] && f_sp!=sparsity_in_[i+1]) {
+          arg1[i] = wk; wk += f_sp.nnz();
+          casadi_fill(arg1[i], f_sp.nnz(), bvec_t(0));
+        }
+      }
+      if (fk.rev(arg1, res1, iw, wk, 0)) return 1;
+      // Add buffered sensitivities
+      for (casadi_int i=0; i<n_in_-1; ++i) {
+        const Sparsity& f_sp = fk.sparsity_in(i);
+        const Sparsity& sp = sparsity_in_[i+1];
+        if (arg[i+1] && f_sp!=sp) {
+          casadi_project(arg1[i], f_sp, proj, sp, proj + sp.nnz());
+          for (casadi_int j=0; j<sp.nnz(); ++j) arg[i+1][j] |= proj[j];
+        }
+      }
+    }
+    return 0;
   }
 
   int Switch::eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const {
     // Get the function to be evaluated
     casadi_int k = arg[0] ? static_cast<casadi_int>(*arg[0]) : 0;
+
+    // Derivative of a single case, generated if needed
+    if (lazy()) return eval_projected(get_case(k), arg+1, res, 1);
     const Function& fk = k>=0 && k<f_.size() ? f_[k] : f_def_;
 
     // Project arguments with different sparsity
@@ -197,18 +464,27 @@ namespace casadi {
                 const std::vector<std::string>& inames,
                 const std::vector<std::string>& onames,
                 const Dict& opts) const {
-    // Derivative of each case
-    vector<Function> der(f_.size());
-    for (casadi_int k=0; k<f_.size(); ++k) {
-      if (!f_[k].is_null()) der[k] = f_[k].forward(nfwd);
-    }
-
-    // Default case
-    Function der_def;
-    if (!f_def_.is_null()) der_def = f_def_.forward(nfwd);
+    // Derivatives of a lazy switch: switch over all derivative cases
+    if (lazy()) return get_full()->get_forward(nfwd, name, inames, onames, opts);
 
     // New Switch for derivatives
-    Function sw = Function::conditional("switch_" + name, der, der_def);
+    Function sw;
+    if (lazy_derivatives_) {
+      // Derivative of a case generated when first selected
+      sw = Function::create(new Switch("switch_" + name, f_, f_def_, nfwd, 0), Dict());
+    } else {
+      // Derivative of each case
+      vector<Function> der(f_.size());
+      for (casadi_int k=0; k<f_.size(); ++k) {
+        if (!f_[k].is_null()) der[k] = f_[k].forward(nfwd);
+      }
+
+      // Default case
+      Function der_def;
+      if (!f_def_.is_null()) der_def = f_def_.forward(nfwd);
+
+      sw = Function::conditional("switch_" + name, der, der_def);
+    }
 
     // Get expressions for the derivative switch
     vector<MX> arg = sw.mx_in();
@@ -226,18 +502,27 @@ namespace casadi {
                 const std::vector<std::string>& inames,
                 const std::vector<std::string>& onames,
                 const Dict& opts) const {
-    // Derivative of each case
-    vector<Function> der(f_.size());
-    for (casadi_int k=0; k<f_.size(); ++k) {
-      if (!f_[k].is_null()) der[k] = f_[k].reverse(nadj);
-    }
-
-    // Default case
-    Function der_def;
-    if (!f_def_.is_null()) der_def = f_def_.reverse(nadj);
+    // Derivatives of a lazy switch: switch over all derivative cases
+    if (lazy()) return get_full()->get_reverse(nadj, name, inames, onames, opts);
 
     // New Switch for derivatives
-    Function sw = Function::conditional("switch_" + name, der, der_def);
+    Function sw;
+    if (lazy_derivatives_) {
+      // Derivative of a case generated when first selected
+      sw = Function::create(new Switch("switch_" + name, f_, f_def_, 0, nadj), Dict());
+    } else {
+      // Derivative of each case
+      vector<Function> der(f_.size());
+      for (casadi_int k=0; k<f_.size(); ++k) {
+        if (!f_[k].is_null()) der[k] = f_[k].reverse(nadj);
+      }
+
+      // Default case
+      Function der_def;
+      if (!f_def_.is_null()) der_def = f_def_.reverse(nadj);
+
+      sw = Function::conditional("switch_" + name, der, der_def);
+    }
 
     // Get expressions for the derivative switch
     vector<MX> arg = sw.mx_in();
@@ -252,6 +537,10 @@ namespace casadi {
 
   void Switch::disp_more(ostream &stream) const {
     // Print more
+    if (lazy()) {
+      stream << (lazy_nfwd_>0 ? "forward(" + str(lazy_nfwd_) : "reverse(" + str(lazy_nadj_))
+             << ") of ";
+    }
     if (f_.size()==1) {
       // Print as if-then-else
       stream << f_def_.name() << ", " << f_[0].name();
@@ -275,6 +564,9 @@ namespace casadi {
 
   int Switch::eval_sx(const SXElem** arg, SXElem** res,
       casadi_int* iw, SXElem* w, void* mem) const {
+    // All cases of a lazy switch are needed
+    if (lazy()) return eval_projected(get_full(), arg, res, 0);
+
     // Input and output buffers
     const SXElem** arg1 = arg + n_in_;
     SXElem** res1 = res + n_out_;
@@ -357,7 +649,46 @@ namespace casadi {
     return 0;
   }
 
+  Dict Switch::codegen_footprint(const CodeGenerator& g) const {
+    Dict r = FunctionInternal::codegen_footprint(g);
+    // One of the cases is evaluated, depending on the input
+    std::vector<std::string> calls;
+    for (auto&& f : f_) if (!f.is_null()) calls.push_back(f.name());
+    if (!f_def_.is_null()) calls.push_back(f_def_.name());
+    r["calls"] = calls;
+    r["control"] = "branching";
+    return r;
+  }
+
   void Switch::codegen_body(CodeGenerator& g) const {
+    // Dispatch via a table of function pointers if no projections are needed
+    if (!project_in_ && !project_out_ && f_.size()>2 && !f_def_.is_null()) {
+      std::vector<std::string> names;
+      for (casadi_int k=0; k<=f_.size(); ++k) {
+        const Function& fk = k<f_.size() ? f_[k] : f_def_;
+        if (fk.is_null()) break;
+        std::string fname = g.add_dependency(fk);
+        // External functions may have a different signature
+        if (fname!=fk->codegen_name(g)) break;
+        names.push_back(fname);
+      }
+      if (names.size()==f_.size()+1) {
+        g.add_auxiliary(CodeGenerator::AUX_TO_INT);
+        g.local("k", "casadi_int");
+        g << "static int (*const tbl[" << f_.size() << "])(const casadi_real**, casadi_real**, "
+          << "casadi_int*, casadi_real*, void*) = {";
+        for (casadi_int k=0; k<f_.size(); ++k) {
+          if (k>0) g << ", ";
+          g << names[k];
+        }
+        g << "};\n"
+          << "k = arg[0] ? casadi_to_int(*arg[0]) : 0;\n"
+          << "if ((k>=0 && k<" << f_.size() << " ? tbl[k] : " << names.back()
+          << ")(arg+1, res, iw, w, 0)) return 1;\n";
+        return;
+      }
+    }
+
     // Project arguments with different sparsity
     if (project_in_) {
       // Project one or more argument
@@ -461,7 +792,8 @@ namespace casadi {
 
   Dict Switch::info() const {
     return {{"project_in", project_in_}, {"project_out", project_out_},
-            {"f_def", f_def_}, {"f", f_}};
+            {"f_def", f_def_}, {"f", f_}, {"lazy_derivatives", lazy_derivatives_},
+            {"nfwd", lazy_nfwd_}, {"nadj", lazy_nadj_}};
   }
 
 } // namespace casadi
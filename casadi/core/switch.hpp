@@ -43,6 +43,11 @@ namespace casadi {
     Switch(const std::string& name,
                    const std::vector<Function>& f, const Function& f_def);
 
+    /** \brief Constructor (derivatives of the cases, generated upon first selection)
+        Exactly one of nfwd and nadj is nonzero */
+    Switch(const std::string& name, const std::vector<Function>& f, const Function& f_def,
+           casadi_int nfwd, casadi_int nadj);
+
     /** \brief  Destructor */
     ~Switch() override;
 
@@ -61,12 +66,50 @@ namespace casadi {
     Sparsity get_sparsity_out(casadi_int i) override;
     /// @}
 
+    ///@{
+    /** \brief Options */
+    static Options options_;
+    const Options& get_options() const override { return options_;}
+    ///@}
+
     /** \brief  Initialize */
     void init(const Dict& opts) override;
 
+    /** \brief Function evaluated for index k, default case if out of range
+        Derivatives of lazy switches are generated upon the first call */
+    const Function& get_case(casadi_int k) const;
+
+    /** \brief Switch over all cases, generating all of them for a lazy switch */
+    Function get_full() const;
+
+    /** \brief Number of inputs and outputs of a case, excluding the index */
+    casadi_int case_n_in(const Function& fk) const;
+    casadi_int case_n_out(const Function& fk) const;
+
+    /** \brief Sparsity of an input or output of a case, also if not yet generated */
+    Sparsity case_sparsity_in(const Function& fk, casadi_int i) const;
+    Sparsity case_sparsity_out(const Function& fk, casadi_int i) const;
+
+    /** \brief Evaluate fk, projecting from and to the sparsities of this function
+        Input i of fk corresponds to input i+off, work vectors are allocated here */
+    template<typename T>
+    int eval_projected(const Function& fk, const T** arg, T** res, casadi_int off) const;
+
+    ///@{
+    /** \brief Propagate sparsity through all cases */
+    bool has_spfwd() const override { return !lazy();}
+    bool has_sprev() const override { return !lazy();}
+    int sp_forward(const bvec_t** arg, bvec_t** res,
+                   casadi_int* iw, bvec_t* w, void* mem) const override;
+    int sp_reverse(bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w, void* mem) const override;
+    ///@}
+
     /** \brief  Evaluate numerically, work vectors given */
     int eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const override;
 
+    /** \brief Thread-safe if all cases are */
+    bool is_thread_safe() const override;
+
     /** \brief  evaluate symbolically while also propagating directional derivatives */
     int eval_sx(const SXElem** arg, SXElem** res,
                 casadi_int* iw, SXElem* w, void* mem) const override;
@@ -96,11 +139,14 @@ namespace casadi {
     void codegen_declarations(CodeGenerator& g) const override;
 
     /** \brief Is codegen supported? */
-    bool has_codegen() const override { return true;}
+    bool has_codegen() const override { return !lazy();}
 
     /** \brief Generate code for the body of the C function */
     void codegen_body(CodeGenerator& g) const override;
 
+    /** \brief Worst-case footprint of the generated code */
+    Dict codegen_footprint(const CodeGenerator& g) const override;
+
     // Function to be evaluated for each case
     std::vector<Function> f_;
 
@@ -110,6 +156,27 @@ namespace casadi {
     // Sparsity projection needed?
     bool project_in_, project_out_;
 
+    // Generate the derivatives of the cases lazily
+    bool lazy_derivatives_;
+
+    // Lazy switch: number of forward or adjoint directions of the derivatives of f_, f_def_
+    casadi_int lazy_nfwd_, lazy_nadj_;
+
+    // Work vector sizes for sparsity propagation
+    casadi_int sz_sp_res_, sz_sp_proj_;
+
+    // Lazy switch: derivatives generated so far
+    mutable std::vector<Function> lazy_f_;
+    mutable Function lazy_f_def_, lazy_full_;
+
+#ifdef CASADI_WITH_THREAD
+    // Protects the generation of lazy derivatives
+    mutable std::mutex lazy_mtx_;
+#endif // CASADI_WITH_THREAD
+
+    /** \brief Are the cases derivatives generated upon first selection? */
+    bool lazy() const { return lazy_nfwd_>0 || lazy_nadj_>0;}
+
     /** Obtain information about node */
     Dict info() const override;
 
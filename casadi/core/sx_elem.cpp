@@ -43,6 +43,10 @@ namespace casadi {
   // Allocate storage for the caching
   CACHING_MAP<casadi_int, IntegerSX*> IntegerSX::cached_constants_;
   CACHING_MAP<double, RealtypeSX*> RealtypeSX::cached_constants_;
+#ifdef CASADI_WITH_THREAD
+  std::mutex IntegerSX::mtx_;
+  std::mutex RealtypeSX::mtx_;
+#endif // CASADI_WITH_THREAD
 
   SXElem::SXElem() {
     node = casadi_limits<SXElem>::nan.node;
@@ -70,14 +74,18 @@ namespace casadi {
       else if (intval == 1)        node = casadi_limits<SXElem>::one.node;
       else if (intval == 2)        node = casadi_limits<SXElem>::two.node;
       else if (intval == -1)       node = casadi_limits<SXElem>::minus_one.node;
-      else                        node = IntegerSX::create(intval);
-      node->count++;
+      else                        node = nullptr;
+      // Cached constants are returned with the reference already counted
+      if (node) node->count++;
+      else node = IntegerSX::create(intval);
     } else {
       if (isnan(val))              node = casadi_limits<SXElem>::nan.node;
       else if (isinf(val))         node = val > 0 ? casadi_limits<SXElem>::inf.node :
                                       casadi_limits<SXElem>::minus_inf.node;
-      else                        node = RealtypeSX::create(val);
-      node->count++;
+      else                        node = nullptr;
+      // Cached constants are returned with the reference already counted
+      if (node) node->count++;
+      else node = RealtypeSX::create(val);
     }
   }
 
@@ -110,14 +118,11 @@ namespace casadi {
   }
 
   SXNode* SXElem::assignNoDelete(const SXElem& scalar) {
-    // Return value
-    SXNode* ret = node;
-
     // quick return if the old and new pointers point to the same object
-    if (node == scalar.node) return ret;
+    if (node == scalar.node) return nullptr;
 
     // decrease the counter but do not delete if this was the last pointer
-    --node->count;
+    SXNode* ret = --node->count == 0 ? node : nullptr;
 
     // save the new pointer
     node = scalar.node;
@@ -517,7 +522,7 @@ namespace casadi {
   const SXElem casadi_limits<SXElem>::zero(new ZeroSX(), false);
   // node corresponding to a constant 1
   const SXElem casadi_limits<SXElem>::one(new OneSX(), false);
-  // node corresponding to a constant 2
+  // node corresponding to a constant 2, never deleted (extra reference from "create")
   const SXElem casadi_limits<SXElem>::two(IntegerSX::create(2), false);
   // node corresponding to a constant -1
   const SXElem casadi_limits<SXElem>::minus_one(new MinusOneSX(), false);
@@ -0,0 +1,156 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#include "sx_forward.hpp"
+#include "sx_function.hpp"
+
+using namespace std;
+
+namespace casadi {
+
+  SXForward::SXForward(const std::string& name, casadi_int nfwd)
+    : FunctionInternal(name), nfwd_(nfwd) {
+  }
+
+  SXForward::~SXForward() {
+  }
+
+  void SXForward::init(const Dict& opts) {
+    // Call the initialization method of the base class
+    FunctionInternal::init(opts);
+
+    // The algorithm being differentiated
+    const SXFunction* f = static_cast<const SXFunction*>(derivative_of_.get());
+    casadi_assert(f->free_vars_.empty(), "Cannot differentiate \"" + derivative_of_.name()
+                  + "\" since variables " + str(f->free_vars_) + " are free.");
+    n_w_ = f->worksize_;
+
+    // Values and directional derivatives
+    alloc_w(n_w_*(1 + nfwd_), true);
+  }
+
+  Sparsity SXForward::get_sparsity_in(casadi_int i) {
+    casadi_int n_in = derivative_of_.n_in(), n_out = derivative_of_.n_out();
+    if (i<n_in) {
+      // Non-differentiated input
+      return derivative_of_.sparsity_in(i);
+    } else if (i<n_in+n_out) {
+      // Non-differentiated output
+      return derivative_of_.sparsity_out(i-n_in);
+    } else {
+      // Seeds
+      return repmat(derivative_of_.sparsity_in(i-n_in-n_out), 1, nfwd_);
+    }
+  }
+
+  Sparsity SXForward::get_sparsity_out(casadi_int i) {
+    return repmat(derivative_of_.sparsity_out(i), 1, nfwd_);
+  }
+
+  size_t SXForward::get_n_in() {
+    return derivative_of_.n_in() + derivative_of_.n_out() + derivative_of_.n_in();
+  }
+
+  size_t SXForward::get_n_out() {
+    return derivative_of_.n_out();
+  }
+
+  std::string SXForward::get_name_in(casadi_int i) {
+    casadi_int n_in = derivative_of_.n_in(), n_out = derivative_of_.n_out();
+    if (i<n_in) {
+      return derivative_of_.name_in(i);
+    } else if (i<n_in+n_out) {
+      return "out_" + derivative_of_.name_out(i-n_in);
+    } else {
+      return "fwd_" + derivative_of_.name_in(i-n_in-n_out);
+    }
+  }
+
+  std::string SXForward::get_name_out(casadi_int i) {
+    return "fwd_" + derivative_of_.name_out(i);
+  }
+
+  int SXForward::eval(const double** arg, double** res,
+                      casadi_int* iw, double* w, void* mem) const {
+    const SXFunction* f = static_cast<const SXFunction*>(derivative_of_.get());
+    casadi_int n_in = f->n_in_, n_out = f->n_out_, nfwd = nfwd_;
+
+    // Forward seeds
+    const double** seed = arg + n_in + n_out;
+
+    // Values, followed by the directional derivatives of each element
+    double* v = w;
+    double* vd = w + n_w_;
+
+    // Propagate all directions through one instruction at a time
+    double d[2];
+    for (auto&& e : f->algorithm_) {
+      double* r = vd + e.i0*nfwd;
+      switch (e.op) {
+      case OP_CONST:
+        v[e.i0] = e.d;
+        for (casadi_int k=0; k<nfwd; ++k) r[k] = 0;
+        break;
+      case OP_INPUT:
+        v[e.i0] = arg[e.i1]==nullptr ? 0 : arg[e.i1][e.i2];
+        if (seed[e.i1]==nullptr) {
+          for (casadi_int k=0; k<nfwd; ++k) r[k] = 0;
+        } else {
+          const double* s = seed[e.i1] + e.i2;
+          casadi_int nnz = f->nnz_in(e.i1);
+          for (casadi_int k=0; k<nfwd; ++k) r[k] = s[k*nnz];
+        }
+        break;
+      case OP_OUTPUT:
+        if (res[e.i0]!=nullptr) {
+          double* s = res[e.i0] + e.i2;
+          const double* x = vd + e.i1*nfwd;
+          casadi_int nnz = f->nnz_out(e.i0);
+          for (casadi_int k=0; k<nfwd; ++k) s[k*nnz] = x[k];
+        }
+        break;
+      default:
+        {
+          // The result may overwrite one of the arguments, element by element
+          const double* x = vd + e.i1*nfwd;
+          const double* y = vd + e.i2*nfwd;
+          double xv = v[e.i1], yv = v[e.i2];
+          casadi_math<double>::derF(e.op, xv, yv, v[e.i0], d);
+          if (e.i1==e.i2) {
+            // Unary operation or same argument twice
+            double d0 = d[0] + d[1];
+            for (casadi_int k=0; k<nfwd; ++k) r[k] = d0*x[k];
+          } else {
+            double d0 = d[0], d1 = d[1];
+            for (casadi_int k=0; k<nfwd; ++k) r[k] = d0*x[k] + d1*y[k];
+          }
+        }
+      }
+    }
+    return 0;
+  }
+
+} // namespace casadi
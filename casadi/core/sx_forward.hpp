@@ -0,0 +1,88 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#ifndef CASADI_SX_FORWARD_HPP
+#define CASADI_SX_FORWARD_HPP
+
+#include "function_internal.hpp"
+
+/// \cond INTERNAL
+
+namespace casadi {
+  /** Numerical vector-mode forward derivatives of an SXFunction
+    *
+    * Propagates all forward directions through each instruction of the
+    * SXFunction at once. The directional derivatives of a work vector element
+    * are stored contiguously, so that the inner loop over the directions
+    * can be vectorized, cf. SXFunction option "vector_forward".
+  */
+  class CASADI_EXPORT SXForward : public FunctionInternal {
+  public:
+    // Constructor
+    SXForward(const std::string& name, casadi_int nfwd);
+
+    /** \brief Destructor */
+    ~SXForward() override;
+
+    /** \brief Get type name */
+    std::string class_name() const override {return "SXForward";}
+
+    /// @{
+    /** \brief Sparsities of function inputs and outputs */
+    Sparsity get_sparsity_in(casadi_int i) override;
+    Sparsity get_sparsity_out(casadi_int i) override;
+    /// @}
+
+    ///@{
+    /** \brief Number of function inputs and outputs */
+    size_t get_n_in() override;
+    size_t get_n_out() override;
+    ///@}
+
+    ///@{
+    /** \brief Names of function input and outputs */
+    std::string get_name_in(casadi_int i) override;
+    std::string get_name_out(casadi_int i) override;
+    ///@}
+
+    /** \brief  Initialize */
+    void init(const Dict& opts) override;
+
+    // Evaluate numerically
+    int eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const override;
+
+  protected:
+    // Number of forward directions
+    casadi_int nfwd_;
+
+    // Work vector size
+    casadi_int n_w_;
+  };
+
+} // namespace casadi
+/// \endcond
+
+#endif // CASADI_SX_FORWARD_HPP
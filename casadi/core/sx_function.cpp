@@ -30,12 +30,20 @@
 #include <fstream>
 #include <sstream>
 #include <iomanip>
+#include <cstring>
+#include <unordered_map>
+#include <algorithm>
 #include "casadi_misc.hpp"
 #include "sx_node.hpp"
 #include "casadi_common.hpp"
 #include "sparsity_internal.hpp"
 #include "global_options.hpp"
 #include "casadi_interrupt.hpp"
+#include "sx_reverse.hpp"
+#include "sx_hessvec.hpp"
+#include "sx_forward.hpp"
+#include "binary_serializer.hpp"
+#include "vector_math.hpp"
 
 namespace casadi {
 
@@ -52,6 +60,16 @@ namespace casadi {
     // Default (persistent) options
     just_in_time_opencl_ = false;
     just_in_time_sparsity_ = false;
+    sp_width_ = 1;
+    n_cse_removed_ = -1;
+    n_instructions_initial_ = -1;
+    checkpointing_ = false;
+    checkpoint_memory_ = 1 << 26;
+    vector_forward_ = false;
+    profile_sampling_ = 0;
+    loop_rolling_ = false;
+    batch_math_ = true;
+    batch_math_fast_ = false;
   }
 
   SXFunction::~SXFunction() {
@@ -73,6 +91,18 @@ namespace casadi {
     // class structure can cause large performance losses. For this reason,
     // the preprocessor macros are used below
 
+    // Profiled evaluation, cf. option "profile_instructions"
+    if (mem) {
+      eval_profile(arg, res, w, *static_cast<InstructionProfile*>(mem));
+      return 0;
+    }
+
+    // Evaluate the fused algorithm, if available
+    if (!fused_.empty()) {
+      eval_fused(arg, res, w);
+      return 0;
+    }
+
     // Evaluate the algorithm
     for (auto&& e : algorithm_) {
       switch (e.op) {
@@ -88,6 +118,174 @@ namespace casadi {
     return 0;
   }
 
+  void SXFunction::eval_profile(const double** arg, double** res, double* w,
+                                InstructionProfile& m) const {
+    // Count the executed operations per opcode, timing on average every n-th instruction
+    for (auto&& e : algorithm_) {
+      m.n_call[e.op]++;
+      bool sample = profile_sampling_>0 && m.sample(profile_sampling_);
+      std::chrono::steady_clock::time_point t0;
+      if (sample) t0 = std::chrono::steady_clock::now();
+      switch (e.op) {
+        CASADI_MATH_FUN_BUILTIN(w[e.i1], w[e.i2], w[e.i0])
+
+      case OP_CONST: w[e.i0] = e.d; break;
+      case OP_INPUT: w[e.i0] = arg[e.i1]==nullptr ? 0 : arg[e.i1][e.i2]; break;
+      case OP_OUTPUT: if (res[e.i0]!=nullptr) res[e.i0][e.i2] = w[e.i1]; break;
+      default:
+        casadi_error("Unknown operation" + str(e.op));
+      }
+      if (sample) m.toc(e.op, t0, profile_sampling_);
+    }
+  }
+
+  int SXFunction::eval_batch(const double** arg, double** res,
+      casadi_int* iw, double* w, void* mem, casadi_int n) const {
+    if (verbose_) casadi_message(name_ + "::eval_batch");
+
+    // Make sure no free parameters
+    if (!free_vars_.empty()) {
+      std::stringstream ss;
+      disp(ss, false);
+      casadi_error("Cannot evaluate \"" + ss.str() + "\" since variables "
+                   + str(free_vars_) + " are free.");
+    }
+
+    // Each work vector element holds the values for all n points, so every
+    // instruction is a loop over the points that the compiler can vectorize
+    for (auto&& e : algorithm_) {
+      switch (e.op) {
+      case OP_CONST:
+        fill_n(w + e.i0*n, n, e.d);
+        break;
+      case OP_INPUT:
+        {
+          double* w0 = w + e.i0*n;
+          if (arg[e.i1]==nullptr) {
+            fill_n(w0, n, 0);
+          } else {
+            const double* a = arg[e.i1] + e.i2;
+            casadi_int stride = nnz_in(e.i1);
+            for (casadi_int k=0; k<n; ++k) w0[k] = a[k*stride];
+          }
+        }
+        break;
+      case OP_OUTPUT:
+        if (res[e.i0]!=nullptr) {
+          const double* w1 = w + e.i1*n;
+          double* r = res[e.i0] + e.i2;
+          casadi_int stride = nnz_out(e.i0);
+          for (casadi_int k=0; k<n; ++k) r[k*stride] = w1[k];
+        }
+        break;
+      default:
+        // sin, cos, exp and log with vectorizable kernels, cf. option "batch_math"
+        if (batch_math_ && vector_math(e.op, w + e.i1*n, w + e.i0*n, n, batch_math_fast_)) break;
+        casadi_math<double>::fun(e.op, w + e.i1*n, w + e.i2*n, w + e.i0*n, n);
+      }
+    }
+    return 0;
+  }
+
+  void SXFunction::eval_fused(const double** arg, double** res, double* w) const {
+    // NOTE: Cf. SXFunction::eval, the loop is performance critical
+    for (auto&& e : fused_) {
+      switch (e.op) {
+        CASADI_MATH_FUN_BUILTIN(w[e.i1], w[e.i2], w[e.i0])
+
+      case OP_CONST: w[e.i0] = e.d; break;
+      case OP_INPUT: w[e.i0] = arg[e.i1]==nullptr ? 0 : arg[e.i1][e.i2]; break;
+      case OP_OUTPUT: if (res[e.i0]!=nullptr) res[e.i0][e.i2] = w[e.i1]; break;
+      case VM_MULADD: w[e.i0] = w[e.i1]*w[e.i2] + w[e.i3]; break;
+      case VM_MULSUB: w[e.i0] = w[e.i1]*w[e.i2] - w[e.i3]; break;
+      case VM_NMULADD: w[e.i0] = w[e.i3] - w[e.i1]*w[e.i2]; break;
+      case VM_ADD_C: w[e.i0] = w[e.i1] + e.d; break;
+      case VM_SUB_C: w[e.i0] = w[e.i1] - e.d; break;
+      case VM_C_SUB: w[e.i0] = e.d - w[e.i1]; break;
+      case VM_MUL_C: w[e.i0] = w[e.i1] * e.d; break;
+      case VM_DIV_C: w[e.i0] = w[e.i1] / e.d; break;
+      case VM_C_DIV: w[e.i0] = e.d / w[e.i1]; break;
+      default:
+        casadi_error("Unknown operation" + str(e.op));
+      }
+    }
+  }
+
+  void SXFunction::fuse_instructions() {
+    // Number of times the value computed by each instruction is read
+    vector<casadi_int> nread(algorithm_.size(), 0);
+    vector<casadi_int> writer(worksize_, -1);
+    for (casadi_int k=0; k<algorithm_.size(); ++k) {
+      const AlgEl& a = algorithm_[k];
+      // Reads, before the write since the locations may coincide
+      switch (a.op) {
+      case OP_CONST:
+      case OP_PARAMETER:
+      case OP_INPUT:
+        break;
+      case OP_OUTPUT:
+        nread[writer[a.i1]]++;
+        break;
+      default:
+        nread[writer[a.i1]]++;
+        if (casadi_math<double>::ndeps(a.op)==2) nread[writer[a.i2]]++;
+      }
+      // Write
+      if (a.op!=OP_OUTPUT) writer[a.i0] = k;
+    }
+
+    // Fuse an instruction with its successor, if the successor is the only reader
+    fused_.clear();
+    fused_.reserve(algorithm_.size());
+    for (casadi_int k=0; k<algorithm_.size(); ++k) {
+      const AlgEl& a = algorithm_[k];
+      FusedAtomic e;
+      e.op = a.op;
+      e.i0 = a.i0;
+      e.i1 = a.i1;
+      e.i2 = a.i2;
+      if (a.op==OP_CONST) e.d = a.d;
+      if (k+1<algorithm_.size() && nread[k]==1 && a.op!=OP_OUTPUT) {
+        const AlgEl& b = algorithm_[k+1];
+        // Location of the intermediate result
+        int t = a.i0;
+        bool first = b.i1==t, second = b.i2==t;
+        int other = first ? b.i2 : b.i1;
+        if (first!=second) {
+          if (a.op==OP_MUL && (b.op==OP_ADD || b.op==OP_SUB)) {
+            // Multiply-add
+            e.op = b.op==OP_ADD ? VM_MULADD : first ? VM_MULSUB : VM_NMULADD;
+            e.i0 = b.i0;
+            e.i3 = other;
+            fused_.push_back(e);
+            k++;
+            continue;
+          } else if (a.op==OP_CONST && (b.op==OP_ADD || b.op==OP_SUB || b.op==OP_MUL
+                                        || b.op==OP_DIV)) {
+            // Operation with a constant
+            switch (b.op) {
+            case OP_ADD: e.op = VM_ADD_C; break;
+            case OP_SUB: e.op = second ? VM_SUB_C : VM_C_SUB; break;
+            case OP_MUL: e.op = VM_MUL_C; break;
+            case OP_DIV: e.op = second ? VM_DIV_C : VM_C_DIV; break;
+            }
+            e.i0 = b.i0;
+            e.i1 = other;
+            fused_.push_back(e);
+            k++;
+            continue;
+          }
+        }
+      }
+      fused_.push_back(e);
+    }
+
+    if (verbose_) {
+      casadi_message("Fused " + str(algorithm_.size()) + " instructions into "
+                     + str(fused_.size()));
+    }
+  }
+
   bool SXFunction::is_smooth() const {
     // Go through all nodes and check if any node is non-smooth
     for (auto&& a : algorithm_) {
@@ -148,34 +346,433 @@ namespace casadi {
     }
   }
 
+  Dict SXFunction::codegen_footprint(const CodeGenerator& g) const {
+    Dict r = XFunction::codegen_footprint(g);
+    // Work variables are local unless the stack is avoided
+    if (!g.avoid_stack()) r["stack_real"] = static_cast<casadi_int>(worksize_);
+    // Elementary operations, excluding inputs, outputs and constants
+    Dict ops;
+    casadi_int n_flop = 0;
+    for (auto&& a : algorithm_) {
+      if (a.op==OP_INPUT || a.op==OP_OUTPUT || a.op==OP_CONST || a.op==OP_PARAMETER) continue;
+      std::string name = casadi_math<double>::name(a.op);
+      ops[name] = (ops.count(name) ? ops[name].as_int() : 0) + 1;
+      n_flop++;
+    }
+    r["n_instructions"] = static_cast<casadi_int>(algorithm_.size());
+    r["flops"] = ops;
+    r["n_flop"] = n_flop;
+    return r;
+  }
+
+  std::vector<std::array<casadi_int, 3> > SXFunction::repeated_sequences() const {
+    // Minimum number of instructions saved by a loop
+    const casadi_int min_saved = 16;
+    // Maximum number of candidate lengths tried per instruction
+    const casadi_int max_candidates = 1024;
+    casadi_int n = algorithm_.size();
+
+    // Instructions match if the operation (and input or output index) match,
+    // the remaining fields may differ between repetitions
+    vector<uint64_t> sig(n);
+    for (casadi_int k=0; k<n; ++k) {
+      const AlgEl& a = algorithm_[k];
+      casadi_int ind = a.op==OP_INPUT ? a.i1 : a.op==OP_OUTPUT ? a.i0 : -1;
+      sig[k] = static_cast<uint64_t>(a.op) + NUM_BUILT_IN_OPS*static_cast<uint64_t>(ind+1);
+    }
+
+    // Polynomial hashes of the prefixes, for comparing sequences in constant time
+    const uint64_t base = 1000003;
+    vector<uint64_t> h(n+1, 0), pw(n+1, 1);
+    for (casadi_int k=0; k<n; ++k) {
+      h[k+1] = h[k]*base + sig[k] + 1;
+      pw[k+1] = pw[k]*base;
+    }
+    auto hash = [&](casadi_int k, casadi_int len) { return h[k+len] - h[k]*pw[len];};
+
+    // Next instruction with the same signature
+    vector<casadi_int> next(n, -1);
+    std::unordered_map<uint64_t, casadi_int> last;
+    for (casadi_int k=n-1; k>=0; --k) {
+      auto it = last.find(sig[k]);
+      if (it!=last.end()) next[k] = it->second;
+      last[sig[k]] = k;
+    }
+
+    // Greedily find the sequence saving the most instructions at each position
+    vector<std::array<casadi_int, 3> > ret;
+    for (casadi_int k=0; k<n; ) {
+      casadi_int best_len = 0, best_rep = 0;
+      casadi_int cand = 0;
+      for (casadi_int k1=next[k]; k1>=0 && 2*(k1-k)<=n-k && cand<max_candidates;
+           k1=next[k1], ++cand) {
+        casadi_int len = k1-k, rep = 1;
+        while (k+(rep+1)*len<=n && hash(k+rep*len, len)==hash(k, len)) rep++;
+        if ((rep-1)*len > (best_rep-1)*best_len) {
+          best_len = len;
+          best_rep = rep;
+        }
+      }
+      // Confirm the match, guarding against hash collisions
+      casadi_int rep = 1;
+      for (; rep<best_rep; ++rep) {
+        if (!std::equal(sig.begin()+k, sig.begin()+k+best_len, sig.begin()+k+rep*best_len)) {
+          break;
+        }
+      }
+      if (rep>=2 && (rep-1)*best_len>=min_saved) {
+        ret.push_back({k, best_len, rep});
+        k += rep*best_len;
+      } else {
+        k++;
+      }
+    }
+    return ret;
+  }
+
   void SXFunction::codegen_body(CodeGenerator& g) const {
+    // Repeated instruction sequences, generated as loops
+    vector<std::array<casadi_int, 3> > loops;
+    if (loop_rolling_) loops = repeated_sequences();
 
-    // Run the algorithm
-    for (auto&& a : algorithm_) {
+    if (loops.empty()) {
+      // Run the algorithm
+      for (auto&& a : algorithm_) {
+        if (a.op==OP_OUTPUT) {
+          g << "if (res[" << a.i0 << "]!=0) "
+            << "res["<< a.i0 << "][" << a.i2 << "]=" << g.sx_work(a.i1);
+        } else {
+
+          // Where to store the result
+          g << g.sx_work(a.i0) << "=";
+
+          // What to store
+          if (a.op==OP_CONST) {
+            g << g.constant(a.d);
+          } else if (a.op==OP_INPUT) {
+            g << "arg[" << a.i1 << "] ? arg[" << a.i1 << "][" << a.i2 << "] : 0";
+          } else {
+            casadi_int ndep = casadi_math<double>::ndeps(a.op);
+            casadi_assert_dev(ndep>0);
+            if (ndep==1) g << g.print_op(a.op, g.sx_work(a.i1));
+            if (ndep==2) g << g.print_op(a.op, g.sx_work(a.i1), g.sx_work(a.i2));
+          }
+        }
+        g  << ";\n";
+      }
+      return;
+    }
+
+    // Work vector elements are indexed in the loops, so the work vector is an array
+    std::string w = "w";
+    if (!g.avoid_stack()) {
+      w = "a";
+      g.local("a[" + str(worksize_) + "]", "casadi_real");
+    }
+
+    // Generate an instruction, with the indices (or the constant) given as expressions
+    auto instruction = [&](const AlgEl& a, const std::string& i0, const std::string& i1,
+                           const std::string& i2, const std::string& d) {
+      std::stringstream ss;
       if (a.op==OP_OUTPUT) {
-        g << "if (res[" << a.i0 << "]!=0) "
-          << "res["<< a.i0 << "][" << a.i2 << "]=" << g.sx_work(a.i1);
+        ss << "if (res[" << a.i0 << "]!=0) res[" << a.i0 << "][" << i2 << "]="
+           << w << "[" << i1 << "]";
       } else {
+        ss << w << "[" << i0 << "]=";
+        if (a.op==OP_CONST) {
+          ss << d;
+        } else if (a.op==OP_INPUT) {
+          ss << "arg[" << a.i1 << "] ? arg[" << a.i1 << "][" << i2 << "] : 0";
+        } else {
+          casadi_int ndep = casadi_math<double>::ndeps(a.op);
+          casadi_assert_dev(ndep>0);
+          if (ndep==1) ss << g.print_op(a.op, w + "[" + i1 + "]");
+          if (ndep==2) ss << g.print_op(a.op, w + "[" + i1 + "]", w + "[" + i2 + "]");
+        }
+      }
+      ss << ";\n";
+      return ss.str();
+    };
+
+    auto loop = loops.begin();
+    for (casadi_int k=0; k<algorithm_.size(); ) {
+      if (loop==loops.end() || k<(*loop)[0]) {
+        // Instruction outside of the loops
+        const AlgEl& a = algorithm_[k++];
+        g << instruction(a, str(a.i0), str(a.i1), str(a.i2),
+                         a.op==OP_CONST ? g.constant(a.d) : "");
+        continue;
+      }
+      casadi_int len = (*loop)[1], rep = (*loop)[2];
+      // Indices not changing by a constant stride, and constants not being constant
+      vector<vector<casadi_int> > ind_t;
+      vector<vector<double> > d_t;
+      // Index of the values of a field for repetition i
+      auto index = [&](const vector<casadi_int>& v) {
+        casadi_int stride = v[1]-v[0];
+        bool affine = true;
+        for (casadi_int r=2; r<rep && affine; ++r) affine = v[r]-v[r-1]==stride;
+        if (!affine) {
+          ind_t.push_back(v);
+          return "cii[" + str(ind_t.size()-1) + "]";
+        } else if (stride==0) {
+          return str(v[0]);
+        } else {
+          return str(v[0]) + (stride>0 ? "+" : "-")
+            + (std::abs(stride)==1 ? "" : str(std::abs(stride)) + "*") + "i";
+        }
+      };
+      // Loop body
+      std::string body;
+      vector<casadi_int> v(rep);
+      for (casadi_int j=0; j<len; ++j) {
+        const AlgEl& a = algorithm_[k+j];
+        std::string i0, i1, i2, d;
+        if (a.op==OP_CONST) {
+          vector<double> c(rep);
+          for (casadi_int r=0; r<rep; ++r) c[r] = algorithm_[k+r*len+j].d;
+          if (std::all_of(c.begin(), c.end(), [&](double e) { return e==c[0];})) {
+            d = g.constant(c[0]);
+          } else {
+            d_t.push_back(c);
+            d = "cr[" + str(d_t.size()-1) + "]";
+          }
+        }
+        if (a.op!=OP_OUTPUT) {
+          for (casadi_int r=0; r<rep; ++r) v[r] = algorithm_[k+r*len+j].i0;
+          i0 = index(v);
+        }
+        if (a.op==OP_OUTPUT || (a.op!=OP_CONST && a.op!=OP_INPUT)) {
+          for (casadi_int r=0; r<rep; ++r) v[r] = algorithm_[k+r*len+j].i1;
+          i1 = index(v);
+        }
+        if (a.op==OP_OUTPUT || a.op==OP_INPUT
+            || (a.op!=OP_CONST && casadi_math<double>::ndeps(a.op)==2)) {
+          for (casadi_int r=0; r<rep; ++r) v[r] = algorithm_[k+r*len+j].i2;
+          i2 = index(v);
+        }
+        body += instruction(a, i0, i1, i2, d);
+      }
+      // Tables, one row per repetition
+      auto row = [](casadi_int n) { return n==1 ? std::string("i") : "i*" + str(n);};
+      g.local("i", "casadi_int");
+      g << "for (i=0; i<" << rep << "; ++i) {\n";
+      if (!ind_t.empty()) {
+        vector<casadi_int> t;
+        t.reserve(rep*ind_t.size());
+        for (casadi_int r=0; r<rep; ++r) {
+          for (auto&& c : ind_t) t.push_back(c[r]);
+        }
+        g.local("cii", "const casadi_int", "*");
+        g << "cii=" << g.constant(t) << "+" << row(ind_t.size()) << ";\n";
+      }
+      if (!d_t.empty()) {
+        vector<double> t;
+        t.reserve(rep*d_t.size());
+        for (casadi_int r=0; r<rep; ++r) {
+          for (auto&& c : d_t) t.push_back(c[r]);
+        }
+        g.local("cr", "const casadi_real", "*");
+        g << "cr=" << g.constant(t) << "+" << row(d_t.size()) << ";\n";
+      }
+      g << body << "}\n";
+      k += rep*len;
+      ++loop;
+    }
+  }
 
-        // Where to store the result
-        g << g.sx_work(a.i0) << "=";
+  void SXFunction::codegen_body_batch(CodeGenerator& g, casadi_int n, const std::string& nb,
+                                      const std::string& arg, const std::string& res,
+                                      const std::string& w) const {
+    // Loop over the points, simple enough for the C compiler to vectorize
+    std::string loop = "for (k=0; k<" + nb + "; ++k) ";
 
-        // What to store
+    // Work vector element i for point k
+    auto wk = [&](casadi_int i) { return w + "[" + str(i*n) + "+k]";};
+
+    // Run the algorithm
+    for (auto&& a : algorithm_) {
+      if (a.op==OP_OUTPUT) {
+        g << "if (" << res << "[" << a.i0 << "]) " << loop
+          << res << "[" << a.i0 << "][" << a.i2 << "+k*" << nnz_out(a.i0) << "]="
+          << wk(a.i1) << ";\n";
+      } else if (a.op==OP_INPUT) {
+        g << "if (" << arg << "[" << a.i1 << "]) {\n"
+          << loop << wk(a.i0) << "=" << arg << "[" << a.i1 << "][" << a.i2 << "+k*"
+          << nnz_in(a.i1) << "];\n"
+          << "} else {\n"
+          << loop << wk(a.i0) << "=0;\n"
+          << "}\n";
+      } else {
+        g << loop << wk(a.i0) << "=";
         if (a.op==OP_CONST) {
           g << g.constant(a.d);
-        } else if (a.op==OP_INPUT) {
-          g << "arg[" << a.i1 << "] ? arg[" << a.i1 << "][" << a.i2 << "] : 0";
         } else {
           casadi_int ndep = casadi_math<double>::ndeps(a.op);
           casadi_assert_dev(ndep>0);
-          if (ndep==1) g << g.print_op(a.op, g.sx_work(a.i1));
-          if (ndep==2) g << g.print_op(a.op, g.sx_work(a.i1), g.sx_work(a.i2));
+          if (ndep==1) g << g.print_op(a.op, wk(a.i1));
+          if (ndep==2) g << g.print_op(a.op, wk(a.i1), wk(a.i2));
+        }
+        g << ";\n";
+      }
+    }
+  }
+
+  /* Depth-first topological sort which visits the argument needing the larger part
+     of the work vector first (Sethi-Ullman ordering), cf. XFunction::sort_depth_first */
+  static void sort_sethi_ullman(stack<SXNode*>& s, vector<SXNode*>& nodes,
+                                const std::unordered_map<const SXNode*, casadi_int>& label) {
+    while (!s.empty()) {
+      SXNode* t = s.top();
+      if (t && t->temp>=0) {
+        casadi_int next_dep = t->temp++;
+        if (next_dep < t->n_dep()) {
+          if (t->n_dep()==2 && label.at(t->dep(1).get()) > label.at(t->dep(0).get())) {
+            next_dep = 1-next_dep;
+          }
+          s.push(t->dep(next_dep).get());
+        } else {
+          nodes.push_back(t);
+          t->temp = -1;
+          s.pop();
         }
+      } else {
+        s.pop();
       }
-      g  << ";\n";
     }
   }
 
+  casadi_int SXFunction::rewrite(const std::string& pass) {
+    // Sort the expression graph
+    stack<SXNode*> s;
+    vector<SXNode*> nodes;
+    casadi_int n_out = 0;
+    for (auto&& o : out_) {
+      for (auto&& e : o.nonzeros()) {
+        s.push(e.get());
+        sort_depth_first(s, nodes);
+      }
+      n_out += o.nnz();
+    }
+    casadi_assert(nodes.size() <= std::numeric_limits<int>::max(), "Integer overflow");
+    for (casadi_int i=0; i<nodes.size(); ++i) nodes[i]->temp = static_cast<int>(i);
+
+    // Number of times each node is used
+    vector<casadi_int> nuse(nodes.size(), 0);
+    for (SXNode* n : nodes) {
+      if (n->is_symbolic() || n->is_constant()) continue;
+      casadi_int ndeps = casadi_math<double>::ndeps(n->op());
+      for (casadi_int c=0; c<ndeps; ++c) nuse[n->dep(c).get()->temp]++;
+    }
+    for (auto&& o : out_) {
+      for (auto&& e : o.nonzeros()) nuse[e.get()->temp]++;
+    }
+
+    // Rewritten nodes, visited in topological order
+    vector<SXElem> r(nodes.size());
+    for (casadi_int i=0; i<nodes.size(); ++i) {
+      SXNode* n = nodes[i];
+      if (n->is_symbolic() || n->is_constant()) {
+        r[i] = SXElem::create(n);
+        continue;
+      }
+      casadi_int op = n->op();
+      bool unary = casadi_math<double>::ndeps(op)==1;
+      casadi_int i1 = n->dep(0).get()->temp, i2 = unary ? i1 : n->dep(1).get()->temp;
+      const SXElem& x = r[i1];
+      const SXElem& y = r[i2];
+      SXElem& f = r[i];
+      bool done = false;
+      if (pass=="strength") {
+        if ((op==OP_POW || op==OP_CONSTPOW) && y.is_constant()) {
+          // Small integer and half-integer exponents
+          double p = static_cast<double>(y);
+          done = true;
+          if (p==0) {
+            f = 1;
+          } else if (p==1) {
+            f = x;
+          } else if (p==2) {
+            f = sq(x);
+          } else if (p==3) {
+            f = x*sq(x);
+          } else if (p==4) {
+            f = sq(sq(x));
+          } else if (p==-1) {
+            f = 1/x;
+          } else if (p==-2) {
+            f = 1/sq(x);
+          } else if (p==0.5) {
+            f = sqrt(x);
+          } else if (p==-0.5) {
+            f = 1/sqrt(x);
+          } else {
+            done = false;
+          }
+        } else if (op==OP_DIV && y.is_constant()) {
+          // Division by a power of two is a multiplication by its exact inverse
+          int e;
+          double c = static_cast<double>(y);
+          if (c!=0 && std::fabs(std::frexp(c, &e))==0.5) {
+            f = (1/c)*x;
+            done = true;
+          }
+        } else if (op==OP_MUL && SXElem::is_equal(x, y, SXNode::eq_depth_)) {
+          f = sq(x);
+          done = true;
+        }
+      } else if (pass=="reassociate") {
+        if (op==OP_MUL && x.is_constant() && y.is_op(OP_MUL) && y.dep(0).is_constant()) {
+          // c1*(c2*z) -> (c1*c2)*z
+          f = (static_cast<double>(x)*static_cast<double>(y.dep(0)))*y.dep(1);
+          done = true;
+        } else if ((op==OP_ADD || op==OP_SUB) && !x.is_constant() && !y.is_constant()) {
+          // Write the terms as coefficient times base
+          double cx = 1, cy = 1;
+          SXElem bx = x, by = y;
+          if (x.is_op(OP_MUL) && x.dep(0).is_constant()) {
+            cx = static_cast<double>(x.dep(0));
+            bx = x.dep(1);
+          } else if (x.is_op(OP_NEG)) {
+            cx = -1;
+            bx = x.dep(0);
+          }
+          if (y.is_op(OP_MUL) && y.dep(0).is_constant()) {
+            cy = static_cast<double>(y.dep(0));
+            by = y.dep(1);
+          } else if (y.is_op(OP_NEG)) {
+            cy = -1;
+            by = y.dep(0);
+          }
+          if (SXElem::is_equal(bx, by, SXNode::eq_depth_)) {
+            // c1*z + c2*z -> (c1+c2)*z
+            f = (op==OP_ADD ? cx+cy : cx-cy)*bx;
+            done = true;
+          } else if (x.is_op(OP_MUL) && y.is_op(OP_MUL) && nuse[i1]==1 && nuse[i2]==1) {
+            // a*b + a*c -> a*(b+c), only if the products are not used elsewhere
+            for (casadi_int j1=0; j1<2 && !done; ++j1) {
+              for (casadi_int j2=0; j2<2 && !done; ++j2) {
+                if (SXElem::is_equal(x.dep(j1), y.dep(j2), SXNode::eq_depth_)) {
+                  f = x.dep(j1)*SXElem::binary(op, x.dep(1-j1), y.dep(1-j2));
+                  done = true;
+                }
+              }
+            }
+          }
+        }
+      }
+      // Recreate the node, applying constant folding and local simplifications
+      if (!done) f = unary ? SXElem::unary(op, x) : SXElem::binary(op, x, y);
+    }
+
+    // Replace the expressions
+    for (auto&& o : out_) {
+      for (auto&& e : o.nonzeros()) e = r[e.get()->temp];
+    }
+    for (SXNode* n : nodes) n->temp = 0;
+    return nodes.size() + n_out;
+  }
+
   Options SXFunction::options_
   = {{&FunctionInternal::options_},
      {{"default_in",
@@ -190,7 +787,77 @@ namespace casadi {
         "Just-in-time compilation for numeric evaluation using OpenCL (experimental)"}},
       {"live_variables",
        {OT_BOOL,
-        "Reuse variables in the work vector"}}
+        "Reuse variables in the work vector"}},
+      {"fuse_instructions",
+       {OT_BOOL,
+        "Fuse common instruction sequences (multiply-add, operations with a "
+        "constant) into superinstructions for numerical evaluation. "
+        "Reduces the number of dispatches and work vector accesses."}},
+      {"sp_width",
+       {OT_INT,
+        "Number of bvec_t words propagated per nonzero when detecting Jacobian "
+        "sparsity patterns. A value n>1 propagates n*64 seed directions per sweep, "
+        "using an inner loop that the compiler can vectorize (e.g. 4 for AVX2, "
+        "8 for AVX-512). Comes at the cost of an n times larger work vector during "
+        "pattern detection. Disables the hierarchical sparsity detection. [default: 1]"}},
+      {"cse",
+       {OT_BOOL,
+        "Merge structurally equal subexpressions before allocating the work vector. "
+        "The number of removed instructions is reported in the statistics "
+        "[default: false]"}},
+      {"optimize",
+       {OT_STRINGVECTOR,
+        "Optimization passes applied to the expression graph, in order: "
+        "'simplify' (constant folding and local simplifications), "
+        "'strength' (strength reduction of powers and divisions), "
+        "'reassociate' (merging of constant factors and common factors, "
+        "may change rounding). Unused nodes are always removed. "
+        "The number of instructions before the passes is reported in the statistics"}},
+      {"schedule",
+       {OT_STRING,
+        "Order of the instructions: 'depth_first' visits the arguments in order, "
+        "'sethi_ullman' visits the argument needing the most work vector elements first, "
+        "which reduces the work vector size with live variables. "
+        "The work vector size is reported in the statistics [default: depth_first]"}},
+      {"checkpointing",
+       {OT_BOOL,
+        "Calculate adjoint derivatives numerically, recording only the partial "
+        "derivatives of a part of the algorithm at a time and recomputing the rest from "
+        "snapshots of the work vector (binomial checkpointing). Reduces the memory "
+        "needed by very long algorithms. The resulting derivative functions can only "
+        "be evaluated numerically [default: false]"}},
+      {"checkpoint_memory",
+       {OT_INT,
+        "Memory budget in bytes for the partial derivatives and snapshots "
+        "with checkpointing [default: 64 MiB]"}},
+      {"vector_forward",
+       {OT_BOOL,
+        "Calculate forward derivatives numerically, propagating all directions "
+        "through each instruction at once. Jacobians are then calculated with "
+        "(colored) directional derivatives instead of symbolically. The resulting "
+        "derivative functions can only be evaluated numerically [default: false]"}},
+      {"profile_instructions",
+       {OT_BOOL,
+        "Count the executed instructions per operation during numerical evaluation, "
+        "disabling the fused instructions. The counts are reported in the statistics "
+        "and by print_instruction_profile [default: false]"}},
+      {"profile_sampling",
+       {OT_INT,
+        "With profile_instructions, time every n-th executed instruction and "
+        "estimate the time spent per operation. 0 only counts [default: 0]"}},
+      {"loop_rolling",
+       {OT_BOOL,
+        "Generate code with loops for repeated instruction sequences, e.g. from "
+        "an expanded map. Indices that do not change by a constant stride between "
+        "repetitions are read from tables. Reduces the size of the generated code "
+        "[default: false]"}},
+      {"batch_math",
+       {OT_STRING,
+        "Evaluation of sin, cos, exp and log in batched evaluation (e.g. a serial map "
+        "with batch_size>1): 'libm' calls the C math library for every value, "
+        "'vector' uses polynomial kernels that the compiler vectorizes, with a "
+        "relative error below 2 ulp, 'vector_fast' uses shorter polynomials with a "
+        "relative error below 5e-9 [default: vector]"}}
      }
   };
 
@@ -201,6 +868,10 @@ namespace casadi {
 
     // Default (temporary) options
     bool live_variables = true;
+    bool fuse = false;
+    bool cse = false;
+    std::vector<std::string> optimize;
+    std::string schedule = "depth_first";
 
     // Read options
     for (auto&& op : opts) {
@@ -212,8 +883,38 @@ namespace casadi {
         just_in_time_opencl_ = op.second;
       } else if (op.first=="just_in_time_sparsity") {
         just_in_time_sparsity_ = op.second;
+      } else if (op.first=="fuse_instructions") {
+        fuse = op.second;
+      } else if (op.first=="sp_width") {
+        sp_width_ = op.second;
+      } else if (op.first=="cse") {
+        cse = op.second;
+      } else if (op.first=="optimize") {
+        optimize = op.second;
+      } else if (op.first=="schedule") {
+        schedule = op.second.to_string();
+      } else if (op.first=="checkpointing") {
+        checkpointing_ = op.second;
+      } else if (op.first=="checkpoint_memory") {
+        checkpoint_memory_ = op.second;
+      } else if (op.first=="vector_forward") {
+        vector_forward_ = op.second;
+      } else if (op.first=="profile_instructions") {
+        profile_instructions_ = op.second;
+      } else if (op.first=="profile_sampling") {
+        profile_sampling_ = op.second;
+      } else if (op.first=="loop_rolling") {
+        loop_rolling_ = op.second;
+      } else if (op.first=="batch_math") {
+        std::string batch_math = op.second;
+        casadi_assert(batch_math=="libm" || batch_math=="vector" || batch_math=="vector_fast",
+                      "Option 'batch_math' must be 'libm', 'vector' or 'vector_fast'");
+        batch_math_ = batch_math!="libm";
+        batch_math_fast_ = batch_math=="vector_fast";
       }
     }
+    casadi_assert(profile_sampling_>=0, "Option 'profile_sampling' must be nonnegative");
+    casadi_assert(sp_width_>=1, "Option 'sp_width' must be positive");
 
     // Check/set default inputs
     if (default_in_.empty()) {
@@ -223,12 +924,46 @@ namespace casadi {
                             "Option 'default_in' has incorrect length");
     }
 
+    // Optimization passes
+    n_instructions_initial_ = -1;
+    for (auto&& pass : optimize) {
+      casadi_assert(pass=="simplify" || pass=="strength" || pass=="reassociate",
+                    "Unknown optimization pass '" + pass + "'");
+      casadi_int n = rewrite(pass);
+      if (n_instructions_initial_<0) n_instructions_initial_ = n;
+    }
+
     // Stack used to sort the computational graph
     stack<SXNode*> s;
 
     // All nodes
     vector<SXNode*> nodes;
 
+    // Number of work vector elements needed to evaluate each node (Sethi-Ullman labels)
+    std::unordered_map<const SXNode*, casadi_int> label;
+    if (schedule=="sethi_ullman") {
+      for (auto&& o : out_) {
+        for (auto&& e : o.nonzeros()) {
+          s.push(e.get());
+          sort_depth_first(s, nodes);
+        }
+      }
+      for (SXNode* t : nodes) {
+        casadi_int l = 1;
+        if (t->n_dep()==1) {
+          l = label.at(t->dep(0).get());
+        } else if (t->n_dep()==2) {
+          casadi_int l0 = label.at(t->dep(0).get()), l1 = label.at(t->dep(1).get());
+          l = l0==l1 ? l0+1 : max(l0, l1);
+        }
+        label[t] = l;
+        t->temp = 0;
+      }
+      nodes.clear();
+    } else {
+      casadi_assert(schedule=="depth_first", "Unknown schedule '" + schedule + "'");
+    }
+
     // Add the list of nodes
     casadi_int ind=0;
     for (auto it = out_.begin(); it != out_.end(); ++it, ++ind) {
@@ -236,7 +971,11 @@ namespace casadi {
       for (auto itc = (*it)->begin(); itc != (*it)->end(); ++itc, ++nz) {
         // Add outputs to the list
         s.push(itc->get());
-        sort_depth_first(s, nodes);
+        if (label.empty()) {
+          sort_depth_first(s, nodes);
+        } else {
+          sort_sethi_ullman(s, nodes, label);
+        }
 
         // A null pointer means an output instruction
         nodes.push_back(static_cast<SXNode*>(nullptr));
@@ -251,6 +990,75 @@ namespace casadi {
       }
     }
 
+    // Nodes removed by common subexpression elimination
+    vector<SXNode*> removed;
+
+    // Merge structurally equal nodes, visited in topological order
+    n_cse_removed_ = -1;
+    if (cse) {
+      // Operation, arguments (or value if constant) of a node
+      struct CseKey {
+        casadi_int op;
+        int a1, a2;
+        uint64_t bits;
+        bool operator==(const CseKey& k) const {
+          return op==k.op && a1==k.a1 && a2==k.a2 && bits==k.bits;
+        }
+      };
+      // Candidates for each hash value
+      std::unordered_map<size_t, vector<pair<CseKey, int> > > seen;
+      vector<bool> duplicate(nodes.size(), false);
+      for (casadi_int i=0; i<nodes.size(); ++i) {
+        SXNode* t = nodes[i];
+        if (t==nullptr || t->is_symbolic()) continue;
+        CseKey k = {t->op(), -1, -1, 0};
+        if (t->is_constant()) {
+          double v = t->to_double();
+          memcpy(&k.bits, &v, sizeof(v));
+        } else {
+          // Arguments have been merged already
+          k.a1 = t->dep(0).get()->temp;
+          if (casadi_math<double>::ndeps(k.op)==2) {
+            k.a2 = t->dep(1).get()->temp;
+            if (operation_checker<CommChecker>(k.op) && k.a2<k.a1) swap(k.a1, k.a2);
+          }
+        }
+        size_t h = 0;
+        hash_combine(h, k.op);
+        hash_combine(h, k.a1);
+        hash_combine(h, k.a2);
+        hash_combine(h, k.bits);
+        vector<pair<CseKey, int> >& bucket = seen[h];
+        for (auto&& c : bucket) {
+          if (c.first==k) {
+            // Duplicate, point to the node encountered first
+            t->temp = c.second;
+            duplicate[i] = true;
+            removed.push_back(t);
+            break;
+          }
+        }
+        if (!duplicate[i]) bucket.push_back(make_pair(k, t->temp));
+      }
+
+      // Remove the duplicates from the list of nodes
+      vector<int> new_place(nodes.size(), -1);
+      casadi_int n_kept = 0;
+      for (casadi_int i=0; i<nodes.size(); ++i) {
+        if (duplicate[i]) continue;
+        new_place[i] = static_cast<int>(n_kept);
+        nodes[n_kept++] = nodes[i];
+      }
+      nodes.resize(n_kept);
+      for (SXNode* t : nodes) if (t) t->temp = new_place[t->temp];
+      for (SXNode* t : removed) t->temp = new_place[t->temp];
+      n_cse_removed_ = removed.size();
+      if (verbose_) {
+        casadi_message("Common subexpression elimination removed "
+                       + str(n_cse_removed_) + " instructions");
+      }
+    }
+
     // Sort the nodes by type
     constants_.clear();
     operations_.clear();
@@ -409,6 +1217,7 @@ namespace casadi {
         nodes[i]->temp = 0;
       }
     }
+    for (SXNode* t : removed) t->temp = 0;
 
     // Now mark each input's place in the algorithm
     for (auto it=symb_loc.begin(); it!=symb_loc.end(); ++it) {
@@ -448,18 +1257,63 @@ namespace casadi {
       }
     }
 
-    // Initialize just-in-time compilation for numeric evaluation using OpenCL
+    // Just-in-time compilation of a single evaluation: evaluate many instances instead
     if (just_in_time_opencl_) {
-      casadi_error("OpenCL is not supported in this version of CasADi");
+      casadi_error("Just-in-time compilation of a single evaluation is not supported. "
+                   "Use map(n, 'opencl') to evaluate many instances on an OpenCL device.");
     }
 
     // Initialize just-in-time compilation for sparsity propagation using OpenCL
     if (just_in_time_sparsity_) {
-      casadi_error("OpenCL is not supported in this version of CasADi");
+      casadi_error("OpenCL is not supported for sparsity propagation");
     }
 
+    // Fuse instructions for numerical evaluation
+    if (fuse && !profile_instructions_) fuse_instructions();
+
     // Print
-    if (verbose_) casadi_message(str(algorithm_.size()) + " elementary operations");
+    if (verbose_) {
+      if (n_instructions_initial_>=0) {
+        casadi_message("Optimization passes: " + str(n_instructions_initial_)
+                       + " -> " + str(algorithm_.size()) + " instructions");
+      }
+      casadi_message(str(algorithm_.size()) + " elementary operations");
+    }
+  }
+
+  Dict SXFunction::get_stats(void* mem) const {
+    Dict stats = XFunction::get_stats(mem);
+    stats["worksize"] = static_cast<casadi_int>(worksize_);
+    if (n_cse_removed_>=0) stats["n_cse_removed"] = n_cse_removed_;
+    if (n_instructions_initial_>=0) {
+      stats["n_instructions_initial"] = n_instructions_initial_;
+      stats["n_instructions"] = static_cast<casadi_int>(algorithm_.size());
+    }
+    if (mem) {
+      // Executed operations, cf. option "profile_instructions"
+      const InstructionProfile& m = *static_cast<InstructionProfile*>(mem);
+      std::vector<std::string> op;
+      std::vector<casadi_int> n_call;
+      std::vector<double> t_wall;
+      for (casadi_int k=0; k<m.n_call.size(); ++k) {
+        if (m.n_call[k]==0) continue;
+        op.push_back(casadi_math<double>::name(k));
+        n_call.push_back(m.n_call[k]);
+        t_wall.push_back(m.t_wall[k]);
+      }
+      Dict instructions = {{"op", op}, {"n_call", n_call}};
+      if (profile_sampling_>0) instructions["t_wall"] = t_wall;
+      stats["instructions"] = instructions;
+    }
+    return stats;
+  }
+
+  void SXFunction::memory_usage(std::map<std::string, casadi_int>& usage,
+                                std::set<const void*>& visited) const {
+    XFunction::memory_usage(usage, visited);
+    usage["algorithm"] += memory_bytes(algorithm_) + memory_bytes(fused_)
+      + memory_bytes(operations_) + memory_bytes(constants_) + memory_bytes(free_vars_)
+      + memory_bytes(default_in_);
   }
 
   int SXFunction::
@@ -778,12 +1632,114 @@ namespace casadi {
     return 0;
   }
 
+  int SXFunction::sp_forward_wide(const bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w,
+                                  void* mem, casadi_int nw) const {
+    // Propagate sparsity forward
+    for (auto&& e : algorithm_) {
+      bvec_t* w0 = w + e.i0*nw;
+      switch (e.op) {
+      case OP_CONST:
+      case OP_PARAMETER:
+        fill_n(w0, nw, 0); break;
+      case OP_INPUT:
+        if (arg[e.i1]==nullptr) {
+          fill_n(w0, nw, 0);
+        } else {
+          copy_n(arg[e.i1] + e.i2*nw, nw, w0);
+        }
+        break;
+      case OP_OUTPUT:
+        if (res[e.i0]!=nullptr) copy_n(w + e.i1*nw, nw, res[e.i0] + e.i2*nw);
+        break;
+      default: // Unary or binary operation
+        {
+          const bvec_t *w1 = w + e.i1*nw, *w2 = w + e.i2*nw;
+          for (casadi_int k=0; k<nw; ++k) w0[k] = w1[k] | w2[k];
+        }
+      }
+    }
+    return 0;
+  }
+
+  int SXFunction::sp_reverse_wide(bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w,
+                                  void* mem, casadi_int nw) const {
+    fill_n(w, sz_w()*nw, 0);
+
+    // Propagate sparsity backward
+    for (auto it=algorithm_.rbegin(); it!=algorithm_.rend(); ++it) {
+      bvec_t* w0 = w + it->i0*nw;
+      switch (it->op) {
+      case OP_CONST:
+      case OP_PARAMETER:
+        fill_n(w0, nw, 0);
+        break;
+      case OP_INPUT:
+        if (arg[it->i1]!=nullptr) {
+          bvec_t* a = arg[it->i1] + it->i2*nw;
+          for (casadi_int k=0; k<nw; ++k) a[k] |= w0[k];
+        }
+        fill_n(w0, nw, 0);
+        break;
+      case OP_OUTPUT:
+        if (res[it->i0]!=nullptr) {
+          bvec_t *r = res[it->i0] + it->i2*nw, *w1 = w + it->i1*nw;
+          for (casadi_int k=0; k<nw; ++k) w1[k] |= r[k];
+          fill_n(r, nw, 0);
+        }
+        break;
+      default: // Unary or binary operation
+        {
+          bvec_t *w1 = w + it->i1*nw, *w2 = w + it->i2*nw;
+          for (casadi_int k=0; k<nw; ++k) {
+            bvec_t seed = w0[k];
+            w0[k] = 0;
+            w1[k] |= seed;
+            w2[k] |= seed;
+          }
+        }
+      }
+    }
+    return 0;
+  }
+
+  Function SXFunction::get_forward(casadi_int nfwd, const std::string& name,
+                                   const std::vector<std::string>& inames,
+                                   const std::vector<std::string>& onames,
+                                   const Dict& opts) const {
+    if (!vector_forward_) {
+      return XFunction<SXFunction, SX, SXNode>::get_forward(nfwd, name, inames, onames, opts);
+    }
+    return Function::create(new SXForward(name, nfwd), opts);
+  }
+
+  Function SXFunction::get_reverse(casadi_int nadj, const std::string& name,
+                                   const std::vector<std::string>& inames,
+                                   const std::vector<std::string>& onames,
+                                   const Dict& opts) const {
+    if (!checkpointing_) {
+      return XFunction<SXFunction, SX, SXNode>::get_reverse(nadj, name, inames, onames, opts);
+    }
+    Dict rev_opts = opts;
+    rev_opts["checkpoint_memory"] = checkpoint_memory_;
+    return Function::create(new SXReverse(name, nadj), rev_opts);
+  }
+
+  Function SXFunction::get_hessvec(const std::string& name,
+                                   const std::vector<std::string>& inames,
+                                   const std::vector<std::string>& onames,
+                                   const Dict& opts) const {
+    return Function::create(new SXHessVec(name), opts);
+  }
+
   Function SXFunction::get_jacobian(const std::string& name,
                                        const std::vector<std::string>& inames,
                                        const std::vector<std::string>& onames,
                                        const Dict& opts) const {
     // Jacobian expression
-    SX J = SX::jacobian(veccat(out_), veccat(in_));
+    SX J = SX::jacobian(veccat(out_), veccat(in_),
+                        {{"coloring_num_threads", coloring_num_threads_},
+                         {"ad_weight_timing", ad_weight_timing_},
+                         {"sparsity_cache", sparsity_cache_}});
 
     // All inputs of the return function
     std::vector<SX> ret_in(inames.size());
@@ -945,6 +1901,189 @@ namespace casadi {
     ss.flags(fmtfl);
   }
 
+  void SXFunction::serialize_binary(BinarySerializer& s) const {
+    casadi_assert(free_vars_.empty(), "Cannot serialize SXFunction with free parameters.");
+    static_assert(sizeof(AlgEl)==16, "Unexpected layout of ScalarAtomic");
+    s.pack(casadi_int('S'));
+    s.pack_header(*this);
+    s.pack(static_cast<casadi_int>(worksize_));
+    s.pack(static_cast<casadi_int>(algorithm_.size()));
+    s.pack_raw(algorithm_.data(), algorithm_.size()*sizeof(AlgEl));
+  }
+
+  Function SXFunction::deserialize_binary(BinaryDeserializer& s) {
+    BinaryDeserializer::Header h = s.unpack_header();
+    casadi_int sz_w = s.unpack_int();
+    casadi_int n = s.unpack_int();
+    casadi_assert(sz_w>=0 && n>=0, "Corrupt binary file");
+    const AlgEl* alg = s.unpack_array<AlgEl>(n);
+
+    // Symbolic inputs and outputs
+    std::vector<SX> arg, res;
+    for (const Sparsity& e : h.sp_in) arg.push_back(SX::sym("x", e));
+    for (const Sparsity& e : h.sp_out) res.push_back(SX::zeros(e));
+
+    // Replay the algorithm, with all indices checked
+    std::vector<SXElem> w(sz_w);
+    auto chk = [](casadi_int i, casadi_int n) {
+      casadi_assert(i>=0 && i<n, "Corrupt binary file");
+      return i;
+    };
+    for (casadi_int k=0; k<n; ++k) {
+      const AlgEl& e = alg[k];
+      switch (e.op) {
+        case OP_INPUT:
+          {
+            const SX& a = arg.at(chk(e.i1, arg.size()));
+            w[chk(e.i0, sz_w)] = a.nonzeros()[chk(e.i2, a.nnz())];
+          }
+          break;
+        case OP_OUTPUT:
+          {
+            SX& r = res.at(chk(e.i0, res.size()));
+            r.nonzeros()[chk(e.i2, r.nnz())] = w[chk(e.i1, sz_w)];
+          }
+          break;
+        case OP_CONST:
+          w[chk(e.i0, sz_w)] = e.d;
+          break;
+        default:
+          casadi_assert(e.op>=0 && e.op<NUM_BUILT_IN_OPS, "Corrupt binary file");
+          switch (casadi_math<double>::ndeps(e.op)) {
+            case 1:
+              w[chk(e.i0, sz_w)] = SXElem::unary(e.op, w[chk(e.i1, sz_w)]);
+              break;
+            case 2:
+              w[chk(e.i0, sz_w)] = SXElem::binary(e.op, w[chk(e.i1, sz_w)],
+                                                  w[chk(e.i2, sz_w)]);
+              break;
+            default:
+              casadi_error("Not implemented: " + str(e.op));
+          }
+      }
+    }
+
+    return Function(h.name, arg, res, h.name_in, h.name_out, h.options());
+  }
+
+  void SXFunction::export_code(const std::string& lang,
+      std::ostream &ss, const Dict& options) const {
+    if (lang=="opencl" || lang=="cuda") return export_kernel(lang, ss, options);
+    XFunction<SXFunction, Matrix<SXElem>, SXNode>::export_code(lang, ss, options);
+  }
+
+  void SXFunction::export_kernel(const std::string& lang,
+      std::ostream &ss, const Dict& options) const {
+    casadi_assert(!has_free(), "export_code needs a Function without free variables");
+    bool opencl = lang=="opencl";
+
+    // Default values for options
+    std::string real = "double", kernel_name = name_;
+    bool coalesced = false;
+
+    // Read options
+    for (auto&& op : options) {
+      if (op.first=="real") {
+        real = op.second.to_string();
+      } else if (op.first=="kernel_name") {
+        kernel_name = op.second.to_string();
+      } else if (op.first=="coalesced") {
+        coalesced = op.second;
+      } else {
+        casadi_error("Unknown option '" + op.first + "'.");
+      }
+    }
+    casadi_assert(real=="double" || real=="float",
+                  "Option 'real' must be 'double' or 'float'");
+    std::string gl = opencl ? "__global " : "";
+
+    // Signature
+    if (opencl) {
+      if (real=="double") ss << "#pragma OPENCL EXTENSION cl_khr_fp64 : enable\n";
+      ss << "__kernel void " << kernel_name << "(const long n";
+    } else {
+      ss << "extern \"C\" __global__ void " << kernel_name << "(const long long n";
+    }
+    for (casadi_int i=0; i<n_in_; ++i) {
+      ss << ", " << gl << "const " << real << "* x" << i;
+    }
+    for (casadi_int i=0; i<n_out_; ++i) {
+      ss << ", " << gl << real << "* r" << i;
+    }
+    ss << ") {\n";
+
+    // Instance evaluated by this work item
+    if (opencl) {
+      ss << "  const long i = get_global_id(0);\n";
+    } else {
+      ss << "  const long long i = blockIdx.x*(long long)blockDim.x + threadIdx.x;\n";
+    }
+    if (worksize_>0) {
+      for (casadi_int k=0; k<worksize_; ++k) {
+        ss << (k % 16 == 0 ? (k==0 ? "  " : ";\n  ") + real + " " : ", ") << "w" << k;
+      }
+      ss << ";\n";
+    }
+    ss << "  if (i>=n) return;\n";
+
+    // Location of nonzero k of an input or output
+    auto index = [&](casadi_int k, casadi_int nnz) {
+      return coalesced ? str(k) + "*n+i" : "i*" + str(nnz) + "+" + str(k);
+    };
+
+    // Print constants exactly, without promoting single precision expressions
+    auto constant = [&](double d) {
+      std::stringstream c;
+      if (real=="float") {
+        c << std::scientific << std::setprecision(8) << d << "f";
+      } else {
+        c << std::scientific << std::setprecision(std::numeric_limits<double>::digits10 + 1) << d;
+      }
+      return c.str();
+    };
+
+    for (auto&& a : algorithm_) {
+      std::string x = "w" + str(a.i1), y = "w" + str(a.i2);
+      switch (a.op) {
+        case OP_INPUT:
+          ss << "  w" << a.i0 << " = x" << a.i1 << " ? x" << a.i1 << "["
+             << index(a.i2, nnz_in(a.i1)) << "] : 0;\n";
+          continue;
+        case OP_OUTPUT:
+          ss << "  if (r" << a.i0 << ") r" << a.i0 << "[" << index(a.i2, nnz_out(a.i0))
+             << "] = w" << a.i1 << ";\n";
+          continue;
+        case OP_CONST:
+          ss << "  w" << a.i0 << " = " << constant(a.d) << ";\n";
+          continue;
+        default:
+          break;
+      }
+      ss << "  w" << a.i0 << " = ";
+      switch (a.op) {
+        case OP_SQ: ss << "(" << x << "*" << x << ")"; break;
+        case OP_TWICE: ss << "(2*" << x << ")"; break;
+        case OP_INV: ss << "(1/" << x << ")"; break;
+        case OP_SIGN: ss << "(" << x << "<0 ? -1 : " << x << ">0 ? 1 : " << x << ")"; break;
+        case OP_LIFT: ss << x; break;
+        case OP_ERFINV:
+          casadi_assert(!opencl, "'erfinv' is not available in OpenCL");
+          ss << "erfinv(" << x << ")";
+          break;
+        case OP_PRINTME:
+          casadi_error("'printme' cannot be exported to a kernel");
+        default:
+          if (casadi_math<double>::ndeps(a.op)==2) {
+            ss << casadi_math<double>::print(a.op, x, y);
+          } else {
+            ss << casadi_math<double>::print(a.op, x);
+          }
+      }
+      ss << ";\n";
+    }
+    ss << "}\n";
+  }
+
   void SXFunction::export_code_body(const std::string& lang,
       std::ostream &ss, const Dict& options) const {
 
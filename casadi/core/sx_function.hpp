@@ -27,6 +27,7 @@
 #define CASADI_SX_FUNCTION_HPP
 
 #include "x_function.hpp"
+#include <array>
 
 /// \cond INTERNAL
 
@@ -41,6 +42,16 @@ namespace casadi {
     };
   };
 
+  /** \brief  An element of the fused algorithm, cf. SXFunction option "fuse_instructions" */
+  struct FusedAtomic {
+    int op;     /// Operator index or superinstruction
+    int i0, i1, i2;
+    union {
+      double d;
+      int i3;
+    };
+  };
+
 /** \brief  Internal node class for SXFunction
     Do not use any internal class directly - always use the public Function
     \author Joel Andersson
@@ -62,6 +73,12 @@ class CASADI_EXPORT SXFunction :
   /** \brief  Evaluate numerically, work vectors given */
   int eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const override;
 
+  /** \brief  Evaluate numerically, recording the executed operations */
+  void eval_profile(const double** arg, double** res, double* w, InstructionProfile& m) const;
+
+  /** \brief Number of entries in the instruction profile: one per operation */
+  casadi_int n_profile() const { return NUM_BUILT_IN_OPS;}
+
   /** \brief  evaluate symbolically while also propagating directional derivatives */
   int eval_sx(const SXElem** arg, SXElem** res,
               casadi_int* iw, SXElem* w, void* mem) const override;
@@ -120,6 +137,9 @@ class CASADI_EXPORT SXFunction :
   /** \brief Get the number of atomic operations */
   casadi_int n_instructions() const override { return algorithm_.size();}
 
+  /** \brief Estimated number of atomic operations after expansion to SX */
+  double n_instructions_sx() const override { return algorithm_.size();}
+
   /** \brief Get an atomic operation operator index */
   casadi_int instruction_id(casadi_int k) const override { return algorithm_.at(k).op;}
 
@@ -167,6 +187,27 @@ class CASADI_EXPORT SXFunction :
   /** \brief  all binary nodes of the tree in the order of execution */
   std::vector<AlgEl> algorithm_;
 
+  /** \brief Superinstructions, beyond the built-in operations */
+  enum FusedOp {
+    // w[i0] = w[i1]*w[i2] + w[i3], w[i1]*w[i2] - w[i3], w[i3] - w[i1]*w[i2]
+    VM_MULADD = NUM_BUILT_IN_OPS, VM_MULSUB, VM_NMULADD,
+    // w[i0] = w[i1] OP d and w[i0] = d OP w[i1]
+    VM_ADD_C, VM_SUB_C, VM_C_SUB, VM_MUL_C, VM_DIV_C, VM_C_DIV
+  };
+
+  /** \brief Algorithm with common instruction sequences fused, empty if not used */
+  std::vector<FusedAtomic> fused_;
+
+  /** \brief Fuse instruction sequences of algorithm_ into fused_ */
+  void fuse_instructions();
+
+  /** \brief Evaluate numerically using the fused algorithm */
+  void eval_fused(const double** arg, double** res, double* w) const;
+
+  /** \brief Rewrite the output expressions with an optimization pass
+      Returns the number of instructions before the rewrite, cf. option "optimize" */
+  casadi_int rewrite(const std::string& pass);
+
   // Work vector size
   size_t worksize_;
 
@@ -188,6 +229,13 @@ class CASADI_EXPORT SXFunction :
   const Options& get_options() const override { return options_;}
   ///@}
 
+  /// Get all statistics
+  Dict get_stats(void* mem) const override;
+
+  /** \brief Add the estimated heap memory, including the algorithm */
+  void memory_usage(std::map<std::string, casadi_int>& usage,
+                    std::set<const void*>& visited) const override;
+
   /** \brief  Initialize */
   void init(const Dict& opts) override;
 
@@ -197,6 +245,9 @@ class CASADI_EXPORT SXFunction :
   /** \brief Generate code for the body of the C function */
   void codegen_body(CodeGenerator& g) const override;
 
+  /** \brief Worst-case footprint of the generated code */
+  Dict codegen_footprint(const CodeGenerator& g) const override;
+
   /** \brief  Propagate sparsity forward */
   int sp_forward(const bvec_t** arg, bvec_t** res,
                   casadi_int* iw, bvec_t* w, void* mem) const override;
@@ -204,6 +255,55 @@ class CASADI_EXPORT SXFunction :
   /** \brief  Propagate sparsity backwards */
   int sp_reverse(bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w, void* mem) const override;
 
+  /** \brief Is batched numerical evaluation supported? */
+  bool has_eval_batch() const override { return true;}
+
+  /** \brief Evaluate numerically for n points at once, one instruction at a time */
+  int eval_batch(const double** arg, double** res, casadi_int* iw, double* w,
+                 void* mem, casadi_int n) const override;
+
+  /** \brief Generate code for batched evaluation, one loop over the points per instruction */
+  void codegen_body_batch(CodeGenerator& g, casadi_int n, const std::string& nb,
+                          const std::string& arg, const std::string& res,
+                          const std::string& w) const override;
+
+  /** \brief Number of bvec_t words per nonzero in wide sparsity propagation */
+  casadi_int sp_width() const override { return sp_width_;}
+
+  /** \brief  Propagate sparsity forward, nw consecutive bvec_t words per nonzero */
+  int sp_forward_wide(const bvec_t** arg, bvec_t** res,
+                      casadi_int* iw, bvec_t* w, void* mem, casadi_int nw) const override;
+
+  /** \brief  Propagate sparsity backwards, nw consecutive bvec_t words per nonzero */
+  int sp_reverse_wide(bvec_t** arg, bvec_t** res,
+                      casadi_int* iw, bvec_t* w, void* mem, casadi_int nw) const override;
+
+  /** \brief Generate a function that calculates nfwd forward derivatives
+      Numerical in vector mode if option "vector_forward" is set, otherwise symbolic */
+  Function get_forward(casadi_int nfwd, const std::string& name,
+                       const std::vector<std::string>& inames,
+                       const std::vector<std::string>& onames,
+                       const Dict& opts) const override;
+
+  ///@{
+  /** \brief Jacobians symbolically, unless calculated with vector-mode forward derivatives */
+  bool has_jac() const override { return !vector_forward_;}
+  bool has_jacobian() const override { return !vector_forward_;}
+  ///@}
+
+  /** \brief Generate a function that calculates nadj adjoint derivatives
+      Numerical with checkpointing if option "checkpointing" is set, otherwise symbolic */
+  Function get_reverse(casadi_int nadj, const std::string& name,
+                       const std::vector<std::string>& inames,
+                       const std::vector<std::string>& onames,
+                       const Dict& opts) const override;
+
+  /** \brief Generate a function that calculates Hessian-vector products numerically */
+  Function get_hessvec(const std::string& name,
+                       const std::vector<std::string>& inames,
+                       const std::vector<std::string>& onames,
+                       const Dict& opts) const override;
+
   /** \brief Return Jacobian of all input elements with respect to all output elements */
   Function get_jacobian(const std::string& name,
                                    const std::vector<std::string>& inames,
@@ -213,21 +313,70 @@ class CASADI_EXPORT SXFunction :
   /** \brief Get default input value */
   double get_default_in(casadi_int ind) const override { return default_in_.at(ind);}
 
+  /** \brief Export function in a specific language
+      "opencl" and "cuda" give a kernel evaluating many instances, see export_kernel */
+  void export_code(const std::string& lang,
+    std::ostream &stream, const Dict& options) const override;
+
   /** \brief Export function in a specific language */
   void export_code_body(const std::string& lang,
     std::ostream &stream, const Dict& options) const override;
 
+  /** \brief Export an OpenCL or CUDA kernel evaluating n instances, one per work item
+      Input and output j of instance i start at offset i*nnz, as for Function::map,
+      or with the option "coalesced", nonzero k is at offset k*n+i */
+  void export_kernel(const std::string& lang,
+    std::ostream &stream, const Dict& options) const;
+
   /** \brief Serialize */
   void serialize(std::ostream &stream) const override;
 
   /** \brief Build function from serialization */
   static Function deserialize(std::istream &stream);
 
+  /** \brief Serialize in the binary format: the algorithm is written as is */
+  void serialize_binary(BinarySerializer& s) const override;
+
+  /** \brief Build function from the binary format, reading the algorithm in place */
+  static Function deserialize_binary(BinaryDeserializer& s);
+
   /// With just-in-time compilation using OpenCL
   bool just_in_time_opencl_;
 
   /// With just-in-time compilation for the sparsity propagation
   bool just_in_time_sparsity_;
+
+  /// Number of bvec_t words per nonzero for Jacobian sparsity pattern detection
+  casadi_int sp_width_;
+
+  /// Number of instructions removed by common subexpression elimination, -1 if disabled
+  casadi_int n_cse_removed_;
+
+  /// Number of instructions before the optimization passes, -1 if disabled
+  casadi_int n_instructions_initial_;
+
+  /// Numerical reverse mode with checkpointing, cf. SXReverse
+  bool checkpointing_;
+
+  /// Memory budget for the checkpointed reverse mode, in bytes
+  casadi_int checkpoint_memory_;
+
+  /// Numerical vector-mode forward derivatives, cf. SXForward
+  bool vector_forward_;
+
+  /// Time every n-th instruction when profiling, 0 to only count
+  casadi_int profile_sampling_;
+
+  /// Generate loops for repeated instruction sequences
+  bool loop_rolling_;
+
+  /// Vectorizable kernels for sin, cos, exp and log in batched evaluation, cf. vector_math
+  bool batch_math_, batch_math_fast_;
+
+  /** \brief Find repeated instruction sequences for the code generation
+      Returns the start, length and number of repetitions of each sequence
+  */
+  std::vector<std::array<casadi_int, 3> > repeated_sequences() const;
 };
 
 
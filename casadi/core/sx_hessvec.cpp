@@ -0,0 +1,239 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#include "sx_hessvec.hpp"
+#include "sx_function.hpp"
+
+using namespace std;
+
+namespace casadi {
+
+  SXHessVec::SXHessVec(const std::string& name) : FunctionInternal(name) {
+  }
+
+  SXHessVec::~SXHessVec() {
+  }
+
+  bool SXHessVec::der2(casadi_int op, double x, double y, double f, double* h) {
+    double t;
+    h[0] = h[1] = h[2] = 0;
+    switch (op) {
+    case OP_ASSIGN: case OP_ADD: case OP_SUB: case OP_NEG: case OP_TWICE:
+    case OP_LT: case OP_LE: case OP_EQ: case OP_NE: case OP_NOT: case OP_AND: case OP_OR:
+    case OP_FLOOR: case OP_CEIL: case OP_FMOD: case OP_FABS: case OP_SIGN: case OP_COPYSIGN:
+    case OP_IF_ELSE_ZERO: case OP_FMIN: case OP_FMAX: case OP_PRINTME: case OP_LIFT:
+      break;
+    case OP_MUL: h[1] = 1; break;
+    case OP_DIV: h[1] = -1/(y*y); h[2] = 2*f/(y*y); break;
+    case OP_EXP: h[0] = f; break;
+    case OP_LOG: h[0] = -1/(x*x); break;
+    case OP_POW:
+      h[0] = y*(y-1)*pow(x, y-2);
+      h[1] = pow(x, y-1)*(1 + y*log(x));
+      h[2] = log(x)*log(x)*f;
+      break;
+    case OP_CONSTPOW: h[0] = y*(y-1)*pow(x, y-2); break;
+    case OP_SQRT: h[0] = -1/(4*f*f*f); break;
+    case OP_SQ: h[0] = 2; break;
+    case OP_SIN: h[0] = -f; break;
+    case OP_COS: h[0] = -f; break;
+    case OP_TAN: t = cos(x); h[0] = 2*f/(t*t); break;
+    case OP_ASIN: t = 1-x*x; h[0] = x/(t*sqrt(t)); break;
+    case OP_ACOS: t = 1-x*x; h[0] = -x/(t*sqrt(t)); break;
+    case OP_ATAN: t = 1+x*x; h[0] = -2*x/(t*t); break;
+    case OP_ERF: h[0] = -2*x*(2/sqrt(pi))*exp(-x*x); break;
+    case OP_INV: h[0] = 2*f*f*f; break;
+    // Consistent with the first order partial derivatives of OP_SINH and OP_COSH
+    case OP_SINH: h[0] = -f; break;
+    case OP_COSH: h[0] = -f; break;
+    case OP_TANH: h[0] = -2*f*(1-f*f); break;
+    case OP_ASINH: t = 1+x*x; h[0] = -x/(t*sqrt(t)); break;
+    case OP_ACOSH: t = x*x-1; h[0] = -x/(t*sqrt(t)); break;
+    case OP_ATANH: t = 1-x*x; h[0] = 2*x/(t*t); break;
+    case OP_ATAN2:
+      t = x*x+y*y;
+      h[0] = -2*x*y/(t*t);
+      h[1] = (x*x-y*y)/(t*t);
+      h[2] = 2*x*y/(t*t);
+      break;
+    case OP_ERFINV: t = (sqrt(pi)/2)*exp(f*f); h[0] = 2*f*t*t; break;
+    default:
+      return false;
+    }
+    return true;
+  }
+
+  void SXHessVec::init(const Dict& opts) {
+    // Call the initialization method of the base class
+    FunctionInternal::init(opts);
+
+    // The algorithm being differentiated
+    const SXFunction* f = static_cast<const SXFunction*>(derivative_of_.get());
+    casadi_assert(f->free_vars_.empty(), "Cannot differentiate \"" + derivative_of_.name()
+                  + "\" since variables " + str(f->free_vars_) + " are free.");
+    n_alg_ = f->algorithm_.size();
+    n_w_ = f->worksize_;
+
+    // Make sure that all second order partial derivatives are available
+    double h[3];
+    for (auto&& e : f->algorithm_) {
+      switch (e.op) {
+      case OP_CONST: case OP_INPUT: case OP_OUTPUT: break;
+      default:
+        casadi_assert(der2(e.op, 0, 0, 0, h), "Second order derivatives of operation '"
+                      + casadi_math<double>::name(e.op) + "' not available");
+      }
+    }
+
+    // Values, tangents, adjoints, tangents of the adjoints, partial derivatives
+    alloc_w(4*n_w_ + 4*n_alg_, true);
+  }
+
+  Sparsity SXHessVec::get_sparsity_in(casadi_int i) {
+    casadi_int n_in = derivative_of_.n_in();
+    if (i<n_in) {
+      // Non-differentiated input
+      return derivative_of_.sparsity_in(i);
+    } else if (i<2*n_in) {
+      // Forward seeds
+      return derivative_of_.sparsity_in(i-n_in);
+    } else {
+      // Adjoint seeds
+      return derivative_of_.sparsity_out(i-2*n_in);
+    }
+  }
+
+  Sparsity SXHessVec::get_sparsity_out(casadi_int i) {
+    return derivative_of_.sparsity_in(i);
+  }
+
+  size_t SXHessVec::get_n_in() {
+    return 2*derivative_of_.n_in() + derivative_of_.n_out();
+  }
+
+  size_t SXHessVec::get_n_out() {
+    return derivative_of_.n_in();
+  }
+
+  std::string SXHessVec::get_name_in(casadi_int i) {
+    casadi_int n_in = derivative_of_.n_in();
+    if (i<n_in) {
+      return derivative_of_.name_in(i);
+    } else if (i<2*n_in) {
+      return "fwd_" + derivative_of_.name_in(i-n_in);
+    } else {
+      return "adj_" + derivative_of_.name_out(i-2*n_in);
+    }
+  }
+
+  std::string SXHessVec::get_name_out(casadi_int i) {
+    return "fwd_adj_" + derivative_of_.name_in(i);
+  }
+
+  int SXHessVec::eval(const double** arg, double** res,
+                      casadi_int* iw, double* w, void* mem) const {
+    const SXFunction* f = static_cast<const SXFunction*>(derivative_of_.get());
+    casadi_int n_in = f->n_in_;
+
+    // Clear sensitivities
+    for (casadi_int i=0; i<n_in; ++i) {
+      if (res[i]) casadi_fill(res[i], f->nnz_in(i), 0.0);
+    }
+
+    // Inputs and seeds
+    const double** fseed = arg + n_in;
+    const double** aseed = arg + 2*n_in;
+
+    // Partition the work vector
+    double* v = w;
+    double* vd = v + n_w_;
+    double* a = vd + n_w_;
+    double* ad = a + n_w_;
+    double* tape = ad + n_w_;
+
+    // Forward sweep, recording first order partial derivatives and their tangents
+    double d[2], h[3];
+    for (auto&& e : f->algorithm_) {
+      switch (e.op) {
+      case OP_CONST:
+        v[e.i0] = e.d;
+        vd[e.i0] = 0;
+        break;
+      case OP_INPUT:
+        v[e.i0] = arg[e.i1]==nullptr ? 0 : arg[e.i1][e.i2];
+        vd[e.i0] = fseed[e.i1]==nullptr ? 0 : fseed[e.i1][e.i2];
+        break;
+      case OP_OUTPUT:
+        break;
+      default:
+        {
+          // The result may overwrite one of the arguments
+          double x = v[e.i1], y = v[e.i2], xd = vd[e.i1], yd = vd[e.i2];
+          casadi_math<double>::derF(e.op, x, y, v[e.i0], d);
+          der2(e.op, x, y, v[e.i0], h);
+          vd[e.i0] = d[0]*xd + d[1]*yd;
+          tape[0] = d[0];
+          tape[1] = d[1];
+          tape[2] = h[0]*xd + h[1]*yd;
+          tape[3] = h[1]*xd + h[2]*yd;
+        }
+      }
+      tape += 4;
+    }
+
+    // Reverse sweep
+    casadi_fill(a, n_w_, 0.0);
+    casadi_fill(ad, n_w_, 0.0);
+    for (auto it=f->algorithm_.rbegin(); it!=f->algorithm_.rend(); ++it) {
+      const ScalarAtomic& e = *it;
+      tape -= 4;
+      switch (e.op) {
+      case OP_CONST:
+        a[e.i0] = ad[e.i0] = 0;
+        break;
+      case OP_INPUT:
+        if (res[e.i1]!=nullptr) res[e.i1][e.i2] += ad[e.i0];
+        a[e.i0] = ad[e.i0] = 0;
+        break;
+      case OP_OUTPUT:
+        if (aseed[e.i0]!=nullptr) a[e.i1] += aseed[e.i0][e.i2];
+        break;
+      default:
+        {
+          // The result may share its location with one of the arguments
+          double s = a[e.i0], sd = ad[e.i0];
+          a[e.i0] = ad[e.i0] = 0;
+          a[e.i1] += s*tape[0];
+          a[e.i2] += s*tape[1];
+          ad[e.i1] += sd*tape[0] + s*tape[2];
+          ad[e.i2] += sd*tape[1] + s*tape[3];
+        }
+      }
+    }
+    return 0;
+  }
+
+} // namespace casadi
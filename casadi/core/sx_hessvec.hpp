@@ -0,0 +1,89 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#ifndef CASADI_SX_HESSVEC_HPP
+#define CASADI_SX_HESSVEC_HPP
+
+#include "function_internal.hpp"
+
+/// \cond INTERNAL
+
+namespace casadi {
+  /** Numerical Hessian-vector products of an SXFunction
+    *
+    * Forward-over-reverse in one forward and one reverse sweep over the algorithm
+    * of the SXFunction, using the first and second order partial derivatives of
+    * each instruction. Neither the Hessian nor any derivative expressions are
+    * constructed, cf. Function::hessvec.
+  */
+  class CASADI_EXPORT SXHessVec : public FunctionInternal {
+  public:
+    // Constructor
+    explicit SXHessVec(const std::string& name);
+
+    /** \brief Destructor */
+    ~SXHessVec() override;
+
+    /** \brief Get type name */
+    std::string class_name() const override {return "SXHessVec";}
+
+    /// @{
+    /** \brief Sparsities of function inputs and outputs */
+    Sparsity get_sparsity_in(casadi_int i) override;
+    Sparsity get_sparsity_out(casadi_int i) override;
+    /// @}
+
+    ///@{
+    /** \brief Number of function inputs and outputs */
+    size_t get_n_in() override;
+    size_t get_n_out() override;
+    ///@}
+
+    ///@{
+    /** \brief Names of function input and outputs */
+    std::string get_name_in(casadi_int i) override;
+    std::string get_name_out(casadi_int i) override;
+    ///@}
+
+    /** \brief  Initialize */
+    void init(const Dict& opts) override;
+
+    // Evaluate numerically
+    int eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const override;
+
+    /** \brief Second order partial derivatives [d2f/dx2, d2f/dxdy, d2f/dy2] of an operation
+        Returns false if not available for the operation */
+    static bool der2(casadi_int op, double x, double y, double f, double* h);
+
+  protected:
+    // Number of instructions, work vector size
+    casadi_int n_alg_, n_w_;
+  };
+
+} // namespace casadi
+/// \endcond
+
+#endif // CASADI_SX_HESSVEC_HPP
@@ -58,6 +58,12 @@ namespace casadi {
     return false;
   }
 
+  unsigned int SXNode::hash() const {
+    // Only equal to itself
+    size_t h = std::hash<const void*>()(this);
+    return static_cast<unsigned int>(h ^ (h>>32));
+  }
+
   const std::string& SXNode::name() const {
     casadi_error("'name' not defined for " + class_name());
   }
@@ -96,60 +102,82 @@ namespace casadi {
   }
 
   void SXNode::can_inline(std::map<const SXNode*, casadi_int>& nodeind) const {
-    // Add or mark node in map
-    std::map<const SXNode*, casadi_int>::iterator it=nodeind.find(this);
-    if (it==nodeind.end()) {
-      // First time encountered, mark inlined
-      nodeind.insert(it, make_pair(this, 0));
-
-      // Handle dependencies with recursion
-      for (casadi_int i=0; i<n_dep(); ++i) {
-        dep(i)->can_inline(nodeind);
+    // Depth-first traversal with an explicit stack, deep graphs would overflow the call stack
+    std::stack<const SXNode*> s;
+    s.push(this);
+    while (!s.empty()) {
+      const SXNode* t = s.top();
+      s.pop();
+      // Add or mark node in map
+      std::map<const SXNode*, casadi_int>::iterator it=nodeind.find(t);
+      if (it==nodeind.end()) {
+        // First time encountered, mark inlined
+        nodeind.insert(it, make_pair(t, 0));
+
+        // Handle dependencies, the first one on top
+        for (casadi_int i=t->n_dep(); i-->0; ) {
+          s.push(static_cast<const SXNode*>(t->dep(i).get()));
+        }
+      } else if (it->second==0 && t->op()!=OP_PARAMETER) {
+        // Node encountered before, do not inline (except if symbolic primitive)
+        it->second = -1;
       }
-    } else if (it->second==0 && op()!=OP_PARAMETER) {
-      // Node encountered before, do not inline (except if symbolic primitive)
-      it->second = -1;
     }
   }
 
   std::string SXNode::print_compact(std::map<const SXNode*, casadi_int>& nodeind,
                                    std::vector<std::string>& intermed) const {
-    // Get reference to node index
-    casadi_int& ind = nodeind[this];
-
-    // If positive, already in intermediate expressions
-    if (ind>0) {
-      stringstream ss;
-      ss << "@" << ind;
-      return ss.str();
-    }
+    // Post-order traversal with an explicit stack of nodes and index of the next dependency
+    std::vector<std::pair<const SXNode*, casadi_int> > s;
+    // Expressions of the visited nodes, not yet used by their parent
+    std::vector<std::string> done;
+    s.push_back(make_pair(this, 0));
+    while (!s.empty()) {
+      const SXNode* t = s.back().first;
+      casadi_int next_dep = s.back().second++;
+
+      // Get reference to node index
+      casadi_int& ind = nodeind[t];
+
+      // If positive, already in intermediate expressions
+      if (next_dep==0 && ind>0) {
+        done.push_back("@" + str(ind));
+        s.pop_back();
+        continue;
+      }
 
-    // Get expressions for dependencies
-    std::string arg[2];
-    for (casadi_int i=0; i<n_dep(); ++i) {
-      arg[i] = dep(i)->print_compact(nodeind, intermed);
-    }
+      // Get expressions for dependencies first
+      if (next_dep<t->n_dep()) {
+        s.push_back(make_pair(static_cast<const SXNode*>(t->dep(next_dep).get()), 0));
+        continue;
+      }
+      s.pop_back();
+      std::string arg[2];
+      for (casadi_int i=t->n_dep(); i-->0; ) {
+        arg[i] = std::move(done.back());
+        done.pop_back();
+      }
 
-    // Get expression for this
-    string s = print(arg[0], arg[1]);
-
-    // Decide what to do with the expression
-    if (ind==0) {
-      // Inline expression
-      return s;
-    } else {
-      // Add to list of intermediate expressions and return reference
-      intermed.push_back(s);
-      ind = intermed.size(); // For subsequent references
-      stringstream ss;
-      ss << "@" << ind;
-      return ss.str();
+      // Get expression for this
+      string e = t->print(arg[0], arg[1]);
+
+      // Decide what to do with the expression
+      if (ind==0) {
+        // Inline expression
+        done.push_back(std::move(e));
+      } else {
+        // Add to list of intermediate expressions and return reference
+        intermed.push_back(e);
+        ind = intermed.size(); // For subsequent references
+        done.push_back("@" + str(ind));
+      }
     }
+    return done.back();
   }
 
   void SXNode::safe_delete(SXNode* n) {
-    // Quick return if more owners
-    if (n->count>0) return;
+    // Quick return if more owners, cf. SXElem::assignNoDelete
+    if (n==nullptr) return;
     // Delete straight away if it doesn't have any dependencies
     if (!n->n_dep()) {
       delete n;
@@ -169,8 +197,8 @@ namespace casadi {
         // Get the node of the dependency of the top element
         // and remove it from the smart pointer
         SXNode *n2 = t->dep(c2).assignNoDelete(casadi_limits<SXElem>::nan);
-        // Check if this is the only reference to the element
-        if (n2->count == 0) {
+        // Check if this was the only reference to the element
+        if (n2) {
           // Check if unary or binary
           if (!n2->n_dep()) {
             // Delete straight away if not binary
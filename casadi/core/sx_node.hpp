@@ -30,9 +30,13 @@
 #include <string>
 #include <sstream>
 #include <math.h>
+#ifdef CASADI_WITH_THREAD
+#include <atomic>
+#endif // CASADI_WITH_THREAD
 
 /** \brief  Scalar expression (which also works as a smart pointer class to this class) */
 #include "sx_elem.hpp"
+#include "node_pool.hpp"
 
 
 /// \cond INTERNAL
@@ -54,6 +58,12 @@ namespace casadi {
     /** \brief  destructor  */
     virtual ~SXNode();
 
+    ///@{
+    /** \brief Allocation of nodes, cf. GlobalOptions::setNodePool */
+    static void* operator new(std::size_t sz) { return NodePool::allocate(sz);}
+    static void operator delete(void* p) { NodePool::deallocate(p);}
+    ///@}
+
     ///@{
     /** \brief  check properties of a node */
     virtual bool is_constant() const { return false; }
@@ -87,6 +97,16 @@ namespace casadi {
     /** \brief Check if two nodes are equivalent up to a given depth */
     virtual bool is_equal(const SXNode* node, casadi_int depth) const;
 
+    /** \brief Structural hash
+        Nodes that are equivalent for some depth have the same hash, which allows
+        is_equal to reject most pairs without recursing */
+    virtual unsigned int hash() const;
+
+    /** \brief Combine hash values */
+    static unsigned int hash_combine(unsigned int seed, unsigned int v) {
+      return seed ^ (v + 0x9e3779b9 + (seed<<6) + (seed>>2));
+    }
+
     /** \brief  Number of dependencies */
     virtual casadi_int n_dep() const { return 0;}
 
@@ -131,7 +151,11 @@ namespace casadi {
     mutable int temp;
 
     // Reference counter -- counts the number of parents of the node
+#ifdef CASADI_WITH_THREAD
+    std::atomic<unsigned int> count;
+#else // CASADI_WITH_THREAD
     unsigned int count;
+#endif // CASADI_WITH_THREAD
 
   };
 
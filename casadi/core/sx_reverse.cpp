@@ -0,0 +1,289 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#include "sx_reverse.hpp"
+#include "sx_function.hpp"
+
+using namespace std;
+
+namespace casadi {
+
+  SXReverse::SXReverse(const std::string& name, casadi_int nadj)
+    : FunctionInternal(name), nadj_(nadj) {
+    checkpoint_memory_ = 1 << 26;
+  }
+
+  SXReverse::~SXReverse() {
+  }
+
+  Options SXReverse::options_
+  = {{&FunctionInternal::options_},
+     {{"checkpoint_memory",
+       {OT_INT,
+        "Memory budget in bytes for the recorded partial derivatives and the "
+        "work vector snapshots [default: 64 MiB]"}}
+     }
+  };
+
+  // Number of chunks that can be reversed with c snapshots and r recomputations
+  static double binomial_steps(casadi_int c, casadi_int r) {
+    double ret = 1;
+    for (casadi_int i=1; i<=c; ++i) ret = ret*static_cast<double>(r+i)/static_cast<double>(i);
+    return ret;
+  }
+
+  void SXReverse::init(const Dict& opts) {
+    // Call the initialization method of the base class
+    FunctionInternal::init(opts);
+
+    // Read options
+    for (auto&& op : opts) {
+      if (op.first=="checkpoint_memory") {
+        checkpoint_memory_ = op.second;
+      }
+    }
+    casadi_assert(checkpoint_memory_>=0, "Option 'checkpoint_memory' must be nonnegative");
+
+    // The algorithm being differentiated
+    const SXFunction* f = static_cast<const SXFunction*>(derivative_of_.get());
+    casadi_assert(f->free_vars_.empty(), "Cannot differentiate \"" + derivative_of_.name()
+                  + "\" since variables " + str(f->free_vars_) + " are free.");
+    n_alg_ = f->algorithm_.size();
+    n_w_ = f->worksize_;
+
+    // Two partial derivatives per instruction, budget in number of doubles
+    casadi_int budget = checkpoint_memory_ / static_cast<casadi_int>(sizeof(double));
+    if (2*n_alg_ <= budget) {
+      // Record the whole algorithm at once
+      chunk_ = std::max(n_alg_, casadi_int(1));
+      n_chunk_ = 1;
+      n_snap_ = 0;
+    } else {
+      // Split the budget between the chunk being recorded and the snapshots
+      chunk_ = std::max(budget/4, casadi_int(1));
+      n_chunk_ = (n_alg_ + chunk_ - 1) / chunk_;
+      n_snap_ = std::min(n_chunk_ - 1, (budget/2) / std::max(n_w_, casadi_int(1)));
+    }
+
+    // Forward work vector, adjoints, partial derivatives, snapshots
+    alloc_w(n_w_*(1 + nadj_) + 2*chunk_ + n_snap_*n_w_, true);
+
+    if (verbose_) {
+      casadi_message("Checkpointed reverse mode for " + str(n_alg_) + " instructions: "
+                     + str(n_chunk_) + " chunks of " + str(chunk_) + " instructions, "
+                     + str(n_snap_) + " snapshots of " + str(n_w_) + " elements.");
+    }
+  }
+
+  Sparsity SXReverse::get_sparsity_in(casadi_int i) {
+    casadi_int n_in = derivative_of_.n_in(), n_out = derivative_of_.n_out();
+    if (i<n_in) {
+      // Non-differentiated input
+      return derivative_of_.sparsity_in(i);
+    } else if (i<n_in+n_out) {
+      // Non-differentiated output
+      return derivative_of_.sparsity_out(i-n_in);
+    } else {
+      // Seeds
+      return repmat(derivative_of_.sparsity_out(i-n_in-n_out), 1, nadj_);
+    }
+  }
+
+  Sparsity SXReverse::get_sparsity_out(casadi_int i) {
+    return repmat(derivative_of_.sparsity_in(i), 1, nadj_);
+  }
+
+  size_t SXReverse::get_n_in() {
+    return derivative_of_.n_in() + derivative_of_.n_out() + derivative_of_.n_out();
+  }
+
+  size_t SXReverse::get_n_out() {
+    return derivative_of_.n_in();
+  }
+
+  std::string SXReverse::get_name_in(casadi_int i) {
+    casadi_int n_in = derivative_of_.n_in(), n_out = derivative_of_.n_out();
+    if (i<n_in) {
+      return derivative_of_.name_in(i);
+    } else if (i<n_in+n_out) {
+      return "out_" + derivative_of_.name_out(i-n_in);
+    } else {
+      return "adj_" + derivative_of_.name_out(i-n_in-n_out);
+    }
+  }
+
+  std::string SXReverse::get_name_out(casadi_int i) {
+    return "adj_" + derivative_of_.name_in(i);
+  }
+
+  void SXReverse::restore(casadi_int snap, double* w, const double* s) const {
+    // Instructions always write before reading, the initial state is arbitrary
+    if (snap>=0) casadi_copy(s + snap*n_w_, n_w_, w);
+  }
+
+  void SXReverse::advance(casadi_int k0, casadi_int k1,
+                          const double** arg, double* w) const {
+    const SXFunction* f = static_cast<const SXFunction*>(derivative_of_.get());
+    auto it_end = f->algorithm_.begin() + std::min(k1*chunk_, n_alg_);
+    for (auto it = f->algorithm_.begin() + k0*chunk_; it!=it_end; ++it) {
+      const ScalarAtomic& e = *it;
+      switch (e.op) {
+        CASADI_MATH_FUN_BUILTIN(w[e.i1], w[e.i2], w[e.i0])
+
+      case OP_CONST: w[e.i0] = e.d; break;
+      case OP_INPUT: w[e.i0] = arg[e.i1]==nullptr ? 0 : arg[e.i1][e.i2]; break;
+      case OP_OUTPUT: break;
+      default:
+        casadi_error("Unknown operation" + str(e.op));
+      }
+    }
+  }
+
+  void SXReverse::record(casadi_int k, const double** arg, double* w, double* tape) const {
+    const SXFunction* f = static_cast<const SXFunction*>(derivative_of_.get());
+    auto it_end = f->algorithm_.begin() + std::min((k+1)*chunk_, n_alg_);
+    for (auto it = f->algorithm_.begin() + k*chunk_; it!=it_end; ++it, tape+=2) {
+      const ScalarAtomic& e = *it;
+      switch (e.op) {
+      case OP_CONST: w[e.i0] = e.d; break;
+      case OP_INPUT: w[e.i0] = arg[e.i1]==nullptr ? 0 : arg[e.i1][e.i2]; break;
+      case OP_OUTPUT: break;
+      default:
+        {
+          // The result may overwrite one of the arguments
+          double x = w[e.i1], y = w[e.i2];
+          casadi_math<double>::derF(e.op, x, y, w[e.i0], tape);
+        }
+      }
+    }
+  }
+
+  void SXReverse::propagate(casadi_int k, const double** arg, double** res,
+                            double* aw, const double* tape) const {
+    const SXFunction* f = static_cast<const SXFunction*>(derivative_of_.get());
+    casadi_int n_in = f->n_in_, n_out = f->n_out_;
+    casadi_int i0 = k*chunk_, i1 = std::min((k+1)*chunk_, n_alg_);
+    tape += 2*(i1-i0);
+    for (auto it = f->algorithm_.begin() + i1; it!=f->algorithm_.begin() + i0; ) {
+      const ScalarAtomic& e = *--it;
+      tape -= 2;
+      double *a0 = aw + e.i0*nadj_;
+      switch (e.op) {
+      case OP_CONST:
+        casadi_fill(a0, nadj_, 0.0);
+        break;
+      case OP_INPUT:
+        if (res[e.i1]!=nullptr) {
+          casadi_int nnz = f->nnz_in(e.i1);
+          for (casadi_int d=0; d<nadj_; ++d) res[e.i1][d*nnz + e.i2] += a0[d];
+        }
+        casadi_fill(a0, nadj_, 0.0);
+        break;
+      case OP_OUTPUT:
+        {
+          const double* seed = arg[n_in + n_out + e.i0];
+          if (seed!=nullptr) {
+            casadi_int nnz = f->nnz_out(e.i0);
+            double* a1 = aw + e.i1*nadj_;
+            for (casadi_int d=0; d<nadj_; ++d) a1[d] += seed[d*nnz + e.i2];
+          }
+        }
+        break;
+      default:
+        {
+          double* a1 = aw + e.i1*nadj_;
+          double* a2 = aw + e.i2*nadj_;
+          for (casadi_int d=0; d<nadj_; ++d) {
+            // The result may share its location with one of the arguments
+            double s = a0[d];
+            a0[d] = 0;
+            a1[d] += s*tape[0];
+            a2[d] += s*tape[1];
+          }
+        }
+      }
+    }
+  }
+
+  void SXReverse::sweep(casadi_int k0, casadi_int m, casadi_int c, casadi_int snap,
+                        const double** arg, double** res, double* w, double* aw,
+                        double* tape, double* s) const {
+    if (m==1) {
+      // Record and reverse a single chunk
+      restore(snap, w, s);
+      record(k0, arg, w, tape);
+      propagate(k0, arg, res, aw, tape);
+    } else if (c==0) {
+      // No snapshots left, recompute from the start for every chunk
+      for (casadi_int j=m-1; j>=0; --j) {
+        restore(snap, w, s);
+        advance(k0, k0+j, arg, w);
+        record(k0+j, arg, w, tape);
+        propagate(k0+j, arg, res, aw, tape);
+      }
+    } else {
+      // Smallest number of recomputations allowing m chunks to be reversed
+      casadi_int r = 1;
+      while (binomial_steps(c, r) < m) r++;
+      // The right part can be reversed with one snapshot less
+      casadi_int j = std::max(m - static_cast<casadi_int>(binomial_steps(c-1, r)),
+                              casadi_int(1));
+      // Advance and take a snapshot
+      restore(snap, w, s);
+      advance(k0, k0+j, arg, w);
+      casadi_int slot = n_snap_ - c;
+      casadi_copy(w, n_w_, s + slot*n_w_);
+      // Reverse the right part, then the left part
+      sweep(k0+j, m-j, c-1, slot, arg, res, w, aw, tape, s);
+      sweep(k0, j, c, snap, arg, res, w, aw, tape, s);
+    }
+  }
+
+  int SXReverse::eval(const double** arg, double** res,
+                      casadi_int* iw, double* w, void* mem) const {
+    casadi_int n_in = derivative_of_.n_in();
+
+    // Clear adjoint sensitivities
+    for (casadi_int i=0; i<n_in; ++i) {
+      if (res[i]) casadi_fill(res[i], nadj_*derivative_of_.nnz_in(i), 0.0);
+    }
+
+    // Partition the work vector
+    double* wf = w;
+    w += n_w_;
+    double* aw = w;
+    w += nadj_*n_w_;
+    double* tape = w;
+    w += 2*chunk_;
+    double* s = w;
+
+    // Reverse all chunks
+    casadi_fill(aw, nadj_*n_w_, 0.0);
+    if (n_alg_>0) sweep(0, n_chunk_, n_snap_, -1, arg, res, wf, aw, tape, s);
+    return 0;
+  }
+
+} // namespace casadi
@@ -0,0 +1,119 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#ifndef CASADI_SX_REVERSE_HPP
+#define CASADI_SX_REVERSE_HPP
+
+#include "function_internal.hpp"
+
+/// \cond INTERNAL
+
+namespace casadi {
+  /** Numerical reverse mode of an SXFunction with binomial checkpointing
+    *
+    * The algorithm is divided into chunks of instructions. Only the partial
+    * derivatives of the chunk being reversed are stored, together with a fixed
+    * number of snapshots of the work vector at chunk boundaries. Chunks
+    * between snapshots are recomputed, placing the snapshots as in the
+    * "revolve" algorithm (Griewank & Walther, 2000), cf. SXFunction option "checkpointing".
+  */
+  class CASADI_EXPORT SXReverse : public FunctionInternal {
+  public:
+    // Constructor
+    SXReverse(const std::string& name, casadi_int nadj);
+
+    /** \brief Destructor */
+    ~SXReverse() override;
+
+    /** \brief Get type name */
+    std::string class_name() const override {return "SXReverse";}
+
+    ///@{
+    /** \brief Options */
+    static Options options_;
+    const Options& get_options() const override { return options_;}
+    ///@}
+
+    /// @{
+    /** \brief Sparsities of function inputs and outputs */
+    Sparsity get_sparsity_in(casadi_int i) override;
+    Sparsity get_sparsity_out(casadi_int i) override;
+    /// @}
+
+    ///@{
+    /** \brief Number of function inputs and outputs */
+    size_t get_n_in() override;
+    size_t get_n_out() override;
+    ///@}
+
+    ///@{
+    /** \brief Names of function input and outputs */
+    std::string get_name_in(casadi_int i) override;
+    std::string get_name_out(casadi_int i) override;
+    ///@}
+
+    /** \brief  Initialize */
+    void init(const Dict& opts) override;
+
+    // Evaluate numerically
+    int eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const override;
+
+  protected:
+    // Restore the work vector from a snapshot, -1 for the initial state
+    void restore(casadi_int snap, double* w, const double* s) const;
+
+    // Evaluate chunks [k0, k1) without recording
+    void advance(casadi_int k0, casadi_int k1, const double** arg, double* w) const;
+
+    // Evaluate chunk k, recording the partial derivatives
+    void record(casadi_int k, const double** arg, double* w, double* tape) const;
+
+    // Propagate adjoints backwards through chunk k
+    void propagate(casadi_int k, const double** arg, double** res,
+                   double* aw, const double* tape) const;
+
+    // Reverse chunks [k0, k0+m) starting from snapshot snap with c free snapshots
+    void sweep(casadi_int k0, casadi_int m, casadi_int c, casadi_int snap,
+               const double** arg, double** res, double* w, double* aw,
+               double* tape, double* s) const;
+
+    // Number of adjoint directions
+    casadi_int nadj_;
+
+    // Memory budget for tape and snapshots, in bytes
+    casadi_int checkpoint_memory_;
+
+    // Number of instructions, work vector size
+    casadi_int n_alg_, n_w_;
+
+    // Instructions per chunk, number of chunks, number of snapshots
+    casadi_int chunk_, n_chunk_, n_snap_;
+  };
+
+} // namespace casadi
+/// \endcond
+
+#endif // CASADI_SX_REVERSE_HPP
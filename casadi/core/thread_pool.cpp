@@ -0,0 +1,281 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#include "thread_pool.hpp"
+
+#ifdef CASADI_WITH_THREAD
+#ifdef CASADI_WITH_THREAD_MINGW
+#include <mingw.thread.h>
+#include <mingw.mutex.h>
+#include <mingw.condition_variable.h>
+#else // CASADI_WITH_THREAD_MINGW
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#endif // CASADI_WITH_THREAD_MINGW
+#include <deque>
+#include <exception>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif // __linux__
+#endif // CASADI_WITH_THREAD
+
+using namespace std;
+
+namespace casadi {
+
+#ifdef CASADI_WITH_THREAD
+  namespace {
+    // A task submitted to the pool, lives on the stack of the submitting thread
+    struct PoolJob {
+      // Task to be executed for each chunk
+      const std::function<void(casadi_int, casadi_int)>* task;
+      // Number of chunks
+      casadi_int n;
+      // Next chunk to be claimed
+      casadi_int next;
+      // Number of finished chunks
+      casadi_int done;
+      // Number of worker threads that may still join
+      casadi_int helpers;
+      // Number of threads that have joined, excluding the submitting thread
+      casadi_int joined;
+      // First exception thrown by the task, if any
+      std::exception_ptr error;
+    };
+
+    // Index of the calling thread in the pool, cf. ThreadPool::worker_id
+    thread_local casadi_int pool_worker_id = 0;
+
+    class Pool {
+    public:
+      Pool() : stop_(false), pin_(false) {
+#ifdef __linux__
+        // Cores allowed for the process, workers are pinned to these
+        cpu_set_t mask;
+        if (sched_getaffinity(0, sizeof(mask), &mask)==0) {
+          for (int c=0; c<CPU_SETSIZE; ++c) if (CPU_ISSET(c, &mask)) cores_.push_back(c);
+        }
+#endif // __linux__
+      }
+
+      ~Pool() {
+        {
+          std::lock_guard<std::mutex> lock(mtx_);
+          stop_ = true;
+        }
+        cv_work_.notify_all();
+        for (auto&& th : workers_) th.join();
+      }
+
+      void run(PoolJob& job) {
+        std::unique_lock<std::mutex> lock(mtx_);
+        if (job.helpers>0) {
+          // Spawn workers lazily, they persist for the lifetime of the process
+          while (static_cast<casadi_int>(workers_.size())<job.helpers) {
+            workers_.emplace_back(&Pool::work, this, workers_.size()+1);
+          }
+          jobs_.push_back(&job);
+          cv_work_.notify_all();
+        }
+        // Help out
+        process(job, 0, lock);
+        // Wait for the chunks processed by the workers
+        cv_done_.wait(lock, [&job]{ return job.done==job.n;});
+      }
+
+      // Pin the workers, cf. ThreadPool::set_pinning
+      void set_pinning(bool flag) {
+        std::lock_guard<std::mutex> lock(mtx_);
+        pin_ = flag;
+      }
+      bool pinning() {
+        std::lock_guard<std::mutex> lock(mtx_);
+        return pin_;
+      }
+
+    private:
+      // Claim and evaluate chunks until none are left, mtx_ locked on entry and exit
+      void process(PoolJob& job, casadi_int t, std::unique_lock<std::mutex>& lock) {
+        while (job.next<job.n) {
+          casadi_int k = job.next++;
+          if (job.next==job.n) dequeue(job);
+          lock.unlock();
+          std::exception_ptr error;
+          try {
+            (*job.task)(k, t);
+          } catch (...) {
+            error = std::current_exception();
+          }
+          lock.lock();
+          if (error && !job.error) job.error = error;
+          if (++job.done==job.n) cv_done_.notify_all();
+        }
+      }
+
+      // Remove a job from the queue, if still there
+      void dequeue(PoolJob& job) {
+        for (auto it=jobs_.begin(); it!=jobs_.end(); ++it) {
+          if (*it==&job) {
+            jobs_.erase(it);
+            return;
+          }
+        }
+      }
+
+      // Pin the calling worker to its core, or allow all cores again
+      void apply_pinning(casadi_int id, bool flag) {
+#ifdef __linux__
+        if (cores_.empty()) return;
+        cpu_set_t mask;
+        CPU_ZERO(&mask);
+        if (flag) {
+          CPU_SET(cores_[(id-1) % cores_.size()], &mask);
+        } else {
+          for (int c : cores_) CPU_SET(c, &mask);
+        }
+        pthread_setaffinity_np(pthread_self(), sizeof(mask), &mask);
+#endif // __linux__
+      }
+
+      // Worker thread loop
+      void work(casadi_int id) {
+        pool_worker_id = id;
+        bool pinned = false;
+        std::unique_lock<std::mutex> lock(mtx_);
+        while (true) {
+          cv_work_.wait(lock, [this]{ return stop_ || !jobs_.empty();});
+          if (stop_) return;
+          if (pinned!=pin_) {
+            pinned = pin_;
+            apply_pinning(id, pinned);
+          }
+          PoolJob& job = *jobs_.front();
+          if (--job.helpers==0) dequeue(job);
+          process(job, ++job.joined, lock);
+        }
+      }
+
+      std::mutex mtx_;
+      std::condition_variable cv_work_, cv_done_;
+      std::vector<std::thread> workers_;
+      std::deque<PoolJob*> jobs_;
+      bool stop_;
+      // Pin the workers to cores
+      bool pin_;
+      // Cores allowed for the process
+      std::vector<int> cores_;
+    };
+
+    Pool& pool() {
+      static Pool p;
+      return p;
+    }
+  } // namespace
+#endif // CASADI_WITH_THREAD
+
+  void ThreadPool::run(casadi_int n, casadi_int n_threads,
+                       const std::function<void(casadi_int, casadi_int)>& task) {
+#ifdef CASADI_WITH_THREAD
+    if (n>1 && n_threads>1 && !SerialLock::held()) {
+      PoolJob job = {&task, n, 0, 0, std::min(n, n_threads)-1, 0, nullptr};
+      pool().run(job);
+      if (job.error) std::rethrow_exception(job.error);
+      return;
+    }
+#endif // CASADI_WITH_THREAD
+    for (casadi_int k=0; k<n; ++k) task(k, 0);
+  }
+
+#ifdef CASADI_WITH_THREAD
+  namespace {
+    std::recursive_mutex& serial_mutex() {
+      static std::recursive_mutex instance;
+      return instance;
+    }
+
+    // Number of times the calling thread holds the serial lock
+    thread_local casadi_int serial_depth = 0;
+  } // namespace
+#endif // CASADI_WITH_THREAD
+
+  SerialLock::SerialLock(bool active) : active_(active) {
+#ifdef CASADI_WITH_THREAD
+    if (active_) {
+      serial_mutex().lock();
+      serial_depth++;
+    }
+#endif // CASADI_WITH_THREAD
+  }
+
+  SerialLock::~SerialLock() {
+#ifdef CASADI_WITH_THREAD
+    if (active_) {
+      serial_depth--;
+      serial_mutex().unlock();
+    }
+#endif // CASADI_WITH_THREAD
+  }
+
+  bool SerialLock::held() {
+#ifdef CASADI_WITH_THREAD
+    return serial_depth>0;
+#else // CASADI_WITH_THREAD
+    return false;
+#endif // CASADI_WITH_THREAD
+  }
+
+  casadi_int ThreadPool::worker_id() {
+#ifdef CASADI_WITH_THREAD
+    return pool_worker_id;
+#else // CASADI_WITH_THREAD
+    return 0;
+#endif // CASADI_WITH_THREAD
+  }
+
+  void ThreadPool::set_pinning(bool flag) {
+#ifdef CASADI_WITH_THREAD
+    pool().set_pinning(flag);
+#endif // CASADI_WITH_THREAD
+  }
+
+  bool ThreadPool::pinning() {
+#ifdef CASADI_WITH_THREAD
+    return pool().pinning();
+#else // CASADI_WITH_THREAD
+    return false;
+#endif // CASADI_WITH_THREAD
+  }
+
+  casadi_int ThreadPool::hardware_concurrency() {
+#ifdef CASADI_WITH_THREAD
+    casadi_int n = std::thread::hardware_concurrency();
+    if (n>0) return n;
+#endif // CASADI_WITH_THREAD
+    return 1;
+  }
+
+} // namespace casadi
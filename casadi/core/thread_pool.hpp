@@ -0,0 +1,99 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#ifndef CASADI_THREAD_POOL_HPP
+#define CASADI_THREAD_POOL_HPP
+
+#include "casadi_common.hpp"
+#include <functional>
+
+/// \cond INTERNAL
+
+namespace casadi {
+
+  /** \brief Process-wide pool of persistent worker threads
+
+      A task is split into a number of chunks which are processed by the worker
+      threads and by the calling thread. The call blocks until all chunks have
+      been processed. Since the calling thread takes part in the work, nested
+      calls (e.g. a thread map inside a thread map) cannot deadlock.
+      Without thread support, the chunks are processed serially.
+  */
+  class CASADI_EXPORT ThreadPool {
+  public:
+    /** \brief Evaluate task(k, t) for k=0..n-1
+        At most n_threads threads, including the calling thread, work on the task.
+        Chunks are claimed dynamically; t=0..n_threads-1 identifies the thread that
+        processes chunk k, with t=0 the calling thread. Per-thread resources such as
+        work vectors and memory objects can thus be indexed by t.
+        An exception thrown by the task is rethrown in the calling thread.
+    */
+    static void run(casadi_int n, casadi_int n_threads,
+                    const std::function<void(casadi_int, casadi_int)>& task);
+
+    /** \brief Number of hardware threads, at least 1 */
+    static casadi_int hardware_concurrency();
+
+    /** \brief Index of the calling thread: 1, 2, ... for the worker threads of the pool,
+        which keep their index for the lifetime of the process, 0 for all other threads
+        Buffers that a worker allocates itself and indexes by worker_id stay local to its
+        NUMA node under first-touch page placement, cf. ThreadMap */
+    static casadi_int worker_id();
+
+    /** \brief Pin each worker thread to one core, cf. GlobalOptions::setThreadPinning
+        Worker k runs on the k-th core (cyclically) allowed for the process when the pool
+        was created. Takes effect when a worker picks up its next task. Linux only */
+    static void set_pinning(bool flag);
+    static bool pinning();
+  };
+
+  /** \brief Process-wide lock serializing calls into non-reentrant libraries
+
+      Held during the numerical evaluation of plugins wrapping libraries with global
+      state, cf. FunctionInternal::is_reentrant. One lock is shared by all such plugins,
+      since the libraries depend on each other (e.g. blocksqp on qpOASES). It is
+      recursive, so that the plugins can call each other, and ThreadPool::run processes
+      all chunks in the calling thread while it is held, since the workers would block.
+      Without thread support, this does nothing.
+  */
+  class CASADI_EXPORT SerialLock {
+  public:
+    /// Acquire the lock, unless inactive
+    explicit SerialLock(bool active=true);
+
+    /// Release the lock
+    ~SerialLock();
+
+    /// Does the calling thread hold the lock?
+    static bool held();
+
+  private:
+    bool active_;
+  };
+
+} // namespace casadi
+/// \endcond
+
+#endif // CASADI_THREAD_POOL_HPP
@@ -25,10 +25,13 @@
 
 #include "timing.hpp"
 
+#include <algorithm>
+#include <cmath>
+
 namespace casadi {
 
   using namespace std::chrono;
-  FStats::FStats() {
+  FStats::FStats() : n_hist(0), t_max(0) {
     reset();
   }
 
@@ -50,9 +53,57 @@ namespace casadi {
 
     // Process them
     t_proc += static_cast<double>(stop_proc - start_proc) / static_cast<double>(CLOCKS_PER_SEC);
-    t_wall += duration<double>(stop_wall - start_wall).count();
+    double t = duration<double>(stop_wall - start_wall).count();
+    t_wall += t;
+    if (!hist.empty()) record(t);
 
     n_call +=1;
   }
 
+  void FStats::enable_histogram() {
+    // Exact below HIST_SUB ns, then HIST_SUB buckets per power of two up to ~1100 s
+    hist.resize(HIST_SUB*37, 0);
+  }
+
+  void FStats::record(double t) {
+    double ns = t*1e9;
+    casadi_int ind;
+    if (ns < HIST_SUB) {
+      ind = std::max(static_cast<casadi_int>(ns), casadi_int(0));
+    } else {
+      // ns = f*2^e with f in [0.5, 1), HIST_SUB = 2^4
+      int e;
+      double f = std::frexp(ns, &e);
+      ind = (e-4)*HIST_SUB + static_cast<casadi_int>((2*f-1)*HIST_SUB);
+    }
+    hist[std::min(ind, static_cast<casadi_int>(hist.size())-1)]++;
+    n_hist++;
+    t_max = std::max(t_max, t);
+  }
+
+  double FStats::percentile(double p) const {
+    if (n_hist==0) return 0;
+    // Number of calls at or below the percentile
+    casadi_int target = std::max(static_cast<casadi_int>(std::ceil(p*n_hist)), casadi_int(1));
+    casadi_int cum = 0;
+    for (casadi_int ind=0; ind<hist.size(); ++ind) {
+      cum += hist[ind];
+      if (cum<target) continue;
+      // Upper bound of the bucket
+      double ns;
+      if (ind < HIST_SUB) {
+        ns = ind+1;
+      } else {
+        ns = std::ldexp(static_cast<double>(HIST_SUB+1+ind%HIST_SUB), ind/HIST_SUB-1);
+      }
+      return std::min(ns*1e-9, t_max);
+    }
+    return t_max;
+  }
+
+  Dict FStats::latency() const {
+    return {{"n_call", n_hist}, {"p50", percentile(0.5)}, {"p90", percentile(0.9)},
+            {"p99", percentile(0.99)}, {"p999", percentile(0.999)}, {"max", t_max}};
+  }
+
 } // namespace casadi
@@ -30,6 +30,7 @@
 
 #include <ctime>
 #include <chrono>
+#include <vector>
 
 namespace casadi {
   /// \cond INTERNAL
@@ -71,6 +72,35 @@ namespace casadi {
       /// Stop timing
       void toc();
 
+      /** \brief Keep a histogram of the wall time of each call
+       * Unlike the accumulated times, the histogram is not cleared by reset */
+      void enable_histogram();
+
+      /// Is a histogram kept?
+      bool has_histogram() const { return !hist.empty();}
+
+      /// Add a call with a given wall time [s] to the histogram
+      void record(double t);
+
+      /** \brief Wall time [s] not exceeded by a fraction p of the recorded calls
+       * Upper bound of the bucket, at most 1/HIST_SUB larger than the exact value */
+      double percentile(double p) const;
+
+      /// Percentiles, maximum and number of the recorded calls
+      Dict latency() const;
+
+      /// Number of buckets per power of two of the histogram
+      static const casadi_int HIST_SUB = 16;
+
+      /// Histogram over the wall time in nanoseconds, empty if not kept
+      std::vector<casadi_int> hist;
+
+      /// Number of calls in the histogram
+      casadi_int n_hist;
+
+      /// Largest wall time [s] in the histogram
+      double t_max;
+
       /// Accumulated number of calls since last reset
       casadi_int n_call;
 
@@ -40,7 +40,9 @@ class UnarySX : public SXNode {
   private:
 
     /** \brief  Constructor is private, use "create" below */
-    UnarySX(unsigned char op, const SXElem& dep) : op_(op), dep_(dep) {}
+    UnarySX(unsigned char op, const SXElem& dep) : op_(op), dep_(dep) {
+      hash_ = hash_combine(op_, dep.get()->hash());
+    }
 
   public:
 
@@ -72,6 +74,7 @@ class UnarySX : public SXNode {
 
     /** \brief Check if two nodes are equivalent up to a given depth */
     bool is_equal(const SXNode* node, casadi_int depth) const override {
+      if (node->hash()!=hash_) return false;
       const UnarySX* n = dynamic_cast<const UnarySX*>(node);
       return n && n->op_ == op_ &&  SXElem::is_equal(n->dep_, dep_, depth-1);
     }
@@ -86,6 +89,9 @@ class UnarySX : public SXNode {
     /** \brief  Get the operation */
     casadi_int op() const override { return op_;}
 
+    /** \brief  Structural hash */
+    unsigned int hash() const override { return hash_;}
+
     /** \brief  Print expression */
     std::string print(const std::string& arg1, const std::string& arg2) const  override {
       return casadi_math<double>::print(op_, arg1);
@@ -94,6 +100,9 @@ class UnarySX : public SXNode {
     /** \brief  The binary operation as an 1 byte integer (allows 256 values) */
     unsigned char op_;
 
+    /** \brief  Structural hash, stored in the padding after op_ */
+    unsigned int hash_;
+
     /** \brief  The dependencies of the node */
     SXElem dep_;
 };
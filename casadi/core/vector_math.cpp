@@ -0,0 +1,204 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#include "vector_math.hpp"
+#include "casadi_misc.hpp"
+#include "calculus.hpp"
+
+#include <cfloat>
+#include <cstdint>
+#include <cstring>
+
+namespace casadi {
+
+  namespace {
+    // Values per block. The results of a block are written to a local buffer first,
+    // so that out-of-range arguments can be redone with libm even if f aliases x
+    const casadi_int BLOCK = 64;
+
+    inline uint64_t to_bits(double x) { uint64_t b; std::memcpy(&b, &x, sizeof(b)); return b;}
+    inline double from_bits(uint64_t b) { double x; std::memcpy(&x, &b, sizeof(x)); return x;}
+
+    // Adding 1.5*2^52 rounds to an integer, which ends up in the low mantissa bits
+    const double ROUND = 6755399441055744.0;
+
+    // ln(2) and pi/2 split such that the leading parts times a moderate integer are exact
+    const double LN2_HI = 6.93147180369123816490e-01, LN2_LO = 1.90821492927058770002e-10;
+    const double PIO2_1 = 1.57079632673412561417e+00, PIO2_2 = 6.07710050630396597660e-11,
+                 PIO2_3 = 2.02226624871116645580e-21;
+
+    template<bool fast>
+    inline double exp_kernel(double x) {
+      // exp(x) = 2^k exp(r), |r| <= ln(2)/2
+      double t = x*1.44269504088896338700e+00 + ROUND;
+      double k = t - ROUND;
+      double r = (x - k*LN2_HI) - k*LN2_LO;
+      // Taylor polynomial of degree 13 (fast: 8)
+      double p;
+      if (fast) {
+        p = 1./40320;
+        p = 1./5040 + r*p;
+        p = 1./720 + r*p;
+      } else {
+        p = 1./6227020800.;
+        p = 1./479001600. + r*p;
+        p = 1./39916800. + r*p;
+        p = 1./3628800. + r*p;
+        p = 1./362880. + r*p;
+        p = 1./40320. + r*p;
+        p = 1./5040. + r*p;
+        p = 1./720. + r*p;
+      }
+      p = 1./120 + r*p;
+      p = 1./24 + r*p;
+      p = 1./6 + r*p;
+      p = 0.5 + r*p;
+      p = 1. + r*p;
+      p = 1. + r*p;
+      // 2^k, constructed from the low bits of t
+      return p*from_bits((to_bits(t) + 1023) << 52);
+    }
+
+    template<bool fast>
+    inline double log_kernel(double x) {
+      // x = 2^k m with sqrt(2)/2 <= m < sqrt(2)
+      // Subtracting the bits of sqrt(2)/2 leaves k in the upper 12 bits, cf. musl.
+      // Only logical shifts and no comparisons, which vectorizes with SSE2
+      uint64_t b = to_bits(x);
+      uint64_t tmp = b - 0x3fe6a09e667f3bcdULL;
+      double m = from_bits(b - (tmp & 0xfff0000000000000ULL));
+      double k = from_bits(0x4330000000000000ULL | (((tmp >> 52) + 2048) & 0xfff))
+        - (4503599627370496. + 2048.);
+      // log(m) = f - f^2/2 + s (f^2/2 + R(s^2)), f = m-1, s = f/(2+f), cf. fdlibm
+      double f = m - 1.;
+      double s = f/(2. + f);
+      double z = s*s, R;
+      if (fast) {
+        R = z*(2./3 + z*(2./5 + z*(2./7 + z*(2./9))));
+      } else {
+        double w = z*z;
+        R = w*(3.999999999940941908e-01 + w*(2.222219843214978396e-01
+              + w*1.531383769920937332e-01))
+          + z*(6.666666666666735130e-01 + w*(2.857142874366239149e-01
+              + w*(1.818357216161805012e-01 + w*1.479819860511658591e-01)));
+      }
+      double hfsq = 0.5*f*f;
+      return k*LN2_HI - ((hfsq - (s*(hfsq + R) + k*LN2_LO)) - f);
+    }
+
+    template<bool fast, bool cosine>
+    inline double sin_kernel(double x) {
+      // x = q pi/2 + r, |r| <= pi/4
+      double t = x*6.36619772367581382433e-01 + ROUND;
+      double q = t - ROUND;
+      double r = x - q*PIO2_1;
+      r -= q*PIO2_2;
+      r -= q*PIO2_3;
+      // cos(x) = sin(x + pi/2)
+      uint64_t iq = to_bits(t) + (cosine ? 1 : 0);
+      // Polynomials of fdlibm for sin and cos on [-pi/4, pi/4] (fast: truncated)
+      double z = r*r, ps, pc;
+      if (fast) {
+        ps = -1.98412698298579493134e-04 + z*2.75573137070700676789e-06;
+        pc = 2.48015872894767294178e-05 + z*-2.75573143513906633035e-07;
+      } else {
+        ps = -2.50507602534068634195e-08 + z*1.58969099521155010221e-10;
+        ps = 2.75573137070700676789e-06 + z*ps;
+        ps = -1.98412698298579493134e-04 + z*ps;
+        pc = 2.08757232129817482790e-09 + z*-1.13596475577881948265e-11;
+        pc = -2.75573143513906633035e-07 + z*pc;
+        pc = 2.48015872894767294178e-05 + z*pc;
+      }
+      ps = -1.66666666666666324348e-01 + z*(8.33333333332248946124e-03 + z*ps);
+      pc = 4.16666666666666019037e-02 + z*(-1.38888888888741095749e-03 + z*pc);
+      double s = r + r*z*ps;
+      double c = (1. - 0.5*z) + z*z*pc;
+      // Select and flip the sign with integer operations, which unlike conditional
+      // floating-point operations do not keep the compiler from vectorizing
+      uint64_t odd = 0 - (iq & 1);
+      return from_bits(((to_bits(c) & odd) | (to_bits(s) & ~odd)) ^ ((iq & 2) << 62));
+    }
+
+    // Arguments handled by the kernels
+    inline bool exp_range(double x) { return x >= -708. && x <= 709.;}
+    inline bool log_range(double x) { return x >= DBL_MIN && x <= DBL_MAX;}
+    inline bool sin_range(double x) { return x >= -1e5 && x <= 1e5;}
+
+    // libm, for the remaining arguments
+    inline double libm_exp(double x) { return std::exp(x);}
+    inline double libm_log(double x) { return std::log(x);}
+    inline double libm_sin(double x) { return std::sin(x);}
+    inline double libm_cos(double x) { return std::cos(x);}
+
+    template<double (*Kernel)(double), bool (*Range)(double), double (*Libm)(double)>
+    void vector_loop(const double* x, double* f, casadi_int n) {
+      double buf[BLOCK];
+      for (casadi_int i=0; i<n; i+=BLOCK) {
+        const double* xb = x + i;
+        casadi_int nb = std::min(BLOCK, n - i);
+        if (nb==BLOCK) {
+          // Constant trip count
+          for (casadi_int k=0; k<BLOCK; ++k) buf[k] = Kernel(xb[k]);
+        } else {
+          for (casadi_int k=0; k<nb; ++k) buf[k] = Kernel(xb[k]);
+        }
+        // Redo the arguments outside of the reduced range, rare in practice
+        casadi_int n_out = 0;
+        for (casadi_int k=0; k<nb; ++k) n_out += !Range(xb[k]);
+        if (n_out) {
+          for (casadi_int k=0; k<nb; ++k) {
+            if (!Range(xb[k])) buf[k] = Libm(xb[k]);
+          }
+        }
+        std::copy(buf, buf + nb, f + i);
+      }
+    }
+
+    template<bool fast>
+    bool vector_math_gen(unsigned char op, const double* x, double* f, casadi_int n) {
+      switch (op) {
+      case OP_SIN:
+        vector_loop<sin_kernel<fast, false>, sin_range, libm_sin>(x, f, n);
+        return true;
+      case OP_COS:
+        vector_loop<sin_kernel<fast, true>, sin_range, libm_cos>(x, f, n);
+        return true;
+      case OP_EXP:
+        vector_loop<exp_kernel<fast>, exp_range, libm_exp>(x, f, n);
+        return true;
+      case OP_LOG:
+        vector_loop<log_kernel<fast>, log_range, libm_log>(x, f, n);
+        return true;
+      default:
+        return false;
+      }
+    }
+  } // namespace
+
+  bool vector_math(unsigned char op, const double* x, double* f, casadi_int n, bool fast) {
+    return fast ? vector_math_gen<true>(op, x, f, n) : vector_math_gen<false>(op, x, f, n);
+  }
+
+} // namespace casadi
@@ -0,0 +1,58 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#ifndef CASADI_VECTOR_MATH_HPP
+#define CASADI_VECTOR_MATH_HPP
+
+#include "casadi_common.hpp"
+
+/// \cond INTERNAL
+
+namespace casadi {
+
+  /** \brief Elementwise sin, cos, exp or log of n values with vectorizable kernels
+
+      The kernels reduce the argument (Cody-Waite with the constants of fdlibm)
+      and evaluate a polynomial, without branches or library calls, so that the
+      loops over the values can be vectorized by the compiler. Arguments outside
+      the reduced range are passed on to libm: |x|>1e5 for sin and cos, results
+      that would be subnormal or overflow for exp, zero, negative and non-normal
+      arguments for log, and NaN. f may alias x.
+
+      Accuracy, measured against libm over the reduced range:
+      - accurate: relative error below 2 ulp (4e-16), with the exception of sin and
+        cos close to their zeros, where the absolute error is below 1e-16 |x|/1e5
+      - fast: shorter polynomials with a relative error below 1e-9
+
+      Returns false, without touching f, if op is not one of OP_SIN, OP_COS, OP_EXP, OP_LOG.
+  */
+  CASADI_EXPORT bool vector_math(unsigned char op, const double* x, double* f,
+                                 casadi_int n, bool fast);
+
+} // namespace casadi
+
+/// \endcond
+
+#endif // CASADI_VECTOR_MATH_HPP
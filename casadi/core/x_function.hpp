@@ -27,8 +27,11 @@
 #define CASADI_X_FUNCTION_HPP
 
 #include <stack>
+#include <chrono>
+#include <type_traits>
 #include "function_internal.hpp"
 #include "factory.hpp"
+#include "thread_pool.hpp"
 
 // To reuse variables we need to be able to sort by sparsity pattern
 #include <unordered_map>
@@ -44,6 +47,46 @@ throw CasadiException("Error in XFunction::" FNAME " for '" + this->name_ + "' "
 
 namespace casadi {
 
+  /** \brief Per-instruction statistics of a numerical evaluation,
+      cf. option "profile_instructions" of SXFunction and MXFunction */
+  struct CASADI_EXPORT InstructionProfile {
+    /// Number of executions of each entry
+    std::vector<casadi_int> n_call;
+    /// Accumulated wall time [s] of each entry
+    std::vector<double> t_wall;
+    /// Overhead of reading the clock [s], subtracted from each timing
+    double t_clock;
+    /// Instructions until the next sample, and state of the random number generator
+    casadi_int countdown;
+    unsigned long long seed;
+    /// Clear the statistics for n entries
+    void reset(casadi_int n) {
+      n_call.assign(n, 0);
+      t_wall.assign(n, 0);
+      countdown = 1;
+      seed = 1;
+      t_clock = 0;
+      for (casadi_int k=0; k<16; ++k) {
+        auto t0 = std::chrono::steady_clock::now();
+        double t = std::chrono::duration<double>(std::chrono::steady_clock::now()-t0).count();
+        if (k==0 || t<t_clock) t_clock = t;
+      }
+    }
+    /// Whether to time the next instruction, on average every n-th
+    bool sample(casadi_int n) {
+      if (--countdown>0) return false;
+      // Random interval in [1, 2n-1] avoids aliasing with periodic instruction sequences
+      seed = seed*6364136223846793005ULL + 1442695040888963407ULL;
+      countdown = 1 + static_cast<casadi_int>((seed >> 33) % (2*n-1));
+      return true;
+    }
+    /// Add a timing of entry k, started at t0
+    void toc(casadi_int k, std::chrono::steady_clock::time_point t0, double weight=1) {
+      double t = std::chrono::duration<double>(std::chrono::steady_clock::now()-t0).count();
+      if (t>t_clock) t_wall[k] += weight*(t-t_clock);
+    }
+  };
+
   /** \brief  Internal node class for the base class of SXFunction and MXFunction
       (lacks a public counterpart)
       The design of the class uses the curiously recurring template pattern (CRTP) idiom
@@ -62,7 +105,7 @@ namespace casadi {
               const std::vector<std::string>& name_out);
 
     /** \brief  Destructor */
-    ~XFunction() override {}
+    ~XFunction() override { clear_mem();}
 
     /** \brief  Initialize */
     void init(const Dict& opts) override;
@@ -192,8 +235,37 @@ namespace casadi {
     Sparsity get_sparsity_out(casadi_int i) override { return out_.at(i).sparsity();}
     /// @}
 
+    /** \brief Create memory block, holding the instruction profile if enabled */
+    void* alloc_mem() const override {
+      return profile_instructions_ ? new InstructionProfile() : nullptr;
+    }
+
+    /** \brief Initalize memory block */
+    int init_mem(void* mem) const override {
+      if (mem) static_cast<InstructionProfile*>(mem)->reset(
+        static_cast<const DerivedType*>(this)->n_profile());
+      return 0;
+    }
+
+    /** \brief Free memory block */
+    void free_mem(void *mem) const override { delete static_cast<InstructionProfile*>(mem);}
+
+    /** \brief Add the estimated heap memory, including the instruction profiles */
+    void memory_usage(std::map<std::string, casadi_int>& usage,
+                      std::set<const void*>& visited) const override {
+      FunctionInternal::memory_usage(usage, visited);
+      if (!profile_instructions_) return;
+      for (casadi_int i=0; i<this->n_mem(); ++i) {
+        auto m = static_cast<const InstructionProfile*>(this->memory(i));
+        if (m) usage["memory"] += sizeof(*m) + memory_bytes(m->n_call) + memory_bytes(m->t_wall);
+      }
+    }
+
     // Data members (all public)
 
+    /// Record per-instruction statistics during numerical evaluation
+    bool profile_instructions_;
+
     /** \brief  Inputs of the function (needed for symbolic calculations) */
     std::vector<MatType> in_;
 
@@ -211,6 +283,7 @@ namespace casadi {
             const std::vector<std::string>& name_in,
             const std::vector<std::string>& name_out)
     : FunctionInternal(name), in_(ex_in),  out_(ex_out) {
+    profile_instructions_ = false;
     // Names of inputs
     if (!name_in.empty()) {
       casadi_assert(ex_in.size()==name_in.size(),
@@ -309,7 +382,10 @@ namespace casadi {
           allow_forward = op.second;
         } else if (op.first=="allow_reverse") {
           allow_reverse = op.second;
-        } else if (op.first=="verbose") {
+        } else if (op.first=="verbose" || op.first=="coloring_num_threads"
+                   || op.first=="ad_num_threads" || op.first=="ad_weight_timing"
+                   || op.first=="sparsity_cache") {
+          // Options of the helper function
           continue;
         } else {
           casadi_error("No such Jacobian option: " + string(op.first));
@@ -356,9 +432,6 @@ namespace casadi {
       // Evaluation result (known)
       std::vector<MatType> res(out_);
 
-      // Forward and adjoint seeds and sensitivities
-      std::vector<std::vector<MatType> > fseed, aseed, fsens, asens;
-
       // Get the sparsity of the Jacobian block
       Sparsity jsp = sparsity_jac(iind, oind, true, symmetric).T();
       const casadi_int* jsp_colind = jsp.colind();
@@ -403,25 +476,27 @@ namespace casadi {
                        + str(nadir) + " reverse directions");
       }
 
-      // Sparsity of the seeds
-      vector<casadi_int> seed_col, seed_row;
-
-      // Evaluate until everything has been determined
-      for (casadi_int s=0; s<nsweep; ++s) {
-        // Print progress
-        if (verbose_) {
-          casadi_int progress_new = (s*100)/nsweep;
-          // Print when entering a new decade
-          if (progress_new / 10 > progress / 10) {
-            progress = progress_new;
-            casadi_message(str(progress) + " %");
-          }
-        }
-
-        // Number of forward and adjoint directions in the current "batch"
+      // Number of sweeps evaluated at once, in parallel if more than one
+      casadi_int n_threads = std::is_same<MatType, SX>::value ? ad_num_threads_ : 1;
+      n_threads = std::max(casadi_int(1), std::min(n_threads, nsweep));
+
+      // Forward and adjoint seeds and sensitivities for each sweep of a block
+      std::vector<std::vector<std::vector<MatType> > > fseed_b, aseed_b, fsens_b, asens_b;
+
+      // Seeds and sensitivities of a sweep
+      auto init_sweep = [&](casadi_int s, std::vector<std::vector<MatType> >& fseed,
+                            std::vector<std::vector<MatType> >& aseed,
+                            std::vector<std::vector<MatType> >& fsens,
+                            std::vector<std::vector<MatType> >& asens) {
+        // Direction offsets and number of directions of the sweep
+        casadi_int offset_nfdir = std::min(s*max_nfdir, nfdir);
+        casadi_int offset_nadir = std::min(s*max_nadir, nadir);
         casadi_int nfdir_batch = std::min(nfdir - offset_nfdir, max_nfdir);
         casadi_int nadir_batch = std::min(nadir - offset_nadir, max_nadir);
 
+        // Sparsity of the seeds
+        vector<casadi_int> seed_col, seed_row;
+
         // Forward seeds
         fseed.resize(nfdir_batch);
         for (casadi_int d=0; d<nfdir_batch; ++d) {
@@ -501,20 +576,59 @@ namespace casadi {
             asens[d][ind] = MatType::zeros(sparsity_in_.at(ind));
           }
         }
+      };
+
+      // Evaluate until everything has been determined
+      for (casadi_int s=0; s<nsweep; ++s) {
+        // Print progress
+        if (verbose_) {
+          casadi_int progress_new = (s*100)/nsweep;
+          // Print when entering a new decade
+          if (progress_new / 10 > progress / 10) {
+            progress = progress_new;
+            casadi_message(str(progress) + " %");
+          }
+        }
+
+        // Number of forward and adjoint directions in the current "batch"
+        casadi_int nfdir_batch = std::min(nfdir - offset_nfdir, max_nfdir);
+        casadi_int nadir_batch = std::min(nadir - offset_nadir, max_nadir);
 
-        // Evaluate symbolically
-        if (fseed.size()>0) {
-          casadi_assert_dev(aseed.size()==0);
-          if (verbose_) casadi_message("Calling 'ad_forward'");
-          static_cast<const DerivedType*>(this)->ad_forward(fseed, fsens);
-          if (verbose_) casadi_message("Back from 'ad_forward'");
-        } else if (aseed.size()>0) {
-          casadi_assert_dev(fseed.size()==0);
-          if (verbose_) casadi_message("Calling 'ad_reverse'");
-          static_cast<const DerivedType*>(this)->ad_reverse(aseed, asens);
-          if (verbose_) casadi_message("Back from 'ad_reverse'");
+        // Evaluate a block of sweeps, the block size being the number of threads
+        casadi_int sb = s % n_threads;
+        if (sb==0) {
+          casadi_int nb = std::min(n_threads, nsweep-s);
+          fseed_b.resize(nb);
+          aseed_b.resize(nb);
+          fsens_b.resize(nb);
+          asens_b.resize(nb);
+          for (casadi_int k=0; k<nb; ++k) {
+            init_sweep(s+k, fseed_b[k], aseed_b[k], fsens_b[k], asens_b[k]);
+          }
+          // Symbolic evaluation, creating new expression nodes in parallel
+          ThreadPool::run(nb, n_threads, [&](casadi_int k, casadi_int t) {
+            const std::vector<std::vector<MatType> >& fseed = fseed_b[k];
+            const std::vector<std::vector<MatType> >& aseed = aseed_b[k];
+            std::vector<std::vector<MatType> >& fsens = fsens_b[k];
+            std::vector<std::vector<MatType> >& asens = asens_b[k];
+            if (fseed.size()>0) {
+              casadi_assert_dev(aseed.size()==0);
+              if (verbose_) casadi_message("Calling 'ad_forward'");
+              static_cast<const DerivedType*>(this)->ad_forward(fseed, fsens);
+              if (verbose_) casadi_message("Back from 'ad_forward'");
+            } else if (aseed.size()>0) {
+              casadi_assert_dev(fseed.size()==0);
+              if (verbose_) casadi_message("Calling 'ad_reverse'");
+              static_cast<const DerivedType*>(this)->ad_reverse(aseed, asens);
+              if (verbose_) casadi_message("Back from 'ad_reverse'");
+            }
+          });
         }
 
+        // Sensitivities of the current sweep
+        std::vector<std::vector<MatType> >& fsens = fsens_b[sb];
+        std::vector<std::vector<MatType> >& asens = asens_b[sb];
+
         // Carry out the forward sweeps
         for (casadi_int d=0; d<nfdir_batch; ++d) {
           // Skip if nothing to add
@@ -759,7 +873,11 @@ namespace casadi {
     try {
       // Temporary single-input, single-output function FIXME(@jaeandersson)
       Function tmp("tmp", {veccat(in_)}, {veccat(out_)},
-                   {{"ad_weight", ad_weight()}, {"ad_weight_sp", sp_weight()}});
+                   {{"ad_weight", ad_weight()}, {"ad_weight_sp", sp_weight()},
+                    {"coloring_num_threads", coloring_num_threads_},
+                    {"ad_num_threads", ad_num_threads_},
+                    {"ad_weight_timing", ad_weight_timing_},
+                    {"sparsity_cache", sparsity_cache_}});
 
       // Jacobian expression
       MatType J = tmp.get<DerivedType>()->jac(0, 0, Dict());
@@ -798,7 +916,11 @@ namespace casadi {
     try {
       // Temporary single-input, single-output function FIXME(@jaeandersson)
       Function tmp("tmp", {veccat(in_)}, {veccat(out_)},
-                   {{"ad_weight", ad_weight()}, {"ad_weight_sp", sp_weight()}});
+                   {{"ad_weight", ad_weight()}, {"ad_weight_sp", sp_weight()},
+                    {"coloring_num_threads", coloring_num_threads_},
+                    {"ad_num_threads", ad_num_threads_},
+                    {"ad_weight_timing", ad_weight_timing_},
+                    {"sparsity_cache", sparsity_cache_}});
 
       // Jacobian expression
       MatType J = tmp.get<DerivedType>()->jac(0, 0, Dict());
@@ -822,7 +944,9 @@ namespace casadi {
   ::get_jacobian_sparsity() const {
     // Temporary single-input, single-output function FIXME(@jaeandersson)
     Function tmp("tmp", {veccat(in_)}, {veccat(out_)},
-                 {{"ad_weight", ad_weight()}, {"ad_weight_sp", sp_weight()}});
+                 {{"ad_weight", ad_weight()}, {"ad_weight_sp", sp_weight()},
+                  {"coloring_num_threads", coloring_num_threads_},
+                  {"sparsity_cache", sparsity_cache_}});
     return tmp.sparsity_jac(0, 0);
   }
 
@@ -1008,7 +1132,7 @@ namespace casadi {
     if (it!=opts.end()) verbose = it->second;
 
     // Create an expression factory
-    Factory<MatType> f(aux, verbose);
+    Factory<MatType> f(aux, verbose, ad_num_threads_);
     for (casadi_int i=0; i<in_.size(); ++i) f.add_input(name_in_[i], in_[i]);
     for (casadi_int i=0; i<out_.size(); ++i) f.add_output(name_out_[i], out_[i]);
 
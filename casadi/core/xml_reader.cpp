@@ -0,0 +1,324 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#include "xml_reader.hpp"
+#include "binary_serializer.hpp"
+#include "casadi_misc.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+using namespace std;
+namespace casadi {
+
+  XmlReader::XmlReader(const std::string& filename)
+    : empty_(false), pending_(false), entered_empty_(false), depth_(0) {
+    buf_.reset(new BinaryBuffer(filename));
+    pos_ = buf_->data();
+    end_ = pos_ + buf_->size();
+  }
+
+  XmlReader::~XmlReader() {
+  }
+
+  uint64_t XmlReader::checksum() const {
+    uint64_t h = 14695981039346656037ULL;
+    for (const char* p=buf_->data(); p!=end_; ++p) {
+      h = (h ^ static_cast<unsigned char>(*p)) * 1099511628211ULL;
+    }
+    return h;
+  }
+
+  void XmlReader::error(const std::string& msg) const {
+    // Line number of the current position
+    casadi_int line = 1 + count(buf_->data(), pos_, '\n');
+    casadi_error("XML error on line " + str(line) + ": " + msg);
+  }
+
+  bool XmlReader::at(const char* s) const {
+    size_t n = strlen(s);
+    return static_cast<size_t>(end_-pos_) >= n && memcmp(pos_, s, n)==0;
+  }
+
+  void XmlReader::skip_past(const char* s) {
+    size_t n = strlen(s);
+    for (; static_cast<size_t>(end_-pos_) >= n; ++pos_) {
+      if (memcmp(pos_, s, n)==0) {
+        pos_ += n;
+        return;
+      }
+    }
+    error("Unexpected end of file, expected " + string(s));
+  }
+
+  void XmlReader::skip_misc() {
+    while (true) {
+      while (pos_!=end_ && isspace(static_cast<unsigned char>(*pos_))) pos_++;
+      if (at("<!--")) {
+        skip_past("-->");
+      } else if (at("<?")) {
+        skip_past("?>");
+      } else if (at("<!") && !at("<![CDATA[")) {
+        skip_past(">");
+      } else {
+        return;
+      }
+    }
+  }
+
+  void XmlReader::decode(const char* begin, const char* end, std::string& s) {
+    while (begin!=end) {
+      const char* amp = static_cast<const char*>(memchr(begin, '&', end-begin));
+      if (amp==nullptr) {
+        s.append(begin, end);
+        return;
+      }
+      s.append(begin, amp);
+      const char* semi = static_cast<const char*>(memchr(amp, ';', end-amp));
+      string ent = semi ? string(amp+1, semi) : string();
+      if (ent=="lt") {
+        s += '<';
+      } else if (ent=="gt") {
+        s += '>';
+      } else if (ent=="amp") {
+        s += '&';
+      } else if (ent=="quot") {
+        s += '"';
+      } else if (ent=="apos") {
+        s += '\'';
+      } else if (ent.size()>1 && ent[0]=='#') {
+        // Character reference, encoded as UTF-8
+        unsigned long c = ent[1]=='x' ? strtoul(ent.c_str()+2, nullptr, 16)
+                                      : strtoul(ent.c_str()+1, nullptr, 10);
+        if (c<0x80) {
+          s += static_cast<char>(c);
+        } else if (c<0x800) {
+          s += static_cast<char>(0xC0 | (c>>6));
+          s += static_cast<char>(0x80 | (c & 0x3F));
+        } else if (c<0x10000) {
+          s += static_cast<char>(0xE0 | (c>>12));
+          s += static_cast<char>(0x80 | ((c>>6) & 0x3F));
+          s += static_cast<char>(0x80 | (c & 0x3F));
+        } else {
+          s += static_cast<char>(0xF0 | (c>>18));
+          s += static_cast<char>(0x80 | ((c>>12) & 0x3F));
+          s += static_cast<char>(0x80 | ((c>>6) & 0x3F));
+          s += static_cast<char>(0x80 | (c & 0x3F));
+        }
+      } else {
+        // Not an entity, keep as is
+        s += '&';
+        begin = amp + 1;
+        continue;
+      }
+      begin = semi + 1;
+    }
+  }
+
+  bool XmlReader::read_start_tag(XmlNode& node) {
+    casadi_assert_dev(pos_!=end_ && *pos_=='<');
+    pos_++;
+
+    // Read the name
+    const char* name_begin = pos_;
+    while (pos_!=end_ && !isspace(static_cast<unsigned char>(*pos_))
+           && *pos_!='/' && *pos_!='>') pos_++;
+    if (pos_==name_begin) error("Element name expected");
+    node.name_.assign(name_begin, pos_);
+
+    // Read the attributes
+    while (true) {
+      while (pos_!=end_ && isspace(static_cast<unsigned char>(*pos_))) pos_++;
+      if (pos_==end_) error("Unexpected end of file in start tag");
+      if (*pos_=='>') {
+        pos_++;
+        return false;
+      }
+      if (at("/>")) {
+        pos_ += 2;
+        return true;
+      }
+      // Attribute name
+      const char* att_begin = pos_;
+      while (pos_!=end_ && *pos_!='=' && !isspace(static_cast<unsigned char>(*pos_))) pos_++;
+      string att(att_begin, pos_);
+      while (pos_!=end_ && isspace(static_cast<unsigned char>(*pos_))) pos_++;
+      if (pos_==end_ || *pos_!='=') error("'=' expected after attribute " + att);
+      pos_++;
+      while (pos_!=end_ && isspace(static_cast<unsigned char>(*pos_))) pos_++;
+      // Attribute value, in single or double quotes
+      if (pos_==end_ || (*pos_!='"' && *pos_!='\'')) error("Quoted value expected for " + att);
+      char quote = *pos_++;
+      const char* val_end = static_cast<const char*>(memchr(pos_, quote, end_-pos_));
+      if (val_end==nullptr) error("Unterminated value of attribute " + att);
+      string val;
+      decode(pos_, val_end, val);
+      node.attributes_[att] = val;
+      pos_ = val_end + 1;
+    }
+  }
+
+  void XmlReader::read_end_tag() {
+    casadi_assert_dev(at("</"));
+    skip_past(">");
+  }
+
+  void XmlReader::read_content(XmlNode& node) {
+    string text;
+    while (true) {
+      // Character data up to the next markup
+      const char* lt = static_cast<const char*>(memchr(pos_, '<', end_-pos_));
+      if (lt==nullptr) error("Unexpected end of file, expected </" + node.name_ + ">");
+      decode(pos_, lt, text);
+      pos_ = lt;
+      if (at("</")) {
+        read_end_tag();
+        break;
+      } else if (at("<!--")) {
+        const char* begin = pos_ + 4;
+        skip_past("-->");
+        node.comment_.assign(begin, pos_ - 3);
+      } else if (at("<![CDATA[")) {
+        const char* begin = pos_ + 9;
+        skip_past("]]>");
+        text.append(begin, pos_ - 3);
+      } else if (at("<?") || at("<!")) {
+        skip_misc();
+      } else {
+        // Child element
+        XmlNode child;
+        if (!read_start_tag(child)) read_content(child);
+        node.child_indices_[child.name_] = node.children_.size();
+        node.children_.push_back(child);
+      }
+    }
+
+    // Trimmed text
+    size_t first = text.find_first_not_of(" \t\r\n");
+    if (first!=string::npos) {
+      size_t last = text.find_last_not_of(" \t\r\n");
+      node.text_ = text.substr(first, last-first+1);
+    }
+  }
+
+  bool XmlReader::next() {
+    // Skip the current element, unless processed
+    if (pending_) skip();
+
+    // No children of an empty element
+    if (entered_empty_) {
+      entered_empty_ = false;
+      depth_--;
+      return false;
+    }
+
+    // Skip character data between elements
+    while (true) {
+      skip_misc();
+      if (pos_==end_) {
+        if (depth_>0) error("Unexpected end of file");
+        return false;
+      }
+      if (at("<![CDATA[")) {
+        skip_past("]]>");
+        continue;
+      }
+      if (*pos_=='<') break;
+      const char* lt = static_cast<const char*>(memchr(pos_, '<', end_-pos_));
+      pos_ = lt ? lt : end_;
+    }
+
+    // End of the parent
+    if (at("</")) {
+      if (depth_==0) error("Unexpected end tag");
+      read_end_tag();
+      depth_--;
+      return false;
+    }
+
+    // Start of the next element
+    head_ = XmlNode();
+    empty_ = read_start_tag(head_);
+    pending_ = true;
+    return true;
+  }
+
+  XmlNode XmlReader::read() {
+    casadi_assert(pending_, "No element to read");
+    pending_ = false;
+    XmlNode ret = head_;
+    if (!empty_) read_content(ret);
+    return ret;
+  }
+
+  void XmlReader::enter() {
+    casadi_assert(pending_, "No element to enter");
+    pending_ = false;
+    depth_++;
+    entered_empty_ = empty_;
+  }
+
+  void XmlReader::skip() {
+    casadi_assert(pending_, "No element to skip");
+    pending_ = false;
+    if (empty_) return;
+    // Find the matching end tag, without reading the contents
+    casadi_int depth = 1;
+    while (depth>0) {
+      const char* lt = static_cast<const char*>(memchr(pos_, '<', end_-pos_));
+      if (lt==nullptr) error("Unexpected end of file, expected </" + head_.name() + ">");
+      pos_ = lt;
+      if (at("</")) {
+        skip_past(">");
+        depth--;
+      } else if (at("<!--")) {
+        skip_past("-->");
+      } else if (at("<![CDATA[")) {
+        skip_past("]]>");
+      } else if (at("<?")) {
+        skip_past("?>");
+      } else if (at("<!")) {
+        skip_past(">");
+      } else {
+        // Start tag, may contain '>' in quoted attribute values
+        char quote = 0;
+        for (pos_++; pos_!=end_; ++pos_) {
+          if (quote) {
+            if (*pos_==quote) quote = 0;
+          } else if (*pos_=='"' || *pos_=='\'') {
+            quote = *pos_;
+          } else if (*pos_=='>') {
+            break;
+          }
+        }
+        if (pos_==end_) error("Unexpected end of file in start tag");
+        if (*(pos_-1)!='/') depth++;
+        pos_++;
+      }
+    }
+  }
+
+} // namespace casadi
@@ -0,0 +1,128 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#ifndef CASADI_XML_READER_HPP
+#define CASADI_XML_READER_HPP
+
+#include "xml_node.hpp"
+#include <memory>
+
+/// \cond INTERNAL
+
+namespace casadi {
+
+  // Forward declaration
+  class BinaryBuffer;
+
+  /** \brief Streaming reader of XML files
+
+  Visits the elements of a memory-mapped file one level at a time, without building
+  a tree for the whole document. Elements are read into an XmlNode, entered to visit
+  their children, or skipped.
+  \code
+  XmlReader xml(filename);
+  xml.next();   // Root element
+  xml.enter();
+  while (xml.next()) {
+    if (xml.name()=="ModelVariables") {
+      xml.enter();
+      while (xml.next()) process(xml.read());
+    }
+  }
+  \endcode
+  An element that is neither read nor entered is skipped by the next call to next.
+  Comments, processing instructions and document type declarations are ignored.
+  Text is trimmed and the predefined and numeric entities are decoded.
+  */
+  class CASADI_EXPORT XmlReader {
+  public:
+    /// Map a file
+    explicit XmlReader(const std::string& filename);
+
+    /// Destructor
+    ~XmlReader();
+
+    /// Move to the next element with the current parent, false after the last
+    bool next();
+
+    /// Name and attributes of the current element, without children
+    const XmlNode& head() const { return head_;}
+
+    /// Name of the current element
+    const std::string& name() const { return head_.name();}
+
+    /// Read the current element, with its children
+    XmlNode read();
+
+    /// Skip the current element
+    void skip();
+
+    /// Visit the children of the current element with next
+    void enter();
+
+    /// Checksum of the file contents, 64-bit FNV-1a
+    uint64_t checksum() const;
+
+  private:
+    // Throw an error at the current position
+    void error(const std::string& msg) const;
+    // Does the remaining input start with a string?
+    bool at(const char* s) const;
+    // Move past the next occurrence of a string
+    void skip_past(const char* s);
+    // Skip whitespace, comments, processing instructions and declarations
+    void skip_misc();
+    // Read a start tag, returns true if the element is empty
+    bool read_start_tag(XmlNode& node);
+    // Read an end tag
+    void read_end_tag();
+    // Read the children and the text of a node, up to and including its end tag
+    void read_content(XmlNode& node);
+    // Decode entities and add to a string
+    static void decode(const char* begin, const char* end, std::string& s);
+
+    // File contents
+    std::unique_ptr<BinaryBuffer> buf_;
+    // Current position and end of the file
+    const char* pos_;
+    const char* end_;
+    // Current element
+    XmlNode head_;
+    // Is the current element empty, i.e. <name/>?
+    bool empty_;
+    // Has the current element not yet been read, skipped or entered?
+    bool pending_;
+    // Has an empty element been entered?
+    bool entered_empty_;
+    // Number of elements entered
+    casadi_int depth_;
+  };
+
+} // namespace casadi
+
+/// \endcond
+
+#endif // CASADI_XML_READER_HPP
@@ -601,18 +601,32 @@ namespace casadi {
     // Reset the SQP metod
     reset_sqp(m);
 
-    // Free existing memory, if any
-    if (m->qp) delete m->qp;
-    m->qp = nullptr;
-    if (schur_) {
-      m->qp = new qpOASES::SQProblemSchur(nx_, ng_, qpOASES::HST_UNKNOWN, 50,
-                                          m->qpoases_mem,
-                                          QpoasesInterface::qpoases_init,
-                                          QpoasesInterface::qpoases_sfact,
-                                          QpoasesInterface::qpoases_nfact,
-                                          QpoasesInterface::qpoases_solve);
+    // Keep the QP solver and the Hessian approximation of the previous call?
+    bool warm = warm_start_ && m->warm && m->qp;
+    if (warm) {
+      const double* h = get_ptr(m->ws_hess);
+      for (casadi_int b=0; b<nblocks_; b++) {
+        casadi_copy(h, dim_[b]*dim_[b], m->hess1[b]);
+        h += dim_[b]*dim_[b];
+        if (m->hess2) {
+          casadi_copy(h, dim_[b]*dim_[b], m->hess2[b]);
+          h += dim_[b]*dim_[b];
+        }
+      }
     } else {
-      m->qp = new qpOASES::SQProblem(nx_, ng_);
+      // Free existing memory, if any
+      if (m->qp) delete m->qp;
+      m->qp = nullptr;
+      if (schur_) {
+        m->qp = new qpOASES::SQProblemSchur(nx_, ng_, qpOASES::HST_UNKNOWN, 50,
+                                            m->qpoases_mem,
+                                            QpoasesInterface::qpoases_init,
+                                            QpoasesInterface::qpoases_sfact,
+                                            QpoasesInterface::qpoases_nfact,
+                                            QpoasesInterface::qpoases_solve);
+      } else {
+        m->qp = new qpOASES::SQProblem(nx_, ng_);
+      }
     }
 
     // Print header and information about the algorithmic parameters
@@ -634,10 +648,22 @@ namespace casadi {
     casadi_copy(m->lam_xk, nx_, m->lam_qp);
     casadi_copy(m->lam_gk, ng_, m->lam_qp+nx_);
 
-    ret = run(m, max_iter_, warmstart_);
+    ret = run(m, max_iter_, warmstart_, warm);
 
     m->success = ret==0;
 
+    // Keep the Hessian approximation for the next call
+    if (warm_start_) {
+      m->ws_hess.clear();
+      for (casadi_int b=0; b<nblocks_; b++) {
+        m->ws_hess.insert(m->ws_hess.end(), m->hess1[b], m->hess1[b]+dim_[b]*dim_[b]);
+        if (m->hess2) {
+          m->ws_hess.insert(m->ws_hess.end(), m->hess2[b], m->hess2[b]+dim_[b]*dim_[b]);
+        }
+      }
+      m->warm = true;
+    }
+
     if (ret==1) print("***WARNING: Maximum number of iterations reached\n");
 
     // Get optimal cost
@@ -655,7 +681,8 @@ namespace casadi {
     return 0;
   }
 
-  casadi_int Blocksqp::run(BlocksqpMemory* m, casadi_int maxIt, casadi_int warmStart) const {
+  casadi_int Blocksqp::run(BlocksqpMemory* m, casadi_int maxIt, casadi_int warmStart,
+                           bool keep_hessian) const {
     casadi_int it, infoQP = 0;
     bool skipLineSearch = false;
     bool hasConverged = false;
@@ -663,8 +690,8 @@ namespace casadi {
     if (warmStart == 0 || m->itCount == 0) {
       // SQP iteration 0
 
-      /// Set initial Hessian approximation
-      calcInitialHessian(m);
+      /// Set initial Hessian approximation, unless kept from the previous call
+      if (!keep_hessian) calcInitialHessian(m);
 
       /// Evaluate all functions and gradients for xk_0
       (void)evaluate(m, &m->obj, m->gk, m->grad_fk, m->jac_g);
@@ -100,6 +100,7 @@ namespace casadi {
     double **hess;  // [blockwise] pointer to current Hessian of the Lagrangian
     double **hess1;  // [blockwise] first Hessian approximation
     double **hess2;  // [blockwise] second Hessian approximation (convexified)
+    std::vector<double> ws_hess;  // Hessian approximations (all blocks) kept for warm starting
     double *hess_lag;  // nonzero elements of Hessian (length)
     int *hessIndRow;  // row indices (length)
     int *hessIndCol;  // indices to first entry of columns (nCols+1)
@@ -153,6 +154,9 @@ namespace casadi {
     // Get name of the class
     std::string class_name() const override { return "Blocksqp";}
 
+    /// Not reentrant: qpOASES reports errors through a global message handler
+    bool is_reentrant() const override { return false;}
+
     /** \brief  Create a new NLP Solver */
     static Nlpsol* creator(const std::string& name, const Function& nlp) {
       return new Blocksqp(name, nlp);
@@ -196,7 +200,8 @@ namespace casadi {
     Sparsity Asp_, Hsp_;
 
     /// Main Loop of SQP method
-    casadi_int run(BlocksqpMemory* m, casadi_int maxIt, casadi_int warmStart = 0) const;
+    casadi_int run(BlocksqpMemory* m, casadi_int maxIt, casadi_int warmStart = 0,
+                   bool keep_hessian = false) const;
     /// Compute gradient of Lagrangian function (sparse version)
     void calcLagrangeGradient(BlocksqpMemory* m,
       const double* lam_x, const double* lam_g,
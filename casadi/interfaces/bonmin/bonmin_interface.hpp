@@ -109,6 +109,9 @@ namespace casadi {
     // Get name of the class
     std::string class_name() const override { return "BonminInterface";}
 
+    /// Not reentrant: builds on Ipopt and Cbc, with global state in the linear solvers
+    bool is_reentrant() const override { return false;}
+
     /** \brief  Create a new NLP Solver */
     static Nlpsol* creator(const std::string& name, const Function& nlp) {
       return new BonminInterface(name, nlp);
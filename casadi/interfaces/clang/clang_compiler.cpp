@@ -27,6 +27,18 @@
 #include "casadi/core/casadi_misc.hpp"
 #include "casadi/core/casadi_meta.hpp"
 #include <fstream>
+#include <chrono>
+
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/ADT/StringMap.h>
+
+#ifdef CASADI_WITH_THREAD
+#ifdef CASADI_WITH_THREAD_MINGW
+#include <mingw.mutex.h>
+#else // CASADI_WITH_THREAD_MINGW
+#include <mutex>
+#endif // CASADI_WITH_THREAD_MINGW
+#endif // CASADI_WITH_THREAD
 
 // To be able to get the plugin path
 #ifdef _WIN32 // also for 64-bit
@@ -56,6 +68,80 @@ namespace casadi {
     ImporterInternal::registerPlugin(casadi_register_importer_clang);
   }
 
+#if LLVM_VERSION_MAJOR>=4
+  namespace {
+    /// Objects generated by the JIT, shared by all instances, cf. option "cache"
+    class JitObjectCache : public llvm::ObjectCache {
+    public:
+      /// Is there an object for a module compiled from the source key?
+      bool has(const std::string& id, const std::string& key) {
+#ifdef CASADI_WITH_THREAD
+        std::lock_guard<std::mutex> lock(mtx_);
+#endif // CASADI_WITH_THREAD
+        auto it = entries_.find(id);
+        if (it==entries_.end()) return false;
+        if (it->second.key==key && it->second.obj) return true;
+        // Colliding hash: replaced by the next compilation
+        entries_.erase(it);
+        return false;
+      }
+
+      /// Store the object of a module that is about to be compiled
+      void expect(const std::string& id, const std::string& key) {
+#ifdef CASADI_WITH_THREAD
+        std::lock_guard<std::mutex> lock(mtx_);
+#endif // CASADI_WITH_THREAD
+        entries_[id].key = key;
+      }
+
+      /// Number of objects
+      casadi_int size() {
+#ifdef CASADI_WITH_THREAD
+        std::lock_guard<std::mutex> lock(mtx_);
+#endif // CASADI_WITH_THREAD
+        return entries_.size();
+      }
+
+      void notifyObjectCompiled(const llvm::Module* m, llvm::MemoryBufferRef obj) override {
+#ifdef CASADI_WITH_THREAD
+        std::lock_guard<std::mutex> lock(mtx_);
+#endif // CASADI_WITH_THREAD
+        auto it = entries_.find(m->getModuleIdentifier());
+        if (it==entries_.end()) return;
+        it->second.obj = llvm::MemoryBuffer::getMemBufferCopy(obj.getBuffer(),
+                                                              obj.getBufferIdentifier());
+      }
+
+      std::unique_ptr<llvm::MemoryBuffer> getObject(const llvm::Module* m) override {
+#ifdef CASADI_WITH_THREAD
+        std::lock_guard<std::mutex> lock(mtx_);
+#endif // CASADI_WITH_THREAD
+        auto it = entries_.find(m->getModuleIdentifier());
+        if (it==entries_.end() || !it->second.obj) return nullptr;
+        return llvm::MemoryBuffer::getMemBufferCopy(it->second.obj->getBuffer(),
+                                                    it->second.obj->getBufferIdentifier());
+      }
+
+    private:
+      struct Entry {
+        // Source code, flags and compiler version
+        std::string key;
+        // Generated object, if any
+        std::unique_ptr<llvm::MemoryBuffer> obj;
+      };
+      std::map<std::string, Entry> entries_;
+#ifdef CASADI_WITH_THREAD
+      std::mutex mtx_;
+#endif // CASADI_WITH_THREAD
+    };
+
+    JitObjectCache& jit_cache() {
+      static JitObjectCache instance;
+      return instance;
+    }
+  } // namespace
+#endif // LLVM_VERSION_MAJOR>=4
+
   ClangCompiler::ClangCompiler(const std::string& name) :
     ImporterInternal(name) {
 
@@ -63,6 +149,9 @@ namespace casadi {
     executionEngine_ = nullptr;
     context_ = nullptr;
     act_ = nullptr;
+    module_ = nullptr;
+    t_frontend_ = t_codegen_ = 0;
+    cache_hit_ = false;
   }
 
   ClangCompiler::~ClangCompiler() {
@@ -80,7 +169,22 @@ namespace casadi {
         "The include directory shipped with CasADi will be automatically appended."}},
       {"flags",
        {OT_STRINGVECTOR,
-        "Compile flags for the JIT compiler. Default: None"}}
+        "Compile flags for the JIT compiler. Default: None"}},
+      {"optimization_level",
+       {OT_INT,
+        "Optimization level (0-3) of both the frontend and the code generation. "
+        "Default: -1, as given by the flags"}},
+      {"target_cpu",
+       {OT_STRING,
+        "CPU to generate code for, \"native\" for the host CPU including all of its "
+        "features (cf. -march=native). Default: generic"}},
+      {"vectorize",
+       {OT_BOOL,
+        "Vectorize loops and straight-line code. Default: false"}},
+      {"cache",
+       {OT_BOOL,
+        "Reuse the object generated for the same source code and options, kept in memory "
+        "for the lifetime of the process and shared by all instances. Default: true"}}
      }
   };
 
@@ -88,21 +192,153 @@ namespace casadi {
     // Base class
     ImporterInternal::init(opts);
 
+    // Default options
+    optimization_level_ = -1;
+    vectorize_ = false;
+    cache_ = true;
+
     // Read options
     for (auto&& op : opts) {
       if (op.first=="include_path") {
         include_path_ = op.second.to_string();
       } else if (op.first=="flags") {
         flags_ = op.second;
+      } else if (op.first=="optimization_level") {
+        optimization_level_ = op.second;
+      } else if (op.first=="target_cpu") {
+        target_cpu_ = op.second.to_string();
+      } else if (op.first=="vectorize") {
+        vectorize_ = op.second;
+      } else if (op.first=="cache") {
+        cache_ = op.second;
       }
     }
+    casadi_assert(optimization_level_>=-1 && optimization_level_<=3,
+                  "Option 'optimization_level' must be in the range 0-3");
+#if LLVM_VERSION_MAJOR<4
+    cache_ = false;
+#endif // LLVM_VERSION_MAJOR<4
+
+    // Flags passed to the frontend after the user flags
+    vector<string> extra_flags;
+    if (optimization_level_>=0) extra_flags.push_back("-O" + str(optimization_level_));
+    if (vectorize_) {
+      extra_flags.push_back("-vectorize-loops");
+      extra_flags.push_back("-vectorize-slp");
+    }
+
+    // Target CPU and its features
+    string cpu = target_cpu_;
+    vector<string> features;
+    if (cpu=="native") {
+      cpu = llvm::sys::getHostCPUName().str();
+      llvm::StringMap<bool> host_features;
+      if (llvm::sys::getHostCPUFeatures(host_features)) {
+        for (auto&& f : host_features) {
+          features.push_back((f.second ? "+" : "-") + f.first().str());
+        }
+      }
+    }
+    if (!cpu.empty()) {
+      extra_flags.push_back("-target-cpu");
+      extra_flags.push_back(cpu);
+    }
+    for (auto&& f : features) {
+      extra_flags.push_back("-target-feature");
+      extra_flags.push_back(f);
+    }
 
     // Arguments to pass to the clang frontend
     vector<const char *> args(1, name_.c_str());
     for (auto&& f : flags_) {
       args.push_back(f.c_str());
     }
+    for (auto&& f : extra_flags) {
+      args.push_back(f.c_str());
+    }
+
+    // Look for an object generated from the same source and arguments
+    auto t0 = std::chrono::steady_clock::now();
+    cache_hit_ = false;
+    string cache_id, cache_key;
+    if (cache_) {
+      ifstream source(name_, ios::binary);
+      stringstream ss;
+      ss << source.rdbuf();
+      if (source) {
+        cache_key = CLANG_VERSION_STRING;
+        cache_key += '\0' + include_path_;
+        for (const char* a : args) cache_key += '\0' + string(a);
+        cache_key += '\0' + ss.str();
+        cache_id = "casadi_jit_" + str(std::hash<string>()(cache_key));
+#if LLVM_VERSION_MAJOR>=4
+        cache_hit_ = jit_cache().has(cache_id, cache_key);
+#endif // LLVM_VERSION_MAJOR>=4
+      }
+    }
+
+    // Create an LLVM context (NOTE: should use a static context instead?)
+    context_ = new llvm::LLVMContext();
+
+    // Module to be compiled, empty if the object is cached
+#if LLVM_VERSION_MAJOR>=4 || (LLVM_VERSION_MAJOR==3 && LLVM_VERSION_MINOR>=5)
+    std::unique_ptr<llvm::Module> module;
+#else
+    llvm::Module* module = nullptr;
+#endif
+    if (cache_hit_) {
+#if LLVM_VERSION_MAJOR>=4
+      module.reset(new llvm::Module(cache_id, *context_));
+#endif // LLVM_VERSION_MAJOR>=4
+    } else {
+      module = compile_module(args);
+#if LLVM_VERSION_MAJOR>=4
+      if (!cache_id.empty()) {
+        module->setModuleIdentifier(cache_id);
+        jit_cache().expect(cache_id, cache_key);
+      }
+#endif // LLVM_VERSION_MAJOR>=4
+    }
+    module_ = &*module;
+    auto t1 = std::chrono::steady_clock::now();
+    t_frontend_ = std::chrono::duration<double>(t1-t0).count();
+
+    llvm::InitializeNativeTarget();
+    llvm::InitializeNativeTargetAsmPrinter();
+
+    // Create the JIT.  This takes ownership of the module.
+    std::string ErrStr;
+    llvm::EngineBuilder builder(std::move(module));
+    builder.setEngineKind(llvm::EngineKind::JIT).setErrorStr(&ErrStr);
+    if (optimization_level_>=0) {
+      static const llvm::CodeGenOpt::Level levels[] = {llvm::CodeGenOpt::None,
+        llvm::CodeGenOpt::Less, llvm::CodeGenOpt::Default, llvm::CodeGenOpt::Aggressive};
+      builder.setOptLevel(levels[optimization_level_]);
+    }
+    if (!cpu.empty()) builder.setMCPU(cpu);
+    if (!features.empty()) builder.setMAttrs(features);
+    executionEngine_ = builder.create();
+    if (!executionEngine_) {
+      casadi_error("Could not create ExecutionEngine: " + ErrStr);
+    }
+#if LLVM_VERSION_MAJOR>=4
+    if (cache_) executionEngine_->setObjectCache(&jit_cache());
+#endif // LLVM_VERSION_MAJOR>=4
 
+    executionEngine_->finalizeObject();
+    t_codegen_ = std::chrono::duration<double>(std::chrono::steady_clock::now()-t1).count();
+    if (verbose_) {
+      casadi_message("Compiled " + name_ + (cache_hit_ ? " (cached)" : "") + ": frontend "
+                     + str(t_frontend_) + " s, code generation " + str(t_codegen_) + " s");
+    }
+  }
+
+#if LLVM_VERSION_MAJOR>=4 || (LLVM_VERSION_MAJOR==3 && LLVM_VERSION_MINOR>=5)
+  std::unique_ptr<llvm::Module>
+#else
+  llvm::Module*
+#endif
+  ClangCompiler::compile_module(const std::vector<const char*>& args) {
     // Create the compiler instance
     clang::CompilerInstance compInst;
 
@@ -206,45 +442,39 @@ namespace casadi {
       compInst.getHeaderSearchOpts().AddPath(path.c_str(), clang::frontend::System, false, false);
     }
 
-    // Create an LLVM context (NOTE: should use a static context instead?)
-    context_ = new llvm::LLVMContext();
-
     // Create an action and make the compiler instance carry it out
     act_ = new clang::EmitLLVMOnlyAction(context_);
     if (!compInst.ExecuteAction(*act_))
       casadi_error("Cannot execute action");
 
     // Grab the module built by the EmitLLVMOnlyAction
-    #if LLVM_VERSION_MAJOR>=4 || (LLVM_VERSION_MAJOR==3 && LLVM_VERSION_MINOR>=5)
-    std::unique_ptr<llvm::Module> module = act_->takeModule();
-    module_ = module.get();
-    #else
-    llvm::Module* module = act_->takeModule();
-    module_ = module;
-    #endif
-
-    llvm::InitializeNativeTarget();
-    llvm::InitializeNativeTargetAsmPrinter();
-
-    // Create the JIT.  This takes ownership of the module.
-    std::string ErrStr;
-    executionEngine_ =
-      llvm::EngineBuilder(std::move(module)).setEngineKind(llvm::EngineKind::JIT)
-      .setErrorStr(&ErrStr).create();
-    if (!executionEngine_) {
-      casadi_error("Could not create ExecutionEngine: " + ErrStr);
-    }
-
-    executionEngine_->finalizeObject();
+    return act_->takeModule();
   }
 
   signal_t ClangCompiler::get_function(const std::string& symname) {
+#if LLVM_VERSION_MAJOR>=4
+    // Also for modules whose object was taken from the cache
+    uint64_t addr = executionEngine_->getFunctionAddress(symname);
+    return reinterpret_cast<signal_t>(static_cast<uintptr_t>(addr));
+#else // LLVM_VERSION_MAJOR>=4
     llvm::Function* f = module_->getFunction(symname);
     if (f) {
       return reinterpret_cast<signal_t>(executionEngine_->getPointerToFunction(f));
     } else {
       return nullptr;
     }
+#endif // LLVM_VERSION_MAJOR>=4
+  }
+
+  Dict ClangCompiler::get_stats() const {
+    Dict stats;
+    stats["t_frontend"] = t_frontend_;
+    stats["t_codegen"] = t_codegen_;
+    stats["cache_hit"] = cache_hit_;
+#if LLVM_VERSION_MAJOR>=4
+    if (cache_) stats["n_cached"] = jit_cache().size();
+#endif // LLVM_VERSION_MAJOR>=4
+    return stats;
   }
 
   std::vector<std::pair<std::string, bool> > ClangCompiler::
@@ -43,6 +43,7 @@
 
 #include <llvm/ADT/SmallString.h>
 #include <llvm/ExecutionEngine/ExecutionEngine.h>
+#include <llvm/ExecutionEngine/ObjectCache.h>
 #if (LLVM_VERSION_MAJOR>=4) || (LLVM_VERSION_MAJOR==3 && LLVM_VERSION_MINOR>=5)
 #include <llvm/ExecutionEngine/MCJIT.h>
 #else
@@ -112,6 +113,9 @@ namespace casadi {
     /// Get a function pointer for numerical evaluation
     signal_t get_function(const std::string& symname) override;
 
+    /// Get statistics of the compilation
+    Dict get_stats() const override;
+
     // Helper function for reading includes
     static std::vector<std::pair<std::string, bool> >
       getIncludes(const std::string& file, const std::string& path);
@@ -120,7 +124,33 @@ namespace casadi {
     std::string include_path_;
     std::vector<std::string> flags_;
 
+    /// Optimization level, -1 if given by the flags
+    casadi_int optimization_level_;
+
+    /// Target CPU, "native" for the host, empty for the default
+    std::string target_cpu_;
+
+    /// Vectorize loops and straight-line code
+    bool vectorize_;
+
+    /// Reuse objects compiled from the same source and flags
+    bool cache_;
+
+    /// Time spent in the frontend and in code generation [s]
+    double t_frontend_, t_codegen_;
+
+    /// Object taken from the cache
+    bool cache_hit_;
+
   protected:
+    /// Run the frontend, generating LLVM IR
+#if LLVM_VERSION_MAJOR>=4 || (LLVM_VERSION_MAJOR==3 && LLVM_VERSION_MINOR>=5)
+    std::unique_ptr<llvm::Module>
+#else
+    llvm::Module*
+#endif
+    compile_module(const std::vector<const char*>& args);
+
     clang::EmitLLVMOnlyAction* act_;
     llvm::ExecutionEngine* executionEngine_;
     llvm::LLVMContext* context_;
@@ -77,7 +77,12 @@ namespace casadi {
         "Detect redundant constraints."}},
       {"warm_start",
        {OT_BOOL,
-        "Use warm start with simplex methods (affects only the simplex methods)."}}
+        "Use warm start with simplex methods (affects only the simplex methods)."}},
+      {"incremental",
+       {OT_BOOL,
+        "Only pass the bounds, linear cost and constraint data that changed since the "
+        "previous call to the CPLEX problem object instead of reloading the problem. "
+        "The problem is reloaded when the Hessian changes [default: false]"}}
      }
   };
 
@@ -92,6 +97,7 @@ namespace casadi {
     tol_ = 1e-6;
     dep_check_ = 0;
     warm_start_ = false;
+    incremental_ = false;
 
     // Read options
     for (auto&& op : opts) {
@@ -109,6 +115,8 @@ namespace casadi {
         dep_check_ = op.second;
       } else if (op.first=="warm_start") {
         warm_start_ = op.second;
+      } else if (op.first=="incremental") {
+        incremental_ = op.second;
       }
     }
 
@@ -270,6 +278,15 @@ namespace casadi {
     copy_vector(H_.colind(), m->h_colind);
     copy_vector(H_.row(), m->h_row);
 
+    // Work vectors for incremental updates
+    if (incremental_) {
+      casadi_int sz = std::max(2*nx_, std::max(na_, A_.nnz()));
+      m->chg_ind.resize(sz);
+      m->chg_ind2.resize(A_.nnz());
+      m->chg_type.resize(sz);
+      m->chg_val.resize(sz);
+    }
+
     m->fstats["preprocessing"]  = FStats();
     m->fstats["solver"]         = FStats();
     m->fstats["postprocessing"] = FStats();
@@ -375,16 +392,38 @@ namespace casadi {
     const double* obj = g;
     const double* lb = lbx;
     const double* ub = ubx;
-    if (CPXXcopylp(m->env, m->lp, nx_, na_, m->objsen, obj, get_ptr(m->rhs), get_ptr(m->sense),
-                  matbeg, get_ptr(m->matcnt), matind, matval, lb, ub, get_ptr(m->rngval))) {
-      casadi_error("CPXXcopylp failed");
+
+    // Only pass the changes if the Hessian is unchanged
+    m->updated = incremental_ && m->is_loaded
+      && std::equal(H, H + nnz_in(CONIC_H), m->prev_h.begin());
+    m->is_loaded = false;
+    if (m->updated) {
+      update_prob(m, obj, lb, ub, matval);
+    } else {
+      if (CPXXcopylp(m->env, m->lp, nx_, na_, m->objsen, obj, get_ptr(m->rhs), get_ptr(m->sense),
+                    matbeg, get_ptr(m->matcnt), matind, matval, lb, ub, get_ptr(m->rngval))) {
+        casadi_error("CPXXcopylp failed");
+      }
+
+      // Preparing coefficient matrix Q
+      const CPXNNZ* qmatbeg = get_ptr(m->h_colind);
+      const CPXDIM* qmatind = get_ptr(m->h_row);
+      const double* qmatval = H;
+      if (CPXXcopyquad(m->env, m->lp, qmatbeg, get_ptr(m->qmatcnt), qmatind, qmatval)) {
+      }
     }
 
-    // Preparing coefficient matrix Q
-    const CPXNNZ* qmatbeg = get_ptr(m->h_colind);
-    const CPXDIM* qmatind = get_ptr(m->h_row);
-    const double* qmatval = H;
-    if (CPXXcopyquad(m->env, m->lp, qmatbeg, get_ptr(m->qmatcnt), qmatind, qmatval)) {
+    // Keep track of the loaded data
+    if (incremental_) {
+      m->prev_g.assign(g, g + nx_);
+      m->prev_lbx.assign(lbx, lbx + nx_);
+      m->prev_ubx.assign(ubx, ubx + nx_);
+      m->prev_h.assign(H, H + nnz_in(CONIC_H));
+      m->prev_a.assign(A, A + nnz_in(CONIC_A));
+      m->prev_sense = m->sense;
+      m->prev_rhs = m->rhs;
+      m->prev_rngval = m->rngval;
+      m->is_loaded = true;
     }
 
     if (dump_to_file_) {
@@ -528,13 +567,106 @@ namespace casadi {
     auto m = static_cast<CplexMemory*>(mem);
     stats["return_status"] = return_status_string(m->return_status);
     stats["success"] = m->success;
+    if (incremental_) stats["model_updated"] = m->updated;
     return stats;
   }
 
+  void CplexInterface::update_prob(CplexMemory* m, const double* g, const double* lbx,
+                                   const double* ubx, const double* A) const {
+    CPXDIM* ind = get_ptr(m->chg_ind);
+    char* type = get_ptr(m->chg_type);
+    double* val = get_ptr(m->chg_val);
+
+    // Variable bounds
+    CPXDIM n = 0;
+    for (casadi_int i=0; i<nx_; ++i) {
+      if (lbx[i]!=m->prev_lbx[i]) {
+        ind[n] = i;
+        type[n] = 'L';
+        val[n++] = lbx[i];
+      }
+      if (ubx[i]!=m->prev_ubx[i]) {
+        ind[n] = i;
+        type[n] = 'U';
+        val[n++] = ubx[i];
+      }
+    }
+    if (n>0 && CPXXchgbds(m->env, m->lp, n, ind, type, val)) {
+      casadi_error("CPXXchgbds failed");
+    }
+
+    // Linear cost
+    n = 0;
+    for (casadi_int i=0; i<nx_; ++i) {
+      if (g[i]!=m->prev_g[i]) {
+        ind[n] = i;
+        val[n++] = g[i];
+      }
+    }
+    if (n>0 && CPXXchgobj(m->env, m->lp, n, ind, val)) {
+      casadi_error("CPXXchgobj failed");
+    }
+
+    // Constraint senses
+    n = 0;
+    for (casadi_int i=0; i<na_; ++i) {
+      if (m->sense[i]!=m->prev_sense[i]) {
+        ind[n] = i;
+        type[n++] = m->sense[i];
+      }
+    }
+    if (n>0 && CPXXchgsense(m->env, m->lp, n, ind, type)) {
+      casadi_error("CPXXchgsense failed");
+    }
+
+    // Right-hand sides
+    n = 0;
+    for (casadi_int i=0; i<na_; ++i) {
+      if (m->rhs[i]!=m->prev_rhs[i]) {
+        ind[n] = i;
+        val[n++] = m->rhs[i];
+      }
+    }
+    if (n>0 && CPXXchgrhs(m->env, m->lp, n, ind, val)) {
+      casadi_error("CPXXchgrhs failed");
+    }
+
+    // Ranges
+    n = 0;
+    for (casadi_int i=0; i<na_; ++i) {
+      if (m->rngval[i]!=m->prev_rngval[i]) {
+        ind[n] = i;
+        val[n++] = m->rngval[i];
+      }
+    }
+    if (n>0 && CPXXchgrngval(m->env, m->lp, n, ind, val)) {
+      casadi_error("CPXXchgrngval failed");
+    }
+
+    // Constraint coefficients
+    CPXDIM* ind2 = get_ptr(m->chg_ind2);
+    const casadi_int *colind = A_.colind(), *row = A_.row();
+    CPXNNZ nnz = 0;
+    for (casadi_int c=0; c<A_.size2(); ++c) {
+      for (casadi_int k=colind[c]; k<colind[c+1]; ++k) {
+        if (A[k]!=m->prev_a[k]) {
+          ind[nnz] = row[k];
+          ind2[nnz] = c;
+          val[nnz++] = A[k];
+        }
+      }
+    }
+    if (nnz>0 && CPXXchgcoeflist(m->env, m->lp, nnz, ind, ind2, val)) {
+      casadi_error("CPXXchgcoeflist failed");
+    }
+  }
+
 
   CplexMemory::CplexMemory() {
     // Setting warm-start flag
     this->is_warm = false;
+    this->is_loaded = false;
+    this->updated = false;
 
     // Set pointer to zero to avoid deleting a nonexisting instance
     this->env = nullptr;
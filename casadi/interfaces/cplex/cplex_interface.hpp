@@ -81,6 +81,18 @@ namespace casadi {
     int return_status;
     bool success;
 
+    /// Problem data the CPLEX problem was last loaded with (with the 'incremental' option)
+    std::vector<double> prev_g, prev_lbx, prev_ubx, prev_h, prev_a, prev_rhs, prev_rngval;
+    std::vector<char> prev_sense;
+
+    /// Has the CPLEX problem been loaded, was it updated in place in the last call
+    bool is_loaded, updated;
+
+    /// Work vectors for incremental updates
+    std::vector<CPXDIM> chg_ind, chg_ind2;
+    std::vector<char> chg_type;
+    std::vector<double> chg_val;
+
     /// Constructor
     CplexMemory();
 
@@ -144,6 +156,10 @@ namespace casadi {
     /// Get all statistics
     Dict get_stats(void* mem) const override;
 
+    /// Update the loaded problem with the entries that changed since the last call
+    void update_prob(CplexMemory* m, const double* g, const double* lbx, const double* ubx,
+                     const double* A) const;
+
     /// All CPLEX options
     Dict opts_;
 
@@ -155,6 +171,7 @@ namespace casadi {
     double tol_;
     casadi_int dep_check_;
     bool warm_start_;
+    bool incremental_;
     ///@}
 
     // Are we solving a mixed-integer problem?
@@ -61,7 +61,13 @@ namespace casadi {
         "Type of variables: [CONTINUOUS|binary|integer|semicont|semiint]"}},
       {"gurobi",
        {OT_DICT,
-        "Options to be passed to gurobi."}}
+        "Options to be passed to gurobi."}},
+      {"incremental",
+       {OT_BOOL,
+        "Keep the Gurobi model between calls and only update bounds, linear cost, "
+        "right-hand sides and constraint coefficients that changed. The model is "
+        "rebuilt when the Hessian, the SOCP data or the types of variables or "
+        "constraints change [default: false]"}}
      }
   };
 
@@ -71,6 +77,7 @@ namespace casadi {
 
     // Default options
     std::vector<std::string> vtype;
+    incremental_ = false;
 
     // Read options
     for (auto&& op : opts) {
@@ -78,6 +85,8 @@ namespace casadi {
         vtype = op.second;
       } else if (op.first=="gurobi") {
         opts_ = op.second;
+      } else if (op.first=="incremental") {
+        incremental_ = op.second;
       }
     }
 
@@ -324,189 +333,193 @@ namespace casadi {
     int *ind=reinterpret_cast<int*>(iw); iw+=indval_size_;
     int *ind2=reinterpret_cast<int*>(iw); iw+=nx_;
 
-    // Greate an empty model
-    GRBmodel *model = nullptr;
+    // Reuse the persistent model if possible
+    GRBmodel *model = m->model;
+    m->model = nullptr;
+    m->updated = false;
     try {
-      casadi_int flag = GRBnewmodel(m->env, &model, name_.c_str(), 0,
-        nullptr, nullptr, nullptr, nullptr, nullptr);
-      casadi_assert(!flag, GRBgeterrormsg(m->env));
-
-      // Add variables
-      for (casadi_int i=0; i<nx_; ++i) {
-        // Get bounds
-        double lb = lbx ? lbx[i] : 0., ub = ubx ? ubx[i] : 0.;
-        if (isinf(lb)) lb = -GRB_INFINITY;
-        if (isinf(ub)) ub =  GRB_INFINITY;
-
-        // Get variable type
-        char vtype;
-        if (!vtype_.empty()) {
-          // Explicitly set 'vtype' takes precedence
-          vtype = vtype_.at(i);
-        } else if (!discrete_.empty() && discrete_.at(i)) {
-          // Variable marked as discrete (integer or binary)
-          vtype = lb==0 && ub==1 ? GRB_BINARY : GRB_INTEGER;
-        } else {
-          // Continious variable
-          vtype = GRB_CONTINUOUS;
+      casadi_int flag;
+      if (model) {
+        m->updated = update_model(m, arg, val);
+        if (!m->updated) {
+          GRBfreemodel(model);
+          model = nullptr;
         }
-
-        // Pass to model
-        flag = GRBaddvar(model, 0, nullptr, nullptr, g ? g[i] : 0., lb, ub, vtype, nullptr);
-        casadi_assert(!flag, GRBgeterrormsg(m->env));
       }
 
-      // Add helper variables for SOCP
-      for (casadi_int i=0;i<r_.size()-1;++i) {
-        for (casadi_int k=0;k<r_[i+1]-r_[i]-1;++k) {
-          flag = GRBaddvar(model, 0, nullptr, nullptr, 0, -GRB_INFINITY, GRB_INFINITY,
-                           GRB_CONTINUOUS, nullptr);
-          casadi_assert(!flag, GRBgeterrormsg(m->env));
-        }
-        flag = GRBaddvar(model, 0, nullptr, nullptr, 0, 0, GRB_INFINITY, GRB_CONTINUOUS, nullptr);
+      // Greate a new model
+      if (!model) {
+        flag = GRBnewmodel(m->env, &model, name_.c_str(), 0,
+          nullptr, nullptr, nullptr, nullptr, nullptr);
         casadi_assert(!flag, GRBgeterrormsg(m->env));
-      }
-
-      flag = GRBupdatemodel(model);
-      casadi_assert(!flag, GRBgeterrormsg(m->env));
 
-      // Add quadratic terms
-      const casadi_int *H_colind=H_.colind(), *H_row=H_.row();
-      for (int i=0; i<nx_; ++i) {
+        // Add variables
+        for (casadi_int i=0; i<nx_; ++i) {
+          // Get bounds
+          double lb = lbx ? lbx[i] : 0., ub = ubx ? ubx[i] : 0.;
+          if (isinf(lb)) lb = -GRB_INFINITY;
+          if (isinf(ub)) ub =  GRB_INFINITY;
 
-        // Quadratic term nonzero indices
-        casadi_int numqnz = H_colind[1]-H_colind[0];
-        for (casadi_int k=0;k<numqnz;++k) ind[k]=H_row[k];
-        H_colind++;
-        H_row += numqnz;
+          // Get variable type
+          char vtype = var_type(i, lb, ub);
 
-        // Corresponding column
-        casadi_fill(ind2, numqnz, i);
+          // Pass to model
+          flag = GRBaddvar(model, 0, nullptr, nullptr, g ? g[i] : 0., lb, ub, vtype, nullptr);
+          casadi_assert(!flag, GRBgeterrormsg(m->env));
+        }
 
-        // Quadratic term nonzeros
-        if (h) {
-          casadi_copy(h, numqnz, val);
-          casadi_scal(numqnz, 0.5, val);
-          h += numqnz;
-        } else {
-          casadi_fill(val, numqnz, 0.);
+        // Add helper variables for SOCP
+        for (casadi_int i=0;i<r_.size()-1;++i) {
+          for (casadi_int k=0;k<r_[i+1]-r_[i]-1;++k) {
+            flag = GRBaddvar(model, 0, nullptr, nullptr, 0, -GRB_INFINITY, GRB_INFINITY,
+                             GRB_CONTINUOUS, nullptr);
+            casadi_assert(!flag, GRBgeterrormsg(m->env));
+          }
+          flag = GRBaddvar(model, 0, nullptr, nullptr, 0, 0, GRB_INFINITY, GRB_CONTINUOUS, nullptr);
+          casadi_assert(!flag, GRBgeterrormsg(m->env));
         }
 
-        // Pass to model
-        flag = GRBaddqpterms(model, numqnz, ind, ind2, val);
+        flag = GRBupdatemodel(model);
         casadi_assert(!flag, GRBgeterrormsg(m->env));
-      }
 
-      // Add constraints
-      const casadi_int *AT_colind=AT_.colind(), *AT_row=AT_.row();
-      for (casadi_int i=0; i<na_; ++i) {
-        // Get bounds
-        double lb = lba ? lba[i] : 0., ub = uba ? uba[i] : 0.;
+        // Add quadratic terms
+        const casadi_int *H_colind=H_.colind(), *H_row=H_.row();
+        for (int i=0; i<nx_; ++i) {
+
+          // Quadratic term nonzero indices
+          casadi_int numqnz = H_colind[1]-H_colind[0];
+          for (casadi_int k=0;k<numqnz;++k) ind[k]=H_row[k];
+          H_colind++;
+          H_row += numqnz;
 
-        casadi_int numnz = 0;
-        // Loop over rows
-        for (casadi_int k=AT_colind[i]; k<AT_colind[i+1]; ++k) {
-          casadi_int j = AT_row[k];
+          // Corresponding column
+          casadi_fill(ind2, numqnz, i);
 
-          ind[numnz] = j;
-          val[numnz] = a ? a[A_mapping_[k]]  : 0;
+          // Quadratic term nonzeros
+          if (h) {
+            casadi_copy(h, numqnz, val);
+            casadi_scal(numqnz, 0.5, val);
+            h += numqnz;
+          } else {
+            casadi_fill(val, numqnz, 0.);
+          }
 
-          numnz++;
+          // Pass to model
+          flag = GRBaddqpterms(model, numqnz, ind, ind2, val);
+          casadi_assert(!flag, GRBgeterrormsg(m->env));
         }
 
-        // Pass to model
-        if (isinf(lb)) {
-          if (isinf(ub)) {
-            // Neither upper or lower bounds, skip
-          } else {
-            // Only upper bound
-            flag = GRBaddconstr(model, numnz, ind, val, GRB_LESS_EQUAL, ub, nullptr);
-            casadi_assert(!flag, GRBgeterrormsg(m->env));
+        // Add constraints
+        const casadi_int *AT_colind=AT_.colind(), *AT_row=AT_.row();
+        for (casadi_int i=0; i<na_; ++i) {
+          // Get bounds
+          double lb = lba ? lba[i] : 0., ub = uba ? uba[i] : 0.;
+
+          casadi_int numnz = 0;
+          // Loop over rows
+          for (casadi_int k=AT_colind[i]; k<AT_colind[i+1]; ++k) {
+            casadi_int j = AT_row[k];
+
+            ind[numnz] = j;
+            val[numnz] = a ? a[A_mapping_[k]]  : 0;
+
+            numnz++;
           }
-        } else {
-          if (isinf(ub)) {
-            // Only lower bound
-            flag = GRBaddconstr(model, numnz, ind, val, GRB_GREATER_EQUAL, lb, nullptr);
-            casadi_assert(!flag, GRBgeterrormsg(m->env));
-          } else if (lb==ub) {
-            // Upper and lower bounds equal
-            flag = GRBaddconstr(model, numnz, ind, val, GRB_EQUAL, lb, nullptr);
-            casadi_assert(!flag, GRBgeterrormsg(m->env));
+
+          // Pass to model
+          if (isinf(lb)) {
+            if (isinf(ub)) {
+              // Neither upper or lower bounds, skip
+            } else {
+              // Only upper bound
+              flag = GRBaddconstr(model, numnz, ind, val, GRB_LESS_EQUAL, ub, nullptr);
+              casadi_assert(!flag, GRBgeterrormsg(m->env));
+            }
           } else {
-            // Both upper and lower bounds
-            flag = GRBaddrangeconstr(model, numnz, ind, val, lb, ub, nullptr);
-            casadi_assert(!flag, GRBgeterrormsg(m->env));
+            if (isinf(ub)) {
+              // Only lower bound
+              flag = GRBaddconstr(model, numnz, ind, val, GRB_GREATER_EQUAL, lb, nullptr);
+              casadi_assert(!flag, GRBgeterrormsg(m->env));
+            } else if (lb==ub) {
+              // Upper and lower bounds equal
+              flag = GRBaddconstr(model, numnz, ind, val, GRB_EQUAL, lb, nullptr);
+              casadi_assert(!flag, GRBgeterrormsg(m->env));
+            } else {
+              // Both upper and lower bounds
+              flag = GRBaddrangeconstr(model, numnz, ind, val, lb, ub, nullptr);
+              casadi_assert(!flag, GRBgeterrormsg(m->env));
+            }
           }
         }
-      }
 
-      // SOCP helper constraints
-      const Sparsity& sp = map_Q_.sparsity();
-      const casadi_int* colind = sp.colind();
-      const casadi_int* row = sp.row();
-      const casadi_int* data = map_Q_.ptr();
+        // SOCP helper constraints
+        const Sparsity& sp = map_Q_.sparsity();
+        const casadi_int* colind = sp.colind();
+        const casadi_int* row = sp.row();
+        const casadi_int* data = map_Q_.ptr();
 
-      // Loop over columns
-      for (casadi_int i=0; i<sp.size2(); ++i) {
+        // Loop over columns
+        for (casadi_int i=0; i<sp.size2(); ++i) {
 
-        casadi_int numnz = 0;
-        // Loop over rows
-        for (casadi_int k=colind[i]; k<colind[i+1]; ++k) {
-          casadi_int j = row[k];
+          casadi_int numnz = 0;
+          // Loop over rows
+          for (casadi_int k=colind[i]; k<colind[i+1]; ++k) {
+            casadi_int j = row[k];
 
-          ind[numnz] = j;
-          val[numnz] = (q && j<nx_) ? q[data[k]] : -1;
+            ind[numnz] = j;
+            val[numnz] = (q && j<nx_) ? q[data[k]] : -1;
 
-          numnz++;
-        }
+            numnz++;
+          }
 
-        // Get bound
-        double bound = map_P_[i]==-1 ? 0 : -p[map_P_[i]];
+          // Get bound
+          double bound = map_P_[i]==-1 ? 0 : -p[map_P_[i]];
 
-        flag = GRBaddconstr(model, numnz, ind, val, GRB_EQUAL, bound, nullptr);
-        casadi_assert(!flag, GRBgeterrormsg(m->env));
-      }
+          flag = GRBaddconstr(model, numnz, ind, val, GRB_EQUAL, bound, nullptr);
+          casadi_assert(!flag, GRBgeterrormsg(m->env));
+        }
 
-      // Loop over blocks
-      for (casadi_int i=0; i<r_.size()-1; ++i) {
-        casadi_int block_size = r_[i+1]-r_[i];
+        // Loop over blocks
+        for (casadi_int i=0; i<r_.size()-1; ++i) {
+          casadi_int block_size = r_[i+1]-r_[i];
 
-        // Indicate x'x - y^2 <= 0
-        for (casadi_int j=0;j<block_size;++j) {
-          ind[j] = nx_ + r_[i] + j;
-          val[j] = j<block_size-1 ? 1 : -1;
-        }
+          // Indicate x'x - y^2 <= 0
+          for (casadi_int j=0;j<block_size;++j) {
+            ind[j] = nx_ + r_[i] + j;
+            val[j] = j<block_size-1 ? 1 : -1;
+          }
 
-        flag = GRBaddqconstr(model, 0, nullptr, nullptr,
-          block_size, ind, ind, val,
-          GRB_LESS_EQUAL, 0, nullptr);
-        casadi_assert(!flag, GRBgeterrormsg(m->env));
-      }
+          flag = GRBaddqconstr(model, 0, nullptr, nullptr,
+            block_size, ind, ind, val,
+            GRB_LESS_EQUAL, 0, nullptr);
+          casadi_assert(!flag, GRBgeterrormsg(m->env));
+        }
 
-      flag = 0;
-      for (auto && op : opts_) {
-        int ret = GRBgetparamtype(m->env, op.first.c_str());
-        switch (ret) {
-          case -1:
-            casadi_error("Parameter '" + op.first + "' unknown to Gurobi.");
-          case 1:
-            {
-              flag = GRBsetintparam(GRBgetenv(model), op.first.c_str(), op.second);
-              break;
-            }
-          case 2:
-              flag = GRBsetdblparam(GRBgetenv(model), op.first.c_str(), op.second);
-              break;
-          case 3:
-            {
-              std::string s = op.second;
-              flag = GRBsetstrparam(GRBgetenv(model), op.first.c_str(), s.c_str());
-              break;
-            }
-          default:
-            casadi_error("Not implememented : " + str(ret));
+        flag = 0;
+        for (auto && op : opts_) {
+          int ret = GRBgetparamtype(m->env, op.first.c_str());
+          switch (ret) {
+            case -1:
+              casadi_error("Parameter '" + op.first + "' unknown to Gurobi.");
+            case 1:
+              {
+                flag = GRBsetintparam(GRBgetenv(model), op.first.c_str(), op.second);
+                break;
+              }
+            case 2:
+                flag = GRBsetdblparam(GRBgetenv(model), op.first.c_str(), op.second);
+                break;
+            case 3:
+              {
+                std::string s = op.second;
+                flag = GRBsetstrparam(GRBgetenv(model), op.first.c_str(), s.c_str());
+                break;
+              }
+            default:
+              casadi_error("Not implememented : " + str(ret));
+          }
+          casadi_assert(!flag, GRBgeterrormsg(m->env));
         }
-        casadi_assert(!flag, GRBgeterrormsg(m->env));
       }
 
       m->fstats.at("preprocessing").toc();
@@ -544,8 +557,13 @@ namespace casadi {
       if (lam_x) fill_n(lam_x, nx_, casadi::nan);
       if (lam_a) fill_n(lam_a, na_, casadi::nan);
 
-      // Free memory
-      GRBfreemodel(model);
+      // Keep the model for the next call or free memory
+      if (incremental_) {
+        if (!m->updated) store_data(m, arg);
+        m->model = model;
+      } else {
+        GRBfreemodel(model);
+      }
       m->fstats.at("postprocessing").toc();
 
     } catch (...) {
@@ -564,14 +582,165 @@ namespace casadi {
     auto m = static_cast<GurobiMemory*>(mem);
     stats["return_status"] = return_status_string(m->return_status);
     stats["success"] = m->success;
+    if (incremental_) stats["model_updated"] = m->updated;
     return stats;
   }
 
+  char GurobiInterface::var_type(casadi_int i, double lb, double ub) const {
+    if (!vtype_.empty()) {
+      // Explicitly set 'vtype' takes precedence
+      return vtype_.at(i);
+    } else if (!discrete_.empty() && discrete_.at(i)) {
+      // Variable marked as discrete (integer or binary)
+      return lb==0 && ub==1 ? GRB_BINARY : GRB_INTEGER;
+    } else {
+      // Continious variable
+      return GRB_CONTINUOUS;
+    }
+  }
+
+  // Sense of a linear constraint as added to the model, 0 if skipped and 'R' for ranges
+  static char constr_sense(double lb, double ub) {
+    if (isinf(lb)) {
+      return isinf(ub) ? 0 : GRB_LESS_EQUAL;
+    } else if (isinf(ub)) {
+      return GRB_GREATER_EQUAL;
+    } else {
+      return lb==ub ? GRB_EQUAL : 'R';
+    }
+  }
+
+  // Compare with stored data, a null pointer corresponds to zeros
+  static bool is_equal(const double* v, const std::vector<double>& ref) {
+    for (casadi_int i=0; i<ref.size(); ++i) {
+      if ((v ? v[i] : 0.)!=ref[i]) return false;
+    }
+    return true;
+  }
+
+  // Store data, a null pointer corresponds to zeros
+  static void store(const double* v, casadi_int n, std::vector<double>& ref) {
+    ref.resize(n);
+    if (v) {
+      casadi_copy(v, n, get_ptr(ref));
+    } else {
+      casadi_fill(get_ptr(ref), n, 0.);
+    }
+  }
+
+  void GurobiInterface::store_data(GurobiMemory* m, const double** arg) const {
+    store(arg[CONIC_LBX], nx_, m->lbx);
+    store(arg[CONIC_UBX], nx_, m->ubx);
+    store(arg[CONIC_G], nx_, m->g);
+    store(arg[CONIC_H], H_.nnz(), m->h);
+    store(arg[CONIC_A], A_.nnz(), m->a);
+    store(arg[CONIC_LBA], na_, m->lba);
+    store(arg[CONIC_UBA], na_, m->uba);
+    store(arg[CONIC_P], P_.nnz(), m->p);
+    store(arg[CONIC_Q], Q_.nnz(), m->q);
+    m->vtype.resize(nx_);
+    for (casadi_int i=0; i<nx_; ++i) m->vtype[i] = var_type(i, m->lbx[i], m->ubx[i]);
+    m->sense.resize(na_);
+    for (casadi_int i=0; i<na_; ++i) m->sense[i] = constr_sense(m->lba[i], m->uba[i]);
+  }
+
+  bool GurobiInterface::update_model(GurobiMemory* m, const double** arg, double* val) const {
+    const double *h=arg[CONIC_H],
+      *g=arg[CONIC_G],
+      *a=arg[CONIC_A],
+      *lba=arg[CONIC_LBA],
+      *uba=arg[CONIC_UBA],
+      *lbx=arg[CONIC_LBX],
+      *ubx=arg[CONIC_UBX],
+      *p=arg[CONIC_P],
+      *q=arg[CONIC_Q];
+
+    // Changes to the quadratic or SOCP parts require a rebuild
+    if (!is_equal(h, m->h) || !is_equal(p, m->p) || !is_equal(q, m->q)) return false;
+
+    // As do changes to variable types or constraint senses, or to the bounds of
+    // range constraints, which Gurobi represents with an auxiliary variable
+    for (casadi_int i=0; i<nx_; ++i) {
+      if (var_type(i, lbx ? lbx[i] : 0., ubx ? ubx[i] : 0.)!=m->vtype[i]) return false;
+    }
+    for (casadi_int i=0; i<na_; ++i) {
+      double lb = lba ? lba[i] : 0., ub = uba ? uba[i] : 0.;
+      if (constr_sense(lb, ub)!=m->sense[i]) return false;
+      if (m->sense[i]=='R' && (lb!=m->lba[i] || ub!=m->uba[i])) return false;
+    }
+
+    // Update variable bounds and linear cost
+    int flag;
+    for (casadi_int i=0; i<nx_; ++i) {
+      val[i] = lbx ? lbx[i] : 0.;
+      if (isinf(val[i])) val[i] = -GRB_INFINITY;
+    }
+    flag = GRBsetdblattrarray(m->model, GRB_DBL_ATTR_LB, 0, nx_, val);
+    casadi_assert(!flag, GRBgeterrormsg(m->env));
+    for (casadi_int i=0; i<nx_; ++i) {
+      val[i] = ubx ? ubx[i] : 0.;
+      if (isinf(val[i])) val[i] = GRB_INFINITY;
+    }
+    flag = GRBsetdblattrarray(m->model, GRB_DBL_ATTR_UB, 0, nx_, val);
+    casadi_assert(!flag, GRBgeterrormsg(m->env));
+    for (casadi_int i=0; i<nx_; ++i) val[i] = g ? g[i] : 0.;
+    flag = GRBsetdblattrarray(m->model, GRB_DBL_ATTR_OBJ, 0, nx_, val);
+    casadi_assert(!flag, GRBgeterrormsg(m->env));
+
+    // Update right-hand sides and coefficients of the linear constraints that changed
+    const casadi_int *AT_colind=AT_.colind(), *AT_row=AT_.row();
+    int c = 0;
+    for (casadi_int i=0; i<na_; ++i) {
+      // Constraint not in the model
+      if (m->sense[i]==0) continue;
+
+      // Right-hand side
+      if (m->sense[i]!='R') {
+        double rhs, rhs_prev;
+        if (m->sense[i]==GRB_LESS_EQUAL) {
+          rhs = uba ? uba[i] : 0.;
+          rhs_prev = m->uba[i];
+        } else {
+          rhs = lba ? lba[i] : 0.;
+          rhs_prev = m->lba[i];
+        }
+        if (rhs!=rhs_prev) {
+          flag = GRBsetdblattrelement(m->model, GRB_DBL_ATTR_RHS, c, rhs);
+          casadi_assert(!flag, GRBgeterrormsg(m->env));
+        }
+      }
+
+      // Coefficients
+      for (casadi_int k=AT_colind[i]; k<AT_colind[i+1]; ++k) {
+        casadi_int el = A_mapping_[k];
+        double v = a ? a[el] : 0;
+        if (v!=m->a[el]) {
+          int j = AT_row[k];
+          flag = GRBchgcoeffs(m->model, 1, &c, &j, &v);
+          casadi_assert(!flag, GRBgeterrormsg(m->env));
+        }
+      }
+      c++;
+    }
+
+    // Keep track of the updated data
+    store(lbx, nx_, m->lbx);
+    store(ubx, nx_, m->ubx);
+    store(g, nx_, m->g);
+    store(a, A_.nnz(), m->a);
+    store(lba, na_, m->lba);
+    store(uba, na_, m->uba);
+    return true;
+  }
+
   GurobiMemory::GurobiMemory() {
     this->env = nullptr;
+    this->model = nullptr;
+    this->updated = false;
   }
 
   GurobiMemory::~GurobiMemory() {
+    if (this->model) GRBfreemodel(this->model);
     if (this->env) GRBfreeenv(this->env);
   }
 
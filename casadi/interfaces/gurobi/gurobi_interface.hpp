@@ -50,6 +50,18 @@ namespace casadi {
     int return_status;
     bool success;
 
+    // Persistent model (with the 'incremental' option)
+    GRBmodel *model;
+
+    // Problem data the persistent model was built or last updated with
+    std::vector<double> lbx, ubx, g, h, a, lba, uba, p, q;
+
+    // Variable types and constraint senses of the persistent model
+    std::vector<char> vtype, sense;
+
+    // Was the persistent model updated in place in the last call
+    bool updated;
+
     /// Constructor
     GurobiMemory();
 
@@ -117,9 +129,21 @@ namespace casadi {
     /// Get all statistics
     Dict get_stats(void* mem) const override;
 
+    /// Type of a variable, given its bounds
+    char var_type(casadi_int i, double lb, double ub) const;
+
+    /// Update the persistent model in place, returns false if a rebuild is needed
+    bool update_model(GurobiMemory* m, const double** arg, double* val) const;
+
+    /// Store the problem data of the persistent model
+    void store_data(GurobiMemory* m, const double** arg) const;
+
     // Variable types
     std::vector<char> vtype_;
 
+    // Keep the model between calls and update it in place
+    bool incremental_;
+
     /// Gurobi options
     Dict opts_;
 
@@ -26,6 +26,7 @@
 
 #include "ma27_interface.hpp"
 #include "casadi/core/global_options.hpp"
+#include "casadi/core/thread_pool.hpp"
 
 using namespace std;
 namespace casadi {
@@ -86,6 +87,8 @@ namespace casadi {
 
   int Ma27Interface::nfact(void* mem, const double* A) const {
     auto m = static_cast<Ma27Memory*>(mem);
+    // MA27 keeps its state in Fortran common blocks
+    SerialLock serial;
     casadi_assert_dev(A!=nullptr);
 
     // Get sparsity
@@ -175,6 +178,7 @@ namespace casadi {
 
   int Ma27Interface::solve(void* mem, const double* A, double* x, casadi_int nrhs, bool tr) const {
     auto m = static_cast<Ma27Memory*>(mem);
+    SerialLock serial;
 
     // Solve for each right-hand-side
     int N = this->ncol();
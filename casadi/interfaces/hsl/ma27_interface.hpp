@@ -149,6 +149,9 @@ namespace casadi {
     // Solve the linear system
     int solve(void* mem, const double* A, double* x, casadi_int nrhs, bool tr) const override;
 
+    /// MA27 keeps its state in Fortran common blocks
+    bool is_reentrant() const override { return false;}
+
     /// A documentation string
     static const std::string meta_doc;
 
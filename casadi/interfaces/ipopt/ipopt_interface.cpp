@@ -38,6 +38,11 @@
 
 using namespace std;
 #include <IpIpoptApplication.hpp>
+#include <IpAlgBuilder.hpp>
+#include <IpStdAugSystemSolver.hpp>
+#include <IpTSymLinearSolver.hpp>
+#include <IpTNLPAdapter.hpp>
+#include "ipopt_linsol.hpp"
 
 namespace casadi {
   extern "C"
@@ -99,6 +104,18 @@ namespace casadi {
       {"hess_lag",
        {OT_FUNCTION,
         "Function for calculating the Hessian of the Lagrangian (autogenerated by default)"}},
+      {"linsol",
+       {OT_STRING,
+        "Solve the linear systems in Ipopt with a CasADi Linsol plugin, e.g. 'ldl' or 'ma27', "
+        "instead of the linear solver selected by the Ipopt option 'linear_solver'"}},
+      {"linsol_options",
+       {OT_DICT,
+        "Options to be passed to the Linsol plugin"}},
+      {"colored_hessian",
+       {OT_BOOL,
+        "Calculate the exact Hessian of the Lagrangian numerically, by star coloring its "
+        "sparsity pattern and one forward-over-reverse Hessian-vector product per color, "
+        "instead of constructing nlp_hess_l symbolically [false]"}},
       {"jac_g",
        {OT_FUNCTION,
         "Function for calculating the Jacobian of the constraints "
@@ -116,6 +133,7 @@ namespace casadi {
 
     // Default options
     pass_nonlinear_variables_ = false;
+    colored_hessian_ = false;
 
     // Read user options
     for (auto&& op : opts) {
@@ -123,6 +141,12 @@ namespace casadi {
         opts_ = op.second;
       } else if (op.first=="pass_nonlinear_variables") {
         pass_nonlinear_variables_ = op.second;
+      } else if (op.first=="linsol") {
+        linsol_plugin_ = op.second.to_string();
+      } else if (op.first=="linsol_options") {
+        linsol_options_ = op.second;
+      } else if (op.first=="colored_hessian") {
+        colored_hessian_ = op.second;
       } else if (op.first=="var_string_md") {
         var_string_md_ = op.second;
       } else if (op.first=="var_integer_md") {
@@ -161,6 +185,7 @@ namespace casadi {
     }
 
     // Setup NLP functions
+    bool user_derivatives = has_function("nlp_grad_f") || has_function("nlp_jac_g");
     create_function("nlp_f", {"x", "p"}, {"f"});
     create_function("nlp_g", {"x", "p"}, {"g"});
     if (!has_function("nlp_grad_f")) {
@@ -171,8 +196,22 @@ namespace casadi {
     }
     jacg_sp_ = get_function("nlp_jac_g").sparsity_out(1);
 
+    // Fused functions for the evaluation cache: f and g at trial points,
+    // all first order information at accepted points
+    if (oracle_cache_) {
+      create_function("nlp_fg", {"x", "p"}, {"f", "g"});
+      add_fused("nlp_fg");
+      if (!user_derivatives) {
+        create_function("nlp_jac_fg", {"x", "p"}, {"f", "grad:f:x", "g", "jac:g:x"});
+        add_fused("nlp_jac_fg");
+      }
+    }
+
     // Allocate temporary work vectors
-    if (exact_hessian_) {
+    colored_hessian_ = colored_hessian_ && exact_hessian_ && !has_function("nlp_hess_l");
+    if (colored_hessian_) {
+      init_colored_hessian();
+    } else if (exact_hessian_) {
       if (!has_function("nlp_hess_l")) {
         create_function("nlp_hess_l", {"x", "p", "lam:f", "lam:g"},
                         {"hess:gamma:x:x"}, {{"gamma", {"f", "g"}}});
@@ -189,6 +228,90 @@ namespace casadi {
     if (exact_hessian_) {
       alloc_w(hesslag_sp_.nnz(), true); // hess_lk_
     }
+    if (colored_hessian_) {
+      alloc_w(nx_, true); // hess_seed
+      alloc_w(nx_*hess_coloring_.size2(), true); // hess_prod
+    }
+  }
+
+  void IpoptInterface::init_colored_hessian() {
+    // Sparsity pattern of the Hessian, only the gradient of the Lagrangian is constructed
+    Function grad_l = oracle_.factory("nlp_grad_l", {"x", "p", "lam:f", "lam:g"},
+                                      {"grad:gamma:x"}, {{"gamma", {"f", "g"}}});
+    Sparsity hess_sp = grad_l.sparsity_jac(0, 0, false, true);
+    hesslag_sp_ = Sparsity::triu(hess_sp);
+
+    // Star coloring, nx-by-ncolor
+    hess_coloring_ = hess_sp.star_coloring();
+    casadi_int ncolor = hess_coloring_.size2();
+    if (verbose_) {
+      casadi_message("Hessian of the Lagrangian: " + str(hesslag_sp_.nnz()) + " nonzeros, "
+                     + str(ncolor) + " colors");
+    }
+    vector<casadi_int> color(nx_);
+    const casadi_int* d_colind = hess_coloring_.colind();
+    const casadi_int* d_row = hess_coloring_.row();
+    for (casadi_int c=0; c<ncolor; ++c) {
+      for (casadi_int k=d_colind[c]; k<d_colind[c+1]; ++k) color[d_row[k]] = c;
+    }
+
+    // For each nonzero (k, i), is k the only neighbor of i with its color?
+    const casadi_int* h_colind = hess_sp.colind();
+    const casadi_int* h_row = hess_sp.row();
+    vector<bool> unique(hess_sp.nnz());
+    vector<casadi_int> count(ncolor, 0);
+    for (casadi_int i=0; i<nx_; ++i) {
+      for (casadi_int k=h_colind[i]; k<h_colind[i+1]; ++k) count[color[h_row[k]]]++;
+      for (casadi_int k=h_colind[i]; k<h_colind[i+1]; ++k) {
+        unique[k] = count[color[h_row[k]]]==1;
+      }
+      for (casadi_int k=h_colind[i]; k<h_colind[i+1]; ++k) count[color[h_row[k]]] = 0;
+    }
+
+    // Entry (i, j) is (H*v_c)_i with c the color of j if j is the only neighbor of i
+    // with that color, otherwise (H*v_c)_j with c the color of i
+    hess_nz_.resize(hesslag_sp_.nnz());
+    const casadi_int* colind = hesslag_sp_.colind();
+    const casadi_int* row = hesslag_sp_.row();
+    for (casadi_int j=0; j<nx_; ++j) {
+      for (casadi_int el=colind[j]; el<colind[j+1]; ++el) {
+        casadi_int i = row[el];
+        if (unique[hess_sp.get_nz(j, i)]) {
+          hess_nz_[el] = color[j]*nx_ + i;
+        } else {
+          casadi_assert_dev(unique[hess_sp.get_nz(i, j)]);
+          hess_nz_[el] = color[i]*nx_ + j;
+        }
+      }
+    }
+
+    // Hessian-vector products of f and g, no derivative expressions for SX
+    Function fg = has_function("nlp_fg") ? get_function("nlp_fg")
+      : create_function("nlp_fg", {"x", "p"}, {"f", "g"});
+    set_function(fg.hessvec(), "nlp_hessvec");
+  }
+
+  int IpoptInterface::calc_hess_l(IpoptMemory* m, const double* x, double obj_factor,
+                                  const double* lambda, double* hess_l) const {
+    const casadi_int* colind = hess_coloring_.colind();
+    const casadi_int* row = hess_coloring_.row();
+    for (casadi_int c=0; c<hess_coloring_.size2(); ++c) {
+      // Seed all columns with color c
+      casadi_fill(m->hess_seed, nx_, 0.);
+      for (casadi_int k=colind[c]; k<colind[c+1]; ++k) m->hess_seed[row[k]] = 1;
+      m->arg[0] = x;
+      m->arg[1] = m->p;
+      m->arg[2] = m->hess_seed;
+      m->arg[3] = nullptr;
+      m->arg[4] = &obj_factor;
+      m->arg[5] = lambda;
+      m->res[0] = m->hess_prod + c*nx_;
+      m->res[1] = nullptr;
+      if (calc_function(m, "nlp_hessvec")) return 1;
+    }
+    // Recover the nonzeros
+    for (casadi_int k=0; k<hess_nz_.size(); ++k) hess_l[k] = m->hess_prod[hess_nz_[k]];
+    return 0;
   }
 
   int IpoptInterface::init_mem(void* mem) const {
@@ -279,6 +402,19 @@ namespace casadi {
       }
     }
 
+    // Algorithm builder with the Linsol plugin as a custom linear solver
+    if (!linsol_plugin_.empty()) {
+      bool ret = (*app)->Options()->SetStringValue("linear_solver", "custom", false);
+      casadi_assert(ret, "Cannot select a custom linear solver in IPOPT");
+      SmartPtr<SparseSymLinearSolverInterface> lsi
+        = new IpoptLinsol(linsol_plugin_, linsol_options_);
+      SmartPtr<SymLinearSolver> sls = new TSymLinearSolver(lsi, SmartPtr<TSymScalingMethod>());
+      SmartPtr<AugSystemSolver> aug = new StdAugSystemSolver(*sls);
+      SmartPtr<AlgorithmBuilder> *builder = new SmartPtr<AlgorithmBuilder>();
+      m->builder = static_cast<void*>(builder);
+      *builder = new AlgorithmBuilder(aug);
+    }
+
     // Intialize the IpoptApplication and process the options
     Ipopt::ApplicationReturnStatus status = (*app)->Initialize();
     casadi_assert(status == Solve_Succeeded, "Error during IPOPT initialization");
@@ -299,6 +435,10 @@ namespace casadi {
     if (exact_hessian_) {
       m->hess_lk = w; w += hesslag_sp_.nnz();
     }
+    if (colored_hessian_) {
+      m->hess_seed = w; w += nx_;
+      m->hess_prod = w; w += nx_*hess_coloring_.size2();
+    }
   }
 
   inline const char* return_status_string(Ipopt::ApplicationReturnStatus status) {
@@ -368,9 +508,35 @@ namespace casadi {
     Ipopt::SmartPtr<Ipopt::IpoptApplication> *app =
       static_cast<Ipopt::SmartPtr<Ipopt::IpoptApplication>*>(m->app);
 
-    // Ask Ipopt to solve the problem
-    Ipopt::ApplicationReturnStatus status = (*app)->OptimizeTNLP(*userclass);
+    // Ask Ipopt to solve the problem, reusing the application state when warm starting
+    Ipopt::ApplicationReturnStatus status;
+    if (warm_start_ && m->warm) {
+      if (opts_.find("warm_start_init_point")==opts_.end()) {
+        (*app)->Options()->SetStringValue("warm_start_init_point", "yes");
+      }
+      if (m->builder) {
+        status = (*app)->ReOptimizeNLP(*static_cast<SmartPtr<NLP>*>(m->adapter));
+      } else {
+        status = (*app)->ReOptimizeTNLP(*userclass);
+      }
+    } else if (m->builder) {
+      // Same as OptimizeTNLP, but with the custom algorithm builder
+      SmartPtr<NLP> *adapter = static_cast<SmartPtr<NLP>*>(m->adapter);
+      if (adapter==nullptr) {
+        adapter = new SmartPtr<NLP>();
+        m->adapter = static_cast<void*>(adapter);
+      }
+      *adapter = new TNLPAdapter(*userclass, ConstPtr((*app)->Jnlst()));
+      status = (*app)->OptimizeNLP(*adapter,
+                                   *static_cast<SmartPtr<AlgorithmBuilder>*>(m->builder));
+    } else {
+      status = (*app)->OptimizeTNLP(*userclass);
+    }
+    m->warm = warm_start_;
     m->return_status = return_status_string(status);
+    if (status==User_Requested_Stop && m->deadline.expired() && !m->deadline.cancelled()) {
+      m->return_status = "Maximum_WallTime_Exceeded";
+    }
     m->success = status==Solve_Succeeded || status==Solved_To_Acceptable_Level
                  || status==Feasible_Point_Found;
 
@@ -387,6 +553,8 @@ namespace casadi {
                         double regularization_size, double alpha_du, double alpha_pr,
                         int ls_trials, bool full_callback) const {
     m->n_iter += 1;
+    // Stop at the current iterate if cancelled or out of time
+    if (m->deadline.expired()) return 0;
     try {
       m->inf_pr.push_back(inf_pr);
       m->inf_du.push_back(inf_du);
@@ -596,10 +764,20 @@ namespace casadi {
   IpoptMemory::IpoptMemory() {
     this->app = nullptr;
     this->userclass = nullptr;
+    this->builder = nullptr;
+    this->adapter = nullptr;
     this->return_status = "Unset";
   }
 
   IpoptMemory::~IpoptMemory() {
+    // Free the NLP adapter and algorithm builder, before the objects they refer to
+    if (this->adapter != nullptr) {
+      delete static_cast<Ipopt::SmartPtr<Ipopt::NLP>*>(this->adapter);
+    }
+    if (this->builder != nullptr) {
+      delete static_cast<Ipopt::SmartPtr<Ipopt::AlgorithmBuilder>*>(this->builder);
+    }
+
     // Free Ipopt application instance (or rather, the smart pointer holding it)
     if (this->app != nullptr) {
       delete static_cast<Ipopt::SmartPtr<Ipopt::IpoptApplication>*>(this->app);
@@ -72,9 +72,16 @@ namespace casadi {
     void* userclass;
     void* app;
 
+    // Algorithm builder and NLP adapter when a Linsol plugin is used, cf. option 'linsol'
+    void* builder;
+    void* adapter;
+
     // Current calculated quantities
     double *gk, *grad_fk, *jac_gk, *hess_lk, *grad_lk;
 
+    // Seed and Hessian-vector products for the colored Hessian
+    double *hess_seed, *hess_prod;
+
     // Stats
     std::vector<double> inf_pr, inf_du, mu, d_norm, regularization_size,
       obj, alpha_pr, alpha_du;
@@ -117,6 +124,9 @@ namespace casadi {
     // Get name of the class
     std::string class_name() const override { return "IpoptInterface";}
 
+    /// Not reentrant: the linear solvers (MUMPS, HSL) have global state
+    bool is_reentrant() const override { return false;}
+
     /** \brief  Create a new NLP Solver */
     static Nlpsol* creator(const std::string& name, const Function& nlp) {
       return new IpoptInterface(name, nlp);
@@ -153,6 +163,20 @@ namespace casadi {
     /// Exact Hessian?
     bool exact_hessian_;
 
+    /// Hessian of the Lagrangian from colored Hessian-vector products?
+    bool colored_hessian_;
+
+    /// Star coloring of the Hessian and nonzeros of hesslag_sp_ in the products
+    Sparsity hess_coloring_;
+    std::vector<casadi_int> hess_nz_;
+
+    // Set up the colored Hessian
+    void init_colored_hessian();
+
+    // Calculate the Hessian of the Lagrangian with colored Hessian-vector products
+    int calc_hess_l(IpoptMemory* m, const double* x, double obj_factor,
+                    const double* lambda, double* hess_l) const;
+
     /// All IPOPT options
     Dict opts_;
 
@@ -187,6 +211,8 @@ namespace casadi {
 
     // Options
     bool pass_nonlinear_variables_;
+    std::string linsol_plugin_;
+    Dict linsol_options_;
     std::vector<bool> nl_ex_;
     Dict var_string_md_, var_integer_md_, var_numeric_md_,
       con_string_md_, con_integer_md_, con_numeric_md_;
@@ -0,0 +1,113 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#include "ipopt_linsol.hpp"
+
+#include <cmath>
+
+namespace casadi {
+
+  IpoptLinsol::IpoptLinsol(const std::string& plugin, const Dict& opts)
+    : plugin_(plugin), opts_(opts), provides_inertia_(false), neig_(-1) {
+  }
+
+  IpoptLinsol::~IpoptLinsol() {
+  }
+
+  bool IpoptLinsol::InitializeImpl(const OptionsList& options, const std::string& prefix) {
+    return true;
+  }
+
+  ESymSolverStatus IpoptLinsol::InitializeStructure(Index dim, Index nonzeros,
+                                                    const Index* ia, const Index* ja) {
+    try {
+      // The upper triangular rows are the lower triangular columns
+      std::vector<casadi_int> colind(ia, ia+dim+1), row(ja, ja+nonzeros);
+      Sparsity sp_tril(dim, dim, colind, row);
+      Sparsity sp = sp_tril + sp_tril.T();
+
+      // Location of each nonzero of the full matrix in the triangular part
+      const casadi_int* sp_colind = sp.colind();
+      const casadi_int* sp_row = sp.row();
+      full_nz_.resize(sp.nnz());
+      for (casadi_int c=0; c<dim; ++c) {
+        for (casadi_int k=sp_colind[c]; k<sp_colind[c+1]; ++k) {
+          casadi_int r = sp_row[k];
+          full_nz_[k] = r>=c ? sp_tril.get_nz(r, c) : sp_tril.get_nz(c, r);
+        }
+      }
+      a_.resize(nonzeros);
+      a_full_.resize(sp.nnz());
+
+      // Create the solver, the symbolic factorization is performed once
+      linsol_ = Linsol("ipopt_linsol", plugin_, sp, opts_);
+
+      // Check if the plugin can count negative eigenvalues, using the identity matrix
+      for (casadi_int c=0; c<dim; ++c) {
+        for (casadi_int k=sp_colind[c]; k<sp_colind[c+1]; ++k) {
+          a_full_[k] = sp_row[k]==c ? 1 : 0;
+        }
+      }
+      if (linsol_.nfact(get_ptr(a_full_))) return SYMSOLVER_FATAL_ERROR;
+      try {
+        provides_inertia_ = linsol_.neig(get_ptr(a_full_))==0;
+      } catch (std::exception&) {
+        provides_inertia_ = false;
+      }
+    } catch (std::exception& e) {
+      casadi_warning("IpoptLinsol::InitializeStructure failed: " + std::string(e.what()));
+      return SYMSOLVER_FATAL_ERROR;
+    }
+    return SYMSOLVER_SUCCESS;
+  }
+
+  ESymSolverStatus IpoptLinsol::MultiSolve(bool new_matrix, const Index* ia, const Index* ja,
+                                           Index nrhs, double* rhs_vals, bool check_NegEVals,
+                                           Index numberOfNegEVals) {
+    casadi_int dim = linsol_.sparsity().size1();
+    try {
+      if (new_matrix) {
+        // Numeric factorization, reusing the symbolic factorization
+        for (casadi_int k=0; k<a_full_.size(); ++k) a_full_[k] = a_[full_nz_[k]];
+        if (linsol_.nfact(get_ptr(a_full_))) return SYMSOLVER_SINGULAR;
+        if (provides_inertia_) {
+          neig_ = linsol_.neig(get_ptr(a_full_));
+          if (check_NegEVals && neig_!=numberOfNegEVals) return SYMSOLVER_WRONG_INERTIA;
+        }
+      }
+      if (linsol_.solve(get_ptr(a_full_), rhs_vals, nrhs)) return SYMSOLVER_FATAL_ERROR;
+    } catch (std::exception& e) {
+      casadi_warning("IpoptLinsol::MultiSolve failed: " + std::string(e.what()));
+      return SYMSOLVER_FATAL_ERROR;
+    }
+    // A singular matrix may go undetected by the factorization
+    for (casadi_int k=0; k<dim*nrhs; ++k) {
+      if (!std::isfinite(rhs_vals[k])) return SYMSOLVER_SINGULAR;
+    }
+    return SYMSOLVER_SUCCESS;
+  }
+
+} // namespace casadi
@@ -0,0 +1,102 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#ifndef CASADI_IPOPT_LINSOL_HPP
+#define CASADI_IPOPT_LINSOL_HPP
+
+#include <IpSparseSymLinearSolverInterface.hpp>
+
+#include "casadi/core/linsol.hpp"
+
+#include <casadi/interfaces/ipopt/casadi_nlpsol_ipopt_export.h>
+
+/// \cond INTERNAL
+using namespace Ipopt;
+namespace casadi {
+
+  /** \brief Ipopt sparse symmetric linear solver backed by a CasADi Linsol plugin
+
+      Ipopt passes the upper triangular part of the KKT matrix in compressed row format,
+      which is expanded to the full symmetric matrix in compressed column format expected
+      by Linsol. The sparsity pattern is fixed after InitializeStructure, hence the symbolic
+      factorization is performed once and reused for all subsequent factorizations.
+  */
+  class CASADI_NLPSOL_IPOPT_EXPORT IpoptLinsol : public SparseSymLinearSolverInterface {
+  public:
+    IpoptLinsol(const std::string& plugin, const Dict& opts);
+    ~IpoptLinsol() override;
+
+    /** Nothing to initialize from the Ipopt options */
+    bool InitializeImpl(const OptionsList& options, const std::string& prefix) override;
+
+    /** Set up the Linsol instance for the sparsity pattern of the KKT matrix */
+    ESymSolverStatus InitializeStructure(Index dim, Index nonzeros,
+                                         const Index* ia, const Index* ja) override;
+
+    /** Array for Ipopt to write the nonzeros of the KKT matrix to */
+    double* GetValuesArrayPtr() override { return get_ptr(a_); }
+
+    /** Factorize, if the matrix changed, and solve for nrhs right-hand sides */
+    ESymSolverStatus MultiSolve(bool new_matrix, const Index* ia, const Index* ja,
+                                Index nrhs, double* rhs_vals, bool check_NegEVals,
+                                Index numberOfNegEVals) override;
+
+    /** Number of negative eigenvalues of the last factorized matrix */
+    Index NumberOfNegEVals() const override { return neig_; }
+
+    /** No pivoting tolerance to tighten */
+    bool IncreaseQuality() override { return false; }
+
+    /** Only if the plugin can count negative eigenvalues, e.g. ldl and ma27 */
+    bool ProvidesInertia() const override { return provides_inertia_; }
+
+    /** Upper triangular part in compressed row format */
+    EMatrixFormat MatrixFormat() const override { return CSR_Format_0_Offset; }
+
+  private:
+    IpoptLinsol(const IpoptLinsol&);
+    IpoptLinsol& operator=(const IpoptLinsol&);
+
+    // Linsol plugin and options
+    std::string plugin_;
+    Dict opts_;
+
+    // Linear solver for the full symmetric matrix
+    Linsol linsol_;
+
+    // Nonzeros as passed by Ipopt, the full matrix and the mapping between the two
+    std::vector<double> a_, a_full_;
+    std::vector<casadi_int> full_nz_;
+
+    // Inertia
+    bool provides_inertia_;
+    Index neig_;
+  };
+
+} // namespace casadi
+/// \endcond
+
+#endif // CASADI_IPOPT_LINSOL_HPP
@@ -143,6 +143,10 @@ namespace casadi {
                               bool new_lambda, Index nele_hess, Index* iRow,
                               Index* jCol, Number* values) {
     if (values) {
+      // Colored Hessian-vector products
+      if (solver_.colored_hessian_) {
+        return solver_.calc_hess_l(mem_, x, obj_factor, lambda, values)==0;
+      }
       // Evaluate numerically
       mem_->arg[0] = x;
       mem_->arg[1] = mem_->p;
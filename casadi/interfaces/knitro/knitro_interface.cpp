@@ -112,6 +112,18 @@ namespace casadi {
                                   {{"gamma", {"f", "g"}}});
     hesslag_sp_ = hess_l_fcn.sparsity_out(0);
 
+    // Triplet format of the Jacobian and Hessian sparsity, passed to KNITRO on every solve
+    Jcol_.clear(); Jrow_.clear();
+    if (!jacg_sp_.is_null()) {
+      assign_vector(jacg_sp_.get_col(), Jcol_);
+      assign_vector(jacg_sp_.get_row(), Jrow_);
+    }
+    Hcol_.clear(); Hrow_.clear();
+    if (!hesslag_sp_.is_null()) {
+      assign_vector(hesslag_sp_.get_col(), Hcol_);
+      assign_vector(hesslag_sp_.get_row(), Hrow_);
+    }
+
     // Allocate persistent memory
     alloc_w(nx_, true); // wlbx_
     alloc_w(nx_, true); // wubx_
@@ -157,19 +169,9 @@ namespace casadi {
     casadi_assert_dev(m->kc!=nullptr);
     casadi_int status;
 
-    // Jacobian sparsity
-    vector<int> Jcol, Jrow;
-    if (!jacg_sp_.is_null()) {
-      assign_vector(jacg_sp_.get_col(), Jcol);
-      assign_vector(jacg_sp_.get_row(), Jrow);
-    }
-
     // Hessian sparsity
-    casadi_int nnzH = hesslag_sp_.is_null() ? 0 : hesslag_sp_.nnz();
-    vector<int> Hcol, Hrow;
+    casadi_int nnzH = Hcol_.size();
     if (nnzH>0) {
-      assign_vector(hesslag_sp_.get_col(), Hcol);
-      assign_vector(hesslag_sp_.get_row(), Hrow);
       status = KTR_set_int_param_by_name(m->kc, "hessopt", KTR_HESSOPT_EXACT);
       casadi_assert(status==0, "KTR_set_int_param failed");
     } else {
@@ -237,15 +239,15 @@ namespace casadi {
       KTR_mip_init_problem(m->kc, nx_, KTR_OBJGOAL_MINIMIZE, KTR_OBJTYPE_GENERAL,
                            objFnType, get_ptr(vtype), m->wlbx, m->wubx,
                            ng_, get_ptr(contype_), get_ptr(ftype),
-                           m->wlbg, m->wubg, Jcol.size(), get_ptr(Jcol), get_ptr(Jrow),
-                           nnzH, get_ptr(Hrow), get_ptr(Hcol), m->x, nullptr);
+                           m->wlbg, m->wubg, Jcol_.size(), get_ptr(Jcol_), get_ptr(Jrow_),
+                           nnzH, get_ptr(Hrow_), get_ptr(Hcol_), m->x, nullptr);
       casadi_assert(status==0, "KTR_mip_init_problem failed");
     } else {
       status =
       KTR_init_problem(m->kc, nx_, KTR_OBJGOAL_MINIMIZE, KTR_OBJTYPE_GENERAL,
                        m->wlbx, m->wubx, ng_, get_ptr(contype_),
-                       m->wlbg, m->wubg, Jcol.size(), get_ptr(Jcol), get_ptr(Jrow),
-                       nnzH, get_ptr(Hrow), get_ptr(Hcol), m->x, nullptr); // initial lambda
+                       m->wlbg, m->wubg, Jcol_.size(), get_ptr(Jcol_), get_ptr(Jrow_),
+                       nnzH, get_ptr(Hrow_), get_ptr(Hcol_), m->x, nullptr); // initial lambda
       casadi_assert(status==0, "KTR_init_problem failed");
     }
 
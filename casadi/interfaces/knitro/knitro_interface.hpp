@@ -70,6 +70,9 @@ namespace casadi {
     Sparsity jacg_sp_;
     Sparsity hesslag_sp_;
 
+    /// Jacobian and Hessian sparsity in triplet format, computed once in init
+    std::vector<int> Jcol_, Jrow_, Hcol_, Hrow_;
+
     explicit KnitroInterface(const std::string& name, const Function& nlp);
     ~KnitroInterface() override;
 
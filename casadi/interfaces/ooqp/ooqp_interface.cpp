@@ -60,6 +60,7 @@ namespace casadi {
   }
 
   OoqpInterface::~OoqpInterface() {
+    clear_mem();
   }
 
   Options OoqpInterface::options_
@@ -145,9 +146,9 @@ namespace casadi {
 
   int OoqpInterface::
   eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const {
-
-    return_status_ = -1;
-    success_ = false;
+    auto m = static_cast<OoqpMemory*>(mem);
+    m->return_status = -1;
+    m->success = false;
     if (inputs_check_) {
       check_inputs(arg[CONIC_LBX], arg[CONIC_UBX], arg[CONIC_LBA], arg[CONIC_UBA]);
     }
@@ -411,8 +412,8 @@ namespace casadi {
       }
     }
 
-    return_status_ = ierr;
-    success_ = ierr==SUCCESSFUL_TERMINATION;
+    m->return_status = ierr;
+    m->success = ierr==SUCCESSFUL_TERMINATION;
     if (ierr>0) {
       casadi_warning("Unable to solve problem: " + str(errFlag(ierr)));
     } else if (ierr<0) {
@@ -489,8 +490,9 @@ namespace casadi {
 
   Dict OoqpInterface::get_stats(void* mem) const {
     Dict stats = Conic::get_stats(mem);
-    stats["return_status"] = return_status_;
-    stats["success"] = success_;
+    auto m = static_cast<OoqpMemory*>(mem);
+    stats["return_status"] = m->return_status;
+    stats["success"] = m->success;
     return stats;
   }
 
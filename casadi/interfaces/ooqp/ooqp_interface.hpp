@@ -41,6 +41,11 @@
 /// \cond INTERNAL
 namespace casadi {
 
+  struct CASADI_CONIC_OOQP_EXPORT OoqpMemory : public ConicMemory {
+    int return_status;
+    bool success;
+  };
+
   /** \brief \pluginbrief{Conic,ooqp}
 
       @copydoc Conic_doc
@@ -68,6 +73,9 @@ namespace casadi {
     // Get name of the class
     std::string class_name() const override { return "OoqpInterface";}
 
+    /// Not reentrant: MA27 keeps its state in Fortran common blocks
+    bool is_reentrant() const override { return false;}
+
     ///@{
     /** \brief Options */
     static Options options_;
@@ -77,6 +85,12 @@ namespace casadi {
     /** \brief  Initialize */
     void init(const Dict& opts) override;
 
+    /** \brief Create memory block */
+    void* alloc_mem() const override { return new OoqpMemory();}
+
+    /** \brief Free memory block */
+    void free_mem(void *mem) const override { delete static_cast<OoqpMemory*>(mem);}
+
     /// Solve the QP
     int eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const override;
 
@@ -111,9 +125,6 @@ namespace casadi {
     /// A documentation string
     static const std::string meta_doc;
 
-    mutable int return_status_;
-    mutable bool success_;
-
   };
 
 } // namespace casadi
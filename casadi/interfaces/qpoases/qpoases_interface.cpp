@@ -51,12 +51,9 @@ namespace casadi {
   QpoasesInterface::QpoasesInterface(const std::string& name,
                                      const std::map<std::string, Sparsity>& st)
     : Conic(name, st) {
-    // Redirect output to CasADi
-    static bool first_call = true;
-    if (first_call) {
-      qpOASES::setPrintf(qpoases_printf);
-      first_call = false;
-    }
+    // Redirect output to CasADi, once (thread-safe static initialization)
+    static bool redirected = (qpOASES::setPrintf(qpoases_printf), true);
+    (void)redirected;
   }
 
   void QpoasesInterface::qpoases_printf(const char* s) {
@@ -297,10 +294,7 @@ namespace casadi {
     }
 
     // Allocate work vectors
-    if (sparse_) {
-      alloc_w(nnz_in(CONIC_H), true); // h
-      alloc_w(nnz_in(CONIC_A), true); // a
-    } else {
+    if (!sparse_) {
       alloc_w(nx_*nx_, true); // h
       alloc_w(nx_*na_, true); // a
     }
@@ -310,6 +304,26 @@ namespace casadi {
     alloc_w(na_, true); // lba
     alloc_w(na_, true); // uba
     alloc_w(nx_+na_, true); // dual
+    alloc_w(nx_+na_, true); // y0
+  }
+
+  void QpoasesInterface::memory_usage(std::map<std::string, casadi_int>& usage,
+                                      std::set<const void*>& visited) const {
+    Conic::memory_usage(usage, visited);
+    for (casadi_int i=0; i<n_mem(); ++i) {
+      auto m = static_cast<const QpoasesMemory*>(memory(i));
+      if (!m) continue;
+      usage["memory"] += sizeof(*m) + memory_bytes(m->lin_map) + memory_bytes(m->row)
+        + memory_bytes(m->col) + memory_bytes(m->nz_map) + memory_bytes(m->h_row)
+        + memory_bytes(m->h_colind) + memory_bytes(m->a_row) + memory_bytes(m->a_colind)
+        + memory_bytes(m->nz) + memory_bytes(m->h_nz) + memory_bytes(m->a_nz)
+        + memory_bytes(m->kkt_row) + memory_bytes(m->kkt_col);
+    }
+    // qpOASES instances, as an estimate: the dense factorization matrices R, Q and T,
+    // the dense constraint matrix unless sparse, and about thirty vectors
+    casadi_int n = nx_ + na_;
+    casadi_int per_qp = (3*nx_*nx_ + (sparse_ ? A_.nnz() : nx_*na_) + 30*n)*sizeof(double);
+    usage["qpoases"] += n_mem()*per_qp;
   }
 
   int QpoasesInterface::init_mem(void* mem) const {
@@ -341,6 +355,23 @@ namespace casadi {
     m->a_row.resize(A_.nnz());
     m->a_colind.resize(A_.size2()+1);
 
+    // Sparse QP matrices, kept across calls with the nonzeros updated in place
+    if (sparse_) {
+      copy_vector(H_.colind(), m->h_colind);
+      copy_vector(H_.row(), m->h_row);
+      m->h_nz.resize(H_.nnz());
+      if (m->h) delete m->h;
+      m->h = new qpOASES::SymSparseMat(H_.size1(), H_.size2(),
+        get_ptr(m->h_row), get_ptr(m->h_colind), get_ptr(m->h_nz));
+      m->h->createDiagInfo();
+      copy_vector(A_.colind(), m->a_colind);
+      copy_vector(A_.row(), m->a_row);
+      m->a_nz.resize(A_.nnz());
+      if (m->a) delete m->a;
+      m->a = new qpOASES::SparseMatrix(A_.size1(), A_.size2(),
+        get_ptr(m->a_row), get_ptr(m->a_colind), get_ptr(m->a_nz));
+    }
+
     return 0;
   }
 
@@ -378,29 +409,29 @@ namespace casadi {
     double* ubA=w; w += na_;
     casadi_copy(arg[CONIC_UBA], na_, ubA);
 
+    // Working set guess for a cold start, from the nonzero multipliers
+    double* y0 = nullptr;
+    if (!m->called_once) {
+      y0=w; w += nx_+na_;
+      casadi_copy(arg[CONIC_LAM_X0], nx_, y0);
+      casadi_copy(arg[CONIC_LAM_A0], na_, y0+nx_);
+      if (casadi_norm_inf(nx_+na_, y0)==0) {
+        y0 = nullptr;
+      } else {
+        casadi_scal(nx_+na_, -1., y0);
+      }
+    }
+    const double* x0 = y0 ? arg[CONIC_X0] : nullptr;
+
     // Return flag
     casadi_int flag;
 
     // Sparse or dense mode?
     if (sparse_) {
-      // Get quadratic term
-      copy_vector(H_.colind(), m->h_colind);
-      copy_vector(H_.row(), m->h_row);
-      double* h=w; w += H_.nnz();
-      casadi_copy(arg[CONIC_H], H_.nnz(), h);
-      if (m->h) delete m->h;
-      m->h = new qpOASES::SymSparseMat(H_.size1(), H_.size2(),
-        get_ptr(m->h_row), get_ptr(m->h_colind), h);
-      m->h->createDiagInfo();
-
-      // Get linear term
-      copy_vector(A_.colind(), m->a_colind);
-      copy_vector(A_.row(), m->a_row);
-      double* a=w; w += A_.nnz();
-      casadi_copy(arg[CONIC_A], A_.nnz(), a);
-      if (m->a) delete m->a;
-      m->a = new qpOASES::SparseMatrix(A_.size1(), A_.size2(),
-        get_ptr(m->a_row), get_ptr(m->a_colind), a);
+      // Update the quadratic and linear terms, qpOASES only keeps the solution of the
+      // previous call, hence the nonzeros can be overwritten before a hotstart
+      casadi_copy(arg[CONIC_H], H_.nnz(), get_ptr(m->h_nz));
+      casadi_copy(arg[CONIC_A], A_.nnz(), get_ptr(m->a_nz));
 
       m->fstats.at("preprocessing").toc();
       m->fstats.at("solver").tic();
@@ -409,6 +440,12 @@ namespace casadi {
       if (m->called_once) {
         flag = m->sqp->hotstart(m->h, g, m->a, lb, ub, lbA, ubA, nWSR, cputime_ptr);
       } else {
+        flag = m->sqp->init(m->h, g, m->a, lb, ub, lbA, ubA, nWSR, cputime_ptr, x0, y0);
+      }
+      if (retry_cold(m, flag, y0)) {
+        nWSR = max_nWSR_;
+        cputime = max_cputime_;
+        m->sqp->reset();
         flag = m->sqp->init(m->h, g, m->a, lb, ub, lbA, ubA, nWSR, cputime_ptr);
       }
       m->fstats.at("solver").toc();
@@ -429,15 +466,30 @@ namespace casadi {
         if (m->called_once) {
           // Broken?
           //flag = m->qp->hotstart(g, lb, ub, nWSR, cputime_ptr);
+          // Reinitialize, starting from the previous working set
+          qpOASES::Bounds bounds;
+          m->qp->getBounds(bounds);
           m->qp->reset();
-          flag = m->qp->init(h, g, lb, ub, nWSR, cputime_ptr);
+          flag = m->qp->init(h, g, lb, ub, nWSR, cputime_ptr, nullptr, nullptr, &bounds);
         } else {
+          flag = m->qp->init(h, g, lb, ub, nWSR, cputime_ptr, x0, y0);
+        }
+        if (retry_cold(m, flag, y0)) {
+          nWSR = max_nWSR_;
+          cputime = max_cputime_;
+          m->qp->reset();
           flag = m->qp->init(h, g, lb, ub, nWSR, cputime_ptr);
         }
       } else {
         if (m->called_once) {
           flag = m->sqp->hotstart(h, g, a, lb, ub, lbA, ubA, nWSR, cputime_ptr);
         } else {
+          flag = m->sqp->init(h, g, a, lb, ub, lbA, ubA, nWSR, cputime_ptr, x0, y0);
+        }
+        if (retry_cold(m, flag, y0)) {
+          nWSR = max_nWSR_;
+          cputime = max_cputime_;
+          m->sqp->reset();
           flag = m->sqp->init(h, g, a, lb, ub, lbA, ubA, nWSR, cputime_ptr);
         }
       }
@@ -451,6 +503,7 @@ namespace casadi {
 
     m->return_status = flag;
     m->success = flag==qpOASES::SUCCESSFUL_RETURN;
+    m->iter_count = nWSR;
 
     if (verbose_) casadi_message("qpOASES return status: " + getErrorMessage(m->return_status));
 
@@ -480,6 +533,17 @@ namespace casadi {
     return 0;
   }
 
+  bool QpoasesInterface::retry_cold(QpoasesMemory* m, casadi_int flag, const double* y0) const {
+    // Only if the solver was warm started and failed
+    if (!m->called_once && y0==nullptr) return false;
+    if (flag==qpOASES::SUCCESSFUL_RETURN || flag==qpOASES::RET_MAX_NWSR_REACHED) return false;
+    if (verbose_) {
+      casadi_message("qpOASES warm start failed: " + getErrorMessage(flag)
+                     + " Retrying with a cold start.");
+    }
+    return true;
+  }
+
   std::string QpoasesInterface::getErrorMessage(casadi_int flag) {
     switch (flag) {
     case qpOASES::SUCCESSFUL_RETURN:
@@ -835,6 +899,9 @@ namespace casadi {
     this->qp = nullptr;
     this->h = nullptr;
     this->a = nullptr;
+    this->kkt_dim = -1;
+    this->iter_count = 0;
+    this->sfact_reused = false;
   }
 
   QpoasesMemory::~QpoasesMemory() {
@@ -848,6 +915,16 @@ namespace casadi {
     casadi_assert_dev(mem!=nullptr);
     QpoasesMemory* m = static_cast<QpoasesMemory*>(mem);
 
+    // Reuse the linear solver and its symbolic factorization if the pattern is unchanged,
+    // which is the case when qpOASES resets the Schur complement or hotstarts
+    m->sfact_reused = !m->linsol.is_null() && dim==m->kkt_dim
+      && nnz==m->kkt_row.size() && std::equal(row, row+nnz, m->kkt_row.begin())
+      && std::equal(col, col+nnz, m->kkt_col.begin());
+    if (m->sfact_reused) return 0;
+    m->kkt_dim = dim;
+    m->kkt_row.assign(row, row+nnz);
+    m->kkt_col.assign(col, col+nnz);
+
     // Get sparsity pattern in sparse triplet format
     m->row.clear();
     m->col.clear();
@@ -882,6 +959,9 @@ namespace casadi {
     casadi_assert_dev(mem!=nullptr);
     QpoasesMemory* m = static_cast<QpoasesMemory*>(mem);
 
+    // Symbolic factorization already available
+    if (m->sfact_reused) return 0;
+
     // Get nonzero elements (entire elements)
     for (int i=0; i<m->nz.size(); ++i) m->nz[i] = vals[m->lin_map[i]];
 
@@ -926,6 +1006,7 @@ namespace casadi {
     auto m = static_cast<QpoasesMemory*>(mem);
     stats["return_status"] = getErrorMessage(m->return_status);
     stats["success"] = m->success;
+    stats["iter_count"] = m->iter_count;
     return stats;
   }
 
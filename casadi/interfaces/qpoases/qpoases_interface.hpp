@@ -57,9 +57,10 @@ namespace casadi {
       qpOASES::QProblemB *qp;
     };
 
-    // Sparse QP matrices
+    // Sparse QP matrices and their nonzeros
     qpOASES::SymSparseMat *h;
     qpOASES::SparseMatrix *a;
+    std::vector<double> h_nz, a_nz;
 
     /// Has qpOASES been called once?
     bool called_once;
@@ -75,9 +76,19 @@ namespace casadi {
     // Nonzero entries
     std::vector<double> nz;
 
+    // Pattern of the last linear system, as passed by qpOASES
+    int kkt_dim;
+    std::vector<int> kkt_row, kkt_col;
+
+    // Linear solver reused with its symbolic factorization
+    bool sfact_reused;
+
     int return_status;
     bool success;
 
+    // Number of working set recalculations
+    int iter_count;
+
     /// Constructor
     QpoasesMemory();
 
@@ -118,6 +129,9 @@ namespace casadi {
     // Get name of the class
     std::string class_name() const override { return "QpoasesInterface";}
 
+    /// Not reentrant: qpOASES reports errors through a global message handler
+    bool is_reentrant() const override { return false;}
+
     ///@{
     /** \brief Options */
     static Options options_;
@@ -160,6 +174,10 @@ namespace casadi {
     /// Get all statistics
     Dict get_stats(void* mem) const override;
 
+    /** \brief Add the estimated heap memory, including the qpOASES instances */
+    void memory_usage(std::map<std::string, casadi_int>& usage,
+                      std::set<const void*>& visited) const override;
+
   protected:
 
     ///@{
@@ -189,6 +207,9 @@ namespace casadi {
 
     /// Get qpOASES error message
     static std::string getErrorMessage(casadi_int flag);
+
+    /// Solve from scratch after a failed hotstart or warm start?
+    bool retry_cold(QpoasesMemory* m, casadi_int flag, const double* y0) const;
   };
 
 } // namespace casadi
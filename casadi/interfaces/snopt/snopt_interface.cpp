@@ -168,6 +168,25 @@ namespace casadi {
     // We don't need a dummy row if a linear objective row is present
     casadi_assert_dev(!(dummyrow_ && jacF_row_));
 
+    // Nonzeros of gradF passed as gObj in userfun, -1 for structural zeros
+    const Sparsity& jacf_sp = jac_f_fcn_.sparsity_out(1);
+    gobj_map_.resize(nnObj_);
+    for (casadi_int k = 0; k < nnObj_; ++k) {
+      gobj_map_[k] = jacf_sp.colind(k+1) > jacf_sp.colind(k) ? jacf_sp.colind(k) : -1;
+    }
+
+    // Nonzeros of jacG passed as gCon in userfun
+    gcon_map_.clear();
+    const casadi_int* A_colind = A_structure_.colind();
+    const casadi_int* A_row = A_structure_.row();
+    const std::vector<casadi_int>& A_nz = A_structure_.nonzeros();
+    for (casadi_int j = 0; j < nnJac_; ++j) {
+      for (casadi_int k = A_colind[j]; k < A_colind[j+1]; ++k) {
+        if (A_row[k] >= nnCon_) break;
+        if (A_nz[k] > 0) gcon_map_.push_back(A_nz[k]-1);
+      }
+    }
+
     // Allocate temporary memory
     alloc_w(nx_, true); // xk2_
     alloc_w(ng_, true); // lam_gk_
@@ -184,7 +203,6 @@ namespace casadi {
     auto m = static_cast<SnoptMemory*>(mem);
 
     // Allocate data structures needed in evaluate
-    m->A_data.resize(A_structure_.nnz());
     m->bl.resize(nx_+ng_);
     m->bu.resize(nx_+ng_);
     m->hs.resize(nx_+ng_);
@@ -295,26 +313,21 @@ std::map<int, std::string> SnoptInterface::secondary_status_ =
     m->return_status = -1;
 
     // Evaluate gradF and jacG at initial value
-    m->arg[0] = m->x;
-    m->arg[1] = m->p;
-    m->res[0] = nullptr;
-    m->res[1] = m->jac_gk;
-    calc_function(m, "nlp_jac_g");
-    m->res[0] = nullptr;
-    m->res[1] = m->jac_fk;
-    calc_function(m, "nlp_jac_f");
+    calc_functions(m, {{"nlp_jac_g", {m->x, m->p}, {nullptr, m->jac_gk}},
+                       {"nlp_jac_f", {m->x, m->p}, {nullptr, m->jac_fk}}});
 
     // perform the mapping:
-    // populate A_data_ (the nonzeros of A)
+    // populate valJ (the nonzeros of A)
     // with numbers pulled from jacG and gradF
-    for (casadi_int k = 0; k < A_structure_.nnz(); ++k) {
-      casadi_int i = A_structure_.nonzeros()[k];
+    const std::vector<casadi_int>& A_nz = A_structure_.nonzeros();
+    for (casadi_int k = 0; k < A_nz.size(); ++k) {
+      casadi_int i = A_nz[k];
       if (i == 0) {
-        m->A_data[k] = 0;
+        m->valJ[k] = 0;
       } else if (i > 0) {
-        m->A_data[k] = m->jac_gk[i-1];
+        m->valJ[k] = m->jac_gk[i-1];
       } else {
-        m->A_data[k] = m->jac_fk[-i-1];
+        m->valJ[k] = m->jac_fk[-i-1];
       }
     }
 
@@ -360,7 +373,6 @@ std::map<int, std::string> SnoptInterface::secondary_status_ =
     // Set up Jacobian matrix
     copy_vector(A_structure_.colind(), m->locJ);
     copy_vector(A_structure_.row(), m->indJ);
-    casadi_copy(get_ptr(m->A_data), A_structure_.nnz(), get_ptr(m->valJ));
 
     for (auto&& op : opts_) {
       // Replace underscores with spaces
@@ -457,12 +469,8 @@ std::map<int, std::string> SnoptInterface::secondary_status_ =
 
       // provide nonlinear part of objective gradient to SNOPT
       for (casadi_int k = 0; k < nnObj; ++k) {
-        casadi_int el = jac_f_fcn_.sparsity_out(1).colind(k);
-        if (jac_f_fcn_.sparsity_out(1).colind(k+1) > el) {
-          gObj[k] = m->jac_fk[el];
-        } else {
-          gObj[k] = 0;
-        }
+        casadi_int el = gobj_map_[k];
+        gObj[k] = el >= 0 ? m->jac_fk[el] : 0;
       }
 
       if (!jac_g_fcn_.is_null()) {
@@ -482,19 +490,9 @@ std::map<int, std::string> SnoptInterface::secondary_status_ =
         calc_function(m, "nlp_jac_g");
 
         // provide nonlinear part of constraint jacobian to SNOPT
-        casadi_int kk = 0;
-        for (casadi_int j = 0; j < nnJac; ++j) {
-          for (casadi_int k = A_structure_.colind(j);
-              k < A_structure_.sparsity().colind(j+1); ++k) {
-            if (A_structure_.row(k) >= nnCon) break;
-            casadi_int i = A_structure_.nonzeros()[k];
-            if (i > 0) {
-              gCon[kk++] = m->jac_gk[i-1];
-            }
-          }
-        }
-
+        casadi_int kk = gcon_map_.size();
         casadi_assert_dev(kk == 0 || kk == neJac);
+        for (casadi_int k = 0; k < kk; ++k) gCon[k] = m->jac_gk[gcon_map_[k]];
 
         // provide nonlinear part of objective to SNOPT
         for (casadi_int k = 0; k < nnCon; ++k) {
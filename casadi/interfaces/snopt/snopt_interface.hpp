@@ -60,7 +60,7 @@ namespace casadi {
 
     casadi_int n_iter; // number of major iterations
 
-    std::vector<double> A_data, valJ, rc, pi;
+    std::vector<double> valJ, rc, pi;
 
     // Memory pool
     static std::vector<SnoptMemory*> mempool;
@@ -154,6 +154,11 @@ namespace casadi {
 
     IM A_structure_;
 
+    /// Nonzero of gradF for each entry of gObj (-1 for zero), computed in init
+    std::vector<casadi_int> gobj_map_;
+    /// Nonzero of jacG for each entry of gCon, computed in init
+    std::vector<casadi_int> gcon_map_;
+
     casadi_int m_;
     casadi_int iObj_;
 
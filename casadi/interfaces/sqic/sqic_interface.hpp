@@ -68,6 +68,9 @@ namespace casadi {
     // Get name of the class
     std::string class_name() const override { return "SqicInterface";}
 
+    /// Not reentrant: SQIC keeps its workspace in Fortran module variables
+    bool is_reentrant() const override { return false;}
+
     /** \brief  Initialize */
     virtual void init();
 
@@ -66,7 +66,12 @@ namespace casadi {
         "Nonlinear solver type: NEWTON|functional"}},
       {"fsens_all_at_once",
        {OT_BOOL,
-        "Calculate all right hand sides of the sensitivity equations at once"}}
+        "Calculate all right hand sides of the sensitivity equations at once"}},
+      {"warm_start",
+       {OT_BOOL,
+        "Start each call with the initial step size actually taken by the previous call "
+        "with the same memory instead of estimating it, which saves right-hand-side "
+        "evaluations in repeated short integrations [default: false]"}}
      }
   };
 
@@ -79,6 +84,7 @@ namespace casadi {
     // Default options
     string linear_multistep_method = "bdf";
     string nonlinear_solver_iteration = "newton";
+    warm_start_ = false;
 
     // Read options
     for (auto&& op : opts) {
@@ -86,6 +92,8 @@ namespace casadi {
         linear_multistep_method = op.second.to_string();
       } else if (op.first=="nonlinear_solver_iteration") {
         nonlinear_solver_iteration = op.second.to_string();
+      } else if (op.first=="warm_start") {
+        warm_start_ = op.second;
       }
     }
 
@@ -194,10 +202,18 @@ namespace casadi {
       }
     }
 
+    // Event functions
+    if (ne_>0) {
+      THROWING(CVodeRootInit, m->mem, ne_, rootF);
+      std::vector<int> dir(event_direction_.begin(), event_direction_.end());
+      THROWING(CVodeSetRootDirection, m->mem, get_ptr(dir));
+    }
+
     // Initialize adjoint sensitivities
     if (nrx_>0) {
       casadi_int interpType = interp_==SD_HERMITE ? CV_HERMITE : CV_POLYNOMIAL;
       THROWING(CVodeAdjInit, m->mem, steps_per_checkpoint_, interpType);
+      m->steps_per_checkpoint = steps_per_checkpoint_;
     }
 
     m->first_callB = true;
@@ -234,6 +250,9 @@ namespace casadi {
     // Re-initialize
     THROWING(CVodeReInit, m->mem, t, m->xz);
 
+    // Skip the estimation of the initial step size
+    if (warm_start_ && m->hinused>0) THROWING(CVodeSetInitStep, m->mem, m->hinused);
+
     // Re-initialize quadratures
     if (nq_>0) {
       N_VConst(0.0, m->q);
@@ -242,7 +261,18 @@ namespace casadi {
 
     // Re-initialize backward integration
     if (nrx_>0) {
-      THROWING(CVodeAdjReInit, m->mem);
+      casadi_int nd = m->steps_per_checkpoint;
+      if (checkpoint_memory_>0 && m->nsteps>0) nd = steps_per_checkpoint(m->nsteps);
+      if (nd!=m->steps_per_checkpoint) {
+        // New checkpoint spacing, the backward problem is recreated in resetB
+        CVodeAdjFree(m->mem);
+        casadi_int interpType = interp_==SD_HERMITE ? CV_HERMITE : CV_POLYNOMIAL;
+        THROWING(CVodeAdjInit, m->mem, nd, interpType);
+        m->steps_per_checkpoint = nd;
+        m->first_callB = true;
+      } else {
+        THROWING(CVodeAdjReInit, m->mem);
+      }
     }
 
     // Set the stop time of the integration -- don't integrate past this point
@@ -269,8 +299,24 @@ namespace casadi {
         // ... with taping
         THROWING(CVodeF, m->mem, t, m->xz, &m->t, CV_NORMAL, &m->ncheck);
       } else {
-        // ... without taping
-        THROWING(CVode, m->mem, t, m->xz, &m->t, CV_NORMAL);
+        // ... without taping, restarting after each event
+        while (fabs(m->t-t)>=ttol) {
+          int flag = CVode(m->mem, t, m->xz, &m->t, CV_NORMAL);
+          cvodes_error("CVode", flag);
+          if (flag!=CV_ROOT_RETURN) continue;
+          // Apply the state transitions at the located zero crossing
+          THROWING(CVodeGetRootInfo, m->mem, get_ptr(m->iroot));
+          if (nq_>0) {
+            double tret;
+            THROWING(CVodeGetQuad, m->mem, &tret, m->q);
+          }
+          for (casadi_int i=0; i<ne_; ++i) {
+            if (m->iroot[i]) apply_event(m, m->t, i, NV_DATA_S(m->xz), nullptr, m->p);
+          }
+          THROWING(CVodeReInit, m->mem, m->t, m->xz);
+          if (nq_>0) THROWING(CVodeQuadReInit, m->mem, m->q);
+          if (stop_at_end_) setStopTime(m, grid_.back());
+        }
       }
 
       // Get quadratures
@@ -289,6 +335,10 @@ namespace casadi {
              &m->netfails, &m->qlast, &m->qcur, &m->hinused,
              &m->hlast, &m->hcur, &m->tcur);
     THROWING(CVodeGetNonlinSolvStats, m->mem, &m->nniters, &m->nncfails);
+    m->trace.record(m->nsteps, {m->tcur, m->hlast, static_cast<double>(m->qlast),
+                                static_cast<double>(m->nniters), static_cast<double>(m->netfails),
+                                static_cast<double>(m->nncfails)});
+    m->ncalls_rhs = m->fstats.at("odeF").n_call;
   }
 
   void CvodesInterface::resetB(IntegratorMemory* mem, double t, const double* rx,
@@ -304,6 +354,7 @@ namespace casadi {
       THROWING(CVodeInitB, m->mem, m->whichB, rhsB, grid_.back(), m->rxz);
       THROWING(CVodeSStolerancesB, m->mem, m->whichB, reltol_, abstol_);
       THROWING(CVodeSetUserDataB, m->mem, m->whichB, m);
+      THROWING(CVodeSetMaxNumStepsB, m->mem, m->whichB, max_num_steps_);
       if (newton_scheme_==SD_DIRECT) {
         // Direct scheme
         CVodeMem cv_mem = static_cast<CVodeMem>(m->mem);
@@ -339,6 +390,9 @@ namespace casadi {
     } else {
       THROWING(CVodeReInitB, m->mem, m->whichB, grid_.back(), m->rxz);
       THROWING(CVodeQuadReInitB, m->mem, m->whichB, m->rq);
+      if (warm_start_ && m->hinusedB>0) {
+        THROWING(CVodeSetInitStepB, m->mem, m->whichB, m->hinusedB);
+      }
     }
   }
 
@@ -366,6 +420,7 @@ namespace casadi {
            &m->nfevalsB, &m->nlinsetupsB, &m->netfailsB, &m->qlastB,
            &m->qcurB, &m->hinusedB, &m->hlastB, &m->hcurB, &m->tcurB);
     THROWING(CVodeGetNonlinSolvStats, cvB_mem->cv_mem, &m->nnitersB, &m->nncfailsB);
+    m->nfevals_recompute = m->fstats.at("odeF").n_call - m->ncalls_rhs;
   }
 
   void CvodesInterface::cvodes_error(const char* module, int flag) {
@@ -393,6 +448,19 @@ namespace casadi {
     }
   }
 
+  int CvodesInterface::rootF(double t, N_Vector x, double* e, void *user_data) {
+    try {
+      casadi_assert_dev(user_data);
+      auto m = to_mem(user_data);
+      auto& s = m->self;
+      s.calc_event(m, t, NV_DATA_S(x), nullptr, m->p, e);
+      return 0;
+    } catch(exception& ex) {
+      uerr() << "rootF failed: " << ex.what() << endl;
+      return -1;
+    }
+  }
+
   int CvodesInterface::rhsQ(double t, N_Vector x, N_Vector qdot, void *user_data) {
     try {
       auto m = to_mem(user_data);
@@ -524,8 +592,7 @@ namespace casadi {
       casadi_copy(v, s.nx_, m->v1);
 
       // Solve for undifferentiated right-hand-side, save to output
-      if (s.linsolF_.solve(m->jac, m->v1, 1, false, m->mem_linsolF))
-        casadi_error("Linear system solve failed");
+      s.solveF(m, t, NV_DATA_S(x), gamma, m->v1, 1);
       v = NV_DATA_S(z); // possibly different from r
       casadi_copy(m->v1, s.nx1_, v);
 
@@ -547,8 +614,7 @@ namespace casadi {
         }
 
         // Solve for sensitivity right-hand-sides
-        if (s.linsolF_.solve(m->jac, m->v1 + s.nx1_, s.ns_, false, m->mem_linsolF))
-          casadi_error("Linear solve failed");
+        s.solveF(m, t, NV_DATA_S(x), gamma, m->v1 + s.nx1_, s.ns_);
 
         // Save to output, reordered
         casadi_copy(m->v1 + s.nx1_, s.nx_-s.nx1_, v+s.nx1_);
@@ -626,6 +692,12 @@ namespace casadi {
       // Store gamma for later
       m->gamma = gamma;
 
+      // User preconditioner instead of the factorized Jacobian
+      if (s.user_prec_) {
+        s.setupF(m, t, NV_DATA_S(x), gamma);
+        return 0;
+      }
+
       // Calculate Jacobian
       double d1 = -gamma, d2 = 1.;
       m->arg[0] = &t;
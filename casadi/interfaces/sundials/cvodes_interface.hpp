@@ -160,6 +160,7 @@ namespace casadi {
     static void ehfun(int error_code, const char *module, const char *function, char *msg,
                       void *user_data);
     static int rhsQ(double t, N_Vector x, N_Vector qdot, void *user_data);
+    static int rootF(double t, N_Vector x, double* e, void *user_data);
     static int rhsB(double t, N_Vector x, N_Vector xB, N_Vector xdotB, void *user_data);
     static int rhsQB(double t, N_Vector x, N_Vector xB, N_Vector qdotB, void *user_data);
     static int jtimes(N_Vector v, N_Vector Jv, double t, N_Vector x, N_Vector xdot,
@@ -193,6 +194,7 @@ namespace casadi {
 
     casadi_int lmm_; // linear multistep method
     casadi_int iter_; // nonlinear solver iteration
+    bool warm_start_; // reuse the initial step size of the previous call
   };
 
 } // namespace casadi
@@ -360,6 +360,13 @@ namespace casadi {
 
     if (verbose_) casadi_message("Attached linear solver");
 
+    // Event functions
+    if (ne_>0) {
+      THROWING(IDARootInit, m->mem, ne_, rootF);
+      std::vector<int> dir(event_direction_.begin(), event_direction_.end());
+      THROWING(IDASetRootDirection, m->mem, get_ptr(dir));
+    }
+
     // Adjoint sensitivity problem
     if (nrx_>0) {
       m->rxzdot = N_VNew_Serial(nrx_+nrz_);
@@ -372,6 +379,7 @@ namespace casadi {
     if (nrx_>0) {
       int interpType = interp_==SD_HERMITE ? IDA_HERMITE : IDA_POLYNOMIAL;
       THROWING(IDAAdjInit, m->mem, steps_per_checkpoint_, interpType);
+      m->steps_per_checkpoint = steps_per_checkpoint_;
     }
 
     m->first_callB = true;
@@ -400,7 +408,20 @@ namespace casadi {
     }
 
     // Re-initialize backward integration
-    if (nrx_>0) THROWING(IDAAdjReInit, m->mem);
+    if (nrx_>0) {
+      casadi_int nd = m->steps_per_checkpoint;
+      if (checkpoint_memory_>0 && m->nsteps>0) nd = steps_per_checkpoint(m->nsteps);
+      if (nd!=m->steps_per_checkpoint) {
+        // New checkpoint spacing, the backward problem is recreated in resetB
+        IDAAdjFree(m->mem);
+        int interpType = interp_==SD_HERMITE ? IDA_HERMITE : IDA_POLYNOMIAL;
+        THROWING(IDAAdjInit, m->mem, nd, interpType);
+        m->steps_per_checkpoint = nd;
+        m->first_callB = true;
+      } else {
+        THROWING(IDAAdjReInit, m->mem);
+      }
+    }
 
     // Set the stop time of the integration -- don't integrate past this point
     if (stop_at_end_) setStopTime(m, grid_.back());
@@ -424,8 +445,30 @@ namespace casadi {
       // Integrate forward ...
       if (nrx_>0) { // ... with taping
         THROWING(IDASolveF, m->mem, t, &m->t, m->xz, m->xzdot, IDA_NORMAL, &m->ncheck);
-      } else { // ... without taping
-        THROWING(IDASolve, m->mem, t, &m->t, m->xz, m->xzdot, IDA_NORMAL);
+      } else { // ... without taping, restarting after each event
+        while (fabs(m->t-t)>=ttol) {
+          int flag = IDASolve(m->mem, t, &m->t, m->xz, m->xzdot, IDA_NORMAL);
+          idas_error("IDASolve", flag);
+          if (flag!=IDA_ROOT_RETURN) continue;
+          // Apply the state transitions at the located zero crossing
+          THROWING(IDAGetRootInfo, m->mem, get_ptr(m->iroot));
+          if (nq_>0) {
+            double tret;
+            THROWING(IDAGetQuad, m->mem, &tret, m->q);
+          }
+          double* xz = NV_DATA_S(m->xz);
+          for (casadi_int i=0; i<ne_; ++i) {
+            if (m->iroot[i]) apply_event(m, m->t, i, xz, xz+nx_, m->p);
+          }
+          // Restart with consistent algebraic states and derivatives
+          THROWING(IDAReInit, m->mem, m->t, m->xz, m->xzdot);
+          if (nq_>0) THROWING(IDAQuadReInit, m->mem, m->q);
+          if (fabs(m->t-t)>=ttol) {
+            THROWING(IDACalcIC, m->mem, IDA_YA_YDP_INIT, t);
+            THROWING(IDAGetConsistentIC, m->mem, m->xz, m->xzdot);
+          }
+          if (stop_at_end_) setStopTime(m, grid_.back());
+        }
       }
 
       // Get quadratures
@@ -445,7 +488,10 @@ namespace casadi {
              &m->netfails, &m->qlast, &m->qcur, &m->hinused,
              &m->hlast, &m->hcur, &m->tcur);
     THROWING(IDAGetNonlinSolvStats, m->mem, &m->nniters, &m->nncfails);
-
+    m->trace.record(m->nsteps, {m->tcur, m->hlast, static_cast<double>(m->qlast),
+                                static_cast<double>(m->nniters), static_cast<double>(m->netfails),
+                                static_cast<double>(m->nncfails)});
+    m->ncalls_rhs = m->fstats.at("daeF").n_call;
   }
 
   void IdasInterface::resetB(IntegratorMemory* mem, double t, const double* rx,
@@ -547,6 +593,7 @@ namespace casadi {
              &m->nlinsetupsB, &m->netfailsB, &m->qlastB, &m->qcurB, &m->hinusedB,
              &m->hlastB, &m->hcurB, &m->tcurB);
     THROWING(IDAGetNonlinSolvStats, IDAB_mem->IDA_mem, &m->nnitersB, &m->nncfailsB);
+    m->nfevals_recompute = m->fstats.at("daeF").n_call - m->ncalls_rhs;
   }
 
   void IdasInterface::idas_error(const char* module, int flag) {
@@ -581,6 +628,19 @@ namespace casadi {
     }
   }
 
+  int IdasInterface::rootF(double t, N_Vector xz, N_Vector xzdot, double* e,
+                           void *user_data) {
+    try {
+      auto m = to_mem(user_data);
+      auto& s = m->self;
+      s.calc_event(m, t, NV_DATA_S(xz), NV_DATA_S(xz)+s.nx_, m->p, e);
+      return 0;
+    } catch(exception& ex) {
+      uerr() << "rootF failed: " << ex.what() << endl;
+      return -1;
+    }
+  }
+
   int IdasInterface::resB(double t, N_Vector xz, N_Vector xzdot, N_Vector rxz,
                                  N_Vector rxzdot, N_Vector rr, void *user_data) {
     try {
@@ -662,8 +722,7 @@ namespace casadi {
       }
 
       // Solve for undifferentiated right-hand-side, save to output
-      if (s.linsolF_.solve(m->jac, m->v1, 1, false, m->mem_linsolF))
-        casadi_error("'jac' solve failed");
+      s.solveF(m, t, NV_DATA_S(xz), cj, m->v1, 1);
       vx = NV_DATA_S(zvec); // possibly different from rvec
       vz = vx + s.nx_;
       casadi_copy(m->v1, s.nx1_, vx);
@@ -697,9 +756,7 @@ namespace casadi {
         }
 
         // Solve for sensitivity right-hand-sides
-        if (s.linsolF_.solve(m->jac, m->v1 + s.nx1_ + s.nz1_, s.ns_, false, m->mem_linsolF)) {
-          casadi_error("'jac' solve failed");
-        }
+        s.solveF(m, t, NV_DATA_S(xz), cj, m->v1 + s.nx1_ + s.nz1_, s.ns_);
 
         // Save to output, reordered
         v_it = m->v1 + s.nx1_ + s.nz1_;
@@ -809,6 +866,13 @@ namespace casadi {
     try {
       auto m = to_mem(user_data);
       auto& s = m->self;
+
+      // User preconditioner instead of the factorized Jacobian
+      if (s.user_prec_) {
+        s.setupF(m, t, NV_DATA_S(xz), cj);
+        return 0;
+      }
+
       m->arg[0] = &t;
       m->arg[1] = NV_DATA_S(xz);
       m->arg[2] = NV_DATA_S(xz)+s.nx_;
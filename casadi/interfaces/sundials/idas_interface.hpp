@@ -167,6 +167,7 @@ namespace casadi {
                        N_Vector resvalB, N_Vector vB, N_Vector JvB, double cjB,
                        void *user_data, N_Vector tmp1B, N_Vector tmp2B);
     static int rhsQ(double t, N_Vector xz, N_Vector xzdot, N_Vector qdot, void *user_data);
+    static int rootF(double t, N_Vector xz, N_Vector xzdot, double* e, void *user_data);
     static int rhsQB(double t, N_Vector xz, N_Vector xzdot, N_Vector xzB, N_Vector xzdotB,
                      N_Vector qdotA, void *user_data);
     static int psolve(double t, N_Vector xz, N_Vector xzdot, N_Vector rr, N_Vector rvec,
@@ -71,6 +71,8 @@ namespace casadi {
 
     // Default options
     exact_jac_ = true;
+    reuse_jac_ = false;
+    max_setup_calls_ = 0;
     disable_internal_warnings_ = false;
     max_iter_ = 0;
     maxl_ = 0;
@@ -109,6 +111,15 @@ namespace casadi {
       {"exact_jacobian",
        {OT_BOOL,
         "Use exact Jacobian information"}},
+      {"reuse_jacobian",
+       {OT_BOOL,
+        "Start from the Jacobian (factorization) of the previous call instead of "
+        "updating it at the initial guess. Useful for sequences of closely related "
+        "problems [default: false]"}},
+      {"max_setup_calls",
+       {OT_INT,
+        "Maximum number of nonlinear iterations between Jacobian updates. "
+        "Putting 0 sets the default value of KinSol."}},
       {"iterative_solver",
        {OT_STRING,
         "gmres|bcgstab|tfqmr"}},
@@ -150,6 +161,10 @@ namespace casadi {
         strategy = op.second.to_string();
       } else if (op.first=="exact_jacobian") {
         exact_jac_ = op.second;
+      } else if (op.first=="reuse_jacobian") {
+        reuse_jac_ = op.second;
+      } else if (op.first=="max_setup_calls") {
+        max_setup_calls_ = op.second;
       } else if (op.first=="u_scale") {
         u_scale = op.second;
       } else if (op.first=="f_scale") {
@@ -268,9 +283,19 @@ namespace casadi {
     // Get the initial guess
     casadi_copy(m->iarg[iin_], nnz_in(iin_), NV_DATA_S(m->u));
 
+    // Skip the initial Jacobian update if one is available from the previous call
+    m->njac = 0;
+    if (reuse_jac_) {
+      int flag = KINSetNoInitSetup(m->mem, m->has_jac);
+      casadi_assert(flag==KIN_SUCCESS, "KINSetNoInitSetup");
+    }
+
     // Solve the nonlinear system of equations
     int flag = KINSol(m->mem, m->u, strategy_, u_scale_, f_scale_);
     m->success = flag>= KIN_SUCCESS;
+
+    // Only reuse a Jacobian that led to convergence
+    m->has_jac = m->success && (m->has_jac || m->njac>0);
     if (flag<KIN_SUCCESS) kinsol_error("KINSol", flag, error_on_fail_);
 
     // Warn if not successful return
@@ -350,6 +375,7 @@ namespace casadi {
   void KinsolInterface::djac(KinsolMemory& m, long N, N_Vector u, N_Vector fu, DlsMat J,
                           N_Vector tmp1, N_Vector tmp2) const {
     // Evaluate jac_
+    m.njac++;
     copy_n(m.iarg, n_in_, m.arg);
     m.arg[iin_] = NV_DATA_S(u);
     fill_n(m.res, n_out_+1, nullptr);
@@ -391,6 +417,7 @@ namespace casadi {
   void KinsolInterface::bjac(KinsolMemory& m, long N, long mupper, long mlower, N_Vector u,
                           N_Vector fu, DlsMat J, N_Vector tmp1, N_Vector tmp2) const {
     // Evaluate jac_
+    m.njac++;
     copy_n(m.iarg, n_in_, m.arg);
     m.arg[iin_] = NV_DATA_S(u);
     fill_n(m.res, n_out_+1, nullptr);
@@ -458,6 +485,7 @@ namespace casadi {
   psetup(KinsolMemory& m, N_Vector u, N_Vector uscale, N_Vector fval,
          N_Vector fscale, N_Vector tmp1, N_Vector tmp2) const {
     // Evaluate jac_
+    m.njac++;
     copy_n(m.iarg, n_in_, m.arg);
     m.arg[iin_] = NV_DATA_S(u);
     fill_n(m.res, n_out_+1, nullptr);
@@ -683,6 +711,8 @@ namespace casadi {
   KinsolMemory::KinsolMemory(const KinsolInterface& s) : self(s) {
     this->u = nullptr;
     this->mem = nullptr;
+    this->has_jac = false;
+    this->njac = 0;
   }
 
   KinsolMemory::~KinsolMemory() {
@@ -720,6 +750,12 @@ namespace casadi {
     flag = KINSetMaxNewtonStep(m->mem, max_iter_);
     casadi_assert_dev(flag==KIN_SUCCESS);
 
+    // Maximum number of nonlinear iterations between Jacobian updates
+    if (max_setup_calls_>0) {
+      flag = KINSetMaxSetupCalls(m->mem, max_setup_calls_);
+      casadi_assert(flag==KIN_SUCCESS, "KINSetMaxSetupCalls");
+    }
+
     // Set constraints
     if (!u_c_.empty()) {
       N_Vector domain  = N_VNew_Serial(n_);
@@ -799,4 +835,14 @@ namespace casadi {
     return 0;
   }
 
+  Dict KinsolInterface::get_stats(void* mem) const {
+    Dict stats = Rootfinder::get_stats(mem);
+    auto m = static_cast<KinsolMemory*>(mem);
+    long iter = 0;
+    if (m->mem) KINGetNumNonlinSolvIters(m->mem, &iter);
+    stats["iter_count"] = static_cast<casadi_int>(iter);
+    stats["n_jac"] = m->njac;
+    return stats;
+  }
+
 } // namespace casadi
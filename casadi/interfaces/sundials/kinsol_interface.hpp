@@ -70,6 +70,12 @@ namespace casadi {
 
     // Current Jacobian
     double* jac;
+
+    // Is there a Jacobian from a previous call that can be reused
+    bool has_jac;
+
+    // Number of Jacobian evaluations in the last call
+    casadi_int njac;
   };
 
   /** \brief \pluginbrief{Rootfinder,kinsol}
@@ -123,6 +129,12 @@ namespace casadi {
     // Use exact Jacobian?
     bool exact_jac_;
 
+    // Reuse the Jacobian of the previous call
+    bool reuse_jac_;
+
+    // Maximum number of nonlinear iterations between Jacobian updates
+    casadi_int max_setup_calls_;
+
     // Type of linear solver
     enum LinsolType { DENSE, BANDED, ITERATIVE, USER_DEFINED};
     LinsolType linear_solver_type_;
@@ -164,6 +176,9 @@ namespace casadi {
     /** \brief Free memory block */
     void free_mem(void *mem) const override { delete static_cast<KinsolMemory*>(mem);}
 
+    /// Get all statistics
+    Dict get_stats(void* mem) const override;
+
     /** \brief Set the (persistent) work vectors */
     void set_work(void* mem, const double**& arg, double**& res,
                           casadi_int*& iw, double*& w) const override;
@@ -81,6 +81,11 @@ namespace casadi {
       {"steps_per_checkpoint",
        {OT_INT,
         "Number of steps between two consecutive checkpoints"}},
+      {"checkpoint_memory",
+       {OT_INT,
+        "Memory budget in bytes for the adjoint checkpoints and interpolation data. "
+        "If positive, steps_per_checkpoint is only used for the first call, after which "
+        "the spacing is chosen from the number of steps of the previous call [default: 0]"}},
       {"interpolation_type",
        {OT_STRING,
         "Type of interpolation for the adjoint sensitivities"}},
@@ -101,7 +106,18 @@ namespace casadi {
         "Maximum order"}},
       {"nonlin_conv_coeff",
        {OT_DOUBLE,
-        "Coefficient in the nonlinear convergence test"}}
+        "Coefficient in the nonlinear convergence test"}},
+      {"preconditioner",
+       {OT_FUNCTION,
+        "Preconditioner for an iterative newton_scheme, replacing the factorized Jacobian: "
+        "(t, x, z, p, c, v) -> (w) with w approximately solving the linear system of the "
+        "Newton iteration with the scaling factor c, i.e. (I - c*df/dx) w = v for cvodes, "
+        "where z is empty, and [df/dx - c*I, df/dz; dg/dx, dg/dz] w = v for idas. "
+        "With preconditioner_setup, the inputs are (d, v) instead"}},
+      {"preconditioner_setup",
+       {OT_FUNCTION,
+        "Setup for the preconditioner, evaluated when SUNDIALS sets up the preconditioner: "
+        "(t, x, z, p, c) -> (d)"}}
      }
   };
 
@@ -125,6 +141,7 @@ namespace casadi {
     quad_err_con_ = false;
     string interpolation_type = "hermite";
     steps_per_checkpoint_ = 20;
+    checkpoint_memory_ = 0;
     disable_internal_warnings_ = false;
     max_multistep_order_ = 5;
     second_order_correction_ = true;
@@ -133,6 +150,7 @@ namespace casadi {
     nonlin_conv_coeff_ = 0;
 
     // Read options
+    Function prec, prec_setup;
     for (auto&& op : opts) {
       if (op.first=="abstol") {
         abstol_ = op.second;
@@ -158,6 +176,8 @@ namespace casadi {
         interpolation_type = op.second.to_string();
       } else if (op.first=="steps_per_checkpoint") {
         steps_per_checkpoint_ = op.second;
+      } else if (op.first=="checkpoint_memory") {
+        checkpoint_memory_ = op.second;
       } else if (op.first=="disable_internal_warnings") {
         disable_internal_warnings_ = op.second;
       } else if (op.first=="max_multistep_order") {
@@ -170,6 +190,10 @@ namespace casadi {
         max_order_ = op.second;
       } else if (op.first=="nonlin_conv_coeff") {
         nonlin_conv_coeff_ = op.second;
+      } else if (op.first=="preconditioner") {
+        prec = op.second;
+      } else if (op.first=="preconditioner_setup") {
+        prec_setup = op.second;
       }
     }
 
@@ -222,13 +246,72 @@ namespace casadi {
     alloc_w(nrp_, true); // rp
     alloc_w(2*max(nx_+nz_, nrx_+nrz_), true); // v1, v2
 
-    // Allocate linear solvers
-    linsolF_ = Linsol("linsolF", linear_solver_,
-      get_function("jacF").sparsity_out(0), linear_solver_options_);
+    // User preconditioner
+    user_prec_ = !prec.is_null();
+    user_prec_setup_ = !prec_setup.is_null();
+    if (user_prec_) {
+      casadi_assert(newton_scheme_!=SD_DIRECT && use_precon_,
+        "'preconditioner' requires an iterative newton_scheme and use_preconditioner");
+      casadi_int nxz1 = nx1_ + nz1_;
+      if (user_prec_setup_) {
+        casadi_assert(prec_setup.n_in()==5 && prec_setup.n_out()==1,
+          "'preconditioner_setup' must have the inputs (t, x, z, p, c) and one output");
+        casadi_assert(prec_setup.nnz_in(1)==nx1_ && prec_setup.nnz_in(2)==nz1_
+                      && prec_setup.nnz_in(3)==np1_,
+          "'preconditioner_setup': dimension mismatch for x, z or p");
+        casadi_assert(prec.n_in()==2 && prec.n_out()==1,
+          "'preconditioner' must have the inputs (d, v) when 'preconditioner_setup' is given");
+        casadi_assert(prec.nnz_in(0)==prec_setup.nnz_out(0),
+          "'preconditioner': input d does not match the output of 'preconditioner_setup'");
+        set_function(prec_setup, "precsetupF");
+      } else {
+        casadi_assert(prec.n_in()==6 && prec.n_out()==1,
+          "'preconditioner' must have the inputs (t, x, z, p, c, v) and one output");
+        casadi_assert(prec.nnz_in(1)==nx1_ && prec.nnz_in(2)==nz1_ && prec.nnz_in(3)==np1_,
+          "'preconditioner': dimension mismatch for x, z or p");
+      }
+      casadi_assert(prec.nnz_in(prec.n_in()-1)==nxz1 && prec.nnz_out(0)==nxz1,
+        "'preconditioner': v and w must have " + str(nxz1) + " nonzeros");
+      set_function(prec, "precF");
+    }
+
+    // Allocate linear solvers, sharing the symbolic analysis with the nondifferentiated
+    // integrator when factorizing the same Jacobian, each memory object factorizes separately
+    SundialsInterface* d = ns_==0 ? nullptr : derivative_of_.get<SundialsInterface>();
+    bool share = d!=nullptr && d->ns_==0 && d->linear_solver_==linear_solver_
+      && d->linear_solver_options_==linear_solver_options_;
+    if (share) {
+      linsolF_ = d->linsolF_;
+    } else {
+      linsolF_ = Linsol("linsolF", linear_solver_,
+        get_function("jacF").sparsity_out(0), linear_solver_options_);
+    }
     if (nrx_>0) {
-      linsolB_ = Linsol("linsolB", linear_solver_,
-        get_function("jacB").sparsity_out(0), linear_solver_options_);
+      if (share && !d->linsolB_.is_null()) {
+        linsolB_ = d->linsolB_;
+      } else {
+        linsolB_ = Linsol("linsolB", linear_solver_,
+          get_function("jacB").sparsity_out(0), linear_solver_options_);
+      }
+    }
+  }
+
+  void SundialsInterface::memory_usage(std::map<std::string, casadi_int>& usage,
+                                       std::set<const void*>& visited) const {
+    Integrator::memory_usage(usage, visited);
+    // Per memory object: the N-vectors and, as an estimate, one vector per history
+    // entry of the multistep method and ten for temporaries, forward and backward
+    casadi_int n = nx_+nz_+nq_, nr = nrx_+nrz_+nrq_;
+    casadi_int per_mem = sizeof(SundialsMemory) + (n+nr)*sizeof(double)
+      + (max_multistep_order_+10)*(n + nr)*sizeof(double);
+    // Numeric factorizations, at least the nonzeros of the linear systems
+    casadi_int& linsol = usage["linsol"];
+    for (const Linsol* ls : {&linsolF_, &linsolB_}) {
+      if (ls->is_null()) continue;
+      linsol += memory_bytes(ls->sparsity(), visited);
+      per_mem += ls->sparsity().nnz()*sizeof(double);
     }
+    usage["memory"] += n_mem()*per_mem;
   }
 
   int SundialsInterface::init_mem(void* mem) const {
@@ -244,9 +327,55 @@ namespace casadi {
     m->mem_linsolF = linsolF_.checkout();
     if (!linsolB_.is_null()) m->mem_linsolB = linsolB_.checkout();
 
+    // Preconditioner work
+    if (user_prec_setup_) m->prec_data.resize(get_function("precsetupF").nnz_out(0));
+    if (user_prec_) m->prec_w.resize(nx1_ + nz1_);
+
+    // Event detection
+    m->iroot.resize(ne_);
+
     return 0;
   }
 
+  void SundialsInterface::setupF(SundialsMemory* m, double t, const double* xz, double c) const {
+    if (!user_prec_setup_) return;
+    m->arg[0] = &t;
+    m->arg[1] = xz;
+    m->arg[2] = xz + nx_;
+    m->arg[3] = m->p;
+    m->arg[4] = &c;
+    m->res[0] = get_ptr(m->prec_data);
+    if (calc_function(m, "precsetupF")) casadi_error("'preconditioner_setup' failed");
+  }
+
+  void SundialsInterface::solveF(SundialsMemory* m, double t, const double* xz, double c,
+                                 double* v, casadi_int nrhs) const {
+    if (!user_prec_) {
+      if (linsolF_.solve(m->jac, v, nrhs, false, m->mem_linsolF)) {
+        casadi_error("Linear system solve failed");
+      }
+      return;
+    }
+    casadi_int nxz1 = nx1_ + nz1_;
+    for (casadi_int r=0; r<nrhs; ++r) {
+      if (user_prec_setup_) {
+        m->arg[0] = get_ptr(m->prec_data);
+        m->arg[1] = v;
+      } else {
+        m->arg[0] = &t;
+        m->arg[1] = xz;
+        m->arg[2] = xz + nx_;
+        m->arg[3] = m->p;
+        m->arg[4] = &c;
+        m->arg[5] = v;
+      }
+      m->res[0] = get_ptr(m->prec_w);
+      if (calc_function(m, "precF")) casadi_error("'preconditioner' failed");
+      casadi_copy(get_ptr(m->prec_w), nxz1, v);
+      v += nxz1;
+    }
+  }
+
   void SundialsInterface::free_mem(void *mem) const {
     Integrator::free_mem(mem);
     auto m = static_cast<SundialsMemory*>(mem);
@@ -296,6 +425,11 @@ namespace casadi {
     this->rxz = nullptr;
     this->rq = nullptr;
     this->first_callB = true;
+    this->nsteps = 0;
+    this->ncheck = 0;
+    this->steps_per_checkpoint = 0;
+    this->ncalls_rhs = this->nfevals_recompute = 0;
+    this->hinused = this->hinusedB = 0;
   }
 
   SundialsMemory::~SundialsMemory() {
@@ -305,6 +439,25 @@ namespace casadi {
     if (this->rq) N_VDestroy_Serial(this->rq);
   }
 
+  casadi_int SundialsInterface::steps_per_checkpoint(casadi_int nsteps) const {
+    // Bytes per checkpoint (history array of the state and quadratures) and per stored step
+    double c_ck = static_cast<double>((max_multistep_order_+1)*(nx_+nz_+nq_)*sizeof(double));
+    double c_dt = static_cast<double>((interp_==SD_HERMITE ? 2 : 1)*(nx_+nz_)*sizeof(double));
+    double b = static_cast<double>(checkpoint_memory_), n = static_cast<double>(nsteps);
+
+    // Largest spacing d with n/d checkpoints and d stored steps within the budget
+    double disc = b*b - 4*c_dt*c_ck*n, d;
+    if (disc<0) {
+      d = sqrt(c_ck*n/c_dt);
+      casadi_warning(name_ + ": checkpoint_memory too small for " + str(nsteps) + " steps, "
+                     "need at least " + str(static_cast<casadi_int>(2*sqrt(c_dt*c_ck*n)))
+                     + " bytes");
+    } else {
+      d = (b + sqrt(disc))/(2*c_dt);
+    }
+    return std::max(casadi_int(1), std::min(nsteps, static_cast<casadi_int>(d)));
+  }
+
   Dict SundialsInterface::get_stats(void* mem) const {
     Dict stats = Integrator::get_stats(mem);
     auto m = static_cast<SundialsMemory*>(mem);
@@ -336,6 +489,13 @@ namespace casadi {
     stats["tcurB"] = m->tcurB;
     stats["nnitersB"] = static_cast<casadi_int>(m->nnitersB);
     stats["nncfailsB"] = static_cast<casadi_int>(m->nncfailsB);
+
+    // Adjoint checkpointing
+    if (nrx_>0) {
+      stats["ncheckpoints"] = static_cast<casadi_int>(m->ncheck);
+      stats["steps_per_checkpoint"] = m->steps_per_checkpoint;
+      stats["nfevals_recompute"] = m->nfevals_recompute;
+    }
     return stats;
   }
 
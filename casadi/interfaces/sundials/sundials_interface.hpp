@@ -76,9 +76,21 @@ namespace casadi {
     /// number of checkpoints stored so far
     int ncheck;
 
+    /// Current checkpoint spacing of the adjoint problem
+    casadi_int steps_per_checkpoint;
+
+    /// Forward right-hand side evaluations after the forward problem, and during the backward one
+    casadi_int ncalls_rhs, nfevals_recompute;
+
     /// Linear solver memory objects
     casadi_int mem_linsolF, mem_linsolB;
 
+    /// Output of the preconditioner setup and a right-hand side for the preconditioner
+    std::vector<double> prec_data, prec_w;
+
+    /// Zero crossings found by the root finder
+    std::vector<int> iroot;
+
     /// Constructor
     SundialsMemory();
 
@@ -118,9 +130,28 @@ namespace casadi {
     // Get system Jacobian
     virtual Function getJ(bool backward) const = 0;
 
+    /// Checkpoint spacing for the memory budget checkpoint_memory, given the number of steps
+    casadi_int steps_per_checkpoint(casadi_int nsteps) const;
+
+    /// Set up the forward preconditioner at [x;z] with the scaling factor c (gamma or cj)
+    void setupF(SundialsMemory* m, double t, const double* xz, double c) const;
+
+    /// Apply the forward preconditioner to nrhs right-hand sides of length nx1_+nz1_, in place
+    void solveF(SundialsMemory* m, double t, const double* xz, double c,
+                double* v, casadi_int nrhs) const;
+
     /// Get all statistics
     Dict get_stats(void* mem) const override;
 
+    /// Columns of the iteration trace, one record per output time
+    std::vector<std::string> trace_columns() const override {
+      return {"t", "h", "order", "n_newton", "n_err_fail", "n_conv_fail"};
+    }
+
+    /** \brief Add the estimated heap memory, including the SUNDIALS internals */
+    void memory_usage(std::map<std::string, casadi_int>& usage,
+                      std::set<const void*>& visited) const override;
+
     /** \brief  Print solver statistics */
     void print_stats(IntegratorMemory* mem) const override;
 
@@ -146,6 +177,7 @@ namespace casadi {
     bool stop_at_end_;
     bool quad_err_con_;
     casadi_int steps_per_checkpoint_;
+    casadi_int checkpoint_memory_;
     bool disable_internal_warnings_;
     casadi_int max_multistep_order_;
     std::string linear_solver_;
@@ -161,6 +193,9 @@ namespace casadi {
     /// Linear solver
     Linsol linsolF_, linsolB_;
 
+    /// User preconditioner for the forward problem, replacing linsolF_
+    bool user_prec_, user_prec_setup_;
+
     /// Supported iterative solvers in Sundials
     enum NewtonScheme {SD_DIRECT, SD_GMRES, SD_BCGSTAB, SD_TFQMR} newton_scheme_;
 
@@ -132,8 +132,26 @@ namespace casadi {
                                   {{"gamma", {"f", "g"}}});
     hesslag_sp_ = hess_l_fcn_.sparsity_out(0);
 
+    // Nonzero of the Hessian for each entry of HM.val, -1 for a structural zero:
+    // strictly lower triangular part first (CCS -> CRS format change), then the diagonal
+    const casadi_int* colind = hesslag_sp_.colind();
+    const casadi_int* row = hesslag_sp_.row();
+    hm_nz_.clear();
+    hm_nz_.reserve(nx_ + hesslag_sp_.nnz_lower(true));
+    std::vector<casadi_int> diag_nz(nx_, -1);
+    for (casadi_int c=0; c<nx_; ++c) {
+      for (casadi_int el=colind[c]; el<colind[c+1]; ++el) {
+        if (row[el]>c) {
+          hm_nz_.push_back(el);
+        } else if (row[el]==c) {
+          diag_nz[c] = el;
+        }
+      }
+    }
+    hm_nz_.insert(hm_nz_.end(), diag_nz.begin(), diag_nz.end());
+
     // Temporary vectors
-    alloc_w(nx_); // for fetching diagonal entries form Hessian
+    alloc_w(hesslag_sp_.nnz(), true); // hess_lk
   }
 
   void worhp_disp(int mode, const char message[]) {
@@ -266,6 +284,9 @@ namespace casadi {
     // Set work in base classes
     Nlpsol::set_work(mem, arg, res, iw, w);
 
+    // Hessian nonzeros
+    m->hess_lk = w; w += hesslag_sp_.nnz();
+
     // Free existing Worhp memory (except parameters)
     m->worhp_p.initialised = false; // Avoid freeing the memory for parameters
     if (m->worhp_o.initialised || m->worhp_w.initialised || m->worhp_c.initialised) {
@@ -482,28 +503,14 @@ namespace casadi {
         m->arg[1] = m->p;
         m->arg[2] = &m->worhp_w.ScaleObj;
         m->arg[3] = m->worhp_o.Mu;
-        m->res[0] = m->worhp_w.HM.val;
+        m->res[0] = m->hess_lk;
         calc_function(m, "nlp_hess_l");
-        // Diagonal values
-        double *dval = m->w;
-        casadi_fill(dval, nx_, 0.);
-
-        // Remove diagonal
-        const casadi_int* colind = hesslag_sp_.colind();
-        const casadi_int* row = hesslag_sp_.row();
-        casadi_int ind=0;
-        for (casadi_int c=0; c<nx_; ++c) {
-          for (casadi_int el=colind[c]; el<colind[c+1]; ++el) {
-            if (row[el]==c) {
-              dval[c] = m->worhp_w.HM.val[el];
-            } else {
-              m->worhp_w.HM.val[ind++] = m->worhp_w.HM.val[el];
-            }
-          }
-        }
 
-        // Add diagonal entries at the end
-        casadi_copy(dval, nx_, m->worhp_w.HM.val+ind);
+        // Reorder into HM.val, diagonal entries at the end
+        for (casadi_int k=0; k<hm_nz_.size(); ++k) {
+          casadi_int el = hm_nz_[k];
+          m->worhp_w.HM.val[k] = el>=0 ? m->hess_lk[el] : 0;
+        }
         DoneUserAction(&m->worhp_c, evalHM);
       }
 
@@ -53,6 +53,9 @@ namespace casadi {
     Params    worhp_p;
     Control   worhp_c;
 
+    // Hessian nonzeros before reordering into HM.val
+    double* hess_lk;
+
     // Stats
     casadi_int iter;
     casadi_int iter_sqp;
@@ -86,6 +89,9 @@ namespace casadi {
     Sparsity jacg_sp_;
     Sparsity hesslag_sp_;
 
+    /// Hessian nonzero for each entry of HM.val (-1 for zero), computed in init
+    std::vector<casadi_int> hm_nz_;
+
     // Constructor
     explicit WorhpInterface(const std::string& name, const Function& nlp);
 
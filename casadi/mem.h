@@ -45,6 +45,23 @@ extern "C" {
 #define casadi_int long long int
 #endif
 
+/* Maximum number of memory objects that can be checked out concurrently */
+#ifndef CASADI_MAX_NUM_THREADS
+#define CASADI_MAX_NUM_THREADS 16
+#endif
+
+/* Atomically claim (returns nonzero on success) or give back a flag */
+#ifndef casadi_flag_acquire
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define casadi_flag_acquire(p) (_InterlockedExchange((p), 1)==0)
+#define casadi_flag_release(p) _InterlockedExchange((p), 0)
+#else
+#define casadi_flag_acquire(p) (__sync_lock_test_and_set((p), 1)==0)
+#define casadi_flag_release(p) __sync_lock_release(p)
+#endif
+#endif /* casadi_flag_acquire */
+
 /* Function types corresponding to entry points in CasADi's C API */
 typedef void (*casadi_signal_t)(void);
 typedef casadi_int (*casadi_getint_t)(void);
@@ -54,6 +71,8 @@ typedef int (*casadi_work_t)(casadi_int* sz_arg, casadi_int* sz_res,
                              casadi_int* sz_iw, casadi_int* sz_w);
 typedef int (*casadi_eval_t)(const casadi_real** arg, casadi_real** res,
                              casadi_int* iw, casadi_real* w, void* mem);
+typedef void* (*casadi_checkout_t)(void);
+typedef void (*casadi_release_t)(void* mem);
 
 /* Structure to hold meta information about an input or output */
 typedef struct {
@@ -67,9 +86,9 @@ typedef struct {
 } casadi_io;
 
 /* Decompress a sparsity pattern */
-inline void casadi_decompress(const int* sp, int* nrow, int* ncol,
-                              int* nnz, int* numel,
-                              const int** colind, const int** row) {
+static inline void casadi_decompress(const casadi_int* sp, casadi_int* nrow, casadi_int* ncol,
+                              casadi_int* nnz, casadi_int* numel,
+                              const casadi_int** colind, const casadi_int** row) {
   if (sp==0) {
     /* Scalar sparsity pattern if sp is null */
     static const casadi_int scalar_colind[2] = {0, 1};
@@ -100,6 +119,8 @@ typedef struct {
   casadi_sparsity_t sparsity_out;
   casadi_work_t work;
   casadi_eval_t eval;
+  casadi_checkout_t checkout;
+  casadi_release_t release;
 } casadi_functions;
 
 /* Memory needed for evaluation */
@@ -122,7 +143,7 @@ typedef struct {
 } casadi_mem;
 
 /* Initialize */
-inline void casadi_init(casadi_mem* mem, casadi_functions* f) {
+static inline void casadi_init(casadi_mem* mem, casadi_functions* f) {
   int flag;
 
   /* Check arguments */
@@ -148,8 +169,8 @@ inline void casadi_init(casadi_mem* mem, casadi_functions* f) {
     assert(flag==0);
   }
 
-  /* TODO: Check out a memory object */
-  mem->mem = 0;
+  /* Check out a memory object, thread-safe */
+  mem->mem = f->checkout ? f->checkout() : 0;
 
   /* No io structs allocated */
   mem->in = 0;
@@ -163,17 +184,18 @@ inline void casadi_init(casadi_mem* mem, casadi_functions* f) {
 }
 
 /* Free claimed static memory */
-inline void casadi_deinit(casadi_mem* mem) {
+static inline void casadi_deinit(casadi_mem* mem) {
   assert(mem!=0);
 
-  /* TODO: Release a memory object */
+  /* Release the memory object */
+  if (mem->f->release && mem->mem) mem->f->release(mem->mem);
 
   /* Decrease reference counter */
   if (mem->f->decref) mem->f->decref();
 }
 
 /* Initialize */
-inline void casadi_init_arrays(casadi_mem* mem) {
+static inline void casadi_init_arrays(casadi_mem* mem) {
   casadi_int i;
   assert(mem!=0);
   casadi_functions* f = mem->f;
@@ -199,7 +221,7 @@ inline void casadi_init_arrays(casadi_mem* mem) {
 
 /* Allocate dynamic memory */
 #ifndef CASADI_STATIC
-inline int casadi_alloc_arrays(casadi_mem* mem) {
+static inline int casadi_alloc_arrays(casadi_mem* mem) {
   /* Allocate io memory */
   mem->in = (casadi_io*)malloc(mem->n_in*sizeof(casadi_io));
   if (mem->n_in!=0 && mem->in==0) return 1;
@@ -222,7 +244,7 @@ inline int casadi_alloc_arrays(casadi_mem* mem) {
 
 /* Free dynamic memory */
 #ifndef CASADI_STATIC
-inline void casadi_free_arrays(casadi_mem* mem) {
+static inline void casadi_free_arrays(casadi_mem* mem) {
   assert(mem!=0);
 
   /* Free io meta data */
@@ -238,14 +260,14 @@ inline void casadi_free_arrays(casadi_mem* mem) {
 #endif /* CASADI_STATIC */
 
 /* Evaluate */
-inline int casadi_eval(casadi_mem* mem) {
+static inline int casadi_eval(casadi_mem* mem) {
   assert(mem!=0);
   return mem->f->eval(mem->arg, mem->res, mem->iw, mem->w, mem->mem);
 }
 
 /* Create a memory struct with dynamic memory allocation */
 #ifndef CASADI_STATIC
-inline casadi_mem* casadi_alloc(casadi_functions* f) {
+static inline casadi_mem* casadi_alloc(casadi_functions* f) {
   int flag;
 
   /* Allocate struct */
@@ -268,7 +290,7 @@ inline casadi_mem* casadi_alloc(casadi_functions* f) {
 
 /* Free memory struct */
 #ifndef CASADI_STATIC
-inline void casadi_free(casadi_mem* mem) {
+static inline void casadi_free(casadi_mem* mem) {
   assert(mem!=0);
 
   /* Free dynamically allocated arrays */
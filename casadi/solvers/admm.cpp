@@ -0,0 +1,311 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#include "admm.hpp"
+#include <algorithm>
+
+using namespace std;
+namespace casadi {
+
+  extern "C"
+  int CASADI_CONIC_ADMM_EXPORT
+  casadi_register_conic_admm(Conic::Plugin* plugin) {
+    plugin->creator = Admm::creator;
+    plugin->name = "admm";
+    plugin->doc = Admm::meta_doc.c_str();
+    plugin->version = CASADI_VERSION;
+    plugin->options = &Admm::options_;
+    return 0;
+  }
+
+  extern "C"
+  void CASADI_CONIC_ADMM_EXPORT casadi_load_conic_admm() {
+    Conic::registerPlugin(casadi_register_conic_admm);
+  }
+
+  Admm::Admm(const std::string& name, const std::map<std::string, Sparsity> &st)
+    : Conic(name, st) {
+  }
+
+  Admm::~Admm() {
+    clear_mem();
+  }
+
+  Options Admm::options_
+  = {{&Conic::options_},
+     {{"max_iter",
+       {OT_INT,
+        "Maximum number of iterations [4000]."}},
+      {"eps_abs",
+       {OT_DOUBLE,
+        "Absolute tolerance for the primal and dual residuals [1e-3]."}},
+      {"eps_rel",
+       {OT_DOUBLE,
+        "Relative tolerance for the primal and dual residuals [1e-3]."}},
+      {"rho",
+       {OT_DOUBLE,
+        "Initial penalty parameter [0.1]."}},
+      {"rho_min",
+       {OT_DOUBLE,
+        "Lower bound for the penalty parameter, used for free constraints [1e-6]."}},
+      {"rho_max",
+       {OT_DOUBLE,
+        "Upper bound for the penalty parameter [1e6]."}},
+      {"rho_interval",
+       {OT_INT,
+        "Number of iterations between updates of the penalty parameter, "
+        "0 disables the adaptation [25]."}},
+      {"sigma",
+       {OT_DOUBLE,
+        "Proximal regularization of the variables [1e-6]."}},
+      {"alpha",
+       {OT_DOUBLE,
+        "Relaxation parameter, between 0 and 2 [1.6]."}}
+     }
+  };
+
+  void Admm::init(const Dict& opts) {
+    // Initialize the base classes
+    Conic::init(opts);
+
+    // Default options
+    max_iter_ = 4000;
+    eps_abs_ = 1e-3;
+    eps_rel_ = 1e-3;
+    rho_ = 0.1;
+    rho_min_ = 1e-6;
+    rho_max_ = 1e6;
+    rho_interval_ = 25;
+    sigma_ = 1e-6;
+    alpha_ = 1.6;
+
+    // Read user options
+    for (auto&& op : opts) {
+      if (op.first=="max_iter") {
+        max_iter_ = op.second;
+      } else if (op.first=="eps_abs") {
+        eps_abs_ = op.second;
+      } else if (op.first=="eps_rel") {
+        eps_rel_ = op.second;
+      } else if (op.first=="rho") {
+        rho_ = op.second;
+      } else if (op.first=="rho_min") {
+        rho_min_ = op.second;
+      } else if (op.first=="rho_max") {
+        rho_max_ = op.second;
+      } else if (op.first=="rho_interval") {
+        rho_interval_ = op.second;
+      } else if (op.first=="sigma") {
+        sigma_ = op.second;
+      } else if (op.first=="alpha") {
+        alpha_ = op.second;
+      }
+    }
+    casadi_assert(rho_min_>0 && rho_min_<=rho_ && rho_<=rho_max_,
+      "Options must satisfy 0 < rho_min <= rho <= rho_max");
+    casadi_assert(sigma_>0, "Option 'sigma' must be positive");
+    casadi_assert(alpha_>0 && alpha_<2, "Option 'alpha' must be in (0, 2)");
+
+    // KKT matrix, including the diagonal
+    kkt_ = Sparsity::blockcat({{H_.unite(Sparsity::diag(nx_)), A_.T()},
+                               {A_, Sparsity::diag(na_)}});
+
+    // Locations of the nonzeros of H, A, A' and the diagonal
+    std::vector<casadi_int> row, col;
+    H_.get_triplet(row, col);
+    for (casadi_int k=0; k<row.size(); ++k) kkt_h_.push_back(kkt_.get_nz(row[k], col[k]));
+    A_.get_triplet(row, col);
+    for (casadi_int k=0; k<row.size(); ++k) {
+      kkt_a_.push_back(kkt_.get_nz(nx_+row[k], col[k]));
+      kkt_at_.push_back(kkt_.get_nz(col[k], nx_+row[k]));
+    }
+    for (casadi_int i=0; i<nx_+na_; ++i) kkt_d_.push_back(kkt_.get_nz(i, i));
+
+    // Symbolic factorization
+    sp_lt_ = kkt_.ldl(perm_);
+
+    // Setup memory structure
+    p_.nx = nx_;
+    p_.na = na_;
+    p_.n = nx_ + na_;
+    p_.sp_h = H_;
+    p_.sp_a = A_;
+    p_.sp_kkt = kkt_;
+    p_.sp_lt = sp_lt_;
+    p_.perm = get_ptr(perm_);
+    p_.kkt_h = get_ptr(kkt_h_);
+    p_.kkt_a = get_ptr(kkt_a_);
+    p_.kkt_at = get_ptr(kkt_at_);
+    p_.kkt_d = get_ptr(kkt_d_);
+    p_.max_iter = max_iter_;
+    p_.rho_interval = rho_interval_;
+    p_.eps_abs = eps_abs_;
+    p_.eps_rel = eps_rel_;
+    p_.rho0 = rho_;
+    p_.rho_min = rho_min_;
+    p_.rho_max = rho_max_;
+    p_.sigma = sigma_;
+    p_.alpha = alpha_;
+    p_.inf = inf;
+
+    // Allocate memory
+    casadi_int sz_w, sz_iw;
+    casadi_admm_work(&p_, &sz_iw, &sz_w);
+    alloc_iw(sz_iw, true);
+    alloc_w(sz_w, true);
+  }
+
+  int Admm::init_mem(void* mem) const {
+    auto m = static_cast<AdmmMemory*>(mem);
+    m->return_status = "";
+    m->success = false;
+    m->iter_count = 0;
+    m->n_factor = 0;
+    m->rho = m->r_prim = m->r_dual = 0;
+    m->factorized = false;
+    m->lt.resize(sp_lt_.nnz());
+    m->d.resize(nx_+na_);
+    m->h.resize(H_.nnz());
+    m->a.resize(A_.nnz());
+    m->type.resize(nx_+na_);
+    return 0;
+  }
+
+  int Admm::
+  eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const {
+    auto m = static_cast<AdmmMemory*>(mem);
+    // Reset statistics
+    for (auto&& s : m->fstats) s.second.reset();
+    // Check inputs
+    if (inputs_check_) {
+      check_inputs(arg[CONIC_LBX], arg[CONIC_UBX], arg[CONIC_LBA], arg[CONIC_UBA]);
+    }
+    // Setup data structure
+    casadi_admm_data<double> d;
+    d.prob = &p_;
+    casadi_admm_init(&d, iw, w);
+    if (casadi_admm_setup(&d, arg[CONIC_H], arg[CONIC_G], arg[CONIC_A],
+                          arg[CONIC_LBA], arg[CONIC_UBA],
+                          arg[CONIC_LBX], arg[CONIC_UBX],
+                          arg[CONIC_X0], arg[CONIC_LAM_X0], arg[CONIC_LAM_A0])) {
+      casadi_error("Inconsistent bounds");
+    }
+    // Keep the factorization in the memory, reuse it if the KKT matrix is unchanged
+    d.lt = get_ptr(m->lt);
+    d.d = get_ptr(m->d);
+    if (m->factorized
+        && (m->h.empty() || std::equal(m->h.begin(), m->h.end(), arg[CONIC_H]))
+        && (m->a.empty() || std::equal(m->a.begin(), m->a.end(), arg[CONIC_A]))
+        && std::equal(m->type.begin(), m->type.end(), d.type)) {
+      d.rho = m->rho;
+      d.factorized = 1;
+    }
+    // Solve
+    int flag = casadi_admm_solve(&d);
+    m->return_status = flag==0 ? "success" : "Maximum number of iterations reached";
+    m->success = flag==0;
+    m->iter_count = d.iter;
+    m->n_factor = d.nfact;
+    m->rho = d.rho;
+    m->r_prim = d.r_prim;
+    m->r_dual = d.r_dual;
+    // Data corresponding to the factorization
+    m->factorized = (arg[CONIC_H] || m->h.empty()) && (arg[CONIC_A] || m->a.empty());
+    if (m->factorized) {
+      std::copy_n(arg[CONIC_H], m->h.size(), m->h.begin());
+      std::copy_n(arg[CONIC_A], m->a.size(), m->a.begin());
+      std::copy_n(d.type, m->type.size(), m->type.begin());
+    }
+    // Get solution
+    casadi_admm_scatter(&d, res[CONIC_X], res[CONIC_COST], res[CONIC_LAM_A],
+                        res[CONIC_LAM_X]);
+    if (verbose_) casadi_warning(m->return_status);
+    return 0;
+  }
+
+  Dict Admm::get_stats(void* mem) const {
+    Dict stats = Conic::get_stats(mem);
+    auto m = static_cast<AdmmMemory*>(mem);
+    stats["return_status"] = m->return_status;
+    stats["success"] = m->success;
+    stats["iter_count"] = m->iter_count;
+    stats["n_factor"] = m->n_factor;
+    stats["rho"] = m->rho;
+    stats["r_prim"] = m->r_prim;
+    stats["r_dual"] = m->r_dual;
+    return stats;
+  }
+
+  Dict Admm::codegen_footprint(const CodeGenerator& g) const {
+    Dict r = Conic::codegen_footprint(g);
+    // Data dependent loop, bounded by the maximum number of iterations
+    r["control"] = "iterative";
+    r["max_iter"] = max_iter_;
+    return r;
+  }
+
+  void Admm::codegen_body(CodeGenerator& g) const {
+    g.add_auxiliary(CodeGenerator::AUX_ADMM);
+    g.local("p", "struct casadi_admm_prob");
+    g.local("d", "struct casadi_admm_data");
+
+    g << "p.nx = " << p_.nx << ";\n";
+    g << "p.na = " << p_.na << ";\n";
+    g << "p.n = " << p_.n << ";\n";
+    g << "p.sp_h = " << g.sparsity(H_) << ";\n";
+    g << "p.sp_a = " << g.sparsity(A_) << ";\n";
+    g << "p.sp_kkt = " << g.sparsity(kkt_) << ";\n";
+    g << "p.sp_lt = " << g.sparsity(sp_lt_) << ";\n";
+    g << "p.perm = " << g.constant(perm_) << ";\n";
+    g << "p.kkt_h = " << g.constant(kkt_h_) << ";\n";
+    g << "p.kkt_a = " << g.constant(kkt_a_) << ";\n";
+    g << "p.kkt_at = " << g.constant(kkt_at_) << ";\n";
+    g << "p.kkt_d = " << g.constant(kkt_d_) << ";\n";
+    g << "p.max_iter = " << max_iter_ << ";\n";
+    g << "p.rho_interval = " << rho_interval_ << ";\n";
+    g << "p.eps_abs = " << g.constant(eps_abs_) << ";\n";
+    g << "p.eps_rel = " << g.constant(eps_rel_) << ";\n";
+    g << "p.rho0 = " << g.constant(rho_) << ";\n";
+    g << "p.rho_min = " << g.constant(rho_min_) << ";\n";
+    g << "p.rho_max = " << g.constant(rho_max_) << ";\n";
+    g << "p.sigma = " << g.constant(sigma_) << ";\n";
+    g << "p.alpha = " << g.constant(alpha_) << ";\n";
+    g << "p.inf = " << g.constant(inf) << ";\n";
+    g << "d.prob = &p;\n";
+    g << "casadi_admm_init(&d, iw, w);\n";
+
+    g << "if (casadi_admm_setup(&d";
+    for (casadi_int i : {CONIC_H, CONIC_G, CONIC_A, CONIC_LBA, CONIC_UBA, CONIC_LBX,
+                         CONIC_UBX, CONIC_X0, CONIC_LAM_X0, CONIC_LAM_A0}) {
+      g << ", arg[" << i << "]";
+    }
+    g << ")) return 1;\n";
+    g << "casadi_admm_solve(&d);\n";
+    g << "casadi_admm_scatter(&d, res[" << CONIC_X << "], res[" << CONIC_COST << "], "
+      << "res[" << CONIC_LAM_A << "], res[" << CONIC_LAM_X << "]);\n";
+  }
+
+} // namespace casadi
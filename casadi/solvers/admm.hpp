@@ -0,0 +1,145 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#ifndef CASADI_ADMM_HPP
+#define CASADI_ADMM_HPP
+
+#include "casadi/core/conic_impl.hpp"
+#include <casadi/solvers/casadi_conic_admm_export.h>
+
+/** \defgroup plugin_Conic_admm
+
+   Solve QPs using the alternating direction method of multipliers (ADMM)
+
+   The splitting follows OSQP. The quasi-definite KKT matrix
+   [H + sigma*I + Rx, A'; A, -Ra^(-1)] is factorized once by a sparse LDL^T
+   factorization, after which each iteration costs a single pair of triangular
+   solves. The penalty R is adapted to balance the primal and dual residuals,
+   triggering a refactorization only when it changes significantly. The factorization
+   is kept between calls with unchanged H, A, penalty and constraint types, and the
+   iterations are warm started from x0, lam_x0 and lam_a0. Suitable for large sparse
+   QPs where moderate accuracy suffices. The Hessian must be positive semidefinite.
+   The method is implemented in the C runtime and can be code generated.
+*/
+
+/** \pluginsection{Conic,admm} */
+
+/// \cond INTERNAL
+namespace casadi {
+  struct CASADI_CONIC_ADMM_EXPORT AdmmMemory : public ConicMemory {
+    const char* return_status;
+    bool success;
+    casadi_int iter_count, n_factor;
+    double rho, r_prim, r_dual;
+    // Factorization kept between calls, with the data it corresponds to
+    bool factorized;
+    std::vector<double> lt, d, h, a;
+    std::vector<casadi_int> type;
+  };
+
+  /** \brief \pluginbrief{Conic,admm}
+
+      @copydoc Conic_doc
+      @copydoc plugin_Conic_admm
+  */
+  class CASADI_CONIC_ADMM_EXPORT Admm : public Conic {
+  public:
+    /** \brief  Create a new Solver */
+    explicit Admm(const std::string& name,
+                  const std::map<std::string, Sparsity> &st);
+
+    /** \brief  Create a new QP Solver */
+    static Conic* creator(const std::string& name,
+                          const std::map<std::string, Sparsity>& st) {
+      return new Admm(name, st);
+    }
+
+    /** \brief  Destructor */
+    ~Admm() override;
+
+    // Get name of the plugin
+    const char* plugin_name() const override { return "admm";}
+
+    // Get name of the class
+    std::string class_name() const override { return "Admm";}
+
+    /** \brief Create memory block */
+    void* alloc_mem() const override { return new AdmmMemory();}
+
+    /** \brief Initalize memory block */
+    int init_mem(void* mem) const override;
+
+    /** \brief Free memory block */
+    void free_mem(void *mem) const override { delete static_cast<AdmmMemory*>(mem);}
+
+    ///@{
+    /** \brief Options */
+    static Options options_;
+    const Options& get_options() const override { return options_;}
+    ///@}
+
+    /** \brief Initialize */
+    void init(const Dict& opts) override;
+
+    /** \brief Solve the QP */
+    int eval(const double** arg, double** res,
+             casadi_int* iw, double* w, void* mem) const override;
+
+    /// Get all statistics
+    Dict get_stats(void* mem) const override;
+
+    /** \brief Is codegen supported? */
+    bool has_codegen() const override { return true;}
+
+    /** \brief Generate code for the body of the C function */
+    void codegen_body(CodeGenerator& g) const override;
+
+    /** \brief Worst-case footprint of the generated code */
+    Dict codegen_footprint(const CodeGenerator& g) const override;
+
+    /// A documentation string
+    static const std::string meta_doc;
+
+    // Memory structure
+    casadi_admm_prob<double> p_;
+
+    /// KKT matrix, its transposed L factor and the fill-reducing ordering
+    Sparsity kkt_, sp_lt_;
+    std::vector<casadi_int> perm_;
+
+    /// Locations in the KKT matrix of the nonzeros of H, A, A' and of the diagonal
+    std::vector<casadi_int> kkt_h_, kkt_a_, kkt_at_, kkt_d_;
+
+    ///@{
+    // Options
+    casadi_int max_iter_, rho_interval_;
+    double eps_abs_, eps_rel_, rho_, rho_min_, rho_max_, sigma_, alpha_;
+    ///@}
+  };
+
+} // namespace casadi
+/// \endcond
+#endif // CASADI_ADMM_HPP
@@ -0,0 +1,103 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+
+      #include "admm.hpp"
+      #include <string>
+
+      const std::string casadi::Admm::meta_doc=
+      "\n"
+"Solve QPs using the alternating direction method of multipliers (ADMM)\n"
+"\n"
+"The splitting follows OSQP. The quasi-definite KKT matrix [H + sigma*I +\n"
+"Rx, A'; A, -Ra^(-1)] is factorized once by a sparse LDL^T factorization,\n"
+"after which each iteration costs a single pair of triangular solves. The\n"
+"penalty R is adapted to balance the primal and dual residuals, triggering a\n"
+"refactorization only when it changes significantly. The factorization is\n"
+"kept between calls with unchanged H, A, penalty and constraint types, and\n"
+"the iterations are warm started from x0, lam_x0 and lam_a0. Suitable for\n"
+"large sparse QPs where moderate accuracy suffices. The Hessian must be\n"
+"positive semidefinite. The method is implemented in the C runtime and can\n"
+"be code generated.\n"
+"\n"
+"\n"
+">List of available options\n"
+"\n"
+"+--------------+-----------+-------------------------------------------+\n"
+"|      Id      |   Type    |                Description                |\n"
+"+==============+===========+===========================================+\n"
+"| alpha        | OT_DOUBLE | Relaxation parameter, between 0 and 2     |\n"
+"|              |           | [1.6].                                    |\n"
+"+--------------+-----------+-------------------------------------------+\n"
+"| eps_abs      | OT_DOUBLE | Absolute tolerance for the primal and     |\n"
+"|              |           | dual residuals [1e-3].                    |\n"
+"+--------------+-----------+-------------------------------------------+\n"
+"| eps_rel      | OT_DOUBLE | Relative tolerance for the primal and     |\n"
+"|              |           | dual residuals [1e-3].                    |\n"
+"+--------------+-----------+-------------------------------------------+\n"
+"| max_iter     | OT_INT    | Maximum number of iterations [4000].      |\n"
+"+--------------+-----------+-------------------------------------------+\n"
+"| rho          | OT_DOUBLE | Initial penalty parameter [0.1].          |\n"
+"+--------------+-----------+-------------------------------------------+\n"
+"| rho_interval | OT_INT    | Number of iterations between updates of   |\n"
+"|              |           | the penalty parameter, 0 disables the     |\n"
+"|              |           | adaptation [25].                          |\n"
+"+--------------+-----------+-------------------------------------------+\n"
+"| rho_max      | OT_DOUBLE | Upper bound for the penalty parameter     |\n"
+"|              |           | [1e6].                                    |\n"
+"+--------------+-----------+-------------------------------------------+\n"
+"| rho_min      | OT_DOUBLE | Lower bound for the penalty parameter,    |\n"
+"|              |           | used for free constraints [1e-6].         |\n"
+"+--------------+-----------+-------------------------------------------+\n"
+"| sigma        | OT_DOUBLE | Proximal regularization of the variables  |\n"
+"|              |           | [1e-6].                                   |\n"
+"+--------------+-----------+-------------------------------------------+\n"
+"\n"
+"\n"
+">List of available stats\n"
+"\n"
+"+---------------+\n"
+"|      Id       |\n"
+"+===============+\n"
+"| iter_count    |\n"
+"+---------------+\n"
+"| n_factor      |\n"
+"+---------------+\n"
+"| r_dual        |\n"
+"+---------------+\n"
+"| r_prim        |\n"
+"+---------------+\n"
+"| return_status |\n"
+"+---------------+\n"
+"| rho           |\n"
+"+---------------+\n"
+"| success       |\n"
+"+---------------+\n"
+"\n"
+"\n"
+"\n"
+"\n"
+;
@@ -0,0 +1,643 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#include "aladin.hpp"
+#include "casadi/core/casadi_misc.hpp"
+#include "casadi/core/conic.hpp"
+#include "casadi/core/thread_pool.hpp"
+
+using namespace std;
+namespace casadi {
+
+  extern "C"
+  int CASADI_NLPSOL_ALADIN_EXPORT
+      casadi_register_nlpsol_aladin(Nlpsol::Plugin* plugin) {
+    plugin->creator = Aladin::creator;
+    plugin->name = "aladin";
+    plugin->doc = Aladin::meta_doc.c_str();
+    plugin->version = CASADI_VERSION;
+    plugin->options = &Aladin::options_;
+    return 0;
+  }
+
+  extern "C"
+  void CASADI_NLPSOL_ALADIN_EXPORT casadi_load_nlpsol_aladin() {
+    Nlpsol::registerPlugin(casadi_register_nlpsol_aladin);
+  }
+
+  Aladin::Aladin(const std::string& name, const Function& nlp)
+    : Nlpsol(name, nlp) {
+  }
+
+  Aladin::~Aladin() {
+    clear_mem();
+  }
+
+  Options Aladin::options_
+  = {{&Nlpsol::options_},
+     {{"blocks",
+       {OT_INTVECTORVECTOR,
+        "Partition of the variables into blocks, each solved as a local NLP"}},
+      {"nlpsol",
+       {OT_STRING,
+        "NLP solver for the local problems [ipopt]"}},
+      {"nlpsol_options",
+       {OT_DICT,
+        "Options to be passed to the local NLP solvers"}},
+      {"qpsol",
+       {OT_STRING,
+        "QP solver for the coordination problem [qrqp]"}},
+      {"qpsol_options",
+       {OT_DICT,
+        "Options to be passed to the QP solver"}},
+      {"hessian_approximation",
+       {OT_STRING,
+        "Hessian of the coordination QP: "
+        "exact (ALADIN) or proximal (rho*I, ADMM-like) [exact]"}},
+      {"rho",
+       {OT_DOUBLE,
+        "Weight of the proximal term of the local problems [10]"}},
+      {"mu",
+       {OT_DOUBLE,
+        "Penalty on the slack of the coupling constraints in the QP [100]"}},
+      {"rho_update",
+       {OT_DOUBLE,
+        "Factor by which rho is multiplied every iteration [1]"}},
+      {"mu_update",
+       {OT_DOUBLE,
+        "Factor by which mu is multiplied every iteration [1]"}},
+      {"max_iter",
+       {OT_INT,
+        "Maximum number of iterations [50]"}},
+      {"tol_pr",
+       {OT_DOUBLE,
+        "Stopping tolerance for the violation of the coupling constraints [1e-6]"}},
+      {"tol_du",
+       {OT_DOUBLE,
+        "Stopping tolerance for rho times the step of the local problems [1e-6]"}},
+      {"active_tol",
+       {OT_DOUBLE,
+        "Distance to a bound below which a local constraint is considered active [1e-6]"}},
+      {"regularize",
+       {OT_BOOL,
+        "Automatic regularization of the Lagrangian Hessian [false]"}},
+      {"max_num_threads",
+       {OT_INT,
+        "Maximum number of local problems solved in parallel [number of blocks]"}},
+      {"print_iteration",
+       {OT_BOOL,
+        "Print the iterations [true]"}}
+     }
+  };
+
+  void Aladin::init(const Dict& opts) {
+    // Call the init method of the base class
+    Nlpsol::init(opts);
+
+    // Default options
+    string nlpsol_plugin = "ipopt", qpsol_plugin = "qrqp", hessian_approximation = "exact";
+    Dict nlpsol_options, qpsol_options;
+    rho_ = 10;
+    mu_ = 100;
+    rho_update_ = mu_update_ = 1;
+    max_iter_ = 50;
+    tol_pr_ = tol_du_ = active_tol_ = 1e-6;
+    regularize_ = false;
+    max_num_threads_ = -1;
+    print_iteration_ = true;
+
+    // Read user options
+    for (auto&& op : opts) {
+      if (op.first=="blocks") {
+        blocks_ = op.second;
+      } else if (op.first=="nlpsol") {
+        nlpsol_plugin = op.second.to_string();
+      } else if (op.first=="nlpsol_options") {
+        nlpsol_options = op.second;
+      } else if (op.first=="qpsol") {
+        qpsol_plugin = op.second.to_string();
+      } else if (op.first=="qpsol_options") {
+        qpsol_options = op.second;
+      } else if (op.first=="hessian_approximation") {
+        hessian_approximation = op.second.to_string();
+      } else if (op.first=="rho") {
+        rho_ = op.second;
+      } else if (op.first=="mu") {
+        mu_ = op.second;
+      } else if (op.first=="rho_update") {
+        rho_update_ = op.second;
+      } else if (op.first=="mu_update") {
+        mu_update_ = op.second;
+      } else if (op.first=="max_iter") {
+        max_iter_ = op.second;
+      } else if (op.first=="tol_pr") {
+        tol_pr_ = op.second;
+      } else if (op.first=="tol_du") {
+        tol_du_ = op.second;
+      } else if (op.first=="active_tol") {
+        active_tol_ = op.second;
+      } else if (op.first=="regularize") {
+        regularize_ = op.second;
+      } else if (op.first=="max_num_threads") {
+        max_num_threads_ = op.second;
+        casadi_assert(max_num_threads_>=1, "Option 'max_num_threads' must be positive");
+      } else if (op.first=="print_iteration") {
+        print_iteration_ = op.second;
+      }
+    }
+    casadi_assert(hessian_approximation=="exact" || hessian_approximation=="proximal",
+                  "Unknown Hessian approximation: '" + hessian_approximation + "'");
+    exact_hessian_ = hessian_approximation=="exact";
+    casadi_assert(rho_>0 && mu_>0, "Options 'rho' and 'mu' must be positive");
+
+    // The blocks must partition the variables
+    casadi_assert(!blocks_.empty(), "Option 'blocks' must be provided");
+    x_block_.assign(nx_, -1);
+    for (casadi_int i=0; i<blocks_.size(); ++i) {
+      casadi_assert(!blocks_[i].empty(), "Block " + str(i) + " is empty");
+      for (casadi_int k : blocks_[i]) {
+        casadi_assert(k>=0 && k<nx_, "Variable index " + str(k) + " out of bounds");
+        casadi_assert(x_block_[k]<0, "Variable " + str(k) + " appears in more than one block");
+        x_block_[k] = i;
+      }
+    }
+    for (casadi_int k=0; k<nx_; ++k) {
+      casadi_assert(x_block_[k]>=0, "Variable " + str(k) + " is not in any block");
+    }
+    if (max_num_threads_<0) max_num_threads_ = blocks_.size();
+
+    // Get/generate required functions
+    create_function("nlp_fg", {"x", "p"}, {"f", "g"});
+    Asp_ = create_function("nlp_jac_g", {"x", "p"}, {"jac:g:x"}).sparsity_out(0);
+    if (exact_hessian_) {
+      create_function("nlp_grad_f", {"x", "p"}, {"grad:f:x"});
+      Hsp_ = create_function("nlp_hess_l", {"x", "p", "lam:f", "lam:g"},
+                             {"sym:hess:gamma:x:x"}, {{"gamma", {"f", "g"}}}).sparsity_out(0);
+    } else {
+      Hsp_ = Sparsity::diag(nx_);
+    }
+
+    // Constraints depending on a single block are local, the others are coupling constraints
+    blk_g_.clear();
+    blk_g_.resize(blocks_.size());
+    blk_c_.clear();
+    blk_c_.resize(blocks_.size());
+    cg_.clear();
+    Sparsity Asp_t = Asp_.T();
+    for (casadi_int j=0; j<ng_; ++j) {
+      std::vector<casadi_int> b;
+      for (casadi_int k=Asp_t.colind(j); k<Asp_t.colind(j+1); ++k) {
+        casadi_int i = x_block_[Asp_t.row(k)];
+        if (std::find(b.begin(), b.end(), i)==b.end()) b.push_back(i);
+      }
+      if (b.size()==1) {
+        blk_g_[b[0]].push_back(j);
+      } else {
+        for (casadi_int i : b) blk_c_[i].push_back(cg_.size());
+        cg_.push_back(j);
+      }
+    }
+
+    // Local NLP solvers
+    std::vector<Function> nlps = oracle_.is_a("SXFunction") ? local_nlps<SX>()
+                                                             : local_nlps<MX>();
+    solvers_.clear();
+    for (casadi_int i=0; i<nlps.size(); ++i) {
+      solvers_.push_back(nlpsol(name_ + "_" + str(i), nlpsol_plugin, nlps[i],
+                                nlpsol_options));
+    }
+
+    // Coordination QP in the step and a slack on each coupling constraint
+    casadi_int nc = cg_.size();
+    Sparsity Hsp_qp = diagcat(Hsp_, Sparsity::diag(nc));
+    Sparsity Asp_qp = horzcat(Asp_, Sparsity::triplet(ng_, nc, cg_, range(nc)));
+    qpsol_ = conic(name_ + "_qpsol", qpsol_plugin, {{"h", Hsp_qp}, {"a", Asp_qp}},
+                   qpsol_options);
+    alloc(qpsol_);
+
+    // Print information
+    if (verbose_) {
+      casadi_message(str(blocks_.size()) + " blocks, " + str(cg_.size())
+                     + " coupling constraints");
+    }
+  }
+
+  template<typename M>
+  std::vector<Function> Aladin::local_nlps() const {
+    // Expressions of the NLP, with the calls of the oracle inlined
+    std::vector<M> arg = M::get_input(oracle_), res;
+    oracle_.call(arg, res, true);
+    const M& x = arg.at(NL_X);
+    const M& p = arg.at(NL_P);
+    M g = densify(res.at(NL_G));
+    casadi_assert(is_linear(g.nz(cg_), x),
+                  "The coupling constraints, which depend on more than one block, "
+                  "must be affine in x");
+
+    // Split the objective into its terms
+    std::vector<M> terms;
+    std::vector<std::pair<M, double> > stack = {{res.at(NL_F), 1.}};
+    while (!stack.empty()) {
+      M e = stack.back().first;
+      double s = stack.back().second;
+      stack.pop_back();
+      if (e.is_op(OP_ADD)) {
+        stack.push_back({e.dep(1), s});
+        stack.push_back({e.dep(0), s});
+      } else if (e.is_op(OP_SUB)) {
+        stack.push_back({e.dep(1), -s});
+        stack.push_back({e.dep(0), s});
+      } else {
+        terms.push_back(s==1 ? e : -e);
+      }
+    }
+
+    // Each term goes into the objective of the blocks it depends on
+    std::vector<std::vector<M> > blk_terms(blocks_.size());
+    Sparsity sp_terms = Function("terms", {x, p}, {vertcat(terms)}).sparsity_jac(0, 0).T();
+    for (casadi_int t=0; t<terms.size(); ++t) {
+      std::vector<bool> added(blocks_.size(), false);
+      for (casadi_int k=sp_terms.colind(t); k<sp_terms.colind(t+1); ++k) {
+        casadi_int i = x_block_[sp_terms.row(k)];
+        if (!added[i]) blk_terms[i].push_back(terms[t]);
+        added[i] = true;
+      }
+    }
+
+    // Local NLP of each block
+    std::vector<Function> ret;
+    for (casadi_int i=0; i<blocks_.size(); ++i) {
+      const std::vector<casadi_int>& xi = blocks_[i];
+      std::vector<casadi_int> ci;
+      for (casadi_int c : blk_c_[i]) ci.push_back(cg_[c]);
+      Function fi("f", {x, p}, {sum(blk_terms[i]), g.nz(blk_g_[i]), g.nz(ci)});
+
+      // Variables of the block and parameters: all variables, multipliers, rho, p
+      M y = M::sym("y", xi.size());
+      M q = M::sym("q", nx_ + ci.size() + 1 + np_);
+      std::vector<M> qs = vertsplit(q, {0, nx_, nx_ + static_cast<casadi_int>(ci.size()),
+                                        nx_ + static_cast<casadi_int>(ci.size()) + 1,
+                                        q.size1()});
+      M xy = qs[0];
+      xy.nz(xi) = y;
+      std::vector<M> r = fi(std::vector<M>{xy, qs[3]});
+
+      // Augmented objective with the proximal term
+      M obj = r[0] + dot(qs[1], r[2]) + qs[2]/2*sumsqr(y - qs[0].nz(xi));
+      ret.push_back(Function("nlp", {y, q}, {obj, r[1]}, {"x", "p"}, {"f", "g"}));
+    }
+    return ret;
+  }
+
+  int Aladin::init_mem(void* mem) const {
+    if (Nlpsol::init_mem(mem)) return 1;
+    auto m = static_cast<AladinMemory*>(mem);
+    casadi_int nb = blocks_.size(), nc = cg_.size();
+    m->blk_x0.resize(nb);
+    m->blk_q.resize(nb);
+    m->blk_lbx.resize(nb);
+    m->blk_ubx.resize(nb);
+    m->blk_lbg.resize(nb);
+    m->blk_ubg.resize(nb);
+    m->blk_y.resize(nb);
+    m->blk_lam_x.resize(nb);
+    m->blk_lam_g.resize(nb);
+    m->blk_success.resize(nb);
+    m->blk_arg.resize(nb);
+    m->blk_res.resize(nb);
+    m->blk_iw.resize(nb);
+    m->blk_w.resize(nb);
+    for (casadi_int i=0; i<nb; ++i) {
+      casadi_int nxi = blocks_[i].size(), ngi = blk_g_[i].size();
+      m->blk_x0[i].resize(nxi);
+      m->blk_q[i].resize(nx_ + blk_c_[i].size() + 1 + np_);
+      m->blk_lbx[i].resize(nxi);
+      m->blk_ubx[i].resize(nxi);
+      m->blk_lbg[i].resize(ngi);
+      m->blk_ubg[i].resize(ngi);
+      m->blk_y[i].resize(nxi);
+      m->blk_lam_x[i].resize(nxi);
+      m->blk_lam_g[i].resize(ngi);
+      m->blk_arg[i].resize(solvers_[i].sz_arg());
+      m->blk_res[i].resize(solvers_[i].sz_res());
+      m->blk_iw[i].resize(solvers_[i].sz_iw());
+      m->blk_w[i].resize(solvers_[i].sz_w());
+    }
+    m->y.resize(nx_);
+    m->lam.resize(nc);
+    m->lam_gy.resize(ng_);
+    m->gy.resize(ng_);
+    m->hess.resize(Hsp_.nnz());
+    m->jac.resize(Asp_.nnz());
+    m->grad.resize(nx_);
+    m->qp_h.resize(Hsp_.nnz() + nc);
+    m->qp_g.resize(nx_ + nc);
+    m->qp_a.resize(Asp_.nnz() + nc);
+    m->qp_lbx.resize(nx_ + nc);
+    m->qp_ubx.resize(nx_ + nc);
+    m->qp_lba.resize(ng_);
+    m->qp_uba.resize(ng_);
+    m->qp_x.resize(nx_ + nc);
+    m->qp_lam_x.resize(nx_ + nc);
+    m->qp_lam_a.resize(ng_);
+    m->iter_count = 0;
+    m->return_status = "";
+    return 0;
+  }
+
+  int Aladin::solve_local(AladinMemory* m) const {
+    casadi_int nb = blocks_.size();
+    for (casadi_int i=0; i<nb; ++i) m->blk_mem.push_back(solvers_[i].checkout());
+
+    // Solve the local problem of block i
+    auto task = [&](casadi_int i, casadi_int t) {
+      const Function& s = solvers_[i];
+      const std::vector<casadi_int>& xi = blocks_[i];
+      // Parameters: all variables, coupling multipliers, rho, p
+      double* q = get_ptr(m->blk_q[i]);
+      casadi_copy(m->x, nx_, q);
+      q += nx_;
+      for (casadi_int c : blk_c_[i]) *q++ = m->lam[c];
+      *q++ = m->rho;
+      casadi_copy(m->p, np_, q);
+      // Proximal center as initial guess, warm started multipliers
+      for (casadi_int k=0; k<xi.size(); ++k) m->blk_x0[i][k] = m->x[xi[k]];
+      const double** arg = get_ptr(m->blk_arg[i]);
+      double** res = get_ptr(m->blk_res[i]);
+      fill_n(arg, NLPSOL_NUM_IN, nullptr);
+      fill_n(res, NLPSOL_NUM_OUT, nullptr);
+      arg[NLPSOL_X0] = get_ptr(m->blk_x0[i]);
+      arg[NLPSOL_P] = get_ptr(m->blk_q[i]);
+      arg[NLPSOL_LBX] = get_ptr(m->blk_lbx[i]);
+      arg[NLPSOL_UBX] = get_ptr(m->blk_ubx[i]);
+      arg[NLPSOL_LBG] = get_ptr(m->blk_lbg[i]);
+      arg[NLPSOL_UBG] = get_ptr(m->blk_ubg[i]);
+      arg[NLPSOL_LAM_X0] = get_ptr(m->blk_lam_x[i]);
+      arg[NLPSOL_LAM_G0] = get_ptr(m->blk_lam_g[i]);
+      res[NLPSOL_X] = get_ptr(m->blk_y[i]);
+      res[NLPSOL_LAM_X] = get_ptr(m->blk_lam_x[i]);
+      res[NLPSOL_LAM_G] = get_ptr(m->blk_lam_g[i]);
+      try {
+        s(arg, res, get_ptr(m->blk_iw[i]), get_ptr(m->blk_w[i]), m->blk_mem[i]);
+        m->blk_success[i] = s.stats(m->blk_mem[i]).at("success");
+      } catch(exception& ex) {
+        if (verbose_) casadi_message("Block " + str(i) + " failed: " + string(ex.what()));
+        m->blk_success[i] = false;
+      }
+    };
+    ThreadPool::run(nb, max_num_threads_, task);
+
+    for (casadi_int i=0; i<nb; ++i) solvers_[i].release(m->blk_mem[i]);
+    m->blk_mem.clear();
+    for (casadi_int i=0; i<nb; ++i) if (!m->blk_success[i]) return 1;
+
+    // Gather the local solutions and multipliers
+    for (casadi_int i=0; i<nb; ++i) {
+      for (casadi_int k=0; k<blocks_[i].size(); ++k) {
+        m->y[blocks_[i][k]] = m->blk_y[i][k];
+        m->lam_x[blocks_[i][k]] = m->blk_lam_x[i][k];
+      }
+      for (casadi_int k=0; k<blk_g_[i].size(); ++k) {
+        m->lam_gy[blk_g_[i][k]] = m->blk_lam_g[i][k];
+      }
+    }
+    for (casadi_int c=0; c<cg_.size(); ++c) m->lam_gy[cg_[c]] = m->lam[c];
+    return 0;
+  }
+
+  int Aladin::solve_coordination(AladinMemory* m) const {
+    casadi_int nc = cg_.size();
+    double* y = get_ptr(m->y);
+
+    // Sensitivities at the local solutions
+    m->arg[0] = y;
+    m->arg[1] = m->p;
+    m->res[0] = get_ptr(m->jac);
+    if (calc_function(m, "nlp_jac_g")) return 1;
+    if (exact_hessian_) {
+      m->arg[0] = y;
+      m->arg[1] = m->p;
+      m->res[0] = get_ptr(m->grad);
+      if (calc_function(m, "nlp_grad_f")) return 1;
+      const double one = 1;
+      m->arg[0] = y;
+      m->arg[1] = m->p;
+      m->arg[2] = &one;
+      m->arg[3] = get_ptr(m->lam_gy);
+      m->res[0] = get_ptr(m->hess);
+      if (calc_function(m, "nlp_hess_l")) return 1;
+      if (regularize_) {
+        double reg = std::fmin(0, -casadi_lb_eig(Hsp_, get_ptr(m->hess)));
+        if (reg > 0) casadi_regularize(Hsp_, get_ptr(m->hess), reg);
+      }
+    } else {
+      // Proximal Hessian, gradient from the stationarity of the local problems:
+      // grad f + C'*kappa = rho*(x-y) - A'*lam
+      casadi_fill(get_ptr(m->hess), nx_, m->rho);
+      casadi_fill(get_ptr(m->qp_lam_a), ng_, 0.);
+      for (casadi_int c=0; c<nc; ++c) m->qp_lam_a[cg_[c]] = m->lam[c];
+      casadi_fill(get_ptr(m->grad), nx_, 0.);
+      casadi_mv(get_ptr(m->jac), Asp_, get_ptr(m->qp_lam_a), get_ptr(m->grad), true);
+      for (casadi_int k=0; k<nx_; ++k) m->grad[k] = m->rho*(m->x[k] - y[k]) - m->grad[k];
+    }
+
+    // Objective: 1/2*dy'*H*dy + grad'*dy + lam'*s + mu/2*|s|^2
+    casadi_copy(get_ptr(m->hess), Hsp_.nnz(), get_ptr(m->qp_h));
+    casadi_fill(get_ptr(m->qp_h) + Hsp_.nnz(), nc, m->mu);
+    casadi_copy(get_ptr(m->grad), nx_, get_ptr(m->qp_g));
+    casadi_copy(get_ptr(m->lam), nc, get_ptr(m->qp_g) + nx_);
+
+    // Constraints: linearized constraints with a slack on the coupling constraints
+    casadi_copy(get_ptr(m->jac), Asp_.nnz(), get_ptr(m->qp_a));
+    casadi_fill(get_ptr(m->qp_a) + Asp_.nnz(), nc, -1.);
+    for (casadi_int j=0; j<ng_; ++j) {
+      double lb = m->lbg ? m->lbg[j] : 0, ub = m->ubg ? m->ubg[j] : 0;
+      if (exact_hessian_ && (m->gy[j]-lb<=active_tol_ || ub-m->gy[j]<=active_tol_)) {
+        // Active local constraints are kept fixed
+        m->qp_lba[j] = m->qp_uba[j] = 0;
+      } else {
+        m->qp_lba[j] = -inf;
+        m->qp_uba[j] = inf;
+      }
+    }
+    for (casadi_int c=0; c<nc; ++c) {
+      casadi_int j = cg_[c];
+      m->qp_lba[j] = (m->lbg ? m->lbg[j] : 0) - m->gy[j];
+      m->qp_uba[j] = (m->ubg ? m->ubg[j] : 0) - m->gy[j];
+    }
+
+    // Bounds on the step: active bounds are kept fixed
+    for (casadi_int k=0; k<nx_; ++k) {
+      double lb = m->lbx ? m->lbx[k] : 0, ub = m->ubx ? m->ubx[k] : 0;
+      if (exact_hessian_ && (y[k]-lb<=active_tol_ || ub-y[k]<=active_tol_)) {
+        m->qp_lbx[k] = m->qp_ubx[k] = 0;
+      } else {
+        m->qp_lbx[k] = lb - y[k];
+        m->qp_ubx[k] = ub - y[k];
+      }
+    }
+    casadi_fill(get_ptr(m->qp_lbx) + nx_, nc, -inf);
+    casadi_fill(get_ptr(m->qp_ubx) + nx_, nc, inf);
+
+    // Solve the QP
+    casadi_fill(get_ptr(m->qp_x), nx_ + nc, 0.);
+    casadi_fill(get_ptr(m->qp_lam_x), nx_ + nc, 0.);
+    casadi_fill(get_ptr(m->qp_lam_a), ng_, 0.);
+    fill_n(m->arg, qpsol_.n_in(), nullptr);
+    m->arg[CONIC_H] = get_ptr(m->qp_h);
+    m->arg[CONIC_G] = get_ptr(m->qp_g);
+    m->arg[CONIC_A] = get_ptr(m->qp_a);
+    m->arg[CONIC_LBA] = get_ptr(m->qp_lba);
+    m->arg[CONIC_UBA] = get_ptr(m->qp_uba);
+    m->arg[CONIC_LBX] = get_ptr(m->qp_lbx);
+    m->arg[CONIC_UBX] = get_ptr(m->qp_ubx);
+    m->arg[CONIC_X0] = get_ptr(m->qp_x);
+    m->arg[CONIC_LAM_X0] = get_ptr(m->qp_lam_x);
+    m->arg[CONIC_LAM_A0] = get_ptr(m->qp_lam_a);
+    fill_n(m->res, qpsol_.n_out(), nullptr);
+    m->res[CONIC_X] = get_ptr(m->qp_x);
+    m->res[CONIC_LAM_X] = get_ptr(m->qp_lam_x);
+    m->res[CONIC_LAM_A] = get_ptr(m->qp_lam_a);
+    if (qpsol_(m->arg, m->res, m->iw, m->w, 0)) return 1;
+    return qpsol_.stats().at("success") ? 0 : 1;
+  }
+
+  int Aladin::solve(void* mem) const {
+    auto m = static_cast<AladinMemory*>(mem);
+    casadi_int nc = cg_.size();
+
+    // Bounds of the local problems
+    for (casadi_int i=0; i<blocks_.size(); ++i) {
+      for (casadi_int k=0; k<blocks_[i].size(); ++k) {
+        casadi_int j = blocks_[i][k];
+        m->blk_lbx[i][k] = m->lbx ? m->lbx[j] : 0;
+        m->blk_ubx[i][k] = m->ubx ? m->ubx[j] : 0;
+        m->blk_lam_x[i][k] = m->lam_x[j];
+      }
+      for (casadi_int k=0; k<blk_g_[i].size(); ++k) {
+        casadi_int j = blk_g_[i][k];
+        m->blk_lbg[i][k] = m->lbg ? m->lbg[j] : 0;
+        m->blk_ubg[i][k] = m->ubg ? m->ubg[j] : 0;
+        m->blk_lam_g[i][k] = m->lam_g[j];
+      }
+    }
+
+    // Coupling multipliers, warm started from lam_g0
+    for (casadi_int c=0; c<nc; ++c) m->lam[c] = m->lam_g[cg_[c]];
+    m->rho = rho_;
+    m->mu = mu_;
+    m->success = false;
+    m->return_status = "Maximum_Iterations_Exceeded";
+    double dx_norm = 0;
+
+    for (m->iter_count=0; ; ++m->iter_count) {
+      // Solve the local problems
+      if (solve_local(m)) {
+        m->return_status = "Local_Solver_Failed";
+        break;
+      }
+
+      // Violation of the coupling constraints and step of the local problems
+      m->arg[0] = get_ptr(m->y);
+      m->arg[1] = m->p;
+      m->res[0] = &m->f;
+      m->res[1] = get_ptr(m->gy);
+      if (calc_function(m, "nlp_fg")) {
+        m->return_status = "Nonfinite_Function_Evaluation";
+        break;
+      }
+      m->pr_inf = 0;
+      for (casadi_int c=0; c<nc; ++c) {
+        casadi_int j = cg_[c];
+        m->pr_inf = fmax(m->pr_inf, casadi_max_viol(1, &m->gy[j], m->lbg ? m->lbg + j : nullptr,
+                                                    m->ubg ? m->ubg + j : nullptr));
+      }
+      m->du_inf = 0;
+      for (casadi_int k=0; k<nx_; ++k) {
+        m->du_inf = fmax(m->du_inf, m->rho*fabs(m->y[k] - m->x[k]));
+      }
+
+      // Print iteration progress
+      if (print_iteration_) {
+        if (m->iter_count % 10 == 0) print_iteration();
+        print_iteration(m->iter_count, m->f, m->pr_inf, m->du_inf, dx_norm, m->rho);
+      }
+
+      // Converged?
+      if (m->pr_inf <= tol_pr_ && m->du_inf <= tol_du_) {
+        m->success = true;
+        m->return_status = "Solve_Succeeded";
+        break;
+      }
+      if (m->iter_count >= max_iter_) break;
+
+      // Coordination step
+      if (solve_coordination(m)) {
+        m->return_status = "Coordination_QP_Failed";
+        break;
+      }
+      for (casadi_int k=0; k<nx_; ++k) m->x[k] = m->y[k] + m->qp_x[k];
+      for (casadi_int c=0; c<nc; ++c) m->lam[c] = m->qp_lam_a[cg_[c]];
+      dx_norm = casadi_norm_inf(nx_, get_ptr(m->qp_x));
+      m->rho *= rho_update_;
+      m->mu *= mu_update_;
+    }
+
+    // Solution: the local solutions with their multipliers
+    if (m->success) {
+      casadi_copy(get_ptr(m->y), nx_, m->x);
+      casadi_copy(get_ptr(m->lam_gy), ng_, m->lam_g);
+      casadi_copy(get_ptr(m->gy), ng_, m->g);
+    } else {
+      m->arg[0] = m->x;
+      m->arg[1] = m->p;
+      m->res[0] = &m->f;
+      m->res[1] = m->g;
+      calc_function(m, "nlp_fg");
+    }
+    m->n_iter = m->iter_count;
+    return 0;
+  }
+
+  void Aladin::print_iteration() const {
+    print("%4s %14s %9s %9s %9s %9s\n", "iter", "objective", "inf_pr",
+          "inf_du", "||d||", "rho");
+  }
+
+  void Aladin::print_iteration(casadi_int iter, double obj, double pr_inf, double du_inf,
+                               double dx_norm, double rho) const {
+    print("%4d %14.6e %9.2e %9.2e %9.2e %9.2e\n", iter, obj, pr_inf, du_inf, dx_norm, rho);
+  }
+
+  Dict Aladin::get_stats(void* mem) const {
+    Dict stats = Nlpsol::get_stats(mem);
+    auto m = static_cast<AladinMemory*>(mem);
+    stats["return_status"] = m->return_status;
+    stats["iter_count"] = m->iter_count;
+    return stats;
+  }
+
+} // namespace casadi
@@ -0,0 +1,179 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#ifndef CASADI_ALADIN_HPP
+#define CASADI_ALADIN_HPP
+
+#include "casadi/core/nlpsol_impl.hpp"
+#include <casadi/solvers/casadi_nlpsol_aladin_export.h>
+
+/** \defgroup plugin_Nlpsol_aladin
+ Distributed optimization with the augmented Lagrangian based alternating direction
+ inexact Newton method (ALADIN). The decision variables are partitioned into blocks
+ with the option 'blocks'. Constraints depending on a single block are local to that
+ block, the others are coupling constraints and must be affine in x. The objective
+ should be a sum of terms: each term goes into the subproblems of the blocks it
+ depends on.
+
+ Each iteration solves one NLP per block in parallel threads, with any NLP solver,
+ augmented with the coupling multipliers and a proximal term rho/2*|y-x|^2. A
+ coordination QP then takes a joint step from the local solutions with the active
+ local constraints kept fixed, a slack on the coupling constraints penalized by mu,
+ and updates the coupling multipliers. With 'hessian_approximation' set to
+ 'proximal', the QP uses the Hessian rho*I and no second order derivatives, which
+ amounts to an ADMM-like consensus step.
+*/
+
+/** \pluginsection{Nlpsol,aladin} */
+
+/// \cond INTERNAL
+namespace casadi {
+
+  struct CASADI_NLPSOL_ALADIN_EXPORT AladinMemory : public NlpsolMemory {
+    // Local problem of each block: parameters, bounds, solution and multipliers
+    std::vector<std::vector<double> > blk_x0, blk_q, blk_lbx, blk_ubx, blk_lbg, blk_ubg,
+      blk_y, blk_lam_x, blk_lam_g;
+    std::vector<bool> blk_success;
+
+    // Memory and work vectors of the local solvers
+    std::vector<casadi_int> blk_mem;
+    std::vector<std::vector<const double*> > blk_arg;
+    std::vector<std::vector<double*> > blk_res;
+    std::vector<std::vector<casadi_int> > blk_iw;
+    std::vector<std::vector<double> > blk_w;
+
+    // Local solutions, coupling multipliers, multipliers of all constraints
+    std::vector<double> y, lam, lam_gy;
+
+    // Coordination QP
+    std::vector<double> gy, hess, jac, grad, qp_h, qp_g, qp_a, qp_lbx, qp_ubx, qp_lba, qp_uba,
+      qp_x, qp_lam_x, qp_lam_a;
+
+    // Penalty parameters
+    double rho, mu;
+
+    // Progress
+    casadi_int iter_count;
+    double pr_inf, du_inf;
+    const char* return_status;
+  };
+
+  /** \brief \pluginbrief{Nlpsol,aladin}
+   *  @copydoc NlpSolver_doc
+   *  @copydoc plugin_Nlpsol_aladin
+   */
+  class CASADI_NLPSOL_ALADIN_EXPORT Aladin : public Nlpsol {
+  public:
+    explicit Aladin(const std::string& name, const Function& nlp);
+    ~Aladin() override;
+
+    // Get name of the plugin
+    const char* plugin_name() const override { return "aladin";}
+
+    // Name of the class
+    std::string class_name() const override { return "Aladin";}
+
+    /** \brief  Create a new NLP Solver */
+    static Nlpsol* creator(const std::string& name, const Function& nlp) {
+      return new Aladin(name, nlp);
+    }
+
+    ///@{
+    /** \brief Options */
+    static Options options_;
+    const Options& get_options() const override { return options_;}
+    ///@}
+
+    /// Get all statistics
+    Dict get_stats(void* mem) const override;
+
+    // Initialize the solver
+    void init(const Dict& opts) override;
+
+    /** \brief Create memory block */
+    void* alloc_mem() const override { return new AladinMemory();}
+
+    /** \brief Initalize memory block */
+    int init_mem(void* mem) const override;
+
+    /** \brief Free memory block */
+    void free_mem(void *mem) const override { delete static_cast<AladinMemory*>(mem);}
+
+    // Solve the NLP
+    int solve(void* mem) const override;
+
+    // Local NLPs of the blocks, in x=y and p=[x; lam; rho; p]
+    template<typename M>
+    std::vector<Function> local_nlps() const;
+
+    // Solve the local NLPs in parallel
+    int solve_local(AladinMemory* m) const;
+
+    // Solve the coordination QP
+    int solve_coordination(AladinMemory* m) const;
+
+    /// Print iteration header
+    void print_iteration() const;
+
+    /// Print iteration
+    void print_iteration(casadi_int iter, double obj, double pr_inf, double du_inf,
+                         double dx_norm, double rho) const;
+
+    /// A documentation string
+    static const std::string meta_doc;
+
+    // Variables of each block
+    std::vector<std::vector<casadi_int> > blocks_;
+
+    // Block of each variable
+    std::vector<casadi_int> x_block_;
+
+    // Local constraints of each block
+    std::vector<std::vector<casadi_int> > blk_g_;
+
+    // Coupling constraints, and those depending on each block
+    std::vector<casadi_int> cg_;
+    std::vector<std::vector<casadi_int> > blk_c_;
+
+    // Local NLP solvers and coordination QP solver
+    std::vector<Function> solvers_;
+    Function qpsol_;
+
+    // Sparsity of the Lagrangian Hessian and the constraint Jacobian
+    Sparsity Hsp_, Asp_;
+
+    // Use the exact Hessian in the coordination QP?
+    bool exact_hessian_;
+
+    // Options
+    double rho_, mu_, rho_update_, mu_update_, tol_pr_, tol_du_, active_tol_;
+    casadi_int max_iter_, max_num_threads_;
+    bool regularize_, print_iteration_;
+  };
+
+} // namespace casadi
+/// \endcond
+#endif // CASADI_ALADIN_HPP
@@ -0,0 +1,312 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#include "branch_and_bound.hpp"
+#include "casadi/core/thread_pool.hpp"
+
+using namespace std;
+namespace casadi {
+
+  extern "C"
+  int CASADI_NLPSOL_BRANCH_AND_BOUND_EXPORT
+      casadi_register_nlpsol_branch_and_bound(Nlpsol::Plugin* plugin) {
+    plugin->creator = BranchAndBound::creator;
+    plugin->name = "branch_and_bound";
+    plugin->doc = BranchAndBound::meta_doc.c_str();
+    plugin->version = CASADI_VERSION;
+    plugin->options = &BranchAndBound::options_;
+    return 0;
+  }
+
+  extern "C"
+  void CASADI_NLPSOL_BRANCH_AND_BOUND_EXPORT casadi_load_nlpsol_branch_and_bound() {
+    Nlpsol::registerPlugin(casadi_register_nlpsol_branch_and_bound);
+  }
+
+  BranchAndBound::BranchAndBound(const std::string& name, const Function& nlp)
+    : Nlpsol(name, nlp) {
+  }
+
+  BranchAndBound::~BranchAndBound() {
+    clear_mem();
+  }
+
+  Options BranchAndBound::options_
+  = {{&Nlpsol::options_},
+     {{"solver",
+       {OT_STRING,
+        "NLP solver for the continuous relaxations [ipopt]"}},
+      {"solver_options",
+       {OT_DICT,
+        "Options to be passed to the NLP solver"}},
+      {"max_num_threads",
+       {OT_INT,
+        "Maximum number of nodes solved in parallel [number of hardware threads]"}},
+      {"max_nodes",
+       {OT_INT,
+        "Maximum number of nodes to explore [10000]"}},
+      {"integer_tol",
+       {OT_DOUBLE,
+        "Tolerance for a discrete variable to be considered integer [1e-6]"}},
+      {"abs_gap",
+       {OT_DOUBLE,
+        "Absolute optimality gap: nodes that cannot improve on the incumbent "
+        "by more than this are pruned [1e-6]"}},
+      {"rel_gap",
+       {OT_DOUBLE,
+        "Relative optimality gap, with respect to the incumbent objective [1e-6]"}}
+     }
+  };
+
+  void BranchAndBound::init(const Dict& opts) {
+    // Call the init method of the base class
+    Nlpsol::init(opts);
+
+    // Default options
+    string solver = "ipopt";
+    Dict solver_options;
+    max_num_threads_ = ThreadPool::hardware_concurrency();
+    max_nodes_ = 10000;
+    integer_tol_ = 1e-6;
+    abs_gap_ = 1e-6;
+    rel_gap_ = 1e-6;
+
+    // Read user options
+    for (auto&& op : opts) {
+      if (op.first=="solver") {
+        solver = op.second.to_string();
+      } else if (op.first=="solver_options") {
+        solver_options = op.second;
+      } else if (op.first=="max_num_threads") {
+        max_num_threads_ = op.second;
+        casadi_assert(max_num_threads_>=1, "Option 'max_num_threads' must be positive");
+      } else if (op.first=="max_nodes") {
+        max_nodes_ = op.second;
+      } else if (op.first=="integer_tol") {
+        integer_tol_ = op.second;
+      } else if (op.first=="abs_gap") {
+        abs_gap_ = op.second;
+      } else if (op.first=="rel_gap") {
+        rel_gap_ = op.second;
+      }
+    }
+
+    // Solver for the continuous relaxations
+    solver_ = nlpsol(name_ + "_relaxation", solver, oracle_, solver_options);
+  }
+
+  int BranchAndBound::init_mem(void* mem) const {
+    if (Nlpsol::init_mem(mem)) return 1;
+    auto m = static_cast<BranchAndBoundMemory*>(mem);
+    casadi_int nt = max_num_threads_;
+    m->x_node.resize(nt, std::vector<double>(nx_));
+    m->g_node.resize(nt, std::vector<double>(ng_));
+    m->lam_x_node.resize(nt, std::vector<double>(nx_));
+    m->lam_g_node.resize(nt, std::vector<double>(ng_));
+    m->lam_p_node.resize(nt, std::vector<double>(np_));
+    m->f_node.resize(nt);
+    m->success_node.resize(nt);
+    m->thread_arg.resize(nt, std::vector<const double*>(solver_.sz_arg()));
+    m->thread_res.resize(nt, std::vector<double*>(solver_.sz_res()));
+    m->thread_iw.resize(nt, std::vector<casadi_int>(solver_.sz_iw()));
+    m->thread_w.resize(nt, std::vector<double>(solver_.sz_w()));
+    m->has_incumbent = false;
+    m->n_nodes = m->n_infeasible = 0;
+    m->bound = -inf;
+    return 0;
+  }
+
+  int BranchAndBound::solve(void* mem) const {
+    auto m = static_cast<BranchAndBoundMemory*>(mem);
+
+    // Root node, with the bounds on the discrete variables rounded inwards
+    BranchAndBoundNode root;
+    root.lbx.resize(nx_);
+    root.ubx.resize(nx_);
+    for (casadi_int i=0; i<nx_; ++i) {
+      root.lbx[i] = m->lbx ? m->lbx[i] : 0;
+      root.ubx[i] = m->ubx ? m->ubx[i] : 0;
+      if (mi_ && discrete_[i]) {
+        root.lbx[i] = ceil(root.lbx[i] - integer_tol_);
+        root.ubx[i] = floor(root.ubx[i] + integer_tol_);
+      }
+    }
+    root.x0.assign(m->x, m->x + nx_);
+    root.lam_x0.assign(m->lam_x, m->lam_x + nx_);
+    root.lam_g0.assign(m->lam_g, m->lam_g + ng_);
+    root.bound = -inf;
+    m->open.clear();
+    m->open.push_back(root);
+
+    // Memory of each thread
+    m->thread_mem.resize(max_num_threads_);
+    for (casadi_int t=0; t<max_num_threads_; ++t) m->thread_mem[t] = solver_.checkout();
+
+    // Solve the relaxation of node k of the batch in thread t
+    auto task = [&](casadi_int k, casadi_int t) {
+      const BranchAndBoundNode& node = m->batch[k];
+      const double** arg = get_ptr(m->thread_arg[t]);
+      double** res = get_ptr(m->thread_res[t]);
+      fill_n(arg, NLPSOL_NUM_IN, nullptr);
+      arg[NLPSOL_X0] = get_ptr(node.x0);
+      arg[NLPSOL_P] = m->p;
+      arg[NLPSOL_LBX] = get_ptr(node.lbx);
+      arg[NLPSOL_UBX] = get_ptr(node.ubx);
+      arg[NLPSOL_LBG] = m->lbg;
+      arg[NLPSOL_UBG] = m->ubg;
+      arg[NLPSOL_LAM_X0] = get_ptr(node.lam_x0);
+      arg[NLPSOL_LAM_G0] = get_ptr(node.lam_g0);
+      res[NLPSOL_X] = get_ptr(m->x_node[k]);
+      res[NLPSOL_F] = &m->f_node[k];
+      res[NLPSOL_G] = get_ptr(m->g_node[k]);
+      res[NLPSOL_LAM_X] = get_ptr(m->lam_x_node[k]);
+      res[NLPSOL_LAM_G] = get_ptr(m->lam_g_node[k]);
+      res[NLPSOL_LAM_P] = get_ptr(m->lam_p_node[k]);
+      bool success;
+      try {
+        solver_(arg, res, get_ptr(m->thread_iw[t]), get_ptr(m->thread_w[t]), m->thread_mem[t]);
+        success = solver_.stats(m->thread_mem[t]).at("success");
+      } catch(exception& ex) {
+        if (verbose_) casadi_message("Relaxation failed: " + string(ex.what()));
+        success = false;
+      }
+      m->success_node[k] = success;
+    };
+
+    // Nodes with a lower bound above the cutoff cannot improve on the incumbent
+    auto cutoff = [&]() {
+      return m->has_incumbent ? m->f - fmax(abs_gap_, rel_gap_*fabs(m->f)) : inf;
+    };
+
+    // Explore the tree
+    m->has_incumbent = false;
+    m->n_nodes = m->n_infeasible = 0;
+    m->f = inf;
+    while (!m->open.empty() && m->n_nodes<max_nodes_) {
+      // Prune nodes that cannot improve on the incumbent
+      double f_cut = cutoff();
+      m->open.erase(std::remove_if(m->open.begin(), m->open.end(),
+        [f_cut](const BranchAndBoundNode& node) { return node.bound>=f_cut;}), m->open.end());
+      if (m->open.empty()) break;
+
+      // Best-first: the nodes with the lowest bounds, at the end after sorting
+      std::stable_sort(m->open.begin(), m->open.end(),
+        [](const BranchAndBoundNode& a, const BranchAndBoundNode& b) {
+          return a.bound>b.bound;});
+      casadi_int nb = std::min(max_num_threads_, max_nodes_-m->n_nodes);
+      nb = std::min(nb, static_cast<casadi_int>(m->open.size()));
+      m->batch.clear();
+      for (casadi_int k=0; k<nb; ++k) {
+        m->batch.push_back(std::move(m->open.back()));
+        m->open.pop_back();
+      }
+
+      // Solve the relaxations in parallel
+      ThreadPool::run(nb, max_num_threads_, task);
+      m->n_nodes += nb;
+
+      // Process the solutions
+      for (casadi_int k=0; k<nb; ++k) {
+        // Infeasible or failed relaxation
+        if (!m->success_node[k]) {
+          m->n_infeasible++;
+          continue;
+        }
+
+        // Prune by bound
+        double f = m->f_node[k];
+        if (f>=cutoff()) continue;
+
+        // Branch on the most fractional discrete variable
+        const std::vector<double>& x = m->x_node[k];
+        casadi_int j = -1;
+        double frac_max = integer_tol_;
+        for (casadi_int i=0; i<nx_; ++i) {
+          if (!mi_ || !discrete_[i]) continue;
+          double frac = fabs(x[i] - round(x[i]));
+          if (frac>frac_max) {
+            j = i;
+            frac_max = frac;
+          }
+        }
+
+        // Integer feasible: new incumbent
+        if (j<0) {
+          m->has_incumbent = true;
+          casadi_copy(get_ptr(x), nx_, m->x);
+          casadi_copy(get_ptr(m->lam_x_node[k]), nx_, m->lam_x);
+          casadi_copy(get_ptr(m->lam_g_node[k]), ng_, m->lam_g);
+          casadi_copy(get_ptr(m->lam_p_node[k]), np_, m->lam_p);
+          casadi_copy(get_ptr(m->g_node[k]), ng_, m->g);
+          m->f = f;
+          if (verbose_) casadi_message("New incumbent " + str(f) + " at node "
+                                       + str(m->n_nodes - nb + k));
+          continue;
+        }
+
+        // Child nodes, warm-started from the solution of the parent
+        BranchAndBoundNode child;
+        child.lbx = m->batch[k].lbx;
+        child.ubx = m->batch[k].ubx;
+        child.x0 = x;
+        child.lam_x0 = m->lam_x_node[k];
+        child.lam_g0 = m->lam_g_node[k];
+        child.bound = f;
+        child.ubx[j] = floor(x[j]);
+        m->open.push_back(child);
+        child.ubx[j] = m->batch[k].ubx[j];
+        child.lbx[j] = ceil(x[j]);
+        m->open.push_back(std::move(child));
+      }
+    }
+
+    for (casadi_int t=0; t<max_num_threads_; ++t) solver_.release(m->thread_mem[t]);
+
+    // Lower bound on the optimal objective
+    m->bound = m->f;
+    for (auto&& node : m->open) m->bound = fmin(m->bound, node.bound);
+
+    if (!m->has_incumbent) {
+      m->return_status = m->open.empty() ? "Infeasible" : "Node_Limit_Reached";
+      m->success = false;
+      return 1;
+    }
+    m->success = m->open.empty();
+    m->return_status = m->success ? "Solve_Succeeded" : "Node_Limit_Reached";
+    return 0;
+  }
+
+  Dict BranchAndBound::get_stats(void* mem) const {
+    Dict stats = Nlpsol::get_stats(mem);
+    auto m = static_cast<BranchAndBoundMemory*>(mem);
+    stats["return_status"] = m->return_status;
+    stats["n_nodes"] = m->n_nodes;
+    stats["n_infeasible"] = m->n_infeasible;
+    stats["bound"] = m->bound;
+    return stats;
+  }
+
+} // namespace casadi
@@ -0,0 +1,156 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#ifndef CASADI_BRANCH_AND_BOUND_HPP
+#define CASADI_BRANCH_AND_BOUND_HPP
+
+#include "casadi/core/nlpsol_impl.hpp"
+#include <casadi/solvers/casadi_nlpsol_branch_and_bound_export.h>
+
+/** \defgroup plugin_Nlpsol_branch_and_bound
+ Nonlinear branch-and-bound for mixed-integer NLPs, with the variables marked by
+ the 'discrete' option restricted to integer values. The continuous relaxations are
+ solved with an NLP solver plugin; a QP relaxation can be solved with a Conic plugin
+ through e.g. sqpmethod and its 'qpsol' option. Nodes are explored best-first, in
+ batches that are solved in parallel threads, and child nodes are warm-started from
+ the solution of their parent. The search is exact for convex problems and a
+ heuristic otherwise.
+*/
+
+/** \pluginsection{Nlpsol,branch_and_bound} */
+
+/// \cond INTERNAL
+namespace casadi {
+
+  /// Node of the branch-and-bound tree
+  struct CASADI_NLPSOL_BRANCH_AND_BOUND_EXPORT BranchAndBoundNode {
+    // Bounds on the variables
+    std::vector<double> lbx, ubx;
+
+    // Initial guess, from the parent node
+    std::vector<double> x0, lam_x0, lam_g0;
+
+    // Lower bound on the objective, from the parent node
+    double bound;
+  };
+
+  struct CASADI_NLPSOL_BRANCH_AND_BOUND_EXPORT BranchAndBoundMemory : public NlpsolMemory {
+    // Nodes left to explore
+    std::vector<BranchAndBoundNode> open;
+
+    // Nodes being solved
+    std::vector<BranchAndBoundNode> batch;
+
+    // Solution of each node in the batch
+    std::vector<std::vector<double> > x_node, g_node, lam_x_node, lam_g_node, lam_p_node;
+    std::vector<double> f_node;
+    std::vector<bool> success_node;
+
+    // Memory and work vectors of each thread
+    std::vector<casadi_int> thread_mem;
+    std::vector<std::vector<const double*> > thread_arg;
+    std::vector<std::vector<double*> > thread_res;
+    std::vector<std::vector<casadi_int> > thread_iw;
+    std::vector<std::vector<double> > thread_w;
+
+    // Incumbent, i.e. the best integer feasible solution found
+    bool has_incumbent;
+
+    // Statistics
+    casadi_int n_nodes, n_infeasible;
+    double bound;
+    std::string return_status;
+  };
+
+  /** \brief \pluginbrief{Nlpsol,branch_and_bound}
+   *  @copydoc NlpSolver_doc
+   *  @copydoc plugin_Nlpsol_branch_and_bound
+   */
+  class CASADI_NLPSOL_BRANCH_AND_BOUND_EXPORT BranchAndBound : public Nlpsol {
+  public:
+    explicit BranchAndBound(const std::string& name, const Function& nlp);
+    ~BranchAndBound() override;
+
+    // Get name of the plugin
+    const char* plugin_name() const override { return "branch_and_bound";}
+
+    // Name of the class
+    std::string class_name() const override { return "BranchAndBound";}
+
+    /** \brief  Create a new NLP Solver */
+    static Nlpsol* creator(const std::string& name, const Function& nlp) {
+      return new BranchAndBound(name, nlp);
+    }
+
+    ///@{
+    /** \brief Options */
+    static Options options_;
+    const Options& get_options() const override { return options_;}
+    ///@}
+
+    /// Get all statistics
+    Dict get_stats(void* mem) const override;
+
+    // Initialize the solver
+    void init(const Dict& opts) override;
+
+    /** \brief Create memory block */
+    void* alloc_mem() const override { return new BranchAndBoundMemory();}
+
+    /** \brief Initalize memory block */
+    int init_mem(void* mem) const override;
+
+    /** \brief Free memory block */
+    void free_mem(void *mem) const override { delete static_cast<BranchAndBoundMemory*>(mem);}
+
+    /// Can discrete variables be treated
+    bool integer_support() const override { return true;}
+
+    // Solve the NLP
+    int solve(void* mem) const override;
+
+    /// A documentation string
+    static const std::string meta_doc;
+
+    // Solver for the continuous relaxations
+    Function solver_;
+
+    // Maximum number of nodes solved in parallel
+    casadi_int max_num_threads_;
+
+    // Maximum number of nodes
+    casadi_int max_nodes_;
+
+    // Tolerance for a variable to be considered integer
+    double integer_tol_;
+
+    // Nodes are pruned unless they may improve on the incumbent by more than the gap
+    double abs_gap_, rel_gap_;
+  };
+
+} // namespace casadi
+/// \endcond
+#endif // CASADI_BRANCH_AND_BOUND_HPP
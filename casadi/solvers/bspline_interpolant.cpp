@@ -51,7 +51,8 @@ namespace casadi {
         "Sets, for each grid dimension, the degree of the spline."}},
        {"linear_solver",
         {OT_STRING,
-         "Solver used for constructing the coefficient tensor."}},
+         "Solver used for constructing the coefficient tensor. "
+         "Default: 'qr', or 'lsqr' when 'fitting' is 'full'."}},
        {"algorithm",
         {OT_STRING,
          "Algorithm used for fitting the data: 'not_a_knot' (default, same as Matlab),"
@@ -60,7 +61,12 @@ namespace casadi {
         {OT_DOUBLE,
          "When 'smooth_linear' algorithm is active, determines sharpness between"
          " 0 (sharp, as linear interpolation) and 0.5 (smooth)."
-         "Default value is 0.1."}}
+         "Default value is 0.1."}},
+       {"fitting",
+        {OT_STRING,
+         "How the 'not_a_knot' conditions are solved: 'kronecker' (default) solves the "
+         "one-dimensional collocation systems along each dimension in turn, "
+         "'full' solves the tensor-product system at once."}}
      }
   };
 
@@ -75,6 +81,7 @@ namespace casadi {
   }
 
   BSplineInterpolant::~BSplineInterpolant() {
+    clear_mem();
   }
 
   std::vector<double> meshgrid(const std::vector< std::vector<double> >& grid) {
@@ -130,9 +137,10 @@ namespace casadi {
 
     degree_  = std::vector<casadi_int>(offset_.size()-1, 3);
 
-    linear_solver_ = "lsqr";
+    linear_solver_ = "";
     algorithm_ = ALG_NOT_A_KNOT;
     smooth_linear_frac_ = 0.1;
+    fit_full_ = false;
 
     // Read options
     for (auto&& op : opts) {
@@ -153,11 +161,23 @@ namespace casadi {
         smooth_linear_frac_ = op.second;
         casadi_assert(smooth_linear_frac_>0 && smooth_linear_frac_<0.5,
           "smooth_linear_frac must be in ]0,0.5[");
+      } else if (op.first=="fitting") {
+        std::string fitting = op.second.to_string();
+        if (fitting=="kronecker") {
+          fit_full_ = false;
+        } else if (fitting=="full") {
+          fit_full_ = true;
+        } else {
+          casadi_error("Option 'fitting' invalid: " + get_options().info("fitting"));
+        }
       }
     }
 
     casadi_assert_dev(degree_.size()==offset_.size()-1);
 
+    // The one-dimensional systems are small and banded, a direct solver is preferred
+    if (linear_solver_.empty()) linear_solver_ = fit_full_ ? "lsqr" : "qr";
+
     std::vector< std::vector<double> > grid;
     for (casadi_int k=0;k<degree_.size();++k) {
       std::vector<double> local_grid(grid_.begin()+offset_[k], grid_.begin()+offset_[k+1]);
@@ -173,6 +193,11 @@ namespace casadi {
           std::vector< std::vector<double> > knots;
           for (casadi_int k=0;k<degree_.size();++k)
             knots.push_back(not_a_knot(grid[k], degree_[k]));
+          if (!fit_full_) {
+            S_ = Function::bspline("spline", knots, fit_kronecker(knots, grid), degree_, m_,
+                                   opts_bspline);
+            break;
+          }
           Dict opts_dual;
           opts_dual["ad_weight_sp"] = 0;
           opts_dual["lookup_mode"] = lookup_modes_;
@@ -276,6 +301,53 @@ namespace casadi {
 
 
 
+  std::vector<double> BSplineInterpolant::
+  fit_kronecker(const std::vector< std::vector<double> >& knots,
+                const std::vector< std::vector<double> >& grid) const {
+    // The collocation matrix of the tensor-product spline is the Kronecker product of the
+    // one-dimensional collocation matrices, so the system is solved one dimension at a time
+    std::vector<double> c = values_;
+    casadi_int n_dims = degree_.size();
+    casadi_int a = m_, b = c.size()/m_;
+    for (casadi_int k=0;k<n_dims;++k) {
+      casadi_int n = grid[k].size();
+      b /= n;
+
+      // One-dimensional collocation matrix
+      Dict opts_dual;
+      opts_dual["ad_weight_sp"] = 0;
+      if (!lookup_modes_.empty()) {
+        opts_dual["lookup_mode"] = std::vector<std::string>{lookup_modes_[k]};
+      }
+      Function B = Function::bspline_dual("spline", {knots[k]}, grid[k], {degree_[k]}, 1, false,
+                                          opts_dual);
+      DM J = B.jacobian_old(0, 0)(std::vector<DM>{0})[0];
+      casadi_assert_dev(J.size1()==n && J.size2()==n);
+
+      // Fibers along dimension k as columns
+      DM Y = DM::zeros(n, a*b);
+      double* y = Y.ptr();
+      for (casadi_int j=0;j<b;++j) {
+        for (casadi_int i=0;i<n;++i) {
+          for (casadi_int r=0;r<a;++r) y[i+n*(j*a+r)] = c[r+a*(i+n*j)];
+        }
+      }
+      DM X = densify(solve(J, Y, linear_solver_));
+      const double* x = X.ptr();
+      for (casadi_int j=0;j<b;++j) {
+        for (casadi_int i=0;i<n;++i) {
+          for (casadi_int r=0;r<a;++r) c[r+a*(i+n*j)] = x[i+n*(j*a+r)];
+        }
+      }
+      a *= n;
+    }
+
+    if (verbose_) {
+      casadi_message("Coefficients from " + str(n_dims) + " one-dimensional fits");
+    }
+    return c;
+  }
+
   std::vector<double> BSplineInterpolant::greville_points(const std::vector<double>& x,
                                                           casadi_int deg) {
     casadi_int dim = x.size()-deg-1;
@@ -82,6 +82,27 @@ namespace casadi {
     /// Evaluate numerically
     int eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const override;
 
+    ///@{
+    /** \brief Batched evaluation of the spline */
+    bool has_eval_batch() const override { return true;}
+    int eval_batch(const double** arg, double** res, casadi_int* iw, double* w,
+                   void* mem, casadi_int n) const override {
+      return S_->eval_batch(arg, res, iw, w, mem, n);
+    }
+    void codegen_body_batch(CodeGenerator& g, casadi_int n, const std::string& nb,
+                            const std::string& arg, const std::string& res,
+                            const std::string& w) const override {
+      S_->codegen_body_batch(g, n, nb, arg, res, w);
+    }
+    ///@}
+
+    ///@{
+    /** \brief Memory blocks are those of the spline */
+    void* alloc_mem() const override { return S_->alloc_mem();}
+    int init_mem(void* mem) const override { return S_->init_mem(mem);}
+    void free_mem(void *mem) const override { S_->free_mem(mem);}
+    ///@}
+
     ///@{
     /** \brief Full Jacobian */
     bool has_jacobian() const override { return true;}
@@ -119,8 +140,15 @@ namespace casadi {
     FittingAlgorithm algorithm_;
     double smooth_linear_frac_;
 
+    /// Solve the tensor-product system at once instead of one dimension at a time
+    bool fit_full_;
+
     static std::vector<double> greville_points(const std::vector<double>& x, casadi_int degree);
 
+    /// Coefficients interpolating the values, exploiting the Kronecker structure
+    std::vector<double> fit_kronecker(const std::vector< std::vector<double> >& knots,
+                                      const std::vector< std::vector<double> >& grid) const;
+
   };
 
 
@@ -0,0 +1,239 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#include "btf_newton.hpp"
+
+using namespace std;
+namespace casadi {
+
+  extern "C"
+  int CASADI_ROOTFINDER_BTF_EXPORT
+  casadi_register_rootfinder_btf(Rootfinder::Plugin* plugin) {
+    plugin->creator = BtfNewton::creator;
+    plugin->name = "btf";
+    plugin->doc = BtfNewton::meta_doc.c_str();
+    plugin->version = CASADI_VERSION;
+    plugin->options = &BtfNewton::options_;
+    return 0;
+  }
+
+  extern "C"
+  void CASADI_ROOTFINDER_BTF_EXPORT casadi_load_rootfinder_btf() {
+    Rootfinder::registerPlugin(casadi_register_rootfinder_btf);
+  }
+
+  BtfNewton::BtfNewton(const std::string& name, const Function& f)
+    : Rootfinder(name, f) {
+  }
+
+  BtfNewton::~BtfNewton() {
+    clear_mem();
+  }
+
+  Options BtfNewton::options_
+  = {{&Rootfinder::options_},
+     {{"abstol",
+       {OT_DOUBLE,
+        "Stopping criterion tolerance on max(|F|) of each block [1e-12]"}},
+      {"abstolStep",
+       {OT_DOUBLE,
+        "Stopping criterion tolerance on the step size of each block [1e-12]"}},
+      {"max_iter",
+       {OT_INT,
+        "Maximum number of Newton iterations per block [1000]"}}
+     }
+  };
+
+  void BtfNewton::init(const Dict& opts) {
+
+    // Call the base class initializer
+    Rootfinder::init(opts);
+
+    // Default options
+    max_iter_ = 1000;
+    abstol_ = 1e-12;
+    abstolStep_ = 1e-12;
+
+    // Read options
+    for (auto&& op : opts) {
+      if (op.first=="max_iter") {
+        max_iter_ = op.second;
+      } else if (op.first=="abstol") {
+        abstol_ = op.second;
+      } else if (op.first=="abstolStep") {
+        abstolStep_ = op.second;
+      }
+    }
+
+    // Residual in SX, such that each block only evaluates its own equations
+    Function f = oracle_.is_a("SXFunction") ? oracle_ : oracle_.expand();
+    vector<SX> arg = f.sx_in();
+    SX z = arg.at(iin_);
+    SX r = f(arg).at(iout_);
+
+    // Block triangular form of the Jacobian, lower block triangular
+    vector<casadi_int> rowperm, colperm, rowblock, colblock, coarse_rowblock, coarse_colblock;
+    casadi_int nb = sp_jac_.btf(rowperm, colperm, rowblock, colblock,
+                                coarse_rowblock, coarse_colblock);
+
+    // Residual and Jacobian of each block
+    blocks_.resize(nb);
+    max_n_ = max_jac_ = max_w_ = max_v_ = max_r_ = 0;
+    for (casadi_int b=0; b<nb; ++b) {
+      Block& bl = blocks_[b];
+      vector<casadi_int> rows(rowperm.begin()+rowblock[b], rowperm.begin()+rowblock[b+1]);
+      bl.cols.assign(colperm.begin()+colblock[b], colperm.begin()+colblock[b+1]);
+      casadi_assert_dev(rows.size()==bl.cols.size());
+      SX zb = z(bl.cols, 0), rb = r(rows, 0);
+      SX jb = SX::jacobian(rb, zb);
+      bl.linear = !SX::depends_on(jb, zb);
+      bl.f = Function(name_ + "_block" + str(b), arg, {rb, jb});
+      alloc(bl.f);
+      bl.sp_jac = jb.sparsity();
+      casadi_int nbv = bl.cols.size();
+      max_n_ = max(max_n_, nbv);
+      max_jac_ = max(max_jac_, bl.sp_jac.nnz());
+      if (nbv>1) {
+        bl.sp_jac.qr_sparse(bl.sp_v, bl.sp_r, bl.prinv, bl.pc);
+        max_w_ = max(max_w_, bl.sp_v.size1());
+        max_v_ = max(max_v_, bl.sp_v.nnz());
+        max_r_ = max(max_r_, bl.sp_r.nnz());
+      }
+    }
+    if (verbose_) casadi_message(str(nb) + " blocks, the largest of size " + str(max_n_));
+
+    // Auxiliary outputs, evaluated at the solution
+    if (n_out_>1) set_function(oracle_, "f");
+
+    // Allocate memory
+    alloc_w(n_, true); // x
+    alloc_w(max_n_, true); // r
+    alloc_w(max_jac_, true); // jac
+    alloc_w(max_w_, true); // lin_w
+    alloc_w(max_v_, true); // lin_v
+    alloc_w(max_r_, true); // lin_r
+    alloc_w(max_n_, true); // lin_beta
+  }
+
+  void BtfNewton::set_work(void* mem, const double**& arg, double**& res,
+                           casadi_int*& iw, double*& w) const {
+    Rootfinder::set_work(mem, arg, res, iw, w);
+    auto m = static_cast<BtfNewtonMemory*>(mem);
+    m->x = w; w += n_;
+    m->r = w; w += max_n_;
+    m->jac = w; w += max_jac_;
+    m->lin_w = w; w += max_w_;
+    m->lin_v = w; w += max_v_;
+    m->lin_r = w; w += max_r_;
+    m->lin_beta = w; w += max_n_;
+  }
+
+  int BtfNewton::solve(void* mem) const {
+    auto m = static_cast<BtfNewtonMemory*>(mem);
+
+    // Get the initial guess
+    casadi_copy(m->iarg[iin_], n_, m->x);
+
+    // Solve the blocks in order
+    m->iter = 0;
+    m->return_status = "success";
+    bool success = true;
+    for (casadi_int b=0; b<blocks_.size() && success; ++b) {
+      const Block& bl = blocks_[b];
+      casadi_int nbv = bl.cols.size();
+      for (casadi_int k=0; ; ++k) {
+        if (k>=max_iter_) {
+          if (verbose_) casadi_message("Max iterations reached in block " + str(b) + ".");
+          m->return_status = "max_iteration_reached";
+          success = false;
+          break;
+        }
+        m->iter++;
+
+        // Residual and Jacobian of the block
+        copy_n(m->iarg, n_in_, m->arg);
+        m->arg[iin_] = m->x;
+        m->res[0] = m->r;
+        m->res[1] = m->jac;
+        if (bl.f(m->arg, m->res, m->iw, m->w)) return 1;
+        if (casadi_norm_inf(nbv, m->r) <= abstol_) break;
+
+        // Newton step, a division for 1-by-1 blocks
+        if (nbv==1) {
+          if (m->jac[0]==0) {
+            m->return_status = "singular_jacobian";
+            success = false;
+            break;
+          }
+          m->r[0] /= m->jac[0];
+        } else {
+          casadi_qr(bl.sp_jac, m->jac, m->lin_w, bl.sp_v, m->lin_v, bl.sp_r, m->lin_r,
+                    m->lin_beta, get_ptr(bl.prinv), get_ptr(bl.pc));
+          casadi_qr_solve(m->r, 1, 0, bl.sp_v, m->lin_v, bl.sp_r, m->lin_r, m->lin_beta,
+                          get_ptr(bl.prinv), get_ptr(bl.pc), m->lin_w);
+        }
+        for (casadi_int i=0; i<nbv; ++i) m->x[bl.cols[i]] -= m->r[i];
+
+        // A linear block is solved exactly in one step
+        if (bl.linear || casadi_norm_inf(nbv, m->r) <= abstolStep_) break;
+      }
+    }
+
+    // Auxiliary outputs at the solution
+    if (n_out_>1) {
+      copy_n(m->iarg, n_in_, m->arg);
+      m->arg[iin_] = m->x;
+      copy_n(m->ires, n_out_, m->res);
+      m->res[iout_] = nullptr;
+      calc_function(m, "f");
+    }
+
+    // Get the solution
+    casadi_copy(m->x, n_, m->ires[iout_]);
+    if (verbose_) casadi_message("Solved " + str(blocks_.size()) + " blocks in "
+                                 + str(m->iter) + " iterations");
+    m->success = success;
+    return 0;
+  }
+
+  int BtfNewton::init_mem(void* mem) const {
+    if (Rootfinder::init_mem(mem)) return 1;
+    auto m = static_cast<BtfNewtonMemory*>(mem);
+    m->return_status = nullptr;
+    m->iter = 0;
+    return 0;
+  }
+
+  Dict BtfNewton::get_stats(void* mem) const {
+    Dict stats = Rootfinder::get_stats(mem);
+    auto m = static_cast<BtfNewtonMemory*>(mem);
+    stats["return_status"] = m->return_status;
+    stats["iter_count"] = m->iter;
+    stats["n_block"] = static_cast<casadi_int>(blocks_.size());
+    return stats;
+  }
+
+} // namespace casadi
@@ -0,0 +1,150 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#ifndef CASADI_BTF_NEWTON_HPP
+#define CASADI_BTF_NEWTON_HPP
+
+#include "casadi/core/rootfinder_impl.hpp"
+#include <casadi/solvers/casadi_rootfinder_btf_export.h>
+
+/** \defgroup plugin_Rootfinder_btf
+     Solves a sparse system of equations block by block. A block triangular form
+     of the Jacobian splits the equations into a sequence of strongly connected
+     blocks, each of which only depends on its own unknowns and on those of the
+     preceding blocks. The blocks are solved one after the other with Newton's
+     method, blocks that are linear in their unknowns in a single step. The
+     residual function is expanded into SX, so that each block only evaluates the
+     part of the residual it needs.
+*/
+
+/** \pluginsection{Rootfinder,btf} */
+
+/// \cond INTERNAL
+namespace casadi {
+
+  // Memory
+  struct CASADI_ROOTFINDER_BTF_EXPORT BtfNewtonMemory
+    : public RootfinderMemory {
+    // Current guess
+    double* x;
+    // Residual and Jacobian of the current block
+    double *r, *jac;
+    // QR factorization of the current block
+    double *lin_w, *lin_v, *lin_r, *lin_beta;
+    // Return status
+    const char* return_status;
+    // Number of iterations, summed over the blocks
+    casadi_int iter;
+  };
+
+  /** \brief \pluginbrief{Rootfinder,btf}
+
+      @copydoc Rootfinder_doc
+      @copydoc plugin_Rootfinder_btf
+  */
+  class CASADI_ROOTFINDER_BTF_EXPORT BtfNewton : public Rootfinder {
+  public:
+    /** \brief  Constructor */
+    explicit BtfNewton(const std::string& name, const Function& f);
+
+    /** \brief  Destructor */
+    ~BtfNewton() override;
+
+    // Get name of the plugin
+    const char* plugin_name() const override { return "btf";}
+
+    // Name of the class
+    std::string class_name() const override { return "BtfNewton";}
+
+    /** \brief  Create a new Rootfinder */
+    static Rootfinder* creator(const std::string& name, const Function& f) {
+      return new BtfNewton(name, f);
+    }
+
+    ///@{
+    /** \brief Options */
+    static Options options_;
+    const Options& get_options() const override { return options_;}
+    ///@}
+
+    /** \brief  Initialize */
+    void init(const Dict& opts) override;
+
+    /** \brief Create memory block */
+    void* alloc_mem() const override { return new BtfNewtonMemory();}
+
+    /** \brief Initalize memory block */
+    int init_mem(void* mem) const override;
+
+    /** \brief Free memory block */
+    void free_mem(void *mem) const override { delete static_cast<BtfNewtonMemory*>(mem);}
+
+    /** \brief Set the (persistent) work vectors */
+    void set_work(void* mem, const double**& arg, double**& res,
+                          casadi_int*& iw, double*& w) const override;
+
+    /// Solve the system of equations
+    int solve(void* mem) const override;
+
+    /// Get all statistics
+    Dict get_stats(void* mem) const override;
+
+    /// A documentation string
+    static const std::string meta_doc;
+
+  protected:
+    /// A strongly connected block of equations
+    struct Block {
+      // Residual of the block and its Jacobian with respect to the block unknowns
+      Function f;
+      // Unknowns of the block
+      std::vector<casadi_int> cols;
+      // Is the block linear in its unknowns?
+      bool linear;
+      // Symbolic QR factorization of the block Jacobian
+      Sparsity sp_jac, sp_v, sp_r;
+      std::vector<casadi_int> prinv, pc;
+    };
+
+    /// Blocks, in the order they are solved
+    std::vector<Block> blocks_;
+
+    /// Largest block dimension, Jacobian and QR factorization over the blocks
+    casadi_int max_n_, max_jac_, max_w_, max_v_, max_r_;
+
+    /// Maximum number of Newton iterations per block
+    casadi_int max_iter_;
+
+    /// Absolute tolerance that should be met on residual
+    double abstol_;
+
+    /// Absolute tolerance that should be met on step
+    double abstolStep_;
+  };
+
+} // namespace casadi
+/// \endcond
+#endif // CASADI_BTF_NEWTON_HPP
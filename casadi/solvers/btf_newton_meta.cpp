@@ -0,0 +1,79 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+      #include "btf_newton.hpp"
+      #include <string>
+
+      const std::string casadi::BtfNewton::meta_doc=
+      "\n"
+"Solves a sparse system of equations block by block. A block triangular form\n"
+"of the Jacobian splits the equations into a sequence of strongly connected\n"
+"blocks, each of which only depends on its own unknowns and on those of the\n"
+"preceding blocks. The blocks are solved one after the other with Newton's\n"
+"method, blocks that are linear in their unknowns in a single step. The\n"
+"residual function is expanded into SX, so that each block only evaluates the\n"
+"part of the residual it needs.\n"
+"\n"
+"\n"
+">List of available options\n"
+"\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
+"|       Id        |      Type       |     Default     |   Description   |\n"
+"+=================+=================+=================+=================+\n"
+"| abstol          | OT_DOUBLE       | 1e-12           | Stopping        |\n"
+"|                 |                 |                 | criterion       |\n"
+"|                 |                 |                 | tolerance on    |\n"
+"|                 |                 |                 | max(|F|) of     |\n"
+"|                 |                 |                 | each block      |\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
+"| abstolStep      | OT_DOUBLE       | 1e-12           | Stopping        |\n"
+"|                 |                 |                 | criterion       |\n"
+"|                 |                 |                 | tolerance on    |\n"
+"|                 |                 |                 | the step size   |\n"
+"|                 |                 |                 | of each block   |\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
+"| max_iter        | OT_INT          | 1000            | Maximum number  |\n"
+"|                 |                 |                 | of Newton       |\n"
+"|                 |                 |                 | iterations per  |\n"
+"|                 |                 |                 | block           |\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
+"\n"
+"\n"
+">List of available stats\n"
+"\n"
+"+---------------+\n"
+"|      Id       |\n"
+"+===============+\n"
+"| iter_count    |\n"
+"+---------------+\n"
+"| n_block       |\n"
+"+---------------+\n"
+"| return_status |\n"
+"+---------------+\n"
+"\n"
+"\n"
+"\n"
+"\n"
+;
@@ -26,10 +26,135 @@
 #include "collocation.hpp"
 #include "casadi/core/polynomial.hpp"
 #include "casadi/core/casadi_misc.hpp"
+#include "casadi/core/thread_pool.hpp"
 
 using namespace std;
 namespace casadi {
 
+  namespace {
+    typedef complex<double> Complex;
+
+    // Dense LU factorization with partial pivoting, column-major A overwritten by L and U.
+    // Returns true if a pivot is zero
+    template<typename T>
+    bool dense_lu(casadi_int n, T* A, casadi_int* ipiv) {
+      bool singular = false;
+      for (casadi_int k=0; k<n; ++k) {
+        casadi_int p = k;
+        for (casadi_int i=k+1; i<n; ++i) {
+          if (abs(A[i+k*n]) > abs(A[p+k*n])) p = i;
+        }
+        ipiv[k] = p;
+        if (p!=k) {
+          for (casadi_int j=0; j<n; ++j) swap(A[k+j*n], A[p+j*n]);
+        }
+        if (A[k+k*n]==T(0)) {
+          singular = true;
+          continue;
+        }
+        for (casadi_int i=k+1; i<n; ++i) A[i+k*n] /= A[k+k*n];
+        for (casadi_int j=k+1; j<n; ++j) {
+          T a = A[k+j*n];
+          if (a==T(0)) continue;
+          for (casadi_int i=k+1; i<n; ++i) A[i+j*n] -= A[i+k*n]*a;
+        }
+      }
+      return singular;
+    }
+
+    // Solve A*x = b in place with the factorization of dense_lu
+    template<typename T>
+    void dense_lu_solve(casadi_int n, const T* A, const casadi_int* ipiv, T* b) {
+      for (casadi_int k=0; k<n; ++k) swap(b[k], b[ipiv[k]]);
+      for (casadi_int k=0; k<n; ++k) {
+        for (casadi_int i=k+1; i<n; ++i) b[i] -= A[i+k*n]*b[k];
+      }
+      for (casadi_int k=n-1; k>=0; --k) {
+        b[k] /= A[k+k*n];
+        for (casadi_int i=0; i<k; ++i) b[i] -= A[i+k*n]*b[k];
+      }
+    }
+
+    // Eigenvector for the eigenvalue lambda of the column-major n-by-n matrix C:
+    // with C - lambda*I = P*L*U singular, solve U*v = 0 with v[n-1] = 1
+    vector<Complex> eigenvector(casadi_int n, const vector<double>& C, Complex lambda) {
+      vector<Complex> M(C.begin(), C.end());
+      for (casadi_int i=0; i<n; ++i) M[i+i*n] -= lambda;
+      vector<casadi_int> ipiv(n);
+      dense_lu(n, get_ptr(M), get_ptr(ipiv));
+      vector<Complex> v(n, 0);
+      v[n-1] = 1;
+      for (casadi_int k=n-2; k>=0; --k) {
+        Complex s = 0;
+        for (casadi_int j=k+1; j<n; ++j) s += M[k+j*n]*v[j];
+        v[k] = -s/M[k+k*n];
+      }
+      // Normalize by the largest entry
+      Complex vmax = 0;
+      for (auto& e : v) if (abs(e)>abs(vmax)) vmax = e;
+      for (auto& e : v) e /= vmax;
+      return v;
+    }
+
+    // Eigenvalues of a small column-major real matrix with distinct eigenvalues:
+    // characteristic polynomial (Faddeev-LeVerrier) and its roots (Durand-Kerner),
+    // refined with a few steps of Rayleigh quotient iteration
+    vector<Complex> eigenvalues(casadi_int n, const vector<double>& C) {
+      // Coefficients c[k] of lambda^k, c[n] = 1
+      vector<double> c(n+1, 0), M(n*n, 0), CM(n*n);
+      c[n] = 1;
+      for (casadi_int k=1; k<=n; ++k) {
+        // M = C*M + c[n-k+1]*I
+        for (casadi_int j=0; j<n; ++j) {
+          for (casadi_int i=0; i<n; ++i) {
+            double s = 0;
+            for (casadi_int l=0; l<n; ++l) s += C[i+l*n]*M[l+j*n];
+            CM[i+j*n] = s;
+          }
+        }
+        for (casadi_int i=0; i<n; ++i) CM[i+i*n] += c[n-k+1];
+        M = CM;
+        // c[n-k] = -trace(C*M)/k
+        double tr = 0;
+        for (casadi_int i=0; i<n; ++i) {
+          for (casadi_int l=0; l<n; ++l) tr += C[i+l*n]*M[l+i*n];
+        }
+        c[n-k] = -tr/static_cast<double>(k);
+      }
+      // Simultaneous iteration for all roots
+      vector<Complex> z(n);
+      for (casadi_int k=0; k<n; ++k) z[k] = pow(Complex(0.4, 0.9), static_cast<int>(k));
+      for (casadi_int iter=0; iter<1000; ++iter) {
+        double delta = 0, zmax = 1;
+        for (casadi_int k=0; k<n; ++k) {
+          Complex num = c[n], den = 1;
+          for (casadi_int l=n-1; l>=0; --l) num = num*z[k] + c[l];
+          for (casadi_int l=0; l<n; ++l) if (l!=k) den *= z[k] - z[l];
+          Complex d = num/den;
+          z[k] -= d;
+          delta = max(delta, abs(d));
+          zmax = max(zmax, abs(z[k]));
+        }
+        if (delta <= 1e-14*zmax) break;
+      }
+      // Refine
+      for (Complex& lambda : z) {
+        for (casadi_int iter=0; iter<3; ++iter) {
+          vector<Complex> v = eigenvector(n, C, lambda);
+          Complex num = 0, den = 0;
+          for (casadi_int i=0; i<n; ++i) {
+            Complex Cv = 0;
+            for (casadi_int l=0; l<n; ++l) Cv += C[i+l*n]*v[l];
+            num += conj(v[i])*Cv;
+            den += conj(v[i])*v[i];
+          }
+          lambda = num/den;
+        }
+      }
+      return z;
+    }
+  } // namespace
+
   extern "C"
   int CASADI_INTEGRATOR_COLLOCATION_EXPORT
       casadi_register_integrator_collocation(Integrator::Plugin* plugin) {
@@ -60,7 +185,24 @@ namespace casadi {
         "Order of the interpolating polynomials"}},
       {"collocation_scheme",
        {OT_STRING,
-        "Collocation scheme: radau|legendre"}}
+        "Collocation scheme: radau|legendre"}},
+      {"newton_scheme",
+       {OT_STRING,
+        "Solution of the collocation equations of a step: 'rootfinder' uses the "
+        "rootfinder on the full system, 'transformed' uses a simplified Newton method "
+        "with the DAE Jacobian at the start of the step, where a transformation with "
+        "the eigenvectors of the collocation matrix decouples the collocation points "
+        "(cf. RADAU5). Only one dense system of size nx+nz per real eigenvalue or "
+        "complex conjugate pair is factorized, and reused over the iterations. "
+        "The backward problem then factorizes the Jacobians of all steps up front, "
+        "concurrently with max_num_threads>1, so that the backward sweep only "
+        "needs back-substitutions [rootfinder]"}},
+      {"newton_abstol",
+       {OT_DOUBLE,
+        "Tolerance on max(|F|) for the transformed scheme [1e-12]"}},
+      {"newton_max_iter",
+       {OT_INT,
+        "Maximum number of iterations per step for the transformed scheme [50]"}}
      }
   };
 
@@ -68,6 +210,9 @@ namespace casadi {
     // Default options
     deg_ = 3;
     collocation_scheme_ = "radau";
+    std::string newton_scheme = "rootfinder";
+    newton_abstol_ = 1e-12;
+    newton_max_iter_ = 50;
 
     // Read options
     for (auto&& op : opts) {
@@ -75,8 +220,17 @@ namespace casadi {
         deg_ = op.second;
       } else if (op.first=="collocation_scheme") {
         collocation_scheme_ = op.second.to_string();
+      } else if (op.first=="newton_scheme") {
+        newton_scheme = op.second.to_string();
+      } else if (op.first=="newton_abstol") {
+        newton_abstol_ = op.second;
+      } else if (op.first=="newton_max_iter") {
+        newton_max_iter_ = op.second;
       }
     }
+    casadi_assert(newton_scheme=="rootfinder" || newton_scheme=="transformed",
+                  "Option 'newton_scheme' must be 'rootfinder' or 'transformed'");
+    transformed_ = newton_scheme=="transformed";
 
     // Call the base class init
     ImplicitFixedStepIntegrator::init(opts);
@@ -100,6 +254,11 @@ namespace casadi {
     // Coefficients of the quadratures
     vector<double> B(deg_+1, 0);
 
+    // Bases for dense output
+    x_basis_.resize(deg_+1);
+    z_basis_.resize(deg_);
+    q_basis_.resize(deg_);
+
     // For all collocation points
     for (casadi_int j=0; j<deg_+1; ++j) {
 
@@ -129,6 +288,91 @@ namespace casadi {
       // Integrate polynomial to get the coefficients of the quadratures
       Polynomial ip = p.anti_derivative();
       B[j] = ip(1.0);
+      x_basis_[j] = p;
+
+      // Lagrange polynomial for z, which is only defined at the collocation points
+      if (j>0) {
+        Polynomial pz = 1;
+        for (casadi_int r=1; r<deg_+1; ++r) {
+          if (r!=j) {
+            pz *= Polynomial(-tau_root[r], 1)/(tau_root[j]-tau_root[r]);
+          }
+        }
+        z_basis_[j-1] = pz;
+        q_basis_[j-1] = pz.anti_derivative();
+      }
+    }
+    tau_root_ = tau_root;
+
+    // Eigendecomposition of the collocation matrix for the transformed Newton scheme
+    if (transformed_) {
+      // Dependence of the collocation equation j on x_r, column-major
+      vector<double> A(deg_*deg_);
+      for (casadi_int j=0; j<deg_; ++j) {
+        for (casadi_int r=0; r<deg_; ++r) A[j+r*deg_] = C[r+1][j+1];
+      }
+      lambda_ = eigenvalues(deg_, A);
+      double scale = 1;
+      for (auto& l : lambda_) scale = max(scale, abs(l));
+
+      // Real eigenvalues and complex conjugate pairs, sharing a block
+      conj_.assign(deg_, -1);
+      block_.assign(deg_, -1);
+      casadi_int nb = 0;
+      for (casadi_int i=0; i<deg_; ++i) {
+        if (block_[i]>=0) continue;
+        block_[i] = nb++;
+        if (abs(lambda_[i].imag()) <= 1e-8*scale) {
+          lambda_[i] = lambda_[i].real();
+          continue;
+        }
+        casadi_int c = -1;
+        for (casadi_int j=i+1; j<deg_; ++j) {
+          if (block_[j]<0 && (c<0 || abs(lambda_[j]-conj(lambda_[i]))
+                                     < abs(lambda_[c]-conj(lambda_[i])))) c = j;
+        }
+        casadi_assert(c>=0 && abs(lambda_[c]-conj(lambda_[i])) <= 1e-6*scale,
+                      "Collocation matrix has an unpaired complex eigenvalue");
+        lambda_[c] = conj(lambda_[i]);
+        conj_[i] = c;
+        conj_[c] = i;
+        block_[c] = block_[i];
+      }
+
+      // Eigenvectors, conjugate for conjugate pairs
+      V_.resize(deg_*deg_);
+      for (casadi_int i=0; i<deg_; ++i) {
+        if (conj_[i]>=0 && conj_[i]<i) {
+          for (casadi_int j=0; j<deg_; ++j) V_[j+i*deg_] = conj(V_[j+conj_[i]*deg_]);
+        } else {
+          vector<Complex> v = eigenvector(deg_, A, lambda_[i]);
+          if (conj_[i]<0) for (auto& e : v) e = e.real();
+          copy(v.begin(), v.end(), V_.begin()+i*deg_);
+        }
+      }
+
+      // Inverse of the eigenvectors
+      vector<Complex> LU = V_;
+      vector<casadi_int> ipiv(deg_);
+      casadi_assert(!dense_lu(deg_, get_ptr(LU), get_ptr(ipiv)),
+                    "Collocation matrix is not diagonalizable");
+      Vinv_.assign(deg_*deg_, 0);
+      for (casadi_int i=0; i<deg_; ++i) {
+        Vinv_[i+i*deg_] = 1;
+        dense_lu_solve(deg_, get_ptr(LU), get_ptr(ipiv), get_ptr(Vinv_)+i*deg_);
+      }
+
+      // Check the decomposition
+      double err = 0;
+      for (casadi_int j=0; j<deg_; ++j) {
+        for (casadi_int r=0; r<deg_; ++r) {
+          Complex a = 0;
+          for (casadi_int i=0; i<deg_; ++i) a += V_[j+i*deg_]*lambda_[i]*Vinv_[i+r*deg_];
+          err = max(err, abs(a-A[j+r*deg_]));
+        }
+      }
+      casadi_assert(err <= 1e-8*scale, "Eigendecomposition of the collocation matrix failed, "
+                    "error " + str(err));
     }
 
     // Symbolic inputs
@@ -213,6 +457,19 @@ namespace casadi {
     F_ = Function("dae", F_in, F_out);
     alloc(F_);
 
+    // Scaled DAE Jacobian [h*ode_x, h*ode_z; alg_x, alg_z] for the transformed scheme
+    if (transformed_) {
+      vector<MX> f_arg(DAE_NUM_IN);
+      f_arg[DAE_X] = MX::sym("x", this->x());
+      f_arg[DAE_Z] = MX::sym("z", this->z());
+      f_arg[DAE_P] = p;
+      f_arg[DAE_T] = t;
+      vector<MX> f_res = f_(f_arg);
+      MX J = MX::jacobian(vertcat(vec(h_*f_res[DAE_ODE]), vec(f_res[DAE_ALG])),
+                      vertcat(vec(f_arg[DAE_X]), vec(f_arg[DAE_Z])));
+      set_function(Function("jac_dae", f_arg, {MX::densify(J)}));
+    }
+
     // Backwards dynamics
     // NOTE: The following is derived so that it will give the exact adjoint
     // sensitivities whenever g is the reverse mode derivative of f.
@@ -297,6 +554,12 @@ namespace casadi {
       G_out[RDAE_QUAD] = rqf;
       G_ = Function("rdae", G_in, G_out);
       alloc(G_);
+
+      // Jacobian of the backward collocation equations, factorized for all steps up front
+      if (transformed_) {
+        MX J = MX::jacobian(G_out[RDAE_ALG], rv);
+        set_function(Function("rdae_jac", G_in, {MX::densify(J)}));
+      }
     }
   }
 
@@ -332,6 +595,257 @@ namespace casadi {
       casadi_copy(rz, nrz_, RZ);
       RZ += nrz_;
     }
+
+    // Factorize the Jacobians of all steps
+    if (transformed_) factorizeB(static_cast<CollocationMemory*>(mem));
+  }
+
+  int Collocation::init_mem(void* mem) const {
+    if (ImplicitFixedStepIntegrator::init_mem(mem)) return 1;
+    auto m = static_cast<CollocationMemory*>(mem);
+    if (!transformed_) return 0;
+
+    // Work vectors of the transformed Newton scheme
+    casadi_int n = nx_+nz_, nb = 0;
+    for (casadi_int b : block_) nb = max(nb, b+1);
+    m->v.resize(max(nZ_, nRZ_));
+    m->r.resize(max(nZ_, nRZ_));
+    m->dv.resize(nZ_);
+    m->J.resize(n*n);
+    m->K.assign(nb, vector<Complex>(n*n));
+    m->ipiv.assign(nb, vector<casadi_int>(n));
+    m->rt.resize(deg_*n);
+    if (nrx_>0) {
+      m->KB.assign(nk_, vector<double>(nRZ_*nRZ_));
+      m->ipivB.assign(nk_, vector<casadi_int>(nRZ_));
+    }
+    return 0;
+  }
+
+  void Collocation::free_mem(void *mem) const {
+    auto m = static_cast<CollocationMemory*>(mem);
+    if (m->mem_F>=0) rootfinder_.release(m->mem_F);
+    if (m->mem_G>=0) backward_rootfinder_.release(m->mem_G);
+    delete m;
+  }
+
+  void Collocation::factorize(CollocationMemory* m, const double* t, const double* x,
+                              const double* z, const double* p) const {
+    casadi_int n = nx_+nz_;
+
+    // Scaled DAE Jacobian
+    fill_n(m->arg, DAE_NUM_IN, nullptr);
+    m->arg[DAE_X] = x;
+    m->arg[DAE_Z] = z;
+    m->arg[DAE_P] = p;
+    m->arg[DAE_T] = t;
+    m->res[0] = get_ptr(m->J);
+    if (calc_function(m, "jac_dae")) casadi_error("Collocation: 'jac_dae' failed");
+
+    // Factorize J - lambda*E, E the identity for the differential states
+    for (casadi_int i=0; i<deg_; ++i) {
+      if (conj_[i]>=0 && conj_[i]<i) continue;
+      vector<Complex>& K = m->K[block_[i]];
+      copy(m->J.begin(), m->J.end(), K.begin());
+      for (casadi_int j=0; j<nx_; ++j) K[j+j*n] -= lambda_[i];
+      if (dense_lu(n, get_ptr(K), get_ptr(m->ipiv[block_[i]]))) {
+        casadi_error("Collocation: singular Newton matrix at t = " + str(*t));
+      }
+    }
+    m->nfact++;
+  }
+
+  void Collocation::stepF(FixedStepMemory* mem) const {
+    if (!transformed_) return ImplicitFixedStepIntegrator::stepF(mem);
+    auto m = static_cast<CollocationMemory*>(mem);
+    casadi_int n = nx_+nz_;
+
+    // Inputs and outputs of the step
+    const double *t = m->arg[DAE_T], *x0 = m->arg[DAE_X], *p = m->arg[DAE_P];
+    double *xf = m->res[DAE_ODE], *sol = m->res[DAE_ALG], *qf = m->res[DAE_QUAD];
+    const double* guess = m->arg[DAE_Z];
+    double* v = get_ptr(m->v);
+    double* r = get_ptr(m->r);
+    double* dv = get_ptr(m->dv);
+    casadi_copy(guess, nZ_, v);
+
+    // Jacobian at the start of the step, algebraic states from the guess
+    factorize(m, t, x0, v+nZ_-nz_, p);
+
+    // Simplified Newton iterations
+    double step = inf, step_prev = inf, tend = *t + h_;
+    for (casadi_int iter=0; ; ++iter) {
+      // Residual, with the outputs at the current iterate
+      fill_n(m->arg, DAE_NUM_IN, nullptr);
+      m->arg[DAE_T] = t;
+      m->arg[DAE_X] = x0;
+      m->arg[DAE_Z] = v;
+      m->arg[DAE_P] = p;
+      fill_n(m->res, DAE_NUM_OUT, nullptr);
+      m->res[DAE_ODE] = xf;
+      m->res[DAE_ALG] = r;
+      m->res[DAE_QUAD] = qf;
+      if (F_(m->arg, m->res, m->iw, m->w)) casadi_error("Collocation: 'dae' failed");
+
+      // Converged?
+      if (casadi_norm_inf(nZ_, r) <= newton_abstol_ || step <= newton_abstol_) {
+        m->niter += iter;
+        break;
+      }
+      casadi_assert(iter<newton_max_iter_, "Collocation: transformed Newton method did not "
+                    "converge at t = " + str(*t) + ", max(|F|) = " + str(casadi_norm_inf(nZ_, r)));
+
+      // Transform the residual with the inverse eigenvectors and solve the decoupled systems
+      for (casadi_int i=0; i<deg_; ++i) {
+        if (conj_[i]>=0 && conj_[i]<i) continue;
+        Complex* y = get_ptr(m->rt) + i*n;
+        fill_n(y, n, 0);
+        for (casadi_int j=0; j<deg_; ++j) {
+          const Complex& a = Vinv_[i+j*deg_];
+          for (casadi_int k=0; k<n; ++k) y[k] += a*r[k+j*n];
+        }
+        dense_lu_solve(n, get_ptr(m->K[block_[i]]), get_ptr(m->ipiv[block_[i]]), y);
+      }
+
+      // Transform back, a conjugate pair contributes twice the real part
+      casadi_fill(dv, nZ_, 0.);
+      for (casadi_int i=0; i<deg_; ++i) {
+        if (conj_[i]>=0 && conj_[i]<i) continue;
+        const Complex* y = get_ptr(m->rt) + i*n;
+        double s = conj_[i]<0 ? 1 : 2;
+        for (casadi_int j=0; j<deg_; ++j) {
+          const Complex& a = V_[j+i*deg_];
+          for (casadi_int k=0; k<n; ++k) dv[k+j*n] += s*(a*y[k]).real();
+        }
+      }
+      casadi_axpy(nZ_, -1., dv, v);
+
+      // Refactorize at the end of the step if the convergence is slow
+      step_prev = step;
+      step = casadi_norm_inf(nZ_, dv);
+      if (iter>0 && step>0.5*step_prev) factorize(m, &tend, v+nZ_-n, v+nZ_-nz_, p);
+    }
+
+    // Solution
+    casadi_copy(v, nZ_, sol);
+    m->arg[DAE_Z] = guess;
+    m->res[DAE_ALG] = sol;
+  }
+
+  void Collocation::factorizeB(CollocationMemory* m) const {
+    const Function& J = get_function("rdae_jac");
+    casadi_int n_threads = min(max_num_threads_, nk_);
+
+    // One memory object per thread
+    vector< scoped_checkout<Function> > ind;
+    ind.reserve(n_threads);
+    for (casadi_int t=0; t<n_threads; ++t) ind.emplace_back(J);
+
+    // Factorize the Jacobian of step k with thread t
+    vector<casadi_int> flag(nk_, 0);
+    auto task = [&](casadi_int k, casadi_int t) {
+      const double** arg = t==0 ? m->arg : get_ptr(m->thread_arg[t-1]);
+      double** res = t==0 ? m->res : get_ptr(m->thread_res[t-1]);
+      casadi_int* iw = t==0 ? m->iw : get_ptr(m->thread_iw[t-1]);
+      double* w = t==0 ? m->w : get_ptr(m->thread_w[t-1]);
+      double tk = grid_.front() + static_cast<double>(k)*h_;
+      fill_n(arg, RDAE_NUM_IN, nullptr);
+      arg[RDAE_T] = &tk;
+      arg[RDAE_X] = get_ptr(m->x_tape[k]);
+      arg[RDAE_Z] = get_ptr(m->Z_tape[k]);
+      arg[RDAE_P] = get_ptr(m->p);
+      arg[RDAE_RP] = get_ptr(m->rp);
+      res[0] = get_ptr(m->KB[k]);
+      flag[k] = J(arg, res, iw, w, ind[t]) ? 1 : 0;
+      if (!flag[k] && dense_lu(nRZ_, get_ptr(m->KB[k]), get_ptr(m->ipivB[k]))) flag[k] = 2;
+    };
+    if (n_threads>1) {
+      ThreadPool::run(nk_, n_threads, task);
+    } else {
+      for (casadi_int k=0; k<nk_; ++k) task(k, 0);
+    }
+    for (casadi_int k=0; k<nk_; ++k) {
+      casadi_assert(flag[k]!=1, "Collocation: 'rdae_jac' failed");
+      casadi_assert(flag[k]!=2, "Collocation: singular backward Newton matrix in step "
+                    + str(k));
+    }
+    m->nfactB += nk_;
+  }
+
+  void Collocation::stepG(FixedStepMemory* mem) const {
+    if (!transformed_) return ImplicitFixedStepIntegrator::stepG(mem);
+    auto m = static_cast<CollocationMemory*>(mem);
+
+    // Unknowns and residual of the step
+    const double* guess = m->arg[RDAE_RZ];
+    double* sol = m->res[RDAE_ALG];
+    double* v = get_ptr(m->v);
+    double* r = get_ptr(m->r);
+    casadi_copy(guess, nRZ_, v);
+    m->arg[RDAE_RZ] = v;
+    m->res[RDAE_ALG] = r;
+
+    // Newton iterations with the factorization of the step, exact if g is linear in rx and rz
+    double step = inf;
+    for (casadi_int iter=0; ; ++iter) {
+      if (G_(m->arg, m->res, m->iw, m->w)) casadi_error("Collocation: 'rdae' failed");
+      if (casadi_norm_inf(nRZ_, r) <= newton_abstol_ || step <= newton_abstol_) {
+        m->niterB += iter;
+        break;
+      }
+      casadi_assert(iter<newton_max_iter_, "Collocation: backward Newton method did not "
+                    "converge in step " + str(m->k));
+      dense_lu_solve(nRZ_, get_ptr(m->KB[m->k]), get_ptr(m->ipivB[m->k]), r);
+      casadi_axpy(nRZ_, -1., r, v);
+      step = casadi_norm_inf(nRZ_, r);
+    }
+
+    // Solution
+    casadi_copy(v, nRZ_, sol);
+    m->arg[RDAE_RZ] = guess;
+    m->res[RDAE_ALG] = sol;
+  }
+
+  void Collocation::interpolate(FixedStepMemory* m, double theta,
+                                double* x, double* z, double* q) const {
+    // Collocated states in Z, laid out as [x1, z1, ..., xd, zd]
+    const double* v = get_ptr(m->Z);
+    if (x) {
+      casadi_copy(get_ptr(m->x_prev), nx_, x);
+      casadi_scal(nx_, x_basis_[0](theta), x);
+      for (casadi_int j=1; j<deg_+1; ++j) {
+        casadi_axpy(nx_, x_basis_[j](theta), v + (j-1)*(nx_+nz_), x);
+      }
+    }
+    if (z) {
+      casadi_fill(z, nz_, 0.);
+      for (casadi_int j=1; j<deg_+1; ++j) {
+        casadi_axpy(nz_, z_basis_[j-1](theta), v + (j-1)*(nx_+nz_) + nx_, z);
+      }
+    }
+
+    // Quadrature derivatives at the collocation points, calculated once per step
+    if (q && nq_>0) {
+      if (m->k_dense!=m->k) {
+        m->dense.resize(deg_*nq_);
+        for (casadi_int j=1; j<deg_+1; ++j) {
+          double tj = m->t - h_ + h_*tau_root_[j];
+          fill_n(m->arg, DAE_NUM_IN, nullptr);
+          m->arg[DAE_X] = v + (j-1)*(nx_+nz_);
+          m->arg[DAE_Z] = v + (j-1)*(nx_+nz_) + nx_;
+          m->arg[DAE_P] = get_ptr(m->p);
+          m->arg[DAE_T] = &tj;
+          fill_n(m->res, DAE_NUM_OUT, nullptr);
+          m->res[DAE_QUAD] = get_ptr(m->dense) + (j-1)*nq_;
+          if (calc_function(m, "f")) casadi_error("Collocation::interpolate: 'f' failed");
+        }
+        m->k_dense = m->k;
+      }
+      casadi_copy(get_ptr(m->q_prev), nq_, q);
+      for (casadi_int j=1; j<deg_+1; ++j) {
+        casadi_axpy(nq_, h_*q_basis_[j-1](theta), get_ptr(m->dense) + (j-1)*nq_, q);
+      }
+    }
   }
 
 } // namespace casadi
@@ -28,7 +28,9 @@
 
 #include "casadi/core/integrator_impl.hpp"
 #include "casadi/core/integration_tools.hpp"
+#include "casadi/core/polynomial.hpp"
 #include <casadi/solvers/casadi_integrator_collocation_export.h>
+#include <complex>
 
 /** \defgroup plugin_Integrator_collocation
 
@@ -44,6 +46,26 @@
 /// \cond INTERNAL
 namespace casadi {
 
+  /** \brief Memory of the collocation integrator, cf. option "newton_scheme" */
+  struct CASADI_INTEGRATOR_COLLOCATION_EXPORT CollocationMemory : public FixedStepMemory {
+    // Collocated variables, residual and Newton step of the transformed scheme
+    std::vector<double> v, r, dv;
+
+    // Scaled DAE Jacobian [h*ode_x, h*ode_z; alg_x, alg_z]
+    std::vector<double> J;
+
+    // Factorized blocks J - lambda_i*E, one per real eigenvalue or conjugate pair
+    std::vector<std::vector<std::complex<double> > > K;
+    std::vector<std::vector<casadi_int> > ipiv;
+
+    // Residual and step transformed with the eigenvectors
+    std::vector<std::complex<double> > rt;
+
+    // Factorized Jacobians of the backward steps
+    std::vector<std::vector<double> > KB;
+    std::vector<std::vector<casadi_int> > ipivB;
+  };
+
   /**
      \brief \pluginbrief{Integrator,collocation}
 
@@ -83,6 +105,15 @@ namespace casadi {
     /// Initialize stage
     void init(const Dict& opts) override;
 
+    /** \brief Create memory block */
+    void* alloc_mem() const override { return new CollocationMemory();}
+
+    /** \brief Initalize memory block */
+    int init_mem(void* mem) const override;
+
+    /** \brief Free memory block */
+    void free_mem(void *mem) const override;
+
     /// Setup F and G
     void setupFG() override;
 
@@ -97,12 +128,51 @@ namespace casadi {
     void resetB(IntegratorMemory* mem, double t, const double* rx,
                         const double* rz, const double* rp) const override;
 
+    /// Take a step, with the transformed Newton scheme if requested
+    void stepF(FixedStepMemory* m) const override;
+
+    /// Take a step, with the precomputed factorizations if requested (backward problem)
+    void stepG(FixedStepMemory* m) const override;
+
+    /// Factorize the blocks of the transformed Newton scheme at x and z
+    void factorize(CollocationMemory* m, const double* t, const double* x, const double* z,
+                   const double* p) const;
+
+    /// Jacobians of all backward steps, factorized concurrently
+    void factorizeB(CollocationMemory* m) const;
+
+    /// Dense output from the collocation polynomials
+    void interpolate(FixedStepMemory* m, double theta,
+                     double* x, double* z, double* q) const override;
+
     // Interpolation order
     casadi_int deg_;
 
+    // Collocation time points, including zero
+    std::vector<double> tau_root_;
+
+    // Lagrange bases of x (all time points) and z (collocation points), integrated basis of z
+    std::vector<Polynomial> x_basis_, z_basis_, q_basis_;
+
     // Collocation scheme
     std::string collocation_scheme_;
 
+    // Simplified Newton method with decoupled collocation points, cf. option "newton_scheme"
+    bool transformed_;
+
+    // Tolerance and maximum number of iterations of the transformed scheme
+    double newton_abstol_;
+    casadi_int newton_max_iter_;
+
+    // Eigendecomposition C = V diag(lambda) V^{-1} of the collocation matrix
+    std::vector<std::complex<double> > lambda_, V_, Vinv_;
+
+    // Conjugate partner of each eigenvalue, -1 if real
+    std::vector<casadi_int> conj_;
+
+    // Block of each eigenvalue: blocks are shared by conjugate pairs
+    std::vector<casadi_int> block_;
+
     /// A documentation string
     static const std::string meta_doc;
 
@@ -0,0 +1,447 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#include "condensing.hpp"
+#include <numeric>
+
+using namespace std;
+namespace casadi {
+
+  extern "C"
+  int CASADI_CONIC_CONDENSING_EXPORT
+  casadi_register_conic_condensing(Conic::Plugin* plugin) {
+    plugin->creator = Condensing::creator;
+    plugin->name = "condensing";
+    plugin->doc = Condensing::meta_doc.c_str();
+    plugin->version = CASADI_VERSION;
+    plugin->options = &Condensing::options_;
+    return 0;
+  }
+
+  extern "C"
+  void CASADI_CONIC_CONDENSING_EXPORT casadi_load_conic_condensing() {
+    Conic::registerPlugin(casadi_register_conic_condensing);
+  }
+
+  Condensing::Condensing(const std::string& name, const std::map<std::string, Sparsity> &st)
+    : Conic(name, st) {
+  }
+
+  Condensing::~Condensing() {
+    clear_mem();
+  }
+
+  Options Condensing::options_
+  = {{&Conic::options_},
+     {{"N",
+       {OT_INT,
+        "OCP horizon. Unless all of N, nx, nu, ng are set, "
+        "the structure is detected from the sparsity of A."}},
+      {"nx",
+       {OT_INTVECTOR,
+        "Number of states, length N+1"}},
+      {"nu",
+       {OT_INTVECTOR,
+        "Number of controls, length N"}},
+      {"ng",
+       {OT_INTVECTOR,
+        "Number of non-dynamic constraints, length N+1"}},
+      {"block_size",
+       {OT_INT,
+        "Number of stages condensed into one block. The default, N, eliminates all "
+        "states but the first and the last (full condensing), 1 disables condensing."}},
+      {"qpsol",
+       {OT_STRING,
+        "Name of the QP solver for the condensed problem."}},
+      {"qpsol_options",
+       {OT_DICT,
+        "Options to be passed to the QP solver. If it is hpmpc, the structure "
+        "of the condensed problem is passed unless given."}}
+     }
+  };
+
+  void Condensing::init(const Dict& opts) {
+    // Initialize the base classes
+    Conic::init(opts);
+
+    // Default options
+    block_size_ = -1;
+    string qpsol_plugin;
+    Dict qpsol_options;
+    casadi_int struct_cnt=0;
+
+    // Read user options
+    for (auto&& op : opts) {
+      if (op.first=="N") {
+        N_ = op.second;
+        struct_cnt++;
+      } else if (op.first=="nx") {
+        nxs_ = op.second;
+        struct_cnt++;
+      } else if (op.first=="nu") {
+        nus_ = op.second;
+        struct_cnt++;
+      } else if (op.first=="ng") {
+        ngs_ = op.second;
+        struct_cnt++;
+      } else if (op.first=="block_size") {
+        block_size_ = op.second;
+      } else if (op.first=="qpsol") {
+        qpsol_plugin = op.second.to_string();
+      } else if (op.first=="qpsol_options") {
+        qpsol_options = op.second;
+      }
+    }
+
+    // Check the structure
+    casadi_assert(struct_cnt==0 || struct_cnt==4,
+      "You must either set all of N, nx, nu, ng; "
+      "or set none at all (automatic detection).");
+    if (struct_cnt==0) {
+      detect_structure(N_, nxs_, nus_, ngs_);
+      if (verbose_) {
+        casadi_message("Detected structure: N " + str(N_) + ", nx " + str(nxs_) + ", "
+          "nu " + str(nus_) + ", ng " + str(ngs_) + ".");
+      }
+    }
+    const std::vector<casadi_int>& nx = nxs_;
+    const std::vector<casadi_int>& ng = ngs_;
+    const std::vector<casadi_int>& nu = nus_;
+    casadi_assert(nx.size()==N_+1, "nx must have length N+1");
+    casadi_assert(nu.size()==N_, "nu must have length N");
+    casadi_assert(ng.size()==N_+1, "ng must have length N+1");
+    casadi_assert(nx_ == std::accumulate(nx.begin(), nx.end(), 0) +
+      std::accumulate(nu.begin(), nu.end(), 0),
+      "sum(nx)+sum(nu) = must equal total size of variables (" + str(nx_) + "). "
+      "Structure is: N " + str(N_) + ", nx " + str(nx) + ", "
+      "nu " + str(nu) + ", ng " + str(ng) + ".");
+    casadi_assert(na_ == std::accumulate(nx.begin()+1, nx.end(), 0) +
+      std::accumulate(ng.begin(), ng.end(), 0),
+      "sum(nx+1)+sum(ng) = must equal total size of constraints (" + str(na_) + "). "
+      "Structure is: N " + str(N_) + ", nx " + str(nx) + ", "
+      "nu " + str(nu) + ", ng " + str(ng) + ".");
+    if (block_size_<0) block_size_ = N_;
+    casadi_assert(block_size_>=1, "'block_size' must be positive");
+    casadi_assert(!qpsol_plugin.empty(), "'qpsol' option has not been set");
+
+    // Offsets of the states, controls, dynamic and other constraints of each stage
+    std::vector<casadi_int> xoff(N_+1), uoff(N_), doff(N_), coff(N_+1);
+    casadi_int col=0, row=0;
+    for (casadi_int k=0; k<N_; ++k) {
+      xoff[k] = col; col += nx[k];
+      uoff[k] = col; col += nu[k];
+      doff[k] = row; row += nx[k+1];
+      coff[k] = row; row += ng[k];
+    }
+    xoff[N_] = col;
+    coff[N_] = row;
+
+    // Eliminated states, kept variables and the constraints of the condensed problem,
+    // which has the same multistage structure with one stage per block
+    kept_.clear();
+    elim_.clear();
+    elim_row_.clear();
+    crow_.clear();
+    std::vector<casadi_int> nxc, nuc, ngc;
+    for (casadi_int k0=0; k0<N_; k0+=block_size_) {
+      casadi_int k1 = std::min(k0+block_size_, N_);
+      nxc.push_back(nx[k0]);
+      nuc.push_back(0);
+      ngc.push_back(0);
+      for (casadi_int i=0; i<nx[k0]; ++i) kept_.push_back(xoff[k0]+i);
+      for (casadi_int k=k0; k<k1; ++k) {
+        if (k>k0) {
+          for (casadi_int i=0; i<nx[k]; ++i) {
+            elim_.push_back(xoff[k]+i);
+            elim_row_.push_back(doff[k-1]+i);
+          }
+        }
+        for (casadi_int i=0; i<nu[k]; ++i) kept_.push_back(uoff[k]+i);
+        nuc.back() += nu[k];
+      }
+      // Dynamic constraints linking to the next block
+      for (casadi_int i=0; i<nx[k1]; ++i) crow_.push_back(doff[k1-1]+i);
+      // Other constraints and the bounds of the eliminated states
+      for (casadi_int k=k0; k<k1; ++k) {
+        if (k>k0) {
+          for (casadi_int i=0; i<nx[k]; ++i) crow_.push_back(-1-(xoff[k]+i));
+          ngc.back() += nx[k];
+        }
+        for (casadi_int i=0; i<ng[k]; ++i) crow_.push_back(coff[k]+i);
+        ngc.back() += ng[k];
+      }
+    }
+    nxc.push_back(nx[N_]);
+    ngc.push_back(ng[N_]);
+    for (casadi_int i=0; i<nx[N_]; ++i) kept_.push_back(xoff[N_]+i);
+    for (casadi_int i=0; i<ng[N_]; ++i) crow_.push_back(coff[N_]+i);
+    nxc_ = kept_.size();
+    nac_ = crow_.size();
+
+    // Symbolic problem data
+    SX h = SX::sym("h", H_);
+    SX g = SX::sym("g", nx_);
+    SX a = SX::sym("a", A_);
+    SX lba = SX::sym("lba", na_);
+    SX uba = SX::sym("uba", na_);
+    SX lbx = SX::sym("lbx", nx_);
+    SX ubx = SX::sym("ubx", nx_);
+    SX y = SX::sym("y", nxc_);
+
+    // Express the full solution in the condensed variables, eliminating the states
+    // in order, each using its dynamic constraint
+    std::vector<casadi_int> mapping;
+    Sparsity AT = A_.transpose(mapping);
+    const std::vector<SXElem>& a_nz = a.nonzeros();
+    const std::vector<SXElem>& lba_nz = lba.nonzeros();
+    std::vector<SXElem> x(nx_, 0);
+    for (casadi_int j=0; j<nxc_; ++j) x[kept_[j]] = y.nonzeros()[j];
+    for (casadi_int i=0; i<elim_.size(); ++i) {
+      casadi_int e = elim_[i], r = elim_row_[i];
+      SXElem s = lba_nz[r], d = 0;
+      bool has_d = false;
+      for (casadi_int k=AT.colind(r); k<AT.colind(r+1); ++k) {
+        casadi_int c = AT.row(k);
+        if (c==e) {
+          d = a_nz[mapping[k]];
+          has_d = true;
+        } else {
+          casadi_assert(c<e, "Dynamic constraint " + str(r) + " depends on variable "
+            + str(c) + ", which is not in the current stage or earlier");
+          s -= a_nz[mapping[k]] * x[c];
+        }
+      }
+      casadi_assert(has_d, "Dynamic constraint " + str(r) + " does not depend on state "
+        + str(e) + ", which it is used to eliminate");
+      x[e] = s / d;
+    }
+    SX X = SX(x);
+
+    // The full solution is affine in the condensed variables, X = P*y + t
+    SX P = SX::jacobian(X, y);
+    SX t = substitute(X, y, SX::zeros(nxc_));
+
+    // Condensed objective
+    SX ht = mtimes(h, t);
+    SX hc = mtimes(P.T(), mtimes(h, P));
+    SX gc = mtimes(P.T(), g + ht);
+    SX c0 = dot(t, 0.5*ht + g);
+
+    // Condensed constraints
+    std::vector<casadi_int> arows, evars;
+    std::vector<casadi_int> perm;
+    for (casadi_int r : crow_) {
+      if (r>=0) {
+        perm.push_back(arows.size());
+        arows.push_back(r);
+      } else {
+        perm.push_back(-1-evars.size());
+        evars.push_back(-1-r);
+      }
+    }
+    for (casadi_int& p : perm) if (p<0) p = arows.size()-1-p;
+    SX a_sel = a(arows, Slice());
+    SX at_sel = mtimes(a_sel, t);
+    SX ac = vertcat(mtimes(a_sel, P), P(evars, Slice()))(perm, Slice());
+    SX lbac = vertcat(lba(arows) - at_sel, lbx(evars) - t(evars))(perm);
+    SX ubac = vertcat(uba(arows) - at_sel, ubx(evars) - t(evars))(perm);
+
+    // Functions for setting up the condensed problem and recovering the solution
+    condense_ = Function("condense", {h, g, a, lba, uba, lbx, ubx},
+                         {hc, gc, ac, lbac, ubac, lbx(kept_), ubx(kept_), c0});
+    expand_ = Function("expand", {y, a, lba}, {X});
+    alloc(condense_);
+    alloc(expand_);
+
+    // Pass the structure of the condensed problem to a structure exploiting QP solver
+    if (qpsol_plugin=="hpmpc" && qpsol_options.find("N")==qpsol_options.end()) {
+      qpsol_options["N"] = static_cast<casadi_int>(nuc.size());
+      qpsol_options["nx"] = nxc;
+      qpsol_options["nu"] = nuc;
+      qpsol_options["ng"] = ngc;
+    }
+
+    // Allocate a QP solver
+    qpsol_ = conic("qpsol", qpsol_plugin, {{"h", hc.sparsity()}, {"a", ac.sparsity()}},
+                   qpsol_options);
+    alloc(qpsol_);
+
+    // Condensed problem data
+    alloc_w(hc.nnz() + nxc_ + ac.nnz() + 2*nac_ + 2*nxc_ + 1, true);
+    // Condensed solution and initial guess
+    alloc_w(4*nxc_ + 2*nac_ + 1, true);
+    // Full solution and gradient of the objective
+    alloc_w(3*nx_ + na_, true);
+
+    if (verbose_) {
+      casadi_message("Condensed " + str(N_) + " stages into " + str(nuc.size()) + " blocks: "
+        "nx " + str(nxc) + ", nu " + str(nuc) + ", ng " + str(ngc) + ".");
+    }
+  }
+
+  int Condensing::
+  eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const {
+    casadi_int i, k;
+    const double *a = arg[CONIC_A], *lba = arg[CONIC_LBA], *uba = arg[CONIC_UBA];
+    casadi_assert(a!=nullptr, "Condensing requires the constraint matrix");
+
+    // The constraints used for the elimination must be equalities
+    for (casadi_int r : elim_row_) {
+      casadi_assert((lba ? lba[r] : 0)==(uba ? uba[r] : 0),
+        "Dynamic constraint " + str(r) + " must be an equality constraint");
+    }
+
+    // Work vectors
+    double *hc = w; w += condense_.nnz_out(0);
+    double *gc = w; w += nxc_;
+    double *ac = w; w += condense_.nnz_out(2);
+    double *lbac = w; w += nac_;
+    double *ubac = w; w += nac_;
+    double *lbxc = w; w += nxc_;
+    double *ubxc = w; w += nxc_;
+    double *c0 = w; w += 1;
+    double *y = w; w += nxc_;
+    double *lam_xc = w; w += nxc_;
+    double *lam_ac = w; w += nac_;
+    double *x0c = w; w += nxc_;
+    double *lam_x0c = w; w += nxc_;
+    double *lam_a0c = w; w += nac_;
+    double *fc = w; w += 1;
+    double *x = w; w += nx_;
+    double *lam_x = w; w += nx_;
+    double *lam_a = w; w += na_;
+    double *grad = w; w += nx_;
+
+    // Buffers for calling the functions
+    const double** arg1 = arg + n_in_;
+    double** res1 = res + n_out_;
+
+    // Condense
+    copy_n(arg, CONIC_X0, arg1);
+    res1[0] = hc;
+    res1[1] = gc;
+    res1[2] = ac;
+    res1[3] = lbac;
+    res1[4] = ubac;
+    res1[5] = lbxc;
+    res1[6] = ubxc;
+    res1[7] = c0;
+    if (condense_(arg1, res1, iw, w, 0)) return 1;
+
+    // Initial guess for the condensed problem
+    const double *x0 = arg[CONIC_X0], *lam_x0 = arg[CONIC_LAM_X0],
+                 *lam_a0 = arg[CONIC_LAM_A0];
+    for (i=0; i<nxc_; ++i) {
+      x0c[i] = x0 ? x0[kept_[i]] : 0;
+      lam_x0c[i] = lam_x0 ? lam_x0[kept_[i]] : 0;
+    }
+    for (i=0; i<nac_; ++i) {
+      if (crow_[i]>=0) {
+        lam_a0c[i] = lam_a0 ? lam_a0[crow_[i]] : 0;
+      } else {
+        lam_a0c[i] = lam_x0 ? lam_x0[-1-crow_[i]] : 0;
+      }
+    }
+
+    // Solve the condensed QP
+    fill_n(arg1, qpsol_.n_in(), nullptr);
+    arg1[CONIC_H] = hc;
+    arg1[CONIC_G] = gc;
+    arg1[CONIC_A] = ac;
+    arg1[CONIC_LBA] = lbac;
+    arg1[CONIC_UBA] = ubac;
+    arg1[CONIC_LBX] = lbxc;
+    arg1[CONIC_UBX] = ubxc;
+    arg1[CONIC_X0] = x0c;
+    arg1[CONIC_LAM_X0] = lam_x0c;
+    arg1[CONIC_LAM_A0] = lam_a0c;
+    fill_n(res1, qpsol_.n_out(), nullptr);
+    res1[CONIC_X] = y;
+    res1[CONIC_COST] = fc;
+    res1[CONIC_LAM_X] = lam_xc;
+    res1[CONIC_LAM_A] = lam_ac;
+    if (qpsol_(arg1, res1, iw, w, 0)) return 1;
+
+    // Recover the eliminated states
+    arg1[0] = y;
+    arg1[1] = a;
+    arg1[2] = lba;
+    res1[0] = x;
+    if (expand_(arg1, res1, iw, w, 0)) return 1;
+    if (res[CONIC_X]) casadi_copy(x, nx_, res[CONIC_X]);
+    if (res[CONIC_COST]) *res[CONIC_COST] = *fc + *c0;
+
+    // Multipliers
+    if (res[CONIC_LAM_X] || res[CONIC_LAM_A]) {
+      casadi_fill(lam_x, nx_, 0.);
+      casadi_fill(lam_a, na_, 0.);
+      for (i=0; i<nxc_; ++i) lam_x[kept_[i]] = lam_xc[i];
+      for (i=0; i<nac_; ++i) {
+        if (crow_[i]>=0) {
+          lam_a[crow_[i]] = lam_ac[i];
+        } else {
+          lam_x[-1-crow_[i]] = lam_ac[i];
+        }
+      }
+      // Gradient of the objective
+      if (arg[CONIC_G]) {
+        casadi_copy(arg[CONIC_G], nx_, grad);
+      } else {
+        casadi_fill(grad, nx_, 0.);
+      }
+      if (arg[CONIC_H]) casadi_mv(arg[CONIC_H], H_, x, grad, false);
+      // The multipliers of the dynamic constraints follow from stationarity with respect
+      // to the eliminated states, in reverse order
+      const casadi_int *colind = A_.colind(), *row = A_.row();
+      for (i=elim_.size()-1; i>=0; --i) {
+        casadi_int e = elim_[i], r = elim_row_[i];
+        double s = grad[e] + lam_x[e], d = 0;
+        for (k=colind[e]; k<colind[e+1]; ++k) {
+          if (row[k]==r) {
+            d = a[k];
+          } else {
+            s += a[k]*lam_a[row[k]];
+          }
+        }
+        lam_a[r] = -s/d;
+      }
+      if (res[CONIC_LAM_X]) casadi_copy(lam_x, nx_, res[CONIC_LAM_X]);
+      if (res[CONIC_LAM_A]) casadi_copy(lam_a, na_, res[CONIC_LAM_A]);
+    }
+    return 0;
+  }
+
+  Dict Condensing::get_stats(void* mem) const {
+    Dict stats = Conic::get_stats(mem);
+    Dict qpsol_stats = qpsol_.stats();
+    stats["qpsol_stats"] = qpsol_stats;
+    if (qpsol_stats.find("success")!=qpsol_stats.end()) {
+      stats["success"] = qpsol_stats["success"];
+    }
+    return stats;
+  }
+
+} // namespace casadi
@@ -0,0 +1,133 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#ifndef CASADI_CONDENSING_HPP
+#define CASADI_CONDENSING_HPP
+
+#include "casadi/core/conic_impl.hpp"
+#include <casadi/solvers/casadi_conic_condensing_export.h>
+
+
+/** \defgroup plugin_Conic_condensing
+
+   Solve multistage QPs by (partial) condensing and an inner Conic
+
+   The structure of the QP is described by the options N, nx, nu and ng, with
+   the same conventions as the hpmpc plugin: the decision variables are ordered
+   as [x_0, u_0, x_1, u_1, ..., x_N], and the constraints as
+   [d_0, c_0, d_1, c_1, ..., d_(N-1), c_(N-1), c_N], where the equality constraints d_k
+   couple x_(k+1) to x_k and u_k, and c_k are the remaining stage constraints.
+
+   The stages are grouped into blocks of 'block_size' stages, and the states inside
+   each block are eliminated using the dynamic constraints. The resulting QP, with
+   the same multistage structure but fewer and larger stages, is solved
+   using the Conic given by the 'qpsol' option, after which the full solution,
+   including the multipliers of the eliminated constraints, is recovered.
+   With block_size=N, the default, all states but the first and the last are
+   eliminated (full condensing), with block_size=1 nothing is condensed.
+*/
+
+/** \pluginsection{Conic,condensing} */
+
+/// \cond INTERNAL
+namespace casadi {
+
+  /** \brief \pluginbrief{Conic,condensing}
+
+      @copydoc Conic_doc
+      @copydoc plugin_Conic_condensing
+  */
+  class CASADI_CONIC_CONDENSING_EXPORT Condensing : public Conic {
+  public:
+    /** \brief  Create a new Solver */
+    explicit Condensing(const std::string& name,
+                        const std::map<std::string, Sparsity> &st);
+
+    /** \brief  Create a new QP Solver */
+    static Conic* creator(const std::string& name,
+                          const std::map<std::string, Sparsity>& st) {
+      return new Condensing(name, st);
+    }
+
+    /** \brief  Destructor */
+    ~Condensing() override;
+
+    // Get name of the plugin
+    const char* plugin_name() const override { return "condensing";}
+
+    // Get name of the class
+    std::string class_name() const override { return "Condensing";}
+
+    ///@{
+    /** \brief Options */
+    static Options options_;
+    const Options& get_options() const override { return options_;}
+    ///@}
+
+    /// Get all statistics
+    Dict get_stats(void* mem) const override;
+
+    /** \brief  Initialize */
+    void init(const Dict& opts) override;
+
+    int eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const override;
+
+    /// A documentation string
+    static const std::string meta_doc;
+
+    /// Multistage structure
+    casadi_int N_;
+    std::vector<casadi_int> nxs_, nus_, ngs_;
+
+    /// Number of stages per block
+    casadi_int block_size_;
+
+    /// QP solver for the condensed problem
+    Function qpsol_;
+
+    /// Forms the condensed QP: (h, g, a, lba, uba, lbx, ubx) -> (hc, gc, ac, lbac, ubac,
+    /// lbxc, ubxc, c0), where c0 is the constant term of the objective
+    Function condense_;
+
+    /// Recovers the full primal solution: (y, a, lba) -> (x)
+    Function expand_;
+
+    /// Variables kept in the condensed problem
+    std::vector<casadi_int> kept_;
+
+    /// Eliminated variables and the dynamic constraints used to eliminate them
+    std::vector<casadi_int> elim_, elim_row_;
+
+    /// Constraints of the condensed problem: a row of the original constraints if
+    /// nonnegative, the bounds of eliminated variable -1-i otherwise
+    std::vector<casadi_int> crow_;
+
+    /// Number of variables and constraints in the condensed problem
+    casadi_int nxc_, nac_;
+  };
+
+} // namespace casadi
+/// \endcond
+#endif // CASADI_CONDENSING_HPP
@@ -0,0 +1,93 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+
+      #include "condensing.hpp"
+      #include <string>
+
+      const std::string casadi::Condensing::meta_doc=
+      "\n"
+"Solve multistage QPs by (partial) condensing and an inner Conic\n"
+"\n"
+"The structure of the QP is described by the options N, nx, nu and ng, with\n"
+"the same conventions as the hpmpc plugin: the decision variables are\n"
+"ordered as [x_0, u_0, x_1, u_1, ..., x_N], and the constraints as [d_0,\n"
+"c_0, d_1, c_1, ..., d_(N-1), c_(N-1), c_N], where the equality constraints\n"
+"d_k couple x_(k+1) to x_k and u_k, and c_k are the remaining stage\n"
+"constraints.\n"
+"\n"
+"The stages are grouped into blocks of 'block_size' stages, and the states\n"
+"inside each block are eliminated using the dynamic constraints. The\n"
+"resulting QP, with the same multistage structure but fewer and larger\n"
+"stages, is solved using the Conic given by the 'qpsol' option, after which\n"
+"the full solution, including the multipliers of the eliminated\n"
+"constraints, is recovered. With block_size=N, the default, all states but\n"
+"the first and the last are eliminated (full condensing), with block_size=1\n"
+"nothing is condensed.\n"
+"\n"
+"\n"
+">List of available options\n"
+"\n"
+"+---------------+--------------+----------------------------------------+\n"
+"|      Id       |     Type     |              Description               |\n"
+"+===============+==============+========================================+\n"
+"| N             | OT_INT       | OCP horizon                            |\n"
+"+---------------+--------------+----------------------------------------+\n"
+"| block_size    | OT_INT       | Number of stages condensed into one    |\n"
+"|               |              | block. The default, N, eliminates all  |\n"
+"|               |              | states but the first and the last      |\n"
+"|               |              | (full condensing), 1 disables          |\n"
+"|               |              | condensing.                            |\n"
+"+---------------+--------------+----------------------------------------+\n"
+"| ng            | OT_INTVECTOR | Number of non-dynamic constraints,     |\n"
+"|               |              | length N+1                             |\n"
+"+---------------+--------------+----------------------------------------+\n"
+"| nu            | OT_INTVECTOR | Number of controls, length N           |\n"
+"+---------------+--------------+----------------------------------------+\n"
+"| nx            | OT_INTVECTOR | Number of states, length N+1           |\n"
+"+---------------+--------------+----------------------------------------+\n"
+"| qpsol         | OT_STRING    | Name of the QP solver for the          |\n"
+"|               |              | condensed problem.                     |\n"
+"+---------------+--------------+----------------------------------------+\n"
+"| qpsol_options | OT_DICT      | Options to be passed to the QP solver. |\n"
+"|               |              | If it is hpmpc, the structure of the   |\n"
+"|               |              | condensed problem is passed unless     |\n"
+"|               |              | given.                                 |\n"
+"+---------------+--------------+----------------------------------------+\n"
+"\n"
+"\n"
+">List of available stats\n"
+"\n"
+"+-------------+\n"
+"|     Id      |\n"
+"+=============+\n"
+"| qpsol_stats |\n"
+"+-------------+\n"
+"\n"
+"\n"
+"\n"
+"\n"
+;
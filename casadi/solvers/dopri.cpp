@@ -0,0 +1,484 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#include "dopri.hpp"
+
+using namespace std;
+namespace casadi {
+
+  extern "C"
+  int CASADI_INTEGRATOR_DOPRI_EXPORT
+      casadi_register_integrator_dopri(Integrator::Plugin* plugin) {
+    plugin->creator = Dopri::creator;
+    plugin->name = "dopri";
+    plugin->doc = Dopri::meta_doc.c_str();
+    plugin->version = CASADI_VERSION;
+    plugin->options = &Dopri::options_;
+    return 0;
+  }
+
+  extern "C"
+  void CASADI_INTEGRATOR_DOPRI_EXPORT casadi_load_integrator_dopri() {
+    Integrator::registerPlugin(casadi_register_integrator_dopri);
+  }
+
+  Dopri::Dopri(const std::string& name, const Function& dae)
+    : Integrator(name, dae) {
+  }
+
+  Dopri::~Dopri() {
+    clear_mem();
+  }
+
+  Options Dopri::options_
+  = {{&Integrator::options_},
+     {{"abstol",
+       {OT_DOUBLE,
+        "Absolute tolerance for the local error estimate [1e-8]"}},
+      {"reltol",
+       {OT_DOUBLE,
+        "Relative tolerance for the local error estimate [1e-6]"}},
+      {"max_num_steps",
+       {OT_INT,
+        "Maximum number of steps between two output times [10000]"}},
+      {"initial_step_size",
+       {OT_DOUBLE,
+        "Initial step size [default: estimated from the initial state and its derivative]"}},
+      {"max_step_size",
+       {OT_DOUBLE,
+        "Maximum step size [default: length of the time horizon]"}},
+      {"min_step_factor",
+       {OT_DOUBLE,
+        "Smallest factor by which the step size is changed after a step [0.2]"}},
+      {"max_step_factor",
+       {OT_DOUBLE,
+        "Largest factor by which the step size is changed after a step [10]"}},
+      {"safety_factor",
+       {OT_DOUBLE,
+        "Safety factor of the step size control [0.9]"}}
+     }
+  };
+
+  void Dopri::init(const Dict& opts) {
+    // Call the base class init
+    Integrator::init(opts);
+    casadi_assert(ne_==0, "Events are not supported by 'dopri'");
+
+    // Default options
+    abstol_ = 1e-8;
+    reltol_ = 1e-6;
+    max_num_steps_ = 10000;
+    h_init_ = 0;
+    h_max_ = grid_.back() - grid_.front();
+    fac_min_ = 0.2;
+    fac_max_ = 10;
+    safety_ = 0.9;
+
+    // Read options
+    for (auto&& op : opts) {
+      if (op.first=="abstol") {
+        abstol_ = op.second;
+      } else if (op.first=="reltol") {
+        reltol_ = op.second;
+      } else if (op.first=="max_num_steps") {
+        max_num_steps_ = op.second;
+      } else if (op.first=="initial_step_size") {
+        h_init_ = op.second;
+      } else if (op.first=="max_step_size") {
+        h_max_ = std::min(static_cast<double>(op.second), h_max_);
+      } else if (op.first=="min_step_factor") {
+        fac_min_ = op.second;
+      } else if (op.first=="max_step_factor") {
+        fac_max_ = op.second;
+      } else if (op.first=="safety_factor") {
+        safety_ = op.second;
+      }
+    }
+
+    // Algebraic variables not supported
+    casadi_assert(nz_==0 && nrz_==0,
+      "Explicit Runge-Kutta integrators do not support algebraic variables");
+    casadi_assert(abstol_>0 || reltol_>0, "Tolerances must not both be zero");
+    casadi_assert(fac_min_>0 && fac_min_<1 && fac_max_>1,
+      "Step size factors must satisfy 0 < min_step_factor < 1 < max_step_factor");
+    casadi_assert(safety_>0 && safety_<=1, "Safety factor must be in (0, 1]");
+
+    // Continuous time dynamics
+    create_function("f", {"x", "p", "t"}, {"ode", "quad"});
+    if (nrx_>0) create_function("g", {"rx", "rp", "x", "p", "t"}, {"rode", "rquad"});
+
+    // Stepper storage in the generated code
+    alloc_w(14*(nx_+nq_), true);
+  }
+
+  int Dopri::init_mem(void* mem) const {
+    if (Integrator::init_mem(mem)) return 1;
+    auto m = static_cast<DopriMemory*>(mem);
+
+    // Stepper memory, the quadratures do not enter the error estimate
+    m->yf.resize(14*(nx_+nq_));
+    init_stepper(m->fwd, nx_+nq_, nx_, get_ptr(m->yf));
+    m->yb.resize(14*(nrx_+nrq_));
+    init_stepper(m->bwd, nrx_+nrq_, nrx_, get_ptr(m->yb));
+
+    // Parameters and forward state for the backward problem
+    m->p.resize(np_);
+    m->rp.resize(nrp_);
+    m->x.resize(nx_);
+    return 0;
+  }
+
+  void Dopri::init_stepper(casadi_dopri_mem<double>& s, casadi_int n, casadi_int ne,
+                           double* w) const {
+    s.n = n;
+    s.ne = ne;
+    s.abstol = abstol_;
+    s.reltol = reltol_;
+    s.h_max = h_max_;
+    s.fac_min = fac_min_;
+    s.fac_max = fac_max_;
+    s.safety = safety_;
+    s.y = w; w += n;
+    s.ys = w; w += n;
+    s.k = w; w += 7*n;
+    s.rc = w;
+  }
+
+  bool Dopri::eval_f(DopriMemory* m, double t, const double* y, double* k) const {
+    m->nfevals++;
+    m->arg[0] = y;
+    m->arg[1] = get_ptr(m->p);
+    m->arg[2] = &t;
+    m->res[0] = k;
+    m->res[1] = k+nx_;
+    return calc_function(m, "f")!=0;
+  }
+
+  bool Dopri::eval_g(DopriMemory* m, double t, const double* y, double* k) const {
+    m->nfevalsB++;
+    tape_x(m, t, get_ptr(m->x));
+    m->arg[0] = y;
+    m->arg[1] = get_ptr(m->rp);
+    m->arg[2] = get_ptr(m->x);
+    m->arg[3] = get_ptr(m->p);
+    m->arg[4] = &t;
+    m->res[0] = k;
+    m->res[1] = k+nrx_;
+    return calc_function(m, "g")!=0;
+  }
+
+  void Dopri::tape_x(DopriMemory* m, double t, double* x) const {
+    // Entries in the tape
+    casadi_int sz = 2+5*nx_, n_tape = m->tape.size()/sz;
+    if (n_tape==0) {
+      // No step taken
+      casadi_copy(m->fwd.y, nx_, x);
+      return;
+    }
+    // Locate the step containing t, starting from the step used last
+    casadi_int& k = m->k_tape;
+    while (k>0 && m->tape[k*sz]>t) k--;
+    while (k+1<n_tape && m->tape[(k+1)*sz]<=t) k++;
+    // Dense output
+    const double* e = get_ptr(m->tape) + k*sz;
+    casadi_dopri_interp(nx_, e+2, (t-e[0])/e[1], x);
+  }
+
+  void Dopri::step(DopriMemory* m, bool fwd, double t_end) const {
+    casadi_dopri_mem<double>& s = fwd ? m->fwd : m->bwd;
+
+    // Do not step past the end of the time horizon
+    bool last = s.t + s.h >= t_end;
+    if (last) s.h = t_end - s.t;
+
+    // Stages, the backward problem is integrated in negated time
+    bool failed = false;
+    for (casadi_int i=1; i<7 && !failed; ++i) {
+      double ts = casadi_dopri_stage(&s, i);
+      failed = fwd ? eval_f(m, ts, s.ys, s.k+i*s.n) : eval_g(m, -ts, s.ys, s.k+i*s.n);
+    }
+
+    // A failed evaluation rejects the step with the smallest step size factor
+    double err = failed ? numeric_limits<double>::infinity() : casadi_dopri_err(&s);
+    double fac = casadi_dopri_fac(&s, err);
+    if (err<=1) {
+      double t_prev = s.t;
+      casadi_dopri_accept(&s);
+      if (last) s.t = t_end;
+      if (fwd) {
+        m->t_prev = t_prev;
+        m->nsteps++;
+        // Record the dense output of the state for the backward problem
+        if (nrx_>0) {
+          m->tape.push_back(t_prev);
+          m->tape.push_back(s.t-t_prev);
+          for (casadi_int j=0; j<5; ++j) {
+            m->tape.insert(m->tape.end(), s.rc+j*s.n, s.rc+j*s.n+nx_);
+          }
+        }
+      } else {
+        m->t_prevB = t_prev;
+        m->nstepsB++;
+      }
+    } else {
+      if (fwd) {
+        m->nrejected++;
+      } else {
+        m->nrejectedB++;
+      }
+    }
+
+    // Next step size
+    s.h = std::min(s.h*fac, s.h_max);
+    casadi_assert(last || s.h>1e-14*std::max(1., std::fabs(s.t)),
+      name_ + ": Step size too small at t=" + str(fwd ? s.t : -s.t));
+  }
+
+  void Dopri::reset(IntegratorMemory* mem, double t,
+                    const double* x, const double* z, const double* p) const {
+    auto m = static_cast<DopriMemory*>(mem);
+    casadi_dopri_mem<double>& s = m->fwd;
+
+    // Set parameters
+    casadi_copy(p, np_, get_ptr(m->p));
+
+    // Initial state, reset quadratures
+    s.t = t;
+    casadi_copy(x, nx_, s.y);
+    casadi_fill(s.y+nx_, nq_, 0.);
+
+    // Reset statistics and tape
+    m->nsteps = m->nrejected = m->nfevals = 0;
+    m->t_prev = t;
+    m->tape.clear();
+
+    // Right-hand side at the initial time, reused by the first step
+    casadi_assert(!eval_f(m, t, s.y, s.k), name_ + ": Evaluation of \"f\" failed");
+
+    // Initial step size
+    s.h = h_init_>0 ? std::min(h_init_, s.h_max) : casadi_dopri_h0(&s);
+  }
+
+  void Dopri::advance(IntegratorMemory* mem, double t,
+                      double* x, double* z, double* q) const {
+    auto m = static_cast<DopriMemory*>(mem);
+    casadi_dopri_mem<double>& s = m->fwd;
+
+    // Take steps until the output time has been passed
+    for (casadi_int k=0; s.t<t; ++k) {
+      casadi_assert(k<max_num_steps_,
+        name_ + ": Maximum number of steps reached at t=" + str(s.t));
+      step(m, true, grid_.back());
+    }
+
+    // Interpolate at the output time
+    const double* y = s.y;
+    if (t<s.t) {
+      casadi_dopri_interp(s.n, s.rc, (t-m->t_prev)/(s.t-m->t_prev), s.ys);
+      y = s.ys;
+    }
+
+    // Return to user
+    casadi_copy(y, nx_, x);
+    casadi_copy(y+nx_, nq_, q);
+  }
+
+  void Dopri::resetB(IntegratorMemory* mem, double t, const double* rx,
+                     const double* rz, const double* rp) const {
+    auto m = static_cast<DopriMemory*>(mem);
+    casadi_dopri_mem<double>& s = m->bwd;
+
+    // Set parameters
+    casadi_copy(rp, nrp_, get_ptr(m->rp));
+
+    // Initial state in negated time, reset quadratures
+    s.t = -t;
+    casadi_copy(rx, nrx_, s.y);
+    casadi_fill(s.y+nrx_, nrq_, 0.);
+
+    // Reset statistics, start from the end of the tape
+    m->nstepsB = m->nrejectedB = m->nfevalsB = 0;
+    m->t_prevB = s.t;
+    m->k_tape = std::max(static_cast<casadi_int>(m->tape.size()/(2+5*nx_))-1, casadi_int(0));
+
+    // Right-hand side at the initial time, reused by the first step
+    casadi_assert(!eval_g(m, t, s.y, s.k), name_ + ": Evaluation of \"g\" failed");
+
+    // Initial step size
+    s.h = h_init_>0 ? std::min(h_init_, s.h_max) : casadi_dopri_h0(&s);
+  }
+
+  void Dopri::retreat(IntegratorMemory* mem, double t,
+                      double* rx, double* rz, double* rq) const {
+    auto m = static_cast<DopriMemory*>(mem);
+    casadi_dopri_mem<double>& s = m->bwd;
+
+    // Take steps until the output time has been passed
+    for (casadi_int k=0; s.t<-t; ++k) {
+      casadi_assert(k<max_num_steps_,
+        name_ + ": Maximum number of steps reached at t=" + str(-s.t));
+      step(m, false, -grid_.front());
+    }
+
+    // Interpolate at the output time
+    const double* y = s.y;
+    if (-t<s.t) {
+      casadi_dopri_interp(s.n, s.rc, (-t-m->t_prevB)/(s.t-m->t_prevB), s.ys);
+      y = s.ys;
+    }
+
+    // Return to user
+    casadi_copy(y, nrx_, rx);
+    casadi_copy(y+nrx_, nrq_, rq);
+  }
+
+  void Dopri::print_stats(IntegratorMemory* mem) const {
+    auto m = static_cast<DopriMemory*>(mem);
+    print("FORWARD INTEGRATION:\n");
+    print("Number of steps taken by DOPRI: %lld\n", m->nsteps);
+    print("Number of rejected steps: %lld\n", m->nrejected);
+    print("Number of calls to the RHS function: %lld\n", m->nfevals);
+    if (nrx_>0) {
+      print("BACKWARD INTEGRATION:\n");
+      print("Number of steps taken by DOPRI: %lld\n", m->nstepsB);
+      print("Number of rejected steps: %lld\n", m->nrejectedB);
+      print("Number of calls to the RHS function: %lld\n", m->nfevalsB);
+    }
+  }
+
+  Dict Dopri::get_stats(void* mem) const {
+    Dict stats = Integrator::get_stats(mem);
+    auto m = static_cast<DopriMemory*>(mem);
+    stats["nsteps"] = m->nsteps;
+    stats["nrejected"] = m->nrejected;
+    stats["nfevals"] = m->nfevals;
+    stats["nstepsB"] = m->nstepsB;
+    stats["nrejectedB"] = m->nrejectedB;
+    stats["nfevalsB"] = m->nfevalsB;
+    return stats;
+  }
+
+  void Dopri::codegen_declarations(CodeGenerator& g) const {
+    g.add_dependency(get_function("f"));
+  }
+
+  Dict Dopri::codegen_footprint(const CodeGenerator& g) const {
+    Dict r = Integrator::codegen_footprint(g);
+    // Data dependent loop, bounded by the maximum number of steps per output time
+    r["control"] = "iterative";
+    r["max_iter"] = max_num_steps_;
+    r["n_output"] = ngrid_;
+    return r;
+  }
+
+  void Dopri::codegen_body(CodeGenerator& g) const {
+    g.add_auxiliary(CodeGenerator::AUX_DOPRI);
+    std::string f = g.add_dependency(get_function("f"));
+    casadi_int n = nx_+nq_;
+    string tf = g.constant(grid_.back());
+
+    g.local("m", "struct casadi_dopri_mem");
+    g.local("k", "casadi_int");
+    g.local("j", "casadi_int");
+    g.local("s", "casadi_int");
+    g.local("last", "casadi_int");
+    g.local("ts", "casadi_real");
+    g.local("t_prev", "casadi_real");
+    g.local("err", "casadi_real");
+    g.local("fac", "casadi_real");
+
+    g << "m.n = " << n << ";\n";
+    g << "m.ne = " << nx_ << ";\n";
+    g << "m.abstol = " << g.constant(abstol_) << ";\n";
+    g << "m.reltol = " << g.constant(reltol_) << ";\n";
+    g << "m.h_max = " << g.constant(h_max_) << ";\n";
+    g << "m.fac_min = " << g.constant(fac_min_) << ";\n";
+    g << "m.fac_max = " << g.constant(fac_max_) << ";\n";
+    g << "m.safety = " << g.constant(safety_) << ";\n";
+    g << "m.y = w;\n";
+    g << "m.ys = w+" << n << ";\n";
+    g << "m.k = w+" << 2*n << ";\n";
+    g << "m.rc = w+" << 9*n << ";\n";
+
+    // Arguments and work vector for the right-hand side
+    string f_call = f + "(arg+" + str(n_in_) + ", res+" + str(n_out_) + ", iw, w+"
+      + str(14*n) + ", 0)";
+    g << "arg[" << n_in_ << "] = m.y;\n";
+    g << "arg[" << n_in_+1 << "] = arg[" << INTEGRATOR_P << "];\n";
+    g << "arg[" << n_in_+2 << "] = &ts;\n";
+    g << "res[" << n_out_ << "] = m.k;\n";
+    g << "res[" << n_out_+1 << "] = m.k+" << nx_ << ";\n";
+
+    g.comment("Initial state, quadratures start at zero");
+    g << g.copy("arg[" + str(INTEGRATOR_X0) + "]", nx_, "m.y") << "\n";
+    g << g.fill("m.y+" + str(nx_), nq_, "0") << "\n";
+    g << "m.t = ts = " << g.constant(grid_.front()) << ";\n";
+    g << "if (" << f_call << ") return 1;\n";
+    g << "m.h = " << (h_init_>0 ? g.constant(std::min(h_init_, h_max_)) : "casadi_dopri_h0(&m)")
+      << ";\n";
+    g << "t_prev = m.t;\n";
+    g << "arg[" << n_in_ << "] = m.ys;\n";
+
+    string grid = g.constant(grid_);
+    casadi_int k0 = output_t0_ ? 0 : 1;
+    g << "for (k=" << k0 << "; k<" << ngrid_ << "; ++k) {\n";
+    g.comment("Take steps until the output time has been passed");
+    g << "for (j=0; m.t<" << grid << "[k]; ++j) {\n";
+    g << "if (j>=" << max_num_steps_ << ") return 1;\n";
+    g << "last = m.t+m.h >= " << tf << ";\n";
+    g << "if (last) m.h = " << tf << "-m.t;\n";
+    g << "for (s=1; s<7; ++s) {\n";
+    g << "ts = casadi_dopri_stage(&m, s);\n";
+    g << "res[" << n_out_ << "] = m.k+s*" << n << ";\n";
+    g << "res[" << n_out_+1 << "] = m.k+s*" << n << "+" << nx_ << ";\n";
+    g << "if (" << f_call << ") break;\n";
+    g << "}\n";
+    g.comment("A failed evaluation rejects the step");
+    g << "err = s==7 ? casadi_dopri_err(&m) : 1e10;\n";
+    g << "fac = casadi_dopri_fac(&m, err);\n";
+    g << "if (err<=1) {\n";
+    g << "t_prev = m.t;\n";
+    g << "casadi_dopri_accept(&m);\n";
+    g << "if (last) m.t = " << tf << ";\n";
+    g << "}\n";
+    g << "m.h = casadi_fmin(m.h*fac, m.h_max);\n";
+    g << "}\n";
+    g.comment("Interpolate at the output time");
+    g << "if (" << grid << "[k]<m.t) {\n";
+    g << "casadi_dopri_interp(" << n << ", m.rc, (" << grid << "[k]-t_prev)/(m.t-t_prev), m.ys);\n";
+    g << "} else {\n";
+    g << g.copy("m.y", n, "m.ys") << "\n";
+    g << "}\n";
+    g << "if (res[" << INTEGRATOR_XF << "]) "
+      << g.copy("m.ys", nx_, "res[" + str(INTEGRATOR_XF) + "]+(k-" + str(k0) + ")*"
+                + str(nx_)) << "\n";
+    g << "if (res[" << INTEGRATOR_QF << "]) "
+      << g.copy("m.ys+" + str(nx_), nq_, "res[" + str(INTEGRATOR_QF) + "]+(k-" + str(k0) + ")*"
+                + str(nq_)) << "\n";
+    g << "}\n";
+  }
+
+} // namespace casadi
@@ -0,0 +1,181 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#ifndef CASADI_DOPRI_HPP
+#define CASADI_DOPRI_HPP
+
+#include "casadi/core/integrator_impl.hpp"
+#include <casadi/solvers/casadi_integrator_dopri_export.h>
+
+/** \defgroup plugin_Integrator_dopri
+      Adaptive explicit Runge-Kutta integrator for ODEs, using the Dormand-Prince 5(4) pair
+      with embedded error estimation and dense output.
+
+      The state at the output times is interpolated from the dense output and, for the
+      backward problem, the forward trajectory is recorded at every accepted step.
+      Forward problems can be code generated.
+*/
+/** \pluginsection{Integrator,dopri} */
+
+/// \cond INTERNAL
+namespace casadi {
+
+  /** \brief Memory for the Dormand-Prince integrator */
+  struct CASADI_INTEGRATOR_DOPRI_EXPORT DopriMemory : public IntegratorMemory {
+    // Forward and backward stepper memory
+    casadi_dopri_mem<double> fwd, bwd;
+
+    // Storage for the stepper memory
+    std::vector<double> yf, yb;
+
+    // Parameters
+    std::vector<double> p, rp;
+
+    // Forward state during the backward integration
+    std::vector<double> x;
+
+    // Dense output of the forward problem at every accepted step: [t, h, rc(x)]
+    std::vector<double> tape;
+
+    // Position in the tape during the backward integration
+    casadi_int k_tape;
+
+    // Start of the last accepted step
+    double t_prev, t_prevB;
+
+    // Statistics
+    casadi_int nsteps, nrejected, nfevals, nstepsB, nrejectedB, nfevalsB;
+  };
+
+  /** \brief \pluginbrief{Integrator,dopri}
+
+      @copydoc DAE_doc
+      @copydoc plugin_Integrator_dopri
+  */
+  class CASADI_INTEGRATOR_DOPRI_EXPORT Dopri : public Integrator {
+  public:
+
+    /// Constructor
+    explicit Dopri(const std::string& name, const Function& dae);
+
+    /** \brief  Create a new integrator */
+    static Integrator* creator(const std::string& name, const Function& dae) {
+      return new Dopri(name, dae);
+    }
+
+    /// Destructor
+    ~Dopri() override;
+
+    // Get name of the plugin
+    const char* plugin_name() const override { return "dopri";}
+
+    // Get name of the class
+    std::string class_name() const override { return "Dopri";}
+
+    ///@{
+    /** \brief Options */
+    static Options options_;
+    const Options& get_options() const override { return options_;}
+    ///@}
+
+    /// Initialize stage
+    void init(const Dict& opts) override;
+
+    /** \brief Create memory block */
+    void* alloc_mem() const override { return new DopriMemory();}
+
+    /** \brief Initalize memory block */
+    int init_mem(void* mem) const override;
+
+    /** \brief Free memory block */
+    void free_mem(void *mem) const override { delete static_cast<DopriMemory*>(mem);}
+
+    /** \brief Reset the forward problem */
+    void reset(IntegratorMemory* mem, double t,
+               const double* x, const double* z, const double* p) const override;
+
+    /** \brief  Advance solution in time */
+    void advance(IntegratorMemory* mem, double t,
+                 double* x, double* z, double* q) const override;
+
+    /** \brief Reset the backward problem */
+    void resetB(IntegratorMemory* mem, double t,
+                const double* rx, const double* rz, const double* rp) const override;
+
+    /** \brief  Retreat solution in time */
+    void retreat(IntegratorMemory* mem, double t,
+                 double* rx, double* rz, double* rq) const override;
+
+    /** \brief  Print solver statistics */
+    void print_stats(IntegratorMemory* mem) const override;
+
+    /** \brief Get all statistics */
+    Dict get_stats(void* mem) const override;
+
+    /** \brief Is codegen supported? */
+    bool has_codegen() const override { return nrx_==0;}
+
+    /** \brief Generate code for the declarations of the C function */
+    void codegen_declarations(CodeGenerator& g) const override;
+
+    /** \brief Generate code for the function body */
+    void codegen_body(CodeGenerator& g) const override;
+
+    /** \brief Worst-case footprint of the generated code */
+    Dict codegen_footprint(const CodeGenerator& g) const override;
+
+    /// A documentation string
+    static const std::string meta_doc;
+
+  protected:
+    // Initialize the stepper memory, storage of length 14*n
+    void init_stepper(casadi_dopri_mem<double>& s, casadi_int n, casadi_int ne,
+                      double* w) const;
+
+    // Right-hand sides of the forward and backward problem, true if evaluation failed
+    bool eval_f(DopriMemory* m, double t, const double* y, double* k) const;
+    bool eval_g(DopriMemory* m, double t, const double* y, double* k) const;
+
+    // Attempt a step of the forward or backward problem, not past t_end
+    void step(DopriMemory* m, bool fwd, double t_end) const;
+
+    // Forward state at time t from the tape
+    void tape_x(DopriMemory* m, double t, double* x) const;
+
+    // Error tolerances
+    double abstol_, reltol_;
+
+    // Step size control
+    double h_init_, h_max_, fac_min_, fac_max_, safety_;
+
+    // Maximum number of steps between two output times
+    casadi_int max_num_steps_;
+  };
+
+} // namespace casadi
+
+/// \endcond
+#endif // CASADI_DOPRI_HPP
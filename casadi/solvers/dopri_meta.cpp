@@ -0,0 +1,74 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+      #include "dopri.hpp"
+      #include <string>
+
+      const std::string casadi::Dopri::meta_doc=
+      "\n"
+"Adaptive explicit Runge-Kutta integrator for ODEs, using the Dormand-\n"
+"Prince 5(4) pair with embedded error estimation and dense output.\n"
+"\n"
+"The state at the output times is interpolated from the dense output and,\n"
+"for the backward problem, the forward trajectory is recorded at every\n"
+"accepted step. Forward problems can be code generated.\n"
+"\n"
+"\n"
+">List of available options\n"
+"\n"
+"+-------------------+-----------+-----------------------------------------+\n"
+"|        Id         |   Type    |               Description               |\n"
+"+===================+===========+=========================================+\n"
+"| abstol            | OT_DOUBLE | Absolute tolerance for the local error  |\n"
+"|                   |           | estimate [1e-8]                         |\n"
+"+-------------------+-----------+-----------------------------------------+\n"
+"| initial_step_size | OT_DOUBLE | Initial step size [default: estimated   |\n"
+"|                   |           | from the initial state and its          |\n"
+"|                   |           | derivative]                             |\n"
+"+-------------------+-----------+-----------------------------------------+\n"
+"| max_num_steps     | OT_INT    | Maximum number of steps between two     |\n"
+"|                   |           | output times [10000]                    |\n"
+"+-------------------+-----------+-----------------------------------------+\n"
+"| max_step_factor   | OT_DOUBLE | Largest factor by which the step size   |\n"
+"|                   |           | is changed after a step [10]            |\n"
+"+-------------------+-----------+-----------------------------------------+\n"
+"| max_step_size     | OT_DOUBLE | Maximum step size [default: length of   |\n"
+"|                   |           | the time horizon]                       |\n"
+"+-------------------+-----------+-----------------------------------------+\n"
+"| min_step_factor   | OT_DOUBLE | Smallest factor by which the step size  |\n"
+"|                   |           | is changed after a step [0.2]           |\n"
+"+-------------------+-----------+-----------------------------------------+\n"
+"| reltol            | OT_DOUBLE | Relative tolerance for the local error  |\n"
+"|                   |           | estimate [1e-6]                         |\n"
+"+-------------------+-----------+-----------------------------------------+\n"
+"| safety_factor     | OT_DOUBLE | Safety factor of the step size control  |\n"
+"|                   |           | [0.9]                                   |\n"
+"+-------------------+-----------+-----------------------------------------+\n"
+"\n"
+"\n"
+"\n"
+"\n"
+;
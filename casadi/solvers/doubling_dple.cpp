@@ -0,0 +1,161 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#include "doubling_dple.hpp"
+
+using namespace std;
+namespace casadi {
+
+  extern "C"
+  int CASADI_DPLE_DOUBLING_EXPORT
+  casadi_register_dple_doubling(Dple::Plugin* plugin) {
+    plugin->creator = DoublingDple::creator;
+    plugin->name = "doubling";
+    plugin->doc = DoublingDple::meta_doc.c_str();
+    plugin->version = CASADI_VERSION;
+    plugin->options = &DoublingDple::options_;
+    return 0;
+  }
+
+  extern "C"
+  void CASADI_DPLE_DOUBLING_EXPORT casadi_load_dple_doubling() {
+    Dple::registerPlugin(casadi_register_dple_doubling);
+  }
+
+  DoublingDple::DoublingDple(const std::string& name, const SpDict & st)
+    : Dple(name, st) {
+  }
+
+  DoublingDple::~DoublingDple() {
+    clear_mem();
+  }
+
+  Options DoublingDple::options_
+  = {{&Dple::options_},
+     {{"max_iter",
+       {OT_INT,
+        "Maximum number of doubling iterations, i.e. squarings of the "
+        "monodromy matrix [100]."}},
+      {"tol",
+       {OT_DOUBLE,
+        "Stopping tolerance on the relative size of the last doubling "
+        "increment [1e-12]."}}
+     }
+  };
+
+  void DoublingDple::init(const Dict& opts) {
+    // Initialize the base classes
+    Dple::init(opts);
+
+    // Default options
+    max_iter_ = 100;
+    tol_ = 1e-12;
+
+    // Read user options
+    for (auto&& op : opts) {
+      if (op.first=="max_iter") {
+        max_iter_ = op.second;
+      } else if (op.first=="tol") {
+        tol_ = op.second;
+      }
+    }
+
+    // Block size
+    n_ = A_.size1()/K_;
+
+    // Work vectors: zero inputs, doubling iteration
+    alloc_w(A_.nnz() + V_.nnz() + 3*n_*n_, true);
+  }
+
+  int DoublingDple::init_mem(void* mem) const {
+    auto m = static_cast<DoublingDpleMemory*>(mem);
+    m->return_status = "";
+    m->success = false;
+    m->iter_count = 0;
+    return 0;
+  }
+
+  int DoublingDple::
+  eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const {
+    auto m = static_cast<DoublingDpleMemory*>(mem);
+    if (!res[DPLE_P]) return 0;
+    // Missing inputs are zero
+    const double *a = arg[DPLE_A], *v = arg[DPLE_V];
+    if (!a) casadi_fill(w, A_.nnz(), 0.);
+    if (!a) a = w;
+    w += A_.nnz();
+    if (!v) casadi_fill(w, V_.nnz(), 0.);
+    if (!v) v = w;
+    w += V_.nnz();
+    // Solve
+    casadi_int iter;
+    int flag = casadi_dple(n_, K_, nrhs_, a, v, res[DPLE_P], max_iter_, tol_, &iter, w);
+    m->iter_count = iter;
+    m->success = flag==0;
+    m->return_status = m->success ? "success" : "Maximum number of iterations reached";
+    if (!m->success) {
+      casadi_assert(!error_unstable_,
+        "DoublingDple: the doubling iteration did not converge, "
+        "the system is probably unstable.");
+      if (verbose_) casadi_warning(m->return_status);
+      return 1;
+    }
+    return 0;
+  }
+
+  Dict DoublingDple::get_stats(void* mem) const {
+    Dict stats = Dple::get_stats(mem);
+    auto m = static_cast<DoublingDpleMemory*>(mem);
+    stats["return_status"] = m->return_status;
+    stats["success"] = m->success;
+    stats["iter_count"] = m->iter_count;
+    return stats;
+  }
+
+  void DoublingDple::codegen_body(CodeGenerator& g) const {
+    g.add_auxiliary(CodeGenerator::AUX_DPLE);
+    g.local("a", "const casadi_real", "*");
+    g.local("v", "const casadi_real", "*");
+    g.local("iter", "casadi_int");
+    g << "if (!res[" << DPLE_P << "]) return 0;\n";
+    g.comment("Missing inputs are zero");
+    g << "a = arg[" << DPLE_A << "];\n";
+    g << "if (!a) {\n"
+      << g.fill("w", A_.nnz(), "0.") << "\n"
+      << "a = w;\n"
+      << "}\n";
+    g << "w += " << A_.nnz() << ";\n";
+    g << "v = arg[" << DPLE_V << "];\n";
+    g << "if (!v) {\n"
+      << g.fill("w", V_.nnz(), "0.") << "\n"
+      << "v = w;\n"
+      << "}\n";
+    g << "w += " << V_.nnz() << ";\n";
+    g << "if (casadi_dple(" << n_ << ", " << K_ << ", " << nrhs_ << ", a, v, res[" << DPLE_P
+      << "], " << max_iter_ << ", " << g.constant(tol_) << ", &iter, w)) return 1;\n";
+  }
+
+} // namespace casadi
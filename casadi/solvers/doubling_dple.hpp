@@ -0,0 +1,130 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#ifndef CASADI_DOUBLING_DPLE_HPP
+#define CASADI_DOUBLING_DPLE_HPP
+
+#include "casadi/core/dple_impl.hpp"
+#include <casadi/solvers/casadi_dple_doubling_export.h>
+
+/** \defgroup plugin_Dple_doubling
+
+   Solve Discrete Periodic Lyapunov Equations by a doubling iteration on the
+   monodromy matrix
+
+   The periodic solution P_0 satisfies the lifted equation P_0 = F*P_0*F' + S,
+   where F = A_(K-1)*...*A_0 is the monodromy matrix and S is obtained by
+   propagating P_0 = 0 over one period. This equation is solved by the doubling
+   (squared Smith) iteration S <- S + F*S*F', F <- F*F, which converges
+   quadratically for stable systems. The other P_k follow by propagation.
+
+   The cost per iteration is O(n^3), independent of the period K, and the squarings
+   of F are shared among the right-hand sides, which includes the seeds of the forward
+   and adjoint derivatives. Only dense n-by-n blocks are used, positive definiteness is
+   not assumed. The method is implemented in the C runtime and can be code generated.
+*/
+
+/** \pluginsection{Dple,doubling} */
+
+/// \cond INTERNAL
+namespace casadi {
+  struct CASADI_DPLE_DOUBLING_EXPORT DoublingDpleMemory {
+    const char* return_status;
+    bool success;
+    casadi_int iter_count;
+  };
+
+  /** \brief \pluginbrief{Dple,doubling}
+
+      @copydoc Dple_doc
+      @copydoc plugin_Dple_doubling
+  */
+  class CASADI_DPLE_DOUBLING_EXPORT DoublingDple : public Dple {
+  public:
+    /** \brief  Constructor */
+    DoublingDple(const std::string& name, const SpDict & st);
+
+    /** \brief  Create a new Dple solver */
+    static Dple* creator(const std::string& name, const SpDict& st) {
+      return new DoublingDple(name, st);
+    }
+
+    /** \brief  Destructor */
+    ~DoublingDple() override;
+
+    // Get name of the plugin
+    const char* plugin_name() const override { return "doubling";}
+
+    // Get name of the class
+    std::string class_name() const override { return "DoublingDple";}
+
+    ///@{
+    /** \brief Options */
+    static Options options_;
+    const Options& get_options() const override { return options_;}
+    ///@}
+
+    /** \brief  Initialize */
+    void init(const Dict& opts) override;
+
+    /** \brief Create memory block */
+    void* alloc_mem() const override { return new DoublingDpleMemory();}
+
+    /** \brief Initalize memory block */
+    int init_mem(void* mem) const override;
+
+    /** \brief Free memory block */
+    void free_mem(void *mem) const override { delete static_cast<DoublingDpleMemory*>(mem);}
+
+    /** \brief  Evaluate numerically */
+    int eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const override;
+
+    /// Get all statistics
+    Dict get_stats(void* mem) const override;
+
+    /** \brief Is codegen supported? */
+    bool has_codegen() const override { return true;}
+
+    /** \brief Generate code for the body of the C function */
+    void codegen_body(CodeGenerator& g) const override;
+
+    /// A documentation string
+    static const std::string meta_doc;
+
+  private:
+    /// Dimension of the state space
+    casadi_int n_;
+
+    ///@{
+    // Options
+    casadi_int max_iter_;
+    double tol_;
+    ///@}
+  };
+
+} // namespace casadi
+/// \endcond
+#endif // CASADI_DOUBLING_DPLE_HPP
@@ -0,0 +1,77 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+      #include "doubling_dple.hpp"
+      #include <string>
+
+      const std::string casadi::DoublingDple::meta_doc=
+      "\n"
+"Solve Discrete Periodic Lyapunov Equations by a doubling iteration on the\n"
+"monodromy matrix\n"
+"\n"
+"The periodic solution P_0 satisfies the lifted equation P_0 = F*P_0*F' + S,\n"
+"where F = A_(K-1)*...*A_0 is the monodromy matrix and S is obtained by\n"
+"propagating P_0 = 0 over one period. This equation is solved by the\n"
+"doubling (squared Smith) iteration S <- S + F*S*F', F <- F*F, which\n"
+"converges quadratically for stable systems. The other P_k follow by\n"
+"propagation.\n"
+"\n"
+"The cost per iteration is O(n^3), independent of the period K, and the\n"
+"squarings of F are shared among the right-hand sides, which includes the\n"
+"seeds of the forward and adjoint derivatives. Only dense n-by-n blocks are\n"
+"used, positive definiteness is not assumed. The method is implemented in\n"
+"the C runtime and can be code generated.\n"
+"\n"
+"\n"
+">List of available options\n"
+"\n"
+"+----------+-----------+------------------------------------------------+\n"
+"|    Id    |   Type    |                  Description                   |\n"
+"+==========+===========+================================================+\n"
+"| max_iter | OT_INT    | Maximum number of doubling iterations, i.e.    |\n"
+"|          |           | squarings of the monodromy matrix [100].       |\n"
+"+----------+-----------+------------------------------------------------+\n"
+"| tol      | OT_DOUBLE | Stopping tolerance on the relative size of the |\n"
+"|          |           | last doubling increment [1e-12].               |\n"
+"+----------+-----------+------------------------------------------------+\n"
+"\n"
+"\n"
+">List of available stats\n"
+"\n"
+"+---------------+\n"
+"|      Id       |\n"
+"+===============+\n"
+"| iter_count    |\n"
+"+---------------+\n"
+"| return_status |\n"
+"+---------------+\n"
+"| success       |\n"
+"+---------------+\n"
+"\n"
+"\n"
+"\n"
+"\n"
+;
@@ -0,0 +1,244 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#include "etd.hpp"
+
+using namespace std;
+namespace casadi {
+
+  extern "C"
+  int CASADI_INTEGRATOR_ETD_EXPORT
+      casadi_register_integrator_etd(Integrator::Plugin* plugin) {
+    plugin->creator = Etd::creator;
+    plugin->name = "etd";
+    plugin->doc = Etd::meta_doc.c_str();
+    plugin->version = CASADI_VERSION;
+    plugin->options = &Etd::options_;
+    return 0;
+  }
+
+  extern "C"
+  void CASADI_INTEGRATOR_ETD_EXPORT casadi_load_integrator_etd() {
+    Integrator::registerPlugin(casadi_register_integrator_etd);
+  }
+
+  Etd::Etd(const std::string& name, const Function& dae)
+    : FixedStepIntegrator(name, dae) {
+
+    // Default options
+    order_ = 2;
+  }
+
+  Etd::~Etd() {
+  }
+
+  Options Etd::options_
+  = {{&FixedStepIntegrator::options_},
+     {{"order",
+       {OT_INT,
+        "Order of the scheme: 1 (exponential Euler) or 2 (ETD2RK) [2]"}}
+     }
+  };
+
+  void Etd::init(const Dict& opts) {
+    // Read options, needed when the base class sets up the discrete time dynamics
+    for (auto&& op : opts) {
+      if (op.first=="order") {
+        order_ = op.second;
+      }
+    }
+    casadi_assert(order_==1 || order_==2, "Order must be 1 or 2");
+
+    // Call the base class init
+    FixedStepIntegrator::init(opts);
+  }
+
+  DM Etd::linear_part(const std::string& res, const std::string& arg) const {
+    // Evaluate the Jacobian with all inputs not-a-number
+    Function J = oracle_.factory("jac_" + res + "_" + arg, oracle_.name_in(),
+                                 {"jac:" + res + ":" + arg});
+    vector<DM> J_arg;
+    for (casadi_int i=0; i<J.n_in(); ++i) {
+      J_arg.push_back(DM(J.sparsity_in(i), numeric_limits<double>::quiet_NaN()));
+    }
+    vector<double> A = densify(J(J_arg).at(0)).nonzeros();
+
+    // Entries that depend on an input belong to the nonlinear part
+    for (double& a : A) if (!isfinite(a)) a = 0;
+    return DM(Sparsity::dense(J.size_out(0)), A);
+  }
+
+  vector<DM> Etd::phi(const DM& A) const {
+    // The phi-functions are blocks of the exponential of an augmented matrix
+    casadi_int n = A.size1();
+    DM I = DM::eye(n), M = DM::zeros(3*n, 3*n);
+    M(Slice(0, n), Slice(0, n)) = h_*A;
+    M(Slice(0, n), Slice(n, 2*n)) = I;
+    M(Slice(n, 2*n), Slice(2*n, 3*n)) = I;
+
+    // Scaling and squaring with a diagonal Pade approximant of degree 6
+    double nrm = 3*n*static_cast<double>(norm_inf(M));
+    casadi_int s = nrm>0.5 ? static_cast<casadi_int>(ceil(log2(nrm/0.5))) : 0;
+    DM X = M/pow(2., s), Xk = X, E = DM::eye(3*n), D = DM::eye(3*n);
+    double c = 1;
+    const casadi_int q = 6;
+    for (casadi_int k=1; k<=q; ++k) {
+      if (k>1) Xk = mtimes(X, Xk);
+      c *= static_cast<double>(q-k+1)/static_cast<double>(k*(2*q-k+1));
+      E += c*Xk;
+      D += (k%2 ? -c : c)*Xk;
+    }
+    E = solve(D, E);
+    for (casadi_int k=0; k<s; ++k) E = mtimes(E, E);
+
+    return {E(Slice(0, n), Slice(0, n)), h_*E(Slice(0, n), Slice(n, 2*n)),
+            h_*E(Slice(0, n), Slice(2*n, 3*n))};
+  }
+
+  void Etd::setupFG() {
+    // Algebraic variables not supported
+    casadi_assert(nz_==0 && nrz_==0,
+                  "Exponential integrators do not support algebraic variables");
+
+    f_ = create_function("f", {"x", "z", "p", "t"}, {"ode", "alg", "quad"});
+    g_ = create_function("g", {"rx", "rz", "rp", "x", "z", "p", "t"},
+                              {"rode", "ralg", "rquad"});
+
+    // Symbolic inputs
+    MX x0 = MX::sym("x0", this->x());
+    MX p = MX::sym("p", this->p());
+    MX t = MX::sym("t", this->t());
+
+    // State at the end of the step (does not enter in F_, only in G_)
+    MX v = MX::sym("v", x0.sparsity());
+
+    // Linear part applied to a (matrix-valued) state
+    auto lin = [](const DM& A, const MX& y) {
+      return reshape(mtimes(A, vec(y)), y.size());
+    };
+
+    // Forward integration
+    {
+      DM A = linear_part("ode", "x");
+      vector<DM> E = phi(A);
+
+      // Arguments when calling f
+      vector<MX> f_arg(DAE_NUM_IN);
+      vector<MX> f_res;
+      f_arg[DAE_P] = p;
+
+      // Nonlinear part at the beginning of the step
+      f_arg[DAE_T] = t;
+      f_arg[DAE_X] = x0;
+      f_res = f_(f_arg);
+      MX N0 = f_res[DAE_ODE] - lin(A, x0);
+      MX q0 = f_res[DAE_QUAD];
+
+      // Exponential Euler step
+      MX xf = lin(E[0], x0) + lin(E[1], N0);
+
+      // Correction with the nonlinear part at the predicted state
+      f_arg[DAE_T] = t + h_;
+      f_arg[DAE_X] = xf;
+      f_res = f_(f_arg);
+      if (order_==2) {
+        xf += lin(E[2], f_res[DAE_ODE] - lin(A, xf) - N0);
+        f_arg[DAE_X] = xf;
+        f_res = f_(f_arg);
+      }
+
+      // Quadratures with the trapezoidal rule
+      MX qf = (h_/2)*(q0 + f_res[DAE_QUAD]);
+
+      // Define discrete time dynamics
+      f_arg[DAE_T] = t;
+      f_arg[DAE_X] = x0;
+      f_arg[DAE_P] = p;
+      f_arg[DAE_Z] = v;
+      f_res[DAE_ODE] = xf;
+      f_res[DAE_QUAD] = qf;
+      f_res[DAE_ALG] = xf;
+      F_ = Function("dae", f_arg, f_res);
+      alloc(F_);
+    }
+
+    // Backward integration, in reversed time from the end of the step
+    if (!g_.is_null()) {
+      DM A = linear_part("rode", "rx");
+      vector<DM> E = phi(A);
+
+      // Symbolic inputs
+      MX rx0 = MX::sym("rx0", this->rx());
+      MX rp = MX::sym("rp", this->rp());
+
+      // Arguments when calling g
+      vector<MX> g_arg(RDAE_NUM_IN);
+      vector<MX> g_res;
+      g_arg[RDAE_P] = p;
+      g_arg[RDAE_RP] = rp;
+
+      // Nonlinear part at the end of the step
+      g_arg[RDAE_T] = t + h_;
+      g_arg[RDAE_X] = v;
+      g_arg[RDAE_RX] = rx0;
+      g_res = g_(g_arg);
+      MX N0 = g_res[RDAE_ODE] - lin(A, rx0);
+      MX rq0 = g_res[RDAE_QUAD];
+
+      // Exponential Euler step
+      MX rxf = lin(E[0], rx0) + lin(E[1], N0);
+
+      // Correction with the nonlinear part at the predicted state
+      g_arg[RDAE_T] = t;
+      g_arg[RDAE_X] = x0;
+      g_arg[RDAE_RX] = rxf;
+      g_res = g_(g_arg);
+      if (order_==2) {
+        rxf += lin(E[2], g_res[RDAE_ODE] - lin(A, rxf) - N0);
+        g_arg[RDAE_RX] = rxf;
+        g_res = g_(g_arg);
+      }
+
+      // Quadratures with the trapezoidal rule
+      MX rqf = (h_/2)*(rq0 + g_res[RDAE_QUAD]);
+
+      // Define discrete time dynamics
+      g_arg[RDAE_T] = t;
+      g_arg[RDAE_X] = x0;
+      g_arg[RDAE_P] = p;
+      g_arg[RDAE_Z] = v;
+      g_arg[RDAE_RX] = rx0;
+      g_arg[RDAE_RP] = rp;
+      g_arg[RDAE_RZ] = MX::sym("rv", 0, 1);
+      g_res[RDAE_ODE] = rxf;
+      g_res[RDAE_QUAD] = rqf;
+      g_res[RDAE_ALG] = MX();
+      G_ = Function("rdae", g_arg, g_res);
+      alloc(G_);
+    }
+  }
+
+} // namespace casadi
@@ -0,0 +1,106 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#ifndef CASADI_ETD_HPP
+#define CASADI_ETD_HPP
+
+#include "casadi/core/integrator_impl.hpp"
+#include <casadi/solvers/casadi_integrator_etd_export.h>
+
+/** \defgroup plugin_Integrator_etd
+      Fixed-step exponential time differencing integrator for semi-linear stiff ODEs
+
+      The right-hand side is split into a linear part A*x, formed by the entries of the
+      Jacobian of the ODE with respect to the state that do not depend on any input,
+      and a nonlinear remainder. The linear part is integrated exactly using the matrix
+      exponential and the phi-functions of h*A, which are calculated once during
+      initialization, so that the step size is not limited by the stiffness of A.
+      Implements exponential Euler (order 1) and the ETD2RK scheme of Cox and Matthews
+      (order 2).
+*/
+/** \pluginsection{Integrator,etd} */
+
+/// \cond INTERNAL
+namespace casadi {
+
+  /** \brief \pluginbrief{Integrator,etd}
+
+      @copydoc DAE_doc
+      @copydoc plugin_Integrator_etd
+  */
+  class CASADI_INTEGRATOR_ETD_EXPORT Etd : public FixedStepIntegrator {
+  public:
+
+    /// Constructor
+    explicit Etd(const std::string& name, const Function& dae);
+
+    /** \brief  Create a new integrator */
+    static Integrator* creator(const std::string& name, const Function& dae) {
+      return new Etd(name, dae);
+    }
+
+    /// Destructor
+    ~Etd() override;
+
+    // Get name of the plugin
+    const char* plugin_name() const override { return "etd";}
+
+    // Get name of the class
+    std::string class_name() const override { return "Etd";}
+
+    ///@{
+    /** \brief Options */
+    static Options options_;
+    const Options& get_options() const override { return options_;}
+    ///@}
+
+    /// Initialize stage
+    void init(const Dict& opts) override;
+
+    /// Setup F and G
+    void setupFG() override;
+
+    /// A documentation string
+    static const std::string meta_doc;
+
+    /// Continuous time dynamics
+    Function f_, g_;
+
+  protected:
+    // Constant part of the Jacobian of a DE output with respect to a DE input
+    DM linear_part(const std::string& res, const std::string& arg) const;
+
+    // exp(h*A), h*phi1(h*A) and h*phi2(h*A)
+    std::vector<DM> phi(const DM& A) const;
+
+    // Order of the scheme
+    casadi_int order_;
+  };
+
+} // namespace casadi
+
+/// \endcond
+#endif // CASADI_ETD_HPP
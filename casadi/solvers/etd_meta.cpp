@@ -0,0 +1,59 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+      #include "etd.hpp"
+      #include <string>
+
+      const std::string casadi::Etd::meta_doc=
+      "\n"
+"Fixed-step exponential time differencing integrator for semi-linear stiff\n"
+"ODEs\n"
+"\n"
+"The right-hand side is split into a linear part A*x, formed by the entries\n"
+"of the Jacobian of the ODE with respect to the state that do not depend on\n"
+"any input, and a nonlinear remainder. The linear part is integrated\n"
+"exactly using the matrix exponential and the phi-functions of h*A, which\n"
+"are calculated once during initialization, so that the step size is not\n"
+"limited by the stiffness of A. Implements exponential Euler (order 1) and\n"
+"the ETD2RK scheme of Cox and Matthews (order 2).\n"
+"\n"
+"\n"
+">List of available options\n"
+"\n"
+"+---------------------------+-----------+--------------------------------+\n"
+"|            Id             |   Type    |          Description           |\n"
+"+===========================+===========+================================+\n"
+"| number_of_finite_elements | OT_INT    | Number of finite elements      |\n"
+"+---------------------------+-----------+--------------------------------+\n"
+"| order                     | OT_INT    | Order of the scheme: 1         |\n"
+"|                           |           | (exponential Euler) or 2       |\n"
+"|                           |           | (ETD2RK) [2]                   |\n"
+"+---------------------------+-----------+--------------------------------+\n"
+"\n"
+"\n"
+"\n"
+"\n"
+;
@@ -0,0 +1,228 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#include "ipqp.hpp"
+
+using namespace std;
+namespace casadi {
+
+  extern "C"
+  int CASADI_CONIC_IPQP_EXPORT
+  casadi_register_conic_ipqp(Conic::Plugin* plugin) {
+    plugin->creator = Ipqp::creator;
+    plugin->name = "ipqp";
+    plugin->doc = Ipqp::meta_doc.c_str();
+    plugin->version = CASADI_VERSION;
+    plugin->options = &Ipqp::options_;
+    return 0;
+  }
+
+  extern "C"
+  void CASADI_CONIC_IPQP_EXPORT casadi_load_conic_ipqp() {
+    Conic::registerPlugin(casadi_register_conic_ipqp);
+  }
+
+  Ipqp::Ipqp(const std::string& name, const std::map<std::string, Sparsity> &st)
+    : Conic(name, st) {
+  }
+
+  Ipqp::~Ipqp() {
+    clear_mem();
+  }
+
+  Options Ipqp::options_
+  = {{&Conic::options_},
+     {{"max_iter",
+       {OT_INT,
+        "Maximum number of iterations [100]."}},
+      {"tol",
+       {OT_DOUBLE,
+        "Tolerance for the residuals and the duality measure [1e-8]."}},
+      {"reg",
+       {OT_DOUBLE,
+        "Static regularization of the KKT system, making it quasi-definite [1e-10]."}}
+     }
+  };
+
+  void Ipqp::init(const Dict& opts) {
+    // Initialize the base classes
+    Conic::init(opts);
+
+    // Default options
+    max_iter_ = 100;
+    tol_ = 1e-8;
+    reg_ = 1e-10;
+
+    // Read user options
+    for (auto&& op : opts) {
+      if (op.first=="max_iter") {
+        max_iter_ = op.second;
+      } else if (op.first=="tol") {
+        tol_ = op.second;
+      } else if (op.first=="reg") {
+        reg_ = op.second;
+      }
+    }
+    casadi_assert(reg_>0, "Option 'reg' must be positive");
+
+    // KKT matrix, including the diagonal
+    kkt_ = Sparsity::blockcat({{H_.unite(Sparsity::diag(nx_)), A_.T()},
+                               {A_, Sparsity::diag(na_)}});
+
+    // Locations of the nonzeros of H, A, A' and the diagonal
+    std::vector<casadi_int> row, col;
+    H_.get_triplet(row, col);
+    for (casadi_int k=0; k<row.size(); ++k) kkt_h_.push_back(kkt_.get_nz(row[k], col[k]));
+    A_.get_triplet(row, col);
+    for (casadi_int k=0; k<row.size(); ++k) {
+      kkt_a_.push_back(kkt_.get_nz(nx_+row[k], col[k]));
+      kkt_at_.push_back(kkt_.get_nz(col[k], nx_+row[k]));
+    }
+    for (casadi_int i=0; i<nx_+na_; ++i) kkt_d_.push_back(kkt_.get_nz(i, i));
+
+    // Symbolic factorization
+    sp_lt_ = kkt_.ldl(perm_);
+
+    // Setup memory structure
+    p_.nx = nx_;
+    p_.na = na_;
+    p_.n = nx_ + na_;
+    p_.sp_h = H_;
+    p_.sp_a = A_;
+    p_.sp_kkt = kkt_;
+    p_.sp_lt = sp_lt_;
+    p_.perm = get_ptr(perm_);
+    p_.kkt_h = get_ptr(kkt_h_);
+    p_.kkt_a = get_ptr(kkt_a_);
+    p_.kkt_at = get_ptr(kkt_at_);
+    p_.kkt_d = get_ptr(kkt_d_);
+    p_.max_iter = max_iter_;
+    p_.tol = tol_;
+    p_.reg = reg_;
+    p_.inf = inf;
+
+    // Allocate memory
+    casadi_int sz_w, sz_iw;
+    casadi_ipqp_work(&p_, &sz_iw, &sz_w);
+    alloc_iw(sz_iw, true);
+    alloc_w(sz_w, true);
+  }
+
+  int Ipqp::init_mem(void* mem) const {
+    auto m = static_cast<IpqpMemory*>(mem);
+    m->return_status = "";
+    m->success = false;
+    m->iter_count = 0;
+    return 0;
+  }
+
+  int Ipqp::
+  eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const {
+    auto m = static_cast<IpqpMemory*>(mem);
+    // Reset statistics
+    for (auto&& s : m->fstats) s.second.reset();
+    // Check inputs
+    if (inputs_check_) {
+      check_inputs(arg[CONIC_LBX], arg[CONIC_UBX], arg[CONIC_LBA], arg[CONIC_UBA]);
+    }
+    // Setup data structure
+    casadi_ipqp_data<double> d;
+    d.prob = &p_;
+    casadi_ipqp_init(&d, iw, w);
+    if (casadi_ipqp_setup(&d, arg[CONIC_H], arg[CONIC_G], arg[CONIC_A],
+                          arg[CONIC_LBA], arg[CONIC_UBA],
+                          arg[CONIC_LBX], arg[CONIC_UBX])) {
+      casadi_error("Inconsistent bounds");
+    }
+    // Solve
+    int flag = casadi_ipqp_solve(&d);
+    switch (flag) {
+      case 0: m->return_status = "success"; break;
+      case 1: m->return_status = "Maximum number of iterations reached"; break;
+      default: m->return_status = "KKT factorization failed"; break;
+    }
+    m->success = flag==0;
+    m->iter_count = d.iter;
+    // Get solution
+    casadi_ipqp_scatter(&d, res[CONIC_X], res[CONIC_COST], res[CONIC_LAM_A],
+                        res[CONIC_LAM_X]);
+    if (verbose_) casadi_warning(m->return_status);
+    return 0;
+  }
+
+  Dict Ipqp::get_stats(void* mem) const {
+    Dict stats = Conic::get_stats(mem);
+    auto m = static_cast<IpqpMemory*>(mem);
+    stats["return_status"] = m->return_status;
+    stats["success"] = m->success;
+    stats["iter_count"] = m->iter_count;
+    return stats;
+  }
+
+  Dict Ipqp::codegen_footprint(const CodeGenerator& g) const {
+    Dict r = Conic::codegen_footprint(g);
+    // Data dependent loop, bounded by the maximum number of iterations
+    r["control"] = "iterative";
+    r["max_iter"] = max_iter_;
+    return r;
+  }
+
+  void Ipqp::codegen_body(CodeGenerator& g) const {
+    g.add_auxiliary(CodeGenerator::AUX_IPQP);
+    g.local("p", "struct casadi_ipqp_prob");
+    g.local("d", "struct casadi_ipqp_data");
+
+    g << "p.nx = " << p_.nx << ";\n";
+    g << "p.na = " << p_.na << ";\n";
+    g << "p.n = " << p_.n << ";\n";
+    g << "p.sp_h = " << g.sparsity(H_) << ";\n";
+    g << "p.sp_a = " << g.sparsity(A_) << ";\n";
+    g << "p.sp_kkt = " << g.sparsity(kkt_) << ";\n";
+    g << "p.sp_lt = " << g.sparsity(sp_lt_) << ";\n";
+    g << "p.perm = " << g.constant(perm_) << ";\n";
+    g << "p.kkt_h = " << g.constant(kkt_h_) << ";\n";
+    g << "p.kkt_a = " << g.constant(kkt_a_) << ";\n";
+    g << "p.kkt_at = " << g.constant(kkt_at_) << ";\n";
+    g << "p.kkt_d = " << g.constant(kkt_d_) << ";\n";
+    g << "p.max_iter = " << max_iter_ << ";\n";
+    g << "p.tol = " << g.constant(tol_) << ";\n";
+    g << "p.reg = " << g.constant(reg_) << ";\n";
+    g << "p.inf = " << g.constant(inf) << ";\n";
+    g << "d.prob = &p;\n";
+    g << "casadi_ipqp_init(&d, iw, w);\n";
+
+    g << "if (casadi_ipqp_setup(&d";
+    for (casadi_int i : {CONIC_H, CONIC_G, CONIC_A, CONIC_LBA, CONIC_UBA, CONIC_LBX,
+                         CONIC_UBX}) {
+      g << ", arg[" << i << "]";
+    }
+    g << ")) return 1;\n";
+    g << "casadi_ipqp_solve(&d);\n";
+    g << "casadi_ipqp_scatter(&d, res[" << CONIC_X << "], res[" << CONIC_COST << "], "
+      << "res[" << CONIC_LAM_A << "], res[" << CONIC_LAM_X << "]);\n";
+  }
+
+} // namespace casadi
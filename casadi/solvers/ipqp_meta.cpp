@@ -0,0 +1,75 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+
+      #include "ipqp.hpp"
+      #include <string>
+
+      const std::string casadi::Ipqp::meta_doc=
+      "\n"
+"Solve QPs using a primal-dual interior point method on the sparse KKT\n"
+"system\n"
+"\n"
+"Each iteration of the Mehrotra predictor-corrector method solves the\n"
+"regularized, quasi-definite KKT system [H + Sx, A'; A, -Sa^(-1)] by a\n"
+"sparse LDL^T factorization. The symbolic factorization, including the\n"
+"fill-reducing ordering, is calculated once during initialization. The\n"
+"number of iterations is nearly independent of the number of changes in the\n"
+"active set. The Hessian must be positive semidefinite. The method is\n"
+"implemented in the C runtime and can be code generated.\n"
+"\n"
+"\n"
+">List of available options\n"
+"\n"
+"+----------+-----------+-----------------------------------------------+\n"
+"|    Id    |   Type    |                  Description                  |\n"
+"+==========+===========+===============================================+\n"
+"| max_iter | OT_INT    | Maximum number of iterations [100].           |\n"
+"+----------+-----------+-----------------------------------------------+\n"
+"| reg      | OT_DOUBLE | Static regularization of the KKT system,      |\n"
+"|          |           | making it quasi-definite [1e-10].             |\n"
+"+----------+-----------+-----------------------------------------------+\n"
+"| tol      | OT_DOUBLE | Tolerance for the residuals and the duality   |\n"
+"|          |           | measure [1e-8].                               |\n"
+"+----------+-----------+-----------------------------------------------+\n"
+"\n"
+"\n"
+">List of available stats\n"
+"\n"
+"+---------------+\n"
+"|      Id       |\n"
+"+===============+\n"
+"| iter_count    |\n"
+"+---------------+\n"
+"| return_status |\n"
+"+---------------+\n"
+"| success       |\n"
+"+---------------+\n"
+"\n"
+"\n"
+"\n"
+"\n"
+;
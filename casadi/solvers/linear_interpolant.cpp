@@ -50,7 +50,9 @@ namespace casadi {
        {OT_STRINGVECTOR,
         "Sets, for each grid dimenion, the lookup algorithm used to find the correct index. "
         "'linear' uses a for-loop + break; "
-        "'exact' uses floored division (only for uniform grids)."}}
+        "'exact' uses floored division (only for uniform grids); "
+        "'hunt' searches outward from the interval found in the previous call; "
+        "'table' uses a precomputed index table (for non-uniform grids)."}}
      }
   };
 
@@ -64,6 +66,7 @@ namespace casadi {
   }
 
   LinearInterpolant::~LinearInterpolant() {
+    clear_mem();
   }
 
   void LinearInterpolant::init(const Dict& opts) {
@@ -71,21 +74,57 @@ namespace casadi {
     Interpolant::init(opts);
 
     lookup_mode_ = Interpolant::interpret_lookup_mode(lookup_modes_, grid_, offset_);
+    batch_lookup_mode_ = Interpolant::batch_lookup_mode(lookup_mode_, ndim_);
 
     // Needed by casadi_interpn
     alloc_w(ndim_, true);
     alloc_iw(2*ndim_, true);
   }
 
+  int LinearInterpolant::init_mem(void* mem) const {
+    static_cast<LookupMemory*>(mem)->hint.assign(ndim_, 0);
+    return 0;
+  }
+
   int LinearInterpolant::
   eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const {
+    auto m = static_cast<LookupMemory*>(mem);
     if (res[0]) {
+      // Intervals from the previous call, stored where casadi_interpn keeps the indices
+      copy(m->hint.begin(), m->hint.end(), iw);
       casadi_interpn(res[0], ndim_, get_ptr(grid_), get_ptr(offset_),
                      get_ptr(values_), arg[0], get_ptr(lookup_mode_), m_, iw, w);
+      copy(iw, iw+ndim_, m->hint.begin());
+    }
+    return 0;
+  }
+
+  int LinearInterpolant::eval_batch(const double** arg, double** res, casadi_int* iw,
+                                    double* w, void* mem, casadi_int n) const {
+    auto m = static_cast<LookupMemory*>(mem);
+    if (!res[0]) return 0;
+    copy(m->hint.begin(), m->hint.end(), iw);
+    for (casadi_int k=0; k<n; ++k) {
+      casadi_interpn(res[0]+k*m_, ndim_, get_ptr(grid_), get_ptr(offset_),
+                     get_ptr(values_), arg[0] ? arg[0]+k*ndim_ : nullptr,
+                     get_ptr(batch_lookup_mode_), m_, iw, w);
     }
+    copy(iw, iw+ndim_, m->hint.begin());
     return 0;
   }
 
+  void LinearInterpolant::codegen_body_batch(CodeGenerator& g, casadi_int n, const std::string& nb,
+                                             const std::string& arg, const std::string& res,
+                                             const std::string& w) const {
+    g << "if (" << res << "[0]) {\n"
+      << "for (k=0; k<" << nb << "; ++k) {\n"
+      << g.interpn(res + "[0]+k*" + str(m_), ndim_, g.constant(grid_), g.constant(offset_),
+                   g.constant(values_), arg + "[0] ? " + arg + "[0]+k*" + str(ndim_) + " : 0",
+                   g.constant(batch_lookup_mode_), m_, "iw", w) << "\n"
+      << "}\n"
+      << "}\n";
+  }
+
   void LinearInterpolant::codegen_body(CodeGenerator& g) const {
     g << "  if (res[0]) {\n"
       << "    " << g.interpn("res[0]", ndim_, g.constant(grid_), g.constant(offset_),
@@ -128,11 +167,20 @@ namespace casadi {
     alloc_iw(2*m->ndim_, true);
   }
 
+  int LinearInterpolantJac::init_mem(void* mem) const {
+    auto m = derivative_of_.get<LinearInterpolant>();
+    static_cast<LookupMemory*>(mem)->hint.assign(m->ndim_, 0);
+    return 0;
+  }
+
   int LinearInterpolantJac::
   eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const {
     auto m = derivative_of_.get<LinearInterpolant>();
+    auto lm = static_cast<LookupMemory*>(mem);
+    copy(lm->hint.begin(), lm->hint.end(), iw);
     casadi_interpn_grad(res[0], m->ndim_, get_ptr(m->grid_), get_ptr(m->offset_),
                         get_ptr(m->values_), arg[0], get_ptr(m->lookup_mode_), m->m_, iw, w);
+    if (res[0]) copy(iw, iw+m->ndim_, lm->hint.begin());
     return 0;
   }
 
@@ -79,6 +79,15 @@ namespace casadi {
     /// Evaluate numerically
     int eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const override;
 
+    /** \brief Create memory block */
+    void* alloc_mem() const override { return new LookupMemory();}
+
+    /** \brief Initalize memory block */
+    int init_mem(void* mem) const override;
+
+    /** \brief Free memory block */
+    void free_mem(void *mem) const override { delete static_cast<LookupMemory*>(mem);}
+
     ///@{
     /** \brief Full Jacobian */
     bool has_jacobian() const override { return true;}
@@ -94,6 +103,16 @@ namespace casadi {
     /** \brief Generate code for the body of the C function */
     void codegen_body(CodeGenerator& g) const override;
 
+    ///@{
+    /** \brief Batched evaluation, each lookup starts from the interval of the previous point */
+    bool has_eval_batch() const override { return true;}
+    int eval_batch(const double** arg, double** res, casadi_int* iw, double* w,
+                   void* mem, casadi_int n) const override;
+    void codegen_body_batch(CodeGenerator& g, casadi_int n, const std::string& nb,
+                            const std::string& arg, const std::string& res,
+                            const std::string& w) const override;
+    ///@}
+
     /// A documentation string
     static const std::string meta_doc;
 
@@ -103,7 +122,7 @@ namespace casadi {
     const Options& get_options() const override { return options_;}
     ///@}
 
-    std::vector<casadi_int> lookup_mode_;
+    std::vector<casadi_int> lookup_mode_, batch_lookup_mode_;
   };
 
   /** First order derivatives */
@@ -113,7 +132,7 @@ namespace casadi {
     LinearInterpolantJac(const std::string& name) : FunctionInternal(name) {}
 
     /// Destructor
-    ~LinearInterpolantJac() override {}
+    ~LinearInterpolantJac() override { clear_mem();}
 
     /** \brief Get type name */
     std::string class_name() const override { return "LinearInterpolantJac";}
@@ -130,6 +149,15 @@ namespace casadi {
     /// Evaluate numerically
     int eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const override;
 
+    /** \brief Create memory block */
+    void* alloc_mem() const override { return new LookupMemory();}
+
+    /** \brief Initalize memory block */
+    int init_mem(void* mem) const override;
+
+    /** \brief Free memory block */
+    void free_mem(void *mem) const override { delete static_cast<LookupMemory*>(mem);}
+
     ///@{
     /** \brief Full Jacobian */
     bool has_jacobian() const override { return true;}
@@ -25,6 +25,7 @@
 
 #include "linsol_ldl.hpp"
 #include "casadi/core/global_options.hpp"
+#include "casadi/core/thread_pool.hpp"
 
 using namespace std;
 namespace casadi {
@@ -47,18 +48,159 @@ namespace casadi {
 
   LinsolLdl::LinsolLdl(const std::string& name, const Sparsity& sp)
     : LinsolInternal(name, sp) {
+
+    // Default options
+    supernodal_ = false;
+    max_num_threads_ = 1;
+    ordering_ = "amd";
+    mixed_precision_ = false;
+    refine_tol_ = 1e-12;
+    max_refine_ = 10;
+    posdef_ = false;
   }
 
   LinsolLdl::~LinsolLdl() {
     clear_mem();
   }
 
+  Options LinsolLdl::options_
+  = {{&FunctionInternal::options_},
+     {{"ordering",
+       {OT_STRING,
+        "Fill-reducing ordering: 'natural', 'amd' (default), 'nd' (nested dissection) "
+        "or 'auto' (sparsest factor of 'amd' and 'nd')"}},
+      {"supernodal",
+       {OT_BOOL,
+        "Factorize dense column blocks (supernodes) of L with dense kernels. "
+        "Pays off when most columns of L fall into supernodes, e.g. banded KKT systems"}},
+      {"max_num_threads",
+       {OT_INT,
+        "Factorize independent subtrees of the elimination tree in parallel, "
+        "using at most this many threads [1]"}},
+      {"mixed_precision",
+       {OT_BOOL,
+        "Factorize in single precision and recover a double precision solution "
+        "by iterative refinement. Halves the memory traffic of the factorization, "
+        "but requires the system to be reasonably well-conditioned"}},
+      {"refine_tol",
+       {OT_DOUBLE,
+        "Tolerance for the iterative refinement, relative to the infinity norm "
+        "of the right-hand side [1e-12]"}},
+      {"max_refine",
+       {OT_INT,
+        "Maximum number of iterative refinement steps [10]"}},
+      {"posdef",
+       {OT_BOOL,
+        "Require a positive definite matrix, as a Cholesky factorization would: "
+        "the factorization, also in generated code, fails if D has an entry that is "
+        "not positive. For SPD systems, this replaces 'csparsecholesky'"}}
+     }
+  };
+
   void LinsolLdl::init(const Dict& opts) {
     // Call the init method of the base class
     LinsolInternal::init(opts);
 
-    // Symbolic factorization
-    sp_Lt_ = sp_.ldl(p_);
+    // Read options
+    for (auto&& op : opts) {
+      if (op.first=="ordering") {
+        ordering_ = op.second.to_string();
+      } else if (op.first=="supernodal") {
+        supernodal_ = op.second;
+      } else if (op.first=="max_num_threads") {
+        max_num_threads_ = op.second;
+        casadi_assert(max_num_threads_>=1, "Option 'max_num_threads' must be positive");
+      } else if (op.first=="mixed_precision") {
+        mixed_precision_ = op.second;
+      } else if (op.first=="refine_tol") {
+        refine_tol_ = op.second;
+      } else if (op.first=="max_refine") {
+        max_refine_ = op.second;
+      } else if (op.first=="posdef") {
+        posdef_ = op.second;
+      }
+    }
+    casadi_assert(!mixed_precision_ || (!supernodal_ && max_num_threads_==1),
+      "Option 'mixed_precision' cannot be combined with 'supernodal' or 'max_num_threads'");
+    casadi_assert(!supernodal_ || max_num_threads_==1,
+      "Options 'supernodal' and 'max_num_threads' cannot be combined");
+
+    // Symbolic factorization, shared with instances with the same pattern and options
+    std::string key = ordering_ + ":" + str(supernodal_) + ":" + str(max_num_threads_);
+    sym_ = shared_symbolic<LinsolLdlSymbolic>(sp_, key, [&]() {
+      LinsolLdlSymbolic sym;
+      // Symbolic factorization, after permuting
+      sym.p = sp_.ordering(ordering_);
+      std::vector<casadi_int> tmp;
+      sym.sp_Lt = sp_.sub(sym.p, sym.p, tmp).ldl(tmp, false);
+      sym.sp_L = sym.sp_Lt.transpose(sym.l_map);
+      // Supernode partitioning
+      if (supernodal_) sym.sn = supernodes(sym.sp_Lt);
+      // Parallel schedule
+      if (max_num_threads_>1) {
+        etree_subtrees(sym.sp_Lt, max_num_threads_, sym.task_ptr, sym.task_ind);
+      }
+      return sym;
+    });
+    sz_blk_ = supernodal_ ? sym_->sn.back() : 0;
+  }
+
+  std::vector<casadi_int> LinsolLdl::supernodes(const Sparsity& sp_Lt) {
+    casadi_int n = sp_Lt.size2();
+    // Columns of L, strictly lower entries only
+    Sparsity sp_L = sp_Lt.T();
+    const casadi_int *colind = sp_L.colind(), *row = sp_L.row();
+    // Merge column j into the supernode of j-1 if j is the parent of j-1 in
+    // the elimination tree and the remaining rows of j-1 coincide with those of j
+    std::vector<casadi_int> super(1, 0);
+    for (casadi_int j=1; j<n; ++j) {
+      casadi_int k1=colind[j-1], k2=colind[j];
+      bool merge = k2-k1==colind[j+1]-k2+1 && row[k1]==j;
+      for (casadi_int k=k1+1; merge && k<k2; ++k) merge = row[k]==row[k+k2-k1-1];
+      if (!merge) super.push_back(j);
+    }
+    if (n>0) super.push_back(n);
+    casadi_int ns = super.size()-1;
+    // Rows below each supernode: those of its last column
+    std::vector<casadi_int> rowptr(1, 0), sn_row;
+    for (casadi_int s=0; s<ns; ++s) {
+      casadi_int c = super[s+1]-1;
+      sn_row.insert(sn_row.end(), row+colind[c], row+colind[c+1]);
+      rowptr.push_back(sn_row.size());
+    }
+    // Supernode of each column
+    std::vector<casadi_int> snode(n);
+    for (casadi_int s=0; s<ns; ++s) {
+      for (casadi_int c=super[s]; c<super[s+1]; ++c) snode[c] = s;
+    }
+    // Supernodes updating each supernode: those of the nonzeros in its rows of L
+    const casadi_int *lt_colind = sp_Lt.colind(), *lt_row = sp_Lt.row();
+    std::vector<casadi_int> updptr(1, 0), upd;
+    for (casadi_int s=0; s<ns; ++s) {
+      std::set<casadi_int> u;
+      for (casadi_int c=super[s]; c<super[s+1]; ++c) {
+        for (casadi_int k=lt_colind[c]; k<lt_colind[c+1]; ++k) {
+          if (snode[lt_row[k]]!=s) u.insert(snode[lt_row[k]]);
+        }
+      }
+      upd.insert(upd.end(), u.begin(), u.end());
+      updptr.push_back(upd.size());
+    }
+    // Offsets of the dense blocks
+    std::vector<casadi_int> blkptr(1, 0);
+    for (casadi_int s=0; s<ns; ++s) {
+      casadi_int nc = super[s+1]-super[s];
+      blkptr.push_back(blkptr.back() + nc*(nc+rowptr[s+1]-rowptr[s]));
+    }
+    // Assemble, cf. casadi_ldl_super
+    std::vector<casadi_int> ret(1, ns);
+    ret.insert(ret.end(), super.begin(), super.end());
+    ret.insert(ret.end(), rowptr.begin(), rowptr.end());
+    ret.insert(ret.end(), sn_row.begin(), sn_row.end());
+    ret.insert(ret.end(), updptr.begin(), updptr.end());
+    ret.insert(ret.end(), upd.begin(), upd.end());
+    ret.insert(ret.end(), blkptr.begin(), blkptr.end());
+    return ret;
   }
 
   int LinsolLdl::init_mem(void* mem) const {
@@ -68,8 +210,21 @@ namespace casadi {
     // Work vectors
     casadi_int nrow = this->nrow();
     m->d.resize(nrow);
-    m->l.resize(sp_Lt_.nnz());
-    m->w.resize(nrow);
+    m->l.resize(sym_->sp_Lt.nnz());
+    m->w.resize(nrow*std::max(max_num_threads_, nrhs_blk));
+    if (supernodal_) {
+      m->blk.resize(sz_blk_);
+      m->iw.resize(2*nrow);
+    }
+    if (mixed_precision_) {
+      m->af.resize(sp_.nnz());
+      m->lf.resize(sym_->sp_Lt.nnz());
+      m->df.resize(nrow);
+      m->wf.resize(nrow);
+      m->xf.resize(nrow);
+      m->b.resize(nrow);
+      m->r.resize(nrow);
+    }
 
     return 0;
   }
@@ -80,7 +235,41 @@ namespace casadi {
 
   int LinsolLdl::nfact(void* mem, const double* A) const {
     auto m = static_cast<LinsolLdlMemory*>(mem);
-    casadi_ldl(sp_, A, sp_Lt_, get_ptr(m->l), get_ptr(m->d), get_ptr(p_), get_ptr(m->w));
+    const casadi_int* p = get_ptr(sym_->p);
+    if (mixed_precision_) {
+      std::copy(A, A+sp_.nnz(), m->af.begin());
+      casadi_ldl(sp_, get_ptr(m->af), sym_->sp_Lt, get_ptr(m->lf), get_ptr(m->df), p,
+                 get_ptr(m->wf));
+      // D in double precision for neig and rank
+      std::copy(m->df.begin(), m->df.end(), m->d.begin());
+    } else if (supernodal_) {
+      casadi_ldl_super(sp_, A, sym_->sp_Lt, get_ptr(m->l), get_ptr(m->d), p,
+                       get_ptr(sym_->sn), get_ptr(m->blk), get_ptr(m->w), get_ptr(m->iw));
+    } else if (max_num_threads_>1) {
+      // Independent subtrees in parallel, each thread with its own work vector
+      casadi_int nrow = this->nrow(), ntask = sym_->task_ptr.size()-2;
+      std::fill(m->w.begin(), m->w.end(), 0);
+      auto task = [&](casadi_int k, casadi_int t) {
+        for (casadi_int i=sym_->task_ptr[k]; i<sym_->task_ptr[k+1]; ++i) {
+          casadi_ldl_row(sp_, A, sym_->sp_Lt, get_ptr(m->l), get_ptr(m->d), p,
+                         sym_->task_ind[i], get_ptr(m->w) + t*nrow);
+        }
+      };
+      ThreadPool::run(ntask, max_num_threads_, task);
+      // Remaining rows
+      task(ntask, 0);
+    } else {
+      casadi_ldl(sp_, A, sym_->sp_Lt, get_ptr(m->l), get_ptr(m->d), p, get_ptr(m->w));
+    }
+    if (posdef_) {
+      for (double d : m->d) {
+        if (!(d>0)) {
+          if (verbose_) casadi_message("Matrix is not positive definite");
+          return 1;
+        }
+      }
+      return 0;
+    }
     for (double d : m->d) {
       if (d==0) casadi_warning("LDL factorization has zeros in D");
     }
@@ -89,7 +278,52 @@ namespace casadi {
 
   int LinsolLdl::solve(void* mem, const double* A, double* x, casadi_int nrhs, bool tr) const {
     auto m = static_cast<LinsolLdlMemory*>(mem);
-    casadi_ldl_solve(x, nrhs, sp_Lt_, get_ptr(m->l), get_ptr(m->d), get_ptr(p_), get_ptr(m->w));
+    const casadi_int* p = get_ptr(sym_->p);
+    if (mixed_precision_) {
+      auto solve_low = [&](double* v) {
+        std::copy(v, v+nrow(), m->xf.begin());
+        casadi_ldl_solve(get_ptr(m->xf), 1, sym_->sp_Lt, get_ptr(m->lf), get_ptr(m->df), p,
+                         get_ptr(m->wf));
+        std::copy(m->xf.begin(), m->xf.end(), v);
+      };
+      refine(sp_, A, x, nrhs, tr, solve_low, get_ptr(m->b), get_ptr(m->r),
+             max_refine_, refine_tol_);
+      return 0;
+    }
+    if (nrhs>1) {
+      // Several right-hand sides per pass over the factors
+      casadi_ldl_solve_blk(x, nrhs, sym_->sp_Lt, get_ptr(m->l), get_ptr(m->d), p,
+                           get_ptr(m->w), nrhs_blk);
+    } else {
+      casadi_ldl_solve(x, nrhs, sym_->sp_Lt, get_ptr(m->l), get_ptr(m->d), p, get_ptr(m->w));
+    }
+    return 0;
+  }
+
+  int LinsolLdl::update(void* mem, const double* W, casadi_int k, double sigma) const {
+    auto m = static_cast<LinsolLdlMemory*>(mem);
+    casadi_assert(!mixed_precision_, "'update' cannot be combined with 'mixed_precision'");
+    casadi_int nrow = this->nrow();
+    const casadi_int *colind = sp_.colind(), *row = sp_.row();
+    std::vector<casadi_int> nz;
+    for (casadi_int j=0; j<k; ++j) {
+      const double* w = W + j*nrow;
+      // The pattern of w*w' must be contained in the pattern of A
+      nz.clear();
+      for (casadi_int i=0; i<nrow; ++i) if (w[i]!=0) nz.push_back(i);
+      for (casadi_int c : nz) {
+        casadi_int n_match = 0;
+        for (casadi_int el=colind[c]; el<colind[c+1]; ++el) n_match += w[row[el]]!=0;
+        casadi_assert(n_match==nz.size(),
+          "Pattern of the update is not contained in the sparsity pattern");
+      }
+      // Rank-1 modification
+      if (casadi_ldl_update(sym_->sp_L, get_ptr(sym_->l_map), get_ptr(m->l), get_ptr(m->d),
+                            get_ptr(sym_->p), sigma, w, get_ptr(m->w))) {
+        casadi_warning("LDL update has zeros in D");
+        return 1;
+      }
+    }
     return 0;
   }
 
@@ -111,22 +345,51 @@ namespace casadi {
     return ret;
   }
 
+  void LinsolLdl::generate_posdef(CodeGenerator& g) const {
+    g << "{\n"
+      << "casadi_int i;\n"
+      << "for (i=0; i<" << nrow() << "; ++i) if (!(d[i]>0)) return 1;\n"
+      << "}\n";
+  }
+
   void LinsolLdl::generate(CodeGenerator& g, const std::string& A, const std::string& x,
                           casadi_int nrhs, bool tr) const {
     // Codegen the integer vectors
     string sp = g.sparsity(sp_);
-    string sp_Lt = g.sparsity(sp_Lt_);
-    string p = g.constant(p_);
+    string sp_Lt = g.sparsity(sym_->sp_Lt);
+    string p = g.constant(sym_->p);
 
     // Place in block to avoid conflicts caused by local variables
     g << "{\n";
     g.comment("FIXME(@jaeandersson): Memory allocation can be avoided");
-    g << "casadi_real lt[" << sp_Lt_.nnz() << "], "
+    if (mixed_precision_) {
+      g << "casadi_int i;\n"
+        << "float al[" << sp_.nnz() << "], "
+           "lt[" << sym_->sp_Lt.nnz() << "], "
+           "d[" << nrow() << "], "
+           "w[" << nrow() << "];\n"
+        << "for (i=0; i<" << sp_.nnz() << "; ++i) al[i] = (" << A << ")[i];\n"
+        << g.ldl(sp, "al", sp_Lt, "lt", "d", p, "w", "float") << "\n";
+      if (posdef_) generate_posdef(g);
+      generate_refine(g, sp_, A, x, nrhs, tr, "float",
+                      g.ldl_solve("xl", 1, sp_Lt, "lt", "d", p, "w", "float"),
+                      max_refine_, refine_tol_);
+      g << "}\n";
+      return;
+    }
+    g << "casadi_real lt[" << sym_->sp_Lt.nnz() << "], "
          "d[" << nrow() << "], "
          "w[" << nrow() << "];\n";
 
     // Factorize
-    g << g.ldl(sp, A, sp_Lt, "lt", "d", p, "w") << "\n";
+    if (supernodal_) {
+      g << "casadi_real blk[" << sz_blk_ << "];\n"
+        << "casadi_int iw[" << 2*nrow() << "];\n";
+      g << g.ldl_super(sp, A, sp_Lt, "lt", "d", p, g.constant(sym_->sn), "blk", "w", "iw") << "\n";
+    } else {
+      g << g.ldl(sp, A, sp_Lt, "lt", "d", p, "w") << "\n";
+    }
+    if (posdef_) generate_posdef(g);
 
     // Solve
     g << g.ldl_solve(x, nrhs, sp_Lt, "lt", "d", p, "w") << "\n";
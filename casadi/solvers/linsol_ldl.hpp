@@ -39,6 +39,29 @@
 namespace casadi {
   struct CASADI_LINSOL_LDL_EXPORT LinsolLdlMemory : public LinsolMemory {
     std::vector<double> l, d, w;
+    // Supernodal factorization
+    std::vector<double> blk;
+    std::vector<casadi_int> iw;
+    // Mixed-precision factorization
+    std::vector<float> af, lf, df, wf, xf;
+    std::vector<double> b, r;
+  };
+
+  /** \brief Symbolic factorization, shared between instances */
+  struct CASADI_LINSOL_LDL_EXPORT LinsolLdlSymbolic {
+    // Fill-reducing permutation and the pattern of L^T
+    std::vector<casadi_int> p;
+    Sparsity sp_Lt;
+
+    // Pattern of L and the locations of its nonzeros in L^T, for update
+    Sparsity sp_L;
+    std::vector<casadi_int> l_map;
+
+    // Supernode partitioning, empty if not supernodal
+    std::vector<casadi_int> sn;
+
+    // Rows grouped by independent subtrees of the elimination tree
+    std::vector<casadi_int> task_ptr, task_ind;
   };
 
   /** \brief \pluginbrief{LinsolInternal,ldl}
@@ -59,9 +82,18 @@ namespace casadi {
     // Destructor
     ~LinsolLdl() override;
 
+    ///@{
+    /** \brief Options */
+    static Options options_;
+    const Options& get_options() const override { return options_;}
+    ///@}
+
     // Initialize the solver
     void init(const Dict& opts) override;
 
+    // Partition the columns of L into supernodes, cf. casadi_ldl_super
+    static std::vector<casadi_int> supernodes(const Sparsity& sp_Lt);
+
     /** \brief Create memory block */
     void* alloc_mem() const override { return new LinsolLdlMemory();}
 
@@ -80,10 +112,16 @@ namespace casadi {
     // Solve the linear system
     int solve(void* mem, const double* A, double* x, casadi_int nrhs, bool tr) const override;
 
+    // Low-rank modification of the factorization
+    int update(void* mem, const double* W, casadi_int k, double sigma) const override;
+
     /// Generate C code
     void generate(CodeGenerator& g, const std::string& A, const std::string& x,
                   casadi_int nrhs, bool tr) const override;
 
+    /// Generate C code that returns with an error unless D is positive
+    void generate_posdef(CodeGenerator& g) const;
+
     /// Number of negative eigenvalues
     casadi_int neig(void* mem, const double* A) const override;
 
@@ -100,8 +138,29 @@ namespace casadi {
     std::string class_name() const override { return "LinsolLdl";}
 
     // Symbolic factorization
-    std::vector<casadi_int> p_;
-    Sparsity sp_Lt_;
+    std::shared_ptr<const LinsolLdlSymbolic> sym_;
+
+    // Fill-reducing ordering
+    std::string ordering_;
+
+    // Factorize supernodes as dense blocks
+    bool supernodal_;
+
+    // Size of the dense supernode blocks
+    casadi_int sz_blk_;
+
+    // Maximum number of threads for the numeric factorization
+    casadi_int max_num_threads_;
+
+    // Factorize in single precision, refine the solution in double precision
+    bool mixed_precision_;
+
+    // Iterative refinement
+    double refine_tol_;
+    casadi_int max_refine_;
+
+    // Fail unless positive definite, like a Cholesky factorization
+    bool posdef_;
   };
 
 } // namespace casadi
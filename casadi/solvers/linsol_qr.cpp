@@ -25,6 +25,7 @@
 
 #include "linsol_qr.hpp"
 #include "casadi/core/global_options.hpp"
+#include "casadi/core/thread_pool.hpp"
 
 using namespace std;
 namespace casadi {
@@ -47,18 +48,80 @@ namespace casadi {
 
   LinsolQr::LinsolQr(const std::string& name, const Sparsity& sp)
     : LinsolInternal(name, sp) {
+
+    // Default options
+    max_num_threads_ = 1;
+    ordering_ = "amd";
+    mixed_precision_ = false;
+    refine_tol_ = 1e-12;
+    max_refine_ = 10;
   }
 
   LinsolQr::~LinsolQr() {
     clear_mem();
   }
 
+  Options LinsolQr::options_
+  = {{&FunctionInternal::options_},
+     {{"ordering",
+       {OT_STRING,
+        "Fill-reducing column ordering, applied to the pattern of A'*A: 'natural', "
+        "'amd' (default), 'nd' (nested dissection) or 'auto' (sparsest R of 'amd' and 'nd')"}},
+      {"max_num_threads",
+       {OT_INT,
+        "Factorize independent subtrees of the elimination tree in parallel, "
+        "using at most this many threads [1]"}},
+      {"mixed_precision",
+       {OT_BOOL,
+        "Factorize in single precision and recover a double precision solution "
+        "by iterative refinement. Halves the memory traffic of the factorization, "
+        "but requires the system to be reasonably well-conditioned"}},
+      {"refine_tol",
+       {OT_DOUBLE,
+        "Tolerance for the iterative refinement, relative to the infinity norm "
+        "of the right-hand side [1e-12]"}},
+      {"max_refine",
+       {OT_INT,
+        "Maximum number of iterative refinement steps [10]"}}
+     }
+  };
+
   void LinsolQr::init(const Dict& opts) {
     // Call the init method of the base class
     LinsolInternal::init(opts);
 
-    // Symbolic factorization
-    sp_.qr_sparse(sp_v_, sp_r_, prinv_, pc_);
+    // Read options
+    for (auto&& op : opts) {
+      if (op.first=="ordering") {
+        ordering_ = op.second.to_string();
+      } else if (op.first=="max_num_threads") {
+        max_num_threads_ = op.second;
+        casadi_assert(max_num_threads_>=1, "Option 'max_num_threads' must be positive");
+      } else if (op.first=="mixed_precision") {
+        mixed_precision_ = op.second;
+      } else if (op.first=="refine_tol") {
+        refine_tol_ = op.second;
+      } else if (op.first=="max_refine") {
+        max_refine_ = op.second;
+      }
+    }
+    casadi_assert(!mixed_precision_ || max_num_threads_==1,
+      "Option 'mixed_precision' cannot be combined with 'max_num_threads'");
+
+    // Symbolic factorization, shared with instances with the same pattern and options
+    std::string key = ordering_ + ":" + str(max_num_threads_);
+    sym_ = shared_symbolic<LinsolQrSymbolic>(sp_, key, [&]() {
+      LinsolQrSymbolic sym;
+      // Symbolic factorization, after permuting the columns
+      sym.pc = mtimes(sp_.T(), sp_).ordering(ordering_);
+      std::vector<casadi_int> tmp;
+      sp_.sub(range(nrow()), sym.pc, tmp).qr_sparse(sym.sp_v, sym.sp_r, sym.prinv, tmp, false);
+      // Parallel schedule
+      if (max_num_threads_>1) {
+        etree_subtrees(sym.sp_r, max_num_threads_, sym.task_ptr, sym.task_ind);
+      }
+      return sym;
+    });
   }
 
   int LinsolQr::init_mem(void* mem) const {
@@ -66,10 +129,21 @@ namespace casadi {
     auto m = static_cast<LinsolQrMemory*>(mem);
 
     // Memory for numerical solution
-    m->v.resize(sp_v_.nnz());
-    m->r.resize(sp_r_.nnz());
+    m->v.resize(sym_->sp_v.nnz());
+    m->r.resize(sym_->sp_r.nnz());
     m->beta.resize(ncol());
-    m->w.resize(nrow() + ncol());
+    m->w.resize(std::max(nrow() + ncol(),
+                         std::max(max_num_threads_, nrhs_blk+1)*sym_->sp_v.size1()+nrhs_blk));
+    if (mixed_precision_) {
+      m->af.resize(sp_.nnz());
+      m->vf.resize(sym_->sp_v.nnz());
+      m->rf.resize(sym_->sp_r.nnz());
+      m->betaf.resize(ncol());
+      m->wf.resize(nrow() + ncol());
+      m->xf.resize(nrow());
+      m->b.resize(nrow());
+      m->res.resize(nrow());
+    }
     return 0;
   }
 
@@ -79,34 +153,92 @@ namespace casadi {
 
   int LinsolQr::nfact(void* mem, const double* A) const {
     auto m = static_cast<LinsolQrMemory*>(mem);
-    casadi_qr(sp_, A, get_ptr(m->w),
-              sp_v_, get_ptr(m->v), sp_r_, get_ptr(m->r),
-              get_ptr(m->beta), get_ptr(prinv_), get_ptr(pc_));
+    if (mixed_precision_) {
+      std::copy(A, A+sp_.nnz(), m->af.begin());
+      casadi_qr(sp_, get_ptr(m->af), get_ptr(m->wf),
+                sym_->sp_v, get_ptr(m->vf), sym_->sp_r, get_ptr(m->rf),
+                get_ptr(m->betaf), get_ptr(sym_->prinv), get_ptr(sym_->pc));
+    } else if (max_num_threads_>1) {
+      // Independent subtrees in parallel, each thread with its own work vector
+      casadi_int nrow_ext = sym_->sp_v.size1(), ntask = sym_->task_ptr.size()-2;
+      std::fill(m->w.begin(), m->w.end(), 0);
+      auto task = [&](casadi_int k, casadi_int t) {
+        for (casadi_int i=sym_->task_ptr[k]; i<sym_->task_ptr[k+1]; ++i) {
+          casadi_qr_col(sp_, A, get_ptr(m->w) + t*nrow_ext,
+                        sym_->sp_v, get_ptr(m->v), sym_->sp_r, get_ptr(m->r),
+                        get_ptr(m->beta), get_ptr(sym_->prinv), get_ptr(sym_->pc),
+                        sym_->task_ind[i]);
+        }
+      };
+      ThreadPool::run(ntask, max_num_threads_, task);
+      // Remaining columns
+      task(ntask, 0);
+    } else {
+      casadi_qr(sp_, A, get_ptr(m->w),
+                sym_->sp_v, get_ptr(m->v), sym_->sp_r, get_ptr(m->r),
+                get_ptr(m->beta), get_ptr(sym_->prinv), get_ptr(sym_->pc));
+    }
     return 0;
   }
 
   int LinsolQr::solve(void* mem, const double* A, double* x, casadi_int nrhs, bool tr) const {
     auto m = static_cast<LinsolQrMemory*>(mem);
-    casadi_qr_solve(x, nrhs, tr,
-                    sp_v_, get_ptr(m->v), sp_r_, get_ptr(m->r),
-                    get_ptr(m->beta), get_ptr(prinv_), get_ptr(pc_), get_ptr(m->w));
+    if (mixed_precision_) {
+      auto solve_low = [&](double* v) {
+        std::copy(v, v+nrow(), m->xf.begin());
+        casadi_qr_solve(get_ptr(m->xf), 1, tr,
+                        sym_->sp_v, get_ptr(m->vf), sym_->sp_r, get_ptr(m->rf),
+                        get_ptr(m->betaf), get_ptr(sym_->prinv), get_ptr(sym_->pc), get_ptr(m->wf));
+        std::copy(m->xf.begin(), m->xf.end(), v);
+      };
+      refine(sp_, A, x, nrhs, tr, solve_low, get_ptr(m->b), get_ptr(m->res),
+             max_refine_, refine_tol_);
+      return 0;
+    }
+    if (nrhs>1) {
+      // Several right-hand sides per pass over the factors
+      casadi_qr_solve_blk(x, nrhs, tr,
+                          sym_->sp_v, get_ptr(m->v), sym_->sp_r, get_ptr(m->r),
+                          get_ptr(m->beta), get_ptr(sym_->prinv), get_ptr(sym_->pc),
+                          get_ptr(m->w), nrhs_blk);
+    } else {
+      casadi_qr_solve(x, nrhs, tr,
+                      sym_->sp_v, get_ptr(m->v), sym_->sp_r, get_ptr(m->r),
+                      get_ptr(m->beta), get_ptr(sym_->prinv), get_ptr(sym_->pc), get_ptr(m->w));
+    }
     return 0;
   }
 
   void LinsolQr::generate(CodeGenerator& g, const std::string& A, const std::string& x,
                           casadi_int nrhs, bool tr) const {
     // Codegen the integer vectors
-    string prinv = g.constant(prinv_);
-    string pc = g.constant(pc_);
+    string prinv = g.constant(sym_->prinv);
+    string pc = g.constant(sym_->pc);
     string sp = g.sparsity(sp_);
-    string sp_v = g.sparsity(sp_v_);
-    string sp_r = g.sparsity(sp_r_);
+    string sp_v = g.sparsity(sym_->sp_v);
+    string sp_r = g.sparsity(sym_->sp_r);
 
     // Place in block to avoid conflicts caused by local variables
     g << "{\n";
     g.comment("FIXME(@jaeandersson): Memory allocation can be avoided");
-    g << "casadi_real v[" << sp_v_.nnz() << "], "
-         "r[" << sp_r_.nnz() << "], "
+    if (mixed_precision_) {
+      g << "casadi_int i;\n"
+        << "float al[" << sp_.nnz() << "], "
+           "v[" << sym_->sp_v.nnz() << "], "
+           "r[" << sym_->sp_r.nnz() << "], "
+           "beta[" << ncol() << "], "
+           "w[" << nrow() + ncol() << "];\n"
+        << "for (i=0; i<" << sp_.nnz() << "; ++i) al[i] = (" << A << ")[i];\n"
+        << g.qr(sp, "al", "w", sp_v, "v", sp_r, "r", "beta", prinv, pc, "float") << "\n";
+      generate_refine(g, sp_, A, x, nrhs, tr, "float",
+                      g.qr_solve("xl", 1, tr, sp_v, "v", sp_r, "r", "beta", prinv, pc, "w",
+                                 "float"),
+                      max_refine_, refine_tol_);
+      g << "}\n";
+      return;
+    }
+    g << "casadi_real v[" << sym_->sp_v.nnz() << "], "
+         "r[" << sym_->sp_r.nnz() << "], "
          "beta[" << ncol() << "], "
          "w[" << nrow() + ncol() << "];\n";
 
@@ -39,6 +39,19 @@
 namespace casadi {
   struct CASADI_LINSOL_QR_EXPORT LinsolQrMemory : public LinsolMemory {
     std::vector<double> v, r, beta, w;
+    // Mixed-precision factorization
+    std::vector<float> af, vf, rf, betaf, wf, xf;
+    std::vector<double> b, res;
+  };
+
+  /** \brief Symbolic factorization, shared between instances */
+  struct CASADI_LINSOL_QR_EXPORT LinsolQrSymbolic {
+    // Row and column permutations and the patterns of V and R
+    std::vector<casadi_int> prinv, pc;
+    Sparsity sp_v, sp_r;
+
+    // Columns grouped by independent subtrees of the elimination tree
+    std::vector<casadi_int> task_ptr, task_ind;
   };
 
   /** \brief \pluginbrief{LinsolInternal,qr}
@@ -59,6 +72,12 @@ namespace casadi {
     // Destructor
     ~LinsolQr() override;
 
+    ///@{
+    /** \brief Options */
+    static Options options_;
+    const Options& get_options() const override { return options_;}
+    ///@}
+
     // Initialize the solver
     void init(const Dict& opts) override;
 
@@ -94,8 +113,20 @@ namespace casadi {
     static const std::string meta_doc;
 
     /// Symbolic factorization
-    std::vector<casadi_int> prinv_, pc_;
-    Sparsity sp_v_, sp_r_;
+    std::shared_ptr<const LinsolQrSymbolic> sym_;
+
+    // Fill-reducing column ordering
+    std::string ordering_;
+
+    // Maximum number of threads for the numeric factorization
+    casadi_int max_num_threads_;
+
+    // Factorize in single precision, refine the solution in double precision
+    bool mixed_precision_;
+
+    // Iterative refinement
+    double refine_tol_;
+    casadi_int max_refine_;
   };
 
 } // namespace casadi
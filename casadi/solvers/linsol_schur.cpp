@@ -0,0 +1,369 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#include "linsol_schur.hpp"
+#include "casadi/core/global_options.hpp"
+#include "casadi/core/thread_pool.hpp"
+
+using namespace std;
+namespace casadi {
+
+  extern "C"
+  int CASADI_LINSOL_SCHUR_EXPORT
+  casadi_register_linsol_schur(LinsolInternal::Plugin* plugin) {
+    plugin->creator = LinsolSchur::creator;
+    plugin->name = "schur";
+    plugin->doc = LinsolSchur::meta_doc.c_str();
+    plugin->version = CASADI_VERSION;
+    plugin->options = &LinsolSchur::options_;
+    return 0;
+  }
+
+  extern "C"
+  void CASADI_LINSOL_SCHUR_EXPORT casadi_load_linsol_schur() {
+    LinsolInternal::registerPlugin(casadi_register_linsol_schur);
+  }
+
+  LinsolSchur::LinsolSchur(const std::string& name, const Sparsity& sp)
+    : LinsolInternal(name, sp) {
+
+    // Default options
+    linear_solver_ = "qr";
+    max_num_threads_ = 1;
+  }
+
+  LinsolSchur::~LinsolSchur() {
+    clear_mem();
+  }
+
+  Options LinsolSchur::options_
+  = {{&FunctionInternal::options_},
+     {{"coupling",
+       {OT_INTVECTOR,
+        "Coupling variables, e.g. the states and controls shared by the branches "
+        "of a scenario tree. The remaining variables split into independent branches"}},
+      {"linear_solver",
+       {OT_STRING,
+        "Linear solver for the branches and the Schur complement [qr]"}},
+      {"linear_solver_options",
+       {OT_DICT,
+        "Options to be passed to the linear solver"}},
+      {"max_num_threads",
+       {OT_INT,
+        "Factorize and solve the branches in parallel, "
+        "using at most this many threads [1]"}}
+     }
+  };
+
+  void LinsolSchur::init(const Dict& opts) {
+    // Call the init method of the base class
+    LinsolInternal::init(opts);
+
+    // Read options
+    for (auto&& op : opts) {
+      if (op.first=="coupling") {
+        coupling_ = op.second;
+      } else if (op.first=="linear_solver") {
+        linear_solver_ = op.second.to_string();
+      } else if (op.first=="linear_solver_options") {
+        linear_solver_options_ = op.second;
+      } else if (op.first=="max_num_threads") {
+        max_num_threads_ = op.second;
+        casadi_assert(max_num_threads_>=1, "Option 'max_num_threads' must be positive");
+      }
+    }
+
+    // Mark the coupling variables
+    casadi_int n = nrow(), nc = coupling_.size();
+    std::vector<bool> is_c(n, false);
+    for (casadi_int c : coupling_) {
+      casadi_assert(c>=0 && c<n, "Coupling variable " + str(c) + " out of bounds");
+      casadi_assert(!is_c[c], "Duplicate coupling variable " + str(c));
+      is_c[c] = true;
+    }
+
+    // Branches: connected components of the remaining variables
+    std::vector<casadi_int> root(n);
+    for (casadi_int i=0; i<n; ++i) root[i] = i;
+    auto find = [&](casadi_int i) {
+      while (root[i]!=i) i = root[i] = root[root[i]];
+      return i;
+    };
+    const casadi_int *colind = sp_.colind(), *row = sp_.row();
+    for (casadi_int c=0; c<n; ++c) {
+      if (is_c[c]) continue;
+      for (casadi_int k=colind[c]; k<colind[c+1]; ++k) {
+        casadi_int r = row[k];
+        if (is_c[r]) continue;
+        casadi_int r1 = find(r), c1 = find(c);
+        // Smallest index is the root
+        if (r1<c1) {
+          root[c1] = r1;
+        } else {
+          root[r1] = c1;
+        }
+      }
+    }
+    std::vector<casadi_int> ind(n, -1);
+    branch_.clear();
+    for (casadi_int i=0; i<n; ++i) {
+      if (is_c[i]) continue;
+      casadi_int r = find(i);
+      if (ind[r]<0) {
+        ind[r] = branch_.size();
+        branch_.push_back({});
+      }
+      branch_[ind[r]].push_back(i);
+    }
+    casadi_int nb = branch_.size();
+    if (verbose_) {
+      casadi_message(str(nb) + " branches and " + str(nc) + " coupling variables");
+    }
+
+    // Blocks of each branch, with the locations of their nonzeros in A
+    sp_ii_.resize(nb);
+    sp_ic_.resize(nb);
+    sp_ci_.resize(nb);
+    map_ii_.resize(nb);
+    map_ic_.resize(nb);
+    map_ci_.resize(nb);
+    linsol_.resize(nb);
+    for (casadi_int b=0; b<nb; ++b) {
+      const std::vector<casadi_int>& br = branch_[b];
+      sp_ii_[b] = sp_.sub(br, br, map_ii_[b]);
+      sp_ic_[b] = sp_.sub(br, coupling_, map_ic_[b]);
+      sp_ci_[b] = sp_.sub(coupling_, br, map_ci_[b]);
+      linsol_[b] = Linsol(name_ + "_" + str(b), linear_solver_, sp_ii_[b],
+                          linear_solver_options_);
+    }
+
+    // Schur complement, dense
+    Sparsity sp_cc = sp_.sub(coupling_, coupling_, map_cc_);
+    std::vector<casadi_int> map_cc(nc*nc, -1);
+    for (casadi_int c=0; c<nc; ++c) {
+      for (casadi_int k=sp_cc.colind(c); k<sp_cc.colind(c+1); ++k) {
+        map_cc[sp_cc.row(k)+c*nc] = map_cc_[k];
+      }
+    }
+    map_cc_ = map_cc;
+    if (nc>0) {
+      linsol_s_ = Linsol(name_ + "_schur", linear_solver_, Sparsity::dense(nc, nc),
+                         linear_solver_options_);
+    }
+  }
+
+  int LinsolSchur::init_mem(void* mem) const {
+    if (LinsolInternal::init_mem(mem)) return 1;
+    auto m = static_cast<LinsolSchurMemory*>(mem);
+    casadi_int nc = coupling_.size();
+
+    // Work vectors and memory in the linear solvers
+    m->b.resize(branch_.size());
+    for (casadi_int b=0; b<m->b.size(); ++b) {
+      LinsolSchurBranch& mb = m->b[b];
+      casadi_int ni = branch_[b].size();
+      mb.mem = linsol_[b].checkout();
+      mb.a_ii.resize(sp_ii_[b].nnz());
+      mb.a_ic.resize(sp_ic_[b].nnz());
+      mb.a_ci.resize(sp_ci_[b].nnz());
+      mb.w.resize(ni*nc);
+      mb.s.resize(nc*nc);
+    }
+    m->mem_s = nc>0 ? linsol_s_.checkout() : -1;
+    m->s.resize(nc*nc);
+    return 0;
+  }
+
+  void LinsolSchur::free_mem(void *mem) const {
+    auto m = static_cast<LinsolSchurMemory*>(mem);
+    for (casadi_int b=0; b<m->b.size(); ++b) linsol_[b].release(m->b[b].mem);
+    if (m->mem_s>=0) linsol_s_.release(m->mem_s);
+    delete m;
+  }
+
+  int LinsolSchur::sfact(void* mem, const double* A) const {
+    auto m = static_cast<LinsolSchurMemory*>(mem);
+    for (casadi_int b=0; b<m->b.size(); ++b) {
+      LinsolSchurBranch& mb = m->b[b];
+      for (casadi_int k=0; k<mb.a_ii.size(); ++k) mb.a_ii[k] = A[map_ii_[b][k]];
+      if (linsol_[b].sfact(get_ptr(mb.a_ii), mb.mem)) return 1;
+    }
+    return 0;
+  }
+
+  int LinsolSchur::nfact(void* mem, const double* A) const {
+    auto m = static_cast<LinsolSchurMemory*>(mem);
+    casadi_int nc = coupling_.size();
+
+    // Factorize each branch and form its contribution A_ci*inv(A_ii)*A_ic
+    std::vector<int> flag(m->b.size(), 0);
+    auto task = [&](casadi_int b, casadi_int t) {
+      LinsolSchurBranch& mb = m->b[b];
+      casadi_int ni = branch_[b].size();
+      for (casadi_int k=0; k<mb.a_ii.size(); ++k) mb.a_ii[k] = A[map_ii_[b][k]];
+      for (casadi_int k=0; k<mb.a_ic.size(); ++k) mb.a_ic[k] = A[map_ic_[b][k]];
+      for (casadi_int k=0; k<mb.a_ci.size(); ++k) mb.a_ci[k] = A[map_ci_[b][k]];
+      if (linsol_[b].nfact(get_ptr(mb.a_ii), mb.mem)) {
+        flag[b] = 1;
+        return;
+      }
+      if (nc==0) return;
+      // W = inv(A_ii)*A_ic
+      std::fill(mb.w.begin(), mb.w.end(), 0);
+      const casadi_int *colind = sp_ic_[b].colind(), *row = sp_ic_[b].row();
+      for (casadi_int c=0; c<nc; ++c) {
+        for (casadi_int k=colind[c]; k<colind[c+1]; ++k) mb.w[row[k]+c*ni] = mb.a_ic[k];
+      }
+      if (linsol_[b].solve(get_ptr(mb.a_ii), get_ptr(mb.w), nc, false, mb.mem)) {
+        flag[b] = 1;
+        return;
+      }
+      // A_ci*W
+      std::fill(mb.s.begin(), mb.s.end(), 0);
+      colind = sp_ci_[b].colind();
+      row = sp_ci_[b].row();
+      for (casadi_int j=0; j<ni; ++j) {
+        for (casadi_int k=colind[j]; k<colind[j+1]; ++k) {
+          for (casadi_int c=0; c<nc; ++c) mb.s[row[k]+c*nc] += mb.a_ci[k]*mb.w[j+c*ni];
+        }
+      }
+    };
+    ThreadPool::run(m->b.size(), max_num_threads_, task);
+    for (casadi_int b=0; b<m->b.size(); ++b) {
+      if (flag[b]) {
+        if (verbose_) casadi_message("Factorization of branch " + str(b) + " failed");
+        return 1;
+      }
+    }
+    if (nc==0) return 0;
+
+    // Schur complement: A_cc - sum_i A_ci*inv(A_ii)*A_ic
+    for (casadi_int k=0; k<nc*nc; ++k) m->s[k] = map_cc_[k]<0 ? 0 : A[map_cc_[k]];
+    for (auto&& mb : m->b) {
+      for (casadi_int k=0; k<nc*nc; ++k) m->s[k] -= mb.s[k];
+    }
+    return linsol_s_.nfact(get_ptr(m->s), m->mem_s);
+  }
+
+  int LinsolSchur::solve(void* mem, const double* A, double* x, casadi_int nrhs,
+                         bool tr) const {
+    auto m = static_cast<LinsolSchurMemory*>(mem);
+    casadi_int n = nrow(), nc = coupling_.size(), nb = m->b.size();
+    m->xc.resize(nc*nrhs);
+    std::vector<int> flag(nb, 0);
+
+    // Gather the right-hand sides of the coupling variables
+    for (casadi_int r=0; r<nrhs; ++r) {
+      for (casadi_int c=0; c<nc; ++c) m->xc[c+r*nc] = x[coupling_[c]+r*n];
+    }
+
+    // Reduced right-hand side of the coupling variables, branch by branch
+    auto task1 = [&](casadi_int b, casadi_int t) {
+      LinsolSchurBranch& mb = m->b[b];
+      const std::vector<casadi_int>& br = branch_[b];
+      casadi_int ni = br.size();
+      mb.y.resize(ni*nrhs);
+      mb.t.resize(nc*nrhs);
+      for (casadi_int r=0; r<nrhs; ++r) {
+        for (casadi_int j=0; j<ni; ++j) mb.y[j+r*ni] = x[br[j]+r*n];
+      }
+      std::fill(mb.t.begin(), mb.t.end(), 0);
+      if (tr) {
+        // t = W'*b_i
+        for (casadi_int r=0; r<nrhs; ++r) {
+          for (casadi_int c=0; c<nc; ++c) {
+            for (casadi_int j=0; j<ni; ++j) mb.t[c+r*nc] += mb.w[j+c*ni]*mb.y[j+r*ni];
+          }
+        }
+      } else {
+        // y = inv(A_ii)*b_i, t = A_ci*y
+        if (linsol_[b].solve(get_ptr(mb.a_ii), get_ptr(mb.y), nrhs, false, mb.mem)) {
+          flag[b] = 1;
+          return;
+        }
+        const casadi_int *colind = sp_ci_[b].colind(), *row = sp_ci_[b].row();
+        for (casadi_int r=0; r<nrhs; ++r) {
+          for (casadi_int j=0; j<ni; ++j) {
+            for (casadi_int k=colind[j]; k<colind[j+1]; ++k) {
+              mb.t[row[k]+r*nc] += mb.a_ci[k]*mb.y[j+r*ni];
+            }
+          }
+        }
+      }
+    };
+    ThreadPool::run(nb, max_num_threads_, task1);
+    for (casadi_int b=0; b<nb; ++b) if (flag[b]) return 1;
+
+    // Solve for the coupling variables
+    if (nc>0) {
+      for (auto&& mb : m->b) {
+        for (casadi_int k=0; k<nc*nrhs; ++k) m->xc[k] -= mb.t[k];
+      }
+      if (linsol_s_.solve(get_ptr(m->s), get_ptr(m->xc), nrhs, tr, m->mem_s)) return 1;
+    }
+
+    // Back substitution, branch by branch
+    auto task2 = [&](casadi_int b, casadi_int t) {
+      LinsolSchurBranch& mb = m->b[b];
+      const std::vector<casadi_int>& br = branch_[b];
+      casadi_int ni = br.size();
+      if (tr) {
+        // x_i = inv(A_ii')*(b_i - A_ci'*x_c)
+        const casadi_int *colind = sp_ci_[b].colind(), *row = sp_ci_[b].row();
+        for (casadi_int r=0; r<nrhs; ++r) {
+          for (casadi_int j=0; j<ni; ++j) {
+            for (casadi_int k=colind[j]; k<colind[j+1]; ++k) {
+              mb.y[j+r*ni] -= mb.a_ci[k]*m->xc[row[k]+r*nc];
+            }
+          }
+        }
+        if (linsol_[b].solve(get_ptr(mb.a_ii), get_ptr(mb.y), nrhs, true, mb.mem)) {
+          flag[b] = 1;
+          return;
+        }
+      } else {
+        // x_i = y - W*x_c
+        for (casadi_int r=0; r<nrhs; ++r) {
+          for (casadi_int c=0; c<nc; ++c) {
+            for (casadi_int j=0; j<ni; ++j) mb.y[j+r*ni] -= mb.w[j+c*ni]*m->xc[c+r*nc];
+          }
+        }
+      }
+      for (casadi_int r=0; r<nrhs; ++r) {
+        for (casadi_int j=0; j<ni; ++j) x[br[j]+r*n] = mb.y[j+r*ni];
+      }
+    };
+    ThreadPool::run(nb, max_num_threads_, task2);
+    for (casadi_int b=0; b<nb; ++b) if (flag[b]) return 1;
+
+    // Scatter the coupling variables
+    for (casadi_int r=0; r<nrhs; ++r) {
+      for (casadi_int c=0; c<nc; ++c) x[coupling_[c]+r*n] = m->xc[c+r*nc];
+    }
+    return 0;
+  }
+
+} // namespace casadi
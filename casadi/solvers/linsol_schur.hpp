@@ -0,0 +1,148 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#ifndef CASADI_LINSOL_SCHUR_HPP
+#define CASADI_LINSOL_SCHUR_HPP
+
+/** \defgroup plugin_Linsol_schur
+  * Linear solver for block-bordered systems, e.g. the KKT systems of multistage
+  * problems on a scenario tree. Variables not listed in the option 'coupling'
+  * decompose into independent diagonal blocks (branches), which are factorized
+  * in parallel. The coupling variables are then solved for from the dense
+  * Schur complement.
+*/
+
+/** \pluginsection{Linsol,schur} */
+
+/// \cond INTERNAL
+#include "casadi/core/linsol_internal.hpp"
+#include <casadi/solvers/casadi_linsol_schur_export.h>
+
+namespace casadi {
+  /** \brief Memory for one branch */
+  struct CASADI_LINSOL_SCHUR_EXPORT LinsolSchurBranch {
+    // Memory in the branch linear solver
+    casadi_int mem;
+    // Nonzeros of A_ii, A_ic and A_ci
+    std::vector<double> a_ii, a_ic, a_ci;
+    // W = inv(A_ii)*A_ic and A_ci*W, dense
+    std::vector<double> w, s;
+    // Work vectors for the solve
+    std::vector<double> y, t;
+  };
+
+  struct CASADI_LINSOL_SCHUR_EXPORT LinsolSchurMemory : public LinsolMemory {
+    std::vector<LinsolSchurBranch> b;
+    // Memory in the Schur complement linear solver
+    casadi_int mem_s;
+    // Schur complement, dense, and the coupling part of the solution
+    std::vector<double> s, xc;
+  };
+
+  /** \brief \pluginbrief{LinsolInternal,schur}
+   * @copydoc LinsolInternal_doc
+   * @copydoc plugin_LinsolInternal_schur
+   */
+  class CASADI_LINSOL_SCHUR_EXPORT LinsolSchur : public LinsolInternal {
+  public:
+
+    // Create a linear solver given a sparsity pattern
+    LinsolSchur(const std::string& name, const Sparsity& sp);
+
+    /** \brief  Create a new LinsolInternal */
+    static LinsolInternal* creator(const std::string& name, const Sparsity& sp) {
+      return new LinsolSchur(name, sp);
+    }
+
+    // Destructor
+    ~LinsolSchur() override;
+
+    ///@{
+    /** \brief Options */
+    static Options options_;
+    const Options& get_options() const override { return options_;}
+    ///@}
+
+    // Initialize the solver
+    void init(const Dict& opts) override;
+
+    /** \brief Create memory block */
+    void* alloc_mem() const override { return new LinsolSchurMemory();}
+
+    /** \brief Initalize memory block */
+    int init_mem(void* mem) const override;
+
+    /** \brief Free memory block */
+    void free_mem(void *mem) const override;
+
+    // Symbolic factorization
+    int sfact(void* mem, const double* A) const override;
+
+    // Factorize the linear system
+    int nfact(void* mem, const double* A) const override;
+
+    // Solve the linear system
+    int solve(void* mem, const double* A, double* x, casadi_int nrhs, bool tr) const override;
+
+    /// A documentation string
+    static const std::string meta_doc;
+
+    // Get name of the plugin
+    const char* plugin_name() const override { return "schur";}
+
+    // Get name of the class
+    std::string class_name() const override { return "LinsolSchur";}
+
+    // Coupling variables
+    std::vector<casadi_int> coupling_;
+
+    // Linear solver for the branches and the Schur complement
+    std::string linear_solver_;
+    Dict linear_solver_options_;
+
+    // Maximum number of threads
+    casadi_int max_num_threads_;
+
+    // Variables of each branch
+    std::vector<std::vector<casadi_int> > branch_;
+
+    // Sparsity patterns and nonzeros of A_ii, A_ic and A_ci for each branch
+    std::vector<Sparsity> sp_ii_, sp_ic_, sp_ci_;
+    std::vector<std::vector<casadi_int> > map_ii_, map_ic_, map_ci_;
+
+    // Nonzeros of A_cc, dense
+    std::vector<casadi_int> map_cc_;
+
+    // Linear solvers for the branches and the Schur complement
+    std::vector<Linsol> linsol_;
+    Linsol linsol_s_;
+  };
+
+} // namespace casadi
+
+/// \endcond
+
+#endif // CASADI_LINSOL_SCHUR_HPP
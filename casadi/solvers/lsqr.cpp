@@ -24,6 +24,7 @@
 
 
 #include "lsqr.hpp"
+#include "casadi/core/thread_pool.hpp"
 
 #ifdef WITH_DL
 #include <cstdlib>
@@ -50,29 +51,227 @@ namespace casadi {
 
   Lsqr::Lsqr(const std::string& name, const Sparsity& sp) :
     LinsolInternal(name, sp) {
+
+    // Default options
+    preconditioner_ = "none";
+    max_num_threads_ = 1;
+    tol_ = 1e-15;
+    max_iter_ = 10000;
   }
 
   Lsqr::~Lsqr() {
     clear_mem();
   }
 
+  Options Lsqr::options_
+  = {{&FunctionInternal::options_},
+     {{"preconditioner",
+       {OT_STRING,
+        "Right preconditioner: 'none' (default), 'jacobi' (scale by the column norms) "
+        "or 'ichol' (incomplete Cholesky factorization of the normal matrix, without fill-in)"}},
+      {"max_num_threads",
+       {OT_INT,
+        "Calculate the sparse matrix-vector products in parallel, "
+        "using at most this many threads [1]"}},
+      {"mv",
+       {OT_FUNCTION,
+        "Matrix-free mode: Function calculating A*x. The nonzeros of A passed to the "
+        "solver are then ignored. Requires 'mtv'"}},
+      {"mtv",
+       {OT_FUNCTION,
+        "Matrix-free mode: Function calculating A'*y. Requires 'mv'"}},
+      {"tol",
+       {OT_DOUBLE,
+        "Relative tolerance for the residual and the normal equations [1e-15]"}},
+      {"max_iter",
+       {OT_INT,
+        "Maximum number of iterations [10000]"}}
+     }
+  };
+
+  void Lsqr::init(const Dict& opts) {
+    // Call the init method of the base class
+    LinsolInternal::init(opts);
+
+    // Read options
+    for (auto&& op : opts) {
+      if (op.first=="preconditioner") {
+        preconditioner_ = op.second.to_string();
+      } else if (op.first=="max_num_threads") {
+        max_num_threads_ = op.second;
+      } else if (op.first=="mv") {
+        mv_ = op.second;
+      } else if (op.first=="mtv") {
+        mtv_ = op.second;
+      } else if (op.first=="tol") {
+        tol_ = op.second;
+      } else if (op.first=="max_iter") {
+        max_iter_ = op.second;
+      }
+    }
+    casadi_assert(preconditioner_=="none" || preconditioner_=="jacobi"
+                  || preconditioner_=="ichol",
+                  "Unknown preconditioner '" + preconditioner_ + "'");
+    casadi_assert(max_num_threads_>=1, "Option 'max_num_threads' must be positive");
+
+    // Matrix-free mode
+    casadi_assert(mv_.is_null()==mtv_.is_null(), "Options 'mv' and 'mtv' must be given together");
+    if (!mv_.is_null()) {
+      for (const Function& f : {mv_, mtv_}) {
+        casadi_assert(f.n_in()==1 && f.n_out()==1
+                      && f.nnz_in(0)==ncol() && f.nnz_out(0)==ncol(),
+                      "'" + f.name() + "' must map a vector of length " + str(ncol())
+                      + " to a vector of the same length");
+      }
+      casadi_assert(preconditioner_=="none",
+                    "Preconditioning requires the matrix, it cannot be combined with 'mv'");
+    }
+
+    // Rows of A as columns, for the products with A
+    sp_tr_ = sp_.transpose(tr_map_);
+
+    // Pattern of the normal matrix, with the diagonal for the incomplete factorization
+    if (preconditioner_=="ichol") {
+      sp_n_[0] = Sparsity::mtimes(sp_.T(), sp_) + Sparsity::diag(ncol());
+      sp_n_[1] = Sparsity::mtimes(sp_, sp_.T()) + Sparsity::diag(nrow());
+      for (casadi_int k=0; k<2; ++k) sp_lt_[k] = Sparsity::triu(sp_n_[k], false);
+    }
+  }
+
   int Lsqr::init_mem(void* mem) const {
     if (LinsolInternal::init_mem(mem)) return 1;
     auto m = static_cast<LsqrMemory*>(mem);
 
     // Temporary storage
-    m->w.resize(nrow()+4*ncol());
-    m->A.resize(sp_.nnz());
+    m->w.resize(nrow()+6*ncol());
+    if (mv_.is_null()) {
+      m->A.resize(sp_.nnz());
+      m->At.resize(sp_.nnz());
+    } else {
+      // Work vectors for the operators, followed by the result
+      size_t sz_arg = std::max(mv_.sz_arg(), mtv_.sz_arg());
+      size_t sz_res = std::max(mv_.sz_res(), mtv_.sz_res());
+      m->arg.resize(sz_arg);
+      m->res.resize(sz_res);
+      m->fiw.resize(std::max(mv_.sz_iw(), mtv_.sz_iw()));
+      m->fw.resize(std::max(mv_.sz_w(), mtv_.sz_w()) + ncol());
+    }
+    m->pc_valid[0] = m->pc_valid[1] = false;
     return 0;
   }
 
   int Lsqr::nfact(void* mem, const double* A) const {
     auto m = static_cast<LsqrMemory*>(mem);
 
+    // Matrix-free: nothing to store
+    if (!mv_.is_null()) return 0;
+
     std::copy(A, A+m->A.size(), get_ptr(m->A));
+    for (casadi_int k=0; k<m->At.size(); ++k) m->At[k] = A[tr_map_[k]];
+    // Preconditioners are recalculated on demand
+    m->pc_valid[0] = m->pc_valid[1] = false;
     return 0;
   }
 
+  void Lsqr::apply(LsqrMemory* m, const double* x, double* y, bool tr, bool adj) const {
+    if (!mv_.is_null()) {
+      // Matrix-free: B*x = A*x and B'*x = A'*x, or the other way around if tr
+      const Function& f = tr==adj ? mv_ : mtv_;
+      double* r = get_ptr(m->fw) + m->fw.size() - ncol();
+      m->arg[0] = x;
+      m->res[0] = r;
+      f(get_ptr(m->arg), get_ptr(m->res), get_ptr(m->fiw), get_ptr(m->fw));
+      for (casadi_int i=0; i<ncol(); ++i) y[i] += r[i];
+      return;
+    }
+    // Dot products with the columns of B' (or of B if adj), which are independent
+    bool use_a = tr!=adj;
+    const Sparsity& sp = use_a ? sp_ : sp_tr_;
+    const double* nz = use_a ? get_ptr(m->A) : get_ptr(m->At);
+    const casadi_int *colind = sp.colind(), *row = sp.row();
+    casadi_int ncol = sp.size2();
+    casadi_int nt = std::min(max_num_threads_, ncol);
+    ThreadPool::run(nt, nt, [&](casadi_int t, casadi_int) {
+      for (casadi_int c=t*ncol/nt; c<(t+1)*ncol/nt; ++c) {
+        double s = 0;
+        for (casadi_int k=colind[c]; k<colind[c+1]; ++k) s += nz[k]*x[row[k]];
+        y[c] += s;
+      }
+    });
+  }
+
+  void Lsqr::precondition(LsqrMemory* m, bool tr) const {
+    casadi_int ind = tr ? 1 : 0;
+    // Columns of B
+    const Sparsity& sp_b = tr ? sp_tr_ : sp_;
+    const double* b = tr ? get_ptr(m->At) : get_ptr(m->A);
+    const casadi_int *colind = sp_b.colind(), *row = sp_b.row();
+    casadi_int n = sp_b.size2();
+    std::vector<double>& d = m->pc_d[ind];
+    d.resize(n);
+    if (preconditioner_=="jacobi") {
+      // Scale by the column norms, M = diag(|B(:,c)|)
+      for (casadi_int c=0; c<n; ++c) {
+        double s = 0;
+        for (casadi_int k=colind[c]; k<colind[c+1]; ++k) s += b[k]*b[k];
+        d[c] = s>0 ? sqrt(s) : 1;
+      }
+    } else {
+      // Nonzeros of the normal matrix B'*B
+      const Sparsity& sp_n = sp_n_[ind];
+      const casadi_int *n_colind = sp_n.colind(), *n_row = sp_n.row();
+      std::vector<double> nz(sp_n.nnz()), w(sp_b.size1(), 0);
+      double dmax = 0;
+      for (casadi_int c=0; c<n; ++c) {
+        for (casadi_int k=colind[c]; k<colind[c+1]; ++k) w[row[k]] = b[k];
+        for (casadi_int k=n_colind[c]; k<n_colind[c+1]; ++k) {
+          casadi_int r = n_row[k];
+          for (casadi_int k2=colind[r]; k2<colind[r+1]; ++k2) nz[k] += b[k2]*w[row[k2]];
+          if (r==c) dmax = std::max(dmax, nz[k]);
+        }
+        for (casadi_int k=colind[c]; k<colind[c+1]; ++k) w[row[k]] = 0;
+      }
+      // Incomplete LDL' without fill-in, shifting the diagonal on breakdown
+      std::vector<casadi_int> p = range(n);
+      std::vector<double> nz_shift(nz);
+      std::vector<double>& lt = m->pc_lt[ind];
+      lt.resize(sp_lt_[ind].nnz());
+      w.resize(n);
+      double shift = 0;
+      for (casadi_int iter=0; ; ++iter) {
+        casadi_ldl(sp_n, get_ptr(nz_shift), sp_lt_[ind], get_ptr(lt), get_ptr(d),
+                   get_ptr(p), get_ptr(w));
+        if (std::all_of(d.begin(), d.end(), [](double e) { return e>0;})) break;
+        casadi_assert(iter<20, "Incomplete Cholesky factorization failed");
+        shift = shift==0 ? (dmax>0 ? 1e-8*dmax : 1) : 10*shift;
+        if (verbose_) casadi_message("Incomplete Cholesky breakdown, shift " + str(shift));
+        for (casadi_int c=0; c<n; ++c) {
+          for (casadi_int k=n_colind[c]; k<n_colind[c+1]; ++k) {
+            nz_shift[k] = n_row[k]==c ? nz[k] + shift : nz[k];
+          }
+        }
+      }
+      // M = sqrt(D)*L'
+      for (double& e : d) e = sqrt(e);
+    }
+    m->pc_valid[ind] = true;
+  }
+
+  void Lsqr::apply_pc(LsqrMemory* m, double* x, bool tr, bool adj) const {
+    casadi_int ind = tr ? 1 : 0;
+    const double* d = get_ptr(m->pc_d[ind]);
+    casadi_int n = m->pc_d[ind].size();
+    if (preconditioner_=="ichol" && adj) {
+      // Solve for L
+      casadi_ldl_trs(sp_lt_[ind], get_ptr(m->pc_lt[ind]), x, 1);
+    }
+    for (casadi_int i=0; i<n; ++i) x[i] /= d[i];
+    if (preconditioner_=="ichol" && !adj) {
+      // Solve for L'
+      casadi_ldl_trs(sp_lt_[ind], get_ptr(m->pc_lt[ind]), x, 0);
+    }
+  }
+
 
   void sym_ortho(double a, double b, double& cs, double&sn, double& rho) {
     if (b == 0) {
@@ -96,19 +295,15 @@ namespace casadi {
     }
   }
 
-  casadi_int solve_(void* mem, const Sparsity& sp, double* x, bool tr) {
-    auto m = static_cast<LsqrMemory*>(mem);
-
-    const double*A = get_ptr(m->A);
-
-    casadi_int m_ = sp.size1();
-    casadi_int n_ = sp.size2();
+  int Lsqr::solve_single(LsqrMemory* m, double* x, bool tr) const {
+    casadi_int m_ = sp_.size1();
+    casadi_int n_ = sp_.size2();
 
     double damp = 0;
-    double atol=1e-15;
-    double btol=1e-15;
+    double atol=tol_;
+    double btol=tol_;
     double conlim=1e8;
-    casadi_int iter_lim = 10000;
+    casadi_int iter_lim = max_iter_;
 
 
     double* w = get_ptr(m->w);
@@ -134,13 +329,31 @@ namespace casadi {
     double *xx = w; w+= n_; fill_n(xx, n_, 0.0);
     double *ww = w; w+= n_; fill_n(v, n_, 0.0);
     double *dk = w; w+= n_;
+    double *t = w; w+= n_;
+
+    // Preconditioned operator B/M (or its transpose if adj), added to y
+    bool pc = preconditioner_!="none";
+    if (pc && !m->pc_valid[tr]) precondition(m, tr);
+    auto op = [&](const double* x, double* y, bool adj) {
+      if (!pc) return apply(m, x, y, tr, adj);
+      if (adj) {
+        fill_n(t, n_, 0.0);
+        apply(m, x, t, tr, true);
+        apply_pc(m, t, tr, true);
+        for (casadi_int i=0; i<n_; ++i) y[i] += t[i];
+      } else {
+        std::copy(x, x+n_, t);
+        apply_pc(m, t, tr, false);
+        apply(m, t, y, tr, false);
+      }
+    };
 
     double alpha = 0;
     double beta = casadi_norm_2(m_, u);
 
     if (beta>0) {
       for (casadi_int i=0;i<m_;++i) u[i]*=1/beta;
-      casadi_mv(A, sp, u, v, !tr);
+      op(u, v, true);
       alpha = casadi_norm_2(n_, v);
     }
 
@@ -172,14 +385,14 @@ namespace casadi {
     while (itn<iter_lim) {
       itn++;
       for (casadi_int i=0;i<m_;++i) u[i]*=-alpha;
-      casadi_mv(A, sp, v, u, tr);
+      op(v, u, false);
       beta = casadi_norm_2(m_, u);
 
       if (beta>0) {
         for (casadi_int i=0;i<m_;++i) u[i]*=1/beta;
         anorm = sqrt(anorm*anorm + alpha*alpha+beta*beta+damp*damp);
         for (casadi_int i=0;i<n_;++i) v[i]*=-beta;
-        casadi_mv(A, sp, u, v, !tr);
+        op(u, v, true);
         alpha = casadi_norm_2(n_, v);
         if (alpha>0) for (casadi_int i=0;i<n_;++i) v[i]*=1/alpha;
       }
@@ -251,17 +464,19 @@ namespace casadi {
       if (istop != 0) break;
 
     }
+    // Undo the preconditioning
+    if (pc) apply_pc(m, xx, tr, false);
     std::copy(xx, xx+m_, x);
     return 0;
   }
 
   int Lsqr::solve(void* mem, const double* A, double* x, casadi_int nrhs, bool tr) const {
-    //auto m = static_cast<LsqrMemory*>(mem);
+    auto m = static_cast<LsqrMemory*>(mem);
 
     casadi_int n_ = ncol();
 
     for (casadi_int i=0; i<nrhs;++i) {
-      if (solve_(mem, sp_, x+i*n_, tr)) return 1;
+      if (solve_single(m, x+i*n_, tr)) return 1;
     }
     return 0;
   }
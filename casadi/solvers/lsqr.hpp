@@ -49,6 +49,19 @@ namespace casadi {
     std::vector<double> w;
 
     std::vector<double> A;
+
+    // Nonzeros of the transpose of A
+    std::vector<double> At;
+
+    // Work vectors for the matrix-free operators
+    std::vector<double*> res;
+    std::vector<casadi_int> fiw;
+    std::vector<double> fw;
+
+    // Preconditioners for the system with A and with A', calculated on demand
+    bool pc_valid[2];
+    // Jacobi: column norms, incomplete Cholesky: D and the nonzeros of L'
+    std::vector<double> pc_d[2], pc_lt[2];
   };
 
   /** \brief \pluginbrief{Linsol,symbolicqr}
@@ -67,7 +80,7 @@ namespace casadi {
     ~Lsqr() override;
 
     // Get name of the plugin
-    const char* plugin_name() const override { return "symbolicqr";}
+    const char* plugin_name() const override { return "lsqr";}
 
     // Name of the class
     std::string class_name() const override { return "Lsqr";}
@@ -77,6 +90,15 @@ namespace casadi {
       return new Lsqr(name, sp);
     }
 
+    ///@{
+    /** \brief Options */
+    static Options options_;
+    const Options& get_options() const override { return options_;}
+    ///@}
+
+    // Initialize
+    void init(const Dict& opts) override;
+
     /** \brief Create memory block */
     void* alloc_mem() const override { return new LsqrMemory();}
 
@@ -92,8 +114,40 @@ namespace casadi {
     // Solve the linear system
     int solve(void* mem, const double* A, double* x, casadi_int nrhs, bool tr) const override;
 
+    // Solve for a single right-hand side
+    int solve_single(LsqrMemory* m, double* x, bool tr) const;
+
+    // y += B*x, or y += B'*x if adj, with B = A' if tr and A otherwise
+    void apply(LsqrMemory* m, const double* x, double* y, bool tr, bool adj) const;
+
+    // Calculate the preconditioner M for B, cf. apply
+    void precondition(LsqrMemory* m, bool tr) const;
+
+    // x <- M\x, or x <- M'\x if adj
+    void apply_pc(LsqrMemory* m, double* x, bool tr, bool adj) const;
+
     /// A documentation string
     static const std::string meta_doc;
+
+    // Preconditioner: "none", "jacobi" or "ichol"
+    std::string preconditioner_;
+
+    // Maximum number of threads for the sparse matrix-vector products
+    casadi_int max_num_threads_;
+
+    // Matrix-free mode: A*x and A'*y
+    Function mv_, mtv_;
+
+    // Stopping criteria
+    double tol_;
+    casadi_int max_iter_;
+
+    // Pattern of the transpose of A and the corresponding nonzero mapping
+    Sparsity sp_tr_;
+    std::vector<casadi_int> tr_map_;
+
+    // Patterns of B'*B and its strictly upper triangle, with B as in apply
+    Sparsity sp_n_[2], sp_lt_[2];
   };
 
 } // namespace casadi
@@ -0,0 +1,277 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#include "multistart.hpp"
+#include "casadi/core/thread_pool.hpp"
+
+using namespace std;
+namespace casadi {
+
+  extern "C"
+  int CASADI_NLPSOL_MULTISTART_EXPORT
+      casadi_register_nlpsol_multistart(Nlpsol::Plugin* plugin) {
+    plugin->creator = Multistart::creator;
+    plugin->name = "multistart";
+    plugin->doc = Multistart::meta_doc.c_str();
+    plugin->version = CASADI_VERSION;
+    plugin->options = &Multistart::options_;
+    return 0;
+  }
+
+  extern "C"
+  void CASADI_NLPSOL_MULTISTART_EXPORT casadi_load_nlpsol_multistart() {
+    Nlpsol::registerPlugin(casadi_register_nlpsol_multistart);
+  }
+
+  // Stop flag of the run in the calling thread, if any
+  static thread_local const std::atomic<bool>* multistart_stop = nullptr;
+
+  // Return status of a run
+  enum MultistartRunStatus {RUN_NOT_STARTED, RUN_SUCCEEDED, RUN_FAILED, RUN_ERROR};
+
+  Multistart::Multistart(const std::string& name, const Function& nlp)
+    : Nlpsol(name, nlp) {
+  }
+
+  Multistart::~Multistart() {
+    clear_mem();
+  }
+
+  Options Multistart::options_
+  = {{&Nlpsol::options_},
+     {{"solvers",
+       {OT_STRINGVECTOR,
+        "NLP solvers raced from each initial guess [ipopt]"}},
+      {"solver_options",
+       {OT_DICT,
+        "Options to be passed to the NLP solvers, "
+        "a nested dictionary with the plugin names as keys"}},
+      {"starts",
+       {OT_DOUBLEVECTORVECTOR,
+        "Initial guesses for x in addition to x0"}},
+      {"f_target",
+       {OT_DOUBLE,
+        "Stop the remaining runs once a run succeeds with an objective value "
+        "at most this value. Use inf to stop at the first success [-inf]"}},
+      {"max_num_threads",
+       {OT_INT,
+        "Maximum number of runs in parallel [number of runs]"}}
+     }
+  };
+
+  void Multistart::init(const Dict& opts) {
+    // Call the init method of the base class
+    Nlpsol::init(opts);
+
+    // Default options
+    plugins_ = {"ipopt"};
+    Dict solver_options;
+    f_target_ = -inf;
+    max_num_threads_ = -1;
+
+    // Read user options
+    for (auto&& op : opts) {
+      if (op.first=="solvers") {
+        plugins_ = op.second;
+      } else if (op.first=="solver_options") {
+        solver_options = op.second;
+      } else if (op.first=="starts") {
+        starts_ = op.second;
+      } else if (op.first=="f_target") {
+        f_target_ = op.second;
+      } else if (op.first=="max_num_threads") {
+        max_num_threads_ = op.second;
+        casadi_assert(max_num_threads_>=1, "Option 'max_num_threads' must be positive");
+      }
+    }
+    casadi_assert(!plugins_.empty(), "Option 'solvers' must not be empty");
+    for (auto&& s : starts_) {
+      casadi_assert(s.size()==nx_, "Initial guess in 'starts' has length " + str(s.size())
+                    + ", expected " + str(nx_));
+    }
+    n_run_ = plugins_.size()*(1+starts_.size());
+    if (max_num_threads_<0) max_num_threads_ = n_run_;
+
+    // Callback stopping the abandoned runs
+    std::vector<Sparsity> sp(NLPSOL_NUM_OUT);
+    for (casadi_int i=0; i<NLPSOL_NUM_OUT; ++i) sp[i] = sparsity_out(i);
+    stop_ = Function::create(new MultistartStop(name_ + "_stop", sp), Dict());
+
+    // NLP solvers
+    solvers_.clear();
+    for (auto&& p : plugins_) {
+      Dict opts;
+      auto it = solver_options.find(p);
+      if (it!=solver_options.end()) opts = it->second;
+      opts["iteration_callback"] = stop_;
+      solvers_.push_back(nlpsol(name_ + "_" + p, p, oracle_, opts));
+    }
+  }
+
+  int Multistart::init_mem(void* mem) const {
+    if (Nlpsol::init_mem(mem)) return 1;
+    auto m = static_cast<MultistartMemory*>(mem);
+    m->x0.resize(nx_);
+    m->lam_x0.resize(nx_);
+    m->lam_g0.resize(ng_);
+    m->x_run.resize(n_run_, std::vector<double>(nx_));
+    m->g_run.resize(n_run_, std::vector<double>(ng_));
+    m->lam_x_run.resize(n_run_, std::vector<double>(nx_));
+    m->lam_g_run.resize(n_run_, std::vector<double>(ng_));
+    m->lam_p_run.resize(n_run_, std::vector<double>(np_));
+    m->f_run.resize(n_run_);
+    m->viol.resize(n_run_);
+    m->run_status.resize(n_run_);
+    m->run_arg.resize(n_run_);
+    m->run_res.resize(n_run_);
+    m->run_iw.resize(n_run_);
+    m->run_w.resize(n_run_);
+    for (casadi_int k=0; k<n_run_; ++k) {
+      const Function& s = solvers_[k % solvers_.size()];
+      m->run_arg[k].resize(s.sz_arg());
+      m->run_res[k].resize(s.sz_res());
+      m->run_iw[k].resize(s.sz_iw());
+      m->run_w[k].resize(s.sz_w());
+    }
+    m->best = -1;
+    return 0;
+  }
+
+  int Multistart::solve(void* mem) const {
+    auto m = static_cast<MultistartMemory*>(mem);
+    casadi_int ns = solvers_.size();
+
+    // Initial guesses, the outputs overwrite x, lam_x and lam_g
+    casadi_copy(m->x, nx_, get_ptr(m->x0));
+    casadi_copy(m->lam_x, nx_, get_ptr(m->lam_x0));
+    casadi_copy(m->lam_g, ng_, get_ptr(m->lam_g0));
+
+    // Memory of each run
+    m->stop = false;
+    m->run_mem.resize(n_run_);
+    for (casadi_int k=0; k<n_run_; ++k) m->run_mem[k] = solvers_[k % ns].checkout();
+
+    // Run solver k % ns from initial guess k / ns
+    auto task = [&](casadi_int k, casadi_int t) {
+      m->run_status[k] = RUN_NOT_STARTED;
+      if (m->stop) return;
+      const Function& s = solvers_[k % ns];
+      casadi_int j = k / ns;
+      const double** arg = get_ptr(m->run_arg[k]);
+      double** res = get_ptr(m->run_res[k]);
+      fill_n(arg, NLPSOL_NUM_IN, nullptr);
+      arg[NLPSOL_X0] = j==0 ? get_ptr(m->x0) : get_ptr(starts_[j-1]);
+      arg[NLPSOL_P] = m->p;
+      arg[NLPSOL_LBX] = m->lbx;
+      arg[NLPSOL_UBX] = m->ubx;
+      arg[NLPSOL_LBG] = m->lbg;
+      arg[NLPSOL_UBG] = m->ubg;
+      arg[NLPSOL_LAM_X0] = get_ptr(m->lam_x0);
+      arg[NLPSOL_LAM_G0] = get_ptr(m->lam_g0);
+      res[NLPSOL_X] = get_ptr(m->x_run[k]);
+      res[NLPSOL_F] = &m->f_run[k];
+      res[NLPSOL_G] = get_ptr(m->g_run[k]);
+      res[NLPSOL_LAM_X] = get_ptr(m->lam_x_run[k]);
+      res[NLPSOL_LAM_G] = get_ptr(m->lam_g_run[k]);
+      res[NLPSOL_LAM_P] = get_ptr(m->lam_p_run[k]);
+      multistart_stop = &m->stop;
+      try {
+        s(arg, res, get_ptr(m->run_iw[k]), get_ptr(m->run_w[k]), m->run_mem[k]);
+        bool success = s.stats(m->run_mem[k]).at("success");
+        m->run_status[k] = success ? RUN_SUCCEEDED : RUN_FAILED;
+      } catch(exception& ex) {
+        if (verbose_) casadi_message("Run " + str(k) + " failed: " + string(ex.what()));
+        m->run_status[k] = RUN_ERROR;
+      }
+      multistart_stop = nullptr;
+      if (m->run_status[k]==RUN_ERROR) return;
+      m->viol[k] = fmax(casadi_max_viol(nx_, get_ptr(m->x_run[k]), m->lbx, m->ubx),
+                        casadi_max_viol(ng_, get_ptr(m->g_run[k]), m->lbg, m->ubg));
+      // Good enough?
+      if (m->run_status[k]==RUN_SUCCEEDED && m->f_run[k]<=f_target_) m->stop = true;
+    };
+    ThreadPool::run(n_run_, max_num_threads_, task);
+
+    for (casadi_int k=0; k<n_run_; ++k) solvers_[k % ns].release(m->run_mem[k]);
+
+    // Best run: the lowest objective among the successful runs,
+    // otherwise the smallest constraint violation
+    m->best = -1;
+    for (casadi_int k=0; k<n_run_; ++k) {
+      if (m->run_status[k]==RUN_NOT_STARTED || m->run_status[k]==RUN_ERROR) continue;
+      if (m->best<0) {
+        m->best = k;
+        continue;
+      }
+      bool s = m->run_status[k]==RUN_SUCCEEDED, s_best = m->run_status[m->best]==RUN_SUCCEEDED;
+      if (s!=s_best ? s : s ? m->f_run[k]<m->f_run[m->best] : m->viol[k]<m->viol[m->best]) {
+        m->best = k;
+      }
+    }
+    if (m->best<0) {
+      m->return_status = "All_Runs_Failed";
+      m->success = false;
+      return 1;
+    }
+
+    // Get the solution
+    casadi_int k = m->best;
+    casadi_copy(get_ptr(m->x_run[k]), nx_, m->x);
+    casadi_copy(get_ptr(m->lam_x_run[k]), nx_, m->lam_x);
+    casadi_copy(get_ptr(m->lam_g_run[k]), ng_, m->lam_g);
+    casadi_copy(get_ptr(m->lam_p_run[k]), np_, m->lam_p);
+    casadi_copy(get_ptr(m->g_run[k]), ng_, m->g);
+    m->f = m->f_run[k];
+    m->success = m->run_status[k]==RUN_SUCCEEDED;
+    m->return_status = m->success ? "Solve_Succeeded" : "Best_Run_Failed";
+    return 0;
+  }
+
+  Dict Multistart::get_stats(void* mem) const {
+    Dict stats = Nlpsol::get_stats(mem);
+    auto m = static_cast<MultistartMemory*>(mem);
+    stats["return_status"] = m->return_status;
+    if (m->best>=0) {
+      stats["best_solver"] = plugins_[m->best % solvers_.size()];
+      stats["best_start"] = m->best / static_cast<casadi_int>(solvers_.size());
+    }
+    // Status of each run: "not_started", "succeeded", "failed" or "error"
+    std::vector<std::string> run_status;
+    for (casadi_int s : m->run_status) {
+      run_status.push_back(s==RUN_NOT_STARTED ? "not_started" : s==RUN_SUCCEEDED ? "succeeded"
+                           : s==RUN_FAILED ? "failed" : "error");
+    }
+    stats["run_status"] = run_status;
+    return stats;
+  }
+
+  int MultistartStop::eval(const double** arg, double** res, casadi_int* iw, double* w,
+                           void* mem) const {
+    if (res[0]) res[0][0] = multistart_stop && *multistart_stop ? 1 : 0;
+    return 0;
+  }
+
+} // namespace casadi
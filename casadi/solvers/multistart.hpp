@@ -0,0 +1,175 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#ifndef CASADI_MULTISTART_HPP
+#define CASADI_MULTISTART_HPP
+
+#include "casadi/core/nlpsol_impl.hpp"
+#include <casadi/solvers/casadi_nlpsol_multistart_export.h>
+#include <atomic>
+
+/** \defgroup plugin_Nlpsol_multistart
+ Multi-start and solver racing: solves the NLP with a set of NLP solvers from a
+ set of initial guesses in parallel threads and returns the best solution.
+ Runs that are still active once a solution with the objective below 'f_target'
+ has been found are stopped through their iteration callbacks.
+*/
+
+/** \pluginsection{Nlpsol,multistart} */
+
+/// \cond INTERNAL
+namespace casadi {
+
+  struct CASADI_NLPSOL_MULTISTART_EXPORT MultistartMemory : public NlpsolMemory {
+    // Initial guesses
+    std::vector<double> x0, lam_x0, lam_g0;
+
+    // Solution of each run
+    std::vector<std::vector<double> > x_run, g_run, lam_x_run, lam_g_run, lam_p_run;
+    std::vector<double> f_run, viol;
+    std::vector<casadi_int> run_status;
+
+    // Memory and work vectors of each run
+    std::vector<casadi_int> run_mem;
+    std::vector<std::vector<const double*> > run_arg;
+    std::vector<std::vector<double*> > run_res;
+    std::vector<std::vector<casadi_int> > run_iw;
+    std::vector<std::vector<double> > run_w;
+
+    // Stop the remaining runs
+    std::atomic<bool> stop;
+
+    // Best run, -1 if none
+    casadi_int best;
+    std::string return_status;
+  };
+
+  /** \brief \pluginbrief{Nlpsol,multistart}
+   *  @copydoc NlpSolver_doc
+   *  @copydoc plugin_Nlpsol_multistart
+   */
+  class CASADI_NLPSOL_MULTISTART_EXPORT Multistart : public Nlpsol {
+  public:
+    explicit Multistart(const std::string& name, const Function& nlp);
+    ~Multistart() override;
+
+    // Get name of the plugin
+    const char* plugin_name() const override { return "multistart";}
+
+    // Name of the class
+    std::string class_name() const override { return "Multistart";}
+
+    /** \brief  Create a new NLP Solver */
+    static Nlpsol* creator(const std::string& name, const Function& nlp) {
+      return new Multistart(name, nlp);
+    }
+
+    ///@{
+    /** \brief Options */
+    static Options options_;
+    const Options& get_options() const override { return options_;}
+    ///@}
+
+    /// Get all statistics
+    Dict get_stats(void* mem) const override;
+
+    // Initialize the solver
+    void init(const Dict& opts) override;
+
+    /** \brief Create memory block */
+    void* alloc_mem() const override { return new MultistartMemory();}
+
+    /** \brief Initalize memory block */
+    int init_mem(void* mem) const override;
+
+    /** \brief Free memory block */
+    void free_mem(void *mem) const override { delete static_cast<MultistartMemory*>(mem);}
+
+    // Solve the NLP
+    int solve(void* mem) const override;
+
+    /// A documentation string
+    static const std::string meta_doc;
+
+    // Iteration callback of the solvers, requesting a stop when the run is to be abandoned
+    Function stop_;
+
+    // NLP solvers
+    std::vector<std::string> plugins_;
+    std::vector<Function> solvers_;
+
+    // Initial guesses in addition to x0
+    std::vector<std::vector<double> > starts_;
+
+    // Stop the remaining runs once a run succeeds with an objective below this value
+    double f_target_;
+
+    // Maximum number of threads
+    casadi_int max_num_threads_;
+
+    // Number of runs: all solvers from all initial guesses
+    casadi_int n_run_;
+  };
+
+  /** \brief Iteration callback of the runs of Multistart
+      Returns nonzero if the run in the calling thread is to be stopped */
+  class CASADI_NLPSOL_MULTISTART_EXPORT MultistartStop : public FunctionInternal {
+  public:
+    MultistartStop(const std::string& name, const std::vector<Sparsity>& sp_in)
+      : FunctionInternal(name), sp_in_(sp_in) {}
+
+    // Name of the class
+    std::string class_name() const override { return "MultistartStop";}
+
+    ///@{
+    /** \brief Number of function inputs and outputs */
+    size_t get_n_in() override { return NLPSOL_NUM_OUT;}
+    size_t get_n_out() override { return 1;}
+    ///@}
+
+    /// @{
+    /** \brief Sparsities of function inputs and outputs */
+    Sparsity get_sparsity_in(casadi_int i) override { return sp_in_.at(i);}
+    Sparsity get_sparsity_out(casadi_int i) override { return Sparsity::scalar();}
+    /// @}
+
+    ///@{
+    /** \brief Names of function input and outputs */
+    std::string get_name_in(casadi_int i) override { return nlpsol_out(i);}
+    std::string get_name_out(casadi_int i) override { return "stop";}
+    /// @}
+
+    // Evaluate numerically
+    int eval(const double** arg, double** res, casadi_int* iw, double* w,
+             void* mem) const override;
+
+    // Sparsities of the solver outputs
+    std::vector<Sparsity> sp_in_;
+  };
+
+} // namespace casadi
+/// \endcond
+#endif // CASADI_MULTISTART_HPP
@@ -66,7 +66,22 @@ namespace casadi {
         "Maximum number of Newton iterations to perform before returning."}},
       {"print_iteration",
        {OT_BOOL,
-        "Print information about each iteration"}}
+        "Print information about each iteration"}},
+      {"jacobian_reuse",
+       {OT_BOOL,
+        "Simplified Newton method: keep the factorized Jacobian across iterations "
+        "and across calls, and only update it when the convergence degrades [false]"}},
+      {"max_contraction",
+       {OT_DOUBLE,
+        "Largest ratio between the sizes of consecutive steps before the reused "
+        "Jacobian is updated [0.5]"}},
+      {"broyden",
+       {OT_BOOL,
+        "Broyden's method: when reusing the factorized Jacobian, correct it with a "
+        "rank-one secant update in every iteration. Implies jacobian_reuse [false]"}},
+      {"max_broyden",
+       {OT_INT,
+        "Maximum number of Broyden updates before the Jacobian is re-evaluated [10]"}}
      }
   };
 
@@ -80,6 +95,10 @@ namespace casadi {
     abstol_ = 1e-12;
     abstolStep_ = 1e-12;
     print_iteration_ = false;
+    jacobian_reuse_ = false;
+    max_contraction_ = 0.5;
+    broyden_ = false;
+    max_broyden_ = 10;
 
     // Read options
     for (auto&& op : opts) {
@@ -91,6 +110,14 @@ namespace casadi {
         abstolStep_ = op.second;
       } else if (op.first=="print_iteration") {
         print_iteration_ = op.second;
+      } else if (op.first=="jacobian_reuse") {
+        jacobian_reuse_ = op.second;
+      } else if (op.first=="max_contraction") {
+        max_contraction_ = op.second;
+      } else if (op.first=="broyden") {
+        broyden_ = op.second;
+      } else if (op.first=="max_broyden") {
+        max_broyden_ = op.second;
       }
     }
 
@@ -99,10 +126,23 @@ namespace casadi {
     casadi_assert(!linsol_.is_null(),
                           "Newton::init: linear_solver must be supplied");
 
+    // Broyden updates are corrections of a reused Jacobian
+    if (broyden_) {
+      jacobian_reuse_ = true;
+      casadi_assert(max_broyden_>0, "Newton::init: \"max_broyden\" must be positive");
+    }
+
+    // Residual only, for iterations with a reused Jacobian
+    if (jacobian_reuse_) set_function(oracle_, "f");
+
     // Allocate memory
     alloc_w(n_, true); // x
     alloc_w(n_, true); // F
     alloc_w(sp_jac_.nnz(), true); // J
+    if (broyden_) {
+      alloc_w(n_, true); // f_prev
+      alloc_w(n_, true); // s_prev
+    }
   }
 
  void Newton::set_work(void* mem, const double**& arg, double**& res,
@@ -112,18 +152,34 @@ namespace casadi {
      m->x = w; w += n_;
      m->f = w; w += n_;
      m->jac = w; w += sp_jac_.nnz();
+     if (broyden_) {
+       m->f_prev = w; w += n_;
+       m->s_prev = w; w += n_;
+     }
+  }
+
+  void Newton::solve_jac(NewtonMemory* m, double* jac, double* v) const {
+    linsol_.solve(jac, v, 1, false, m->mem_linsol);
+    // Apply the Broyden updates in the order they were made
+    for (casadi_int k=0; k<m->n_broyden; ++k) {
+      const double* sk = get_ptr(m->broyden_s) + k*n_;
+      casadi_axpy(n_, casadi_dot(n_, sk, v), get_ptr(m->broyden_u) + k*n_, v);
+    }
   }
 
   int Newton::solve(void* mem) const {
     auto m = static_cast<NewtonMemory*>(mem);
 
-    scoped_checkout<Linsol> mem_linsol(linsol_);
-
     // Get the initial guess
     casadi_copy(m->iarg[iin_], n_, m->x);
 
     // Perform the Newton iterations
     m->iter=0;
+    m->nfact=0;
+    m->njac=0;
+    m->nbroyden=0;
+    double step_prev = -1;
+    bool has_prev = false;
     bool success = true;
     while (true) {
       // Break if maximum number of iterations already reached
@@ -134,16 +190,33 @@ namespace casadi {
         break;
       }
 
+      // Break if cancelled or out of time
+      if (m->deadline.expired()) {
+        if (verbose_) casadi_message("Deadline reached.");
+        m->return_status = m->deadline.cancelled() ? "cancelled" : "max_wall_time_reached";
+        success = false;
+        break;
+      }
+
       // Start a new iteration
       m->iter++;
 
-      // Use x to evaluate J
+      // Use x to evaluate J, or only F when the factorization is reused
+      bool new_jac = !jacobian_reuse_ || !m->fact_valid
+        || (broyden_ && m->n_broyden>=max_broyden_);
       copy_n(m->iarg, n_in_, m->arg);
       m->arg[iin_] = m->x;
-      m->res[0] = m->jac;
-      copy_n(m->ires, n_out_, m->res+1);
-      m->res[1+iout_] = m->f;
-      calc_function(m, "jac_f_z");
+      if (new_jac) {
+        m->res[0] = m->jac;
+        copy_n(m->ires, n_out_, m->res+1);
+        m->res[1+iout_] = m->f;
+        calc_function(m, "jac_f_z");
+        m->njac++;
+      } else {
+        copy_n(m->ires, n_out_, m->res);
+        m->res[iout_] = m->f;
+        calc_function(m, "f");
+      }
 
       // Check convergence
       double abstol = 0;
@@ -157,22 +230,57 @@ namespace casadi {
         }
       }
 
-      // Factorize the linear solver with J
-      linsol_.nfact(m->jac, mem_linsol);
-      linsol_.solve(m->jac, m->f, 1, false, mem_linsol);
+      // Factorize the linear solver with J, kept if it is to be reused
+      double* jac = jacobian_reuse_ ? get_ptr(m->jac_fact) : m->jac;
+      if (new_jac) {
+        if (jacobian_reuse_) casadi_copy(m->jac, sp_jac_.nnz(), jac);
+        linsol_.nfact(jac, m->mem_linsol);
+        m->fact_valid = true;
+        m->nfact++;
+        m->n_broyden = 0;
+      } else if (broyden_ && has_prev) {
+        // Broyden update: u = (s - H*y)/(s'*H*y) with y the change in the residual
+        double* u = get_ptr(m->broyden_u) + m->n_broyden*n_;
+        casadi_copy(m->f, n_, u);
+        casadi_axpy(n_, -1., m->f_prev, u);
+        solve_jac(m, jac, u);
+        double den = casadi_dot(n_, m->s_prev, u);
+        if (den!=0) {
+          for (casadi_int i=0; i<n_; ++i) u[i] = (m->s_prev[i] - u[i])/den;
+          casadi_copy(m->s_prev, n_, get_ptr(m->broyden_s) + m->n_broyden*n_);
+          m->n_broyden++;
+          m->nbroyden++;
+        }
+      }
+      if (broyden_) casadi_copy(m->f, n_, m->f_prev);
+      solve_jac(m, jac, m->f);
 
       // Check convergence again
       double abstolStep=0;
+      for (casadi_int i=0; i<n_; ++i) {
+        abstolStep = max(abstolStep, fabs(m->f[i]));
+      }
       if (numeric_limits<double>::infinity() != abstolStep_) {
-        for (casadi_int i=0; i<n_; ++i) {
-          abstolStep = max(abstolStep, fabs(m->f[i]));
-        }
         if (abstolStep <= abstolStep_) {
           if (verbose_) casadi_message("Converged to acceptable tolerance: " + str(abstolStep_));
           break;
         }
       }
 
+      // Too slow convergence with a reused Jacobian: update it at the current x
+      if (!new_jac && step_prev>=0 && abstolStep > max_contraction_*step_prev) {
+        m->fact_valid = false;
+        step_prev = -1;
+        has_prev = false;
+        continue;
+      }
+      step_prev = abstolStep;
+      if (broyden_) {
+        casadi_copy(m->f, n_, m->s_prev);
+        casadi_scal(n_, -1., m->s_prev);
+        has_prev = true;
+      }
+
       if (print_iteration_) {
         // Only print iteration header once in a while
         if (m->iter % 10==0) {
@@ -223,14 +331,35 @@ namespace casadi {
     auto m = static_cast<NewtonMemory*>(mem);
     m->return_status = nullptr;
     m->iter = 0;
+    m->nfact = 0;
+    m->njac = 0;
+    m->mem_linsol = linsol_.checkout();
+    if (jacobian_reuse_) m->jac_fact.resize(sp_jac_.nnz());
+    m->fact_valid = false;
+    if (broyden_) {
+      m->broyden_s.resize(n_*max_broyden_);
+      m->broyden_u.resize(n_*max_broyden_);
+    }
+    m->n_broyden = 0;
+    m->nbroyden = 0;
     return 0;
   }
 
+  void Newton::free_mem(void *mem) const {
+    auto m = static_cast<NewtonMemory*>(mem);
+    linsol_.release(m->mem_linsol);
+    delete m;
+  }
+
   Dict Newton::get_stats(void* mem) const {
     Dict stats = Rootfinder::get_stats(mem);
     auto m = static_cast<NewtonMemory*>(mem);
     stats["return_status"] = m->return_status;
     stats["iter_count"] = m->iter;
+    stats["n_fact"] = m->nfact;
+    stats["n_jac"] = m->njac;
+    stats["n_jac_saved"] = m->iter - m->njac;
+    stats["n_broyden"] = m->nbroyden;
     return stats;
   }
 
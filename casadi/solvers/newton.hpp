@@ -51,6 +51,28 @@ namespace casadi {
     const char* return_status;
     // Number of iterations
     casadi_int iter;
+
+    // Linear solver memory, persistent to reuse the factorization across calls
+    casadi_int mem_linsol;
+
+    // Jacobian of the current factorization
+    std::vector<double> jac_fact;
+
+    // Does the linear solver hold a valid factorization?
+    bool fact_valid;
+
+    // Number of factorizations and of Jacobian evaluations
+    casadi_int nfact, njac;
+
+    // Broyden updates of the inverse of the factorized Jacobian, pairs (s, u) s.t.
+    // the updated inverse H+ = (I + u*s') H, stored columnwise
+    std::vector<double> broyden_s, broyden_u;
+
+    // Number of Broyden updates since the last factorization, and in the last call
+    casadi_int n_broyden, nbroyden;
+
+    // Residual and step of the previous iteration, for the next Broyden update
+    double *f_prev, *s_prev;
   };
 
   /** \brief \pluginbrief{Rootfinder,newton}
@@ -96,7 +118,7 @@ namespace casadi {
     int init_mem(void* mem) const override;
 
     /** \brief Free memory block */
-    void free_mem(void *mem) const override { delete static_cast<NewtonMemory*>(mem);}
+    void free_mem(void *mem) const override;
 
     /** \brief Set the (persistent) work vectors */
     void set_work(void* mem, const double**& arg, double**& res,
@@ -124,6 +146,19 @@ namespace casadi {
     /// If true, each iteration will be printed
     bool print_iteration_;
 
+    /// Simplified Newton method, reusing the factorization while it converges fast enough
+    bool jacobian_reuse_;
+
+    /// Largest ratio between consecutive step sizes before the Jacobian is updated
+    double max_contraction_;
+
+    /// Broyden updates of the reused factorization, at most max_broyden_ of them
+    bool broyden_;
+    casadi_int max_broyden_;
+
+    /// Solve with the factorized Jacobian and the Broyden updates, in place
+    void solve_jac(NewtonMemory* m, double* jac, double* v) const;
+
     bool error_on_;
 
     /// Print iteration header
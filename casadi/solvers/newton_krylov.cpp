@@ -0,0 +1,446 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#include "newton_krylov.hpp"
+
+using namespace std;
+namespace casadi {
+
+  extern "C"
+  int CASADI_ROOTFINDER_NEWTON_KRYLOV_EXPORT
+  casadi_register_rootfinder_newton_krylov(Rootfinder::Plugin* plugin) {
+    plugin->creator = NewtonKrylov::creator;
+    plugin->name = "newton_krylov";
+    plugin->doc = NewtonKrylov::meta_doc.c_str();
+    plugin->version = CASADI_VERSION;
+    plugin->options = &NewtonKrylov::options_;
+    return 0;
+  }
+
+  extern "C"
+  void CASADI_ROOTFINDER_NEWTON_KRYLOV_EXPORT casadi_load_rootfinder_newton_krylov() {
+    Rootfinder::registerPlugin(casadi_register_rootfinder_newton_krylov);
+  }
+
+  NewtonKrylov::NewtonKrylov(const std::string& name, const Function& f)
+    : Rootfinder(name, f) {
+  }
+
+  NewtonKrylov::~NewtonKrylov() {
+    clear_mem();
+  }
+
+  Options NewtonKrylov::options_
+  = {{&Rootfinder::options_},
+     {{"abstol",
+       {OT_DOUBLE,
+        "Stopping criterion tolerance on max(|F|) [1e-12]"}},
+      {"abstolStep",
+       {OT_DOUBLE,
+        "Stopping criterion tolerance on step size [1e-12]"}},
+      {"max_iter",
+       {OT_INT,
+        "Maximum number of Newton iterations to perform before returning [1000]"}},
+      {"krylov_dim",
+       {OT_INT,
+        "Number of GMRES iterations before a restart, at most the number of unknowns [20]"}},
+      {"max_restart",
+       {OT_INT,
+        "Maximum number of GMRES restarts per Newton iteration [10]"}},
+      {"eta",
+       {OT_DOUBLE,
+        "Relative tolerance on the residual of the linear system in each Newton "
+        "iteration [1e-6]"}},
+      {"preconditioner",
+       {OT_FUNCTION,
+        "Right preconditioner: a function with the inputs of the residual function "
+        "followed by a vector v, returning an approximation of J^(-1) v"}},
+      {"print_iteration",
+       {OT_BOOL,
+        "Print information about each iteration"}}
+     }
+  };
+
+  void NewtonKrylov::init(const Dict& opts) {
+
+    // Call the base class initializer
+    Rootfinder::init(opts);
+
+    // Default options
+    max_iter_ = 1000;
+    abstol_ = 1e-12;
+    abstolStep_ = 1e-12;
+    krylov_dim_ = 20;
+    max_restart_ = 10;
+    eta_ = 1e-6;
+    print_iteration_ = false;
+
+    // Read options
+    for (auto&& op : opts) {
+      if (op.first=="max_iter") {
+        max_iter_ = op.second;
+      } else if (op.first=="abstol") {
+        abstol_ = op.second;
+      } else if (op.first=="abstolStep") {
+        abstolStep_ = op.second;
+      } else if (op.first=="krylov_dim") {
+        krylov_dim_ = op.second;
+      } else if (op.first=="max_restart") {
+        max_restart_ = op.second;
+      } else if (op.first=="eta") {
+        eta_ = op.second;
+      } else if (op.first=="preconditioner") {
+        prec_ = op.second;
+      } else if (op.first=="print_iteration") {
+        print_iteration_ = op.second;
+      }
+    }
+
+    casadi_assert(krylov_dim_>0, "NewtonKrylov: \"krylov_dim\" must be positive");
+    casadi_assert(max_restart_>=0, "NewtonKrylov: \"max_restart\" must be nonnegative");
+    krylov_dim_ = std::min(krylov_dim_, n_);
+
+    // Residual and its directional derivatives, the Jacobian is never evaluated
+    set_function(oracle_, "f");
+    fwd_ = oracle_.forward(1);
+    set_function(fwd_, "fwd_f");
+
+    // Preconditioner
+    if (!prec_.is_null()) {
+      casadi_assert(prec_.n_in()==n_in_+1 && prec_.n_out()==1,
+        "NewtonKrylov: the preconditioner must have " + str(n_in_+1) + " inputs "
+        "and one output, got " + str(prec_.n_in()) + " and " + str(prec_.n_out()));
+      for (casadi_int i=0; i<n_in_; ++i) {
+        casadi_assert(prec_.sparsity_in(i)==oracle_.sparsity_in(i),
+          "NewtonKrylov: input " + str(i) + " of the preconditioner has the wrong sparsity");
+      }
+      casadi_assert(prec_.sparsity_in(n_in_)==oracle_.sparsity_in(iin_)
+                    && prec_.sparsity_out(0)==oracle_.sparsity_in(iin_),
+        "NewtonKrylov: the preconditioner must map a dense vector of length " + str(n_)
+        + " onto another");
+      set_function(prec_, "prec");
+    }
+
+    // Allocate memory
+    alloc_w(n_, true); // x
+    alloc_w(n_, true); // f
+    alloc_w(n_, true); // dx
+    alloc_w(n_, true); // z
+    alloc_w(n_*(krylov_dim_+1), true); // Krylov basis
+    alloc_w((krylov_dim_+1)*krylov_dim_, true); // Hessenberg matrix
+    alloc_w(krylov_dim_, true); // Givens cosines
+    alloc_w(krylov_dim_, true); // Givens sines
+    alloc_w(krylov_dim_+1, true); // Rotated right-hand side
+  }
+
+  void NewtonKrylov::set_work(void* mem, const double**& arg, double**& res,
+                              casadi_int*& iw, double*& w) const {
+    Rootfinder::set_work(mem, arg, res, iw, w);
+    auto m = static_cast<NewtonKrylovMemory*>(mem);
+    m->x = w; w += n_;
+    m->f = w; w += n_;
+    m->dx = w; w += n_;
+    m->z = w; w += n_;
+    m->gm.n = n_;
+    m->gm.m = krylov_dim_;
+    m->gm.v = w; w += n_*(krylov_dim_+1);
+    m->gm.h = w; w += (krylov_dim_+1)*krylov_dim_;
+    m->gm.c = w; w += krylov_dim_;
+    m->gm.s = w; w += krylov_dim_;
+    m->gm.g = w; w += krylov_dim_+1;
+  }
+
+  void NewtonKrylov::jtimes(NewtonKrylovMemory* m, const double* z, double* jz) const {
+    // Nondifferentiated inputs and outputs
+    copy_n(m->iarg, n_in_, m->arg);
+    m->arg[iin_] = m->x;
+    copy_n(m->ires, n_out_, m->arg + n_in_);
+    m->arg[n_in_ + iout_] = m->f;
+    // Seed in the direction of the unknown only
+    fill_n(m->arg + n_in_ + n_out_, n_in_, static_cast<const double*>(nullptr));
+    m->arg[n_in_ + n_out_ + iin_] = z;
+    fill_n(m->res, n_out_, static_cast<double*>(nullptr));
+    m->res[iout_] = jz;
+    calc_function(m, "fwd_f");
+    m->n_jtimes++;
+  }
+
+  void NewtonKrylov::precondition(NewtonKrylovMemory* m, const double* v, double* z) const {
+    if (prec_.is_null()) {
+      casadi_copy(v, n_, z);
+    } else {
+      copy_n(m->iarg, n_in_, m->arg);
+      m->arg[iin_] = m->x;
+      m->arg[n_in_] = v;
+      m->res[0] = z;
+      calc_function(m, "prec");
+    }
+  }
+
+  int NewtonKrylov::solve(void* mem) const {
+    auto m = static_cast<NewtonKrylovMemory*>(mem);
+    casadi_gmres_mem<double>* gm = &m->gm;
+
+    // Get the initial guess
+    casadi_copy(m->iarg[iin_], n_, m->x);
+
+    // Perform the Newton iterations
+    m->iter = 0;
+    m->n_jtimes = 0;
+    bool success = true;
+    while (true) {
+      // Break if maximum number of iterations already reached
+      if (m->iter >= max_iter_) {
+        if (verbose_) casadi_message("Max iterations reached.");
+        m->return_status = "max_iteration_reached";
+        success = false;
+        break;
+      }
+
+      // Start a new iteration
+      m->iter++;
+
+      // Evaluate the residual
+      copy_n(m->iarg, n_in_, m->arg);
+      m->arg[iin_] = m->x;
+      copy_n(m->ires, n_out_, m->res);
+      m->res[iout_] = m->f;
+      calc_function(m, "f");
+
+      // Check convergence
+      double abstol = casadi_norm_inf(n_, m->f);
+      if (abstol_!=numeric_limits<double>::infinity() && abstol <= abstol_) {
+        if (verbose_) casadi_message("Converged to acceptable tolerance: " + str(abstol_));
+        break;
+      }
+
+      // Solve J*dx = -F with restarted GMRES, right preconditioned
+      double tol = eta_*casadi_norm_2(n_, m->f), res_lin = 0;
+      casadi_fill(m->dx, n_, 0.);
+      for (casadi_int r=0; r<=max_restart_; ++r) {
+        // Residual of the linear system, -F - J*dx
+        if (r==0) {
+          casadi_copy(m->f, n_, gm->v);
+        } else {
+          jtimes(m, m->dx, gm->v);
+          casadi_axpy(n_, 1., m->f, gm->v);
+        }
+        casadi_scal(n_, -1., gm->v);
+        if (casadi_gmres_start(gm) <= tol) break;
+        // Arnoldi iterations
+        casadi_int k = 0;
+        while (k<krylov_dim_) {
+          precondition(m, gm->v + k*n_, m->z);
+          jtimes(m, m->z, gm->v + (k+1)*n_);
+          res_lin = casadi_gmres_arnoldi(gm, k++);
+          if (res_lin <= tol) break;
+        }
+        // Update the step
+        casadi_gmres_update(gm, k, m->z);
+        precondition(m, m->z, gm->v);
+        casadi_axpy(n_, 1., gm->v, m->dx);
+        if (res_lin <= tol) break;
+      }
+
+      // Check convergence again
+      double abstolStep = casadi_norm_inf(n_, m->dx);
+      if (abstolStep_!=numeric_limits<double>::infinity() && abstolStep <= abstolStep_) {
+        if (verbose_) casadi_message("Converged to acceptable tolerance: " + str(abstolStep_));
+        break;
+      }
+
+      if (print_iteration_) {
+        // Only print iteration header once in a while
+        if (m->iter % 10==1) {
+          print("%5s %10s %10s %10s %8s\n", "iter", "res", "step", "lin_res", "n_jtimes");
+        }
+        print("%5d %10.2e %10.2e %10.2e %8d\n", m->iter, abstol, abstolStep, res_lin,
+              m->n_jtimes);
+      }
+
+      // Update x
+      casadi_axpy(n_, 1., m->dx, m->x);
+    }
+
+    // Get the solution
+    casadi_copy(m->x, n_, m->ires[iout_]);
+
+    if (success) m->return_status = "success";
+    if (verbose_) casadi_message("Newton-Krylov algorithm took " + str(m->iter) + " steps");
+    m->success = success;
+    return 0;
+  }
+
+  void NewtonKrylov::codegen_declarations(CodeGenerator& g) const {
+    g.add_dependency(get_function("f"));
+    g.add_dependency(get_function("fwd_f"));
+    if (!prec_.is_null()) g.add_dependency(get_function("prec"));
+  }
+
+  Dict NewtonKrylov::codegen_footprint(const CodeGenerator& g) const {
+    Dict r = Rootfinder::codegen_footprint(g);
+    // Data dependent loop, bounded by the maximum number of Newton iterations
+    r["control"] = "iterative";
+    r["max_iter"] = max_iter_;
+    return r;
+  }
+
+  void NewtonKrylov::codegen_body(CodeGenerator& g) const {
+    g.add_auxiliary(CodeGenerator::AUX_GMRES);
+    g.add_auxiliary(CodeGenerator::AUX_COPY);
+    g.add_auxiliary(CodeGenerator::AUX_NORM_INF);
+    std::string f = g.add_dependency(get_function("f"));
+    std::string fwd = g.add_dependency(get_function("fwd_f"));
+    std::string prec = prec_.is_null() ? "" : g.add_dependency(get_function("prec"));
+
+    // Persistent work vectors, as in set_work
+    g.local("gm", "struct casadi_gmres_mem");
+    g.local("x", "casadi_real", "*");
+    g.local("f", "casadi_real", "*");
+    g.local("dx", "casadi_real", "*");
+    g.local("z", "casadi_real", "*");
+    casadi_int off = 0;
+    g << "x = w;\n"; off += n_;
+    g << "f = w+" << off << ";\n"; off += n_;
+    g << "dx = w+" << off << ";\n"; off += n_;
+    g << "z = w+" << off << ";\n"; off += n_;
+    g << "gm.n = " << n_ << ";\n";
+    g << "gm.m = " << krylov_dim_ << ";\n";
+    g << "gm.v = w+" << off << ";\n"; off += n_*(krylov_dim_+1);
+    g << "gm.h = w+" << off << ";\n"; off += (krylov_dim_+1)*krylov_dim_;
+    g << "gm.c = w+" << off << ";\n"; off += krylov_dim_;
+    g << "gm.s = w+" << off << ";\n"; off += krylov_dim_;
+    g << "gm.g = w+" << off << ";\n"; off += krylov_dim_+1;
+    std::string w1 = "w+" + str(off);
+
+    // Input pointers with x as the unknown
+    auto set_arg = [&](casadi_int offset) {
+      for (casadi_int i=0; i<n_in_; ++i) {
+        g << "arg[" << offset+i << "] = " << (i==iin_ ? "x" : "arg[" + str(i) + "]") << ";\n";
+      }
+    };
+    // Jacobian times a vector
+    auto jtimes = [&](const std::string& z, const std::string& jz) {
+      set_arg(n_in_);
+      for (casadi_int i=0; i<n_out_; ++i) {
+        g << "arg[" << 2*n_in_+i << "] = " << (i==iout_ ? "f" : "res[" + str(i) + "]")
+          << ";\n";
+      }
+      for (casadi_int i=0; i<n_in_; ++i) {
+        g << "arg[" << 2*n_in_+n_out_+i << "] = " << (i==iin_ ? z : "0") << ";\n";
+      }
+      for (casadi_int i=0; i<n_out_; ++i) {
+        g << "res[" << n_out_+i << "] = " << (i==iout_ ? jz : "0") << ";\n";
+      }
+      g << "if (" << fwd << "(arg+" << n_in_ << ", res+" << n_out_ << ", iw, " << w1
+        << ", 0)) return 1;\n";
+    };
+    // Preconditioner
+    auto precondition = [&](const std::string& v, const std::string& z) {
+      if (prec_.is_null()) {
+        g << g.copy(v, n_, z) << "\n";
+      } else {
+        set_arg(n_in_);
+        g << "arg[" << 2*n_in_ << "] = " << v << ";\n";
+        g << "res[" << n_out_ << "] = " << z << ";\n";
+        g << "if (" << prec << "(arg+" << n_in_ << ", res+" << n_out_ << ", iw, " << w1
+          << ", 0)) return 1;\n";
+      }
+    };
+
+    g.comment("Get the initial guess");
+    g << g.copy("arg[" + str(iin_) + "]", n_, "x") << "\n";
+
+    g.local("iter", "casadi_int");
+    g.local("r", "casadi_int");
+    g.local("k", "casadi_int");
+    g.local("tol", "casadi_real");
+    g.local("res_lin", "casadi_real");
+    g << "for (iter=0; iter<" << max_iter_ << "; ++iter) {\n";
+    g.comment("Evaluate the residual");
+    set_arg(n_in_);
+    for (casadi_int i=0; i<n_out_; ++i) {
+      g << "res[" << n_out_+i << "] = " << (i==iout_ ? "f" : "res[" + str(i) + "]") << ";\n";
+    }
+    g << "if (" << f << "(arg+" << n_in_ << ", res+" << n_out_ << ", iw, " << w1
+      << ", 0)) return 1;\n";
+    if (abstol_!=numeric_limits<double>::infinity()) {
+      g << "if (casadi_norm_inf(" << n_ << ", f) <= " << g.constant(abstol_) << ") break;\n";
+    }
+    g.comment("Solve J*dx = -F with restarted GMRES");
+    g << "tol = " << g.constant(eta_) << "*casadi_norm_2(" << n_ << ", f);\n";
+    g << "res_lin = 0;\n";
+    g << g.fill("dx", n_, "0.") << "\n";
+    g << "for (r=0; r<=" << max_restart_ << "; ++r) {\n";
+    g << "if (r==0) {\n";
+    g << g.copy("f", n_, "gm.v") << "\n";
+    g << "} else {\n";
+    jtimes("dx", "gm.v");
+    g << g.axpy(n_, "1.", "f", "gm.v") << "\n";
+    g << "}\n";
+    g << g.scal(n_, "-1.", "gm.v") << "\n";
+    g << "if (casadi_gmres_start(&gm) <= tol) break;\n";
+    g << "for (k=0; k<" << krylov_dim_ << ";) {\n";
+    precondition("gm.v+k*" + str(n_), "z");
+    jtimes("z", "gm.v+(k+1)*" + str(n_));
+    g << "res_lin = casadi_gmres_arnoldi(&gm, k++);\n";
+    g << "if (res_lin <= tol) break;\n";
+    g << "}\n";
+    g << "casadi_gmres_update(&gm, k, z);\n";
+    precondition("z", "gm.v");
+    g << g.axpy(n_, "1.", "gm.v", "dx") << "\n";
+    g << "if (res_lin <= tol) break;\n";
+    g << "}\n";
+    if (abstolStep_!=numeric_limits<double>::infinity()) {
+      g << "if (casadi_norm_inf(" << n_ << ", dx) <= " << g.constant(abstolStep_)
+        << ") break;\n";
+    }
+    g << g.axpy(n_, "1.", "dx", "x") << "\n";
+    g << "}\n";
+
+    g.comment("Get the solution");
+    g << g.copy("x", n_, "res[" + str(iout_) + "]") << "\n";
+  }
+
+  int NewtonKrylov::init_mem(void* mem) const {
+    if (Rootfinder::init_mem(mem)) return 1;
+    auto m = static_cast<NewtonKrylovMemory*>(mem);
+    m->return_status = nullptr;
+    m->iter = 0;
+    m->n_jtimes = 0;
+    return 0;
+  }
+
+  Dict NewtonKrylov::get_stats(void* mem) const {
+    Dict stats = Rootfinder::get_stats(mem);
+    auto m = static_cast<NewtonKrylovMemory*>(mem);
+    stats["return_status"] = m->return_status;
+    stats["iter_count"] = m->iter;
+    stats["n_jtimes"] = m->n_jtimes;
+    return stats;
+  }
+
+} // namespace casadi
@@ -0,0 +1,158 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#ifndef CASADI_NEWTON_KRYLOV_HPP
+#define CASADI_NEWTON_KRYLOV_HPP
+
+#include "casadi/core/rootfinder_impl.hpp"
+#include <casadi/solvers/casadi_rootfinder_newton_krylov_export.h>
+
+/** \defgroup plugin_Rootfinder_newton_krylov
+     Matrix-free inexact Newton method: the Newton steps are solved with restarted
+     GMRES using directional derivatives of the residual, so the Jacobian is never
+     evaluated. The memory needed scales with the number of unknowns times the
+     Krylov dimension. An optional preconditioner, a Function with the inputs of
+     the residual function followed by a vector v and returning an approximation
+     of J^(-1) v, is applied from the right. The method can be code generated.
+*/
+
+/** \pluginsection{Rootfinder,newton_krylov} */
+
+/// \cond INTERNAL
+namespace casadi {
+
+  // Memory
+  struct CASADI_ROOTFINDER_NEWTON_KRYLOV_EXPORT NewtonKrylovMemory
+    : public RootfinderMemory {
+    // Current guess, residual, step and a work vector
+    double *x, *f, *dx, *z;
+    // GMRES memory
+    casadi_gmres_mem<double> gm;
+    // Return status
+    const char* return_status;
+    // Number of Newton iterations and of Jacobian-times-vector products
+    casadi_int iter, n_jtimes;
+  };
+
+  /** \brief \pluginbrief{Rootfinder,newton_krylov}
+
+      @copydoc Rootfinder_doc
+      @copydoc plugin_Rootfinder_newton_krylov
+  */
+  class CASADI_ROOTFINDER_NEWTON_KRYLOV_EXPORT NewtonKrylov : public Rootfinder {
+  public:
+    /** \brief  Constructor */
+    explicit NewtonKrylov(const std::string& name, const Function& f);
+
+    /** \brief  Destructor */
+    ~NewtonKrylov() override;
+
+    // Get name of the plugin
+    const char* plugin_name() const override { return "newton_krylov";}
+
+    // Name of the class
+    std::string class_name() const override { return "NewtonKrylov";}
+
+    /** \brief  Create a new Rootfinder */
+    static Rootfinder* creator(const std::string& name, const Function& f) {
+      return new NewtonKrylov(name, f);
+    }
+
+    ///@{
+    /** \brief Options */
+    static Options options_;
+    const Options& get_options() const override { return options_;}
+    ///@}
+
+    /** \brief  Initialize */
+    void init(const Dict& opts) override;
+
+    /** \brief Create memory block */
+    void* alloc_mem() const override { return new NewtonKrylovMemory();}
+
+    /** \brief Initalize memory block */
+    int init_mem(void* mem) const override;
+
+    /** \brief Free memory block */
+    void free_mem(void *mem) const override { delete static_cast<NewtonKrylovMemory*>(mem);}
+
+    /** \brief Set the (persistent) work vectors */
+    void set_work(void* mem, const double**& arg, double**& res,
+                          casadi_int*& iw, double*& w) const override;
+
+    /// Solve the system of equations
+    int solve(void* mem) const override;
+
+    /// Get all statistics
+    Dict get_stats(void* mem) const override;
+
+    /// A documentation string
+    static const std::string meta_doc;
+
+    /** \brief Is codegen supported? */
+    bool has_codegen() const override { return true;}
+
+    /** \brief Generate code for the function body */
+    void codegen_body(CodeGenerator& g) const override;
+
+    /** \brief Worst-case footprint of the generated code */
+    Dict codegen_footprint(const CodeGenerator& g) const override;
+
+    /** \brief Generate code for the declarations of the C function */
+    void codegen_declarations(CodeGenerator& g) const override;
+
+  protected:
+    /// Jacobian times the vector z, stored in jz
+    void jtimes(NewtonKrylovMemory* m, const double* z, double* jz) const;
+
+    /// Apply the preconditioner to v, stored in z
+    void precondition(NewtonKrylovMemory* m, const double* v, double* z) const;
+
+    /// Maximum number of Newton iterations
+    casadi_int max_iter_;
+
+    /// Absolute tolerance that should be met on residual
+    double abstol_;
+
+    /// Absolute tolerance that should be met on step
+    double abstolStep_;
+
+    /// Krylov dimension between restarts and maximum number of restarts
+    casadi_int krylov_dim_, max_restart_;
+
+    /// Relative tolerance of the linear solves (forcing term)
+    double eta_;
+
+    /// If true, each iteration will be printed
+    bool print_iteration_;
+
+    /// Forward derivative of the residual function and the preconditioner, if any
+    Function fwd_, prec_;
+  };
+
+} // namespace casadi
+/// \endcond
+#endif // CASADI_NEWTON_KRYLOV_HPP
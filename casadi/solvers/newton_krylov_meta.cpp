@@ -0,0 +1,115 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+      #include "newton_krylov.hpp"
+      #include <string>
+
+      const std::string casadi::NewtonKrylov::meta_doc=
+      "\n"
+"Matrix-free inexact Newton method: the Newton steps are solved with restarted\n"
+"GMRES using directional derivatives of the residual, so the Jacobian is never\n"
+"evaluated. The memory needed scales with the number of unknowns times the\n"
+"Krylov dimension. An optional preconditioner, a Function with the inputs of\n"
+"the residual function followed by a vector v and returning an approximation\n"
+"of J^(-1) v, is applied from the right. The method can be code generated.\n"
+"\n"
+"\n"
+">List of available options\n"
+"\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
+"|       Id        |      Type       |     Default     |   Description   |\n"
+"+=================+=================+=================+=================+\n"
+"| abstol          | OT_DOUBLE       | 1e-12           | Stopping        |\n"
+"|                 |                 |                 | criterion       |\n"
+"|                 |                 |                 | tolerance on    |\n"
+"|                 |                 |                 | max(|F|)        |\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
+"| abstolStep      | OT_DOUBLE       | 1e-12           | Stopping        |\n"
+"|                 |                 |                 | criterion       |\n"
+"|                 |                 |                 | tolerance on    |\n"
+"|                 |                 |                 | step size       |\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
+"| eta             | OT_DOUBLE       | 1e-6            | Relative        |\n"
+"|                 |                 |                 | tolerance on    |\n"
+"|                 |                 |                 | the residual of |\n"
+"|                 |                 |                 | the linear      |\n"
+"|                 |                 |                 | system in each  |\n"
+"|                 |                 |                 | Newton          |\n"
+"|                 |                 |                 | iteration       |\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
+"| krylov_dim      | OT_INT          | 20              | Number of GMRES |\n"
+"|                 |                 |                 | iterations      |\n"
+"|                 |                 |                 | before a        |\n"
+"|                 |                 |                 | restart, at     |\n"
+"|                 |                 |                 | most the number |\n"
+"|                 |                 |                 | of unknowns     |\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
+"| max_iter        | OT_INT          | 1000            | Maximum number  |\n"
+"|                 |                 |                 | of Newton       |\n"
+"|                 |                 |                 | iterations to   |\n"
+"|                 |                 |                 | perform before  |\n"
+"|                 |                 |                 | returning       |\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
+"| max_restart     | OT_INT          | 10              | Maximum number  |\n"
+"|                 |                 |                 | of GMRES        |\n"
+"|                 |                 |                 | restarts per    |\n"
+"|                 |                 |                 | Newton          |\n"
+"|                 |                 |                 | iteration       |\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
+"| preconditioner  | OT_FUNCTION     |                 | Right           |\n"
+"|                 |                 |                 | preconditioner: |\n"
+"|                 |                 |                 | a function with |\n"
+"|                 |                 |                 | the inputs of   |\n"
+"|                 |                 |                 | the residual    |\n"
+"|                 |                 |                 | function        |\n"
+"|                 |                 |                 | followed by a   |\n"
+"|                 |                 |                 | vector v,       |\n"
+"|                 |                 |                 | returning an    |\n"
+"|                 |                 |                 | approximation   |\n"
+"|                 |                 |                 | of J^(-1) v     |\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
+"| print_iteration | OT_BOOL         | false           | Print           |\n"
+"|                 |                 |                 | information     |\n"
+"|                 |                 |                 | about each      |\n"
+"|                 |                 |                 | iteration       |\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
+"\n"
+"\n"
+">List of available stats\n"
+"\n"
+"+---------------+\n"
+"|      Id       |\n"
+"+===============+\n"
+"| iter_count    |\n"
+"+---------------+\n"
+"| n_jtimes      |\n"
+"+---------------+\n"
+"| return_status |\n"
+"+---------------+\n"
+"\n"
+"\n"
+"\n"
+"\n"
+;
@@ -0,0 +1,91 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#include "pade_expm.hpp"
+
+using namespace std;
+namespace casadi {
+
+  extern "C"
+  int CASADI_EXPM_PADE_EXPORT
+  casadi_register_expm_pade(Expm::Plugin* plugin) {
+    plugin->creator = PadeExpm::creator;
+    plugin->name = "pade";
+    plugin->doc = PadeExpm::meta_doc.c_str();
+    plugin->version = CASADI_VERSION;
+    plugin->options = &PadeExpm::options_;
+    return 0;
+  }
+
+  extern "C"
+  void CASADI_EXPM_PADE_EXPORT casadi_load_expm_pade() {
+    Expm::registerPlugin(casadi_register_expm_pade);
+  }
+
+  PadeExpm::PadeExpm(const std::string& name, const Sparsity& A) : Expm(name, A) {
+  }
+
+  PadeExpm::~PadeExpm() {
+    clear_mem();
+  }
+
+  void PadeExpm::init(const Dict& opts) {
+    // Initialize the base classes
+    Expm::init(opts);
+
+    n_ = A_.size1();
+
+    // Work vectors: zero matrix if A is missing, Pade approximant
+    alloc_w(n_*n_ + 7*n_*n_);
+  }
+
+  int PadeExpm::eval(const double** arg, double** res, casadi_int* iw, double* w,
+                     void* mem) const {
+    if (!res[0]) return 0;
+    // Missing inputs are zero
+    const double* A = arg[0];
+    if (!A) casadi_fill(w, n_*n_, 0.);
+    if (!A) A = w;
+    w += n_*n_;
+    double t = arg[1] ? *arg[1] : 0;
+    return casadi_expm(n_, A, t, res[0], w);
+  }
+
+  void PadeExpm::codegen_body(CodeGenerator& g) const {
+    g.add_auxiliary(CodeGenerator::AUX_EXPM);
+    g.local("a", "const casadi_real", "*");
+    g << "if (!res[0]) return 0;\n";
+    g.comment("Missing inputs are zero");
+    g << "a = arg[0];\n";
+    g << "if (!a) {\n"
+      << g.fill("w", n_*n_, "0.") << "\n"
+      << "a = w;\n"
+      << "}\n";
+    g << "w += " << n_*n_ << ";\n";
+    g << "return casadi_expm(" << n_ << ", a, arg[1] ? *arg[1] : 0, res[0], w);\n";
+  }
+
+} // namespace casadi
@@ -0,0 +1,98 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#ifndef CASADI_PADE_EXPM_HPP
+#define CASADI_PADE_EXPM_HPP
+
+#include "casadi/core/expm_impl.hpp"
+#include <casadi/solvers/casadi_expm_pade_export.h>
+
+/** \defgroup plugin_Expm_pade
+
+   Matrix exponential by the degree 13 Pade approximant with scaling and
+   squaring (Higham, 2005)
+
+   The matrix is scaled by a power of two until its 1-norm is below 5.37, the
+   Pade approximant is evaluated with six matrix products and one dense solve,
+   and the scaling is undone by repeated squaring. The Frechet derivatives used
+   for forward and adjoint sensitivities are the upper right block of the
+   exponential of a block triangular matrix of twice the size, evaluated by the
+   same plugin. The method is implemented in the C runtime and can be code
+   generated, including its derivatives.
+*/
+
+/** \pluginsection{Expm,pade} */
+
+/// \cond INTERNAL
+namespace casadi {
+
+  /** \brief \pluginbrief{Expm,pade}
+
+      @copydoc Expm_doc
+      @copydoc plugin_Expm_pade
+  */
+  class CASADI_EXPM_PADE_EXPORT PadeExpm : public Expm {
+  public:
+    /** \brief  Constructor */
+    PadeExpm(const std::string& name, const Sparsity& A);
+
+    /** \brief  Create a new Expm solver */
+    static Expm* creator(const std::string& name, const Sparsity& A) {
+      return new PadeExpm(name, A);
+    }
+
+    /** \brief  Destructor */
+    ~PadeExpm() override;
+
+    // Get name of the plugin
+    const char* plugin_name() const override { return "pade";}
+
+    // Get name of the class
+    std::string class_name() const override { return "PadeExpm";}
+
+    /** \brief  Initialize */
+    void init(const Dict& opts) override;
+
+    /** \brief  Evaluate numerically */
+    int eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const override;
+
+    /** \brief Is codegen supported? */
+    bool has_codegen() const override { return true;}
+
+    /** \brief Generate code for the body of the C function */
+    void codegen_body(CodeGenerator& g) const override;
+
+    /// A documentation string
+    static const std::string meta_doc;
+
+  private:
+    /// Dimension of the matrix
+    casadi_int n_;
+  };
+
+} // namespace casadi
+/// \endcond
+#endif // CASADI_PADE_EXPM_HPP
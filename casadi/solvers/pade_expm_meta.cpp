@@ -0,0 +1,45 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+      #include "pade_expm.hpp"
+      #include <string>
+
+      const std::string casadi::PadeExpm::meta_doc=
+      "\n"
+"Matrix exponential by the degree 13 Pade approximant with scaling and\n"
+"squaring (Higham, 2005)\n"
+"\n"
+"The matrix is scaled by a power of two until its 1-norm is below 5.37, the\n"
+"Pade approximant is evaluated with six matrix products and one dense solve,\n"
+"and the scaling is undone by repeated squaring. The Frechet derivatives\n"
+"used for forward and adjoint sensitivities are the upper right block of the\n"
+"exponential of a block triangular matrix of twice the size, evaluated by\n"
+"the same plugin. The method is implemented in the C runtime and can be code\n"
+"generated, including its derivatives.\n"
+"\n"
+"\n"
+"\n"
+;
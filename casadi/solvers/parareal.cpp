@@ -0,0 +1,333 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#include "parareal.hpp"
+
+using namespace std;
+namespace casadi {
+
+  extern "C"
+  int CASADI_INTEGRATOR_PARAREAL_EXPORT
+      casadi_register_integrator_parareal(Integrator::Plugin* plugin) {
+    plugin->creator = Parareal::creator;
+    plugin->name = "parareal";
+    plugin->doc = Parareal::meta_doc.c_str();
+    plugin->version = CASADI_VERSION;
+    plugin->options = &Parareal::options_;
+    return 0;
+  }
+
+  extern "C"
+  void CASADI_INTEGRATOR_PARAREAL_EXPORT casadi_load_integrator_parareal() {
+    Integrator::registerPlugin(casadi_register_integrator_parareal);
+  }
+
+  Parareal::Parareal(const std::string& name, const Function& dae)
+    : Integrator(name, dae) {
+  }
+
+  Parareal::~Parareal() {
+    clear_mem();
+  }
+
+  Options Parareal::options_
+  = {{&Integrator::options_},
+     {{"coarse",
+       {OT_STRING,
+        "Integrator plugin used for the sequential coarse propagation [rk]"}},
+      {"coarse_options",
+       {OT_DICT,
+        "Options passed to the coarse integrator, with time running from 0 to 1 over "
+        "each slice [default for rk: number_of_finite_elements 1]"}},
+      {"fine",
+       {OT_STRING,
+        "Integrator plugin used for the parallel fine propagation [cvodes]"}},
+      {"fine_options",
+       {OT_DICT,
+        "Options passed to the fine integrator, with time running from 0 to 1 over "
+        "each slice"}},
+      {"number_of_slices",
+       {OT_INT,
+        "Number of equidistant time slices, refined by the output times [8]"}},
+      {"max_iter",
+       {OT_INT,
+        "Maximum number of Parareal iterations [default: number of slices, "
+        "which reproduces the fine integrator]"}},
+      {"tol",
+       {OT_DOUBLE,
+        "Stop when the largest correction of the state at a slice boundary, "
+        "relative to 1+|x|, is below tol [1e-8]"}},
+      {"parallelization",
+       {OT_STRING,
+        "Parallelization of the fine propagation over the slices: "
+        "serial, openmp or thread [thread]"}},
+      {"map_options",
+       {OT_DICT,
+        "Options passed to the map of the fine integrator, e.g. max_num_threads"}}
+     }
+  };
+
+  void Parareal::init(const Dict& opts) {
+    // Call the base class init
+    Integrator::init(opts);
+    casadi_assert(ne_==0, "Events are not supported by 'parareal'");
+
+    // Default options
+    string coarse_plugin = "rk", fine_plugin = "cvodes", parallelization = "thread";
+    Dict coarse_opts, fine_opts, map_opts;
+    bool coarse_opts_given = false;
+    casadi_int nslices = 8;
+    max_iter_ = -1;
+    tol_ = 1e-8;
+
+    // Read options
+    for (auto&& op : opts) {
+      if (op.first=="coarse") {
+        coarse_plugin = op.second.to_string();
+      } else if (op.first=="coarse_options") {
+        coarse_opts = op.second;
+        coarse_opts_given = true;
+      } else if (op.first=="fine") {
+        fine_plugin = op.second.to_string();
+      } else if (op.first=="fine_options") {
+        fine_opts = op.second;
+      } else if (op.first=="number_of_slices") {
+        nslices = op.second;
+      } else if (op.first=="max_iter") {
+        max_iter_ = op.second;
+      } else if (op.first=="tol") {
+        tol_ = op.second;
+      } else if (op.first=="parallelization") {
+        parallelization = op.second.to_string();
+      } else if (op.first=="map_options") {
+        map_opts = op.second;
+      }
+    }
+
+    // Only forward problems for ODEs
+    casadi_assert(nz_==0 && nrz_==0,
+      "Parareal integrator does not support algebraic variables");
+    casadi_assert(nrx_==0,
+      "Parareal integrator does not support backward problems, "
+      "use forward mode for the sensitivities");
+    casadi_assert(nslices>=1, "Number of slices must be positive");
+
+    // Slice boundaries: the output times, refined by equidistant points
+    double t0 = grid_.front(), tf = grid_.back(), eps = 1e-10*fabs(tf-t0);
+    tslice_.clear();
+    grid_slice_.clear();
+    casadi_int j = 0;
+    for (double t : grid_) {
+      for (; j<=nslices; ++j) {
+        double tj = t0 + static_cast<double>(j)/nslices*(tf-t0);
+        if (tj>t+eps) break;
+        if (tj<t-eps) tslice_.push_back(tj);
+      }
+      if (tslice_.empty() || t>tslice_.back()+eps) tslice_.push_back(t);
+      grid_slice_.push_back(tslice_.size()-1);
+    }
+    nslices = tslice_.size()-1;
+    casadi_assert(nslices>=1, "Parareal integrator requires a nonzero time horizon");
+    if (max_iter_<0) max_iter_ = nslices;
+
+    // Integrators over a slice
+    Function dae = oracle_.is_a("SXFunction") ? slice_dae<SX>() : slice_dae<MX>();
+    np_slice_ = dae.nnz_in(DE_P);
+    if (coarse_plugin=="rk" && !coarse_opts_given) {
+      coarse_opts["number_of_finite_elements"] = 1;
+    }
+    for (Dict* d : {&coarse_opts, &fine_opts}) {
+      d->erase("grid");
+      d->erase("output_t0");
+      (*d)["t0"] = 0.;
+      (*d)["tf"] = 1.;
+    }
+    Function G = integrator(name_ + "_coarse", coarse_plugin, dae, coarse_opts);
+    Function F = integrator(name_ + "_fine", fine_plugin, dae, fine_opts);
+    set_function(G, "coarse");
+    set_function(F.map(nslices, parallelization, map_opts), "fine");
+  }
+
+  template<typename MatType>
+  Function Parareal::slice_dae() const {
+    // The time t = t_slice + tau*dt_slice is scaled to tau in [0, 1]
+    vector<MatType> arg = MatType::get_input(oracle_);
+    MatType tau = MatType::sym("tau");
+    MatType ts = MatType::sym("t_slice"), dt = MatType::sym("dt_slice");
+    // Sensitivity equations are integrated as states
+    MatType x = MatType::sym("x", nx_);
+    vector<MatType> arg1 = arg;
+    arg1[DE_T] = ts + tau*dt;
+    arg1[DE_X] = reshape(x, arg[DE_X].size());
+    vector<MatType> res = oracle_(arg1);
+    res[DE_ODE] = vec(dt*res[DE_ODE]);
+    res[DE_QUAD] = vec(dt*res[DE_QUAD]);
+
+    // The start and length of the slice are appended to the parameters
+    arg[DE_T] = tau;
+    arg[DE_X] = x;
+    arg[DE_P] = vertcat(vec(arg[DE_P]), ts, dt);
+    return Function("slice_" + oracle_.name(), arg, res, DE_INPUTS, DE_OUTPUTS);
+  }
+
+  int Parareal::init_mem(void* mem) const {
+    if (Integrator::init_mem(mem)) return 1;
+    auto m = static_cast<PararealMemory*>(mem);
+
+    casadi_int nslices = tslice_.size()-1;
+    m->U.resize(nx_*(nslices+1));
+    m->G.resize(nx_*nslices);
+    m->F.resize(nx_*(nslices+1));
+    m->Q.resize(nq_*(nslices+1));
+    m->P.resize(np_slice_*nslices);
+
+    // Start time and length of each slice
+    for (casadi_int n=0; n<nslices; ++n) {
+      double* Pn = get_ptr(m->P) + (n+1)*np_slice_;
+      Pn[-2] = tslice_[n];
+      Pn[-1] = tslice_[n+1]-tslice_[n];
+    }
+    m->niter = 0;
+    m->err = 0;
+    return 0;
+  }
+
+  void Parareal::coarse(PararealMemory* m, casadi_int n, const double* x, double* xf) const {
+    fill_n(m->arg, INTEGRATOR_NUM_IN, nullptr);
+    m->arg[INTEGRATOR_X0] = x;
+    m->arg[INTEGRATOR_P] = get_ptr(m->P) + n*np_slice_;
+    fill_n(m->res, INTEGRATOR_NUM_OUT, nullptr);
+    m->res[INTEGRATOR_XF] = xf;
+    if (calc_function(m, "coarse")) casadi_error("Parareal::coarse: 'coarse' failed");
+  }
+
+  void Parareal::fine(PararealMemory* m, double* xf, double* qf) const {
+    fill_n(m->arg, INTEGRATOR_NUM_IN, nullptr);
+    m->arg[INTEGRATOR_X0] = get_ptr(m->U);
+    m->arg[INTEGRATOR_P] = get_ptr(m->P);
+    fill_n(m->res, INTEGRATOR_NUM_OUT, nullptr);
+    m->res[INTEGRATOR_XF] = xf;
+    m->res[INTEGRATOR_QF] = qf;
+    if (calc_function(m, "fine")) casadi_error("Parareal::fine: 'fine' failed");
+  }
+
+  void Parareal::reset(IntegratorMemory* mem, double t, const double* x,
+                       const double* z, const double* p) const {
+    auto m = static_cast<PararealMemory*>(mem);
+    casadi_int nslices = tslice_.size()-1;
+    double *U = get_ptr(m->U), *G = get_ptr(m->G), *F = get_ptr(m->F);
+
+    // Parameters of each slice
+    for (casadi_int n=0; n<nslices; ++n) {
+      casadi_copy(p, np_, get_ptr(m->P) + n*np_slice_);
+    }
+
+    // Initial guess from the coarse integrator
+    casadi_copy(x, nx_, U);
+    for (casadi_int n=0; n<nslices; ++n) {
+      coarse(m, n, U+n*nx_, G+n*nx_);
+      casadi_copy(G+n*nx_, nx_, U+(n+1)*nx_);
+    }
+
+    // Parareal iterations
+    m->niter = 0;
+    m->err = 0;
+    double* g = F + nx_*nslices;
+    while (m->niter<max_iter_) {
+      // Fine propagation of all slices in parallel
+      fine(m, F, nullptr);
+      m->niter++;
+
+      // Sequential correction: U[n+1] = G(U[n]) + F(U_old[n]) - G(U_old[n])
+      m->err = 0;
+      for (casadi_int n=0; n<nslices; ++n) {
+        double *Un = U+(n+1)*nx_, *Fn = F+n*nx_, *Gn = G+n*nx_;
+        if (n<m->niter) {
+          // Exact after niter iterations
+          casadi_copy(Fn, nx_, g);
+        } else {
+          coarse(m, n, U+n*nx_, g);
+        }
+        for (casadi_int i=0; i<nx_; ++i) {
+          double v = n<m->niter ? g[i] : g[i] + Fn[i] - Gn[i];
+          m->err = fmax(m->err, fabs(v-Un[i])/(1+fabs(v)));
+          Un[i] = v;
+          Gn[i] = g[i];
+        }
+      }
+      if (m->err<=tol_) break;
+    }
+
+    // Quadratures from a fine propagation of the converged states
+    if (nq_>0) {
+      double* Q = get_ptr(m->Q);
+      fine(m, F, Q+nq_);
+      casadi_fill(Q, nq_, 0.);
+      for (casadi_int n=1; n<=nslices; ++n) {
+        casadi_axpy(nq_, 1., Q+(n-1)*nq_, Q+n*nq_);
+      }
+    }
+  }
+
+  void Parareal::advance(IntegratorMemory* mem, double t,
+                         double* x, double* z, double* q) const {
+    auto m = static_cast<PararealMemory*>(mem);
+    // Slice boundary at the output time
+    casadi_int k = lower_bound(grid_.begin(), grid_.end(), t) - grid_.begin();
+    casadi_assert_dev(k<grid_.size() && grid_[k]==t);
+    casadi_int n = grid_slice_[k];
+    casadi_copy(get_ptr(m->U) + n*nx_, nx_, x);
+    casadi_copy(get_ptr(m->Q) + n*nq_, nq_, q);
+  }
+
+  void Parareal::resetB(IntegratorMemory* mem, double t, const double* rx,
+                        const double* rz, const double* rp) const {
+    casadi_error("Parareal integrator does not support backward problems");
+  }
+
+  void Parareal::retreat(IntegratorMemory* mem, double t,
+                         double* rx, double* rz, double* rq) const {
+    casadi_error("Parareal integrator does not support backward problems");
+  }
+
+  void Parareal::print_stats(IntegratorMemory* mem) const {
+    auto m = static_cast<PararealMemory*>(mem);
+    print("FORWARD INTEGRATION:\n");
+    print("Number of time slices: %lld\n", static_cast<casadi_int>(tslice_.size()-1));
+    print("Number of Parareal iterations: %lld\n", m->niter);
+    print("Largest correction in the last iteration: %g\n", m->err);
+  }
+
+  Dict Parareal::get_stats(void* mem) const {
+    Dict stats = Integrator::get_stats(mem);
+    auto m = static_cast<PararealMemory*>(mem);
+    stats["niter"] = m->niter;
+    stats["nslices"] = static_cast<casadi_int>(tslice_.size()-1);
+    stats["err"] = m->err;
+    return stats;
+  }
+
+} // namespace casadi
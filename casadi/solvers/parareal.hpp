@@ -0,0 +1,163 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#ifndef CASADI_PARAREAL_HPP
+#define CASADI_PARAREAL_HPP
+
+#include "casadi/core/integrator_impl.hpp"
+#include <casadi/solvers/casadi_integrator_parareal_export.h>
+
+/** \defgroup plugin_Integrator_parareal
+      Parallel-in-time integrator for ODEs, composed from two existing integrator plugins.
+
+      The time horizon is divided into slices, bounded by the output times and
+      'number_of_slices' equidistant points. A cheap coarse integrator propagates the state
+      sequentially from slice to slice, and the Parareal corrections with an accurate fine
+      integrator are evaluated for all slices at once, using a parallel map.
+      After k iterations, the states at the first k slice boundaries are exact with respect
+      to the fine integrator.
+*/
+/** \pluginsection{Integrator,parareal} */
+
+/// \cond INTERNAL
+namespace casadi {
+
+  /** \brief Memory for the Parareal integrator */
+  struct CASADI_INTEGRATOR_PARAREAL_EXPORT PararealMemory : public IntegratorMemory {
+    // State at the slice boundaries
+    std::vector<double> U;
+
+    // Coarse and fine propagation of the state over each slice
+    std::vector<double> G, F;
+
+    // Quadratures at the slice boundaries
+    std::vector<double> Q;
+
+    // Parameters of each slice, including the start time and the length of the slice
+    std::vector<double> P;
+
+    // Statistics
+    casadi_int niter;
+    double err;
+  };
+
+  /** \brief \pluginbrief{Integrator,parareal}
+
+      @copydoc DAE_doc
+      @copydoc plugin_Integrator_parareal
+  */
+  class CASADI_INTEGRATOR_PARAREAL_EXPORT Parareal : public Integrator {
+  public:
+
+    /// Constructor
+    explicit Parareal(const std::string& name, const Function& dae);
+
+    /** \brief  Create a new integrator */
+    static Integrator* creator(const std::string& name, const Function& dae) {
+      return new Parareal(name, dae);
+    }
+
+    /// Destructor
+    ~Parareal() override;
+
+    // Get name of the plugin
+    const char* plugin_name() const override { return "parareal";}
+
+    // Get name of the class
+    std::string class_name() const override { return "Parareal";}
+
+    ///@{
+    /** \brief Options */
+    static Options options_;
+    const Options& get_options() const override { return options_;}
+    ///@}
+
+    /// Initialize stage
+    void init(const Dict& opts) override;
+
+    /** \brief Create memory block */
+    void* alloc_mem() const override { return new PararealMemory();}
+
+    /** \brief Initalize memory block */
+    int init_mem(void* mem) const override;
+
+    /** \brief Free memory block */
+    void free_mem(void *mem) const override { delete static_cast<PararealMemory*>(mem);}
+
+    /** \brief Reset the forward problem */
+    void reset(IntegratorMemory* mem, double t,
+               const double* x, const double* z, const double* p) const override;
+
+    /** \brief  Advance solution in time */
+    void advance(IntegratorMemory* mem, double t,
+                 double* x, double* z, double* q) const override;
+
+    /** \brief Reset the backward problem */
+    void resetB(IntegratorMemory* mem, double t,
+                const double* rx, const double* rz, const double* rp) const override;
+
+    /** \brief  Retreat solution in time */
+    void retreat(IntegratorMemory* mem, double t,
+                 double* rx, double* rz, double* rq) const override;
+
+    /** \brief  Print solver statistics */
+    void print_stats(IntegratorMemory* mem) const override;
+
+    /** \brief Get all statistics */
+    Dict get_stats(void* mem) const override;
+
+    /// A documentation string
+    static const std::string meta_doc;
+
+  protected:
+    // DAE over a slice, scaled to the unit time interval
+    template<typename MatType>
+    Function slice_dae() const;
+
+    // Propagate the state over slice n with the coarse integrator
+    void coarse(PararealMemory* m, casadi_int n, const double* x, double* xf) const;
+
+    // Propagate the states over all slices with the fine integrator
+    void fine(PararealMemory* m, double* xf, double* qf) const;
+
+    // Slice boundaries
+    std::vector<double> tslice_;
+
+    // Slice boundary corresponding to each grid point
+    std::vector<casadi_int> grid_slice_;
+
+    // Number of parameters of the slice DAE
+    casadi_int np_slice_;
+
+    // Convergence tolerance and maximum number of Parareal iterations
+    double tol_;
+    casadi_int max_iter_;
+  };
+
+} // namespace casadi
+
+/// \endcond
+#endif // CASADI_PARAREAL_HPP
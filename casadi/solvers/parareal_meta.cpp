@@ -0,0 +1,85 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+      #include "parareal.hpp"
+      #include <string>
+
+      const std::string casadi::Parareal::meta_doc=
+      "\n"
+"Parallel-in-time integrator for ODEs, composed from two existing\n"
+"integrator plugins.\n"
+"\n"
+"The time horizon is divided into slices, bounded by the output times and\n"
+"'number_of_slices' equidistant points. A cheap coarse integrator\n"
+"propagates the state sequentially from slice to slice, and the Parareal\n"
+"corrections with an accurate fine integrator are evaluated for all slices\n"
+"at once, using a parallel map. After k iterations, the states at the\n"
+"first k slice boundaries are exact with respect to the fine integrator.\n"
+"\n"
+"\n"
+">List of available options\n"
+"\n"
+"+------------------+-----------+------------------------------------------+\n"
+"|        Id        |   Type    |               Description                |\n"
+"+==================+===========+==========================================+\n"
+"| coarse           | OT_STRING | Integrator plugin used for the           |\n"
+"|                  |           | sequential coarse propagation [rk]       |\n"
+"+------------------+-----------+------------------------------------------+\n"
+"| coarse_options   | OT_DICT   | Options passed to the coarse integrator, |\n"
+"|                  |           | with time running from 0 to 1 over each  |\n"
+"|                  |           | slice [default for rk:                   |\n"
+"|                  |           | number_of_finite_elements 1]             |\n"
+"+------------------+-----------+------------------------------------------+\n"
+"| fine             | OT_STRING | Integrator plugin used for the parallel  |\n"
+"|                  |           | fine propagation [cvodes]                |\n"
+"+------------------+-----------+------------------------------------------+\n"
+"| fine_options     | OT_DICT   | Options passed to the fine integrator,   |\n"
+"|                  |           | with time running from 0 to 1 over each  |\n"
+"|                  |           | slice                                    |\n"
+"+------------------+-----------+------------------------------------------+\n"
+"| map_options      | OT_DICT   | Options passed to the map of the fine    |\n"
+"|                  |           | integrator, e.g. max_num_threads         |\n"
+"+------------------+-----------+------------------------------------------+\n"
+"| max_iter         | OT_INT    | Maximum number of Parareal iterations    |\n"
+"|                  |           | [default: number of slices, which        |\n"
+"|                  |           | reproduces the fine integrator]          |\n"
+"+------------------+-----------+------------------------------------------+\n"
+"| number_of_slices | OT_INT    | Number of equidistant time slices,       |\n"
+"|                  |           | refined by the output times [8]          |\n"
+"+------------------+-----------+------------------------------------------+\n"
+"| parallelization  | OT_STRING | Parallelization of the fine propagation  |\n"
+"|                  |           | over the slices: serial, openmp or       |\n"
+"|                  |           | thread [thread]                          |\n"
+"+------------------+-----------+------------------------------------------+\n"
+"| tol              | OT_DOUBLE | Stop when the largest correction of the  |\n"
+"|                  |           | state at a slice boundary, relative to   |\n"
+"|                  |           | 1+|x|, is below tol [1e-8]               |\n"
+"+------------------+-----------+------------------------------------------+\n"
+"\n"
+"\n"
+"\n"
+"\n"
+;
@@ -69,7 +69,14 @@ namespace casadi {
         "Print header [true]."}},
       {"print_iter",
        {OT_BOOL,
-        "Print iterations [true]."}}
+        "Print iterations [true]."}},
+      {"trace_size",
+       {OT_INT,
+        "Keep the data of this many of the last iterations, across solves, in a "
+        "preallocated buffer, available as 'trace' in the statistics [0]"}},
+      {"trace_file",
+       {OT_STRING,
+        "Write the iteration trace to this file, in a binary format, when a solve fails"}}
      }
   };
 
@@ -82,6 +89,7 @@ namespace casadi {
     print_iter_ = true;
     print_header_ = true;
     du_to_pr_ = 1000.;
+    trace_size_ = 0;
 
     // Read user options
     for (auto&& op : opts) {
@@ -93,6 +101,11 @@ namespace casadi {
         print_header_ = op.second;
       } else if (op.first=="du_to_pr") {
         du_to_pr_ = op.second;
+      } else if (op.first=="trace_size") {
+        trace_size_ = op.second;
+        casadi_assert(trace_size_>=0, "Option 'trace_size' must be nonnegative");
+      } else if (op.first=="trace_file") {
+        trace_file_ = op.second.to_string();
       }
     }
 
@@ -146,6 +159,12 @@ namespace casadi {
     auto m = static_cast<QrqpMemory*>(mem);
     m->return_status = "";
     m->success = false;
+    m->iter_count = 0;
+    m->n_qr_col = 0;
+    // Iteration trace
+    if (trace_size_>0) {
+      m->trace.init(trace_size_, {"f", "inf_pr", "inf_du", "tau", "sing"}, trace_file_);
+    }
     return 0;
   }
 
@@ -154,17 +173,60 @@ namespace casadi {
     auto m = static_cast<QrqpMemory*>(mem);
     // Reset statistics
     for (auto&& s : m->fstats) s.second.reset();
+    m->deadline.start(max_wall_time_, &cancel_epoch_);
+    // Setup data structure
+    casadi_qp_data<double> d;
+    d.prob = &p_;
+    casadi_qp_init(&d, iw, w);
+    // Solve the QP
+    return solve(d, arg, res, m);
+  }
+
+  int Qrqp::eval_batch(const double** arg, double** res, casadi_int* iw, double* w,
+                       void* mem, casadi_int n) const {
+    auto m = static_cast<QrqpMemory*>(mem);
+    // Reset statistics
+    for (auto&& s : m->fstats) s.second.reset();
+    m->deadline.start(max_wall_time_, &cancel_epoch_);
+    // Setup data structure, shared by all QPs
+    casadi_qp_data<double> d;
+    d.prob = &p_;
+    casadi_qp_init(&d, iw, w);
+    // Solve the QPs one after the other
+    const double* arg1[CONIC_NUM_IN];
+    double* res1[CONIC_NUM_OUT];
+    const char* return_status = "success";
+    bool success = true;
+    casadi_int iter_count = 0;
+    for (casadi_int k=0; k<n; ++k) {
+      batch_point(arg, res, k, arg1, res1);
+      // The QR factorization of the previous QP can be updated if H and A are unchanged
+      if (!batch_same_matrices(arg, k)) d.has_qr = 0;
+      if (solve(d, arg1, res1, m)) return 1;
+      iter_count += m->iter_count;
+      if (!m->success) {
+        success = false;
+        return_status = m->return_status;
+      }
+    }
+    // Statistics of the whole batch
+    m->return_status = return_status;
+    m->success = success;
+    m->iter_count = iter_count;
+    m->n_qr_col = d.n_qr_col;
+    return 0;
+  }
+
+  int Qrqp::solve(casadi_qp_data<double>& d, const double** arg, double** res,
+                  QrqpMemory* m) const {
     // Check inputs
     if (inputs_check_) {
       check_inputs(arg[CONIC_LBX], arg[CONIC_UBX], arg[CONIC_LBA], arg[CONIC_UBA]);
     }
-    // Setup data structure
-    casadi_qp_data<double> d;
-    d.prob = &p_;
+    // Pass QP data
     d.nz_h = arg[CONIC_H];
     d.g = arg[CONIC_G];
     d.nz_a = arg[CONIC_A];
-    casadi_qp_init(&d, iw, w);
     // Pass bounds on z
     casadi_copy(arg[CONIC_LBX], nx_, d.lbz);
     casadi_copy(arg[CONIC_LBA], na_, d.lbz+nx_);
@@ -182,6 +244,7 @@ namespace casadi {
     casadi_int index=-2, sign=0, r_index=-2, r_sign=0;
     // QP iterations
     casadi_int iter = 0;
+    m->trace.start();
     while (true) {
       // Calculate dependent quantities
       casadi_qp_calc_dependent(&d);
@@ -197,7 +260,14 @@ namespace casadi {
         casadi_qp_log(&d, "QP terminated: max iter");
         m->return_status = "Maximum number of iterations reached";
         flag = 1;
+      } else if (m->deadline.expired()) {
+        casadi_qp_log(&d, "QP terminated: deadline");
+        m->return_status = m->deadline.cancelled() ? "Cancelled"
+          : "Maximum wall time exceeded";
+        flag = 1;
       }
+      // Record the iterate
+      m->trace.record(iter, {d.f, d.pr, d.du, d.tau, static_cast<double>(d.sing)});
       // Print iteration progress:
       if (print_iter_) {
         if (iter % 10 == 0) {
@@ -229,9 +299,12 @@ namespace casadi {
     casadi_copy(d.z, nx_, res[CONIC_X]);
     casadi_copy(d.lam, nx_, res[CONIC_LAM_X]);
     casadi_copy(d.lam+nx_, na_, res[CONIC_LAM_A]);
+    m->iter_count = iter;
+    m->n_qr_col = d.n_qr_col;
     // Return
     if (verbose_) casadi_warning(m->return_status);
     m->success = flag ? false : true;
+    if (!m->success) m->trace.dump_on_fail();
     return 0;
   }
 
@@ -240,6 +313,9 @@ namespace casadi {
     auto m = static_cast<QrqpMemory*>(mem);
     stats["return_status"] = m->return_status;
     stats["success"] = m->success;
+    stats["iter_count"] = m->iter_count;
+    stats["n_qr_col"] = m->n_qr_col;
+    if (m->trace.enabled()) stats["trace"] = m->trace.get();
     return stats;
   }
 
@@ -27,6 +27,7 @@
 #define CASADI_QRQP_HPP
 
 #include "casadi/core/conic_impl.hpp"
+#include "casadi/core/iteration_trace.hpp"
 #include <casadi/solvers/casadi_conic_qrqp_export.h>
 namespace casadi {
 #include "casadi/core/runtime/casadi_qp.hpp"
@@ -43,6 +44,10 @@ namespace casadi {
   struct CASADI_CONIC_QRQP_EXPORT QrqpMemory : public ConicMemory {
     const char* return_status;
     bool success;
+    // Number of iterations and of QR columns calculated
+    casadi_int iter_count, n_qr_col;
+    // Iteration trace
+    IterationTrace trace;
   };
 
   /** \brief \pluginbrief{Conic,qrqp}
@@ -96,6 +101,15 @@ namespace casadi {
     int eval(const double** arg, double** res,
              casadi_int* iw, double* w, void* mem) const override;
 
+    /** \brief Solve n QPs, reusing the QR factorization when H and A are unchanged
+        The statistics are summed over the batch */
+    int eval_batch(const double** arg, double** res, casadi_int* iw, double* w,
+                   void* mem, casadi_int n) const override;
+
+    /// Solve one QP, with the data structure initialized
+    int solve(casadi_qp_data<double>& d, const double** arg, double** res,
+              QrqpMemory* m) const;
+
     /// Get all statistics
     Dict get_stats(void* mem) const override;
 
@@ -112,6 +126,8 @@ namespace casadi {
     casadi_int max_iter_;
     bool print_iter_, print_header_;
     double du_to_pr_;
+    casadi_int trace_size_;
+    std::string trace_file_;
     ///@}
   };
 
@@ -0,0 +1,285 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#include "riccati.hpp"
+#include <numeric>
+
+using namespace std;
+namespace casadi {
+
+  extern "C"
+  int CASADI_CONIC_RICCATI_EXPORT
+  casadi_register_conic_riccati(Conic::Plugin* plugin) {
+    plugin->creator = Riccati::creator;
+    plugin->name = "riccati";
+    plugin->doc = Riccati::meta_doc.c_str();
+    plugin->version = CASADI_VERSION;
+    plugin->options = &Riccati::options_;
+    return 0;
+  }
+
+  extern "C"
+  void CASADI_CONIC_RICCATI_EXPORT casadi_load_conic_riccati() {
+    Conic::registerPlugin(casadi_register_conic_riccati);
+  }
+
+  Riccati::Riccati(const std::string& name, const std::map<std::string, Sparsity> &st)
+    : Conic(name, st) {
+  }
+
+  Riccati::~Riccati() {
+    clear_mem();
+  }
+
+  Options Riccati::options_
+  = {{&Conic::options_},
+     {{"N",
+       {OT_INT,
+        "OCP horizon. Unless all of N, nx, nu, ng are set, "
+        "the structure is detected from the sparsity of A."}},
+      {"nx",
+       {OT_INTVECTOR,
+        "Number of states, length N+1"}},
+      {"nu",
+       {OT_INTVECTOR,
+        "Number of controls, length N"}},
+      {"ng",
+       {OT_INTVECTOR,
+        "Number of non-dynamic constraints, length N+1"}},
+      {"max_iter",
+       {OT_INT,
+        "Maximum number of iterations [100]."}},
+      {"tol",
+       {OT_DOUBLE,
+        "Tolerance for the residuals and the duality measure [1e-8]."}}
+     }
+  };
+
+  void Riccati::init(const Dict& opts) {
+    // Initialize the base classes
+    Conic::init(opts);
+
+    // Default options
+    max_iter_ = 100;
+    tol_ = 1e-8;
+    casadi_int struct_cnt=0;
+
+    // Read user options
+    for (auto&& op : opts) {
+      if (op.first=="N") {
+        N_ = op.second;
+        struct_cnt++;
+      } else if (op.first=="nx") {
+        nxs_ = op.second;
+        struct_cnt++;
+      } else if (op.first=="nu") {
+        nus_ = op.second;
+        struct_cnt++;
+      } else if (op.first=="ng") {
+        ngs_ = op.second;
+        struct_cnt++;
+      } else if (op.first=="max_iter") {
+        max_iter_ = op.second;
+      } else if (op.first=="tol") {
+        tol_ = op.second;
+      }
+    }
+
+    // Check the structure
+    casadi_assert(struct_cnt==0 || struct_cnt==4,
+      "You must either set all of N, nx, nu, ng; "
+      "or set none at all (automatic detection).");
+    if (struct_cnt==0) {
+      detect_structure(N_, nxs_, nus_, ngs_);
+      if (verbose_) {
+        casadi_message("Detected structure: N " + str(N_) + ", nx " + str(nxs_) + ", "
+          "nu " + str(nus_) + ", ng " + str(ngs_) + ".");
+      }
+    }
+    const std::vector<casadi_int>& nx = nxs_;
+    const std::vector<casadi_int>& ng = ngs_;
+    const std::vector<casadi_int>& nu = nus_;
+    casadi_assert(nx.size()==N_+1, "nx must have length N+1");
+    casadi_assert(nu.size()==N_, "nu must have length N");
+    casadi_assert(ng.size()==N_+1, "ng must have length N+1");
+    casadi_assert(nx_ == std::accumulate(nx.begin(), nx.end(), 0) +
+      std::accumulate(nu.begin(), nu.end(), 0),
+      "sum(nx)+sum(nu) = must equal total size of variables (" + str(nx_) + "). "
+      "Structure is: N " + str(N_) + ", nx " + str(nx) + ", "
+      "nu " + str(nu) + ", ng " + str(ng) + ".");
+    casadi_assert(na_ == std::accumulate(nx.begin()+1, nx.end(), 0) +
+      std::accumulate(ng.begin(), ng.end(), 0),
+      "sum(nx+1)+sum(ng) = must equal total size of constraints (" + str(na_) + "). "
+      "Structure is: N " + str(N_) + ", nx " + str(nx) + ", "
+      "nu " + str(nu) + ", ng " + str(ng) + ".");
+    nus_.push_back(0);
+
+    // Stage of each variable and constraint, the state each dynamic constraint defines
+    std::vector<casadi_int> zstage, rstage, rstate;
+    for (casadi_int k=0; k<=N_; ++k) {
+      zstage.insert(zstage.end(), nxs_[k]+nus_[k], k);
+      if (k<N_) {
+        // The states of stage k+1 start after the variables of stage k
+        for (casadi_int i=0; i<nxs_[k+1]; ++i) {
+          rstage.push_back(k);
+          rstate.push_back(zstage.size()+i);
+        }
+      }
+      rstage.insert(rstage.end(), ngs_[k], k);
+      rstate.insert(rstate.end(), ngs_[k], -1);
+    }
+
+    // The Hessian must be block diagonal
+    const casadi_int *colind = H_.colind(), *row = H_.row();
+    for (casadi_int c=0; c<nx_; ++c) {
+      for (casadi_int k=colind[c]; k<colind[c+1]; ++k) {
+        casadi_assert(zstage[row[k]]==zstage[c], "Hessian entry (" + str(row[k]) + ", "
+          + str(c) + ") couples the stages " + str(zstage[row[k]]) + " and "
+          + str(zstage[c]));
+      }
+    }
+
+    // The constraints may only depend on the variables of their stage, and the dynamic
+    // constraints in addition on the diagonal entry of the state they define
+    colind = A_.colind(); row = A_.row();
+    for (casadi_int c=0; c<nx_; ++c) {
+      for (casadi_int k=colind[c]; k<colind[c+1]; ++k) {
+        casadi_int r = row[k];
+        casadi_assert(zstage[c]==rstage[r] || rstate[r]==c, "Constraint " + str(r)
+          + " of stage " + str(rstage[r]) + " depends on variable " + str(c)
+          + " of stage " + str(zstage[c]));
+      }
+    }
+
+    // Setup memory structure
+    p_.N = N_;
+    p_.nx = get_ptr(nxs_);
+    p_.nu = get_ptr(nus_);
+    p_.ng = get_ptr(ngs_);
+    p_.nz = nx_;
+    p_.na = na_;
+    p_.nd = std::accumulate(nx.begin()+1, nx.end(), 0);
+    p_.nc = std::accumulate(ng.begin(), ng.end(), 0);
+    p_.sp_h = H_;
+    p_.sp_a = A_;
+    p_.max_iter = max_iter_;
+    p_.tol = tol_;
+    p_.inf = inf;
+
+    // Allocate memory
+    casadi_int sz_w, sz_iw;
+    casadi_riccati_work(&p_, &sz_iw, &sz_w);
+    alloc_iw(sz_iw, true);
+    alloc_w(sz_w, true);
+  }
+
+  int Riccati::init_mem(void* mem) const {
+    auto m = static_cast<RiccatiMemory*>(mem);
+    m->return_status = "";
+    m->success = false;
+    m->iter_count = 0;
+    return 0;
+  }
+
+  int Riccati::
+  eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const {
+    auto m = static_cast<RiccatiMemory*>(mem);
+    // Reset statistics
+    for (auto&& s : m->fstats) s.second.reset();
+    // Check inputs
+    if (inputs_check_) {
+      check_inputs(arg[CONIC_LBX], arg[CONIC_UBX], arg[CONIC_LBA], arg[CONIC_UBA]);
+    }
+    // Setup data structure
+    casadi_riccati_data<double> d;
+    d.prob = &p_;
+    casadi_riccati_init(&d, iw, w);
+    // Distribute the problem data over the stages
+    if (casadi_riccati_gather(&d, arg[CONIC_H], arg[CONIC_G], arg[CONIC_A],
+                              arg[CONIC_LBA], arg[CONIC_UBA],
+                              arg[CONIC_LBX], arg[CONIC_UBX])) {
+      casadi_error("The dynamic constraints must be equality constraints depending on "
+                   "the state they define");
+    }
+    // Solve
+    int flag = casadi_riccati_solve(&d);
+    switch (flag) {
+      case 0: m->return_status = "success"; break;
+      case 1: m->return_status = "Maximum number of iterations reached"; break;
+      default: m->return_status = "Reduced Hessian not positive definite"; break;
+    }
+    m->success = flag==0;
+    m->iter_count = d.iter;
+    // Get solution
+    casadi_riccati_scatter(&d, res[CONIC_X], res[CONIC_COST], res[CONIC_LAM_A],
+                           res[CONIC_LAM_X]);
+    if (verbose_) casadi_warning(m->return_status);
+    return 0;
+  }
+
+  Dict Riccati::get_stats(void* mem) const {
+    Dict stats = Conic::get_stats(mem);
+    auto m = static_cast<RiccatiMemory*>(mem);
+    stats["return_status"] = m->return_status;
+    stats["success"] = m->success;
+    stats["iter_count"] = m->iter_count;
+    return stats;
+  }
+
+  void Riccati::codegen_body(CodeGenerator& g) const {
+    g.add_auxiliary(CodeGenerator::AUX_RICCATI);
+    g.local("p", "struct casadi_riccati_prob");
+    g.local("d", "struct casadi_riccati_data");
+
+    g << "p.N = " << N_ << ";\n";
+    g << "p.nx = " << g.constant(nxs_) << ";\n";
+    g << "p.nu = " << g.constant(nus_) << ";\n";
+    g << "p.ng = " << g.constant(ngs_) << ";\n";
+    g << "p.nz = " << p_.nz << ";\n";
+    g << "p.na = " << p_.na << ";\n";
+    g << "p.nd = " << p_.nd << ";\n";
+    g << "p.nc = " << p_.nc << ";\n";
+    g << "p.sp_h = " << g.sparsity(H_) << ";\n";
+    g << "p.sp_a = " << g.sparsity(A_) << ";\n";
+    g << "p.max_iter = " << max_iter_ << ";\n";
+    g << "p.tol = " << g.constant(tol_) << ";\n";
+    g << "p.inf = " << g.constant(inf) << ";\n";
+    g << "d.prob = &p;\n";
+    g << "casadi_riccati_init(&d, iw, w);\n";
+
+    g.comment("Distribute the problem data over the stages");
+    g << "if (casadi_riccati_gather(&d";
+    for (casadi_int i : {CONIC_H, CONIC_G, CONIC_A, CONIC_LBA, CONIC_UBA, CONIC_LBX,
+                         CONIC_UBX}) {
+      g << ", arg[" << i << "]";
+    }
+    g << ")) return 1;\n";
+    g << "casadi_riccati_solve(&d);\n";
+    g << "casadi_riccati_scatter(&d, res[" << CONIC_X << "], res[" << CONIC_COST << "], "
+      << "res[" << CONIC_LAM_A << "], res[" << CONIC_LAM_X << "]);\n";
+  }
+
+} // namespace casadi
@@ -0,0 +1,85 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+
+      #include "riccati.hpp"
+      #include <string>
+
+      const std::string casadi::Riccati::meta_doc=
+      "\n"
+"Solve multistage QPs using an interior point method with a Riccati\n"
+"recursion\n"
+"\n"
+"The structure of the QP is described by the options N, nx, nu and ng, with\n"
+"the same conventions as the hpmpc plugin: the decision variables are\n"
+"ordered as [x_0, u_0, x_1, u_1, ..., x_N], and the constraints as [d_0,\n"
+"c_0, d_1, c_1, ..., d_(N-1), c_(N-1), c_N], where the equality constraints\n"
+"d_k couple x_(k+1) to x_k and u_k, and c_k are the remaining stage\n"
+"constraints. The Hessian must be block diagonal with one block per stage.\n"
+"\n"
+"Each iteration of the Mehrotra predictor-corrector method solves the\n"
+"Newton system by a backward and a forward sweep over the stages, so that\n"
+"the cost grows linearly with the horizon. The method is implemented in the\n"
+"C runtime and can be code generated.\n"
+"\n"
+"\n"
+">List of available options\n"
+"\n"
+"+----------+--------------+--------------------------------------------+\n"
+"|    Id    |     Type     |                Description                 |\n"
+"+==========+==============+============================================+\n"
+"| N        | OT_INT       | OCP horizon                                |\n"
+"+----------+--------------+--------------------------------------------+\n"
+"| max_iter | OT_INT       | Maximum number of iterations [100].        |\n"
+"+----------+--------------+--------------------------------------------+\n"
+"| ng       | OT_INTVECTOR | Number of non-dynamic constraints, length  |\n"
+"|          |              | N+1                                        |\n"
+"+----------+--------------+--------------------------------------------+\n"
+"| nu       | OT_INTVECTOR | Number of controls, length N               |\n"
+"+----------+--------------+--------------------------------------------+\n"
+"| nx       | OT_INTVECTOR | Number of states, length N+1               |\n"
+"+----------+--------------+--------------------------------------------+\n"
+"| tol      | OT_DOUBLE    | Tolerance for the residuals and the        |\n"
+"|          |              | duality measure [1e-8].                    |\n"
+"+----------+--------------+--------------------------------------------+\n"
+"\n"
+"\n"
+">List of available stats\n"
+"\n"
+"+---------------+\n"
+"|      Id       |\n"
+"+===============+\n"
+"| iter_count    |\n"
+"+---------------+\n"
+"| return_status |\n"
+"+---------------+\n"
+"| success       |\n"
+"+---------------+\n"
+"\n"
+"\n"
+"\n"
+"\n"
+;
@@ -201,4 +201,44 @@ namespace casadi {
     }
   }
 
+  void RungeKutta::interpolate(FixedStepMemory* m, double theta,
+                               double* x, double* z, double* q) const {
+    // Weights of the continuous extension, equal to 1/6, 1/3, 1/3, 1/6 for theta=1
+    double t2 = theta*theta, t3 = t2*theta;
+    double b[4] = {theta - 1.5*t2 + 2*t3/3, t2 - 2*t3/3, t2 - 2*t3/3, 2*t3/3 - 0.5*t2};
+
+    // Stage derivatives, times h, follow from the stage states in Z
+    const double *x0 = get_ptr(m->x_prev), *xf = get_ptr(m->x), *s = get_ptr(m->Z);
+    if (x) {
+      for (casadi_int i=0; i<nx_; ++i) {
+        double d1 = 2*(s[i]-x0[i]), d2 = 2*(s[i+nx_]-x0[i]), d3 = s[i+2*nx_]-x0[i];
+        double d4 = 6*(xf[i]-x0[i]) - d1 - 2*d2 - 2*d3;
+        x[i] = x0[i] + b[0]*d1 + b[1]*d2 + b[2]*d3 + b[3]*d4;
+      }
+    }
+
+    // Quadrature derivatives at the stages, calculated once per step
+    if (q && nq_>0) {
+      if (m->k_dense!=m->k) {
+        m->dense.resize(4*nq_);
+        double t0 = m->t - h_, tt[4] = {t0, t0 + h_/2, t0 + h_/2, t0 + h_};
+        const double* xs[4] = {x0, s, s+nx_, s+2*nx_};
+        for (casadi_int j=0; j<4; ++j) {
+          fill_n(m->arg, DAE_NUM_IN, nullptr);
+          m->arg[DAE_X] = xs[j];
+          m->arg[DAE_P] = get_ptr(m->p);
+          m->arg[DAE_T] = tt+j;
+          fill_n(m->res, DAE_NUM_OUT, nullptr);
+          m->res[DAE_QUAD] = get_ptr(m->dense) + j*nq_;
+          if (calc_function(m, "f")) casadi_error("RungeKutta::interpolate: 'f' failed");
+        }
+        m->k_dense = m->k;
+      }
+      casadi_copy(get_ptr(m->q_prev), nq_, q);
+      for (casadi_int j=0; j<4; ++j) {
+        casadi_axpy(nq_, h_*b[j], get_ptr(m->dense) + j*nq_, q);
+      }
+    }
+  }
+
 } // namespace casadi
@@ -75,6 +75,10 @@ namespace casadi {
     /// Setup F and G
     void setupFG() override;
 
+    /// Dense output from the continuous extension of RK4
+    void interpolate(FixedStepMemory* m, double theta,
+                     double* x, double* z, double* q) const override;
+
     /// A documentation string
     static const std::string meta_doc;
 
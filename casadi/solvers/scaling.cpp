@@ -0,0 +1,303 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#include "scaling.hpp"
+
+using namespace std;
+namespace casadi {
+
+  extern "C"
+  int CASADI_NLPSOL_SCALING_EXPORT
+      casadi_register_nlpsol_scaling(Nlpsol::Plugin* plugin) {
+    plugin->creator = Scaling::creator;
+    plugin->name = "scaling";
+    plugin->doc = Scaling::meta_doc.c_str();
+    plugin->version = CASADI_VERSION;
+    plugin->options = &Scaling::options_;
+    return 0;
+  }
+
+  extern "C"
+  void CASADI_NLPSOL_SCALING_EXPORT casadi_load_nlpsol_scaling() {
+    Nlpsol::registerPlugin(casadi_register_nlpsol_scaling);
+  }
+
+  Scaling::Scaling(const std::string& name, const Function& nlp)
+    : Nlpsol(name, nlp) {
+  }
+
+  Scaling::~Scaling() {
+    clear_mem();
+  }
+
+  Options Scaling::options_
+  = {{&Nlpsol::options_},
+     {{"solver",
+       {OT_STRING,
+        "NLP solver applied to the scaled problem [ipopt]"}},
+      {"solver_options",
+       {OT_DICT,
+        "Options to be passed to the NLP solver"}},
+      {"nominal_x",
+       {OT_DOUBLEVECTOR,
+        "Nominal magnitudes of the decision variables: x = nominal_x*xs [1]"}},
+      {"nominal_g",
+       {OT_DOUBLEVECTOR,
+        "Nominal magnitudes of the constraints, replacing the gradient-based scaling: "
+        "dg = 1/nominal_g"}},
+      {"max_gradient",
+       {OT_DOUBLE,
+        "Gradient-based scaling: largest allowed entry of the scaled objective gradient "
+        "and constraint Jacobian rows at the initial guess [100]"}},
+      {"min_scaling",
+       {OT_DOUBLE,
+        "Gradient-based scaling: lower bound on the factors [1e-8]"}}
+     }
+  };
+
+  void Scaling::init(const Dict& opts) {
+    // Call the init method of the base class
+    Nlpsol::init(opts);
+
+    // Default options
+    plugin_ = "ipopt";
+    Dict solver_options;
+    dx_.clear();
+    nominal_g_.clear();
+    max_gradient_ = 100;
+    min_scaling_ = 1e-8;
+
+    // Read user options
+    for (auto&& op : opts) {
+      if (op.first=="solver") {
+        plugin_ = op.second.to_string();
+      } else if (op.first=="solver_options") {
+        solver_options = op.second;
+      } else if (op.first=="nominal_x") {
+        dx_ = op.second;
+      } else if (op.first=="nominal_g") {
+        nominal_g_ = op.second;
+      } else if (op.first=="max_gradient") {
+        max_gradient_ = op.second;
+      } else if (op.first=="min_scaling") {
+        min_scaling_ = op.second;
+      }
+    }
+    if (dx_.empty()) dx_.resize(nx_, 1);
+    casadi_assert(dx_.size()==nx_, "Option 'nominal_x' has length " + str(dx_.size())
+                  + ", expected " + str(nx_));
+    casadi_assert(nominal_g_.empty() || nominal_g_.size()==ng_, "Option 'nominal_g' has length "
+                  + str(nominal_g_.size()) + ", expected " + str(ng_));
+    for (double d : dx_) casadi_assert(d>0, "Option 'nominal_x' must be positive");
+    for (double d : nominal_g_) casadi_assert(d>0, "Option 'nominal_g' must be positive");
+    casadi_assert(max_gradient_>0, "Option 'max_gradient' must be positive");
+
+    // First order derivative information at the initial guess
+    Function jac_fg = create_function("nlp_jac_fg", {"x", "p"},
+                                      {"f", "grad:f:x", "g", "jac:g:x"});
+    jac_g_sp_ = jac_fg.sparsity_out(3);
+
+    // NLP solver of the scaled problem
+    Function nlp = oracle_.is_a("SXFunction") ? scaled_nlp<SX>() : scaled_nlp<MX>();
+    solver_ = nlpsol(name_ + "_" + plugin_, plugin_, nlp, solver_options);
+  }
+
+  template<typename M>
+  Function Scaling::scaled_nlp() const {
+    M xs = M::sym("x", oracle_.sparsity_in(NL_X));
+    M p = M::sym("p", oracle_.sparsity_in(NL_P));
+    M dx = M::sym("dx", oracle_.sparsity_in(NL_X));
+    M dg = M::sym("dg", oracle_.sparsity_out(NL_G));
+    M df = M::sym("df");
+    std::vector<M> r = oracle_(std::vector<M>{dx*xs, p});
+    M pe = vertcat(std::vector<M>{vec(p), vec(dx), vec(dg), df});
+    return Function("nlp", {xs, pe}, {df*r[NL_F], dg*r[NL_G]}, NL_INPUTS, NL_OUTPUTS);
+  }
+
+  int Scaling::init_mem(void* mem) const {
+    if (Nlpsol::init_mem(mem)) return 1;
+    auto m = static_cast<ScalingMemory*>(mem);
+    m->gf.resize(nx_);
+    m->jac_g.resize(jac_g_sp_.nnz());
+    m->dg.resize(ng_);
+    m->x_eval.resize(nx_);
+    m->g_eval.resize(ng_);
+    m->pe.resize(np_+nx_+ng_+1);
+    m->x0s.resize(nx_);
+    m->lbxs.resize(nx_);
+    m->ubxs.resize(nx_);
+    m->lbgs.resize(ng_);
+    m->ubgs.resize(ng_);
+    m->lam_x0s.resize(nx_);
+    m->lam_g0s.resize(ng_);
+    m->xs.resize(nx_);
+    m->gs.resize(ng_);
+    m->lam_xs.resize(nx_);
+    m->lam_gs.resize(ng_);
+    m->lam_pe.resize(m->pe.size());
+    m->solver_arg.resize(solver_.sz_arg());
+    m->solver_res.resize(solver_.sz_res());
+    m->solver_iw.resize(solver_.sz_iw());
+    m->solver_w.resize(solver_.sz_w());
+    m->solver_mem = solver_.checkout();
+    return 0;
+  }
+
+  void Scaling::free_mem(void *mem) const {
+    auto m = static_cast<ScalingMemory*>(mem);
+    solver_.release(m->solver_mem);
+    delete m;
+  }
+
+  void Scaling::scaling_factors(ScalingMemory* m, const double* x) const {
+    m->df = 1;
+    if (nominal_g_.empty()) {
+      fill(m->dg.begin(), m->dg.end(), 1.);
+    } else {
+      for (casadi_int i=0; i<ng_; ++i) m->dg[i] = 1/nominal_g_[i];
+    }
+
+    // Derivatives at x
+    m->arg[0] = x;
+    m->arg[1] = m->p;
+    m->res[0] = &m->f_eval;
+    m->res[1] = get_ptr(m->gf);
+    m->res[2] = get_ptr(m->g_eval);
+    m->res[3] = get_ptr(m->jac_g);
+    if (calc_function(m, "nlp_jac_fg")) {
+      casadi_warning("Scaling: Derivatives not defined at the initial guess, no scaling");
+      return;
+    }
+
+    // Factor bringing the largest entry of v down to max_gradient
+    auto factor = [&](double vmax) {
+      return vmax>max_gradient_ ? fmax(max_gradient_/vmax, min_scaling_) : 1.;
+    };
+
+    // Objective, largest entry of the gradient for the scaled variables
+    double gmax = 0;
+    for (casadi_int i=0; i<nx_; ++i) gmax = fmax(gmax, fabs(m->gf[i])*dx_[i]);
+    m->df = factor(gmax);
+
+    // Constraints, largest entry of each Jacobian row for the scaled variables
+    if (nominal_g_.empty()) {
+      std::vector<double>& rmax = m->g_eval;
+      fill(rmax.begin(), rmax.end(), 0.);
+      const casadi_int *colind = jac_g_sp_.colind(), *row = jac_g_sp_.row();
+      for (casadi_int c=0; c<nx_; ++c) {
+        for (casadi_int k=colind[c]; k<colind[c+1]; ++k) {
+          rmax[row[k]] = fmax(rmax[row[k]], fabs(m->jac_g[k])*dx_[c]);
+        }
+      }
+      for (casadi_int i=0; i<ng_; ++i) m->dg[i] = factor(rmax[i]);
+    }
+  }
+
+  int Scaling::solve(void* mem) const {
+    auto m = static_cast<ScalingMemory*>(mem);
+
+    // Scaling factors at the initial guess, projected onto the bounds
+    for (casadi_int i=0; i<nx_; ++i) {
+      double x = m->x[i];
+      if (m->lbx) x = fmax(x, m->lbx[i]);
+      if (m->ubx) x = fmin(x, m->ubx[i]);
+      m->x_eval[i] = x;
+    }
+    scaling_factors(m, get_ptr(m->x_eval));
+    double df = m->df;
+    const double* dg = get_ptr(m->dg);
+
+    // Parameters of the scaled problem
+    double* pe = get_ptr(m->pe);
+    casadi_copy(m->p, np_, pe); pe += np_;
+    casadi_copy(get_ptr(dx_), nx_, pe); pe += nx_;
+    casadi_copy(dg, ng_, pe); pe += ng_;
+    *pe = df;
+
+    // Scaled initial guess and bounds
+    for (casadi_int i=0; i<nx_; ++i) {
+      m->x0s[i] = m->x[i]/dx_[i];
+      if (m->lbx) m->lbxs[i] = m->lbx[i]/dx_[i];
+      if (m->ubx) m->ubxs[i] = m->ubx[i]/dx_[i];
+      m->lam_x0s[i] = m->lam_x[i]*dx_[i]*df;
+    }
+    for (casadi_int i=0; i<ng_; ++i) {
+      if (m->lbg) m->lbgs[i] = m->lbg[i]*dg[i];
+      if (m->ubg) m->ubgs[i] = m->ubg[i]*dg[i];
+      m->lam_g0s[i] = m->lam_g[i]*df/dg[i];
+    }
+
+    // Solve the scaled problem
+    const double** arg = get_ptr(m->solver_arg);
+    double** res = get_ptr(m->solver_res);
+    fill_n(arg, NLPSOL_NUM_IN, nullptr);
+    arg[NLPSOL_X0] = get_ptr(m->x0s);
+    arg[NLPSOL_P] = get_ptr(m->pe);
+    arg[NLPSOL_LBX] = m->lbx ? get_ptr(m->lbxs) : nullptr;
+    arg[NLPSOL_UBX] = m->ubx ? get_ptr(m->ubxs) : nullptr;
+    arg[NLPSOL_LBG] = m->lbg ? get_ptr(m->lbgs) : nullptr;
+    arg[NLPSOL_UBG] = m->ubg ? get_ptr(m->ubgs) : nullptr;
+    arg[NLPSOL_LAM_X0] = get_ptr(m->lam_x0s);
+    arg[NLPSOL_LAM_G0] = get_ptr(m->lam_g0s);
+    res[NLPSOL_X] = get_ptr(m->xs);
+    res[NLPSOL_F] = &m->fs;
+    res[NLPSOL_G] = get_ptr(m->gs);
+    res[NLPSOL_LAM_X] = get_ptr(m->lam_xs);
+    res[NLPSOL_LAM_G] = get_ptr(m->lam_gs);
+    res[NLPSOL_LAM_P] = get_ptr(m->lam_pe);
+    solver_(arg, res, get_ptr(m->solver_iw), get_ptr(m->solver_w), m->solver_mem);
+    m->solver_stats = solver_.stats(m->solver_mem);
+    m->success = m->solver_stats.at("success");
+    auto it = m->solver_stats.find("return_status");
+    m->return_status = it==m->solver_stats.end() ? "" : it->second.to_string();
+
+    // Solution of the original problem
+    for (casadi_int i=0; i<nx_; ++i) {
+      m->x[i] = m->xs[i]*dx_[i];
+      m->lam_x[i] = m->lam_xs[i]/(dx_[i]*df);
+    }
+    for (casadi_int i=0; i<ng_; ++i) {
+      m->g[i] = m->gs[i]/dg[i];
+      m->lam_g[i] = m->lam_gs[i]*dg[i]/df;
+    }
+    for (casadi_int i=0; i<np_; ++i) m->lam_p[i] = m->lam_pe[i]/df;
+    m->f = m->fs/df;
+    return 0;
+  }
+
+  Dict Scaling::get_stats(void* mem) const {
+    Dict stats = Nlpsol::get_stats(mem);
+    auto m = static_cast<ScalingMemory*>(mem);
+    stats["return_status"] = m->return_status;
+    auto it = m->solver_stats.find("iter_count");
+    if (it!=m->solver_stats.end()) stats["iter_count"] = it->second;
+    stats["solver_stats"] = m->solver_stats;
+    stats["scale_f"] = m->df;
+    stats["scale_g"] = m->dg;
+    return stats;
+  }
+
+} // namespace casadi
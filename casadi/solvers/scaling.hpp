@@ -0,0 +1,149 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#ifndef CASADI_SCALING_HPP
+#define CASADI_SCALING_HPP
+
+#include "casadi/core/nlpsol_impl.hpp"
+#include <casadi/solvers/casadi_nlpsol_scaling_export.h>
+
+/** \defgroup plugin_Nlpsol_scaling
+ Scaling of the NLP: solves x = nominal_x*xs, min df*f(x) s.t. dg*g(x)
+ with another NLP solver and maps the solution back.
+ Unless given as 'nominal_g', the factors df and dg are computed at the initial
+ guess from the gradient of the objective and the rows of the constraint Jacobian,
+ such that no entry exceeds 'max_gradient'. The factors enter the scaled problem
+ as parameters and are recomputed for every solve.
+*/
+
+/** \pluginsection{Nlpsol,scaling} */
+
+/// \cond INTERNAL
+namespace casadi {
+
+  struct CASADI_NLPSOL_SCALING_EXPORT ScalingMemory : public NlpsolMemory {
+    // Derivatives at the initial guess
+    std::vector<double> gf, jac_g;
+
+    // Scaling factors of the constraints and the objective
+    std::vector<double> dg;
+    double df;
+
+    // Point where the factors are computed
+    std::vector<double> x_eval, g_eval;
+    double f_eval;
+
+    // Inputs and outputs of the scaled problem
+    std::vector<double> pe, x0s, lbxs, ubxs, lbgs, ubgs, lam_x0s, lam_g0s;
+    std::vector<double> xs, gs, lam_xs, lam_gs, lam_pe;
+    double fs;
+
+    // Memory and work vectors of the NLP solver
+    casadi_int solver_mem;
+    std::vector<const double*> solver_arg;
+    std::vector<double*> solver_res;
+    std::vector<casadi_int> solver_iw;
+    std::vector<double> solver_w;
+
+    // Statistics of the NLP solver
+    Dict solver_stats;
+    std::string return_status;
+  };
+
+  /** \brief \pluginbrief{Nlpsol,scaling}
+   *  @copydoc NlpSolver_doc
+   *  @copydoc plugin_Nlpsol_scaling
+   */
+  class CASADI_NLPSOL_SCALING_EXPORT Scaling : public Nlpsol {
+  public:
+    explicit Scaling(const std::string& name, const Function& nlp);
+    ~Scaling() override;
+
+    // Get name of the plugin
+    const char* plugin_name() const override { return "scaling";}
+
+    // Name of the class
+    std::string class_name() const override { return "Scaling";}
+
+    /** \brief  Create a new NLP Solver */
+    static Nlpsol* creator(const std::string& name, const Function& nlp) {
+      return new Scaling(name, nlp);
+    }
+
+    ///@{
+    /** \brief Options */
+    static Options options_;
+    const Options& get_options() const override { return options_;}
+    ///@}
+
+    /// Get all statistics
+    Dict get_stats(void* mem) const override;
+
+    // Initialize the solver
+    void init(const Dict& opts) override;
+
+    /** \brief Create memory block */
+    void* alloc_mem() const override { return new ScalingMemory();}
+
+    /** \brief Initalize memory block */
+    int init_mem(void* mem) const override;
+
+    /** \brief Free memory block */
+    void free_mem(void *mem) const override;
+
+    // Solve the NLP
+    int solve(void* mem) const override;
+
+    /// A documentation string
+    static const std::string meta_doc;
+
+    // Scaled NLP, the scaling factors appended to the parameters
+    template<typename M>
+    Function scaled_nlp() const;
+
+    // Compute the scaling factors at the point x
+    void scaling_factors(ScalingMemory* m, const double* x) const;
+
+    // NLP solver of the scaled problem
+    std::string plugin_;
+    Function solver_;
+
+    // Nominal magnitudes of the variables
+    std::vector<double> dx_;
+
+    // Nominal magnitudes of the constraints, empty for gradient-based scaling
+    std::vector<double> nominal_g_;
+
+    // Gradient-based scaling
+    double max_gradient_, min_scaling_;
+
+    // Sparsity of the constraint Jacobian
+    Sparsity jac_g_sp_;
+  };
+
+} // namespace casadi
+/// \endcond
+#endif // CASADI_SCALING_HPP
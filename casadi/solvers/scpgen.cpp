@@ -25,6 +25,7 @@
 
 #include "scpgen.hpp"
 #include "casadi/core/core.hpp"
+#include "casadi/core/thread_pool.hpp"
 #include <ctime>
 #include <iomanip>
 #include <fstream>
@@ -112,6 +113,12 @@ namespace casadi {
       {"codegen",
        {OT_BOOL,
         "C-code generation"}},
+      {"max_num_threads",
+       {OT_INT,
+        "Evaluate independent calls in the lifted functions, e.g. the stages of a "
+        "multiple shooting discretization, and the Gauss-Newton condensing in parallel, "
+        "using at most this many threads. The lifted functions are evaluated serially "
+        "when combined with 'codegen' [1]"}},
       {"reg_threshold",
        {OT_DOUBLE,
         "Threshold for the regularization."}},
@@ -139,6 +146,7 @@ namespace casadi {
     tol_reg_ = 1e-11;
     regularize_ = false;
     codegen_ = false;
+    max_num_threads_ = 1;
     reg_threshold_ = 1e-8;
     tol_pr_step_ = 1e-6;
     merit_memsize_ = 4;
@@ -170,6 +178,8 @@ namespace casadi {
         regularize_ = op.second;
       } else if (op.first=="codegen") {
         codegen_ = op.second;
+      } else if (op.first=="max_num_threads") {
+        max_num_threads_ = op.second;
       } else if (op.first=="reg_threshold") {
         reg_threshold_ = op.second;
       } else if (op.first=="tol_pr_step") {
@@ -195,6 +205,13 @@ namespace casadi {
 
     // Gauss-Newton Hessian?
     gauss_newton_ = hessian_approximation == "gauss-newton";
+    casadi_assert(max_num_threads_>=1, "Option 'max_num_threads' must be positive");
+
+    // Lifted functions: calls on the same level of the MX graph concurrently
+    Dict fcn_opts;
+    if (max_num_threads_>1 && !codegen_) {
+      fcn_opts = {{"parallel", true}, {"max_num_threads", max_num_threads_}};
+    }
 
     // Name the components
     if (name_x_.empty()) {
@@ -327,7 +344,7 @@ namespace casadi {
     }
 
     // Generate function
-    Function res_fcn("res_fcn", res_fcn_in, res_fcn_out);
+    Function res_fcn("res_fcn", res_fcn_in, res_fcn_out, fcn_opts);
     if (verbose_) {
       uout() << "Generated residual function ( " << res_fcn.n_nodes() << " nodes)." << endl;
     }
@@ -433,7 +450,7 @@ namespace casadi {
     vector<MX> mat_out;
     mat_out.push_back(jac);                             mat_jac_ = n++;
     mat_out.push_back(hes);                             mat_hes_ = n++;
-    Function mat_fcn("mat_fcn", mfcn_in, mat_out);
+    Function mat_fcn("mat_fcn", mfcn_in, mat_out, fcn_opts);
 
     // Definition of intermediate variables
     n = mfcn_out.size();
@@ -471,7 +488,7 @@ namespace casadi {
     vec_fcn_out.push_back(b_g);                               vec_g_ = n++;
     casadi_assert_dev(n==vec_fcn_out.size());
 
-    Function vec_fcn("vec_fcn", mfcn_in, vec_fcn_out);
+    Function vec_fcn("vec_fcn", mfcn_in, vec_fcn_out, fcn_opts);
     if (verbose_) {
       uout() << "Generated linearization function ( " << vec_fcn.n_nodes()
            << " nodes)." << endl;
@@ -519,7 +536,7 @@ namespace casadi {
     }
 
     // Step expansion function
-    Function exp_fcn("exp_fcn", mfcn_in, exp_fcn_out);
+    Function exp_fcn("exp_fcn", mfcn_in, exp_fcn_out, fcn_opts);
     if (verbose_) {
       uout() << "Generated step expansion function ( " << exp_fcn.n_nodes() << " nodes)."
            << endl;
@@ -571,6 +588,7 @@ namespace casadi {
     // Allocate a QP solver
     spL_ = mat_fcn_.sparsity_out(mat_hes_);
     spH_ = mtimes(spL_.T(), spL_);
+    if (gauss_newton_) spH_.transpose(spH_tr_);
     spA_ = mat_fcn_.sparsity_out(mat_jac_);
     casadi_assert(!qpsol_plugin.empty(), "'qpsol' option has not been set");
     qpsol_ = conic("qpsol", qpsol_plugin, {{"h", spH_}, {"a", spA_}},
@@ -679,7 +697,7 @@ namespace casadi {
     alloc(vec_fcn_);
     alloc(exp_fcn_);
     if (gauss_newton_) {
-      alloc_w(ngn_); // casadi_mul to get GN Hessian
+      alloc_w(ngn_*max_num_threads_); // Dense columns of L for the GN Hessian
     }
     alloc(qpsol_);
   }
@@ -694,6 +712,14 @@ namespace casadi {
       m->lifted_mem[i].n = v_[i].n;
     }
 
+    // Warm start
+    if (warm_start_) {
+      if (!gauss_newton_) {
+        for (auto&& v : m->lifted_mem) v.ws_lam.resize(v.n);
+      }
+      m->ws_merit.resize(merit_memsize_);
+    }
+
     return 0;
   }
 
@@ -779,15 +805,25 @@ namespace casadi {
     casadi_fill(m->dlam_gk, ng_, 0.);
     casadi_fill(m->lam_xk, nx_, 0.);
     casadi_fill(m->dlam_xk, nx_, 0.);
+    bool warm = warm_start_ && m->warm;
     if (!gauss_newton_) {
       for (auto&& v : m->lifted_mem) {
-        casadi_fill(v.lam, v.n, 0.);
+        if (warm) {
+          casadi_copy(get_ptr(v.ws_lam), v.n, v.lam);
+        } else {
+          casadi_fill(v.lam, v.n, 0.);
+        }
         casadi_fill(v.dlam, v.n, 0.);
       }
     }
 
-    // Reset line-search
-    m->merit_ind = 0;
+    // Reset line-search, unless warm starting from the previous call
+    if (warm) {
+      m->merit_ind = m->ws_merit_ind;
+      casadi_copy(get_ptr(m->ws_merit), merit_memsize_, m->merit_mem);
+    } else {
+      m->merit_ind = 0;
+    }
 
     // Current guess for the primal solution
     for (auto&& v : m->lifted_mem) {
@@ -833,6 +869,10 @@ namespace casadi {
       // 1-norm of the dual infeasibility
       double du_inf = dualInfeasibility(m);
 
+      // Record the iterate
+      m->trace.record(m->iter_count, {m->f, pr_inf, du_inf, m->pr_step, m->du_step, m->reg,
+                                      static_cast<double>(ls_iter), ls_success ? 1. : 0.});
+
       // Print header occasionally
       if (m->iter_count % 10 == 0) printIteration(m, uout());
 
@@ -855,6 +895,13 @@ namespace casadi {
         break;
       }
 
+      if (m->deadline.expired()) {
+        uout() << endl;
+        uout() << "casadi::SCPgen: " << (m->deadline.cancelled() ? "Cancelled."
+                  : "Maximum wall time exceeded.") << endl;
+        break;
+      }
+
       // Check if not-a-number
       if (m->f!=m->f || m->pr_step != m->pr_step || pr_inf != pr_inf) {
         uout() << "casadi::SCPgen: Aborted, nan detected" << endl;
@@ -889,6 +936,16 @@ namespace casadi {
     casadi_copy(m->lam_xk, nx_, m->lam_x);
     casadi_copy(m->gk, ng_, m->g);
 
+    // Keep the multipliers of the lifted variables and the merit memory for the next call
+    if (warm_start_) {
+      if (!gauss_newton_) {
+        for (auto&& v : m->lifted_mem) casadi_copy(v.lam, v.n, get_ptr(v.ws_lam));
+      }
+      m->ws_merit_ind = m->merit_ind;
+      casadi_copy(m->merit_mem, merit_memsize_, get_ptr(m->ws_merit));
+      m->warm = true;
+    }
+
     // Write timers
     if (print_time_) {
       uout() << endl;
@@ -1008,13 +1065,36 @@ namespace casadi {
     mat_fcn_(m->arg, m->res, m->iw, m->w, 0);
 
     if (gauss_newton_) {
-      // Gauss-Newton Hessian
-      casadi_fill(m->qpH, spH_.nnz(), 0.);
-      casadi_mtimes(m->qpL, spL_, m->qpL, spL_, m->qpH, spH_, m->w, true);
-
-      // Gradient of the objective in Gauss-Newton
-      casadi_fill(m->gfk, nx_, 0.);
-      casadi_mv(m->qpL, spL_, m->b_gn, m->gfk, true);
+      // Gauss-Newton Hessian L'*L and gradient L'*b, the columns are independent
+      const casadi_int *l_colind = spL_.colind(), *l_row = spL_.row();
+      const casadi_int *h_colind = spH_.colind(), *h_row = spH_.row();
+      casadi_int nt = std::min(max_num_threads_, nx_);
+      ThreadPool::run(nt, nt, [&](casadi_int t, casadi_int) {
+        double* w = m->w + t*ngn_;
+        casadi_fill(w, ngn_, 0.);
+        for (casadi_int c=t*nx_/nt; c<(t+1)*nx_/nt; ++c) {
+          // Dense column c of L
+          for (casadi_int k=l_colind[c]; k<l_colind[c+1]; ++k) w[l_row[k]] = m->qpL[k];
+          // Upper triangle of column c of the Hessian
+          for (casadi_int k=h_colind[c]; k<h_colind[c+1] && h_row[k]<=c; ++k) {
+            casadi_int r = h_row[k];
+            double s = 0;
+            for (casadi_int k2=l_colind[r]; k2<l_colind[r+1]; ++k2) s += m->qpL[k2]*w[l_row[k2]];
+            m->qpH[k] = s;
+          }
+          for (casadi_int k=l_colind[c]; k<l_colind[c+1]; ++k) w[l_row[k]] = 0;
+          // Gradient of the objective
+          double s = 0;
+          for (casadi_int k=l_colind[c]; k<l_colind[c+1]; ++k) s += m->qpL[k]*m->b_gn[l_row[k]];
+          m->gfk[c] = s;
+        }
+      });
+      // Strictly lower triangle by symmetry
+      for (casadi_int c=0; c<nx_; ++c) {
+        for (casadi_int k=h_colind[c]; k<h_colind[c+1]; ++k) {
+          if (h_row[k]>c) m->qpH[k] = m->qpH[spH_tr_[k]];
+        }
+      }
     }
 
     // Calculate the gradient of the lagrangian
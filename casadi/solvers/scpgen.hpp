@@ -49,6 +49,8 @@ namespace casadi {
       casadi_int n;
       double *dx, *x0, *x, *lam, *dlam;
       double *res, *resL;
+      // Multipliers kept for warm starting
+      std::vector<double> ws_lam;
     };
     std::vector<VarMem> lifted_mem;
 
@@ -77,6 +79,10 @@ namespace casadi {
     double* merit_mem;
     casadi_int merit_ind;
 
+    // Merit function memory kept for warm starting
+    std::vector<double> ws_merit;
+    casadi_int ws_merit_ind;
+
     // Timers
     double t_eval_mat, t_eval_res, t_eval_vec, t_eval_exp, t_solve_qp, t_mainloop;
 
@@ -129,6 +135,11 @@ namespace casadi {
     /// Get all statistics
     Dict get_stats(void* mem) const override;
 
+    /// Columns of the iteration trace
+    std::vector<std::string> trace_columns() const override {
+      return {"f", "inf_pr", "inf_du", "pr_step", "du_step", "reg", "ls_trials", "ls_success"};
+    }
+
     /** \brief Set the (persistent) work vectors */
     void set_work(void* mem, const double**& arg, double**& res,
                           casadi_int*& iw, double*& w) const override;
@@ -210,6 +221,9 @@ namespace casadi {
     /// Enable Code generation
     bool codegen_;
 
+    /// Maximum number of threads for the lifted functions and the condensing
+    casadi_int max_num_threads_;
+
     /// Access qpsol
     const Function getConic() const { return qpsol_;}
 
@@ -273,6 +287,9 @@ namespace casadi {
     // QP sparsity
     Sparsity spH_, spA_, spL_;
 
+    // Nonzero of the Gauss-Newton Hessian mirrored into each nonzero
+    std::vector<casadi_int> spH_tr_;
+
     // Print options
     bool print_header_;
 
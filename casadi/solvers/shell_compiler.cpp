@@ -27,6 +27,7 @@
 #include "casadi/core/casadi_misc.hpp"
 #include "casadi/core/casadi_meta.hpp"
 #include "casadi/core/casadi_logger.hpp"
+#include "casadi/core/thread_pool.hpp"
 #include <fstream>
 
 // Set default object file suffix
@@ -71,6 +72,9 @@ namespace casadi {
     if (cleanup_) {
       if (remove(bin_name_.c_str())) casadi_warning("Failed to remove " + bin_name_);
       if (remove(obj_name_.c_str())) casadi_warning("Failed to remove " + obj_name_);
+      for (const std::string& s : extra_obj_names_) {
+        if (remove(s.c_str())) casadi_warning("Failed to remove " + s);
+      }
       for (const std::string& s : extra_suffixes_) {
         std::string name = base_name_+s;
         remove(name.c_str());
@@ -119,7 +123,16 @@ namespace casadi {
        "Linker flag to denote shared library output. Default: '-o '"}},
       {"extra_suffixes",
        {OT_STRINGVECTOR,
-       "List of suffixes for extra files that the compiler may generate. Default: None"}}
+       "List of suffixes for extra files that the compiler may generate. Default: None"}},
+      {"extra_sources",
+       {OT_STRINGVECTOR,
+       "Additional source files to be compiled and linked into the same library, "
+       "e.g. the translation units written by CodeGenerator with the 'split' option. "
+       "Default: None"}},
+      {"max_num_threads",
+       {OT_INT,
+       "Maximum number of sources to compile in parallel. "
+       "Default: number of hardware threads"}}
      }
   };
 
@@ -134,6 +147,8 @@ namespace casadi {
     vector<string> compiler_flags;
     vector<string> linker_flags;
     string suffix = OBJECT_FILE_SUFFIX;
+    vector<string> extra_sources;
+    casadi_int max_num_threads = ThreadPool::hardware_concurrency();
 
 #ifdef _WIN32
     string compiler = "cl.exe";
@@ -174,6 +189,11 @@ namespace casadi {
         linker_output_flag = op.second.to_string();
       } else if (op.first=="extra_suffixes") {
         extra_suffixes_ = op.second.to_string_vector();
+      } else if (op.first=="extra_sources") {
+        extra_sources = op.second.to_string_vector();
+      } else if (op.first=="max_num_threads") {
+        max_num_threads = op.second;
+        casadi_assert(max_num_threads>=1, "Option 'max_num_threads' must be positive");
       }
     }
 
@@ -194,24 +214,40 @@ namespace casadi {
     }
 #endif // _WIN32
 
-    // Construct the compiler command
-    stringstream cccmd;
-    cccmd << compiler;
-    for (vector<string>::const_iterator i=compiler_flags.begin(); i!=compiler_flags.end(); ++i) {
-      cccmd << " " << *i;
+    // Object files for the additional sources
+    for (casadi_int i=0; i<extra_sources.size(); ++i) {
+      extra_obj_names_.push_back(base_name_ + "_" + str(i+1) + suffix);
     }
-    cccmd << " " << compiler_setup;
 
-    // C/C++ source file
-    cccmd << " " << name_;
+    // Construct the compiler commands
+    vector<string> sources = {name_}, objects = {obj_name_};
+    sources.insert(sources.end(), extra_sources.begin(), extra_sources.end());
+    objects.insert(objects.end(), extra_obj_names_.begin(), extra_obj_names_.end());
+    vector<string> cccmds;
+    for (casadi_int k=0; k<sources.size(); ++k) {
+      stringstream cccmd;
+      cccmd << compiler;
+      for (vector<string>::const_iterator i=compiler_flags.begin(); i!=compiler_flags.end(); ++i) {
+        cccmd << " " << *i;
+      }
+      cccmd << " " << compiler_setup;
 
-    // Temporary object file
-    cccmd << " " + compiler_output_flag << obj_name_;
+      // C/C++ source file
+      cccmd << " " << sources[k];
+
+      // Temporary object file
+      cccmd << " " + compiler_output_flag << objects[k];
+      cccmds.push_back(cccmd.str());
+      if (verbose_) uout() << "calling \"" << cccmds.back() + "\"" << std::endl;
+    }
 
-    // Compile into an object
-    if (verbose_) uout() << "calling \"" << cccmd.str() + "\"" << std::endl;
-    if (system(cccmd.str().c_str())) {
-      casadi_error("Compilation failed. Tried \"" + cccmd.str() + "\"");
+    // Compile into objects, independent sources in parallel
+    vector<int> failed(cccmds.size(), 0);
+    ThreadPool::run(cccmds.size(), max_num_threads, [&](casadi_int k, casadi_int t) {
+      failed[k] = system(cccmds[k].c_str());
+    });
+    for (casadi_int k=0; k<cccmds.size(); ++k) {
+      if (failed[k]) casadi_error("Compilation failed. Tried \"" + cccmds[k] + "\"");
     }
 
     // Link step
@@ -223,7 +259,8 @@ namespace casadi {
     ldcmd << " " << linker_setup;
 
     // Temporary file
-    ldcmd << " " << obj_name_ << " " + linker_output_flag + bin_name_;
+    for (const std::string& o : objects) ldcmd << " " << o;
+    ldcmd << " " + linker_output_flag + bin_name_;
 
     // Compile into a shared library
     if (verbose_) uout() << "calling \"" << ldcmd.str() << "\"" << std::endl;
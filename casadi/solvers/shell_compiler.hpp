@@ -90,6 +90,9 @@ namespace casadi {
     /// Temporary file
     std::string obj_name_;
 
+    /// Object files of additional sources
+    std::vector<std::string> extra_obj_names_;
+
     /// Extra files
     std::vector<std::string> extra_suffixes_;
 
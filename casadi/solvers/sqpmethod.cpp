@@ -56,6 +56,7 @@ namespace casadi {
 
   Sqpmethod::Sqpmethod(const std::string& name, const Function& nlp)
     : Nlpsol(name, nlp) {
+    rti_mem_ = -1;
   }
 
   Sqpmethod::~Sqpmethod() {
@@ -103,6 +104,10 @@ namespace casadi {
       {"regularize",
        {OT_BOOL,
         "Automatic regularization of Lagrange Hessian."}},
+      {"block_hess",
+       {OT_BOOL,
+        "Detect the diagonal blocks of the Lagrange Hessian and update the BFGS "
+        "approximation blockwise, keeping the QP subproblems sparse [false]"}},
       {"print_header",
        {OT_BOOL,
         "Print the header with problem statistics"}},
@@ -115,6 +120,12 @@ namespace casadi {
       {"min_step_size",
        {OT_DOUBLE,
         "The size (inf-norm) of the step size should not become smaller than this."}},
+      {"rti",
+       {OT_BOOL,
+        "Real-time iteration: perform a single full SQP step per call. The preparation "
+        "(linearization at the guess) and feedback (QP solution with the current bounds) "
+        "phases are also available as the functions 'rti_prepare' and 'rti_feedback' "
+        "of the solver [false]"}}
      }
   };
 
@@ -140,6 +151,8 @@ namespace casadi {
     print_header_ = true;
     print_iteration_ = true;
     print_status_ = true;
+    rti_ = false;
+    block_hess_ = false;
 
     // Read user options
     for (auto&& op : opts) {
@@ -177,6 +190,10 @@ namespace casadi {
         print_iteration_ = op.second;
       } else if (op.first=="print_status") {
         print_status_ = op.second;
+      } else if (op.first=="rti") {
+        rti_ = op.second;
+      } else if (op.first=="block_hess") {
+        block_hess_ = op.second;
       }
     }
 
@@ -194,8 +211,38 @@ namespace casadi {
       Function hess_l_fcn = create_function("nlp_hess_l", {"x", "p", "lam:f", "lam:g"},
                                            {"sym:hess:gamma:x:x"}, {{"gamma", {"f", "g"}}});
       Hsp_ = hess_l_fcn.sparsity_out(0);
+    } else if (block_hess_) {
+      // Get the sparsity pattern for the Hessian of the Lagrangian
+      Function grad_lag = oracle_.factory("grad_lag",
+                                          {"x", "p", "lam:f", "lam:g"}, {"grad:gamma:x"},
+                                          {{"gamma", {"f", "g"}}});
+      Sparsity Hsp = grad_lag.sparsity_jac("x", "grad_gamma_x", false, true);
+      Hsp = Hsp + Sparsity::diag(nx_);
+
+      // Find the diagonal blocks, assuming the variables are ordered
+      const casadi_int* colind = Hsp.colind();
+      const casadi_int* row = Hsp.row();
+      blocks_ = {0};
+      casadi_int ind = 0;
+      while (ind < nx_) {
+        casadi_int next=ind+1;
+        while (ind<next && ind<nx_) {
+          for (casadi_int k=colind[ind]; k<colind[ind+1]; ++k) next = max(next, 1+row[k]);
+          ind++;
+        }
+        blocks_.push_back(next);
+      }
+
+      // Dense blocks, updated separately
+      Hsp_blocks_.clear();
+      for (casadi_int b=0; b+1<blocks_.size(); ++b) {
+        Hsp_blocks_.push_back(Sparsity::dense(blocks_[b+1]-blocks_[b], blocks_[b+1]-blocks_[b]));
+      }
+      Hsp_ = diagcat(Hsp_blocks_);
     } else {
       Hsp_ = Sparsity::dense(nx_, nx_);
+      blocks_ = {0, nx_};
+      Hsp_blocks_ = {Hsp_};
     }
 
 
@@ -218,6 +265,8 @@ namespace casadi {
         print("Using exact Hessian\n");
       } else {
         print("Using limited memory BFGS Hessian approximation\n");
+        if (block_hess_) print("Number of Hessian blocks:                  %9d\n",
+                               Hsp_blocks_.size());
       }
       print("Number of variables:                       %9d\n", nx_);
       print("Number of constraints:                     %9d\n", ng_);
@@ -303,9 +352,38 @@ namespace casadi {
     m->iter_count = -1;
   }
 
+  int Sqpmethod::init_mem(void* mem) const {
+    if (Nlpsol::init_mem(mem)) return 1;
+    auto m = static_cast<SqpmethodMemory*>(mem);
+    m->rti_phase = SQP_RTI_BOTH;
+    m->rti_count = 0;
+    m->rti_prepared = false;
+    if (warm_start_) {
+      if (!exact_hessian_) m->ws_Bk.resize(Hsp_.nnz());
+      m->ws_merit.resize(merit_memsize_);
+    }
+    if (rti_) {
+      m->rti_x.resize(nx_);
+      m->rti_gf.resize(nx_);
+      m->rti_g.resize(ng_);
+      m->rti_Jk.resize(Asp_.nnz());
+      m->rti_Bk.resize(Hsp_.nnz());
+      m->rti_lam_x.resize(nx_);
+      m->rti_lam_g.resize(ng_);
+    }
+    return 0;
+  }
+
   int Sqpmethod::solve(void* mem) const {
     auto m = static_cast<SqpmethodMemory*>(mem);
 
+    // Real-time iteration
+    if (rti_) {
+      if (m->rti_phase!=SQP_RTI_FEEDBACK && rti_prepare(m)) return 1;
+      if (m->rti_phase!=SQP_RTI_PREPARE && rti_feedback(m)) return 1;
+      return 0;
+    }
+
     // Number of SQP iterations
     m->iter_count = 0;
 
@@ -315,9 +393,17 @@ namespace casadi {
     // Last linesearch successfull
     bool ls_success = true;
 
-    // Reset
-    m->merit_ind = 0;
-    m->sigma = 0.;    // NOTE: Move this into the main optimization loop
+    // Reset, unless warm starting from the previous call
+    bool warm = warm_start_ && m->warm;
+    if (warm) {
+      m->merit_ind = m->ws_merit_ind;
+      casadi_copy(get_ptr(m->ws_merit), merit_memsize_, m->merit_mem);
+      m->sigma = m->ws_sigma;
+      if (!exact_hessian_) casadi_copy(get_ptr(m->ws_Bk), Hsp_.nnz(), m->Bk);
+    } else {
+      m->merit_ind = 0;
+      m->sigma = 0.;    // NOTE: Move this into the main optimization loop
+    }
     m->reg = 0;
 
     // Default stepsize
@@ -326,16 +412,26 @@ namespace casadi {
     // For seeds
     const double one = 1.;
 
+    // Evaluate the exact Hessian together with the first order derivative information
+    bool hess_concurrent = exact_hessian_ && max_num_threads_>1;
+
     // MAIN OPTIMIZATION LOOP
     while (true) {
       // Evaluate f, g and first order derivative information
-      m->arg[0] = m->x;
-      m->arg[1] = m->p;
-      m->res[0] = &m->f;
-      m->res[1] = m->gf;
-      m->res[2] = m->g;
-      m->res[3] = m->Jk;
-      if (calc_function(m, "nlp_jac_fg")) return 1;
+      if (hess_concurrent) {
+        if (calc_functions(m, {{"nlp_jac_fg", {m->x, m->p}, {&m->f, m->gf, m->g, m->Jk}},
+                               {"nlp_hess_l", {m->x, m->p, &one, m->lam_g}, {m->Bk}}})) {
+          return 1;
+        }
+      } else {
+        m->arg[0] = m->x;
+        m->arg[1] = m->p;
+        m->res[0] = &m->f;
+        m->res[1] = m->gf;
+        m->res[2] = m->g;
+        m->res[3] = m->Jk;
+        if (calc_function(m, "nlp_jac_fg")) return 1;
+      }
 
       // Evaluate the gradient of the Lagrangian
       casadi_copy(m->gf, nx_, m->gLag);
@@ -352,6 +448,10 @@ namespace casadi {
       // inf-norm of step
       double dx_norminf = casadi_norm_inf(nx_, m->dx);
 
+      // Record the iterate
+      m->trace.record(m->iter_count, {m->f, pr_inf, gLag_norminf, dx_norminf, m->reg,
+                                      static_cast<double>(ls_iter), ls_success ? 1. : 0.});
+
       // Printing information about the actual iterate
       if (print_iteration_) {
         if (m->iter_count % 10 == 0) print_iteration();
@@ -381,6 +481,17 @@ namespace casadi {
         break;
       }
 
+      if (m->deadline.expired()) {
+        if (m->deadline.cancelled()) {
+          if (print_status_) print("MESSAGE(sqpmethod): Cancelled.\n");
+          m->return_status = "User_Requested_Stop";
+        } else {
+          if (print_status_) print("MESSAGE(sqpmethod): Maximum wall time exceeded.\n");
+          m->return_status = "Maximum_WallTime_Exceeded";
+        }
+        break;
+      }
+
       if (m->iter_count >= 1 && m->iter_count >= min_iter_ && dx_norminf <= min_step_size_) {
         if (print_status_) print("MESSAGE(sqpmethod): Search direction becomes too small without "
               "convergence criteria being met.\n");
@@ -390,12 +501,14 @@ namespace casadi {
 
       if (exact_hessian_) {
         // Update/reset exact Hessian
-        m->arg[0] = m->x;
-        m->arg[1] = m->p;
-        m->arg[2] = &one;
-        m->arg[3] = m->lam_g;
-        m->res[0] = m->Bk;
-        if (calc_function(m, "nlp_hess_l")) return 1;
+        if (!hess_concurrent) {
+          m->arg[0] = m->x;
+          m->arg[1] = m->p;
+          m->arg[2] = &one;
+          m->arg[3] = m->lam_g;
+          m->res[0] = m->Bk;
+          if (calc_function(m, "nlp_hess_l")) return 1;
+        }
 
         // Determing regularization parameter with Gershgorin theorem
         if (regularize_) {
@@ -403,14 +516,16 @@ namespace casadi {
           if (m->reg > 0) casadi_regularize(Hsp_, m->Bk, m->reg);
         }
       } else if (m->iter_count==0) {
-        // Initialize BFGS
-        casadi_fill(m->Bk, Hsp_.nnz(), 1.);
-        casadi_bfgs_reset(Hsp_, m->Bk);
+        // Initialize BFGS, unless warm starting
+        if (!warm) {
+          casadi_fill(m->Bk, Hsp_.nnz(), 1.);
+          casadi_bfgs_reset(Hsp_, m->Bk);
+        }
       } else {
         // Update BFGS
         if (m->iter_count % lbfgs_memory_ == 0) casadi_bfgs_reset(Hsp_, m->Bk);
         // Update the Hessian approximation
-        casadi_bfgs(Hsp_, m->Bk, m->dx, m->gLag, m->gLag_old, m->w);
+        bfgs(m);
       }
 
       // Formulate the QP
@@ -541,9 +656,186 @@ namespace casadi {
       }
     }
 
+    // Keep the solver state for the next call
+    if (warm_start_) {
+      m->ws_merit_ind = m->merit_ind;
+      casadi_copy(m->merit_mem, merit_memsize_, get_ptr(m->ws_merit));
+      m->ws_sigma = m->sigma;
+      if (!exact_hessian_) casadi_copy(m->Bk, Hsp_.nnz(), get_ptr(m->ws_Bk));
+      m->warm = true;
+    }
+
     return 0;
   }
 
+  int Sqpmethod::rti_prepare(SqpmethodMemory* m) const {
+    // Linearize at the (shifted) initial guess
+    const double one = 1.;
+    bool hess_concurrent = exact_hessian_ && max_num_threads_>1;
+    if (hess_concurrent) {
+      if (calc_functions(m, {{"nlp_jac_fg", {m->x, m->p}, {&m->f, m->gf, m->g, m->Jk}},
+                             {"nlp_hess_l", {m->x, m->p, &one, m->lam_g}, {m->Bk}}})) {
+        return 1;
+      }
+    } else {
+      m->arg[0] = m->x;
+      m->arg[1] = m->p;
+      m->res[0] = &m->f;
+      m->res[1] = m->gf;
+      m->res[2] = m->g;
+      m->res[3] = m->Jk;
+      if (calc_function(m, "nlp_jac_fg")) return 1;
+    }
+
+    // Gradient of the Lagrangian
+    casadi_copy(m->gf, nx_, m->gLag);
+    casadi_mv(m->Jk, Asp_, m->lam_g, m->gLag, true);
+    casadi_axpy(nx_, 1., m->lam_x, m->gLag);
+
+    if (exact_hessian_) {
+      // Exact Hessian, with regularization as in the full SQP method
+      if (!hess_concurrent) {
+        m->arg[0] = m->x;
+        m->arg[1] = m->p;
+        m->arg[2] = &one;
+        m->arg[3] = m->lam_g;
+        m->res[0] = m->Bk;
+        if (calc_function(m, "nlp_hess_l")) return 1;
+      }
+      m->reg = 0;
+      if (regularize_) {
+        m->reg = std::fmin(0, -casadi_lb_eig(Hsp_, m->Bk));
+        if (m->reg > 0) casadi_regularize(Hsp_, m->Bk, m->reg);
+      }
+    } else if (!m->rti_prepared || m->rti_count % lbfgs_memory_ == 0) {
+      // Initialize BFGS
+      casadi_fill(m->Bk, Hsp_.nnz(), 1.);
+      casadi_bfgs_reset(Hsp_, m->Bk);
+    } else {
+      // BFGS update between the previous and the current linearization point,
+      // with the Lagrange gradients evaluated for the current multipliers
+      casadi_copy(get_ptr(m->rti_gf), nx_, m->gLag_old);
+      casadi_mv(get_ptr(m->rti_Jk), Asp_, m->lam_g, m->gLag_old, true);
+      casadi_axpy(nx_, 1., m->lam_x, m->gLag_old);
+      casadi_copy(m->x, nx_, m->dx);
+      casadi_axpy(nx_, -1., get_ptr(m->rti_x), m->dx);
+      casadi_copy(get_ptr(m->rti_Bk), Hsp_.nnz(), m->Bk);
+      bfgs(m);
+    }
+
+    // Store the linearization for the feedback phase
+    m->rti_f = m->f;
+    casadi_copy(m->x, nx_, get_ptr(m->rti_x));
+    casadi_copy(m->gf, nx_, get_ptr(m->rti_gf));
+    casadi_copy(m->g, ng_, get_ptr(m->rti_g));
+    casadi_copy(m->Jk, Asp_.nnz(), get_ptr(m->rti_Jk));
+    casadi_copy(m->Bk, Hsp_.nnz(), get_ptr(m->rti_Bk));
+    casadi_copy(m->lam_x, nx_, get_ptr(m->rti_lam_x));
+    casadi_copy(m->lam_g, ng_, get_ptr(m->rti_lam_g));
+    m->rti_prepared = true;
+    m->rti_count++;
+
+    m->iter_count = 0;
+    m->return_status = "Preparation_Completed";
+    m->success = true;
+    return 0;
+  }
+
+  int Sqpmethod::rti_feedback(SqpmethodMemory* m) const {
+    casadi_assert(m->rti_prepared,
+      "Real-time iteration: the feedback phase requires a preceding preparation phase");
+
+    // Linearization from the preparation phase
+    m->f = m->rti_f;
+    casadi_copy(get_ptr(m->rti_x), nx_, m->x);
+    casadi_copy(get_ptr(m->rti_gf), nx_, m->gf);
+    casadi_copy(get_ptr(m->rti_g), ng_, m->g);
+    casadi_copy(get_ptr(m->rti_Jk), Asp_.nnz(), m->Jk);
+    casadi_copy(get_ptr(m->rti_Bk), Hsp_.nnz(), m->Bk);
+
+    // Formulate the QP with the current bounds, e.g. with the initial state embedded
+    casadi_copy(m->lbx, nx_, m->qp_LBX);
+    casadi_axpy(nx_, -1., m->x, m->qp_LBX);
+    casadi_copy(m->ubx, nx_, m->qp_UBX);
+    casadi_axpy(nx_, -1., m->x, m->qp_UBX);
+    casadi_copy(m->lbg, ng_, m->qp_LBA);
+    casadi_axpy(ng_, -1., m->g, m->qp_LBA);
+    casadi_copy(m->ubg, ng_, m->qp_UBA);
+    casadi_axpy(ng_, -1., m->g, m->qp_UBA);
+
+    // Intitial guess
+    casadi_copy(get_ptr(m->rti_lam_x), nx_, m->qp_DUAL_X);
+    casadi_copy(get_ptr(m->rti_lam_g), ng_, m->qp_DUAL_A);
+    casadi_fill(m->dx, nx_, 0.);
+
+    // Solve the QP
+    solve_QP(m, m->Bk, m->gf, m->qp_LBX, m->qp_UBX, m->Jk, m->qp_LBA,
+             m->qp_UBA, m->dx, m->qp_DUAL_X, m->qp_DUAL_A);
+
+    // Full step, objective and constraints are linear predictions
+    m->f += casadi_dot(nx_, m->gf, m->dx);
+    casadi_mv(m->Jk, Asp_, m->dx, m->g, false);
+    casadi_axpy(nx_, 1., m->dx, m->x);
+    casadi_copy(m->qp_DUAL_X, nx_, m->lam_x);
+    casadi_copy(m->qp_DUAL_A, ng_, m->lam_g);
+
+    m->iter_count = 1;
+    m->return_status = "Feedback_Completed";
+    m->success = true;
+    return 0;
+  }
+
+  int Sqpmethod::eval_rti(const double** arg, double** res, casadi_int* iw, double* w,
+                          casadi_int phase) const {
+#ifdef CASADI_WITH_THREAD
+    std::lock_guard<std::mutex> lock(rti_mtx_);
+#endif // CASADI_WITH_THREAD
+    if (rti_mem_<0) rti_mem_ = checkout();
+    auto m = static_cast<SqpmethodMemory*>(memory(rti_mem_));
+    m->rti_phase = phase;
+    int flag = eval(arg, res, iw, w, m);
+    m->rti_phase = SQP_RTI_BOTH;
+    return flag;
+  }
+
+  std::vector<std::string> Sqpmethod::get_function() const {
+    std::vector<std::string> ret = Nlpsol::get_function();
+    if (rti_) {
+      ret.push_back("rti_feedback");
+      ret.push_back("rti_prepare");
+    }
+    return ret;
+  }
+
+  const Function& Sqpmethod::get_function(const std::string &name) const {
+    if (rti_ && (name=="rti_prepare" || name=="rti_feedback")) {
+      bool prepare = name=="rti_prepare";
+      Function& f = prepare ? rti_prepare_ : rti_feedback_;
+      if (f.is_null()) {
+        f = Function::create(new SqpmethodRti(name_ + "_" + name, self(),
+          prepare ? SQP_RTI_PREPARE : SQP_RTI_FEEDBACK), Dict());
+      }
+      return f;
+    }
+    return Nlpsol::get_function(name);
+  }
+
+  bool Sqpmethod::has_function(const std::string& fname) const {
+    if (rti_ && (fname=="rti_prepare" || fname=="rti_feedback")) return true;
+    return Nlpsol::has_function(fname);
+  }
+
+  void Sqpmethod::bfgs(SqpmethodMemory* m) const {
+    // Damped BFGS update of each diagonal block, stored consecutively in Bk
+    double* Bk = m->Bk;
+    for (casadi_int b=0; b<Hsp_blocks_.size(); ++b) {
+      casadi_int offset = blocks_[b];
+      casadi_bfgs(Hsp_blocks_[b], Bk, m->dx + offset, m->gLag + offset,
+                  m->gLag_old + offset, m->w);
+      Bk += Hsp_blocks_[b].nnz();
+    }
+  }
+
   void Sqpmethod::print_iteration() const {
     print("%4s %14s %9s %9s %9s %7s %2s\n", "iter", "objective", "inf_pr",
           "inf_du", "||d||", "lg(rg)", "ls");
@@ -599,4 +891,44 @@ namespace casadi {
     stats["iter_count"] = m->iter_count;
     return stats;
   }
+
+  SqpmethodRti::SqpmethodRti(const std::string& name, const Function& solver,
+                             casadi_int phase)
+    : FunctionInternal(name), solver_(solver), phase_(phase) {
+    sp_in_.resize(NLPSOL_NUM_IN);
+    for (casadi_int i=0; i<NLPSOL_NUM_IN; ++i) sp_in_[i] = solver.sparsity_in(i);
+    sp_out_.resize(NLPSOL_NUM_OUT);
+    for (casadi_int i=0; i<NLPSOL_NUM_OUT; ++i) sp_out_[i] = solver.sparsity_out(i);
+  }
+
+  void SqpmethodRti::init(const Dict& opts) {
+    // Call the initialization method of the base class
+    FunctionInternal::init(opts);
+
+    // Work vectors of the solver
+    WeakRef s = solver_;
+    Function solver = shared_cast<Function>(s.shared());
+    alloc_arg(solver.sz_arg());
+    alloc_res(solver.sz_res());
+    alloc_iw(solver.sz_iw());
+    alloc_w(solver.sz_w());
+  }
+
+  int SqpmethodRti::eval(const double** arg, double** res, casadi_int* iw, double* w,
+                         void* mem) const {
+    casadi_assert(solver_.alive(), "The solver of '" + name_ + "' has been deleted");
+    WeakRef s = solver_;
+    Function solver = shared_cast<Function>(s.shared());
+    return static_cast<const Sqpmethod*>(solver.get())->eval_rti(arg, res, iw, w, phase_);
+  }
+
+  Dict SqpmethodRti::get_stats(void* mem) const {
+    if (!solver_.alive()) return Dict();
+    WeakRef s = solver_;
+    Function solver = shared_cast<Function>(s.shared());
+    auto self = static_cast<const Sqpmethod*>(solver.get());
+    if (self->rti_mem_<0) return Dict();
+    return self->get_stats(self->memory(self->rti_mem_));
+  }
+
 } // namespace casadi
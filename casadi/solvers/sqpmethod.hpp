@@ -38,6 +38,9 @@
 /// \cond INTERNAL
 namespace casadi {
 
+  /// Phases of a real-time iteration
+  enum SqpmethodRtiPhase {SQP_RTI_BOTH, SQP_RTI_PREPARE, SQP_RTI_FEEDBACK};
+
   struct CASADI_NLPSOL_SQPMETHOD_EXPORT SqpmethodMemory : public NlpsolMemory {
     /// Current and previous linearization point and candidate
     double *x_cand;
@@ -78,6 +81,22 @@ namespace casadi {
 
     /// Iteration count
     int iter_count;
+
+    /// Warm start: Hessian approximation, merit function memory and penalty parameter
+    std::vector<double> ws_Bk, ws_merit;
+    size_t ws_merit_ind;
+    double ws_sigma;
+
+    /// Real-time iteration: phase of the current call
+    casadi_int rti_phase;
+
+    /// Real-time iteration: number of linearizations, is one available?
+    casadi_int rti_count;
+    bool rti_prepared;
+
+    /// Real-time iteration: linearization from the preparation phase
+    double rti_f;
+    std::vector<double> rti_x, rti_gf, rti_g, rti_Jk, rti_Bk, rti_lam_x, rti_lam_g;
   };
 
   /** \brief  \pluginbrief{Nlpsol,sqpmethod}
@@ -109,12 +128,20 @@ namespace casadi {
     /// Get all statistics
     Dict get_stats(void* mem) const override;
 
+    /// Columns of the iteration trace
+    std::vector<std::string> trace_columns() const override {
+      return {"f", "inf_pr", "inf_du", "step", "reg", "ls_trials", "ls_success"};
+    }
+
     // Initialize the solver
     void init(const Dict& opts) override;
 
     /** \brief Create memory block */
     void* alloc_mem() const override { return new SqpmethodMemory();}
 
+    /** \brief Initalize memory block */
+    int init_mem(void* mem) const override;
+
     /** \brief Free memory block */
     void free_mem(void *mem) const override { delete static_cast<SqpmethodMemory*>(mem);}
 
@@ -125,6 +152,23 @@ namespace casadi {
     // Solve the NLP
     int solve(void* mem) const override;
 
+    /// Real-time iteration: linearize at the initial guess
+    int rti_prepare(SqpmethodMemory* m) const;
+
+    /// Real-time iteration: solve the QP with the current bounds and take a full step
+    int rti_feedback(SqpmethodMemory* m) const;
+
+    /// Evaluate a phase of the real-time iteration, in a memory object shared by all phases
+    int eval_rti(const double** arg, double** res, casadi_int* iw, double* w,
+                 casadi_int phase) const;
+
+    ///@{
+    /** \brief The preparation and feedback phases of the real-time iteration */
+    std::vector<std::string> get_function() const override;
+    const Function& get_function(const std::string &name) const override;
+    bool has_function(const std::string& fname) const override;
+    ///@}
+
     /// QP solver for the subproblems
     Function qpsol_;
 
@@ -157,15 +201,39 @@ namespace casadi {
     // Hessian sparsity
     Sparsity Hsp_;
 
+    /// Blockwise BFGS approximation of the Hessian
+    bool block_hess_;
+
+    /// Offsets and sparsity patterns of the diagonal Hessian blocks
+    std::vector<casadi_int> blocks_;
+    std::vector<Sparsity> Hsp_blocks_;
+
     // Jacobian sparsity
     Sparsity Asp_;
 
     /// Regularization
     bool regularize_;
 
+    /// Real-time iteration mode
+    bool rti_;
+
+    /// Functions for the real-time iteration phases, created on demand
+    mutable Function rti_prepare_, rti_feedback_;
+
+    /// Memory object shared by the real-time iteration phases
+    mutable casadi_int rti_mem_;
+
+#ifdef CASADI_WITH_THREAD
+    /// Serializes the real-time iteration phases, which share rti_mem_
+    mutable std::mutex rti_mtx_;
+#endif // CASADI_WITH_THREAD
+
     /// Access Conic
     const Function getConic() const { return qpsol_;}
 
+    /// Update the BFGS approximation of the Hessian, block by block
+    void bfgs(SqpmethodMemory* m) const;
+
     /// Print iteration header
     void print_iteration() const;
 
@@ -184,6 +252,58 @@ namespace casadi {
 
   };
 
+  /** \brief A phase of the real-time iteration of a Sqpmethod instance
+
+      Same signature as the solver. All phases of a solver share one memory object.
+  */
+  class CASADI_NLPSOL_SQPMETHOD_EXPORT SqpmethodRti : public FunctionInternal {
+  public:
+    SqpmethodRti(const std::string& name, const Function& solver, casadi_int phase);
+
+    // Name of the class
+    std::string class_name() const override { return "SqpmethodRti";}
+
+    ///@{
+    /** \brief Number of function inputs and outputs */
+    size_t get_n_in() override { return NLPSOL_NUM_IN;}
+    size_t get_n_out() override { return NLPSOL_NUM_OUT;}
+    ///@}
+
+    /// @{
+    /** \brief Sparsities of function inputs and outputs */
+    Sparsity get_sparsity_in(casadi_int i) override { return sp_in_.at(i);}
+    Sparsity get_sparsity_out(casadi_int i) override { return sp_out_.at(i);}
+    /// @}
+
+    ///@{
+    /** \brief Names of function input and outputs */
+    std::string get_name_in(casadi_int i) override { return nlpsol_in(i);}
+    std::string get_name_out(casadi_int i) override { return nlpsol_out(i);}
+    /// @}
+
+    // Initialize
+    void init(const Dict& opts) override;
+
+    // Evaluate numerically
+    int eval(const double** arg, double** res, casadi_int* iw, double* w,
+             void* mem) const override;
+
+    /// Statistics of the solver, from the shared memory object
+    Dict get_stats(void* mem) const override;
+
+    /// Calls are serialized, since they share one memory object
+    bool is_thread_safe() const override { return false;}
+
+    // The solver, not owned to avoid a circular reference
+    WeakRef solver_;
+
+    // Phase, SQP_RTI_PREPARE or SQP_RTI_FEEDBACK
+    casadi_int phase_;
+
+    // Sparsities, as for the solver
+    std::vector<Sparsity> sp_in_, sp_out_;
+  };
+
 } // namespace casadi
 /// \endcond
 #endif // CASADI_SQPMETHOD_HPP
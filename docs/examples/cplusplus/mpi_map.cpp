@@ -0,0 +1,62 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+/** \brief Parameter sweep distributed over MPI ranks
+ *
+ * Run with e.g. "mpirun -np 4 ./mpi_map". Every rank runs this program and evaluates
+ * the map collectively, the results are available on all ranks.
+ */
+
+#include <casadi/casadi.hpp>
+#include <iostream>
+
+using namespace casadi;
+
+int main(int argc, char* argv[]) {
+  // Final state of a damped oscillator after 100 explicit Euler steps
+  SX x = SX::sym("x", 2), p = SX::sym("p");
+  SX xk = x;
+  for (int k=0; k<100; ++k) xk += 0.01*vertcat(xk(1), -p*xk(0) - 0.1*xk(1));
+  Function f("f", {x, p}, {xk});
+
+  // Sweep over 1000 values of the parameter, each rank evaluating a block with threads
+  casadi_int n = 1000;
+  DM x0 = std::vector<double>{1, 0};
+  DM pv = linspace(DM(0.1), DM(10), n).T();
+  Function sweep = f.map(n, "mpi", {{"local_parallelization", "thread"}});
+  DM xf = sweep(std::vector<DM>{x0, pv}).at(0);
+
+  // Sensitivities with respect to the parameters are distributed as well
+  MX P = MX::sym("P", 1, n);
+  Function dsweep("dsweep", {P}, {jacobian(sweep(std::vector<MX>{x0, P}).at(0), P)});
+  DM J = dsweep(std::vector<DM>{pv}).at(0);
+
+  Dict info = sweep.info();
+  if (static_cast<casadi_int>(info.at("rank"))==0) {
+    std::cout << "ranks: " << info.at("size") << std::endl;
+    std::cout << "final position, first five: " << xf(0, Slice(0, 5)) << std::endl;
+    std::cout << "Jacobian nonzeros: " << J.nnz() << std::endl;
+  }
+  return 0;
+}
@@ -232,7 +232,8 @@ def DM_from_array(m, check_only=True):
     else:
       shape = m.shape + (1, 1)
       nrow, ncol = shape[0], shape[1]
-      return (nrow,ncol,m.flat)
+      # Row-major and contiguous, read as a buffer
+      return (nrow,ncol,m.ravel())
   return False
 
 def IM_from_array(m, check_only=True):
@@ -269,7 +270,7 @@ def DM_from_csc(m, check_only=True):
   if m.__class__.__name__ == "csc_matrix":
     if len(m.shape)!=2: return False
     if check_only: return True
-    return m.shape + (m.indptr.flat,m.indices.flat,m.data.flat)
+    return m.shape + (m.indptr.ravel(),m.indices.ravel(),m.data.ravel())
   return False
 
 %}
@@ -706,6 +707,42 @@ namespace std {
       return ret;
     }
 
+    // Copy the elements of a contiguous buffer, e.g. a numpy array, without
+    // creating a Python object for each of them
+    template<typename S, typename T>
+    void copy_buffer_elements(const void* buf, Py_ssize_t n, std::vector<T>* v) {
+      const S* b = static_cast<const S*>(buf);
+      v->resize(n);
+      for (Py_ssize_t i=0; i<n; ++i) (*v)[i] = static_cast<T>(b[i]);
+    }
+
+    template<typename T>
+    bool copy_buffer(GUESTOBJECT *p, std::vector<T>* v) {
+      if (!PyObject_CheckBuffer(p)) return false;
+      Py_buffer view;
+      if (PyObject_GetBuffer(p, &view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT)) {
+        PyErr_Clear();
+        return false;
+      }
+      // Native byte order only
+      const char* f = view.format ? view.format : "B";
+      if (*f=='@' || *f=='=') f++;
+      bool ret = f[0]!='\0' && f[1]=='\0';
+      if (ret) {
+        Py_ssize_t n = view.len/view.itemsize;
+        switch (f[0]) {
+          case 'd': copy_buffer_elements<double>(view.buf, n, v); break;
+          case 'f': copy_buffer_elements<float>(view.buf, n, v); break;
+          case 'i': copy_buffer_elements<int>(view.buf, n, v); break;
+          case 'l': copy_buffer_elements<long>(view.buf, n, v); break;
+          case 'q': copy_buffer_elements<long long>(view.buf, n, v); break;
+          default: ret = false;
+        }
+      }
+      PyBuffer_Release(&view);
+      return ret;
+    }
+
     bool SX_from_array_conv(GUESTOBJECT *p, casadi::SX** m) {
       std::vector<SXElem> data;
       if (!to_val(PyTuple_GetItem(p, 2), &data)) return false;
@@ -732,7 +769,8 @@ namespace std {
     bool DM_from_array_conv(GUESTOBJECT *p, casadi::DM** m) {
       if (!m) return true;
       std::vector<double> data;
-      if (!to_val(PyTuple_GetItem(p, 2), &data)) return false;
+      PyObject* d = PyTuple_GetItem(p, 2);
+      if (!copy_buffer(d, &data) && !to_val(d, &data)) return false;
       casadi_int nrow; to_val(PyTuple_GetItem(p, 0), &nrow);
       casadi_int ncol; to_val(PyTuple_GetItem(p, 1), &ncol);
       **m = DM::zeros(nrow, ncol);
@@ -743,9 +781,10 @@ namespace std {
     bool DM_from_csc_conv(GUESTOBJECT *p, casadi::DM** m) {
       std::vector<double> data;
       std::vector<casadi_int> colind, row;
-      if (!to_val(PyTuple_GetItem(p, 4), &data)) return false;
-      if (!to_val(PyTuple_GetItem(p, 3), &row)) return false;
-      if (!to_val(PyTuple_GetItem(p, 2), &colind)) return false;
+      PyObject *d = PyTuple_GetItem(p, 4), *r = PyTuple_GetItem(p, 3), *c = PyTuple_GetItem(p, 2);
+      if (!copy_buffer(d, &data) && !to_val(d, &data)) return false;
+      if (!copy_buffer(r, &row) && !to_val(r, &row)) return false;
+      if (!copy_buffer(c, &colind) && !to_val(c, &colind)) return false;
       casadi_int nrow; to_val(PyTuple_GetItem(p, 0), &nrow);
       casadi_int ncol; to_val(PyTuple_GetItem(p, 1), &ncol);
       **m = casadi::Matrix<double>(casadi::Sparsity(nrow,ncol,colind,row), data, false);
@@ -2892,6 +2931,22 @@ DECL M casadi_sumsqr(const M& X) {
   return sumsqr(X);
 }
 
+DECL M casadi_conv(const M& h, const M& x) {
+  return conv(h, x);
+}
+
+DECL M casadi_kron_mtimes(const M& a, const M& b, const M& x) {
+  return kron_mtimes(a, b, x);
+}
+
+DECL M casadi_diagcat_mtimes(const std::vector< M >& a, const M& x) {
+  return diagcat_mtimes(a, x);
+}
+
+DECL M casadi_toeplitz_mtimes(const M& c, const M& r, const M& x) {
+  return toeplitz_mtimes(c, r, x);
+}
+
 DECL M casadi_linspace(const M& a, const M& b, casadi_int nsteps) {
   return linspace(a, b, nsteps);
 }
@@ -3457,6 +3512,16 @@ namespace casadi{
 namespace casadi{
 %extend Matrix<double> {
 
+  // Dense values in row-major order, written directly into a bytearray
+  PyObject* full_buffer() const {
+    PyObject* ret = PyByteArray_FromStringAndSize(0, $self->numel()*sizeof(double));
+    if (ret) {
+      double* d = reinterpret_cast<double*>(PyByteArray_AsString(ret));
+      casadi_densify($self->ptr(), $self->sparsity(), d, true);
+    }
+    return ret;
+  }
+
 %python_array_wrappers(999.0)
 
 // The following code has some trickery to fool numpy ufunc.
@@ -3483,12 +3548,15 @@ namespace casadi{
     return csc_matrix( (self.nonzeros(),self.row(),self.colind()), shape = self.shape, dtype=np.double )
   def toarray(self,simplify=False):
     import numpy as np
-    if simplify:
-      if self.is_scalar():
-        return float(self)
-      elif self.is_vector():
-        return np.array(self.T.elements())
-    return np.array(self.T.elements()).reshape(self.shape)
+    if simplify and self.is_scalar():
+      return float(self)
+    if self.numel()==0:
+      ret = np.zeros(self.shape)
+    else:
+      ret = np.frombuffer(self.full_buffer(), dtype=np.double)
+    if simplify and self.is_vector():
+      return ret
+    return ret.reshape(self.shape)
 %}
 
 
@@ -3847,7 +3915,142 @@ def PyFunction(name, obj, inputs, outputs, opts={}):
 #ifdef SWIGPYTHON
 namespace casadi{
 %extend Function {
+  // Evaluate with the nonzeros of the inputs and outputs in buffers, without copying.
+  // Each entry is None or a contiguous buffer of nnz doubles, in column-major order
+  void eval_buffers(PyObject* arg, PyObject* res) const {
+    casadi_int n_in = $self->n_in(), n_out = $self->n_out();
+    casadi_assert(PySequence_Check(arg) && PySequence_Size(arg)==n_in,
+                  "Expected a sequence of " + casadi::str(n_in) + " input buffers");
+    casadi_assert(PySequence_Check(res) && PySequence_Size(res)==n_out,
+                  "Expected a sequence of " + casadi::str(n_out) + " output buffers");
+    std::vector<Py_buffer> views;
+    views.reserve(n_in+n_out);
+    std::vector<const double*> a(n_in, nullptr);
+    std::vector<double*> r(n_out, nullptr);
+    std::string err;
+    for (casadi_int i=0; i<n_in+n_out && err.empty(); ++i) {
+      bool is_in = i<n_in;
+      casadi_int k = is_in ? i : i-n_in;
+      PyObject* e = PySequence_GetItem(is_in ? arg : res, k);
+      if (!e) {
+        PyErr_Clear();
+        err = "Cannot access buffer " + casadi::str(i);
+        break;
+      }
+      if (e!=Py_None) {
+        Py_buffer view;
+        int flags = PyBUF_ANY_CONTIGUOUS | PyBUF_FORMAT | (is_in ? 0 : PyBUF_WRITABLE);
+        casadi_int nnz = is_in ? $self->nnz_in(k) : $self->nnz_out(k);
+        std::string what = (is_in ? "Input " : "Output ") + casadi::str(k);
+        if (!PyObject_CheckBuffer(e) || PyObject_GetBuffer(e, &view, flags)) {
+          PyErr_Clear();
+          err = what + " is not a contiguous" + (is_in ? "" : ", writable") + " buffer";
+        } else {
+          views.push_back(view);
+          const char* f = view.format ? view.format : "B";
+          if (*f=='@' || *f=='=') f++;
+          if (std::string(f)!="d" || view.len!=nnz*sizeof(double)) {
+            err = what + " must hold " + casadi::str(nnz) + " doubles";
+          } else if (is_in) {
+            a[k] = static_cast<const double*>(view.buf);
+          } else {
+            r[k] = static_cast<double*>(view.buf);
+          }
+        }
+      }
+      Py_DECREF(e);
+    }
+    try {
+      if (err.empty()) (*$self)(a, r);
+    } catch (...) {
+      for (auto&& v : views) PyBuffer_Release(&v);
+      throw;
+    }
+    for (auto&& v : views) PyBuffer_Release(&v);
+    if (!err.empty()) casadi_error(err);
+  }
+
   %pythoncode %{
+    def call_numpy(self, *args, **kwargs):
+      """Evaluate with numpy arrays, without converting to DM
+
+      Inputs are numpy arrays (or objects convertible to float64 arrays), scalars,
+      scipy.sparse matrices or None (zero). Contiguous float64 arrays and CSC matrices
+      with the pattern of the input are passed to CasADi without copying.
+      Dense outputs are returned as Fortran-ordered numpy arrays and sparse outputs as
+      scipy.sparse.csc_matrix, written directly by the evaluation. Pass out=[...]
+      to write into preallocated arrays instead.
+      """
+      import numpy as np
+      out = kwargs.pop("out", None)
+      if len(kwargs)>0:
+        raise TypeError("Unexpected keyword arguments: " + str(list(kwargs.keys())))
+      if len(args)!=self.n_in():
+        raise ValueError("Expected %d inputs, got %d" % (self.n_in(), len(args)))
+
+      def nonzeros(a, sp, what):
+        if a is None: return None
+        if hasattr(a, "tocsc") and not isinstance(a, np.ndarray):
+          a = a.tocsc()
+          if a.shape==sp.shape and a.has_sorted_indices and np.array_equal(a.indptr, sp.colind()) \
+              and np.array_equal(a.indices, sp.row()):
+            return np.ascontiguousarray(a.data, dtype=np.double)
+          a = a.toarray()
+        a = np.asarray(a, dtype=np.double)
+        if a.size==1 and sp.numel()!=1:
+          return np.full(sp.nnz(), a.item())
+        if a.shape!=sp.shape and not (a.size==sp.numel() and (a.ndim<2 or sp.is_vector())):
+          raise ValueError("%s has shape %s, expected %s" % (what, a.shape, sp.shape))
+        a = a.ravel(order='F')
+        if not sp.is_dense(): a = a[sp.find()]
+        return np.ascontiguousarray(a)
+
+      arg = [nonzeros(a, self.sparsity_in(i), "Input %d" % i) for i, a in enumerate(args)]
+
+      # Outputs, evaluated in place
+      if out is None:
+        ret = []
+        for i in range(self.n_out()):
+          sp = self.sparsity_out(i)
+          if sp.is_dense():
+            ret.append(np.empty(sp.shape, order='F'))
+          else:
+            import warnings
+            with warnings.catch_warnings():
+              warnings.simplefilter("ignore")
+              from scipy.sparse import csc_matrix
+            ret.append(csc_matrix((np.empty(sp.nnz()), sp.row(), sp.colind()), shape=sp.shape))
+      else:
+        ret = list(out)
+        if len(ret)!=self.n_out():
+          raise ValueError("Expected %d outputs, got %d" % (self.n_out(), len(ret)))
+      res = []
+      for i, r in enumerate(ret):
+        sp = self.sparsity_out(i)
+        if r is None:
+          res.append(None)
+        elif hasattr(r, "tocsc") and not isinstance(r, np.ndarray):
+          if r.format!="csc" or r.shape!=sp.shape or not np.array_equal(r.indptr, sp.colind()) \
+              or not np.array_equal(r.indices, sp.row()):
+            raise ValueError("Output %d must be a CSC matrix with the pattern of the output" % i)
+          res.append(r.data)
+        else:
+          if not sp.is_dense():
+            raise ValueError("Output %d is sparse, expected a CSC matrix" % i)
+          if r.shape!=sp.shape and not (r.size==sp.numel() and r.ndim<2):
+            raise ValueError("Output %d has shape %s, expected %s" % (i, r.shape, sp.shape))
+          if r.ndim==2 and not r.flags.f_contiguous:
+            raise ValueError("Output %d must be Fortran-ordered" % i)
+          res.append(r)
+
+      self.eval_buffers(arg, res)
+      if len(ret)==0:
+        return None
+      elif len(ret)==1:
+        return ret[0]
+      else:
+        return tuple(ret)
+
     def __call__(self, *args, **kwargs):
       # Either named inputs or ordered inputs
       if len(args)>0 and len(kwargs)>0:
@@ -4020,6 +4223,7 @@ namespace casadi{
 %include <casadi/core/dple.hpp>
 %include <casadi/core/expm.hpp>
 %include <casadi/core/interpolant.hpp>
+%include <casadi/core/plugin_preload.hpp>
 
 %feature("copyctor", "0") casadi::CodeGenerator;
 %include <casadi/core/code_generator.hpp>
@@ -4172,6 +4376,7 @@ namespace casadi {
 %include <casadi/core/global_options.hpp>
 %include <casadi/core/casadi_meta.hpp>
 %include <casadi/core/integration_tools.hpp>
+%include <casadi/core/sparse_product.hpp>
 %include <casadi/core/nlp_builder.hpp>
 %include <casadi/core/variable.hpp>
 %include <casadi/core/dae_builder.hpp>
@@ -28,6 +28,7 @@ from subprocess import *
 import time
 import re
 import tempfile
+import json
 
 class TimeoutEvent(Exception):
     pass
@@ -147,6 +148,10 @@ class TestSuite:
        -skipfiles="file1 file2"   get's added to skipfiles
        -memcheck           Include a check for memory leaks
        -passoptions="option1 option2"   get's passed onto the command constructor as third argument
+       -perf=history.jsonl  Record timings of key operations in the tests to this history file
+       -perf_tag=label      Label the recorded timings, e.g. with a commit or release
+       -perf_threshold=0.2  Relative slowdown w.r.t. the recent history that is flagged as a regression
+       -perf_fail           Fail tests that report a performance regression
 
 
     """
@@ -171,6 +176,8 @@ class TestSuite:
     self.workingdir = workingdir
     self.memcheck = False
     self.passoptions = []
+    self.perf = None
+    self.env = None
     self.stderr_trigger = stderr_trigger
     self.stdout_trigger = stdout_trigger
     self.custom_stdout = custom_stdout
@@ -200,8 +207,50 @@ class TestSuite:
       if m:
         self.passoptions+=m.group(1).split(' ')
         okay = True
+      m = re.search('-perf=(.*)', arg)
+      if m:
+        self.perf = os.path.abspath(m.group(1))
+        okay = True
+      m = re.search('-perf_tag=(.*)', arg)
+      if m:
+        self.env_perf("CASADI_PERF_TAG", m.group(1))
+        okay = True
+      m = re.search('-perf_threshold=(.*)', arg)
+      if m:
+        self.env_perf("CASADI_PERF_THRESHOLD", m.group(1))
+        okay = True
+      m = re.search('-perf_fail$', arg)
+      if m:
+        self.stderr_trigger.append((re.compile("perf regression"),"performance regression"))
+        okay = True
       if not(okay):
         print("Unknown argument: ", arg)
+    if self.perf is not None:
+      # All test processes of this run share the run identifier
+      self.perf_run = time.strftime("%Y%m%dT%H%M%S") + "-%d" % os.getpid()
+      self.env_perf("CASADI_PERF_RECORD", self.perf)
+      self.env_perf("CASADI_PERF_RUN", self.perf_run)
+
+  def env_perf(self, key, value):
+    # Environment of the test processes in performance-recording mode
+    if self.env is None: self.env = dict(os.environ)
+    self.env[key] = value
+
+  def perf_summary(self):
+    # Report the regressions flagged during this run
+    regressions = []
+    if os.path.exists(self.perf):
+      with open(self.perf) as f:
+        for line in f:
+          try:
+            r = json.loads(line)
+          except ValueError:
+            continue
+          if r.get("run")==self.perf_run and r.get("regression"):
+            regressions.append(r)
+    print("Recorded timings in %s, %d regressions." % (self.perf, len(regressions)))
+    for r in regressions:
+      print("  %s: %.3e s, recent median %.3e s" % (r["key"], r["time"], r["reference"]))
 
   def run(self):
     print("Running test in " + self.dirname)
@@ -219,6 +268,8 @@ class TestSuite:
         self.postRun(root)
 
     print("Ran %d tests, %d fails." % (self.stats['numtests'],self.stats['numfails']))
+    if self.perf is not None:
+      self.perf_summary()
 
     if self.stats['numfails']>0:
       sys.exit(1)
@@ -229,7 +280,7 @@ class TestSuite:
     print(("%02d. " % self.stats['numtests']) + fn)
     t0 = time.time()
 
-    p=Popen(self.command(dir,fn,self.passoptions),cwd=self.workingdir(dir),stdout=PIPE, stderr=PIPE, stdin=PIPE)
+    p=Popen(self.command(dir,fn,self.passoptions),cwd=self.workingdir(dir),stdout=PIPE, stderr=PIPE, stdin=PIPE, env=self.env)
 
     inp = None
     if callable(self.inputs):
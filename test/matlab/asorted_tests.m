@@ -422,6 +422,27 @@ assert(norm(a-6,1)==0);
 assert(norm(b-3*eye(2),1)==0);
 assert(~issparse(a));
 assert(~issparse(b));
+clear fmex
+
+% Evaluation at several points stacked horizontally
+y=SX.sym('y',2);
+f=Function('f',{x,y},{2*x,DM.eye(2)*x,y*x});
+f.generate('fmex',struct('mex',true));
+if is_octave
+mex -DMATLAB_MEX_FILE fmex.c
+else
+mex -largeArrayDims fmex.c
+end
+[a,b,c] = fmex('f',[1 2 3],[1 2 3;4 5 6]);
+assert(norm(a-[2 4 6],1)==0);
+assert(norm(b-[eye(2) 2*eye(2) 3*eye(2)],1)==0);
+assert(issparse(b));
+assert(norm(c-[1 4 9;4 10 18],1)==0);
+[a,b,c] = fmex('f',2,[1 2 3;4 5 6]);
+assert(norm(a-[4 4 4],1)==0);
+assert(norm(c-2*[1 2 3;4 5 6],1)==0);
+[a,b,c] = fmex('f',2,sparse([1;0]));
+assert(norm(c-[2;0],1)==0);
 
 Xs = {SX, MX};
 for j=1:2;
@@ -66,6 +66,9 @@ if has_conic("clp"):
 if has_conic("qrqp"):
   conics.append(("qrqp",dict(max_iter=20),{"quadratic": True, "dual": True, "soc": False}))
 
+if has_conic("ipqp"):
+  conics.append(("ipqp",{},{"less_digits":1,"quadratic": True, "dual": True, "soc": False}))
+
 print(conics)
 
 class ConicTests(casadiTestCase):
@@ -971,5 +974,205 @@ class ConicTests(casadiTestCase):
 
       self.assertTrue(solver.stats()["success"])
 
+  @requires_conic("condensing")
+  @requires_conic("qrqp")
+  def test_condensing(self):
+    N = 6
+    X = [SX.sym("x%d" % k, 2) for k in range(N+1)]
+    U = [SX.sym("u%d" % k) for k in range(N)]
+    w = []; lbw = []; ubw = []; g = []; lbg = []; ubg = []; f = 0
+    for k in range(N):
+      w += [X[k], U[k]]
+      lbw += [1, 0] if k==0 else [-inf, -0.02]
+      ubw += [1, 0] if k==0 else [inf, 0.02]
+      lbw += [-2]
+      ubw += [2]
+      f += dot(X[k],X[k]) + 0.1*U[k]**2 + 0.2*X[k][0]*U[k] + X[k][1]
+      g += [vertcat(X[k][0]+0.1*X[k][1], X[k][1]+0.1*U[k]+0.05) - 1.1*X[k+1]]
+      lbg += [0, 0.01]
+      ubg += [0, 0.01]
+      if k>0:
+        g += [X[k][0]+U[k]]
+        lbg += [-inf]
+        ubg += [0.95]
+    w += [X[N]]
+    lbw += [-inf, -0.02]
+    ubw += [inf, 0.02]
+    f += 5*dot(X[N],X[N])
+    g += [X[N][0]-X[N][1]]
+    lbg += [-0.5]
+    ubg += [inf]
+    prob = {"x":vertcat(*w),"f":f,"g":vertcat(*g)}
+    args = {"lbx":lbw,"ubx":ubw,"lbg":lbg,"ubg":ubg}
+    qrqp_options = {"print_iter":False,"print_header":False}
+    solver_ref = qpsol("solver","qrqp",prob,qrqp_options)
+    ref = solver_ref(**args)
+    for block_size in [1, 3, N]:
+      solver = qpsol("solver","condensing",prob,{"N":N,"nx":[2]*(N+1),"nu":[1]*N,
+        "ng":[0]+[1]*N,"block_size":block_size,"qpsol":"qrqp","qpsol_options":qrqp_options})
+      sol = solver(**args)
+      self.assertTrue(solver.stats()["success"])
+      for k in ["x","f","lam_x","lam_g"]:
+        self.checkarray(sol[k],ref[k],digits=8)
+
+  def test_riccati(self):
+    N = 6
+    X = [SX.sym("x%d" % k, 2) for k in range(N+1)]
+    U = [SX.sym("u%d" % k) for k in range(N)]
+    w = []; lbw = []; ubw = []; g = []; lbg = []; ubg = []; f = 0
+    for k in range(N):
+      w += [X[k], U[k]]
+      lbw += [1, 0] if k==0 else [-inf, -0.02]
+      ubw += [1, 0] if k==0 else [inf, 0.02]
+      lbw += [-2]
+      ubw += [2]
+      f += dot(X[k],X[k]) + 0.1*U[k]**2 + 0.2*X[k][0]*U[k] + X[k][1]
+      g += [vertcat(X[k][0]+0.1*X[k][1], X[k][1]+0.1*U[k]+0.05) - 1.1*X[k+1]]
+      lbg += [0, 0.01]
+      ubg += [0, 0.01]
+      if k>0:
+        g += [X[k][0]+U[k]]
+        lbg += [-inf]
+        ubg += [0.95]
+    w += [X[N]]
+    lbw += [-inf, -0.02]
+    ubw += [inf, 0.02]
+    f += 5*dot(X[N],X[N])
+    g += [X[N][0]-X[N][1]]
+    lbg += [-0.5]
+    ubg += [inf]
+    prob = {"x":vertcat(*w),"f":f,"g":vertcat(*g)}
+    args = {"lbx":lbw,"ubx":ubw,"lbg":lbg,"ubg":ubg}
+    solver_ref = qpsol("solver","qrqp",prob,{"print_iter":False,"print_header":False})
+    ref = solver_ref(**args)
+    solver = qpsol("solver","riccati",prob,{"N":N,"nx":[2]*(N+1),"nu":[1]*N,"ng":[0]+[1]*N})
+    sol = solver(**args)
+    self.assertTrue(solver.stats()["success"])
+    for k in ["x","f","lam_x","lam_g"]:
+      self.checkarray(sol[k],ref[k],digits=5)
+
+    # Stage coupling in the Hessian is not supported
+    prob["f"] = f + X[0][0]*X[1][0]
+    with self.assertRaises(Exception):
+      qpsol("solver","riccati",prob,{"N":N,"nx":[2]*(N+1),"nu":[1]*N,"ng":[0]+[1]*N})
+
+  @requires_conic("ipqp")
+  @requires_conic("qrqp")
+  def test_ipqp(self):
+    x = SX.sym("x",5)
+    f = sumsqr(x[1:]-x[:-1]) + 0.1*sumsqr(x) - x[0] + 2*x[4]
+    g = vertcat(x[0]+x[1], x[1]-x[2]+x[3], x[2]+x[4], x[3])
+    prob = {"x":x,"f":f,"g":g}
+    args = {"lbx":[-1,-1,0.2,-inf,-1],"ubx":[1,1,0.2,inf,1],"lbg":[-inf,0.5,-1,-inf],"ubg":[0.3,0.5,1,inf]}
+    solver_ref = qpsol("solver","qrqp",prob,{"print_iter":False,"print_header":False})
+    ref = solver_ref(**args)
+    solver = qpsol("solver","ipqp",prob)
+    sol = solver(**args)
+    self.assertTrue(solver.stats()["success"])
+    for k in ["x","f","lam_x","lam_g"]:
+      self.checkarray(sol[k],ref[k],digits=6)
+
+  @requires_conic("admm")
+  @requires_conic("qrqp")
+  def test_admm(self):
+    x = SX.sym("x",5)
+    p = SX.sym("p")
+    f = sumsqr(x[1:]-x[:-1]) + 0.1*sumsqr(x) - p*x[0] + 2*x[4]
+    g = vertcat(x[0]+x[1], x[1]-x[2]+x[3], x[2]+x[4], x[3])
+    prob = {"x":x,"p":p,"f":f,"g":g}
+    args = {"lbx":[-1,-1,0.2,-inf,-1],"ubx":[1,1,0.2,inf,1],"lbg":[-inf,0.5,-1,-inf],"ubg":[0.3,0.5,1,inf]}
+    solver_ref = qpsol("solver","qrqp",prob,{"print_iter":False,"print_header":False})
+    solver = qpsol("solver","admm",prob,{"eps_abs":1e-9,"eps_rel":1e-9})
+    ref = solver_ref(p=1,**args)
+    sol = solver(p=1,**args)
+    self.assertTrue(solver.stats()["success"])
+    for k in ["x","f","lam_x","lam_g"]:
+      self.checkarray(sol[k],ref[k],digits=6)
+
+    # Warm start with a different gradient, reusing the factorization
+    ref = solver_ref(p=1.1,**args)
+    iter_cold = solver.stats()["iter_count"]
+    sol = solver(p=1.1,x0=sol["x"],lam_x0=sol["lam_x"],lam_g0=sol["lam_g"],**args)
+    self.assertTrue(solver.stats()["success"])
+    self.assertEqual(solver.stats()["n_factor"],0)
+    self.assertTrue(solver.stats()["iter_count"]<iter_cold)
+    for k in ["x","f","lam_x","lam_g"]:
+      self.checkarray(sol[k],ref[k],digits=6)
+
+  @requires_conic("qrqp")
+  def test_qrqp_warmstart(self):
+    x = SX.sym("x",4)
+    p = SX.sym("p")
+    f = dot(x,x) + x[0]*x[1] - p*x[0] - 2*x[3]
+    g = vertcat(x[0]+x[1]+x[2], x[1]-x[3], x[0]+2*x[2])
+    solver = qpsol("solver","qrqp",{"x":x,"p":p,"f":f,"g":g},{"print_iter":False,"print_header":False})
+    args = {"lbx":-1,"ubx":[1,1,1,0.5],"lbg":[-inf,-0.2,-1],"ubg":[0.5,inf,1]}
+    sol = solver(p=3,**args)
+    cold = solver(p=3.1,**args)
+    iter_cold = solver.stats()["iter_count"]
+    warm = solver(p=3.1,lam_x0=sol["lam_x"],lam_g0=sol["lam_g"],**args)
+    stats = solver.stats()
+    self.assertTrue(stats["success"])
+    self.assertTrue(stats["iter_count"]<=iter_cold)
+    # The factorization is only updated in the columns that changed
+    self.assertTrue(stats["n_qr_col"]<=7*(stats["iter_count"]+1))
+    for k in ["x","f","lam_x","lam_g"]:
+      self.checkarray(warm[k],cold[k],digits=8)
+
+  @requires_conic("qpoases")
+  def test_qpoases_warmstart(self):
+    H = DM([[4,1,0,0],[1,2,0.5,0],[0,0.5,3,1],[0,0,1,2]])
+    A = DM([[1,1,1,0],[1,-1,0,1],[0,1,0,2]])
+    args = {"g":DM([1,-1,0.5,-2]),"lba":-0.3,"uba":0.3,"lbx":-0.5,"ubx":0.5}
+    ref = conic("ref","qpoases",{"h":H.sparsity(),"a":A.sparsity()})
+    for opts in [{}, {"sparse":True}, {"schur":True,"linsol_plugin":"ldl"}]:
+      # Cold start from the working set of the solution
+      solver = conic("solver","qpoases",{"h":H.sparsity(),"a":A.sparsity()},opts)
+      sol = ref(h=H,a=A,**args)
+      warm = solver(h=H,a=A,x0=sol["x"],lam_x0=sol["lam_x"],lam_a0=sol["lam_a"],**args)
+      self.assertTrue(solver.stats()["success"])
+      for k in ["x","cost","lam_x","lam_a"]:
+        self.checkarray(warm[k],sol[k],digits=8)
+      # Hotstart with changed matrices
+      for s in [1.1,1.2]:
+        sol = solver(h=s*H,a=s*A,**args)
+        self.assertTrue(solver.stats()["success"])
+        sol_ref = ref(h=s*H,a=s*A,**args)
+        for k in ["x","cost","lam_x","lam_a"]:
+          self.checkarray(sol[k],sol_ref[k],digits=8)
+
+  def test_batch(self):
+    H = DM([[4,1,0],[1,2,0.5],[0,0.5,3]])
+    A = DM([[1,1,1],[1,-1,0]])
+    N = 10
+    G = DM(numpy.random.RandomState(0).uniform(-2,2,(3,N)))
+    args = {"h":repmat(H,1,N),"a":repmat(A,1,N),"g":G,"lba":-0.3,"uba":0.3,"lbx":-0.5,"ubx":0.5}
+    for conic_name, opts in [("qrqp",{"print_iter":False,"print_header":False}),
+                             ("admm",{"eps_abs":1e-9,"eps_rel":1e-9}),
+                             ("ipqp",{})]:
+      if not has_conic(conic_name): continue
+      solver = conic("solver",conic_name,{"h":H.sparsity(),"a":A.sparsity()},opts)
+      ref = solver.map(N,"serial")(**args)
+      sol = solver.map(N,"serial",{"batch_size":4})(**args)
+      for k in ["x","cost","lam_x","lam_a"]:
+        self.checkarray(sol[k],ref[k],digits=6)
+
+  def test_incremental(self):
+    H = DM([[4,1,0],[1,2,0.5],[0,0.5,3]])
+    A = DM([[1,1,1],[1,-1,0]])
+    for conic_name in ["cplex","gurobi"]:
+      if not has_conic(conic_name): continue
+      solver = conic("solver",conic_name,{"h":H.sparsity(),"a":A.sparsity()},{"incremental":True})
+      ref = conic("ref",conic_name,{"h":H.sparsity(),"a":A.sparsity()})
+      args = {"h":H,"a":A,"g":DM([1,-1,0.5]),"lba":-0.3,"uba":0.3,"lbx":-0.5,"ubx":0.5}
+      for update in [{}, {"g":DM([0.5,-1,1])}, {"lbx":-0.4,"uba":0.2},
+                     {"a":DM([[1,2,1],[1,-1,0]])}, {"lba":-inf}, {"h":2*H}]:
+        args.update(update)
+        sol = solver(**args)
+        self.assertEqual(solver.stats()["model_updated"], len(update)>0 and "h" not in update)
+        sol_ref = ref(**args)
+        for k in ["x","cost"]:
+          self.checkarray(sol[k],sol_ref[k],digits=6)
+
 if __name__ == '__main__':
     unittest.main()
@@ -51,6 +51,9 @@ dplesolvers = []
 if has_dple("slicot"):
   dplesolvers.append(("slicot",{"linear_solver": "csparse"}))
 
+if has_dple("doubling"):
+  dplesolvers.append(("doubling",{}))
+
 def randstable(n,margin=0.8,minimal=0):
   r = margin
   A_ = tril(DM(numpy.random.random((n,n))))
@@ -148,5 +151,30 @@ class Controltests(casadiTestCase):
 
           self.checkfunction(solver,refsol,inputs=inputs,failmessage=str(Solver))
     
+  @skip(not scipy_available)
+  def test_dple_doubling(self):
+    if not has_dple("doubling"): return
+    numpy.random.seed(1)
+    n = 3
+    K = 3
+    A_ = [randstable(n) for i in range(K)]
+    V_ = [mtimes(v,v.T) for v in [DM(numpy.random.random((n,n))) for i in range(K)]]
+    S = kron(Sparsity.diag(K),Sparsity.dense(n,n))
+    solver = dplesol("solver", "doubling", {'a':S,'v':S})
+    P = solver(a=dcat(A_), v=dcat(V_))["p"]
+    P_ = diagsplit(P,n)
+
+    # Periodic Lyapunov equations are satisfied
+    for k in range(K):
+      self.checkarray(P_[(k+1) % K], mtimes([A_[k],P_[k],A_[k].T])+V_[k],digits=10)
+    self.assertTrue(solver.stats()["success"])
+
+    # Unstable system is detected
+    with self.assertInException("did not converge"):
+      unstable = dplesol("unstable", "doubling", {'a':S,'v':S}, {"error_unstable": True})
+      unstable(a=dcat([1.5*DM.eye(n) for a in A_]), v=dcat(V_))
+
+    self.check_codegen(solver,inputs=[dcat(A_),dcat(V_)])
+
 if __name__ == '__main__':
     unittest.main()
@@ -561,6 +561,17 @@ class Functiontests(casadiTestCase):
     self.checkfunction_light(fun.map(3,"thread",2),fun.map(3),inputs=[hcat(X_[:3]),hcat(Y_[:3]),hcat(Z_[:3]),hcat(V_[:3])])
     self.checkfunction_light(fun.map(4,"thread",2),fun.map(4),inputs=[hcat(X_[:4]),hcat(Y_[:4]),hcat(Z_[:4]),hcat(V_[:4])])
     self.checkfunction_light(fun.map(4,"thread",5),fun.map(4),inputs=[hcat(X_[:4]),hcat(Y_[:4]),hcat(Z_[:4]),hcat(V_[:4])])
+    self.assertEqual(fun.map(4,"thread",2).info()["max_num_threads"],2)
+
+    for opts in [{"schedule":"dynamic"},{"schedule":"dynamic","chunk_size":3,"max_num_threads":2}]:
+      self.checkfunction_light(fun.map(7,"thread",opts),fun.map(7),inputs=[hcat(X_[:7]),hcat(Y_[:7]),hcat(Z_[:7]),hcat(V_[:7])])
+    self.checkfunction_light(fun.map(7,"openmp",{"schedule":"dynamic","chunk_size":2}),fun.map(7),inputs=[hcat(X_[:7]),hcat(Y_[:7]),hcat(Z_[:7]),hcat(V_[:7])])
+
+    # Parallel sparsity propagation
+    for f in [fun.map(7,"thread",2), fun.map(7,"openmp"), fun.map(7,"thread",{"schedule":"dynamic"})]:
+      for i in range(fun.n_in()):
+        for j in range(fun.n_out()):
+          self.assertTrue(f.sparsity_jac(i,j)==fun.map(7).sparsity_jac(i,j))
 
   @memory_heavy()
   def test_mapsum(self):
@@ -855,6 +866,19 @@ class Functiontests(casadiTestCase):
   #   [v] = f([])
   #   self.checkarray(2.37683, v, digits=4)
 
+  @requiresPlugin(Importer,"clang")
+  def test_clang_cache(self):
+    opts = {"optimization_level":2,"vectorize":True,"target_cpu":"native"}
+    c1 = Importer('../data/helloworld.c', 'clang', opts)
+    c2 = Importer('../data/helloworld.c', 'clang', opts)
+    self.assertTrue(c2.stats()["cache_hit"])
+    self.assertTrue(c1.stats()["t_frontend"]>=0)
+    for c in [c1, c2]:
+      [v] = external("helloworld_c", c)([])
+      self.checkarray(2.37683, v, digits=4)
+    c3 = Importer('../data/helloworld.c', 'clang', {"cache":False})
+    self.assertFalse(c3.stats()["cache_hit"])
+
   # @requiresPlugin(Importer,"shell")
   # def test_shell_c(self):
   #   compiler = Importer('../data/helloworld.c', 'shell')
@@ -994,7 +1018,7 @@ class Functiontests(casadiTestCase):
   def test_1d_interpolant_uniform(self):
     grid = [[0, 1, 2]]
     values = [0, 1, 2]
-    for opts in [{"lookup_mode": ["linear"]},{"lookup_mode": ["exact"]},{"lookup_mode": ["binary"]}]:
+    for opts in [{"lookup_mode": ["linear"]},{"lookup_mode": ["exact"]},{"lookup_mode": ["binary"]},{"lookup_mode": ["hunt"]},{"lookup_mode": ["table"]}]:
       F = interpolant('F', 'linear', grid, values, opts)
       def same(a, b): return abs(float(a)-b)<1e-8
       self.assertTrue(same(F(2.4), 2.4))
@@ -1010,7 +1034,7 @@ class Functiontests(casadiTestCase):
 
     grid = [[2, 4, 6]]
     values = [10, 7, 1]
-    for opts in [{"lookup_mode": ["linear"]},{"lookup_mode": ["exact"]},{"lookup_mode": ["binary"]}]:
+    for opts in [{"lookup_mode": ["linear"]},{"lookup_mode": ["exact"]},{"lookup_mode": ["binary"]},{"lookup_mode": ["hunt"]},{"lookup_mode": ["table"]}]:
       F = interpolant('F', 'linear', grid, values, opts)
       def same(a, b): return abs(float(a)-b)<1e-8
       self.assertTrue(same(F(1), 11.5))
@@ -1026,7 +1050,7 @@ class Functiontests(casadiTestCase):
   def test_2d_interpolant_uniform(self):
     grid = [[0, 1, 2], [0, 1, 2]]
     values = [0, 1, 2, 10, 11, 12, 20, 21, 22]
-    for opts in [{"lookup_mode": ["linear","linear"]},{"lookup_mode": ["exact","exact"]},{"lookup_mode": ["binary","binary"]}]:
+    for opts in [{"lookup_mode": ["linear","linear"]},{"lookup_mode": ["exact","exact"]},{"lookup_mode": ["binary","binary"]},{"lookup_mode": ["hunt","table"]}]:
       F = interpolant('F', 'linear', grid, values, opts)
       def same(a, b): return abs(float(a)-b)<1e-8
       self.assertTrue(same(F([2.4, 0.5]), 7.4))
@@ -1041,6 +1065,107 @@ class Functiontests(casadiTestCase):
       self.assertTrue(same(F([-.6, 2.5]), 24.4))
       self.assertTrue(same(F([-.6, 3.5]), 34.4))
 
+  def test_bspline_fitting(self):
+    grid = [list(np.linspace(0,1,6)**2), list(np.linspace(-1,2,7)), [0, 0.5, 2, 3, 7]]
+    values = np.random.random(6*7*5*2)
+    F = interpolant('F', 'bspline', grid, values, {"fitting": "full"})
+    X = DM(np.random.random((3,20)))
+    for opts in [{}, {"fitting": "kronecker"}, {"fitting": "kronecker", "linear_solver": "csparse"}]:
+      G = interpolant('G', 'bspline', grid, values, opts)
+      self.checkarray(G.map(20)(X), F.map(20)(X), digits=8)
+      self.checkarray(G(vertcat(grid[0][2],grid[1][3],grid[2][1])), DM(values[2*(2+6*(3+7*1)):][:2]), digits=8)
+
+  def test_polynomial(self):
+    np.random.seed(1)
+    exponents = [[0,0,0],[1,0,0],[0,2,1],[3,1,0],[0,0,4],[2,2,2]]
+    coeff = DM(np.random.random((2,6)))
+    coeff[0,2] = 0
+    coeff = sparsify(coeff)
+    lbx = [-1, 0, 2]
+    ubx = [1, 3, 5]
+    x = SX.sym("x",3)
+    def cheb(s, d):
+      a, b = 1, s
+      if d==0: return a
+      for k in range(d-1): a, b = b, 2*s*b-a
+      return b
+    for basis in ["monomial", "chebyshev"]:
+      opts = {"basis": basis}
+      if basis=="chebyshev": opts.update({"lbx": lbx, "ubx": ubx})
+      P = Function.polynomial('P', exponents, coeff, opts)
+      y = 0
+      for t, e in enumerate(exponents):
+        phi = 1
+        for j in range(3):
+          if basis=="monomial":
+            phi = phi*x[j]**e[j]
+          else:
+            phi = phi*cheb((2*x[j]-(lbx[j]+ubx[j]))/(ubx[j]-lbx[j]), e[j])
+        y = y + coeff[:,t]*phi
+      R = Function('R',[x],[y])
+      X = DM(np.random.random((3,1)))
+      self.checkfunction(P,R,inputs=[X])
+      self.check_codegen(P,inputs=[X])
+      FB = P.map(20,"serial",{"batch_size":7})
+      X = DM(np.random.random((3,20)))
+      self.checkarray(FB(X), R.map(20)(X))
+      self.check_codegen(FB,inputs=[X])
+      self.assertTrue(P.sparsity_jac(0,0)==R.sparsity_jac(0,0))
+
+  def test_mlp(self):
+    np.random.seed(1)
+    widths = [3, 6, 5, 2]
+    W = [DM(np.random.random((widths[l+1],widths[l]))-0.5) for l in range(3)]
+    b = [DM(np.random.random((widths[l+1],1))) for l in range(3)]
+    act = {"identity": lambda z: z, "tanh": tanh, "sigmoid": lambda z: 1/(1+exp(-z)),
+           "relu": lambda z: fmax(z,0), "softplus": lambda z: log(1+exp(z))}
+    x = SX.sym("x",3)
+    for acts in [["tanh","sigmoid","identity"], ["relu","softplus","tanh"], ["softplus"]]:
+      F = Function.mlp('F', W, b, acts)
+      if len(acts)==1: acts = [acts[0], acts[0], "identity"]
+      h = x
+      for l in range(3):
+        h = act[acts[l]](mtimes(W[l],h)+b[l])
+      R = Function('R',[x],[h])
+      X = DM(np.random.random((3,1)))
+      self.checkfunction(F,R,inputs=[X])
+      self.check_codegen(F,inputs=[X])
+      FB = F.map(20,"serial",{"batch_size":7})
+      X = DM(np.random.random((3,20)))
+      self.checkarray(FB(X), R.map(20)(X))
+      self.check_codegen(FB,inputs=[X])
+    with self.assertInException("columns"):
+      Function.mlp('F', [W[0], W[2]], [], ["tanh"])
+
+  def test_interpolant_batch(self):
+    grid = [list(np.linspace(0,1,200)**3), [0, 0.5, 2, 3, 7]]
+    values = np.random.random(200*5)
+    X = DM(np.vstack([np.linspace(-0.1,1.1,30), np.random.random(30)*8-0.5]))
+    for plugin in ['linear','bspline']:
+      for modes in [["binary","linear"],["hunt","table"]]:
+        F = interpolant('F', plugin, grid, values, {"lookup_mode": modes})
+        for bs in [1,7,30]:
+          FB = F.map(30,"serial",{"batch_size":bs})
+          self.checkarray(FB(X), F.map(30)(X))
+          self.check_codegen(FB,inputs=[X])
+
+  def test_interpolant_lookup_nonuniform(self):
+    grid = [list(np.linspace(0,1,200)**3), [0, 0.5, 2, 3, 7]]
+    values = np.random.random(200*5)
+    x = MX.sym("x",2)
+    for plugin in ['linear','bspline']:
+      F = interpolant('F', plugin, grid, values, {"lookup_mode": ["binary","linear"]})
+      J = Function('J',[x],[jacobian(F(x),x)])
+      for modes in [["hunt","hunt"],["table","table"],["hunt","table"]]:
+        G = interpolant('G', plugin, grid, values, {"lookup_mode": modes})
+        JG = Function('JG',[x],[jacobian(G(x),x)])
+        # Slowly varying inputs, jumps and points outside the grid
+        for t in list(np.linspace(-0.1,1.1,50))+[0.9,0.1,1,0,-1]:
+          a = vertcat(t, 8*t-0.5)
+          self.checkarray(G(a), F(a))
+          self.checkarray(JG(a), J(a))
+        self.check_codegen(G, inputs=[vertcat(0.3,2.5)])
+
   @skip(not scipy_interpolate)
   def test_2d_bspline(self):
     import scipy.interpolate
@@ -1167,6 +1292,145 @@ class Functiontests(casadiTestCase):
 
     self.checkfunction(f,g,inputs=num_inputs,fwd=False,adj=False,indirect=False)
 
+  def test_Callback_jacobian_sparsity(self):
+    n = 20
+    x = MX.sym("x",n)
+    g = Function("g",[x],[sin(x)*x[::-1]])
+
+    class Fun(Callback):
+        def __init__(self, sp):
+          Callback.__init__(self)
+          self.sp = sp
+          self.nevals = 0
+          self.construct("Fun", {"enable_fd":True})
+        def get_n_in(self): return 1
+        def get_n_out(self): return 1
+        def get_sparsity_in(self,i): return Sparsity.dense(n,1)
+        def get_sparsity_out(self,i): return Sparsity.dense(n,1)
+        def has_jacobian_sparsity(self): return self.sp
+        def get_jacobian_sparsity(self): return Sparsity.diag(n)+Sparsity.diag(n)[:,::-1]
+        def eval(self,arg):
+          self.nevals += 1
+          return [sin(arg[0])*arg[0][::-1]]
+
+    x0 = DM(range(n))/n
+    J_ref = Function("J",[x],[jacobian(g(x),x)])(x0)
+    nevals = []
+    for sp in [False, True]:
+      f = Fun(sp)
+      J = Function("J",[x],[jacobian(f(x),x)])
+      f.nevals = 0
+      self.checkarray(J(x0),J_ref,digits=5)
+      nevals.append(f.nevals)
+    # Columns i and n-1-i share a row, two colors suffice
+    self.assertTrue(nevals[1]<nevals[0])
+    self.assertTrue(nevals[1]<=1+2*2*2)
+
+  def test_Callback_jac_sparsity_blocks(self):
+    n = 10
+
+    class Fun(Callback):
+        def __init__(self):
+          Callback.__init__(self)
+          self.construct("Fun", {"enable_fd":True})
+        def get_n_in(self): return 2
+        def get_n_out(self): return 2
+        def get_sparsity_in(self,i): return Sparsity.dense(n,1) if i==0 else Sparsity.diag(2)
+        def get_sparsity_out(self,i): return Sparsity.dense(n,1)
+        def has_jac_sparsity(self,oind,iind): return True
+        def get_jac_sparsity(self,oind,iind,symmetric):
+          if iind==1: return Sparsity(n,4) if oind==0 else Sparsity.dense(n,4)
+          return Sparsity.diag(n)
+        def eval(self,arg):
+          return [sin(arg[0]), arg[0]**2+arg[1][0,0]+arg[1][1,1]]
+
+    f = Fun()
+    self.checkarray(f.sparsity_jac(0,0).nnz(),n)
+    self.checkarray(f.sparsity_jac(1,0).nnz(),0)
+    self.checkarray(f.sparsity_jac(1,1).size2(),2)
+
+    x = MX.sym("x",n)
+    p = MX.sym("p",Sparsity.diag(2))
+    [y,z] = f(x,p)
+    self.assertFalse(depends_on(y,p))
+    J = Function("J",[x,p],[jacobian(y,x),jacobian(z,p)])
+    Jx, Jp = J(DM(range(n))/n, DM.eye(2))
+    self.checkarray(Jx,diag(cos(DM(range(n))/n)),digits=5)
+    self.checkarray(Jp,DM.ones(n,2),digits=5)
+
+  def test_Callback_eval_batch(self):
+    x = MX.sym("x",2)
+    g = Function("g",[x],[vertcat(sin(x[0])*x[1],x[0]**2)])
+
+    class Fun(Callback):
+        def __init__(self, batch):
+          Callback.__init__(self)
+          self.batch = batch
+          self.ncalls = 0
+          self.construct("Fun", {"enable_fd":True})
+        def get_n_in(self): return 1
+        def get_n_out(self): return 1
+        def get_sparsity_in(self,i): return Sparsity.dense(2,1)
+        def get_sparsity_out(self,i): return Sparsity.dense(2,1)
+        def eval(self,arg):
+          self.ncalls += 1
+          return [g(arg[0])]
+        def has_eval_batch(self): return self.batch
+        def eval_batch(self,arg,n):
+          self.ncalls += 1
+          x = numpy.array(arg[0])
+          return [numpy.vstack((numpy.sin(x[0,:])*x[1,:],x[0,:]**2))]
+
+    X = DM([[0.1,0.2,0.3,0.4],[1,2,3,4]])
+    for batch in [False, True]:
+      f = Fun(batch)
+      F = f.map(4)
+      f.ncalls = 0
+      self.checkarray(F(X),g.map(4)(X))
+      self.checkarray(f.ncalls,1 if batch else 4)
+
+      J = Function("J",[x],[jacobian(f(x),x)])
+      f.ncalls = 0
+      self.checkarray(J(X[:,0]),Function("J",[x],[jacobian(g(x),x)])(X[:,0]),digits=5)
+      if batch:
+        # One call for the nominal point, one per step size iteration
+        self.assertTrue(f.ncalls<=3)
+
+  def test_Callback_eval_async(self):
+    x = MX.sym("x",2)
+    g = Function("g",[x],[vertcat(sin(x[0])*x[1],x[0]**2)])
+
+    class Fun(Callback):
+        def __init__(self):
+          Callback.__init__(self)
+          self.pending = {}
+          self.max_pending = 0
+          self.next = 0
+          self.construct("Fun", {"enable_fd":True})
+        def get_n_in(self): return 1
+        def get_n_out(self): return 1
+        def get_sparsity_in(self,i): return Sparsity.dense(2,1)
+        def get_sparsity_out(self,i): return Sparsity.dense(2,1)
+        def has_eval_async(self): return True
+        def eval_async(self,arg):
+          self.next += 1
+          self.pending[self.next] = g(arg[0])
+          self.max_pending = max(self.max_pending, len(self.pending))
+          return self.next
+        def eval_await(self,handle):
+          return [self.pending.pop(handle)]
+
+    X = DM([[0.1,0.2,0.3,0.4],[1,2,3,4]])
+    f = Fun()
+    self.checkarray(f(X[:,1]),g(X[:,1]))
+    self.checkarray(f.max_pending,1)
+    self.checkarray(f.map(4)(X),g.map(4)(X))
+    self.checkarray(f.max_pending,4)
+    self.assertTrue(len(f.pending)==0)
+    J = Function("J",[x],[jacobian(f(x),x)])
+    self.checkarray(J(X[:,0]),Function("J",[x],[jacobian(g(x),x)])(X[:,0]),digits=5)
+    self.assertTrue(f.max_pending>=4)
+
 
   def test_Callback_errors(self):
 
@@ -1530,6 +1794,31 @@ class Functiontests(casadiTestCase):
       self.assertTrue(JA.nnz()==0)
       self.assertTrue(Jt.nnz()==n**2)
 
+  @requires_expm("pade")
+  def test_expm_pade(self):
+      n = 4
+      np.random.seed(0)
+      Anum = np.random.random((n,n))
+
+      A = MX.sym("A",n,n)
+      t = MX.sym("t")
+
+      # Reference: truncated Taylor series
+      term = MX.eye(n)
+      ref = MX.eye(n)
+      for k in range(1,60):
+        term = mtimes(term,A*t)/k
+        ref += term
+
+      fr = Function('fr',[A,t],[ref])
+      F = expmsol('F','pade',Sparsity.dense(n,n))
+      f = Function('f',[A,t],[F(A,t)])
+
+      # Norm of A*t large enough to require squaring
+      for tnum in [0.3, 3.0]:
+        self.checkfunction(fr,f,inputs=[Anum, tnum],digits=8)
+      self.check_codegen(f,inputs=[Anum, 3.0])
+
   def test_conditional(self):
 
     np.random.seed(5)
@@ -1554,6 +1843,53 @@ class Functiontests(casadiTestCase):
       self.checkfunction(F,Fsx,inputs = [i,A,B])
       self.check_codegen(F,inputs=[i,A,B])
 
+  def test_conditional_lazy(self):
+
+    x = MX.sym('x',2)
+
+    f = [Function("f%d" % k,[x],[sin((k+1)*x)*x[0]]) for k in range(4)]
+    fdef = Function("fdef",[x],[x**2])
+
+    F = Function.conditional("test",f,fdef,{"lazy_derivatives":True})
+    Fref = Function.conditional("test",f,fdef)
+
+    J = F.jacobian_old(1,0)
+    Jref = Fref.jacobian_old(1,0)
+
+    x0 = DM([0.3,0.7])
+    for i in range(-1,5):
+      self.checkarray(J(i,x0)[0],Jref(i,x0)[0])
+      self.checkarray(F.reverse(1)(i,x0,0,DM([1,2]))[1],Fref.reverse(1)(i,x0,0,DM([1,2]))[1])
+
+    self.assertTrue(F.sparsity_jac(1,0)==Fref.sparsity_jac(1,0))
+
+  def test_conditional_codegen_table(self):
+    x = MX.sym('x',2)
+    f = [Function("f%d" % k,[x],[(k+1)*x]) for k in range(4)]
+    F = Function.conditional("test",f,Function("fdef",[x],[x**2]))
+
+    c = CodeGenerator('me')
+    c.add(F)
+    self.assertTrue("tbl[k]" in c.dump())
+    for i in range(-1,5):
+      self.check_codegen(F,inputs=[i,DM([0.3,0.7])])
+
+  def test_memoize(self):
+    x = MX.sym('x',2)
+    y = MX.sym('y')
+    f = Function("f",[x,y],[sin(x)*y,y**2])
+    F = f.memoize("F",2)
+
+    for v in [1,1,2,3,1,3]:
+      self.checkarray(F(DM([v,2]),v)[0],f(DM([v,2]),v)[0])
+
+    stats = F.stats()
+    self.assertEqual(stats["n_hit"],2)
+    self.assertEqual(stats["n_miss"],4)
+    self.assertEqual(stats["n_cached"],2)
+
+    self.checkfunction(F,f,inputs=[DM([0.3,0.7]),1.5])
+
   def test_max_num_dir(self):
     x = MX.sym("x",10)
 
@@ -1597,6 +1933,46 @@ class Functiontests(casadiTestCase):
 
     self.assertTrue("ffff_acc4_acc4_acc4" in code)
 
+  def test_codegen_split(self):
+    x = MX.sym("x",3)
+    f = Function("f",[x],[sin(x)*x])
+    h = Function("h",[x],[f(x)**2, f(2*x)+x])
+
+    c = CodeGenerator('codegen_split', {"split": 2})
+    c.add(h)
+    files = c.source_files()
+    self.assertEqual(files, ["codegen_split.c", "codegen_split_1.c"])
+    c.generate()
+
+    if args.run_slow:
+      compiler = Importer(files[0], "shell", {"extra_sources": files[1:]})
+      h2 = external("h", compiler)
+      v = DM([1.1,2.3,0.4])
+      for r, r2 in zip(h(v), h2(v)):
+        self.checkarray(r, r2)
+
+  def test_external_shared_library(self):
+    x = MX.sym("x",2)
+    f = Function("f",[x],[sin(x)])
+    g = Function("g",[x],[x**2])
+    c = CodeGenerator('external_shared')
+    c.add(f)
+    c.add(g)
+    c.generate()
+
+    if args.run_slow:
+      import subprocess, os
+      subprocess.Popen("gcc -fPIC -shared -O1 external_shared.c -o external_shared.so", shell=True).wait()
+      lib = os.path.abspath("external_shared.so")
+      # One library, whichever way the path is written
+      li = Importer(lib,"dll")
+      li2 = Importer("./external_shared.so","dll")
+      self.assertEqual(hash(li), hash(li2))
+      f2 = external("f", lib)
+      g2 = external("g", "./external_shared.so")
+      self.checkarray(f2(DM([1,2])), sin(DM([1,2])))
+      self.checkarray(g2(DM([1,2])), DM([1,4]))
+
   def test_2d_linear_multiout(self):
     np.random.seed(0)
 
@@ -1679,6 +2055,59 @@ class Functiontests(casadiTestCase):
     self.check_codegen(f,inputs=[np.random.random((3,3))], opts={"avoid_stack": True})
 
 
+  def test_codegen_report(self):
+    import json, os
+    x = SX.sym("x",3)
+    f = Function('f',[x],[sin(x)*x+1])
+    X = MX.sym("X",3)
+    g = Function('g',[X],[f(X)+f(2*X), X*X])
+    for avoid_stack in [False, True]:
+      g.generate("g_report_test.c", {"with_report": True, "avoid_stack": avoid_stack})
+      with open("g_report_test_report.json") as r:
+        report = json.load(r)
+      os.remove("g_report_test.c")
+      os.remove("g_report_test_report.json")
+      self.assertEqual(report["exposed"],["g"])
+      rf = report["functions"]["f"]
+      rg = report["functions"]["g"]
+      self.assertEqual(rf["flops"]["sin"],3)
+      self.assertEqual(rf["n_flop"],9)
+      self.assertEqual(rg["calls"],["f"])
+      self.assertEqual(rg["flops"]["mul"],6)
+      self.assertEqual(rg["control"],"static")
+      # Local variables of f are on the stack of g
+      self.assertEqual(rg["stack_bytes"],rf["stack_bytes"])
+      self.assertEqual(rf["stack_bytes"]>0,not avoid_stack)
+      self.assertTrue(rg["work_bytes"]>=rf["work_bytes"])
+
+  def test_codegen_with_mem_threads(self):
+    import os
+    x = MX.sym("x",3)
+    p = MX.sym("p")
+    f = Function('f_mem_test',[x,p],[sin(x)*p+mtimes(x.T(),x)])
+    f.generate("f_mem_test.c", {"with_mem": True})
+    with open("f_mem_test.c") as r:
+      src = r.read()
+    for e in ["f_mem_test_checkout", "f_mem_test_release", "f_mem_test_call"]:
+      self.assertTrue(e in src)
+    if args.run_slow:
+      import subprocess, ctypes
+      import casadi as ca
+      inc = os.path.dirname(os.path.dirname(ca.__file__))
+      subprocess.Popen("gcc -std=c99 -fPIC -shared -O1 -I%s f_mem_test.c -o f_mem_test.so" % inc, shell=True).wait()
+      lib = ctypes.CDLL("./f_mem_test.so")
+      lib.f_mem_test_checkout.restype = ctypes.c_void_p
+      lib.f_mem_test_release.argtypes = [ctypes.c_void_p]
+      # Concurrent checkouts get distinct memory objects
+      m = [lib.f_mem_test_checkout() for i in range(3)]
+      self.assertTrue(all(m))
+      self.assertEqual(len(set(m)),3)
+      lib.f_mem_test_release(m[1])
+      self.assertEqual(lib.f_mem_test_checkout(),m[1])
+      for e in m: lib.f_mem_test_release(e)
+      os.remove("f_mem_test.so")
+    os.remove("f_mem_test.c")
+
   def test_sx_serialize(self):
     x = SX.sym("x")
     y = x+3
@@ -1731,6 +2160,72 @@ class Functiontests(casadiTestCase):
     with self.assertInException("'serialize' not defined for MXFunction"):
       pickle.loads(pickle.dumps(f))
 
+  def test_save_load(self):
+    import tempfile, os, shutil
+    d = tempfile.mkdtemp()
+    try:
+      fname = os.path.join(d,"f.casadi")
+      x = SX.sym("x")
+      y = SX.sym("y", Sparsity.lower(3))
+      z = x+y
+      f = Function('f',[x,y],[sparsify(vertcat(z[0],0,z[1])),z.T,x**2,np.nan,-np.inf],["x","y"],["a","b","c","d","e"])
+      f.save(fname)
+      fs = Function.load(fname)
+      self.assertEqual(fs.name_in(1), "y")
+      self.assertEqual(fs.name_out(0), "a")
+      self.assertEqual(fs.name(), "f")
+      self.assertTrue(fs.is_a("SXFunction"))
+      self.checkfunction(f,fs,inputs=[3.7,np.array([[1,0,0],[2,3,0],[4,5,6]])],hessian=False)
+
+      # MX, with nested Functions that are written once
+      X = MX.sym("X",2,2)
+      v = MX.sym("v",2)
+      p = MX.sym("p")
+      g = Function('g',[v],[sin(v)*v[0]])
+      h = Function('h',[vertcat(v,p),X],[mtimes(X,v)+g(v)*p,g(g(v))[1:],trace(X)+dot(v,v),norm_fro(X),X.T[:,1],horzsplit(X)[0]],
+                   {"default_in":[0,2]})
+      h.save(fname)
+      hs = Function.load(fname)
+      self.assertTrue(hs.is_a("MXFunction"))
+      self.assertEqual(hs.default_in(1),2)
+      self.checkfunction(h,hs,inputs=[DM([1,2,3]),DM([[1,2],[3,5]])],hessian=False)
+      n_call = lambda f: len([i for i in range(f.n_instructions()) if f.instruction_id(i)==OP_CALL])
+      self.assertEqual(n_call(hs),n_call(h))
+
+      with self.assertInException("Not a CasADi binary file"):
+        with open(fname,"w") as f: f.write("not a binary file, but long enough")
+        Function.load(fname)
+      p = SX.sym("p")
+      with self.assertInException("Cannot serialize SXFunction with free parameters"):
+        Function('f',[x],[p]).save(fname)
+    finally:
+      shutil.rmtree(d)
+
+  def test_load_lazy(self):
+    import tempfile, os, shutil
+    d = tempfile.mkdtemp()
+    try:
+      fname = os.path.join(d,"h.casadi")
+      v = MX.sym("v",2)
+      p = MX.sym("p")
+      g = Function('g',[v],[sin(v)*v[0]])
+      h = Function('h',[v,p],[g(g(v))*p+g(v)])
+      h.save(fname)
+      h1 = Function.load(fname,{"lazy":True})
+      h2 = Function.load(fname,{"lazy":True})
+      calls = lambda f: [f.instruction_MX(i).which_function() for i in range(f.n_instructions()) if f.instruction_id(i)==OP_CALL]
+      self.assertFalse(any(c.info()["loaded"] for c in calls(h1)))
+      self.checkfunction(h,h1,inputs=[DM([1,2]),3],hessian=False)
+      self.assertTrue(all(c.info()["loaded"] for c in calls(h1)))
+      self.checkfunction(h,h2,inputs=[DM([1,2]),3],hessian=False)
+
+      # Identical sub-Functions are shared between loads
+      for c1, c2 in zip(calls(h1), calls(h2)):
+        self.assertTrue(c1.is_a("LazyFunction"))
+        self.assertEqual(hash(c1), hash(c2))
+    finally:
+      shutil.rmtree(d)
+
   def test_string(self):
     x=MX.sym("x")
     y=MX.sym("y")
@@ -1760,6 +2255,25 @@ class Functiontests(casadiTestCase):
 
     self.checkfunction(F,Fref,inputs=[DM([[1,2],[3,7]])])
 
+  def test_mapaccum_native(self):
+    x = MX.sym("x",2)
+    u = MX.sym("u")
+    p = MX.sym("p")
+    f = Function("f",[x,u,p],[vertcat(x[1],-p*sin(x[0])+u)*0.1+x,x[0]*u])
+
+    n = 7
+    Fref = f.mapaccum("ref",n)
+    F = f.mapaccum("acc",n,1,{"unroll":False})
+    self.assertEqual(F.info()["n"],n)
+
+    inputs = [DM([0.3,0.2]),DM(range(n)).T*0.1,DM(range(n)).T*0.05+1]
+    self.checkfunction(F,Fref,inputs=inputs)
+    self.check_codegen(F,inputs=inputs)
+
+    for K in [1,3,n]:
+      Ffold = f.fold(n,{"unroll":False,"checkpoint_interval":K})
+      self.checkfunction(Ffold,f.fold(n),inputs=inputs)
+
 
   @memory_heavy()
   def test_thread_safety(self):
@@ -1777,6 +2291,63 @@ class Functiontests(casadiTestCase):
       res = finv_par(numpy.ones(200), numpy.linspace(0, 10, 200))
       self.checkarray(norm_inf(res.T-sqrt(numpy.linspace(0, 10, 200))),0, digits=5)
 
+  def test_parallel_eval(self):
+    x = MX.sym('x')
+    y = MX.sym('y')
+    f = Function('f', [x, y], [x ** 2 - y])
+    finv = rootfinder('finv', 'newton', f)
+    p = MX.sym('p', 6)
+    r = [finv(1, p[i]) for i in range(6)]
+    out = [vertcat(*r), r[0]*r[1]+sin(r[2])]
+    F = Function('F', [p], out)
+    for n in [1, 2, 4]:
+      Fp = Function('Fp', [p], out, {"parallel": True, "max_num_threads": n})
+      self.checkfunction(Fp, F, inputs=[numpy.linspace(1, 6, 6)])
+
+  def test_parallel_codegen(self):
+    x = SX.sym('x', 3)
+    f = Function('f', [x], [sin(x)*x[0]+cos(x[1])])
+    y = MX.sym('y', 3)
+    r = [f(k*y) for k in range(1, 5)]
+    out = [r[0]+r[1]*r[2]-r[3], f.map(7, "thread", 3)(repmat(y, 1, 7))]
+    F = Function('F', [y], out)
+    Fp = Function('Fp', [y], out, {"parallel": True, "max_num_threads": 3})
+    self.checkfunction(Fp, F, inputs=[DM([0.3, 0.7, 1.1])])
+    src = Fp.generate()
+    self.assertTrue("#pragma omp parallel for" in open(src).read())
+    self.check_codegen(Fp, inputs=[DM([0.3, 0.7, 1.1])])
+
+  def test_export_kernel(self):
+    x = SX.sym('x', 3)
+    p = SX.sym('p')
+    f = Function('f', [x, p], [vertcat(sin(x[0])*p+x[1]**2, fmax(x[2], p)), exp(x[0])])
+    src = f.export_code("opencl")
+    self.assertTrue("__kernel void f(const long n" in src)
+    self.assertTrue("get_global_id(0)" in src)
+    src = f.export_code("cuda", {"real": "float", "coalesced": True, "kernel_name": "fk"})
+    self.assertTrue("__global__ void fk(" in src)
+    self.assertTrue("const float* x0" in src)
+    self.assertTrue("x0[0*n+i]" in src)
+
+    for X in [SX, MX]:
+      x = X.sym('x', 3)
+      y = X.sym('y', 3)
+      a = sin(x*y) + cos(x*y)
+      b = sin(x*y) + cos(x*y)
+      out = [a*b + a, dot(a, b)]
+      f = Function('f', [x, y], out)
+      fc = Function('fc', [x, y], out, {"cse": True})
+      self.assertTrue(fc.n_instructions()<f.n_instructions())
+      self.assertTrue(fc.stats()["n_cse_removed"]>0)
+      self.checkfunction(fc, f, inputs=[DM([1,2,3]), DM([0.5,-1,2])])
+
+    x = MX.sym('x')
+    g = Function('g', [x], [x**2, sin(x)])
+    r = [g(2*x) for i in range(3)]
+    f = Function('f', [x], [r[0][0]+r[1][0], r[2][1]], {"cse": True})
+    self.assertEqual(sum(f.instruction_id(k)==OP_CALL for k in range(f.n_instructions())), 1)
+    self.checkarray(f(0.3)[0], 2*(0.6)**2)
+
   def test_mapped_eval(self):
       x = SX.sym('x')
       y = SX.sym('y', 2)
@@ -1793,6 +2364,326 @@ class Functiontests(casadiTestCase):
       r_mx = F(DM([[1,2,3]]))
       self.checkarray(r_all, r_mx, "Mapped evaluation (MX)")
 
+  def test_sp_width(self):
+      x = SX.sym("x",300)
+      y = vertcat(x[1:]*x[:-1], sin(x[0])*x[-1], sum1(x[::7]))
+      f = Function("f",[x],[y])
+      for w in [2,3,8]:
+        for mode in [0,1]:
+          fw_ = Function("f",[x],[y],{"sp_width":w,"ad_weight_sp":mode})
+          self.assertTrue(fw_.sparsity_jac(0,0)==f.sparsity_jac(0,0))
+          self.assertTrue(fw_.sparsity_jac(0,0)==jacobian(y,x).sparsity())
+
+  def test_fuse_instructions(self):
+      x = SX.sym("x",3)
+      y = SX.sym("y")
+      e = vertcat(x[0]*x[1]+y, x[1]*y-x[2], y-x[0]*x[2], 3+x[0], x[1]-2, 2-x[2], 4*y, y/3, 5/y, x[0]*x[0]+x[0], sin(x[0]*y)+cos(2*x[1]))
+      f = Function("f",[x,y],[e])
+      ff = Function("f",[x,y],[e],{"fuse_instructions":True})
+      self.checkfunction_light(ff,f,inputs=[DM([1.1,2.3,-0.7]),0.9])
+
+  def test_loop_rolling(self):
+      x = SX.sym("x",3)
+      u = SX.sym("u")
+      f = Function("f",[x,u],[vertcat(x[0]+0.1*sin(x[1])*u, x[1]*cos(x[2])-u, exp(-x[2])+x[0]**2), dot(x,x)])
+      X = SX.sym("X",3,50)
+      U = SX.sym("U",1,50)
+      r = f.map(50)(X,U)
+      outputs = [r[0], r[1]*DM(range(50)).T+1]
+      inputs = [DM(np.random.random((3,50))),DM(np.random.random((1,50)))]
+      for live in [True, False]:
+        F = Function("F",[X,U],outputs,{"live_variables":live})
+        Fr = Function("F",[X,U],outputs,{"live_variables":live,"loop_rolling":True})
+        code = []
+        for g in [F, Fr]:
+          c = CodeGenerator('me')
+          c.add(g)
+          code.append(c.dump())
+        self.assertTrue("for (i=0; i<" in code[1])
+        self.assertTrue(len(code[1])<len(code[0]))
+        self.checkfunction_light(Fr,F,inputs=inputs)
+        self.check_codegen(Fr,inputs=inputs)
+        self.check_codegen(Fr,inputs=inputs,opts={"avoid_stack":True})
+
+  def test_codegen_precision(self):
+      x = SX.sym("x",3)
+      f = Function("f",[x],[vertcat(sin(x[0])*exp(x[1])+0.1*x[2], x[1]**2.5/(1+x[0]**2))])
+      samples = [[DM(np.random.random(3))+0.1] for k in range(10)]
+
+      c = CodeGenerator('me',{"casadi_real":"float"})
+      c.add(f)
+      code = c.dump()
+      self.assertTrue("sinf(" in code)
+      self.assertTrue("1.00000001e-01f" in code)
+      r = c.check_accuracy(f,samples)
+      self.assertTrue(max(r["rel_err"])<1e-6)
+      self.assertTrue(max(r["rel_err"])>0)
+
+      g = Function("g",[x],[vertcat(x[0]*x[1]+0.1*x[2], x[1]/(1+x[0]*x[0]), fmax(x[0],0.3)-fabs(x[2]), if_else(x[0]<x[1],x[2],-x[2]))])
+      c = CodeGenerator('me',{"casadi_real":"int32_t","fixed_point":16})
+      c.add(g)
+      code = c.dump()
+      self.assertTrue("casadi_qmul" in code)
+      r16 = c.check_accuracy(g,samples)
+      self.assertTrue(max(r16["abs_err"])<1e-4)
+      r8 = CodeGenerator('me',{"casadi_real":"int16_t","fixed_point":8}).check_accuracy(g,samples)
+      self.assertTrue(max(r8["abs_err"])>max(r16["abs_err"]))
+
+      c = CodeGenerator('me',{"casadi_real":"int32_t","fixed_point":16})
+      with self.assertInException("not supported with option 'fixed_point'"):
+        c.add(f)
+        c.dump()
+
+  def test_codegen_header_only(self):
+      q = SX.sym("q",6)
+      T = SX.zeros(6,6)
+      for i in range(6):
+        T[i,i] = sin(q[i])
+        T[i,(i+1)%6] = q[i]*cos(q[(i+1)%6])
+      f = Function("kin",[q],[T, mtimes(T,q)])
+      c = CodeGenerator('kin_gen',{"header_only":True})
+      c.add(f)
+      code = c.dump()
+      self.assertTrue("#ifndef KIN_GEN_HPP" in code)
+      self.assertTrue("namespace {" in code)
+      self.assertTrue("static constexpr casadi_int nnz_out0 = 12" in code)
+      self.assertTrue("inline int kin(const casadi_real (&arg0)[6], casadi_real (&res0)[12], casadi_real (&res1)[6])" in code)
+      self.assertFalse("extern \"C\"" in code)
+      with self.assertInException("header_only"):
+        CodeGenerator('kin_gen',{"header_only":True, "main":True})
+
+  def test_map_batch_size(self):
+      x = SX.sym("x",2)
+      y = SX.sym("y")
+      f = Function("f",[x,y],[vertcat(sin(x[0])*y+x[1], fmax(x[1],y)), x[0]**y])
+      X = DM(np.random.random((2,10)))
+      Y = DM(np.random.random((1,10)))
+      for bs in [1,3,10,20]:
+        F = f.map(10,"serial",{"batch_size":bs})
+        self.checkfunction_light(F,f.map(10),inputs=[X,Y])
+        self.check_codegen(F,inputs=[X,Y])
+
+  def test_batch_math(self):
+      x = SX.sym("x")
+      f_ref = Function("f",[x],[vertcat(sin(x),cos(x),exp(x),log(x))],{"batch_math":"libm"})
+      # Reduced range, out-of-range arguments and special values
+      X = DM([list(np.linspace(1e-3,5,200))+[1e6,-1e6,800,-800,1e-310,0,-1,inf,nan]])
+      for bm, digits in [("libm",15),("vector",12),("vector_fast",6)]:
+        f = Function("f",[x],[vertcat(sin(x),cos(x),exp(x),log(x))],{"batch_math":bm})
+        F = f.map(X.numel(),"serial",{"batch_size":64})
+        R = F(X)
+        R_ref = f_ref.map(X.numel())(X)
+        finite = np.isfinite(np.array(R_ref))
+        self.assertTrue(np.array_equal(finite, np.isfinite(np.array(R))))
+        self.checkarray(DM(np.array(R)[finite]),DM(np.array(R_ref)[finite]),digits=digits)
+      with self.assertInException("batch_math"):
+        Function("f",[x],[sin(x)],{"batch_math":"foo"})
+
+  def test_profiling(self):
+      import tempfile, os, shutil, json
+      x = SX.sym("x",2)
+      f = Function("f",[x],[sin(x)])
+      X = MX.sym("X",2)
+      g = Function("g",[X],[f.map(3)(repmat(X,1,3))],{"never_inline":True})
+      d = tempfile.mkdtemp()
+      try:
+        GlobalOptions.resetProfile()
+        GlobalOptions.setProfiling(True)
+        for k in range(4): g([1,2])
+        GlobalOptions.setProfiling(False)
+        g([1,2])
+        GlobalOptions.writeProfile(os.path.join(d,"p.json"))
+        GlobalOptions.writeProfile(os.path.join(d,"p.txt"),"collapsed")
+        with open(os.path.join(d,"p.json")) as pf:
+          events = json.load(pf)["traceEvents"]
+        calls = dict((e["name"],e["args"]["n_call"]) for e in events)
+        self.assertEqual(calls["g"],4)
+        self.assertEqual(calls["f"],12)
+        with open(os.path.join(d,"p.txt")) as pf:
+          stacks = [l.rsplit(" ",1)[0].split(";")[1:] for l in pf]
+        for st in stacks:
+          self.assertEqual(st, ["g","map3_f","f"][:len(st)])
+        GlobalOptions.resetProfile()
+        with self.assertRaises(Exception):
+          GlobalOptions.writeProfile(os.path.join(d,"p.json"),"flat")
+      finally:
+        shutil.rmtree(d)
+
+  def test_profile_instructions(self):
+      x = SX.sym("x",3)
+      f = Function("f",[x],[sin(x)*x+x],{"profile_instructions":True,"profile_sampling":2,"fuse_instructions":True})
+      f_ref = Function("f",[x],[sin(x)*x+x])
+      for k in range(5):
+        self.checkarray(f([1,2,3]),f_ref([1,2,3]))
+      p = f.stats()["instructions"]
+      n_call = dict(zip(p["op"],p["n_call"]))
+      self.assertEqual(n_call["sin"],15)
+      self.assertEqual(n_call["mul"],15)
+      self.assertEqual(n_call["output"],15)
+      self.assertEqual(len(p["t_wall"]),len(p["op"]))
+      self.assertFalse("instructions" in f_ref.stats())
+
+      X = MX.sym("X",4,4)
+      g = Function("g",[X],[mtimes(X,X),f(X[:3,0])],{"profile_instructions":True})
+      for k in range(3): g(DM.eye(4))
+      p = g.stats()["instructions"]
+      self.assertEqual(list(p["n_call"]),[3]*len(p["n_call"]))
+      self.assertTrue("f" in p["name"])
+      self.assertTrue(any(c.startswith("4x4") for c in p["sparsity"]))
+      g.print_instruction_profile()
+      with self.assertRaises(Exception):
+        f_ref.print_instruction_profile()
+
+  def test_sparsity_cache(self):
+      import tempfile, os, shutil
+      d = tempfile.mkdtemp()
+      try:
+        for X in [SX, MX]:
+          x = X.sym("x",20)
+          e = vertcat(x[1:]-x[:-1]**2, sin(x[0])*x[-1])
+          ref = Function("f",[x],[e]).jacobian()
+          J = []
+          for k in range(2):
+            f = Function("f",[x],[e],{"sparsity_cache":d})
+            J.append(f.jacobian())
+          self.assertTrue(len(os.listdir(d))>0)
+          for Jk in J:
+            self.assertTrue(Jk.sparsity_out(0)==ref.sparsity_out(0))
+            self.checkfunction_light(Jk,ref,inputs=[DM(np.random.random(20)),DM(20,1)])
+      finally:
+        shutil.rmtree(d)
+
+  def test_share_derivatives(self):
+      for X in [SX, MX]:
+        F = []
+        for k in range(3):
+          x = X.sym("x",20)
+          e = vertcat(x[1:]-x[:-1]**2, sin(x[0])*x[-1])
+          F.append(Function("f",[x],[e],{"share_derivatives":k<2}))
+        J = [f.jacobian() for f in F]
+        fwd = [f.forward(2) for f in F]
+        self.assertEqual(hash(J[0]),hash(J[1]))
+        self.assertEqual(hash(fwd[0]),hash(fwd[1]))
+        self.assertNotEqual(hash(J[0]),hash(J[2]))
+        self.assertNotEqual(hash(fwd[0]),hash(fwd[2]))
+        for k in range(1,3):
+          self.checkfunction_light(J[k],J[0],inputs=[DM(np.random.random(20)),DM(20,1)])
+
+  def test_ad_weight_timing(self):
+      for X in [SX, MX]:
+        x = X.sym("x",20)
+        e = vertcat(x[1:]-x[:-1]**2, sin(x[0])*x[-1], sumsqr(x))
+        ref = Function("f",[x],[e]).jacobian()
+        f = Function("f",[x],[e],{"ad_weight_timing":True})
+        J = f.jacobian()
+        self.assertTrue(J.sparsity_out(0)==ref.sparsity_out(0))
+        self.checkfunction_light(J,ref,inputs=[DM(np.random.random(20)),DM(21,1)])
+
+  def test_ad_num_threads(self):
+      x = SX.sym("x",200)
+      e = vertcat(x[1:]*x[:-1]**2, sin(x[0])*x[-1])
+      f = sumsqr(e) + dot(x, cos(x))
+      ref = Function("f",[x],[e, f]).factory("h",["i0"],["jac:o0:i0","hess:o1:i0:i0"])
+      h = Function("f",[x],[e, f],{"ad_num_threads":4}).factory("h",["i0"],["jac:o0:i0","hess:o1:i0:i0"])
+      for i in range(2):
+        self.assertTrue(h.sparsity_out(i)==ref.sparsity_out(i))
+      self.checkfunction_light(h,ref,inputs=[DM(np.random.random(200))])
+      J = jacobian(e, x, {"ad_num_threads":4})
+      self.checkarray(Function("J",[x],[J])(0.3), Function("J",[x],[jacobian(e, x)])(0.3))
+
+  def test_memory_usage(self):
+      x = SX.sym("x",10)
+      f = Function("f",[x],[sin(x)*x])
+      m = f.memory_usage()
+      self.assertTrue(m["self"]["algorithm"]>0)
+      self.assertTrue(m["total"]>=sum(v for k,v in m["self"].items() if k!="n_memory"))
+      X = MX.sym("X",10)
+      g = Function("g",[X],[f(X)+f(2*X)])
+      gm = g.memory_usage()
+      # The nested function is counted once
+      self.assertEqual(len(gm["children"]),1)
+      self.assertTrue(gm["total"]>gm["self"]["algorithm"])
+      self.assertTrue(gm["children"]["f"]["total"]<=m["total"])
+      g.print_memory_usage()
+
+  def test_checkout(self):
+      x = SX.sym("x")
+      f = Function("f",[x],[sin(x)])
+      mem = [f.checkout() for k in range(70)]
+      self.assertEqual(sorted(mem),list(range(70)))
+      for m in mem[10:]: f.release(m)
+      # Released memory objects are reused, most recently released first
+      self.assertEqual(f.checkout(),mem[-1])
+      self.assertEqual(f.memory_usage()["self"]["n_memory"],70)
+      self.checkarray(f(0.5),sin(0.5))
+
+  def test_is_thread_safe(self):
+      x = MX.sym("x")
+      f = Function("f",[x],[sin(x)])
+      # Thread-safe with thread support, propagated through calls and maps
+      g = Function("g",[x],[f(x)+f.map(3)(repmat(x,1,3))[0]])
+      self.assertEqual(g.is_thread_safe(),f.is_thread_safe())
+
+  @requires_conic("qpoases")
+  def test_is_thread_safe_serialized(self):
+      # qpOASES is not reentrant, calls are serialized
+      solver = conic("solver","qpoases",{"h":Sparsity.dense(1,1)},{"printLevel":"none"})
+      self.assertFalse(solver.is_thread_safe())
+      g = MX.sym("g")
+      f = Function("f",[g],[solver(h=1,g=g,lbx=-1,ubx=1)["x"]])
+      self.assertFalse(f.is_thread_safe())
+      self.checkarray(f(0.5),-0.5)
+
+  def test_call_numpy(self):
+      import numpy as np
+      x = MX.sym("x",2,2)
+      p = MX.sym("p",Sparsity.lower(3))
+      y = MX.sym("y",3)
+      f = Function("f",[x,p,y],[mtimes(x,x),p*2,dot(y,y)+x[0,1]])
+      X = np.array([[1.,2.],[3.,4.]])
+      P = DM(Sparsity.lower(3),[1,2,3,4,5,6]).tocsc()
+      Y = np.array([1.,2.,3.])
+      ref = f(X,P,Y)
+      for args in [(X,P,Y),(np.asfortranarray(X),P.toarray(),list(Y)),(X,P,Y.reshape((1,3)))]:
+        ret = f.call_numpy(*args)
+        self.assertTrue(isinstance(ret[0],np.ndarray))
+        self.checkarray(ret[0],ref[0])
+        self.checkarray(DM(ret[1]),ref[1])
+        self.checkarray(ret[2],ref[2])
+      # None is zero, scalars are repeated
+      self.checkarray(f.call_numpy(None,2,Y)[2],f(0,2,Y)[2])
+      # Preallocated outputs
+      out = [np.zeros((2,2),order='F'),DM(Sparsity.lower(3),0).tocsc(),np.zeros(1)]
+      f.call_numpy(X,P,Y,out=out)
+      self.checkarray(out[0],ref[0])
+      self.checkarray(DM(out[1]),ref[1])
+      self.checkarray(out[2],ref[2])
+      with self.assertRaises(ValueError):
+        f.call_numpy(X,P,Y,out=[np.zeros((2,2)),None,None])
+      with self.assertRaises(ValueError):
+        f.call_numpy(np.zeros(3),P,Y)
+      # Conversion of numpy arrays to DM
+      self.checkarray(DM(X),X)
+      self.checkarray(DM(np.asfortranarray(X)),X)
+      self.checkarray(DM(X[:,1]),X[:,1])
+      self.checkarray(DM(P),P.toarray())
+      self.checkarray(DM(ref[1]).toarray(),ref[1].full())
+
+  def test_thread_map_pinning(self):
+      x = SX.sym("x",2)
+      f = Function("f",[x],[sin(x)*x])
+      X = DM.rand(2,50)
+      ref = f.map(50)(X)
+      F = f.map(50,"thread",{"max_num_threads":3})
+      pinning = GlobalOptions.getThreadPinning()
+      try:
+        for pin in [False,True,False]:
+          GlobalOptions.setThreadPinning(pin)
+          # Repeated calls reuse the per-thread memory objects
+          for k in range(3):
+            self.checkarray(F(X),ref)
+      finally:
+        GlobalOptions.setThreadPinning(pinning)
 
 if __name__ == '__main__':
     unittest.main()
@@ -35,6 +35,8 @@ from casadi.tools import capture_stdout
 
 import argparse
 import struct
+import os
+import json
 
 if sys.version_info >= (3, 0):
   import builtins
@@ -50,6 +52,8 @@ parser.add_argument('--known_bugs', help='Run with known bugs', action='store_tr
 parser.add_argument('--ignore_memory_heavy', help='Skip those tests that have a high memory footprint', action='store_true')
 parser.add_argument('--ignore_memory_light', help='Skip those tests that have a lightweight memory footprint', action='store_true')
 parser.add_argument('--run_slow', help='Skip those tests that take a long time to run', action='store_true')
+parser.add_argument('--perf_record', help='Append timings of key operations to this history file (JSON lines)', default=os.environ.get("CASADI_PERF_RECORD"))
+parser.add_argument('--perf_threshold', help='Flag timings that exceed the recent history by more than this fraction', type=float, default=float(os.environ.get("CASADI_PERF_THRESHOLD", 0.2)))
 parser.add_argument('unittest_args', nargs='*')
 
 args = parser.parse_args()
@@ -59,6 +63,56 @@ sys.argv[1:] = ['-v'] + args.unittest_args
 
 from io import StringIO
 
+class PerfHistory(object):
+  """
+  Timings of key operations, appended to a history file with one JSON record per line
+
+  A record holds the operation key, the best time [s] over the repeats, the run
+  (CASADI_PERF_RUN, shared by all test files of a suite run) and a tag
+  (CASADI_PERF_TAG, defaults to the git description of the CasADi build).
+
+  A timing is flagged as a regression when it exceeds the median of the last
+  `window` runs by more than `threshold` (relative) and by more than `mint` [s].
+  Regressions are reported on stderr, cf. the -perf_fail option of the test suite.
+  """
+  window = 5
+  mint = 1e-3
+  def __init__(self, filename, threshold):
+    self.filename = filename
+    self.threshold = threshold
+    self.run = os.environ.get("CASADI_PERF_RUN", time.strftime("%Y%m%dT%H%M%S") + "-%d" % os.getpid())
+    self.tag = os.environ.get("CASADI_PERF_TAG", CasadiMeta.git_describe())
+    self.history = None
+
+  def load(self):
+    # Timings of earlier runs, per key, in chronological order
+    self.history = {}
+    if not os.path.exists(self.filename): return
+    with open(self.filename) as f:
+      for line in f:
+        try:
+          r = json.loads(line)
+        except ValueError:
+          continue
+        if r.get("run")==self.run: continue
+        self.history.setdefault(r["key"], []).append(r["time"])
+
+  def record(self, key, t, **extra):
+    if self.history is None: self.load()
+    past = sorted(self.history.get(key, [])[-self.window:])
+    ref = past[len(past)//2] if past else None
+    regression = ref is not None and t>ref*(1+self.threshold) and t-ref>self.mint
+    r = {"key": key, "time": t, "run": self.run, "tag": self.tag,
+         "date": time.strftime("%Y-%m-%dT%H:%M:%S"), "regression": regression}
+    if ref is not None: r["reference"] = ref
+    r.update(extra)
+    with open(self.filename, "a") as f:
+      f.write(json.dumps(r, sort_keys=True) + "\n")
+    if regression:
+      sys.stderr.write("perf regression %s: %.3e s, recent median %.3e s (+%.0f%%)\n" % (key, t, ref, 100*(t/ref-1)))
+
+perf_history = None if args.perf_record is None else PerfHistory(args.perf_record, args.perf_threshold)
+
 
 class LazyString(object):
   def __init__(self,f):
@@ -143,6 +197,23 @@ class casadiTestCase(unittest.TestCase):
     self.assertFalse(e is None)
     self.assertTrue(s in e,msg=e + "<->" + s)
 
+  def perf(self, key, fun, repeat=3, extra=None):
+    """
+    Evaluate fun() and return its result
+
+    In performance-recording mode (--perf_record or CASADI_PERF_RECORD), fun is
+    evaluated `repeat` times and the best time is recorded under `key`.
+    extra maps the result to additional fields of the record, e.g. iteration counts.
+    """
+    if perf_history is None: return fun()
+    ts = []
+    for i in range(repeat):
+      t0 = time.time()
+      ret = fun()
+      ts.append(time.time()-t0)
+    perf_history.record(key, min(ts), **({} if extra is None else extra(ret)))
+    return ret
+
   def tearDown(self):
     t = time.time() - self.startTime
     print("deltaT %s: %.3f" % ( self.id(), t))
@@ -45,6 +45,8 @@ except:
   pass
 
 solvers.append(("fast_newton",{},("codegen")))
+solvers.append(("newton_krylov",{},("codegen")))
+solvers.append(("btf",{},[]))
 
 print(solvers)
 
@@ -151,6 +153,7 @@ class ImplicitFunctiontests(casadiTestCase):
     for Solver, options, features in solvers:
       if 'kinsol' in str(Solver): continue
       if 'newton' in str(Solver): continue
+      if 'btf' in str(Solver): continue
 
       message = Solver
       N = 5
@@ -215,6 +218,7 @@ class ImplicitFunctiontests(casadiTestCase):
     for Solver, options, features in solvers:
       if 'kinsol' in str(Solver): continue
       if 'newton' in str(Solver): continue
+      if 'btf' in str(Solver): continue
 
       print(Solver, options)
       x=SX.sym("x",2)
@@ -304,5 +308,76 @@ class ImplicitFunctiontests(casadiTestCase):
       with self.assertInException("process"):
         solver(x0=0)
 
+  def test_broyden(self):
+    n = 20
+    h = 1./(n+1)
+    u = SX.sym("u",n)
+    p = SX.sym("p")
+    U = vertcat(0,u,0)
+    f = Function("f",[u,p],[(U[:-2]-2*u+U[2:])/h**2+p*exp(u)])
+    ref = rootfinder("ref","newton",f)
+    chord = rootfinder("chord","newton",f,{"jacobian_reuse":True})
+    broyden = rootfinder("broyden","newton",f,{"broyden":True})
+    for pv in [2,2.1]:
+      r = ref(0,pv)
+      self.assertEqual(ref.stats()["n_jac_saved"],0)
+      self.checkarray(chord(0,pv),r,digits=10)
+      self.checkarray(broyden(0,pv),r,digits=10)
+      stats = broyden.stats()
+      self.assertTrue(stats["n_broyden"]>0)
+      self.assertTrue(stats["n_jac"]<ref.stats()["n_jac"])
+      self.assertTrue(stats["iter_count"]<chord.stats()["iter_count"])
+
+  def test_btf(self):
+    z = MX.sym("z",5)
+    p = MX.sym("p")
+    r = vertcat(z[3]+z[4]**3-z[1], z[0]**2-p, z[1]-2*z[0]-1, z[3]*z[4]-0.5, z[2]-sin(z[1]))
+    f = Function("f",[z,p],[r,sumsqr(z)])
+    ref = rootfinder("ref","newton",f)
+    solver = rootfinder("solver","btf",f)
+    self.checkfunction(solver,ref,inputs=[1,2],digits=8)
+    stats = solver.stats()
+    self.assertTrue(stats["success"])
+    # Three 1-by-1 blocks, two of them linear, and a 2-by-2 block
+    self.assertEqual(stats["n_block"],4)
+    self.assertEqual(stats["n_call_jac_f_z"],0)
+
+  def test_newton_krylov(self):
+    n = 30
+    h = 1./(n+1)
+    u = SX.sym("u",n)
+    p = SX.sym("p")
+    U = vertcat(0,u,0)
+    f = Function("f",[u,p],[(U[:-2]-2*u+U[2:])/h**2+p*exp(u)])
+    v = SX.sym("v",n)
+    prec = Function("prec",[u,p,v],[v/(-2/h**2+p*exp(u))])
+    ref = rootfinder("ref","newton",f)
+    for opts in [{}, {"preconditioner":prec,"krylov_dim":10}]:
+      solver = rootfinder("solver","newton_krylov",f,opts)
+      self.checkarray(solver(0,2),ref(0,2),digits=9)
+      stats = solver.stats()
+      self.assertTrue(stats["success"])
+      self.assertEqual(stats["n_call_jac_f_z"],0)
+      self.assertTrue(stats["n_jtimes"]>0)
+      self.check_codegen(solver,inputs=[0,2])
+
+  @requires_rootfinder("kinsol")
+  def test_kinsol_reuse_jacobian(self):
+    x = SX.sym("x",4)
+    p = SX.sym("p")
+    f = Function("f",[x,p],[vertcat(x[0]**2+x[1]-p,x[1]+sin(x[2])-1,x[2]*x[3]+x[0]-2,x[3]+x[0]*x[1]-3)])
+    ref = rootfinder("ref","newton",f)
+    for opts in [{}, {"linear_solver_type":"banded","upper_bandwidth":3,"lower_bandwidth":3}]:
+      opts = dict(opts, abstol=1e-10, strategy="linesearch")
+      solver = rootfinder("solver","kinsol",f,dict(opts, reuse_jacobian=True))
+      solver_ref = rootfinder("solver","kinsol",f,opts)
+      n_jac = n_jac_ref = 0
+      for p0 in [2, 2.001, 2.002, 2.003]:
+        self.checkarray(solver(1,p0),ref(1,p0),digits=8)
+        n_jac += solver.stats()["n_jac"]
+        solver_ref(1,p0)
+        n_jac_ref += solver_ref.stats()["n_jac"]
+      self.assertTrue(n_jac<n_jac_ref)
+
 if __name__ == '__main__':
     unittest.main()
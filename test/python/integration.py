@@ -56,6 +56,8 @@ integrators.append(("collocation",["dae","ode"],{"rootfinder":"kinsol","number_o
 
 integrators.append(("rk",["ode"],{"number_of_finite_elements": 1000}))
 
+integrators.append(("dopri",["ode"],{"abstol": 1e-12,"reltol": 1e-12}))
+
 print("Will test these integrators:")
 for cl, t, options in integrators:
   print(cl, " : ", t)
@@ -1036,5 +1038,342 @@ class Integrationtests(casadiTestCase):
       self.checkarray(norm_inf(res["xf"].T-exp(-1)*numpy.linspace(0, 10, 40)),0, digits=5)
       self.checkarray(norm_inf(res["rxf"].T-exp(1)*numpy.linspace(0, 10, 40)),0, digits=5)
 
+  def test_dopri(self):
+    x = SX.sym("x",2)
+    p = SX.sym("p")
+    t = SX.sym("t")
+    dae = {"x":x,"p":p,"t":t,"ode":vertcat(p*x[1],-p*x[0]+0.1*sin(t)),"quad":x[0]**2}
+    grid = [0, 0.5, 3, 10]
+    F = integrator("F","dopri",dae,{"grid":grid,"output_t0":True,"abstol":1e-10,"reltol":1e-10})
+    R = integrator("R","rk",dae,{"grid":grid,"output_t0":True,"number_of_finite_elements":20000})
+    r = F(x0=[1,0.5],p=1.3)
+    ref = R(x0=[1,0.5],p=1.3)
+    self.checkarray(r["xf"],ref["xf"],digits=7)
+    self.checkarray(r["qf"],ref["qf"],digits=7)
+
+    # Far fewer steps than a fixed step method
+    self.assertTrue(F.stats()["nsteps"]<1000)
+
+    # Forward and adjoint sensitivities
+    x0 = MX.sym("x0",2)
+    P = MX.sym("p")
+    for ad_weight in [0, 1]:
+      J = Function("J",[x0,P],[jacobian(F(x0=x0,p=P)["xf"],vertcat(x0,P))],{"ad_weight":ad_weight})
+      Jref = Function("J",[x0,P],[jacobian(R(x0=x0,p=P)["xf"],vertcat(x0,P))])
+      self.checkarray(J([1,0.5],1.3),Jref([1,0.5],1.3),digits=6)
+
+    # Forward problems can be code generated
+    G = Function("G",[x0,P],[F(x0=x0,p=P)["xf"]])
+    self.check_codegen(G,inputs=[[1,0.5],1.3])
+    J = Function("J",[x0,P],[jacobian(F(x0=x0,p=P)["xf"],vertcat(x0,P))],{"ad_weight":0})
+    self.check_codegen(J,inputs=[[1,0.5],1.3])
+
+  def test_integrator_batch(self):
+    x = SX.sym("x",2)
+    p = SX.sym("p")
+    dae = {"x":x,"p":p,"ode":vertcat(x[1],-p*x[0]),"quad":x[0]**2}
+    N = 5
+    x0 = DM.rand(2,N)
+    P = 1+DM.rand(1,N)
+    for Solver, options in [("rk",{}),("cvodes",{"abstol":1e-12,"reltol":1e-12})]:
+      options = dict(options,grid=[0,1,2],output_t0=True)
+      F = integrator("F",Solver,dae,options)
+      Fb = integrator_batch("Fb",Solver,dae,N,options)
+      r = F.map(N)(x0=x0,p=P)
+      rb = Fb(x0=x0,p=P)
+      for k in ["xf","qf"]:
+        self.checkarray(rb[k],r[k],digits=8)
+
+  def test_sens_parallelization(self):
+    x = SX.sym("x",2)
+    p = SX.sym("p",3)
+    dae = {"x":x,"p":p,"ode":vertcat(x[1],-p[0]*x[0]-p[1]*sin(x[1])+p[2]),"quad":x[0]**2}
+    x0 = MX.sym("x0",2)
+    P = MX.sym("p",3)
+    for Solver in ["cvodes","rk"]:
+      J = []
+      for par in [None,"serial","thread"]:
+        opts = {"tf":2}
+        if par is not None: opts["sens_parallelization"] = par
+        F = integrator("F",Solver,dae,opts)
+        r = F(x0=x0,p=P)
+        J.append(Function("J",[x0,P],[jacobian(vertcat(r["xf"],r["qf"]),vertcat(x0,P))],
+                          {"ad_weight":0}))
+      for j in J[1:]:
+        self.checkarray(j([1,0.5],[1.3,0.2,0.1]),J[0]([1,0.5],[1.3,0.2,0.1]),digits=8)
+
+  def test_dense_output(self):
+    x = SX.sym("x",2)
+    p = SX.sym("p")
+    dae = {"x":x,"p":p,"ode":vertcat(x[1],-p*x[0]),"quad":x[0]**2}
+    grid = [0.1*i for i in range(38)]
+    R = integrator("R","cvodes",dae,{"grid":grid,"abstol":1e-12,"reltol":1e-12})
+    ref = R(x0=[1,0.5],p=1.3)
+    P = MX.sym("p")
+    for Solver, options in [("rk",{"number_of_finite_elements":100}),
+                            ("collocation",{"number_of_finite_elements":20})]:
+      # Output grid much finer than the steps
+      F = integrator("F",Solver,dae,dict(options,grid=grid))
+      r = F(x0=[1,0.5],p=1.3)
+      self.checkarray(r["xf"],ref["xf"],digits=5)
+      self.checkarray(r["qf"],ref["qf"],digits=5)
+
+      # Forward sensitivities at all output times
+      J = Function("J",[P],[jacobian(F(x0=[1,0.5],p=P)["xf"],P)],{"ad_weight":0})
+      Jref = Function("J",[P],[jacobian(R(x0=[1,0.5],p=P)["xf"],P)],{"ad_weight":0})
+      self.checkarray(J(1.3),Jref(1.3),digits=4)
+
+  def test_checkpoint_memory(self):
+    x = SX.sym("x",2)
+    p = SX.sym("p")
+    rx = SX.sym("rx",2)
+    ode = vertcat(x[1],-p*x[0]-0.1*x[1])
+    dae = {"x":x,"p":p,"rx":rx,"ode":ode,"rode":mtimes(jacobian(ode,x).T,rx),
+           "rquad":mtimes(jacobian(ode,p).T,rx)}
+    for Solver in ["cvodes","idas"]:
+      F = integrator("F",Solver,dae,{"tf":50})
+      ref = F(x0=[1,0],p=1.3,rx0=[1,0])
+      self.assertEqual(F.stats()["steps_per_checkpoint"],20)
+      for budget in [3000, 100000]:
+        F = integrator("F",Solver,dae,{"tf":50,"checkpoint_memory":budget})
+        for k in range(2):
+          r = F(x0=[1,0],p=1.3,rx0=[1,0])
+        stats = F.stats()
+        self.checkarray(r["rqf"],ref["rqf"],digits=4)
+        self.assertTrue(stats["steps_per_checkpoint"]>20)
+        self.assertTrue(stats["ncheckpoints"]>=1)
+        self.assertTrue(stats["nfevals_recompute"]>0)
+
+  def test_trajectory_cache(self):
+    x = SX.sym("x",2)
+    p = SX.sym("p")
+    dae = {"x":x,"p":p,"ode":vertcat(x[1],-p*sin(x[0])),"quad":x[0]**2}
+    X = MX.sym("x",2)
+    P = MX.sym("p")
+    for Solver in ["rk","collocation"]:
+      opts = {"tf":1,"number_of_finite_elements":20}
+      G = []
+      for cache in [0,4]:
+        F = integrator("F",Solver,dae,dict(opts,trajectory_cache=cache))
+        r = F(x0=X,p=P)
+        g = dot(r["xf"],r["xf"])+r["qf"]
+        G.append(Function("G",[X,P],[g,gradient(g,vertcat(X,P))]))
+      for x0 in [[0.3,0.1],[0.4,0.2]]:
+        self.checkarray(G[1](x0,2)[1],G[0](x0,2)[1])
+
+      # The reverse derivative reuses the forward pass with the same inputs
+      F = integrator("F",Solver,dae,dict(opts,trajectory_cache=1))
+      R = F.reverse(1)
+      F(x0=[0.3,0.1],p=2)
+      R(x0=[0.3,0.1],p=2,adj_xf=[1,0])
+      R_ref = integrator("F",Solver,dae,opts).reverse(1)
+      self.checkarray(R(x0=[0.3,0.1],p=2,adj_xf=[1,0])["adj_x0"],
+                      R_ref(x0=[0.3,0.1],p=2,adj_xf=[1,0])["adj_x0"])
+
+  def test_warm_start(self):
+    x = SX.sym("x",3)
+    p = SX.sym("p")
+    dae = {"x":x,"p":p,"ode":vertcat(x[1],-p*sin(x[0])-0.1*x[1],x[0]-x[2])}
+    nfevals = []
+    for warm_start in [False,True]:
+      F = integrator("F","cvodes",dae,{"tf":0.05,"warm_start":warm_start})
+      n = 0
+      for k in range(10):
+        r = F(x0=[0.3+0.01*k,0.1,0],p=2)
+        n += F.stats()["nfevals"]
+      nfevals.append(n)
+      if warm_start:
+        self.checkarray(r["xf"],ref,digits=6)
+      else:
+        ref = r["xf"]
+    self.assertTrue(nfevals[1]<nfevals[0])
+
+  def test_preconditioner(self):
+    N = 20
+    a = 0.1*N**2
+    x = SX.sym("x",N)
+    p = SX.sym("p")
+    xe = vertcat(0,x,0)
+    dae = {"x":x,"p":p,"ode":a*(xe[:-2]-2*x+xe[2:])+p*sin(x)}
+    t = SX.sym("t")
+    z = SX.sym("z",0)
+    c = SX.sym("c")
+    v = SX.sym("v",N)
+    d = SX.sym("d")
+    for Solver in ["cvodes","idas"]:
+      # Jacobi preconditioner
+      diag = 1+2*a*c if Solver=="cvodes" else -2*a-c
+      P = Function("P",[t,x,z,p,c,v],[v/diag])
+      P_setup = Function("P_setup",[t,x,z,p,c],[diag])
+      P_apply = Function("P_apply",[d,v],[v/d])
+      ref = integrator("F",Solver,dae,{"tf":1})(x0=1,p=0.5)["xf"]
+      for opts in [{"preconditioner":P},{"preconditioner":P_apply,"preconditioner_setup":P_setup}]:
+        F = integrator("F",Solver,dae,dict(opts,tf=1,newton_scheme="gmres"))
+        self.checkarray(F(x0=1,p=0.5)["xf"],ref,digits=5)
+      with self.assertRaises(Exception):
+        integrator("F",Solver,dae,{"preconditioner":P})
+
+  def test_parareal(self):
+    x = SX.sym("x",2)
+    p = SX.sym("p")
+    t = SX.sym("t")
+    dae = {"x":x,"p":p,"t":t,"ode":vertcat(x[1],-p*x[0]+0.1*sin(t)),"quad":x[0]**2}
+    grid = [0,1.3,4,10]
+    tol = {"abstol":1e-12,"reltol":1e-12}
+    R = integrator("R","cvodes",dae,dict(tol,grid=grid))
+    ref = R(x0=[1,0],p=2)
+    P = MX.sym("p")
+    Jref = Function("J",[P],[jacobian(R(x0=[1,0],p=P)["xf"],P)],{"ad_weight":0})
+    for par in ["serial","thread"]:
+      F = integrator("F","parareal",dae,{"grid":grid,"fine_options":tol,"number_of_slices":16,
+                                         "tol":1e-10,"parallelization":par})
+      r = F(x0=[1,0],p=2)
+      self.checkarray(r["xf"],ref["xf"],digits=7)
+      self.checkarray(r["qf"],ref["qf"],digits=7)
+      self.assertTrue(F.stats()["niter"]<F.stats()["nslices"])
+
+      # Forward sensitivities
+      J = Function("J",[P],[jacobian(F(x0=[1,0],p=P)["xf"],P)],{"ad_weight":0})
+      self.checkarray(J(2),Jref(2),digits=6)
+
+    # Iteration limit
+    F = integrator("F","parareal",dae,{"grid":grid,"fine_options":tol,"max_iter":1})
+    F(x0=[1,0],p=2)
+    self.assertEqual(F.stats()["niter"],1)
+
+  def test_etd(self):
+    x = SX.sym("x",2)
+    p = SX.sym("p")
+    t = SX.sym("t")
+    # Stiff linear part, mildly nonlinear remainder
+    dae = {"x":x,"p":p,"t":t,"ode":vertcat(-1000*x[0]+999*x[1]+sin(t),-x[1]+p*x[0]*x[1]),
+           "quad":x[0]**2}
+    R = integrator("R","cvodes",dae,{"tf":2,"abstol":1e-12,"reltol":1e-12})
+    ref = R(x0=[0.5,0.5],p=0.3)
+    err = {}
+    for order in [1,2]:
+      for nk in [20,40]:
+        F = integrator("F","etd",dae,{"tf":2,"order":order,"number_of_finite_elements":nk})
+        r = F(x0=[0.5,0.5],p=0.3)
+        err[order,nk] = float(norm_inf(r["xf"]-ref["xf"]))
+      # Convergence order despite h*1000 >> 1
+      self.assertTrue(err[order,20]/err[order,40]>2**order*0.9)
+    self.assertTrue(err[2,40]<1e-4)
+
+    # Forward and reverse sensitivities of the discrete scheme agree
+    F = integrator("F","etd",dae,{"tf":2,"number_of_finite_elements":40})
+    X0 = MX.sym("x0",2)
+    P = MX.sym("p")
+    xf = F(x0=X0,p=P)["xf"]
+    Jf = Function("J",[X0,P],[jacobian(xf,vertcat(X0,P))],{"ad_weight":0})
+    Jr = Function("J",[X0,P],[jacobian(xf,vertcat(X0,P))],{"ad_weight":1})
+    self.checkarray(Jf([0.5,0.5],0.3),Jr([0.5,0.5],0.3),digits=10)
+
+  def test_jacobian_reuse(self):
+    x = SX.sym("x",2)
+    p = SX.sym("p")
+    dae = {"x":x,"p":p,"ode":vertcat(x[1],p*(1-x[0]**2)*x[1]-x[0]),"quad":x[0]}
+    stats = {}
+    for reuse in [False,True]:
+      F = integrator("F","collocation",dae,{"tf":2,"number_of_finite_elements":200,
+                     "rootfinder_options":{"jacobian_reuse":reuse}})
+      r = F(x0=[2,0],p=100)
+      stats[reuse] = F.stats()
+      if reuse:
+        self.checkarray(r["xf"],ref["xf"],digits=8)
+        self.checkarray(r["qf"],ref["qf"],digits=8)
+      ref = r
+    # One factorization per Newton iteration without reuse
+    self.assertEqual(stats[False]["rootfinder_nfact"],
+                     stats[False]["rootfinder_iter"]-200)
+    self.assertTrue(stats[True]["rootfinder_nfact"]<10)
+
+  def test_events(self):
+    # Bouncing ball with a coefficient of restitution of 0.8
+    x = SX.sym("x",2)
+    t = SX.sym("t")
+    g = 9.81
+    dae = {"x":x,"ode":vertcat(x[1],-g),"quad":x[0]}
+    ev = Function("ev",[t,x,SX(0,1),SX(0,1)],[x[0]])
+    tr = Function("tr",[t,x,SX(0,1),SX(0,1),SX.sym("i")],[vertcat(x[0],-0.8*x[1])])
+    t1 = sqrt(2/g)
+    v1 = 0.8*g*t1
+    t2 = t1+2*v1/g
+    tau = 1.5-t2
+    h = 0.8*v1*tau-0.5*g*tau**2
+    for plugin, opts in [("rk",{"number_of_finite_elements":20}),
+                         ("collocation",{"number_of_finite_elements":20}),
+                         ("cvodes",{"abstol":1e-10,"reltol":1e-10}),
+                         ("idas",{"abstol":1e-10,"reltol":1e-10})]:
+      opts = dict(opts, tf=1.5, event=ev, event_transition=tr, event_direction=[-1])
+      F = integrator("F",plugin,dae,opts)
+      r = F(x0=[1,0])
+      self.checkarray(r["xf"],DM([h,0.8*v1-g*tau]),digits=7)
+      self.assertEqual(F.stats()["nevents"],2)
+    with self.assertInException("not supported"):
+      integrator("F","dopri",dae,{"tf":1.5,"event":ev})
+
+  def test_collocation_transformed(self):
+    x = SX.sym("x",2)
+    z = SX.sym("z")
+    p = SX.sym("p")
+    dae = {"x":x,"z":z,"p":p,"ode":vertcat(x[1],p*(1-x[0]**2)*x[1]-x[0]+0.1*z),
+           "alg":z-sin(x[0])-0.05*z**2,"quad":x[0]**2+z}
+    X0 = MX.sym("x0",2)
+    P = MX.sym("p")
+    for scheme in ["radau","legendre"]:
+      for deg in [1,2,3,4,5]:
+        opts = {"tf":2,"number_of_finite_elements":40,"collocation_scheme":scheme,
+                "interpolation_order":deg}
+        r = {}
+        for newton_scheme in ["rootfinder","transformed"]:
+          opts["newton_scheme"] = newton_scheme
+          # Backward factorizations in parallel
+          opts["max_num_threads"] = 4 if newton_scheme=="transformed" else 1
+          F = integrator("F","collocation",dae,opts)
+          res = F(x0=X0,p=P,z0=0.8)
+          J = Function("J",[X0,P],[jacobian(res["xf"],vertcat(X0,P)),
+                                   gradient(res["qf"],vertcat(X0,P))])
+          r[newton_scheme] = [F(x0=[1,0.5],p=5,z0=0.8)["xf"]] + J([1,0.5],5)
+        for a,b in zip(r["rootfinder"],r["transformed"]):
+          self.checkarray(a,b,digits=9)
+
+  def test_fusedRK(self):
+    x = SX.sym("x",2)
+    p = SX.sym("p")
+    f = Function("f",[x,p],[vertcat(x[1],p*(1-x[0]**2)*x[1]-x[0])])
+    ref = simpleRK(f,2000)([1,0],0.5,1)
+    # Identical to the MX based generator
+    self.checkarray(fusedRK(f,10)([1,0],0.5,1),simpleRK(f,10)([1,0],0.5,1),digits=14)
+    for method, tol in [("euler",1e-1),("midpoint",1e-2),("heun",1e-2),("rk4",1e-5),
+                        ("rk23",1e-4),("rk45",1e-8)]:
+      F = fusedRK(f,10,method)
+      self.assertTrue(F.is_a("SXFunction"))
+      r = F([1,0],0.5,1)
+      if F.n_out()==2:
+        xf, err = r
+        self.assertTrue(float(norm_inf(err))>0)
+      else:
+        xf = r
+      self.assertTrue(float(norm_inf(xf-ref))<tol)
+    # Steps chained with mapaccum
+    F = fusedRK(f,1,"rk45").mapaccum(10)
+    xf, err = F([1,0],0.5,DM.ones(1,10)*0.1)
+    self.checkarray(xf[:,-1],fusedRK(f,10,"rk45")([1,0],0.5,1)[0],digits=12)
+    # Butcher tableau
+    F = butcherRK(f,[[0,0],[1,0]],[0.5,0.5],[-0.5,0.5],10)
+    self.checkarray(F([1,0],0.5,1)[0],fusedRK(f,10,"heun")([1,0],0.5,1)[0],digits=14)
+    with self.assertInException("explicit"):
+      butcherRK(f,[[0.5,0],[1,0]],[0.5,0.5])
+
+  def test_fusedIRK(self):
+    x = SX.sym("x",2)
+    p = SX.sym("p")
+    f = Function("f",[x,p],[vertcat(x[1],p*(1-x[0]**2)*x[1]-x[0])])
+    for scheme in ["radau","legendre"]:
+      F = fusedIRK(f,10,3,scheme)
+      self.assertTrue(F.is_a("SXFunction"))
+      self.checkarray(F([1,0],0.5,1),simpleIRK(f,10,3,scheme)([1,0],0.5,1),digits=10)
+
 if __name__ == '__main__':
     unittest.main()
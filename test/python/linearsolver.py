@@ -66,6 +66,8 @@ except:
 try:
   load_linsol("lsqr")
   lsolvers.append(("lsqr",{},set()))
+  lsolvers.append(("lsqr",{"preconditioner":"jacobi"},set()))
+  lsolvers.append(("lsqr",{"preconditioner":"ichol","max_num_threads":2},set()))
 except:
   pass
 
@@ -78,12 +80,27 @@ except:
 try:
   load_linsol("qr")
   lsolvers.append(("qr",{},set()))
+  lsolvers.append(("qr",{"max_num_threads":4},set()))
+  lsolvers.append(("qr",{"ordering":"nd"},set()))
+  lsolvers.append(("qr",{"mixed_precision":True},set()))
 except:
   pass
 
 try:
   load_linsol("ldl")
   lsolvers.append(("ldl",{},{"posdef","symmetry"}))
+  lsolvers.append(("ldl",{"supernodal":True},{"posdef","symmetry"}))
+  lsolvers.append(("ldl",{"max_num_threads":4},{"posdef","symmetry"}))
+  lsolvers.append(("ldl",{"ordering":"auto"},{"posdef","symmetry"}))
+  lsolvers.append(("ldl",{"mixed_precision":True},{"posdef","symmetry"}))
+  lsolvers.append(("ldl",{"posdef":True,"supernodal":True},{"posdef","symmetry"}))
+except:
+  pass
+
+try:
+  load_linsol("schur")
+  lsolvers.append(("schur",{},set()))
+  lsolvers.append(("schur",{"max_num_threads":4},set()))
 except:
   pass
 
@@ -285,6 +302,94 @@ class LinearSolverTests(casadiTestCase):
       res = np.linalg.solve(A0.T,b)
       self.checkarray(x, res)
 
+  def test_solve_batch(self):
+    np.random.seed(1)
+    A = DM([[4,1,0,0],[1,5,2,0],[0,2,6,1],[0,0,1,7]])
+    As = [A+DM.eye(4)*i for i in range(5)]
+    Bs = [DM(np.random.random((4,11))) for i in range(5)]
+    for Solver, options,req in lsolvers:
+      solver = casadi.Linsol("solver", Solver, A.sparsity(), options)
+      for tr in [False, True]:
+        for n_threads in [1, 3]:
+          Xs = solver.solve_batch(As, Bs, tr, n_threads)
+          for a, b, x in zip(As, Bs, Xs):
+            a = np.array(a.T if tr else a)
+            self.checkarray(x, np.linalg.solve(a, np.array(b)))
+
+  @requiresPlugin(Linsol,"lsqr")
+  def test_lsqr_matrix_free(self):
+    A = DM([[4,1,0,0],[1,5,2,0],[0,2,6,1],[0,0,1,7]])
+    A[0,3] = 3
+    b = DM([1,2,3,4])
+    x = MX.sym("x",4)
+    mv = Function("mv",[x],[mtimes(A,x)])
+    mtv = Function("mtv",[x],[mtimes(A.T,x)])
+    # The nonzeros passed to the solver are ignored
+    solver = casadi.Linsol("solver", "lsqr", A.sparsity(), {"mv":mv, "mtv":mtv})
+    self.checkarray(solver.solve(DM.zeros(A.sparsity()), b), np.linalg.solve(A, b))
+    self.checkarray(solver.solve(DM.zeros(A.sparsity()), b, True), np.linalg.solve(A.T, b))
+    with self.assertRaises(Exception):
+      casadi.Linsol("solver", "lsqr", A.sparsity(), {"mv":mv, "mtv":mtv, "preconditioner":"jacobi"})
+
+  @requiresPlugin(Linsol,"ldl")
+  def test_ldl_update(self):
+    A = DM([[4,1,0,0],[1,5,2,0],[0,2,6,1],[0,0,1,7]])
+    W = DM([[0,0],[1,0],[0.5,0.3],[0,-0.2]])
+    b = DM([1,2,3,4])
+    for sigma in [1,-1]:
+      A2 = A+sigma*mtimes(W,W.T)
+      solver = casadi.Linsol("solver", "ldl", A.sparsity())
+      solver.nfact(A)
+      solver.update(W, sigma)
+      self.checkarray(solver.solve(A2, b), np.linalg.solve(A2, b))
+      self.checkarray(solver.neig(A2), np.sum(np.linalg.eigvalsh(A2)<0))
+
+  @requiresPlugin(Linsol,"ldl")
+  def test_ldl_posdef(self):
+    A = DM([[4,1,0,0],[1,5,2,0],[0,2,6,1],[0,0,1,7]])
+    b = DM([1,2,3,4])
+    solver = casadi.Linsol("solver", "ldl", A.sparsity(), {"posdef":True})
+    self.checkarray(solver.solve(A, b), np.linalg.solve(A, b))
+    # Indefinite
+    A[3,3] = -7
+    with self.assertRaises(Exception):
+      solver.solve(A, b)
+    x = MX.sym("x",A.sparsity())
+    f = Function("f",[x],[solve(x,b,"ldl",{"posdef":True})])
+    self.check_codegen(f,inputs=[A+DM.eye(4)*14])
+
+  @requiresPlugin(Linsol,"schur")
+  def test_schur(self):
+    # Three branches coupled through the variables 2 and 6
+    A = DM([[4,1,1,0,0,0,0,0],
+            [1,5,0,0,0,0,0,0],
+            [1,0,6,1,0,1,1,0],
+            [0,0,1,5,2,0,0,0],
+            [0,0,0,2,7,0,0,0],
+            [0,0,1,0,0,4,0,0],
+            [0,0,1,0,0,0,5,1],
+            [0,0,0,0,0,0,1,3]])
+    A[0,6] = 0.5
+    b = DM([[1,2,3,4,5,6,7,8],[0,1,0,-1,2,0,1,1]]).T
+    for opts in [{}, {"max_num_threads":3}, {"linear_solver":"ldl"}]:
+      if "linear_solver" in opts: A2 = A+A.T
+      else: A2 = A
+      solver = casadi.Linsol("solver", "schur", sparsify(A2).sparsity(), dict(coupling=[2,6], **opts))
+      solver.nfact(A2)
+      self.checkarray(solver.solve(A2, b), np.linalg.solve(A2, b))
+      self.checkarray(solver.solve(A2, b, True), np.linalg.solve(A2.T, b))
+
+  def test_shared_symbolic(self):
+    A = DM([[4,1,0],[1,5,2],[0,2,6]])
+    B = DM([[3,1,0],[1,4,1],[0,1,2]])
+    b = DM([1,2,3])
+    for Solver, options, req in lsolvers:
+      solvers = [casadi.Linsol("solver", Solver, A.sparsity(), options) for i in range(2)]
+      solvers[0].nfact(A)
+      solvers[1].nfact(B)
+      self.checkarray(solvers[0].solve(A, b), np.linalg.solve(A, b))
+      self.checkarray(solvers[1].solve(B, b), np.linalg.solve(B, b))
+
   def test_simple(self):
     A = DM([[3,1],[7,2]])
     for Solver, options, req in lsolvers:
@@ -368,6 +368,34 @@ class Matrixtests(casadiTestCase):
 
     self.checkarray(det(a)/npy_det(a),1,"det()")
 
+  def test_det_inv_sparse(self):
+    numpy.random.seed(0)
+    n = 20
+    sp = Sparsity.banded(n,1)+Sparsity.triplet(n,n,list(numpy.random.randint(n,size=n)),
+                                                   list(numpy.random.randint(n,size=n)))
+    x = SX.sym("x",sp)
+    f = Function('f',[x],[det(x),inv(x)])
+    # Elimination keeps the expressions small
+    self.assertTrue(f.n_instructions()<20000)
+    A = DM(sp,numpy.random.random(sp.nnz()))
+    d, Ainv = f(A)
+    self.checkarray(d/numpy.linalg.det(A),1,"det()")
+    self.checkarray(Ainv,numpy.linalg.inv(A),"inv()")
+    # Structurally singular
+    x = SX.sym("x",Sparsity.banded(n,1)[:,:n-1])
+    self.assertTrue(det(horzcat(x,SX(n,1))).is_zero())
+
+    L, U, rowperm, colperm = sp.lu_sparse()
+    self.assertTrue(A[rowperm,colperm].sparsity().is_subset(L+U))
+    self.assertTrue(L.is_tril() and U.is_triu())
+
+    X = MX.sym("x",Sparsity.banded(8,1))
+    F = Function('F',[X],[det(X),inv_node(X)]).expand()
+    A = DM(Sparsity.banded(8,1),numpy.random.random(22))
+    d, Ainv = F(A)
+    self.checkarray(d,numpy.linalg.det(A),"det()")
+    self.checkarray(Ainv,numpy.linalg.inv(A),"inv()")
+
   @skip(not GlobalOptions.getSimplificationOnTheFly())
   def test_inv_sparsity(self):
     self.message("sparsity pattern of inverse")
@@ -438,6 +466,24 @@ class Matrixtests(casadiTestCase):
     self.assertEqual(D.shape[0],4)
     self.assertEqual(D.shape[1],7)
 
+  def test_sparse_product(self):
+    numpy.random.seed(3)
+    for (n, m, l) in [(40, 300, 250), (5, 4, 3)]:
+      for dense in [False, True]:
+        A = DM(numpy.random.random((n,m))*(dense or numpy.random.random((n,m))>0.8))
+        B = DM(numpy.random.random((m,l))*(dense or numpy.random.random((m,l))>0.8))
+        if dense:
+          A = densify(A)
+          B = densify(B)
+        for n_threads in [1, 4]:
+          P = SparseProduct(A.sparsity(), B.sparsity(), n_threads)
+          self.assertTrue(P.sparsity_out()==mtimes(A, B).sparsity())
+          self.checkarray(P.mtimes(A, B), mtimes(A, B))
+          Z = DM(P.sparsity_out(), 1)
+          self.checkarray(P.mac(A, B, Z), Z+mtimes(A, B))
+          with self.assertInException("plan is for"):
+            P.mtimes(B.T, A.T)
+
   def test_remove(self):
     self.message("remove")
     B = DM([[1,2,3,4],[5,6,7,8],[9,10,11,12],[13,14,15,16],[17,18,19,20]])
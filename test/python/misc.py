@@ -347,6 +347,19 @@ class Misctests(casadiTestCase):
 
     assert "casadi_nlpsol_foo" in result[1]
 
+  def test_preload_plugins(self):
+    t = preload_plugins(["nlpsol::sqpmethod","conic::qrqp","integrator::rk"])
+    self.assertEqual(set(t.keys()),set(["nlpsol::sqpmethod","conic::qrqp","integrator::rk"]))
+    self.assertTrue(all(v>=0 for v in t.values()))
+    self.assertTrue(has_nlpsol("sqpmethod"))
+
+    # Failures are reported after registering the others
+    with self.assertInException("nlpsol::foo"):
+      preload_plugins(["nlpsol::foo","rootfinder::newton"],{"pin":False,"max_num_threads":1})
+    self.assertTrue(has_rootfinder("newton"))
+    with self.assertInException("must be given as"):
+      preload_plugins(["sqpmethod"])
+
 
 if __name__ == '__main__':
     unittest.main()
@@ -2473,6 +2473,18 @@ class MXtests(casadiTestCase):
 
         einstein_tests([2,4,3], [2,5,3], [5, 4], [-1, -2, -3], [-1, -4, -3], [-4, -2])
 
+        # Matrix multiplication like: plain, swapped factors, batched, transposed
+        einstein_tests([4,5], [5,3], [4,3], [-1, -3], [-3, -2], [-1, -2])
+        einstein_tests([5,3], [4,5], [4,3], [-3, -2], [-1, -3], [-1, -2])
+        einstein_tests([4,5,2], [5,3,2], [4,3,2], [-1, -3, -4], [-3, -2, -4], [-1, -2, -4])
+        einstein_tests([5,4], [5,3], [4,3], [-3, -1], [-3, -2], [-1, -2])
+        # Kronecker product
+        einstein_tests([2,3], [4,2], [4,2,2,3], [-1, -2], [-3, -4], [-3, -1, -4, -2])
+
+        A = MX.sym("A",20)
+        B = MX.sym("B",15)
+        self.assertTrue(casadi.einstein(A, B, [4,5], [5,3], [4,3], [-1, -3], [-3, -2], [-1, -2]).info()["gemm"])
+
   def test_sparsity_operation(self):
     L = [MX(Sparsity(1,1)),MX(Sparsity(2,1)), MX.sym("x",1,1), MX.sym("x", Sparsity(1,1)), DM(1), DM(Sparsity(1,1),1), DM(Sparsity(2,1),1), DM(Sparsity.dense(2,1),1)]
 
@@ -2638,6 +2650,187 @@ class MXtests(casadiTestCase):
           f = Function('f',[M,Y],[e])
           self.checkfunction(f,f.expand(),inputs=[ numpy.random.random((S.nnz(),1)), numpy.random.random((E.nnz(),1))])
 
+  def test_getsetnonzeros_runs(self):
+    import numpy
+    numpy.random.seed(42)
+    # Piecewise strided index, too irregular for a (nested) slice
+    ind = list(range(0,40,2))+list(range(99,54,-3))+list(range(50,62))
+    x = MX.sym("x",100)
+    E = x[ind]
+    self.assertTrue("99:54:-3" in str(E))
+    y = MX.sym("y",len(ind))
+    xc = x+0
+    xc[ind] = y
+    xa = x+0
+    xa[ind] += y
+
+    f = Function('f',[x,y],[E,xc,xa])
+    x_ = numpy.random.random((100,1))
+    y_ = numpy.random.random((len(ind),1))
+    xc_ = DM(x_)
+    xc_[ind] = y_
+    xa_ = DM(x_)
+    xa_[ind] += y_
+    [E_,r1,r2] = f(x_,y_)
+    self.checkarray(E_,DM(x_)[ind])
+    self.checkarray(r1,xc_)
+    self.checkarray(r2,xa_)
+    self.checkfunction(f,f.expand(),inputs=[x_,y_])
+    self.check_codegen(f,inputs=[x_,y_])
+
+  def test_fuse_elementwise(self):
+    import numpy
+    numpy.random.seed(42)
+    x = MX.sym("x",10)
+    y = MX.sym("y",10)
+    s = MX.sym("s")
+    q = sin(x)*y + exp(x)
+    e = q*s - 2*cos(q) + sqrt(fabs(x)+1) - 3/(1+s*s)
+    m = dot(e,e)
+    out = [e, sin(m)+2*m, q*3]
+    f = Function('f',[x,y,s],out)
+    g = Function('g',[x,y,s],out,{"fuse_elementwise":True})
+    self.assertTrue(g.stats()["n_fused"]>0)
+    self.assertTrue(g.n_instructions()<f.n_instructions())
+    inputs = [numpy.random.random((10,1)),numpy.random.random((10,1)),0.3]
+    self.checkfunction(g,f,inputs=inputs)
+    self.checkfunction(g,g.expand(),inputs=inputs)
+    self.check_codegen(g,inputs=inputs)
+
+  def test_inline_max_instructions(self):
+    x = MX.sym("x",3)
+    y = MX.sym("y")
+    small = Function('small',[x,y],[sin(x)*y, dot(x,x)])
+    z = MX.sym("z",3)
+    nested = Function('nested',[z],[small(z,2)[0]+1])
+    big = Function('big',[x],[mtimes(DM.ones(3,3),x)+sum1(x)*cos(x)+x**3])
+    out = [nested(x)+big(x), small(x,y)[1]*big(small(x,y)[0])]
+    f = Function('f',[x,y],out)
+    g = Function('g',[x,y],out,{"inline_max_instructions":small.n_instructions()})
+    self.assertEqual(g.stats()["n_inlined"],4)
+    self.assertTrue("n_inlined" not in f.stats())
+    self.assertTrue(g.n_instructions()>f.n_instructions())
+    inputs = [DM([0.1,0.5,0.7]),0.3]
+    self.checkfunction(g,f,inputs=inputs)
+    self.check_codegen(g,inputs=inputs)
+
+  def test_detect_map(self):
+    x = MX.sym("x",2)
+    p = MX.sym("p")
+    F = Function('F',[x,p],[sin(x)*p, dot(x,x)])
+    X = MX.sym("X",2,4)
+    P = MX.sym("P",4)
+    out = []
+    for k in range(4):
+      r = F(X[:,k],P[k])
+      out.append(r[0]+r[1])
+    # Dependent on the previous calls, not folded
+    out.append(F(out[0],P[0])[0])
+    f = Function('f',[X,P],[hcat(out)])
+    for par in ["serial","openmp","thread"]:
+      g = Function('g',[X,P],[hcat(out)],{"detect_map":par})
+      self.assertEqual(g.stats()["n_mapped"],4)
+      inputs = [DM([[0.1,0.2,0.3,0.4],[0.5,0.6,0.7,0.8]]),DM([1,2,3,4])]
+      self.checkfunction(g,f,inputs=inputs)
+    self.check_codegen(g,inputs=inputs)
+
+  def test_zero_copy_concat(self):
+    x = MX.sym("x",3)
+    y = MX.sym("y",2,2)
+    a = sin(x)
+    e = vertcat(a*2, cos(x), x, exp(x[0]), a)
+    out = [e, horzcat(sin(y), y@y, vertcat(cos(x[:2]).T, y[0,:]).T), diagcat(sqrt(y), 3*x)]
+    f = Function('f',[x,y],out)
+    for live_variables in [True, False]:
+      g = Function('g',[x,y],out,{"zero_copy_concat":True,"live_variables":live_variables})
+      self.assertTrue(g.stats()["n_zero_copy"]>0)
+      inputs = [DM([0.1,0.5,0.7]),DM([[1,2],[3,4]])]
+      self.checkfunction(g,f,inputs=inputs)
+      self.checkfunction(g,g.expand(),inputs=inputs)
+      self.check_codegen(g,inputs=inputs)
+
+  def test_incremental(self):
+    x = MX.sym("x",3)
+    p = MX.sym("p",2)
+    a = sin(x)*x
+    out = [mtimes(a.T,a)*p[0]+exp(x[0]), vertcat(a, p[1])]
+    f = Function('f',[x,p],out)
+    g = Function('g',[x,p],out,{"incremental":True})
+    xv = DM([0.1,0.5,0.7])
+    for pv in [DM([1,2]),DM([1,2]),DM([3,2]),DM([3,-1])]:
+      self.checkfunction(g,f,inputs=[xv,pv])
+    n_all = g.n_instructions()
+    # Unchanged inputs: only the outputs are written
+    g(xv,pv)
+    self.assertTrue(g.stats()["n_evaluated"]<n_all)
+    self.checkfunction(g,f,inputs=[xv*2,pv])
+    with self.assertInException("cannot be combined"):
+      Function('g',[x,p],out,{"incremental":True,"parallel":True})
+
+  def test_structured_mtimes(self):
+    import numpy
+    numpy.random.seed(42)
+    A_ = DM(numpy.random.random((3,4)))
+    B_ = DM(numpy.random.random((2,5)))
+    X_ = DM(numpy.random.random((20,2)))
+    c_ = DM(numpy.random.random((6,1)))
+    r_ = DM(numpy.random.random((4,1)))
+    T_ = DM([[float(c_[i-j]) if i>=j else float(r_[j-i]) for j in range(4)] for i in range(6)])
+    Y_ = DM(numpy.random.random((4,3)))
+    h_ = DM(numpy.random.random((3,1)))
+    x_ = DM(numpy.random.random((5,1)))
+    blocks = [DM(numpy.random.random((2,3))),DM(numpy.random.random((4,1)))]
+    Z_ = DM(numpy.random.random((4,2)))
+
+    self.checkarray(kron_mtimes(A_,B_,X_),mtimes(kron(A_,B_),X_))
+    self.checkarray(toeplitz_mtimes(c_,r_,Y_),mtimes(T_,Y_))
+    self.checkarray(diagcat_mtimes(blocks,Z_),mtimes(diagcat(*blocks),Z_))
+    self.checkarray(conv(h_,x_),DM(numpy.convolve(numpy.array(h_).squeeze(),numpy.array(x_).squeeze())))
+
+    for X in [SX, MX]:
+      A = X.sym("A",3,4)
+      B = X.sym("B",2,5)
+      x = X.sym("x",20,2)
+      c = X.sym("c",6)
+      r = X.sym("r",4)
+      y = X.sym("y",4,3)
+      h = X.sym("h",3)
+      z = X.sym("z",5)
+      f = Function('f',[A,B,x,c,r,y,h,z],[kron_mtimes(A,B,x),toeplitz_mtimes(c,r,y),conv(h,z),conv(h.T(),z)])
+      inputs = [A_,B_,X_,c_,r_,Y_,h_,x_]
+      out = f(*inputs)
+      self.checkarray(out[0],mtimes(kron(A_,B_),X_))
+      self.checkarray(out[1],mtimes(T_,Y_))
+      self.checkarray(out[2],conv(h_,x_))
+      self.checkarray(out[3],conv(h_,x_))
+      if X is MX:
+        self.checkfunction(f,f.expand(),inputs=inputs)
+        self.check_codegen(f,inputs=inputs)
+
+  def test_mtimes_large(self):
+    # Large enough for a threaded evaluation when threads are available
+    sp = Sparsity.banded(400,50)
+    A_ = DM.rand(sp)
+    B_ = DM.rand(sp)
+    x = MX.sym("x",sp)
+    y = MX.sym("y",sp)
+    z = mtimes(x,y)
+    self.assertTrue(z.info()["n_threads"]>=1)
+    f = Function('f',[x,y],[z])
+    self.checkarray(f(A_,B_),mtimes(A_,B_))
+    fe = f.expand()
+    for w in [0,1]:
+      fw = Function('f',[x,y],[z],{'ad_weight_sp':w})
+      for i in range(2):
+        self.assertTrue(fw.sparsity_jac(i,0)==fe.sparsity_jac(i,0))
+
+    xd = MX.sym("x",300,300)
+    yd = MX.sym("y",300,200)
+    C_ = DM.rand(300,300)
+    D_ = DM.rand(300,200)
+    f = Function('f',[xd,yd],[mtimes(xd,yd)])
+    self.checkarray(f(C_,D_),mtimes(C_,D_))
+
   def test_evalf(self):
     x = MX.sym("x")
 
@@ -2709,5 +2902,36 @@ class MXtests(casadiTestCase):
   def test_doc_expression_tools(self):
     self.assertTrue("Given a repeated matrix, computes the sum of repeated parts." in repsum.__doc__)
 
+  def test_dense_mtimes(self):
+    for (n,m,k) in [(1,1,1),(3,5,2),(7,9,70),(300,5,3)]:
+      A_ = DM(np.random.random((n,m)))
+      B_ = DM(np.random.random((m,k)))
+      C_ = DM(np.random.random((n,k)))
+      self.checkarray(mtimes(A_,B_),DM(np.dot(np.array(A_),np.array(B_))))
+      self.checkarray(mac(A_,B_,C_),DM(np.dot(np.array(A_),np.array(B_))+np.array(C_)))
+      A = MX.sym("A",n,m)
+      B = MX.sym("B",m,k)
+      C = MX.sym("C",n,k)
+      f = Function("f",[A,B,C],[mac(A,B,C)])
+      self.checkarray(f(A_,B_,C_),mac(A_,B_,C_))
+      self.check_codegen(f,inputs=[A_,B_,C_])
+    cg = CodeGenerator("f_blas",{"blas":True})
+    cg.add(f)
+    self.assertTrue("cblas_dgemm" in cg.dump())
+
+  def test_dense_kernels(self):
+    for n in [0,1,3,4,5,17]:
+      x_ = DM(np.random.random(n))
+      y_ = DM(np.random.random(n))
+      x = MX.sym("x",n)
+      y = MX.sym("y",n)
+      f = Function("f",[x,y],[dot(x,y),norm_2(x),norm_inf(x)])
+      self.checkarray(f(x_,y_)[0],np.dot(np.array(x_).ravel(),np.array(y_).ravel()))
+      self.checkarray(f(x_,y_)[2],np.max(np.abs(np.array(x_))) if n>0 else 0)
+      self.check_codegen(f,inputs=[x_,y_])
+    cg = CodeGenerator("f_blas",{"blas":True})
+    cg.add(f)
+    self.assertTrue("cblas_ddot" in cg.dump())
+
 if __name__ == '__main__':
     unittest.main()
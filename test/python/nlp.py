@@ -1048,6 +1048,58 @@ class NLPtests(casadiTestCase):
         solver(x0=0,lbg=0,ubg=0)
     
 
+  @requires_nlpsol("ipopt")
+  def test_oracle_cache(self):
+    x=SX.sym("x")
+    y=SX.sym("y")
+    nlp={'x':vertcat(x,y), 'f':(1-x)**2+100*(y-x**2)**2, 'g':vertcat(x+y,x**2+y)}
+    r = {}
+    for oracle_cache in [False,True]:
+      solver = nlpsol("solver","ipopt",nlp,{"oracle_cache":oracle_cache,"print_time":False,
+                                            "ipopt":{"print_level":0}})
+      r[oracle_cache] = solver(x0=[0.5,0.5],lbg=[-10,0],ubg=[1.5,1])
+      if oracle_cache:
+        # All callbacks without multipliers are served by the fused functions
+        stats = solver.stats()
+        for fcn in ["nlp_f","nlp_g","nlp_grad_f","nlp_jac_g"]:
+          self.assertEqual(stats["n_call_"+fcn],0)
+        self.assertTrue(stats["n_call_nlp_jac_fg"]>0)
+    self.checkarray(r[True]["x"],r[False]["x"],digits=12)
+
+  @requires_nlpsol("ipopt")
+  def test_colored_hessian(self):
+    x=SX.sym("x",6)
+    p=SX.sym("p")
+    f=sum1((1-x[:-1])**2+p*(x[1:]-x[:-1]**2)**2)+x[0]*x[5]
+    nlp={'x':x, 'p':p, 'f':f, 'g':x[:-2]*x[2:]+sin(x[1:-1])}
+    r = {}
+    for colored_hessian in [False,True]:
+      solver = nlpsol("solver","ipopt",nlp,{"colored_hessian":colored_hessian,"print_time":False,
+                                            "ipopt":{"print_level":0}})
+      r[colored_hessian] = solver(x0=0.5,p=10,lbg=-1,ubg=1)
+      if colored_hessian:
+        # The symbolic Hessian is never evaluated
+        stats = solver.stats()
+        self.assertFalse("n_call_nlp_hess_l" in stats)
+        self.assertTrue(stats["n_call_nlp_hessvec"]>0)
+    for k in ["x","f","lam_g"]:
+      self.checkarray(r[True][k],r[False][k],digits=8)
+
+  @requires_nlpsol("ipopt")
+  def test_ipopt_linsol(self):
+    x=SX.sym("x")
+    y=SX.sym("y")
+    nlp={'x':vertcat(x,y), 'f':(1-x)**2+100*(y-x**2)**2, 'g':vertcat(x+y,x**2+y)}
+    r = {}
+    for linsol in [None,"ldl","qr"]:
+      opts = {"print_time":False, "ipopt":{"print_level":0}}
+      if linsol is not None: opts["linsol"] = linsol
+      solver = nlpsol("solver","ipopt",nlp,opts)
+      r[linsol] = solver(x0=[0.5,0.5],lbg=[-10,0],ubg=[1.5,1])
+      self.assertTrue(solver.stats()["success"])
+    for linsol in ["ldl","qr"]:
+      self.checkarray(r[linsol]["x"],r[None]["x"],digits=8)
+
   @requires_nlpsol("ipopt")
   def test_iteration_Callback(self):
 
@@ -1368,6 +1420,336 @@ class NLPtests(casadiTestCase):
       self.checkarray(solver_out["x"],DM([0]),digits=7)
       if "bonmin" not in str(Solver): self.checkarray(solver_out["lam_x"],DM([0]),digits=7)
 
+  @requires_nlpsol("sqpmethod")
+  @requires_conic("qrqp")
+  def test_sqpmethod_rti(self):
+    N = 10
+    w = MX.sym("w",2*N+1)
+    J = 10*w[N]**2
+    g = []
+    for k in range(N):
+      J += w[k]**2+w[N+1+k]**2
+      g.append(w[k+1]-(w[k]+0.1*(sin(w[k])+w[N+1+k])))
+    nlp = {"x":w,"f":J,"g":vertcat(*g)}
+    opts = {"qpsol":"qrqp","qpsol_options":{"print_iter":False,"print_header":False},
+            "print_header":False,"print_iteration":False,"print_status":False,"print_time":False}
+    lbx = [1]+[-inf]*(2*N)
+    ubx = [1]+[inf]*(2*N)
+    ref = nlpsol("ref","sqpmethod",nlp,opts)(lbx=lbx,ubx=ubx,lbg=0,ubg=0)
+    opts["rti"] = True
+    solver = nlpsol("solver","sqpmethod",nlp,opts)
+    prepare = solver.get_function("rti_prepare")
+    feedback = solver.get_function("rti_feedback")
+    # Real-time iterations converge to the NLP solution for a fixed initial state
+    for f in [solver,feedback]:
+      r = {"x":0,"lam_x":0,"lam_g":0}
+      for i in range(10):
+        if f is feedback: prepare(x0=r["x"],lam_x0=r["lam_x"],lam_g0=r["lam_g"])
+        r = f(x0=r["x"],lam_x0=r["lam_x"],lam_g0=r["lam_g"],lbx=lbx,ubx=ubx,lbg=0,ubg=0)
+      self.checkarray(r["x"],ref["x"],digits=7)
+    self.assertEqual(feedback.stats()["return_status"],"Feedback_Completed")
+
+  @requires_nlpsol("sqpmethod")
+  @requires_conic("qrqp")
+  def test_warm_start(self):
+    x = SX.sym("x",4)
+    p = SX.sym("p")
+    f = sum([(x[i+1]-x[i]**2)**2+(p-x[i])**2 for i in range(3)])
+    nlp = {"x":x,"p":p,"f":f,"g":x[0]+x[1]}
+    iters = {}
+    for warm_start in [False,True]:
+      solver = nlpsol("solver","sqpmethod",nlp,{"qpsol":"qrqp",
+        "qpsol_options":{"print_iter":False,"print_header":False},
+        "hessian_approximation":"limited-memory","print_header":False,"print_iteration":False,
+        "print_status":False,"print_time":False,"warm_start":warm_start})
+      r = {"x":1,"lam_x":0,"lam_g":0}
+      iters[warm_start] = 0
+      for k in range(20):
+        r = solver(x0=r["x"],lam_x0=r["lam_x"],lam_g0=r["lam_g"],p=1+0.01*k,lbg=-10,ubg=1.5)
+        iters[warm_start] += solver.stats()["iter_count"]
+      if warm_start: self.checkarray(r["x"],ref,digits=5)
+      ref = r["x"]
+    # The BFGS approximation is kept between the solves
+    self.assertTrue(iters[True]<iters[False])
+
+  @requires_nlpsol("sqpmethod")
+  @requires_conic("qrqp")
+  def test_max_num_threads(self):
+    x = SX.sym("x",3)
+    nlp = {"x":x,"f":(1-x[0])**2+100*(x[1]-x[0]**2)**2+(x[2]-1)**2,
+           "g":vertcat(x[0]+x[1]+x[2],x[0]**2+x[2])}
+    r = {}
+    for max_num_threads in [1,2]:
+      solver = nlpsol("solver","sqpmethod",nlp,{"qpsol":"qrqp",
+        "qpsol_options":{"print_iter":False,"print_header":False},"print_header":False,
+        "print_iteration":False,"print_status":False,"print_time":False,
+        "max_num_threads":max_num_threads})
+      r[max_num_threads] = solver(x0=0.5,lbg=[-10,0],ubg=[2,1.5])
+      # The Hessian is evaluated together with the Jacobian, also after the last iteration
+      stats = solver.stats()
+      self.assertEqual(stats["n_call_nlp_hess_l"],stats["iter_count"]+(max_num_threads>1))
+    self.checkarray(r[1]["x"],r[2]["x"],digits=12)
+
+  @requires_nlpsol("multistart")
+  @requires_nlpsol("sqpmethod")
+  @requires_conic("qrqp")
+  def test_multistart(self):
+    x = SX.sym("x",2)
+    nlp = {"x":x,"f":(x[0]**2-1)**2+0.3*x[0]+(x[1]-x[0])**2,"g":x[0]+x[1]}
+    sqp = {"qpsol":"qrqp","qpsol_options":{"print_iter":False,"print_header":False},
+           "print_header":False,"print_iteration":False,"print_status":False,"print_time":False}
+    for max_num_threads in [1,3]:
+      opts = {"solvers":["sqpmethod"],"solver_options":{"sqpmethod":sqp},"print_time":False,
+              "starts":[[-1.5,-1.5],[2,2]],"max_num_threads":max_num_threads}
+      # Best of all runs: the global minimum, from the first additional start
+      solver = nlpsol("solver","multistart",nlp,opts)
+      r = solver(x0=1,lbg=-10,ubg=10)
+      self.assertEqual(solver.stats()["best_start"],1)
+      self.checkarray(r["x"],DM([-1.03558,-1.03558]),digits=4)
+      # Stop at the first success
+      opts["f_target"] = inf
+      solver = nlpsol("solver","multistart",nlp,opts)
+      r = solver(x0=1,lbg=-10,ubg=10)
+      self.assertTrue(solver.stats()["success"])
+      if max_num_threads==1:
+        self.assertEqual(solver.stats()["run_status"],["succeeded","not_started","not_started"])
+
+  @requires_nlpsol("aladin")
+  @requires_nlpsol("sqpmethod")
+  @requires_conic("qrqp")
+  def test_aladin(self):
+    N = 4
+    for X in [SX, MX]:
+      x = [X.sym("x%d" % i,2) for i in range(N)]
+      f = 0
+      for i in range(N):
+        f += (x[i][0]-0.3*i)**2+(x[i][1]+1)**2+0.1*x[i][0]**4
+      # Local constraints, then coupling constraints between neighbouring blocks
+      g = [x[i][0]**2+x[i][1]**2 for i in range(N)]
+      g += [x[i][1]-x[i+1][0] for i in range(N-1)]
+      nlp = {"x":vertcat(*x),"f":f,"g":vertcat(*g)}
+      arg = dict(x0=0,lbg=[-inf]*N+[0]*(N-1),ubg=[1]*N+[0]*(N-1))
+      qp = {"print_iter":False,"print_header":False}
+      sqp = {"qpsol":"qrqp","qpsol_options":qp,"print_header":False,"print_iteration":False,
+             "print_status":False,"print_time":False}
+      r_ref = nlpsol("solver","sqpmethod",nlp,sqp)(**arg)
+      for hessian_approximation in ["exact","proximal"]:
+        for max_num_threads in [1,N]:
+          opts = {"blocks":[[2*i,2*i+1] for i in range(N)],"nlpsol":"sqpmethod",
+                  "nlpsol_options":sqp,"qpsol_options":qp,"print_iteration":False,
+                  "print_time":False,"hessian_approximation":hessian_approximation,
+                  "max_iter":200,"max_num_threads":max_num_threads}
+          solver = nlpsol("solver","aladin",nlp,opts)
+          r = solver(**arg)
+          self.assertTrue(solver.stats()["success"])
+          if hessian_approximation=="exact":
+            self.assertTrue(solver.stats()["iter_count"]<10)
+          self.checkarray(r["x"],r_ref["x"],digits=5)
+          self.checkarray(r["lam_g"],r_ref["lam_g"],digits=5)
+
+  @requires_nlpsol("branch_and_bound")
+  @requires_nlpsol("sqpmethod")
+  @requires_conic("qrqp")
+  def test_branch_and_bound(self):
+    x = SX.sym("x",4)
+    nlp = {"x":x,"f":(x[0]-0.6)**2+(x[1]-2.4)**2+(x[2]-1.3)**2+(x[3]-0.5)**2+0.3*x[0]*x[1],
+           "g":vertcat(x[0]+x[1]+x[2]+x[3],x[0]-x[2])}
+    sqp = {"qpsol":"qrqp","qpsol_options":{"print_iter":False,"print_header":False},
+           "print_header":False,"print_iteration":False,"print_status":False,"print_time":False}
+    arg = dict(x0=0,lbx=[0,0,0,-5],ubx=5,lbg=[4.2,-10],ubg=[10,-0.5])
+    # Reference: enumerate the integer assignments
+    solver = nlpsol("solver","sqpmethod",nlp,sqp)
+    f_ref = inf
+    for i in itertools.product(range(6),repeat=3):
+      r = solver(x0=list(i)+[0],lbx=list(i)+[-5],ubx=list(i)+[5],lbg=arg["lbg"],ubg=arg["ubg"])
+      if solver.stats()["success"] and float(r["f"])<f_ref:
+        f_ref = float(r["f"])
+        x_ref = r["x"]
+    for max_num_threads in [1,4]:
+      opts = {"solver":"sqpmethod","solver_options":sqp,"discrete":[True,True,True,False],
+              "max_num_threads":max_num_threads,"print_time":False}
+      bnb = nlpsol("bnb","branch_and_bound",nlp,opts)
+      r = bnb(**arg)
+      stats = bnb.stats()
+      self.assertTrue(stats["success"])
+      self.checkarray(r["f"],f_ref,digits=8)
+      self.checkarray(r["x"],x_ref,digits=6)
+      self.assertTrue(stats["n_nodes"]<6**3)
+
+  @requires_nlpsol("scaling")
+  @requires_nlpsol("sqpmethod")
+  @requires_conic("qrqp")
+  def test_scaling(self):
+    sqp = {"qpsol":"qrqp","qpsol_options":{"print_iter":False,"print_header":False},
+           "print_header":False,"print_iteration":False,"print_status":False,"print_time":False}
+    for X in [SX, MX]:
+      x = X.sym("x",2)
+      p = X.sym("p")
+      nlp = {"x":x,"p":p,"f":1e4*(x[0]-p)**2+1e2*(x[1]-2e-3)**2+1e3*x[0]*x[1],
+             "g":vertcat(1e5*(x[0]+x[1]),1e3*x[0]**2)}
+      solver = nlpsol("solver","sqpmethod",nlp,sqp)
+      for nominal in [{}, {"nominal_x":[10,0.1],"nominal_g":[1e5,1e3]}]:
+        opts = {"solver":"sqpmethod","solver_options":sqp,"print_time":False}
+        opts.update(nominal)
+        scaled = nlpsol("solver","scaling",nlp,opts)
+        # Active variable bound and constraints
+        for ubx in [10, 1.5]:
+          arg = dict(x0=[0.5,0.1],p=3,lbx=-10,ubx=ubx,lbg=[-1e5,0],ubg=[1e5,4e3])
+          r = solver(**arg)
+          r_scaled = scaled(**arg)
+          self.assertTrue(scaled.stats()["success"])
+          for k in ["x","f","g","lam_x","lam_g","lam_p"]:
+            self.checkarray(r_scaled[k],r[k],digits=6)
+      stats = scaled.stats()
+      self.checkarray(stats["scale_g"],DM([1e-5,1e-3]))
+
+  @requires_nlpsol("sqpmethod")
+  @requires_conic("qrqp")
+  def test_sens_linsol(self):
+    x = MX.sym("x",2)
+    p = MX.sym("p",2)
+    nlp = {"x":x,"p":p,"f":(x[0]-p[0])**2+2*(x[1]-p[1]*x[0])**2+sin(x[0]),"g":x[0]+x[1]}
+    P = MX.sym("P",2)
+    J = {}
+    for sens_linsol in ["qr","symbolicqr"]:
+      solver = nlpsol("solver","sqpmethod",nlp,{"qpsol":"qrqp",
+        "qpsol_options":{"print_iter":False,"print_header":False},"print_header":False,
+        "print_iteration":False,"print_status":False,"print_time":False,
+        "sens_linsol":sens_linsol})
+      r = solver(p=P,lbg=-1,ubg=0.5,x0=0)
+      # Forward and reverse derivatives share one factorization of the KKT system
+      F = Function("F",[P],[jacobian(r["x"],P),gradient(r["f"]+dot(r["x"],r["x"]),P)])
+      J[sens_linsol] = F([0.3,0.7])
+    for a,b in zip(J["qr"],J["symbolicqr"]):
+      self.checkarray(a,b,digits=8)
+
+  @requires_nlpsol("sqpmethod")
+  @requires_conic("qrqp")
+  def test_block_hess(self):
+    N = 5
+    x = SX.sym("x",2*N)
+    f = sum([(x[2*i]-1)**2+(x[2*i+1]-0.5*x[2*i])**2+0.1*x[2*i]**4+x[2*i]*x[2*i+1]
+             for i in range(N)])
+    g = vertcat(*[x[2*i+2]-0.5*x[2*i+1]-0.4 for i in range(N-1)])
+    nlp = {"x":x,"f":f,"g":g}
+    opts = {"qpsol":"qrqp","qpsol_options":{"print_iter":False,"print_header":False},
+      "print_header":False,"print_iteration":False,"print_status":False,"print_time":False}
+    solver = nlpsol("solver","sqpmethod",nlp,opts)
+    ref = solver(x0=0.5,lbg=0,ubg=0)["x"]
+    opts["hessian_approximation"] = "limited-memory"
+    opts["block_hess"] = True
+    opts["max_iter"] = 200
+    solver = nlpsol("solver","sqpmethod",nlp,opts)
+    r = solver(x0=0.5,lbg=0,ubg=0)
+    self.assertEqual(solver.stats()["return_status"],"Solve_Succeeded")
+    self.checkarray(r["x"],ref,digits=5)
+
+  @requires_nlpsol("sqpmethod")
+  @requires_conic("qrqp")
+  def test_latency_stats(self):
+    x = SX.sym("x",2)
+    nlp = {"x":x,"f":(x[0]-1)**2+(x[1]-x[0]**2)**2}
+    solver = nlpsol("solver","sqpmethod",nlp,{"qpsol":"qrqp",
+      "qpsol_options":{"print_iter":False,"print_header":False},"print_header":False,
+      "print_iteration":False,"print_status":False,"print_time":False,"latency_stats":True})
+    for k in range(3): solver(x0=0)
+    s = solver.stats()
+    # Histograms are kept over all solves
+    l = s["latency_solver"]
+    self.assertEqual(l["n_call"],3)
+    self.assertTrue(0<l["p50"]<=l["p99"]<=l["max"])
+    l = s["latency_nlp_jac_fg"]
+    self.assertTrue(l["n_call"]>=s["n_call_nlp_jac_fg"])
+    self.assertTrue(l["p99"]<=l["max"])
+    self.assertFalse("latency_solver" in nlpsol("solver","sqpmethod",nlp,{"qpsol":"qrqp"}).stats())
+
+  def test_expand_auto(self):
+    x = MX.sym("x",2)
+    nlp = {"x":x,"f":(x[0]-1)**2+(x[1]-x[0]**2)**2}
+    opts = {"qpsol":"qrqp","qpsol_options":{"print_iter":False,"print_header":False},
+      "print_header":False,"print_iteration":False,"print_status":False,"print_time":False,
+      "expand_auto":True}
+    for max_instructions, expanded in [(1000, True), (2, False)]:
+      opts["expand_max_instructions"] = max_instructions
+      solver = nlpsol("solver","sqpmethod",nlp,opts)
+      self.checkarray(solver(x0=0)["x"], DM([1, 1]), digits=6)
+      s = solver.stats()["expand"]
+      self.assertEqual(s["expanded"], expanded)
+      self.assertTrue(s["n_instructions"]>2)
+      self.assertEqual(solver.get_function("nlp_f").is_a("SXFunction"), expanded)
+
+  def test_trace(self):
+    x = SX.sym("x",2)
+    nlp = {"x":x,"f":(x[0]-1)**2+(x[1]-x[0]**2)**2}
+    solver = nlpsol("solver","sqpmethod",nlp,{"qpsol":"qrqp",
+      "qpsol_options":{"print_iter":False,"print_header":False},"print_header":False,
+      "print_iteration":False,"print_status":False,"print_time":False,"trace_size":1000})
+    solver(x0=0)
+    n = solver.stats()["iter_count"]+1
+    solver(x0=0)
+    t = solver.stats()["trace"]
+    # The trace is kept across solves
+    self.assertEqual(len(t["iter"]),2*n)
+    self.assertEqual(t["solve"],[1]*n+[2]*n)
+    self.assertEqual(t["iter"][:n],list(range(n)))
+    self.assertEqual(t["n_dropped"],0)
+    self.assertTrue(t["t_wall"][n-1]>=t["t_wall"][0])
+    self.checkarray(t["f"][-1],0,digits=6)
+    for c in ["inf_pr","inf_du","step","reg","ls_trials","ls_success"]: self.assertTrue(c in t)
+    # Ring buffer keeps the last iterations
+    solver = nlpsol("solver","sqpmethod",nlp,{"qpsol":"qrqp",
+      "qpsol_options":{"print_iter":False,"print_header":False},"print_header":False,
+      "print_iteration":False,"print_status":False,"print_time":False,"trace_size":3})
+    solver(x0=0)
+    t = solver.stats()["trace"]
+    self.assertEqual(t["iter"],list(range(n-3,n)))
+    self.assertEqual(t["n_dropped"],n-3)
+    self.assertFalse("trace" in nlpsol("solver","sqpmethod",nlp,{"qpsol":"qrqp"}).stats())
+
+  def test_snapshot(self):
+    import tempfile, os, shutil
+    d = tempfile.mkdtemp()
+    fname = os.path.join(d, "snapshot.bin")
+    x = MX.sym("x",2)
+    opts = {"qpsol":"qrqp","qpsol_options":{"print_iter":False,"print_header":False},
+      "print_header":False,"print_iteration":False,"print_status":False,"print_time":False,
+      "snapshot":fname}
+    nlp = {"x":x,"f":(x[0]-1)**2+(x[1]-x[0]**2)**2}
+    sol_ref = nlpsol("solver","sqpmethod",nlp,opts)(x0=0)
+    self.assertTrue(os.path.exists(fname))
+    # Functions are read from the snapshot
+    data = open(fname,"rb").read()
+    sol = nlpsol("solver","sqpmethod",nlp,opts)(x0=0)
+    self.checkarray(sol["x"],sol_ref["x"])
+    self.assertEqual(open(fname,"rb").read(),data)
+    # A different problem regenerates the functions
+    nlp = {"x":x,"f":(x[0]-2)**2+(x[1]-x[0]**2)**2}
+    sol = nlpsol("solver","sqpmethod",nlp,opts)(x0=0)
+    self.checkarray(sol["x"],DM([2,4]),digits=6)
+    self.assertNotEqual(open(fname,"rb").read(),data)
+    shutil.rmtree(d)
+
+  def test_max_wall_time(self):
+    x = SX.sym("x",20)
+    f = sum1((1-x[:-1])**2+100*(x[1:]-x[:-1]**2)**2)
+    opts = {"qpsol":"qrqp","qpsol_options":{"print_iter":False,"print_header":False},
+      "print_header":False,"print_iteration":False,"print_status":False,"print_time":False}
+    nlp = {"x":x,"f":f}
+    # Current iterate returned when the time limit has passed
+    solver = nlpsol("solver","sqpmethod",nlp,dict(opts,max_wall_time=1e-9))
+    sol = solver(x0=0)
+    self.assertEqual(solver.stats()["return_status"],"Maximum_WallTime_Exceeded")
+    self.assertFalse(solver.stats()["success"])
+    self.checkarray(sol["x"],DM.zeros(20))
+    # Only the calls in progress are cancelled
+    solver = nlpsol("solver","sqpmethod",nlp,opts)
+    solver.cancel()
+    sol = solver(x0=0)
+    self.assertEqual(solver.stats()["return_status"],"Solve_Succeeded")
+    self.checkarray(sol["x"],DM.ones(20),digits=6)
+    with self.assertInException("must be positive"):
+      nlpsol("solver","sqpmethod",nlp,dict(opts,max_wall_time=0))
+
 if __name__ == '__main__':
     unittest.main()
     print(solvers)
@@ -187,6 +187,41 @@ class OCPtests(casadiTestCase):
     self.assertAlmostEqual(fmax(-solver_out["lam_x"],0)[0],0,8,"Constraint is supposed to be unactive")
     self.assertAlmostEqual(fmax(-solver_out["lam_x"],0)[1],0,8,"Constraint is supposed to be unactive")
 
+  def test_eliminate_alg(self):
+    dae = DaeBuilder()
+    x = dae.add_x("x")
+    p = dae.add_p("p")
+    d = [p]
+    dref = [p]
+    for i in range(5):
+      d.append(dae.add_d("d%d" % i, 1.01*d[-1] + sin(p)))
+      dref.append(1.01*dref[-1] + sin(p))
+    z = [dae.add_z("z%d" % i) for i in range(5)]
+    zref = [x]
+    for i in range(5):
+      dae.add_alg("a%d" % i, (2+sin(z[i-1] if i else x))*z[i] - cos(z[i-1] if i else x) - d[i+1])
+      zref.append((cos(zref[-1]) + dref[i+1])/(2+sin(zref[-1])))
+    dae.add_ode("ode", -x + z[-1])
+    dae.eliminate_alg()
+    self.assertEqual(len(dae.z),0)
+    f = dae.create("f", ["x", "p"], ["ode"])
+    fref = Function("fref", [x, p], [-x + zref[-1]])
+    self.checkarray(f(1, 2), fref(1, 2))
+
+  def test_XML_cache(self):
+    ivp = DaeBuilder()
+    ivp.parse_fmi('data/cstr.xml',{"cache":True})
+    ivp2 = DaeBuilder()
+    ivp2.parse_fmi('data/cstr.xml',{"cache":True})
+    self.assertEqual(len(ivp2.dae),3)
+    self.assertTrue(is_equal(ivp("cstr.c"),ivp2("cstr.c")))
+
+    ivp3 = DaeBuilder()
+    ivp3.parse_fmi('data/cstr.xml',{"skip":["opt:Optimization"]})
+    self.assertEqual(len(ivp3.dae),3)
+    self.assertEqual(len(ivp3.y),0)
+    self.assertFalse(is_equal(ivp("cstr.c"),ivp3("cstr.c")))
+
   @requiresPlugin(XmlFile,"tinyxml")
   def test_XML(self):
     self.message("JModelica XML parsing")
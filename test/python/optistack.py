@@ -853,6 +853,101 @@ class OptiStacktests(inherit_from):
       sol2 = solver(p=sol.value(p),lbg=sol.value(opti.lbg),ubg=sol.value(opti.ubg))
       
       self.checkarray(sol2["x"],sol.value(opti.x))
+
+    def test_incremental_bake(self):
+      def build(query):
+        opti = Opti()
+        x = opti.variable(3)
+        p = opti.parameter()
+        opti.minimize(sumsqr(x))
+        ng = []
+        for i in range(3):
+          y = opti.variable()
+          opti.subject_to(x[i]+y>=p+i)
+          if query: ng.append((opti.nx,opti.ng,str(opti.g),str(opti.lam_g)))
+          opti.subject_to(opti.bounded(-5,y,5))
+        opti.set_value(p, 1)
+        opti.solver('ipopt')
+        return opti, ng
+
+      opti, ng = build(True)
+      self.assertEqual([e[:2] for e in ng],[(4,1),(5,3),(6,5)])
+      ref, _ = build(False)
+      self.assertEqual(str(opti.g),str(ref.g))
+      self.assertEqual(str(opti.lbg),str(ref.lbg))
+      self.assertEqual(str(opti.lam_g),str(ref.lam_g))
+      self.checkarray(opti.solve().value(opti.x),ref.solve().value(ref.x),digits=7)
+
+      # Changing the objective or constraint bounds still rebakes fully
+      opti.minimize(sumsqr(opti.x-1))
+      self.assertEqual(opti.nx,6)
+
+    def test_to_function(self):
+      opti = Opti()
+      x = opti.variable(2)
+      p = opti.parameter()
+      q = opti.parameter()
+      opti.minimize(sumsqr(x-p))
+      c = x[0]+x[1]>=q
+      opti.subject_to(c)
+      opti.set_value(p, 0)
+      opti.set_value(q, 1)
+      opti.solver('ipopt')
+
+      f = opti.to_function('f',[p,x],[x,opti.f,opti.dual(c)],['p','x0'],['x','f','lam'])
+      self.assertEqual(f.name_in(),['p','x0'])
+
+      xx = DM.zeros(2)
+      for pv in [2,0,-1]:
+        [xx,fv,lam] = f(pv,xx)
+        opti.set_value(p, pv)
+        sol = opti.solve()
+        self.checkarray(xx,sol.value(x),digits=7)
+        self.checkarray(fv,sol.value(opti.f),digits=7)
+        self.checkarray(lam,sol.value(opti.dual(c)),digits=7)
+
+      # Parameters that are not inputs keep their current value
+      opti.set_value(q, 3)
+      self.checkarray(f(0,xx)[0],DM([0.5,0.5]),digits=7)
+      self.checkarray(opti.to_function('g',[p],[x])(0),DM([1.5,1.5]),digits=7)
+
+      with self.assertInException("inputs must be variables, parameters or dual variables"):
+        opti.to_function('g',[2*p],[x])
+
+    def test_structure_detection(self):
+      N = 5
+      opti = Opti()
+      X = opti.variable(2,N+1)
+      U = opti.variable(1,N)
+      T = opti.variable()
+      opti.minimize(sumsqr(X)+sumsqr(U)+(T-1)**2)
+      for k in range(N):
+        opti.subject_to(X[:,k+1]==vertcat(X[0,k]+0.1*X[1,k],X[1,k]+0.1*U[k]*T))
+      opti.subject_to(opti.bounded(-1,U,1))
+      opti.subject_to(X[:,0]==vertcat(1,0))
+
+      opti.solver('ipopt')
+      sol = opti.solve()
+      x_ref = sol.value(X)
+      lam_ref = sol.value(opti.lam_g)
+
+      qpsol_options = {"print_iter":False,"print_header":False}
+      for qpsol in ["qrqp", "condensing"]:
+        opts = {"structure_detection":"auto","qpsol":qpsol,"print_header":False,"print_iteration":False}
+        if qpsol=="condensing":
+          opts["qpsol_options"] = {"qpsol":"qrqp","qpsol_options":qpsol_options}
+        else:
+          opts["qpsol_options"] = qpsol_options
+        opti.solver('sqpmethod',opts)
+        sol = opti.solve()
+        self.checkarray(sol.value(X),x_ref,digits=6)
+        self.checkarray(sol.value(opti.lam_g),lam_ref,digits=6)
+        f = opti.to_function('f',[X],[X])
+        self.checkarray(f(0),x_ref,digits=6)
+
+      opti.solver('ipopt',{"structure_detection":"foo"})
+      with self.assertInException("'structure_detection' must be 'none' or 'auto'"):
+        opti.solve()
       
 if __name__ == '__main__':
     unittest.main()
@@ -0,0 +1,103 @@
+#
+#     This file is part of CasADi.
+#
+#     CasADi -- A symbolic framework for dynamic optimization.
+#     Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+#                             K.U. Leuven. All rights reserved.
+#     Copyright (C) 2011-2014 Greg Horn
+#
+#     CasADi is free software; you can redistribute it and/or
+#     modify it under the terms of the GNU Lesser General Public
+#     License as published by the Free Software Foundation; either
+#     version 3 of the License, or (at your option) any later version.
+#
+#     CasADi is distributed in the hope that it will be useful,
+#     but WITHOUT ANY WARRANTY; without even the implied warranty of
+#     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+#     Lesser General Public License for more details.
+#
+#     You should have received a copy of the GNU Lesser General Public
+#     License along with CasADi; if not, write to the Free Software
+#     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+#
+#
+from casadi import *
+import casadi as c
+import numpy as np
+import unittest
+from helpers import *
+import os
+import subprocess
+
+# Timings of key operations on a chained Rosenbrock model, recorded in
+# performance-recording mode (--perf_record), cf. PerfHistory in helpers.py
+
+def rosenbrock(x):
+  return sum1(100*(x[1:]-x[:-1]**2)**2 + (1-x[:-1])**2)
+
+class Performancetests(casadiTestCase):
+  N = 200
+
+  def test_construction(self):
+    for X in [SX, MX]:
+      x = X.sym("x", self.N)
+      f = self.perf("construct.%s" % X.__name__, lambda: Function('f', [x], [rosenbrock(x)]))
+      self.checkarray(f(DM.ones(self.N)), 0)
+
+  def test_derivatives(self):
+    for X in [SX, MX]:
+      x = X.sym("x", self.N)
+      f = rosenbrock(x)
+      J = self.perf("jacobian.%s" % X.__name__, lambda: Function('J', [x], [jacobian(f, x)]))
+      H = self.perf("hessian.%s" % X.__name__, lambda: Function('H', [x], [hessian(f, x)[0]]))
+      self.checkarray(J(DM.ones(self.N)), DM.zeros(1, self.N))
+      self.assertEqual(H.sparsity_out(0).nnz(), 3*self.N-2)
+
+  def test_eval(self):
+    x0 = DM(np.random.random(self.N))
+    for X in [SX, MX]:
+      x = X.sym("x", self.N)
+      f = Function('f', [x], [rosenbrock(x), gradient(rosenbrock(x), x)])
+      def evaluate():
+        for i in range(100): r = f(x0)
+        return r
+      r = self.perf("eval.%s" % X.__name__, evaluate)
+      self.checkarray(r[0], rosenbrock(x0))
+
+  def test_codegen(self):
+    x = SX.sym("x", self.N)
+    f = rosenbrock(x)
+    F = Function('perf_codegen', [x], [f, gradient(f, x), hessian(f, x)[0]])
+    self.perf("codegen.generate", lambda: F.generate("perf_codegen.c"))
+    if not (args.run_slow or args.perf_record): return
+    cmd = "gcc -fPIC -shared -O3 perf_codegen.c -o perf_codegen.so"
+    self.perf("codegen.compile", lambda: subprocess.check_call(cmd, shell=True), repeat=1)
+    F2 = external(F.name(), './perf_codegen.so')
+    x0 = DM(np.random.random(self.N))
+    for r, r2 in zip(F(x0), F2(x0)):
+      self.checkarray(r, r2)
+
+  def solve(self, solver, opts):
+    x = MX.sym("x", self.N)
+    nlp = {"x": x, "f": rosenbrock(x), "g": x[0]}
+    S = self.perf("nlpsol.%s.construct" % solver, lambda: nlpsol('S', solver, nlp, opts))
+    def iterations(sol):
+      stats = S.stats()
+      return {"iter_count": stats["iter_count"],
+              "time_per_iter": stats["t_wall_total"]/max(stats["iter_count"], 1)}
+    sol = self.perf("nlpsol.%s.solve" % solver, lambda: S(x0=0, lbg=-0.5, ubg=2), extra=iterations)
+    self.assertTrue(S.stats()["success"])
+    self.checkarray(sol["x"], DM.ones(self.N), digits=5)
+
+  @requires_nlpsol("ipopt")
+  def test_ipopt(self):
+    self.solve("ipopt", {"print_time": False, "ipopt": {"print_level": 0, "tol": 1e-10}})
+
+  @requires_conic("qrqp")
+  def test_sqpmethod(self):
+    self.solve("sqpmethod", {"print_time": False, "print_header": False, "print_iteration": False,
+                             "qpsol": "qrqp", "qpsol_options": {"print_iter": False, "print_header": False},
+                             "tol_du": 1e-10, "max_iter": 200})
+
+if __name__ == '__main__':
+    unittest.main()
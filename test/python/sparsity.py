@@ -25,6 +25,7 @@ from casadi import *
 import casadi as c
 import numpy
 import unittest
+import sys
 from types import *
 from helpers import *
 import numpy
@@ -545,7 +546,178 @@ class Sparsitytests(casadiTestCase):
     A = dn[[e for e in zres if e>=0]]
     B = D[[e for e,k in zip(z,zres) if k>=0]]
     self.checkarray(A,B)
-    self.assertFalse(np.any(D[[e for e,k in zip(z,zres) if k==-1]]))    
+    self.assertFalse(np.any(D[[e for e,k in zip(z,zres) if k==-1]]))
+
+  def test_get_nz_elements(self):
+    numpy.random.seed(0)
+    n = 300
+    sp = (DM(numpy.random.random((n,4))>0.3)).sparsity()
+    r = list(numpy.random.randint(n,size=1000))
+    c = list(numpy.random.randint(4,size=1000))
+    ref = [sp.get_nz(i,j) for i,j in zip(r,c)]
+    for n_threads in [1,3]:
+      self.assertEqual(sp.get_nz_elements(r,c,n_threads),ref)
+    # Unsorted linear indices
+    self.assertEqual(sp.get_nz([i+j*n for i,j in zip(r,c)]),ref)
+    self.assertEqual(Sparsity.dense(n,4).get_nz_elements(r,c),[i+j*n for i,j in zip(r,c)])
+    with self.assertInException("Out of bounds"):
+      sp.get_nz_elements([n],[0])
+
+  def test_nd(self):
+    # 2D grid Laplacian
+    N = 30
+    A = DM.eye(N*N)*4
+    for i in range(N):
+      for j in range(N):
+        if i+1<N: A[i*N+j,(i+1)*N+j] = A[(i+1)*N+j,i*N+j] = -1
+        if j+1<N: A[i*N+j,i*N+j+1] = A[i*N+j+1,i*N+j] = -1
+    sp = A.sparsity()
+    for method in ["natural", "amd", "nd", "auto"]:
+      p = sp.ordering(method)
+      self.assertEqual(sorted(p), list(range(N*N)))
+    p = sp.nd()
+    nnz_nd = sp.sub(p, p)[0].ldl(False)[0].nnz()
+    p = sp.ordering("natural")
+    nnz_natural = sp.sub(p, p)[0].ldl(False)[0].nnz()
+    self.assertTrue(nnz_nd<nnz_natural)
+    p = sp.ordering("auto")
+    nnz_auto = sp.sub(p, p)[0].ldl(False)[0].nnz()
+    self.assertTrue(nnz_auto<=nnz_nd)
+
+  def test_cache_stats(self):
+    s0 = Sparsity.cache_stats()
+    sp = Sparsity.lower(17)
+    s1 = Sparsity.cache_stats()
+    sp2 = Sparsity.lower(17)
+    s2 = Sparsity.cache_stats()
+    self.assertTrue(sp==sp2)
+    self.assertEqual(s2["n_hit"], s1["n_hit"]+1)
+    self.assertEqual(s2["n_miss"], s1["n_miss"])
+    self.assertTrue(s1["n_miss"]>s0["n_miss"] or s1["n_hit"]>s0["n_hit"])
+    self.assertTrue(s2["n_pattern"]>0 and s2["n_bytes"]>0)
+
+  def test_memo(self):
+    import numpy
+    numpy.random.seed(1)
+    A = DM(numpy.random.random((30,20))>0.7).sparsity()
+    B = DM(numpy.random.random((20,25))>0.7).sparsity()
+    C = DM(numpy.random.random((30,20))>0.6).sparsity()
+    for k in range(3):
+      for invert in [False, True]:
+        T, m = A.transpose(invert)
+        self.assertTrue(T==A.T())
+        self.checkarray(DM(A,m if invert else list(range(A.nnz()))),
+                        DM(T,list(range(A.nnz())) if invert else m).T())
+      self.assertTrue(Sparsity.mtimes(A,B)==(DM.ones(A)@DM.ones(B)).sparsity())
+      self.assertTrue(A.unite(C)==(DM.ones(A)+DM.ones(C)).sparsity())
+      self.assertTrue(A.intersect(C)==(DM.ones(A)*DM.ones(C)).sparsity())
+
+  def test_structured(self):
+    for (n, l, u) in [(6, 1, 2), (5, 0, 0), (4, 3, 3), (7, 0, 2), (1, 0, 0)]:
+      A = Sparsity.banded(n, l, u)
+      self.assertEqual((A.bw_lower(), A.bw_upper()), (l, u))
+      ref = numpy.array([[1 if -u<=i-j<=l else 0 for j in range(n)] for i in range(n)])
+      self.checkarray(DM(A, 1), ref)
+      B = Sparsity.banded(n, u, 1)
+      C = DM(A, 1) @ DM(B, 1)
+      self.assertTrue(Sparsity.mtimes(A, B)==C.sparsity())
+      self.checkarray(DM(Sparsity.mtimes(A, B), 1), numpy.minimum(numpy.array(C), 1))
+    self.assertTrue(Sparsity.banded(5, 0, 0).is_diag())
+    self.assertFalse(Sparsity.lower(3).is_diag())
+    for S in [Sparsity.dense(3, 4), Sparsity.diag(4)]:
+      D = DM(S, list(range(S.nnz())))
+      for invert in [False, True]:
+        T, m = S.transpose(invert)
+        self.assertTrue(T==S.T())
+        self.checkarray(DM(T, m if not invert else [m.index(k) for k in range(len(m))]), D.T)
+
+  def test_sub_erase(self):
+    numpy.random.seed(4)
+    for k in range(50):
+      A = DM(numpy.random.random((8,7))*(numpy.random.random((8,7))>0.5))
+      A = sparsify(A)
+      rr = list(numpy.random.randint(-8, 8, numpy.random.randint(0, 17)))
+      cc = list(numpy.random.randint(-7, 7, numpy.random.randint(0, 15)))
+      if k%2: rr.sort()
+      sp, m = A.sparsity().sub(rr, cc)
+      self.assertEqual(sp.shape, (len(rr), len(cc)))
+      self.checkarray(DM(sp, [A.nonzeros()[i] for i in m]),
+                      numpy.array(A)[numpy.ix_(rr, cc)].reshape(sp.shape))
+      self.checkarray(DM(sp, 1), numpy.array(DM(A.sparsity(), 1))[numpy.ix_(rr, cc)].reshape(sp.shape))
+      E = A.sparsity()
+      m = E.erase(rr, cc)
+      ref = numpy.array(A)
+      for r in rr:
+        for c in cc:
+          ref[r, c] = 0
+      self.checkarray(DM(E, [A.nonzeros()[i] for i in m]), ref)
+
+  def test_assemble(self):
+    numpy.random.seed(2)
+    n = 5000
+    r = list(numpy.random.randint(0, 40, n))
+    c = list(numpy.random.randint(0, 30, n))
+    v = numpy.random.random(n)
+    ref = numpy.zeros((40, 30))
+    for k in range(n): ref[r[k], c[k]] += v[k]
+    for n_threads in [1, 4]:
+      sp, nz = Sparsity.assemble(40, 30, r, c, n_threads)
+      self.assertTrue(sp==Sparsity.triplet(40, 30, r, c))
+      self.checkarray(DM.assemble(sp, nz, v), ref)
+      self.checkarray(DM.assemble(r, c, v, 40, 30, n_threads), ref)
+    # Into an existing pattern, nonzeros looked up from linear indices
+    sp = Sparsity.dense(40, 30)
+    nz = sp.get_nz([r[k]+40*c[k] for k in range(n)])
+    self.checkarray(DM.assemble(sp, nz, v), ref)
+    with self.assertInException("not in the sparsity pattern"):
+      DM.assemble(Sparsity.diag(40, 30), Sparsity.diag(40, 30).get_nz([1]), DM(1))
+
+  def test_parallel_coloring(self):
+    n = 2000
+    numpy.random.seed(0)
+    r = list(range(n))*3
+    c = list(numpy.random.randint(0, n, 3*n))
+    A = Sparsity.triplet(n, n, r, c)
+    S = A + A.T() + Sparsity.diag(n)
+    ref = None
+    for n_threads in [2, 3, 8]:
+      D = A.uni_coloring(A.T(), sys.maxsize, n_threads)
+      # Columns with the same color may not share a row
+      self.assertEqual(max(mtimes(DM(A, 1), DM(D, 1)).nonzeros()), 1)
+      H = S.star_coloring(1, sys.maxsize, n_threads)
+      self.assertEqual(H.nnz(), n)
+      if ref is None:
+        ref = (D, H)
+      else:
+        self.assertTrue(D==ref[0])
+        self.assertTrue(H==ref[1])
+    self.assertTrue(A.uni_coloring(A.T(), 2, 4).is_null())
+
+    x = MX.sym("x", n)
+    f = Function("f", [x], [mtimes(DM(A, 1), x**2)], {"coloring_num_threads": 4})
+    J = f.jacobian_old(0, 0)
+    self.checkarray(J(1)[0], 2*DM(A, 1))
+
+  def test_file(self):
+    import tempfile, os, shutil
+    d = tempfile.mkdtemp()
+    A = DM.rand(Sparsity.banded(5,1))
+    A[1,3] = 7
+    for ext in ["mtx", "csc"]:
+      fname = os.path.join(d, "A." + ext)
+      A.to_file(fname)
+      B = DM.from_file(fname)
+      self.assertTrue(B.sparsity()==A.sparsity())
+      self.checkarray(B, A)
+      A.sparsity().to_file(fname)
+      self.assertTrue(Sparsity.from_file(fname)==A.sparsity())
+      self.checkarray(DM.from_file(fname), DM(A.sparsity(), 1))
+    # Symmetric Matrix Market, with comments and in any order
+    fname = os.path.join(d, "S.mtx")
+    with open(fname, "w") as f:
+      f.write("%%MatrixMarket matrix coordinate real symmetric\n% comment\n3 3 3\n3 1 2.5\n1 1 1\n2 2 -1\n")
+    self.checkarray(DM.from_file(fname), DM([[1,0,2.5],[0,-1,0],[2.5,0,0]]))
+    shutil.rmtree(d)
 
 if __name__ == '__main__':
     unittest.main()
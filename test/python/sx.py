@@ -688,6 +688,19 @@ class SXtests(casadiTestCase):
     b = x*x
     self.assertTrue(a.is_equal(b,1))
 
+  def test_is_equal_depth(self):
+    x = SX.sym("x")
+    y = SX.sym("y")
+    a = sin(x+y)*2
+    # Commutative operations, constants compared by value
+    self.assertTrue(is_equal(a, 2*sin(y+x), 3))
+    self.assertTrue(is_equal(x+SX(2), x+2., 1))
+    self.assertFalse(is_equal(a, 2*sin(y+x), 2))
+    self.assertFalse(is_equal(a, sin(x-y)*2, 10))
+    self.assertFalse(is_equal(a, cos(x+y)*2, 10))
+    self.assertFalse(is_equal(x-y, y-x, 10))
+    self.assertTrue(is_equal(x*y, y*x, 1))
+
   @skip(not GlobalOptions.getSimplificationOnTheFly())
   def test_SXsimplifications(self):
     self.message("simplifications")
@@ -1419,6 +1432,124 @@ class SXtests(casadiTestCase):
     with self.assertInException("since variables [x] are free"):
       evalf(x)
 
+  def test_optimize(self):
+    x = SX.sym("x", 4)
+    f = 0
+    for i in range(4):
+      f += 3*x[i]*x[(i+1)%4] + constpow(x[i], 2)/4 + 2*(5*x[i]) + 7*x[i]
+    f += sin(x[0])*x[1] + sin(x[0])*x[2]
+    out = [f, gradient(f, x), hessian(f, x)[0]]
+    F = Function("F", [x], out)
+    for passes in [["simplify"], ["strength"], ["reassociate"],
+                   ["simplify", "strength", "reassociate", "simplify"]]:
+      Fo = Function("Fo", [x], out, {"optimize": passes})
+      self.assertEqual(Fo.stats()["n_instructions_initial"], F.n_instructions())
+      self.assertTrue(Fo.n_instructions()<=F.n_instructions())
+      self.checkfunction(Fo, F, inputs=[DM([0.3, 1.2, 2.1, 0.7])])
+    self.assertRaises(RuntimeError, lambda: Function("Fo", [x], out, {"optimize": ["foo"]}))
+
+  def test_schedule(self):
+    x = SX.sym("x", 20)
+    f = sin(x[19])
+    for i in range(18, -1, -1):
+      f = sin(x[i])*cos(x[i]) + f
+    F = Function("F", [x], [f, gradient(f, x)])
+    Fs = Function("Fs", [x], [f, gradient(f, x)], {"schedule": "sethi_ullman"})
+    self.assertTrue(Fs.stats()["worksize"]<F.stats()["worksize"])
+    self.checkfunction(Fs, F, inputs=[DM(list(range(20)))])
+
+  def test_checkpointing(self):
+    x = SX.sym("x", 3)
+    p = SX.sym("p")
+    s = x
+    for k in range(100):
+      s = vertcat(s[0]+0.01*sin(p*s[1]), s[1]+0.01*s[2]*s[0], s[2]-0.01*s[1]**2)
+    F = Function("F", [x, p], [s, sumsqr(s)])
+    x0 = DM([0.3, -0.2, 0.5])
+    res = F(x0, 1.2)
+    Fr = F.reverse(2)
+    for mem in [2**26, 1000, 100, 0]:
+      Fc = Function("Fc", [x, p], [s, sumsqr(s)],
+                    {"checkpointing": True, "checkpoint_memory": mem})
+      Fcr = Fc.reverse(2)
+      self.assertEqual(Fcr.class_name(), "SXReverse")
+      inputs = [x0, 1.2, res[0], res[1], DM([[1, 2], [-1, 0.5], [3, 0]]), DM([[0.3, -0.4]])]
+      self.checkfunction_light(Fcr, Fr, inputs=inputs)
+
+  def test_hessvec(self):
+    x = SX.sym("x", 3)
+    p = SX.sym("p")
+    e = vertcat(sin(x[0])*x[1]/x[2], x[2]**p + exp(x[0]*p), atan2(x[0], x[1])*tanh(x[2]))
+    F = Function("F", [x, p], [e, sumsqr(x)])
+    Fhv = F.hessvec()
+    self.assertEqual(Fhv.class_name(), "SXHessVec")
+    # Reference: symbolic Hessian of the Lagrangian times the direction
+    w = SX.sym("w", 3)
+    v = SX.sym("v", 4)
+    H = hessian(dot(w, e) + 2*sumsqr(x), vertcat(x, p))[0]
+    hv = mtimes(H, v)
+    Fref = Function("Fref", [x, p, v[:3], v[3], w, SX.sym("l")], [hv[:3], hv[3]])
+    inputs = [DM([0.3, 0.7, 0.5]), 1.2, DM([1, -2, 0.5]), -1, DM([0.5, -1, 2]), 2]
+    self.checkfunction_light(Fhv, Fref, inputs=inputs)
+    # Forward-over-reverse via the derivative functions for MX
+    X = MX.sym("x", 3)
+    P = MX.sym("p")
+    G = Function("G", [X, P], F(X, P))
+    self.checkfunction_light(G.hessvec(), Fref, inputs=inputs)
+
+  def test_vector_forward(self):
+    x = SX.sym("x", 4)
+    p = SX.sym("p")
+    s = x
+    for k in range(10):
+      s = vertcat(s[0]+0.1*sin(p*s[1]), s[1]*s[2], s[2]-0.1*s[3]**2, s[3]+s[0]/(1+s[1]**2))
+    F = Function("F", [x, p], [s, s[0]*s[1]])
+    Fv = Function("Fv", [x, p], [s, s[0]*s[1]], {"vector_forward": True})
+    self.assertEqual(Fv.forward(3).class_name(), "SXForward")
+    inputs = [DM([0.3, -0.2, 0.5, 1.1]), 1.2]
+    res = F(*inputs)
+    fwd_inputs = inputs + [res[0], res[1], DM.rand(4, 3), DM.rand(1, 3)]
+    self.checkfunction_light(Fv.forward(3), F.forward(3), inputs=fwd_inputs)
+    self.checkfunction_light(Fv.jacobian(), F.jacobian(), inputs=inputs + [res[0], res[1]])
+
+  def test_node_pool(self):
+    ref = None
+    for pool in [False, True]:
+      GlobalOptions.setNodePool(pool)
+      try:
+        m0 = GlobalOptions.getNodeMemory()
+        GlobalOptions.resetNodeMemoryPeak()
+        x = SX.sym("x", 5)
+        e = x
+        for k in range(100):
+          e = sin(e)*e[k%5] + 0.5*e
+        self.assertTrue(GlobalOptions.getNodeMemory()>m0)
+        r = Function("f", [x], [e])(DM.ones(5))
+        if ref is None:
+          ref = r
+        else:
+          self.checkarray(r, ref)
+        del x, e
+        self.assertTrue(GlobalOptions.getNodeMemory()<GlobalOptions.getNodeMemoryPeak())
+      finally:
+        GlobalOptions.setNodePool(False)
+
+  def test_deep_print(self):
+    x = SX.sym("x")
+    e = x
+    for k in range(100000):
+      e = sin(e) + k*x
+    self.assertTrue(len(str(e))>100000)
+    X = MX.sym("x")
+    E = X
+    for k in range(100000):
+      E = sin(E) + X
+    self.assertTrue(len(str(E))>100000)
+    del e, E
+
+    e = sin(x)
+    self.assertEqual(str(e*e+e), "@1=sin(x), (sq(@1)+@1)")
+
 
 if __name__ == '__main__':
     unittest.main()